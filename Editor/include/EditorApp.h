@@ -2,6 +2,7 @@
 
 #include "Engine/Application.h"
 #include "Engine/Camera.h"
+#include "Engine/TerrainHeightfield.h"
 
 #include "EditorRenderRunner.h"
 #include "editor/BattleConfigEditor.h"
@@ -12,11 +13,17 @@
 #include <glm/glm.hpp>
 
 #include <memory>
+#include <vector>
 
 namespace Engine
 {
     class AssetManager;
-    class GroundPlaneRenderPassModule;
+    class TerrainRenderPassModule;
+}
+
+namespace Engine::ECS
+{
+    struct Prefab;
 }
 
 class EditorApp : public Engine::Application
@@ -31,8 +38,11 @@ public:
 
 private:
     void setupECSFromPrefabs();
-    void loadPrefabsFromDir(const std::string &dirPath);
+    // out: collect the prefabs instead of adding them to ecs.prefabs.
+    void loadPrefabsFromDir(const std::string &dirPath, std::vector<Engine::ECS::Prefab> *out = nullptr);
     void reloadPrefabsAndRespawnWorld();
+    // Changed model files and prefab JSON patched into the live world (PrefabHotReload.h).
+    void hotReloadPrefabsAndModels();
     void clearAllEntities();
     void OnEvent(const std::string &name);
     void ApplyRTSCamera(float aspect);
@@ -63,7 +73,8 @@ private:
     Engine::Camera m_camera;
 
     Engine::TextureHandle m_groundTexture;
-    std::shared_ptr<Engine::GroundPlaneRenderPassModule> m_groundPass;
+    Engine::TerrainHeightfield m_terrain;
+    std::shared_ptr<Engine::TerrainRenderPassModule> m_groundPass;
 
     Editor::EditorRenderRunner m_render;
     Editor::BattleConfigEditor m_configEditor;
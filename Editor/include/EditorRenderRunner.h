@@ -1,12 +1,13 @@
 #pragma once
 
 #include "ECS/systems/RenderTransformUpdateSystem.h"
-#include "ECS/systems/RenderBoundsUpdateSystem.h"
 #include "ECS/systems/VisibilityCullingSystem.h"
 #include "ECS/systems/Animation/AnimationPlaybackSystem.h"
 #include "ECS/systems/PoseUpdateSystem.h"
 #include "ECS/systems/VisibleRenderGatherSystem.h"
 #include "ECS/systems/RenderSystem.h"
+#include "ECS/systems/NavGrid.h"
+#include "ECS/systems/NavGridBuilderSystem.h"
 
 namespace Engine
 {
@@ -24,6 +25,7 @@ namespace Editor
 {
     // Minimal system runner for the Editor: keeps the scene renderable
     // without running gameplay simulation (combat/movement/pathfinding/etc.).
+    // The NavGrid follows placed obstacles through the builder's incremental path.
     class EditorRenderRunner
     {
     public:
@@ -34,15 +36,18 @@ namespace Editor
         void SetRenderer(Engine::Renderer *renderer);
         void SetCamera(Engine::Camera *camera);
 
+        const NavGrid &navGrid() const { return m_navGrid; }
+
     private:
         bool m_initialized = false;
 
         RenderTransformUpdateSystem m_renderTransform;
-        RenderBoundsUpdateSystem m_renderBoundsUpdate;
         VisibilityCullingSystem m_visibilityCulling;
         AnimationPlaybackSystem m_animPlayback;
         PoseUpdateSystem m_poseUpdate;
         VisibleRenderGatherSystem m_visibleRenderGather;
         RenderSystem m_render;
+        NavGrid m_navGrid;
+        NavGridBuilderSystem m_navGridBuilder{&m_navGrid};
     };
 }
@@ -6,6 +6,7 @@
 #include <filesystem>
 #include <nlohmann/json.hpp>
 #include <string>
+#include <vector>
 
 namespace Editor
 {
@@ -36,6 +37,9 @@ namespace Editor
         bool writePermanent();
         void reloadFromDisk(Engine::ECS::ECSContext &ecs);
 
+        // Anchor names in document order; rebuilt after the anchors object changes.
+        const std::vector<std::string> &anchorKeys();
+
         void respawnFromPath(Engine::ECS::ECSContext &ecs, const std::string &scenarioPath);
         void respawnWorkingCopy(Engine::ECS::ECSContext &ecs);
         void resetGame(Engine::ECS::ECSContext &ecs);
@@ -45,6 +49,9 @@ namespace Editor
         nlohmann::json m_doc;
         nlohmann::json m_originalDoc;
 
+        std::vector<std::string> m_anchorKeys;
+        bool m_anchorKeysDirty = true;
+
         // Selection state for list-style editors.
         std::string m_selectedAnchorKey;
         int m_selectedSpawnGroupIndex = -1;
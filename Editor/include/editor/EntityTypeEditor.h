@@ -2,7 +2,9 @@
 
 #include <nlohmann/json.hpp>
 
+#include <cstdint>
 #include <filesystem>
+#include <future>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -33,6 +35,8 @@ namespace Editor
         {
             // Called after save/delete when the world should be rebuilt.
             void (*reloadPrefabsAndRespawn)(void *user) = nullptr;
+            // Same, patching the entities in place (keeps the world as it is).
+            void (*hotReloadPrefabs)(void *user) = nullptr;
             void *user = nullptr;
         };
 
@@ -52,6 +56,14 @@ namespace Editor
             std::string name;
             std::filesystem::path path;
             bool isEditorOwned = false; // true => editor_entities/, false => entities/
+            std::string label;          // list text, built with the list
+        };
+
+        // One line of the Components checklist.
+        struct ComponentRow
+        {
+            std::string name;
+            bool enabled = false;
         };
 
         void refreshList();
@@ -63,7 +75,13 @@ namespace Editor
         void applyEntityKindPreset(EntityKind kind);
         EntityKind detectEntityKindFromDoc() const;
 
+        // Starts a background scan of assets/ for .smodel files; the list is swapped in when done.
         void refreshSModelList();
+        void pollSModelScan();
+        static std::vector<SModelEntry> scanSModels();
+
+        // Components checklist and enabled list, rebuilt when the document or registry changes.
+        void rebuildComponentRows(Engine::ECS::ECSContext &ecs);
 
         bool saveToEditorEntities(std::string *outError);
         bool deleteEditorEntity(std::string *outError);
@@ -83,12 +101,19 @@ namespace Editor
 
         std::vector<SModelEntry> m_smodels;
         bool m_smodelsDirty = true;
+        std::future<std::vector<SModelEntry>> m_smodelScan; // valid while a scan runs
 
         std::vector<EntityEntry> m_entries;
         int m_selectedIndex = -1;
 
         // Working JSON document
         nlohmann::json m_doc;
+        uint64_t m_docRevision = 0; // bumped when m_doc is replaced or its components change
+
+        std::vector<ComponentRow> m_componentRows;    // editor-visible, enabled first
+        std::vector<std::string> m_enabledComponents; // editor-visible enabled ones, sorted
+        uint64_t m_componentRowsRevision = UINT64_MAX;
+        uint32_t m_componentRowsRegistryCount = 0;
 
         // Raw JSON editor buffers for Defaults panel (per component name)
         std::unordered_map<std::string, std::string> m_defaultsJsonBuf;
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <imgui.h>
+
+namespace Editor
+{
+    // Submits only the on-screen rows of a list whose rows all have the same height
+    // (Selectable / Checkbox lines): row(i) runs for the visible indices, in order.
+    // keepIndex (e.g. the selection) is submitted even when scrolled away, so combo popups can
+    // still give it default focus.
+    template <typename Row>
+    inline void drawClippedRows(int count, Row &&row, int keepIndex = -1)
+    {
+        ImGuiListClipper clipper;
+        clipper.Begin(count);
+        if (keepIndex >= 0 && keepIndex < count)
+            clipper.IncludeItemByIndex(keepIndex);
+        while (clipper.Step())
+        {
+            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
+                row(i);
+        }
+    }
+}
@@ -1,4 +1,5 @@
 #include "editor/BattleConfigEditor.h"
+#include "editor/ListClipper.h"
 
 #include <imgui.h>
 #include <nlohmann/json.hpp>
@@ -90,6 +91,7 @@ namespace Editor
         ensureArray(m_doc, "obstacles");
 
         m_originalDoc = m_doc;
+        m_anchorKeysDirty = true;
         m_selectedAnchorKey.clear();
         m_selectedSpawnGroupIndex = -1;
         m_selectedObstacleIndex = -1;
@@ -219,6 +221,20 @@ namespace Editor
         ImGui::PopItemWidth();
     }
 
+    const std::vector<std::string> &BattleConfigEditor::anchorKeys()
+    {
+        const json &anchors = m_doc["anchors"];
+        if (m_anchorKeysDirty)
+        {
+            m_anchorKeys.clear();
+            m_anchorKeys.reserve(anchors.size());
+            for (auto it = anchors.begin(); it != anchors.end(); ++it)
+                m_anchorKeys.push_back(it.key());
+            m_anchorKeysDirty = false;
+        }
+        return m_anchorKeys;
+    }
+
     void BattleConfigEditor::drawAnchorsSection()
     {
         if (!ImGui::CollapsingHeader("Anchors", ImGuiTreeNodeFlags_DefaultOpen))
@@ -237,7 +253,10 @@ namespace Editor
             if (!key.empty())
             {
                 if (!anchors.contains(key))
+                {
                     anchors[key] = json::object();
+                    m_anchorKeysDirty = true;
+                }
                 ensureXZObject(anchors[key]);
                 m_selectedAnchorKey = key;
                 std::snprintf(m_renameAnchorName, sizeof(m_renameAnchorName), "%s", key.c_str());
@@ -246,16 +265,15 @@ namespace Editor
 
         ImGui::Columns(2, "##AnchorsColumns", true);
         ImGui::BeginChild("##AnchorsList", ImVec2(180.0f, 160.0f), true);
-        for (auto it = anchors.begin(); it != anchors.end(); ++it)
-        {
-            const std::string key = it.key();
-            const bool selected = (key == m_selectedAnchorKey);
-            if (ImGui::Selectable(key.c_str(), selected))
-            {
-                m_selectedAnchorKey = key;
-                std::snprintf(m_renameAnchorName, sizeof(m_renameAnchorName), "%s", key.c_str());
-            }
-        }
+        const std::vector<std::string> &keys = anchorKeys();
+        drawClippedRows(static_cast<int>(keys.size()), [&](int i)
+                        {
+                            const std::string &key = keys[i];
+                            if (ImGui::Selectable(key.c_str(), key == m_selectedAnchorKey))
+                            {
+                                m_selectedAnchorKey = key;
+                                std::snprintf(m_renameAnchorName, sizeof(m_renameAnchorName), "%s", key.c_str());
+                            } });
         ImGui::EndChild();
         ImGui::NextColumn();
 
@@ -275,6 +293,7 @@ namespace Editor
                         anchors[newKey] = a;
                         anchors.erase(m_selectedAnchorKey);
                         m_selectedAnchorKey = newKey;
+                        m_anchorKeysDirty = true;
                     }
                     else
                     {
@@ -298,6 +317,7 @@ namespace Editor
             if (ImGui::Button("Delete Anchor"))
             {
                 anchors.erase(m_selectedAnchorKey);
+                m_anchorKeysDirty = true;
                 m_selectedAnchorKey.clear();
                 m_selectedSpawnGroupIndex = -1;
             }
@@ -340,15 +360,13 @@ namespace Editor
 
         ImGui::Columns(2, "##SpawnGroupsColumns", true);
         ImGui::BeginChild("##SpawnGroupsList", ImVec2(220.0f, 190.0f), true);
-        for (int i = 0; i < static_cast<int>(groups.size()); ++i)
-        {
-            const auto &g = groups[i];
-            std::string label = "[" + std::to_string(i) + "] ";
-            label += g.value("id", std::string("(no-id)"));
-            const bool selected = (i == m_selectedSpawnGroupIndex);
-            if (ImGui::Selectable(label.c_str(), selected))
-                m_selectedSpawnGroupIndex = i;
-        }
+        // Labels are built for the visible rows only: ids can be edited in the panel next to it.
+        drawClippedRows(static_cast<int>(groups.size()), [&](int i)
+                        {
+                            std::string label = "[" + std::to_string(i) + "] ";
+                            label += groups[i].value("id", std::string("(no-id)"));
+                            if (ImGui::Selectable(label.c_str(), i == m_selectedSpawnGroupIndex))
+                                m_selectedSpawnGroupIndex = i; });
         ImGui::EndChild();
         ImGui::NextColumn();
 
@@ -388,7 +406,6 @@ namespace Editor
 
             // Anchor selection
             ensureObject(m_doc, "anchors");
-            auto &anchors = m_doc["anchors"];
             std::string anchorName = g.value("anchor", std::string(""));
             const char *anchorPreview = anchorName.empty() ? "(none)" : anchorName.c_str();
             if (ImGui::BeginCombo("Anchor", anchorPreview))
@@ -398,18 +415,20 @@ namespace Editor
                     g["anchor"] = "";
                     anchorName.clear();
                 }
-                for (auto it = anchors.begin(); it != anchors.end(); ++it)
-                {
-                    const std::string key = it.key();
-                    const bool selected = (key == anchorName);
-                    if (ImGui::Selectable(key.c_str(), selected))
-                    {
-                        g["anchor"] = key;
-                        anchorName = key;
-                    }
-                    if (selected)
-                        ImGui::SetItemDefaultFocus();
-                }
+                const std::vector<std::string> &keys = anchorKeys();
+                const int current = static_cast<int>(std::find(keys.begin(), keys.end(), anchorName) - keys.begin());
+                drawClippedRows(static_cast<int>(keys.size()), [&](int i)
+                                {
+                                    const std::string &key = keys[i];
+                                    const bool selected = (key == anchorName);
+                                    if (ImGui::Selectable(key.c_str(), selected))
+                                    {
+                                        g["anchor"] = key;
+                                        anchorName = key;
+                                    }
+                                    if (selected)
+                                        ImGui::SetItemDefaultFocus(); },
+                                current);
                 ImGui::EndCombo();
             }
 
@@ -523,18 +542,15 @@ namespace Editor
 
         ImGui::Columns(2, "##ObstaclesColumns", true);
         ImGui::BeginChild("##ObstaclesList", ImVec2(220.0f, 190.0f), true);
-        for (int i = 0; i < static_cast<int>(obstacles.size()); ++i)
-        {
-            const auto &o = obstacles[i];
-            std::string label = "[" + std::to_string(i) + "] ";
-            label += o.value("prefab", std::string("(no-prefab)"));
-            const bool selected = (i == m_selectedObstacleIndex);
-            if (ImGui::Selectable(label.c_str(), selected))
-            {
-                m_selectedObstacleIndex = i;
-                m_selectedGapIndex = -1;
-            }
-        }
+        drawClippedRows(static_cast<int>(obstacles.size()), [&](int i)
+                        {
+                            std::string label = "[" + std::to_string(i) + "] ";
+                            label += obstacles[i].value("prefab", std::string("(no-prefab)"));
+                            if (ImGui::Selectable(label.c_str(), i == m_selectedObstacleIndex))
+                            {
+                                m_selectedObstacleIndex = i;
+                                m_selectedGapIndex = -1;
+                            } });
         ImGui::EndChild();
         ImGui::NextColumn();
 
@@ -598,13 +614,11 @@ namespace Editor
             }
 
             ImGui::BeginChild("##GapsList", ImVec2(0.0f, 90.0f), true);
-            for (int gi = 0; gi < static_cast<int>(gaps.size()); ++gi)
-            {
-                std::string glabel = "Gap [" + std::to_string(gi) + "]";
-                const bool selected = (gi == m_selectedGapIndex);
-                if (ImGui::Selectable(glabel.c_str(), selected))
-                    m_selectedGapIndex = gi;
-            }
+            drawClippedRows(static_cast<int>(gaps.size()), [&](int gi)
+                            {
+                                const std::string glabel = "Gap [" + std::to_string(gi) + "]";
+                                if (ImGui::Selectable(glabel.c_str(), gi == m_selectedGapIndex))
+                                    m_selectedGapIndex = gi; });
             ImGui::EndChild();
 
             if (m_selectedGapIndex >= 0 && m_selectedGapIndex < static_cast<int>(gaps.size()))
@@ -738,6 +752,7 @@ namespace Editor
     void BattleConfigEditor::resetGame(Engine::ECS::ECSContext &ecs)
     {
         m_doc = m_originalDoc;
+        m_anchorKeysDirty = true;
 
         respawnFromPath(ecs, m_battleConfigPath);
     }
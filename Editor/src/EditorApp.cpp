@@ -5,11 +5,12 @@
 #include "Engine/ImGuiLayer.h"
 
 #include "ECS/Prefab.h"
+#include "ECS/PrefabHotReload.h"
 #include "ECS/PrefabSpawner.h"
 #include "ECS/ECSContext.h"
 
 #include "assets/AssetManager.h"
-#include "Engine/GroundPlaneRenderPassModule.h"
+#include "Engine/TerrainRenderPassModule.h"
 
 #include "editor/GameWorldSpawner.h"
 
@@ -22,6 +23,9 @@
 #include <iostream>
 #include <sstream>
 #include <cstdio>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
 
 #include <glm/gtc/matrix_transform.hpp>
 
@@ -34,6 +38,9 @@ using json = nlohmann::json;
 // -----------------------------------------------------------------------------
 namespace EditorTuning
 {
+    // Asset garbage collection: main-thread time per frame for collecting and destroying unloaded assets.
+    static constexpr float ASSET_GC_BUDGET_MS = 0.5f;
+
     // Hover label placement near cursor.
     static constexpr float HOVER_LABEL_OFFSET_X_PX = 14.0f;
     static constexpr float HOVER_LABEL_OFFSET_Y_PX = 10.0f; // applied upward
@@ -114,12 +121,17 @@ EditorApp::EditorApp(std::string battleConfigPath)
 
         if (m_groundTexture.isValid())
         {
-            m_groundPass = std::make_shared<Engine::GroundPlaneRenderPassModule>();
+            // Optional 4097x4097 16-bit height map (1 m spacing, 0..200 m); flat ground otherwise.
+            if (!m_terrain.loadRaw16("assets/terrain/height.r16", 4097, 4097, 1.0f, -2048.0f, -2048.0f, 200.0f / 65535.0f, 0.0f))
+                m_terrain.createFlat(-2048.0f, -2048.0f, 4096.0f, 4096.0f);
+            else
+                m_terrain.loadSplatRaw("assets/terrain/splat.rgba8");
+
+            m_groundPass = std::make_shared<Engine::TerrainRenderPassModule>();
             m_groundPass->setAssets(m_assets.get());
             m_groundPass->setCamera(&m_camera);
-            m_groundPass->setBaseColorTexture(m_groundTexture);
-            m_groundPass->setHalfSize(1000.0f);
-            m_groundPass->setTileWorldSize(5.0f);
+            m_groundPass->setHeightfield(&m_terrain);
+            m_groundPass->setLayerTexture(0, m_groundTexture, 5.0f);
             m_groundPass->setEnabled(true);
             GetRenderer().registerPass(m_groundPass);
         }
@@ -207,6 +219,17 @@ void EditorApp::OnUpdate(Engine::TimeStep ts)
     // Keep render-related data updated, but do not run gameplay systems.
     (void)ts;
     m_render.Update(GetECS(), 0.0f);
+
+    // Mip residency from this frame's on-screen sizes, before the passes record, then a slice of
+    // collection; GPU objects wait for their frames to retire.
+    if (m_assets)
+    {
+        m_assets->updateTextureResidency();
+
+        auto &renderer = GetRenderer();
+        m_assets->setFrameSerials(renderer.getFrameSerial(), renderer.getCompletedFrameSerial());
+        m_assets->garbageCollectStep(EditorTuning::ASSET_GC_BUDGET_MS);
+    }
 }
 
 void EditorApp::OnRender()
@@ -236,6 +259,11 @@ void EditorApp::OnRender()
             auto *self = static_cast<EditorApp *>(user);
             self->reloadPrefabsAndRespawnWorld();
         };
+        cb.hotReloadPrefabs = [](void *user)
+        {
+            auto *self = static_cast<EditorApp *>(user);
+            self->hotReloadPrefabsAndModels();
+        };
         cb.user = this;
 
         m_entityEditor.draw(ecs, *m_assets, cb);
@@ -296,6 +324,16 @@ void EditorApp::OnRender()
                     else
                         std::snprintf(buf, sizeof(buf), "X: %.2f  Z: %.2f", hit.x, hit.z);
 
+                    // Cells covered by placed obstacles (inflated as pathfinding sees them).
+                    const NavGrid &nav = m_render.navGrid();
+                    const int gx = nav.worldToGridX(hit.x);
+                    const int gz = nav.worldToGridZ(hit.z);
+                    if (nav.isValid(gx, gz) && !nav.isWalkable(gx, gz))
+                    {
+                        const size_t len = std::strlen(buf);
+                        std::snprintf(buf + len, sizeof(buf) - len, "  (blocked)");
+                    }
+
                     const ImVec2 ts = ImGui::CalcTextSize(buf);
                     ImVec2 tl;
                     tl.x = mp.x + EditorTuning::HOVER_LABEL_OFFSET_X_PX;
@@ -327,13 +365,14 @@ void EditorApp::setupECSFromPrefabs()
     auto &ecs = GetECS();
 
     ecs.prefabs.clear();
+    ecs.prefabs.setTrackInstances(true); // hot reload finds each prefab's entities
     loadPrefabsFromDir("entities");
     loadPrefabsFromDir(m_editorEntitiesDir);
 
     Editor::SpawnFromGameWorldFile(ecs, m_battleConfigPath, /*selectSpawned=*/false);
 }
 
-void EditorApp::loadPrefabsFromDir(const std::string &dirPath)
+void EditorApp::loadPrefabsFromDir(const std::string &dirPath, std::vector<Engine::ECS::Prefab> *out)
 {
     auto &ecs = GetECS();
     try
@@ -357,7 +396,10 @@ void EditorApp::loadPrefabsFromDir(const std::string &dirPath)
             if (p.name.empty())
                 continue;
 
-            ecs.prefabs.add(p);
+            if (out)
+                out->push_back(std::move(p));
+            else
+                ecs.prefabs.add(p);
         }
     }
     catch (...)
@@ -380,6 +422,7 @@ void EditorApp::clearAllEntities()
             storePtr->destroyRow(storePtr->size() - 1);
         }
     }
+    ecs.prefabs.clearInstances();
 }
 
 void EditorApp::reloadPrefabsAndRespawnWorld()
@@ -394,6 +437,56 @@ void EditorApp::reloadPrefabsAndRespawnWorld()
     Editor::SpawnFromGameWorldFile(ecs, m_battleConfigPath, /*selectSpawned=*/false);
 }
 
+void EditorApp::hotReloadPrefabsAndModels()
+{
+    auto &ecs = GetECS();
+
+    std::vector<Engine::ModelHandle> reloadedModels;
+    m_assets->reloadChangedModels(&reloadedModels);
+
+    std::vector<Engine::ECS::Prefab> loaded;
+    loadPrefabsFromDir("entities", &loaded);
+    loadPrefabsFromDir(m_editorEntitiesDir, &loaded);
+
+    // Same precedence as a full load: the last file of a name wins.
+    std::unordered_map<std::string, size_t> lastOfName;
+    for (size_t i = 0; i < loaded.size(); ++i)
+        lastOfName[loaded[i].name] = i;
+
+    Engine::ECS::PrefabReloadStats stats;
+    for (size_t i = 0; i < loaded.size(); ++i)
+    {
+        if (lastOfName[loaded[i].name] == i)
+            Engine::ECS::hotReloadPrefab(ecs, std::move(loaded[i]), stats);
+    }
+
+    // Reloaded models keep their handles, so neither the prefab JSON nor its RenderBounds
+    // default changed: copy the new local bounds to the rows by model handle instead (this also
+    // marks them dirty, so WorldBounds and the pose caches follow).
+    if (!reloadedModels.empty())
+    {
+        const uint32_t rmId = ecs.components.ensureId("RenderModel");
+        std::unordered_set<uint64_t> reloadedIds;
+        for (const Engine::ModelHandle &h : reloadedModels)
+            reloadedIds.insert(h.id);
+
+        for (const auto &kv : lastOfName)
+        {
+            Engine::ECS::Prefab *prefab = ecs.prefabs.find(kv.first);
+            if (!prefab)
+                continue;
+            auto it = prefab->defaults.find(rmId);
+            if (it != prefab->defaults.end() && std::holds_alternative<Engine::ECS::RenderModel>(it->second) &&
+                reloadedIds.count(std::get<Engine::ECS::RenderModel>(it->second).handle.id))
+                Engine::ECS::refreshStreamedModelBounds(*prefab, ecs, *m_assets);
+        }
+    }
+
+    std::cout << "[Editor] Hot reload: " << reloadedModels.size() << " models, " << stats.prefabsChanged
+              << " prefabs changed (" << stats.prefabsAdded << " new), " << stats.entitiesMigrated
+              << " entities migrated, " << stats.valuesPatched << " values patched\n";
+}
+
 void EditorApp::OnEvent(const std::string &name)
 {
     std::istringstream iss(name);
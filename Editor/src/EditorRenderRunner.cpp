@@ -37,14 +37,18 @@ namespace Editor
         auto &registry = ecs.components;
 
         m_renderTransform.buildMasks(registry);
-        m_renderBoundsUpdate.buildMasks(registry);
         m_visibilityCulling.buildMasks(registry);
         m_animPlayback.buildMasks(registry);
         m_poseUpdate.buildMasks(registry);
         m_visibleRenderGather.buildMasks(registry);
         m_render.buildMasks(registry);
+        m_navGridBuilder.buildMasks(registry);
 
         m_render.setVisibleBuckets(&m_visibleRenderGather.buckets());
+        m_render.setPosePalettePool(&m_poseUpdate.palettePool());
+
+        // Same area as the Sample's grid; the first update rasterizes every obstacle.
+        m_navGrid.rebuild(2.0f, -600.0f, -600.0f, 600.0f, 600.0f);
 
         m_initialized = true;
     }
@@ -55,11 +59,11 @@ namespace Editor
             Initialize(ecs);
 
         // Keep scene stable: no locomotion/combat/etc.
-        // We still update render transforms + pose + render batches.
+        // We still update render transforms (+ world bounds) + pose + render batches.
         m_renderTransform.update(ecs, 0.0f);
 
-        // Update world bounds from render transform
-        m_renderBoundsUpdate.update(ecs, 0.0f);
+        // Placed, moved or resized obstacles: only their footprints are re-stamped.
+        m_navGridBuilder.update(ecs, 0.0f);
 
         // Cull based on editor camera
         m_visibilityCulling.update(ecs, 0.0f);
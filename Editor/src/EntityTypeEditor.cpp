@@ -4,11 +4,13 @@
 #include "ECS/Prefab.h"
 
 #include "assets/AssetManager.h"
+#include "editor/ListClipper.h"
 
 #include <imgui.h>
 
 #include <algorithm>
 #include <cctype>
+#include <chrono>
 #include <cstdio>
 #include <fstream>
 #include <sstream>
@@ -52,7 +54,12 @@ namespace
             "PosePalette",
             "RenderTransform",
             "RenderBounds",
+            "WorldBounds",
             "VisibilityState",
+            "PreviousTransform",
+            "SleepState",
+            "CombatMemory",
+            "RenderSlot",
         };
 
         if (name.empty())
@@ -270,6 +277,8 @@ namespace Editor
             dedup.push_back(e);
         }
         m_entries = std::move(dedup);
+        for (auto &e : m_entries)
+            e.label = e.isEditorOwned ? e.name + "  (editor)" : e.name;
 
         m_listDirty = false;
     }
@@ -291,6 +300,7 @@ namespace Editor
         try
         {
             m_doc = nlohmann::json::parse(f);
+            ++m_docRevision;
         }
         catch (const std::exception &ex)
         {
@@ -368,6 +378,7 @@ namespace Editor
     void EntityTypeEditor::newEntity(EntityKind kind)
     {
         m_doc = nlohmann::json::object();
+        ++m_docRevision;
         const char *defaultName = "NewCombatant";
         if (kind == EntityKind::Obstacle)
             defaultName = "NewObstacle";
@@ -392,35 +403,102 @@ namespace Editor
 
     void EntityTypeEditor::refreshSModelList()
     {
-        m_smodels.clear();
+        m_smodelsDirty = false;
+        if (m_smodelScan.valid())
+            return; // the running scan will pick up the change
+        m_smodelScan = std::async(std::launch::async, &EntityTypeEditor::scanSModels);
+    }
 
-        const std::filesystem::path assetsRoot("assets");
-        if (!std::filesystem::exists(assetsRoot) || !std::filesystem::is_directory(assetsRoot))
-        {
-            m_smodelsDirty = false;
+    void EntityTypeEditor::pollSModelScan()
+    {
+        if (!m_smodelScan.valid() || m_smodelScan.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
             return;
-        }
+        m_smodels = m_smodelScan.get();
+    }
+
+    std::vector<EntityTypeEditor::SModelEntry> EntityTypeEditor::scanSModels()
+    {
+        // Runs on a worker thread: touches only the filesystem.
+        std::vector<SModelEntry> models;
 
+        const std::filesystem::path assetsRoot("assets");
         std::error_code ec;
-        for (const auto &entry : std::filesystem::recursive_directory_iterator(assetsRoot, ec))
+        if (!std::filesystem::is_directory(assetsRoot, ec))
+            return models;
+
+        for (auto it = std::filesystem::recursive_directory_iterator(assetsRoot, ec);
+             !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec))
         {
-            if (ec)
-                break;
-            if (!entry.is_regular_file())
+            if (!it->is_regular_file(ec))
                 continue;
 
-            const auto p = entry.path();
+            const auto &p = it->path();
             if (p.extension() != ".smodel")
                 continue;
 
-            const std::string runtimePath = p.generic_string();
-            m_smodels.push_back({p.filename().string(), runtimePath});
+            models.push_back({p.filename().string(), p.generic_string()});
         }
 
-        std::sort(m_smodels.begin(), m_smodels.end(), [](const SModelEntry &a, const SModelEntry &b)
+        std::sort(models.begin(), models.end(), [](const SModelEntry &a, const SModelEntry &b)
                   { return a.fileName < b.fileName; });
+        return models;
+    }
 
-        m_smodelsDirty = false;
+    void EntityTypeEditor::rebuildComponentRows(Engine::ECS::ECSContext &ecs)
+    {
+        if (m_componentRowsRevision == m_docRevision && m_componentRowsRegistryCount == ecs.components.count())
+            return;
+
+        // Ensure any components already present in the JSON are registered so they can appear.
+        if (m_doc.contains("components") && m_doc["components"].is_array())
+        {
+            for (const auto &v : m_doc["components"])
+            {
+                if (v.is_string())
+                    (void)ecs.components.ensureId(v.get<std::string>());
+            }
+        }
+        m_componentRowsRevision = m_docRevision;
+        m_componentRowsRegistryCount = ecs.components.count();
+
+        std::vector<std::string> all;
+        all.reserve(static_cast<size_t>(ecs.components.count()) + 16);
+
+        for (uint32_t cid = 0; cid < ecs.components.count(); ++cid)
+        {
+            const std::string &nm = ecs.components.getName(cid);
+            if (!nm.empty())
+                all.push_back(nm);
+        }
+
+        // Also include any components referenced by defaults even if not in the registry yet.
+        if (m_doc.contains("defaults") && m_doc["defaults"].is_object())
+        {
+            for (auto it = m_doc["defaults"].begin(); it != m_doc["defaults"].end(); ++it)
+            {
+                if (!it.key().empty())
+                    all.push_back(it.key());
+            }
+        }
+
+        std::sort(all.begin(), all.end());
+        all.erase(std::unique(all.begin(), all.end()), all.end());
+
+        m_componentRows.clear();
+        m_enabledComponents.clear();
+        for (auto &name : all)
+        {
+            if (!isEditorVisibleComponentName(name))
+                continue;
+            const bool enabled = hasComponent(name);
+            if (enabled)
+                m_enabledComponents.push_back(name);
+            m_componentRows.push_back({std::move(name), enabled});
+        }
+
+        // Show enabled components first, then alphabetical.
+        std::stable_sort(m_componentRows.begin(), m_componentRows.end(), [](const ComponentRow &a, const ComponentRow &b)
+                         { return a.enabled > b.enabled; });
     }
 
     nlohmann::json &EntityTypeEditor::defaultsObj()
@@ -444,6 +522,7 @@ namespace Editor
 
     void EntityTypeEditor::ensureComponent(const std::string &comp, bool enabled)
     {
+        ++m_docRevision;
         ensureComponentsArray(m_doc);
         if (enabled)
         {
@@ -602,21 +681,13 @@ namespace Editor
 
         ImGui::BeginChild("##EntityList", ImVec2(220.0f, 0.0f), true);
 
-        for (int i = 0; i < static_cast<int>(m_entries.size()); ++i)
-        {
-            const auto &e = m_entries[i];
-            const bool selected = (i == m_selectedIndex);
-
-            std::string label = e.name;
-            if (e.isEditorOwned)
-                label += "  (editor)";
-
-            if (ImGui::Selectable(label.c_str(), selected))
-            {
-                m_selectedIndex = i;
-                loadSelected();
-            }
-        }
+        drawClippedRows(static_cast<int>(m_entries.size()), [&](int i)
+                        {
+                            if (ImGui::Selectable(m_entries[i].label.c_str(), i == m_selectedIndex))
+                            {
+                                m_selectedIndex = i;
+                                loadSelected();
+                            } });
 
         ImGui::EndChild();
     }
@@ -644,20 +715,36 @@ namespace Editor
 
         if (m_smodelsDirty)
             refreshSModelList();
+        pollSModelScan();
+        if (m_smodelScan.valid())
+        {
+            ImGui::SameLine();
+            ImGui::TextDisabled("(scanning...)");
+        }
 
         const std::string currentModelPath = trim(std::string(m_modelBuf));
         const char *preview = currentModelPath.empty() ? "(none)" : currentModelPath.c_str();
 
         if (ImGui::BeginCombo("Pick .smodel", preview))
         {
-            for (const auto &m : m_smodels)
+            int current = -1;
+            for (int i = 0; !currentModelPath.empty() && i < static_cast<int>(m_smodels.size()); ++i)
             {
-                const bool selected = (!currentModelPath.empty() && m.runtimePath == currentModelPath);
-                if (ImGui::Selectable(m.runtimePath.c_str(), selected))
-                    std::snprintf(m_modelBuf, sizeof(m_modelBuf), "%s", m.runtimePath.c_str());
-                if (selected)
-                    ImGui::SetItemDefaultFocus();
+                if (m_smodels[i].runtimePath == currentModelPath)
+                {
+                    current = i;
+                    break;
+                }
             }
+            drawClippedRows(static_cast<int>(m_smodels.size()), [&](int i)
+                            {
+                                const auto &m = m_smodels[i];
+                                const bool selected = (i == current);
+                                if (ImGui::Selectable(m.runtimePath.c_str(), selected))
+                                    std::snprintf(m_modelBuf, sizeof(m_modelBuf), "%s", m.runtimePath.c_str());
+                                if (selected)
+                                    ImGui::SetItemDefaultFocus(); },
+                            current);
             ImGui::EndCombo();
         }
 
@@ -671,70 +758,26 @@ namespace Editor
         // Components + defaults
         auto &defs = defaultsObj();
 
+        rebuildComponentRows(ecs);
+
         if (ImGui::CollapsingHeader("Components", ImGuiTreeNodeFlags_DefaultOpen))
         {
-            // Ensure any components already present in the JSON are registered so they can appear.
-            if (m_doc.contains("components") && m_doc["components"].is_array())
-            {
-                for (const auto &v : m_doc["components"])
-                {
-                    if (v.is_string())
-                        (void)ecs.components.ensureId(v.get<std::string>());
-                }
-            }
-
-            std::vector<std::string> all;
-            all.reserve(static_cast<size_t>(ecs.components.count()) + 16);
-
-            for (uint32_t cid = 0; cid < ecs.components.count(); ++cid)
-            {
-                const std::string &nm = ecs.components.getName(cid);
-                if (!nm.empty())
-                    all.push_back(nm);
-            }
-
-            // Also include any components referenced by defaults even if not in the registry yet.
-            if (m_doc.contains("defaults") && m_doc["defaults"].is_object())
-            {
-                for (auto it = m_doc["defaults"].begin(); it != m_doc["defaults"].end(); ++it)
-                {
-                    if (!it.key().empty())
-                        all.push_back(it.key());
-                }
-            }
-
-            std::sort(all.begin(), all.end());
-            all.erase(std::unique(all.begin(), all.end()), all.end());
-
-            // Show enabled components first, then alphabetical.
-            std::stable_sort(all.begin(), all.end(), [&](const std::string &a, const std::string &b)
-                             {
-                                 const bool ea = hasComponent(a);
-                                 const bool eb = hasComponent(b);
-                                 if (ea != eb)
-                                     return ea > eb;
-                                 return a < b;
-                             });
-
-            for (const auto &name : all)
-            {
-                if (!isEditorVisibleComponentName(name))
-                    continue;
-
-                bool enabled = hasComponent(name);
-                if (ImGui::Checkbox(name.c_str(), &enabled))
-                {
-                    ensureComponent(name, enabled);
-                    if (enabled)
-                    {
-                        // For components that support defaults, having an empty object is harmless and
-                        // makes it easy for users to fill fields later.
-                        ensureDefaultsObject(m_doc);
-                        if (!defs.contains(name))
-                            defs[name] = nlohmann::json::object();
-                    }
-                }
-            }
+            // Toggling bumps the revision; the rows are rebuilt (and re-sorted) next frame.
+            drawClippedRows(static_cast<int>(m_componentRows.size()), [&](int i)
+                            {
+                                const std::string &name = m_componentRows[i].name;
+                                bool enabled = m_componentRows[i].enabled;
+                                if (!ImGui::Checkbox(name.c_str(), &enabled))
+                                    return;
+                                ensureComponent(name, enabled);
+                                if (enabled)
+                                {
+                                    // For components that support defaults, having an empty object is harmless and
+                                    // makes it easy for users to fill fields later.
+                                    ensureDefaultsObject(m_doc);
+                                    if (!defs.contains(name))
+                                        defs[name] = nlohmann::json::object();
+                                } });
 
             ImGui::Spacing();
             ImGui::InputText("Custom Component", m_customCompBuf, sizeof(m_customCompBuf));
@@ -753,23 +796,7 @@ namespace Editor
 
         if (ImGui::CollapsingHeader("Defaults", ImGuiTreeNodeFlags_DefaultOpen))
         {
-            // Build the set of enabled components from the JSON doc.
-            std::vector<std::string> enabled;
-            if (m_doc.contains("components") && m_doc["components"].is_array())
-            {
-                for (const auto &v : m_doc["components"])
-                {
-                    if (!v.is_string())
-                        continue;
-                    std::string nm = v.get<std::string>();
-                    if (!isEditorVisibleComponentName(nm))
-                        continue;
-                    enabled.push_back(std::move(nm));
-                }
-            }
-
-            std::sort(enabled.begin(), enabled.end());
-            enabled.erase(std::unique(enabled.begin(), enabled.end()), enabled.end());
+            const std::vector<std::string> &enabled = m_enabledComponents;
 
             for (const auto &comp : enabled)
             {
@@ -1104,6 +1131,12 @@ namespace Editor
         ImGui::Columns(1);
 
         // If we changed files, allow quick world refresh
+        if (ImGui::Button("Hot Reload Prefabs + Models"))
+        {
+            if (callbacks.hotReloadPrefabs)
+                callbacks.hotReloadPrefabs(callbacks.user);
+        }
+        ImGui::SameLine();
         if (ImGui::Button("Reload Prefabs + Respawn World"))
         {
             if (callbacks.reloadPrefabsAndRespawn)
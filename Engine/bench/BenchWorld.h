@@ -0,0 +1,101 @@
+#pragma once
+//
+// BenchWorld.h
+// ------------
+// Purpose:
+//   - Shared setup for the Engine microbenchmarks: an ECSContext with one unit prefab spawned
+//     over a square whose size follows from the requested density, and a NavGrid with a share
+//     of blocked cells.
+//
+// Notes:
+//   - Everything is seeded, so two runs measure the same layout.
+//   - Density is units per 100 m^2 (a 10 m x 10 m square); 1 is a spread army, 16 a packed blob.
+//
+
+#include "ECS/ECSContext.h"
+#include "ECS/Prefab.h"
+#include "ECS/PrefabSpawner.h"
+#include "ECS/systems/NavGrid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <initializer_list>
+#include <random>
+#include <vector>
+
+namespace EngineBench
+{
+    // Side length (m) of the square holding count units at density units per 100 m^2.
+    inline float extentFor(uint32_t count, uint32_t density)
+    {
+        const float d = static_cast<float>(density > 0 ? density : 1u);
+        return std::sqrt(static_cast<float>(count) * 100.0f / d);
+    }
+
+    struct BenchWorld
+    {
+        Engine::ECS::ECSContext ecs;
+        Engine::ECS::Prefab unit;
+        uint32_t archetypeId = 0;
+        float extent = 0.0f;
+
+        // Prefab with the given components; compiled so spawnBatch fills defaults in bulk.
+        explicit BenchWorld(std::initializer_list<const char *> components)
+        {
+            ecs.WireQueryManager();
+            for (const char *name : components)
+                unit.signature.set(ecs.components.ensureId(name));
+            unit.archetypeId = ecs.archetypes.getOrCreate(unit.signature);
+            unit.compile();
+            archetypeId = unit.archetypeId;
+        }
+
+        Engine::ECS::ArchetypeStore &store() { return *ecs.stores.getOrCreate(archetypeId, unit.signature, ecs.components); }
+
+        // Spawn count units uniformly over an extent x extent square centred on the origin.
+        void spawn(uint32_t count, uint32_t density, uint32_t seed = 1)
+        {
+            extent = extentFor(count, density);
+            std::mt19937 rng(seed);
+            std::uniform_real_distribution<float> u(-0.5f * extent, 0.5f * extent);
+            std::vector<Engine::ECS::Position> positions(count);
+            for (Engine::ECS::Position &p : positions)
+                p = Engine::ECS::Position{u(rng), 0.0f, u(rng)};
+            Engine::ECS::spawnBatch(unit, ecs, count, positions.data());
+        }
+    };
+
+    // cells x cells grid of cellSize m centred on the origin; blockedPercent of the cells is
+    // covered by round obstacles of 1-3 cells radius. The start/goal corners stay open.
+    inline void buildNavGrid(NavGrid &grid, int cells, float cellSize, uint32_t blockedPercent, uint32_t seed = 7)
+    {
+        const float half = 0.5f * static_cast<float>(cells) * cellSize;
+        grid.rebuild(cellSize, -half, -half, half, half);
+
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> u(-half, half);
+        std::uniform_real_distribution<float> r(1.0f, 3.0f);
+        const size_t target = grid.cellCount() * blockedPercent / 100u;
+        size_t blocked = 0;
+        while (blocked < target)
+        {
+            const float wx = u(rng), wz = u(rng);
+            grid.forEachObstacleCell(wx, wz, r(rng) * cellSize, [&](int cell)
+                                     {
+                                         if (!grid.isBlocked(cell))
+                                         {
+                                             grid.setBlocked(cell, true);
+                                             ++blocked;
+                                         } });
+        }
+
+        const int corner = std::max(2, cells / 16);
+        for (int gz = 0; gz < grid.height; ++gz)
+            for (int gx = 0; gx < grid.width; ++gx)
+                if ((gx < corner && gz < corner) || (gx >= grid.width - corner && gz >= grid.height - corner))
+                    grid.setBlocked(gz * grid.width + gx, false);
+        grid.updateClearance(0, 0, grid.width - 1, grid.height - 1);
+        grid.dirty = false;
+    }
+} // namespace EngineBench
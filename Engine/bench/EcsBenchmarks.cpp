@@ -0,0 +1,96 @@
+// Structural ECS primitives: row creation/removal, archetype moves and dirty-row consumption.
+// Args are {entities, density}; density only matters where rows are spread over space, the
+// others take a second argument for the share (percent) of rows touched per iteration.
+
+#include "BenchWorld.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <vector>
+
+using namespace Engine::ECS;
+
+namespace
+{
+    // createRow for every entity, then destroyRowSwap from the front (each removal swaps the
+    // last row in, the common case for despawns in the middle of a store).
+    void BM_ArchetypeStore_CreateDestroyRows(benchmark::State &state)
+    {
+        const uint32_t count = static_cast<uint32_t>(state.range(0));
+        EngineBench::BenchWorld world({"Position", "Velocity", "Facing", "Health", "Team", "Radius"});
+        ArchetypeStore &store = world.store();
+        std::vector<Entity> handles(count);
+        world.ecs.entities.create(handles.data(), count);
+        store.reserve(count);
+
+        for (auto _ : state)
+        {
+            for (uint32_t i = 0; i < count; ++i)
+                benchmark::DoNotOptimize(store.createRow(handles[i]));
+            while (store.size() > 0)
+                benchmark::DoNotOptimize(store.destroyRowSwap(0));
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * count * 2);
+    }
+    BENCHMARK(BM_ArchetypeStore_CreateDestroyRows)->ArgName("entities")->RangeMultiplier(8)->Range(512, 32768);
+
+    // moveEntity of a share of the rows to an archetype with one more component and back,
+    // which is what an AddComponent/RemoveComponent command costs at playback.
+    void BM_ECSContext_MoveEntity(benchmark::State &state)
+    {
+        const uint32_t count = static_cast<uint32_t>(state.range(0));
+        const uint32_t percent = static_cast<uint32_t>(state.range(1));
+        EngineBench::BenchWorld world({"Position", "Velocity", "Facing", "Health", "Team", "Radius"});
+        std::vector<Entity> handles(count);
+        world.spawn(count, 4);
+        {
+            const auto &entities = world.store().entities();
+            for (uint32_t i = 0; i < count; ++i)
+                handles[i] = entities[i];
+        }
+
+        const ComponentMask base = world.unit.signature;
+        ComponentMask tagged = base;
+        tagged.set(world.ecs.components.ensureId("Selected"));
+        const uint32_t step = 100u / (percent > 0 ? percent : 1u);
+        uint32_t moved = 0;
+
+        for (auto _ : state)
+        {
+            moved = 0;
+            for (uint32_t i = 0; i < count; i += step, ++moved)
+                world.ecs.moveEntity(handles[i], tagged);
+            for (uint32_t i = 0; i < count; i += step)
+                world.ecs.moveEntity(handles[i], base);
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * moved * 2);
+    }
+    BENCHMARK(BM_ECSContext_MoveEntity)->ArgNames({"entities", "percent"})->ArgsProduct({{1024, 8192, 32768}, {1, 10, 100}});
+
+    // markDirty on a share of the rows, then consumeDirtyRows, as a dirty-driven system sees it.
+    void BM_QueryManager_ConsumeDirtyRows(benchmark::State &state)
+    {
+        const uint32_t count = static_cast<uint32_t>(state.range(0));
+        const uint32_t percent = static_cast<uint32_t>(state.range(1));
+        EngineBench::BenchWorld world({"Position", "Velocity", "Facing", "Health"});
+        world.spawn(count, 4);
+
+        const uint32_t posId = world.ecs.components.ensureId("Position");
+        ComponentMask dirty;
+        dirty.set(posId);
+        const QueryId qid = world.ecs.queries.createDirtyQuery(world.unit.signature, ComponentMask{}, dirty, world.ecs.stores);
+        std::vector<uint32_t> rows;
+        world.ecs.queries.consumeDirtyRows(qid, world.archetypeId, rows); // spawn marks everything
+
+        const uint32_t step = 100u / (percent > 0 ? percent : 1u);
+        for (auto _ : state)
+        {
+            for (uint32_t row = 0; row < count; row += step)
+                world.ecs.markDirty(posId, world.archetypeId, row);
+            benchmark::DoNotOptimize(world.ecs.queries.consumeDirtyRows(qid, world.archetypeId, rows));
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * rows.size());
+    }
+    BENCHMARK(BM_QueryManager_ConsumeDirtyRows)->ArgNames({"entities", "percent"})->ArgsProduct({{1024, 8192, 65536}, {1, 10, 100}});
+} // namespace
@@ -0,0 +1,187 @@
+// CPU render-side kernels: skeletal pose evaluation and frustum sphere tests.
+
+#include "assets/ModelAsset.h"
+#include "Engine/Frustum.h"
+
+#include <benchmark/benchmark.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <bitset>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace
+{
+    // A humanoid-like hierarchy of nodeCount nodes (spine chain with limbs branching off every
+    // fourth node) and one looping clip with rotation keys on every node and translation keys
+    // on the root, all linear. keyCount keys per channel over a two second clip.
+    Engine::ModelAsset makeAnimatedModel(uint32_t nodeCount, uint32_t keyCount)
+    {
+        using Engine::ModelAsset;
+        namespace sm = Engine::smodel;
+        ModelAsset model;
+        model.nodes.resize(nodeCount);
+        std::vector<std::vector<uint32_t>> children(nodeCount);
+        for (uint32_t i = 1; i < nodeCount; ++i)
+        {
+            const uint32_t parent = (i % 4 == 0) ? (i / 4) : (i - 1);
+            model.nodes[i].parentIndex = parent;
+            children[parent].push_back(i);
+        }
+        for (uint32_t i = 0; i < nodeCount; ++i)
+        {
+            model.nodes[i].firstChildIndex = static_cast<uint32_t>(model.nodeChildIndices.size());
+            model.nodes[i].childCount = static_cast<uint32_t>(children[i].size());
+            model.nodeChildIndices.insert(model.nodeChildIndices.end(), children[i].begin(), children[i].end());
+            model.nodes[i].localMatrix = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.1f, 0.0f));
+        }
+        model.restTRS.assign(nodeCount, ModelAsset::NodeTRS{});
+        for (ModelAsset::NodeTRS &trs : model.restTRS)
+            trs.t = glm::vec3(0.0f, 0.1f, 0.0f);
+        model.buildEvaluationOrder();
+
+        std::mt19937 rng(11);
+        std::uniform_real_distribution<float> u(-1.0f, 1.0f);
+        auto addSampler = [&](uint32_t components)
+        {
+            sm::SModelAnimationSamplerRecord s{};
+            s.firstTime = static_cast<uint32_t>(model.animTimes.size());
+            s.timeCount = keyCount;
+            s.firstValue = static_cast<uint32_t>(model.animValues.size());
+            s.valueCount = keyCount * components;
+            s.interpolation = static_cast<uint8_t>(sm::SModelAnimInterpolation::Linear);
+            s.valueType = static_cast<uint8_t>(components == 4 ? sm::SModelAnimValueType::Quat : sm::SModelAnimValueType::Vec3);
+            for (uint32_t k = 0; k < keyCount; ++k)
+            {
+                model.animTimes.push_back(2.0f * static_cast<float>(k) / static_cast<float>(keyCount - 1));
+                if (components == 4)
+                {
+                    const glm::quat q = glm::normalize(glm::quat(1.0f, 0.2f * u(rng), 0.2f * u(rng), 0.2f * u(rng)));
+                    model.animValues.insert(model.animValues.end(), {q.x, q.y, q.z, q.w});
+                }
+                else
+                {
+                    model.animValues.insert(model.animValues.end(), {u(rng), 1.0f + 0.1f * u(rng), u(rng)});
+                }
+            }
+            model.animSamplers.push_back(s);
+            return static_cast<uint16_t>(model.animSamplers.size() - 1);
+        };
+
+        sm::SModelAnimationClipRecord clip{};
+        clip.durationSec = 2.0f;
+        clip.firstChannel = 0;
+        model.animChannels.push_back(sm::SModelAnimationChannelRecord{0u, static_cast<uint16_t>(sm::SModelAnimPath::Translation), addSampler(3)});
+        for (uint32_t i = 0; i < nodeCount; ++i)
+            model.animChannels.push_back(sm::SModelAnimationChannelRecord{i, static_cast<uint16_t>(sm::SModelAnimPath::Rotation), addSampler(4)});
+        clip.channelCount = static_cast<uint32_t>(model.animChannels.size());
+        model.animClips.push_back(clip);
+        return model;
+    }
+
+    // One pose per iteration, time advancing by a 30 Hz tick; with key cursors (arg 2 = 1) the
+    // sampler resumes from the previous key interval like PoseUpdateSystem instances do, and
+    // arg 3 = 1 interpolates rotations with the SIMD nlerp path instead of slerp.
+    void BM_ModelAsset_EvaluatePose(benchmark::State &state)
+    {
+        const uint32_t nodeCount = static_cast<uint32_t>(state.range(0));
+        const Engine::ModelAsset model = makeAnimatedModel(nodeCount, static_cast<uint32_t>(state.range(1)));
+        std::vector<Engine::ModelAsset::NodeTRS> trs;
+        std::vector<glm::mat4> locals, globals;
+        std::vector<uint8_t> visited;
+        std::vector<uint32_t> cursors(model.clipChannelCount(0), 0u);
+        uint32_t *keyCursors = state.range(2) ? cursors.data() : nullptr;
+        const Engine::ModelAsset::RotationSampling rotation =
+            state.range(3) ? Engine::ModelAsset::RotationSampling::Nlerp : Engine::ModelAsset::RotationSampling::Slerp;
+
+        float t = 0.0f;
+        for (auto _ : state)
+        {
+            model.evaluatePoseInto(0, t, trs, locals, globals, visited, keyCursors, rotation);
+            benchmark::DoNotOptimize(globals.data());
+            t += 1.0f / 30.0f;
+            if (t >= 2.0f)
+                t -= 2.0f;
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * nodeCount);
+    }
+    BENCHMARK(BM_ModelAsset_EvaluatePose)->ArgNames({"nodes", "keys", "cursors", "nlerp"})->ArgsProduct({{24, 64, 160}, {30, 300}, {0, 1}, {0, 1}});
+
+    // testSphere over count bounds scattered in front of a camera; density (percent) is the
+    // share of spheres inside the frustum, which sets how many planes an average test reads.
+    void BM_Frustum_TestSphere(benchmark::State &state)
+    {
+        const uint32_t count = static_cast<uint32_t>(state.range(0));
+        const float inside = static_cast<float>(state.range(1)) / 100.0f;
+        const glm::mat4 proj = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 500.0f);
+        const glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 40.0f, 0.0f), glm::vec3(0.0f, 0.0f, -100.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        const Engine::Frustum frustum = Engine::Frustum::fromViewProjection(proj * view);
+
+        std::mt19937 rng(13);
+        std::uniform_real_distribution<float> u(-600.0f, 600.0f);
+        std::uniform_real_distribution<float> near(-150.0f, -40.0f);
+        std::uniform_real_distribution<float> p(0.0f, 1.0f);
+        std::vector<glm::vec4> spheres(count);
+        for (glm::vec4 &s : spheres)
+        {
+            if (p(rng) < inside)
+                s = glm::vec4(0.2f * near(rng), 0.0f, near(rng), 1.0f);
+            else
+                s = glm::vec4(u(rng), 0.0f, 300.0f + 0.5f * std::abs(u(rng)), 1.0f); // behind the camera
+        }
+
+        for (auto _ : state)
+        {
+            uint32_t visible = 0;
+            for (const glm::vec4 &s : spheres)
+                visible += frustum.testSphere(glm::vec3(s), s.w) ? 1u : 0u;
+            benchmark::DoNotOptimize(visible);
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * count);
+    }
+    BENCHMARK(BM_Frustum_TestSphere)->ArgNames({"spheres", "inside"})->ArgsProduct({{1024, 16384, 131072}, {10, 50, 90}});
+
+    // Same scene as BM_Frustum_TestSphere, stored as SoA lanes and tested eight at a time.
+    void BM_Frustum_TestSpheres8(benchmark::State &state)
+    {
+        const uint32_t count = static_cast<uint32_t>(state.range(0)) & ~7u;
+        const float inside = static_cast<float>(state.range(1)) / 100.0f;
+        const glm::mat4 proj = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 500.0f);
+        const glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 40.0f, 0.0f), glm::vec3(0.0f, 0.0f, -100.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        const Engine::Frustum frustum = Engine::Frustum::fromViewProjection(proj * view);
+
+        std::mt19937 rng(13);
+        std::uniform_real_distribution<float> u(-600.0f, 600.0f);
+        std::uniform_real_distribution<float> near(-150.0f, -40.0f);
+        std::uniform_real_distribution<float> p(0.0f, 1.0f);
+        std::vector<float> cx(count), cy(count, 0.0f), cz(count), r(count, 1.0f);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            if (p(rng) < inside)
+            {
+                cx[i] = 0.2f * near(rng);
+                cz[i] = near(rng);
+            }
+            else
+            {
+                cx[i] = u(rng);
+                cz[i] = 300.0f + 0.5f * std::abs(u(rng));
+            }
+        }
+
+        for (auto _ : state)
+        {
+            uint32_t visible = 0;
+            for (uint32_t i = 0; i < count; i += 8u)
+                visible += static_cast<uint32_t>(std::bitset<8>(frustum.testSpheres8(&cx[i], &cy[i], &cz[i], &r[i])).count());
+            benchmark::DoNotOptimize(visible);
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * count);
+    }
+    BENCHMARK(BM_Frustum_TestSpheres8)->ArgNames({"spheres", "inside"})->ArgsProduct({{1024, 16384, 131072}, {10, 50, 90}});
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,152 @@
+// Spatial and navigation kernels: SpatialIndexSystem updates, NavGrid::lineCheck and single
+// flat / hierarchical searches through PathfindingSystem.
+
+#include "BenchWorld.h"
+
+#include "ECS/systems/PathfindingSystem.h"
+#include "ECS/systems/SpatialIndexSystem.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace Engine::ECS;
+
+namespace
+{
+    constexpr float GRID_CELL_SIZE = 4.0f; // SystemRunner's spatial cell size for sample units
+
+    // Full rebuild of both layers (setIncremental(false), the worst case after a mass move).
+    void BM_SpatialIndex_FullRebuild(benchmark::State &state)
+    {
+        const uint32_t count = static_cast<uint32_t>(state.range(0));
+        EngineBench::BenchWorld world({"Position", "Velocity", "Radius", "Team"});
+        world.spawn(count, static_cast<uint32_t>(state.range(1)));
+        SpatialIndexSystem grid(GRID_CELL_SIZE);
+        grid.buildMasks(world.ecs.components);
+        grid.setIncremental(false);
+
+        for (auto _ : state)
+        {
+            world.ecs.advanceChangeVersion();
+            grid.update(world.ecs, 1.0f / 30.0f);
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * count);
+    }
+    BENCHMARK(BM_SpatialIndex_FullRebuild)->ArgNames({"entities", "density"})->ArgsProduct({{1024, 8192, 65536}, {1, 16}});
+
+    // Incremental update with a tenth of the units moving about half a cell per tick.
+    void BM_SpatialIndex_IncrementalTick(benchmark::State &state)
+    {
+        const uint32_t count = static_cast<uint32_t>(state.range(0));
+        EngineBench::BenchWorld world({"Position", "Velocity", "Radius", "Team"});
+        world.spawn(count, static_cast<uint32_t>(state.range(1)));
+        SpatialIndexSystem grid(GRID_CELL_SIZE);
+        grid.buildMasks(world.ecs.components);
+        grid.update(world.ecs, 1.0f / 30.0f);
+
+        const uint32_t posId = world.ecs.components.ensureId("Position");
+        std::mt19937 rng(5);
+        std::uniform_real_distribution<float> step(-0.5f * GRID_CELL_SIZE, 0.5f * GRID_CELL_SIZE);
+        for (auto _ : state)
+        {
+            state.PauseTiming();
+            auto positions = world.store().positions();
+            for (uint32_t row = 0; row < count; row += 10)
+            {
+                positions[row].x += step(rng);
+                positions[row].z += step(rng);
+                world.ecs.markDirty(posId, world.archetypeId, row);
+            }
+            world.ecs.advanceChangeVersion();
+            state.ResumeTiming();
+
+            grid.update(world.ecs, 1.0f / 30.0f);
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * (count / 10u));
+    }
+    BENCHMARK(BM_SpatialIndex_IncrementalTick)->ArgNames({"entities", "density"})->ArgsProduct({{1024, 8192, 65536}, {1, 16}});
+
+    // World-space line checks of random direction and the given length over a grid with the
+    // given share of blocked cells.
+    void BM_NavGrid_LineCheck(benchmark::State &state)
+    {
+        const int lengthCells = static_cast<int>(state.range(0));
+        NavGrid nav;
+        EngineBench::buildNavGrid(nav, 512, 2.0f, static_cast<uint32_t>(state.range(1)));
+
+        constexpr uint32_t LINES = 1024;
+        std::mt19937 rng(3);
+        const float half = 0.5f * 512 * 2.0f;
+        const float len = static_cast<float>(lengthCells) * nav.cellSize;
+        std::uniform_real_distribution<float> u(-half + len, half - len);
+        std::uniform_real_distribution<float> a(0.0f, 6.2831853f);
+        std::vector<float> lines(LINES * 4);
+        for (uint32_t i = 0; i < LINES; ++i)
+        {
+            const float x = u(rng), z = u(rng), t = a(rng);
+            lines[i * 4 + 0] = x;
+            lines[i * 4 + 1] = z;
+            lines[i * 4 + 2] = x + std::cos(t) * len;
+            lines[i * 4 + 3] = z + std::sin(t) * len;
+        }
+
+        for (auto _ : state)
+        {
+            uint32_t clear = 0;
+            for (uint32_t i = 0; i < LINES; ++i)
+                clear += nav.lineCheck(lines[i * 4], lines[i * 4 + 1], lines[i * 4 + 2], lines[i * 4 + 3]) ? 1u : 0u;
+            benchmark::DoNotOptimize(clear);
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * LINES);
+    }
+    BENCHMARK(BM_NavGrid_LineCheck)->ArgNames({"cells", "blocked"})->ArgsProduct({{8, 64, 256}, {0, 10, 30}});
+
+    // One corner-to-corner plan per iteration: a single unit gets its MoveTarget re-issued and
+    // PathfindingSystem plans it in the same update (deterministic mode, no cache). Arg 2
+    // selects flat A* (0) or the cluster hierarchy (1).
+    void BM_Pathfinding_SinglePlan(benchmark::State &state)
+    {
+        const int cells = static_cast<int>(state.range(0));
+        NavGrid nav;
+        EngineBench::buildNavGrid(nav, cells, 2.0f, static_cast<uint32_t>(state.range(1)));
+
+        EngineBench::BenchWorld world({"Position", "MoveTarget", "Path"});
+        const float corner = 0.5f * static_cast<float>(cells) * nav.cellSize - 2.0f * nav.cellSize;
+        const Position start{-corner, 0.0f, -corner};
+        Engine::ECS::spawnBatch(world.unit, world.ecs, 1, &start);
+
+        PathfindingSystem pf(&nav);
+        pf.buildMasks(world.ecs.components);
+        pf.setDeterministic(true);
+        pf.setPathCaching(false);
+        pf.setFlowFields(false);
+        pf.setHierarchical(state.range(2) != 0);
+
+        const uint32_t moveTargetId = world.ecs.components.ensureId("MoveTarget");
+        auto plan = [&]()
+        {
+            ArchetypeStore &store = world.store();
+            store.positions()[0] = start;
+            store.moveTargets()[0] = MoveTarget{corner, 0.0f, corner, 1u, 1u};
+            world.ecs.markDirty(moveTargetId, world.archetypeId, 0);
+            pf.update(world.ecs, 1.0f / 30.0f);
+        };
+        plan(); // builds the hierarchy outside the timed loop
+
+        uint32_t planned = 0;
+        uint32_t waypoints = 0;
+        for (auto _ : state)
+        {
+            plan();
+            planned += pf.lastStats().plansCompleted;
+            waypoints = world.store().paths()[0].count;
+        }
+        state.counters["plans/iter"] = benchmark::Counter(static_cast<double>(planned) / static_cast<double>(state.iterations()));
+        state.counters["waypoints"] = static_cast<double>(waypoints);
+    }
+    BENCHMARK(BM_Pathfinding_SinglePlan)->ArgNames({"cells", "blocked", "hpa"})->ArgsProduct({{64, 256}, {0, 20}, {0, 1}})->Unit(benchmark::kMicrosecond);
+} // namespace
@@ -4,7 +4,8 @@
   ------------------
   Purpose:
     - Maintain a registry of archetypes keyed by component signature (ComponentMask).
-    - Assign and look up an archetype ID for each unique signature.
+    - Assign and look up an archetype ID for each unique signature (hashed on the mask's raw
+      words, so tag transitions in ECSContext::moveEntity don't build string keys).
 
   Usage:
     - uint32_t id = manager.getOrCreate(signature);
@@ -14,7 +15,6 @@
 #include <unordered_map>
 #include <vector>
 #include <cstdint>
-#include <string>
 #include "ECS/Components.h"
 
 namespace Engine::ECS
@@ -31,13 +31,12 @@ namespace Engine::ECS
         // Returns existing ID for signature or creates a new archetype and returns its ID.
         uint32_t getOrCreate(const ComponentMask &signature)
         {
-            const std::string key = signature.toKey();
-            auto it = m_keyToId.find(key);
+            auto it = m_keyToId.find(signature);
             if (it != m_keyToId.end())
                 return it->second;
 
             const uint32_t id = static_cast<uint32_t>(m_archetypes.size());
-            m_keyToId.emplace(key, id);
+            m_keyToId.emplace(signature, id);
             m_archetypes.push_back(Archetype{id, signature});
             return id;
         }
@@ -49,7 +48,7 @@ namespace Engine::ECS
         }
 
     private:
-        std::unordered_map<std::string, uint32_t> m_keyToId;
+        std::unordered_map<ComponentMask, uint32_t, ComponentMaskHash> m_keyToId;
         std::vector<Archetype> m_archetypes;
     };
 
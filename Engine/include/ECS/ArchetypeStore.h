@@ -4,88 +4,186 @@
   ----------------
   Purpose:
     - Provide a generic Struct-of-Arrays store for a single archetype (signature).
-    - Conditionally hold arrays for components present in the signature (Position, Velocity, Health).
+    - Hold one ComponentColumn per component of the signature that has a registered type
+      (ComponentRegistry::registerType); tags have no column.
     - Support creation of rows with defaults, destruction via swap-remove, and per-row masks.
+    - Row create/destroy/move walk the store's columns (O(components in signature)); trivially
+      copyable components are moved with memcpy.
+
+  Chunks:
+    - Rows live in fixed-size chunks (ChunkPool::CHUNK_BYTES) holding every column for a
+      power-of-two number of rows, so growing never reallocates or copies existing rows, and
+      emptied chunks go back to the pool.
+    - Each chunk starts with one change version per column (markChanged, stamped with the
+      world version on row creation and ECSContext::markDirty), so full-scan systems can skip
+      chunks nobody touched since they last ran (chunkChangedSince).
+    - The store keeps the same per column over all its chunks (columnChangedSince), so a
+      "changed since version N" scan rejects an untouched archetype without visiting its chunks.
+    - Chunks also serve as cache-sized work items (ECSContext::forEachChunk).
 
   Usage:
     - Construct with a signature.
-    - resolveKnownComponents(registry) to enable arrays for known components.
-    - createRow(entity) then applyDefaults(row, defaults, registry).
+    - resolveKnownComponents(registry) to create the columns.
+    - createRow(entity) then applyDefaults(row, defaults, registry); or, for many rows,
+      compileDefaults(defaults, fills) once (or compileDefaults(prefab.image, prefab.defaults, fills)
+      for a compiled prefab), then createRows(entities, count) + fillDefaults.
     - destroyRow(row) with dense packing.
+    - permuteRows(order) reorders every row in place (ECSContext::reorderRows patches the
+      entity records and dirty bits around it).
+    - Engine components have named accessors (positions(), paths(), ...); any registered type is
+      reachable through column<T>(componentId).
+    - Stores with VisibilityState also keep two bitsets, bit (row & 63) of word row >> 6:
+      visible and visible-last-frame. VisibilityCullingSystem writes them; readers test
+      rowVisible(row) or scan visibleBits() a word (64 rows) at a time. They follow rows
+      through createRow/destroyRowSwap/permuteRows like a column and start cleared.
 */
 
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
 #include <vector>
 #include <unordered_map>
 #include <memory>
 #include <variant>
 #include <limits>
 #include <functional>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#include "ECS/ChunkPool.h"
 #include "ECS/Components.h"
+#include "ECS/ComponentColumn.h"
 #include "ECS/Entity.h"
+#include "ECS/PrefabImage.h"
 
 namespace Engine::ECS
 {
+    // Bit scans for the visibility words (and similar 64-row masks).
+    inline uint32_t popcount64(uint64_t word)
+    {
+#ifdef _MSC_VER
+        return static_cast<uint32_t>(__popcnt64(word));
+#else
+        return static_cast<uint32_t>(__builtin_popcountll(word));
+#endif
+    }
+
+    // Index of the lowest set bit; word != 0.
+    inline uint32_t ctz64(uint64_t word)
+    {
+#ifdef _MSC_VER
+        unsigned long idx;
+        _BitScanForward64(&idx, word);
+        return static_cast<uint32_t>(idx);
+#else
+        return static_cast<uint32_t>(__builtin_ctzll(word));
+#endif
+    }
+
     class ArchetypeStore
     {
     public:
-        explicit ArchetypeStore(const ComponentMask &signature)
-            : m_signature(signature) {}
+        // =====================
+        // TUNING CONSTANTS
+        // =====================
+        static constexpr uint32_t MAX_CHUNK_SHIFT = 10; // at most 1024 rows per chunk (tag-only stores)
+
+        // pool: shared chunk pool (not owned); the store keeps a private one when null.
+        explicit ArchetypeStore(const ComponentMask &signature, ChunkPool *pool = nullptr)
+            : m_signature(signature), m_pool(pool)
+        {
+            if (!m_pool)
+            {
+                m_ownPool = std::make_unique<ChunkPool>();
+                m_pool = m_ownPool.get();
+            }
+        }
+
+        ~ArchetypeStore()
+        {
+            for (uint32_t row = 0; row < m_table.rows; ++row)
+            {
+                for (ComponentColumn &column : m_columns)
+                    column.destroyAt(row);
+            }
+            while (!m_table.chunks.empty())
+                releaseLastChunk();
+        }
+
+        // Views and columns point at m_table.
+        ArchetypeStore(const ArchetypeStore &) = delete;
+        ArchetypeStore &operator=(const ArchetypeStore &) = delete;
 
         // Create a new row for the given entity; returns row index.
         uint32_t createRow(Entity e)
         {
-            const uint32_t row = static_cast<uint32_t>(m_entities.size());
+            const uint32_t row = m_table.rows;
             m_entities.emplace_back(e);
+            ++m_structuralVersion;
 
-            // Conditionally create per-component entries based on signature bits.
-            if (hasPosition())
-                m_positions.emplace_back(Position{});
-            if (hasVelocity())
-                m_velocities.emplace_back(Velocity{});
-            if (hasHealth())
-                m_healths.emplace_back(Health{100.f});
-            if (hasMoveTarget())
-                m_moveTargets.emplace_back(MoveTarget{});
-            if (hasMoveSpeed())
-                m_moveSpeeds.emplace_back(MoveSpeed{});
-            if (hasRadius())
-                m_radii.emplace_back(Radius{});
-            if (hasSeparation())
-                m_separations.emplace_back(Separation{});
-            if (hasAvoidanceParams())
-                m_avoidanceParams.emplace_back(AvoidanceParams{});
-            if (hasRenderModel())
-                m_renderModels.emplace_back(RenderModel{});
-            if (hasLocomotionClips())
-                m_locomotionClips.emplace_back(LocomotionClips{});
-            if (hasCombatClips())
-                m_combatClips.emplace_back(CombatClips{});
-            if (hasRenderAnimation())
-                m_renderAnimations.emplace_back(RenderAnimation{});
-            if (hasFacing())
-                m_facings.emplace_back(Facing{});
-            if (hasRenderTransform())
-                m_renderTransforms.emplace_back(RenderTransform{});
-            if (hasRenderScale())
-                m_renderScales.emplace_back(RenderScale{});
-            if (hasObstacleRadius())
-                m_obstacleRadii.emplace_back(ObstacleRadius{});
-            if (hasPath())
-                m_paths.emplace_back(Path{});
-            if (hasPosePalette())
-                m_posePalettes.emplace_back(PosePalette{});
-            if (hasTeam())
-                m_teams.emplace_back(Team{});
-            if (hasAttackCooldown())
-                m_attackCooldowns.emplace_back(AttackCooldown{});
-            if (hasRenderBounds())
-                m_renderBounds.emplace_back(RenderBounds{});
-            if (hasVisibilityState())
-                m_visibilityState.emplace_back(VisibilityState{});
+            if (row == static_cast<uint32_t>(m_table.chunks.size()) << m_table.shift)
+                addChunk();
+            for (ComponentColumn &column : m_columns)
+                column.constructAt(row);
+            ++m_table.rows;
+            stampChunk(row >> m_table.shift);
+            resizeVisibility();
 
             return row;
         }
 
+        // Append count rows, one per entities[i]; returns the first row. Chunks are added and
+        // stamped once each, and columns are constructed one after another.
+        uint32_t createRows(const Entity *entities, uint32_t count)
+        {
+            const uint32_t first = m_table.rows;
+            if (count == 0)
+                return first;
+            const uint32_t end = first + count;
+            m_entities.insert(m_entities.end(), entities, entities + count);
+            ++m_structuralVersion;
+
+            while ((static_cast<uint32_t>(m_table.chunks.size()) << m_table.shift) < end)
+                addChunk();
+            for (ComponentColumn &column : m_columns)
+            {
+                for (uint32_t row = first; row < end; ++row)
+                    column.constructAt(row);
+            }
+            m_table.rows = end;
+            for (uint32_t c = first >> m_table.shift; c <= ((end - 1u) >> m_table.shift); ++c)
+                stampChunk(c);
+            resizeVisibility();
+
+            return first;
+        }
+
+        // Make room for count more rows' entity handles (chunks are still added as rows arrive).
+        void reserve(uint32_t count) { m_entities.reserve(m_entities.size() + count); }
+
+        // Pre-size for rows rows in total (ECSContext::reserve): entity handles, the chunk table,
+        // chunks parked in the pool and visibility words, so growing to it neither reallocates
+        // nor allocates chunks. Systems size their per-store buffers from reservedRows().
+        void reserveRows(uint32_t rows)
+        {
+            const uint32_t before = chunksFor(std::max(m_reservedRows, m_table.rows));
+            m_reservedRows = std::max(m_reservedRows, rows);
+            const uint32_t after = chunksFor(m_reservedRows);
+            m_entities.reserve(m_reservedRows);
+            m_table.chunks.reserve(after);
+            if (after > before)
+                m_pool->reserve(after - before);
+            if (m_builtin[BuiltinVisibilityState])
+            {
+                const size_t words = (static_cast<size_t>(m_reservedRows) + 63u) >> 6;
+                m_visibleBits.reserve(words);
+                m_wasVisibleBits.reserve(words);
+            }
+        }
+        uint32_t reservedRows() const { return std::max(m_reservedRows, m_table.rows); }
+
         // Swap-remove a row; maintains dense arrays.
         // Returns the entity that was moved into 'row' (the previous last entity) when row!=last.
         // Returns an invalid entity when the removed row was already the last row, or if row was out of range.
@@ -100,59 +198,27 @@ namespace Engine::ECS
             Entity moved{};
             if (row != last)
                 moved = m_entities[last];
+            ++m_structuralVersion;
 
-            auto swapErase = [&](auto &vec)
+            if (row != last)
+                m_entities[row] = m_entities[last];
+            m_entities.pop_back();
+            for (ComponentColumn &column : m_columns)
+                column.swapRemove(row, last);
+            m_table.rows = last;
+            if (!m_visibleBits.empty())
             {
-                if (row != last)
-                    vec[row] = std::move(vec[last]);
-                vec.pop_back();
-            };
+                copyBit(m_visibleBits.data(), row, last);
+                copyBit(m_wasVisibleBits.data(), row, last);
+                resizeVisibility();
+            }
+            if (row != last)
+                stampChunk(row >> m_table.shift);
 
-            swapErase(m_entities);
-            if (hasPosition())
-                swapErase(m_positions);
-            if (hasVelocity())
-                swapErase(m_velocities);
-            if (hasHealth())
-                swapErase(m_healths);
-            if (hasMoveTarget())
-                swapErase(m_moveTargets);
-            if (hasMoveSpeed())
-                swapErase(m_moveSpeeds);
-            if (hasRadius())
-                swapErase(m_radii);
-            if (hasSeparation())
-                swapErase(m_separations);
-            if (hasAvoidanceParams())
-                swapErase(m_avoidanceParams);
-            if (hasRenderModel())
-                swapErase(m_renderModels);
-            if (hasLocomotionClips())
-                swapErase(m_locomotionClips);
-            if (hasCombatClips())
-                swapErase(m_combatClips);
-            if (hasRenderAnimation())
-                swapErase(m_renderAnimations);
-            if (hasFacing())
-                swapErase(m_facings);
-            if (hasRenderTransform())
-                swapErase(m_renderTransforms);
-            if (hasRenderScale())
-                swapErase(m_renderScales);
-            if (hasObstacleRadius())
-                swapErase(m_obstacleRadii);
-            if (hasPath())
-                swapErase(m_paths);
-            if (hasPosePalette())
-                swapErase(m_posePalettes);
-            if (hasTeam())
-                swapErase(m_teams);
-            if (hasAttackCooldown())
-                swapErase(m_attackCooldowns);
-            if (hasRenderBounds())
-                swapErase(m_renderBounds);
-            if (hasVisibilityState())
-                swapErase(m_visibilityState);
+            // Keep one empty chunk as slack so a store oscillating at a boundary doesn't churn.
+            const size_t needed = (static_cast<size_t>(m_table.rows) + m_table.mask) >> m_table.shift;
+            while (m_table.chunks.size() > needed + 1u)
+                releaseLastChunk();
 
             return moved;
         }
@@ -163,103 +229,166 @@ namespace Engine::ECS
             (void)destroyRowSwap(row);
         }
 
+        // Move every component this store shares with src from src's srcRow into dstRow
+        // (ECSContext::moveEntity; src's row is destroyed right after).
+        void moveRowFrom(uint32_t dstRow, ArchetypeStore &src, uint32_t srcRow)
+        {
+            for (ComponentColumn &column : m_columns)
+            {
+                if (ComponentColumn *from = src.findColumn(column.componentId()))
+                    column.moveFrom(dstRow, *from, srcRow);
+            }
+            if (!m_visibleBits.empty() && !src.m_visibleBits.empty())
+            {
+                setBit(m_visibleBits.data(), dstRow, src.rowVisible(srcRow));
+                setBit(m_wasVisibleBits.data(), dstRow, src.rowWasVisible(srcRow));
+            }
+        }
+
+        // Reorder all rows: new row i holds what row order[i] held. order is a permutation of
+        // [0, size()). Each column is walked once per cycle of the permutation with a single
+        // element of scratch, so nothing is reallocated; every chunk counts as changed.
+        void permuteRows(const uint32_t *order)
+        {
+            const uint32_t n = size();
+            if (n < 2u)
+                return;
+
+            // Cycles of the permutation, flattened: row cycle[j] takes row order[cycle[j]].
+            m_permuteCycles.clear();
+            m_permuteCycleEnds.clear();
+            m_permuteVisited.assign(n, 0u);
+            for (uint32_t start = 0; start < n; ++start)
+            {
+                if (m_permuteVisited[start] || order[start] == start)
+                    continue;
+                for (uint32_t row = start; !m_permuteVisited[row]; row = order[row])
+                {
+                    m_permuteVisited[row] = 1u;
+                    m_permuteCycles.push_back(row);
+                }
+                m_permuteCycleEnds.push_back(static_cast<uint32_t>(m_permuteCycles.size()));
+            }
+            if (m_permuteCycles.empty())
+                return;
+
+            m_permuteEntities.resize(n);
+            for (uint32_t i = 0; i < n; ++i)
+                m_permuteEntities[i] = m_entities[order[i]];
+            m_entities.swap(m_permuteEntities);
+
+            for (ComponentColumn &column : m_columns)
+            {
+                const size_t words = (column.type().size + sizeof(std::max_align_t) - 1u) / sizeof(std::max_align_t);
+                if (m_permuteTemp.size() < words)
+                    m_permuteTemp.resize(words);
+                uint32_t begin = 0;
+                for (uint32_t end : m_permuteCycleEnds)
+                {
+                    column.rotateCycle(m_permuteCycles.data() + begin, end - begin, m_permuteTemp.data());
+                    begin = end;
+                }
+            }
+            if (!m_visibleBits.empty())
+            {
+                permuteBits(m_visibleBits, order, n);
+                permuteBits(m_wasVisibleBits, order, n);
+            }
+
+            ++m_structuralVersion;
+            for (uint32_t c = 0; c < static_cast<uint32_t>(m_table.chunks.size()); ++c)
+                stampChunk(c);
+        }
+
         // Apply typed defaults for a newly created row.
         void applyDefaults(uint32_t row, const std::unordered_map<uint32_t, DefaultValue> &defaults,
                            const ComponentRegistry & /*registry*/)
         {
             for (const auto &kv : defaults)
             {
-                const uint32_t cid = kv.first;
-                if (!m_signature.has(cid))
+                ComponentColumn *column = findColumn(kv.first);
+                if (!column)
                     continue;
+                std::visit([&](const auto &value)
+                           {
+                               using T = std::decay_t<decltype(value)>;
+                               if (column->type().typeKey == componentTypeKey<T>())
+                                   *static_cast<T *>(column->at(row)) = value; },
+                           kv.second);
+            }
+        }
 
-                if (std::holds_alternative<Position>(kv.second) && hasPosition())
-                {
-                    m_positions[row] = std::get<Position>(kv.second);
-                }
-                else if (std::holds_alternative<Velocity>(kv.second) && hasVelocity())
-                {
-                    m_velocities[row] = std::get<Velocity>(kv.second);
-                }
-                else if (std::holds_alternative<Health>(kv.second) && hasHealth())
-                {
-                    m_healths[row] = std::get<Health>(kv.second);
-                }
-                else if (std::holds_alternative<MoveTarget>(kv.second) && hasMoveTarget())
-                {
-                    m_moveTargets[row] = std::get<MoveTarget>(kv.second);
-                }
-                else if (std::holds_alternative<MoveSpeed>(kv.second) && hasMoveSpeed())
-                {
-                    m_moveSpeeds[row] = std::get<MoveSpeed>(kv.second);
-                }
-                else if (std::holds_alternative<Radius>(kv.second) && hasRadius())
-                {
-                    m_radii[row] = std::get<Radius>(kv.second);
-                }
-                else if (std::holds_alternative<Separation>(kv.second) && hasSeparation())
-                {
-                    m_separations[row] = std::get<Separation>(kv.second);
-                }
-                else if (std::holds_alternative<AvoidanceParams>(kv.second) && hasAvoidanceParams())
-                {
-                    m_avoidanceParams[row] = std::get<AvoidanceParams>(kv.second);
-                }
-                else if (std::holds_alternative<RenderModel>(kv.second) && hasRenderModel())
-                {
-                    m_renderModels[row] = std::get<RenderModel>(kv.second);
-                }
-                else if (std::holds_alternative<LocomotionClips>(kv.second) && hasLocomotionClips())
-                {
-                    m_locomotionClips[row] = std::get<LocomotionClips>(kv.second);
-                }
-                else if (std::holds_alternative<CombatClips>(kv.second) && hasCombatClips())
-                {
-                    m_combatClips[row] = std::get<CombatClips>(kv.second);
-                }
-                else if (std::holds_alternative<RenderAnimation>(kv.second) && hasRenderAnimation())
-                {
-                    m_renderAnimations[row] = std::get<RenderAnimation>(kv.second);
-                }
-                else if (std::holds_alternative<Facing>(kv.second) && hasFacing())
-                {
-                    m_facings[row] = std::get<Facing>(kv.second);
-                }
-                else if (std::holds_alternative<RenderTransform>(kv.second) && hasRenderTransform())
-                {
-                    m_renderTransforms[row] = std::get<RenderTransform>(kv.second);
-                }
-                else if (std::holds_alternative<RenderScale>(kv.second) && hasRenderScale())
-                {
-                    m_renderScales[row] = std::get<RenderScale>(kv.second);
-                }
-                else if (std::holds_alternative<ObstacleRadius>(kv.second) && hasObstacleRadius())
-                {
-                    m_obstacleRadii[row] = std::get<ObstacleRadius>(kv.second);
-                }
-                else if (std::holds_alternative<Path>(kv.second) && hasPath())
-                {
-                    m_paths[row] = std::get<Path>(kv.second);
-                }
-                else if (std::holds_alternative<PosePalette>(kv.second) && hasPosePalette())
-                {
-                    m_posePalettes[row] = std::get<PosePalette>(kv.second);
-                }
-                else if (std::holds_alternative<Team>(kv.second) && hasTeam())
-                {
-                    m_teams[row] = std::get<Team>(kv.second);
-                }
-                else if (std::holds_alternative<AttackCooldown>(kv.second) && hasAttackCooldown())
-                {
-                    m_attackCooldowns[row] = std::get<AttackCooldown>(kv.second);
-                }
-                else if (std::holds_alternative<RenderBounds>(kv.second) && hasRenderBounds())
-                {
-                    m_renderBounds[row] = std::get<RenderBounds>(kv.second);
-                }
-                else if (std::holds_alternative<VisibilityState>(kv.second) && hasVisibilityState())
+        // A default resolved to its column: every new row gets a copy of *value.
+        struct DefaultFill
+        {
+            ComponentColumn *column = nullptr;
+            const void *value = nullptr; // points into the defaults map it was compiled from
+        };
+
+        // Resolve defaults to this store's columns once, for fillDefaults over many rows.
+        void compileDefaults(const std::unordered_map<uint32_t, DefaultValue> &defaults, std::vector<DefaultFill> &out)
+        {
+            out.clear();
+            for (const auto &kv : defaults)
+            {
+                ComponentColumn *column = findColumn(kv.first);
+                if (!column)
+                    continue;
+                std::visit([&](const auto &value)
+                           {
+                               using T = std::decay_t<decltype(value)>;
+                               if (column->type().typeKey == componentTypeKey<T>())
+                                   out.push_back(DefaultFill{column, &value}); },
+                           kv.second);
+            }
+        }
+
+        // Same, from a compiled prefab: image entries point into image.bytes; only the ids in
+        // image.variantIds are visited in defaults.
+        void compileDefaults(const PrefabImage &image, const std::unordered_map<uint32_t, DefaultValue> &defaults,
+                             std::vector<DefaultFill> &out)
+        {
+            out.clear();
+            for (const PrefabImage::Entry &entry : image.entries)
+            {
+                ComponentColumn *column = findColumn(entry.componentId);
+                if (column && column->type().typeKey == entry.typeKey)
+                    out.push_back(DefaultFill{column, image.value(entry)});
+            }
+            for (uint32_t componentId : image.variantIds)
+            {
+                ComponentColumn *column = findColumn(componentId);
+                auto it = defaults.find(componentId);
+                if (!column || it == defaults.end())
+                    continue;
+                std::visit([&](const auto &value)
+                           {
+                               using T = std::decay_t<decltype(value)>;
+                               if (column->type().typeKey == componentTypeKey<T>())
+                                   out.push_back(DefaultFill{column, &value}); },
+                           it->second);
+            }
+        }
+
+        // Copy compiled defaults into rows [first, first + count), one column and chunk run at a time.
+        void fillDefaults(uint32_t first, uint32_t count, const std::vector<DefaultFill> &fills)
+        {
+            const uint32_t end = first + count;
+            for (const DefaultFill &fill : fills)
+            {
+                const ComponentTypeInfo &type = fill.column->type();
+                for (uint32_t row = first; row < end;)
                 {
-                    m_visibilityState[row] = std::get<VisibilityState>(kv.second);
+                    const uint32_t runEnd = std::min(end, ((row >> m_table.shift) + 1u) << m_table.shift);
+                    std::byte *dst = static_cast<std::byte *>(fill.column->at(row));
+                    for (uint32_t k = 0; k < runEnd - row; ++k, dst += type.size)
+                    {
+                        if (type.trivial)
+                            std::memcpy(dst, fill.value, type.size);
+                        else
+                            type.copyAssign(dst, fill.value);
+                    }
+                    row = runEnd;
                 }
             }
         }
@@ -268,209 +397,449 @@ namespace Engine::ECS
         const ComponentMask &signature() const { return m_signature; }
         uint32_t size() const { return static_cast<uint32_t>(m_entities.size()); }
 
+        // Bumped on every createRow/destroyRowSwap/permuteRows. Caches keyed by row can compare it to
+        // detect that rows were added, removed or swap-moved since they were built.
+        uint32_t structuralVersion() const { return m_structuralVersion; }
+
         const std::vector<Entity> &entities() const { return m_entities; }
 
-        // Component arrays (conditionally enabled).
-        std::vector<Position> &positions() { return m_positions; }
-        const std::vector<Position> &positions() const { return m_positions; }
+        // Visibility bitsets (empty without VisibilityState): bit (row & 63) of word row >> 6, zero
+        // past size(). Written by VisibilityCullingSystem only, one whole word per lane.
+        uint32_t visibilityWordCount() const { return static_cast<uint32_t>(m_visibleBits.size()); }
+        uint64_t *visibleBits() { return m_visibleBits.data(); }
+        const uint64_t *visibleBits() const { return m_visibleBits.data(); }
+        uint64_t *wasVisibleBits() { return m_wasVisibleBits.data(); }
+        const uint64_t *wasVisibleBits() const { return m_wasVisibleBits.data(); }
+        bool rowVisible(uint32_t row) const { return (m_visibleBits[row >> 6] >> (row & 63u)) & 1u; }
+        bool rowWasVisible(uint32_t row) const { return (m_wasVisibleBits[row >> 6] >> (row & 63u)) & 1u; }
+        // fn(row) for every visible row of [first, last), ascending, skipping 64 hidden rows per word.
+        template <typename Fn>
+        void forEachVisibleRow(uint32_t first, uint32_t last, Fn &&fn) const
+        {
+            if (first >= last || m_visibleBits.empty())
+                return;
+            const uint32_t lastWord = (last - 1u) >> 6;
+            for (uint32_t w = first >> 6; w <= lastWord; ++w)
+            {
+                uint64_t word = m_visibleBits[w];
+                if (w == (first >> 6))
+                    word &= ~uint64_t{0} << (first & 63u);
+                if (w == lastWord && (last & 63u) != 0u)
+                    word &= (uint64_t{1} << (last & 63u)) - 1u;
+                for (; word != 0u; word &= word - 1u)
+                    fn((w << 6) + ctz64(word));
+            }
+        }
+        // Culling frame the bits were last computed for (VisibilityState::visibleFrame of visible rows).
+        uint32_t visibilityTestFrame() const { return m_visibilityTestFrame; }
+        void setVisibilityTestFrame(uint32_t frame) { m_visibilityTestFrame = frame; }
+
+        // Chunks: rows [c * chunkCapacity(), + chunkRows(c)) live in chunk c.
+        uint32_t chunkCount() const { return static_cast<uint32_t>(m_table.chunks.size()); }
+        uint32_t chunkCapacity() const { return m_table.capacity(); }
+        uint32_t chunkRows(uint32_t chunk) const { return m_table.rowsInChunk(chunk); }
+        uint32_t chunkOfRow(uint32_t row) const { return row >> m_table.shift; }
+
+        // Record that componentId of row changed (ECSContext::markDirty). Safe from parallel lanes.
+        void markChanged(uint32_t componentId, uint32_t row)
+        {
+            const ComponentColumn *c = findColumn(componentId);
+            if (!c || row >= m_table.rows)
+                return;
+            const uint32_t version = m_pool->changeVersion();
+            stamp(versionsOf(row >> m_table.shift)[c->slot()], version);
+            stamp(m_columnVersions[c->slot()], version);
+        }
 
-        std::vector<Velocity> &velocities() { return m_velocities; }
-        const std::vector<Velocity> &velocities() const { return m_velocities; }
+        // World version at which componentId last changed in any row of the store (0 = never).
+        uint32_t columnVersion(uint32_t componentId) const
+        {
+            const ComponentColumn *c = findColumn(componentId);
+            return c ? m_columnVersions[c->slot()].load(std::memory_order_relaxed) : 0u;
+        }
 
-        std::vector<Health> &healths() { return m_healths; }
-        const std::vector<Health> &healths() const { return m_healths; }
+        bool columnChangedSince(uint32_t componentId, uint32_t version) const
+        {
+            return columnVersion(componentId) > version;
+        }
 
-        std::vector<MoveTarget> &moveTargets() { return m_moveTargets; }
-        const std::vector<MoveTarget> &moveTargets() const { return m_moveTargets; }
+        // World version at which componentId last changed in chunk (0 = never, or no column).
+        uint32_t chunkVersion(uint32_t chunk, uint32_t componentId) const
+        {
+            const ComponentColumn *c = findColumn(componentId);
+            if (!c || chunk >= m_table.chunks.size())
+                return 0u;
+            return versionsOf(chunk)[c->slot()].load(std::memory_order_relaxed);
+        }
 
-        std::vector<MoveSpeed> &moveSpeeds() { return m_moveSpeeds; }
-        const std::vector<MoveSpeed> &moveSpeeds() const { return m_moveSpeeds; }
+        // True if componentId changed in chunk after version (e.g. the version a system last ran at).
+        bool chunkChangedSince(uint32_t chunk, uint32_t componentId, uint32_t version) const
+        {
+            return chunkVersion(chunk, componentId) > version;
+        }
 
-        std::vector<Radius> &radii() { return m_radii; }
-        const std::vector<Radius> &radii() const { return m_radii; }
+        // Column of any registered component type; empty view if the store has none for it or
+        // it holds a different type.
+        template <typename T>
+        ColumnView<T> column(uint32_t componentId)
+        {
+            ComponentColumn *c = findColumn(componentId);
+            return ColumnView<T>((c && c->type().typeKey == componentTypeKey<T>()) ? c : nullptr);
+        }
 
-        std::vector<Separation> &separations() { return m_separations; }
-        const std::vector<Separation> &separations() const { return m_separations; }
+        template <typename T>
+        ColumnView<const T> column(uint32_t componentId) const
+        {
+            const ComponentColumn *c = findColumn(componentId);
+            return ColumnView<const T>((c && c->type().typeKey == componentTypeKey<T>()) ? c : nullptr);
+        }
 
-        std::vector<AvoidanceParams> &avoidanceParams() { return m_avoidanceParams; }
-        const std::vector<AvoidanceParams> &avoidanceParams() const { return m_avoidanceParams; }
+        ComponentColumn *findColumn(uint32_t componentId)
+        {
+            return (componentId < m_columnOf.size() && m_columnOf[componentId] >= 0) ? &m_columns[m_columnOf[componentId]] : nullptr;
+        }
 
-        std::vector<RenderModel> &renderModels() { return m_renderModels; }
-        const std::vector<RenderModel> &renderModels() const { return m_renderModels; }
+        const ComponentColumn *findColumn(uint32_t componentId) const
+        {
+            return (componentId < m_columnOf.size() && m_columnOf[componentId] >= 0) ? &m_columns[m_columnOf[componentId]] : nullptr;
+        }
 
-        std::vector<LocomotionClips> &locomotionClips() { return m_locomotionClips; }
-        const std::vector<LocomotionClips> &locomotionClips() const { return m_locomotionClips; }
+        const std::vector<ComponentColumn> &columns() const { return m_columns; }
+
+        // Component arrays (empty views when the signature lacks them).
+        ColumnView<Position> positions() { return ColumnView<Position>(m_builtin[BuiltinPosition]); }
+        ColumnView<const Position> positions() const { return ColumnView<const Position>(m_builtin[BuiltinPosition]); }
+        ColumnView<Velocity> velocities() { return ColumnView<Velocity>(m_builtin[BuiltinVelocity]); }
+        ColumnView<const Velocity> velocities() const { return ColumnView<const Velocity>(m_builtin[BuiltinVelocity]); }
+        ColumnView<Health> healths() { return ColumnView<Health>(m_builtin[BuiltinHealth]); }
+        ColumnView<const Health> healths() const { return ColumnView<const Health>(m_builtin[BuiltinHealth]); }
+        ColumnView<MoveTarget> moveTargets() { return ColumnView<MoveTarget>(m_builtin[BuiltinMoveTarget]); }
+        ColumnView<const MoveTarget> moveTargets() const { return ColumnView<const MoveTarget>(m_builtin[BuiltinMoveTarget]); }
+        ColumnView<MoveSpeed> moveSpeeds() { return ColumnView<MoveSpeed>(m_builtin[BuiltinMoveSpeed]); }
+        ColumnView<const MoveSpeed> moveSpeeds() const { return ColumnView<const MoveSpeed>(m_builtin[BuiltinMoveSpeed]); }
+        ColumnView<Radius> radii() { return ColumnView<Radius>(m_builtin[BuiltinRadius]); }
+        ColumnView<const Radius> radii() const { return ColumnView<const Radius>(m_builtin[BuiltinRadius]); }
+        ColumnView<Separation> separations() { return ColumnView<Separation>(m_builtin[BuiltinSeparation]); }
+        ColumnView<const Separation> separations() const { return ColumnView<const Separation>(m_builtin[BuiltinSeparation]); }
+        ColumnView<AvoidanceParams> avoidanceParams() { return ColumnView<AvoidanceParams>(m_builtin[BuiltinAvoidanceParams]); }
+        ColumnView<const AvoidanceParams> avoidanceParams() const { return ColumnView<const AvoidanceParams>(m_builtin[BuiltinAvoidanceParams]); }
+        ColumnView<RenderModel> renderModels() { return ColumnView<RenderModel>(m_builtin[BuiltinRenderModel]); }
+        ColumnView<const RenderModel> renderModels() const { return ColumnView<const RenderModel>(m_builtin[BuiltinRenderModel]); }
+        ColumnView<LocomotionClips> locomotionClips() { return ColumnView<LocomotionClips>(m_builtin[BuiltinLocomotionClips]); }
+        ColumnView<const LocomotionClips> locomotionClips() const { return ColumnView<const LocomotionClips>(m_builtin[BuiltinLocomotionClips]); }
+        ColumnView<CombatClips> combatClips() { return ColumnView<CombatClips>(m_builtin[BuiltinCombatClips]); }
+        ColumnView<const CombatClips> combatClips() const { return ColumnView<const CombatClips>(m_builtin[BuiltinCombatClips]); }
+        ColumnView<RenderAnimation> renderAnimations() { return ColumnView<RenderAnimation>(m_builtin[BuiltinRenderAnimation]); }
+        ColumnView<const RenderAnimation> renderAnimations() const { return ColumnView<const RenderAnimation>(m_builtin[BuiltinRenderAnimation]); }
+        ColumnView<Facing> facings() { return ColumnView<Facing>(m_builtin[BuiltinFacing]); }
+        ColumnView<const Facing> facings() const { return ColumnView<const Facing>(m_builtin[BuiltinFacing]); }
+        ColumnView<RenderTransform> renderTransforms() { return ColumnView<RenderTransform>(m_builtin[BuiltinRenderTransform]); }
+        ColumnView<const RenderTransform> renderTransforms() const { return ColumnView<const RenderTransform>(m_builtin[BuiltinRenderTransform]); }
+        ColumnView<RenderScale> renderScales() { return ColumnView<RenderScale>(m_builtin[BuiltinRenderScale]); }
+        ColumnView<const RenderScale> renderScales() const { return ColumnView<const RenderScale>(m_builtin[BuiltinRenderScale]); }
+        ColumnView<ObstacleRadius> obstacleRadii() { return ColumnView<ObstacleRadius>(m_builtin[BuiltinObstacleRadius]); }
+        ColumnView<const ObstacleRadius> obstacleRadii() const { return ColumnView<const ObstacleRadius>(m_builtin[BuiltinObstacleRadius]); }
+        ColumnView<Path> paths() { return ColumnView<Path>(m_builtin[BuiltinPath]); }
+        ColumnView<const Path> paths() const { return ColumnView<const Path>(m_builtin[BuiltinPath]); }
+        ColumnView<PosePalette> posePalettes() { return ColumnView<PosePalette>(m_builtin[BuiltinPosePalette]); }
+        ColumnView<const PosePalette> posePalettes() const { return ColumnView<const PosePalette>(m_builtin[BuiltinPosePalette]); }
+        ColumnView<Team> teams() { return ColumnView<Team>(m_builtin[BuiltinTeam]); }
+        ColumnView<const Team> teams() const { return ColumnView<const Team>(m_builtin[BuiltinTeam]); }
+        ColumnView<AttackCooldown> attackCooldowns() { return ColumnView<AttackCooldown>(m_builtin[BuiltinAttackCooldown]); }
+        ColumnView<const AttackCooldown> attackCooldowns() const { return ColumnView<const AttackCooldown>(m_builtin[BuiltinAttackCooldown]); }
+        ColumnView<RenderBounds> renderBounds() { return ColumnView<RenderBounds>(m_builtin[BuiltinRenderBounds]); }
+        ColumnView<const RenderBounds> renderBounds() const { return ColumnView<const RenderBounds>(m_builtin[BuiltinRenderBounds]); }
+        ColumnView<VisibilityState> visibilityState() { return ColumnView<VisibilityState>(m_builtin[BuiltinVisibilityState]); }
+        ColumnView<const VisibilityState> visibilityState() const { return ColumnView<const VisibilityState>(m_builtin[BuiltinVisibilityState]); }
+        ColumnView<PreviousTransform> previousTransforms() { return ColumnView<PreviousTransform>(m_builtin[BuiltinPreviousTransform]); }
+        ColumnView<const PreviousTransform> previousTransforms() const { return ColumnView<const PreviousTransform>(m_builtin[BuiltinPreviousTransform]); }
+        ColumnView<SleepState> sleepStates() { return ColumnView<SleepState>(m_builtin[BuiltinSleepState]); }
+        ColumnView<const SleepState> sleepStates() const { return ColumnView<const SleepState>(m_builtin[BuiltinSleepState]); }
+        ColumnView<CombatMemory> combatMemories() { return ColumnView<CombatMemory>(m_builtin[BuiltinCombatMemory]); }
+        ColumnView<const CombatMemory> combatMemories() const { return ColumnView<const CombatMemory>(m_builtin[BuiltinCombatMemory]); }
+        ColumnView<RenderSlot> renderSlots() { return ColumnView<RenderSlot>(m_builtin[BuiltinRenderSlot]); }
+        ColumnView<const RenderSlot> renderSlots() const { return ColumnView<const RenderSlot>(m_builtin[BuiltinRenderSlot]); }
+        ColumnView<WorldBounds> worldBounds() { return ColumnView<WorldBounds>(m_builtin[BuiltinWorldBounds]); }
+        ColumnView<const WorldBounds> worldBounds() const { return ColumnView<const WorldBounds>(m_builtin[BuiltinWorldBounds]); }
 
-        std::vector<CombatClips> &combatClips() { return m_combatClips; }
-        const std::vector<CombatClips> &combatClips() const { return m_combatClips; }
+        // Helpers
+        bool hasPosition() const { return m_builtin[BuiltinPosition] != nullptr; }
+        bool hasVelocity() const { return m_builtin[BuiltinVelocity] != nullptr; }
+        bool hasHealth() const { return m_builtin[BuiltinHealth] != nullptr; }
+        bool hasMoveTarget() const { return m_builtin[BuiltinMoveTarget] != nullptr; }
+        bool hasMoveSpeed() const { return m_builtin[BuiltinMoveSpeed] != nullptr; }
+        bool hasRadius() const { return m_builtin[BuiltinRadius] != nullptr; }
+        bool hasSeparation() const { return m_builtin[BuiltinSeparation] != nullptr; }
+        bool hasAvoidanceParams() const { return m_builtin[BuiltinAvoidanceParams] != nullptr; }
+        bool hasRenderModel() const { return m_builtin[BuiltinRenderModel] != nullptr; }
+        bool hasLocomotionClips() const { return m_builtin[BuiltinLocomotionClips] != nullptr; }
+        bool hasCombatClips() const { return m_builtin[BuiltinCombatClips] != nullptr; }
+        bool hasRenderAnimation() const { return m_builtin[BuiltinRenderAnimation] != nullptr; }
+        bool hasFacing() const { return m_builtin[BuiltinFacing] != nullptr; }
+        bool hasRenderTransform() const { return m_builtin[BuiltinRenderTransform] != nullptr; }
+        bool hasRenderScale() const { return m_builtin[BuiltinRenderScale] != nullptr; }
+        bool hasObstacle() const { return m_hasObstacle; }
+        bool hasObstacleRadius() const { return m_builtin[BuiltinObstacleRadius] != nullptr; }
+        bool hasPath() const { return m_builtin[BuiltinPath] != nullptr; }
+        bool hasPosePalette() const { return m_builtin[BuiltinPosePalette] != nullptr; }
+        bool hasTeam() const { return m_builtin[BuiltinTeam] != nullptr; }
+        bool hasAttackCooldown() const { return m_builtin[BuiltinAttackCooldown] != nullptr; }
+        bool hasRenderBounds() const { return m_builtin[BuiltinRenderBounds] != nullptr; }
+        bool hasVisibilityState() const { return m_builtin[BuiltinVisibilityState] != nullptr; }
+        bool hasPreviousTransform() const { return m_builtin[BuiltinPreviousTransform] != nullptr; }
+        bool hasSleepState() const { return m_builtin[BuiltinSleepState] != nullptr; }
+        bool hasCombatMemory() const { return m_builtin[BuiltinCombatMemory] != nullptr; }
+        bool hasRenderSlot() const { return m_builtin[BuiltinRenderSlot] != nullptr; }
+        bool hasWorldBounds() const { return m_builtin[BuiltinWorldBounds] != nullptr; }
+
+        // Create one column per typed component of the signature and lay them out in a chunk;
+        // cache the engine components' columns. Called once, before any row exists.
+        void resolveKnownComponents(ComponentRegistry &registry)
+        {
+            assert(m_table.rows == 0 && m_table.chunks.empty());
+            m_columns.clear();
+            m_columnOf.clear();
 
-        std::vector<RenderAnimation> &renderAnimations() { return m_renderAnimations; }
-        const std::vector<RenderAnimation> &renderAnimations() const { return m_renderAnimations; }
+            const auto &words = m_signature.words();
+            std::vector<std::pair<uint32_t, const ComponentTypeInfo *>> typed;
+            for (size_t w = 0; w < words.size(); ++w)
+            {
+                for (uint32_t bit = 0; bit < 64; ++bit)
+                {
+                    const uint32_t id = static_cast<uint32_t>(w * 64u + bit);
+                    if (!((words[w] >> bit) & 1ull))
+                        continue;
+                    if (const ComponentTypeInfo *info = registry.typeInfo(id))
+                        typed.emplace_back(id, info);
+                }
+            }
 
-        std::vector<Facing> &facings() { return m_facings; }
-        const std::vector<Facing> &facings() const { return m_facings; }
+            // Largest power-of-two row count whose header + aligned column arrays fit a chunk.
+            auto alignUp = [](size_t v, size_t a)
+            { return (v + a - 1u) & ~(a - 1u); };
+            const size_t header = alignUp(typed.size() * sizeof(std::atomic<uint32_t>), ChunkPool::CHUNK_ALIGN);
+            uint32_t shift = MAX_CHUNK_SHIFT;
+            size_t bytes = 0;
+            for (;; --shift)
+            {
+                bytes = header;
+                for (const auto &t : typed)
+                    bytes = alignUp(bytes, t.second->align) + (static_cast<size_t>(1u) << shift) * t.second->size;
+                if (bytes <= ChunkPool::CHUNK_BYTES || shift == 0)
+                    break;
+            }
+            m_table.shift = shift;
+            m_table.mask = (1u << shift) - 1u;
+            m_chunkBytes = bytes;
+
+            m_columns.reserve(typed.size()); // columns never move after this
+            m_columnVersions = std::make_unique<std::atomic<uint32_t>[]>(typed.size());
+            for (size_t i = 0; i < typed.size(); ++i)
+                m_columnVersions[i].store(0u, std::memory_order_relaxed);
+            m_columnOf.assign(words.size() * 64u, -1);
+            size_t offset = header;
+            for (const auto &t : typed)
+            {
+                assert(t.second->align <= ChunkPool::CHUNK_ALIGN);
+                offset = alignUp(offset, t.second->align);
+                m_columnOf[t.first] = static_cast<int32_t>(m_columns.size());
+                m_columns.emplace_back(t.first, *t.second, static_cast<uint32_t>(offset),
+                                       static_cast<uint32_t>(m_columns.size()), &m_table);
+                offset += m_table.capacity() * t.second->size;
+            }
 
-        std::vector<RenderTransform> &renderTransforms() { return m_renderTransforms; }
-        const std::vector<RenderTransform> &renderTransforms() const { return m_renderTransforms; }
+            static constexpr const char *kBuiltinNames[BuiltinCount] = {
+                "Position",
+                "Velocity",
+                "Health",
+                "MoveTarget",
+                "MoveSpeed",
+                "Radius",
+                "Separation",
+                "AvoidanceParams",
+                "RenderModel",
+                "LocomotionClips",
+                "CombatClips",
+                "RenderAnimation",
+                "Facing",
+                "RenderTransform",
+                "RenderScale",
+                "ObstacleRadius",
+                "Path",
+                "PosePalette",
+                "Team",
+                "AttackCooldown",
+                "RenderBounds",
+                "VisibilityState",
+                "PreviousTransform",
+                "SleepState",
+                "CombatMemory",
+                "RenderSlot",
+                "WorldBounds",
+            };
+            for (uint32_t b = 0; b < BuiltinCount; ++b)
+                m_builtin[b] = findColumn(registry.ensureId(kBuiltinNames[b]));
+            m_hasObstacle = m_signature.has(registry.ensureId("Obstacle"));
+            m_visibleBits.clear();
+            m_wasVisibleBits.clear();
+        }
 
-        std::vector<RenderScale> &renderScales() { return m_renderScales; }
-        const std::vector<RenderScale> &renderScales() const { return m_renderScales; }
+    private:
+        enum Builtin : uint32_t
+        {
+            BuiltinPosition,
+            BuiltinVelocity,
+            BuiltinHealth,
+            BuiltinMoveTarget,
+            BuiltinMoveSpeed,
+            BuiltinRadius,
+            BuiltinSeparation,
+            BuiltinAvoidanceParams,
+            BuiltinRenderModel,
+            BuiltinLocomotionClips,
+            BuiltinCombatClips,
+            BuiltinRenderAnimation,
+            BuiltinFacing,
+            BuiltinRenderTransform,
+            BuiltinRenderScale,
+            BuiltinObstacleRadius,
+            BuiltinPath,
+            BuiltinPosePalette,
+            BuiltinTeam,
+            BuiltinAttackCooldown,
+            BuiltinRenderBounds,
+            BuiltinVisibilityState,
+            BuiltinPreviousTransform,
+            BuiltinSleepState,
+            BuiltinCombatMemory,
+            BuiltinRenderSlot,
+            BuiltinWorldBounds,
+            BuiltinCount,
+        };
+
+        uint32_t chunksFor(uint32_t rows) const { return (rows + m_table.mask) >> m_table.shift; }
+
+        void addChunk()
+        {
+            std::byte *block = static_cast<std::byte *>(m_pool->acquire(m_chunkBytes));
+            std::atomic<uint32_t> *versions = reinterpret_cast<std::atomic<uint32_t> *>(block);
+            for (size_t i = 0; i < m_columns.size(); ++i)
+                new (&versions[i]) std::atomic<uint32_t>(0u);
+            m_table.chunks.push_back(block);
+        }
 
-        std::vector<ObstacleRadius> &obstacleRadii() { return m_obstacleRadii; }
-        const std::vector<ObstacleRadius> &obstacleRadii() const { return m_obstacleRadii; }
+        void releaseLastChunk()
+        {
+            m_pool->release(m_table.chunks.back(), m_chunkBytes);
+            m_table.chunks.pop_back();
+        }
 
-        std::vector<Path> &paths() { return m_paths; }
-        const std::vector<Path> &paths() const { return m_paths; }
-        std::vector<PosePalette> &posePalettes() { return m_posePalettes; }
-        const std::vector<PosePalette> &posePalettes() const { return m_posePalettes; }
+        std::atomic<uint32_t> *versionsOf(uint32_t chunk) const
+        {
+            return reinterpret_cast<std::atomic<uint32_t> *>(m_table.chunks[chunk]);
+        }
+
+        // Row contents of chunk changed structurally: every column counts as changed.
+        void stampChunk(uint32_t chunk)
+        {
+            const uint32_t version = m_pool->changeVersion();
+            std::atomic<uint32_t> *versions = versionsOf(chunk);
+            for (size_t i = 0; i < m_columns.size(); ++i)
+            {
+                stamp(versions[i], version);
+                stamp(m_columnVersions[i], version);
+            }
+        }
 
-        std::vector<Team> &teams() { return m_teams; }
-        const std::vector<Team> &teams() const { return m_teams; }
+        // One word per 64 rows while the store has VisibilityState; new words start cleared.
+        void resizeVisibility()
+        {
+            if (!m_builtin[BuiltinVisibilityState])
+                return;
+            const size_t words = (static_cast<size_t>(m_table.rows) + 63u) >> 6;
+            m_visibleBits.resize(words, 0u);
+            m_wasVisibleBits.resize(words, 0u);
+        }
 
-        std::vector<AttackCooldown> &attackCooldowns() { return m_attackCooldowns; }
-        const std::vector<AttackCooldown> &attackCooldowns() const { return m_attackCooldowns; }
+        static void setBit(uint64_t *bits, uint32_t row, bool value)
+        {
+            const uint64_t bit = uint64_t{1} << (row & 63u);
+            bits[row >> 6] = value ? (bits[row >> 6] | bit) : (bits[row >> 6] & ~bit);
+        }
 
-        std::vector<RenderBounds> &renderBounds() { return m_renderBounds; }
-        const std::vector<RenderBounds> &renderBounds() const { return m_renderBounds; }
+        // Row 'from' (the old last row) moves into 'to'; 'from' is cleared.
+        static void copyBit(uint64_t *bits, uint32_t to, uint32_t from)
+        {
+            const bool value = (bits[from >> 6] >> (from & 63u)) & 1u;
+            setBit(bits, to, value);
+            bits[from >> 6] &= ~(uint64_t{1} << (from & 63u));
+        }
 
-        std::vector<VisibilityState> &visibilityState() { return m_visibilityState; }
-        const std::vector<VisibilityState> &visibilityState() const { return m_visibilityState; }
+        void permuteBits(std::vector<uint64_t> &bits, const uint32_t *order, uint32_t n)
+        {
+            m_permuteBits.assign(bits.size(), 0u);
+            for (uint32_t i = 0; i < n; ++i)
+                m_permuteBits[i >> 6] |= ((bits[order[i] >> 6] >> (order[i] & 63u)) & 1u) << (i & 63u);
+            bits.swap(m_permuteBits);
+        }
 
-        // Helpers
-        bool hasPosition() const { return m_hasPosition; }
-        bool hasVelocity() const { return m_hasVelocity; }
-        bool hasHealth() const { return m_hasHealth; }
-        bool hasMoveTarget() const { return m_hasMoveTarget; }
-        bool hasMoveSpeed() const { return m_hasMoveSpeed; }
-        bool hasRadius() const { return m_hasRadius; }
-        bool hasSeparation() const { return m_hasSeparation; }
-        bool hasAvoidanceParams() const { return m_hasAvoidanceParams; }
-        bool hasRenderModel() const { return m_hasRenderModel; }
-        bool hasLocomotionClips() const { return m_hasLocomotionClips; }
-        bool hasCombatClips() const { return m_hasCombatClips; }
-        bool hasRenderAnimation() const { return m_hasRenderAnimation; }
-        bool hasFacing() const { return m_hasFacing; }
-        bool hasRenderTransform() const { return m_hasRenderTransform; }
-        bool hasRenderScale() const { return m_hasRenderScale; }
-        bool hasObstacle() const { return m_hasObstacle; }
-        bool hasObstacleRadius() const { return m_hasObstacleRadius; }
-        bool hasPath() const { return m_hasPath; }
-        bool hasPosePalette() const { return m_hasPosePalette; }
-        bool hasTeam() const { return m_hasTeam; }
-        bool hasAttackCooldown() const { return m_hasAttackCooldown; }
-        bool hasRenderBounds() const { return m_hasRenderBounds; }
-        bool hasVisibilityState() const { return m_hasVisibilityState; }
-
-        // Resolve which known components are present in signature; enables arrays accordingly.
-        void resolveKnownComponents(ComponentRegistry &registry)
+        // Most marks within a level carry the version already stored; skip the write so
+        // parallel lanes marking rows of one chunk don't keep stealing its header cache line.
+        static void stamp(std::atomic<uint32_t> &slot, uint32_t version)
         {
-            const uint32_t posId = registry.ensureId("Position");
-            const uint32_t velId = registry.ensureId("Velocity");
-            const uint32_t heaId = registry.ensureId("Health");
-            const uint32_t tgtId = registry.ensureId("MoveTarget");
-            const uint32_t spdId = registry.ensureId("MoveSpeed");
-            const uint32_t radId = registry.ensureId("Radius");
-            const uint32_t sepId = registry.ensureId("Separation");
-            const uint32_t apId = registry.ensureId("AvoidanceParams");
-            const uint32_t rmId = registry.ensureId("RenderModel");
-            const uint32_t locoId = registry.ensureId("LocomotionClips");
-            const uint32_t ccId = registry.ensureId("CombatClips");
-            const uint32_t raId = registry.ensureId("RenderAnimation");
-            const uint32_t faceId = registry.ensureId("Facing");
-            const uint32_t rtId = registry.ensureId("RenderTransform");
-            const uint32_t rsId = registry.ensureId("RenderScale");
-            const uint32_t obsId = registry.ensureId("Obstacle");
-            const uint32_t obsRId = registry.ensureId("ObstacleRadius");
-            const uint32_t pathId = registry.ensureId("Path");
-            const uint32_t ppId = registry.ensureId("PosePalette");
-            m_hasPosition = m_signature.has(posId);
-            m_hasVelocity = m_signature.has(velId);
-            m_hasHealth = m_signature.has(heaId);
-            m_hasMoveTarget = m_signature.has(tgtId);
-            m_hasMoveSpeed = m_signature.has(spdId);
-            m_hasRadius = m_signature.has(radId);
-            m_hasSeparation = m_signature.has(sepId);
-            m_hasAvoidanceParams = m_signature.has(apId);
-            m_hasRenderModel = m_signature.has(rmId);
-            m_hasLocomotionClips = m_signature.has(locoId);
-            m_hasCombatClips = m_signature.has(ccId);
-            m_hasRenderAnimation = m_signature.has(raId);
-            m_hasFacing = m_signature.has(faceId);
-            m_hasRenderTransform = m_signature.has(rtId);
-            m_hasRenderScale = m_signature.has(rsId);
-            m_hasObstacle = m_signature.has(obsId);
-            m_hasObstacleRadius = m_signature.has(obsRId);
-            m_hasPath = m_signature.has(pathId);
-            m_hasPosePalette = m_signature.has(ppId);
-
-            const uint32_t teamId = registry.ensureId("Team");
-            const uint32_t ackId = registry.ensureId("AttackCooldown");
-            m_hasTeam = m_signature.has(teamId);
-            m_hasAttackCooldown = m_signature.has(ackId);
-
-            const uint32_t rbId = registry.ensureId("RenderBounds");
-            const uint32_t vsId = registry.ensureId("VisibilityState");
-            m_hasRenderBounds = m_signature.has(rbId);
-            m_hasVisibilityState = m_signature.has(vsId);
+            if (slot.load(std::memory_order_relaxed) != version)
+                slot.store(version, std::memory_order_relaxed);
         }
 
-    private:
         ComponentMask m_signature;
         std::vector<Entity> m_entities;
-
-        // Component arrays (only used if signature includes them).
-        std::vector<Position> m_positions;
-        std::vector<Velocity> m_velocities;
-        std::vector<Health> m_healths;
-        std::vector<MoveTarget> m_moveTargets;
-        std::vector<MoveSpeed> m_moveSpeeds;
-        std::vector<Radius> m_radii;
-        std::vector<Separation> m_separations;
-        std::vector<AvoidanceParams> m_avoidanceParams;
-        std::vector<RenderModel> m_renderModels;
-        std::vector<LocomotionClips> m_locomotionClips;
-        std::vector<CombatClips> m_combatClips;
-        std::vector<RenderAnimation> m_renderAnimations;
-        std::vector<Facing> m_facings;
-        std::vector<RenderTransform> m_renderTransforms;
-        std::vector<RenderScale> m_renderScales;
-        std::vector<ObstacleRadius> m_obstacleRadii;
-        std::vector<Path> m_paths;
-        std::vector<PosePalette> m_posePalettes;
-        std::vector<Team> m_teams;
-        std::vector<AttackCooldown> m_attackCooldowns;
-        std::vector<RenderBounds> m_renderBounds;
-        std::vector<VisibilityState> m_visibilityState;
-
-        // Flags indicating which arrays are active.
-        bool m_hasPosition = false;
-        bool m_hasVelocity = false;
-        bool m_hasHealth = false;
-        bool m_hasMoveTarget = false;
-        bool m_hasMoveSpeed = false;
-        bool m_hasRadius = false;
-        bool m_hasSeparation = false;
-        bool m_hasAvoidanceParams = false;
-        bool m_hasRenderModel = false;
-        bool m_hasLocomotionClips = false;
-        bool m_hasCombatClips = false;
-        bool m_hasRenderAnimation = false;
-        bool m_hasFacing = false;
-        bool m_hasRenderTransform = false;
-        bool m_hasRenderScale = false;
+        uint32_t m_structuralVersion = 0;
+
+        ChunkPool *m_pool = nullptr; // not owned (ArchetypeStoreManager), or m_ownPool
+        std::unique_ptr<ChunkPool> m_ownPool;
+        ChunkTable m_table;
+        size_t m_chunkBytes = ChunkPool::CHUNK_BYTES;
+
+        std::vector<ComponentColumn> m_columns;
+
+        // permuteRows() scratch
+        std::vector<uint32_t> m_permuteCycles;
+        std::vector<uint32_t> m_permuteCycleEnds;
+        std::vector<uint8_t> m_permuteVisited;
+        std::vector<Entity> m_permuteEntities;
+        std::vector<std::max_align_t> m_permuteTemp;
+        std::vector<uint64_t> m_permuteBits;
+
+        std::vector<uint64_t> m_visibleBits;    // see visibleBits()
+        std::vector<uint64_t> m_wasVisibleBits; // visible bits of the previous culling frame
+        uint32_t m_visibilityTestFrame = 0;
+        uint32_t m_reservedRows = 0; // reserveRows() target (rows may already exceed it)
+        std::vector<int32_t> m_columnOf;                // component id -> column index (-1 = none)
+        std::unique_ptr<std::atomic<uint32_t>[]> m_columnVersions; // per column, max over chunks
+        ComponentColumn *m_builtin[BuiltinCount] = {}; // engine components' columns (nullptr = absent)
         bool m_hasObstacle = false;
-        bool m_hasObstacleRadius = false;
-        bool m_hasPath = false;
-        bool m_hasPosePalette = false;
-        bool m_hasTeam = false;
-        bool m_hasAttackCooldown = false;
-        bool m_hasRenderBounds = false;
-        bool m_hasVisibilityState = false;
     };
 
     class ArchetypeStoreManager
     {
     public:
+        ArchetypeStoreManager() : m_pool(std::make_unique<ChunkPool>()) {}
+        ArchetypeStoreManager(ArchetypeStoreManager &&) = default;
+
+        // Stores hand their chunks back to the pool, so they go first (also why m_pool is
+        // declared before m_stores).
+        ArchetypeStoreManager &operator=(ArchetypeStoreManager &&other) noexcept
+        {
+            if (this != &other)
+            {
+                m_stores.clear();
+                m_stores = std::move(other.m_stores);
+                m_pool = std::move(other.m_pool);
+                m_onStoreCreated = std::move(other.m_onStoreCreated);
+            }
+            return *this;
+        }
+
         void setOnStoreCreated(std::function<void(uint32_t archetypeId, const ComponentMask &signature)> cb)
         {
             m_onStoreCreated = std::move(cb);
@@ -483,7 +852,7 @@ namespace Engine::ECS
 
             if (!m_stores[archetypeId])
             {
-                m_stores[archetypeId] = std::make_unique<ArchetypeStore>(signature);
+                m_stores[archetypeId] = std::make_unique<ArchetypeStore>(signature, m_pool.get());
                 m_stores[archetypeId]->resolveKnownComponents(registry);
                 if (m_onStoreCreated)
                     m_onStoreCreated(archetypeId, signature);
@@ -503,7 +872,11 @@ namespace Engine::ECS
 
         const std::vector<std::unique_ptr<ArchetypeStore>> &stores() const { return m_stores; }
 
+        ChunkPool &chunkPool() { return *m_pool; }
+        const ChunkPool &chunkPool() const { return *m_pool; }
+
     private:
+        std::unique_ptr<ChunkPool> m_pool;
         std::vector<std::unique_ptr<ArchetypeStore>> m_stores;
         std::function<void(uint32_t archetypeId, const ComponentMask &signature)> m_onStoreCreated;
     };
@@ -0,0 +1,126 @@
+#pragma once
+/*
+  ChunkPool.h
+  -----------
+  Purpose:
+    - Hand out the fixed-size memory blocks ArchetypeStore lays its rows out in (one chunk holds
+      every column of the archetype for a power-of-two number of rows).
+    - Chunks released by shrinking stores go to a free list and are reused by the next store
+      that grows, so mass spawns after deaths don't touch the heap.
+    - Also carries the world's change version: chunks stamp it per column when rows in them are
+      created or marked dirty (ArchetypeStore::markChanged).
+
+  Usage:
+    - ArchetypeStoreManager owns one pool and passes it to every store it creates.
+    - Oversized chunks (a single row larger than CHUNK_BYTES) bypass the pool.
+    - reserve(n) (ArchetypeStore::reserveRows) allocates n chunks up front; reservations add up
+      until acquires consume them, so several stores reserved before a spawn all get theirs.
+*/
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+namespace Engine::ECS
+{
+    class ChunkPool
+    {
+    public:
+        // =====================
+        // TUNING CONSTANTS
+        // =====================
+        static constexpr size_t CHUNK_BYTES = 16u * 1024u;
+        static constexpr size_t CHUNK_ALIGN = 64u;
+
+        struct Stats
+        {
+            uint32_t live = 0;      // chunks handed out
+            uint32_t free = 0;      // chunks parked on the free list
+            uint32_t peakLive = 0;
+            uint64_t heapAllocs = 0; // blocks ever requested from the heap
+        };
+
+        ChunkPool() = default;
+        ~ChunkPool()
+        {
+            for (void *block : m_free)
+                ::operator delete(block, std::align_val_t(CHUNK_ALIGN));
+        }
+
+        ChunkPool(const ChunkPool &) = delete;
+        ChunkPool &operator=(const ChunkPool &) = delete;
+
+        // Park enough chunks on the free list for count more acquires than already reserved.
+        void reserve(uint32_t count)
+        {
+            m_reserved += count;
+            m_free.reserve(m_reserved);
+            while (m_free.size() < m_reserved)
+            {
+                m_free.push_back(::operator new(CHUNK_BYTES, std::align_val_t(CHUNK_ALIGN)));
+                ++m_stats.heapAllocs;
+            }
+            m_stats.free = static_cast<uint32_t>(m_free.size());
+        }
+
+        void *acquire(size_t bytes)
+        {
+            void *block = nullptr;
+            if (bytes <= CHUNK_BYTES && !m_free.empty())
+            {
+                block = m_free.back();
+                m_free.pop_back();
+                if (m_reserved > 0)
+                    --m_reserved;
+            }
+            else
+            {
+                block = ::operator new(bytes <= CHUNK_BYTES ? CHUNK_BYTES : bytes, std::align_val_t(CHUNK_ALIGN));
+                ++m_stats.heapAllocs;
+            }
+            ++m_stats.live;
+            if (m_stats.live > m_stats.peakLive)
+                m_stats.peakLive = m_stats.live;
+            m_stats.free = static_cast<uint32_t>(m_free.size());
+            return block;
+        }
+
+        void release(void *block, size_t bytes)
+        {
+            if (!block)
+                return;
+            --m_stats.live;
+            if (bytes <= CHUNK_BYTES)
+                m_free.push_back(block);
+            else
+                ::operator delete(block, std::align_val_t(CHUNK_ALIGN));
+            m_stats.free = static_cast<uint32_t>(m_free.size());
+        }
+
+        // Return parked chunks beyond keep to the heap (outstanding reservations are dropped).
+        void trim(size_t keep = 0)
+        {
+            m_reserved = std::min<size_t>(m_reserved, keep);
+            while (m_free.size() > keep)
+            {
+                ::operator delete(m_free.back(), std::align_val_t(CHUNK_ALIGN));
+                m_free.pop_back();
+            }
+            m_stats.free = static_cast<uint32_t>(m_free.size());
+        }
+
+        const Stats &stats() const { return m_stats; }
+
+        // World change version (ECSContext::advanceChangeVersion). Starts at 1 so 0 means "never".
+        uint32_t changeVersion() const { return m_changeVersion; }
+        void advanceChangeVersion() { ++m_changeVersion; }
+
+    private:
+        std::vector<void *> m_free;
+        size_t m_reserved = 0; // free chunks promised by reserve() and not yet acquired
+        Stats m_stats{};
+        uint32_t m_changeVersion = 1;
+    };
+}
@@ -0,0 +1,175 @@
+#pragma once
+/*
+  ComponentColumn.h
+  -----------------
+  Purpose:
+    - Describe one component type's slice of an ArchetypeStore's chunks: every chunk holds the
+      column as a packed array at the same byte offset, so row r lives in chunk r >> shift at
+      index r & mask (ChunkTable).
+    - The element layout and lifetime operations come from its ComponentTypeInfo
+      (ComponentRegistry). Trivially copyable components are moved with memcpy; others go
+      through the type's function pointers.
+
+  Usage:
+    - ArchetypeStore owns the chunks and one column per typed component of its signature.
+    - Systems use ColumnView<T> (ArchetypeStore::positions(), column<T>(id), ...): a small
+      handle with size()/operator[] over store rows, plus chunk(c) for contiguous per-chunk
+      loops. It stays valid while the store grows.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "ECS/Components.h"
+
+namespace Engine::ECS
+{
+    // Chunk list of one ArchetypeStore. Rows are packed: chunks [0, n-1) are full.
+    struct ChunkTable
+    {
+        std::vector<std::byte *> chunks;
+        uint32_t rows = 0;
+        uint32_t shift = 0; // log2(rows per chunk)
+        uint32_t mask = 0;  // rows per chunk - 1
+
+        uint32_t capacity() const { return mask + 1u; }
+        uint32_t rowsInChunk(uint32_t chunk) const
+        {
+            const uint32_t first = chunk << shift;
+            return (rows - first < capacity()) ? rows - first : capacity();
+        }
+    };
+
+    class ComponentColumn
+    {
+    public:
+        ComponentColumn(uint32_t componentId, const ComponentTypeInfo &type, uint32_t offset, uint32_t slot,
+                        const ChunkTable *table)
+            : m_type(type), m_table(table), m_componentId(componentId), m_offset(offset), m_slot(slot) {}
+
+        uint32_t componentId() const { return m_componentId; }
+        const ComponentTypeInfo &type() const { return m_type; }
+        const ChunkTable *table() const { return m_table; }
+        uint32_t offset() const { return m_offset; } // byte offset of the array inside a chunk
+        uint32_t slot() const { return m_slot; }     // index in the chunk's change-version header
+        uint32_t size() const { return m_table->rows; }
+
+        void *at(uint32_t row) { return address(row); }
+        const void *at(uint32_t row) const { return address(row); }
+
+        void constructAt(uint32_t row) { m_type.construct(at(row)); }
+
+        void destroyAt(uint32_t row)
+        {
+            if (!m_type.trivial)
+                m_type.destroy(at(row));
+        }
+
+        // Move row last into row and end last's lifetime (swap-remove).
+        void swapRemove(uint32_t row, uint32_t last)
+        {
+            if (m_type.trivial)
+            {
+                if (row != last)
+                    std::memcpy(at(row), at(last), m_type.size);
+            }
+            else
+            {
+                if (row != last)
+                    m_type.moveAssign(at(row), at(last));
+                m_type.destroy(at(last));
+            }
+        }
+
+        // Shift one permutation cycle: row cycle[j] takes the value of row cycle[j + 1], the last
+        // row takes the first's. temp holds one element (size/align of the type) meanwhile.
+        void rotateCycle(const uint32_t *cycle, uint32_t length, void *temp)
+        {
+            if (length < 2u)
+                return;
+            if (m_type.trivial)
+            {
+                std::memcpy(temp, at(cycle[0]), m_type.size);
+                for (uint32_t j = 0; j + 1u < length; ++j)
+                    std::memcpy(at(cycle[j]), at(cycle[j + 1u]), m_type.size);
+                std::memcpy(at(cycle[length - 1u]), temp, m_type.size);
+            }
+            else
+            {
+                m_type.relocate(temp, at(cycle[0]));
+                for (uint32_t j = 0; j + 1u < length; ++j)
+                    m_type.relocate(at(cycle[j]), at(cycle[j + 1u]));
+                m_type.relocate(at(cycle[length - 1u]), temp);
+            }
+        }
+
+        // dst[dstRow] = std::move(src[srcRow]); both columns hold the same component type.
+        void moveFrom(uint32_t dstRow, ComponentColumn &src, uint32_t srcRow)
+        {
+            if (m_type.trivial)
+                std::memcpy(at(dstRow), src.at(srcRow), m_type.size);
+            else
+                m_type.moveAssign(at(dstRow), src.at(srcRow));
+        }
+
+        // dst[dstRow] = src[srcRow]; both columns hold the same component type.
+        void copyFrom(uint32_t dstRow, const ComponentColumn &src, uint32_t srcRow)
+        {
+            if (m_type.trivial)
+                std::memcpy(at(dstRow), src.at(srcRow), m_type.size);
+            else
+                m_type.copyAssign(at(dstRow), src.at(srcRow));
+        }
+
+    private:
+        std::byte *address(uint32_t row) const
+        {
+            return m_table->chunks[row >> m_table->shift] + m_offset + static_cast<size_t>(row & m_table->mask) * m_type.size;
+        }
+
+        ComponentTypeInfo m_type;
+        const ChunkTable *m_table = nullptr; // not owned (ArchetypeStore)
+        uint32_t m_componentId = 0;
+        uint32_t m_offset = 0;
+        uint32_t m_slot = 0;
+    };
+
+    // Typed handle to a column (or to nothing: size() == 0). Cheap to copy; elements are
+    // re-read through the store's chunk table, so growth doesn't invalidate the view itself.
+    template <typename T>
+    class ColumnView
+    {
+    public:
+        ColumnView() = default;
+        explicit ColumnView(const ComponentColumn *column)
+            : m_table(column ? column->table() : nullptr), m_offset(column ? column->offset() : 0u) {}
+
+        size_t size() const { return m_table ? m_table->rows : 0u; }
+        bool empty() const { return size() == 0u; }
+
+        T &operator[](size_t i) const
+        {
+            const uint32_t row = static_cast<uint32_t>(i);
+            return chunk(row >> m_table->shift)[row & m_table->mask];
+        }
+
+        // Contiguous elements of one chunk: rows [c * chunkCapacity(), +ArchetypeStore::chunkRows(c)).
+        uint32_t chunkCount() const { return m_table ? static_cast<uint32_t>(m_table->chunks.size()) : 0u; }
+        uint32_t chunkCapacity() const { return m_table ? m_table->capacity() : 0u; }
+        T *chunk(uint32_t c) const { return reinterpret_cast<T *>(m_table->chunks[c] + m_offset); }
+
+        operator ColumnView<const T>() const { return ColumnView<const T>(m_table, m_offset); }
+
+    private:
+        template <typename>
+        friend class ColumnView;
+        ColumnView(const ChunkTable *table, uint32_t offset) : m_table(table), m_offset(offset) {}
+
+        const ChunkTable *m_table = nullptr;
+        uint32_t m_offset = 0;
+    };
+}
@@ -4,25 +4,48 @@
   ------------
   Purpose:
     - Define component data structures (Position, Velocity, Health).
-    - Provide ComponentRegistry for name <-> ID mapping (data-driven).
-    - Provide ComponentMask: dynamic bitset keyed by component IDs.
+    - Provide ComponentRegistry for name <-> ID mapping (data-driven), plus the layout of every
+      component type that ArchetypeStore keeps a column for (ComponentTypeInfo).
+    - Provide ComponentMask: fixed-size inline bitset keyed by component IDs
+      (ComponentRegistry::MaxComponents bits; SSE2/NEON containsAll/containsNone).
 
   Usage:
     - ComponentRegistry gives stable numeric IDs for component names defined in JSON.
     - ComponentMask builds signatures using those IDs to represent an entity/archetype's component set.
+    - Engine component types are registered by the registry itself. Gameplay code registers its own
+      with registerType<T>("Name") before the first store holding them is created; names without a
+      type (tags such as Selected/Obstacle/Dead) get no column. Sparse tags (registerSparseTag;
+      Selected by default) never enter signatures at all.
 */
 
+#include "ECS/Entity.h"
+
+#include <cassert>
 #include <cstdint>
 #include <vector>
 #include <string>
-#include <sstream>
-#include <iomanip>
+#include <array>
 #include <algorithm>
+#include <utility>
 #include <unordered_map>
 #include <variant>
+#include <new>
+#include <type_traits>
 #include <assets/Handles.h>
 #include <glm/glm.hpp>
 
+// Mask tests use the same backend switch as utils/SimdMat4.h (ENGINE_SIMD_MATH=0 forces scalar).
+#ifndef ENGINE_SIMD_MATH
+#define ENGINE_SIMD_MATH 1
+#endif
+#if ENGINE_SIMD_MATH && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define ENGINE_MASK_SSE 1
+#include <emmintrin.h>
+#elif ENGINE_SIMD_MATH && (defined(__aarch64__) || defined(_M_ARM64))
+#define ENGINE_MASK_NEON 1
+#include <arm_neon.h>
+#endif
+
 namespace Engine::ECS
 {
     // -----------------------
@@ -59,6 +82,7 @@ namespace Engine::ECS
     {
         float x = 0.0f, y = 0.0f, z = 0.0f;
         uint8_t active = 0; // 0 = inactive, 1 = active
+        uint32_t order = 0; // group order that set this target (CommandSystem), 0 = individual
     };
 
     // Movement speed
@@ -126,16 +150,18 @@ namespace Engine::ECS
     // Pathfinding Components
     // -----------------------
 
-    // Waypoint buffer for A* pathfinding
+    // A* route of a unit: the waypoints live in PathfindingSystem's PathStore, shared by every
+    // unit handed the same plan.
     struct Path
     {
-        static constexpr uint32_t MAX_WAYPOINTS = 64;
-
-        float waypointsX[MAX_WAYPOINTS];
-        float waypointsZ[MAX_WAYPOINTS];
-        uint32_t count = 0;   // how many waypoints are valid
-        uint32_t current = 0; // index of the next waypoint to walk toward
-        bool valid = false;   // was a path successfully found?
+        uint32_t waypoints = 0; // PathStore handle (0 = none)
+        uint32_t count = 0;     // how many waypoints are valid
+        uint32_t current = 0;   // index of the next waypoint to walk toward
+        uint32_t corridorCell = 0; // index into the block's corridor of the cell the unit is in (SteeringSystem)
+        bool valid = false;     // was a path successfully found?
+        bool partial = false;   // route continues past the last waypoint (hierarchical plan, refined in pieces)
+        bool offCorridor = false; // left the corridor for good: walks the waypoints instead
+        uint32_t flowField = 0; // FlowFieldCache handle while following a group field (no waypoints)
     };
 
     struct RenderModel
@@ -177,8 +203,47 @@ namespace Engine::ECS
         float speed = 1.0f;
         bool loop = false;
         bool playing = false;
+
+        // Crossfade: while blendWeight < 1 the pose mixes in blendFromClip (sampled at
+        // blendFromTimeSec) with weight 1 - blendWeight. Started by CrossfadeTo(), advanced
+        // by AnimationPlaybackSystem.
+        bool blendFromLoop = false;
+        uint32_t blendFromClip = 0;
+        float blendFromTimeSec = 0.0f;
+        float blendWeight = 1.0f;
+        float blendDurationSec = 0.0f;
     };
 
+    // Switch anim to clipIndex (restarting at startTimeSec), fading the current pose out over
+    // fadeSec; 0 = hard switch. Retargeting back to the clip being faded out reverses the fade
+    // instead, so that clip resumes where it was.
+    inline void CrossfadeTo(RenderAnimation &anim, uint32_t clipIndex, float fadeSec, float startTimeSec = 0.0f)
+    {
+        if (fadeSec <= 0.0f)
+        {
+            anim.blendWeight = 1.0f;
+        }
+        else if (anim.blendWeight < 1.0f && anim.blendFromClip == clipIndex)
+        {
+            std::swap(anim.clipIndex, anim.blendFromClip);
+            std::swap(anim.timeSec, anim.blendFromTimeSec);
+            anim.blendFromLoop = anim.loop;
+            anim.blendWeight = 1.0f - anim.blendWeight;
+            anim.blendDurationSec = fadeSec;
+            return;
+        }
+        else
+        {
+            anim.blendFromLoop = anim.loop;
+            anim.blendFromClip = anim.clipIndex;
+            anim.blendFromTimeSec = anim.timeSec;
+            anim.blendWeight = 0.0f;
+            anim.blendDurationSec = fadeSec;
+        }
+        anim.clipIndex = clipIndex;
+        anim.timeSec = startTimeSec;
+    }
+
     // Entity facing direction (Y-axis rotation in radians)
     // 0 = facing +Z, PI/2 = facing +X, PI = facing -Z, -PI/2 = facing -X
     struct Facing
@@ -186,6 +251,29 @@ namespace Engine::ECS
         float yaw = 0.0f; // Rotation around Y axis in radians
     };
 
+    // Position/Facing as of the start of the last fixed simulation tick (TransformHistorySystem).
+    // RenderTransformUpdateSystem interpolates from here to the current Position/Facing.
+    // valid = 0 until the first tick after spawning (rendered at the current Position meanwhile).
+    struct PreviousTransform
+    {
+        float x = 0.0f;
+        float y = 0.0f;
+        float z = 0.0f;
+        float yaw = 0.0f;
+        uint32_t valid = 0;
+    };
+
+    // Rest state of an idle mover (SleepSystem). An asleep row has no target and zero velocity and
+    // is skipped by LocalAvoidanceSystem, so nothing marks it dirty until a new order or a nearby
+    // mover wakes it. anchor = where the current calm period started.
+    struct SleepState
+    {
+        float anchorX = 0.0f;
+        float anchorZ = 0.0f;
+        float calmSeconds = 0.0f;
+        uint32_t asleep = 0;
+    };
+
     // Render-side cached world transform.
     // Updated by a dedicated system from Position (+ optional Facing).
     struct RenderTransform
@@ -202,13 +290,14 @@ namespace Engine::ECS
         float uniform = 1.0f;
     };
 
-    // Cached pose palettes computed by PoseUpdateSystem.
-    // nodePalette: one matrix per node in the model.
-    // jointPalette: one matrix per joint across all skins in the model (flattened).
+    // Cached pose palettes computed by PoseUpdateSystem, stored in its PosePalettePool.
+    // Node palette: one matrix per node in the model.
+    // Joint palette: one matrix per joint across all skins in the model (flattened).
     struct PosePalette
     {
-        std::vector<glm::mat4> nodePalette;
-        std::vector<glm::mat4> jointPalette;
+        // Slot in the PosePalettePool (palettePool 0 = none).
+        uint32_t palettePool = 0;
+        uint32_t paletteSlot = 0;
         uint32_t nodeCount = 0;
         uint32_t jointCount = 0;
 
@@ -222,6 +311,14 @@ namespace Engine::ECS
         // Track the model source used to build this pose so model changes can force a refresh.
         uint32_t sourceModelId = 0;
         uint32_t sourceModelGeneration = 0;
+
+        // Last evaluation came from the model's baked palettes (distant LOD). Also set on
+        // GPU-deferred rows so the pose pass samples the baked frames instead.
+        bool bakedSample = false;
+
+        // Clip the slot's key interval cursors belong to (ModelAsset::evaluatePoseInto).
+        // The cursors are reset when the clip or model changes.
+        uint32_t keyCursorClip = UINT32_MAX;
     };
 
     // -----------------------
@@ -241,39 +338,164 @@ namespace Engine::ECS
         float interval = 1.5f; // time between attacks (seconds)
     };
 
+    // Combat decision state carried between ticks (sample CombatSystem). Added by the prefab
+    // loader next to AttackCooldown.
+    struct CombatMemory
+    {
+        Entity targetEnemy{};
+        uint32_t nextScanTick = 0; // combat tick of the next nearest-enemy search (0 = now)
+        uint8_t engaged = 0;          // chasing or fighting a nearby enemy
+        uint8_t inMelee = 0;          // in melee recently (hysteresis around meleeRange)
+        uint8_t combatMoveIssued = 0; // MoveTarget was set by combat (safe to clear)
+        uint8_t _pad = 0;
+    };
+
     // -----------------------
     // Rendering & Visibility
     // -----------------------
 
-    // Bounding sphere for render culling.
-    // localCenter/localRadius are in model space; computed from asset data or defaults.
-    // worldCenter/worldRadius are in world space; updated by RenderBoundsUpdateSystem.
+    // Bounding sphere for render culling, model space; computed from asset data or defaults.
+    // Written at spawn and when a streamed model arrives; the per-frame world sphere derived
+    // from it is WorldBounds.
     struct RenderBounds
     {
-        glm::vec3 localCenter{0.0f};     // center in model space
-        float localRadius = 1.0f;         // radius in model space
-
-        glm::vec3 worldCenter{0.0f};     // center in world space (updated per frame)
-        float worldRadius = 1.0f;         // radius in world space (updated per frame)
+        glm::vec3 localCenter{0.0f}; // center in model space
+        float localRadius = 1.0f;    // radius in model space
+    };
 
-        uint32_t boundsVersion = 0;       // monotonic version for tracking updates
+    // World-space bounding sphere, updated with the world matrix by RenderTransformUpdateSystem.
+    // Split from RenderBounds so culling and the render-side readers stream 16 bytes per row.
+    struct WorldBounds
+    {
+        glm::vec3 center{0.0f};
+        float radius = 1.0f;
     };
 
-    // Runtime visibility state; render-system maintained.
-    // Track which entities are currently visible to the camera.
+    // Marks rows VisibilityCullingSystem tests. Visible / visible-last-frame are not stored
+    // here but as bits in the row's ArchetypeStore (visibleBits(), wasVisibleBits()), so
+    // readers scan 64 rows per word; this keeps only what the bits can't say.
     struct VisibilityState
     {
-        bool visible = false;             // is entity visible this frame?
-        bool wasVisibleLastFrame = false; // was entity visible last frame?
-        uint32_t visibleFrame = 0;        // frame counter when visibility was last set to true
-        uint32_t lastTestFrame = 0;       // frame counter when frustum test was last performed
+        // Last culling frame the row was visible (0: never). Written when the row turns hidden;
+        // while visible, the store's visibilityTestFrame() is the current value.
+        uint32_t visibleFrame = 0;
+    };
 
-        // Derived state: justBecameVisible = visible && !wasVisibleLastFrame
-        // Can be computed on demand or stored here for convenience
+    // Instance slot of the entity in its model pass; render-system maintained.
+    // Only trusted while the pass's slot table still names this entity, so values left
+    // behind by a LOD switch, a freed slot or a cloned row are simply reallocated.
+    struct RenderSlot
+    {
+        uint32_t bucket = UINT32_MAX; // VisibleBucketIndex of the pass holding the slot
+        uint32_t slot = 0;
     };
 
     // Typed defaults per component ID (used by Prefabs/Stores).
-    using DefaultValue = std::variant<Position, Velocity, Health, MoveTarget, MoveSpeed, Radius, Separation, AvoidanceParams, RenderModel, LocomotionClips, CombatClips, RenderAnimation, Facing, RenderTransform, RenderScale, ObstacleRadius, Path, PosePalette, Team, AttackCooldown, RenderBounds, VisibilityState>;
+    using DefaultValue = std::variant<Position, Velocity, Health, MoveTarget, MoveSpeed, Radius, Separation, AvoidanceParams, RenderModel, LocomotionClips, CombatClips, RenderAnimation, Facing, RenderTransform, RenderScale, ObstacleRadius, Path, PosePalette, Team, AttackCooldown, RenderBounds, VisibilityState, PreviousTransform, SleepState, CombatMemory, RenderSlot, WorldBounds>;
+
+    // -----------------------
+    // Compile-time component IDs
+    // -----------------------
+    // Every ComponentRegistry registers the engine components first and in this order, so their
+    // ids are the same constants in every world. TypedQuery.h builds masks from them without
+    // name lookups. Gameplay types registered later (registerType) only have runtime ids.
+    template <typename T>
+    struct ComponentId
+    {
+        static constexpr bool known = false;
+    };
+
+#define ENGINE_ECS_COMPONENT_ID(Type, Id)         \
+    template <>                                    \
+    struct ComponentId<Type>                       \
+    {                                              \
+        static constexpr bool known = true;        \
+        static constexpr uint32_t value = Id;      \
+        static constexpr const char *name = #Type; \
+    };
+    ENGINE_ECS_COMPONENT_ID(Position, 0)
+    ENGINE_ECS_COMPONENT_ID(Velocity, 1)
+    ENGINE_ECS_COMPONENT_ID(Health, 2)
+    ENGINE_ECS_COMPONENT_ID(MoveTarget, 3)
+    ENGINE_ECS_COMPONENT_ID(MoveSpeed, 4)
+    ENGINE_ECS_COMPONENT_ID(Radius, 5)
+    ENGINE_ECS_COMPONENT_ID(Separation, 6)
+    ENGINE_ECS_COMPONENT_ID(AvoidanceParams, 7)
+    ENGINE_ECS_COMPONENT_ID(RenderModel, 8)
+    ENGINE_ECS_COMPONENT_ID(LocomotionClips, 9)
+    ENGINE_ECS_COMPONENT_ID(CombatClips, 10)
+    ENGINE_ECS_COMPONENT_ID(RenderAnimation, 11)
+    ENGINE_ECS_COMPONENT_ID(Facing, 12)
+    ENGINE_ECS_COMPONENT_ID(RenderTransform, 13)
+    ENGINE_ECS_COMPONENT_ID(RenderScale, 14)
+    ENGINE_ECS_COMPONENT_ID(ObstacleRadius, 15)
+    ENGINE_ECS_COMPONENT_ID(Path, 16)
+    ENGINE_ECS_COMPONENT_ID(PosePalette, 17)
+    ENGINE_ECS_COMPONENT_ID(Team, 18)
+    ENGINE_ECS_COMPONENT_ID(AttackCooldown, 19)
+    ENGINE_ECS_COMPONENT_ID(RenderBounds, 20)
+    ENGINE_ECS_COMPONENT_ID(VisibilityState, 21)
+    ENGINE_ECS_COMPONENT_ID(PreviousTransform, 22)
+    ENGINE_ECS_COMPONENT_ID(SleepState, 23)
+    ENGINE_ECS_COMPONENT_ID(CombatMemory, 24)
+    ENGINE_ECS_COMPONENT_ID(RenderSlot, 25)
+    ENGINE_ECS_COMPONENT_ID(WorldBounds, 26)
+#undef ENGINE_ECS_COMPONENT_ID
+
+    static constexpr uint32_t EngineComponentCount = 27;
+    static_assert(std::variant_size_v<DefaultValue> == EngineComponentCount, "new engine component: give it a ComponentId");
+
+    // -----------------------
+    // Component Type Info
+    // -----------------------
+    // Layout and lifetime operations of one component type, so ArchetypeStore can keep columns as
+    // raw aligned arrays. Trivially copyable types are moved, swapped and copied with memcpy; the
+    // function pointers cover the rest (components with owning members).
+    struct ComponentTypeInfo
+    {
+        uint32_t size = 0;
+        uint32_t align = 1;
+        bool trivial = false;
+        const void *typeKey = nullptr;                       // identifies T (see componentTypeKey)
+        void (*construct)(void *dst) = nullptr;              // default-construct in place
+        void (*destroy)(void *p) = nullptr;
+        void (*moveAssign)(void *dst, void *src) = nullptr;
+        void (*copyAssign)(void *dst, const void *src) = nullptr;
+        void (*relocate)(void *dst, void *src) = nullptr;    // move-construct dst, destroy src
+    };
+
+    template <typename T>
+    const void *componentTypeKey()
+    {
+        static const char key = 0;
+        return &key;
+    }
+
+    template <typename T>
+    ComponentTypeInfo makeComponentTypeInfo()
+    {
+        static_assert(std::is_default_constructible_v<T>, "component types need a default constructor");
+        ComponentTypeInfo info;
+        info.size = static_cast<uint32_t>(sizeof(T));
+        info.align = static_cast<uint32_t>(alignof(T));
+        info.trivial = std::is_trivially_copyable_v<T>;
+        info.typeKey = componentTypeKey<T>();
+        info.construct = [](void *dst)
+        { new (dst) T(); };
+        info.destroy = [](void *p)
+        { static_cast<T *>(p)->~T(); };
+        info.moveAssign = [](void *dst, void *src)
+        { *static_cast<T *>(dst) = std::move(*static_cast<T *>(src)); };
+        info.copyAssign = [](void *dst, const void *src)
+        { *static_cast<T *>(dst) = *static_cast<const T *>(src); };
+        info.relocate = [](void *dst, void *src)
+        {
+            new (dst) T(std::move(*static_cast<T *>(src)));
+            static_cast<T *>(src)->~T();
+        };
+        return info;
+    }
+
     // -----------------------
     // Component Registry
     // -----------------------
@@ -283,6 +505,84 @@ namespace Engine::ECS
     {
     public:
         static constexpr uint32_t InvalidID = UINT32_MAX;
+        // Capacity of ComponentMask (components and tags together).
+        static constexpr uint32_t MaxComponents = 256;
+
+        ComponentRegistry()
+        {
+            registerEngineType<Position>();
+            registerEngineType<Velocity>();
+            registerEngineType<Health>();
+            registerEngineType<MoveTarget>();
+            registerEngineType<MoveSpeed>();
+            registerEngineType<Radius>();
+            registerEngineType<Separation>();
+            registerEngineType<AvoidanceParams>();
+            registerEngineType<RenderModel>();
+            registerEngineType<LocomotionClips>();
+            registerEngineType<CombatClips>();
+            registerEngineType<RenderAnimation>();
+            registerEngineType<Facing>();
+            registerEngineType<RenderTransform>();
+            registerEngineType<RenderScale>();
+            registerEngineType<ObstacleRadius>();
+            registerEngineType<Path>();
+            registerEngineType<PosePalette>();
+            registerEngineType<Team>();
+            registerEngineType<AttackCooldown>();
+            registerEngineType<RenderBounds>();
+            registerEngineType<VisibilityState>();
+            registerEngineType<PreviousTransform>();
+            registerEngineType<SleepState>();
+            registerEngineType<CombatMemory>();
+            registerEngineType<RenderSlot>();
+            registerEngineType<WorldBounds>();
+
+            registerSparseTag("Selected");
+        }
+
+        // Register (or look up) a component name and attach T's layout to it, so stores created
+        // afterwards hold a column of T for it.
+        template <typename T>
+        uint32_t registerType(const std::string &name)
+        {
+            const uint32_t id = ensureId(name);
+            if (m_types.size() <= id)
+                m_types.resize(static_cast<size_t>(id) + 1u);
+            m_types[id] = makeComponentTypeInfo<T>();
+            return id;
+        }
+
+        // Layout of a component, or nullptr for tags / names without a registered type.
+        const ComponentTypeInfo *typeInfo(uint32_t id) const
+        {
+            return (id < m_types.size() && m_types[id].size != 0) ? &m_types[id] : nullptr;
+        }
+
+        // Register a tag kept in a per-entity sparse set (ECSContext::addTag) instead of the
+        // archetype signature, so toggling it never moves rows. For tags that flip often and are
+        // rarely iterated (Selected); tags most systems exclude (Dead, Disabled) filter cheaper
+        // per archetype. Declare before any query or store uses the id.
+        uint32_t registerSparseTag(const std::string &name)
+        {
+            const uint32_t id = ensureId(name);
+            assert(!typeInfo(id) && "sparse tags carry no data");
+            if (id != InvalidID && !isSparseTag(id))
+                m_sparseTags.push_back(id);
+            return id;
+        }
+
+        bool isSparseTag(uint32_t id) const
+        {
+            for (uint32_t t : m_sparseTags)
+            {
+                if (t == id)
+                    return true;
+            }
+            return false;
+        }
+
+        const std::vector<uint32_t> &sparseTags() const { return m_sparseTags; }
 
         // Register a component name and return its stable ID.
         // If already registered, returns the existing ID.
@@ -293,6 +593,9 @@ namespace Engine::ECS
                 return it->second;
 
             const uint32_t id = static_cast<uint32_t>(m_idToName.size());
+            assert(id < MaxComponents && "raise ComponentRegistry::MaxComponents");
+            if (id >= MaxComponents)
+                return InvalidID;
             m_nameToId.emplace(name, id);
             m_idToName.emplace_back(name);
             return id;
@@ -325,8 +628,18 @@ namespace Engine::ECS
         uint32_t count() const { return static_cast<uint32_t>(m_idToName.size()); }
 
     private:
+        template <typename T>
+        void registerEngineType()
+        {
+            const uint32_t id = registerType<T>(ComponentId<T>::name);
+            assert(id == ComponentId<T>::value && "ComponentId<T> out of step with the registration order");
+            (void)id;
+        }
+
         std::unordered_map<std::string, uint32_t> m_nameToId;
         std::vector<std::string> m_idToName;
+        std::vector<ComponentTypeInfo> m_types; // by id; size == 0 for tags
+        std::vector<uint32_t> m_sparseTags;      // ids registered with registerSparseTag
     };
 
     // -----------------------
@@ -336,60 +649,92 @@ namespace Engine::ECS
     class ComponentMask
     {
     public:
+        static constexpr uint32_t MaxComponents = ComponentRegistry::MaxComponents;
+        static constexpr size_t WordCount = MaxComponents / 64u;
+        static_assert(MaxComponents % 128u == 0, "ComponentMask is compared two words at a time");
+
         ComponentMask() = default;
 
-        // Set a bit for component ID.
+        // Set a bit for component ID (ids past MaxComponents, e.g. InvalidID, are ignored).
         void set(uint32_t compId)
         {
-            ensureBit(compId);
-            const auto [wordIdx, bit] = bitPos(compId);
-            m_words[wordIdx] |= (uint64_t(1) << bit);
+            if (compId >= MaxComponents)
+                return;
+            m_words[compId >> 6] |= (uint64_t(1) << (compId & 63u));
         }
 
         // Clear a bit for component ID.
         void clear(uint32_t compId)
         {
-            if (!has(compId))
+            if (compId >= MaxComponents)
                 return;
-            const auto [wordIdx, bit] = bitPos(compId);
-            m_words[wordIdx] &= ~(uint64_t(1) << bit);
+            m_words[compId >> 6] &= ~(uint64_t(1) << (compId & 63u));
         }
 
         // Check if a bit for component ID is set.
         bool has(uint32_t compId) const
         {
-            const auto [wordIdx, bit] = bitPos(compId);
-            if (wordIdx >= m_words.size())
+            if (compId >= MaxComponents)
                 return false;
-            return (m_words[wordIdx] & (uint64_t(1) << bit)) != 0;
+            return (m_words[compId >> 6] & (uint64_t(1) << (compId & 63u))) != 0;
+        }
+
+        bool empty() const
+        {
+            uint64_t any = 0;
+            for (uint64_t w : m_words)
+                any |= w;
+            return any == 0;
         }
 
         // Return true if this mask contains all bits in 'rhs'.
         bool containsAll(const ComponentMask &rhs) const
         {
-            const size_t n = std::max(m_words.size(), rhs.m_words.size());
-            for (size_t i = 0; i < n; ++i)
+#if defined(ENGINE_MASK_SSE)
+            __m128i missing = _mm_setzero_si128();
+            for (size_t i = 0; i < WordCount; i += 2)
             {
-                const uint64_t a = i < m_words.size() ? m_words[i] : 0;
-                const uint64_t b = i < rhs.m_words.size() ? rhs.m_words[i] : 0;
-                if ((a & b) != b)
-                    return false;
+                const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&m_words[i]));
+                const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&rhs.m_words[i]));
+                missing = _mm_or_si128(missing, _mm_andnot_si128(a, b));
             }
-            return true;
+            return _mm_movemask_epi8(_mm_cmpeq_epi8(missing, _mm_setzero_si128())) == 0xFFFF;
+#elif defined(ENGINE_MASK_NEON)
+            uint64x2_t missing = vdupq_n_u64(0);
+            for (size_t i = 0; i < WordCount; i += 2)
+                missing = vorrq_u64(missing, vbicq_u64(vld1q_u64(&rhs.m_words[i]), vld1q_u64(&m_words[i])));
+            return (vgetq_lane_u64(missing, 0) | vgetq_lane_u64(missing, 1)) == 0;
+#else
+            uint64_t missing = 0;
+            for (size_t i = 0; i < WordCount; ++i)
+                missing |= rhs.m_words[i] & ~m_words[i];
+            return missing == 0;
+#endif
         }
 
         // Return true if this mask contains none of the bits in 'rhs'.
         bool containsNone(const ComponentMask &rhs) const
         {
-            const size_t n = std::max(m_words.size(), rhs.m_words.size());
-            for (size_t i = 0; i < n; ++i)
+#if defined(ENGINE_MASK_SSE)
+            __m128i common = _mm_setzero_si128();
+            for (size_t i = 0; i < WordCount; i += 2)
             {
-                const uint64_t a = i < m_words.size() ? m_words[i] : 0;
-                const uint64_t b = i < rhs.m_words.size() ? rhs.m_words[i] : 0;
-                if ((a & b) != 0)
-                    return false;
+                const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&m_words[i]));
+                const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&rhs.m_words[i]));
+                common = _mm_or_si128(common, _mm_and_si128(a, b));
             }
-            return true;
+            return _mm_movemask_epi8(_mm_cmpeq_epi8(common, _mm_setzero_si128())) == 0xFFFF;
+#elif defined(ENGINE_MASK_NEON)
+            uint64x2_t common = vdupq_n_u64(0);
+            for (size_t i = 0; i < WordCount; i += 2)
+                common = vorrq_u64(common, vandq_u64(vld1q_u64(&m_words[i]), vld1q_u64(&rhs.m_words[i])));
+            return (vgetq_lane_u64(common, 0) | vgetq_lane_u64(common, 1)) == 0;
+#else
+            uint64_t common = 0;
+            for (size_t i = 0; i < WordCount; ++i)
+                common |= m_words[i] & rhs.m_words[i];
+            return common == 0;
+#endif
         }
 
         // Convenience: required/excluded match.
@@ -398,18 +743,51 @@ namespace Engine::ECS
             return containsAll(required) && containsNone(excluded);
         }
 
-        // Stable string key for dictionary indexing (hex of words, high word first).
+        bool operator==(const ComponentMask &rhs) const
+        {
+            uint64_t diff = 0;
+            for (size_t i = 0; i < WordCount; ++i)
+                diff |= m_words[i] ^ rhs.m_words[i];
+            return diff == 0;
+        }
+        bool operator!=(const ComponentMask &rhs) const { return !(*this == rhs); }
+
+        ComponentMask &operator|=(const ComponentMask &rhs)
+        {
+            for (size_t i = 0; i < WordCount; ++i)
+                m_words[i] |= rhs.m_words[i];
+            return *this;
+        }
+
+        // Hash of the raw words (archetype lookup).
+        size_t hash() const
+        {
+            uint64_t h = 0x9E3779B97F4A7C15ull;
+            for (uint64_t w : m_words)
+            {
+                h ^= w + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+                h *= 0xBF58476D1CE4E5B9ull;
+            }
+            return static_cast<size_t>(h ^ (h >> 31));
+        }
+
+        // Readable key for logs/tools (hex of words, high word first, leading zero words dropped).
         std::string toKey() const
         {
-            if (m_words.empty())
+            size_t top = WordCount;
+            while (top > 0 && m_words[top - 1] == 0)
+                --top;
+            if (top == 0)
                 return "0";
-            std::ostringstream oss;
-            oss << std::hex << std::setfill('0');
-            for (size_t i = m_words.size(); i-- > 0;)
+            static constexpr char kHex[] = "0123456789abcdef";
+            std::string key;
+            key.reserve(top * 16u);
+            for (size_t i = top; i-- > 0;)
             {
-                oss << std::setw(16) << m_words[i];
+                for (int shift = 60; shift >= 0; shift -= 4)
+                    key.push_back(kHex[(m_words[i] >> shift) & 0xFu]);
             }
-            return oss.str();
+            return key;
         }
 
         // Build a mask from a list of component IDs.
@@ -421,24 +799,15 @@ namespace Engine::ECS
             return m;
         }
 
-        const std::vector<uint64_t> &words() const { return m_words; }
+        const std::array<uint64_t, WordCount> &words() const { return m_words; }
 
     private:
-        std::vector<uint64_t> m_words; // 64 bits per word
-
-        static std::pair<size_t, uint32_t> bitPos(uint32_t compId)
-        {
-            const size_t wordIdx = compId / 64;
-            const uint32_t bit = compId % 64;
-            return {wordIdx, bit};
-        }
+        std::array<uint64_t, WordCount> m_words{}; // 64 bits per word
+    };
 
-        void ensureBit(uint32_t compId)
-        {
-            const size_t need = compId / 64 + 1;
-            if (m_words.size() < need)
-                m_words.resize(need, 0);
-        }
+    struct ComponentMaskHash
+    {
+        size_t operator()(const ComponentMask &mask) const { return mask.hash(); }
     };
 
 } // namespace Engine::ECS
\ No newline at end of file
@@ -0,0 +1,114 @@
+#pragma once
+/*
+  CostBalancedBatches.h
+  ---------------------
+  Purpose:
+    - Split a parallel pass whose items cost very different amounts (a long A* next to trivial
+      ones, a 160-joint rig next to a prop, a unit in a packed block next to a loner) into
+      batches of about equal total cost, so no worker is still busy long after the others
+      reached the barrier.
+
+  Usage:
+    - costs[i] = cheap estimate for item i of the pass (path distance, joint count, neighbor
+      count; any unit, 0 allowed). build(costs, count, batchCount), then run(jobs, fn) calls
+      fn(workerIndex, item) once per item; or walk batchCount() / batch(b) by hand.
+    - batchCountFor(jobs) is the usual batchCount: BATCHES_PER_THREAD per loop thread.
+
+  Notes:
+    - Longest-processing-time first: items sorted by descending cost, each dealt to the
+      batch with the least cost so far. Within a batch items stay longest-first, so the
+      expensive ones start early.
+    - Ties keep item order, so equal-cost runs (one model, one cell) stay together.
+      Deterministic for a given input; fn must not depend on item order (write per item).
+    - Batches are handed to JobSystem::parallelForRange with grain 1: stealing still covers
+      estimates that were off.
+*/
+
+#include "utils/JobSystem.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace Engine::ECS
+{
+    class CostBalancedBatches
+    {
+    public:
+        // =====================
+        // TUNING CONSTANTS
+        // =====================
+        // Batches per loop thread: slack for stealing when estimates are off.
+        static constexpr uint32_t BATCHES_PER_THREAD = 2;
+
+        static uint32_t batchCountFor(const JobSystem *jobs)
+        {
+            return jobs ? (jobs->loopWorkerCount() + 1u) * BATCHES_PER_THREAD : 1u;
+        }
+
+        void build(const uint32_t *costs, uint32_t count, uint32_t batchCount)
+        {
+            batchCount = std::max(1u, std::min(batchCount, std::max(count, 1u)));
+
+            // Descending cost, ascending item: one 64-bit key per item.
+            m_keys.resize(count);
+            for (uint32_t i = 0; i < count; ++i)
+                m_keys[i] = (static_cast<uint64_t>(~costs[i]) << 32) | i;
+            std::sort(m_keys.begin(), m_keys.end());
+
+            // Greedy: the lightest batch (lowest index on ties) takes the next item.
+            m_load.assign(batchCount, 0u);
+            m_batchOf.resize(count);
+            m_begin.assign(batchCount + 1u, 0u);
+            for (uint32_t k = 0; k < count; ++k)
+            {
+                const uint32_t b = static_cast<uint32_t>(std::min_element(m_load.begin(), m_load.end()) - m_load.begin());
+                m_load[b] += ~static_cast<uint32_t>(m_keys[k] >> 32);
+                m_batchOf[k] = b;
+                m_begin[b + 1u] += 1u;
+            }
+            for (uint32_t b = 0; b < batchCount; ++b)
+                m_begin[b + 1u] += m_begin[b];
+
+            m_items.resize(count);
+            m_fill.assign(m_begin.begin(), m_begin.end() - 1);
+            for (uint32_t k = 0; k < count; ++k)
+                m_items[m_fill[m_batchOf[k]]++] = static_cast<uint32_t>(m_keys[k]);
+        }
+
+        uint32_t batchCount() const { return m_begin.empty() ? 0u : static_cast<uint32_t>(m_begin.size() - 1u); }
+        uint32_t batchSize(uint32_t b) const { return m_begin[b + 1u] - m_begin[b]; }
+        const uint32_t *batch(uint32_t b) const { return m_items.data() + m_begin[b]; }
+        // Sum of the estimates dealt to batch b.
+        uint64_t batchCost(uint32_t b) const { return m_load[b]; }
+
+        // fn(workerIndex, item) for every item; batches in parallel when jobs is set.
+        template <typename Fn>
+        void run(JobSystem *jobs, const Fn &fn) const
+        {
+            const uint32_t batches = batchCount();
+            auto runBatches = [&](uint32_t worker, uint32_t first, uint32_t last)
+            {
+                for (uint32_t b = first; b < last; ++b)
+                {
+                    const uint32_t *items = batch(b);
+                    const uint32_t size = batchSize(b);
+                    for (uint32_t k = 0; k < size; ++k)
+                        fn(worker, items[k]);
+                }
+            };
+            if (jobs && batches > 1u)
+                jobs->parallelForRange(0u, batches, 1u, runBatches);
+            else
+                runBatches(jobs ? jobs->currentWorkerIndex() : 0u, 0u, batches);
+        }
+
+    private:
+        std::vector<uint64_t> m_keys;    // sorted (~cost << 32 | item)
+        std::vector<uint64_t> m_load;    // per batch
+        std::vector<uint32_t> m_batchOf; // per sorted position
+        std::vector<uint32_t> m_begin;   // batchCount + 1 offsets into m_items
+        std::vector<uint32_t> m_fill;
+        std::vector<uint32_t> m_items;
+    };
+}
@@ -12,6 +12,9 @@
 //   - ArchetypeStoreManager: lazily created SoA stores per archetype.
 //   - EntitiesRecord: control-plane mapping of entity handle -> (archetypeId, row).
 //   - PrefabManager: dictionary of prefabs keyed by name (SampleApp loads JSON and fills it).
+//   - EntityCommandBuffer: deferred structural changes, applied by playbackCommands().
+//   - SparseTagSet per sparse tag (ComponentRegistry::registerSparseTag): addTag/removeTag
+//     on them flip set membership instead of moving the entity.
 //
 // Notes:
 //   - Engine/Application owns lifetime of ECSContext.
@@ -22,18 +25,17 @@
 #include "ECS/ArchetypeManager.h" // ArchetypeManager
 #include "ECS/ArchetypeStore.h"   // ArchetypeStoreManager
 #include "ECS/Entity.h"           // EntitiesRecord
+#include "ECS/EntityCommandBuffer.h" // EntityCommandBuffer
 #include "ECS/Prefab.h"           // PrefabManager
 #include "ECS/QueryManager.h"     // QueryManager
+#include "ECS/SparseTagSet.h"     // SparseTagSet
 #if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
 #include "ECS/EcsTrace.h"
 #endif
+#include <algorithm>
+#include <cstring>
 #include <vector>
 
-namespace Engine
-{
-    class JobSystem;
-}
-
 namespace Engine::ECS
 {
     struct ECSContext
@@ -45,6 +47,7 @@ namespace Engine::ECS
         EntitiesRecord entities;
         PrefabManager prefabs;
         QueryManager queries;
+        EntityCommandBuffer commands;
 
 #if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
         EcsTrace trace;
@@ -59,6 +62,7 @@ namespace Engine::ECS
         {
             stores.setOnStoreCreated([this](uint32_t archetypeId, const ComponentMask &signature)
                                      { this->queries.onStoreCreated(archetypeId, signature); });
+            queries.setRegistry(&components);
 
 #if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
             this->queries.setTrace(&this->trace);
@@ -68,6 +72,7 @@ namespace Engine::ECS
         void SetJobSystem(Engine::JobSystem *js)
         {
             jobSystem = js;
+            commands.setJobSystem(js);
         }
 
         // -------------------------
@@ -92,7 +97,7 @@ namespace Engine::ECS
 
             const Archetype *srcArch = archetypes.get(srcArchetypeId);
             const ComponentMask srcSignature = srcArch ? srcArch->signature : srcStore->signature();
-            if (srcSignature.toKey() == newSignature.toKey())
+            if (srcSignature == newSignature)
                 return true;
 
             const uint32_t dstArchetypeId = archetypes.getOrCreate(newSignature);
@@ -102,39 +107,8 @@ namespace Engine::ECS
 
             const uint32_t dstRow = dstStore->createRow(e);
 
-            // Copy intersection components.
-            if (srcStore->hasPosition() && dstStore->hasPosition())
-                dstStore->positions()[dstRow] = srcStore->positions()[srcRow];
-            if (srcStore->hasVelocity() && dstStore->hasVelocity())
-                dstStore->velocities()[dstRow] = srcStore->velocities()[srcRow];
-            if (srcStore->hasHealth() && dstStore->hasHealth())
-                dstStore->healths()[dstRow] = srcStore->healths()[srcRow];
-            if (srcStore->hasMoveTarget() && dstStore->hasMoveTarget())
-                dstStore->moveTargets()[dstRow] = srcStore->moveTargets()[srcRow];
-            if (srcStore->hasMoveSpeed() && dstStore->hasMoveSpeed())
-                dstStore->moveSpeeds()[dstRow] = srcStore->moveSpeeds()[srcRow];
-            if (srcStore->hasRadius() && dstStore->hasRadius())
-                dstStore->radii()[dstRow] = srcStore->radii()[srcRow];
-            if (srcStore->hasSeparation() && dstStore->hasSeparation())
-                dstStore->separations()[dstRow] = srcStore->separations()[srcRow];
-            if (srcStore->hasAvoidanceParams() && dstStore->hasAvoidanceParams())
-                dstStore->avoidanceParams()[dstRow] = srcStore->avoidanceParams()[srcRow];
-            if (srcStore->hasRenderModel() && dstStore->hasRenderModel())
-                dstStore->renderModels()[dstRow] = srcStore->renderModels()[srcRow];
-            if (srcStore->hasRenderAnimation() && dstStore->hasRenderAnimation())
-                dstStore->renderAnimations()[dstRow] = srcStore->renderAnimations()[srcRow];
-            if (srcStore->hasFacing() && dstStore->hasFacing())
-                dstStore->facings()[dstRow] = srcStore->facings()[srcRow];
-            if (srcStore->hasRenderTransform() && dstStore->hasRenderTransform())
-                dstStore->renderTransforms()[dstRow] = srcStore->renderTransforms()[srcRow];
-            if (srcStore->hasRenderScale() && dstStore->hasRenderScale())
-                dstStore->renderScales()[dstRow] = srcStore->renderScales()[srcRow];
-            if (srcStore->hasPosePalette() && dstStore->hasPosePalette())
-                dstStore->posePalettes()[dstRow] = srcStore->posePalettes()[srcRow];
-            if (srcStore->hasRenderBounds() && dstStore->hasRenderBounds())
-                dstStore->renderBounds()[dstRow] = srcStore->renderBounds()[srcRow];
-            if (srcStore->hasVisibilityState() && dstStore->hasVisibilityState())
-                dstStore->visibilityState()[dstRow] = srcStore->visibilityState()[srcRow];
+            // Move every component both signatures share (source row is destroyed below).
+            dstStore->moveRowFrom(dstRow, *srcStore, srcRow);
 
             // Update mapping for moved entity first (so the source destroy can't leave it stale).
             entities.attach(e, dstArchetypeId, dstRow);
@@ -155,12 +129,208 @@ namespace Engine::ECS
             return true;
         }
 
+        // Destroy an entity and its row; the row swap-moved into its place is marked dirty.
+        bool destroyEntity(Entity e)
+        {
+            const EntityRecord *rec = entities.find(e);
+            if (!rec)
+            {
+                entities.destroy(e);
+                return false;
+            }
+            const uint32_t archetypeId = rec->archetypeId;
+            const uint32_t row = rec->row;
+            ArchetypeStore *store = stores.get(archetypeId);
+            if (store && row < store->size())
+            {
+                const Entity swapped = store->destroyRowSwap(row);
+                if (swapped.valid())
+                {
+                    entities.attach(swapped, archetypeId, row);
+                    queries.markRowDirtyAll(archetypeId, row, store->size());
+                }
+            }
+            for (uint32_t tagId : components.sparseTags())
+            {
+                if (tagId < m_sparseTags.size())
+                    m_sparseTags[tagId].remove(e);
+            }
+            entities.destroy(e);
+            return true;
+        }
+
+        // Reorder a store's rows (new row i was row order[i], a permutation of its rows) and
+        // patch everything keyed by row: entity records and dirty bits. Row components such as
+        // RenderSlot travel with their rows. Sync points only, like playbackCommands().
+        void reorderRows(uint32_t archetypeId, const uint32_t *order)
+        {
+            ArchetypeStore *store = stores.get(archetypeId);
+            if (!store || store->size() < 2u)
+                return;
+            store->permuteRows(order);
+            const std::vector<Entity> &rowEntities = store->entities();
+            for (uint32_t row = 0; row < store->size(); ++row)
+                entities.attach(rowEntities[row], archetypeId, row);
+            queries.permuteRows(archetypeId, order, store->size());
+        }
+
+        // Apply everything recorded in commands (see EntityCommandBuffer.h for the order).
+        // Call at sync points only: no system may be iterating stores or recording meanwhile.
+        void playbackCommands()
+        {
+            EntityCommandBuffer &cb = commands;
+            if (cb.empty())
+                return;
+            EntityCommandBuffer::Stats &stats = cb.m_stats;
+            stats = EntityCommandBuffer::Stats{};
+
+            // 1. Creates, straight into their target archetype.
+            for (EntityCommandBuffer::Lane &lane : cb.m_lanes)
+            {
+                lane.m_created.resize(lane.m_creates.size());
+                ArchetypeStore *store = nullptr;
+                uint32_t archetypeId = UINT32_MAX;
+                for (size_t k = 0; k < lane.m_creates.size(); ++k)
+                {
+                    const ComponentMask &signature = lane.m_creates[k];
+                    if (!store || signature != store->signature())
+                    {
+                        archetypeId = archetypes.getOrCreate(signature);
+                        store = stores.getOrCreate(archetypeId, signature, components);
+                    }
+                    const Entity e = entities.create();
+                    const uint32_t row = store->createRow(e);
+                    entities.attach(e, archetypeId, row);
+                    queries.markRowDirtyAll(archetypeId, row, store->size());
+                    lane.m_created[k] = e;
+                    ++stats.created;
+                }
+            }
+
+            // 2. Fold adds/removes/destroys into one pending change per entity.
+            auto &pending = cb.m_pending;
+            auto &slotOf = m_commandSlotOf;
+            pending.clear();
+            for (EntityCommandBuffer::Lane &lane : cb.m_lanes)
+            {
+                for (const EntityCommandBuffer::Command &cmd : lane.m_commands)
+                {
+                    const Entity e = cb.resolve(cmd.entity);
+                    const EntityRecord *rec = entities.find(e);
+                    if (!rec)
+                    {
+                        ++stats.dropped;
+                        continue;
+                    }
+                    if (e.index >= slotOf.size())
+                        slotOf.resize(static_cast<size_t>(e.index) + 1u, UINT32_MAX);
+                    if (slotOf[e.index] == UINT32_MAX)
+                    {
+                        slotOf[e.index] = static_cast<uint32_t>(pending.size());
+                        EntityCommandBuffer::PendingMove p;
+                        p.entity = e;
+                        p.srcArchetypeId = rec->archetypeId;
+                        const ArchetypeStore *src = stores.get(rec->archetypeId);
+                        p.signature = src ? src->signature() : ComponentMask{};
+                        pending.push_back(p);
+                    }
+                    EntityCommandBuffer::PendingMove &p = pending[slotOf[e.index]];
+                    if (cmd.op == EntityCommandBuffer::Op::Destroy)
+                        p.destroy = true;
+                    else if (SparseTagSet *set = sparseTag(cmd.componentId))
+                        (void)(cmd.op == EntityCommandBuffer::Op::AddComponent ? set->add(e) : set->remove(e));
+                    else if (cmd.op == EntityCommandBuffer::Op::AddComponent)
+                        p.signature.set(cmd.componentId);
+                    else
+                        p.signature.clear(cmd.componentId);
+                }
+            }
+            for (const EntityCommandBuffer::PendingMove &p : pending)
+                slotOf[p.entity.index] = UINT32_MAX;
+
+            // 3. Moves, grouped by (source, destination) archetype.
+            auto &order = cb.m_order;
+            order.clear();
+            for (uint32_t i = 0; i < pending.size(); ++i)
+            {
+                EntityCommandBuffer::PendingMove &p = pending[i];
+                const ArchetypeStore *src = stores.get(p.srcArchetypeId);
+                if (p.destroy || !src || p.signature == src->signature())
+                    continue;
+                p.dstArchetypeId = archetypes.getOrCreate(p.signature);
+                order.push_back(i);
+            }
+            std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b)
+                      {
+                          const auto &pa = pending[a];
+                          const auto &pb = pending[b];
+                          if (pa.srcArchetypeId != pb.srcArchetypeId)
+                              return pa.srcArchetypeId < pb.srcArchetypeId;
+                          if (pa.dstArchetypeId != pb.dstArchetypeId)
+                              return pa.dstArchetypeId < pb.dstArchetypeId;
+                          return a < b; });
+            for (uint32_t i : order)
+            {
+                if (moveEntity(pending[i].entity, pending[i].signature))
+                    ++stats.moved;
+            }
+
+            // 4. Destroys, highest row first per store.
+            order.clear();
+            for (uint32_t i = 0; i < pending.size(); ++i)
+            {
+                EntityCommandBuffer::PendingMove &p = pending[i];
+                if (!p.destroy)
+                    continue;
+                const EntityRecord *rec = entities.find(p.entity);
+                p.srcArchetypeId = rec ? rec->archetypeId : UINT32_MAX;
+                p.row = rec ? rec->row : 0u;
+                order.push_back(i);
+            }
+            std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b)
+                      {
+                          const auto &pa = pending[a];
+                          const auto &pb = pending[b];
+                          if (pa.srcArchetypeId != pb.srcArchetypeId)
+                              return pa.srcArchetypeId < pb.srcArchetypeId;
+                          return pa.row > pb.row; });
+            for (uint32_t i : order)
+            {
+                (void)destroyEntity(pending[i].entity);
+                ++stats.destroyed;
+            }
+
+            // 5. Component writes on the final rows.
+            for (EntityCommandBuffer::Lane &lane : cb.m_lanes)
+            {
+                for (const EntityCommandBuffer::SetCommand &set : lane.m_sets)
+                {
+                    const Entity e = cb.resolve(set.entity);
+                    const EntityRecord *rec = entities.find(e);
+                    ArchetypeStore *store = rec ? stores.get(rec->archetypeId) : nullptr;
+                    ComponentColumn *column = store ? store->findColumn(set.componentId) : nullptr;
+                    if (!column || column->type().typeKey != set.typeKey)
+                    {
+                        ++stats.dropped;
+                        continue;
+                    }
+                    std::memcpy(column->at(rec->row), lane.m_bytes.data() + set.offset, set.size);
+                    markDirty(set.componentId, rec->archetypeId, rec->row);
+                    ++stats.sets;
+                }
+            }
+
+            for (EntityCommandBuffer::Lane &lane : cb.m_lanes)
+                lane.clear();
+        }
+
         // Mark dirty by explicit archetype+row.
         void markDirty(uint32_t compId, uint32_t archetypeId, uint32_t row)
         {
             ArchetypeStore *store = stores.get(archetypeId);
             if (!store)
                 return;
+            store->markChanged(compId, row);
             queries.markDirtyComponent(compId, archetypeId, row, store->size());
         }
 
@@ -173,8 +343,197 @@ namespace Engine::ECS
             markDirty(compId, rec->archetypeId, rec->row);
         }
 
+        // World change version stamped into chunks by markDirty/createRow. SystemScheduler
+        // advances it before every level, so a system that remembers changeVersion() during its
+        // update can later skip chunks with !store.chunkChangedSince(chunk, compId, remembered).
+        uint32_t changeVersion() const { return stores.chunkPool().changeVersion(); }
+        void advanceChangeVersion() { stores.chunkPool().advanceChangeVersion(); }
+
+        // Visit every non-empty chunk of the stores a query matches.
+        // Visitor signature: void(ArchetypeStore &store, uint32_t archetypeId, uint32_t chunk,
+        //                         uint32_t firstRow, uint32_t rowCount)
+        template <typename Visitor>
+        void forEachChunk(QueryId queryId, Visitor &&visit)
+        {
+            for (uint32_t archetypeId : queries.get(queryId).matchingArchetypeIds)
+            {
+                ArchetypeStore *store = stores.get(archetypeId);
+                if (!store)
+                    continue;
+                const uint32_t chunks = store->chunkCount();
+                for (uint32_t c = 0; c < chunks; ++c)
+                {
+                    const uint32_t rows = store->chunkRows(c);
+                    if (rows)
+                        visit(*store, archetypeId, c, c * store->chunkCapacity(), rows);
+                }
+            }
+        }
+
+        // forEachChunk restricted to chunks where compId changed after sinceVersion (a
+        // changeVersion() remembered earlier). Untouched stores are skipped without visiting
+        // their chunks.
+        template <typename Visitor>
+        void forEachChangedChunk(QueryId queryId, uint32_t compId, uint32_t sinceVersion, Visitor &&visit)
+        {
+            for (uint32_t archetypeId : queries.get(queryId).matchingArchetypeIds)
+            {
+                ArchetypeStore *store = stores.get(archetypeId);
+                if (!store || !store->columnChangedSince(compId, sinceVersion))
+                    continue;
+                const uint32_t chunks = store->chunkCount();
+                for (uint32_t c = 0; c < chunks; ++c)
+                {
+                    const uint32_t rows = store->chunkRows(c);
+                    if (rows && store->chunkChangedSince(c, compId, sinceVersion))
+                        visit(*store, archetypeId, c, c * store->chunkCapacity(), rows);
+                }
+            }
+        }
+
+        // -------------------------
+        // Capacity
+        // -------------------------
+        // Room for count more entities of prefab than its store holds or was reserved for:
+        // entity slots, the store's handles, chunks and visibility words, and its dirty
+        // bitsets. Reservations add up until spawns fill them; call once per spawn group before
+        // a large spawn (ScenarioSpawner does). Sync points only.
+        void reserve(const Prefab &prefab, uint32_t count)
+        {
+            if (count == 0)
+                return;
+            ArchetypeStore *store = stores.getOrCreate(prefab.archetypeId, prefab.signature, components);
+            if (!store)
+                return;
+            const uint32_t rows = store->reservedRows() + count;
+            store->reserveRows(rows);
+            queries.reserveRows(prefab.archetypeId, rows);
+            m_reservedEntities = reservedEntities() + count;
+            entities.reserve(m_reservedEntities);
+        }
+
+        // Live entities the world was reserved for (at least the live count); systems with
+        // world-sized buffers (spatial index) pre-size to it.
+        uint32_t reservedEntities() const { return std::max(m_reservedEntities, entities.aliveCount()); }
+
+        // -------------------------
+        // Sparse tags
+        // -------------------------
+        // Membership set of a sparse tag (nullptr if tagId isn't one).
+        SparseTagSet *sparseTag(uint32_t tagId)
+        {
+            if (!components.isSparseTag(tagId))
+                return nullptr;
+            if (tagId >= m_sparseTags.size())
+                m_sparseTags.resize(static_cast<size_t>(tagId) + 1u);
+            return &m_sparseTags[tagId];
+        }
+
+        const SparseTagSet *sparseTag(uint32_t tagId) const
+        {
+            return (tagId < m_sparseTags.size() && components.isSparseTag(tagId)) ? &m_sparseTags[tagId] : nullptr;
+        }
+
+        // True if the entity carries tagId, sparse or in its archetype signature.
+        bool hasTag(Entity e, uint32_t tagId) const
+        {
+            if (components.isSparseTag(tagId))
+            {
+                const SparseTagSet *set = sparseTag(tagId);
+                return set && set->has(e);
+            }
+            const EntityRecord *rec = entities.find(e);
+            const ArchetypeStore *store = rec ? stores.get(rec->archetypeId) : nullptr;
+            return store && store->signature().has(tagId);
+        }
+
+        // Per-entity part of a query match (its sparseRequired/sparseExcluded tags).
+        bool matchesSparse(const Query &q, Entity e) const
+        {
+            for (uint32_t tagId : components.sparseTags())
+            {
+                const bool want = q.sparseRequired.has(tagId);
+                if (!want && !q.sparseExcluded.has(tagId))
+                    continue;
+                const SparseTagSet *set = sparseTag(tagId);
+                if ((set && set->has(e)) != want)
+                    return false;
+            }
+            return true;
+        }
+
+        // Visit every row matching a query, sparse tags included.
+        // Visitor signature: void(ArchetypeStore &store, uint32_t archetypeId, uint32_t row)
+        // A query requiring a sparse tag walks that tag's set instead of the stores (rows come in
+        // set order). The visitor must not add or remove tags or entities.
+        template <typename Visitor>
+        void forEachQueryRow(QueryId queryId, Visitor &&visit)
+        {
+            const Query &q = queries.get(queryId);
+
+            const SparseTagSet *driver = nullptr;
+            for (uint32_t tagId : components.sparseTags())
+            {
+                if (!q.sparseRequired.has(tagId))
+                    continue;
+                const SparseTagSet *set = sparseTag(tagId);
+                if (!set || set->empty())
+                    return;
+                if (!driver || set->size() < driver->size())
+                    driver = set;
+            }
+
+            if (driver)
+            {
+                for (const Entity e : driver->entities())
+                {
+                    const EntityRecord *rec = entities.find(e);
+                    if (!rec || !q.matchesArchetype(rec->archetypeId))
+                        continue;
+                    ArchetypeStore *store = stores.get(rec->archetypeId);
+                    if (!store || rec->row >= store->size() || !matchesSparse(q, e))
+                        continue;
+                    visit(*store, rec->archetypeId, rec->row);
+                }
+                return;
+            }
+
+            const bool filter = !q.sparseExcluded.empty();
+            for (uint32_t archetypeId : q.matchingArchetypeIds)
+            {
+                ArchetypeStore *store = stores.get(archetypeId);
+                if (!store)
+                    continue;
+                const uint32_t n = store->size();
+                const auto &ents = store->entities();
+                for (uint32_t row = 0; row < n; ++row)
+                {
+                    if (!filter || matchesSparse(q, ents[row]))
+                        visit(*store, archetypeId, row);
+                }
+            }
+        }
+
+        // Remove tagId from every entity that has it.
+        void clearTag(uint32_t tagId)
+        {
+            if (SparseTagSet *set = sparseTag(tagId))
+            {
+                set->clear();
+                return;
+            }
+            (void)setTagExclusive(Entity{}, tagId);
+        }
+
         bool addTag(Entity e, uint32_t tagId)
         {
+            if (SparseTagSet *set = sparseTag(tagId))
+            {
+                if (!entities.find(e))
+                    return false;
+                (void)set->add(e);
+                return true;
+            }
             const EntityRecord *rec = entities.find(e);
             if (!rec)
                 return false;
@@ -190,6 +549,13 @@ namespace Engine::ECS
 
         bool removeTag(Entity e, uint32_t tagId)
         {
+            if (SparseTagSet *set = sparseTag(tagId))
+            {
+                if (!entities.find(e))
+                    return false;
+                (void)set->remove(e);
+                return true;
+            }
             const EntityRecord *rec = entities.find(e);
             if (!rec)
                 return false;
@@ -207,6 +573,12 @@ namespace Engine::ECS
         // then adds it to target.
         bool setTagExclusive(Entity target, uint32_t tagId)
         {
+            if (SparseTagSet *set = sparseTag(tagId))
+            {
+                set->clear();
+                return target.valid() && addTag(target, tagId);
+            }
+
             std::vector<Entity> toClear;
             for (const auto &ptr : stores.stores())
             {
@@ -246,6 +618,10 @@ namespace Engine::ECS
             entities = EntitiesRecord{};
             prefabs = PrefabManager{};
             queries = QueryManager{};
+            commands.setJobSystem(js);
+            m_commandSlotOf.clear();
+            m_sparseTags.clear();
+            m_reservedEntities = 0; // the next world reserves for its own battle
 
 #if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
             trace.beginFrame();
@@ -253,5 +629,10 @@ namespace Engine::ECS
 
             jobSystem = js;
         }
+
+    private:
+        uint32_t m_reservedEntities = 0;
+        std::vector<uint32_t> m_commandSlotOf; // playbackCommands scratch: entity index -> pending change
+        std::vector<SparseTagSet> m_sparseTags; // by tag id; only sparse tags' entries are used
     };
 }
\ No newline at end of file
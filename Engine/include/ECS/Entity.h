@@ -10,12 +10,16 @@
   Usage:
     - Use EntitiesRecord.create() to get a fresh Entity.
     - After creating a row in an archetype store, call EntitiesRecord.attach(entity, archetypeId, row).
-    - Use EntitiesRecord.find(entity) to get quick O(1) location info for per-entity operations.
+    - Use EntitiesRecord.find(entity) to get quick O(1) location info for per-entity operations
+      (a dense array lookup validated by generation).
+    - create(out, count) / destroy(entities, count) for bulk spawns and despawns.
+    - slots()/freeList()/restore() expose the raw table for world snapshots.
 */
 
+#include <algorithm>
 #include <cstdint>
+#include <utility>
 #include <vector>
-#include <unordered_map>
 
 namespace Engine::ECS
 {
@@ -36,6 +40,9 @@ namespace Engine::ECS
     };
 
     // Central registry for creating/destroying entities and tracking their store membership.
+    // Records live in a dense array indexed by Entity::index next to the index's generation, so
+    // find() is one bounds check and one generation compare. Pointers returned by find() stay
+    // valid until the next create()/reserve() grows the array.
     class EntitiesRecord
     {
     public:
@@ -51,11 +58,24 @@ namespace Engine::ECS
             }
             else
             {
-                idx = static_cast<uint32_t>(m_generations.size());
-                m_generations.emplace_back(0);
+                idx = static_cast<uint32_t>(m_slots.size());
+                m_slots.emplace_back();
             }
-            ++m_generations[idx]; // new generation marks the handle as alive
-            return Entity{idx, m_generations[idx]};
+            Slot &slot = m_slots[idx];
+            ++slot.generation; // new generation marks the handle as alive
+            slot.record = EntityRecord{};
+            ++m_alive;
+            return Entity{idx, slot.generation};
+        }
+
+        // Create count entities into out (freelist first, then one growth for the rest).
+        void create(Entity *out, uint32_t count)
+        {
+            const size_t fromFree = std::min<size_t>(count, m_free.size());
+            const size_t fresh = count - fromFree;
+            m_slots.reserve(m_slots.size() + fresh);
+            for (uint32_t i = 0; i < count; ++i)
+                out[i] = create();
         }
 
         // Destroy an entity: erase record and invalidate handle via generation bump.
@@ -63,15 +83,41 @@ namespace Engine::ECS
         {
             if (!isAlive(e))
                 return;
-            m_records.erase(e.index);
-            ++m_generations[e.index];
+            Slot &slot = m_slots[e.index];
+            slot.record = EntityRecord{};
+            ++slot.generation;
             m_free.push_back(e.index);
+            --m_alive;
+        }
+
+        void destroy(const Entity *entities, uint32_t count)
+        {
+            m_free.reserve(m_free.size() + count);
+            for (uint32_t i = 0; i < count; ++i)
+                destroy(entities[i]);
+        }
+
+        // Make room for count live entities without reallocating.
+        void reserve(uint32_t count)
+        {
+            const size_t available = static_cast<size_t>(m_alive) + m_free.size();
+            if (count > available)
+                m_slots.reserve(m_slots.size() + (count - available));
+        }
+
+        uint32_t aliveCount() const { return m_alive; }
+
+        // Heap bytes of the slot table and freelist.
+        uint64_t memoryBytes() const
+        {
+            return static_cast<uint64_t>(m_slots.capacity()) * sizeof(Slot) +
+                   static_cast<uint64_t>(m_free.capacity()) * sizeof(uint32_t);
         }
 
         // Is the entity currently alive?
         bool isAlive(Entity e) const
         {
-            return e.index < m_generations.size() && m_generations[e.index] == e.generation;
+            return e.index < m_slots.size() && m_slots[e.index].generation == e.generation;
         }
 
         // Attach the entity to an archetype store and row.
@@ -79,7 +125,7 @@ namespace Engine::ECS
         {
             if (!isAlive(e))
                 return;
-            m_records[e.index] = EntityRecord{archetypeId, row};
+            m_slots[e.index].record = EntityRecord{archetypeId, row};
         }
 
         // Detach the entity (remove its mapping).
@@ -87,7 +133,7 @@ namespace Engine::ECS
         {
             if (!isAlive(e))
                 return;
-            m_records.erase(e.index);
+            m_slots[e.index].record = EntityRecord{};
         }
 
         // Find record; returns nullptr if missing or dead.
@@ -95,22 +141,39 @@ namespace Engine::ECS
         {
             if (!isAlive(e))
                 return nullptr;
-            auto it = m_records.find(e.index);
-            return (it != m_records.end()) ? &it->second : nullptr;
+            const EntityRecord &rec = m_slots[e.index].record;
+            return rec.archetypeId != UINT32_MAX ? &rec : nullptr;
         }
 
         EntityRecord *find(Entity e)
         {
             if (!isAlive(e))
                 return nullptr;
-            auto it = m_records.find(e.index);
-            return (it != m_records.end()) ? &it->second : nullptr;
+            EntityRecord &rec = m_slots[e.index].record;
+            return rec.archetypeId != UINT32_MAX ? &rec : nullptr;
+        }
+
+        struct Slot
+        {
+            uint32_t generation = 0; // live while it matches the handle's generation
+            EntityRecord record;     // archetypeId == UINT32_MAX: not attached
+        };
+
+        // Raw state for world snapshots (ECS/WorldSnapshot.h). restore() replaces everything;
+        // every index not on the freelist counts as alive.
+        const std::vector<Slot> &slots() const { return m_slots; }
+        const std::vector<uint32_t> &freeList() const { return m_free; }
+        void restore(std::vector<Slot> slots, std::vector<uint32_t> freeList)
+        {
+            m_slots = std::move(slots);
+            m_free = std::move(freeList);
+            m_alive = static_cast<uint32_t>(m_slots.size() - std::min(m_slots.size(), m_free.size()));
         }
 
     private:
-        std::vector<uint32_t> m_generations;                  // generation per index
-        std::vector<uint32_t> m_free;                         // freelist of indices
-        std::unordered_map<uint32_t, EntityRecord> m_records; // index -> record
+        std::vector<Slot> m_slots;   // per index
+        std::vector<uint32_t> m_free; // freelist of indices
+        uint32_t m_alive = 0;
     };
 
 } // namespace Engine::ECS
\ No newline at end of file
@@ -0,0 +1,200 @@
+#pragma once
+/*
+  EntityCommandBuffer.h
+  ---------------------
+  Purpose:
+    - Record structural changes (create, destroy, add/remove component or tag) and component
+      writes while queries are being iterated, and apply them later at a sync point.
+    - One recording lane per JobSystem thread (parallelFor worker index), so systems running in
+      parallel levels or inside parallelFor bodies record without locks.
+
+  Usage:
+    - ecs.commands.writer() (or writer(workerIndex) inside a parallelFor body) returns the
+      calling thread's lane:
+        auto &cmd = ecs.commands.writer();
+        cmd.addComponent(e, deadId);
+        cmd.destroy(other);
+        Entity spawned = cmd.create(signature);   // deferred handle, valid inside this buffer
+        cmd.set(spawned, positionId, Position{x, 0.0f, z});
+    - ECSContext::playbackCommands() applies everything; SystemScheduler calls it after every
+      level. Per entity, a lane's commands apply in recording order; the relative order of two
+      lanes touching the same entity is unspecified.
+
+  Playback (ECSContext::playbackCommands):
+    - Creates first (rows created in the target archetype directly), then one move per entity
+      to its final signature (adds/removes folded), sorted by (source, destination) archetype,
+      then destroys sorted by (archetype, row descending) so swap-removes never move a row that
+      is about to be destroyed, then component writes.
+    - set<T>() requires trivially copyable T (values are kept as bytes in the lane).
+*/
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+#include "ECS/Components.h"
+#include "ECS/Entity.h"
+#include "utils/JobSystem.h"
+
+namespace Engine::ECS
+{
+    struct ECSContext;
+
+    class EntityCommandBuffer
+    {
+    public:
+        // Deferred entities (from create()) carry generation 0, which live handles never have,
+        // and the recording lane in the top bits of the index.
+        static constexpr uint32_t DEFERRED_LANE_SHIFT = 24;
+        static bool isDeferred(Entity e) { return e.valid() && e.generation == 0u; }
+
+        enum class Op : uint8_t
+        {
+            Destroy,
+            AddComponent,
+            RemoveComponent,
+        };
+
+        struct Command
+        {
+            Entity entity;
+            uint32_t componentId = ComponentRegistry::InvalidID;
+            Op op = Op::Destroy;
+        };
+
+        struct SetCommand
+        {
+            Entity entity;
+            uint32_t componentId = ComponentRegistry::InvalidID;
+            const void *typeKey = nullptr; // componentTypeKey<T>()
+            uint32_t offset = 0; // into Lane::bytes
+            uint32_t size = 0;
+        };
+
+        class Lane
+        {
+        public:
+            Entity create(const ComponentMask &signature)
+            {
+                const uint32_t k = static_cast<uint32_t>(m_creates.size());
+                m_creates.push_back(signature);
+                return Entity{(m_index << DEFERRED_LANE_SHIFT) | k, 0u};
+            }
+
+            void destroy(Entity e) { m_commands.push_back(Command{e, ComponentRegistry::InvalidID, Op::Destroy}); }
+            void addComponent(Entity e, uint32_t componentId) { m_commands.push_back(Command{e, componentId, Op::AddComponent}); }
+            void removeComponent(Entity e, uint32_t componentId) { m_commands.push_back(Command{e, componentId, Op::RemoveComponent}); }
+
+            // Write value into the entity's componentId column after structural changes applied.
+            template <typename T>
+            void set(Entity e, uint32_t componentId, const T &value)
+            {
+                static_assert(std::is_trivially_copyable_v<T>, "EntityCommandBuffer::set needs a trivially copyable component");
+                const uint32_t offset = static_cast<uint32_t>((m_bytes.size() + alignof(T) - 1u) & ~(alignof(T) - 1u));
+                m_bytes.resize(offset + sizeof(T));
+                std::memcpy(m_bytes.data() + offset, &value, sizeof(T));
+                m_sets.push_back(SetCommand{e, componentId, componentTypeKey<T>(), offset, static_cast<uint32_t>(sizeof(T))});
+            }
+
+            bool empty() const { return m_creates.empty() && m_commands.empty() && m_sets.empty(); }
+
+        private:
+            friend class EntityCommandBuffer;
+            friend struct ECSContext;
+
+            void clear()
+            {
+                m_creates.clear();
+                m_created.clear();
+                m_commands.clear();
+                m_sets.clear();
+                m_bytes.clear();
+            }
+
+            uint32_t m_index = 0;
+            std::vector<ComponentMask> m_creates;
+            std::vector<Entity> m_created; // playback: resolved create() handles
+            std::vector<Command> m_commands;
+            std::vector<SetCommand> m_sets;
+            std::vector<unsigned char> m_bytes;
+        };
+
+        struct Stats
+        {
+            uint32_t created = 0;
+            uint32_t moved = 0;
+            uint32_t destroyed = 0;
+            uint32_t sets = 0;
+            uint32_t dropped = 0; // commands on dead or unknown entities
+        };
+
+        EntityCommandBuffer() { setJobSystem(nullptr); }
+
+        EntityCommandBuffer(const EntityCommandBuffer &) = delete;
+        EntityCommandBuffer &operator=(const EntityCommandBuffer &) = delete;
+
+        // One lane per parallelFor worker index. Not while recording (ECSContext::SetJobSystem).
+        void setJobSystem(const Engine::JobSystem *jobs)
+        {
+            m_jobs = jobs;
+            const uint32_t lanes = (jobs ? jobs->workerCount() : 0u) + 1u;
+            m_lanes = std::vector<Lane>(lanes);
+            for (uint32_t i = 0; i < lanes; ++i)
+                m_lanes[i].m_index = i;
+        }
+
+        // Lane of the calling thread.
+        Lane &writer() { return writer(m_jobs ? m_jobs->currentWorkerIndex() : 0u); }
+
+        // Lane for a parallelFor workerIndex (only that thread may use it until playback).
+        Lane &writer(uint32_t workerIndex)
+        {
+            return m_lanes[workerIndex < m_lanes.size() ? workerIndex : m_lanes.size() - 1u];
+        }
+
+        bool empty() const
+        {
+            for (const Lane &lane : m_lanes)
+            {
+                if (!lane.empty())
+                    return false;
+            }
+            return true;
+        }
+
+        // Counters of the last playback.
+        const Stats &lastStats() const { return m_stats; }
+
+    private:
+        friend struct ECSContext;
+
+        // Resolve a deferred handle from create() (after creates were played back).
+        Entity resolve(Entity e) const
+        {
+            if (!isDeferred(e))
+                return e;
+            const uint32_t lane = e.index >> DEFERRED_LANE_SHIFT;
+            const uint32_t k = e.index & ((1u << DEFERRED_LANE_SHIFT) - 1u);
+            if (lane >= m_lanes.size() || k >= m_lanes[lane].m_created.size())
+                return Entity{};
+            return m_lanes[lane].m_created[k];
+        }
+
+        // Playback scratch: one structural change per entity.
+        struct PendingMove
+        {
+            Entity entity;
+            uint32_t srcArchetypeId = UINT32_MAX;
+            uint32_t dstArchetypeId = UINT32_MAX;
+            uint32_t row = 0;
+            ComponentMask signature;
+            bool destroy = false;
+        };
+
+        const Engine::JobSystem *m_jobs = nullptr; // not owned
+        std::vector<Lane> m_lanes;
+        std::vector<PendingMove> m_pending;
+        std::vector<uint32_t> m_order;
+        Stats m_stats{};
+    };
+}
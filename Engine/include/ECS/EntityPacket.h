@@ -0,0 +1,87 @@
+#pragma once
+/*
+  EntityPacket.h
+  --------------
+  Purpose:
+    - Serialize a chosen set of entities (not the whole world) into a byte buffer that another
+      ECSContext can read: units migrating between simulation shards, ghost copies of units near
+      a shard border (WorldShard.h).
+
+  Format (native endianness, sections 16-byte aligned; see SnapshotFormat.h):
+    - EntityPacketHeader
+    - Component table of the sender's registry
+    - Per archetype of the packed entities: StoreRecord, signature, the sender's Entity handles
+      and one blob per trivially copyable column, rows in the sender's store order.
+
+  Usage:
+    - Sender:   packEntities(ecs, units.data(), n, excluded, bytes);
+    - Receiver: EntityPacketReader r; r.open(bytes.data(), bytes.size(), ecs.components, err);
+                for each r.stores() view and row: unpackRow(ecs, view, row)            // new entity
+                                                  unpackRowInto(ecs, view, row, e)  // refresh e
+
+  Notes:
+    - Entity handles in the packet and inside components are the sender's. unpacking
+      clears CombatMemory::targetEnemy (the unit scans again) along with the process-local
+      handles resetForeignHandles drops; RenderModel handles are kept, so packets only move
+      between worlds that share an AssetManager (or have none: headless servers).
+    - Sparse tags are not carried; the receiver applies its own.
+*/
+
+#include "ECS/Components.h"
+#include "ECS/SnapshotFormat.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Engine::ECS
+{
+    struct ECSContext;
+
+    static constexpr uint32_t ENTITY_PACKET_MAGIC = 0x544B5053u; // "SPKT"
+    static constexpr uint32_t ENTITY_PACKET_VERSION = 1;
+
+    struct EntityPacketHeader
+    {
+        uint32_t magic = ENTITY_PACKET_MAGIC;
+        uint32_t version = ENTITY_PACKET_VERSION;
+        uint32_t componentCount = 0;
+        uint32_t storeCount = 0;
+    };
+
+    static_assert(sizeof(EntityPacketHeader) == 16, "EntityPacketHeader is a wire format struct");
+
+    // Replaces out with a packet of the live entities among entities[0..count) (empty when none is
+    // alive) and returns how many were packed. Components in `excluded` are left out of the packed
+    // signatures: receivers get entities without them.
+    uint32_t packEntities(const ECSContext &ecs, const Entity *entities, uint32_t count, const ComponentMask &excluded,
+                          std::vector<uint8_t> &out);
+
+    // Views into a packet's bytes; the buffer must outlive the reader.
+    class EntityPacketReader
+    {
+    public:
+        bool open(const uint8_t *data, size_t size, ComponentRegistry &registry, std::string &outError);
+
+        const std::vector<SnapshotStoreView> &stores() const { return m_stores; }
+        uint32_t entityCount() const { return m_entityCount; }
+
+        // Copies the packed columns of one row over dstStore's row; columns dstStore lacks are skipped.
+        static void copyRow(const SnapshotStoreView &store, uint32_t row, ArchetypeStore &dstStore, uint32_t dstRow);
+
+    private:
+        std::vector<SnapshotStoreView> m_stores;
+        uint32_t m_entityCount = 0;
+    };
+
+    // Creates a new entity from one packed row, with the packet's signature; rows are marked dirty.
+    Entity unpackRow(ECSContext &ecs, const SnapshotStoreView &store, uint32_t row);
+
+    // Overwrites an existing entity with one packed row: it moves to the packet's signature first
+    // (sparse tags stay), so handles other entities hold to it stay valid.
+    bool unpackRowInto(ECSContext &ecs, const SnapshotStoreView &store, uint32_t row, Entity existing);
+
+    // The fix-ups both apply to rows [first, first + count) of a store: the sender's cache handles
+    // (resetForeignHandles) and CombatMemory::targetEnemy.
+    void resetPacketHandles(const ComponentRegistry &registry, ArchetypeStore &store, uint32_t first, uint32_t count);
+}
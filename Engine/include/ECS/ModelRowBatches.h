@@ -0,0 +1,116 @@
+#pragma once
+/*
+  ModelRowBatches.h
+  -----------------
+  Purpose:
+    - Group the rows a system is about to process by their RenderModel handle, so every
+      instance of one model is handled back to back and the model's clips, channels and
+      skins stay in cache instead of alternating between models from row to row.
+
+  Usage:
+    - build(models, storeSize, rows, rowCount, assets) once per archetype pass; rows == nullptr
+      groups every row [0, rowCount). Then walk batches(): each one is a range of rows() that
+      share a handle, with the asset resolved once (nullptr while not resident).
+    - batchIndexOf(position) maps a position in rows() back to its batch, for passes that
+      permute the grouped rows again (PoseUpdateSystem's pose sharing).
+
+  Notes:
+    - A counting sort over a dense per-pass model index: O(rows + models), stable within a
+      model, batches in order of each model's first row. Deterministic for a given input.
+    - Rows >= storeSize are dropped (callers skip them anyway).
+*/
+
+#include "ECS/Components.h"
+#include "assets/AssetManager.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace Engine::ECS
+{
+    class ModelRowBatches
+    {
+    public:
+        struct Batch
+        {
+            ModelHandle handle;
+            ModelAsset *asset = nullptr;
+            uint32_t begin = 0; // range in rows()
+            uint32_t end = 0;
+        };
+
+        template <typename ModelColumn>
+        void build(const ModelColumn &models, uint32_t storeSize, const uint32_t *rows, uint32_t rowCount,
+                   const AssetManager &assets)
+        {
+            m_batches.clear();
+            m_modelIndex.clear();
+            m_keys.clear();
+            m_rowsIn.clear();
+
+            // 1) Dense model index per row (consecutive rows usually share a model).
+            uint64_t lastKey = 0;
+            uint32_t lastIndex = UINT32_MAX;
+            for (uint32_t i = 0; i < rowCount; ++i)
+            {
+                const uint32_t row = rows ? rows[i] : i;
+                if (row >= storeSize)
+                    continue;
+                const ModelHandle handle = models[row].handle;
+                const uint64_t key = (static_cast<uint64_t>(handle.generation) << 32) | static_cast<uint64_t>(handle.id);
+                if (lastIndex == UINT32_MAX || key != lastKey)
+                {
+                    auto it = m_modelIndex.try_emplace(key, static_cast<uint32_t>(m_batches.size())).first;
+                    if (it->second == m_batches.size())
+                    {
+                        Batch b;
+                        b.handle = handle;
+                        b.asset = assets.getModel(handle);
+                        m_batches.push_back(b);
+                    }
+                    lastKey = key;
+                    lastIndex = it->second;
+                }
+                m_keys.push_back(lastIndex);
+                m_rowsIn.push_back(row);
+                m_batches[lastIndex].end += 1u; // count for now
+            }
+
+            // 2) Prefix sums: counts become ranges.
+            uint32_t offset = 0;
+            for (Batch &b : m_batches)
+            {
+                const uint32_t count = b.end;
+                b.begin = offset;
+                b.end = offset;
+                offset += count;
+            }
+
+            // 3) Stable scatter; end advances to its final value.
+            m_rows.resize(offset);
+            m_batchOf.resize(offset);
+            for (uint32_t i = 0; i < offset; ++i)
+            {
+                const uint32_t b = m_keys[i];
+                const uint32_t at = m_batches[b].end++;
+                m_rows[at] = m_rowsIn[i];
+                m_batchOf[at] = b;
+            }
+        }
+
+        const std::vector<Batch> &batches() const { return m_batches; }
+        const std::vector<uint32_t> &rows() const { return m_rows; }
+        uint32_t batchIndexOf(uint32_t position) const { return m_batchOf[position]; }
+
+    private:
+        std::vector<Batch> m_batches;
+        std::vector<uint32_t> m_rows;    // grouped by batch
+        std::vector<uint32_t> m_batchOf; // parallel to m_rows
+
+        // build() scratch, reused across passes.
+        std::unordered_map<uint64_t, uint32_t> m_modelIndex;
+        std::vector<uint32_t> m_keys;   // batch per input row
+        std::vector<uint32_t> m_rowsIn; // input rows that passed the bounds check
+    };
+}
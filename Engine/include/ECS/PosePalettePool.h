@@ -0,0 +1,245 @@
+#pragma once
+/*
+  PosePalettePool.h
+  -----------------
+  Purpose:
+    - Storage behind PosePalette: one pool per model keeps the node palettes, joint palettes
+      and key cursors of all its instances in three contiguous arrays, one fixed-stride slot
+      per entity. The component only holds the slot (PosePalette::palettePool / paletteSlot),
+      so it stays trivially copyable and archetype moves, snapshots and packets copy it as bytes.
+
+  Usage:
+    - PoseUpdateSystem owns the pool (palettePool()) and hands out slots serially before
+      evaluating: acquire(modelKey, nodes, joints, cursors, entity, pose). Evaluation then
+      writes nodes(pose) / joints(pose) / cursors(pose) in place, one writer per slot.
+    - RenderSystem reads the palettes through setPosePalettePool().
+
+  Notes:
+    - A slot belongs to the entity that acquired it. A row whose PosePalette was copied from
+      another entity doesn't own() the slot and gets its own on its next evaluation.
+    - sweep() walks a bounded number of slots per call and frees the ones whose owner died or
+      no longer points at them (PosePalette removed, model switched).
+    - acquire() may grow the arrays: pointers into the pool are valid until the next acquire().
+*/
+
+#include "ECS/ECSContext.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace Engine::ECS
+{
+    class PosePalettePool
+    {
+    public:
+        struct Stats
+        {
+            uint32_t pools = 0;
+            uint32_t slots = 0;     // allocated, live or free
+            uint32_t liveSlots = 0;
+            uint64_t bytes = 0;     // capacity of the palette and cursor arrays
+        };
+
+        // Pool index + 1 in PosePalette::palettePool; 0 = no slot.
+        static constexpr uint32_t NoPool = 0;
+
+        // Gives pose a slot in the pool of modelKey (created with these strides on first use),
+        // releasing the slot it held in another pool. A slot it already owns there is kept.
+        // A new slot starts with zero cursors and pose.keyCursorClip reset.
+        void acquire(uint64_t modelKey, uint32_t nodeCount, uint32_t jointCount, uint32_t cursorCount,
+                     Entity owner, PosePalette &pose)
+        {
+            auto it = m_poolByModel.find(modelKey);
+            if (it == m_poolByModel.end())
+            {
+                it = m_poolByModel.emplace(modelKey, static_cast<uint32_t>(m_pools.size())).first;
+                ModelPool pool;
+                pool.modelKey = modelKey;
+                pool.nodeStride = nodeCount;
+                pool.jointStride = jointCount;
+                pool.cursorStride = cursorCount;
+                m_pools.push_back(std::move(pool));
+            }
+            const uint32_t poolIndex = it->second;
+            if (pose.palettePool == poolIndex + 1u && owns(pose, owner))
+                return;
+            release(pose, owner);
+
+            ModelPool &pool = m_pools[poolIndex];
+            uint32_t slot;
+            if (!pool.freeSlots.empty())
+            {
+                slot = pool.freeSlots.back();
+                pool.freeSlots.pop_back();
+            }
+            else
+            {
+                slot = static_cast<uint32_t>(pool.owners.size());
+                pool.owners.emplace_back();
+                pool.nodes.resize(pool.nodes.size() + pool.nodeStride, glm::mat4(1.0f));
+                pool.joints.resize(pool.joints.size() + pool.jointStride, glm::mat4(1.0f));
+                pool.cursors.resize(pool.cursors.size() + pool.cursorStride, 0u);
+            }
+            pool.owners[slot] = owner;
+            pool.live += 1u;
+            std::fill_n(pool.cursors.begin() + static_cast<std::ptrdiff_t>(static_cast<size_t>(slot) * pool.cursorStride),
+                        pool.cursorStride, 0u);
+
+            pose.palettePool = poolIndex + 1u;
+            pose.paletteSlot = slot;
+            pose.keyCursorClip = UINT32_MAX;
+        }
+
+        // Frees pose's slot if owner holds it; pose is left without one either way.
+        void release(PosePalette &pose, Entity owner)
+        {
+            if (owns(pose, owner))
+                freeSlot(pose.palettePool - 1u, pose.paletteSlot);
+            pose.palettePool = NoPool;
+            pose.paletteSlot = 0;
+        }
+
+        bool owns(const PosePalette &pose, Entity owner) const
+        {
+            const ModelPool *pool = poolOf(pose);
+            if (!pool)
+                return false;
+            const Entity &o = pool->owners[pose.paletteSlot];
+            return o.index == owner.index && o.generation == owner.generation;
+        }
+
+        // nodeCount / jointCount / cursorCount matrices (entries) of pose's slot; nullptr
+        // without a slot or when the model has none.
+        glm::mat4 *nodes(const PosePalette &pose) { return slotData(pose, &ModelPool::nodes, &ModelPool::nodeStride); }
+        const glm::mat4 *nodes(const PosePalette &pose) const { return const_cast<PosePalettePool *>(this)->nodes(pose); }
+        glm::mat4 *joints(const PosePalette &pose) { return slotData(pose, &ModelPool::joints, &ModelPool::jointStride); }
+        const glm::mat4 *joints(const PosePalette &pose) const { return const_cast<PosePalettePool *>(this)->joints(pose); }
+        uint32_t *cursors(const PosePalette &pose) { return slotData(pose, &ModelPool::cursors, &ModelPool::cursorStride); }
+
+        // Checks up to maxSlots slots (round robin over all pools) and frees the stale ones.
+        // Pools left without live slots give their memory back. Returns the slots freed.
+        uint32_t sweep(const ECSContext &ecs, uint32_t maxSlots)
+        {
+            uint32_t freed = 0;
+            for (uint32_t visited = 0; visited < maxSlots && !m_pools.empty();)
+            {
+                if (m_sweepPool >= m_pools.size())
+                {
+                    m_sweepPool = 0;
+                    m_sweepSlot = 0;
+                }
+                ModelPool &pool = m_pools[m_sweepPool];
+                if (m_sweepSlot >= pool.owners.size())
+                {
+                    if (pool.live == 0u && !pool.owners.empty())
+                        pool.release();
+                    ++m_sweepPool;
+                    m_sweepSlot = 0;
+                    if (m_sweepPool >= m_pools.size())
+                        break; // one lap per call at most
+                    continue;
+                }
+
+                const uint32_t slot = m_sweepSlot++;
+                ++visited;
+                const Entity owner = pool.owners[slot];
+                if (!owner.valid())
+                    continue;
+                const EntityRecord *rec = ecs.entities.find(owner);
+                const ArchetypeStore *store = rec ? ecs.stores.get(rec->archetypeId) : nullptr;
+                const bool held = store && store->hasPosePalette() && rec->row < store->size() &&
+                                  store->posePalettes()[rec->row].palettePool == m_sweepPool + 1u &&
+                                  store->posePalettes()[rec->row].paletteSlot == slot;
+                if (!held)
+                {
+                    freeSlot(m_sweepPool, slot);
+                    ++freed;
+                }
+            }
+            return freed;
+        }
+
+        // Drops every pool (world reset); poses keep their handles, which no longer resolve.
+        void clear()
+        {
+            m_pools.clear();
+            m_poolByModel.clear();
+            m_sweepPool = 0;
+            m_sweepSlot = 0;
+        }
+
+        Stats stats() const
+        {
+            Stats s;
+            s.pools = static_cast<uint32_t>(m_pools.size());
+            for (const ModelPool &pool : m_pools)
+            {
+                s.slots += static_cast<uint32_t>(pool.owners.size());
+                s.liveSlots += pool.live;
+                s.bytes += (pool.nodes.capacity() + pool.joints.capacity()) * sizeof(glm::mat4) +
+                           pool.cursors.capacity() * sizeof(uint32_t);
+            }
+            return s;
+        }
+
+    private:
+        struct ModelPool
+        {
+            uint64_t modelKey = 0;
+            uint32_t nodeStride = 0;
+            uint32_t jointStride = 0;
+            uint32_t cursorStride = 0;
+            uint32_t live = 0;
+            std::vector<glm::mat4> nodes;
+            std::vector<glm::mat4> joints;
+            std::vector<uint32_t> cursors;
+            std::vector<Entity> owners; // invalid Entity = free slot
+            std::vector<uint32_t> freeSlots;
+
+            // Every slot gone and the arrays' memory given back; key and strides stay.
+            void release()
+            {
+                live = 0;
+                std::vector<glm::mat4>().swap(nodes);
+                std::vector<glm::mat4>().swap(joints);
+                std::vector<uint32_t>().swap(cursors);
+                std::vector<Entity>().swap(owners);
+                std::vector<uint32_t>().swap(freeSlots);
+            }
+        };
+
+        const ModelPool *poolOf(const PosePalette &pose) const
+        {
+            if (pose.palettePool == NoPool || pose.palettePool > m_pools.size())
+                return nullptr;
+            const ModelPool &pool = m_pools[pose.palettePool - 1u];
+            return pose.paletteSlot < pool.owners.size() ? &pool : nullptr;
+        }
+
+        template <typename T>
+        T *slotData(const PosePalette &pose, std::vector<T> ModelPool::*array, uint32_t ModelPool::*stride)
+        {
+            ModelPool *pool = const_cast<ModelPool *>(poolOf(pose));
+            if (!pool || pool->*stride == 0u)
+                return nullptr;
+            return (pool->*array).data() + static_cast<size_t>(pose.paletteSlot) * (pool->*stride);
+        }
+
+        void freeSlot(uint32_t poolIndex, uint32_t slot)
+        {
+            ModelPool &pool = m_pools[poolIndex];
+            pool.owners[slot] = Entity{};
+            pool.freeSlots.push_back(slot);
+            pool.live -= 1u;
+        }
+
+        std::vector<ModelPool> m_pools;
+        std::unordered_map<uint64_t, uint32_t> m_poolByModel; // model key -> pool index
+        uint32_t m_sweepPool = 0;
+        uint32_t m_sweepSlot = 0;
+    };
+}
@@ -5,13 +5,17 @@
   Purpose:
     - Define Prefab (name, signature, archetypeId, typed defaults).
     - Define PrefabManager (dictionary keyed by name).
-    - Provide JSON loader for Prefabs; constructs signature masks from ComponentRegistry,
-      validates defaults, and resolves archetype via ArchetypeManager.
+    - Provide JSON loader for Prefabs (nlohmann::json, in Prefab.cpp); constructs signature
+      masks from ComponentRegistry, validates defaults, resolves archetype via ArchetypeManager
+      and compiles the defaults into a PrefabImage.
 
   Usage:
     - std::string text = readFileText("Sample/Entity.json");
     - Prefab p = loadPrefabFromJson(text, registry, archetypes, assets);
     - PrefabManager.add(p);
+    - Pass streamModels = true to request models through AssetManager::requestModel instead of
+      loading them synchronously. RenderBounds then keep their defaults until the model is
+      resident; see refreshStreamedModelBounds() in PrefabSpawner.h.
 */
 
 #include <string>
@@ -20,14 +24,19 @@
 #include <cstdint>
 #include <fstream>
 #include <sstream>
-#include <regex>
+#include <type_traits>
 #include <vector>
-#include <iostream>
 #include <cmath>
 
 #include "ECS/Components.h"
 #include "ECS/ArchetypeManager.h"
-#include "assets/AssetManager.h"
+#include "ECS/PrefabImage.h"
+#include "assets/Handles.h"
+
+namespace Engine
+{
+    class AssetManager;
+}
 
 namespace Engine::ECS
 {
@@ -38,6 +47,24 @@ namespace Engine::ECS
         ComponentMask signature; // built from component IDs
         uint32_t archetypeId = UINT32_MAX;
         std::unordered_map<uint32_t, DefaultValue> defaults; // compId -> typed default
+        PrefabImage image;                                    // defaults compiled for spawning
+
+        // Rebuild image from defaults (call after changing defaults).
+        void compile()
+        {
+            image.clear();
+            for (const auto &kv : defaults)
+            {
+                std::visit([&](const auto &value)
+                           {
+                               using T = std::decay_t<decltype(value)>;
+                               if constexpr (std::is_trivially_copyable_v<T>)
+                                   image.append(kv.first, componentTypeKey<T>(), &value, sizeof(T), alignof(T));
+                               else
+                                   image.variantIds.push_back(kv.first); },
+                           kv.second);
+            }
+        }
 
         // Validate that defaults only include components present in the signature.
         bool validateDefaults() const
@@ -58,7 +85,11 @@ namespace Engine::ECS
     public:
         void add(const Prefab &p) { m_prefabs[p.name] = p; }
 
-        void clear() { m_prefabs.clear(); }
+        void clear()
+        {
+            m_prefabs.clear();
+            m_instances.clear();
+        }
 
         const Prefab *get(const std::string &name) const
         {
@@ -66,13 +97,41 @@ namespace Engine::ECS
             return it != m_prefabs.end() ? &it->second : nullptr;
         }
 
+        Prefab *find(const std::string &name)
+        {
+            auto it = m_prefabs.find(name);
+            return it != m_prefabs.end() ? &it->second : nullptr;
+        }
+
         bool exists(const std::string &name) const
         {
             return m_prefabs.find(name) != m_prefabs.end();
         }
 
+        // Instance tracking (off by default; the editor turns it on for hot reload, see
+        // PrefabHotReload.h): spawnFromPrefab/spawnBatch record the entities made from each
+        // prefab. Destroyed entities are not removed here, readers skip dead handles.
+        void setTrackInstances(bool enabled) { m_trackInstances = enabled; }
+        bool tracksInstances() const { return m_trackInstances; }
+
+        void noteInstances(const std::string &name, const Entity *entities, uint32_t count)
+        {
+            std::vector<Entity> &list = m_instances[name];
+            list.insert(list.end(), entities, entities + count);
+        }
+
+        std::vector<Entity> *instances(const std::string &name)
+        {
+            auto it = m_instances.find(name);
+            return it != m_instances.end() ? &it->second : nullptr;
+        }
+
+        void clearInstances() { m_instances.clear(); }
+
     private:
         std::unordered_map<std::string, Prefab> m_prefabs;
+        std::unordered_map<std::string, std::vector<Entity>> m_instances;
+        bool m_trackInstances = false;
     };
 
     // Utility: read a whole file into a string.
@@ -98,428 +157,23 @@ namespace Engine::ECS
         return sig;
     }
 
-    inline Prefab loadPrefabFromJson(const std::string &jsonText,
-                                     ComponentRegistry &registry,
-                                     ArchetypeManager &archetypes,
-                                     Engine::AssetManager &assets)
-    {
-        Prefab p;
-
-        // Extract name
-        {
-            std::regex re_name(R"re("name"\s*:\s*"([^"]+)")re");
-            std::smatch m;
-            if (std::regex_search(jsonText, m, re_name))
-                p.name = m[1].str();
-        }
-
-        // Extract components array
-        {
-            std::regex re_components(R"re("components"\s*:\s*\[([^\]]+)\])re");
-            std::smatch m;
-            if (std::regex_search(jsonText, m, re_components))
-            {
-                std::string inner = m[1].str();
-                std::regex re_item(R"re("([^"]+)")re");
-                auto it = std::sregex_iterator(inner.begin(), inner.end(), re_item);
-                auto end = std::sregex_iterator();
-                std::vector<std::string> names;
-                for (; it != end; ++it)
-                    names.push_back((*it)[1].str());
-                p.signature = buildSignatureFromNames(names, registry);
-            }
-        }
-
-        // Optional visuals: if a model is present, load it and apply a RenderModel default.
-        // JSON schema: "visual": { "model": "path" , ... }
-        {
-            std::regex re_model(R"re("visual"\s*:\s*\{[\s\S]*?"model"\s*:\s*"([^"]+)")re");
-            std::smatch m;
-            if (std::regex_search(jsonText, m, re_model))
-            {
-                const std::string modelPath = m[1].str();
-                if (!modelPath.empty())
-                {
-                    // Optional yaw offset (helps fix authored forward axis mismatches).
-                    // Supported keys inside "visual": yawOffsetDeg, yawOffsetRad
-                    float yawOffsetRad = 0.0f;
-                    {
-                        std::regex re_yaw_deg(R"re("visual"\s*:\s*\{[\s\S]*?"yawOffsetDeg"\s*:\s*([-+]?\d*\.?\d+))re");
-                        std::smatch my;
-                        if (std::regex_search(jsonText, my, re_yaw_deg))
-                        {
-                            constexpr float kDegToRad = 3.14159265358979323846f / 180.0f;
-                            yawOffsetRad = std::stof(my[1].str()) * kDegToRad;
-                        }
-                        else
-                        {
-                            std::regex re_yaw_rad(R"re("visual"\s*:\s*\{[\s\S]*?"yawOffsetRad"\s*:\s*([-+]?\d*\.?\d+))re");
-                            if (std::regex_search(jsonText, my, re_yaw_rad))
-                                yawOffsetRad = std::stof(my[1].str());
-                        }
-                    }
-
-                    Engine::ModelHandle h = assets.loadModel(modelPath);
-                    if (h.isValid())
-                    {
-                        const uint32_t rmId = registry.ensureId("RenderModel");
-                        p.signature.set(rmId);
-
-                        RenderModel rm{};
-                        rm.handle = h;
-                        rm.yawOffset = yawOffsetRad;
-                        p.defaults[rmId] = rm;
-
-                        // Also add per-entity animation state.
-                        const uint32_t raId = registry.ensureId("RenderAnimation");
-                        p.signature.set(raId);
-
-                        RenderAnimation ra{};
-                        ra.clipIndex = 0;
-                        ra.playing = false;
-                        ra.loop = true;
-                        ra.speed = 1.0f;
-                        ra.timeSec = 0.0f;
-                        p.defaults[raId] = ra;
-                    }
-                    else
-                    {
-                        std::cerr << "[Prefab] Warning: Failed to load model mesh: " << modelPath << " for prefab " << p.name << "\n";
-                    }
-                }
-            }
-        }
-
-        // If an entity can be rendered, ensure it also has a PosePalette so rendering can reuse cached transforms.
-        // (RenderSystem currently requires PosePalette.)
-        {
-            const uint32_t rmId = registry.ensureId("RenderModel");
-            if (p.signature.has(rmId))
-            {
-                const uint32_t ppId = registry.ensureId("PosePalette");
-                p.signature.set(ppId);
-                if (p.defaults.find(ppId) == p.defaults.end())
-                    p.defaults.emplace(ppId, PosePalette{});
-
-                // Render-side transform cache (world matrix + version).
-                const uint32_t rtId = registry.ensureId("RenderTransform");
-                p.signature.set(rtId);
-                if (p.defaults.find(rtId) == p.defaults.end())
-                    p.defaults.emplace(rtId, RenderTransform{});
-
-                // Per-entity render scale (defaults to 1.0).
-                const uint32_t rsId = registry.ensureId("RenderScale");
-                p.signature.set(rsId);
-                if (p.defaults.find(rsId) == p.defaults.end())
-                    p.defaults.emplace(rsId, RenderScale{});
-
-                // Visibility runtime state.
-                const uint32_t vsId = registry.ensureId("VisibilityState");
-                p.signature.set(vsId);
-                if (p.defaults.find(vsId) == p.defaults.end())
-                    p.defaults.emplace(vsId, VisibilityState{});
-
-                // Render bounds: derive from model metadata when possible, otherwise use conservative defaults.
-                const uint32_t rbId = registry.ensureId("RenderBounds");
-                p.signature.set(rbId);
-                if (p.defaults.find(rbId) == p.defaults.end())
-                {
-                    RenderBounds rb{};
-
-                    auto itRm = p.defaults.find(rmId);
-                    if (itRm != p.defaults.end() && std::holds_alternative<RenderModel>(itRm->second))
-                    {
-                        const RenderModel &rm = std::get<RenderModel>(itRm->second);
-                        if (Engine::ModelAsset *asset = assets.getModel(rm.handle); asset && asset->hasBounds)
-                        {
-                            const glm::vec3 bmin{asset->boundsMin[0], asset->boundsMin[1], asset->boundsMin[2]};
-                            const glm::vec3 bmax{asset->boundsMax[0], asset->boundsMax[1], asset->boundsMax[2]};
-                            rb.localCenter = (bmin + bmax) * 0.5f;
-
-                            const glm::vec3 ext = (bmax - bmin) * 0.5f;
-                            rb.localRadius = glm::length(ext);
-                            if (!(rb.localRadius > 1e-5f) || !std::isfinite(rb.localRadius))
-                                rb.localRadius = 1.0f;
-
-                            rb.worldCenter = rb.localCenter;
-                            rb.worldRadius = rb.localRadius;
-                        }
-                    }
-
-                    p.defaults.emplace(rbId, rb);
-                }
-            }
-        }
-
-        // Resolve archetype (after any signature adjustments like RenderMesh)
-        p.archetypeId = archetypes.getOrCreate(p.signature);
-
-        // Parse defaults: Position
-        {
-            std::regex re_pos(R"("Position"\s*:\s*\{\s*"x"\s*:\s*([-+]?\d*\.?\d+),\s*"y"\s*:\s*([-+]?\d*\.?\d+),\s*"z"\s*:\s*([-+]?\d*\.?\d+)\s*\})");
-            std::smatch m;
-            if (std::regex_search(jsonText, m, re_pos))
-            {
-                Position pos{};
-                pos.x = std::stof(m[1].str());
-                pos.y = std::stof(m[2].str());
-                pos.z = std::stof(m[3].str());
-                uint32_t cid = registry.ensureId("Position");
-                p.defaults.emplace(cid, pos);
-            }
-        }
-
-        // Parse defaults: Velocity
-        {
-            std::regex re_vel(R"("Velocity"\s*:\s*\{\s*"x"\s*:\s*([-+]?\d*\.?\d+),\s*"y"\s*:\s*([-+]?\d*\.?\d+),\s*"z"\s*:\s*([-+]?\d*\.?\d+)\s*\})");
-            std::smatch m;
-            if (std::regex_search(jsonText, m, re_vel))
-            {
-                Velocity vel{};
-                vel.x = std::stof(m[1].str());
-                vel.y = std::stof(m[2].str());
-                vel.z = std::stof(m[3].str());
-                uint32_t cid = registry.ensureId("Velocity");
-                p.defaults.emplace(cid, vel);
-            }
-        }
-
-        // Parse defaults: Health
-        {
-            std::regex re_health(R"("Health"\s*:\s*\{\s*"value"\s*:\s*([-+]?\d*\.?\d+)\s*\})");
-            std::smatch m;
-            if (std::regex_search(jsonText, m, re_health))
-            {
-                Health h{};
-                h.value = std::stof(m[1].str());
-                uint32_t cid = registry.ensureId("Health");
-                p.defaults.emplace(cid, h);
-            }
-        }
-
-        // Parse defaults: MoveTarget
-        {
-            std::regex re_target(R"("MoveTarget"\s*:\s*\{\s*"x"\s*:\s*([-+]?\d*\.?\d+),\s*"y"\s*:\s*([-+]?\d*\.?\d+),\s*"z"\s*:\s*([-+]?\d*\.?\d+),\s*"active"\s*:\s*(\d+)\s*\})");
-            std::smatch m;
-            if (std::regex_search(jsonText, m, re_target))
-            {
-                MoveTarget t{};
-                t.x = std::stof(m[1].str());
-                t.y = std::stof(m[2].str());
-                t.z = std::stof(m[3].str());
-                t.active = static_cast<uint8_t>(std::stoi(m[4].str()));
-                uint32_t cid = registry.ensureId("MoveTarget");
-                p.defaults.emplace(cid, t);
-            }
-        }
-
-        // Parse defaults: MoveSpeed
-        {
-            std::regex re_speed(R"("MoveSpeed"\s*:\s*\{\s*"value"\s*:\s*([-+]?\d*\.?\d+)\s*\})");
-            std::smatch m;
-            if (std::regex_search(jsonText, m, re_speed))
-            {
-                MoveSpeed s{};
-                s.value = std::stof(m[1].str());
-                uint32_t cid = registry.ensureId("MoveSpeed");
-                p.defaults.emplace(cid, s);
-            }
-        }
-
-        // Parse defaults: Radius
-        {
-            std::regex re_radius(R"("Radius"\s*:\s*\{\s*"r"\s*:\s*([-+]?\d*\.?\d+)\s*\})");
-            std::smatch m;
-            if (std::regex_search(jsonText, m, re_radius))
-            {
-                Radius r{};
-                r.r = std::stof(m[1].str());
-                uint32_t cid = registry.ensureId("Radius");
-                p.defaults.emplace(cid, r);
-            }
-        }
-
-        // Parse defaults: LocomotionClips
-        {
-            std::regex re_loco(R"("LocomotionClips"\s*:\s*\{[\s\S]*?"idleClip"\s*:\s*(\d+)[\s\S]*?"walkClip"\s*:\s*(\d+)[\s\S]*?"runClip"\s*:\s*(\d+)[\s\S]*?\})");
-            std::smatch m;
-            if (std::regex_search(jsonText, m, re_loco))
-            {
-                LocomotionClips clips{};
-                clips.idleClip = static_cast<uint32_t>(std::stoul(m[1].str()));
-                clips.walkClip = static_cast<uint32_t>(std::stoul(m[2].str()));
-                clips.runClip = static_cast<uint32_t>(std::stoul(m[3].str()));
-                uint32_t cid = registry.ensureId("LocomotionClips");
-                p.defaults.emplace(cid, clips);
-            }
-        }
-
-        // Parse defaults: CombatClips
-        {
-            std::regex re_combat(R"("CombatClips"\s*:\s*\{[\s\S]*?"attackStart"\s*:\s*(\d+)[\s\S]*?"attackEnd"\s*:\s*(\d+)[\s\S]*?"damageStart"\s*:\s*(\d+)[\s\S]*?"damageEnd"\s*:\s*(\d+)[\s\S]*?"deathStart"\s*:\s*(\d+)[\s\S]*?"deathEnd"\s*:\s*(\d+)[\s\S]*?\})");
-            std::smatch m;
-            if (std::regex_search(jsonText, m, re_combat))
-            {
-                CombatClips clips{};
-                clips.attackStart = static_cast<uint32_t>(std::stoul(m[1].str()));
-                clips.attackEnd = static_cast<uint32_t>(std::stoul(m[2].str()));
-                clips.damageStart = static_cast<uint32_t>(std::stoul(m[3].str()));
-                clips.damageEnd = static_cast<uint32_t>(std::stoul(m[4].str()));
-                clips.deathStart = static_cast<uint32_t>(std::stoul(m[5].str()));
-                clips.deathEnd = static_cast<uint32_t>(std::stoul(m[6].str()));
-                uint32_t cid = registry.ensureId("CombatClips");
-                p.defaults.emplace(cid, clips);
-            }
-        }
-
-        // If LocomotionClips is provided, default RenderAnimation to idleClip.
-        {
-            const uint32_t locoId = registry.ensureId("LocomotionClips");
-            const uint32_t raId = registry.ensureId("RenderAnimation");
-            auto itLoco = p.defaults.find(locoId);
-            auto itRA = p.defaults.find(raId);
-            if (itLoco != p.defaults.end() && itRA != p.defaults.end() &&
-                std::holds_alternative<LocomotionClips>(itLoco->second) &&
-                std::holds_alternative<RenderAnimation>(itRA->second))
-            {
-                const auto &loco = std::get<LocomotionClips>(itLoco->second);
-                auto ra = std::get<RenderAnimation>(itRA->second);
-                ra.clipIndex = loco.idleClip;
-                ra.timeSec = 0.0f;
-                ra.playing = false;
-                ra.loop = true;
-                itRA->second = ra;
-            }
-        }
-
-        // Parse defaults: Separation
-        {
-            std::regex re_sep(R"("Separation"\s*:\s*\{\s*"value"\s*:\s*([-+]?\d*\.?\d+)\s*\})");
-            std::smatch m;
-            if (std::regex_search(jsonText, m, re_sep))
-            {
-                Separation s{};
-                s.value = std::stof(m[1].str());
-                uint32_t cid = registry.ensureId("Separation");
-                p.defaults.emplace(cid, s);
-            }
-        }
-
-        // Parse defaults: AvoidanceParams
-        {
-            std::regex re_ap(R"("AvoidanceParams"\s*:\s*\{\s*"strength"\s*:\s*([-+]?\d*\.?\d+),\s*"maxAccel"\s*:\s*([-+]?\d*\.?\d+),\s*"blend"\s*:\s*([-+]?\d*\.?\d+),\s*"predictionTime"\s*:\s*([-+]?\d*\.?\d+),\s*"nearGoalRadius"\s*:\s*([-+]?\d*\.?\d+),\s*"nearGoalBoost"\s*:\s*([-+]?\d*\.?\d+),\s*"stoppedBoost"\s*:\s*([-+]?\d*\.?\d+),\s*"pressureBoost"\s*:\s*([-+]?\d*\.?\d+),\s*"interactSlack"\s*:\s*([-+]?\d*\.?\d+),\s*"falloffWeight"\s*:\s*([-+]?\d*\.?\d+),\s*"predictiveWeight"\s*:\s*([-+]?\d*\.?\d+),\s*"maxStopSpeed"\s*:\s*([-+]?\d*\.?\d+)\s*\})");
-            std::smatch m;
-            if (std::regex_search(jsonText, m, re_ap))
-            {
-                AvoidanceParams ap{};
-                ap.strength = std::stof(m[1].str());
-                ap.maxAccel = std::stof(m[2].str());
-                ap.blend = std::stof(m[3].str());
-                ap.predictionTime = std::stof(m[4].str());
-                ap.nearGoalRadius = std::stof(m[5].str());
-                ap.nearGoalBoost = std::stof(m[6].str());
-                ap.stoppedBoost = std::stof(m[7].str());
-                ap.pressureBoost = std::stof(m[8].str());
-                ap.interactSlack = std::stof(m[9].str());
-                ap.falloffWeight = std::stof(m[10].str());
-                ap.predictiveWeight = std::stof(m[11].str());
-                ap.maxStopSpeed = std::stof(m[12].str());
-                uint32_t cid = registry.ensureId("AvoidanceParams");
-                p.defaults.emplace(cid, ap);
-            }
-        }
-
-        // Parse defaults: Facing
-        {
-            std::regex re_face(R"("Facing"\s*:\s*\{\s*"yaw"\s*:\s*([-+]?\d*\.?\d+)\s*\})");
-            std::smatch m;
-            if (std::regex_search(jsonText, m, re_face))
-            {
-                Facing f{};
-                f.yaw = std::stof(m[1].str());
-                uint32_t cid = registry.ensureId("Facing");
-                p.defaults.emplace(cid, f);
-            }
-        }
-
-        // Parse defaults: RenderScale
-        {
-            std::regex re_scale(R"("RenderScale"\s*:\s*\{\s*"uniform"\s*:\s*([-+]?\d*\.?\d+)\s*\})");
-            std::smatch m;
-            if (std::regex_search(jsonText, m, re_scale))
-            {
-                RenderScale s{};
-                s.uniform = std::stof(m[1].str());
-                if (!std::isfinite(s.uniform) || s.uniform <= 0.0f)
-                    s.uniform = 1.0f;
-                uint32_t cid = registry.ensureId("RenderScale");
-                p.defaults[cid] = s;
-            }
-        }
-
-        // Parse defaults: ObstacleRadius
-        {
-            std::regex re_obsR(R"("ObstacleRadius"\s*:\s*\{\s*"r"\s*:\s*([-+]?\d*\.?\d+)\s*\})");
-            std::smatch m;
-            if (std::regex_search(jsonText, m, re_obsR))
-            {
-                ObstacleRadius orad{};
-                orad.r = std::stof(m[1].str());
-                uint32_t cid = registry.ensureId("ObstacleRadius");
-                p.defaults.emplace(cid, orad);
-            }
-        }
-
-        // Parse defaults: Path (mostly for ensuring ID existence if default used)
-        {
-            // Path has no JSON fields for now, but if present in defaults block:
-            if (jsonText.find("\"Path\"") != std::string::npos)
-            {
-                // ensure ID
-                (void)registry.ensureId("Path");
-            }
-        }
-
-        // Parse defaults: Team
-        {
-            std::regex re_team(R"("Team"\s*:\s*\{\s*"id"\s*:\s*(\d+)\s*\})");
-            std::smatch m;
-            if (std::regex_search(jsonText, m, re_team))
-            {
-                Team t{};
-                t.id = static_cast<uint8_t>(std::stoi(m[1].str()));
-                uint32_t cid = registry.ensureId("Team");
-                p.defaults.emplace(cid, t);
-            }
-        }
-
-        // Parse defaults: AttackCooldown
-        {
-            std::regex re_ack(R"("AttackCooldown"\s*:\s*\{\s*"timer"\s*:\s*([-+]?\d*\.?\d+),\s*"interval"\s*:\s*([-+]?\d*\.?\d+)\s*\})");
-            std::smatch m;
-            if (std::regex_search(jsonText, m, re_ack))
-            {
-                AttackCooldown ac{};
-                ac.timer = std::stof(m[1].str());
-                ac.interval = std::stof(m[2].str());
-                uint32_t cid = registry.ensureId("AttackCooldown");
-                p.defaults.emplace(cid, ac);
-            }
-        }
-
-        // Validate defaults align with signature; drop mismatches to keep consistency.
-        if (!p.validateDefaults())
-        {
-            for (auto it = p.defaults.begin(); it != p.defaults.end();)
-            {
-                if (!p.signature.has(it->first))
-                    it = p.defaults.erase(it);
-                else
-                    ++it;
-            }
-        }
-
-        return p;
-    }
-
-} // namespace Engine::ECS
\ No newline at end of file
+#if !defined(ENGINE_HEADLESS) || !ENGINE_HEADLESS
+    // Helper: model-space bounding sphere from model metadata. Returns false (rb untouched) when
+    // the model is not resident or has no bounds.
+    bool renderBoundsFromModel(Engine::AssetManager &assets, Engine::ModelHandle handle, RenderBounds &rb);
+
+    // Parse one prefab file (schema: Sample/entities/*.json; see Prefab.cpp) and compile it.
+    Prefab loadPrefabFromJson(const std::string &jsonText,
+                              ComponentRegistry &registry,
+                              ArchetypeManager &archetypes,
+                              Engine::AssetManager &assets,
+                              bool streamModels = false);
+#endif
+
+    // Headless variant (no GPU, e.g. EcsBench): models are not loaded, so prefabs get no render
+    // components. Prefabs with a "visual" model still get RenderAnimation, which gameplay drives.
+    Prefab loadPrefabFromJson(const std::string &jsonText,
+                              ComponentRegistry &registry,
+                              ArchetypeManager &archetypes);
+
+} // namespace Engine::ECS
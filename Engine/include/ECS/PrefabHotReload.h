@@ -0,0 +1,170 @@
+#pragma once
+/*
+  PrefabHotReload.h
+  -----------------
+  Purpose:
+    - Apply an edited prefab to the entities already spawned from it, instead of clearing and
+      respawning the world:
+      * defaults that changed are copied into every instance row still holding the old default
+        (values set per spawn, e.g. Position or Team, are kept)
+      * a changed signature migrates only that prefab's instances (ECSContext::moveEntity);
+        components new to the signature get the prefab's defaults
+      * rows touched are marked dirty, so bounds/pose/world caches rebuild for them alone
+
+  Usage:
+    - ecs.prefabs.setTrackInstances(true) before spawning (see PrefabManager).
+    - Prefab p = loadPrefabFromJson(text, ecs.components, ecs.archetypes, assets);
+      hotReloadPrefab(ecs, std::move(p), stats);
+    - Models reloaded in place (AssetManager::reloadModel) keep their handles; call
+      refreshStreamedModelBounds(prefab, ecs, assets) for prefabs using one.
+
+  Notes:
+    - Components that systems rewrite every frame (WorldBounds, RenderTransform)
+      no longer match their default, so they keep their values.
+    - Runtime-state defaults (PosePalette, Path) are the same in both images, so live rows keep
+      their values; they are only applied to components a migration adds.
+*/
+
+#include "ECS/Prefab.h"
+#include "ECS/ArchetypeStore.h"
+#include "ECS/ECSContext.h"
+#include "ECS/Entity.h"
+
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+namespace Engine::ECS
+{
+  struct PrefabReloadStats
+  {
+    uint32_t prefabsAdded = 0;
+    uint32_t prefabsChanged = 0;
+    uint32_t entitiesMigrated = 0;
+    uint32_t valuesPatched = 0; // component values rewritten in existing rows
+  };
+
+  namespace detail
+  {
+    inline const PrefabImage::Entry *findImageEntry(const PrefabImage &image, uint32_t componentId)
+    {
+      for (const PrefabImage::Entry &entry : image.entries)
+      {
+        if (entry.componentId == componentId)
+          return &entry;
+      }
+      return nullptr;
+    }
+
+    // A trivially copyable default whose bytes differ between the two images.
+    struct ChangedDefault
+    {
+      uint32_t componentId = 0;
+      const void *oldValue = nullptr;
+      const void *newValue = nullptr;
+      uint32_t size = 0;
+    };
+  } // namespace detail
+
+  // Replace the prefab named updated.name with updated and bring its live instances in line.
+  // A name not registered yet is simply added.
+  inline void hotReloadPrefab(ECSContext &ecs, Prefab updated, PrefabReloadStats &stats)
+  {
+    Prefab *current = ecs.prefabs.find(updated.name);
+    if (!current)
+    {
+      ecs.prefabs.add(updated);
+      ++stats.prefabsAdded;
+      return;
+    }
+
+    std::vector<detail::ChangedDefault> changed;
+    for (const PrefabImage::Entry &entry : updated.image.entries)
+    {
+      const PrefabImage::Entry *old = detail::findImageEntry(current->image, entry.componentId);
+      if (!old || old->typeKey != entry.typeKey || old->size != entry.size)
+        continue; // no old default to compare rows against; set at migration if the component is new
+      const void *oldValue = current->image.value(*old);
+      const void *newValue = updated.image.value(entry);
+      if (std::memcmp(oldValue, newValue, entry.size) != 0)
+        changed.push_back({entry.componentId, oldValue, newValue, entry.size});
+    }
+
+    const bool migrate = !(updated.signature == current->signature);
+    if (changed.empty() && !migrate)
+    {
+      *current = std::move(updated);
+      return;
+    }
+    ++stats.prefabsChanged;
+
+    // Defaults of components only the new signature has, filled into migrated rows.
+    std::unordered_map<uint32_t, DefaultValue> addedDefaults;
+    if (migrate)
+    {
+      for (const auto &kv : updated.defaults)
+      {
+        if (!current->signature.has(kv.first))
+          addedDefaults.emplace(kv.first, kv.second);
+      }
+    }
+
+    std::vector<Entity> *instances = ecs.prefabs.instances(updated.name);
+    if (instances)
+    {
+      std::vector<ArchetypeStore::DefaultFill> fills;
+      const ArchetypeStore *fillsStore = nullptr;
+
+      size_t live = 0;
+      for (size_t i = 0; i < instances->size(); ++i)
+      {
+        const Entity e = (*instances)[i];
+        if (!ecs.entities.isAlive(e))
+          continue;
+        (*instances)[live++] = e;
+
+        if (migrate)
+        {
+          const EntityRecord *before = ecs.entities.find(e);
+          const ArchetypeStore *src = before ? ecs.stores.get(before->archetypeId) : nullptr;
+          if (src && !(src->signature() == updated.signature) && ecs.moveEntity(e, updated.signature))
+          {
+            ++stats.entitiesMigrated;
+            const EntityRecord *after = ecs.entities.find(e);
+            ArchetypeStore *dst = after ? ecs.stores.get(after->archetypeId) : nullptr;
+            if (dst && !addedDefaults.empty())
+            {
+              if (dst != fillsStore)
+              {
+                dst->compileDefaults(addedDefaults, fills);
+                fillsStore = dst;
+              }
+              dst->fillDefaults(after->row, 1, fills);
+            }
+          }
+        }
+
+        const EntityRecord *rec = ecs.entities.find(e);
+        ArchetypeStore *store = rec ? ecs.stores.get(rec->archetypeId) : nullptr;
+        if (!store)
+          continue;
+        for (const detail::ChangedDefault &c : changed)
+        {
+          ComponentColumn *column = store->findColumn(c.componentId);
+          if (!column)
+            continue;
+          void *dst = column->at(rec->row);
+          if (std::memcmp(dst, c.oldValue, c.size) != 0)
+            continue; // set per entity, keep it
+          std::memcpy(dst, c.newValue, c.size);
+          ecs.markDirty(c.componentId, rec->archetypeId, rec->row);
+          ++stats.valuesPatched;
+        }
+      }
+      instances->resize(live);
+    }
+
+    *current = std::move(updated);
+  }
+
+} // namespace Engine::ECS
@@ -0,0 +1,56 @@
+#pragma once
+/*
+  PrefabImage.h
+  -------------
+  Purpose:
+    - A prefab's defaults compiled into one flat byte image: every trivially copyable default
+      sits at an aligned offset, tagged with its component id and type key.
+    - Spawners resolve the entries to store columns once (ArchetypeStore::compileDefaults) and
+      copy the bytes straight into rows, instead of visiting the variant map per row.
+
+  Notes:
+    - Built by Prefab::compile() (loadPrefabFromJson calls it); rebuild after editing defaults.
+    - Defaults that aren't trivially copyable (components with owning members) stay in
+      Prefab::defaults and are listed in variantIds.
+    - Offsets only, no pointers: the image can be copied with its prefab or written out as is.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace Engine::ECS
+{
+    struct PrefabImage
+    {
+        struct Entry
+        {
+            uint32_t componentId = 0;
+            uint32_t offset = 0; // into bytes
+            uint32_t size = 0;
+            const void *typeKey = nullptr; // componentTypeKey<T>()
+        };
+
+        std::vector<Entry> entries;
+        std::vector<std::byte> bytes;
+        std::vector<uint32_t> variantIds; // defaults applied through Prefab::defaults
+
+        void clear()
+        {
+            entries.clear();
+            bytes.clear();
+            variantIds.clear();
+        }
+
+        void append(uint32_t componentId, const void *typeKey, const void *value, size_t size, size_t align)
+        {
+            const size_t offset = (bytes.size() + align - 1u) & ~(align - 1u);
+            bytes.resize(offset + size);
+            std::memcpy(bytes.data() + offset, value, size);
+            entries.push_back(Entry{componentId, static_cast<uint32_t>(offset), static_cast<uint32_t>(size), typeKey});
+        }
+
+        const void *value(const Entry &e) const { return bytes.data() + e.offset; }
+    };
+}
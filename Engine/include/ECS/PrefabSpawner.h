@@ -6,12 +6,17 @@
     - Provide a function to spawn an entity from a Prefab:
       * Create an Entity (EntitiesRecord)
       * Create/get the matching ArchetypeStore
-      * Create a row in the store, apply defaults
+      * Create a row in the store, copy the prefab's compiled defaults (Prefab::image)
       * Attach the entity mapping for quick lookup
 
   Usage:
     - Prefer: SpawnResult res = spawnFromPrefab(prefab, ecs);
       (This marks the new row dirty for dirty-enabled queries so pose/world caches initialize.)
+    - Many units of one prefab: spawnBatch(prefab, ecs, count, positions) creates the entities
+      in bulk, appends all rows at once, copies defaults column by column and marks the new
+      rows dirty as one range.
+    - Streamed prefabs (loadPrefabFromJson(..., streamModels = true)): call
+      refreshStreamedModelBounds(prefab, ecs, assets) once per frame until it returns true.
 */
 
 #include "ECS/Prefab.h"
@@ -21,6 +26,12 @@
 #include "ECS/Components.h"
 #include "ECS/ECSContext.h"
 
+#if !defined(ENGINE_HEADLESS) || !ENGINE_HEADLESS
+#include "assets/AssetManager.h"
+#endif
+
+#include <vector>
+
 namespace Engine::ECS
 {
   // Result of spawning: includes entity handle, row index, and archetypeId.
@@ -50,9 +61,11 @@ namespace Engine::ECS
       // Get or create store for this archetype signature
       ArchetypeStore *store = stores.getOrCreate(prefab.archetypeId, prefab.signature, registry);
 
-      // Create row and apply defaults
+      // Create row and copy the compiled defaults
+      thread_local std::vector<ArchetypeStore::DefaultFill> fills;
+      store->compileDefaults(prefab.image, prefab.defaults, fills);
       res.row = store->createRow(res.entity);
-      store->applyDefaults(res.row, prefab.defaults, registry);
+      store->fillDefaults(res.row, 1, fills);
 
       // Attach entity to record for quick per-entity operations
       entities.attach(res.entity, res.archetypeId, res.row);
@@ -80,7 +93,118 @@ namespace Engine::ECS
     ArchetypeStore *store = ecs.stores.get(res.archetypeId);
     if (store)
       ecs.queries.markRowDirtyAll(res.archetypeId, res.row, store->size());
+    if (ecs.prefabs.tracksInstances())
+      ecs.prefabs.noteInstances(prefab.name, &res.entity, 1);
+    return res;
+  }
+
+  // Result of spawnBatch: the new entities are rows [firstRow, firstRow + count) of archetypeId.
+  struct SpawnBatchResult
+  {
+    uint32_t archetypeId = UINT32_MAX;
+    uint32_t firstRow = 0;
+    uint32_t count = 0;
+  };
+
+  // Spawn count entities of prefab. positions (optional, count entries) replace the Position
+  // default per row; outEntities (optional, count entries) receives the handles in row order.
+  // Like spawnFromPrefab(prefab, ecs), the rows are marked dirty for every dirty query.
+  inline SpawnBatchResult spawnBatch(const Prefab &prefab, ECSContext &ecs, uint32_t count,
+                                     const Position *positions = nullptr, Entity *outEntities = nullptr)
+  {
+    SpawnBatchResult res{};
+    res.archetypeId = prefab.archetypeId;
+    ArchetypeStore *store = ecs.stores.getOrCreate(prefab.archetypeId, prefab.signature, ecs.components);
+    if (!store || count == 0)
+      return res;
+
+    std::vector<Entity> scratch;
+    Entity *handles = outEntities;
+    if (!handles)
+    {
+      scratch.resize(count);
+      handles = scratch.data();
+    }
+    ecs.entities.create(handles, count);
+
+    std::vector<ArchetypeStore::DefaultFill> fills;
+    store->compileDefaults(prefab.image, prefab.defaults, fills);
+
+    store->reserve(count);
+    res.firstRow = store->createRows(handles, count);
+    res.count = count;
+    store->fillDefaults(res.firstRow, count, fills);
+
+    if (positions && store->hasPosition())
+    {
+      auto dst = store->positions();
+      for (uint32_t i = 0; i < count; ++i)
+        dst[res.firstRow + i] = positions[i];
+    }
+
+    for (uint32_t i = 0; i < count; ++i)
+      ecs.entities.attach(handles[i], res.archetypeId, res.firstRow + i);
+    ecs.queries.markRowsDirtyAll(res.archetypeId, res.firstRow, count, store->size());
+    if (ecs.prefabs.tracksInstances())
+      ecs.prefabs.noteInstances(prefab.name, handles, count);
     return res;
   }
 
+#if !defined(ENGINE_HEADLESS) || !ENGINE_HEADLESS
+  // Streamed models: once the prefab's model is resident, copy its bounds into the prefab defaults
+  // and into every spawned row using that model, and mark those rows dirty so bounds and pose
+  // caches are rebuilt. Returns true when there is nothing left to wait for (ready or failed).
+  inline bool refreshStreamedModelBounds(Prefab &prefab, ECSContext &ecs, Engine::AssetManager &assets)
+  {
+    const uint32_t rmId = ecs.components.ensureId("RenderModel");
+    const uint32_t rbId = ecs.components.ensureId("RenderBounds");
+
+    auto itRm = prefab.defaults.find(rmId);
+    if (itRm == prefab.defaults.end() || !std::holds_alternative<RenderModel>(itRm->second))
+      return true;
+    const Engine::ModelHandle handle = std::get<RenderModel>(itRm->second).handle;
+
+    const Engine::AssetState state = assets.modelState(handle);
+    if (state == Engine::AssetState::Pending)
+      return false;
+
+    RenderBounds rb{};
+    if (state != Engine::AssetState::Ready || !renderBoundsFromModel(assets, handle, rb))
+      return true;
+
+    auto itRb = prefab.defaults.find(rbId);
+    if (itRb != prefab.defaults.end())
+    {
+      itRb->second = rb;
+      auto itWb = prefab.defaults.find(ecs.components.ensureId("WorldBounds"));
+      if (itWb != prefab.defaults.end())
+        itWb->second = WorldBounds{rb.localCenter, rb.localRadius};
+      prefab.compile();
+    }
+
+    const auto &stores = ecs.stores.stores();
+    for (uint32_t archetypeId = 0; archetypeId < static_cast<uint32_t>(stores.size()); ++archetypeId)
+    {
+      ArchetypeStore *store = stores[archetypeId].get();
+      if (!store || !store->hasRenderModel() || !store->hasRenderBounds())
+        continue;
+
+      const auto &renderModels = store->renderModels();
+      auto renderBounds = store->renderBounds();
+      const uint32_t n = store->size();
+      for (uint32_t row = 0; row < n; ++row)
+      {
+        const Engine::ModelHandle &h = renderModels[row].handle;
+        if (h.id != handle.id || h.generation != handle.generation)
+          continue;
+
+        renderBounds[row].localCenter = rb.localCenter;
+        renderBounds[row].localRadius = rb.localRadius;
+        ecs.queries.markRowDirtyAll(archetypeId, row, n);
+      }
+    }
+    return true;
+  }
+#endif
+
 } // namespace Engine::ECS
\ No newline at end of file
@@ -9,12 +9,13 @@
     - Queries cache matching archetype IDs to avoid scanning all stores.
     - Queries can optionally track dirty rows (bitset per matching store) so systems can update incrementally.
     - QueryManager incrementally updates store lists when new archetype stores are created.
+    - Sparse tags (ComponentRegistry::registerSparseTag) can't be matched per archetype; they are
+      split into sparseRequired/sparseExcluded and checked per entity (ECSContext::forEachQueryRow).
 */
 
 #include <atomic>
 #include <cstdint>
 #include <mutex>
-#include <unordered_map>
 #include <vector>
 #include "ECS/Components.h"
 
@@ -55,10 +56,12 @@ namespace Engine::ECS
     Query(Query &&other) noexcept
         : required(other.required),
           excluded(other.excluded),
+          sparseRequired(other.sparseRequired),
+          sparseExcluded(other.sparseExcluded),
           matchingArchetypeIds(std::move(other.matchingArchetypeIds)),
           dirtyEnabled(other.dirtyEnabled),
           dirtyComponents(other.dirtyComponents),
-          archetypeToMatchIndex(std::move(other.archetypeToMatchIndex)),
+          matchIndexByArchetype(std::move(other.matchIndexByArchetype)),
           dirtyBits(std::move(other.dirtyBits))
     {
       other.dirtyEnabled = false;
@@ -71,10 +74,12 @@ namespace Engine::ECS
 
       required = other.required;
       excluded = other.excluded;
+      sparseRequired = other.sparseRequired;
+      sparseExcluded = other.sparseExcluded;
       matchingArchetypeIds = std::move(other.matchingArchetypeIds);
       dirtyEnabled = other.dirtyEnabled;
       dirtyComponents = other.dirtyComponents;
-      archetypeToMatchIndex = std::move(other.archetypeToMatchIndex);
+      matchIndexByArchetype = std::move(other.matchIndexByArchetype);
       dirtyBits = std::move(other.dirtyBits);
 
       other.dirtyEnabled = false;
@@ -83,19 +88,40 @@ namespace Engine::ECS
 
     ComponentMask required;
     ComponentMask excluded;
+    // Sparse tags of the query (not part of required/excluded above).
+    ComponentMask sparseRequired;
+    ComponentMask sparseExcluded;
     std::vector<uint32_t> matchingArchetypeIds;
 
+    bool hasSparseFilter() const { return !sparseRequired.empty() || !sparseExcluded.empty(); }
+
     // Dirty tracking (optional)
     bool dirtyEnabled = false;
     ComponentMask dirtyComponents;
 
-    // For O(1) lookup of a matching archetype index.
-    std::unordered_map<uint32_t, uint32_t> archetypeToMatchIndex;
+    // Archetype id -> index into matchingArchetypeIds (NoMatch past the end or for
+    // archetypes the query doesn't match). Dense: archetype ids are small and contiguous.
+    static constexpr uint32_t NoMatch = UINT32_MAX;
+    std::vector<uint32_t> matchIndexByArchetype;
+
+    uint32_t matchIndexOf(uint32_t archetypeId) const
+    {
+      return (archetypeId < matchIndexByArchetype.size()) ? matchIndexByArchetype[archetypeId] : NoMatch;
+    }
+    bool matchesArchetype(uint32_t archetypeId) const { return matchIndexOf(archetypeId) != NoMatch; }
+
+    void addMatch(uint32_t archetypeId)
+    {
+      if (archetypeId >= matchIndexByArchetype.size())
+        matchIndexByArchetype.resize(archetypeId + 1u, NoMatch);
+      matchIndexByArchetype[archetypeId] = static_cast<uint32_t>(matchingArchetypeIds.size());
+      matchingArchetypeIds.push_back(archetypeId);
+    }
 
     // Parallel to matchingArchetypeIds: bitset per matching archetype.
     // Row i is dirty if (dirtyBits[matchIdx][i/64] & (1ull<<(i%64))) != 0.
 
-    // Each word is atomic so markDirty and consumeDirtyRows can be used safely from multiple threads
+    // Each word is atomic so markDirty and forEachDirtyRow/consumeDirtyRows can be used safely from multiple threads
     // as long as the query list / archetype matching list is not being structurally modified concurrently.
     std::vector<std::vector<AtomicWord>> dirtyBits;
 
@@ -9,6 +9,24 @@
   v1 behavior:
     - createQuery(required, excluded) compiles the query against existing stores.
     - onStoreCreated(archetypeId, signature) incrementally updates all queries.
+
+  Match index:
+    - For every component id the manager keeps the bitset of archetypes carrying it, so
+      compiling a query is an AND over its required components' bitsets and an ANDNOT over
+      its excluded ones, instead of a signature test per store.
+    - Queries are bucketed by their highest required component id (usually the most specific
+      one); a new store only tests the queries keyed on a component it actually has, plus
+      the queries with no required component.
+    - Query::matchIndexByArchetype is a dense archetype id -> match index table.
+    - Sparse tags in required/excluded are moved to Query::sparseRequired/sparseExcluded
+      (needs setRegistry; ECSContext::WireQueryManager does it).
+
+  Dirty rows:
+    - Every archetype keeps the list of dirty queries matching it (and the union of their
+      dirty components), so markDirtyComponent/markRowDirtyAll only touch the queries that
+      can care instead of looping over all of them.
+    - forEachDirtyRow(qid, archetypeId, fn) consumes the bitset words in place (ascending rows,
+      no allocation); consumeDirtyRows(qid, archetypeId, out) fills a caller-owned buffer.
 */
 
 #include <cstdint>
@@ -32,6 +50,9 @@ namespace Engine::ECS
         // Optional: ECS trace for debug profiling.
         void setTrace(EcsTrace *trace) { m_trace = trace; }
 
+        // Registry whose sparse tags createQuery splits off (ECSContext::WireQueryManager).
+        void setRegistry(const ComponentRegistry *registry) { m_registry = registry; }
+
         // Set by the schedule driver (SystemRunner) so consumeDirtyRows can attribute work.
         void setCurrentSystemName(const char *name) { t_currentSystemName = name; }
         void clearCurrentSystemName() { t_currentSystemName = nullptr; }
@@ -43,22 +64,61 @@ namespace Engine::ECS
             Query q;
             q.required = required;
             q.excluded = excluded;
+            if (m_registry)
+            {
+                for (uint32_t tagId : m_registry->sparseTags())
+                {
+                    if (q.required.has(tagId))
+                    {
+                        q.required.clear(tagId);
+                        q.sparseRequired.set(tagId);
+                    }
+                    if (q.excluded.has(tagId))
+                    {
+                        q.excluded.clear(tagId);
+                        q.sparseExcluded.set(tagId);
+                    }
+                }
+            }
 
-            // Compile against existing stores.
-            const auto &stores = mgr.stores();
-            for (uint32_t archetypeId = 0; archetypeId < stores.size(); ++archetypeId)
+            // Compile against existing stores: AND/ANDNOT over the per-component archetype sets.
+            syncIndex(mgr);
+            m_matchScratch = m_indexed;
+            for (size_t w = 0; w < ComponentMask::WordCount; ++w)
             {
-                const auto &ptr = stores[archetypeId];
-                if (!ptr)
-                    continue;
-                const auto &sig = ptr->signature();
-                if (!sig.containsAll(required))
-                    continue;
-                if (!sig.containsNone(excluded))
-                    continue;
-                const uint32_t matchIdx = static_cast<uint32_t>(q.matchingArchetypeIds.size());
-                q.matchingArchetypeIds.push_back(archetypeId);
-                q.archetypeToMatchIndex.emplace(archetypeId, matchIdx);
+                uint64_t word = q.required.words()[w];
+                while (word)
+                {
+                    const uint32_t compId = static_cast<uint32_t>(w * 64u) + lowestBit(word);
+                    word &= word - 1ull;
+                    andArchetypes(m_matchScratch, compId);
+                }
+                word = q.excluded.words()[w];
+                while (word)
+                {
+                    const uint32_t compId = static_cast<uint32_t>(w * 64u) + lowestBit(word);
+                    word &= word - 1ull;
+                    andNotArchetypes(m_matchScratch, compId);
+                }
+            }
+            for (size_t w = 0; w < m_matchScratch.size(); ++w)
+            {
+                uint64_t word = m_matchScratch[w];
+                while (word)
+                {
+                    q.addMatch(static_cast<uint32_t>(w * 64u) + lowestBit(word));
+                    word &= word - 1ull;
+                }
+            }
+
+            const uint32_t key = highestComponent(q.required);
+            if (key == NoKey)
+                m_unkeyedQueries.push_back(id);
+            else
+            {
+                if (key >= m_queriesByKey.size())
+                    m_queriesByKey.resize(key + 1u);
+                m_queriesByKey[key].push_back(id);
             }
 
             m_queries.emplace_back(std::move(q));
@@ -81,9 +141,10 @@ namespace Engine::ECS
             for (size_t i = 0; i < q.matchingArchetypeIds.size(); ++i)
             {
                 const uint32_t archetypeId = q.matchingArchetypeIds[i];
+                addDirtyRoute(archetypeId, id, static_cast<uint32_t>(i), dirtyComponents);
                 const ArchetypeStore *store = mgr.get(archetypeId);
                 const uint32_t n = store ? store->size() : 0u;
-                ensureBitsetSize(q, q.dirtyBits[i], n);
+                ensureBitsetSize(q, q.dirtyBits[i], store ? store->reservedRows() : 0u);
                 // Mark all rows dirty.
                 for (uint32_t row = 0; row < n; ++row)
                     setDirtyBit(q.dirtyBits[i], row);
@@ -94,23 +155,55 @@ namespace Engine::ECS
 
         const Query &get(QueryId id) const { return m_queries[id]; }
 
+        // Number of compiled queries. The scheduler uses this to detect lazy query creation.
+        uint32_t queryCount() const { return static_cast<uint32_t>(m_queries.size()); }
+
         // Discard all compiled queries.  Systems must recreate theirs on next update.
-        void clear() { m_queries.clear(); }
+        // The archetype index describes the stores, not the queries, so it stays.
+        void clear()
+        {
+            m_queries.clear();
+            m_dirtyRoutes.clear();
+            m_queriesByKey.clear();
+            m_unkeyedQueries.clear();
+        }
 
         void onStoreCreated(uint32_t archetypeId, const ComponentMask &signature)
         {
-            for (auto &q : m_queries)
+            indexArchetype(archetypeId, signature);
+
+            // Candidates: queries keyed on one of the signature's components, plus unkeyed ones.
+            // Tested in query id order so dirty routes come out as with a full scan.
+            m_candidateScratch.assign(m_unkeyedQueries.begin(), m_unkeyedQueries.end());
+            for (size_t w = 0; w < ComponentMask::WordCount; ++w)
             {
+                uint64_t word = signature.words()[w];
+                while (word)
+                {
+                    const uint32_t compId = static_cast<uint32_t>(w * 64u) + lowestBit(word);
+                    word &= word - 1ull;
+                    if (compId < m_queriesByKey.size())
+                        m_candidateScratch.insert(m_candidateScratch.end(),
+                                                  m_queriesByKey[compId].begin(), m_queriesByKey[compId].end());
+                }
+            }
+            std::sort(m_candidateScratch.begin(), m_candidateScratch.end());
+
+            for (QueryId id : m_candidateScratch)
+            {
+                Query &q = m_queries[id];
                 if (!signature.containsAll(q.required))
                     continue;
                 if (!signature.containsNone(q.excluded))
                     continue;
+                if (q.matchesArchetype(archetypeId))
+                    continue;
                 const uint32_t matchIdx = static_cast<uint32_t>(q.matchingArchetypeIds.size());
-                q.matchingArchetypeIds.push_back(archetypeId);
-                q.archetypeToMatchIndex.emplace(archetypeId, matchIdx);
+                q.addMatch(archetypeId);
                 if (q.dirtyEnabled)
                 {
                     q.dirtyBits.emplace_back();
+                    addDirtyRoute(archetypeId, id, matchIdx, q.dirtyComponents);
                 }
             }
         }
@@ -118,89 +211,281 @@ namespace Engine::ECS
         // Mark a row dirty for any query that is interested in 'compId'.
         void markDirtyComponent(uint32_t compId, uint32_t archetypeId, uint32_t row, uint32_t storeSize)
         {
-            for (auto &q : m_queries)
+            if (archetypeId >= m_dirtyRoutes.size())
+                return;
+            ArchetypeRoutes &routes = m_dirtyRoutes[archetypeId];
+            if (!routes.components.has(compId))
+                return;
+            for (const DirtyRoute &route : routes.routes)
             {
-                if (!q.dirtyEnabled)
+                if (!route.components.has(compId))
                     continue;
-                if (!q.dirtyComponents.has(compId))
-                    continue;
-
-                auto it = q.archetypeToMatchIndex.find(archetypeId);
-                if (it == q.archetypeToMatchIndex.end())
-                    continue;
-                const uint32_t matchIdx = it->second;
-                ensureBitsetSize(q, q.dirtyBits[matchIdx], storeSize);
-                setDirtyBit(q.dirtyBits[matchIdx], row);
+                Query &q = m_queries[route.query];
+                ensureBitsetSize(q, q.dirtyBits[route.matchIdx], storeSize);
+                setDirtyBit(q.dirtyBits[route.matchIdx], row);
             }
         }
 
         // Mark a row dirty for ALL dirty-enabled queries that match the store.
         void markRowDirtyAll(uint32_t archetypeId, uint32_t row, uint32_t storeSize)
         {
-            for (auto &q : m_queries)
+            if (archetypeId >= m_dirtyRoutes.size())
+                return;
+            for (const DirtyRoute &route : m_dirtyRoutes[archetypeId].routes)
             {
-                if (!q.dirtyEnabled)
-                    continue;
-                auto it = q.archetypeToMatchIndex.find(archetypeId);
-                if (it == q.archetypeToMatchIndex.end())
+                Query &q = m_queries[route.query];
+                ensureBitsetSize(q, q.dirtyBits[route.matchIdx], storeSize);
+                setDirtyBit(q.dirtyBits[route.matchIdx], row);
+            }
+        }
+
+        // markRowDirtyAll for rows [firstRow, firstRow + count), a word at a time (batch spawns).
+        void markRowsDirtyAll(uint32_t archetypeId, uint32_t firstRow, uint32_t count, uint32_t storeSize)
+        {
+            if (archetypeId >= m_dirtyRoutes.size() || count == 0)
+                return;
+            for (const DirtyRoute &route : m_dirtyRoutes[archetypeId].routes)
+            {
+                Query &q = m_queries[route.query];
+                auto &bits = q.dirtyBits[route.matchIdx];
+                ensureBitsetSize(q, bits, std::max(storeSize, firstRow + count));
+                for (uint32_t row = firstRow, end = firstRow + count; row < end;)
+                {
+                    const uint32_t bit = row % 64u;
+                    const uint32_t n = std::min(64u - bit, end - row);
+                    const uint64_t mask = (n == 64u) ? ~0ull : (((1ull << n) - 1ull) << bit);
+                    bits[row / 64u].v.fetch_or(mask, std::memory_order_relaxed);
+                    row += n;
+                }
+            }
+        }
+
+        // Size the store's dirty bitsets of every matching dirty query for rows rows
+        // (ECSContext::reserve). Sync points only.
+        void reserveRows(uint32_t archetypeId, uint32_t rows)
+        {
+            if (archetypeId >= m_dirtyRoutes.size())
+                return;
+            for (const DirtyRoute &route : m_dirtyRoutes[archetypeId].routes)
+            {
+                Query &q = m_queries[route.query];
+                ensureBitsetSize(q, q.dirtyBits[route.matchIdx], rows);
+            }
+        }
+
+        // The store's rows were reordered (ArchetypeStore::permuteRows): new row i was row
+        // order[i], so its dirty bit follows it. Sync points only.
+        void permuteRows(uint32_t archetypeId, const uint32_t *order, uint32_t count)
+        {
+            if (archetypeId >= m_dirtyRoutes.size() || count == 0)
+                return;
+            for (const DirtyRoute &route : m_dirtyRoutes[archetypeId].routes)
+            {
+                Query &q = m_queries[route.query];
+                auto &bits = q.dirtyBits[route.matchIdx];
+                ensureBitsetSize(q, bits, count);
+                m_permuteBits.assign((count + 63u) / 64u, 0ull);
+                bool any = false;
+                for (size_t w = 0; w < m_permuteBits.size(); ++w)
+                    any = any || bits[w].v.load(std::memory_order_relaxed) != 0ull;
+                if (!any)
                     continue;
-                const uint32_t matchIdx = it->second;
-                ensureBitsetSize(q, q.dirtyBits[matchIdx], storeSize);
-                setDirtyBit(q.dirtyBits[matchIdx], row);
+                for (uint32_t row = 0; row < count; ++row)
+                {
+                    const uint32_t from = order[row];
+                    if ((bits[from / 64u].v.load(std::memory_order_relaxed) >> (from % 64u)) & 1ull)
+                        m_permuteBits[row / 64u] |= 1ull << (row % 64u);
+                }
+                for (size_t w = 0; w < m_permuteBits.size(); ++w)
+                    bits[w].v.store(m_permuteBits[w], std::memory_order_relaxed);
             }
         }
 
-        // Consume and clear dirty rows for a given query+archetype.
-        // Returns row indices in ascending order.
-        std::vector<uint32_t> consumeDirtyRows(QueryId qid, uint32_t archetypeId)
+        // Consume and clear dirty rows for a given query+archetype, calling fn(row) for each in
+        // ascending order. Returns the number of rows visited.
+        // Rows marked concurrently may show up now or on the next call, never get lost.
+        template <typename Fn>
+        uint32_t forEachDirtyRow(QueryId qid, uint32_t archetypeId, Fn &&fn)
         {
-            std::vector<uint32_t> rows;
             if (qid >= m_queries.size())
-                return rows;
+                return 0u;
             Query &q = m_queries[qid];
             if (!q.dirtyEnabled)
-                return rows;
-            auto it = q.archetypeToMatchIndex.find(archetypeId);
-            if (it == q.archetypeToMatchIndex.end())
-                return rows;
+                return 0u;
+            const uint32_t matchIdx = q.matchIndexOf(archetypeId);
+            if (matchIdx == Query::NoMatch)
+                return 0u;
 
-            const uint32_t matchIdx = it->second;
+            uint32_t count = 0;
             auto &bits = q.dirtyBits[matchIdx];
             for (size_t w = 0; w < bits.size(); ++w)
             {
+                // Cheap check first: most words are clean, and exchange would dirty their lines.
+                if (bits[w].v.load(std::memory_order_relaxed) == 0ull)
+                    continue;
                 // Atomically consume this word: exchange to 0 so concurrent markDirty is safe.
                 uint64_t word = bits[w].v.exchange(0ull, std::memory_order_acq_rel);
-                if (word == 0)
-                    continue;
                 while (word)
                 {
-                    const uint64_t lsb = word & (~word + 1ull);
+                    const uint32_t bit = lowestBit(word);
+                    fn(static_cast<uint32_t>(w * 64u + bit));
+                    ++count;
+                    word &= word - 1ull;
+                }
+            }
+
+            if (m_trace && t_currentSystemName && count)
+            {
+                m_trace->onDirtyConsumed(t_currentSystemName, archetypeId, count);
+            }
+            return count;
+        }
+
+        // Consume dirty rows into out (cleared first; keep it across frames to reuse its
+        // capacity). Rows come out in ascending order. Returns out.size().
+        uint32_t consumeDirtyRows(QueryId qid, uint32_t archetypeId, std::vector<uint32_t> &out)
+        {
+            out.clear();
+            return forEachDirtyRow(qid, archetypeId, [&out](uint32_t row)
+                                   { out.push_back(row); });
+        }
+
+        // Drop pending dirty rows (for systems that rebuild everything this frame anyway).
+        void discardDirtyRows(QueryId qid, uint32_t archetypeId)
+        {
+            forEachDirtyRow(qid, archetypeId, [](uint32_t) {});
+        }
+
+    private:
+        struct DirtyRoute
+        {
+            QueryId query = InvalidQuery;
+            uint32_t matchIdx = 0;
+            ComponentMask components; // the query's dirtyComponents
+        };
+
+        struct ArchetypeRoutes
+        {
+            ComponentMask components; // union over routes
+            std::vector<DirtyRoute> routes;
+        };
+
+        void addDirtyRoute(uint32_t archetypeId, QueryId query, uint32_t matchIdx, const ComponentMask &components)
+        {
+            if (archetypeId >= m_dirtyRoutes.size())
+                m_dirtyRoutes.resize(archetypeId + 1u);
+            ArchetypeRoutes &routes = m_dirtyRoutes[archetypeId];
+            routes.components |= components;
+            routes.routes.push_back(DirtyRoute{query, matchIdx, components});
+        }
+
+        static constexpr uint32_t NoKey = UINT32_MAX;
+
+        static uint32_t lowestBit(uint64_t word)
+        {
 #ifdef _MSC_VER
-                    unsigned long idx;
-                    _BitScanForward64(&idx, word);
-                    const uint32_t bit = static_cast<uint32_t>(idx);
+            unsigned long idx;
+            _BitScanForward64(&idx, word);
+            return static_cast<uint32_t>(idx);
 #else
-                    const uint32_t bit = static_cast<uint32_t>(__builtin_ctzll(word));
+            return static_cast<uint32_t>(__builtin_ctzll(word));
 #endif
-                    const uint32_t row = static_cast<uint32_t>(w * 64u + bit);
-                    rows.push_back(row);
-                    word ^= lsb;
+        }
+
+        static uint32_t highestComponent(const ComponentMask &mask)
+        {
+            for (size_t w = ComponentMask::WordCount; w-- > 0;)
+            {
+                const uint64_t word = mask.words()[w];
+                if (!word)
+                    continue;
+#ifdef _MSC_VER
+                unsigned long idx;
+                _BitScanReverse64(&idx, word);
+                return static_cast<uint32_t>(w * 64u + idx);
+#else
+                return static_cast<uint32_t>(w * 64u + 63u - static_cast<uint32_t>(__builtin_clzll(word)));
+#endif
+            }
+            return NoKey;
+        }
+
+        static void setArchetypeBit(std::vector<uint64_t> &bits, uint32_t archetypeId)
+        {
+            const size_t word = archetypeId / 64u;
+            if (word >= bits.size())
+                bits.resize(word + 1u, 0ull);
+            bits[word] |= 1ull << (archetypeId % 64u);
+        }
+
+        // Record a store in the per-component archetype sets (once per archetype).
+        void indexArchetype(uint32_t archetypeId, const ComponentMask &signature)
+        {
+            const size_t word = archetypeId / 64u;
+            if (word < m_indexed.size() && (m_indexed[word] & (1ull << (archetypeId % 64u))))
+                return;
+            setArchetypeBit(m_indexed, archetypeId);
+            for (size_t w = 0; w < ComponentMask::WordCount; ++w)
+            {
+                uint64_t bits = signature.words()[w];
+                while (bits)
+                {
+                    const uint32_t compId = static_cast<uint32_t>(w * 64u) + lowestBit(bits);
+                    bits &= bits - 1ull;
+                    if (compId >= m_archetypesWith.size())
+                        m_archetypesWith.resize(compId + 1u);
+                    setArchetypeBit(m_archetypesWith[compId], archetypeId);
                 }
             }
-            std::sort(rows.begin(), rows.end());
+        }
 
-            if (m_trace && t_currentSystemName && !rows.empty())
+        // Index stores that appeared without onStoreCreated (a manager filled before wiring).
+        // Only slots past the last sync are visited; later stores arrive through onStoreCreated.
+        void syncIndex(const ArchetypeStoreManager &mgr)
+        {
+            const auto &stores = mgr.stores();
+            for (uint32_t archetypeId = m_syncedSlots; archetypeId < stores.size(); ++archetypeId)
             {
-                m_trace->onDirtyConsumed(t_currentSystemName, archetypeId, static_cast<uint32_t>(rows.size()));
+                if (stores[archetypeId])
+                    indexArchetype(archetypeId, stores[archetypeId]->signature());
             }
+            m_syncedSlots = std::max(m_syncedSlots, static_cast<uint32_t>(stores.size()));
+        }
 
-            return rows;
+        void andArchetypes(std::vector<uint64_t> &acc, uint32_t compId) const
+        {
+            const std::vector<uint64_t> *with = (compId < m_archetypesWith.size()) ? &m_archetypesWith[compId] : nullptr;
+            const size_t n = with ? std::min(acc.size(), with->size()) : 0u;
+            for (size_t w = 0; w < n; ++w)
+                acc[w] &= (*with)[w];
+            acc.resize(n);
+        }
+
+        void andNotArchetypes(std::vector<uint64_t> &acc, uint32_t compId) const
+        {
+            if (compId >= m_archetypesWith.size())
+                return;
+            const std::vector<uint64_t> &with = m_archetypesWith[compId];
+            const size_t n = std::min(acc.size(), with.size());
+            for (size_t w = 0; w < n; ++w)
+                acc[w] &= ~with[w];
         }
 
-    private:
         std::vector<Query> m_queries;
+        std::vector<ArchetypeRoutes> m_dirtyRoutes; // by archetype id; dirty queries only
+
+        // Match index (see header). Archetype bitsets are indexed by archetype id.
+        std::vector<std::vector<uint64_t>> m_archetypesWith; // by component id
+        std::vector<uint64_t> m_indexed;                     // archetypes in the index
+        uint32_t m_syncedSlots = 0;                          // mgr.stores() slots syncIndex visited
+        std::vector<std::vector<QueryId>> m_queriesByKey;    // by highest required component id
+        std::vector<QueryId> m_unkeyedQueries;               // no required component
+        std::vector<uint64_t> m_matchScratch;
+        std::vector<QueryId> m_candidateScratch;
+        std::vector<uint64_t> m_permuteBits; // permuteRows scratch
 
         EcsTrace *m_trace = nullptr;
+        const ComponentRegistry *m_registry = nullptr; // not owned
 
         static thread_local const char *t_currentSystemName;
 
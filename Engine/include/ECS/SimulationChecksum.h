@@ -0,0 +1,85 @@
+#pragma once
+/*
+  SimulationChecksum.h
+  --------------------
+  Purpose:
+    - One 64-bit hash of the simulation state of a world, cheap enough to take every tick:
+      lockstep peers and input replays compare it to find the first tick they diverge on.
+
+  Usage:
+    - const std::vector<uint32_t> ids = {registry.getId("Position"), registry.getId("Health")};
+      uint64_t c = simulationChecksum(ecs, ids);
+
+  Notes:
+    - Per entity: FNV-1a over its handle and the bytes of each listed component it has. Entities
+      are combined by a sum of mixed hashes, so the result depends on what every entity holds,
+      not on store creation order or rows moved by swap-removes.
+    - Only trivially copyable components are hashed, bitwise: list components without padding
+      (Position, Velocity, Health, Facing, ...), and floats only agree between builds that
+      generate the same float code.
+*/
+
+#include "ECS/ECSContext.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace Engine::ECS
+{
+    inline uint64_t simulationChecksum(const ECSContext &ecs, const std::vector<uint32_t> &componentIds)
+    {
+        constexpr uint64_t FNV_OFFSET = 1469598103934665603ull;
+        constexpr uint64_t FNV_PRIME = 1099511628211ull;
+        auto fnv = [](uint64_t h, const void *data, size_t size)
+        {
+            const auto *bytes = static_cast<const unsigned char *>(data);
+            for (size_t i = 0; i < size; ++i)
+            {
+                h ^= bytes[i];
+                h *= FNV_PRIME;
+            }
+            return h;
+        };
+        // splitmix64 finalizer: spreads each entity hash before the order-independent sum.
+        auto mix = [](uint64_t x)
+        {
+            x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+            x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+            return x ^ (x >> 31);
+        };
+
+        uint64_t sum = 0;
+        std::vector<const ComponentColumn *> columns;
+        for (const auto &storePtr : ecs.stores.stores())
+        {
+            if (!storePtr || storePtr->size() == 0)
+                continue;
+            const ArchetypeStore &store = *storePtr;
+
+            columns.clear();
+            for (uint32_t id : componentIds)
+            {
+                const ComponentColumn *column = store.findColumn(id);
+                if (column && column->type().trivial)
+                    columns.push_back(column);
+            }
+            if (columns.empty())
+                continue;
+
+            const std::vector<Entity> &entities = store.entities();
+            for (uint32_t row = 0; row < store.size(); ++row)
+            {
+                uint64_t h = fnv(FNV_OFFSET, &entities[row], sizeof(Entity));
+                for (const ComponentColumn *column : columns)
+                {
+                    const uint32_t id = column->componentId();
+                    h = fnv(h, &id, sizeof(id));
+                    h = fnv(h, column->at(row), column->type().size);
+                }
+                sum += mix(h);
+            }
+        }
+        return sum;
+    }
+
+} // namespace Engine::ECS
@@ -0,0 +1,284 @@
+#pragma once
+/*
+  SnapshotFormat.h
+  ----------------
+  Purpose:
+    - The column format shared by world snapshots (WorldSnapshot.h) and entity packets
+      (EntityPacket.h): a component table that maps saved ids to names, then stores as a
+      StoreRecord, its signature, its Entity handles and one blob per trivially copyable column.
+
+  Usage:
+    - Writers: SnapshotWriter w; writeComponentTable(w, registry); w.put(StoreRecord{...}); ...
+    - Readers: SnapshotReader r{data, size, 0}; readComponentTable(r, n, registry, map, ...);
+      readStoreSection(r, map, view, what) once per store. Views point into the source bytes.
+
+  Notes:
+    - Native endianness; every section starts on a SNAPSHOT_ALIGNMENT boundary.
+    - Readers validate against the current registry by name, so ids may differ between writer and
+      reader; a component whose size or trivially-copyable flag changed is rejected.
+*/
+
+#include "ECS/ArchetypeStore.h"
+#include "ECS/Components.h"
+#include "ECS/Entity.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace Engine::ECS
+{
+    static constexpr size_t SNAPSHOT_ALIGNMENT = 16;
+
+    static constexpr uint32_t COMPONENT_TRIVIAL = 1u << 0;
+    static constexpr uint32_t COMPONENT_SPARSE_TAG = 1u << 1;
+
+    struct ComponentRecord
+    {
+        uint32_t nameLength = 0; // name bytes follow, not null-terminated
+        uint32_t size = 0;       // 0: tag (no column)
+        uint32_t flags = 0;      // COMPONENT_*
+    };
+
+    struct StoreRecord
+    {
+        uint32_t archetypeId = 0; // id at save time (informational: ids are reassigned on load)
+        uint32_t rowCount = 0;
+        uint32_t signatureCount = 0; // component ids follow, then Entity[rowCount]
+        uint32_t columnCount = 0;    // ColumnRecords (each followed by its rows) after the entities
+    };
+
+    struct ColumnRecord
+    {
+        uint32_t componentId = 0;
+        uint32_t elementSize = 0;
+        uint64_t byteCount = 0; // elementSize * rowCount
+    };
+
+    struct SparseTagRecord
+    {
+        uint32_t tagId = 0;
+        uint32_t count = 0; // Entity[count] follow
+    };
+
+    static_assert(sizeof(Entity) == 8, "Entity is stored verbatim");
+
+    struct SnapshotWriter
+    {
+        std::vector<uint8_t> bytes;
+
+        size_t append(const void *data, size_t size)
+        {
+            const size_t at = bytes.size();
+            bytes.resize(at + size);
+            if (size)
+                std::memcpy(bytes.data() + at, data, size);
+            return at;
+        }
+
+        template <typename T>
+        size_t put(const T &value) { return append(&value, sizeof(T)); }
+
+        void align() { bytes.resize((bytes.size() + SNAPSHOT_ALIGNMENT - 1) & ~(SNAPSHOT_ALIGNMENT - 1)); }
+    };
+
+    // Bounds-checked cursor over a byte range (mapped file, received packet).
+    struct SnapshotReader
+    {
+        const uint8_t *data = nullptr;
+        size_t size = 0;
+        size_t offset = 0;
+
+        const uint8_t *take(size_t count)
+        {
+            if (count > size - offset)
+                return nullptr;
+            const uint8_t *p = data + offset;
+            offset += count;
+            return p;
+        }
+
+        template <typename T>
+        bool get(T &out)
+        {
+            const uint8_t *p = take(sizeof(T));
+            if (!p)
+                return false;
+            std::memcpy(&out, p, sizeof(T));
+            return true;
+        }
+
+        bool align()
+        {
+            const size_t aligned = (offset + SNAPSHOT_ALIGNMENT - 1) & ~(SNAPSHOT_ALIGNMENT - 1);
+            if (aligned > size)
+                return false;
+            offset = aligned;
+            return true;
+        }
+    };
+
+    // One record per registry id, then align.
+    inline void writeComponentTable(SnapshotWriter &w, const ComponentRegistry &registry)
+    {
+        for (uint32_t id = 0; id < registry.count(); ++id)
+        {
+            const std::string &name = registry.getName(id);
+            const ComponentTypeInfo *type = registry.typeInfo(id);
+            ComponentRecord rec;
+            rec.nameLength = static_cast<uint32_t>(name.size());
+            rec.size = type ? type->size : 0u;
+            rec.flags = (type && type->trivial ? COMPONENT_TRIVIAL : 0u) | (registry.isSparseTag(id) ? COMPONENT_SPARSE_TAG : 0u);
+            w.put(rec);
+            w.append(name.data(), name.size());
+        }
+        w.align();
+    }
+
+    // Saved id -> current id (ensureId by name) and saved element size, per table entry.
+    struct ComponentIdMap
+    {
+        std::vector<uint32_t> ids;
+        std::vector<uint32_t> sizes;
+    };
+
+    // False on truncation (outMismatch empty) or when a component's layout differs from the
+    // current registry (outMismatch = its name).
+    inline bool readComponentTable(SnapshotReader &r, uint32_t count, ComponentRegistry &registry, ComponentIdMap &out,
+                                   std::string &outMismatch)
+    {
+        out.ids.assign(count, ComponentRegistry::InvalidID);
+        out.sizes.assign(count, 0u);
+        for (uint32_t id = 0; id < count; ++id)
+        {
+            ComponentRecord rec;
+            const uint8_t *name = nullptr;
+            if (!r.get(rec) || !(name = r.take(rec.nameLength)))
+                return false;
+
+            const std::string componentName(reinterpret_cast<const char *>(name), rec.nameLength);
+            const uint32_t newId = registry.ensureId(componentName);
+            const ComponentTypeInfo *type = registry.typeInfo(newId);
+            const uint32_t size = type ? type->size : 0u;
+            const bool sparse = registry.isSparseTag(newId);
+            if (newId == ComponentRegistry::InvalidID || size != rec.size ||
+                (rec.size && type->trivial != ((rec.flags & COMPONENT_TRIVIAL) != 0)) ||
+                sparse != ((rec.flags & COMPONENT_SPARSE_TAG) != 0))
+            {
+                outMismatch = componentName;
+                return false;
+            }
+            out.ids[id] = newId;
+            out.sizes[id] = rec.size;
+        }
+        return r.align();
+    }
+
+    struct SnapshotColumnView
+    {
+        uint32_t componentId = 0; // current registry id
+        const uint8_t *bytes = nullptr;
+        uint32_t elementSize = 0;
+    };
+
+    struct SnapshotStoreView
+    {
+        ComponentMask signature; // current registry ids
+        uint32_t rowCount = 0;
+        const uint8_t *entities = nullptr; // Entity[rowCount], unaligned: memcpy out
+        std::vector<SnapshotColumnView> columns;
+
+        Entity entity(uint32_t row) const
+        {
+            Entity e;
+            std::memcpy(&e, entities + static_cast<size_t>(row) * sizeof(Entity), sizeof(e));
+            return e;
+        }
+    };
+
+    // Parses one store section (StoreRecord .. last column). outWhat names the problem on failure.
+    inline bool readStoreSection(SnapshotReader &r, const ComponentIdMap &map, SnapshotStoreView &view, const char *&outWhat)
+    {
+        StoreRecord rec;
+        const uint8_t *ids = nullptr;
+        if (!r.get(rec) || !(ids = r.take(static_cast<size_t>(rec.signatureCount) * sizeof(uint32_t))) || !r.align())
+        {
+            outWhat = "truncated store";
+            return false;
+        }
+        view.signature = ComponentMask{};
+        for (uint32_t i = 0; i < rec.signatureCount; ++i)
+        {
+            uint32_t oldId;
+            std::memcpy(&oldId, ids + i * sizeof(uint32_t), sizeof(oldId));
+            if (oldId >= map.ids.size())
+            {
+                outWhat = "store signature names an unknown component";
+                return false;
+            }
+            view.signature.set(map.ids[oldId]);
+        }
+        view.rowCount = rec.rowCount;
+        view.entities = r.take(static_cast<size_t>(rec.rowCount) * sizeof(Entity));
+        if ((!view.entities && rec.rowCount) || !r.align())
+        {
+            outWhat = "truncated store entities";
+            return false;
+        }
+
+        view.columns.clear();
+        for (uint32_t c = 0; c < rec.columnCount; ++c)
+        {
+            ColumnRecord colRec;
+            if (!r.get(colRec) || !r.align() || colRec.componentId >= map.ids.size() ||
+                colRec.elementSize != map.sizes[colRec.componentId] ||
+                colRec.byteCount != static_cast<uint64_t>(colRec.elementSize) * rec.rowCount)
+            {
+                outWhat = "corrupt column";
+                return false;
+            }
+            const uint8_t *bytes = r.take(static_cast<size_t>(colRec.byteCount));
+            if ((!bytes && colRec.byteCount) || !r.align())
+            {
+                outWhat = "truncated column";
+                return false;
+            }
+            view.columns.push_back(SnapshotColumnView{map.ids[colRec.componentId], bytes, colRec.elementSize});
+        }
+        return true;
+    }
+
+    // Rows [first, first + count) were just copied in from another process or world: drop the
+    // handles into its caches (Path::waypoints / Path::flowField, RenderSlot, PosePalette's pool
+    // slot; the cleared source model forces a re-pose).
+    inline void resetForeignHandles(ArchetypeStore &store, uint32_t first, uint32_t count, uint32_t pathId, uint32_t renderSlotId)
+    {
+        ColumnView<Path> paths = store.column<Path>(pathId);
+        ColumnView<RenderSlot> renderSlots = store.column<RenderSlot>(renderSlotId);
+        ColumnView<PosePalette> poses = store.posePalettes();
+        for (uint32_t row = first, end = first + count; row < end; ++row)
+        {
+            if (!paths.empty())
+            {
+                Path &p = paths[row];
+                if (p.waypoints != 0 || p.flowField != 0)
+                {
+                    p.waypoints = 0;
+                    p.flowField = 0;
+                    p.valid = false;
+                    p.partial = false;
+                    p.count = 0;
+                    p.current = 0;
+                    p.corridorCell = 0;
+                    p.offCorridor = false;
+                }
+            }
+            if (!renderSlots.empty())
+                renderSlots[row] = RenderSlot{};
+            if (!poses.empty())
+                poses[row] = PosePalette{};
+        }
+    }
+
+} // namespace Engine::ECS
@@ -0,0 +1,86 @@
+#pragma once
+/*
+  SparseTagSet.h
+  --------------
+  Purpose:
+    - Membership of one sparse tag (ComponentRegistry::registerSparseTag): a sparse array
+      indexed by entity index pointing into a dense entity list.
+    - add/remove/has are O(1) and never touch the entity's archetype row, so toggling a tag
+      like Selected on hundreds of units costs no row migrations.
+
+  Notes:
+    - Owned by ECSContext (sparseTag(tagId)); ECSContext::destroyEntity removes dead entities.
+    - A stale entry (an older generation at the same index) counts as absent and is replaced by
+      the next add for that index.
+    - Dense order is unspecified (remove swaps the last entity in).
+*/
+
+#include <cstdint>
+#include <vector>
+#include "ECS/Entity.h"
+
+namespace Engine::ECS
+{
+    class SparseTagSet
+    {
+    public:
+        bool has(Entity e) const
+        {
+            if (e.index >= m_sparse.size())
+                return false;
+            const uint32_t pos = m_sparse[e.index];
+            return pos != NONE && m_dense[pos].generation == e.generation;
+        }
+
+        // Returns false if e already had the tag.
+        bool add(Entity e)
+        {
+            if (!e.valid())
+                return false;
+            if (e.index >= m_sparse.size())
+                m_sparse.resize(static_cast<size_t>(e.index) + 1u, NONE);
+            uint32_t &pos = m_sparse[e.index];
+            if (pos != NONE)
+            {
+                if (m_dense[pos].generation == e.generation)
+                    return false;
+                m_dense[pos] = e; // stale entry of a destroyed entity
+                return true;
+            }
+            pos = static_cast<uint32_t>(m_dense.size());
+            m_dense.push_back(e);
+            return true;
+        }
+
+        // Returns false if e didn't have the tag.
+        bool remove(Entity e)
+        {
+            if (!has(e))
+                return false;
+            const uint32_t pos = m_sparse[e.index];
+            const Entity last = m_dense.back();
+            m_dense[pos] = last;
+            m_sparse[last.index] = pos;
+            m_dense.pop_back();
+            m_sparse[e.index] = NONE;
+            return true;
+        }
+
+        void clear()
+        {
+            for (const Entity &e : m_dense)
+                m_sparse[e.index] = NONE;
+            m_dense.clear();
+        }
+
+        uint32_t size() const { return static_cast<uint32_t>(m_dense.size()); }
+        bool empty() const { return m_dense.empty(); }
+        const std::vector<Entity> &entities() const { return m_dense; }
+
+    private:
+        static constexpr uint32_t NONE = UINT32_MAX;
+
+        std::vector<uint32_t> m_sparse; // entity index -> position in m_dense (NONE = absent)
+        std::vector<Entity> m_dense;
+    };
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace Engine::ECS
+{
+    // Rows of several archetype stores laid out back to back in one flat index range, so a
+    // single JobSystem::parallelForRange can cover all stores matched by a query.
+    // Flat rows [firstRow, firstRow + rowCount) map to store rows [0, rowCount).
+    struct StoreRowSpan
+    {
+        uint32_t archetypeId = UINT32_MAX;
+        uint32_t firstRow = 0;
+        uint32_t rowCount = 0;
+    };
+
+    class StoreRowSpans
+    {
+    public:
+        void clear()
+        {
+            m_spans.clear();
+            m_totalRows = 0;
+        }
+
+        void add(uint32_t archetypeId, uint32_t rowCount)
+        {
+            if (rowCount == 0u)
+                return;
+            m_spans.push_back(StoreRowSpan{archetypeId, m_totalRows, rowCount});
+            m_totalRows += rowCount;
+        }
+
+        bool empty() const { return m_spans.empty(); }
+        uint32_t totalRows() const { return m_totalRows; }
+        const std::vector<StoreRowSpan> &spans() const { return m_spans; }
+
+        // Visit the store-local pieces of flat range [first, last).
+        // Visitor signature: void(const StoreRowSpan &span, uint32_t startRow, uint32_t endRow)
+        template <typename Visitor>
+        void forEachInRange(uint32_t first, uint32_t last, Visitor &&visit) const
+        {
+            auto it = std::upper_bound(m_spans.begin(), m_spans.end(), first,
+                                       [](uint32_t v, const StoreRowSpan &sp)
+                                       { return v < sp.firstRow; });
+            if (it == m_spans.begin())
+                return;
+            --it;
+
+            for (; it != m_spans.end() && first < last; ++it)
+            {
+                const uint32_t start = first - it->firstRow;
+                const uint32_t end = std::min(last - it->firstRow, it->rowCount);
+                visit(*it, start, end);
+                first = it->firstRow + end;
+            }
+        }
+
+    private:
+        std::vector<StoreRowSpan> m_spans;
+        uint32_t m_totalRows = 0;
+    };
+}
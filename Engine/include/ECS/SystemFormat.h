@@ -12,7 +12,13 @@
     - Application should expose these managers to SampleApp (e.g., via getters or an ECSContext).
     - SampleApp constructs systems that follow this format and calls update() each frame.
 
-  You can evolve this into a scheduler later.
+    - Systems may also declare which components (or shared resources such as "NavGrid")
+      they read and write. SystemScheduler uses these sets to run independent systems
+      concurrently; systems that declare nothing are treated as exclusive.
+
+    - Systems whose work can be spread over several updates (path requests, target scans, ...)
+      report it in "work units" (isAmortized / workRemaining / workDone) and honour
+      workBudget(); SystemScheduler sets that budget from its time budgets.
 */
 
 #include "ECS/Components.h"     // ComponentRegistry, ComponentMask
@@ -48,6 +54,35 @@ namespace Engine::ECS
     void setRequiredNames(const std::vector<std::string> &names) { m_requiredNames = names; }
     void setExcludedNames(const std::vector<std::string> &names) { m_excludedNames = names; }
 
+    // Scheduling hints: names of components/resources this system reads or writes.
+    // Names are only compared against other systems' declarations; they do not need to be
+    // registered components (e.g. "SpatialIndex", "Renderer").
+    // A system that declares neither set is scheduled as exclusive (it runs alone).
+    void setReadNames(const std::vector<std::string> &names)
+    {
+      m_readNames = names;
+      m_accessDeclared = true;
+    }
+    void setWriteNames(const std::vector<std::string> &names)
+    {
+      m_writeNames = names;
+      m_accessDeclared = true;
+    }
+
+    const std::vector<std::string> &readNames() const { return m_readNames; }
+    const std::vector<std::string> &writeNames() const { return m_writeNames; }
+    bool hasAccessDeclaration() const { return m_accessDeclared; }
+
+    // Amortized work: the units the next update() may process (UNLIMITED_WORK = all that are
+    // due). Work over the budget is left for a later update.
+    static constexpr uint32_t UNLIMITED_WORK = UINT32_MAX;
+    virtual bool isAmortized() const { return false; }
+    // Units waiting before the next update() (an estimate is fine) / processed by the last one.
+    virtual uint32_t workRemaining() const { return 0; }
+    virtual uint32_t workDone() const { return 0; }
+    void setWorkBudget(uint32_t units) { m_workBudget = units; }
+    uint32_t workBudget() const { return m_workBudget; }
+
     void buildMasks(ComponentRegistry &registry) override
     {
       // Build required mask from names
@@ -74,6 +109,10 @@ namespace Engine::ECS
   private:
     std::vector<std::string> m_requiredNames;
     std::vector<std::string> m_excludedNames;
+    std::vector<std::string> m_readNames;
+    std::vector<std::string> m_writeNames;
+    bool m_accessDeclared = false;
+    uint32_t m_workBudget = UNLIMITED_WORK;
     ComponentMask m_required;
     ComponentMask m_excluded;
   };
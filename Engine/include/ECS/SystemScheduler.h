@@ -0,0 +1,366 @@
+#pragma once
+/*
+  SystemScheduler.h
+  -----------------
+  Purpose:
+    - Run a list of SystemBase systems as a dependency graph instead of a fixed serial list.
+    - Systems declare read/write sets (SystemBase::setReadNames / setWriteNames). Two systems
+      conflict when one writes something the other reads or writes.
+    - Registration order is the reference serial order: a system depends on every earlier
+      system it conflicts with, so results match running the list one by one.
+
+  Execution:
+    - The graph is flattened into levels (wavefronts). Systems inside a level are independent
+      and run concurrently on the JobSystem; levels run one after another.
+    - Systems without access declarations are exclusive barriers (e.g. systems that make
+      structural changes such as adding/removing tags directly).
+    - ecs.commands (EntityCommandBuffer) is played back after every level, so a system that
+      records its structural changes there doesn't need to be exclusive for them.
+
+  Notes:
+    - Systems create their queries lazily inside update(), which mutates QueryManager. Frames
+      therefore run serially until the query count has been stable for one full frame
+      (first frames after startup, after QueryManager::clear(), ...).
+    - Systems running concurrently may still call parallelFor; the JobSystem supports nested
+      loops, so their items are spread over idle workers as usual.
+    - Config::recordTimings keeps the wall time of every system's last update() (systemLastMs),
+      also in production builds where EcsTrace is compiled out (benchmarks).
+    - Every update() runs inside a profiler zone named after the system (utils/Profiler.h).
+
+  Budgets:
+    - Config::frameBudgetMs caps a whole run(), setSystemBudgetMs one system. Only amortized
+      systems (SystemBase::isAmortized) are throttled: before each run() every one of them gets
+      a work budget (SystemBase::setWorkBudget) of the units that fit its share of the time.
+    - Costs are the same per-update wall times EcsTrace receives, kept as running averages (also
+      in production builds): the other systems' milliseconds are taken off the frame budget and
+      the rest is split between the amortized systems in proportion to their measured cost per
+      unit times workRemaining(). Systems are summed as if serial, so the split errs low when a
+      level runs in parallel.
+    - Until a system has reported work once its budget stays unlimited; it never drops below
+      Config::minWorkUnits, so queued work keeps moving under any spike.
+    - Throttling depends on wall time: lockstep runs turn it off (Config::enableThrottling).
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ECS/SystemFormat.h"
+#include "utils/JobSystem.h"
+#include "utils/Profiler.h"
+
+#include <chrono>
+
+namespace Engine::ECS
+{
+    class SystemScheduler
+    {
+    public:
+        struct Config
+        {
+            // When false, every level runs serially (useful for debugging ordering issues).
+            bool enableParallel = true;
+            // Time every system.update() (systemLastMs), independent of the debug trace.
+            bool recordTimings = false;
+            // > 0: milliseconds one run() should stay within by throttling amortized systems.
+            float frameBudgetMs = 0.0f;
+            // Fewest work units a throttled system is given per run().
+            uint32_t minWorkUnits = 8;
+            // false: amortized systems run unlimited whatever the budgets.
+            bool enableThrottling = true;
+        };
+
+        struct Stats
+        {
+            uint32_t systemCount = 0;
+            uint32_t levelCount = 0;
+            uint32_t widestLevel = 0;
+
+            // Last run()
+            uint32_t parallelLevels = 0;
+            bool ranSerial = true;
+            uint32_t throttledSystems = 0; // given fewer units than they had waiting
+        };
+
+        void setConfig(const Config &cfg) { m_cfg = cfg; }
+        const Config &config() const { return m_cfg; }
+        const Stats &stats() const { return m_stats; }
+
+        // Remove all systems (the graph is rebuilt on next run()).
+        void clear()
+        {
+            m_nodes.clear();
+            m_systemBudgets = 0;
+            m_budgetsApplied = false;
+            m_levels.clear();
+            m_accessIds.clear();
+            m_built = false;
+            m_queriesStable = false;
+            m_stats = Stats{};
+        }
+
+        // Register a system. Registration order defines the serial reference order.
+        // The scheduler does not own the system.
+        void addSystem(SystemBase &system)
+        {
+            Node n;
+            n.system = &system;
+            m_nodes.push_back(std::move(n));
+            m_built = false;
+        }
+
+        // Levels of system indices (registration order inside each level). Valid after build().
+        const std::vector<std::vector<uint32_t>> &levels() const { return m_levels; }
+        const SystemBase *systemAt(uint32_t index) const { return index < m_nodes.size() ? m_nodes[index].system : nullptr; }
+        uint32_t systemCount() const { return static_cast<uint32_t>(m_nodes.size()); }
+        // Wall time of the system's update() in the last run() (Config::recordTimings, else 0).
+        float systemLastMs(uint32_t index) const { return index < m_nodes.size() ? m_nodes[index].lastMs : 0.0f; }
+
+        // Milliseconds per run() for the named system (<= 0 removes the cap). Only amortized
+        // systems are held to it. False when no registered system has that name.
+        bool setSystemBudgetMs(const std::string &name, float ms)
+        {
+            for (Node &n : m_nodes)
+            {
+                if (name != n.system->name())
+                    continue;
+                m_systemBudgets += (ms > 0.0f ? 1 : 0) - (n.budgetMs > 0.0f ? 1 : 0);
+                n.budgetMs = std::max(ms, 0.0f);
+                return true;
+            }
+            return false;
+        }
+
+        // Resolve access sets and build the dependency levels. Called lazily by run().
+        void build()
+        {
+            m_accessIds.clear();
+            for (Node &n : m_nodes)
+            {
+                n.reads = ComponentMask{};
+                n.writes = ComponentMask{};
+                n.exclusive = !n.system->hasAccessDeclaration();
+                n.amortized = n.system->isAmortized();
+                for (const auto &name : n.system->readNames())
+                    n.reads.set(accessId(name));
+                for (const auto &name : n.system->writeNames())
+                    n.writes.set(accessId(name));
+            }
+
+            std::vector<uint32_t> levelOf(m_nodes.size(), 0u);
+            uint32_t levelCount = 0;
+            for (uint32_t i = 0; i < m_nodes.size(); ++i)
+            {
+                uint32_t level = 0;
+                for (uint32_t j = 0; j < i; ++j)
+                {
+                    if (conflicts(m_nodes[i], m_nodes[j]))
+                        level = std::max(level, levelOf[j] + 1u);
+                }
+                levelOf[i] = level;
+                levelCount = std::max(levelCount, level + 1u);
+            }
+
+            m_levels.assign(levelCount, {});
+            for (uint32_t i = 0; i < m_nodes.size(); ++i)
+                m_levels[levelOf[i]].push_back(i);
+
+            m_stats.systemCount = static_cast<uint32_t>(m_nodes.size());
+            m_stats.levelCount = levelCount;
+            m_stats.widestLevel = 0;
+            for (const auto &lvl : m_levels)
+                m_stats.widestLevel = std::max(m_stats.widestLevel, static_cast<uint32_t>(lvl.size()));
+
+            m_built = true;
+        }
+
+        void run(ECSContext &ecs, float dt)
+        {
+            if (!m_built)
+                build();
+
+            const uint32_t queriesBefore = ecs.queries.queryCount();
+            const bool queriesStable = m_queriesStable && (queriesBefore == m_lastQueryCount);
+            const bool canParallel = m_cfg.enableParallel && ecs.jobSystem && ecs.jobSystem->workerCount() > 0 &&
+                                     queriesStable;
+
+            m_stats.parallelLevels = 0;
+            m_stats.ranSerial = !canParallel;
+            assignWorkBudgets();
+
+            for (const auto &level : m_levels)
+            {
+                // Chunk changes made by this level are newer than any version a system of an
+                // earlier level (or an earlier frame) remembered.
+                ecs.advanceChangeVersion();
+
+                if (!canParallel || level.size() < 2u)
+                {
+                    for (uint32_t idx : level)
+                        runSystem(ecs, m_nodes[idx], dt);
+                }
+                else
+                {
+                    ++m_stats.parallelLevels;
+                    ecs.jobSystem->parallelFor(static_cast<uint32_t>(level.size()), [&](uint32_t, uint32_t item)
+                                               { runSystem(ecs, m_nodes[level[item]], dt); });
+                }
+
+                // Sync point: structural changes recorded by this level's systems.
+                ecs.playbackCommands();
+            }
+
+            const uint32_t queriesAfter = ecs.queries.queryCount();
+            m_queriesStable = (queriesAfter == queriesBefore);
+            m_lastQueryCount = queriesAfter;
+        }
+
+    private:
+        struct Node
+        {
+            SystemBase *system = nullptr;
+            ComponentMask reads;
+            ComponentMask writes;
+            bool exclusive = true;
+            bool amortized = false;
+            float lastMs = 0.0f; // written only by the thread running this node
+            float budgetMs = 0.0f;      // setSystemBudgetMs; 0 = none
+            float avgMs = 0.0f;         // running average of update() wall time
+            float avgUnitMs = 0.0f;     // amortized: running average per work unit
+        };
+
+        static constexpr float COST_SMOOTHING = 0.25f; // weight of the newest sample
+
+        bool budgeting() const { return m_cfg.enableThrottling && (m_cfg.frameBudgetMs > 0.0f || m_systemBudgets > 0); }
+
+        // Work budgets for the amortized systems from the averages of earlier runs (see "Budgets").
+        void assignWorkBudgets()
+        {
+            m_stats.throttledSystems = 0;
+            if (!budgeting())
+            {
+                if (m_budgetsApplied)
+                {
+                    for (Node &n : m_nodes)
+                        n.system->setWorkBudget(SystemBase::UNLIMITED_WORK);
+                    m_budgetsApplied = false;
+                }
+                return;
+            }
+            m_budgetsApplied = true;
+
+            float fixedMs = 0.0f;
+            float demandMs = 0.0f;
+            for (const Node &n : m_nodes)
+            {
+                if (n.amortized)
+                    demandMs += n.avgUnitMs * static_cast<float>(n.system->workRemaining());
+                else
+                    fixedMs += n.avgMs;
+            }
+            const bool overFrame = m_cfg.frameBudgetMs > 0.0f && demandMs > 0.0f && demandMs > m_cfg.frameBudgetMs - fixedMs;
+            const float share = overFrame ? std::max(m_cfg.frameBudgetMs - fixedMs, 0.0f) / demandMs : 1.0f;
+
+            for (Node &n : m_nodes)
+            {
+                if (!n.amortized)
+                    continue;
+                uint32_t units = SystemBase::UNLIMITED_WORK;
+                const uint32_t remaining = n.system->workRemaining();
+                if (n.avgUnitMs > 0.0f && (overFrame || n.budgetMs > 0.0f))
+                {
+                    float ms = overFrame ? n.avgUnitMs * static_cast<float>(remaining) * share : n.budgetMs;
+                    if (n.budgetMs > 0.0f)
+                        ms = std::min(ms, n.budgetMs);
+                    const float fit = std::min(ms / n.avgUnitMs, 4.0e9f);
+                    units = std::max(m_cfg.minWorkUnits, static_cast<uint32_t>(fit));
+                }
+                n.system->setWorkBudget(units);
+                m_stats.throttledSystems += (units < remaining) ? 1u : 0u;
+            }
+        }
+
+        // Folds the update() that just ran into the node's averages.
+        static void sampleCost(Node &node, float ms)
+        {
+            node.avgMs = (node.avgMs > 0.0f) ? node.avgMs + (ms - node.avgMs) * COST_SMOOTHING : ms;
+            const uint32_t done = node.amortized ? node.system->workDone() : 0u;
+            if (done == 0)
+                return;
+            const float unitMs = ms / static_cast<float>(done);
+            node.avgUnitMs = (node.avgUnitMs > 0.0f) ? node.avgUnitMs + (unitMs - node.avgUnitMs) * COST_SMOOTHING : unitMs;
+        }
+
+        static bool conflicts(const Node &a, const Node &b)
+        {
+            if (a.exclusive || b.exclusive)
+                return true;
+            if (!a.writes.containsNone(b.writes))
+                return true;
+            if (!a.writes.containsNone(b.reads))
+                return true;
+            if (!b.writes.containsNone(a.reads))
+                return true;
+            return false;
+        }
+
+        uint32_t accessId(const std::string &name)
+        {
+            auto it = m_accessIds.find(name);
+            if (it != m_accessIds.end())
+                return it->second;
+            const uint32_t id = static_cast<uint32_t>(m_accessIds.size());
+            m_accessIds.emplace(name, id);
+            return id;
+        }
+
+        void runSystem(ECSContext &ecs, Node &node, float dt)
+        {
+            SystemBase &system = *node.system;
+            ENGINE_PROFILE_ZONE(system.name());
+            ecs.queries.setCurrentSystemName(system.name());
+#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
+            constexpr bool kTrace = true;
+#else
+            constexpr bool kTrace = false;
+#endif
+            if (kTrace || m_cfg.recordTimings || budgeting())
+            {
+                const auto t0 = std::chrono::high_resolution_clock::now();
+                system.update(ecs, dt);
+                const auto t1 = std::chrono::high_resolution_clock::now();
+                const float ms = std::chrono::duration<float, std::milli>(t1 - t0).count();
+                node.lastMs = m_cfg.recordTimings ? ms : 0.0f;
+                if (budgeting())
+                    sampleCost(node, ms);
+                if (kTrace)
+                    ecs.trace.onSystemEnd(system.name(), ms, 0u, 0u);
+            }
+            else
+            {
+                system.update(ecs, dt);
+            }
+            ecs.queries.clearCurrentSystemName();
+        }
+
+    private:
+        Config m_cfg{};
+        Stats m_stats{};
+
+        std::vector<Node> m_nodes;
+        std::vector<std::vector<uint32_t>> m_levels;
+
+        // Access names -> local bit index (independent of ComponentRegistry ids so resources
+        // like "NavGrid" do not become components).
+        std::unordered_map<std::string, uint32_t> m_accessIds;
+
+        int m_systemBudgets = 0; // nodes with budgetMs > 0
+        bool m_budgetsApplied = false;
+
+        bool m_built = false;
+        bool m_queriesStable = false;
+        uint32_t m_lastQueryCount = 0;
+    };
+}
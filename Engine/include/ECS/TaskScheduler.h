@@ -0,0 +1,345 @@
+#pragma once
+/*
+  TaskScheduler.h
+  ---------------
+  Purpose:
+    - Run sequenced gameplay logic ("walk there, then wait, then ...") as stackless tasks that
+      sleep until they have something to do, instead of per-frame state machines that poll
+      every unit every tick.
+
+  Model:
+    - A task is a plain value (the caller's Task type) holding its own state, typically a stage
+      index plus whatever the next stage needs. Resuming it runs one step and returns what to
+      wait for next (TaskWait): a number of ticks, a number of simulated seconds, an event, or
+      done. C++17 has no coroutines, so the "suspension point" is the state kept in the task.
+    - tick(dt, jobs, resume, commit) advances the clock and resumes every task that is due:
+        resume(task, workerIndex) -> TaskWait   runs on JobSystem workers when enough tasks
+                                                are due; must only write its own task state
+        commit(task, wait)                      runs serially on the caller afterwards, in
+                                                slot order, to apply buffered effects
+                                                (may cancel(), must not spawn())
+      Only due tasks are touched: a task sleeping for 300 ticks costs nothing in between.
+    - signal(event) wakes every task waiting on that event at the next tick().
+      A cancelled task leaves its event's waiter list at once, so events that never fire
+      cost nothing once nobody waits on them.
+
+  Determinism:
+    - Due tasks are resumed/committed in slot order; slot reuse follows spawn/finish order,
+      so a replay with the same spawns gets the same order.
+*/
+
+#include "utils/JobSystem.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Engine::ECS
+{
+    // What a task waits for after a step.
+    struct TaskWait
+    {
+        enum class Kind : uint8_t
+        {
+            Done = 0,
+            Ticks,   // resume after `ticks` more tick() calls (0 counts as 1)
+            Seconds, // resume once `seconds` of tick() dt have passed
+            Event    // resume at the tick() after signal(event)
+        };
+
+        Kind kind = Kind::Done;
+        uint32_t ticks = 0;
+        uint32_t event = 0;
+        float seconds = 0.0f;
+
+        static TaskWait done() { return TaskWait{}; }
+        static TaskWait nextTick() { return forTicks(1u); }
+        static TaskWait forTicks(uint32_t n)
+        {
+            TaskWait w;
+            w.kind = Kind::Ticks;
+            w.ticks = n;
+            return w;
+        }
+        static TaskWait forSeconds(float s)
+        {
+            TaskWait w;
+            w.kind = Kind::Seconds;
+            w.seconds = s;
+            return w;
+        }
+        static TaskWait forEvent(uint32_t id)
+        {
+            TaskWait w;
+            w.kind = Kind::Event;
+            w.event = id;
+            return w;
+        }
+    };
+
+    struct TaskHandle
+    {
+        uint32_t slot = UINT32_MAX;
+        uint32_t generation = 0;
+
+        bool valid() const { return slot != UINT32_MAX; }
+    };
+
+    template <typename Task>
+    class TaskScheduler
+    {
+    public:
+        // =====================
+        // TUNING CONSTANTS
+        // =====================
+        static constexpr uint32_t PARALLEL_RESUME_THRESHOLD = 128; // due tasks before using workers
+
+        // Counters of the last tick().
+        struct Stats
+        {
+            uint32_t live = 0;    // tasks not finished
+            uint32_t resumed = 0; // tasks that ran a step
+            uint32_t finished = 0;
+        };
+
+        // The task first runs at the next tick().
+        TaskHandle spawn(Task task)
+        {
+            uint32_t slot;
+            if (!m_freeSlots.empty())
+            {
+                slot = m_freeSlots.back();
+                m_freeSlots.pop_back();
+                m_slots[slot].task = std::move(task);
+            }
+            else
+            {
+                slot = static_cast<uint32_t>(m_slots.size());
+                m_slots.push_back(Slot{std::move(task), 0u, false});
+            }
+            Slot &s = m_slots[slot];
+            s.live = true;
+            ++m_live;
+            const TaskHandle handle{slot, s.generation};
+            pushTick(m_tick + 1u, handle);
+            return handle;
+        }
+
+        // Drop a task without resuming it again (no-op for finished handles).
+        void cancel(TaskHandle handle)
+        {
+            if (!isLive(handle))
+                return;
+            release(handle.slot);
+        }
+
+        bool isLive(TaskHandle handle) const
+        {
+            return handle.slot < m_slots.size() && m_slots[handle.slot].live &&
+                   m_slots[handle.slot].generation == handle.generation;
+        }
+
+        // Wake the tasks waiting on `event` at the next tick().
+        void signal(uint32_t event) { m_signals.push_back(event); }
+
+        // Drop every task (restart, new battle).
+        void clear()
+        {
+            for (uint32_t slot = 0; slot < m_slots.size(); ++slot)
+            {
+                if (m_slots[slot].live)
+                    release(slot);
+            }
+            m_tickHeap.clear();
+            m_timeHeap.clear();
+            m_eventWaiters.clear();
+            m_signals.clear();
+        }
+
+        uint32_t liveCount() const { return m_live; }
+        const Stats &stats() const { return m_stats; }
+        uint64_t tickCount() const { return m_tick; }
+
+        template <typename ResumeFn, typename CommitFn>
+        void tick(float dt, JobSystem *jobs, ResumeFn &&resume, CommitFn &&commit)
+        {
+            ++m_tick;
+            m_time += static_cast<double>(dt);
+            m_stats = Stats{};
+
+            collectDue();
+            const uint32_t count = static_cast<uint32_t>(m_due.size());
+            m_results.resize(count);
+
+            if (jobs && count >= PARALLEL_RESUME_THRESHOLD)
+            {
+                jobs->parallelForRange(0u, count, JobSystem::AutoGrain,
+                                       [&](uint32_t workerIndex, uint32_t first, uint32_t last)
+                                       {
+                                           for (uint32_t i = first; i < last; ++i)
+                                               m_results[i] = resume(m_slots[m_due[i].slot].task, workerIndex);
+                                       });
+            }
+            else
+            {
+                const uint32_t workerIndex = jobs ? jobs->workerCount() : 0u;
+                for (uint32_t i = 0; i < count; ++i)
+                    m_results[i] = resume(m_slots[m_due[i].slot].task, workerIndex);
+            }
+
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                const TaskHandle handle = m_due[i];
+                const TaskWait &wait = m_results[i];
+                commit(m_slots[handle.slot].task, wait);
+                // commit may have cancelled the task.
+                if (!isLive(handle))
+                    continue;
+                schedule(handle, wait);
+            }
+
+            m_stats.live = m_live;
+            m_stats.resumed = count;
+        }
+
+    private:
+        struct Slot
+        {
+            Task task;
+            uint32_t generation;
+            bool live;
+            bool waitingEvent = false; // listed in m_eventWaiters[event]
+            uint32_t event = 0;
+        };
+
+        struct TickEntry
+        {
+            uint64_t tick;
+            TaskHandle handle;
+        };
+
+        struct TimeEntry
+        {
+            double time;
+            TaskHandle handle;
+        };
+
+        // Min-heaps (std::push_heap builds max-heaps, so compare with >).
+        static bool laterTick(const TickEntry &a, const TickEntry &b) { return a.tick > b.tick; }
+        static bool laterTime(const TimeEntry &a, const TimeEntry &b) { return a.time > b.time; }
+
+        void pushTick(uint64_t tick, TaskHandle handle)
+        {
+            m_tickHeap.push_back(TickEntry{tick, handle});
+            std::push_heap(m_tickHeap.begin(), m_tickHeap.end(), &laterTick);
+        }
+
+        void schedule(TaskHandle handle, const TaskWait &wait)
+        {
+            switch (wait.kind)
+            {
+            case TaskWait::Kind::Done:
+                release(handle.slot);
+                ++m_stats.finished;
+                break;
+            case TaskWait::Kind::Ticks:
+                pushTick(m_tick + std::max(1u, wait.ticks), handle);
+                break;
+            case TaskWait::Kind::Seconds:
+                m_timeHeap.push_back(TimeEntry{m_time + static_cast<double>(std::max(0.0f, wait.seconds)), handle});
+                std::push_heap(m_timeHeap.begin(), m_timeHeap.end(), &laterTime);
+                break;
+            case TaskWait::Kind::Event:
+                m_eventWaiters[wait.event].push_back(handle);
+                m_slots[handle.slot].waitingEvent = true;
+                m_slots[handle.slot].event = wait.event;
+                break;
+            }
+        }
+
+        void release(uint32_t slot)
+        {
+            Slot &s = m_slots[slot];
+            // Events may never fire: take the task off its waiter list now.
+            if (s.waitingEvent)
+                dropWaiter(s.event, slot);
+            s.waitingEvent = false;
+            s.live = false;
+            ++s.generation; // stale heap entries stop matching
+            s.task = Task{};
+            m_freeSlots.push_back(slot);
+            --m_live;
+        }
+
+        void dropWaiter(uint32_t event, uint32_t slot)
+        {
+            auto it = m_eventWaiters.find(event);
+            if (it == m_eventWaiters.end())
+                return;
+            std::vector<TaskHandle> &waiters = it->second;
+            waiters.erase(std::remove_if(waiters.begin(), waiters.end(), [slot](const TaskHandle &h)
+                                         { return h.slot == slot; }),
+                          waiters.end());
+            if (waiters.empty())
+                m_eventWaiters.erase(it);
+        }
+
+        // Everything due this tick, live and unique, in slot order.
+        void collectDue()
+        {
+            m_due.clear();
+            while (!m_tickHeap.empty() && m_tickHeap.front().tick <= m_tick)
+            {
+                std::pop_heap(m_tickHeap.begin(), m_tickHeap.end(), &laterTick);
+                addDue(m_tickHeap.back().handle);
+                m_tickHeap.pop_back();
+            }
+            while (!m_timeHeap.empty() && m_timeHeap.front().time <= m_time)
+            {
+                std::pop_heap(m_timeHeap.begin(), m_timeHeap.end(), &laterTime);
+                addDue(m_timeHeap.back().handle);
+                m_timeHeap.pop_back();
+            }
+            for (uint32_t event : m_signals)
+            {
+                auto it = m_eventWaiters.find(event);
+                if (it == m_eventWaiters.end())
+                    continue;
+                for (const TaskHandle &handle : it->second)
+                {
+                    if (isLive(handle))
+                        m_slots[handle.slot].waitingEvent = false;
+                    addDue(handle);
+                }
+                m_eventWaiters.erase(it);
+            }
+            m_signals.clear();
+
+            std::sort(m_due.begin(), m_due.end(), [](const TaskHandle &a, const TaskHandle &b)
+                      { return a.slot < b.slot; });
+        }
+
+        void addDue(TaskHandle handle)
+        {
+            if (isLive(handle))
+                m_due.push_back(handle);
+        }
+
+        std::vector<Slot> m_slots;
+        std::vector<uint32_t> m_freeSlots;
+        uint32_t m_live = 0;
+
+        uint64_t m_tick = 0;
+        double m_time = 0.0;
+        std::vector<TickEntry> m_tickHeap;
+        std::vector<TimeEntry> m_timeHeap;
+        std::unordered_map<uint32_t, std::vector<TaskHandle>> m_eventWaiters;
+        std::vector<uint32_t> m_signals;
+
+        std::vector<TaskHandle> m_due;   // tick() scratch
+        std::vector<TaskWait> m_results; // parallel to m_due
+        Stats m_stats{};
+    };
+}
@@ -0,0 +1,242 @@
+#pragma once
+/*
+  TypedQuery.h
+  ------------
+  Purpose:
+    - Queries spelled as types: TypedQuery<Read<Position>, Write<Velocity>, Opt<Team>>. The
+      masks come from compile-time component ids (ComponentId<T>), the loop hands the body typed
+      references per row, and the read/write sets can feed SystemBase's scheduling hints.
+
+  Usage:
+    - using Units = TypedQuery<Write<MoveTarget>, Read<MoveSpeed>, Opt<Position>>;
+    - Constructor:  Units::appendAccess(reads, writes); setReadNames(reads); setWriteNames(writes);
+    - update():     if (!m_units.valid()) m_units.build(ecs, {"Selected"}, {"Dead", "Disabled"});
+                    m_units.forEach(ecs, [&](const QueryRow &row, MoveTarget &t, const MoveSpeed &s,
+                                             const Position *p) { ... });
+    - Read<T> / Write<T> are required and arrive as const T& / T&; Opt<T> / OptWrite<T> are not
+      and arrive as const T* / T*, nullptr for archetypes without T.
+
+  Notes:
+    - Per archetype, the present optional components are resolved once and the row loop is
+      instantiated for exactly that combination, so an Opt argument is a compile-time nullptr
+      in archetypes that lack it: `if (p)` in the body folds away instead of branching per row.
+    - Rows are visited one chunk at a time with plain pointers into the chunk's arrays.
+    - Tags (Selected, Dead, Disabled, ...) have no type; build() takes them by name. A query with
+      sparse tags visits rows through ECSContext::forEachQueryRow.
+    - Like ECSContext::forEachQueryRow, the body must not make structural changes.
+*/
+
+#include "ECS/ECSContext.h"
+
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Engine::ECS
+{
+    template <typename T>
+    struct Read
+    {
+        using Component = T;
+        using Element = const T;
+        static constexpr bool optional = false;
+        static constexpr bool write = false;
+    };
+
+    template <typename T>
+    struct Write
+    {
+        using Component = T;
+        using Element = T;
+        static constexpr bool optional = false;
+        static constexpr bool write = true;
+    };
+
+    template <typename T>
+    struct Opt
+    {
+        using Component = T;
+        using Element = const T;
+        static constexpr bool optional = true;
+        static constexpr bool write = false;
+    };
+
+    template <typename T>
+    struct OptWrite
+    {
+        using Component = T;
+        using Element = T;
+        static constexpr bool optional = true;
+        static constexpr bool write = true;
+    };
+
+    // Where a visited row lives, for ECSContext::markDirty and handles kept past the loop.
+    struct QueryRow
+    {
+        Entity entity;
+        uint32_t archetypeId = 0;
+        uint32_t row = 0;
+    };
+
+    template <typename... Access>
+    class TypedQuery
+    {
+        static_assert(sizeof...(Access) > 0, "a typed query needs at least one component");
+        static_assert((ComponentId<typename Access::Component>::known && ...),
+                      "TypedQuery takes engine components (ComponentId<T>); use column<T>(id) for the rest");
+
+    public:
+        static constexpr size_t Count = sizeof...(Access);
+
+        // Required typed components (Opt / OptWrite left out).
+        static ComponentMask requiredMask()
+        {
+            ComponentMask mask;
+            ((Access::optional ? void() : mask.set(ComponentId<typename Access::Component>::value)), ...);
+            return mask;
+        }
+
+        // Appends the names of the components read / written (optional ones included).
+        static void appendAccess(std::vector<std::string> &reads, std::vector<std::string> &writes)
+        {
+            ((Access::write ? writes : reads).emplace_back(ComponentId<typename Access::Component>::name), ...);
+        }
+
+        // Compile the query; tags (and untyped names) are resolved through the registry.
+        void build(ECSContext &ecs, std::initializer_list<const char *> requiredTags = {},
+                   std::initializer_list<const char *> excludedTags = {})
+        {
+            ComponentMask required = requiredMask();
+            ComponentMask excluded;
+            for (const char *name : requiredTags)
+                required.set(ecs.components.ensureId(name));
+            for (const char *name : excludedTags)
+                excluded.set(ecs.components.ensureId(name));
+            m_queryId = ecs.queries.createQuery(required, excluded, ecs.stores);
+        }
+
+        bool valid() const { return m_queryId != QueryManager::InvalidQuery; }
+        // Forget the compiled query (QueryManager::clear(), SystemBase::buildMasks).
+        void reset() { m_queryId = QueryManager::InvalidQuery; }
+        QueryId id() const { return m_queryId; }
+
+        // fn(const QueryRow &, Element & / Element *...) per matching row, chunk by chunk.
+        template <typename Fn>
+        void forEach(ECSContext &ecs, Fn &&fn) const
+        {
+            const Query &q = ecs.queries.get(m_queryId);
+            if (q.hasSparseFilter())
+            {
+                ecs.forEachQueryRow(m_queryId, [&](ArchetypeStore &store, uint32_t archetypeId, uint32_t row)
+                                    {
+                                        ComponentColumn *columns[Count];
+                                        resolveColumns(store, columns);
+                                        withPresence<0>(columns, [&](auto... flags)
+                                                        {
+                                                            void *bases[Count];
+                                                            chunkBases(columns, row, bases);
+                                                            runRows(fn, store.entities().data() + row, archetypeId, row, 1u, bases,
+                                                                    std::index_sequence_for<Access...>{}, flags...);
+                                                        });
+                                    });
+                return;
+            }
+
+            for (uint32_t archetypeId : q.matchingArchetypeIds)
+            {
+                ArchetypeStore *store = ecs.stores.get(archetypeId);
+                if (!store || store->size() == 0)
+                    continue;
+                ComponentColumn *columns[Count];
+                resolveColumns(*store, columns);
+                withPresence<0>(columns, [&](auto... flags)
+                                {
+                                    void *bases[Count];
+                                    for (uint32_t c = 0; c < store->chunkCount(); ++c)
+                                    {
+                                        const uint32_t rows = store->chunkRows(c);
+                                        if (rows == 0)
+                                            continue;
+                                        const uint32_t first = c * store->chunkCapacity();
+                                        chunkBases(columns, first, bases);
+                                        runRows(fn, store->entities().data() + first, archetypeId, first, rows, bases,
+                                                std::index_sequence_for<Access...>{}, flags...);
+                                    }
+                                });
+            }
+        }
+
+    private:
+        template <size_t I>
+        using AccessAt = std::tuple_element_t<I, std::tuple<Access...>>;
+
+        // columns[i]: the store's column of Access i (nullptr when absent).
+        static void resolveColumns(ArchetypeStore &store, ComponentColumn **columns)
+        {
+            size_t i = 0;
+            ((columns[i++] = store.findColumn(ComponentId<typename Access::Component>::value)), ...);
+        }
+
+        // bases[i]: address of row firstRow in column i; the row's chunk holds the rows after it
+        // contiguously up to the chunk's end.
+        static void chunkBases(ComponentColumn *const *columns, uint32_t firstRow, void **bases)
+        {
+            for (size_t i = 0; i < Count; ++i)
+                bases[i] = columns[i] ? columns[i]->at(firstRow) : nullptr;
+        }
+
+        // Calls run(flags...) with one std::bool_constant per Access: true for required ones,
+        // the store's presence for optional ones (one instantiation per combination).
+        template <size_t I, typename Run, typename... Flags>
+        static void withPresence(ComponentColumn *const *columns, Run &&run, Flags... flags)
+        {
+            if constexpr (I == Count)
+                run(flags...);
+            else if constexpr (!AccessAt<I>::optional)
+                withPresence<I + 1>(columns, run, flags..., std::true_type{});
+            else if (columns[I])
+                withPresence<I + 1>(columns, run, flags..., std::true_type{});
+            else
+                withPresence<I + 1>(columns, run, flags..., std::false_type{});
+        }
+
+        template <size_t I, bool Present>
+        static decltype(auto) element(void *base, uint32_t i)
+        {
+            using A = AccessAt<I>;
+            using E = typename A::Element;
+            if constexpr (A::optional)
+            {
+                if constexpr (Present)
+                    return static_cast<E *>(base) + i;
+                else
+                    return static_cast<E *>(nullptr);
+            }
+            else
+            {
+                return *(static_cast<E *>(base) + i);
+            }
+        }
+
+        // count rows from firstRow, all inside one chunk (bases from chunkBases(columns, firstRow)).
+        template <typename Fn, size_t... I, typename... Flags>
+        static void runRows(Fn &fn, const Entity *entities, uint32_t archetypeId, uint32_t firstRow, uint32_t count,
+                            void *const *bases, std::index_sequence<I...>, Flags...)
+        {
+            QueryRow ref;
+            ref.archetypeId = archetypeId;
+            for (uint32_t r = 0; r < count; ++r)
+            {
+                ref.entity = entities[r];
+                ref.row = firstRow + r;
+                fn(static_cast<const QueryRow &>(ref), element<I, Flags::value>(bases[I], r)...);
+            }
+        }
+
+        QueryId m_queryId = QueryManager::InvalidQuery;
+    };
+}
@@ -3,8 +3,9 @@
 #include "ECS/Entity.h"
 #include <assets/Handles.h>
 
+#include <algorithm>
 #include <cstdint>
-#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace Engine::ECS
@@ -19,23 +20,44 @@ namespace Engine::ECS
 
         ModelHandle model{};
         uint64_t modelKey = 0;
+        uint32_t lod = 0; // mesh LOD level picked from projected size
 
         uint32_t transformVersion = 0;
         uint32_t poseVersion = 0;
 
         uint32_t visibleFrame = 0;
         bool justBecameVisible = false;
+
+        float viewDepth = 0.0f; // bounds center along the camera forward (depth sorting only)
     };
 
+    // One bucket per (model, mesh LOD level); see VisibleBucketIndex.
     struct VisibleModelBucket
     {
         ModelHandle handle{};
+        uint64_t modelKey = 0;
+        uint32_t lod = 0;
         uint32_t lastUsedFrame = 0;
+        // Largest projected size among refs (radius over half the viewport height, as for LOD
+        // selection); FLT_MAX when a ref has no bounds or LODs are off. Drives texture residency.
+        float maxScreenSize = 0.0f;
+        bool blend = false; // a primitive uses AlphaMode::Blend; set by the depth sort (back to front)
         std::vector<VisibleRenderRef> refs;
     };
 
+    // LOD levels a model can be bucketed at; deeper levels share the last bucket.
+    static constexpr uint32_t MAX_VISIBLE_BUCKET_LODS = 8;
+
+    // Dense bucket index: AssetManager hands out model ids in increasing order, so
+    // id * MAX_VISIBLE_BUCKET_LODS + lod indexes a flat array without hashing.
+    inline uint32_t VisibleBucketIndex(const ModelHandle &model, uint32_t lod)
+    {
+        return static_cast<uint32_t>(model.id) * MAX_VISIBLE_BUCKET_LODS + std::min(lod, MAX_VISIBLE_BUCKET_LODS - 1u);
+    }
+
     // Visible render buckets for the current frame.
-    // byModel persists across frames; activeModelKeys indicates which keys are active this frame.
+    // byModel persists across frames (indexed by VisibleBucketIndex, so it holds empty slots
+    // for unused ids/levels); activeBuckets lists the indices filled this frame, ascending.
     struct VisibleRenderBuckets
     {
         uint32_t frame = 0;
@@ -43,7 +65,14 @@ namespace Engine::ECS
         uint32_t totalRenderables = 0;
         uint32_t visibleRenderables = 0;
 
-        std::unordered_map<uint64_t, VisibleModelBucket> byModel;
-        std::vector<uint64_t> activeModelKeys;
+        std::vector<VisibleModelBucket> byModel;
+        std::vector<uint32_t> activeBuckets;
+    };
+
+    // Models whose render pass evaluates poses on the GPU (written by RenderSystem).
+    // Keys match VisibleRenderRef::modelKey; PoseUpdateSystem skips CPU evaluation for them.
+    struct GpuPoseModels
+    {
+        std::unordered_set<uint64_t> modelKeys;
     };
 }
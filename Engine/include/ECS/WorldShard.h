@@ -0,0 +1,169 @@
+#pragma once
+/*
+  WorldShard.h
+  ------------
+  Purpose:
+    - Split one battlefield across several simulations: each owns the movers (entities with
+      Position and Velocity) inside its region of a ShardLayout and sees the movers near its
+      border as read-only ghosts copied from the neighbour that owns them.
+
+  Usage (per simulation, every shard ticks the same step):
+    - WorldShard shard(layout, region);  shard.attach(ecs);   // before the systems build queries
+    - spawn the whole scenario, then shard.keepOwned(ecs);    // statics stay everywhere
+    - after each tick, on every shard:  collect(ecs, outbox)  // outbox[r]: messages for region r
+      then on every shard, per sender:  deliver(ecs, from, inbox, err)
+      then on every shard:              endExchange(ecs)
+
+  Exchange:
+    - Migrants: living owned movers whose Position left the region move to the new owner in an
+      entity packet with all their columns; the sender destroys them.
+    - Ghosts: owned movers within Config::ghostMargin of another region are packed for it
+      without Config::ghostStripped (CombatMemory, MoveTarget, ...) so no system drives them.
+      They carry the sparse "Ghost" tag; the receiver refreshes them in place each exchange and
+      destroys the ones the owner stopped sending.
+    - Damage: Health a ghost lost since its last refresh (units of this shard hit it) goes back
+      to the owner as a HealthDelta and is applied there; the owner decides deaths.
+
+  Notes:
+    - Region boundaries are multiples of ShardLayout::cellSize from the layout's origin, so a
+      NavGrid / SpatialIndex cell never straddles two regions.
+    - The transport is the caller's: ShardMessages are plain bytes plus a POD list.
+    - A unit that migrates is missing from the sender's and third shards' ghosts for one
+      exchange, and a hit on a ghost whose owner migrates it in that same exchange is dropped.
+*/
+
+#include "ECS/Components.h"
+#include "ECS/Entity.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Engine::ECS
+{
+    struct ECSContext;
+
+    // Axis-aligned grid of regionsX * regionsZ regions; outer regions extend past the bounds.
+    struct ShardLayout
+    {
+        float originX = 0.0f;
+        float originZ = 0.0f;
+        float cellSize = 1.0f;
+        std::vector<float> cutsX; // interior boundaries, ascending (regionsX - 1 of them)
+        std::vector<float> cutsZ;
+
+        // Even split of [minX, maxX] x [minZ, maxZ], boundaries snapped to cellSize.
+        static ShardLayout grid(float minX, float minZ, float maxX, float maxZ, float cellSize,
+                                uint32_t regionsX, uint32_t regionsZ);
+
+        uint32_t regionsX() const { return static_cast<uint32_t>(cutsX.size()) + 1u; }
+        uint32_t regionsZ() const { return static_cast<uint32_t>(cutsZ.size()) + 1u; }
+        uint32_t regionCount() const { return regionsX() * regionsZ(); }
+
+        uint32_t regionOf(float x, float z) const;
+        // 0 inside the region, otherwise the distance to its nearest edge.
+        float distanceToRegion(float x, float z, uint32_t region) const;
+    };
+
+    // Health change for an entity of the receiving shard (its own handle).
+    struct HealthDelta
+    {
+        Entity target;
+        float delta = 0.0f;
+    };
+
+    struct ShardMessages
+    {
+        std::vector<uint8_t> migrants; // entity packet (EntityPacket.h), empty when none
+        std::vector<uint8_t> ghosts;   // entity packet, empty when none
+        std::vector<HealthDelta> damage;
+
+        void clear()
+        {
+            migrants.clear();
+            ghosts.clear();
+            damage.clear();
+        }
+
+        size_t bytes() const { return migrants.size() + ghosts.size() + damage.size() * sizeof(HealthDelta); }
+        bool empty() const { return migrants.empty() && ghosts.empty() && damage.empty(); }
+    };
+
+    class WorldShard
+    {
+    public:
+        struct Config
+        {
+            float ghostMargin = 8.0f; // world units; at least the longest attack or sensing range
+            std::vector<std::string> ghostStripped{"AttackCooldown", "CombatMemory", "MoveTarget", "Path"};
+        };
+
+        struct Stats
+        {
+            uint64_t migratedOut = 0;
+            uint64_t migratedIn = 0;
+            uint64_t ghostsSent = 0;
+            uint64_t damageForwarded = 0;
+            uint64_t bytesSent = 0;
+            uint32_t ghosts = 0; // live ghosts after the last exchange
+        };
+
+        WorldShard(const ShardLayout &layout, uint32_t region);
+        WorldShard(const ShardLayout &layout, uint32_t region, Config config);
+
+        // Registers the Ghost sparse tag and resolves component ids.
+        void attach(ECSContext &ecs);
+
+        // Destroys the movers outside this region; returns how many.
+        uint32_t keepOwned(ECSContext &ecs);
+
+        // Resizes outByRegion to the region count and fills one message set per other region.
+        void collect(ECSContext &ecs, std::vector<ShardMessages> &outByRegion);
+        // Applies what fromRegion's collect produced for this shard. False on a malformed packet.
+        bool deliver(ECSContext &ecs, uint32_t fromRegion, const ShardMessages &messages, std::string &outError);
+        // Drops ghosts the last round of deliveries did not refresh.
+        void endExchange(ECSContext &ecs);
+
+        bool isGhost(const ECSContext &ecs, Entity e) const;
+        uint32_t ghostTagId() const { return m_ghostTagId; }
+        uint32_t region() const { return m_region; }
+        const ShardLayout &layout() const { return m_layout; }
+        const Stats &stats() const { return m_stats; }
+
+    private:
+        struct Ghost
+        {
+            Entity owner;              // the owning shard's handle
+            Entity local;
+            float receivedHealth = 0.0f; // Health at the last refresh (or forwarded hit)
+            uint32_t exchange = 0;       // last exchange that refreshed it
+        };
+
+        static uint64_t ghostKey(uint32_t fromRegion, Entity owner)
+        {
+            return (static_cast<uint64_t>(fromRegion) << 32) | owner.index;
+        }
+
+        bool isMoverStore(const ComponentMask &signature) const;
+        void forgetGhost(ECSContext &ecs, std::unordered_map<uint64_t, Ghost>::iterator it);
+
+        ShardLayout m_layout;
+        uint32_t m_region = 0;
+        Config m_cfg;
+        Stats m_stats;
+
+        uint32_t m_ghostTagId = ComponentRegistry::InvalidID;
+        uint32_t m_positionId = ComponentRegistry::InvalidID;
+        uint32_t m_velocityId = ComponentRegistry::InvalidID;
+        uint32_t m_deadId = ComponentRegistry::InvalidID;
+        ComponentMask m_stripped;
+
+        std::unordered_map<uint64_t, Ghost> m_ghosts; // ghostKey -> ghost
+        uint32_t m_exchange = 0;
+
+        // Scratch reused across exchanges.
+        std::vector<std::vector<Entity>> m_migrantsTo;
+        std::vector<std::vector<Entity>> m_ghostsTo;
+    };
+}
@@ -0,0 +1,92 @@
+#pragma once
+/*
+  WorldSnapshot.h
+  ---------------
+  Purpose:
+    - Save the whole ECS world (every ArchetypeStore, EntitiesRecord, sparse tags) and
+      optionally the NavGrid to one binary file, and load it back without replaying prefab
+      spawns: the file is memory mapped and each column is copied into the store's chunks in
+      runs, one memcpy per chunk.
+
+  Format (version WORLD_SNAPSHOT_VERSION, native endianness, sections 16-byte aligned):
+    - WorldSnapshotHeader
+    - Component table: name, element size and trivially-copyable flag per registry id. Loading
+      maps names to the current registry, so ids may differ between builds; a component whose
+      size changed makes the load fail.
+    - Model table (when saved with an AssetManager): RenderModel handles are stored as an
+      index into this list of model paths and loaded again on the way in.
+    - EntitiesRecord slots and freelist, verbatim: Entity handles stored in components
+      (CombatMemory::targetEnemy, ...) stay valid.
+    - Per non-empty store: signature, entities, then one blob per trivially copyable column.
+    - Sparse tag members, then the NavGrid's cells, clearance and revisions.
+
+  Notes:
+    - Columns that are not trivially copyable are runtime caches and come back default
+      constructed; every loaded row is marked dirty so they are rebuilt.
+    - Handles into process-local caches are dropped on load: Path::waypoints / Path::flowField
+      (the unit plans again), RenderSlot and PosePalette (re-posed from its animation).
+    - Loading replaces the current world; prefabs, queries and systems stay. Prefab instance
+      lists (PrefabManager::setTrackInstances) are cleared, so hot reload skips loaded rows.
+*/
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "assets/Handles.h"
+
+class NavGrid;
+
+namespace Engine
+{
+    class AssetManager;
+}
+
+namespace Engine::ECS
+{
+    struct ECSContext;
+
+    static constexpr uint32_t WORLD_SNAPSHOT_MAGIC = 0x444C5753u; // "SWLD"
+    static constexpr uint32_t WORLD_SNAPSHOT_VERSION = 1;
+    static constexpr uint32_t WORLD_SNAPSHOT_HAS_NAVGRID = 1u << 0;
+    static constexpr uint32_t WORLD_SNAPSHOT_HAS_MODEL_TABLE = 1u << 1;
+
+    struct WorldSnapshotHeader
+    {
+        uint32_t magic = WORLD_SNAPSHOT_MAGIC;
+        uint32_t version = WORLD_SNAPSHOT_VERSION;
+        uint32_t flags = 0; // WORLD_SNAPSHOT_HAS_*
+        uint32_t componentCount = 0;
+        uint32_t storeCount = 0;
+        uint32_t modelCount = 0;
+        uint32_t sparseTagCount = 0;
+        uint32_t reserved = 0;
+        uint64_t slotCount = 0;
+        uint64_t freeCount = 0;
+    };
+    static_assert(sizeof(WorldSnapshotHeader) == 48, "WorldSnapshotHeader is a file format struct");
+
+    struct WorldSnapshotStats
+    {
+        uint32_t entities = 0;
+        uint32_t stores = 0;
+        uint64_t bytes = 0;
+    };
+
+    // nav and assets are optional. Without assets, RenderModel handles are written as they are
+    // and only mean something to the same AssetManager instance.
+    bool saveWorldSnapshot(const std::string &path, const ECSContext &ecs, const NavGrid *nav,
+                           const Engine::AssetManager *assets, std::string &outError,
+                           WorldSnapshotStats *outStats = nullptr);
+
+    // nav: restored when the snapshot has one. assets: required when the snapshot has a model
+    // table; each listed model is loaded with AssetManager::loadModel and that reference is
+    // appended to outModelRefs for the caller to release once the world no longer uses it
+    // (released right away when outModelRefs is null, which is fine while prefabs keep the
+    // models loaded).
+    bool loadWorldSnapshot(const std::string &path, ECSContext &ecs, NavGrid *nav,
+                           Engine::AssetManager *assets, std::string &outError,
+                           std::vector<Engine::ModelHandle> *outModelRefs = nullptr,
+                           WorldSnapshotStats *outStats = nullptr);
+
+} // namespace Engine::ECS
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "ECS/ModelRowBatches.h"
 #include "ECS/SystemFormat.h"
 #include "assets/AssetManager.h"
 
@@ -18,6 +19,9 @@
 // - Advance RenderAnimation::timeSec by dt * speed while playing.
 // - Apply looping with wrap.
 // - For one-shots (loop==false): stop when reaching clip duration.
+// - Advance crossfades (RenderAnimation::blendWeight); off-screen fades complete at once.
+// Rows are visited grouped by model (ModelRowBatches), so each model's clip table is read
+// once per batch rather than once per row.
 class AnimationPlaybackSystem : public Engine::ECS::SystemBase
 {
 public:
@@ -33,6 +37,8 @@ public:
     {
         setRequiredNames({"RenderModel", "RenderAnimation", "VisibilityState"});
         setExcludedNames({"Disabled", "Dead"});
+        setReadNames({"RenderModel", "VisibilityState"});
+        setWriteNames({"RenderAnimation"});
     }
 
     const char *name() const override { return "AnimationPlaybackSystem"; }
@@ -69,136 +75,153 @@ public:
             if (!st || !st->hasRenderModel() || !st->hasRenderAnimation() || !st->hasVisibilityState())
                 continue;
 
-            auto &models = st->renderModels();
-            auto &anims = st->renderAnimations();
+            auto models = st->renderModels();
+            auto anims = st->renderAnimations();
             const auto &visibility = st->visibilityState();
+            const uint32_t testFrame = st->visibilityTestFrame();
             const uint32_t n = st->size();
+            m_lastStats.totalAnimated += n;
+            for (uint32_t w = 0; w < st->visibilityWordCount(); ++w)
+                m_lastStats.visibleAnimated += Engine::ECS::popcount64(st->visibleBits()[w]);
 
-            for (uint32_t row = 0; row < n; ++row)
+            m_batches.build(models, n, nullptr, n, *m_assets);
+            const auto &batchRows = m_batches.rows();
+            for (const auto &batch : m_batches.batches())
             {
-                m_lastStats.totalAnimated += 1u;
-
-                const Engine::ModelHandle handle = models[row].handle;
-                Engine::ModelAsset *asset = m_assets->getModel(handle);
+                const Engine::ModelAsset *asset = batch.asset;
                 if (!asset)
                     continue;
+                const uint32_t clipCount = static_cast<uint32_t>(asset->animClips.size());
 
-                auto &anim = anims[row];
-                const auto &vis = visibility[row];
-
-                const bool isVisible = vis.visible;
-                const bool isOneShot = !anim.loop;
-                const bool oneShotActive = isOneShot && anim.playing && m_policy.advanceOffscreenOneShots;
-                bool recentlyVisible = false;
-                if (!isVisible && vis.visibleFrame > 0 && vis.lastTestFrame >= vis.visibleFrame)
+                for (uint32_t i = batch.begin; i < batch.end; ++i)
                 {
-                    const uint32_t framesSinceVisible = vis.lastTestFrame - vis.visibleFrame;
-                    recentlyVisible = (framesSinceVisible <= m_policy.keepAliveFrames);
-                }
+                    const uint32_t row = batchRows[i];
+                    auto &anim = anims[row];
+                    const bool isVisible = st->rowVisible(row);
+                    const bool isOneShot = !anim.loop;
+                    const bool oneShotActive = isOneShot && anim.playing && m_policy.advanceOffscreenOneShots;
+                    bool recentlyVisible = false;
+                    const uint32_t visibleFrame = visibility[row].visibleFrame;
+                    if (!isVisible && visibleFrame > 0 && testFrame >= visibleFrame)
+                    {
+                        const uint32_t framesSinceVisible = testFrame - visibleFrame;
+                        recentlyVisible = (framesSinceVisible <= m_policy.keepAliveFrames);
+                    }
 
-                const bool shouldAdvance =
-                    m_policy.forceFullRate ||
-                    isVisible ||
-                    (m_policy.allowOffscreenLoopAdvance && !isOneShot) ||
-                    oneShotActive ||
-                    recentlyVisible;
+                    const bool shouldAdvance =
+                        m_policy.forceFullRate ||
+                        isVisible ||
+                        (m_policy.allowOffscreenLoopAdvance && !isOneShot) ||
+                        oneShotActive ||
+                        recentlyVisible;
 
-                if (isVisible)
-                    m_lastStats.visibleAnimated += 1u;
+                    bool changed = false;
 
-                bool changed = false;
+                    if (clipCount == 0)
+                    {
+                        if (anim.clipIndex != 0 || anim.timeSec != 0.0f || anim.playing)
+                        {
+                            anim.clipIndex = 0;
+                            anim.timeSec = 0.0f;
+                            anim.playing = false;
+                            changed = true;
+                        }
+                        if (changed)
+                            ecs.markDirty(m_renderAnimId, archetypeId, row);
+                        continue;
+                    }
 
-                const uint32_t clipCount = static_cast<uint32_t>(asset->animClips.size());
-                if (clipCount == 0)
-                {
-                    if (anim.clipIndex != 0 || anim.timeSec != 0.0f || anim.playing)
+                    if (anim.clipIndex >= clipCount)
                     {
-                        anim.clipIndex = 0;
+                        anim.clipIndex = clipCount - 1;
                         anim.timeSec = 0.0f;
-                        anim.playing = false;
                         changed = true;
                     }
-                    if (changed)
-                        ecs.markDirty(m_renderAnimId, archetypeId, row);
-                    continue;
-                }
-
-                if (anim.clipIndex >= clipCount)
-                {
-                    anim.clipIndex = clipCount - 1;
-                    anim.timeSec = 0.0f;
-                    changed = true;
-                }
 
-                const float duration = asset->animClips[anim.clipIndex].durationSec;
-                if (duration <= 1e-6f)
-                {
-                    if (anim.timeSec != 0.0f || anim.playing)
+                    if (anim.blendWeight < 1.0f)
                     {
-                        anim.timeSec = 0.0f;
-                        anim.playing = false;
+                        if (shouldAdvance && anim.blendDurationSec > 0.0f && anim.blendFromClip < clipCount)
+                        {
+                            advanceCrossfade(anim, asset->animClips[anim.blendFromClip].durationSec, dt);
+                            m_lastStats.crossfading += 1u;
+                        }
+                        else
+                        {
+                            anim.blendWeight = 1.0f;
+                        }
                         changed = true;
                     }
-                    if (changed)
-                        ecs.markDirty(m_renderAnimId, archetypeId, row);
-                    continue;
-                }
 
-                if (anim.playing)
-                {
-                    if (shouldAdvance)
+                    const float duration = asset->animClips[anim.clipIndex].durationSec;
+                    if (duration <= 1e-6f)
                     {
-                        const float delta = dt * anim.speed;
-                        if (std::abs(delta) > 1e-9f)
+                        if (anim.timeSec != 0.0f || anim.playing)
                         {
-                            anim.timeSec += delta;
+                            anim.timeSec = 0.0f;
+                            anim.playing = false;
                             changed = true;
-                            m_lastStats.playbackAdvanced += 1u;
                         }
+                        if (changed)
+                            ecs.markDirty(m_renderAnimId, archetypeId, row);
+                        continue;
+                    }
 
-                        if (anim.loop)
-                        {
-                            anim.timeSec = std::fmod(anim.timeSec, duration);
-                            if (anim.timeSec < 0.0f)
-                                anim.timeSec += duration;
-                        }
-                        else
+                    if (anim.playing)
+                    {
+                        if (shouldAdvance)
                         {
-                            if (anim.timeSec >= duration)
+                            const float delta = dt * anim.speed;
+                            if (std::abs(delta) > 1e-9f)
                             {
-                                anim.timeSec = duration;
-                                anim.playing = false;
+                                anim.timeSec += delta;
                                 changed = true;
+                                m_lastStats.playbackAdvanced += 1u;
                             }
-                            else if (anim.timeSec < 0.0f)
+
+                            if (anim.loop)
                             {
-                                anim.timeSec = 0.0f;
-                                changed = true;
+                                anim.timeSec = std::fmod(anim.timeSec, duration);
+                                if (anim.timeSec < 0.0f)
+                                    anim.timeSec += duration;
+                            }
+                            else
+                            {
+                                if (anim.timeSec >= duration)
+                                {
+                                    anim.timeSec = duration;
+                                    anim.playing = false;
+                                    changed = true;
+                                }
+                                else if (anim.timeSec < 0.0f)
+                                {
+                                    anim.timeSec = 0.0f;
+                                    changed = true;
+                                }
                             }
                         }
+                        else
+                        {
+                            m_lastStats.skippedInvisible += 1u;
+                        }
                     }
                     else
                     {
-                        m_lastStats.skippedInvisible += 1u;
-                    }
-                }
-                else
-                {
-                    // Ensure time is in-range even when not playing.
-                    if (anim.timeSec < 0.0f)
-                    {
-                        anim.timeSec = 0.0f;
-                        changed = true;
-                    }
-                    if (anim.timeSec > duration)
-                    {
-                        anim.timeSec = duration;
-                        changed = true;
+                        // Ensure time is in-range even when not playing.
+                        if (anim.timeSec < 0.0f)
+                        {
+                            anim.timeSec = 0.0f;
+                            changed = true;
+                        }
+                        if (anim.timeSec > duration)
+                        {
+                            anim.timeSec = duration;
+                            changed = true;
+                        }
                     }
-                }
 
-                if (changed)
-                    ecs.markDirty(m_renderAnimId, archetypeId, row);
+                    if (changed)
+                        ecs.markDirty(m_renderAnimId, archetypeId, row);
+                }
             }
         }
 
@@ -210,6 +233,7 @@ public:
                       << " visible=" << m_lastStats.visibleAnimated
                       << " advanced=" << m_lastStats.playbackAdvanced
                       << " skippedInvisible=" << m_lastStats.skippedInvisible
+                      << " crossfading=" << m_lastStats.crossfading
                       << "\n";
         }
 #endif
@@ -222,10 +246,33 @@ private:
         uint32_t visibleAnimated = 0;
         uint32_t playbackAdvanced = 0;
         uint32_t skippedInvisible = 0;
+        uint32_t crossfading = 0;
     };
 
+    // The faded-out clip keeps playing (wrapping or clamping like it did) until the fade ends.
+    static void advanceCrossfade(Engine::ECS::RenderAnimation &anim, float fromDuration, float dt)
+    {
+        anim.blendWeight = std::min(1.0f, anim.blendWeight + dt / anim.blendDurationSec);
+        anim.blendFromTimeSec += dt * anim.speed;
+        if (fromDuration <= 1e-6f)
+        {
+            anim.blendFromTimeSec = 0.0f;
+        }
+        else if (anim.blendFromLoop)
+        {
+            anim.blendFromTimeSec = std::fmod(anim.blendFromTimeSec, fromDuration);
+            if (anim.blendFromTimeSec < 0.0f)
+                anim.blendFromTimeSec += fromDuration;
+        }
+        else
+        {
+            anim.blendFromTimeSec = std::clamp(anim.blendFromTimeSec, 0.0f, fromDuration);
+        }
+    }
+
     Engine::AssetManager *m_assets = nullptr;
     AnimationActivityPolicy m_policy{};
+    Engine::ECS::ModelRowBatches m_batches; // per archetype pass, reused
 
     Engine::ECS::QueryId m_queryId = Engine::ECS::QueryManager::InvalidQuery;
     uint32_t m_renderAnimId = Engine::ECS::ComponentRegistry::InvalidID;
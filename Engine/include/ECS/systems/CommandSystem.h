@@ -1,6 +1,9 @@
 #pragma once
 
 #include "ECS/SystemFormat.h"
+#include "ECS/TypedQuery.h"
+#include "ECS/systems/FormationSolver.h"
+#include "ECS/systems/NavGrid.h"
 
 #include <algorithm>
 #include <cmath>
@@ -15,14 +18,18 @@ public:
         float spacing = 0.5f;
         float minWorld = -10000.0f;
         float maxWorld = 10000.0f;
+        // Fit slots to the NavGrid (setNavGrid) and assign them to minimize crossing paths
+        // (FormationSolver). Off: the plain row-major block by entity id.
+        bool solveFormation = true;
         bool log = false;
     };
 
     CommandSystem()
     {
-        // Only command selected, movable units.
-        setRequiredNames({"MoveTarget", "MoveSpeed", "Selected"});
-        setExcludedNames({"Disabled", "Dead"});
+        std::vector<std::string> reads{"Selected", "NavGrid"}, writes;
+        UnitQuery::appendAccess(reads, writes);
+        setReadNames(reads);
+        setWriteNames(writes);
     }
 
     const char *name() const override { return "CommandSystem"; }
@@ -30,11 +37,12 @@ public:
     void buildMasks(Engine::ECS::ComponentRegistry &registry) override
     {
         Engine::ECS::SystemBase::buildMasks(registry);
-        m_moveTargetId = registry.ensureId("MoveTarget");
-        m_queryId = Engine::ECS::QueryManager::InvalidQuery;
+        m_units.reset();
     }
 
     void setConfig(const Config &cfg) { m_cfg = cfg; }
+    void setNavGrid(const NavGrid *grid) { m_navGrid = grid; }
+    const FormationSolver::Stats &formationStats() const { return m_solver.stats(); }
 
     // Set the last clicked target; system will write it to entities on next update.
     void SetGlobalMoveTarget(float x, float y, float z)
@@ -57,50 +65,41 @@ public:
         auto clamp = [](float v, float a, float b)
         { return std::max(a, std::min(v, b)); };
 
-        if (m_queryId == Engine::ECS::QueryManager::InvalidQuery)
-            m_queryId = ecs.queries.createQuery(required(), excluded(), ecs.stores);
+        // Only command selected, movable units.
+        if (!m_units.valid())
+            m_units.build(ecs, {"Selected"}, {"Disabled", "Dead"});
 
         struct SelectedRow
         {
-            uint32_t archetypeId;
-            uint32_t row;
+            Engine::ECS::QueryRow where;
+            Engine::ECS::MoveTarget *target; // chunk memory: stable until the next structural change
             uint64_t sortKey;
         };
 
         std::vector<SelectedRow> selected;
         selected.reserve(512);
+        m_unitX.clear();
+        m_unitZ.clear();
 
         float maxInflatedRadius = 0.0f; // (r + sep) upper bound across selection
-
-        const auto &q = ecs.queries.get(m_queryId);
-        for (uint32_t archetypeId : q.matchingArchetypeIds)
-        {
-            Engine::ECS::ArchetypeStore *storePtr = ecs.stores.get(archetypeId);
-            if (!storePtr)
-                continue;
-            auto &store = *storePtr;
-
-            const uint32_t n = store.size();
-            if (n == 0)
-                continue;
-
-            const bool hasRadius = store.hasRadius();
-            const bool hasSep = store.hasSeparation();
-            const auto &radii = store.radii();
-            const auto &seps = store.separations();
-            const auto &ents = store.entities();
-
-            for (uint32_t row = 0; row < n; ++row)
-            {
-                const Engine::ECS::Entity e = ents[row];
-                const uint64_t key = (static_cast<uint64_t>(e.generation) << 32) | static_cast<uint64_t>(e.index);
-                selected.push_back(SelectedRow{archetypeId, row, key});
-
-                const float r = (hasRadius && row < radii.size()) ? radii[row].r : 0.0f;
-                const float s = (hasSep && row < seps.size()) ? seps[row].value : 0.0f;
-                maxInflatedRadius = std::max(maxInflatedRadius, std::max(0.0f, r) + std::max(0.0f, s));
-            }
-        }
+        float maxRadius = 0.0f;
+
+        // Selected is a sparse tag: this walks the selection set, not every movable unit.
+        m_units.forEach(ecs, [&](const Engine::ECS::QueryRow &where, Engine::ECS::MoveTarget &target,
+                                 const Engine::ECS::MoveSpeed &, const Engine::ECS::Position *pos,
+                                 const Engine::ECS::Radius *radius, const Engine::ECS::Separation *separation)
+                        {
+                            const Engine::ECS::Entity e = where.entity;
+                            const uint64_t key = (static_cast<uint64_t>(e.generation) << 32) | static_cast<uint64_t>(e.index);
+                            selected.push_back(SelectedRow{where, &target, key});
+                            m_unitX.push_back(pos ? pos->x : m_pendingX);
+                            m_unitZ.push_back(pos ? pos->z : m_pendingZ);
+
+                            const float r = radius ? radius->r : 0.0f;
+                            const float s = separation ? separation->value : 0.0f;
+                            maxInflatedRadius = std::max(maxInflatedRadius, std::max(0.0f, r) + std::max(0.0f, s));
+                            maxRadius = std::max(maxRadius, r);
+                        });
 
         const uint32_t selCount = static_cast<uint32_t>(selected.size());
         if (selCount == 0)
@@ -115,34 +114,56 @@ public:
         const float autoSpacing = std::max(0.0f, 2.0f * maxInflatedRadius);
         const float resolvedSpacing = std::max(std::max(0.0f, spacing), autoSpacing);
 
-        // Stable slot assignment: sort by entity id so mixed archetypes don't each form their own grid.
-        std::sort(selected.begin(), selected.end(), [](const SelectedRow &a, const SelectedRow &b)
-                  { return a.sortKey < b.sortKey; });
+        // Every unit of this order shares one tag, so PathfindingSystem can serve them from one flow field.
+        if (++m_orderSerial == 0)
+            m_orderSerial = 1;
 
         const uint32_t side = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(selCount))));
-        const float half = (static_cast<float>(side) - 1.0f) * 0.5f;
+        m_slotX.resize(selCount);
+        m_slotZ.resize(selCount);
+
+        if (m_cfg.solveFormation)
+        {
+            // Slots fit to walkable space, assigned by position (selection order does not matter).
+            FormationSolver::Params params;
+            params.targetX = m_pendingX;
+            params.targetZ = m_pendingZ;
+            params.spacing = resolvedSpacing;
+            params.minWorld = kMinWorld;
+            params.maxWorld = kMaxWorld;
+            params.grid = (m_navGrid && m_navGrid->width > 0 && m_navGrid->height > 0) ? m_navGrid : nullptr;
+            params.minClearance = params.grid ? params.grid->clearanceFor(maxRadius) : uint8_t(0);
+            m_solver.solve(m_unitX.data(), m_unitZ.data(), selCount, params, ecs.jobSystem, m_slotX.data(), m_slotZ.data());
+        }
+        else
+        {
+            // Stable slot assignment: sort by entity id so mixed archetypes don't each form their own grid.
+            m_byKey.resize(selCount);
+            for (uint32_t i = 0; i < selCount; ++i)
+                m_byKey[i] = i;
+            std::sort(m_byKey.begin(), m_byKey.end(), [&](uint32_t a, uint32_t b)
+                      { return selected[a].sortKey < selected[b].sortKey; });
+
+            const float half = (static_cast<float>(side) - 1.0f) * 0.5f;
+            for (uint32_t k = 0; k < selCount; ++k)
+            {
+                const uint32_t row = k / side;
+                const uint32_t col = k % side;
+                m_slotX[m_byKey[k]] = clamp(m_pendingX + (static_cast<float>(col) - half) * resolvedSpacing, kMinWorld, kMaxWorld);
+                m_slotZ[m_byKey[k]] = clamp(m_pendingZ + (static_cast<float>(row) - half) * resolvedSpacing, kMinWorld, kMaxWorld);
+            }
+        }
 
         for (uint32_t k = 0; k < selCount; ++k)
         {
-            const uint32_t row = k / side;
-            const uint32_t col = k % side;
-            const float ox = (static_cast<float>(col) - half) * resolvedSpacing;
-            const float oz = (static_cast<float>(row) - half) * resolvedSpacing;
-
-            const SelectedRow sr = selected[k];
-            Engine::ECS::ArchetypeStore *storePtr = ecs.stores.get(sr.archetypeId);
-            if (!storePtr)
-                continue;
-            auto &store = *storePtr;
-            if (!store.hasMoveTarget() || sr.row >= store.size())
-                continue;
-
-            auto &targets = const_cast<std::vector<Engine::ECS::MoveTarget> &>(store.moveTargets());
-            targets[sr.row].x = clamp(m_pendingX + ox, kMinWorld, kMaxWorld);
-            targets[sr.row].y = m_pendingY;
-            targets[sr.row].z = clamp(m_pendingZ + oz, kMinWorld, kMaxWorld);
-            targets[sr.row].active = 1;
-            ecs.markDirty(m_moveTargetId, sr.archetypeId, sr.row);
+            const SelectedRow &sr = selected[k];
+            Engine::ECS::MoveTarget &target = *sr.target;
+            target.x = m_slotX[k];
+            target.y = m_pendingY;
+            target.z = m_slotZ[k];
+            target.active = 1;
+            target.order = m_orderSerial;
+            ecs.markDirty(Engine::ECS::ComponentId<Engine::ECS::MoveTarget>::value, sr.where.archetypeId, sr.where.row);
         }
 
         if (m_cfg.log)
@@ -157,9 +178,19 @@ protected:
 
 private:
     Config m_cfg{};
+    const NavGrid *m_navGrid = nullptr;
+    FormationSolver m_solver;
+
+    // Per-order scratch, parallel to the selection.
+    std::vector<float> m_unitX, m_unitZ;
+    std::vector<float> m_slotX, m_slotZ;
+    std::vector<uint32_t> m_byKey;
 
     bool m_hasPending = false;
     float m_pendingX = 0.0f, m_pendingY = 0.0f, m_pendingZ = 0.0f;
-    Engine::ECS::QueryId m_queryId = Engine::ECS::QueryManager::InvalidQuery;
-    uint32_t m_moveTargetId = Engine::ECS::ComponentRegistry::InvalidID;
+    uint32_t m_orderSerial = 0;
+    using UnitQuery = Engine::ECS::TypedQuery<Engine::ECS::Write<Engine::ECS::MoveTarget>, Engine::ECS::Read<Engine::ECS::MoveSpeed>,
+                                              Engine::ECS::Opt<Engine::ECS::Position>, Engine::ECS::Opt<Engine::ECS::Radius>,
+                                              Engine::ECS::Opt<Engine::ECS::Separation>>;
+    UnitQuery m_units;
 };
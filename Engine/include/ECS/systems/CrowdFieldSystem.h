@@ -0,0 +1,397 @@
+#pragma once
+/*
+  CrowdFieldSystem.h
+  ------------------
+  Purpose:
+    - Grid-level crowd layer (continuum crowds) for army-sized moves. Every tick the movers'
+      density and mean velocity are splatted onto a coarse grid aligned with the NavGrid
+      (CELLS_PER_CROWD_CELL nav cells per side), and a congestion field is derived from it:
+      per crowd cell and walking direction (E, N, W, S), how crowded the next cell is and how
+      fast its crowd already moves that way.
+    - SteeringSystem asks CrowdField::steer for every unit standing in a crowd: it picks among
+      a few headings around the desired one the cheapest to walk (time per meter, plus
+      discomfort) and slows to the crowd's flow speed, so armies stream through chokepoints
+      and around jams instead of pushing into them. LocalAvoidanceSystem then only resolves
+      the nearest few neighbors of crowded units (Config::crowdMaxNeighbors).
+    - Cost is per cell touched, not per neighbor pair: a chokepoint of a thousand units costs
+      its cells, however packed they are.
+
+  Usage:
+    - CrowdFieldSystem crowd{&navGrid}; steering.setCrowdField(&crowd.field());
+      avoidance.setCrowdField(&crowd.field()); schedule it before SteeringSystem.
+    - CrowdField is read-only outside the system's update, so parallel lanes may sample it.
+
+  Notes:
+    - Density is the fraction of a cell's area covered by unit footprints (Radius, or
+      DEFAULT_RADIUS without one). Below DENSITY_MIN a cell flows freely; at DENSITY_MAX units
+      walk at the crowd's speed.
+    - Only the rect of cells touched this tick (plus one ring) is cleared and recomputed.
+    - Sequential splat in query order and per-cell field passes keep results deterministic.
+*/
+
+#include "ECS/SystemFormat.h"
+#include "ECS/Components.h"
+#include "ECS/ArchetypeStore.h"
+
+#include "ECS/systems/NavGrid.h"
+#include "utils/JobSystem.h"
+#include "utils/MemoryReport.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+class CrowdField
+{
+public:
+    // =====================
+    // TUNING CONSTANTS
+    // =====================
+    static constexpr float DENSITY_MIN = 0.20f;         // covered fraction where congestion starts
+    static constexpr float DENSITY_MAX = 0.55f;         // ... and where units move with the crowd
+    static constexpr float MIN_SPEED_FRACTION = 0.15f;  // of the unit's speed, even against the flow
+    static constexpr float DISCOMFORT_WEIGHT = 1.0f;    // extra cost per meter of a congested cell
+    static constexpr float TURN_WEIGHT = 0.5f;          // cost of turning 90 degrees off the desired heading
+    static constexpr uint32_t HEADING_COUNT = 5;        // desired, +-22.5 and +-45 degrees
+
+    enum Dir : uint32_t
+    {
+        East,  // +x
+        North, // +z
+        West,  // -x
+        South, // -z
+        DirCount
+    };
+
+    // Per cell, for each direction: congestion of the cell ahead (0 = free, 1 = DENSITY_MAX or
+    // more) and the mean velocity of that cell projected onto the direction (m/s).
+    struct Cost
+    {
+        float congestion[DirCount];
+        float flow[DirCount];
+    };
+
+    int width = 0;
+    int height = 0;
+    float cellSize = 0.0f;
+    float worldMinX = 0.0f;
+    float worldMinZ = 0.0f;
+
+    bool empty() const { return width <= 0 || height <= 0; }
+
+    int cellX(float x) const { return static_cast<int>(std::floor((x - worldMinX) / cellSize)); }
+    int cellZ(float z) const { return static_cast<int>(std::floor((z - worldMinZ) / cellSize)); }
+    bool isValid(int cx, int cz) const { return cx >= 0 && cz >= 0 && cx < width && cz < height; }
+
+    // Covered fraction of the cell at (x, z); 0 off the field.
+    float densityAt(float x, float z) const
+    {
+        const int cx = cellX(x), cz = cellZ(z);
+        return isValid(cx, cz) ? m_density[static_cast<size_t>(cz) * width + cx] : 0.0f;
+    }
+    bool congested(float x, float z) const { return densityAt(x, z) >= DENSITY_MIN; }
+
+    // Heading and speed for a unit at (x, z) that wants to walk along the unit vector dir at
+    // maxSpeed. False (outputs untouched) when nothing around it is congested.
+    bool steer(float x, float z, float dirX, float dirZ, float maxSpeed, float &outDirX, float &outDirZ, float &outSpeed) const
+    {
+        const int cx = cellX(x), cz = cellZ(z);
+        if (!isValid(cx, cz) || maxSpeed <= 0.0f)
+            return false;
+        const Cost &c = m_cost[static_cast<size_t>(cz) * width + cx];
+        if (c.congestion[East] + c.congestion[North] + c.congestion[West] + c.congestion[South] <= 0.0f &&
+            m_density[static_cast<size_t>(cz) * width + cx] < DENSITY_MIN)
+            return false;
+
+        // cos/sin of 0, +22.5, -22.5, +45, -45 degrees.
+        static constexpr float kCos[HEADING_COUNT] = {1.0f, 0.92387953f, 0.92387953f, 0.70710678f, 0.70710678f};
+        static constexpr float kSin[HEADING_COUNT] = {0.0f, 0.38268343f, -0.38268343f, 0.70710678f, -0.70710678f};
+
+        float bestCost = 0.0f;
+        for (uint32_t h = 0; h < HEADING_COUNT; ++h)
+        {
+            const float hx = dirX * kCos[h] - dirZ * kSin[h];
+            const float hz = dirX * kSin[h] + dirZ * kCos[h];
+
+            // Directions blend their axis costs by the squared components (they sum to 1).
+            const uint32_t ax = hx >= 0.0f ? East : West;
+            const uint32_t az = hz >= 0.0f ? North : South;
+            const float wx = hx * hx, wz = hz * hz;
+            const float congestion = wx * c.congestion[ax] + wz * c.congestion[az];
+            const float flow = wx * c.flow[ax] + wz * c.flow[az];
+            const float crowdSpeed = std::max(MIN_SPEED_FRACTION * maxSpeed, std::min(flow, maxSpeed));
+            const float speed = maxSpeed + (crowdSpeed - maxSpeed) * congestion;
+
+            const float cost = (1.0f + DISCOMFORT_WEIGHT * congestion) / speed + TURN_WEIGHT * (1.0f - kCos[h]) / maxSpeed;
+            if (h == 0u || cost < bestCost)
+            {
+                bestCost = cost;
+                outDirX = hx;
+                outDirZ = hz;
+                outSpeed = speed;
+            }
+        }
+        return true;
+    }
+
+private:
+    friend class CrowdFieldSystem;
+
+    std::vector<float> m_density; // per cell, covered fraction
+    std::vector<float> m_velX;    // per cell, sum of weight * velocity until resolved, then the mean
+    std::vector<float> m_velZ;
+    std::vector<float> m_weight;  // per cell, sum of splat weights
+    std::vector<Cost> m_cost;
+};
+
+class CrowdFieldSystem : public Engine::ECS::SystemBase
+{
+public:
+    // =====================
+    // TUNING CONSTANTS
+    // =====================
+    static constexpr int CELLS_PER_CROWD_CELL = 4; // nav cells per crowd cell side
+    static constexpr float DEFAULT_RADIUS = 0.5f;  // footprint of movers without Radius
+    static constexpr uint32_t PARALLEL_ROW_THRESHOLD = 32; // crowd cell rows before the field pass goes parallel
+
+    struct Stats
+    {
+        uint32_t unitsSplatted = 0;
+        uint32_t cellsUpdated = 0;  // touched rect plus its ring
+        uint32_t congestedCells = 0; // density >= DENSITY_MIN
+    };
+
+    explicit CrowdFieldSystem(const NavGrid *grid = nullptr)
+        : m_grid(grid)
+    {
+        setRequiredNames({"Position", "Velocity"});
+        setExcludedNames({"Disabled", "Dead"});
+        setReadNames({"Position", "Velocity", "Radius", "NavGrid"});
+        setWriteNames({"CrowdField"});
+    }
+
+    const char *name() const override { return "CrowdFieldSystem"; }
+
+    void buildMasks(Engine::ECS::ComponentRegistry &registry) override
+    {
+        Engine::ECS::SystemBase::buildMasks(registry);
+        m_queryId = Engine::ECS::QueryManager::InvalidQuery;
+    }
+
+    void setNavGrid(const NavGrid *grid) { m_grid = grid; }
+    void setEnabled(bool enabled) { m_enabled = enabled; }
+    bool enabled() const { return m_enabled; }
+
+    const CrowdField &field() const { return m_field; }
+    const Stats &stats() const { return m_stats; }
+
+    // Field arrays, under category "Navigation".
+    void reportMemory(Engine::MemoryReport &out) const
+    {
+        using Engine::MemoryReport;
+        const uint64_t bytes = MemoryReport::bytesOf(m_field.m_density) + MemoryReport::bytesOf(m_field.m_velX) +
+                               MemoryReport::bytesOf(m_field.m_velZ) + MemoryReport::bytesOf(m_field.m_weight) +
+                               MemoryReport::bytesOf(m_field.m_cost);
+        out.add("Navigation", "Crowd field", bytes, 0, static_cast<uint32_t>(m_field.m_density.size()));
+    }
+
+    void update(Engine::ECS::ECSContext &ecs, float /*dt*/) override
+    {
+        m_stats = Stats{};
+        if (!m_grid || m_grid->width <= 0 || m_grid->height <= 0)
+            return;
+        if (m_layoutRevision != m_grid->layoutRevision || m_field.empty())
+            resize(*m_grid);
+
+        clearRect(m_touched);
+        m_touched = Rect{};
+        if (!m_enabled)
+            return;
+
+        if (m_queryId == Engine::ECS::QueryManager::InvalidQuery)
+            m_queryId = ecs.queries.createQuery(required(), excluded(), ecs.stores);
+
+        splat(ecs);
+        if (!m_touched.valid())
+            return;
+
+        // The ring around the touched rect sees its density from outside.
+        m_touched.minX = std::max(0, m_touched.minX - 1);
+        m_touched.minZ = std::max(0, m_touched.minZ - 1);
+        m_touched.maxX = std::min(m_field.width - 1, m_touched.maxX + 1);
+        m_touched.maxZ = std::min(m_field.height - 1, m_touched.maxZ + 1);
+        resolve(ecs);
+    }
+
+private:
+    struct Rect
+    {
+        int minX = 1, minZ = 1, maxX = 0, maxZ = 0; // inclusive; empty by default
+
+        bool valid() const { return minX <= maxX && minZ <= maxZ; }
+    };
+
+    void resize(const NavGrid &grid)
+    {
+        CrowdField &f = m_field;
+        f.cellSize = grid.cellSize * static_cast<float>(CELLS_PER_CROWD_CELL);
+        f.worldMinX = grid.worldMinX;
+        f.worldMinZ = grid.worldMinZ;
+        f.width = (grid.width + CELLS_PER_CROWD_CELL - 1) / CELLS_PER_CROWD_CELL;
+        f.height = (grid.height + CELLS_PER_CROWD_CELL - 1) / CELLS_PER_CROWD_CELL;
+        const size_t cells = static_cast<size_t>(f.width) * static_cast<size_t>(f.height);
+        f.m_density.assign(cells, 0.0f);
+        f.m_velX.assign(cells, 0.0f);
+        f.m_velZ.assign(cells, 0.0f);
+        f.m_weight.assign(cells, 0.0f);
+        f.m_cost.assign(cells, CrowdField::Cost{});
+        m_layoutRevision = grid.layoutRevision;
+        m_touched = Rect{};
+    }
+
+    void clearRect(const Rect &r)
+    {
+        if (!r.valid())
+            return;
+        CrowdField &f = m_field;
+        for (int z = r.minZ; z <= r.maxZ; ++z)
+        {
+            const size_t first = static_cast<size_t>(z) * f.width + r.minX;
+            const size_t count = static_cast<size_t>(r.maxX - r.minX + 1);
+            std::fill_n(f.m_density.begin() + first, count, 0.0f);
+            std::fill_n(f.m_velX.begin() + first, count, 0.0f);
+            std::fill_n(f.m_velZ.begin() + first, count, 0.0f);
+            std::fill_n(f.m_weight.begin() + first, count, 0.0f);
+            std::fill_n(f.m_cost.begin() + first, count, CrowdField::Cost{});
+        }
+    }
+
+    // Bilinear splat onto the four cells whose centers surround each unit.
+    void splat(Engine::ECS::ECSContext &ecs)
+    {
+        CrowdField &f = m_field;
+        const float invCell = 1.0f / f.cellSize;
+        const float invCellArea = invCell * invCell;
+        constexpr float kPi = 3.14159265358979323846f;
+
+        const auto &q = ecs.queries.get(m_queryId);
+        for (uint32_t archetypeId : q.matchingArchetypeIds)
+        {
+            const Engine::ECS::ArchetypeStore *store = ecs.stores.get(archetypeId);
+            if (!store || store->size() == 0)
+                continue;
+            const auto &positions = store->positions();
+            const auto &velocities = store->velocities();
+            const bool hasRadius = store->hasRadius();
+            const auto &radii = store->radii();
+
+            for (uint32_t row = 0; row < store->size(); ++row)
+            {
+                const auto &p = positions[row];
+                const float gx = (p.x - f.worldMinX) * invCell - 0.5f;
+                const float gz = (p.z - f.worldMinZ) * invCell - 0.5f;
+                const int x0 = static_cast<int>(std::floor(gx));
+                const int z0 = static_cast<int>(std::floor(gz));
+                if (x0 < -1 || z0 < -1 || x0 >= f.width || z0 >= f.height)
+                    continue;
+                const float fx = gx - static_cast<float>(x0);
+                const float fz = gz - static_cast<float>(z0);
+                const float r = hasRadius ? std::max(0.0f, radii[row].r) : DEFAULT_RADIUS;
+                const float area = kPi * r * r * invCellArea;
+                const auto &v = velocities[row];
+
+                const float w[4] = {(1.0f - fx) * (1.0f - fz), fx * (1.0f - fz), (1.0f - fx) * fz, fx * fz};
+                for (int k = 0; k < 4; ++k)
+                {
+                    const int cx = x0 + (k & 1);
+                    const int cz = z0 + (k >> 1);
+                    if (!f.isValid(cx, cz))
+                        continue;
+                    const size_t c = static_cast<size_t>(cz) * f.width + cx;
+                    f.m_density[c] += w[k] * area;
+                    f.m_velX[c] += w[k] * v.x;
+                    f.m_velZ[c] += w[k] * v.z;
+                    f.m_weight[c] += w[k];
+                    m_touched.minX = m_touched.valid() ? std::min(m_touched.minX, cx) : cx;
+                    m_touched.minZ = m_touched.valid() ? std::min(m_touched.minZ, cz) : cz;
+                    m_touched.maxX = m_touched.valid() ? std::max(m_touched.maxX, cx) : cx;
+                    m_touched.maxZ = m_touched.valid() ? std::max(m_touched.maxZ, cz) : cz;
+                }
+                ++m_stats.unitsSplatted;
+            }
+        }
+    }
+
+    // Mean velocities, then each cell's congestion / flow toward its four neighbors.
+    void resolve(Engine::ECS::ECSContext &ecs)
+    {
+        CrowdField &f = m_field;
+        const Rect r = m_touched;
+        const int W = f.width;
+
+        for (int z = r.minZ; z <= r.maxZ; ++z)
+        {
+            for (int x = r.minX; x <= r.maxX; ++x)
+            {
+                const size_t c = static_cast<size_t>(z) * W + x;
+                if (f.m_weight[c] > 0.0f)
+                {
+                    const float inv = 1.0f / f.m_weight[c];
+                    f.m_velX[c] *= inv;
+                    f.m_velZ[c] *= inv;
+                }
+                m_stats.congestedCells += (f.m_density[c] >= CrowdField::DENSITY_MIN) ? 1u : 0u;
+            }
+        }
+
+        const float invRange = 1.0f / (CrowdField::DENSITY_MAX - CrowdField::DENSITY_MIN);
+        auto costRows = [&](uint32_t first, uint32_t last)
+        {
+            static constexpr int kDx[CrowdField::DirCount] = {1, 0, -1, 0};
+            static constexpr int kDz[CrowdField::DirCount] = {0, 1, 0, -1};
+            for (uint32_t zi = first; zi < last; ++zi)
+            {
+                const int z = static_cast<int>(zi);
+                for (int x = r.minX; x <= r.maxX; ++x)
+                {
+                    CrowdField::Cost &cost = f.m_cost[static_cast<size_t>(z) * W + x];
+                    for (uint32_t d = 0; d < CrowdField::DirCount; ++d)
+                    {
+                        const int nx = x + kDx[d], nz = z + kDz[d];
+                        if (!f.isValid(nx, nz))
+                        {
+                            cost.congestion[d] = 0.0f;
+                            cost.flow[d] = 0.0f;
+                            continue;
+                        }
+                        const size_t n = static_cast<size_t>(nz) * W + nx;
+                        cost.congestion[d] = std::max(0.0f, std::min(1.0f, (f.m_density[n] - CrowdField::DENSITY_MIN) * invRange));
+                        cost.flow[d] = f.m_velX[n] * static_cast<float>(kDx[d]) + f.m_velZ[n] * static_cast<float>(kDz[d]);
+                    }
+                }
+            }
+        };
+
+        const uint32_t rows = static_cast<uint32_t>(r.maxZ - r.minZ + 1);
+        if (ecs.jobSystem && rows >= PARALLEL_ROW_THRESHOLD)
+        {
+            ecs.jobSystem->parallelForRange(static_cast<uint32_t>(r.minZ), static_cast<uint32_t>(r.maxZ) + 1u, 4u,
+                                            [&](uint32_t /*worker*/, uint32_t first, uint32_t last)
+                                            { costRows(first, last); });
+        }
+        else
+        {
+            costRows(static_cast<uint32_t>(r.minZ), static_cast<uint32_t>(r.maxZ) + 1u);
+        }
+        m_stats.cellsUpdated = rows * static_cast<uint32_t>(r.maxX - r.minX + 1);
+    }
+
+    const NavGrid *m_grid = nullptr; // not owned; layout only
+    CrowdField m_field;
+    uint32_t m_layoutRevision = UINT32_MAX;
+    Rect m_touched; // cells written by the last update (cleared at the start of the next)
+    bool m_enabled = true;
+    Engine::ECS::QueryId m_queryId = Engine::ECS::QueryManager::InvalidQuery;
+    Stats m_stats{};
+};
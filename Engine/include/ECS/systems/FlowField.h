@@ -0,0 +1,359 @@
+#pragma once
+/*
+  FlowField.h
+  -----------
+  Purpose:
+    - Shared goal fields for group move orders: one Dijkstra integration from the goal over the
+      NavGrid replaces one A* per unit.
+    - A field covers a bounded grid rect (the group, its goal and a margin). Per cell it stores
+      the integrated cost to the goal region and the step toward the neighbor that leads there
+      (same 8-neighbor/corner rules and costs as PathfindingSystem's A*).
+
+  Usage:
+    - sync(grid, js) once per frame before acquiring: fields whose bounds are touched by
+      grid.dirtyRegions are re-integrated in place (their handles stay valid); a layout change
+      drops every field.
+    - acquire(grid, goal, area) returns a cached field for that goal region that covers area,
+      or builds one in the least recently used slot.
+    - steer(handle, x, z, outX, outZ) is read-only and may run from several threads.
+    - Handles carry the slot's generation, so a unit still holding an evicted field gets Lost
+      instead of a stranger's directions.
+*/
+
+#include "ECS/systems/NavGrid.h"
+#include "utils/JobSystem.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+class FlowFieldCache
+{
+public:
+    // =====================
+    // TUNING CONSTANTS
+    // =====================
+    static constexpr uint32_t MAX_FIELDS = 8;
+    static constexpr int LOOKAHEAD_CELLS = 4; // steer() aims at the farthest visible of these
+
+    static constexpr float Unreachable = 1e30f;
+    static constexpr uint8_t NoStep = 4; // step code of the center (goal cells, unreached cells)
+
+    using Handle = uint32_t; // 0 = none; (generation << 4) | (slot + 1)
+
+    struct Rect
+    {
+        int minX = 0, minZ = 0, maxX = 0, maxZ = 0; // inclusive, grid space
+
+        bool contains(int x, int z) const { return x >= minX && x <= maxX && z >= minZ && z <= maxZ; }
+        bool contains(const Rect &o) const { return o.minX >= minX && o.maxX <= maxX && o.minZ >= minZ && o.maxZ <= maxZ; }
+        bool intersects(int x0, int z0, int x1, int z1) const { return x0 <= maxX && x1 >= minX && z0 <= maxZ && z1 >= minZ; }
+        bool operator==(const Rect &o) const { return minX == o.minX && minZ == o.minZ && maxX == o.maxX && maxZ == o.maxZ; }
+    };
+
+    enum class Step
+    {
+        Follow,  // outX/outZ hold the next point to steer at
+        Arrived, // inside the goal region
+        Lost,    // evicted field, outside its bounds, or a cell the field never reached
+    };
+
+    // Finds a live field for goal whose bounds contain area, or integrates a new one.
+    // Returns 0 when the goal region has no walkable cell.
+    Handle acquire(const NavGrid &grid, const Rect &goal, const Rect &area)
+    {
+        m_grid = &grid;
+        ++m_clock;
+
+        for (uint32_t slot = 0; slot < MAX_FIELDS; ++slot)
+        {
+            Field &f = m_fields[slot];
+            if (f.live && f.goal == goal && f.bounds.contains(area))
+            {
+                f.lastUsed = m_clock;
+                return handleOf(slot);
+            }
+        }
+
+        uint32_t victim = 0;
+        for (uint32_t slot = 1; slot < MAX_FIELDS; ++slot)
+        {
+            const Field &f = m_fields[slot];
+            const Field &v = m_fields[victim];
+            if (v.live && (!f.live || f.lastUsed < v.lastUsed))
+                victim = slot;
+        }
+
+        Field &f = m_fields[victim];
+        f.generation = (f.generation + 1u) & GENERATION_MASK;
+        if (f.generation == 0)
+            f.generation = 1;
+        f.goal = goal;
+        f.bounds = area;
+        f.lastUsed = m_clock;
+        f.gridRevision = grid.revision;
+        f.layoutRevision = grid.layoutRevision;
+        f.live = integrate(grid, f);
+        if (f.live)
+            ++m_lastFieldsBuilt;
+        return f.live ? handleOf(victim) : 0u;
+    }
+
+    // Re-integrates fields touched by grid changes since their last build.
+    void sync(const NavGrid &grid, Engine::JobSystem *js)
+    {
+        m_grid = &grid;
+        m_lastFieldsBuilt = 0;
+
+        uint32_t stale[MAX_FIELDS];
+        uint32_t staleCount = 0;
+        for (uint32_t slot = 0; slot < MAX_FIELDS; ++slot)
+        {
+            Field &f = m_fields[slot];
+            if (!f.live)
+                continue;
+            if (f.layoutRevision != grid.layoutRevision)
+            {
+                f.live = false;
+                continue;
+            }
+            if (f.gridRevision == grid.revision)
+                continue;
+
+            // Log already trimmed past this field's revision: we can't tell what changed.
+            bool touched = grid.dirtyRegions.empty() || grid.dirtyRegions.front().revision > f.gridRevision + 1u;
+            for (const NavGrid::DirtyRegion &r : grid.dirtyRegions)
+            {
+                if (touched)
+                    break;
+                if (r.revision > f.gridRevision && f.bounds.intersects(r.minX, r.minZ, r.maxX, r.maxZ))
+                    touched = true;
+            }
+
+            f.gridRevision = grid.revision;
+            if (touched)
+                stale[staleCount++] = slot;
+        }
+
+        auto rebuild = [&](uint32_t k)
+        {
+            Field &f = m_fields[stale[k]];
+            f.live = integrate(grid, f);
+        };
+        if (js && js->workerCount() > 0 && staleCount > 1)
+        {
+            js->parallelForRange(0u, staleCount, 1u, [&](uint32_t /*worker*/, uint32_t first, uint32_t last)
+                                 {
+                                     for (uint32_t k = first; k < last; ++k)
+                                         rebuild(k); });
+        }
+        else
+        {
+            for (uint32_t k = 0; k < staleCount; ++k)
+                rebuild(k);
+        }
+        m_lastFieldsBuilt += staleCount;
+    }
+
+    // Integrated cost at a grid cell (Unreachable when the handle is stale or the cell is not
+    // covered). 0 means the cell is part of the goal region.
+    float costAt(Handle h, int gx, int gz) const
+    {
+        const Field *f = field(h);
+        if (!f || !f->bounds.contains(gx, gz))
+            return Unreachable;
+        return f->cost[f->local(gx, gz)];
+    }
+
+    // Next point to steer at from world position (x, z).
+    Step steer(Handle h, float x, float z, float &outX, float &outZ) const
+    {
+        const Field *f = field(h);
+        if (!f || !m_grid)
+            return Step::Lost;
+
+        const int gx = m_grid->worldToGridX(x);
+        const int gz = m_grid->worldToGridZ(z);
+        if (!f->bounds.contains(gx, gz))
+            return Step::Lost;
+
+        const float c = f->cost[f->local(gx, gz)];
+        if (c <= 0.0f)
+            return Step::Arrived;
+        if (c >= Unreachable)
+        {
+            // Pushed into a blocked cell (avoidance, corner clipping): head back to the cheapest
+            // walkable neighbor instead of dropping the field.
+            if (m_grid->isWalkable(gx, gz))
+                return Step::Lost;
+            float best = Unreachable;
+            for (int dz = -1; dz <= 1; ++dz)
+            {
+                for (int dx = -1; dx <= 1; ++dx)
+                {
+                    const float nc = costAt(h, gx + dx, gz + dz);
+                    if (nc < best)
+                    {
+                        best = nc;
+                        outX = m_grid->gridToWorldX(gx + dx);
+                        outZ = m_grid->gridToWorldZ(gz + dz);
+                    }
+                }
+            }
+            return (best < Unreachable) ? Step::Follow : Step::Lost;
+        }
+
+        // Walk the step chain a few cells and aim at the farthest one still in line of sight,
+        // which smooths the 8-direction staircase the same way path smoothing does.
+        int cx = gx, cz = gz;
+        int bestX = gx, bestZ = gz;
+        for (int k = 0; k < LOOKAHEAD_CELLS; ++k)
+        {
+            const uint8_t code = f->step[f->local(cx, cz)];
+            if (code == NoStep)
+                break;
+            cx += static_cast<int>(code % 3u) - 1;
+            cz += static_cast<int>(code / 3u) - 1;
+            if (k > 0 && !m_grid->lineCheckGrid(gx, gz, cx, cz))
+                break;
+            bestX = cx;
+            bestZ = cz;
+        }
+        if (bestX == gx && bestZ == gz)
+            return Step::Lost;
+
+        outX = m_grid->gridToWorldX(bestX);
+        outZ = m_grid->gridToWorldZ(bestZ);
+        return Step::Follow;
+    }
+
+    // Telemetry: fields integrated since the last sync().
+    uint32_t lastFieldsBuilt() const { return m_lastFieldsBuilt; }
+
+    // Heap bytes held by the field slots (cost/step grids and integration heaps).
+    uint64_t memoryBytes() const
+    {
+        uint64_t bytes = 0;
+        for (const Field &f : m_fields)
+            bytes += f.cost.capacity() * sizeof(float) + f.step.capacity() + f.heap.capacity() * sizeof(HeapEntry);
+        return bytes;
+    }
+
+    uint32_t liveFieldCount() const
+    {
+        uint32_t n = 0;
+        for (const Field &f : m_fields)
+            n += f.live ? 1u : 0u;
+        return n;
+    }
+
+private:
+    static constexpr uint32_t GENERATION_MASK = 0x0FFFFFFFu;
+
+    struct HeapEntry
+    {
+        float cost;
+        int cell; // local index
+        bool operator>(const HeapEntry &o) const { return cost > o.cost; }
+    };
+
+    struct Field
+    {
+        Rect goal;
+        Rect bounds;
+        uint32_t generation = 0;
+        uint32_t gridRevision = 0;
+        uint32_t layoutRevision = 0;
+        uint64_t lastUsed = 0;
+        bool live = false;
+
+        std::vector<float> cost;   // per bounds cell
+        std::vector<uint8_t> step; // (dx + 1) + 3 * (dz + 1) toward the goal
+        std::vector<HeapEntry> heap;
+
+        int local(int gx, int gz) const { return (gz - bounds.minZ) * (bounds.maxX - bounds.minX + 1) + (gx - bounds.minX); }
+    };
+
+    const NavGrid *m_grid = nullptr; // not owned
+    Field m_fields[MAX_FIELDS];
+    uint64_t m_clock = 0;
+    uint32_t m_lastFieldsBuilt = 0;
+
+    Handle handleOf(uint32_t slot) const { return (m_fields[slot].generation << 4) | (slot + 1u); }
+
+    const Field *field(Handle h) const
+    {
+        if (h == 0)
+            return nullptr;
+        const uint32_t slot = (h & 0xFu) - 1u;
+        if (slot >= MAX_FIELDS)
+            return nullptr;
+        const Field &f = m_fields[slot];
+        return (f.live && f.generation == (h >> 4)) ? &f : nullptr;
+    }
+
+    // Multi-source Dijkstra from the walkable goal cells, restricted to f.bounds.
+    // Returns false when no goal cell is walkable.
+    static bool integrate(const NavGrid &grid, Field &f)
+    {
+        const Rect &b = f.bounds;
+        const int w = b.maxX - b.minX + 1;
+        const int h = b.maxZ - b.minZ + 1;
+        f.cost.assign(static_cast<size_t>(w) * h, Unreachable);
+        f.step.assign(static_cast<size_t>(w) * h, NoStep);
+        f.heap.clear();
+
+        for (int gz = std::max(f.goal.minZ, b.minZ); gz <= std::min(f.goal.maxZ, b.maxZ); ++gz)
+        {
+            for (int gx = std::max(f.goal.minX, b.minX); gx <= std::min(f.goal.maxX, b.maxX); ++gx)
+            {
+                if (!grid.isWalkable(gx, gz))
+                    continue;
+                const int l = f.local(gx, gz);
+                f.cost[l] = 0.0f;
+                f.heap.push_back({0.0f, l});
+            }
+        }
+        if (f.heap.empty())
+            return false;
+
+        static constexpr int dxAddr[] = {0, 0, -1, 1, -1, -1, 1, 1};
+        static constexpr int dzAddr[] = {-1, 1, 0, 0, -1, 1, -1, 1};
+        static constexpr float costs[] = {1.0f, 1.0f, 1.0f, 1.0f, 1.414f, 1.414f, 1.414f, 1.414f};
+
+        const int W = grid.width;
+        while (!f.heap.empty())
+        {
+            std::pop_heap(f.heap.begin(), f.heap.end(), std::greater<HeapEntry>{});
+            const HeapEntry cur = f.heap.back();
+            f.heap.pop_back();
+            if (cur.cost > f.cost[cur.cell])
+                continue;
+
+            const int cx = b.minX + cur.cell % w;
+            const int cz = b.minZ + cur.cell / w;
+            for (int i = 0; i < 8; ++i)
+            {
+                const int nx = cx + dxAddr[i];
+                const int nz = cz + dzAddr[i];
+                if (!b.contains(nx, nz) || grid.isBlocked(nz * W + nx))
+                    continue;
+                if (i >= 4 && (grid.isBlocked(nz * W + cx) || grid.isBlocked(cz * W + nx)))
+                    continue;
+
+                const int l = f.local(nx, nz);
+                const float c = cur.cost + costs[i];
+                if (c < f.cost[l])
+                {
+                    f.cost[l] = c;
+                    // Step from the neighbor back to the cell it was reached from.
+                    f.step[l] = static_cast<uint8_t>((1 - dxAddr[i]) + 3 * (1 - dzAddr[i]));
+                    f.heap.push_back({c, l});
+                    std::push_heap(f.heap.begin(), f.heap.end(), std::greater<HeapEntry>{});
+                }
+            }
+        }
+        return true;
+    }
+};
@@ -5,16 +5,36 @@
   Purpose:
     - Adjust velocities to prevent overlap using local separation, based on neighbors
       found via SpatialIndexSystem (hash grid, cellSize = neighbor radius R).
+    - Two modes (Config::mode):
+        - Forces: separation / falloff / predictive accelerations, blended into Velocity.
+        - Orca: reciprocal velocity obstacles against the K nearest neighbors
+          (Config::orcaMaxNeighbors), solved as a 2D linear program in fixed-size stack
+          buffers. Cost per unit is bounded by K regardless of crowd density.
 
   Requirements:
     - Components present in stores: "Position", "Velocity", "Radius", "AvoidanceParams".
         - Optional component: "Separation" (extra desired spacing beyond radii).
         - Optional component: "MoveTarget" (used only to keep avoidance awake near goals).
         - Optional component: "Team" (used only if enabled in config).
-    - SpatialIndexSystem must have run earlier in the frame (grid built).
+        - Optional component: "SleepState" (asleep rows without an active target are skipped).
+    - setSimulationLod (optional): rows in its Far tier are solved every avoidanceInterval ticks
+      against at most avoidanceMaxNeighbors neighbors; in between they keep Steering's velocity.
+    - setCrowdField (optional): rows standing in a congested crowd cell (CrowdFieldSystem) are
+      solved against at most Config::crowdMaxNeighbors neighbors; the crowd layer does the rest.
+    - SpatialIndexSystem must have run earlier in the frame (grid built). Neighbor position, radius,
+      separation and team are read from its GridNeighbor copy; only interacting movers touch
+      their store (for the live Velocity).
     - Steering should have already produced a "preferred" velocity, stored in Velocity.
       This system keeps final speeds close to that magnitude.
 
+  Notes (Orca):
+    - Movers take half the responsibility for a pair (both sides adjust); static neighbors
+      (obstacles) take none, so their half-planes are kept as hard constraints.
+    - Speed limit is the preferred speed, or AvoidanceParams::maxStopSpeed when stopped, so
+      idle units can still be pushed aside. blend and the force weights are not used.
+    - One solve per unit per frame: when the constraints are infeasible the least-penetrating
+      velocity is taken (linear program 3 of RVO2) instead of iterating.
+
   Suggested order per frame:
     CommandSystem -> SteeringSystem -> SpatialIndexSystem -> LocalAvoidanceSystem -> MovementSystem
 */
@@ -22,8 +42,12 @@
 #include "ECS/SystemFormat.h"
 #include "ECS/Components.h"
 #include "ECS/ArchetypeStore.h"
+#include "ECS/CostBalancedBatches.h"
 
+#include "ECS/systems/CrowdFieldSystem.h"
+#include "ECS/systems/SimulationLod.h"
 #include "ECS/systems/SpatialIndexSystem.h"
+#include "utils/FrameArena.h"
 #include "utils/JobSystem.h"
 
 #include <algorithm>
@@ -38,12 +62,26 @@ public:
     // TUNING CONSTANTS
     // =====================
     static constexpr uint32_t PARALLEL_DIRTY_ROW_THRESHOLD = 256;
+    static constexpr uint32_t ORCA_MAX_NEIGHBORS = 16; // stack capacity; Config::orcaMaxNeighbors is clamped to it
+    static constexpr float ORCA_EPSILON = 1e-5f;
+
+    enum class Mode : uint8_t
+    {
+        Forces,
+        Orca,
+    };
 
     struct Config
     {
         // If true and both entities have Team, Separation is only applied to same-team neighbors.
         // If false, Separation applies to all neighbors regardless of Team.
         bool useTeamForSeparation = true;
+
+        Mode mode = Mode::Forces;
+        uint32_t orcaMaxNeighbors = 10;      // K nearest neighbors per unit (<= ORCA_MAX_NEIGHBORS)
+        float orcaTimeHorizon = 1.5f;        // seconds of lookahead against movers
+        float orcaObstacleTimeHorizon = 0.5f; // seconds of lookahead against static neighbors
+        uint32_t crowdMaxNeighbors = 4;      // neighbors of rows in a congested crowd cell (setCrowdField)
     };
 
     LocalAvoidanceSystem(const SpatialIndexSystem *grid = nullptr)
@@ -51,6 +89,8 @@ public:
     {
         setRequiredNames({"Position", "Velocity", "Radius", "AvoidanceParams"});
         setExcludedNames({"Disabled", "Dead"});
+        setReadNames({"Position", "Radius", "AvoidanceParams", "Team", "MoveTarget", "Separation", "SleepState", "SpatialIndex", "CrowdField"});
+        setWriteNames({"Velocity"});
     }
 
     const char *name() const override { return "LocalAvoidanceSystem"; }
@@ -65,7 +105,10 @@ public:
     }
 
     void setGrid(const SpatialIndexSystem *grid) { m_grid = grid; }
+    void setSimulationLod(const SimulationLod *lod) { m_lod = lod; }
+    void setCrowdField(const CrowdField *crowd) { m_crowd = crowd; }
     void setConfig(const Config &cfg) { m_cfg = cfg; }
+    const Config &config() const { return m_cfg; }
 
     void update(Engine::ECS::ECSContext &ecs, float dt) override
     {
@@ -74,6 +117,11 @@ public:
         if (dt <= 0.0f)
             return;
 
+        ++m_tick;
+        const bool lodActive = m_lod && m_lod->enabled();
+        const uint32_t farInterval = lodActive ? std::max(m_lod->config().avoidanceInterval, 1u) : 1u;
+        const uint32_t farNeighbors = lodActive ? std::max(m_lod->config().avoidanceMaxNeighbors, 1u) : UINT32_MAX;
+
         auto clamp = [](float v, float a, float b)
         { return std::max(a, std::min(v, b)); };
 
@@ -125,29 +173,30 @@ public:
                 continue;
             auto &store = *storePtr;
 
-            auto dirtyRows = ecs.queries.consumeDirtyRows(m_queryId, archetypeId);
+            auto &dirtyRows = m_dirtyRows;
+            ecs.queries.consumeDirtyRows(m_queryId, archetypeId, dirtyRows);
             if (dirtyRows.empty())
                 continue;
 
-            auto &positions = store.positions();
-            auto &velocities = store.velocities();
-            auto &radii = store.radii();
-            auto &params = store.avoidanceParams();
+            auto positions = store.positions();
+            auto velocities = store.velocities();
+            auto radii = store.radii();
+            auto params = store.avoidanceParams();
             const bool hasSep = store.hasSeparation();
-            const auto *sepsPtr = hasSep ? &store.separations() : nullptr;
+            const auto seps = store.separations();
             const bool hasMoveTarget = store.hasMoveTarget();
-            const auto *targetsPtr = hasMoveTarget ? &store.moveTargets() : nullptr;
+            const auto targets = store.moveTargets();
             const bool hasTeam = store.hasTeam();
-            const auto *teamsPtr = hasTeam ? &store.teams() : nullptr;
+            const auto teams = store.teams();
             const auto &ents = store.entities();
             const uint32_t n = store.size();
 
             // Compute new velocities into a temporary buffer first. This avoids neighbor read/write hazards
-            // and makes it safe to parallelize the compute phase.
-            std::vector<Engine::ECS::Velocity> outVel(dirtyRows.size());
-            std::vector<uint8_t> outChanged(dirtyRows.size(), 0);
+            // and makes it safe to parallelize the compute phase. Frame arena: no heap traffic per store.
+            Engine::FrameVector<Engine::ECS::Velocity> outVel(dirtyRows.size());
+            Engine::FrameVector<uint8_t> outChanged(dirtyRows.size(), 0);
 
-            auto computeAt = [&](uint32_t idx)
+            auto computeAt = [&](uint32_t idx, bool far)
             {
                 const uint32_t row = dirtyRows[idx];
                 if (row >= n)
@@ -160,14 +209,14 @@ public:
                 const float vOldY = v.y;
                 const auto &r = radii[row];
                 const auto &ap = params[row];
-                const float sepSelf = sepsPtr ? (*sepsPtr)[row].value : 0.0f;
+                const float sepSelf = hasSep ? seps[row].value : 0.0f;
 
                 const float vPrefX = v.x;
                 const float vPrefZ = v.z;
                 const float prefSpeed2 = vPrefX * vPrefX + vPrefZ * vPrefZ;
                 const float prefSpeed = (prefSpeed2 > 1e-12f) ? std::sqrt(prefSpeed2) : 0.0f;
 
-                const bool hasActiveTarget = (targetsPtr && (*targetsPtr)[row].active);
+                const bool hasActiveTarget = (hasMoveTarget && targets[row].active);
                 const bool settleMode = (!hasActiveTarget);
 
                 constexpr float kPenetrationEps = 0.05f;
@@ -183,7 +232,7 @@ public:
                 float arrivalBoost = 1.0f;
                 if (hasActiveTarget)
                 {
-                    const auto &tgt = (*targetsPtr)[row];
+                    const auto &tgt = targets[row];
                     const float dx = tgt.x - p.x;
                     const float dz = tgt.z - p.z;
                     const float dist = std::sqrt(dx * dx + dz * dz);
@@ -195,58 +244,43 @@ public:
                     arrivalBoost = std::max(0.0f, ap.stoppedBoost);
                 }
 
-                const uint8_t myTeam = (teamsPtr ? (*teamsPtr)[row].id : 0u);
+                const uint8_t myTeam = (hasTeam ? teams[row].id : 0u);
 
                 float accDirX = 0.0f;
                 float accDirZ = 0.0f;
                 bool hasPressure = false;
+                uint32_t neighborCap = far ? farNeighbors : UINT32_MAX;
+                if (m_crowd && m_crowd->congested(p.x, p.z))
+                    neighborCap = std::min(neighborCap, std::max(m_cfg.crowdMaxNeighbors, 1u));
+                uint32_t interacting = 0;
 
-                m_grid->forNeighbors(p.x, p.z, [&](uint32_t nStoreId, uint32_t nRow)
+                m_grid->forNeighborData(p.x, p.z, [&](const GridNeighbor &nb)
                                      {
+                    const uint32_t nStoreId = nb.entry.storeId;
+                    const uint32_t nRow = nb.entry.row;
                     if (nStoreId == archetypeId && nRow == row) return;
 
-                    const auto* nStore = ecs.stores.get(nStoreId);
-                    if (!nStore) return;
-                    if (nRow >= nStore->size()) return;
-
-                    if (!nStore->hasPosition()) return;
-
-                    // Obstacles typically use ObstacleRadius (not Radius). Treat ObstacleRadius as the
-                    // neighbor's radius so movers will avoid obstacles without requiring data changes.
-                    float neighborRadius = 0.0f;
-                    if (nStore->hasRadius())
-                    {
-                        neighborRadius = nStore->radii()[nRow].r;
-                    }
-                    else if (nStore->hasObstacleRadius())
-                    {
-                        neighborRadius = nStore->obstacleRadii()[nRow].r;
-                    }
-                    else
-                    {
-                        return;
-                    }
-
-                    const auto& np = nStore->positions()[nRow];
+                    // Obstacles typically use ObstacleRadius (not Radius); the grid copy already folds
+                    // it into nb.radius, so movers avoid obstacles without requiring data changes.
+                    if (!(nb.flags & GRID_NEIGHBOR_HAS_RADIUS)) return;
+                    const float neighborRadius = nb.radius;
 
-                    const bool nHasSep = nStore->hasSeparation();
-                    const bool nHasTeam = nStore->hasTeam();
-                    const bool nHasVel = nStore->hasVelocity();
+                    const bool nHasTeam = (nb.flags & GRID_NEIGHBOR_HAS_TEAM) != 0;
+                    const bool nHasVel = (nb.flags & GRID_NEIGHBOR_MOVER) != 0;
 
                     float desiredSep = 0.0f;
-                    if (!sepsPtr)
+                    if (!hasSep)
                     {
                         desiredSep = 0.0f;
                     }
-                    else if (!m_cfg.useTeamForSeparation || !teamsPtr || !nHasTeam)
+                    else if (!m_cfg.useTeamForSeparation || !hasTeam || !nHasTeam)
                     {
-                        desiredSep = sepSelf + (nHasSep ? nStore->separations()[nRow].value : 0.0f);
+                        desiredSep = sepSelf + nb.separation;
                     }
                     else
                     {
-                        const uint8_t otherTeam = nStore->teams()[nRow].id;
-                        if (otherTeam == myTeam)
-                            desiredSep = sepSelf + (nHasSep ? nStore->separations()[nRow].value : 0.0f);
+                        if (nb.team == myTeam)
+                            desiredSep = sepSelf + nb.separation;
                         else
                             desiredSep = 0.0f;
                     }
@@ -254,11 +288,14 @@ public:
                     const float desiredDist = (r.r + neighborRadius) + desiredSep;
                     const float interactDist = desiredDist + interactSlack;
 
-                    float dx = p.x - np.x;
-                    float dz = p.z - np.z;
+                    float dx = p.x - nb.x;
+                    float dz = p.z - nb.z;
                     const float dist2 = dx * dx + dz * dz;
                     if (dist2 > interactDist * interactDist)
                         return;
+                    if (interacting == neighborCap)
+                        return;
+                    ++interacting;
 
                     float dist = (dist2 > 1e-12f) ? std::sqrt(dist2) : 0.0f;
                     float awayX = dx;
@@ -299,13 +336,14 @@ public:
                     float nVz = 0.0f;
                     if (nHasVel)
                     {
-                        const auto &nv = nStore->velocities()[nRow];
+                        // Velocities are rewritten store by store below, so read the live value.
+                        const auto &nv = ecs.stores.get(nStoreId)->velocities()[nRow];
                         nVx = nv.x;
                         nVz = nv.z;
                     }
 
-                    const float relX = p.x - np.x;
-                    const float relZ = p.z - np.z;
+                    const float relX = p.x - nb.x;
+                    const float relZ = p.z - nb.z;
                     const float rvX = vPrefX - nVx;
                     const float rvZ = vPrefZ - nVz;
                     const float rv2 = rvX * rvX + rvZ * rvZ;
@@ -423,18 +461,167 @@ public:
                 outVel[idx] = out;
             };
 
+            // Orca mode: one half-plane per neighbor among the K nearest, then a 2D linear program
+            // for the velocity closest to the preferred one inside all of them.
+            const uint32_t maxNeighbors = std::min(std::max(m_cfg.orcaMaxNeighbors, 1u), ORCA_MAX_NEIGHBORS);
+            const float invDt = 1.0f / dt;
+            const float invMoverHorizon = 1.0f / std::max(m_cfg.orcaTimeHorizon, 1e-3f);
+            const float invObstacleHorizon = 1.0f / std::max(m_cfg.orcaObstacleTimeHorizon, 1e-3f);
+
+            auto computeOrcaAt = [&](uint32_t idx, bool far)
+            {
+                const uint32_t row = dirtyRows[idx];
+                if (row >= n)
+                    return;
+
+                const auto &p = positions[row];
+                const auto &v = velocities[row];
+                const auto &ap = params[row];
+                const float selfRadius = radii[row].r;
+                const float sepSelf = hasSep ? seps[row].value : 0.0f;
+                const uint8_t myTeam = (hasTeam ? teams[row].id : 0u);
+                const bool hasActiveTarget = (hasMoveTarget && targets[row].active);
+
+                // K nearest by center distance (ties: lower entity index first), insertion-sorted.
+                uint32_t k = far ? std::min(maxNeighbors, farNeighbors) : maxNeighbors;
+                if (m_crowd && m_crowd->congested(p.x, p.z))
+                    k = std::min(k, std::max(m_cfg.crowdMaxNeighbors, 1u));
+                OrcaNeighbor nearest[ORCA_MAX_NEIGHBORS];
+                uint32_t count = 0;
+                m_grid->forNeighborData(p.x, p.z, [&](const GridNeighbor &nb)
+                                        {
+                    if (nb.entry.storeId == archetypeId && nb.entry.row == row) return;
+                    if (!(nb.flags & GRID_NEIGHBOR_HAS_RADIUS)) return;
+
+                    const float dx = nb.x - p.x;
+                    const float dz = nb.z - p.z;
+                    const float d2 = dx * dx + dz * dz;
+                    if (count == k && !orcaNearer(d2, nb.entityIndex, nearest[count - 1]))
+                        return;
+
+                    uint32_t at = (count < k) ? count++ : count - 1;
+                    while (at > 0 && orcaNearer(d2, nb.entityIndex, nearest[at - 1]))
+                    {
+                        nearest[at] = nearest[at - 1];
+                        --at;
+                    }
+                    nearest[at] = OrcaNeighbor{nb, d2}; });
+
+                Engine::ECS::Velocity out = v;
+                if (count == 0)
+                {
+                    if (!hasActiveTarget && std::fabs(v.x) + std::fabs(v.z) > 1e-6f)
+                    {
+                        out.x = 0.0f;
+                        out.z = 0.0f;
+                        outChanged[idx] = 1;
+                    }
+                    outVel[idx] = out;
+                    return;
+                }
+
+                // Static neighbors first: linear program 3 keeps the first numObstacleLines as hard constraints.
+                OrcaLine lines[ORCA_MAX_NEIGHBORS];
+                uint32_t lineCount = 0;
+                uint32_t numObstacleLines = 0;
+                for (int pass = 0; pass < 2; ++pass)
+                {
+                    const bool movers = (pass == 1);
+                    for (uint32_t i = 0; i < count; ++i)
+                    {
+                        const GridNeighbor &nb = nearest[i].neighbor;
+                        const bool nIsMover = (nb.flags & GRID_NEIGHBOR_MOVER) != 0;
+                        if (nIsMover != movers)
+                            continue;
+
+                        float desiredSep = 0.0f;
+                        if (hasSep && (!m_cfg.useTeamForSeparation || !hasTeam || !(nb.flags & GRID_NEIGHBOR_HAS_TEAM) || nb.team == myTeam))
+                            desiredSep = sepSelf + nb.separation;
+                        const float combinedRadius = selfRadius + nb.radius + desiredSep;
+
+                        float nVx = 0.0f;
+                        float nVz = 0.0f;
+                        if (nIsMover)
+                        {
+                            // Velocities are rewritten store by store below, so read the live value.
+                            const auto &nv = ecs.stores.get(nb.entry.storeId)->velocities()[nb.entry.row];
+                            nVx = nv.x;
+                            nVz = nv.z;
+                        }
+
+                        const uint32_t seed = static_cast<uint32_t>(ents[row].index) ^ (nb.entry.storeId * 16777619u + nb.entry.row);
+                        lines[lineCount++] = orcaLine(nb.x - p.x, nb.z - p.z, v.x - nVx, v.z - nVz, v.x, v.z,
+                                                      combinedRadius, nIsMover ? invMoverHorizon : invObstacleHorizon,
+                                                      invDt, nIsMover ? 0.5f : 1.0f, hashAngle(seed));
+                    }
+                    if (!movers)
+                        numObstacleLines = lineCount;
+                }
+
+                const float prefSpeed2 = v.x * v.x + v.z * v.z;
+                const float prefSpeed = (prefSpeed2 > 1e-12f) ? std::sqrt(prefSpeed2) : 0.0f;
+                const float maxSpeed = (prefSpeed > 1e-4f) ? prefSpeed : std::max(0.0f, ap.maxStopSpeed);
+
+                float rx = 0.0f;
+                float rz = 0.0f;
+                const uint32_t failed = orcaLinearProgram2(lines, lineCount, maxSpeed, v.x, v.z, false, rx, rz);
+                if (failed < lineCount)
+                    orcaLinearProgram3(lines, lineCount, numObstacleLines, failed, maxSpeed, rx, rz);
+
+                out.x = rx;
+                out.z = rz;
+                if (!hasActiveTarget && (out.x * out.x + out.z * out.z) < 0.0004f)
+                {
+                    out.x = 0.0f;
+                    out.z = 0.0f;
+                }
+
+                const float dv1 = std::fabs(out.x - v.x) + std::fabs(out.z - v.z);
+                if (dv1 > 1e-6f)
+                    outChanged[idx] = 1;
+
+                outVel[idx] = out;
+            };
+
+            // Asleep rows (SleepSystem) keep still until an order or a nearby mover wakes them.
+            const bool hasSleep = store.hasSleepState();
+            const auto sleeps = store.sleepStates();
+
+            auto computeRow = [&](uint32_t idx)
+            {
+                const uint32_t row = dirtyRows[idx];
+                if (hasSleep && row < n && sleeps[row].asleep && !(hasMoveTarget && targets[row].active))
+                    return;
+                const bool far = lodActive && row < n && m_lod->isFar(ecs, ents[row], positions[row].x, positions[row].z);
+                if (far && !SimulationLod::onStride(ents[row].index, m_tick, farInterval))
+                    return;
+                if (m_cfg.mode == Mode::Orca)
+                    computeOrcaAt(idx, far);
+                else
+                    computeAt(idx, far);
+            };
+
             Engine::JobSystem *js = ecs.jobSystem;
             const bool canParallel = (js != nullptr) && (js->workerCount() > 0) &&
                                      (dirtyRows.size() >= PARALLEL_DIRTY_ROW_THRESHOLD);
             if (canParallel)
             {
-                js->parallelFor(static_cast<uint32_t>(dirtyRows.size()), [&](uint32_t /*workerIndex*/, uint32_t i)
-                                { computeAt(i); });
+                // Rows in packed blocks see many more neighbors than stragglers: balance by cell occupancy.
+                m_rowCosts.resize(dirtyRows.size());
+                for (uint32_t i = 0; i < dirtyRows.size(); ++i)
+                {
+                    const uint32_t row = dirtyRows[i];
+                    m_rowCosts[i] = (row < n) ? 1u + m_grid->cellOccupancy(positions[row].x, positions[row].z) : 0u;
+                }
+                m_balance.build(m_rowCosts.data(), static_cast<uint32_t>(dirtyRows.size()),
+                                Engine::ECS::CostBalancedBatches::batchCountFor(js));
+                m_balance.run(js, [&](uint32_t /*workerIndex*/, uint32_t i)
+                              { computeRow(i); });
             }
             else
             {
                 for (uint32_t i = 0; i < dirtyRows.size(); ++i)
-                    computeAt(i);
+                    computeRow(i);
             }
 
             // Apply buffered velocities and mark dirty if changed.
@@ -453,11 +640,261 @@ public:
     }
 
 private:
+    // ORCA half-plane: velocities on the left of direction (through point) are permitted.
+    struct OrcaLine
+    {
+        float px = 0.0f;
+        float pz = 0.0f;
+        float dx = 0.0f;
+        float dz = 0.0f;
+    };
+
+    struct OrcaNeighbor
+    {
+        GridNeighbor neighbor;
+        float dist2 = 0.0f;
+    };
+
+    static bool orcaNearer(float d2, uint32_t entityIndex, const OrcaNeighbor &o)
+    {
+        return d2 < o.dist2 || (d2 == o.dist2 && entityIndex < o.neighbor.entityIndex);
+    }
+
+    static float orcaDet(float ax, float az, float bx, float bz) { return ax * bz - az * bx; }
+
+    // Half-plane for one neighbor (RVO2 agent-agent case). rel* = neighbor - self position,
+    // relV* = self - neighbor velocity, responsibility = share of the correction this unit takes.
+    // tieAngle orients the push when both centers and velocities coincide.
+    static OrcaLine orcaLine(float relX, float relZ, float relVX, float relVZ, float vX, float vZ,
+                             float combinedRadius, float invHorizon, float invDt, float responsibility, float tieAngle)
+    {
+        const float distSq = relX * relX + relZ * relZ;
+        const float combinedRadiusSq = combinedRadius * combinedRadius;
+        OrcaLine line;
+        float uX = 0.0f;
+        float uZ = 0.0f;
+
+        if (distSq > combinedRadiusSq)
+        {
+            // No collision yet: vector from the truncated cone's cutoff center to the relative velocity.
+            const float wX = relVX - invHorizon * relX;
+            const float wZ = relVZ - invHorizon * relZ;
+            const float wLenSq = wX * wX + wZ * wZ;
+            const float dot1 = wX * relX + wZ * relZ;
+
+            if (dot1 < 0.0f && dot1 * dot1 > combinedRadiusSq * wLenSq)
+            {
+                // Project on the cutoff circle.
+                const float wLen = std::sqrt(wLenSq);
+                const float unitX = wX / wLen;
+                const float unitZ = wZ / wLen;
+                line.dx = unitZ;
+                line.dz = -unitX;
+                uX = (combinedRadius * invHorizon - wLen) * unitX;
+                uZ = (combinedRadius * invHorizon - wLen) * unitZ;
+            }
+            else
+            {
+                // Project on the nearer leg of the cone.
+                const float leg = std::sqrt(distSq - combinedRadiusSq);
+                if (orcaDet(relX, relZ, wX, wZ) > 0.0f)
+                {
+                    line.dx = (relX * leg - relZ * combinedRadius) / distSq;
+                    line.dz = (relX * combinedRadius + relZ * leg) / distSq;
+                }
+                else
+                {
+                    line.dx = -(relX * leg + relZ * combinedRadius) / distSq;
+                    line.dz = -(-relX * combinedRadius + relZ * leg) / distSq;
+                }
+                const float dot2 = relVX * line.dx + relVZ * line.dz;
+                uX = dot2 * line.dx - relVX;
+                uZ = dot2 * line.dz - relVZ;
+            }
+        }
+        else
+        {
+            // Overlapping: resolve within this step instead of the horizon.
+            const float wX = relVX - invDt * relX;
+            const float wZ = relVZ - invDt * relZ;
+            const float wLen = std::sqrt(wX * wX + wZ * wZ);
+            float unitX = std::cos(tieAngle);
+            float unitZ = std::sin(tieAngle);
+            if (wLen > ORCA_EPSILON)
+            {
+                unitX = wX / wLen;
+                unitZ = wZ / wLen;
+            }
+            line.dx = unitZ;
+            line.dz = -unitX;
+            uX = (combinedRadius * invDt - wLen) * unitX;
+            uZ = (combinedRadius * invDt - wLen) * unitZ;
+        }
+
+        line.px = vX + responsibility * uX;
+        line.pz = vZ + responsibility * uZ;
+        return line;
+    }
+
+    // Optimize along line lineNo subject to lines [0, lineNo) and |v| <= radius.
+    static bool orcaLinearProgram1(const OrcaLine *lines, uint32_t lineNo, float radius, float optX, float optZ,
+                                   bool directionOpt, float &rx, float &rz)
+    {
+        const OrcaLine &l = lines[lineNo];
+        const float dotProduct = l.px * l.dx + l.pz * l.dz;
+        const float discriminant = dotProduct * dotProduct + radius * radius - (l.px * l.px + l.pz * l.pz);
+        if (discriminant < 0.0f)
+            return false; // max speed circle fully invalidates line lineNo
+
+        const float sqrtDiscriminant = std::sqrt(discriminant);
+        float tLeft = -dotProduct - sqrtDiscriminant;
+        float tRight = -dotProduct + sqrtDiscriminant;
+
+        for (uint32_t i = 0; i < lineNo; ++i)
+        {
+            const OrcaLine &o = lines[i];
+            const float denominator = orcaDet(l.dx, l.dz, o.dx, o.dz);
+            const float numerator = orcaDet(o.dx, o.dz, l.px - o.px, l.pz - o.pz);
+            if (std::fabs(denominator) <= ORCA_EPSILON)
+            {
+                // Parallel lines: either line i removes lineNo entirely or it doesn't constrain it.
+                if (numerator < 0.0f)
+                    return false;
+                continue;
+            }
+            const float t = numerator / denominator;
+            if (denominator >= 0.0f)
+                tRight = std::min(tRight, t);
+            else
+                tLeft = std::max(tLeft, t);
+            if (tLeft > tRight)
+                return false;
+        }
+
+        float t;
+        if (directionOpt)
+            t = (optX * l.dx + optZ * l.dz > 0.0f) ? tRight : tLeft;
+        else
+            t = std::max(tLeft, std::min(l.dx * (optX - l.px) + l.dz * (optZ - l.pz), tRight));
+        rx = l.px + t * l.dx;
+        rz = l.pz + t * l.dz;
+        return true;
+    }
+
+    // Velocity closest to opt (or furthest along it when directionOpt) inside all lines and the
+    // speed circle. Returns lineCount on success, else the index of the line that failed.
+    static uint32_t orcaLinearProgram2(const OrcaLine *lines, uint32_t lineCount, float radius, float optX, float optZ,
+                                       bool directionOpt, float &rx, float &rz)
+    {
+        const float opt2 = optX * optX + optZ * optZ;
+        if (directionOpt)
+        {
+            rx = optX * radius; // opt is a unit direction here
+            rz = optZ * radius;
+        }
+        else if (opt2 > radius * radius)
+        {
+            const float s = radius / std::sqrt(opt2);
+            rx = optX * s;
+            rz = optZ * s;
+        }
+        else
+        {
+            rx = optX;
+            rz = optZ;
+        }
+
+        for (uint32_t i = 0; i < lineCount; ++i)
+        {
+            const OrcaLine &l = lines[i];
+            if (orcaDet(l.dx, l.dz, l.px - rx, l.pz - rz) > 0.0f)
+            {
+                const float keepX = rx;
+                const float keepZ = rz;
+                if (!orcaLinearProgram1(lines, i, radius, optX, optZ, directionOpt, rx, rz))
+                {
+                    rx = keepX;
+                    rz = keepZ;
+                    return i;
+                }
+            }
+        }
+        return lineCount;
+    }
+
+    // Infeasible: minimize the largest violation of the mover lines from beginLine on, keeping the
+    // first numObstacleLines satisfied. Projected lines live in a second fixed buffer.
+    static void orcaLinearProgram3(const OrcaLine *lines, uint32_t lineCount, uint32_t numObstacleLines,
+                                   uint32_t beginLine, float radius, float &rx, float &rz)
+    {
+        OrcaLine projected[ORCA_MAX_NEIGHBORS];
+        float distance = 0.0f;
+
+        for (uint32_t i = beginLine; i < lineCount; ++i)
+        {
+            const OrcaLine &li = lines[i];
+            if (orcaDet(li.dx, li.dz, li.px - rx, li.pz - rz) <= distance)
+                continue; // already satisfied within the current violation
+
+            uint32_t projectedCount = numObstacleLines;
+            for (uint32_t j = 0; j < numObstacleLines; ++j)
+                projected[j] = lines[j];
+
+            for (uint32_t j = numObstacleLines; j < i; ++j)
+            {
+                const OrcaLine &lj = lines[j];
+                OrcaLine line;
+                const float determinant = orcaDet(li.dx, li.dz, lj.dx, lj.dz);
+                if (std::fabs(determinant) <= ORCA_EPSILON)
+                {
+                    if (li.dx * lj.dx + li.dz * lj.dz > 0.0f)
+                        continue; // same direction
+                    line.px = 0.5f * (li.px + lj.px);
+                    line.pz = 0.5f * (li.pz + lj.pz);
+                }
+                else
+                {
+                    const float t = orcaDet(lj.dx, lj.dz, li.px - lj.px, li.pz - lj.pz) / determinant;
+                    line.px = li.px + t * li.dx;
+                    line.pz = li.pz + t * li.dz;
+                }
+
+                float dirX = lj.dx - li.dx;
+                float dirZ = lj.dz - li.dz;
+                const float len = std::sqrt(dirX * dirX + dirZ * dirZ);
+                if (len > ORCA_EPSILON)
+                {
+                    dirX /= len;
+                    dirZ /= len;
+                }
+                line.dx = dirX;
+                line.dz = dirZ;
+                projected[projectedCount++] = line;
+            }
+
+            const float keepX = rx;
+            const float keepZ = rz;
+            if (orcaLinearProgram2(projected, projectedCount, radius, -li.dz, li.dx, true, rx, rz) < projectedCount)
+            {
+                // Only numerical error can get here; the previous result is the better one.
+                rx = keepX;
+                rz = keepZ;
+            }
+            distance = orcaDet(li.dx, li.dz, li.px - rx, li.pz - rz);
+        }
+    }
+
     Config m_cfg{};
     const SpatialIndexSystem *m_grid = nullptr; // not owned
+    const SimulationLod *m_lod = nullptr;        // not owned
+    const CrowdField *m_crowd = nullptr;         // not owned
+    uint32_t m_tick = 0;                         // stride for far rows
 
     uint32_t m_positionId = Engine::ECS::ComponentRegistry::InvalidID;
     uint32_t m_velocityId = Engine::ECS::ComponentRegistry::InvalidID;
     uint32_t m_moveTargetId = Engine::ECS::ComponentRegistry::InvalidID;
     Engine::ECS::QueryId m_queryId = Engine::ECS::QueryManager::InvalidQuery;
+    std::vector<uint32_t> m_dirtyRows; // consumeDirtyRows scratch, reused across stores and frames
+    std::vector<uint32_t> m_rowCosts;  // per dirty row: neighbor estimate for the parallel split
+    Engine::ECS::CostBalancedBatches m_balance;
 };
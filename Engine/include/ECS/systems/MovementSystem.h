@@ -5,12 +5,17 @@
   Purpose:
     - Moves entities: position += velocity * dt for any store that has both Position and Velocity
       and does not contain excluded tags.
+
+  Notes:
+    - Dirty rows are integrated four at a time (utils/SimdMotion.h: speed clamp, step, step
+      clamp); navgrid checks and dirty marks stay per row.
 */
 
 #include "ECS/SystemFormat.h"
 #include "ECS/Components.h"
 #include "ECS/systems/NavGrid.h"
 #include "utils/JobSystem.h"
+#include "utils/SimdMotion.h"
 
 #include <cmath>
 #include <algorithm>
@@ -22,6 +27,7 @@ public:
     // TUNING CONSTANTS
     // =====================
     static constexpr uint32_t PARALLEL_DIRTY_ROW_THRESHOLD = 256;
+    static constexpr uint32_t PARALLEL_GRAIN = 64; // dirty rows per parallel range (multiple of 4)
     static constexpr float MAX_SPEED = 25.0f; // m/s, sanity cap
     static constexpr float MAX_STEP = 5.0f;   // m/frame, teleport guard
 
@@ -36,6 +42,8 @@ public:
     {
         setRequiredNames({"Position", "Velocity"});
         setExcludedNames({"Disabled", "Dead"});
+        setReadNames({"NavGrid"});
+        setWriteNames({"Position", "Velocity", "MoveTarget"});
     }
 
     const char *name() const override { return "MovementSystem"; }
@@ -73,131 +81,153 @@ public:
             Engine::ECS::ArchetypeStore *storePtr = ecs.stores.get(archetypeId);
             if (!storePtr)
                 continue;
-            const auto &store = *storePtr;
+            auto &store = *storePtr;
 
-            auto dirtyRows = ecs.queries.consumeDirtyRows(m_queryId, archetypeId);
+            auto &dirtyRows = m_dirtyRows;
+            ecs.queries.consumeDirtyRows(m_queryId, archetypeId, dirtyRows);
             if (dirtyRows.empty())
                 continue;
 
             const uint32_t n = store.size();
-            auto &positions = const_cast<std::vector<Engine::ECS::Position> &>(store.positions());
-            auto &velocities = const_cast<std::vector<Engine::ECS::Velocity> &>(store.velocities());
+            auto positions = store.positions();
+            auto velocities = store.velocities();
 
-            auto processRow = [&](uint32_t i)
+            auto stopRow = [&](uint32_t i)
             {
-                if (i >= n)
-                    return;
-
-                auto &pos = positions[i];
                 auto &vel = velocities[i];
+                vel.x = vel.y = vel.z = 0.0f;
+                ecs.markDirty(m_velocityId, archetypeId, i);
+            };
 
-                if (!finite3(pos.x, pos.y, pos.z) || !finite3(vel.x, vel.y, vel.z))
-                {
-                    vel.x = vel.y = vel.z = 0.0f;
-                    ecs.markDirty(m_velocityId, archetypeId, i);
-                    return;
-                }
-
-                // Clamp absurd speeds so one bad frame can't launch an entity across the map.
-                const float v2 = vel.x * vel.x + vel.y * vel.y + vel.z * vel.z;
-                if (v2 > (MAX_SPEED * MAX_SPEED))
-                {
-                    const float inv = MAX_SPEED / std::sqrt(v2);
-                    vel.x *= inv;
-                    vel.y *= inv;
-                    vel.z *= inv;
-                }
-
-                const float velMag1 = std::fabs(vel.x) + std::fabs(vel.y) + std::fabs(vel.z);
-                if (velMag1 <= 1e-6f)
-                    return;
-
-                float dx = vel.x * dt;
-                float dy = vel.y * dt;
-                float dz = vel.z * dt;
-
-                if (!finite3(dx, dy, dz))
-                {
-                    vel.x = vel.y = vel.z = 0.0f;
-                    ecs.markDirty(m_velocityId, archetypeId, i);
-                    return;
-                }
-
-                const float step2 = dx * dx + dy * dy + dz * dz;
-                if (step2 > (MAX_STEP * MAX_STEP))
+            // Rows [first, last) of dirtyRows, four at a time: gather into lanes, clamp and
+            // integrate with IntegrateVelocity4, then apply each lane's result.
+            auto processRange = [&](uint32_t first, uint32_t last)
+            {
+                for (uint32_t base = first; base < last; base += BATCH)
                 {
-                    const float inv = MAX_STEP / std::sqrt(step2);
-                    dx *= inv;
-                    dy *= inv;
-                    dz *= inv;
-                    // Keep velocity consistent with the clamped step.
-                    vel.x = dx / dt;
-                    vel.y = dy / dt;
-                    vel.z = dz / dt;
-                }
+                    uint32_t rows[BATCH];
+                    uint32_t lanes = 0;
+                    float vx[BATCH] = {}, vy[BATCH] = {}, vz[BATCH] = {};
+                    float dx[BATCH], dy[BATCH], dz[BATCH];
 
-                const float oldX = pos.x;
-                const float oldY = pos.y;
-                const float oldZ = pos.z;
-
-                const float newX = oldX + dx;
-                const float newZ = oldZ + dz;
-
-                if (m_cfg.enforceNavGridCollision && m_navGrid)
-                {
-                    // Prevent moving through blocked cells. This is the "hard constraint" that makes
-                    // obstacles reliably blocking even if steering/avoidance pushes into them.
-                    if (!m_navGrid->lineCheck(oldX, oldZ, newX, newZ))
+                    for (uint32_t k = base; k < std::min(last, base + BATCH); ++k)
                     {
-                        vel.x = vel.y = vel.z = 0.0f;
-                        ecs.markDirty(m_velocityId, archetypeId, i);
-
-                        // Trigger replanning if this mover has a goal.
-                        if (store.hasMoveTarget())
-                            ecs.markDirty(m_moveTargetId, archetypeId, i);
-                        return;
+                        const uint32_t i = dirtyRows[k];
+                        if (i >= n)
+                            continue;
+                        const auto &pos = positions[i];
+                        const auto &vel = velocities[i];
+                        if (!finite3(pos.x, pos.y, pos.z) || !finite3(vel.x, vel.y, vel.z))
+                        {
+                            stopRow(i);
+                            continue;
+                        }
+                        rows[lanes] = i;
+                        vx[lanes] = vel.x;
+                        vy[lanes] = vel.y;
+                        vz[lanes] = vel.z;
+                        ++lanes;
                     }
-                }
+                    if (lanes == 0)
+                        continue;
 
-                pos.x = newX;
-                pos.y = oldY + dy;
-                pos.z = newZ;
+                    // Clamp absurd speeds so one bad frame can't launch an entity across the map,
+                    // and guard against teleport-sized steps.
+                    Engine::simd::IntegrateVelocity4(vx, vy, vz, dx, dy, dz, dt, MAX_SPEED, MAX_STEP);
 
-                if (!finite3(pos.x, pos.y, pos.z))
-                {
-                    pos.x = oldX;
-                    pos.y = oldY;
-                    pos.z = oldZ;
-                    vel.x = vel.y = vel.z = 0.0f;
-                    ecs.markDirty(m_velocityId, archetypeId, i);
-                    ecs.markDirty(m_positionId, archetypeId, i);
-                    return;
+                    for (uint32_t k = 0; k < lanes; ++k)
+                        applyLane(ecs, store, archetypeId, rows[k], vx[k], vy[k], vz[k], dx[k], dy[k], dz[k]);
                 }
-
-                ecs.markDirty(m_positionId, archetypeId, i);
-
-                // Keep movers active: movement must run every frame while velocity is non-zero.
-                ecs.markDirty(m_velocityId, archetypeId, i);
             };
 
             // Parallelize over dirty rows when a job system is available and the batch is non-trivial.
-            if (ecs.jobSystem && dirtyRows.size() >= PARALLEL_DIRTY_ROW_THRESHOLD)
+            const uint32_t count = static_cast<uint32_t>(dirtyRows.size());
+            if (ecs.jobSystem && count >= PARALLEL_DIRTY_ROW_THRESHOLD)
             {
-                ecs.jobSystem->parallelFor(static_cast<uint32_t>(dirtyRows.size()), [&](uint32_t /*worker*/, uint32_t item)
-                                           { processRow(dirtyRows[item]); });
+                ecs.jobSystem->parallelForRange(0u, count, PARALLEL_GRAIN, [&](uint32_t /*worker*/, uint32_t first, uint32_t last)
+                                                { processRange(first, last); });
             }
             else
             {
-                for (uint32_t i : dirtyRows)
-                    processRow(i);
+                processRange(0u, count);
             }
         }
     }
 
 private:
+    // Lanes per IntegrateVelocity4 call.
+    static constexpr uint32_t BATCH = 4;
+
+    // Write back one integrated lane: velocity (clamped), then the step unless it is negligible,
+    // blocked by the navgrid or produces a non-finite position.
+    void applyLane(Engine::ECS::ECSContext &ecs, Engine::ECS::ArchetypeStore &store, uint32_t archetypeId, uint32_t i,
+                   float vx, float vy, float vz, float dx, float dy, float dz)
+    {
+        auto &pos = store.positions()[i];
+        auto &vel = store.velocities()[i];
+        vel.x = vx;
+        vel.y = vy;
+        vel.z = vz;
+
+        const float velMag1 = std::fabs(vx) + std::fabs(vy) + std::fabs(vz);
+        if (velMag1 <= 1e-6f)
+            return;
+
+        if (!std::isfinite(dx) || !std::isfinite(dy) || !std::isfinite(dz))
+        {
+            vel.x = vel.y = vel.z = 0.0f;
+            ecs.markDirty(m_velocityId, archetypeId, i);
+            return;
+        }
+
+        const float oldX = pos.x;
+        const float oldY = pos.y;
+        const float oldZ = pos.z;
+
+        const float newX = oldX + dx;
+        const float newZ = oldZ + dz;
+
+        if (m_cfg.enforceNavGridCollision && m_navGrid)
+        {
+            // Prevent moving through blocked cells. This is the "hard constraint" that makes
+            // obstacles reliably blocking even if steering/avoidance pushes into them.
+            if (!m_navGrid->lineCheck(oldX, oldZ, newX, newZ))
+            {
+                vel.x = vel.y = vel.z = 0.0f;
+                ecs.markDirty(m_velocityId, archetypeId, i);
+
+                // Trigger replanning if this mover has a goal.
+                if (store.hasMoveTarget())
+                    ecs.markDirty(m_moveTargetId, archetypeId, i);
+                return;
+            }
+        }
+
+        pos.x = newX;
+        pos.y = oldY + dy;
+        pos.z = newZ;
+
+        if (!std::isfinite(pos.x) || !std::isfinite(pos.y) || !std::isfinite(pos.z))
+        {
+            pos.x = oldX;
+            pos.y = oldY;
+            pos.z = oldZ;
+            vel.x = vel.y = vel.z = 0.0f;
+            ecs.markDirty(m_velocityId, archetypeId, i);
+            ecs.markDirty(m_positionId, archetypeId, i);
+            return;
+        }
+
+        ecs.markDirty(m_positionId, archetypeId, i);
+
+        // Keep movers active: movement must run every frame while velocity is non-zero.
+        ecs.markDirty(m_velocityId, archetypeId, i);
+    }
+
     Config m_cfg{};
     const NavGrid *m_navGrid = nullptr;
     Engine::ECS::QueryId m_queryId = Engine::ECS::QueryManager::InvalidQuery;
+    std::vector<uint32_t> m_dirtyRows; // consumeDirtyRows scratch, reused across stores and frames
     uint32_t m_positionId = Engine::ECS::ComponentRegistry::InvalidID;
     uint32_t m_velocityId = Engine::ECS::ComponentRegistry::InvalidID;
     uint32_t m_moveTargetId = Engine::ECS::ComponentRegistry::InvalidID;
@@ -6,12 +6,26 @@
     - Stores the 2D walkability grid (blocked/open).
     - Provides coordinate mapping between world space and grid space.
     - Used by PathfindingSystem to plan paths.
+
+  Storage:
+    - One bit per cell (blockedBits, bit i of the grid = cell gz * width + gx), so rows are
+      contiguous bit runs and a 1024x1024 grid is 128 KB. Line and rectangle tests check a whole
+      row span per 64-bit word instead of one cell at a time.
+
+  Clearance:
+    - blocked already includes a global inflation (NavGridBuilderSystem's extraInflation, kept
+      in `inflation`). clearance[] holds each cell's distance to the nearest blocked or
+      off-grid cell, so a unit with a larger Radius filters cells by clearanceFor(radius)
+      instead of everyone paying for the largest unit.
 */
 
 #include <algorithm>
 #include <cmath>
 #include <cstdint>
 #include <vector>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 class NavGrid
 {
@@ -22,12 +36,46 @@ public:
     int width = 0;
     int height = 0;
 
-    // 0 = walkable, 1 = blocked
-    std::vector<uint8_t> blocked;
+    // 1 bit per cell: 0 = walkable, 1 = blocked. Use isBlocked/setBlocked.
+    std::vector<uint64_t> blockedBits;
 
     // Dirty flag — set true when obstacles change; NavGridBuilderSystem clears it after rebuild.
     bool dirty = true;
 
+    // Change log for incremental consumers (NavHierarchy). Every change to blockedBits appends the
+    // grid-space rect it touched under a new revision; only the newest MAX_DIRTY_REGIONS are
+    // kept, and a consumer that falls further behind starts over. rebuild() bumps
+    // layoutRevision and clears the log (dimensions changed, nothing carries over).
+    struct DirtyRegion
+    {
+        int minX = 0;
+        int minZ = 0;
+        int maxX = 0; // inclusive
+        int maxZ = 0; // inclusive
+        uint32_t revision = 0;
+    };
+    static constexpr size_t MAX_DIRTY_REGIONS = 32;
+
+    uint32_t revision = 0;
+    uint32_t layoutRevision = 0;
+    std::vector<DirtyRegion> dirtyRegions;
+
+    // Newest revision that touched each REGION_CELLS x REGION_CELLS block, for consumers whose
+    // data depends on part of the grid only (PathCache validates a path against its bounds).
+    static constexpr int REGION_CELLS = 32;
+    int regionsX = 0;
+    int regionsZ = 0;
+    std::vector<uint32_t> regionRevision;
+
+    // Chamfer distance (2 per straight step, 3 per diagonal, i.e. CLEARANCE_STEPS_PER_CELL per
+    // cell) from each cell to the nearest blocked or off-grid cell; 0 = blocked. Capped at
+    // MAX_CLEARANCE. Empty until the first updateClearance().
+    static constexpr int CLEARANCE_STEPS_PER_CELL = 2;
+    static constexpr int MAX_CLEARANCE_CELLS = 16;
+    static constexpr uint8_t MAX_CLEARANCE = CLEARANCE_STEPS_PER_CELL * MAX_CLEARANCE_CELLS;
+    std::vector<uint8_t> clearance;
+    float inflation = 0.0f; // unit radius blocked[] already accounts for (meters)
+
     void rebuild(float cSize, float minX, float minZ, float maxX, float maxZ)
     {
         cellSize = (cSize > 0.1f) ? cSize : 2.0f;
@@ -45,46 +93,57 @@ public:
         if (height < 1)
             height = 1;
 
-        blocked.assign(static_cast<size_t>(width * height), 0);
+        blockedBits.assign((cellCount() + 63u) >> 6, 0ull);
+        clearance.clear();
         dirty = true;
+        ++layoutRevision;
+        dirtyRegions.clear();
+
+        regionsX = (width + REGION_CELLS - 1) / REGION_CELLS;
+        regionsZ = (height + REGION_CELLS - 1) / REGION_CELLS;
+        regionRevision.assign(static_cast<size_t>(regionsX) * regionsZ, revision);
     }
 
-    // Check if a straight line from (x0, z0) to (x1, z1) is clear of obstacles.
-    // Coordinates are in WORLD space.
-    bool lineCheck(float x0, float z0, float x1, float z1) const
+    // Record that cells in [minX..maxX] x [minZ..maxZ] changed walkability.
+    void logChangedRegion(int minX, int minZ, int maxX, int maxZ)
     {
-        int gx0 = worldToGridX(x0);
-        int gz0 = worldToGridZ(z0);
-        int gx1 = worldToGridX(x1);
-        int gz1 = worldToGridZ(z1);
+        ++revision;
+        if (dirtyRegions.size() >= MAX_DIRTY_REGIONS)
+            dirtyRegions.erase(dirtyRegions.begin());
+        dirtyRegions.push_back(DirtyRegion{minX, minZ, maxX, maxZ, revision});
 
-        int dx = std::abs(gx1 - gx0);
-        int dz = std::abs(gz1 - gz0);
-        int sx = (gx0 < gx1) ? 1 : -1;
-        int sz = (gz0 < gz1) ? 1 : -1;
-        int err = dx - dz;
+        const int rx0 = std::max(0, minX / REGION_CELLS), rx1 = std::min(regionsX - 1, maxX / REGION_CELLS);
+        const int rz0 = std::max(0, minZ / REGION_CELLS), rz1 = std::min(regionsZ - 1, maxZ / REGION_CELLS);
+        for (int rz = rz0; rz <= rz1; ++rz)
+            for (int rx = rx0; rx <= rx1; ++rx)
+                regionRevision[static_cast<size_t>(rz) * regionsX + rx] = revision;
+    }
 
-        while (true)
-        {
-            if (!isWalkable(gx0, gz0))
-                return false;
+    // Newest revision of any region overlapping [minX..maxX] x [minZ..maxZ].
+    uint32_t revisionIn(int minX, int minZ, int maxX, int maxZ) const
+    {
+        const int rx0 = std::max(0, minX / REGION_CELLS), rx1 = std::min(regionsX - 1, maxX / REGION_CELLS);
+        const int rz0 = std::max(0, minZ / REGION_CELLS), rz1 = std::min(regionsZ - 1, maxZ / REGION_CELLS);
+        uint32_t rev = 0;
+        for (int rz = rz0; rz <= rz1; ++rz)
+            for (int rx = rx0; rx <= rx1; ++rx)
+                rev = std::max(rev, regionRevision[static_cast<size_t>(rz) * regionsX + rx]);
+        return rev;
+    }
 
-            if (gx0 == gx1 && gz0 == gz1)
-                break;
+    // Check if a straight line from (x0, z0) to (x1, z1) is clear of obstacles.
+    // Coordinates are in WORLD space.
+    bool lineCheck(float x0, float z0, float x1, float z1) const
+    {
+        const int gx0 = worldToGridX(x0);
+        const int gz0 = worldToGridZ(z0);
+        const int gx1 = worldToGridX(x1);
+        const int gz1 = worldToGridZ(z1);
 
-            int e2 = 2 * err;
-            if (e2 > -dz)
-            {
-                err -= dz;
-                gx0 += sx;
-            }
-            if (e2 < dx)
-            {
-                err += dx;
-                gz0 += sz;
-            }
-        }
-        return true;
+        // Short moves (MovementSystem) usually sit in open space: one word per row of the box.
+        if (rectClear(std::min(gx0, gx1), std::min(gz0, gz1), std::max(gx0, gx1), std::max(gz0, gz1)))
+            return true;
+        return lineClear(gx0, gz0, gx1, gz1, false);
     }
 
     int worldToGridX(float wx) const
@@ -116,52 +175,208 @@ public:
     {
         if (!isValid(gx, gz))
             return false;
-        return blocked[gz * width + gx] == 0;
+        return !isBlocked(gz * width + gx);
     }
 
-    bool lineCheckGrid(int gx0, int gz0, int gx1, int gz1) const
+    size_t cellCount() const { return static_cast<size_t>(width) * static_cast<size_t>(height); }
+
+    // Heap bytes of the blocked bits, clearance field and change tracking.
+    uint64_t memoryBytes() const
     {
-        int dx = std::abs(gx1 - gx0);
-        int dz = std::abs(gz1 - gz0);
-        int sx = (gx0 < gx1) ? 1 : -1;
-        int sz = (gz0 < gz1) ? 1 : -1;
-        int err = dx - dz;
+        return blockedBits.capacity() * sizeof(uint64_t) + clearance.capacity() + m_clearanceScratch.capacity() +
+               regionRevision.capacity() * sizeof(uint32_t) + dirtyRegions.capacity() * sizeof(DirtyRegion);
+    }
 
-        while (true)
+    bool isBlocked(int cell) const
+    {
+        return (blockedBits[static_cast<size_t>(cell) >> 6] >> (cell & 63)) & 1ull;
+    }
+
+    void setBlocked(int cell, bool value)
+    {
+        const uint64_t bit = 1ull << (cell & 63);
+        uint64_t &word = blockedBits[static_cast<size_t>(cell) >> 6];
+        word = value ? (word | bit) : (word & ~bit);
+    }
+
+    void clearBlocked() { std::fill(blockedBits.begin(), blockedBits.end(), 0ull); }
+
+    // True if cells [x0..x1] of row gz are all inside the grid and walkable.
+    bool spanClear(int gz, int x0, int x1) const
+    {
+        if (gz < 0 || gz >= height || x0 < 0 || x1 >= width || x0 > x1)
+            return false;
+        const size_t first = static_cast<size_t>(gz) * width + x0;
+        const size_t last = static_cast<size_t>(gz) * width + x1;
+        const size_t w0 = first >> 6;
+        const size_t w1 = last >> 6;
+        const uint64_t lo = ~0ull << (first & 63);
+        const uint64_t hi = ~0ull >> (63 - (last & 63));
+        if (w0 == w1)
+            return (blockedBits[w0] & lo & hi) == 0;
+        if (blockedBits[w0] & lo)
+            return false;
+        for (size_t w = w0 + 1; w < w1; ++w)
         {
-            if (!isWalkable(gx0, gz0))
+            if (blockedBits[w])
                 return false;
-            if (gx0 == gx1 && gz0 == gz1)
-                break;
-            int e2 = 2 * err;
-            bool stepX = (e2 > -dz);
-            bool stepZ = (e2 < dx);
-
-            // Diagonal step: verify both cardinal corner cells are walkable.
-            // Without this, the line slips between diagonally-adjacent blocked
-            // cells and falsely reports "clear" — the same check A* already does
-            // in its neighbor expansion (blocked[idx(cx,nz)] || blocked[idx(nx,cz)]).
-            if (stepX && stepZ)
+        }
+        return (blockedBits[w1] & hi) == 0;
+    }
+
+    // True if every cell of [minX..maxX] x [minZ..maxZ] is inside the grid and walkable.
+    bool rectClear(int minX, int minZ, int maxX, int maxZ) const
+    {
+        if (minZ > maxZ)
+            return false;
+        for (int gz = minZ; gz <= maxZ; ++gz)
+        {
+            if (!spanClear(gz, minX, maxX))
+                return false;
+        }
+        return true;
+    }
+
+    // Calls fn(bitIndex) for every set bit of words, in order (diffing two grids' bits).
+    template <typename Fn>
+    static void forEachSetBit(const std::vector<uint64_t> &words, const Fn &fn)
+    {
+        for (size_t w = 0; w < words.size(); ++w)
+        {
+            uint64_t word = words[w];
+            while (word)
             {
-                if (!isWalkable(gx0 + sx, gz0) || !isWalkable(gx0, gz0 + sz))
-                    return false;
+#ifdef _MSC_VER
+                unsigned long bit;
+                _BitScanForward64(&bit, word);
+#else
+                const int bit = __builtin_ctzll(word);
+#endif
+                fn(static_cast<int>(w * 64u + bit));
+                word &= word - 1ull;
             }
+        }
+    }
 
-            if (stepX)
+    // Grid-space line test that also rejects diagonal steps squeezing between two blocked
+    // corner cells (the same rule A* applies to its diagonal neighbors).
+    bool lineCheckGrid(int gx0, int gz0, int gx1, int gz1) const
+    {
+        return lineClear(gx0, gz0, gx1, gz1, true);
+    }
+
+    // lineCheckGrid for a unit needing minClearance (clearanceFor): every cell the line touches
+    // must be at least that far from obstacles.
+    bool lineCheckGrid(int gx0, int gz0, int gx1, int gz1, uint8_t minClearance) const
+    {
+        if (minClearance == 0)
+            return lineCheckGrid(gx0, gz0, gx1, gz1);
+        return walkCells(gx0, gz0, gx1, gz1, true, [&](int x, int z)
+                         { return fits(x, z, minClearance); });
+    }
+
+    // Clearance a unit of this radius needs beyond what `inflation` covers (0 = any walkable
+    // cell). A walkable cell next to a blocked one is about half a cell from its edge.
+    uint8_t clearanceFor(float unitRadius) const
+    {
+        const float extra = unitRadius - inflation;
+        if (!(extra > 0.0f) || clearance.empty())
+            return 0;
+        const float steps = std::ceil((extra / cellSize + 0.5f) * CLEARANCE_STEPS_PER_CELL);
+        return static_cast<uint8_t>(std::min(steps, static_cast<float>(MAX_CLEARANCE)));
+    }
+
+    bool fits(int gx, int gz, uint8_t minClearance) const
+    {
+        if (minClearance == 0)
+            return isWalkable(gx, gz);
+        return isValid(gx, gz) && clearance[gz * width + gx] >= minClearance;
+    }
+
+    // Recomputes clearance for cells whose value can depend on [minX..maxX] x [minZ..maxZ]
+    // (cells that changed walkability). The first call, or a layout change, computes it all.
+    void updateClearance(int minX, int minZ, int maxX, int maxZ)
+    {
+        if (clearance.size() != cellCount())
+        {
+            clearance.assign(cellCount(), 0);
+            minX = 0;
+            minZ = 0;
+            maxX = width - 1;
+            maxZ = height - 1;
+        }
+
+        // Values are capped at MAX_CLEARANCE_CELLS, so a change reaches that far, and the
+        // cells there see obstacles up to that far again.
+        const int K = MAX_CLEARANCE_CELLS;
+        const int tx0 = std::max(0, minX - K), tz0 = std::max(0, minZ - K);
+        const int tx1 = std::min(width - 1, maxX + K), tz1 = std::min(height - 1, maxZ + K);
+        if (tx0 > tx1 || tz0 > tz1)
+            return;
+        const int wx0 = std::max(0, tx0 - K), wz0 = std::max(0, tz0 - K);
+        const int wx1 = std::min(width - 1, tx1 + K), wz1 = std::min(height - 1, tz1 + K);
+        const int ww = wx1 - wx0 + 1;
+        const int wh = wz1 - wz0 + 1;
+
+        m_clearanceScratch.resize(static_cast<size_t>(ww) * wh);
+        uint8_t *d = m_clearanceScratch.data();
+        for (int z = 0; z < wh; ++z)
+            for (int x = 0; x < ww; ++x)
+                d[z * ww + x] = isBlocked((wz0 + z) * width + wx0 + x) ? 0 : MAX_CLEARANCE;
+
+        // Outside the window: off-grid counts as blocked, in-grid cells as unconstrained.
+        auto at = [&](int x, int z) -> int
+        {
+            if (x >= 0 && x < ww && z >= 0 && z < wh)
+                return d[z * ww + x];
+            return isValid(wx0 + x, wz0 + z) ? MAX_CLEARANCE : 0;
+        };
+        auto relax = [&](int x, int z, int v)
+        {
+            uint8_t &c = d[z * ww + x];
+            if (v < c)
+                c = static_cast<uint8_t>(v);
+        };
+
+        for (int z = 0; z < wh; ++z)
+        {
+            for (int x = 0; x < ww; ++x)
             {
-                err -= dz;
-                gx0 += sx;
+                if (d[z * ww + x] == 0)
+                    continue;
+                relax(x, z, at(x - 1, z) + 2);
+                relax(x, z, at(x - 1, z - 1) + 3);
+                relax(x, z, at(x, z - 1) + 2);
+                relax(x, z, at(x + 1, z - 1) + 3);
             }
-            if (stepZ)
+        }
+        for (int z = wh - 1; z >= 0; --z)
+        {
+            for (int x = ww - 1; x >= 0; --x)
             {
-                err += dx;
-                gz0 += sz;
+                if (d[z * ww + x] == 0)
+                    continue;
+                relax(x, z, at(x + 1, z) + 2);
+                relax(x, z, at(x + 1, z + 1) + 3);
+                relax(x, z, at(x, z + 1) + 2);
+                relax(x, z, at(x - 1, z + 1) + 3);
             }
         }
-        return true;
+
+        for (int gz = tz0; gz <= tz1; ++gz)
+            std::copy(d + (gz - wz0) * ww + (tx0 - wx0), d + (gz - wz0) * ww + (tx1 - wx0) + 1,
+                      clearance.begin() + static_cast<size_t>(gz) * width + tx0);
     }
 
     void markObstacle(float wx, float wz, float radius)
+    {
+        forEachObstacleCell(wx, wz, radius, [this](int cell)
+                            { setBlocked(cell, true); });
+    }
+
+    // Calls fn(cellIndex) for every cell markObstacle() would block.
+    template <typename Fn>
+    void forEachObstacleCell(float wx, float wz, float radius, const Fn &fn) const
     {
         int gxMin = worldToGridX(wx - radius);
         int gxMax = worldToGridX(wx + radius);
@@ -183,9 +398,88 @@ public:
                 float dz = cz - wz;
                 if (dx * dx + dz * dz <= radius * radius)
                 {
-                    blocked[gz * width + gx] = 1;
+                    fn(gz * width + gx);
                 }
             }
         }
     }
+
+private:
+    std::vector<uint8_t> m_clearanceScratch;
+
+    // Bresenham walk from (gx0, gz0) to (gx1, gz1), calling ok(x, z) per cell (and on both
+    // cardinal cells of a diagonal step with cornerCheck) until one fails.
+    template <typename Ok>
+    static bool walkCells(int gx0, int gz0, int gx1, int gz1, bool cornerCheck, const Ok &ok)
+    {
+        const int dx = std::abs(gx1 - gx0);
+        const int dz = std::abs(gz1 - gz0);
+        const int sx = (gx0 < gx1) ? 1 : -1;
+        const int sz = (gz0 < gz1) ? 1 : -1;
+        int err = dx - dz;
+
+        while (true)
+        {
+            if (!ok(gx0, gz0))
+                return false;
+            if (gx0 == gx1 && gz0 == gz1)
+                return true;
+            const int e2 = 2 * err;
+            const bool stepX = (e2 > -dz);
+            const bool stepZ = (e2 < dx);
+            if (cornerCheck && stepX && stepZ)
+            {
+                if (!ok(gx0 + sx, gz0) || !ok(gx0, gz0 + sz))
+                    return false;
+            }
+            if (stepX)
+            {
+                err -= dz;
+                gx0 += sx;
+            }
+            if (stepZ)
+            {
+                err += dx;
+                gz0 += sz;
+            }
+        }
+    }
+
+    // Bresenham walk from (gx0, gz0) to (gx1, gz1). On shallow lines the cells visited in one
+    // row are contiguous, so each row is tested as one span when the walk leaves it; steep lines
+    // touch one or two cells per row and test them directly. cornerCheck adds both cardinal
+    // cells of every diagonal step (lineCheckGrid).
+    bool lineClear(int gx0, int gz0, int gx1, int gz1, bool cornerCheck) const
+    {
+        const int dx = std::abs(gx1 - gx0);
+        const int dz = std::abs(gz1 - gz0);
+        const int sx = (gx0 < gx1) ? 1 : -1;
+        const int sz = (gz0 < gz1) ? 1 : -1;
+        int err = dx - dz;
+
+        if (dx <= dz)
+        {
+            return walkCells(gx0, gz0, gx1, gz1, cornerCheck, [this](int x, int z)
+                             { return isWalkable(x, z); });
+        }
+
+        int runStart = gx0;
+        while (gx0 != gx1)
+        {
+            const int e2 = 2 * err;
+            err -= dz;
+            if (e2 < dx)
+            {
+                // Leaving the row: it spans runStart..gx0, plus the corner cell ahead.
+                const int runEnd = cornerCheck ? gx0 + sx : gx0;
+                if (!spanClear(gz0, std::min(runStart, runEnd), std::max(runStart, runEnd)))
+                    return false;
+                err += dx;
+                gz0 += sz;
+                runStart = cornerCheck ? gx0 : gx0 + sx;
+            }
+            gx0 += sx;
+        }
+        return spanClear(gz0, std::min(runStart, gx0), std::max(runStart, gx0));
+    }
 };
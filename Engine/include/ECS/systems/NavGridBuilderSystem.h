@@ -5,68 +5,452 @@
   Purpose:
     - Scans all entities with Obstacle + ObstacleRadius components.
     - Marks their blocked cells in the NavGrid.
-    - Runs ONCE at init (or on demand), not every frame ideally.
+    - Full rasterization only when NavGrid::dirty is set (first run, layout change). After that
+      only obstacles that were added, removed, moved or resized are re-rasterized.
+
+  Incremental updates:
+    - Every cell keeps a coverage count (how many obstacle footprints block it), so removing
+      one obstacle unblocks exactly the cells nobody else covers.
+    - Each obstacle's last rasterized footprint is remembered per entity. Moves/resizes come
+      from a dirty query on Position/ObstacleRadius; adds/removes are found by reconciling the
+      obstacle stores whenever one of them changed structurally.
+    - Every changed footprint is logged on the NavGrid (logChangedRegion), so NavHierarchy,
+      FlowFieldCache and PathCache only refresh what it touches. A full rasterization diffs
+      against the previous grid and logs the bounding rect of the change.
+    - A footprint removed and added again in one update (the editor clears and respawns the
+      world on every placement edit) cancels out: only obstacles that really changed are logged.
+    - NavGrid::clearance is refreshed around every logged rect (or fully after the first build),
+      so it matches the grid revision PathfindingSystem plans on.
+
+  Amortized work:
+    - One unit is one moved/resized obstacle re-rasterized. Under a work budget (SystemScheduler)
+      the rest are held by entity and go first next update; a reconcile pass or full rebuild
+      syncs everything and drops them.
 */
 
 #include "ECS/SystemFormat.h"
 #include "ECS/systems/NavGrid.h"
 
 #include <algorithm>
+#include <cstdint>
+#include <tuple>
+#include <vector>
 
 class NavGridBuilderSystem : public Engine::ECS::SystemBase
 {
 public:
+    // =====================
+    // TUNING CONSTANTS
+    // =====================
+    static constexpr uint32_t MAX_LOGGED_REGIONS_PER_UPDATE = 8; // more changes are logged as one rect
+
     struct Config
     {
         // Extra radius inflation beyond ObstacleRadius.
         // (Sample can set this to keep units from clipping on coarse grids.)
+        // Units with a larger Radius avoid narrow gaps through NavGrid::clearance instead.
         float extraInflation = 0.0f;
     };
 
+    struct Stats
+    {
+        bool fullRebuild = false;
+        uint32_t obstaclesAdded = 0;
+        uint32_t obstaclesRemoved = 0;
+        uint32_t obstaclesMoved = 0;
+        uint32_t cellsChanged = 0; // walkability flips
+        uint32_t obstaclesSynced = 0; // dirty obstacles checked (work units)
+        uint32_t obstaclesHeld = 0;   // over the work budget, left for the next update
+    };
+
     NavGridBuilderSystem(NavGrid *grid)
         : m_grid(grid)
     {
         setRequiredNames({"Position", "Obstacle", "ObstacleRadius"});
         setExcludedNames({"Disabled", "Dead"});
+        setReadNames({"Position", "Obstacle", "ObstacleRadius"});
+        setWriteNames({"NavGrid"});
     }
 
     const char *name() const override { return "NavGridBuilderSystem"; }
 
-    void setConfig(const Config &cfg) { m_cfg = cfg; }
+    void setConfig(const Config &cfg)
+    {
+        if (cfg.extraInflation != m_cfg.extraInflation && m_grid)
+            m_grid->dirty = true; // every footprint changes
+        m_cfg = cfg;
+    }
+
+    const Stats &lastStats() const { return m_lastStats; }
+
+    bool isAmortized() const override { return true; }
+    uint32_t workRemaining() const override { return m_lastStats.obstaclesSynced + m_lastStats.obstaclesHeld; }
+    uint32_t workDone() const override { return m_lastStats.obstaclesSynced; }
+
+    void buildMasks(Engine::ECS::ComponentRegistry &registry) override
+    {
+        Engine::ECS::SystemBase::buildMasks(registry);
+        m_positionId = registry.ensureId("Position");
+        m_obstacleRadiusId = registry.ensureId("ObstacleRadius");
+        m_queryId = Engine::ECS::QueryManager::InvalidQuery;
+    }
 
     void update(Engine::ECS::ECSContext &ecs, float /*dt*/) override
     {
         if (!m_grid)
             return;
 
-        if (!m_grid->dirty)
+        if (m_queryId == Engine::ECS::QueryManager::InvalidQuery)
+        {
+            Engine::ECS::ComponentMask dirty;
+            dirty.set(m_positionId);
+            dirty.set(m_obstacleRadiusId);
+            m_queryId = ecs.queries.createDirtyQuery(required(), excluded(), dirty, ecs.stores);
+        }
+
+        m_lastStats = Stats{};
+        const auto &q = ecs.queries.get(m_queryId);
+
+        if (m_grid->dirty || m_coverage.size() != m_grid->cellCount())
+        {
+            m_held.clear();
+            fullRebuild(ecs, q.matchingArchetypeIds);
+            m_grid->dirty = false;
             return;
+        }
 
-        std::fill(m_grid->blocked.begin(), m_grid->blocked.end(), 0);
+        // Structural changes (spawn, despawn, Dead/Disabled tags) need a reconcile pass;
+        // otherwise only rows whose Position/ObstacleRadius were marked dirty are checked.
+        bool structural = (m_storeVersions.size() != q.matchingArchetypeIds.size());
+        m_storeVersions.resize(q.matchingArchetypeIds.size(), UINT32_MAX);
+        for (size_t m = 0; m < q.matchingArchetypeIds.size(); ++m)
+        {
+            const Engine::ECS::ArchetypeStore *store = ecs.stores.get(q.matchingArchetypeIds[m]);
+            const uint32_t v = store ? store->structuralVersion() : 0u;
+            if (m_storeVersions[m] != v)
+            {
+                m_storeVersions[m] = v;
+                structural = true;
+            }
+        }
 
-        for (const auto &ptr : ecs.stores.stores())
+        m_changes.clear();
+        if (structural)
         {
-            if (!ptr)
-                continue;
-            auto &store = *ptr;
+            m_held.clear();
+            ++m_stamp;
+            for (uint32_t archetypeId : q.matchingArchetypeIds)
+            {
+                ecs.queries.discardDirtyRows(m_queryId, archetypeId);
+                const Engine::ECS::ArchetypeStore *store = ecs.stores.get(archetypeId);
+                if (!store)
+                    continue;
+                for (uint32_t row = 0; row < store->size(); ++row)
+                    syncObstacle(*store, row);
+            }
+            for (uint32_t index = 0; index < m_records.size(); ++index)
+            {
+                ObstacleRecord &rec = m_records[index];
+                if (rec.present && rec.stamp != m_stamp)
+                {
+                    rasterize(rec, -1);
+                    m_changes.push_back(removedChange(rec));
+                    rec.present = false;
+                    ++m_lastStats.obstaclesRemoved;
+                }
+            }
+        }
+        else
+        {
+            ++m_stamp;
+            uint32_t budgetLeft = workBudget();
+            auto sync = [&](const Engine::ECS::ArchetypeStore &store, uint32_t row)
+            {
+                if (budgetLeft == 0)
+                {
+                    m_held.push_back(store.entities()[row]);
+                    ++m_lastStats.obstaclesHeld;
+                    return;
+                }
+                if (budgetLeft != UNLIMITED_WORK)
+                    --budgetLeft;
+                syncObstacle(store, row);
+                ++m_lastStats.obstaclesSynced;
+            };
 
-            if (!store.signature().containsAll(required()))
-                continue;
-            if (!store.signature().containsNone(excluded()))
+            // Held last update: no spawn or despawn since (that would be structural), so they
+            // are all still obstacles of the matching stores.
+            m_heldScratch.swap(m_held);
+            m_held.clear();
+            for (const Engine::ECS::Entity e : m_heldScratch)
+            {
+                const Engine::ECS::EntityRecord *rec = ecs.entities.find(e);
+                const Engine::ECS::ArchetypeStore *store = rec ? ecs.stores.get(rec->archetypeId) : nullptr;
+                if (store && rec->row < store->size())
+                    sync(*store, rec->row);
+            }
+            m_heldScratch.clear();
+
+            for (uint32_t archetypeId : q.matchingArchetypeIds)
+            {
+                const Engine::ECS::ArchetypeStore *store = ecs.stores.get(archetypeId);
+                if (!store)
+                    continue;
+                ecs.queries.forEachDirtyRow(m_queryId, archetypeId, [&](uint32_t row)
+                                            {
+                                                if (row < store->size())
+                                                    sync(*store, row);
+                                            });
+            }
+        }
+
+        logChanges();
+    }
+
+private:
+    struct CellRect
+    {
+        int minX = 0, minZ = 0, maxX = -1, maxZ = -1; // inclusive; empty when maxX < minX
+    };
+
+    // One footprint added (+1) or removed (-1) this update.
+    struct FootprintChange
+    {
+        CellRect rect;
+        float x = 0.0f, z = 0.0f, radius = 0.0f;
+        int delta = 0;
+    };
+
+    // What an obstacle entity last contributed to the coverage counts.
+    struct ObstacleRecord
+    {
+        uint32_t generation = 0;
+        bool present = false;
+        uint32_t stamp = 0;
+        float x = 0.0f, z = 0.0f, radius = 0.0f; // inflated
+        CellRect rect;
+    };
+
+    CellRect footprintRect(float x, float z, float radius) const
+    {
+        CellRect r;
+        r.minX = std::max(0, m_grid->worldToGridX(x - radius));
+        r.maxX = std::min(m_grid->width - 1, m_grid->worldToGridX(x + radius));
+        r.minZ = std::max(0, m_grid->worldToGridZ(z - radius));
+        r.maxZ = std::min(m_grid->height - 1, m_grid->worldToGridZ(z + radius));
+        return r;
+    }
+
+    // Add (+1) or remove (-1) the record's footprint from the coverage counts.
+    void rasterize(const ObstacleRecord &rec, int delta)
+    {
+        m_grid->forEachObstacleCell(rec.x, rec.z, rec.radius, [&](int cell)
+                                    {
+                                        uint16_t &c = m_coverage[cell];
+                                        if (delta > 0)
+                                        {
+                                            if (c == UINT16_MAX)
+                                                return;
+                                            if (c++ == 0)
+                                            {
+                                                m_grid->setBlocked(cell, true);
+                                                ++m_lastStats.cellsChanged;
+                                            }
+                                        }
+                                        else if (c > 0 && --c == 0)
+                                        {
+                                            m_grid->setBlocked(cell, false);
+                                            ++m_lastStats.cellsChanged;
+                                        }
+                                    });
+    }
+
+    static FootprintChange removedChange(const ObstacleRecord &rec)
+    {
+        return FootprintChange{rec.rect, rec.x, rec.z, rec.radius, -1};
+    }
+
+    // Drops footprints that were removed and added again unchanged: their cells' coverage
+    // is back where it started. Equal (x, z, radius) means the same cells were stamped.
+    void cancelRestampedChanges()
+    {
+        if (m_changes.size() < 2)
+            return;
+        auto key = [](const FootprintChange &c)
+        { return std::make_tuple(c.x, c.z, c.radius); };
+        std::sort(m_changes.begin(), m_changes.end(), [&](const FootprintChange &a, const FootprintChange &b)
+                  { return key(a) < key(b); });
+        size_t kept = 0;
+        for (size_t i = 0; i < m_changes.size();)
+        {
+            size_t j = i;
+            int net = 0;
+            for (; j < m_changes.size() && key(m_changes[j]) == key(m_changes[i]); ++j)
+                net += m_changes[j].delta;
+            if (net != 0)
+                m_changes[kept++] = m_changes[i];
+            i = j;
+        }
+        m_changes.resize(kept);
+    }
+
+    // Brings the record of the obstacle at row up to date (add or move); stamps it as seen.
+    void syncObstacle(const Engine::ECS::ArchetypeStore &store, uint32_t row)
+    {
+        const Engine::ECS::Entity e = store.entities()[row];
+        if (m_records.size() <= e.index)
+            m_records.resize(static_cast<size_t>(e.index) + 1u);
+        ObstacleRecord &rec = m_records[e.index];
+
+        const float x = store.positions()[row].x;
+        const float z = store.positions()[row].z;
+        const float radius = store.obstacleRadii()[row].r + m_cfg.extraInflation;
+
+        // A recycled index whose old entity was not reconciled yet.
+        if (rec.present && rec.generation != e.generation)
+        {
+            rasterize(rec, -1);
+            m_changes.push_back(removedChange(rec));
+            rec.present = false;
+            ++m_lastStats.obstaclesRemoved;
+        }
+
+        rec.stamp = m_stamp;
+        if (rec.present && rec.x == x && rec.z == z && rec.radius == radius)
+            return;
+
+        if (rec.present)
+        {
+            rasterize(rec, -1);
+            m_changes.push_back(removedChange(rec));
+            ++m_lastStats.obstaclesMoved;
+        }
+        else
+        {
+            ++m_lastStats.obstaclesAdded;
+        }
+
+        rec.generation = e.generation;
+        rec.present = true;
+        rec.x = x;
+        rec.z = z;
+        rec.radius = radius;
+        rec.rect = footprintRect(x, z, radius);
+        rasterize(rec, +1);
+        m_changes.push_back(FootprintChange{rec.rect, rec.x, rec.z, rec.radius, +1});
+    }
+
+    void fullRebuild(Engine::ECS::ECSContext &ecs, const std::vector<uint32_t> &archetypeIds)
+    {
+        m_lastStats.fullRebuild = true;
+
+        const bool canDiff = (m_prevBlocked.size() == m_grid->blockedBits.size()) &&
+                             (m_prevLayoutRevision == m_grid->layoutRevision);
+        m_prevBlocked = m_grid->blockedBits;
+        m_grid->clearBlocked();
+        m_coverage.assign(m_grid->cellCount(), 0u);
+        for (ObstacleRecord &rec : m_records)
+            rec.present = false;
+
+        ++m_stamp;
+        m_storeVersions.clear();
+        for (uint32_t archetypeId : archetypeIds)
+        {
+            ecs.queries.discardDirtyRows(m_queryId, archetypeId);
+            const Engine::ECS::ArchetypeStore *store = ecs.stores.get(archetypeId);
+            m_storeVersions.push_back(store ? store->structuralVersion() : 0u);
+            if (!store)
                 continue;
+            for (uint32_t row = 0; row < store->size(); ++row)
+                syncObstacle(*store, row);
+        }
+        m_changes.clear();
+
+        m_grid->inflation = m_cfg.extraInflation;
+        if (canDiff)
+            logFullDiff();
+        else
+            m_grid->updateClearance(0, 0, m_grid->width - 1, m_grid->height - 1);
+        m_prevLayoutRevision = m_grid->layoutRevision;
+    }
+
+    // Logs this update's footprints (old and new rects), merged into one when there are many.
+    void logChanges()
+    {
+        cancelRestampedChanges();
+        if (m_changes.empty())
+            return;
+
+        auto logRect = [&](const CellRect &r)
+        {
+            if (r.maxX >= r.minX && r.maxZ >= r.minZ)
+            {
+                m_grid->updateClearance(r.minX, r.minZ, r.maxX, r.maxZ);
+                m_grid->logChangedRegion(r.minX, r.minZ, r.maxX, r.maxZ);
+            }
+        };
 
-            auto &positions = store.positions();
-            auto &radii = store.obstacleRadii();
-            const uint32_t n = store.size();
+        if (m_changes.size() <= MAX_LOGGED_REGIONS_PER_UPDATE)
+        {
+            for (const FootprintChange &c : m_changes)
+                logRect(c.rect);
+            return;
+        }
 
-            for (uint32_t i = 0; i < n; ++i)
-                m_grid->markObstacle(positions[i].x, positions[i].z, radii[i].r + m_cfg.extraInflation);
+        CellRect all{m_grid->width, m_grid->height, -1, -1};
+        for (const FootprintChange &c : m_changes)
+        {
+            const CellRect &r = c.rect;
+            if (r.maxX < r.minX || r.maxZ < r.minZ)
+                continue;
+            all.minX = std::min(all.minX, r.minX);
+            all.minZ = std::min(all.minZ, r.minZ);
+            all.maxX = std::max(all.maxX, r.maxX);
+            all.maxZ = std::max(all.maxZ, r.maxZ);
         }
+        logRect(all);
+    }
+
+    // Bounding rect of cells whose value differs from the previous full build.
+    void logFullDiff()
+    {
+        const int W = m_grid->width;
+        for (size_t w = 0; w < m_prevBlocked.size(); ++w)
+            m_prevBlocked[w] ^= m_grid->blockedBits[w];
 
-        m_grid->dirty = false;
+        int minX = W, minZ = m_grid->height, maxX = -1, maxZ = -1;
+        NavGrid::forEachSetBit(m_prevBlocked, [&](int cell)
+                               {
+                                   const int gx = cell % W;
+                                   const int gz = cell / W;
+                                   minX = std::min(minX, gx);
+                                   maxX = std::max(maxX, gx);
+                                   minZ = std::min(minZ, gz);
+                                   maxZ = std::max(maxZ, gz);
+                               });
+        if (maxX >= 0)
+        {
+            m_grid->updateClearance(minX, minZ, maxX, maxZ);
+            m_grid->logChangedRegion(minX, minZ, maxX, maxZ);
+        }
     }
 
-private:
     Config m_cfg{};
+    Stats m_lastStats{};
     NavGrid *m_grid = nullptr;
+
+    Engine::ECS::QueryId m_queryId = Engine::ECS::QueryManager::InvalidQuery;
+    uint32_t m_positionId = Engine::ECS::ComponentRegistry::InvalidID;
+    uint32_t m_obstacleRadiusId = Engine::ECS::ComponentRegistry::InvalidID;
+
+    std::vector<uint16_t> m_coverage;        // per cell: obstacle footprints covering it
+    std::vector<ObstacleRecord> m_records;   // entity index -> last rasterized footprint
+    std::vector<uint32_t> m_storeVersions;   // per matching store: structuralVersion seen
+    std::vector<FootprintChange> m_changes;  // footprints touched this update
+    std::vector<Engine::ECS::Entity> m_held; // dirty obstacles over last update's work budget
+    std::vector<Engine::ECS::Entity> m_heldScratch;
+    uint32_t m_stamp = 0;
+
+    std::vector<uint64_t> m_prevBlocked;
+    uint32_t m_prevLayoutRevision = UINT32_MAX;
 };
@@ -0,0 +1,758 @@
+#pragma once
+/*
+  NavHierarchy.h
+  --------------
+  Purpose:
+    - Abstract graph over a NavGrid for hierarchical pathfinding (HPA*).
+    - The grid is split into CLUSTER_SIZE x CLUSTER_SIZE clusters. Where two neighboring clusters
+      share a run of walkable border cells, the run becomes one transition (short runs, at the
+      middle) or two (long runs, at both ends). Each transition adds one node on either side.
+    - Nodes of the same cluster are connected by their shortest in-cluster distance (Dijkstra
+      restricted to the cluster, same 8-neighbor/corner rules as PathfindingSystem's A*).
+
+  Usage:
+    - sync(grid, js) once per frame before queries: builds on first use or when the grid layout
+      changes; otherwise replays grid.dirtyRegions and rebuilds only the touched clusters.
+    - findAbstractPath(grid, startCell, goalCell, scratch, outCells) returns the cells of the
+      abstract route [start, node, ..., goal]; callers refine consecutive pairs with a grid A*
+      restricted to refineBounds(a, b).
+    - Queries are read-only and may run from several threads, each with its own QueryScratch.
+    - Units needing NavGrid clearance pass it to findAbstractPath: each node also remembers the
+      widest crossing of its border run (wideCell), nodes whose wideCell lacks the clearance
+      right now are skipped, and the route goes through wideCells instead.
+*/
+
+#include "ECS/systems/NavGrid.h"
+#include "utils/JobSystem.h"
+#include "utils/MemoryReport.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+class NavHierarchy
+{
+public:
+    // =====================
+    // TUNING CONSTANTS
+    // =====================
+    static constexpr int CLUSTER_SIZE = 16;            // cells per cluster side
+    static constexpr int MAX_SINGLE_ENTRANCE_LEN = 6;  // longer border runs get a transition at each end
+    static constexpr uint32_t PARALLEL_CLUSTER_THRESHOLD = 32;
+
+    static constexpr uint32_t InvalidNode = UINT32_MAX;
+    static constexpr float Unreachable = 1e30f;
+
+    struct Node
+    {
+        int cell = 0;         // grid index (z * width + x)
+        uint32_t cluster = 0; // cluster index (cz * clustersX + cx)
+        int wideCell = 0;     // cell of the same border run with the most clearance
+        uint8_t wideClearance = 0;
+        uint32_t firstEdge = 0;
+        uint32_t edgeCount = 0;
+    };
+
+    struct Edge
+    {
+        uint32_t to = 0;
+        float cost = 0.0f;
+    };
+
+    struct Rect
+    {
+        int minX = 0, minZ = 0, maxX = 0, maxZ = 0; // inclusive
+    };
+
+    // Per-thread query state (generation stamps avoid clearing between queries).
+    struct QueryScratch
+    {
+        uint32_t gen = 0;
+        std::vector<uint32_t> stamp;
+        std::vector<uint32_t> closed;
+        std::vector<float> g;
+        std::vector<uint32_t> parent;
+
+        struct HeapItem
+        {
+            uint32_t node;
+            float f;
+            bool operator>(const HeapItem &o) const { return f > o.f; }
+        };
+        std::vector<HeapItem> heap;
+
+        // Start/goal links into their clusters.
+        std::vector<float> localDist;   // CLUSTER_SIZE^2, scratch for cluster Dijkstra
+        std::vector<uint32_t> startNodes;
+        std::vector<float> startCost;
+        std::vector<uint32_t> goalNodes;
+        std::vector<float> goalCost;
+
+        // Cluster Dijkstra scratch.
+        std::vector<uint32_t> localStamp;
+        uint32_t localGen = 0;
+        std::vector<HeapItem> localHeap;
+
+        uint64_t memoryBytes() const
+        {
+            using Engine::MemoryReport;
+            return MemoryReport::bytesOf(stamp) + MemoryReport::bytesOf(closed) + MemoryReport::bytesOf(g) +
+                   MemoryReport::bytesOf(parent) + MemoryReport::bytesOf(heap) + MemoryReport::bytesOf(localDist) +
+                   MemoryReport::bytesOf(startNodes) + MemoryReport::bytesOf(startCost) +
+                   MemoryReport::bytesOf(goalNodes) + MemoryReport::bytesOf(goalCost) +
+                   MemoryReport::bytesOf(localStamp) + MemoryReport::bytesOf(localHeap);
+        }
+    };
+
+    bool ready() const { return m_built && !m_nodes.empty(); }
+    uint32_t nodeCount() const { return static_cast<uint32_t>(m_nodes.size()); }
+    uint32_t edgeCount() const { return static_cast<uint32_t>(m_edges.size()); }
+    uint32_t clustersX() const { return m_clustersX; }
+    uint32_t clustersZ() const { return m_clustersZ; }
+
+    // Debug/telemetry: clusters whose distance tables were recomputed by the last sync.
+    uint32_t lastClustersRebuilt() const { return m_lastClustersRebuilt; }
+
+    // Heap bytes of the graph, cluster tables and build scratch.
+    uint64_t memoryBytes() const
+    {
+        using Engine::MemoryReport;
+        uint64_t bytes = MemoryReport::bytesOf(m_clusters) + MemoryReport::bytesOf(m_borderX) +
+                         MemoryReport::bytesOf(m_borderZ) + MemoryReport::bytesOf(m_nodes) +
+                         MemoryReport::bytesOf(m_edges) + MemoryReport::bytesOf(m_clusterFirstNode) +
+                         MemoryReport::bytesOf(m_nodeOfCell);
+        for (const Cluster &c : m_clusters)
+            bytes += MemoryReport::bytesOf(c.cells) + MemoryReport::bytesOf(c.dist);
+        for (const auto &b : m_borderX)
+            bytes += MemoryReport::bytesOf(b);
+        for (const auto &b : m_borderZ)
+            bytes += MemoryReport::bytesOf(b);
+        for (const QueryScratch &s : m_buildScratch)
+            bytes += s.memoryBytes();
+        return bytes;
+    }
+
+    // Bring the graph up to date with the grid. Returns true if anything changed.
+    bool sync(const NavGrid &grid, Engine::JobSystem *js = nullptr)
+    {
+        m_lastClustersRebuilt = 0;
+        const bool layoutChanged = !m_built || grid.layoutRevision != m_layoutRevision ||
+                                   grid.width != m_width || grid.height != m_height;
+        if (layoutChanged)
+        {
+            build(grid, js);
+            return true;
+        }
+        if (grid.revision == m_revision)
+            return false;
+
+        // The log must still hold every revision after ours.
+        if (grid.dirtyRegions.empty() || grid.dirtyRegions.front().revision > m_revision + 1u)
+        {
+            build(grid, js);
+            return true;
+        }
+
+        std::vector<uint8_t> affected(m_clusters.size(), 0);
+        for (const NavGrid::DirtyRegion &r : grid.dirtyRegions)
+        {
+            if (r.revision <= m_revision)
+                continue;
+            // Transitions depend on the cells on both sides of a border: grow by one cell.
+            const int x0 = std::max(0, r.minX - 1) / CLUSTER_SIZE;
+            const int z0 = std::max(0, r.minZ - 1) / CLUSTER_SIZE;
+            const int x1 = std::min(m_width - 1, r.maxX + 1) / CLUSTER_SIZE;
+            const int z1 = std::min(m_height - 1, r.maxZ + 1) / CLUSTER_SIZE;
+            for (int cz = z0; cz <= z1; ++cz)
+                for (int cx = x0; cx <= x1; ++cx)
+                    affected[static_cast<size_t>(cz) * m_clustersX + cx] = 1;
+        }
+
+        // Borders touching an affected cluster.
+        for (uint32_t c = 0; c < m_clusters.size(); ++c)
+        {
+            if (!affected[c])
+                continue;
+            const uint32_t cx = c % m_clustersX;
+            const uint32_t cz = c / m_clustersX;
+            buildBorderX(grid, c);
+            buildBorderZ(grid, c);
+            if (cx > 0)
+                buildBorderX(grid, c - 1u);
+            if (cz > 0)
+                buildBorderZ(grid, c - m_clustersX);
+        }
+
+        // Affected clusters, plus neighbors whose node set changed through a shared border.
+        std::vector<uint32_t> rebuild;
+        for (uint32_t c = 0; c < m_clusters.size(); ++c)
+        {
+            if (affected[c])
+            {
+                rebuild.push_back(c);
+                continue;
+            }
+            std::vector<int> cells;
+            gatherClusterCells(c, cells);
+            if (cells != m_clusters[c].cells)
+                rebuild.push_back(c);
+        }
+        rebuildClusters(grid, rebuild, js);
+
+        flatten();
+        m_revision = grid.revision;
+        return true;
+    }
+
+    // Full rebuild.
+    void build(const NavGrid &grid, Engine::JobSystem *js = nullptr)
+    {
+        m_width = grid.width;
+        m_height = grid.height;
+        m_clustersX = static_cast<uint32_t>((grid.width + CLUSTER_SIZE - 1) / CLUSTER_SIZE);
+        m_clustersZ = static_cast<uint32_t>((grid.height + CLUSTER_SIZE - 1) / CLUSTER_SIZE);
+        const uint32_t clusterCount = m_clustersX * m_clustersZ;
+
+        m_clusters.assign(clusterCount, Cluster{});
+        m_borderX.assign(clusterCount, {});
+        m_borderZ.assign(clusterCount, {});
+        m_nodeOfCell.assign(static_cast<size_t>(grid.width) * grid.height, InvalidNode);
+        m_nodes.clear();
+        m_edges.clear();
+
+        for (uint32_t c = 0; c < clusterCount; ++c)
+        {
+            buildBorderX(grid, c);
+            buildBorderZ(grid, c);
+        }
+
+        std::vector<uint32_t> all(clusterCount);
+        for (uint32_t c = 0; c < clusterCount; ++c)
+            all[c] = c;
+        rebuildClusters(grid, all, js);
+
+        flatten();
+        m_layoutRevision = grid.layoutRevision;
+        m_revision = grid.revision;
+        m_built = true;
+    }
+
+    uint32_t clusterOfCell(int cell) const
+    {
+        const int x = cell % m_width;
+        const int z = cell / m_width;
+        return static_cast<uint32_t>(z / CLUSTER_SIZE) * m_clustersX + static_cast<uint32_t>(x / CLUSTER_SIZE);
+    }
+
+    Rect clusterRect(uint32_t cluster) const
+    {
+        const int cx = static_cast<int>(cluster % m_clustersX);
+        const int cz = static_cast<int>(cluster / m_clustersX);
+        Rect r;
+        r.minX = cx * CLUSTER_SIZE;
+        r.minZ = cz * CLUSTER_SIZE;
+        r.maxX = std::min(m_width, r.minX + CLUSTER_SIZE) - 1;
+        r.maxZ = std::min(m_height, r.minZ + CLUSTER_SIZE) - 1;
+        return r;
+    }
+
+    // Search bounds for refining abstract hop a -> b: the union of both cells' clusters.
+    Rect refineBounds(int cellA, int cellB) const
+    {
+        const Rect a = clusterRect(clusterOfCell(cellA));
+        const Rect b = clusterRect(clusterOfCell(cellB));
+        return Rect{std::min(a.minX, b.minX), std::min(a.minZ, b.minZ), std::max(a.maxX, b.maxX), std::max(a.maxZ, b.maxZ)};
+    }
+
+    // A* over the abstract graph. startCell/goalCell must be walkable and in different clusters.
+    // outCells = [startCell, node cells..., goalCell]. Returns false when no route exists.
+    // minClearance > 0 restricts the route to nodes whose wideCell fits and returns those.
+    bool findAbstractPath(const NavGrid &grid, int startCell, int goalCell, QueryScratch &s, std::vector<int> &outCells,
+                          uint8_t minClearance = 0) const
+    {
+        outCells.clear();
+        if (!ready())
+            return false;
+
+        linkToCluster(grid, startCell, s, s.startNodes, s.startCost);
+        linkToCluster(grid, goalCell, s, s.goalNodes, s.goalCost);
+        if (s.startNodes.empty() || s.goalNodes.empty())
+            return false;
+
+        // Virtual nodes: N = start, N + 1 = goal.
+        const uint32_t N = static_cast<uint32_t>(m_nodes.size());
+        const uint32_t startId = N;
+        const uint32_t goalId = N + 1u;
+        const size_t total = static_cast<size_t>(N) + 2u;
+        if (s.stamp.size() < total)
+        {
+            s.stamp.resize(total, 0u);
+            s.closed.resize(total, 0u);
+            s.g.resize(total, Unreachable);
+            s.parent.resize(total, InvalidNode);
+        }
+        if (++s.gen == 0u)
+        {
+            std::fill(s.stamp.begin(), s.stamp.end(), 0u);
+            std::fill(s.closed.begin(), s.closed.end(), 0u);
+            s.gen = 1u;
+        }
+
+        const int W = m_width;
+        const int goalX = goalCell % W;
+        const int goalZ = goalCell / W;
+        auto h = [&](int cell)
+        {
+            const int dx = std::abs(cell % W - goalX);
+            const int dz = std::abs(cell / W - goalZ);
+            return static_cast<float>(std::max(dx, dz)) + 0.414f * static_cast<float>(std::min(dx, dz));
+        };
+        auto getG = [&](uint32_t n)
+        { return (s.stamp[n] == s.gen) ? s.g[n] : Unreachable; };
+        auto relax = [&](uint32_t n, float g, uint32_t from, int cell)
+        {
+            if (s.closed[n] == s.gen || g >= getG(n))
+                return;
+            if (minClearance != 0 && n < N && !grid.fits(m_nodes[n].wideCell % W, m_nodes[n].wideCell / W, minClearance))
+                return;
+            s.stamp[n] = s.gen;
+            s.g[n] = g;
+            s.parent[n] = from;
+            s.heap.push_back({n, g + h(cell)});
+            std::push_heap(s.heap.begin(), s.heap.end(), std::greater<QueryScratch::HeapItem>{});
+        };
+
+        s.heap.clear();
+        s.stamp[startId] = s.gen;
+        s.g[startId] = 0.0f;
+        s.parent[startId] = InvalidNode;
+        s.heap.push_back({startId, h(startCell)});
+
+        // Goal links, indexed by node for the expansion below.
+        auto goalLinkCost = [&](uint32_t node) -> float
+        {
+            for (size_t i = 0; i < s.goalNodes.size(); ++i)
+                if (s.goalNodes[i] == node)
+                    return s.goalCost[i];
+            return Unreachable;
+        };
+
+        bool found = false;
+        while (!s.heap.empty())
+        {
+            std::pop_heap(s.heap.begin(), s.heap.end(), std::greater<QueryScratch::HeapItem>{});
+            const uint32_t cur = s.heap.back().node;
+            s.heap.pop_back();
+            if (s.closed[cur] == s.gen)
+                continue;
+            s.closed[cur] = s.gen;
+
+            if (cur == goalId)
+            {
+                found = true;
+                break;
+            }
+
+            const float g = s.g[cur];
+            if (cur == startId)
+            {
+                for (size_t i = 0; i < s.startNodes.size(); ++i)
+                    relax(s.startNodes[i], g + s.startCost[i], cur, m_nodes[s.startNodes[i]].cell);
+                continue;
+            }
+
+            const Node &node = m_nodes[cur];
+            for (uint32_t e = node.firstEdge; e < node.firstEdge + node.edgeCount; ++e)
+                relax(m_edges[e].to, g + m_edges[e].cost, cur, m_nodes[m_edges[e].to].cell);
+            if (node.cluster == clusterOfCell(goalCell))
+            {
+                const float toGoal = goalLinkCost(cur);
+                if (toGoal < Unreachable)
+                    relax(goalId, g + toGoal, cur, goalCell);
+            }
+        }
+        if (!found)
+            return false;
+
+        for (uint32_t n = goalId; n != InvalidNode; n = s.parent[n])
+            outCells.push_back(n == goalId ? goalCell : (n == startId ? startCell : (minClearance ? m_nodes[n].wideCell : m_nodes[n].cell)));
+        std::reverse(outCells.begin(), outCells.end());
+        return true;
+    }
+
+private:
+    struct Transition
+    {
+        int cellA; // in the lower cluster (-X / -Z side)
+        int cellB; // in the upper cluster
+        int wideA; // widest crossing of the same border run (NavGrid::clearance)
+        int wideB;
+        uint8_t wideClearance;
+    };
+
+    struct Cluster
+    {
+        std::vector<int> cells;  // node cells, ascending
+        std::vector<float> dist; // cells.size()^2 in-cluster distances (Unreachable if none)
+    };
+
+    // Transitions of the border between cluster c and its +X neighbor.
+    void buildBorderX(const NavGrid &grid, uint32_t c)
+    {
+        auto &out = m_borderX[c];
+        out.clear();
+        const uint32_t cx = c % m_clustersX;
+        if (cx + 1u >= m_clustersX)
+            return;
+        const Rect r = clusterRect(c);
+        const int xa = r.maxX;
+        const int xb = r.maxX + 1;
+        scanBorder(r.minZ, r.maxZ, [&](int z)
+                   { return grid.isWalkable(xa, z) && grid.isWalkable(xb, z); },
+                   [&](int z, int runStart, int runEnd)
+                   {
+                       int wide = z;
+                       const uint8_t c = widest(grid, runStart, runEnd, z, [&](int i)
+                                                { return std::array<int, 2>{i * m_width + xa, i * m_width + xb}; }, wide);
+                       out.push_back(Transition{z * m_width + xa, z * m_width + xb, wide * m_width + xa, wide * m_width + xb, c});
+                   });
+    }
+
+    // Transitions of the border between cluster c and its +Z neighbor.
+    void buildBorderZ(const NavGrid &grid, uint32_t c)
+    {
+        auto &out = m_borderZ[c];
+        out.clear();
+        const uint32_t cz = c / m_clustersX;
+        if (cz + 1u >= m_clustersZ)
+            return;
+        const Rect r = clusterRect(c);
+        const int za = r.maxZ;
+        const int zb = r.maxZ + 1;
+        scanBorder(r.minX, r.maxX, [&](int x)
+                   { return grid.isWalkable(x, za) && grid.isWalkable(x, zb); },
+                   [&](int x, int runStart, int runEnd)
+                   {
+                       int wide = x;
+                       const uint8_t c = widest(grid, runStart, runEnd, x, [&](int i)
+                                                { return std::array<int, 2>{za * m_width + i, zb * m_width + i}; }, wide);
+                       out.push_back(Transition{za * m_width + x, zb * m_width + x, za * m_width + wide, zb * m_width + wide, c});
+                   });
+    }
+
+    // Position in [runStart, runEnd] whose cell pair (cellsAt(i)) has the most clearance on both
+    // sides; keeps `best` (the transition's own position) on ties. Returns that clearance.
+    template <typename CellsAt>
+    static uint8_t widest(const NavGrid &grid, int runStart, int runEnd, int best, const CellsAt &cellsAt, int &outPos)
+    {
+        outPos = best;
+        if (grid.clearance.empty())
+            return 0;
+        auto score = [&](int i)
+        {
+            const std::array<int, 2> cells = cellsAt(i);
+            return std::min(grid.clearance[cells[0]], grid.clearance[cells[1]]);
+        };
+        uint8_t bestScore = score(best);
+        for (int i = runStart; i <= runEnd; ++i)
+        {
+            const uint8_t c = score(i);
+            if (c > bestScore)
+            {
+                bestScore = c;
+                outPos = i;
+            }
+        }
+        return bestScore;
+    }
+
+    // Split [lo, hi] into runs of open positions; emit one transition per short run, two per long run.
+    template <typename Open, typename Emit>
+    static void scanBorder(int lo, int hi, const Open &open, const Emit &emit)
+    {
+        int runStart = -1;
+        for (int i = lo; i <= hi + 1; ++i)
+        {
+            const bool o = (i <= hi) && open(i);
+            if (o && runStart < 0)
+                runStart = i;
+            if (o || runStart < 0)
+                continue;
+
+            const int runEnd = i - 1;
+            if (runEnd - runStart + 1 < MAX_SINGLE_ENTRANCE_LEN)
+            {
+                emit((runStart + runEnd) / 2, runStart, runEnd);
+            }
+            else
+            {
+                emit(runStart, runStart, runEnd);
+                emit(runEnd, runStart, runEnd);
+            }
+            runStart = -1;
+        }
+    }
+
+    void gatherClusterCells(uint32_t c, std::vector<int> &cells) const
+    {
+        cells.clear();
+        for (const Transition &t : m_borderX[c])
+            cells.push_back(t.cellA);
+        for (const Transition &t : m_borderZ[c])
+            cells.push_back(t.cellA);
+        if (c % m_clustersX > 0)
+            for (const Transition &t : m_borderX[c - 1u])
+                cells.push_back(t.cellB);
+        if (c / m_clustersX > 0)
+            for (const Transition &t : m_borderZ[c - m_clustersX])
+                cells.push_back(t.cellB);
+        std::sort(cells.begin(), cells.end());
+        cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+    }
+
+    // Node cells + distance tables for the given clusters (parallel when there are many).
+    void rebuildClusters(const NavGrid &grid, const std::vector<uint32_t> &clusters, Engine::JobSystem *js)
+    {
+        m_lastClustersRebuilt = static_cast<uint32_t>(clusters.size());
+        const uint32_t scratchCount = js ? js->workerCount() + 1u : 1u;
+        if (m_buildScratch.size() < scratchCount)
+            m_buildScratch.resize(scratchCount);
+
+        auto one = [&](uint32_t worker, uint32_t i)
+        {
+            const uint32_t c = clusters[i];
+            Cluster &cl = m_clusters[c];
+            gatherClusterCells(c, cl.cells);
+            const size_t n = cl.cells.size();
+            cl.dist.assign(n * n, Unreachable);
+
+            QueryScratch &s = m_buildScratch[std::min(worker, scratchCount - 1u)];
+            for (size_t a = 0; a < n; ++a)
+            {
+                clusterDijkstra(grid, c, cl.cells[a], s);
+                const Rect r = clusterRect(c);
+                const int rw = r.maxX - r.minX + 1;
+                for (size_t b = 0; b < n; ++b)
+                {
+                    const int x = cl.cells[b] % m_width - r.minX;
+                    const int z = cl.cells[b] / m_width - r.minZ;
+                    const size_t li = static_cast<size_t>(z) * rw + x;
+                    cl.dist[a * n + b] = (s.localStamp[li] == s.localGen) ? s.localDist[li] : Unreachable;
+                }
+            }
+        };
+
+        if (js && js->workerCount() > 0 && clusters.size() >= PARALLEL_CLUSTER_THRESHOLD)
+        {
+            js->parallelForRange(0u, static_cast<uint32_t>(clusters.size()), 1u,
+                                 [&](uint32_t worker, uint32_t first, uint32_t last)
+                                 {
+                                     for (uint32_t i = first; i < last; ++i)
+                                         one(worker, i);
+                                 });
+        }
+        else
+        {
+            for (uint32_t i = 0; i < static_cast<uint32_t>(clusters.size()); ++i)
+                one(0u, i);
+        }
+    }
+
+    // Dijkstra from `fromCell` restricted to cluster c. Results in s.localDist, valid where
+    // s.localStamp == s.localGen (cluster-local index (z - minZ) * rectWidth + (x - minX)).
+    void clusterDijkstra(const NavGrid &grid, uint32_t c, int fromCell, QueryScratch &s) const
+    {
+        static constexpr int dxs[] = {0, 0, -1, 1, -1, -1, 1, 1};
+        static constexpr int dzs[] = {-1, 1, 0, 0, -1, 1, -1, 1};
+        static constexpr float costs[] = {1.0f, 1.0f, 1.0f, 1.0f, 1.414f, 1.414f, 1.414f, 1.414f};
+
+        const Rect r = clusterRect(c);
+        const int rw = r.maxX - r.minX + 1;
+        const size_t area = static_cast<size_t>(CLUSTER_SIZE) * CLUSTER_SIZE;
+        if (s.localStamp.size() < area)
+        {
+            s.localStamp.resize(area, 0u);
+            s.localDist.resize(area, Unreachable);
+        }
+        if (++s.localGen == 0u)
+        {
+            std::fill(s.localStamp.begin(), s.localStamp.end(), 0u);
+            s.localGen = 1u;
+        }
+
+        // Settled cells are marked by localStamp == localGen with a final localDist; the heap
+        // holds tentative entries and stale duplicates are skipped.
+        std::vector<QueryScratch::HeapItem> &heap = s.localHeap;
+        heap.clear();
+        const int fx = fromCell % m_width - r.minX;
+        const int fz = fromCell / m_width - r.minZ;
+        heap.push_back({static_cast<uint32_t>(fz * rw + fx), 0.0f});
+
+        while (!heap.empty())
+        {
+            std::pop_heap(heap.begin(), heap.end(), std::greater<QueryScratch::HeapItem>{});
+            const QueryScratch::HeapItem cur = heap.back();
+            heap.pop_back();
+            if (s.localStamp[cur.node] == s.localGen)
+                continue;
+            s.localStamp[cur.node] = s.localGen;
+            s.localDist[cur.node] = cur.f;
+
+            const int lx = static_cast<int>(cur.node) % rw;
+            const int lz = static_cast<int>(cur.node) / rw;
+            for (int i = 0; i < 8; ++i)
+            {
+                const int nx = lx + dxs[i];
+                const int nz = lz + dzs[i];
+                if (nx < 0 || nz < 0 || nx >= rw || r.minZ + nz > r.maxZ)
+                    continue;
+                const uint32_t ni = static_cast<uint32_t>(nz * rw + nx);
+                if (s.localStamp[ni] == s.localGen)
+                    continue;
+                if (!grid.isWalkable(r.minX + nx, r.minZ + nz))
+                    continue;
+                if (i >= 4 && (!grid.isWalkable(r.minX + lx, r.minZ + nz) || !grid.isWalkable(r.minX + nx, r.minZ + lz)))
+                    continue;
+                heap.push_back({ni, cur.f + costs[i]});
+                std::push_heap(heap.begin(), heap.end(), std::greater<QueryScratch::HeapItem>{});
+            }
+        }
+    }
+
+    // Nodes of cell's cluster reachable from cell, with their in-cluster distance.
+    void linkToCluster(const NavGrid &grid, int cell, QueryScratch &s, std::vector<uint32_t> &nodes, std::vector<float> &cost) const
+    {
+        nodes.clear();
+        cost.clear();
+        const uint32_t c = clusterOfCell(cell);
+        clusterDijkstra(grid, c, cell, s);
+
+        const Rect r = clusterRect(c);
+        const int rw = r.maxX - r.minX + 1;
+        for (uint32_t n = m_clusterFirstNode[c]; n < m_clusterFirstNode[c + 1u]; ++n)
+        {
+            const int x = m_nodes[n].cell % m_width - r.minX;
+            const int z = m_nodes[n].cell / m_width - r.minZ;
+            const size_t li = static_cast<size_t>(z) * rw + x;
+            if (s.localStamp[li] != s.localGen)
+                continue;
+            nodes.push_back(n);
+            cost.push_back(s.localDist[li]);
+        }
+    }
+
+    // Assign node ids cluster by cluster and rebuild the CSR edge list.
+    void flatten()
+    {
+        for (const Node &n : m_nodes)
+            m_nodeOfCell[n.cell] = InvalidNode;
+        m_nodes.clear();
+
+        const uint32_t clusterCount = static_cast<uint32_t>(m_clusters.size());
+        m_clusterFirstNode.assign(clusterCount + 1u, 0u);
+        for (uint32_t c = 0; c < clusterCount; ++c)
+        {
+            m_clusterFirstNode[c] = static_cast<uint32_t>(m_nodes.size());
+            for (int cell : m_clusters[c].cells)
+            {
+                m_nodeOfCell[cell] = static_cast<uint32_t>(m_nodes.size());
+                Node n;
+                n.cell = cell;
+                n.cluster = c;
+                n.wideCell = cell;
+                m_nodes.push_back(n);
+            }
+        }
+        m_clusterFirstNode[clusterCount] = static_cast<uint32_t>(m_nodes.size());
+
+        // A cell on two borders (cluster corner) keeps the wider of its crossings.
+        for (uint32_t c = 0; c < clusterCount; ++c)
+        {
+            for (const auto *border : {&m_borderX[c], &m_borderZ[c]})
+            {
+                for (const Transition &t : *border)
+                {
+                    Node &a = m_nodes[m_nodeOfCell[t.cellA]];
+                    Node &b = m_nodes[m_nodeOfCell[t.cellB]];
+                    if (t.wideClearance > a.wideClearance)
+                    {
+                        a.wideCell = t.wideA;
+                        a.wideClearance = t.wideClearance;
+                    }
+                    if (t.wideClearance > b.wideClearance)
+                    {
+                        b.wideCell = t.wideB;
+                        b.wideClearance = t.wideClearance;
+                    }
+                }
+            }
+        }
+
+        // Count, then fill: intra-cluster edges first, then the border crossings.
+        std::vector<uint32_t> counts(m_nodes.size(), 0u);
+        auto forEachEdge = [&](auto &&fn)
+        {
+            for (uint32_t c = 0; c < clusterCount; ++c)
+            {
+                const Cluster &cl = m_clusters[c];
+                const uint32_t base = m_clusterFirstNode[c];
+                const size_t n = cl.cells.size();
+                for (size_t a = 0; a < n; ++a)
+                    for (size_t b = 0; b < n; ++b)
+                        if (a != b && cl.dist[a * n + b] < Unreachable)
+                            fn(base + static_cast<uint32_t>(a), base + static_cast<uint32_t>(b), cl.dist[a * n + b]);
+            }
+            for (uint32_t c = 0; c < clusterCount; ++c)
+            {
+                for (const auto *border : {&m_borderX[c], &m_borderZ[c]})
+                {
+                    for (const Transition &t : *border)
+                    {
+                        const uint32_t a = m_nodeOfCell[t.cellA];
+                        const uint32_t b = m_nodeOfCell[t.cellB];
+                        fn(a, b, 1.0f);
+                        fn(b, a, 1.0f);
+                    }
+                }
+            }
+        };
+
+        forEachEdge([&](uint32_t from, uint32_t, float)
+                    { ++counts[from]; });
+        uint32_t offset = 0;
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_nodes.size()); ++i)
+        {
+            m_nodes[i].firstEdge = offset;
+            m_nodes[i].edgeCount = 0;
+            offset += counts[i];
+        }
+        m_edges.resize(offset);
+        forEachEdge([&](uint32_t from, uint32_t to, float cost)
+                    {
+                        Node &n = m_nodes[from];
+                        m_edges[n.firstEdge + n.edgeCount++] = Edge{to, cost}; });
+    }
+
+    bool m_built = false;
+    int m_width = 0;
+    int m_height = 0;
+    uint32_t m_clustersX = 0;
+    uint32_t m_clustersZ = 0;
+    uint32_t m_layoutRevision = 0;
+    uint32_t m_revision = 0;
+    uint32_t m_lastClustersRebuilt = 0;
+
+    std::vector<Cluster> m_clusters;
+    std::vector<std::vector<Transition>> m_borderX; // per cluster: border with the +X neighbor
+    std::vector<std::vector<Transition>> m_borderZ; // per cluster: border with the +Z neighbor
+
+    std::vector<Node> m_nodes;
+    std::vector<Edge> m_edges;
+    std::vector<uint32_t> m_clusterFirstNode; // clusterCount + 1 (nodes are grouped by cluster)
+    std::vector<uint32_t> m_nodeOfCell;       // grid index -> node id
+
+    std::vector<QueryScratch> m_buildScratch;
+};
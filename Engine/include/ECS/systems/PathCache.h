@@ -0,0 +1,204 @@
+#pragma once
+/*
+  PathCache.h
+  -----------
+  Purpose:
+    - LRU memo of planned paths for PathfindingSystem, keyed by (start block, goal cell,
+      clearance the unit needs; NavGrid::clearanceFor). An
+      entry stays valid while no NavGrid region under its bounds changed since it was planned
+      (NavGrid::revisionIn), so an obstacle placed elsewhere doesn't invalidate it.
+    - Start cells are bucketed into SHARE_BLOCK_CELLS x SHARE_BLOCK_CELLS blocks, so units that
+      start next to each other with the same goal cell share one result. A hit additionally
+      needs a clear line from the requester's cell to the entry's first waypoint.
+    - Entries only name the plan's PathStore block; a hit hands that handle to the requester,
+      so every follower reads the same waypoints. Evicting an entry doesn't touch its block:
+      units already on it keep walking, and the store collects it once none is left
+      (markLive keeps the blocks of live entries).
+
+  Threading:
+    - find/store are internally locked (PathfindingSystem's lanes call them concurrently).
+    - markLive() runs alone (PathfindingSystem's sweep, before the lanes).
+*/
+
+#include "ECS/systems/NavGrid.h"
+#include "ECS/systems/PathStore.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+class PathCache
+{
+public:
+    // =====================
+    // TUNING CONSTANTS
+    // =====================
+    static constexpr uint32_t CAPACITY = 2048;
+    static constexpr int SHARE_BLOCK_CELLS = 4;
+
+    struct Entry
+    {
+        uint64_t key = 0;
+        uint32_t gridRevision = 0;
+        uint32_t layoutRevision = 0;
+        uint64_t lastUsed = 0;
+        bool live = false;
+        bool partial = false;
+        uint8_t minClearance = 0;
+        int startCell = 0;
+        int minX = 0, minZ = 0, maxX = 0, maxZ = 0; // cells of start + waypoints
+        int firstX = 0, firstZ = 0;                 // cell of the first waypoint
+        uint32_t count = 0;
+        PathStore::Handle waypoints = 0;
+    };
+
+    struct Stats
+    {
+        uint32_t hits = 0;
+        uint32_t misses = 0;
+        uint32_t stored = 0;
+        uint32_t evicted = 0;
+    };
+
+    // Waypoints of the cached path for a unit at startCell heading to goalCell, or 0.
+    // count/partial are read under the lock (another lane may evict the entry right after).
+    PathStore::Handle find(const NavGrid &grid, int startCell, int goalCell, uint8_t minClearance, uint32_t &count, bool &partial)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        auto it = m_slots.find(keyOf(grid, startCell, goalCell, minClearance));
+        if (it != m_slots.end())
+        {
+            Entry &e = m_entries[it->second];
+            if (e.live && e.minClearance == minClearance && e.layoutRevision == grid.layoutRevision &&
+                grid.revisionIn(e.minX, e.minZ, e.maxX, e.maxZ) <= e.gridRevision &&
+                (e.startCell == startCell || grid.lineCheckGrid(startCell % grid.width, startCell / grid.width,
+                                                                e.firstX, e.firstZ, minClearance)))
+            {
+                e.lastUsed = ++m_clock;
+                count = e.count;
+                partial = e.partial;
+                ++m_stats.hits;
+                return e.waypoints;
+            }
+        }
+        ++m_stats.misses;
+        return 0u;
+    }
+
+    // Remembers a plan from startCell to goalCell on the current grid revision: its PathStore
+    // block (waypoints) and the count waypoints written there (x, z).
+    void store(const NavGrid &grid, int startCell, int goalCell, uint8_t minClearance, PathStore::Handle waypoints,
+               const float *x, const float *z, uint32_t count, bool partial)
+    {
+        if (waypoints == 0 || count == 0)
+            return;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // Always a fresh slot: units may still follow the entry this key pointed to before
+        // (older revision, or a start it wasn't visible from). LRU reclaims it later.
+        const uint64_t key = keyOf(grid, startCell, goalCell, minClearance);
+        const uint32_t slot = takeSlot();
+        m_slots[key] = slot;
+
+        Entry &e = m_entries[slot];
+        e.key = key;
+        e.gridRevision = grid.revision;
+        e.layoutRevision = grid.layoutRevision;
+        e.lastUsed = ++m_clock;
+        e.live = true;
+        e.partial = partial;
+        e.minClearance = minClearance;
+        e.startCell = startCell;
+        e.count = count;
+        e.waypoints = waypoints;
+        e.firstX = grid.worldToGridX(x[0]);
+        e.firstZ = grid.worldToGridZ(z[0]);
+
+        e.minX = e.maxX = startCell % grid.width;
+        e.minZ = e.maxZ = startCell / grid.width;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const int gx = grid.worldToGridX(x[i]);
+            const int gz = grid.worldToGridZ(z[i]);
+            e.minX = std::min(e.minX, gx);
+            e.minZ = std::min(e.minZ, gz);
+            e.maxX = std::max(e.maxX, gx);
+            e.maxZ = std::max(e.maxZ, gz);
+        }
+        ++m_stats.stored;
+    }
+
+    // Marks the blocks of the live entries in a PathStore sweep.
+    void markLive(PathStore &paths) const
+    {
+        for (const Entry &e : m_entries)
+        {
+            if (e.live)
+                paths.mark(e.waypoints);
+        }
+    }
+
+    // Heap bytes of the entry array and key map (map nodes estimated at key + slot + next pointer).
+    uint64_t memoryBytes()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_entries.capacity() * sizeof(Entry) +
+               m_slots.size() * (sizeof(std::pair<const uint64_t, uint32_t>) + sizeof(void *)) +
+               m_slots.bucket_count() * sizeof(void *);
+    }
+
+    // Counters since the last call.
+    Stats takeStats()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const Stats s = m_stats;
+        m_stats = Stats{};
+        return s;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::vector<Entry> m_entries;
+    std::unordered_map<uint64_t, uint32_t> m_slots; // key -> slot
+    uint64_t m_clock = 0;
+    Stats m_stats{};
+
+    static uint64_t keyOf(const NavGrid &grid, int startCell, int goalCell, uint8_t minClearance)
+    {
+        const int bx = (startCell % grid.width) / SHARE_BLOCK_CELLS;
+        const int bz = (startCell / grid.width) / SHARE_BLOCK_CELLS;
+        const uint32_t blocksX = static_cast<uint32_t>((grid.width + SHARE_BLOCK_CELLS - 1) / SHARE_BLOCK_CELLS);
+        const uint32_t block = static_cast<uint32_t>(bz) * blocksX + static_cast<uint32_t>(bx);
+        return ((static_cast<uint64_t>(block) << 32) | static_cast<uint32_t>(goalCell)) ^
+               (static_cast<uint64_t>(minClearance) << 56);
+    }
+
+    // A free slot, or the least recently used one (dropped from the key map).
+    uint32_t takeSlot()
+    {
+        if (m_entries.size() < CAPACITY)
+        {
+            if (m_entries.empty())
+                m_entries.reserve(CAPACITY);
+            m_entries.emplace_back();
+            return static_cast<uint32_t>(m_entries.size() - 1u);
+        }
+
+        uint32_t victim = 0;
+        for (uint32_t i = 1; i < CAPACITY; ++i)
+        {
+            if (m_entries[i].lastUsed < m_entries[victim].lastUsed)
+                victim = i;
+        }
+        auto it = m_slots.find(m_entries[victim].key);
+        if (it != m_slots.end() && it->second == victim)
+            m_slots.erase(it);
+        m_entries[victim].live = false;
+        ++m_stats.evicted;
+        return victim;
+    }
+};
@@ -0,0 +1,240 @@
+#pragma once
+/*
+  PathStore.h
+  -----------
+  Purpose:
+    - Waypoint arena behind Path::waypoints. Each planned path is one variable-length block in
+      two shared float arrays (x, z); the component keeps only the handle and its cursor, so a
+      pathing row stays small and routes are not capped at a fixed waypoint count.
+    - Units given the same plan (PathCache hits) hold the same handle instead of a copy.
+    - A block can also carry the plan's corridor: the free cells the search walked, start to
+      goal, which SteeringSystem string-pulls as the unit moves (waypoints stay the fallback).
+
+  Usage:
+    - store(x, z, count[, cells, cellCount]) copies a finished plan in and returns its handle
+      (0 when full).
+    - view(handle, out) locates the waypoints and corridor; false for 0 or a freed / foreign handle.
+    - Collection is mark and sweep: beginSweep(), mark() every handle still referenced
+      (Path columns, PathCache entries), endSweep() frees the rest. A path stops being
+      referenced when SteeringSystem finishes it or PathfindingSystem replans the unit.
+
+  Threading:
+    - store() is internally locked (PathfindingSystem's lanes call it concurrently).
+    - view() is lock-free and only valid while no store() runs (SteeringSystem runs after
+      PathfindingSystem; the "PathStore" access name orders them). The arrays may grow on store().
+
+  Notes:
+    - Blocks come in power-of-two sizes from MIN_BLOCK up, each size with its own free list,
+      so freed space is reused by later plans of similar length without compaction. Corridor
+      cells use a second arena with the same scheme.
+    - Handles carry the slot's generation: one kept past its path's collection (a row copied in
+      from another process) resolves to nothing instead of another unit's route.
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+class PathStore
+{
+public:
+    // =====================
+    // TUNING CONSTANTS
+    // =====================
+    static constexpr uint32_t MIN_BLOCK = 8; // waypoints in the smallest block
+
+    using Handle = uint32_t; // 0 = none; (generation << SLOT_BITS) | (slot + 1)
+
+    struct View
+    {
+        const float *x = nullptr;
+        const float *z = nullptr;
+        uint32_t count = 0;
+        const uint32_t *cells = nullptr; // corridor, NavGrid cell indices (nullptr: none)
+        uint32_t cellCount = 0;
+    };
+
+    struct Stats
+    {
+        uint32_t livePaths = 0;
+        uint64_t liveWaypoints = 0;
+        uint64_t arenaWaypoints = 0; // allocated blocks, used or free
+        uint64_t liveCorridorCells = 0;
+    };
+
+    Handle store(const float *x, const float *z, uint32_t count, const uint32_t *cells = nullptr, uint32_t cellCount = 0)
+    {
+        if (count == 0)
+            return 0u;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        uint32_t slot;
+        if (!m_freeSlots.empty())
+        {
+            slot = m_freeSlots.back();
+            m_freeSlots.pop_back();
+        }
+        else
+        {
+            if (m_entries.size() >= SLOT_MASK)
+                return 0u;
+            slot = static_cast<uint32_t>(m_entries.size());
+            m_entries.emplace_back();
+        }
+
+        const uint32_t sizeClass = sizeClassOf(count);
+        const uint32_t offset = allocate(m_freeBlocks, sizeClass, static_cast<uint32_t>(m_x.size()));
+        if (offset == static_cast<uint32_t>(m_x.size()))
+        {
+            m_x.resize(m_x.size() + (MIN_BLOCK << sizeClass));
+            m_z.resize(m_z.size() + (MIN_BLOCK << sizeClass));
+        }
+        std::copy(x, x + count, m_x.begin() + offset);
+        std::copy(z, z + count, m_z.begin() + offset);
+
+        Entry &e = m_entries[slot];
+        e.cellCount = (cells != nullptr) ? cellCount : 0u;
+        if (e.cellCount > 0u)
+        {
+            e.cellSizeClass = sizeClassOf(e.cellCount);
+            e.cellOffset = allocate(m_freeCellBlocks, e.cellSizeClass, static_cast<uint32_t>(m_cells.size()));
+            if (e.cellOffset == static_cast<uint32_t>(m_cells.size()))
+                m_cells.resize(m_cells.size() + (MIN_BLOCK << e.cellSizeClass));
+            std::copy(cells, cells + e.cellCount, m_cells.begin() + e.cellOffset);
+        }
+        e.generation = (e.generation + 1u) & GENERATION_MASK;
+        if (e.generation == 0)
+            e.generation = 1;
+        e.offset = offset;
+        e.count = count;
+        e.sizeClass = sizeClass;
+        e.live = true;
+        return (e.generation << SLOT_BITS) | (slot + 1u);
+    }
+
+    bool view(Handle h, View &out) const
+    {
+        const Entry *e = entry(h);
+        if (!e)
+            return false;
+        out.x = m_x.data() + e->offset;
+        out.z = m_z.data() + e->offset;
+        out.count = e->count;
+        out.cells = (e->cellCount > 0u) ? m_cells.data() + e->cellOffset : nullptr;
+        out.cellCount = e->cellCount;
+        return true;
+    }
+
+    void beginSweep() { m_marked.assign(m_entries.size(), 0u); }
+
+    void mark(Handle h)
+    {
+        if (entry(h) && (h & SLOT_MASK) - 1u < m_marked.size())
+            m_marked[(h & SLOT_MASK) - 1u] = 1u;
+    }
+
+    // Frees every live path not marked since beginSweep(); returns how many.
+    uint32_t endSweep()
+    {
+        uint32_t freed = 0;
+        for (uint32_t slot = 0; slot < m_entries.size(); ++slot)
+        {
+            Entry &e = m_entries[slot];
+            if (!e.live || (slot < m_marked.size() && m_marked[slot]))
+                continue;
+            e.live = false;
+            m_freeBlocks[e.sizeClass].push_back(e.offset);
+            if (e.cellCount > 0u)
+                m_freeCellBlocks[e.cellSizeClass].push_back(e.cellOffset);
+            m_freeSlots.push_back(slot);
+            ++freed;
+        }
+        return freed;
+    }
+
+    Stats stats() const
+    {
+        Stats s;
+        for (const Entry &e : m_entries)
+        {
+            s.livePaths += e.live ? 1u : 0u;
+            s.liveWaypoints += e.live ? e.count : 0u;
+            s.liveCorridorCells += e.live ? e.cellCount : 0u;
+        }
+        s.arenaWaypoints = m_x.size();
+        return s;
+    }
+
+    // Heap bytes of the arena and slot tables.
+    uint64_t memoryBytes() const
+    {
+        uint64_t bytes = (m_x.capacity() + m_z.capacity()) * sizeof(float) + m_entries.capacity() * sizeof(Entry) +
+                         (m_cells.capacity() + m_freeSlots.capacity()) * sizeof(uint32_t) + m_marked.capacity();
+        for (const std::vector<uint32_t> &blocks : m_freeBlocks)
+            bytes += blocks.capacity() * sizeof(uint32_t);
+        for (const std::vector<uint32_t> &blocks : m_freeCellBlocks)
+            bytes += blocks.capacity() * sizeof(uint32_t);
+        return bytes;
+    }
+
+private:
+    static constexpr uint32_t SLOT_BITS = 20;
+    static constexpr uint32_t SLOT_MASK = (1u << SLOT_BITS) - 1u;
+    static constexpr uint32_t GENERATION_MASK = (1u << (32u - SLOT_BITS)) - 1u;
+
+    struct Entry
+    {
+        uint32_t offset = 0;
+        uint32_t count = 0;
+        uint32_t sizeClass = 0;
+        uint32_t generation = 0;
+        uint32_t cellOffset = 0;
+        uint32_t cellCount = 0;
+        uint32_t cellSizeClass = 0;
+        bool live = false;
+    };
+
+    static uint32_t sizeClassOf(uint32_t count)
+    {
+        uint32_t sizeClass = 0;
+        while ((MIN_BLOCK << sizeClass) < count)
+            ++sizeClass;
+        return sizeClass;
+    }
+
+    // A free block of the class, or arenaEnd when the caller has to grow its arena.
+    static uint32_t allocate(std::vector<std::vector<uint32_t>> &freeBlocks, uint32_t sizeClass, uint32_t arenaEnd)
+    {
+        if (freeBlocks.size() <= sizeClass)
+            freeBlocks.resize(sizeClass + 1u);
+        std::vector<uint32_t> &blocks = freeBlocks[sizeClass];
+        if (blocks.empty())
+            return arenaEnd;
+        const uint32_t offset = blocks.back();
+        blocks.pop_back();
+        return offset;
+    }
+
+    const Entry *entry(Handle h) const
+    {
+        if (h == 0)
+            return nullptr;
+        const uint32_t slot = (h & SLOT_MASK) - 1u;
+        if (slot >= m_entries.size())
+            return nullptr;
+        const Entry &e = m_entries[slot];
+        return (e.live && e.generation == (h >> SLOT_BITS)) ? &e : nullptr;
+    }
+
+    std::mutex m_mutex;
+    std::vector<float> m_x;
+    std::vector<float> m_z;
+    std::vector<Entry> m_entries;
+    std::vector<uint32_t> m_freeSlots;
+    std::vector<std::vector<uint32_t>> m_freeBlocks; // per size class: block offsets
+    std::vector<uint32_t> m_cells;                    // corridor arena
+    std::vector<std::vector<uint32_t>> m_freeCellBlocks;
+    std::vector<uint8_t> m_marked;                    // sweep marks per slot
+};
@@ -7,23 +7,70 @@
     - Updates Path component with waypoints.
     - Only runs when needed (dirty query on MoveTarget).
 
+  Scheduling:
+    - Dirty rows become requests in a per-priority FIFO keyed by entity (rows can move
+      between frames). Player orders (MoveTarget::order != 0) are served before AI repaths.
+    - Each frame the queue is drained by one search lane per JobSystem thread until the
+      millisecond budget (setBudgetMs) runs out. Flat A* runs in slices of
+      SEARCH_SLICE_NODES; a search still open when the budget ends stays parked in its lane
+      and continues next frame. setDeterministic runs the lanes serially without a budget.
+    - Amortized work: one unit is one request taken off the queue for planning. A work budget
+      (SystemScheduler) stops the lanes from starting more than that many per frame; parked
+      searches still continue. Deterministic runs ignore it.
+    - A newer request for the same entity supersedes queued and parked ones.
+    - While a request is pending the Path stays invalid, so SteeringSystem walks the unit
+      straight at its MoveTarget.
+
   Optimizations:
     - Generation counter avoids clearing arrays per A* call.
     - Reusable member buffers avoid heap allocations per call.
     - Dirty query avoids scanning all entities every frame.
     - Capped lookahead in path smoothing avoids expensive line checks.
     - Weighted A* (ε=1.2) explores fewer nodes for near-optimal paths.
+    - SearchMode::JumpPoint (setSearchMode) runs searches without a clearance as Jump Point
+      Search: straight and diagonal runs are scanned without entering the heap and only cells
+      where a path may turn become nodes (same moves and corner rule as A*). Straight runs stop
+      on a node every JPS_MAX_RUN cells and scanned cells count against the node limits, so
+      one jump over open ground stays bounded. Fewer heap operations around obstacles; the
+      chain is expanded back to cells before smoothing. Off by default.
     - Grid-space lineCheck avoids float↔int conversions in smoothing.
     - Target cell validation with spiral fallback prevents wasted A* on blocked goals.
+    - Long orders go through NavHierarchy (HPA*): an abstract route over cluster entrances is
+      found first, then only the first HPA_REFINE_CLUSTER_HOPS hops are refined with A*
+      restricted to their clusters. Such paths are marked Path::partial; SteeringSystem marks
+      MoveTarget dirty near their end and the next plan refines the following stretch.
+    - Group orders (MoveTarget::order shared by at least FLOW_FIELD_MIN_GROUP units replanned in
+      the same frame) share one FlowFieldCache field integrated from the group's goal rect.
+      Those units get Path::flowField instead of waypoints; SteeringSystem follows the field
+      and hands the last stretch (inside the goal rect) back here as a short A*.
+    - Waypoints are written once into a PathStore arena (no per-unit cap or copy); Path holds
+      the handle. The block also keeps the plan's corridor (the cells the search walked), which
+      SteeringSystem string-pulls per unit, so a unit pushed aside by avoidance keeps its plan. Every plan is remembered in a PathCache keyed by (start block, goal cell,
+      grid revision), so units starting next to each other with the same goal cell get the
+      same handle instead of searching. Every PATH_SWEEP_INTERVAL frames the store frees the
+      blocks no Path or cache entry references any more.
+    - Units whose Radius exceeds the grid's baked-in inflation plan on the same grid, skipping
+      cells below their NavGrid::clearanceFor (A*, smoothing, cache key, HPA entrances). HPA
+      in-cluster costs stay those of the smallest units, so a gap too narrow inside one cluster
+      is only found by refinement (partial path, then flat A* from there). They don't join
+      flow fields, which are integrated for the smallest units.
 */
 
 #include "ECS/SystemFormat.h"
+#include "ECS/systems/FlowField.h"
 #include "ECS/systems/NavGrid.h"
+#include "ECS/systems/NavHierarchy.h"
+#include "ECS/systems/PathCache.h"
+#include "ECS/systems/PathStore.h"
 #include "utils/JobSystem.h"
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cmath>
 #include <cstdint>
+#include <deque>
+#include <mutex>
 #include <vector>
 
 class PathfindingSystem : public Engine::ECS::SystemBase
@@ -32,17 +79,114 @@ public:
     // =====================
     // TUNING CONSTANTS
     // =====================
-    static constexpr uint32_t PARALLEL_DIRTY_ROW_THRESHOLD = 64;
+    static constexpr float DEFAULT_BUDGET_MS = 2.0f;  // per frame, all lanes together (wall clock)
+    static constexpr int SEARCH_SLICE_NODES = 1024;   // flat A* nodes between budget checks
+    static constexpr int FLAT_MAX_NODES = 4000;       // flat A* gives up (closest cell) past this
+    static constexpr int HPA_MIN_DISTANCE_CELLS = 2 * NavHierarchy::CLUSTER_SIZE; // shorter orders use flat A*
+    static constexpr uint32_t HPA_REFINE_CLUSTER_HOPS = 6;                          // in-cluster hops refined per plan
+    static constexpr int HPA_SEGMENT_MAX_NODES = 2 * NavHierarchy::CLUSTER_SIZE * NavHierarchy::CLUSTER_SIZE;
+    static constexpr uint32_t FLOW_FIELD_MIN_GROUP = 32;  // smaller orders plan per unit
+    static constexpr int FLOW_FIELD_MARGIN_CELLS = 32;     // field bounds around group + goal
+    static constexpr uint32_t PATH_SWEEP_INTERVAL = 32;    // frames between PathStore collections
+    static constexpr int JPS_SCANS_PER_NODE = 8;           // jump scan cells that cost one A* expansion
+    static constexpr int JPS_MAX_RUN = 16;                 // straight jump scans stop on a node after this many cells
+
+    enum class SearchMode : uint8_t
+    {
+        AStar,     // weighted A*, one node per cell
+        JumpPoint, // weighted JPS, one node per jump point
+    };
+
+    enum Priority : uint32_t
+    {
+        PRIORITY_ORDER = 0,  // player-issued (MoveTarget::order != 0)
+        PRIORITY_REPATH = 1, // AI retargets, partial-path continuations without an order
+        PRIORITY_COUNT = 2,
+    };
+
+    struct Stats
+    {
+        uint32_t requestsQueued = 0;    // new requests this frame
+        uint32_t plansCompleted = 0;    // paths written this frame
+        uint32_t plansStarted = 0;      // requests taken off the queue to plan (work units)
+        uint32_t searchesCarried = 0;   // flat searches parked for the next frame
+        uint32_t pendingRequests = 0;   // still queued after this frame
+        uint32_t requestsSuperseded = 0; // dropped (newer request, entity gone, target cleared)
+        uint32_t cacheHits = 0;
+        uint32_t cacheMisses = 0;
+        uint32_t pathsFreed = 0;        // PathStore blocks collected this frame
+        float planMs = 0.0f;
+    };
 
     PathfindingSystem(const NavGrid *grid)
         : m_grid(grid)
     {
         setRequiredNames({"Position", "MoveTarget", "Path"});
         setExcludedNames({"Disabled", "Dead", "Obstacle"});
+        setReadNames({"Position", "Radius", "NavGrid"});
+        setWriteNames({"MoveTarget", "Path", "FlowField", "PathStore"});
     }
 
     const char *name() const override { return "PathfindingSystem"; }
 
+    // Wall-clock planning budget per frame; <= 0 drains the whole queue every frame.
+    void setBudgetMs(float ms) { m_budgetMs = ms; }
+    float budgetMs() const { return m_budgetMs; }
+    const Stats &lastStats() const { return m_lastStats; }
+
+    bool isAmortized() const override { return true; }
+    uint32_t workRemaining() const override { return m_lastStats.pendingRequests + m_lastStats.searchesCarried; }
+    uint32_t workDone() const override { return m_lastStats.plansStarted; }
+
+    // true = lanes run one after another with no budget, so which unit plans and which one reuses
+    // its PathCache entry no longer depends on thread timing (reproducible benchmark runs).
+    void setDeterministic(bool enabled) { m_deterministic = enabled; }
+    bool deterministic() const { return m_deterministic; }
+
+    // false = every unit of a group order plans its own path.
+    void setFlowFields(bool enabled) { m_useFlowFields = enabled; }
+    const FlowFieldCache &flowFields() const { return m_flowFields; }
+
+    // false = every request searches (and nothing is shared).
+    void setPathCaching(bool enabled) { m_usePathCache = enabled; }
+    const PathCache &pathCache() const { return m_pathCache; }
+    // Waypoints of every planned Path (Path::waypoints).
+    const PathStore &pathStore() const { return m_paths; }
+
+    // false = always run flat A* over the whole grid.
+    void setHierarchical(bool enabled) { m_useHierarchy = enabled; }
+
+    // Grid search used by flat plans and HPA refinement (same moves, costs and weighting).
+    void setSearchMode(SearchMode mode) { m_searchMode = mode; }
+    SearchMode searchMode() const { return m_searchMode; }
+    const NavHierarchy &hierarchy() const { return m_hierarchy; }
+
+    // Hierarchy, flow fields, path cache, request bookkeeping and per-lane search scratch, under
+    // category "Navigation".
+    void reportMemory(Engine::MemoryReport &out) const
+    {
+        using Engine::MemoryReport;
+        out.add("Navigation", "Nav hierarchy", m_hierarchy.memoryBytes(), 0);
+        out.add("Navigation", "Flow fields", m_flowFields.memoryBytes(), 0);
+        out.add("Navigation", "Path cache", m_pathCache.memoryBytes(), 0);
+        out.add("Navigation", "Path waypoints", m_paths.memoryBytes(), 0, m_paths.stats().livePaths);
+
+        uint64_t scratch = MemoryReport::bytesOf(m_batches) + MemoryReport::bytesOf(m_batchRows) +
+                           MemoryReport::bytesOf(m_groups) + MemoryReport::bytesOf(m_latestSeq) +
+                           MemoryReport::bytesOf(m_workerScratch);
+        for (const WorkerScratch &s : m_workerScratch)
+        {
+            scratch += MemoryReport::bytesOf(s.genStamp) + MemoryReport::bytesOf(s.gScores) +
+                       MemoryReport::bytesOf(s.cameFrom) + MemoryReport::bytesOf(s.closedGen) +
+                       MemoryReport::bytesOf(s.heapBuf) + MemoryReport::bytesOf(s.pathIndices) +
+                       MemoryReport::bytesOf(s.smoothedIdx) + MemoryReport::bytesOf(s.waypointX) +
+                       MemoryReport::bytesOf(s.waypointZ) + MemoryReport::bytesOf(s.corridor) + s.hpa.memoryBytes() +
+                       MemoryReport::bytesOf(s.abstractCells) + MemoryReport::bytesOf(s.chain) +
+                       MemoryReport::bytesOf(s.goalChanged);
+        }
+        out.add("Navigation", "Pathfinding scratch", scratch, 0, static_cast<uint32_t>(m_workerScratch.size()));
+    }
+
     void buildMasks(Engine::ECS::ComponentRegistry &registry) override
     {
         Engine::ECS::SystemBase::buildMasks(registry);
@@ -55,168 +199,1003 @@ public:
         if (!m_grid)
             return;
 
-        if (m_queryId == Engine::ECS::QueryManager::InvalidQuery)
+        if (m_queryId == Engine::ECS::QueryManager::InvalidQuery)
+        {
+            Engine::ECS::ComponentMask dirty;
+            dirty.set(m_moveTargetId);
+            m_queryId = ecs.queries.createDirtyQuery(required(), excluded(), dirty, ecs.stores);
+        }
+
+        const auto t0 = Clock::now();
+        m_stats = Stats{};
+
+        if (++m_sweepFrame >= PATH_SWEEP_INTERVAL)
+        {
+            m_sweepFrame = 0;
+            m_stats.pathsFreed = sweepPaths(ecs);
+        }
+
+        // Picks up NavGridBuilderSystem's changes (only touched clusters/fields are rebuilt).
+        if (m_useHierarchy)
+            m_hierarchy.sync(*m_grid, ecs.jobSystem);
+        if (m_useFlowFields)
+            m_flowFields.sync(*m_grid, ecs.jobSystem);
+
+        // Gather first: group orders are counted across archetypes before anyone plans.
+        m_batches.clear();
+        m_batchRows.clear();
+        const auto &q = ecs.queries.get(m_queryId);
+        for (uint32_t archetypeId : q.matchingArchetypeIds)
+        {
+            if (!ecs.stores.get(archetypeId))
+                continue;
+            const uint32_t first = static_cast<uint32_t>(m_batchRows.size());
+            const uint32_t count = ecs.queries.forEachDirtyRow(m_queryId, archetypeId, [this](uint32_t row)
+                                                               { m_batchRows.push_back(row); });
+            if (count)
+                m_batches.push_back(Batch{archetypeId, first, count});
+        }
+
+        if (!m_batches.empty())
+        {
+            if (m_useFlowFields)
+                acquireGroupFields(ecs);
+            intake(ecs);
+        }
+
+        const uint32_t threads = (ecs.jobSystem ? (ecs.jobSystem->workerCount() + 1u) : 1u);
+        if (m_workerScratch.size() < threads)
+            m_workerScratch.resize(threads);
+        const uint32_t laneCount = static_cast<uint32_t>(m_workerScratch.size()); // parked searches stay reachable
+
+        bool work = (m_queue[PRIORITY_ORDER].size() + m_queue[PRIORITY_REPATH].size()) > 0;
+        for (const WorkerScratch &s : m_workerScratch)
+            work = work || s.search.active;
+
+        if (work)
+        {
+            const auto deadline = t0 + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float, std::milli>(m_budgetMs));
+            const bool unlimited = (m_budgetMs <= 0.0f) || m_deterministic;
+            m_plansLimited = !m_deterministic && workBudget() != UNLIMITED_WORK;
+            m_plansLeft.store(static_cast<int64_t>(workBudget()), std::memory_order_relaxed);
+
+            if (m_deterministic)
+            {
+                // Lane 0 drains the queue; the others only finish searches parked earlier.
+                for (WorkerScratch &s : m_workerScratch)
+                    runLane(ecs, s, deadline, true);
+            }
+            else if (ecs.jobSystem && laneCount > 1)
+            {
+                ecs.jobSystem->parallelForRange(0u, laneCount, 1u, [&](uint32_t /*worker*/, uint32_t first, uint32_t last)
+                                                {
+                                                    for (uint32_t lane = first; lane < last; ++lane)
+                                                        runLane(ecs, m_workerScratch[lane], deadline, unlimited); });
+            }
+            else
+            {
+                runLane(ecs, m_workerScratch[0], deadline, unlimited);
+            }
+
+            // Keep other systems (and future frames) aware that the goal changed.
+            // Do this single-threaded to avoid any potential QueryManager resizing races.
+            for (WorkerScratch &s : m_workerScratch)
+            {
+                for (const Engine::ECS::Entity e : s.goalChanged)
+                    ecs.markDirty(m_moveTargetId, e);
+                s.goalChanged.clear();
+
+                m_stats.plansCompleted += s.plansCompleted;
+                m_stats.plansStarted += s.plansStarted;
+                m_stats.requestsSuperseded += s.superseded;
+                m_stats.searchesCarried += s.search.active ? 1u : 0u;
+                s.plansCompleted = 0;
+                s.plansStarted = 0;
+                s.superseded = 0;
+            }
+        }
+
+        const PathCache::Stats cacheStats = m_pathCache.takeStats();
+        m_stats.cacheHits = cacheStats.hits;
+        m_stats.cacheMisses = cacheStats.misses;
+        m_stats.pendingRequests = static_cast<uint32_t>(m_queue[PRIORITY_ORDER].size() + m_queue[PRIORITY_REPATH].size());
+        m_stats.planMs = std::chrono::duration<float, std::milli>(Clock::now() - t0).count();
+        m_lastStats = m_stats;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    const NavGrid *m_grid;
+    NavHierarchy m_hierarchy;
+    bool m_useHierarchy = true;
+    SearchMode m_searchMode = SearchMode::AStar;
+    FlowFieldCache m_flowFields;
+    bool m_useFlowFields = true;
+    mutable PathCache m_pathCache; // internally locked; lanes share it
+    bool m_usePathCache = true;
+    mutable PathStore m_paths;     // internally locked for store(); lanes share it
+    uint32_t m_sweepFrame = 0;
+    float m_budgetMs = DEFAULT_BUDGET_MS;
+    bool m_deterministic = false;
+    // Work budget of this frame: plans the lanes may still start (shared, may dip below 0).
+    bool m_plansLimited = false;
+    std::atomic<int64_t> m_plansLeft{0};
+
+    Stats m_stats{};
+    Stats m_lastStats{};
+
+    struct Batch
+    {
+        uint32_t archetypeId;
+        uint32_t first; // rows are m_batchRows[first, first + count)
+        uint32_t count;
+    };
+    std::vector<Batch> m_batches;
+    std::vector<uint32_t> m_batchRows; // dirty rows of every batch, reused across frames
+
+    // One entry per group order replanned this frame.
+    struct GroupOrder
+    {
+        uint32_t order = 0;
+        uint32_t count = 0;
+        FlowFieldCache::Rect goal;  // target cells
+        FlowFieldCache::Rect units; // start cells
+        FlowFieldCache::Handle field = 0;
+    };
+    std::vector<GroupOrder> m_groups;
+
+    struct Request
+    {
+        Engine::ECS::Entity entity;
+        uint32_t seq = 0;
+        uint32_t cost = 0; // estimate for the longest-first order (intake)
+    };
+    std::deque<Request> m_queue[PRIORITY_COUNT];
+    std::mutex m_queueMutex;              // lanes pop concurrently
+    std::vector<uint32_t> m_latestSeq;    // entity index -> newest request seq (0 = none)
+    uint32_t m_seqCounter = 0;
+
+    Engine::ECS::QueryId m_queryId = Engine::ECS::QueryManager::InvalidQuery;
+    uint32_t m_moveTargetId = Engine::ECS::ComponentRegistry::InvalidID;
+
+    struct NodeEntry
+    {
+        int idx;
+        float fCost;
+        bool operator>(const NodeEntry &o) const { return fCost > o.fCost; }
+    };
+
+    // Resumable grid search (heap and parents live in the lane's scratch arrays).
+    struct GridSearch
+    {
+        int targetIdx = 0;
+        NavHierarchy::Rect bounds;
+        int maxNodes = 0;
+        uint8_t minClearance = 0; // NavGrid::clearanceFor the unit (0 = any walkable cell)
+        bool jump = false;        // SearchMode::JumpPoint and no clearance
+        int nodesExplored = 0;
+        int closestIdx = 0;
+        float closestH = 0.0f;
+        int closestFrom = -1; // JumpPoint: node whose scan passed closestIdx (-1 = its own cameFrom)
+        int closestVia = -1;  // JumpPoint: diagonal cell of that scan closestIdx was probed from
+        int cellsScanned = 0; // JumpPoint: jump() cells, charged against maxNodes and slices
+        bool found = false;
+    };
+
+    // A plan in flight: the request it serves plus what finishPath needs once the search ends.
+    struct PendingPlan
+    {
+        bool active = false;
+        Request request;
+        int startIdx = 0;
+        int targetIdx = 0;
+        uint8_t minClearance = 0;
+        float targetX = 0.0f, targetZ = 0.0f; // world goal (after blocked-goal relocation)
+    };
+
+    // One per lane (JobSystem thread). Lanes never share a scratch, so a parked search keeps
+    // its arrays untouched until the lane resumes it.
+    struct WorkerScratch
+    {
+        uint32_t currentGen = 0;
+        std::vector<uint32_t> genStamp;
+        std::vector<float> gScores;
+        std::vector<int> cameFrom;
+        std::vector<uint32_t> closedGen;
+
+        std::vector<NodeEntry> heapBuf;
+        std::vector<int> pathIndices;
+        std::vector<int> smoothedIdx;
+        std::vector<float> waypointX; // finishPath output, copied into the PathStore
+        std::vector<float> waypointZ;
+        std::vector<uint32_t> corridor; // finishPath output: start cell + pathIndices
+
+        NavHierarchy::QueryScratch hpa;
+        std::vector<int> abstractCells;
+        std::vector<int> chain;
+
+        GridSearch grid;
+        PendingPlan search;
+
+        std::vector<Engine::ECS::Entity> goalChanged;
+        uint32_t plansCompleted = 0;
+        uint32_t plansStarted = 0;
+        uint32_t superseded = 0;
+    };
+
+    std::vector<WorkerScratch> m_workerScratch;
+
+    static constexpr float kEpsilon = 1.2f;
+
+    // Counts this frame's dirty rows per group order and acquires a field for each large one.
+    void acquireGroupFields(Engine::ECS::ECSContext &ecs)
+    {
+        m_groups.clear();
+        const int W = m_grid->width;
+        const int H = m_grid->height;
+        auto clampI = [](int v, int lo, int hi)
+        { return std::max(lo, std::min(v, hi)); };
+        auto grow = [](FlowFieldCache::Rect &r, int x, int z)
+        {
+            r.minX = std::min(r.minX, x);
+            r.minZ = std::min(r.minZ, z);
+            r.maxX = std::max(r.maxX, x);
+            r.maxZ = std::max(r.maxZ, z);
+        };
+
+        for (const Batch &batch : m_batches)
+        {
+            auto &store = *ecs.stores.get(batch.archetypeId);
+            const auto &positions = store.positions();
+            const auto &targets = store.moveTargets();
+            const uint32_t n = store.size();
+
+            for (uint32_t k = batch.first; k < batch.first + batch.count; ++k)
+            {
+                const uint32_t i = m_batchRows[k];
+                if (i >= n)
+                    continue;
+                const auto &pos = positions[i];
+                const auto &tgt = targets[i];
+                if (!tgt.active || tgt.order == 0 || clearanceOf(store, i) != 0)
+                    continue;
+                if (!std::isfinite(pos.x) || !std::isfinite(pos.z) || !std::isfinite(tgt.x) || !std::isfinite(tgt.z))
+                    continue;
+
+                const int sx = clampI(m_grid->worldToGridX(pos.x), 0, W - 1);
+                const int sz = clampI(m_grid->worldToGridZ(pos.z), 0, H - 1);
+                const int tx = clampI(m_grid->worldToGridX(tgt.x), 0, W - 1);
+                const int tz = clampI(m_grid->worldToGridZ(tgt.z), 0, H - 1);
+
+                GroupOrder *g = nullptr;
+                for (GroupOrder &e : m_groups)
+                {
+                    if (e.order == tgt.order)
+                    {
+                        g = &e;
+                        break;
+                    }
+                }
+                if (!g)
+                {
+                    m_groups.push_back(GroupOrder{tgt.order, 0u, {tx, tz, tx, tz}, {sx, sz, sx, sz}, 0u});
+                    g = &m_groups.back();
+                }
+                ++g->count;
+                grow(g->goal, tx, tz);
+                grow(g->units, sx, sz);
+            }
+        }
+
+        for (GroupOrder &g : m_groups)
+        {
+            if (g.count < FLOW_FIELD_MIN_GROUP)
+                continue;
+            const FlowFieldCache::Rect area{
+                std::max(0, std::min(g.goal.minX, g.units.minX) - FLOW_FIELD_MARGIN_CELLS),
+                std::max(0, std::min(g.goal.minZ, g.units.minZ) - FLOW_FIELD_MARGIN_CELLS),
+                std::min(W - 1, std::max(g.goal.maxX, g.units.maxX) + FLOW_FIELD_MARGIN_CELLS),
+                std::min(H - 1, std::max(g.goal.maxZ, g.units.maxZ) + FLOW_FIELD_MARGIN_CELLS)};
+            g.field = m_flowFields.acquire(*m_grid, g.goal, area);
+        }
+    }
+
+    // Field of this frame's group order, if the unit starts on a cell it reaches (and is not
+    // already inside the goal rect; those finish with a short A*).
+    FlowFieldCache::Handle findGroupField(uint32_t order, const Engine::ECS::Position &pos) const
+    {
+        for (const GroupOrder &g : m_groups)
+        {
+            if (g.order != order || g.field == 0)
+                continue;
+            const float c = m_flowFields.costAt(g.field, m_grid->worldToGridX(pos.x), m_grid->worldToGridZ(pos.z));
+            return (c > 0.0f && c < FlowFieldCache::Unreachable) ? g.field : 0u;
+        }
+        return 0u;
+    }
+
+    // Resets the Path of every dirty row; rows that need a search are queued.
+    void intake(Engine::ECS::ECSContext &ecs)
+    {
+        // Lanes pull from the shared queue, so longest searches first is the balanced split:
+        // short ones fill in behind and no lane starts a long A* last. Only when the queue is
+        // drained in parallel with no budget; otherwise arrival order decides who waits.
+        const bool longestFirst = !m_deterministic && m_budgetMs <= 0.0f && workBudget() == UNLIMITED_WORK &&
+                                  ecs.jobSystem && ecs.jobSystem->workerCount() > 0;
+        size_t queuedBefore[PRIORITY_COUNT];
+        for (uint32_t p = 0; p < PRIORITY_COUNT; ++p)
+            queuedBefore[p] = m_queue[p].size();
+
+        for (const Batch &batch : m_batches)
+        {
+            auto &store = *ecs.stores.get(batch.archetypeId);
+            const auto &positions = store.positions();
+            const auto &targets = store.moveTargets();
+            auto paths = store.paths();
+            const auto &ents = store.entities();
+            const uint32_t n = store.size();
+
+            for (uint32_t k = batch.first; k < batch.first + batch.count; ++k)
+            {
+                const uint32_t i = m_batchRows[k];
+                if (i >= n)
+                    continue;
+
+                const auto &tgt = targets[i];
+                auto &path = paths[i];
+
+                // MoveTarget became dirty => treat this as a new goal and replan.
+                // (SteeringSystem no longer marks MoveTarget dirty each frame, except near the
+                // end of a partial path or when it leaves a flow field.)
+                path.valid = false;
+                path.partial = false;
+                path.flowField = 0;
+                path.waypoints = 0;
+                path.count = 0;
+                path.current = 0;
+                path.corridorCell = 0;
+                path.offCorridor = false;
+
+                const Engine::ECS::Entity e = ents[i];
+                if (m_latestSeq.size() <= e.index)
+                    m_latestSeq.resize(static_cast<size_t>(e.index) + 1u, 0u);
+
+                // Anything still queued or parked for this entity is obsolete now.
+                if (++m_seqCounter == 0)
+                    m_seqCounter = 1;
+                m_latestSeq[e.index] = m_seqCounter;
+
+                if (!tgt.active)
+                    continue;
+
+                if (tgt.order != 0 && m_useFlowFields && clearanceOf(store, i) == 0)
+                {
+                    const FlowFieldCache::Handle h = findGroupField(tgt.order, positions[i]);
+                    if (h != 0)
+                    {
+                        path.flowField = h;
+                        path.valid = true;
+                        continue;
+                    }
+                }
+
+                const Priority prio = (tgt.order != 0) ? PRIORITY_ORDER : PRIORITY_REPATH;
+                // Straight-line meters: a cheap stand-in for the search length.
+                const float dx = tgt.x - positions[i].x;
+                const float dz = tgt.z - positions[i].z;
+                const uint32_t cost = static_cast<uint32_t>(std::min(std::sqrt(dx * dx + dz * dz), 1.0e9f));
+                m_queue[prio].push_back(Request{e, m_seqCounter, cost});
+                ++m_stats.requestsQueued;
+            }
+        }
+
+        if (longestFirst)
+        {
+            for (uint32_t p = 0; p < PRIORITY_COUNT; ++p)
+                std::stable_sort(m_queue[p].begin() + static_cast<std::ptrdiff_t>(queuedBefore[p]), m_queue[p].end(),
+                                 [](const Request &a, const Request &b)
+                                 { return a.cost > b.cost; });
+        }
+    }
+
+    uint8_t clearanceOf(const Engine::ECS::ArchetypeStore &store, uint32_t row) const
+    {
+        return store.hasRadius() ? m_grid->clearanceFor(store.radii()[row].r) : uint8_t(0);
+    }
+
+    bool isLatest(const Request &r) const
+    {
+        return r.entity.index < m_latestSeq.size() && m_latestSeq[r.entity.index] == r.seq;
+    }
+
+    bool popRequest(Request &out)
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        for (auto &queue : m_queue)
+        {
+            if (queue.empty())
+                continue;
+            out = queue.front();
+            queue.pop_front();
+            return true;
+        }
+        return false;
+    }
+
+    struct RowRef
+    {
+        Engine::ECS::ArchetypeStore *store = nullptr;
+        uint32_t row = 0;
+    };
+
+    // Where the request's entity lives now, if it still matches this system's query.
+    RowRef resolve(Engine::ECS::ECSContext &ecs, const Request &r) const
+    {
+        const Engine::ECS::EntityRecord *rec = ecs.entities.find(r.entity);
+        if (!rec)
+            return {};
+        Engine::ECS::ArchetypeStore *store = ecs.stores.get(rec->archetypeId);
+        if (!store || rec->row >= store->size())
+            return {};
+        if (!store->signature().containsAll(required()) || !store->signature().containsNone(excluded()))
+            return {};
+        return RowRef{store, rec->row};
+    }
+
+    // Serves requests (and the parked search, if any) until the queue is empty or the
+    // deadline passes. Always makes some progress, even on a zero budget.
+    void runLane(Engine::ECS::ECSContext &ecs, WorkerScratch &s, Clock::time_point deadline, bool unlimited)
+    {
+        bool first = true;
+        while (first || unlimited || Clock::now() < deadline)
+        {
+            first = false;
+
+            if (s.search.active)
+            {
+                if (!isLatest(s.search.request))
+                {
+                    s.search.active = false;
+                    ++s.superseded;
+                    continue;
+                }
+                if (stepSearch(s, SEARCH_SLICE_NODES))
+                    completeSearch(ecs, s);
+                continue;
+            }
+
+            if (m_plansLimited && m_plansLeft.load(std::memory_order_relaxed) <= 0)
+                break; // the rest waits in the queue
+            Request r;
+            if (!popRequest(r))
+                break;
+            if (!isLatest(r))
+            {
+                ++s.superseded;
+                continue;
+            }
+            const RowRef ref = resolve(ecs, r);
+            if (!ref.store)
+            {
+                ++s.superseded;
+                continue;
+            }
+
+            auto &tgt = ref.store->moveTargets()[ref.row];
+            auto &path = ref.store->paths()[ref.row];
+            if (!tgt.active)
+            {
+                ++s.superseded;
+                continue;
+            }
+
+            if (m_plansLimited)
+                m_plansLeft.fetch_sub(1, std::memory_order_relaxed);
+            ++s.plansStarted;
+
+            const float oldTx = tgt.x;
+            const float oldTz = tgt.z;
+            s.search.request = r;
+            if (beginPlan(s, ref.store->positions()[ref.row], clearanceOf(*ref.store, ref.row), tgt, path))
+                ++s.plansCompleted;
+            if (tgt.x != oldTx || tgt.z != oldTz)
+                s.goalChanged.push_back(r.entity);
+        }
+    }
+
+    // The lane's flat search ended: write the path if the request is still current.
+    void completeSearch(Engine::ECS::ECSContext &ecs, WorkerScratch &s)
+    {
+        s.search.active = false;
+        const RowRef ref = resolve(ecs, s.search.request);
+        if (!ref.store)
+        {
+            ++s.superseded;
+            return;
+        }
+        auto &tgt = ref.store->moveTargets()[ref.row];
+        if (!tgt.active)
+        {
+            ++s.superseded;
+            return;
+        }
+
+        collectFlatPath(s);
+        auto &path = ref.store->paths()[ref.row];
+        finishPath(s, false, path);
+        ++s.plansCompleted;
+    }
+
+    float heuristic(int x1, int z1, int x2, int z2) const
+    {
+        int dx = std::abs(x1 - x2);
+        int dz = std::abs(z1 - z2);
+        return static_cast<float>(std::max(dx, dz)) + 0.414f * static_cast<float>(std::min(dx, dz));
+    }
+
+    void ensureGridBuffers(WorkerScratch &s) const
+    {
+        const size_t gridSize = static_cast<size_t>(m_grid->width) * m_grid->height;
+        if (s.genStamp.size() < gridSize)
+        {
+            s.genStamp.resize(gridSize, 0);
+            s.gScores.resize(gridSize, 1e9f);
+            s.cameFrom.resize(gridSize, -1);
+            s.closedGen.resize(gridSize, 0);
+        }
+    }
+
+    static bool isVisited(const WorkerScratch &s, int idx) { return s.genStamp[idx] == s.currentGen; }
+    static bool isClosed(const WorkerScratch &s, int idx) { return s.closedGen[idx] == s.currentGen; }
+
+    static float getG(const WorkerScratch &s, int idx)
+    {
+        return isVisited(s, idx) ? s.gScores[idx] : 1e9f;
+    }
+
+    static void setG(WorkerScratch &s, int idx, float g, int parent)
+    {
+        s.genStamp[idx] = s.currentGen;
+        s.gScores[idx] = g;
+        s.cameFrom[idx] = parent;
+    }
+
+    static void setClosed(WorkerScratch &s, int idx)
+    {
+        s.closedGen[idx] = s.currentGen;
+    }
+
+    static void heapPush(WorkerScratch &s, int cellIdx, float f)
+    {
+        s.heapBuf.push_back({cellIdx, f});
+        std::push_heap(s.heapBuf.begin(), s.heapBuf.end(), std::greater<NodeEntry>{});
+    }
+
+    static NodeEntry heapPop(WorkerScratch &s)
+    {
+        std::pop_heap(s.heapBuf.begin(), s.heapBuf.end(), std::greater<NodeEntry>{});
+        NodeEntry n = s.heapBuf.back();
+        s.heapBuf.pop_back();
+        return n;
+    }
+
+    // Starts a weighted A* from startIdx toward targetIdx, restricted to bounds (inclusive grid
+    // rect), giving up after maxNodes. Run it with stepSearch.
+    void beginSearch(WorkerScratch &s, int startIdx, int targetIdx, const NavHierarchy::Rect &bounds, int maxNodes,
+                     uint8_t minClearance) const
+    {
+        const int W = m_grid->width;
+
+        ensureGridBuffers(s);
+        ++s.currentGen;
+        if (s.currentGen == 0)
+        {
+            std::fill(s.genStamp.begin(), s.genStamp.end(), 0u);
+            std::fill(s.closedGen.begin(), s.closedGen.end(), 0u);
+            s.currentGen = 1;
+        }
+
+        s.heapBuf.clear();
+        if (s.heapBuf.capacity() < 256)
+            s.heapBuf.reserve(256);
+
+        GridSearch &g = s.grid;
+        g.targetIdx = targetIdx;
+        g.bounds = bounds;
+        g.maxNodes = maxNodes;
+        g.minClearance = minClearance;
+        // JPS pruning assumes a diagonal's corner cells are as passable as any other; with a
+        // clearance they only need to be unblocked, so those searches stay on A*.
+        g.jump = (m_searchMode == SearchMode::JumpPoint && minClearance == 0);
+        g.nodesExplored = 0;
+        g.found = false;
+        g.closestIdx = startIdx;
+        g.closestFrom = -1;
+        g.closestVia = -1;
+        g.cellsScanned = 0;
+        g.closestH = heuristic(startIdx % W, startIdx / W, targetIdx % W, targetIdx / W);
+
+        setG(s, startIdx, 0.0f, -1);
+        heapPush(s, startIdx, kEpsilon * g.closestH);
+    }
+
+    // Expands up to nodeBudget nodes. Returns true once the search is over: s.grid.found tells
+    // whether the target was reached; endCell() is the target, or the closest explored cell.
+    bool stepSearch(WorkerScratch &s, int nodeBudget) const
+    {
+        if (s.grid.jump)
+            return stepJumpSearch(s, nodeBudget);
+
+        const int W = m_grid->width;
+        auto idx = [W](int x, int z)
+        { return z * W + x; };
+
+        GridSearch &g = s.grid;
+        const int targetX = g.targetIdx % W;
+        const int targetZ = g.targetIdx / W;
+
+        static constexpr int dxAddr[] = {0, 0, -1, 1, -1, -1, 1, 1};
+        static constexpr int dzAddr[] = {-1, 1, 0, 0, -1, 1, -1, 1};
+        static constexpr float costs[] = {1.0f, 1.0f, 1.0f, 1.0f, 1.414f, 1.414f, 1.414f, 1.414f};
+
+        for (int budget = 0; budget < nodeBudget; ++budget)
+        {
+            if (s.heapBuf.empty())
+                return true;
+
+            const NodeEntry current = heapPop(s);
+
+            if (isClosed(s, current.idx))
+            {
+                --budget;
+                continue;
+            }
+            setClosed(s, current.idx);
+
+            if (++g.nodesExplored > g.maxNodes)
+                return true;
+
+            if (current.idx == g.targetIdx)
+            {
+                g.found = true;
+                return true;
+            }
+
+            const float curG = getG(s, current.idx);
+            const float curH = (current.fCost / kEpsilon) - curG + 0.001f;
+            if (curH < g.closestH)
+            {
+                g.closestH = curH;
+                g.closestIdx = current.idx;
+            }
+
+            const int cx = current.idx % W;
+            const int cz = current.idx / W;
+
+            for (int i = 0; i < 8; ++i)
+            {
+                const int nx = cx + dxAddr[i];
+                const int nz = cz + dzAddr[i];
+
+                if (nx < g.bounds.minX || nx > g.bounds.maxX || nz < g.bounds.minZ || nz > g.bounds.maxZ)
+                    continue;
+
+                const int nIdx = idx(nx, nz);
+                if (m_grid->isBlocked(nIdx))
+                    continue;
+                if (g.minClearance != 0 && m_grid->clearance[nIdx] < g.minClearance)
+                    continue;
+                if (isClosed(s, nIdx))
+                    continue;
+
+                if (i >= 4)
+                {
+                    if (m_grid->isBlocked(idx(cx, nz)) || m_grid->isBlocked(idx(nx, cz)))
+                        continue;
+                }
+
+                const float newG = curG + costs[i];
+
+                if (newG < getG(s, nIdx))
+                {
+                    setG(s, nIdx, newG, current.idx);
+                    const float h = heuristic(nx, nz, targetX, targetZ);
+                    heapPush(s, nIdx, newG + kEpsilon * h);
+                }
+            }
+        }
+        return s.heapBuf.empty();
+    }
+
+    // Unblocked cell inside the search's bounds (JumpPoint searches have no clearance).
+    bool passable(const GridSearch &g, int x, int z) const
+    {
+        if (x < g.bounds.minX || x > g.bounds.maxX || z < g.bounds.minZ || z > g.bounds.maxZ)
+            return false;
+        return !m_grid->isBlocked(z * m_grid->width + x);
+    }
+
+    // Scans from (x, z) in direction (dx, dz) for the next jump point: the target, a cell with a
+    // forced neighbor, or (diagonally) a cell whose straight scans find one. -1 at a wall or
+    // once the search is out of work (one diagonal over open ground can scan a whole area).
+    // Open cells scanned from node `from` (through diagonal cell `via` for a probe, else -1)
+    // compete for the closest-cell fallback like expanded nodes do; from < 0 skips that.
+    int jump(WorkerScratch &s, int x, int z, int dx, int dz, int from, int via) const
+    {
+        GridSearch &g = s.grid;
+        const int W = m_grid->width;
+        const int targetX = g.targetIdx % W;
+        const int targetZ = g.targetIdx / W;
+        for (int run = 1;; x += dx, z += dz, ++run)
+        {
+            if (!passable(g, x, z) || workDone(g) > g.maxNodes)
+                return -1;
+            const int i = z * W + x;
+            ++g.cellsScanned;
+            if (i == g.targetIdx)
+                return i;
+            // Closed cells already have a chain (the scanning node may be on it).
+            const bool open = from >= 0 && !isClosed(s, i);
+            if (open)
+            {
+                const float h = heuristic(x, z, targetX, targetZ);
+                if (h < g.closestH)
+                {
+                    g.closestH = h;
+                    g.closestIdx = i;
+                    g.closestFrom = from;
+                    g.closestVia = via;
+                }
+            }
+            if (dx != 0 && dz != 0)
+            {
+                if (x == targetX || z == targetZ)
+                    return i; // lined up: the target is one straight run away
+                const int probeFrom = open ? from : -1;
+                if (jump(s, x + dx, z, dx, 0, probeFrom, i) >= 0 || jump(s, x, z + dz, 0, dz, probeFrom, i) >= 0)
+                    return i;
+                if (!passable(g, x + dx, z) || !passable(g, x, z + dz))
+                    return -1; // no corner cutting
+            }
+            else if (dx != 0)
+            {
+                // A side cell whose diagonal approach from behind is blocked can only be reached from here.
+                if ((passable(g, x, z - 1) && !passable(g, x - dx, z - 1)) ||
+                    (passable(g, x, z + 1) && !passable(g, x - dx, z + 1)))
+                    return i;
+            }
+            else
+            {
+                if ((passable(g, x - 1, z) && !passable(g, x - 1, z - dz)) ||
+                    (passable(g, x + 1, z) && !passable(g, x + 1, z - dz)))
+                    return i;
+            }
+            if (run >= JPS_MAX_RUN && (dx == 0 || dz == 0))
+                return i;
+        }
+    }
+
+    // Directions worth scanning from a node reached moving (dx, dz); all eight at the start.
+    int jumpDirections(const GridSearch &g, int x, int z, int dx, int dz, int (&out)[8][2]) const
+    {
+        int n = 0;
+        auto add = [&](int ox, int oz)
         {
-            Engine::ECS::ComponentMask dirty;
-            dirty.set(m_moveTargetId);
-            m_queryId = ecs.queries.createDirtyQuery(required(), excluded(), dirty, ecs.stores);
+            out[n][0] = ox;
+            out[n][1] = oz;
+            ++n;
+        };
+        if (dx == 0 && dz == 0)
+        {
+            for (int oz = -1; oz <= 1; ++oz)
+            {
+                for (int ox = -1; ox <= 1; ++ox)
+                {
+                    if ((ox != 0 || oz != 0) && passable(g, x + ox, z + oz) &&
+                        (ox == 0 || oz == 0 || (passable(g, x + ox, z) && passable(g, x, z + oz))))
+                        add(ox, oz);
+                }
+            }
+            return n;
         }
-
-        const auto &q = ecs.queries.get(m_queryId);
-        for (uint32_t archetypeId : q.matchingArchetypeIds)
+        if (dx != 0 && dz != 0)
         {
-            Engine::ECS::ArchetypeStore *storePtr = ecs.stores.get(archetypeId);
-            if (!storePtr)
-                continue;
-            auto &store = *storePtr;
+            const bool openX = passable(g, x + dx, z);
+            const bool openZ = passable(g, x, z + dz);
+            if (openX)
+                add(dx, 0);
+            if (openZ)
+                add(0, dz);
+            if (openX && openZ && passable(g, x + dx, z + dz))
+                add(dx, dz);
+            return n;
+        }
 
-            auto dirtyRows = ecs.queries.consumeDirtyRows(m_queryId, archetypeId);
-            if (dirtyRows.empty())
+        // Straight: ahead, plus each side (and the diagonal ahead toward it) that is forced,
+        // i.e. open while the cell behind it is blocked.
+        const int sx = dz != 0 ? 1 : 0; // side axis
+        const int sz = dx != 0 ? 1 : 0;
+        const bool ahead = passable(g, x + dx, z + dz);
+        if (ahead)
+            add(dx, dz);
+        for (int side = -1; side <= 1; side += 2)
+        {
+            const int ox = side * sx;
+            const int oz = side * sz;
+            if (!passable(g, x + ox, z + oz) || passable(g, x - dx + ox, z - dz + oz))
                 continue;
+            add(ox, oz);
+            if (ahead && passable(g, x + dx + ox, z + dz + oz))
+                add(dx + ox, dz + oz);
+        }
+        return n;
+    }
 
-            auto &positions = store.positions();
-            auto &targets = store.moveTargets();
-            auto &paths = store.paths();
-            const uint32_t n = store.size();
-
-            const uint32_t scratchCount = (ecs.jobSystem ? (ecs.jobSystem->workerCount() + 1u) : 1u);
-            if (m_workerScratch.size() < scratchCount)
-                m_workerScratch.resize(scratchCount);
-
-            auto processRow = [&](uint32_t workerIndex, uint32_t i) -> bool
-            {
-                if (i >= n)
-                    return false;
-
-                WorkerScratch &scratch = m_workerScratch[std::min(workerIndex, scratchCount - 1u)];
-
-                auto &pos = positions[i];
-                auto &tgt = targets[i];
-                auto &path = paths[i];
-
-                if (!tgt.active)
-                {
-                    path.valid = false;
-                    path.count = 0;
-                    path.current = 0;
-                    return false;
-                }
+    // stepSearch for SearchMode::JumpPoint: cameFrom links jump points, which lie on straight
+    // or diagonal lines of open cells from their parents.
+    bool stepJumpSearch(WorkerScratch &s, int nodeBudget) const
+    {
+        const int W = m_grid->width;
+        GridSearch &g = s.grid;
+        const int targetX = g.targetIdx % W;
+        const int targetZ = g.targetIdx / W;
 
-                // MoveTarget became dirty => treat this as a new goal and replan.
-                // (SteeringSystem no longer marks MoveTarget dirty each frame.)
-                path.valid = false;
-                path.count = 0;
-                path.current = 0;
+        const int sliceEnd = workDone(g) + nodeBudget;
+        while (workDone(g) < sliceEnd)
+        {
+            if (s.heapBuf.empty())
+                return endJumpSearch(s);
 
-                const float oldTx = tgt.x;
-                const float oldTz = tgt.z;
+            const NodeEntry current = heapPop(s);
+            if (isClosed(s, current.idx))
+                continue;
+            setClosed(s, current.idx);
 
-                runAStar(scratch, pos, tgt, path);
+            ++g.nodesExplored;
+            if (workDone(g) > g.maxNodes)
+                return endJumpSearch(s);
 
-                return (tgt.x != oldTx || tgt.z != oldTz);
-            };
+            if (current.idx == g.targetIdx)
+            {
+                g.found = true;
+                return true;
+            }
 
-            if (ecs.jobSystem && dirtyRows.size() >= PARALLEL_DIRTY_ROW_THRESHOLD)
+            const float curG = getG(s, current.idx);
+            const float curH = (current.fCost / kEpsilon) - curG + 0.001f;
+            if (curH < g.closestH)
             {
-                std::vector<uint8_t> goalChanged;
-                goalChanged.resize(dirtyRows.size(), 0u);
+                g.closestH = curH;
+                g.closestIdx = current.idx;
+                g.closestFrom = -1;
+                g.closestVia = -1;
+            }
 
-                ecs.jobSystem->parallelFor(static_cast<uint32_t>(dirtyRows.size()), [&](uint32_t worker, uint32_t item)
-                                           {
-                                               const uint32_t row = dirtyRows[item];
-                                               if (processRow(worker, row))
-                                                   goalChanged[item] = 1u;
-                                           });
+            const int cx = current.idx % W;
+            const int cz = current.idx / W;
+            const int parent = s.cameFrom[current.idx];
+            const int pdx = parent < 0 ? 0 : (cx > parent % W) - (cx < parent % W);
+            const int pdz = parent < 0 ? 0 : (cz > parent / W) - (cz < parent / W);
 
-                // Keep other systems (and future frames) aware that the goal changed.
-                // Do this single-threaded to avoid any potential QueryManager resizing races.
-                for (uint32_t item = 0; item < static_cast<uint32_t>(dirtyRows.size()); ++item)
-                {
-                    if (!goalChanged[item])
-                        continue;
-                    ecs.markDirty(m_moveTargetId, archetypeId, dirtyRows[item]);
-                }
-            }
-            else
+            int dirs[8][2];
+            const int dirCount = jumpDirections(g, cx, cz, pdx, pdz, dirs);
+            for (int d = 0; d < dirCount; ++d)
             {
-                for (uint32_t i : dirtyRows)
+                const int dx = dirs[d][0];
+                const int dz = dirs[d][1];
+                const int j = jump(s, cx + dx, cz + dz, dx, dz, current.idx, -1);
+                if (j < 0 || isClosed(s, j))
+                    continue;
+
+                const int jx = j % W;
+                const int jz = j / W;
+                const int steps = std::max(std::abs(jx - cx), std::abs(jz - cz));
+                const float newG = curG + static_cast<float>(steps) * ((dx != 0 && dz != 0) ? 1.414f : 1.0f);
+                if (newG < getG(s, j))
                 {
-                    if (processRow(0u, i))
-                        ecs.markDirty(m_moveTargetId, archetypeId, i);
+                    setG(s, j, newG, current.idx);
+                    heapPush(s, j, newG + kEpsilon * heuristic(jx, jz, targetX, targetZ));
                 }
             }
         }
+        return s.heapBuf.empty() ? endJumpSearch(s) : false;
     }
 
-private:
-    const NavGrid *m_grid;
-    Engine::ECS::QueryId m_queryId = Engine::ECS::QueryManager::InvalidQuery;
-    uint32_t m_moveTargetId = Engine::ECS::ComponentRegistry::InvalidID;
-
-    struct NodeEntry
-    {
-        int idx;
-        float fCost;
-        bool operator>(const NodeEntry &o) const { return fCost > o.fCost; }
-    };
-
-    struct WorkerScratch
-    {
-        uint32_t currentGen = 0;
-        std::vector<uint32_t> genStamp;
-        std::vector<float> gScores;
-        std::vector<int> cameFrom;
-        std::vector<uint32_t> closedGen;
-
-        std::vector<NodeEntry> heapBuf;
-        std::vector<int> pathIndices;
-        std::vector<int> smoothedIdx;
-    };
-
-    std::vector<WorkerScratch> m_workerScratch;
-
-    static constexpr float kEpsilon = 1.2f;
+    // JumpPoint work in A* expansions, for slices and maxNodes alike: a search that can't reach
+    // its target gives up after about as much work as A* would spend.
+    static int workDone(const GridSearch &g) { return g.nodesExplored + g.cellsScanned / JPS_SCANS_PER_NODE; }
 
-    float heuristic(int x1, int z1, int x2, int z2) const
+    // A failed search's closest cell may be a scanned one: link it back to the node that
+    // scanned it (through the diagonal cell for a probe), one straight run per link.
+    static bool endJumpSearch(WorkerScratch &s)
     {
-        int dx = std::abs(x1 - x2);
-        int dz = std::abs(z1 - z2);
-        return static_cast<float>(std::max(dx, dz)) + 0.414f * static_cast<float>(std::min(dx, dz));
+        const GridSearch &g = s.grid;
+        if (g.found || g.closestFrom < 0)
+            return true;
+        if (g.closestVia >= 0)
+        {
+            s.cameFrom[g.closestIdx] = g.closestVia;
+            s.cameFrom[g.closestVia] = g.closestFrom;
+        }
+        else
+        {
+            s.cameFrom[g.closestIdx] = g.closestFrom;
+        }
+        return true;
     }
 
-    void ensureGridBuffers(WorkerScratch &s) const
+    static int endCell(const WorkerScratch &s) { return s.grid.found ? s.grid.targetIdx : s.grid.closestIdx; }
+
+    // Search to completion (HPA refinement segments are small enough not to slice).
+    bool searchGrid(WorkerScratch &s, int startIdx, int targetIdx, const NavHierarchy::Rect &bounds, int maxNodes) const
     {
-        const size_t gridSize = static_cast<size_t>(m_grid->width) * m_grid->height;
-        if (s.genStamp.size() < gridSize)
+        beginSearch(s, startIdx, targetIdx, bounds, maxNodes, s.search.minClearance);
+        while (!stepSearch(s, SEARCH_SLICE_NODES))
         {
-            s.genStamp.resize(gridSize, 0);
-            s.gScores.resize(gridSize, 1e9f);
-            s.cameFrom.resize(gridSize, -1);
-            s.closedGen.resize(gridSize, 0);
         }
+        return s.grid.found;
     }
 
-    static bool isVisited(const WorkerScratch &s, int idx) { return s.genStamp[idx] == s.currentGen; }
-    static bool isClosed(const WorkerScratch &s, int idx) { return s.closedGen[idx] == s.currentGen; }
+    // Append the searched cells (fromIdx, endIdx] to out in walking order.
+    void appendChain(WorkerScratch &s, int fromIdx, int endIdx, std::vector<int> &out) const
+    {
+        s.chain.clear();
+        for (int i = endIdx; i != fromIdx && i >= 0; i = s.cameFrom[i])
+            pushLink(s, i, s.cameFrom[i], s.chain);
+        out.insert(out.end(), s.chain.rbegin(), s.chain.rend());
+    }
 
-    static float getG(const WorkerScratch &s, int idx)
+    // Pushes cell i and, for a jump point, the cells back toward its parent (excluded), so
+    // JumpPoint chains smooth from the same per-cell paths as A* ones.
+    void pushLink(const WorkerScratch &s, int i, int parent, std::vector<int> &out) const
     {
-        return isVisited(s, idx) ? s.gScores[idx] : 1e9f;
+        out.push_back(i);
+        if (!s.grid.jump || parent < 0)
+            return;
+        const int W = m_grid->width;
+        const int dx = (parent % W > i % W) - (parent % W < i % W);
+        const int dz = (parent / W > i / W) - (parent / W < i / W);
+        for (int c = i + dz * W + dx; c != parent; c += dz * W + dx)
+            out.push_back(c);
     }
 
-    static void setG(WorkerScratch &s, int idx, float g, int parent)
+    // Cells of the finished flat search (walking order, at most ~200 cells back from its end).
+    void collectFlatPath(WorkerScratch &s) const
     {
-        s.genStamp[idx] = s.currentGen;
-        s.gScores[idx] = g;
-        s.cameFrom[idx] = parent;
+        const int startIdx = s.search.startIdx;
+        s.pathIndices.clear();
+
+        int backIdx = endCell(s);
+        while (backIdx != startIdx)
+        {
+            const int pIdx = s.cameFrom[backIdx];
+            pushLink(s, backIdx, pIdx, s.pathIndices);
+            if (pIdx < 0)
+                break;
+            backIdx = pIdx;
+            if (s.pathIndices.size() > 200)
+                break;
+        }
+
+        std::reverse(s.pathIndices.begin(), s.pathIndices.end());
     }
 
-    static void setClosed(WorkerScratch &s, int idx)
+    static void clearPath(Engine::ECS::Path &path)
     {
-        s.closedGen[idx] = s.currentGen;
+        path.valid = false;
+        path.count = 0;
+        path.current = 0;
+        path.corridorCell = 0;
+        path.offCorridor = false;
     }
 
-    void runAStar(WorkerScratch &s, const Engine::ECS::Position &startPos, Engine::ECS::MoveTarget &target, Engine::ECS::Path &outPath) const
+    // Validates start/goal and plans. Returns true when outPath was written now (HPA route,
+    // trivial or failed plan); false means a flat search was started in the lane
+    // (s.search.active) and completeSearch writes the path when it ends. minClearance is the
+    // unit's NavGrid::clearanceFor; it is dropped if no cell near the start has that much.
+    bool beginPlan(WorkerScratch &s, const Engine::ECS::Position &startPos, uint8_t minClearance,
+                   Engine::ECS::MoveTarget &target, Engine::ECS::Path &outPath) const
     {
         const int W = m_grid->width;
         const int H = m_grid->height;
@@ -224,10 +1203,8 @@ private:
         if (!std::isfinite(startPos.x) || !std::isfinite(startPos.z) ||
             !std::isfinite(target.x) || !std::isfinite(target.z))
         {
-            outPath.valid = false;
-            outPath.count = 0;
-            outPath.current = 0;
-            return;
+            clearPath(outPath);
+            return true;
         }
 
         auto clampI = [](int v, int lo, int hi)
@@ -236,9 +1213,9 @@ private:
                                             : v;
         };
 
-        auto tryRelocateToWalkable = [&](int &x, int &z) -> bool
+        auto tryRelocateToWalkable = [&](int &x, int &z, uint8_t need) -> bool
         {
-            if (m_grid->isWalkable(x, z))
+            if (m_grid->fits(x, z, need))
                 return true;
 
             for (int r = 1; r <= 10; ++r)
@@ -254,7 +1231,7 @@ private:
                         int nz = z + dz;
                         if (!m_grid->isValid(nx, nz))
                             continue;
-                        if (m_grid->isWalkable(nx, nz))
+                        if (m_grid->fits(nx, nz, need))
                         {
                             x = nx;
                             z = nz;
@@ -268,10 +1245,6 @@ private:
 
         auto idx = [W](int x, int z)
         { return z * W + x; };
-        auto idxToX = [W](int i)
-        { return i % W; };
-        auto idxToZ = [W](int i)
-        { return i / W; };
 
         int startX = clampI(m_grid->worldToGridX(startPos.x), 0, W - 1);
         int startZ = clampI(m_grid->worldToGridZ(startPos.z), 0, H - 1);
@@ -280,24 +1253,24 @@ private:
 
         // If the entity starts inside an inflated/blocked cell, nudge the start cell to the nearest
         // walkable cell so we don't produce invalid indices or dead-end A*.
-        if (!tryRelocateToWalkable(startX, startZ))
+        if (!tryRelocateToWalkable(startX, startZ, minClearance))
         {
-            outPath.valid = false;
-            outPath.count = 0;
-            outPath.current = 0;
-            return;
+            minClearance = 0; // wedged in a narrow spot: plan as a small unit
+            if (!tryRelocateToWalkable(startX, startZ, 0))
+            {
+                clearPath(outPath);
+                return true;
+            }
         }
 
         bool relocatedTarget = false;
 
-        if (!m_grid->isWalkable(targetX, targetZ))
+        if (!m_grid->fits(targetX, targetZ, minClearance))
         {
-            if (!tryRelocateToWalkable(targetX, targetZ))
+            if (!tryRelocateToWalkable(targetX, targetZ, minClearance) && !tryRelocateToWalkable(targetX, targetZ, 0))
             {
-                outPath.valid = false;
-                outPath.count = 0;
-                outPath.current = 0;
-                return;
+                clearPath(outPath);
+                return true;
             }
             relocatedTarget = true;
         }
@@ -314,12 +1287,36 @@ private:
         const int startIdx = idx(startX, startZ);
         const int targetIdx = idx(targetX, targetZ);
 
+        s.search.startIdx = startIdx;
+        s.search.targetIdx = targetIdx;
+        s.search.minClearance = minClearance;
+        s.search.targetX = target.x;
+        s.search.targetZ = target.z;
+
         if (startIdx == targetIdx)
         {
             outPath.valid = true;
             outPath.count = 0;
             outPath.current = 0;
-            return;
+            return true;
+        }
+
+        if (m_usePathCache)
+        {
+            uint32_t count = 0;
+            bool partial = false;
+            const PathStore::Handle h = m_pathCache.find(*m_grid, startIdx, targetIdx, minClearance, count, partial);
+            if (h != 0)
+            {
+                outPath.waypoints = h;
+                outPath.count = count;
+                outPath.current = 0;
+                outPath.corridorCell = 0;
+                outPath.offCorridor = false;
+                outPath.partial = partial;
+                outPath.valid = true;
+                return true;
+            }
         }
 
         // NOTE: lineCheckGrid shortcut removed — it produced count=0 (direct
@@ -327,128 +1324,69 @@ private:
         // walk into obstacles before correcting.  A* always runs now; path
         // smoothing still uses lineCheckGrid to optimize waypoints afterward.
 
-        ensureGridBuffers(s);
-        ++s.currentGen;
-        if (s.currentGen == 0)
-        {
-            std::fill(s.genStamp.begin(), s.genStamp.end(), 0u);
-            std::fill(s.closedGen.begin(), s.closedGen.end(), 0u);
-            s.currentGen = 1;
-        }
-
-        s.heapBuf.clear();
-        if (s.heapBuf.capacity() < 256)
-            s.heapBuf.reserve(256);
-
-        auto heapPush = [&](int cellIdx, float f)
-        {
-            s.heapBuf.push_back({cellIdx, f});
-            std::push_heap(s.heapBuf.begin(), s.heapBuf.end(), std::greater<NodeEntry>{});
-        };
-        auto heapPop = [&]() -> NodeEntry
-        {
-            std::pop_heap(s.heapBuf.begin(), s.heapBuf.end(), std::greater<NodeEntry>{});
-            NodeEntry n = s.heapBuf.back();
-            s.heapBuf.pop_back();
-            return n;
-        };
-
-        setG(s, startIdx, 0.0f, -1);
-        const float startH = heuristic(startX, startZ, targetX, targetZ);
-        heapPush(startIdx, kEpsilon * startH);
-
-        bool found = false;
-        int closestIdx = startIdx;
-        float closestH = startH;
-
-        int nodesExplored = 0;
-        constexpr int MAX_NODES = 4000;
-
-        static constexpr int dxAddr[] = {0, 0, -1, 1, -1, -1, 1, 1};
-        static constexpr int dzAddr[] = {-1, 1, 0, 0, -1, 1, -1, 1};
-        static constexpr float costs[] = {1.0f, 1.0f, 1.0f, 1.0f, 1.414f, 1.414f, 1.414f, 1.414f};
+        s.pathIndices.clear();
 
-        while (!s.heapBuf.empty())
+        const int spanX = std::abs(targetX - startX);
+        const int spanZ = std::abs(targetZ - startZ);
+        if (m_useHierarchy && m_hierarchy.ready() && std::max(spanX, spanZ) >= HPA_MIN_DISTANCE_CELLS &&
+            m_hierarchy.clusterOfCell(startIdx) != m_hierarchy.clusterOfCell(targetIdx) &&
+            m_hierarchy.findAbstractPath(*m_grid, startIdx, targetIdx, s.hpa, s.abstractCells, minClearance))
         {
-            const NodeEntry current = heapPop();
-
-            if (isClosed(s, current.idx))
-                continue;
-            setClosed(s, current.idx);
-
-            if (++nodesExplored > MAX_NODES)
-                break;
-
-            if (current.idx == targetIdx)
+            // Refine hop by hop; each hop stays inside (at most) two neighboring clusters.
+            uint32_t clusterHops = 0;
+            size_t k = 1;
+            for (; k < s.abstractCells.size(); ++k)
             {
-                found = true;
-                break;
-            }
+                const int from = s.abstractCells[k - 1];
+                const int to = s.abstractCells[k];
+                if (from == to)
+                    continue;
+                if (clusterHops >= HPA_REFINE_CLUSTER_HOPS)
+                    break;
 
-            const float curG = getG(s, current.idx);
-            const float curH = (current.fCost / kEpsilon) - curG + 0.001f;
-            if (curH < closestH)
-            {
-                closestH = curH;
-                closestIdx = current.idx;
+                const NavHierarchy::Rect bounds = m_hierarchy.refineBounds(from, to);
+                if (!searchGrid(s, from, to, bounds, HPA_SEGMENT_MAX_NODES))
+                    break;
+                appendChain(s, from, to, s.pathIndices);
+                if (m_hierarchy.clusterOfCell(from) == m_hierarchy.clusterOfCell(to))
+                    ++clusterHops;
             }
 
-            const int cx = idxToX(current.idx);
-            const int cz = idxToZ(current.idx);
-
-            for (int i = 0; i < 8; ++i)
+            if (!s.pathIndices.empty())
             {
-                const int nx = cx + dxAddr[i];
-                const int nz = cz + dzAddr[i];
-
-                if (nx < 0 || nx >= W || nz < 0 || nz >= H)
-                    continue;
-
-                const int nIdx = idx(nx, nz);
-                if (m_grid->blocked[nIdx])
-                    continue;
-                if (isClosed(s, nIdx))
-                    continue;
-
-                if (i >= 4)
-                {
-                    if (m_grid->blocked[idx(cx, nz)] || m_grid->blocked[idx(nx, cz)])
-                        continue;
-                }
-
-                const float newG = curG + costs[i];
-
-                if (newG < getG(s, nIdx))
-                {
-                    setG(s, nIdx, newG, current.idx);
-                    const float h = heuristic(nx, nz, targetX, targetZ);
-                    heapPush(nIdx, newG + kEpsilon * h);
-                }
+                finishPath(s, k < s.abstractCells.size(), outPath);
+                return true;
             }
         }
 
-        int backIdx = found ? targetIdx : closestIdx;
-        s.pathIndices.clear();
-
-        while (backIdx != startIdx)
+        // Flat A* over the whole grid, sliced by the lane.
+        const NavHierarchy::Rect all{0, 0, W - 1, H - 1};
+        beginSearch(s, startIdx, targetIdx, all, FLAT_MAX_NODES, minClearance);
+        if (stepSearch(s, SEARCH_SLICE_NODES))
         {
-            s.pathIndices.push_back(backIdx);
-            const int pIdx = s.cameFrom[backIdx];
-            if (pIdx < 0)
-                break;
-            backIdx = pIdx;
-            if (s.pathIndices.size() > 200)
-                break;
+            collectFlatPath(s);
+            finishPath(s, false, outPath);
+            return true;
         }
+        s.search.active = true;
+        return false;
+    }
 
-        std::reverse(s.pathIndices.begin(), s.pathIndices.end());
+    // Smooths s.pathIndices (from s.search.startIdx) into outPath's waypoints.
+    void finishPath(WorkerScratch &s, bool partial, Engine::ECS::Path &outPath) const
+    {
+        const int W = m_grid->width;
+        auto idxToX = [W](int i)
+        { return i % W; };
+        auto idxToZ = [W](int i)
+        { return i / W; };
 
         s.smoothedIdx.clear();
         s.smoothedIdx.reserve(s.pathIndices.size() + 1);
 
         constexpr size_t kMaxLookahead = 16;
 
-        int anchorX = startX, anchorZ = startZ;
+        int anchorX = idxToX(s.search.startIdx), anchorZ = idxToZ(s.search.startIdx);
         size_t pi = 0;
 
         while (pi < s.pathIndices.size())
@@ -460,7 +1398,7 @@ private:
             {
                 const int jx = idxToX(s.pathIndices[j]);
                 const int jz = idxToZ(s.pathIndices[j]);
-                if (!m_grid->lineCheckGrid(anchorX, anchorZ, jx, jz))
+                if (!m_grid->lineCheckGrid(anchorX, anchorZ, jx, jz, s.search.minClearance))
                     break;
                 bestAdvance = j;
             }
@@ -478,28 +1416,72 @@ private:
             s.smoothedIdx.push_back(s.pathIndices.back());
         }
 
-        outPath.count = 0;
-        outPath.current = 0;
-
+        s.waypointX.clear();
+        s.waypointZ.clear();
         for (size_t si = 0; si < s.smoothedIdx.size(); ++si)
         {
-            if (outPath.count >= Engine::ECS::Path::MAX_WAYPOINTS)
-                break;
-
+            // Partial plans end at the last refined cell, not at the target.
             const bool isLast = (si == s.smoothedIdx.size() - 1);
-            if (isLast)
+            if (isLast && !partial)
             {
-                outPath.waypointsX[outPath.count] = target.x;
-                outPath.waypointsZ[outPath.count] = target.z;
+                s.waypointX.push_back(s.search.targetX);
+                s.waypointZ.push_back(s.search.targetZ);
             }
             else
             {
-                outPath.waypointsX[outPath.count] = m_grid->gridToWorldX(idxToX(s.smoothedIdx[si]));
-                outPath.waypointsZ[outPath.count] = m_grid->gridToWorldZ(idxToZ(s.smoothedIdx[si]));
+                s.waypointX.push_back(m_grid->gridToWorldX(idxToX(s.smoothedIdx[si])));
+                s.waypointZ.push_back(m_grid->gridToWorldZ(idxToZ(s.smoothedIdx[si])));
+            }
+        }
+
+        // Corridor: the start cell plus the searched cells, kept only while every step is to a
+        // neighbor (a flat path cut short at ~200 cells doesn't reach back to the start).
+        s.corridor.clear();
+        s.corridor.push_back(static_cast<uint32_t>(s.search.startIdx));
+        for (int cell : s.pathIndices)
+        {
+            const int prev = static_cast<int>(s.corridor.back());
+            if (std::abs(idxToX(cell) - idxToX(prev)) > 1 || std::abs(idxToZ(cell) - idxToZ(prev)) > 1)
+            {
+                s.corridor.clear();
+                break;
             }
-            outPath.count++;
+            if (cell != prev)
+                s.corridor.push_back(static_cast<uint32_t>(cell));
         }
+        if (s.corridor.size() < 2u)
+            s.corridor.clear();
+
+        const uint32_t count = static_cast<uint32_t>(s.waypointX.size());
+        const PathStore::Handle h = m_paths.store(s.waypointX.data(), s.waypointZ.data(), count,
+                                                  s.corridor.data(), static_cast<uint32_t>(s.corridor.size()));
+        outPath.current = 0;
+        outPath.corridorCell = 0;
+        outPath.offCorridor = false;
+        outPath.partial = partial;
+        outPath.waypoints = h;
+        outPath.count = (h != 0) ? count : 0u;
+        outPath.valid = (h != 0) || count == 0; // a full store leaves the unit walking straight
+
+        // Later requesters get the same block.
+        if (m_usePathCache)
+            m_pathCache.store(*m_grid, s.search.startIdx, s.search.targetIdx, s.search.minClearance, h,
+                              s.waypointX.data(), s.waypointZ.data(), count, partial);
+    }
 
-        outPath.valid = true;
+    // Frees the PathStore blocks no Path column or cache entry references.
+    uint32_t sweepPaths(Engine::ECS::ECSContext &ecs)
+    {
+        m_paths.beginSweep();
+        for (const std::unique_ptr<Engine::ECS::ArchetypeStore> &store : ecs.stores.stores())
+        {
+            if (!store || !store->hasPath())
+                continue;
+            const auto paths = static_cast<const Engine::ECS::ArchetypeStore &>(*store).paths();
+            for (uint32_t row = 0; row < store->size(); ++row)
+                m_paths.mark(paths[row].waypoints);
+        }
+        m_pathCache.markLive(m_paths);
+        return m_paths.endSweep();
     }
 };
@@ -1,11 +1,20 @@
 #pragma once
 
+#include "ECS/CostBalancedBatches.h"
+#include "ECS/ModelRowBatches.h"
+#include "ECS/PosePalettePool.h"
 #include "ECS/SystemFormat.h"
+#include "ECS/VisibleRender.h"
 #include "assets/AssetManager.h"
+#include "Engine/Camera.h"
 #include "utils/JobSystem.h"
+#include "utils/SimdMat4.h"
 
 #include <algorithm>
+#include <cmath>
 #include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
@@ -20,17 +29,80 @@ public:
     // =====================
     // Pose evaluation is relatively heavy; parallelize once the dirty set is non-trivial.
     static constexpr uint32_t PARALLEL_DIRTY_ROW_THRESHOLD = 32;
+    // Beyond this camera distance, models cooked with baked palettes sample those instead of
+    // evaluating channels + hierarchy (<= 0 disables).
+    static constexpr float BAKED_POSE_DISTANCE_DEFAULT = 150.0f;
+    // Pose sharing bucket width used by the sample (see setPoseSharing); off by default.
+    static constexpr float POSE_SHARE_QUANTUM_SEC = 1.0f / 30.0f;
+    // Palette pool slots checked for dead owners per update (PosePalettePool::sweep).
+    static constexpr uint32_t PALETTE_SWEEP_SLOTS = 512;
+
+    // Animation LOD: rows whose projected size (bounding radius / half viewport height) is
+    // below fullRateScreenSize are re-posed every ceil(fullRateScreenSize / size) frames,
+    // up to maxInterval, and hold their last pose in between. Entities are staggered across
+    // those frames by index. maxEvaluationsPerFrame caps the remaining evaluations (0 = no
+    // cap); rows over the cap carry over to the next frame, ahead of new ones. Rows that just
+    // became visible or switched model are always evaluated and don't count.
+    // The scheduler's work budget (SystemBase::workBudget, one unit per such evaluation) caps
+    // them the same way, whichever of the two is lower.
+    struct AnimationLodPolicy
+    {
+        float fullRateScreenSize = 0.05f;
+        uint32_t maxInterval = 4;
+        uint32_t maxEvaluationsPerFrame = 0;
+    };
+
+    // Rotation key sampling: with mode Nlerp, raw rotation channels use the SIMD nlerp path
+    // (ModelAsset::RotationSampling) except on rows whose projected size reaches
+    // slerpScreenSize, the close-up "hero" units that keep exact slerp. Without a camera, or
+    // with slerpScreenSize <= 0, every row uses mode.
+    struct RotationSamplingPolicy
+    {
+        Engine::ModelAsset::RotationSampling mode = Engine::ModelAsset::RotationSampling::Slerp;
+        float slerpScreenSize = 0.25f;
+    };
 
     PoseUpdateSystem()
     {
         setRequiredNames({"RenderModel", "RenderAnimation", "PosePalette", "VisibilityState"});
         setExcludedNames({"Disabled", "Dead"});
+        setReadNames({"RenderModel", "RenderAnimation", "VisibilityState", "RenderTransform", "WorldBounds", "GpuPoseModels"});
+        setWriteNames({"PosePalette"});
     }
 
     const char *name() const override { return "PoseUpdateSystem"; }
 
     void setAssetManager(Engine::AssetManager *assets) { m_assets = assets; }
 
+    // Rows of these models still bump poseVersion (RenderSystem then forwards clip/time),
+    // but their palettes are evaluated by the render pass on the GPU.
+    void setGpuPoseModels(const Engine::ECS::GpuPoseModels *models) { m_gpuPoseModels = models; }
+
+    // Distance LOD for baked palettes; without a camera every row is evaluated exactly.
+    void setCamera(const Engine::Camera *camera) { m_camera = camera; }
+    void setBakedPoseDistance(float distance) { m_bakedPoseDistance = distance; }
+
+    // Needs the camera too; without one every dirty row is evaluated each frame.
+    void setAnimationLodPolicy(const AnimationLodPolicy &policy) { m_lodPolicy = policy; }
+    const AnimationLodPolicy &animationLodPolicy() const { return m_lodPolicy; }
+
+    void setRotationSampling(const RotationSamplingPolicy &policy) { m_rotationPolicy = policy; }
+    const RotationSamplingPolicy &rotationSampling() const { return m_rotationPolicy; }
+
+    // Pose sharing: dirty rows of one archetype that play the same clip of the same model
+    // with timeSec in the same timeQuantumSec bucket share one evaluation. The first row is
+    // evaluated at the bucket time and the others copy its palettes. Crossfading, baked and
+    // GPU-posed rows are not shared. 0 = off.
+    void setPoseSharing(float timeQuantumSec) { m_poseShareQuantum = std::max(timeQuantumSec, 0.0f); }
+
+    // Node / joint palettes of every CPU-posed row (PosePalette holds the slot).
+    const Engine::ECS::PosePalettePool &palettePool() const { return m_palettes; }
+
+    // Amortized work: visible rows due for an evaluation (counted by the animation LOD pass).
+    bool isAmortized() const override { return true; }
+    uint32_t workRemaining() const override { return m_lastDueRows; }
+    uint32_t workDone() const override { return m_lastBudgetedRows; }
+
     void buildMasks(Engine::ECS::ComponentRegistry &registry) override
     {
         Engine::ECS::SystemBase::buildMasks(registry);
@@ -47,6 +119,9 @@ public:
 
         ++m_frameCounter;
         m_lastStats = Stats{};
+        m_lastDueRows = 0;
+        m_lastBudgetedRows = 0;
+        m_lastStats.slotsFreed = m_palettes.sweep(ecs, PALETTE_SWEEP_SLOTS);
 
         if (m_queryId == Engine::ECS::QueryManager::InvalidQuery)
         {
@@ -57,6 +132,12 @@ public:
             m_queryId = ecs.queries.createDirtyQuery(required(), excluded(), dirty, ecs.stores);
         }
 
+        const bool animLod = m_camera && (m_lodPolicy.maxInterval > 1u || m_lodPolicy.maxEvaluationsPerFrame > 0u ||
+                                          workBudget() != UNLIMITED_WORK);
+        const float invTanHalfFov = m_camera ? 1.0f / std::max(std::tan(m_camera->GetFOV() * 0.5f), 1e-4f) : 0.0f;
+        uint32_t budgetLeft = (m_lodPolicy.maxEvaluationsPerFrame > 0u) ? m_lodPolicy.maxEvaluationsPerFrame : UINT32_MAX;
+        budgetLeft = std::min(budgetLeft, workBudget()); // UNLIMITED_WORK == UINT32_MAX
+
         const auto &q = ecs.queries.get(m_queryId);
         for (uint32_t archetypeId : q.matchingArchetypeIds)
         {
@@ -66,16 +147,38 @@ public:
             if (!store->hasRenderModel() || !store->hasRenderAnimation() || !store->hasPosePalette() || !store->hasVisibilityState())
                 continue;
 
-            auto dirtyRows = ecs.queries.consumeDirtyRows(m_queryId, archetypeId);
+            auto &dirtyRows = m_dirtyRows;
+            ecs.queries.consumeDirtyRows(m_queryId, archetypeId, dirtyRows);
+            m_lastStats.dirtyCandidates += static_cast<uint32_t>(dirtyRows.size());
+
+            // Rows held back on earlier frames come first so the budget can't starve them.
+            auto pendingIt = m_pendingRows.find(archetypeId);
+            if (pendingIt != m_pendingRows.end() && !pendingIt->second.empty())
+            {
+                std::vector<uint32_t> &pending = pendingIt->second;
+                pending.insert(pending.end(), dirtyRows.begin(), dirtyRows.end());
+                dirtyRows.swap(pending);
+                pending.clear();
+            }
+            else if (!animLod && pendingIt != m_pendingRows.end())
+            {
+                m_pendingRows.erase(pendingIt);
+            }
+            // Hidden rows stay as they are: only a model switch is evaluated off screen.
+            m_lastStats.skippedInvisible += dropHiddenRows(*store, dirtyRows);
             if (dirtyRows.empty())
                 continue;
 
-            m_lastStats.dirtyCandidates += static_cast<uint32_t>(dirtyRows.size());
+            if (animLod)
+                selectLodRows(*store, archetypeId, dirtyRows, invTanHalfFov, budgetLeft);
+            if (dirtyRows.empty())
+                continue;
 
-            auto &renderModels = store->renderModels();
-            auto &renderAnimations = store->renderAnimations();
-            auto &posePalettes = store->posePalettes();
-            const auto &visibilityStates = store->visibilityState();
+            auto renderModels = store->renderModels();
+            auto renderAnimations = store->renderAnimations();
+            auto posePalettes = store->posePalettes();
+            const auto renderTransforms = store->renderTransforms(); // empty when absent
+            const auto worldBounds = store->worldBounds();           // empty when absent
 
             const uint32_t scratchCount = (ecs.jobSystem ? (ecs.jobSystem->workerCount() + 1u) : 1u);
             if (m_workerScratch.size() < scratchCount)
@@ -85,8 +188,49 @@ public:
             for (uint32_t i = 0; i < scratchCount; ++i)
                 m_workerStats[i] = Stats{};
 
-            auto processRow = [&](uint32_t workerIndex, uint32_t row)
+            const std::unordered_set<uint64_t> *gpuPoseKeys =
+                (m_gpuPoseModels && !m_gpuPoseModels->modelKeys.empty()) ? &m_gpuPoseModels->modelKeys : nullptr;
+
+            const bool bakedLod = m_camera && !renderTransforms.empty() && m_bakedPoseDistance > 0.0f;
+            const glm::vec3 cameraPos = m_camera ? m_camera->GetPosition() : glm::vec3(0.0f);
+            const float bakedDistanceSq = m_bakedPoseDistance * m_bakedPoseDistance;
+            const bool heroSlerp = m_rotationPolicy.mode == Engine::ModelAsset::RotationSampling::Nlerp && m_camera && m_rotationPolicy.slerpScreenSize > 0.0f &&
+                                   (!worldBounds.empty() || !renderTransforms.empty());
+
+            // Grouped by model: each model's clips, channels and skins serve all its rows in a row.
+            m_batches.build(renderModels, store->size(), dirtyRows.data(), static_cast<uint32_t>(dirtyRows.size()), *m_assets);
+            dirtyRows.assign(m_batches.rows().begin(), m_batches.rows().end());
+            if (dirtyRows.empty())
+                continue;
+            m_batchGpuPosed.assign(m_batches.batches().size(), 0u);
+            if (gpuPoseKeys)
+            {
+                for (size_t b = 0; b < m_batches.batches().size(); ++b)
+                {
+                    const Engine::ModelHandle handle = m_batches.batches()[b].handle;
+                    const uint64_t modelKey = (static_cast<uint64_t>(handle.generation) << 32) | static_cast<uint64_t>(handle.id);
+                    m_batchGpuPosed[b] = (gpuPoseKeys->count(modelKey) != 0u) ? 1u : 0u;
+                }
+            }
+            m_batchCost.resize(m_batches.batches().size());
+            for (size_t b = 0; b < m_batches.batches().size(); ++b)
+            {
+                const Engine::ModelAsset *asset = m_batches.batches()[b].asset;
+                m_batchCost[b] = (asset && !m_batchGpuPosed[b])
+                                     ? 1u + static_cast<uint32_t>(asset->nodes.size()) + asset->totalJointCount
+                                     : 1u;
+            }
+
+            assignPaletteSlots(*store);
+
+            // Group rows by (model, clip, time bucket); leaders are evaluated first.
+            const bool sharing = m_poseShareQuantum > 0.0f;
+            const uint32_t followersBegin = sharing ? buildShareGroups(*store, dirtyRows) : 0u;
+
+            // dirtyIndex: position in dirtyRows (m_shareOrder when sharing).
+            auto processRow = [&](uint32_t workerIndex, uint32_t dirtyIndex)
             {
+                const uint32_t row = dirtyRows[dirtyIndex];
                 if (row >= store->size())
                     return;
 
@@ -97,9 +241,8 @@ public:
                 const Engine::ModelHandle handle = renderModels[row].handle;
                 auto &out = posePalettes[row];
 
-                const auto &visibility = visibilityStates[row];
-                const bool visible = visibility.visible;
-                const bool justBecameVisible = visibility.visible && !visibility.wasVisibleLastFrame;
+                const bool visible = store->rowVisible(row);
+                const bool justBecameVisible = visible && !store->rowWasVisible(row);
                 const bool modelChanged =
                     (out.sourceModelId != handle.id) ||
                     (out.sourceModelGeneration != handle.generation);
@@ -116,7 +259,8 @@ public:
                 if (justBecameVisible)
                     workerStats.justBecameVisible += 1u;
 
-                Engine::ModelAsset *asset = m_assets->getModel(handle);
+                const uint32_t batchIndex = m_batches.batchIndexOf(dirtyIndex);
+                Engine::ModelAsset *asset = m_batches.batches()[batchIndex].asset;
 
                 // Any write to the palette counts as a new version.
                 out.poseVersion += 1u;
@@ -127,32 +271,118 @@ public:
 
                 if (!asset || asset->nodes.empty())
                 {
-                    out.nodePalette.clear();
-                    out.jointPalette.clear();
                     out.nodeCount = 0;
                     out.jointCount = 0;
                     return;
                 }
 
                 const auto &anim = renderAnimations[row];
+                out.bakedSample = false;
+                if (bakedLod && asset->hasBakedAnimation())
+                {
+                    const glm::vec3 d = glm::vec3(renderTransforms[row].world[3]) - cameraPos;
+                    out.bakedSample = glm::dot(d, d) >= bakedDistanceSq;
+                }
+
+                if (m_batchGpuPosed[batchIndex])
+                {
+                    workerStats.gpuDeferred += 1u;
+                    return;
+                }
+
                 const uint32_t safeClip = (!asset->animClips.empty())
                                               ? std::min(anim.clipIndex, static_cast<uint32_t>(asset->animClips.size() - 1))
                                               : 0u;
-                const float timeSec = (!asset->animClips.empty()) ? anim.timeSec : 0.0f;
-
-                asset->evaluatePoseInto(safeClip, timeSec,
-                                        scratch.trs,
-                                        scratch.locals,
-                                        scratch.globals,
-                                        scratch.visited);
+                float timeSec = (!asset->animClips.empty()) ? anim.timeSec : 0.0f;
+                const bool shareable = sharing && anim.blendWeight >= 1.0f;
+                if (shareable)
+                    timeSec = static_cast<float>(ShareBucket(timeSec, m_poseShareQuantum)) * m_poseShareQuantum;
 
+                glm::mat4 *nodesOut = m_palettes.nodes(out);
+                if (!nodesOut)
+                {
+                    out.nodeCount = 0;
+                    out.jointCount = 0;
+                    return;
+                }
+                glm::mat4 *jointsOut = m_palettes.joints(out);
                 out.nodeCount = static_cast<uint32_t>(asset->nodes.size());
-                out.nodePalette = scratch.globals;
-
                 out.jointCount = asset->totalJointCount;
-                out.jointPalette.assign(out.jointCount, glm::mat4(1.0f));
 
-                if (out.jointCount > 0 && scratch.globals.size() == out.nodeCount)
+                if (out.bakedSample)
+                {
+                    asset->sampleBakedPoseInto(safeClip, timeSec, nodesOut, jointsOut);
+                    workerStats.baked += 1u;
+                    return;
+                }
+
+                // Cursors resume from last frame's key intervals; a new slot or clip resets them.
+                uint32_t *cursors = m_palettes.cursors(out);
+                if (out.keyCursorClip != safeClip)
+                {
+                    if (cursors)
+                        std::fill_n(cursors, asset->clipChannelCount(safeClip), 0u);
+                    out.keyCursorClip = safeClip;
+                }
+
+                if (shareable)
+                {
+                    const uint32_t leader = m_shareLeader[dirtyIndex];
+                    if (leader != dirtyIndex && m_shareReady[leader])
+                    {
+                        const auto &src = posePalettes[dirtyRows[leader]];
+                        std::copy_n(m_palettes.nodes(src), out.nodeCount, nodesOut);
+                        if (jointsOut)
+                            std::copy_n(m_palettes.joints(src), out.jointCount, jointsOut);
+                        workerStats.shared += 1u;
+                        return;
+                    }
+                }
+
+                Engine::ModelAsset::RotationSampling rotation = m_rotationPolicy.mode;
+                if (heroSlerp)
+                {
+                    const glm::vec3 center = !worldBounds.empty() ? worldBounds[row].center
+                                                                  : glm::vec3(renderTransforms[row].world[3]);
+                    const float radius = !worldBounds.empty() ? worldBounds[row].radius : 1.0f;
+                    const float dist = glm::length(center - cameraPos);
+                    const float size = (dist > radius) ? radius * invTanHalfFov / dist : 1.0f;
+                    if (size >= m_rotationPolicy.slerpScreenSize)
+                        rotation = Engine::ModelAsset::RotationSampling::Slerp;
+                }
+
+                if (anim.blendWeight < 1.0f && anim.blendFromClip < asset->animClips.size())
+                {
+                    asset->evaluateBlendedPoseInto(safeClip, timeSec,
+                                                   anim.blendFromClip, anim.blendFromTimeSec, anim.blendWeight,
+                                                   scratch.trs,
+                                                   scratch.blendTrs,
+                                                   scratch.locals,
+                                                   scratch.globals,
+                                                   scratch.visited,
+                                                   cursors,
+                                                   rotation);
+                    workerStats.blended += 1u;
+                }
+                else
+                {
+                    asset->evaluatePoseInto(safeClip, timeSec,
+                                            scratch.trs,
+                                            scratch.locals,
+                                            scratch.globals,
+                                            scratch.visited,
+                                            cursors,
+                                            rotation);
+                }
+
+                if (scratch.globals.size() == out.nodeCount)
+                    std::copy_n(scratch.globals.data(), out.nodeCount, nodesOut);
+                else
+                    std::fill_n(nodesOut, out.nodeCount, glm::mat4(1.0f));
+
+                if (jointsOut)
+                    std::fill_n(jointsOut, out.jointCount, glm::mat4(1.0f));
+                if (jointsOut && scratch.globals.size() == out.nodeCount)
                 {
                     for (const auto &skin : asset->skins)
                     {
@@ -168,28 +398,52 @@ public:
                                 continue;
 
                             const uint32_t outIx = skin.jointBase + j;
-                            if (outIx >= out.jointPalette.size())
+                            if (outIx >= out.jointCount)
                                 continue;
 
-                            out.jointPalette[outIx] = scratch.globals[nodeIx] * skin.inverseBind[j];
+                            Engine::simd::MulMat4(scratch.globals[nodeIx], skin.inverseBind[j], jointsOut[outIx]);
                         }
                     }
                 }
+
+                if (shareable)
+                    m_shareReady[dirtyIndex] = 1u;
+            };
+
+            // Runs dirty positions [begin, end) (through m_shareOrder when sharing).
+            auto processRange = [&](uint32_t begin, uint32_t end)
+            {
+                auto runOne = [&](uint32_t worker, uint32_t i)
+                {
+                    processRow(worker, sharing ? m_shareOrder[i] : i);
+                };
+                if (ecs.jobSystem && end - begin >= PARALLEL_DIRTY_ROW_THRESHOLD)
+                {
+                    // Rigs range from a prop to a full skeleton: balance batches by node + joint count.
+                    m_rowCosts.resize(end - begin);
+                    for (uint32_t i = begin; i < end; ++i)
+                        m_rowCosts[i - begin] = m_batchCost[m_batches.batchIndexOf(sharing ? m_shareOrder[i] : i)];
+                    m_balance.build(m_rowCosts.data(), end - begin,
+                                    Engine::ECS::CostBalancedBatches::batchCountFor(ecs.jobSystem));
+                    m_balance.run(ecs.jobSystem, [&](uint32_t worker, uint32_t k)
+                                  { runOne(worker, begin + k); });
+                }
+                else
+                {
+                    for (uint32_t i = begin; i < end; ++i)
+                        runOne(0u, i);
+                }
             };
 
-            if (ecs.jobSystem && dirtyRows.size() >= PARALLEL_DIRTY_ROW_THRESHOLD)
+            const uint32_t dirtyCount = static_cast<uint32_t>(dirtyRows.size());
+            if (sharing)
             {
-                ecs.jobSystem->parallelFor(static_cast<uint32_t>(dirtyRows.size()), [&](uint32_t worker, uint32_t item)
-                                           {
-                                               if (item >= dirtyRows.size())
-                                                   return;
-                                               processRow(worker, dirtyRows[item]);
-                                           });
+                processRange(0u, followersBegin);
+                processRange(followersBegin, dirtyCount);
             }
             else
             {
-                for (uint32_t row : dirtyRows)
-                    processRow(0u, row);
+                processRange(0u, dirtyCount);
             }
 
             for (uint32_t i = 0; i < scratchCount; ++i)
@@ -198,9 +452,16 @@ public:
                 m_lastStats.visibleEvaluated += m_workerStats[i].visibleEvaluated;
                 m_lastStats.justBecameVisible += m_workerStats[i].justBecameVisible;
                 m_lastStats.skippedInvisible += m_workerStats[i].skippedInvisible;
+                m_lastStats.gpuDeferred += m_workerStats[i].gpuDeferred;
+                m_lastStats.baked += m_workerStats[i].baked;
+                m_lastStats.blended += m_workerStats[i].blended;
+                m_lastStats.shared += m_workerStats[i].shared;
             }
         }
 
+        for (const auto &kv : m_pendingRows)
+            m_lastStats.held += static_cast<uint32_t>(kv.second.size());
+
 #if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
         if ((m_frameCounter % 120u) == 0u)
         {
@@ -210,6 +471,12 @@ public:
                       << " visibleEvaluated=" << m_lastStats.visibleEvaluated
                       << " justBecameVisible=" << m_lastStats.justBecameVisible
                       << " skippedInvisible=" << m_lastStats.skippedInvisible
+                      << " gpuDeferred=" << m_lastStats.gpuDeferred
+                      << " baked=" << m_lastStats.baked
+                      << " held=" << m_lastStats.held
+                      << " blended=" << m_lastStats.blended
+                      << " shared=" << m_lastStats.shared
+                      << " slotsFreed=" << m_lastStats.slotsFreed
                       << "\n";
         }
 #endif
@@ -223,19 +490,257 @@ private:
         uint32_t visibleEvaluated = 0;
         uint32_t justBecameVisible = 0;
         uint32_t skippedInvisible = 0;
+        uint32_t gpuDeferred = 0; // version bumped, palette left to the GPU pose pass
+        uint32_t baked = 0;       // sampled from baked palettes (distance LOD)
+        uint32_t held = 0;        // kept their last pose this frame (animation LOD / budget)
+        uint32_t blended = 0;     // crossfading: two clips mixed in one evaluation
+        uint32_t shared = 0;      // copied another row's palettes (pose sharing)
+        uint32_t slotsFreed = 0;  // palette pool slots reclaimed by the sweep
     };
 
+    struct PoseShareKey
+    {
+        uint64_t modelKey;
+        uint32_t clipIndex;
+        int32_t bucket;
+
+        bool operator==(const PoseShareKey &o) const
+        {
+            return modelKey == o.modelKey && clipIndex == o.clipIndex && bucket == o.bucket;
+        }
+    };
+
+    struct PoseShareKeyHash
+    {
+        size_t operator()(const PoseShareKey &k) const
+        {
+            uint64_t h = k.modelKey * 0x9E3779B97F4A7C15ull;
+            h ^= (static_cast<uint64_t>(k.clipIndex) << 32) ^ static_cast<uint32_t>(k.bucket);
+            h *= 0xBF58476D1CE4E5B9ull;
+            return static_cast<size_t>(h ^ (h >> 31));
+        }
+    };
+
+    static int32_t ShareBucket(float timeSec, float quantum)
+    {
+        return static_cast<int32_t>(std::floor(timeSec / quantum + 0.5f));
+    }
+
+    // Fills m_shareLeader (dirty index of the row each row copies, itself for leaders) and
+    // m_shareOrder (leaders, then followers). Returns where the followers start.
+    uint32_t buildShareGroups(const Engine::ECS::ArchetypeStore &store, const std::vector<uint32_t> &dirtyRows)
+    {
+        const uint32_t count = static_cast<uint32_t>(dirtyRows.size());
+        m_shareLeader.resize(count);
+        m_shareReady.assign(count, 0u);
+        m_shareOrder.clear();
+        m_shareOrder.reserve(count);
+        m_shareGroups.clear();
+
+        const auto &models = store.renderModels();
+        const auto &anims = store.renderAnimations();
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            m_shareLeader[i] = i;
+            const uint32_t row = dirtyRows[i];
+            if (row < store.size() && anims[row].blendWeight >= 1.0f)
+            {
+                const Engine::ModelHandle handle = models[row].handle;
+                const PoseShareKey key{(static_cast<uint64_t>(handle.generation) << 32) | static_cast<uint64_t>(handle.id),
+                                       anims[row].clipIndex, ShareBucket(anims[row].timeSec, m_poseShareQuantum)};
+                m_shareLeader[i] = m_shareGroups.try_emplace(key, i).first->second;
+            }
+            if (m_shareLeader[i] == i)
+                m_shareOrder.push_back(i);
+        }
+
+        const uint32_t followersBegin = static_cast<uint32_t>(m_shareOrder.size());
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            if (m_shareLeader[i] != i)
+                m_shareOrder.push_back(i);
+        }
+        return followersBegin;
+    }
+
+    // Gives the rows processRow will evaluate on the CPU a slot in their model's pool, and
+    // releases the slots of rows that switched to a model without one (missing, GPU-posed).
+    // Serial, so the parallel evaluation never grows the pool. Walks m_batches: one model's
+    // pool layout is worked out once for all its rows.
+    void assignPaletteSlots(Engine::ECS::ArchetypeStore &store)
+    {
+        const auto &entities = store.entities();
+        auto posePalettes = store.posePalettes();
+        const auto &rows = m_batches.rows();
+        const auto &batches = m_batches.batches();
+        for (size_t b = 0; b < batches.size(); ++b)
+        {
+            const auto &batch = batches[b];
+            const Engine::ModelHandle handle = batch.handle;
+            const uint64_t modelKey = (static_cast<uint64_t>(handle.generation) << 32) | static_cast<uint64_t>(handle.id);
+            const Engine::ModelAsset *asset = batch.asset;
+            const bool noSlot = !asset || asset->nodes.empty() || m_batchGpuPosed[b];
+
+            uint32_t cursorStride = 0;
+            if (!noSlot)
+            {
+                for (uint32_t c = 0; c < asset->animClips.size(); ++c)
+                    cursorStride = std::max(cursorStride, asset->clipChannelCount(c));
+            }
+
+            for (uint32_t i = batch.begin; i < batch.end; ++i)
+            {
+                const uint32_t row = rows[i];
+                auto &pose = posePalettes[row];
+                const bool modelChanged = pose.sourceModelId != handle.id || pose.sourceModelGeneration != handle.generation;
+                if (!modelChanged && (!store.rowVisible(row) || m_palettes.owns(pose, entities[row])))
+                    continue; // skipped as invisible, or already has its slot
+
+                if (noSlot)
+                {
+                    m_palettes.release(pose, entities[row]);
+                    continue;
+                }
+                m_palettes.acquire(modelKey, static_cast<uint32_t>(asset->nodes.size()), asset->totalJointCount, cursorStride,
+                                   entities[row], pose);
+            }
+        }
+    }
+
+    // Removes the rows processRow would skip (hidden, same model) from rows before batching and
+    // LOD selection; returns how many. Visibility is one bit test per row (store bitsets).
+    uint32_t dropHiddenRows(const Engine::ECS::ArchetypeStore &store, std::vector<uint32_t> &rows)
+    {
+        const uint32_t n = store.size();
+        const auto &renderModels = store.renderModels();
+        const auto &posePalettes = store.posePalettes();
+        uint32_t kept = 0;
+        for (uint32_t row : rows)
+        {
+            if (row < n && !store.rowVisible(row))
+            {
+                const Engine::ModelHandle handle = renderModels[row].handle;
+                const auto &pose = posePalettes[row];
+                if (pose.sourceModelId == handle.id && pose.sourceModelGeneration == handle.generation)
+                    continue;
+            }
+            rows[kept++] = row;
+        }
+        const uint32_t dropped = static_cast<uint32_t>(rows.size()) - kept;
+        rows.resize(kept);
+        return dropped;
+    }
+
+    // Animation LOD pre-pass: keeps the rows to evaluate this frame in 'rows' and moves the
+    // held ones (not on their stagger frame, or over budget) to m_pendingRows.
+    void selectLodRows(Engine::ECS::ArchetypeStore &store, uint32_t archetypeId, std::vector<uint32_t> &rows,
+                       float invTanHalfFov, uint32_t &budgetLeft)
+    {
+        const uint32_t n = store.size();
+        const auto &entities = store.entities();
+        const auto &renderModels = store.renderModels();
+        const auto &posePalettes = store.posePalettes();
+        const auto bounds = store.worldBounds();         // empty when absent
+        const auto transforms = store.renderTransforms(); // empty when absent
+        const glm::vec3 cameraPos = m_camera->GetPosition();
+
+        // Drop duplicates (a held row can turn dirty again) with a per-pass stamp.
+        if (m_rowStamp.size() < n)
+            m_rowStamp.resize(n, 0u);
+        m_stamp += 1u;
+        if (m_stamp == 0u)
+        {
+            std::fill(m_rowStamp.begin(), m_rowStamp.end(), 0u);
+            m_stamp = 1u;
+        }
+
+        std::vector<uint32_t> &held = m_pendingRows[archetypeId];
+        uint32_t kept = 0;
+        for (uint32_t row : rows)
+        {
+            if (row >= n || m_rowStamp[row] == m_stamp)
+                continue;
+            m_rowStamp[row] = m_stamp;
+
+            const bool visible = store.rowVisible(row);
+            const Engine::ModelHandle handle = renderModels[row].handle;
+            const auto &pose = posePalettes[row];
+            const bool forced = (visible && !store.rowWasVisible(row)) ||
+                                pose.sourceModelId != handle.id || pose.sourceModelGeneration != handle.generation;
+            if (forced || !visible)
+            {
+                // Invisible rows are rejected by processRow as before.
+                rows[kept++] = row;
+                continue;
+            }
+
+            uint32_t interval = 1u;
+            if (m_lodPolicy.maxInterval > 1u && (!bounds.empty() || !transforms.empty()))
+            {
+                const glm::vec3 center = !bounds.empty() ? bounds[row].center : glm::vec3(transforms[row].world[3]);
+                const float radius = !bounds.empty() ? bounds[row].radius : 1.0f;
+                const float dist = glm::length(center - cameraPos);
+                const float size = (dist > radius) ? radius * invTanHalfFov / dist : 1.0f;
+                if (size < m_lodPolicy.fullRateScreenSize)
+                {
+                    const float ratio = m_lodPolicy.fullRateScreenSize / std::max(size, 1e-6f);
+                    interval = static_cast<uint32_t>(std::min(std::ceil(ratio), static_cast<float>(m_lodPolicy.maxInterval)));
+                }
+            }
+
+            const bool due = (interval <= 1u) || ((m_frameCounter + entities[row].index) % interval) == 0u;
+            m_lastDueRows += due ? 1u : 0u;
+            if (due && budgetLeft > 0u)
+            {
+                if (budgetLeft != UINT32_MAX)
+                    budgetLeft -= 1u;
+                ++m_lastBudgetedRows;
+                rows[kept++] = row;
+            }
+            else
+            {
+                held.push_back(row);
+            }
+        }
+        rows.resize(kept);
+    }
+
     struct WorkerScratch
     {
         std::vector<Engine::ModelAsset::NodeTRS> trs;
+        std::vector<Engine::ModelAsset::NodeTRS> blendTrs; // crossfade source pose
         std::vector<glm::mat4> locals;
         std::vector<glm::mat4> globals;
         std::vector<uint8_t> visited;
     };
 
     Engine::AssetManager *m_assets = nullptr;
+    Engine::ECS::PosePalettePool m_palettes;
+    Engine::ECS::ModelRowBatches m_batches; // this archetype pass's dirty rows, grouped by model
+    std::vector<uint8_t> m_batchGpuPosed;   // per batch: palettes left to the GPU pose pass
+    std::vector<uint32_t> m_batchCost;      // per batch: evaluation cost estimate (nodes + joints)
+    std::vector<uint32_t> m_rowCosts;       // per dirty position of a parallel range
+    Engine::ECS::CostBalancedBatches m_balance;
+    const Engine::ECS::GpuPoseModels *m_gpuPoseModels = nullptr; // not owned
+    const Engine::Camera *m_camera = nullptr;                     // not owned
+    float m_bakedPoseDistance = BAKED_POSE_DISTANCE_DEFAULT;
+    AnimationLodPolicy m_lodPolicy{};
+    RotationSamplingPolicy m_rotationPolicy{};
+
+    // Animation LOD: rows held back per archetype, re-checked next frame.
+    std::unordered_map<uint32_t, std::vector<uint32_t>> m_pendingRows;
+    std::vector<uint32_t> m_rowStamp;
+    uint32_t m_stamp = 0;
+
+    // Pose sharing (per archetype pass, indexed by position in dirtyRows).
+    float m_poseShareQuantum = 0.0f;
+    std::unordered_map<PoseShareKey, uint32_t, PoseShareKeyHash> m_shareGroups;
+    std::vector<uint32_t> m_shareLeader;
+    std::vector<uint32_t> m_shareOrder;
+    std::vector<uint8_t> m_shareReady; // leader wrote CPU palettes this pass
 
     Engine::ECS::QueryId m_queryId = Engine::ECS::QueryManager::InvalidQuery;
+    std::vector<uint32_t> m_dirtyRows; // consumeDirtyRows scratch, reused across stores and frames
     uint32_t m_renderAnimId = Engine::ECS::ComponentRegistry::InvalidID;
     uint32_t m_renderModelId = Engine::ECS::ComponentRegistry::InvalidID;
     uint32_t m_visibilityStateId = Engine::ECS::ComponentRegistry::InvalidID;
@@ -245,4 +750,6 @@ private:
 
     uint32_t m_frameCounter = 0;
     Stats m_lastStats{};
+    uint32_t m_lastDueRows = 0;      // reached the evaluation cap last frame
+    uint32_t m_lastBudgetedRows = 0; // evaluated under it
 };
@@ -6,6 +6,8 @@
 #include <algorithm>
 #include <cmath>
 
+// World bounding sphere from a RenderTransform written by something other than
+// RenderTransformUpdateSystem (which fills WorldBounds in its own pass). Not needed alongside it.
 class RenderBoundsUpdateSystem : public Engine::ECS::SystemBase
 {
 public:
@@ -16,9 +18,11 @@ public:
 
     RenderBoundsUpdateSystem()
     {
-        // Requires render transform (world matrix) and render bounds (sphere data)
-        setRequiredNames({"RenderTransform", "RenderBounds"});
+        // Requires render transform (world matrix), the local sphere and its world-space output
+        setRequiredNames({"RenderTransform", "RenderBounds", "WorldBounds"});
         setExcludedNames({"Disabled", "Dead"});
+        setReadNames({"RenderTransform", "RenderBounds"});
+        setWriteNames({"WorldBounds"});
     }
 
     const char *name() const override { return "RenderBoundsUpdateSystem"; }
@@ -27,7 +31,7 @@ public:
     {
         Engine::ECS::SystemBase::buildMasks(registry);
         m_renderTransformId = registry.ensureId("RenderTransform");
-        m_renderBoundsId = registry.ensureId("RenderBounds");
+        m_worldBoundsId = registry.ensureId("WorldBounds");
         m_queryId = Engine::ECS::QueryManager::InvalidQuery;
     }
 
@@ -55,13 +59,15 @@ public:
                 continue;
             if (!store.signature().containsNone(excluded()))
                 continue;
-            if (!store.hasRenderTransform() || !store.hasRenderBounds())
+            if (!store.hasRenderTransform() || !store.hasRenderBounds() || !store.hasWorldBounds())
                 continue;
 
-            auto &renderTransforms = store.renderTransforms();
-            auto &renderBounds = store.renderBounds();
+            auto renderTransforms = store.renderTransforms();
+            const auto renderBounds = store.renderBounds();
+            auto worldBounds = store.worldBounds();
             const uint32_t n = store.size();
-            auto dirtyRows = ecs.queries.consumeDirtyRows(m_queryId, archetypeId);
+            auto &dirtyRows = m_dirtyRows;
+            ecs.queries.consumeDirtyRows(m_queryId, archetypeId, dirtyRows);
             if (dirtyRows.empty())
                 continue;
 
@@ -70,13 +76,14 @@ public:
                 if (row >= n)
                     return;
 
-                auto &bounds = renderBounds[row];
+                const auto &bounds = renderBounds[row];
+                auto &world = worldBounds[row];
                 const auto &transform = renderTransforms[row].world;
 
                 // Transform local sphere center to world space
                 glm::vec4 localCenter4{bounds.localCenter, 1.0f};
                 glm::vec4 worldCenter4 = transform * localCenter4;
-                bounds.worldCenter = glm::vec3(worldCenter4);
+                world.center = glm::vec3(worldCenter4);
 
                 // Scale the radius by the maximum scale component in the transform
                 // For uniform scaling, any axis works. For non-uniform, use max to be conservative.
@@ -85,9 +92,8 @@ public:
                 float scaleZ = glm::length(glm::vec3(transform[2]));
                 float maxScale = std::max({scaleX, scaleY, scaleZ});
 
-                bounds.worldRadius = bounds.localRadius * maxScale;
-                bounds.boundsVersion++;
-                ecs.markDirty(m_renderBoundsId, archetypeId, row);
+                world.radius = bounds.localRadius * maxScale;
+                ecs.markDirty(m_worldBoundsId, archetypeId, row);
             };
 
             if (ecs.jobSystem && dirtyRows.size() >= PARALLEL_DIRTY_ROW_THRESHOLD)
@@ -105,6 +111,7 @@ public:
 
 private:
     Engine::ECS::QueryId m_queryId = Engine::ECS::QueryManager::InvalidQuery;
+    std::vector<uint32_t> m_dirtyRows; // consumeDirtyRows scratch, reused across stores and frames
     uint32_t m_renderTransformId = Engine::ECS::ComponentRegistry::InvalidID;
-    uint32_t m_renderBoundsId = Engine::ECS::ComponentRegistry::InvalidID;
+    uint32_t m_worldBoundsId = Engine::ECS::ComponentRegistry::InvalidID;
 };
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "ECS/PosePalettePool.h"
 #include "ECS/SystemFormat.h"
 #include "ECS/VisibleRender.h"
 
@@ -8,17 +9,18 @@
 #include "Engine/Camera.h"
 #include "Engine/Renderer.h"
 #include "Engine/SModelRenderPassModule.h"
+#include "utils/FrameArena.h"
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <algorithm>
 #include <chrono>
 #include <cmath>
 #include <cstdint>
+#include <functional>
 #include <limits>
 #include <memory>
-#include <unordered_map>
-#include <unordered_set>
 #include <vector>
 
 #if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
@@ -28,14 +30,28 @@
 class RenderSystem : public Engine::ECS::SystemBase
 {
 public:
+    // =====================
+    // TUNING CONSTANTS
+    // =====================
+    // Slot tables of at least COMPACT_MIN_SLOTS that fall below COMPACT_START_FILL live slots
+    // move entities from the top of the table into the lowest free slots, COMPACT_MOVES_PER_FRAME
+    // at a time, until COMPACT_STOP_FILL; the emptied tail is trimmed off the pass's buffers.
+    static constexpr uint32_t COMPACT_MIN_SLOTS = 256;
+    static constexpr float COMPACT_START_FILL = 0.5f;
+    static constexpr float COMPACT_STOP_FILL = 0.9f;
+    static constexpr uint32_t COMPACT_MOVES_PER_FRAME = 256;
+
     explicit RenderSystem(Engine::AssetManager *assets = nullptr)
         : m_assets(assets)
     {
         // RenderModel provides the model handle.
-        // PosePalette provides per-entity node/joint palettes.
+        // PosePalette locates per-entity node/joint palettes in the PosePalettePool.
         // RenderTransform provides the cached world matrix.
         setRequiredNames({"RenderModel", "PosePalette", "RenderTransform"});
         setExcludedNames({"Disabled", "Dead"});
+        // RenderSlot holds each entity's slot in its model pass (O(1) lookup, no map).
+        setReadNames({"RenderModel", "PosePalette", "RenderTransform", "RenderAnimation", "VisibleRenderBuckets"});
+        setWriteNames({"Renderer", "GpuPoseModels", "RenderSlot"});
     }
 
     const char *name() const override { return "RenderModelSystem"; }
@@ -49,6 +65,30 @@ public:
     void setRenderer(Engine::Renderer *renderer) { m_renderer = renderer; }
     void setCamera(Engine::Camera *camera) { m_camera = camera; }
     void setVisibleBuckets(const Engine::ECS::VisibleRenderBuckets *buckets) { m_visibleBuckets = buckets; }
+    // CPU palettes (PoseUpdateSystem::palettePool()); without it CPU-posed slots get the rest pose.
+    void setPosePalettePool(const Engine::ECS::PosePalettePool *pool) { m_posePalettes = pool; }
+
+    // GPU culling: buckets carry every renderable; passes cull them against the frustum
+    // on the GPU from per-slot world bounds (WorldBounds), see SModelRenderPassModule.
+    void setGpuCulling(bool enable)
+    {
+        if (m_gpuCulling == enable)
+            return;
+        m_gpuCulling = enable;
+
+        // Slots uploaded before the switch have no bounds yet: re-send transforms (+bounds).
+        for (PassEntry &entry : m_passes)
+            std::fill(entry.allocator.slotTransformVersion.begin(), entry.allocator.slotTransformVersion.end(), kInvalidVersion);
+    }
+
+    // GPU pose evaluation: passes that can run smodel_pose.comp receive (clip, time) per
+    // slot instead of palettes; their models are listed in gpuPoseModels() so
+    // PoseUpdateSystem stops evaluating them. Other models keep the CPU path.
+    void setGpuPose(bool enable) { m_gpuPose = enable; }
+    const Engine::ECS::GpuPoseModels &gpuPoseModels() const { return m_gpuPoseModels; }
+
+    // Per-cluster culling of models cooked with meshlets (SModelRenderPassModule::setMeshletCulling).
+    void setMeshletCulling(bool enable) { m_meshletCulling = enable; }
 
     void update(Engine::ECS::ECSContext &ecs, float dt) override
     {
@@ -56,11 +96,6 @@ public:
         if (!m_assets || !m_renderer || !m_camera || !m_visibleBuckets)
             return;
 
-        auto entityKey = [](const Engine::ECS::Entity &e) -> uint64_t
-        {
-            return (static_cast<uint64_t>(e.generation) << 32) | static_cast<uint64_t>(e.index);
-        };
-
         m_frameCounter += 1u;
 
         Stats frameStats{};
@@ -71,14 +106,16 @@ public:
         const auto t0 = std::chrono::high_resolution_clock::now();
 #endif
 
-        // Drive passes directly from explicit visible buckets.
-        for (uint64_t key : m_visibleBuckets->activeModelKeys)
+        bool gpuPoseChanged = false;
+        const float viewportHeight = static_cast<float>(m_renderer->getRenderExtent().height);
+
+        // Drive passes directly from explicit visible buckets (one pass per model and LOD level).
+        for (uint32_t bucketIndex : m_visibleBuckets->activeBuckets)
         {
-            auto itBucket = m_visibleBuckets->byModel.find(key);
-            if (itBucket == m_visibleBuckets->byModel.end())
+            if (bucketIndex >= m_visibleBuckets->byModel.size())
                 continue;
 
-            const Engine::ECS::VisibleModelBucket &bucket = itBucket->second;
+            const Engine::ECS::VisibleModelBucket &bucket = m_visibleBuckets->byModel[bucketIndex];
             if (bucket.lastUsedFrame != m_visibleBuckets->frame)
                 continue;
             if (bucket.refs.empty())
@@ -91,23 +128,43 @@ public:
 
             frameStats.visibleModelBatches += 1u;
 
-            auto itPass = m_passes.find(key);
-            if (itPass == m_passes.end())
+            // Texture residency keeps the mip levels this on-screen size needs.
+            const float screenPixels = (bucket.maxScreenSize < std::numeric_limits<float>::max())
+                                           ? bucket.maxScreenSize * viewportHeight
+                                           : std::numeric_limits<float>::max();
+            m_assets->noteModelOnScreen(handle, screenPixels);
+
+            // Passes share the buckets' dense index.
+            if (bucketIndex >= m_passes.size())
+                m_passes.resize(static_cast<size_t>(bucketIndex) + 1u);
+            PassEntry &entry = m_passes[bucketIndex];
+            if (!entry.pass)
             {
-                PassEntry entry;
+                entry.modelKey = bucket.modelKey;
                 entry.pass = std::make_shared<Engine::SModelRenderPassModule>();
                 entry.pass->setAssets(m_assets);
                 entry.pass->setModel(handle);
+                entry.pass->setLod(bucket.lod);
                 entry.pass->setCamera(m_camera);
                 entry.pass->setEnabled(true);
                 m_renderer->registerPass(entry.pass);
-                itPass = m_passes.emplace(key, std::move(entry)).first;
             }
 
-            PassEntry &entry = itPass->second;
             entry.lastUsedFrame = m_frameCounter;
             entry.pass->setCamera(m_camera);
             entry.pass->setEnabled(true);
+            entry.pass->setGpuCulling(m_gpuCulling);
+            entry.pass->setGpuPose(m_gpuPose);
+            entry.pass->setMeshletCulling(m_meshletCulling);
+
+            // Switching pose source: every slot needs a pose from the new one.
+            const bool gpuPose = entry.pass->gpuPoseReady();
+            if (gpuPose != entry.gpuPose)
+            {
+                entry.gpuPose = gpuPose;
+                std::fill(entry.allocator.slotPoseVersion.begin(), entry.allocator.slotPoseVersion.end(), kInvalidVersion);
+                gpuPoseChanged = true;
+            }
 
             const uint32_t nodeCount = std::max<uint32_t>(static_cast<uint32_t>(asset->nodes.size()), 1u);
             const uint32_t jointCount = asset->totalJointCount;
@@ -117,62 +174,78 @@ public:
             alloc.activeSlots.clear();
             alloc.activeSlots.reserve(bucket.refs.size());
 
+            // Fragmented table (a big battle ended): entities above the live count move down into
+            // the lowest free slots, a bounded number per frame since each move re-uploads.
+            const uint32_t tableSlots = static_cast<uint32_t>(alloc.slotToEntity.size());
+            const uint32_t liveSlots = tableSlots - static_cast<uint32_t>(alloc.freeList.size());
+            if (!alloc.compacting && tableSlots >= COMPACT_MIN_SLOTS &&
+                static_cast<float>(liveSlots) < static_cast<float>(tableSlots) * COMPACT_START_FILL)
+                alloc.compacting = true;
+            uint32_t movesLeft = alloc.compacting ? COMPACT_MOVES_PER_FRAME : 0u;
+
+            // Every visible entity holds its own slot, so a wave coming into view grows the
+            // table once to the bucket size instead of doubling per push.
+            if (bucket.refs.size() > alloc.slotToEntity.capacity())
+                reserveSlots(alloc, bucket.refs.size());
+
+            // Buckets made only of obstacles (buildings, walls) go into the cached static shadow
+            // maps; anything that moves is redrawn into the per-frame overlay.
+            bool staticCasters = !bucket.refs.empty();
+
             // Allocate/refresh slots for visible entities and push incremental updates for dirty slots.
             for (const Engine::ECS::VisibleRenderRef &ref : bucket.refs)
             {
-                const uint64_t eKey = entityKey(ref.entity);
+                auto *storePtr = ecs.stores.get(ref.archetypeId);
+                if (!storePtr || ref.row >= storePtr->size() || !storePtr->hasRenderSlot())
+                    continue;
+                staticCasters = staticCasters && storePtr->hasObstacle();
 
-                auto itEnt = alloc.entityToSlot.find(eKey);
+                // The slot recorded on the entity is its own only while this pass's table agrees;
+                // after a LOD switch, a free or a row copy it is simply reallocated.
+                Engine::ECS::RenderSlot &renderSlot = storePtr->renderSlots()[ref.row];
+                uint32_t slot = renderSlot.slot;
                 bool isNew = false;
-                if (itEnt == alloc.entityToSlot.end())
+                if (renderSlot.bucket != bucketIndex || slot >= alloc.slotToEntity.size() ||
+                    !sameEntity(alloc.slotToEntity[slot], ref.entity))
                 {
-                    uint32_t slot = 0;
-                    if (!alloc.freeList.empty())
-                    {
-                        slot = alloc.freeList.back();
-                        alloc.freeList.pop_back();
-                        frameStats.reusedSlots += 1u;
-                    }
-                    else
-                    {
-                        slot = static_cast<uint32_t>(alloc.slotToEntity.size());
-                        alloc.slotToEntity.push_back(Engine::ECS::Entity{});
-                        alloc.slotSeenFrame.push_back(0u);
-                        frameStats.newSlots += 1u;
-                    }
-
-                    alloc.slotToEntity[slot] = ref.entity;
-                    alloc.slotSeenFrame[slot] = m_frameCounter;
-
-                    EntitySlotState st;
-                    st.slot = slot;
-                    st.lastTransformVersion = kInvalidVersion;
-                    st.lastPoseVersion = kInvalidVersion;
-                    itEnt = alloc.entityToSlot.emplace(eKey, st).first;
+                    slot = acquireSlot(alloc, ref.entity, frameStats);
                     isNew = true;
                 }
-
-                const uint32_t slot = itEnt->second.slot;
-                if (slot >= alloc.slotSeenFrame.size())
-                    continue;
+                else if (movesLeft > 0u && slot >= liveSlots && !alloc.freeList.empty() && alloc.freeList.front() < slot)
+                {
+                    // The old slot was active last frame and is not seen this frame: the sweep
+                    // below frees it.
+                    slot = acquireSlot(alloc, ref.entity, frameStats);
+                    isNew = true;
+                    movesLeft -= 1u;
+                    frameStats.movedSlots += 1u;
+                }
+                renderSlot.bucket = bucketIndex;
+                renderSlot.slot = slot;
 
                 alloc.slotSeenFrame[slot] = m_frameCounter;
                 alloc.activeSlots.push_back(slot);
 
                 const bool newlyVisible = isNew || ref.justBecameVisible;
-                const bool transformDirty = newlyVisible || (itEnt->second.lastTransformVersion != ref.transformVersion);
-                const bool poseDirty = newlyVisible || (itEnt->second.lastPoseVersion != ref.poseVersion);
+                const bool transformDirty = newlyVisible || (alloc.slotTransformVersion[slot] != ref.transformVersion);
+                const bool poseDirty = newlyVisible || (alloc.slotPoseVersion[slot] != ref.poseVersion);
 
                 if (transformDirty || poseDirty)
                 {
                     glm::mat4 world(1.0f);
                     const Engine::ECS::PosePalette *posePtr = nullptr;
+                    const Engine::ECS::WorldBounds *boundsPtr = nullptr;
+                    const Engine::ECS::RenderAnimation *animPtr = nullptr;
 
-                    auto *storePtr = ecs.stores.get(ref.archetypeId);
-                    if (storePtr && ref.row < storePtr->size() && storePtr->hasRenderTransform() && storePtr->hasPosePalette())
+                    if (storePtr->hasRenderTransform() && storePtr->hasPosePalette())
                     {
                         world = storePtr->renderTransforms()[ref.row].world;
                         posePtr = &storePtr->posePalettes()[ref.row];
+                        // Bounds feed GPU culling and shadow caster culling alike.
+                        if (storePtr->hasWorldBounds())
+                            boundsPtr = &storePtr->worldBounds()[ref.row];
+                        if (entry.gpuPose && storePtr->hasRenderAnimation())
+                            animPtr = &storePtr->renderAnimations()[ref.row];
                     }
 
                     // Ensure slot arrays exist on the render module.
@@ -181,23 +254,30 @@ public:
                     if (transformDirty)
                     {
                         entry.pass->setSlotWorld(slot, world);
-                        itEnt->second.lastTransformVersion = ref.transformVersion;
+                        if (boundsPtr)
+                            entry.pass->setSlotBounds(slot, boundsPtr->center, boundsPtr->radius);
+                        alloc.slotTransformVersion[slot] = ref.transformVersion;
                         frameStats.transformSlotUpdates += 1u;
                     }
 
                     if (poseDirty)
                     {
-                        if (posePtr)
+                        if (animPtr)
                         {
-                            const glm::mat4 *nodeSrc = posePtr->nodePalette.empty() ? nullptr : posePtr->nodePalette.data();
-                            const glm::mat4 *jointSrc = posePtr->jointPalette.empty() ? nullptr : posePtr->jointPalette.data();
+                            entry.pass->setSlotAnimation(slot, animPtr->clipIndex, animPtr->timeSec, posePtr->bakedSample,
+                                                         animPtr->blendFromClip, animPtr->blendFromTimeSec, animPtr->blendWeight);
+                        }
+                        else if (posePtr && m_posePalettes)
+                        {
+                            const glm::mat4 *nodeSrc = m_posePalettes->nodes(*posePtr);
+                            const glm::mat4 *jointSrc = m_posePalettes->joints(*posePtr);
                             entry.pass->setSlotPose(slot, nodeSrc, posePtr->nodeCount, jointSrc, posePtr->jointCount);
                         }
                         else
                         {
                             entry.pass->setSlotPose(slot, nullptr, 0, nullptr, 0);
                         }
-                        itEnt->second.lastPoseVersion = ref.poseVersion;
+                        alloc.slotPoseVersion[slot] = ref.poseVersion;
                         frameStats.poseSlotUpdates += 1u;
                     }
                 }
@@ -211,63 +291,73 @@ public:
                 if (alloc.slotSeenFrame[slot] == m_frameCounter)
                     continue;
 
-                const Engine::ECS::Entity e = alloc.slotToEntity[slot];
-                if (e.valid())
-                {
-                    const uint64_t eKey = entityKey(e);
-                    alloc.entityToSlot.erase(eKey);
-                }
-
-                alloc.slotToEntity[slot] = Engine::ECS::Entity{};
-                alloc.freeList.push_back(slot);
+                releaseSlot(alloc, slot);
                 frameStats.freedSlots += 1u;
             }
 
             alloc.lastActiveSlots = alloc.activeSlots;
 
+            // Free slots at the end of the table go away, and the pass's slot storage with them.
+            const uint32_t trimmed = trimFreeTail(alloc);
+            if (trimmed > 0u)
+            {
+                frameStats.trimmedSlots += trimmed;
+                entry.pass->trimSlotCapacity(static_cast<uint32_t>(alloc.slotToEntity.size()));
+            }
+            const size_t live = alloc.activeSlots.size();
+            if (alloc.compacting && static_cast<float>(live) >= static_cast<float>(alloc.slotToEntity.size()) * COMPACT_STOP_FILL)
+                alloc.compacting = false;
+
             // Submit active slot list every frame (small SSBO).
             entry.pass->ensureSlotCapacity(static_cast<uint32_t>(alloc.slotToEntity.size()));
             entry.pass->setActiveSlots(alloc.activeSlots.data(), static_cast<uint32_t>(alloc.activeSlots.size()));
+            entry.pass->setShadowCaster(staticCasters ? Engine::ShadowCaster::Static : Engine::ShadowCaster::Dynamic);
 
 #if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
             if ((m_frameCounter % 240u) == 0u)
             {
-                std::unordered_set<uint32_t> uniq;
-                uniq.reserve(alloc.activeSlots.size());
-                for (uint32_t s : alloc.activeSlots)
-                    uniq.insert(s);
-                if (uniq.size() != alloc.activeSlots.size())
+                Engine::FrameVector<uint32_t> sorted(alloc.activeSlots.begin(), alloc.activeSlots.end());
+                std::sort(sorted.begin(), sorted.end());
+                const size_t unique = static_cast<size_t>(std::unique(sorted.begin(), sorted.end()) - sorted.begin());
+                if (unique != alloc.activeSlots.size())
                 {
-                    std::cout << "[RenderSystem] WARNING duplicate slots in active list for modelKey=" << key
-                              << " active=" << alloc.activeSlots.size() << " unique=" << uniq.size() << "\n";
+                    std::cout << "[RenderSystem] WARNING duplicate slots in active list for bucket=" << bucketIndex
+                              << " active=" << alloc.activeSlots.size() << " unique=" << unique << "\n";
                 }
             }
 #endif
         }
 
-        // Disable passes that are not used this frame.
-        for (auto &kv : m_passes)
+        // A model is GPU-posed only while every one of its LOD passes is.
+        if (gpuPoseChanged)
         {
-            if (kv.second.lastUsedFrame != m_frameCounter)
+            m_gpuPoseModels.modelKeys.clear();
+            for (const PassEntry &entry : m_passes)
             {
-                kv.second.pass->setEnabled(false);
-                kv.second.pass->setActiveSlots(nullptr, 0);
-
-                // Inactive model => all instances invisible => free all slots.
-                ModelSlotAllocator &alloc = kv.second.allocator;
-                alloc.entityToSlot.clear();
-                alloc.lastActiveSlots.clear();
-                alloc.activeSlots.clear();
-
-                alloc.freeList.clear();
-                const uint32_t slots = static_cast<uint32_t>(alloc.slotToEntity.size());
-                alloc.freeList.reserve(slots);
-                for (uint32_t s = 0; s < slots; ++s)
-                {
-                    alloc.slotToEntity[s] = Engine::ECS::Entity{};
-                    alloc.slotSeenFrame[s] = 0u;
-                    alloc.freeList.push_back(s);
-                }
+                if (entry.pass && entry.gpuPose)
+                    m_gpuPoseModels.modelKeys.insert(entry.modelKey);
+            }
+            for (const PassEntry &entry : m_passes)
+            {
+                if (entry.pass && !entry.gpuPose)
+                    m_gpuPoseModels.modelKeys.erase(entry.modelKey);
+            }
+        }
+
+        // Disable passes that went unused this frame (once: nothing touches them while idle).
+        for (PassEntry &entry : m_passes)
+        {
+            if (entry.pass && entry.lastUsedFrame + 1u == m_frameCounter)
+            {
+                entry.pass->setEnabled(false);
+                entry.pass->setActiveSlots(nullptr, 0);
+
+                // Inactive model => all instances invisible => free all slots (entities' RenderSlot
+                // values no longer match the empty table).
+                ModelSlotAllocator &alloc = entry.allocator;
+                frameStats.freedSlots += static_cast<uint32_t>(alloc.lastActiveSlots.size());
+                alloc = ModelSlotAllocator{};
+                entry.pass->trimSlotCapacity(0);
             }
         }
 
@@ -281,6 +371,7 @@ public:
                       << " visible=" << frameStats.visibleProcessed
                       << " visibleBatches=" << frameStats.visibleModelBatches
                       << " slots(+new/reuse/free)=" << frameStats.newSlots << "/" << frameStats.reusedSlots << "/" << frameStats.freedSlots
+                      << " compaction(moved/trimmed)=" << frameStats.movedSlots << "/" << frameStats.trimmedSlots
                       << " slotUpdates(xform/pose)=" << frameStats.transformSlotUpdates << "/" << frameStats.poseSlotUpdates
                       << " updateMs=" << ms
                       << "\n";
@@ -288,6 +379,27 @@ public:
 #endif
     }
 
+    // Instance/palette buffers of every live pass plus the CPU side slot allocators.
+    void reportMemory(Engine::MemoryReport &out) const
+    {
+        using Engine::MemoryReport;
+        uint64_t slotBytes = 0;
+        uint32_t slots = 0;
+        for (const PassEntry &entry : m_passes)
+        {
+            if (entry.pass)
+                entry.pass->reportMemory(out);
+
+            const ModelSlotAllocator &alloc = entry.allocator;
+            slotBytes += MemoryReport::bytesOf(alloc.slotToEntity) + MemoryReport::bytesOf(alloc.slotSeenFrame) +
+                         MemoryReport::bytesOf(alloc.slotTransformVersion) + MemoryReport::bytesOf(alloc.slotPoseVersion) +
+                         MemoryReport::bytesOf(alloc.freeList) + MemoryReport::bytesOf(alloc.lastActiveSlots) +
+                         MemoryReport::bytesOf(alloc.activeSlots);
+            slots += static_cast<uint32_t>(alloc.slotToEntity.size());
+        }
+        out.add("Render", "Model slot allocators", slotBytes, 0, slots);
+    }
+
 private:
     struct Stats
     {
@@ -299,6 +411,8 @@ private:
         uint32_t newSlots = 0;
         uint32_t reusedSlots = 0;
         uint32_t freedSlots = 0;
+        uint32_t movedSlots = 0;   // compaction moves into lower slots
+        uint32_t trimmedSlots = 0; // free slots dropped from table ends
 
         uint32_t transformSlotUpdates = 0;
         uint32_t poseSlotUpdates = 0;
@@ -306,28 +420,95 @@ private:
 
     static constexpr uint32_t kInvalidVersion = std::numeric_limits<uint32_t>::max();
 
-    struct EntitySlotState
-    {
-        uint32_t slot = 0;
-        uint32_t lastTransformVersion = kInvalidVersion;
-        uint32_t lastPoseVersion = kInvalidVersion;
-    };
-
+    // Slot table of one pass. Entities point into it through RenderSlot; slotToEntity confirms.
     struct ModelSlotAllocator
     {
-        std::unordered_map<uint64_t, EntitySlotState> entityToSlot;
-        std::vector<Engine::ECS::Entity> slotToEntity;
+        std::vector<Engine::ECS::Entity> slotToEntity;  // invalid entity = free slot
         std::vector<uint32_t> slotSeenFrame;
-        std::vector<uint32_t> freeList;
+        std::vector<uint32_t> slotTransformVersion;    // versions last pushed to the pass
+        std::vector<uint32_t> slotPoseVersion;
+        std::vector<uint32_t> freeList;                // min-heap: lowest free slot first
+        bool compacting = false;
 
         std::vector<uint32_t> lastActiveSlots;
         std::vector<uint32_t> activeSlots;
     };
 
+    static bool sameEntity(const Engine::ECS::Entity &a, const Engine::ECS::Entity &b)
+    {
+        return a.index == b.index && a.generation == b.generation;
+    }
+
+    // Lowest free slot, or a new one at the end of the table.
+    static uint32_t acquireSlot(ModelSlotAllocator &alloc, const Engine::ECS::Entity &e, Stats &stats)
+    {
+        uint32_t slot = 0;
+        if (!alloc.freeList.empty())
+        {
+            std::pop_heap(alloc.freeList.begin(), alloc.freeList.end(), std::greater<uint32_t>());
+            slot = alloc.freeList.back();
+            alloc.freeList.pop_back();
+            stats.reusedSlots += 1u;
+        }
+        else
+        {
+            slot = static_cast<uint32_t>(alloc.slotToEntity.size());
+            alloc.slotToEntity.push_back(Engine::ECS::Entity{});
+            alloc.slotSeenFrame.push_back(0u);
+            alloc.slotTransformVersion.push_back(kInvalidVersion);
+            alloc.slotPoseVersion.push_back(kInvalidVersion);
+            stats.newSlots += 1u;
+        }
+
+        alloc.slotToEntity[slot] = e;
+        alloc.slotTransformVersion[slot] = kInvalidVersion;
+        alloc.slotPoseVersion[slot] = kInvalidVersion;
+        return slot;
+    }
+
+    static void reserveSlots(ModelSlotAllocator &alloc, size_t count)
+    {
+        alloc.slotToEntity.reserve(count);
+        alloc.slotSeenFrame.reserve(count);
+        alloc.slotTransformVersion.reserve(count);
+        alloc.slotPoseVersion.reserve(count);
+    }
+
+    static void releaseSlot(ModelSlotAllocator &alloc, uint32_t slot)
+    {
+        alloc.slotToEntity[slot] = Engine::ECS::Entity{};
+        alloc.freeList.push_back(slot);
+        std::push_heap(alloc.freeList.begin(), alloc.freeList.end(), std::greater<uint32_t>());
+    }
+
+    // Drop free slots from the end of the table; returns how many.
+    static uint32_t trimFreeTail(ModelSlotAllocator &alloc)
+    {
+        const size_t before = alloc.slotToEntity.size();
+        size_t size = before;
+        while (size > 0u && !alloc.slotToEntity[size - 1u].valid())
+            --size;
+        if (size == before)
+            return 0u;
+
+        alloc.slotToEntity.resize(size);
+        alloc.slotSeenFrame.resize(size);
+        alloc.slotTransformVersion.resize(size);
+        alloc.slotPoseVersion.resize(size);
+        alloc.freeList.erase(std::remove_if(alloc.freeList.begin(), alloc.freeList.end(),
+                                            [size](uint32_t slot)
+                                            { return slot >= size; }),
+                             alloc.freeList.end());
+        std::make_heap(alloc.freeList.begin(), alloc.freeList.end(), std::greater<uint32_t>());
+        return static_cast<uint32_t>(before - size);
+    }
+
     struct PassEntry
     {
         std::shared_ptr<Engine::SModelRenderPassModule> pass;
+        uint64_t modelKey = 0; // passes of a model's LOD levels share it
         uint32_t lastUsedFrame = 0;
+        bool gpuPose = false; // pass evaluates poses from setSlotAnimation()
         ModelSlotAllocator allocator;
     };
 
@@ -335,7 +516,12 @@ private:
     Engine::Renderer *m_renderer = nullptr;   // not owned
     Engine::Camera *m_camera = nullptr;       // not owned
     const Engine::ECS::VisibleRenderBuckets *m_visibleBuckets = nullptr; // not owned
+    const Engine::ECS::PosePalettePool *m_posePalettes = nullptr;        // not owned
 
-    std::unordered_map<uint64_t, PassEntry> m_passes;
+    std::vector<PassEntry> m_passes; // indexed by VisibleBucketIndex; pass == nullptr if never drawn
     uint32_t m_frameCounter = 0;
+    bool m_gpuCulling = false;
+    bool m_gpuPose = false;
+    bool m_meshletCulling = true;
+    Engine::ECS::GpuPoseModels m_gpuPoseModels;
 };
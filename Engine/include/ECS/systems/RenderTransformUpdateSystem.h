@@ -7,10 +7,17 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <algorithm>
 #include <cmath>
 
-// Updates Engine::ECS::RenderTransform from Position (+ optional Facing).
-// Uses dirty queries so it only runs when Position/Facing are marked dirty.
+// Updates Engine::ECS::RenderTransform from Position (+ optional Facing), and WorldBounds
+// (RenderBounds' sphere in world space) in the same pass (one read of the pose, matrix and sphere written together).
+// Uses dirty queries so it only runs when Position/Facing/RenderScale are marked dirty; rows that
+// never move (static props) are computed once at spawn and not touched again.
+// With a fixed simulation step, setInterpolationAlpha(alpha) draws entities that have a
+// PreviousTransform at lerp(previous tick, current tick, alpha); rows still between two different
+// poses are rebuilt every frame, the rest only when dirty. Per frame the cost follows the dirty and
+// interpolating rows only, so stores of resting (or asleep, SleepSystem) units cost nothing.
 class RenderTransformUpdateSystem : public Engine::ECS::SystemBase
 {
 public:
@@ -23,6 +30,8 @@ public:
     {
         setRequiredNames({"Position", "RenderTransform"});
         setExcludedNames({"Disabled", "Dead"});
+        setReadNames({"Position", "Facing", "PreviousTransform", "RenderModel", "RenderScale", "RenderBounds"});
+        setWriteNames({"RenderTransform", "WorldBounds"});
     }
 
     const char *name() const override { return "RenderTransformUpdateSystem"; }
@@ -34,9 +43,17 @@ public:
         m_facingId = registry.ensureId("Facing");
         m_renderScaleId = registry.ensureId("RenderScale");
         m_renderTransformId = registry.ensureId("RenderTransform");
+        m_worldBoundsId = registry.ensureId("WorldBounds");
+        m_previousId = registry.ensureId("PreviousTransform");
         m_queryId = Engine::ECS::QueryManager::InvalidQuery;
+        m_interpolating.clear();
+        m_lastVersion = 0;
     }
 
+    // Fraction of the fixed step elapsed since the last simulation tick (1 = current pose only).
+    void setInterpolationAlpha(float alpha) { m_alpha = std::clamp(alpha, 0.0f, 1.0f); }
+    float interpolationAlpha() const { return m_alpha; }
+
     void update(Engine::ECS::ECSContext &ecs, float /*dt*/) override
     {
         if (m_queryId == Engine::ECS::QueryManager::InvalidQuery)
@@ -45,9 +62,14 @@ public:
             dirty.set(m_positionId);
             dirty.set(m_facingId);
             dirty.set(m_renderScaleId);
+            dirty.set(m_previousId);
             m_queryId = ecs.queries.createDirtyQuery(required(), excluded(), dirty, ecs.stores);
         }
 
+        // Same convention as TransformHistorySystem: marks stamped at the current version count next time.
+        const uint32_t since = m_lastVersion;
+        m_lastVersion = ecs.changeVersion() - 1u;
+
         const auto &q = ecs.queries.get(m_queryId);
         for (uint32_t archetypeId : q.matchingArchetypeIds)
         {
@@ -59,29 +81,98 @@ public:
             if (!store.hasPosition() || !store.hasRenderTransform())
                 continue;
 
-            auto dirtyRows = ecs.queries.consumeDirtyRows(m_queryId, archetypeId);
+            if (archetypeId >= m_interpolating.size())
+                m_interpolating.resize(static_cast<size_t>(archetypeId) + 1u);
+            std::vector<uint32_t> &interpolating = m_interpolating[archetypeId];
+
+            auto &dirtyRows = m_dirtyRows;
+            ecs.queries.consumeDirtyRows(m_queryId, archetypeId, dirtyRows);
 
             const uint32_t n = store.size();
-            auto &positions = const_cast<std::vector<Engine::ECS::Position> &>(store.positions());
-            auto &transforms = const_cast<std::vector<Engine::ECS::RenderTransform> &>(store.renderTransforms());
+            auto positions = store.positions();
+            auto transforms = store.renderTransforms();
             const bool hasFacing = store.hasFacing();
-            auto &facings = hasFacing ? const_cast<std::vector<Engine::ECS::Facing> &>(store.facings()) : m_dummyFacings;
+            auto facings = store.facings();
 
             const bool hasRenderModel = store.hasRenderModel();
-            auto &renderModels = hasRenderModel ? const_cast<std::vector<Engine::ECS::RenderModel> &>(store.renderModels()) : m_dummyRenderModels;
+            auto renderModels = store.renderModels();
 
             const bool hasScale = store.hasRenderScale();
-            auto &scales = hasScale ? const_cast<std::vector<Engine::ECS::RenderScale> &>(store.renderScales()) : m_dummyScales;
+            auto scales = store.renderScales();
+
+            const bool hasBounds = store.hasRenderBounds() && store.hasWorldBounds();
+            const auto bounds = store.renderBounds();
+            auto worldBounds = store.worldBounds();
+
+            const bool interpolate = m_alpha < 1.0f && store.hasPreviousTransform();
+            auto previous = store.previousTransforms();
+
+            // Rows between two different tick poses move every frame. A row can only start or stop
+            // moving when Position/Facing/PreviousTransform is marked, so the moving rows of the
+            // previous frame plus the dirty rows cover it (both lists ascending, merged into m_rows).
+            if (interpolate)
+            {
+                auto moving = [&](uint32_t row)
+                {
+                    const Engine::ECS::PreviousTransform &prev = previous[row];
+                    const Engine::ECS::Position &pos = positions[row];
+                    return prev.valid && (prev.x != pos.x || prev.y != pos.y || prev.z != pos.z ||
+                                          (hasFacing && prev.yaw != facings[row].yaw));
+                };
+
+                m_rows.clear();
+                size_t d = 0;
+                size_t m = 0;
+                while (d < dirtyRows.size() || m < interpolating.size())
+                {
+                    uint32_t row;
+                    if (m == interpolating.size() || (d < dirtyRows.size() && dirtyRows[d] <= interpolating[m]))
+                    {
+                        row = dirtyRows[d++];
+                        if (m < interpolating.size() && interpolating[m] == row)
+                            ++m;
+                    }
+                    else
+                    {
+                        row = interpolating[m++];
+                    }
+                    if (row < n)
+                        m_rows.push_back(row);
+                }
+
+                interpolating.clear();
+                for (uint32_t row : m_rows)
+                {
+                    if (moving(row))
+                        interpolating.push_back(row);
+                }
+                dirtyRows.swap(m_rows);
+            }
+            else
+            {
+                interpolating.clear();
+            }
 
             // Dirty-driven update is great once the system is running, but newly spawned entities may not have
             // their Position/Facing dirtied yet. Ensure we compute the initial world matrix once.
+            // Row creation stamps every column of its chunk, so only chunks changed since the last
+            // run can hold such rows.
             if (dirtyRows.empty())
             {
-                dirtyRows.reserve(n);
-                for (uint32_t row = 0; row < n; ++row)
+                if (!store.columnChangedSince(m_renderTransformId, since))
+                    continue;
+                for (uint32_t c = 0; c < store.chunkCount(); ++c)
                 {
-                    if (transforms[row].transformVersion == 0)
-                        dirtyRows.push_back(row);
+                    if (!store.chunkChangedSince(c, m_renderTransformId, since))
+                        continue;
+                    const Engine::ECS::RenderTransform *chunk = transforms.chunk(c);
+                    const uint32_t firstRow = c * store.chunkCapacity();
+                    const uint32_t rows = store.chunkRows(c);
+                    for (uint32_t i = 0; i < rows; ++i)
+                    {
+                        if (chunk[i].transformVersion == 0)
+                            dirtyRows.push_back(firstRow + i);
+                    }
                 }
                 if (dirtyRows.empty())
                     continue;
@@ -92,11 +183,22 @@ public:
                 if (row >= n)
                     return;
 
-                const auto &pos = positions[row];
-                const float yaw = hasFacing ? facings[row].yaw : 0.0f;
+                Engine::ECS::Position pos = positions[row];
+                float yaw = hasFacing ? facings[row].yaw : 0.0f;
                 const float yawOffset = hasRenderModel ? renderModels[row].yawOffset : 0.0f;
                 const float s = hasScale ? scales[row].uniform : 1.0f;
 
+                if (interpolate && previous[row].valid)
+                {
+                    const Engine::ECS::PreviousTransform &prev = previous[row];
+                    pos.x = prev.x + (pos.x - prev.x) * m_alpha;
+                    pos.y = prev.y + (pos.y - prev.y) * m_alpha;
+                    pos.z = prev.z + (pos.z - prev.z) * m_alpha;
+                    // Shortest arc, so a turn across +/-PI doesn't spin the long way round.
+                    const float delta = std::remainder(yaw - prev.yaw, 6.28318530717958647692f);
+                    yaw = prev.yaw + delta * m_alpha;
+                }
+
                 if (!std::isfinite(pos.x) || !std::isfinite(pos.y) || !std::isfinite(pos.z))
                     return;
                 if (hasFacing && !std::isfinite(yaw))
@@ -104,17 +206,29 @@ public:
                 if (hasScale && (!std::isfinite(s) || s <= 0.0f))
                     return;
 
-                glm::mat4 world = glm::translate(glm::mat4(1.0f), glm::vec3(pos.x, pos.y, pos.z));
+                // translate * rotateY(yaw) * scale(s), written column by column.
                 const float totalYaw = yaw + yawOffset;
-                if (std::abs(totalYaw) > 1e-9f)
-                    world = glm::rotate(world, totalYaw, glm::vec3(0.0f, 1.0f, 0.0f));
-                if (hasScale && s != 1.0f)
-                    world = glm::scale(world, glm::vec3(s));
+                const float c = std::cos(totalYaw) * s;
+                const float sn = std::sin(totalYaw) * s;
 
                 auto &rt = transforms[row];
-                rt.world = world;
+                rt.world[0] = glm::vec4(c, 0.0f, -sn, 0.0f);
+                rt.world[1] = glm::vec4(0.0f, s, 0.0f, 0.0f);
+                rt.world[2] = glm::vec4(sn, 0.0f, c, 0.0f);
+                rt.world[3] = glm::vec4(pos.x, pos.y, pos.z, 1.0f);
                 rt.transformVersion += 1u;
                 ecs.markDirty(m_renderTransformId, archetypeId, row);
+
+                if (hasBounds)
+                {
+                    const glm::vec3 lc = bounds[row].localCenter;
+                    auto &wb = worldBounds[row];
+                    wb.center = glm::vec3(c * lc.x + sn * lc.z + pos.x,
+                                          s * lc.y + pos.y,
+                                          c * lc.z - sn * lc.x + pos.z);
+                    wb.radius = bounds[row].localRadius * s;
+                    ecs.markDirty(m_worldBoundsId, archetypeId, row);
+                }
             };
 
             if (ecs.jobSystem && dirtyRows.size() >= PARALLEL_DIRTY_ROW_THRESHOLD)
@@ -132,12 +246,15 @@ public:
 
 private:
     Engine::ECS::QueryId m_queryId = Engine::ECS::QueryManager::InvalidQuery;
+    std::vector<uint32_t> m_dirtyRows; // consumeDirtyRows scratch, reused across stores and frames
+    std::vector<uint32_t> m_rows;      // dirty + interpolating rows scratch
+    std::vector<std::vector<uint32_t>> m_interpolating; // by archetype id: rows between two tick poses last frame
+    uint32_t m_lastVersion = 0;                         // ecs.changeVersion() at the previous update
+    float m_alpha = 1.0f;
     uint32_t m_positionId = Engine::ECS::ComponentRegistry::InvalidID;
     uint32_t m_facingId = Engine::ECS::ComponentRegistry::InvalidID;
     uint32_t m_renderScaleId = Engine::ECS::ComponentRegistry::InvalidID;
     uint32_t m_renderTransformId = Engine::ECS::ComponentRegistry::InvalidID;
-
-    std::vector<Engine::ECS::Facing> m_dummyFacings;
-    std::vector<Engine::ECS::RenderScale> m_dummyScales;
-    std::vector<Engine::ECS::RenderModel> m_dummyRenderModels;
+    uint32_t m_worldBoundsId = Engine::ECS::ComponentRegistry::InvalidID;
+    uint32_t m_previousId = Engine::ECS::ComponentRegistry::InvalidID;
 };
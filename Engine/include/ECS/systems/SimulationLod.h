@@ -0,0 +1,110 @@
+#pragma once
+/*
+  SimulationLod.h
+  ---------------
+  Purpose:
+    - Simulation level of detail. Units outside every interest circle (the camera's ground
+      point, battle hot spots, ...) and not Selected by the player are in the Far tier, where
+      the systems given this object trade fidelity for time:
+        - LocalAvoidanceSystem re-solves a far row once every Config::avoidanceInterval ticks
+          (staggered by entity index) against at most Config::avoidanceMaxNeighbors neighbors.
+        - CombatSystem searches targets Config::retargetScale times less often and resolves
+          each far attack as its expected damage instead of separate hit / crit / damage rolls.
+
+  Usage:
+    - SimulationLod lod; lod.bind(registry); lod.setConfig(cfg);
+    - between ticks: lod.setFocus(cameraX, cameraZ); optionally addInterest(x, z, radius).
+    - systems: setSimulationLod(&lod); per row: if (lod && lod->isFar(ecs, entity, x, z)) ...
+
+  Notes:
+    - Read-only while the simulation ticks, so parallel lanes may query it.
+    - Expected damage keeps battle outcomes statistically equivalent for far units (same mean
+      damage per attack, less variance). The tier depends on where the viewer looks, so
+      lockstep peers and replays must keep it disabled to stay exact.
+*/
+
+#include "ECS/ECSContext.h"
+
+#include <cstdint>
+#include <vector>
+
+class SimulationLod
+{
+public:
+    struct Config
+    {
+        bool enabled = false;
+        float focusRadius = 80.0f;           // world units around the focus point kept at full fidelity
+        uint32_t avoidanceInterval = 4;      // ticks between avoidance solves of a far row
+        uint32_t avoidanceMaxNeighbors = 4;  // neighbors considered by a far row's solve
+        uint32_t retargetScale = 2;          // far target searches happen this many times less often
+        bool expectedDamage = true;          // far attacks deal their mean damage (one roll per attack)
+    };
+
+    struct Interest
+    {
+        float x = 0.0f;
+        float z = 0.0f;
+        float radius = 0.0f;
+    };
+
+    void bind(Engine::ECS::ComponentRegistry &registry) { m_selectedId = registry.ensureId("Selected"); }
+
+    void setConfig(const Config &cfg) { m_cfg = cfg; }
+    const Config &config() const { return m_cfg; }
+    bool enabled() const { return m_cfg.enabled; }
+
+    // The viewer's point of interest (the camera over the ground), radius Config::focusRadius.
+    void setFocus(float x, float z)
+    {
+        m_focusX = x;
+        m_focusZ = z;
+        m_hasFocus = true;
+    }
+    void clearFocus() { m_hasFocus = false; }
+
+    // Extra full-fidelity circles (kept until clearInterest()).
+    void addInterest(float x, float z, float radius) { m_interest.push_back(Interest{x, z, radius}); }
+    void clearInterest() { m_interest.clear(); }
+
+    // Full fidelity at (x, z)? Only the position: Selected is checked by isFar().
+    bool inFocus(float x, float z) const
+    {
+        if (m_hasFocus && within(x, z, m_focusX, m_focusZ, m_cfg.focusRadius))
+            return true;
+        for (const Interest &i : m_interest)
+        {
+            if (within(x, z, i.x, i.z, i.radius))
+                return true;
+        }
+        return false;
+    }
+
+    bool isFar(const Engine::ECS::ECSContext &ecs, Engine::ECS::Entity e, float x, float z) const
+    {
+        if (!m_cfg.enabled || inFocus(x, z))
+            return false;
+        return m_selectedId == Engine::ECS::ComponentRegistry::InvalidID || !ecs.hasTag(e, m_selectedId);
+    }
+
+    // Whether a far row staggered by entityIndex does its interval-spaced work on this tick.
+    static bool onStride(uint32_t entityIndex, uint32_t tick, uint32_t interval)
+    {
+        return interval <= 1u || (entityIndex + tick) % interval == 0u;
+    }
+
+private:
+    static bool within(float x, float z, float cx, float cz, float r)
+    {
+        const float dx = x - cx;
+        const float dz = z - cz;
+        return dx * dx + dz * dz <= r * r;
+    }
+
+    Config m_cfg{};
+    uint32_t m_selectedId = Engine::ECS::ComponentRegistry::InvalidID;
+    bool m_hasFocus = false;
+    float m_focusX = 0.0f;
+    float m_focusZ = 0.0f;
+    std::vector<Interest> m_interest;
+};
@@ -0,0 +1,252 @@
+#pragma once
+/*
+  SleepSystem.h
+  -------------
+  Purpose:
+    - Put idle movers to sleep and wake them again, so parked units stop costing anything.
+      Steering, avoidance, movement and render transforms are dirty-driven; a unit with no
+      target, zero velocity and no disturbance is marked by nobody and is therefore skipped.
+    - Falls asleep: no active MoveTarget and the unit stayed within SLEEP_RADIUS of where it
+      came to rest for SLEEP_DELAY seconds. Catches units that avoidance keeps nudging in a
+      packed crowd, which would otherwise stay dirty forever. Velocity is zeroed on sleep.
+    - Wakes on a new order (MoveTarget active) or a velocity written from outside, and when a
+      mover comes within Radius + WAKE_MARGIN: the neighbor's Velocity is marked dirty so
+      LocalAvoidanceSystem reconsiders it next tick. Woken units that get pushed become movers
+      themselves, so a wake spreads through a touching group (island) and nothing further.
+
+  Requirements:
+    - Components: "Position", "Velocity", "SleepState" (loadPrefabFromJson adds SleepState to
+      prefabs with Velocity and AvoidanceParams). Optional: "MoveTarget", "Radius".
+    - SpatialIndexSystem: neighbors for waking (built earlier in the tick).
+
+  Suggested order per tick:
+    ... -> LocalAvoidanceSystem -> MovementSystem -> SleepSystem
+*/
+
+#include "ECS/SystemFormat.h"
+#include "ECS/Components.h"
+#include "ECS/ArchetypeStore.h"
+
+#include "ECS/systems/SpatialIndexSystem.h"
+#include "utils/JobSystem.h"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+class SleepSystem : public Engine::ECS::SystemBase
+{
+public:
+    // =====================
+    // TUNING CONSTANTS
+    // =====================
+    static constexpr uint32_t PARALLEL_DIRTY_ROW_THRESHOLD = 256;
+    static constexpr float SLEEP_DELAY = 0.75f; // seconds calm before sleeping
+    static constexpr float SLEEP_RADIUS = 0.1f; // meters of drift still counted as calm
+    static constexpr float WAKE_SPEED = 0.05f;  // m/s; slower units don't disturb neighbors
+    static constexpr float WAKE_MARGIN = 0.75f; // meters beyond touching that still wakes
+
+    struct Stats
+    {
+        uint32_t rowsVisited = 0;
+        uint32_t fellAsleep = 0;
+        uint32_t woken = 0;  // by orders or outside velocity writes
+        uint32_t nudged = 0; // neighbors of movers marked for avoidance (asleep or idle)
+    };
+
+    SleepSystem(const SpatialIndexSystem *grid = nullptr)
+        : m_grid(grid)
+    {
+        setRequiredNames({"Position", "Velocity", "SleepState"});
+        setExcludedNames({"Disabled", "Dead"});
+        setReadNames({"Position", "MoveTarget", "Radius", "SpatialIndex"});
+        setWriteNames({"Velocity", "SleepState"});
+    }
+
+    const char *name() const override { return "SleepSystem"; }
+
+    void buildMasks(Engine::ECS::ComponentRegistry &registry) override
+    {
+        Engine::ECS::SystemBase::buildMasks(registry);
+        m_positionId = registry.ensureId("Position");
+        m_velocityId = registry.ensureId("Velocity");
+        m_moveTargetId = registry.ensureId("MoveTarget");
+        m_queryId = Engine::ECS::QueryManager::InvalidQuery;
+    }
+
+    void setGrid(const SpatialIndexSystem *grid) { m_grid = grid; }
+    const Stats &stats() const { return m_stats; }
+
+    void update(Engine::ECS::ECSContext &ecs, float dt) override
+    {
+        if (dt <= 0.0f)
+            return;
+
+        if (m_queryId == Engine::ECS::QueryManager::InvalidQuery)
+        {
+            Engine::ECS::ComponentMask dirty;
+            dirty.set(m_positionId);
+            dirty.set(m_velocityId);
+            dirty.set(m_moveTargetId);
+            m_queryId = ecs.queries.createDirtyQuery(required(), excluded(), dirty, ecs.stores);
+        }
+
+        m_stats = Stats{};
+        m_movers.clear();
+
+        const auto &q = ecs.queries.get(m_queryId);
+        for (uint32_t archetypeId : q.matchingArchetypeIds)
+        {
+            auto *storePtr = ecs.stores.get(archetypeId);
+            if (!storePtr)
+                continue;
+            auto &store = *storePtr;
+
+            auto &dirtyRows = m_dirtyRows;
+            ecs.queries.consumeDirtyRows(m_queryId, archetypeId, dirtyRows);
+            if (dirtyRows.empty())
+                continue;
+
+            auto positions = store.positions();
+            auto velocities = store.velocities();
+            auto sleeps = store.sleepStates();
+            const bool hasMoveTarget = store.hasMoveTarget();
+            const auto targets = store.moveTargets();
+            const uint32_t n = store.size();
+
+            // Per row: 0 = nothing, 1 = fell asleep, 2 = woken, 3 = mover (wakes its neighbors).
+            m_outcome.assign(dirtyRows.size(), 0u);
+
+            auto stepRow = [&](uint32_t idx)
+            {
+                const uint32_t row = dirtyRows[idx];
+                if (row >= n)
+                    return;
+
+                const auto &p = positions[row];
+                auto &v = velocities[row];
+                auto &s = sleeps[row];
+                const bool hasActiveTarget = hasMoveTarget && targets[row].active;
+                const float speed2 = v.x * v.x + v.z * v.z;
+
+                auto rest = [&]()
+                {
+                    s.anchorX = p.x;
+                    s.anchorZ = p.z;
+                    s.calmSeconds = 0.0f;
+                };
+
+                if (s.asleep)
+                {
+                    // Asleep rows only turn up here when something else wrote them.
+                    if (!hasActiveTarget && speed2 <= 1e-12f)
+                        return;
+                    s.asleep = 0;
+                    rest();
+                    m_outcome[idx] = 2u;
+                    return;
+                }
+
+                if (hasActiveTarget)
+                {
+                    rest();
+                    m_outcome[idx] = (speed2 > WAKE_SPEED * WAKE_SPEED) ? 3u : 0u;
+                    return;
+                }
+
+                const float dx = p.x - s.anchorX;
+                const float dz = p.z - s.anchorZ;
+                if (dx * dx + dz * dz > SLEEP_RADIUS * SLEEP_RADIUS)
+                {
+                    rest();
+                    m_outcome[idx] = (speed2 > WAKE_SPEED * WAKE_SPEED) ? 3u : 0u;
+                    return;
+                }
+
+                s.calmSeconds += dt;
+                if (s.calmSeconds < SLEEP_DELAY)
+                    return;
+
+                s.asleep = 1;
+                if (std::fabs(v.x) + std::fabs(v.y) + std::fabs(v.z) > 0.0f)
+                {
+                    v.x = v.y = v.z = 0.0f;
+                    ecs.markDirty(m_velocityId, archetypeId, row);
+                }
+                m_outcome[idx] = 1u;
+            };
+
+            Engine::JobSystem *js = ecs.jobSystem;
+            if (js && js->workerCount() > 0 && dirtyRows.size() >= PARALLEL_DIRTY_ROW_THRESHOLD)
+            {
+                js->parallelFor(static_cast<uint32_t>(dirtyRows.size()), [&](uint32_t /*workerIndex*/, uint32_t i)
+                                { stepRow(i); });
+            }
+            else
+            {
+                for (uint32_t i = 0; i < dirtyRows.size(); ++i)
+                    stepRow(i);
+            }
+
+            m_stats.rowsVisited += static_cast<uint32_t>(dirtyRows.size());
+            for (uint32_t i = 0; i < dirtyRows.size(); ++i)
+            {
+                if (m_outcome[i] == 1u)
+                    ++m_stats.fellAsleep;
+                else if (m_outcome[i] == 2u)
+                    ++m_stats.woken;
+                else if (m_outcome[i] == 3u)
+                    m_movers.push_back(GridEntry{archetypeId, dirtyRows[i]});
+            }
+        }
+
+        // Serial: waking writes neighbors' rows, and movers are few when most units are idle.
+        if (m_grid)
+        {
+            for (const GridEntry &m : m_movers)
+                wakeNeighbors(ecs, m.storeId, m.row);
+        }
+    }
+
+private:
+    void wakeNeighbors(Engine::ECS::ECSContext &ecs, uint32_t archetypeId, uint32_t row)
+    {
+        const auto *store = ecs.stores.get(archetypeId);
+        if (!store || row >= store->size())
+            return;
+        const auto &p = store->positions()[row];
+        const float selfRadius = store->hasRadius() ? store->radii()[row].r : 0.0f;
+
+        m_grid->forNeighborData(p.x, p.z, [&](const GridNeighbor &nb)
+                                {
+            if (!(nb.flags & GRID_NEIGHBOR_MOVER)) return;
+            if (nb.entry.storeId == archetypeId && nb.entry.row == row) return;
+
+            const float reach = selfRadius + nb.radius + WAKE_MARGIN;
+            const float dx = nb.x - p.x;
+            const float dz = nb.z - p.z;
+            if (dx * dx + dz * dz > reach * reach) return;
+
+            auto *nStore = ecs.stores.get(nb.entry.storeId);
+            if (!nStore || !nStore->hasSleepState() || nb.entry.row >= nStore->size()) return;
+
+            auto &s = nStore->sleepStates()[nb.entry.row];
+            s.asleep = 0;
+            s.calmSeconds = 0.0f;
+            s.anchorX = nb.x;
+            s.anchorZ = nb.z;
+            ecs.markDirty(m_velocityId, nb.entry.storeId, nb.entry.row);
+            ++m_stats.nudged; });
+    }
+
+    const SpatialIndexSystem *m_grid = nullptr; // not owned
+    Stats m_stats{};
+
+    uint32_t m_positionId = Engine::ECS::ComponentRegistry::InvalidID;
+    uint32_t m_velocityId = Engine::ECS::ComponentRegistry::InvalidID;
+    uint32_t m_moveTargetId = Engine::ECS::ComponentRegistry::InvalidID;
+    Engine::ECS::QueryId m_queryId = Engine::ECS::QueryManager::InvalidQuery;
+    std::vector<uint32_t> m_dirtyRows;            // consumeDirtyRows scratch, reused across stores and frames
+    std::vector<uint8_t> m_outcome;               // per dirty row, see stepRow
+    std::vector<GridEntry> m_movers; // rows that wake their neighbors this tick
+};
@@ -10,22 +10,46 @@
 
   Usage:
     - Construct the system, setCellSize(R), and call buildMasks(registry) once (requires "Position").
-    - Call update(stores, dt) each frame to rebuild the grid.
+    - Call update(stores, dt) each frame to bring the grid up to date.
     - LocalAvoidanceSystem (or other systems) can call forNeighbors(x, y, fn) to visit candidate neighbors.
+    - Picking/box selection can call forEntitiesInRect(minX, minZ, maxX, maxZ, ...) with a ground footprint.
 
   Notes:
-    - This is stateless across frames: we rebuild the grid each frame (simple and fast for RTS scales).
+    - Cells are ordered by a 64-bit Morton (Z-order) code of (gx, gz), so cells that are close in
+      the world are mostly close in memory, and 3x3 neighborhood scans touch few cache lines.
+    - Two layers, each a flat entry list sorted by cell code (parallel LSD radix sort), a compacted
+      cell range table and an open-addressing hash table from cell code to cell range:
+        static  : stores without Velocity (obstacles, trees, grass). Rebuilt only when one of those
+                  stores gains/loses rows or has a Position marked dirty.
+        dynamic : stores with Velocity (units). Rows whose Position was marked dirty are re-keyed;
+                  only rows that changed cell are moved (removed + merged back in sorted order).
+                  A structural change in any dynamic store rebuilds the dynamic layer.
+    - setTeamLayers(true) adds one more layer per team, holding the movers with that Team (a
+      filtered copy of the dynamic layer). Queries whose filter has a team mode and requires
+      GRID_NEIGHBOR_MOVER scan only the matching teams' layers, so an enemy search never walks
+      through its own army. Results are the same as without them.
+    - Position writers must ecs.markDirty(Position) for the incremental path (MovementSystem does).
+      setIncremental(false) restores the full per-frame rebuild.
     - The grid stores (storeId, row) pairs so you can access components back in ArchetypeStoreManager.
+    - Next to each entry it keeps a GridNeighbor: a 32-byte copy of position, radius, separation,
+      team and entity index taken during update(). queryRadius/queryKNearest/forNeighborData filter
+      on that copy, so rejected candidates never touch their store. The copy is exact for systems
+      that run between SpatialIndexSystem and MovementSystem; read the store for anything that
+      can change in between (Health, Velocity).
 */
 
 #include "ECS/SystemFormat.h"
 #include "ECS/Components.h"
+#include "ECS/StoreRowSpans.h"
 
 #include "utils/JobSystem.h"
+#include "utils/MemoryReport.h"
+#include "utils/RadixSort.h"
 
 #include <cmath>
 #include <cstdint>
 #include <algorithm>
+#include <iterator>
 #include <utility>
 #include <vector>
 
@@ -36,15 +60,40 @@ struct GridKey
     bool operator==(const GridKey &o) const noexcept { return gx == o.gx && gz == o.gz; }
 };
 
-struct GridKeyLess
+// Morton (Z-order) code of a cell: bits of gx and gz interleaved (gx in the even bits).
+// Coordinates are biased by 2^31 so negative cells order before positive ones.
+inline uint64_t GridMortonCode(const GridKey &k) noexcept
 {
-    bool operator()(const GridKey &a, const GridKey &b) const noexcept
+    auto spread = [](uint32_t v) noexcept
     {
-        if (a.gx != b.gx)
-            return a.gx < b.gx;
-        return a.gz < b.gz;
-    }
-};
+        uint64_t x = v;
+        x = (x | (x << 16)) & 0x0000FFFF0000FFFFull;
+        x = (x | (x << 8)) & 0x00FF00FF00FF00FFull;
+        x = (x | (x << 4)) & 0x0F0F0F0F0F0F0F0Full;
+        x = (x | (x << 2)) & 0x3333333333333333ull;
+        x = (x | (x << 1)) & 0x5555555555555555ull;
+        return x;
+    };
+    const uint32_t ux = static_cast<uint32_t>(k.gx) ^ 0x80000000u;
+    const uint32_t uz = static_cast<uint32_t>(k.gz) ^ 0x80000000u;
+    return spread(ux) | (spread(uz) << 1);
+}
+
+// Inverse of GridMortonCode.
+inline GridKey GridKeyFromMorton(uint64_t code) noexcept
+{
+    auto compact = [](uint64_t x) noexcept
+    {
+        x &= 0x5555555555555555ull;
+        x = (x | (x >> 1)) & 0x3333333333333333ull;
+        x = (x | (x >> 2)) & 0x0F0F0F0F0F0F0F0Full;
+        x = (x | (x >> 4)) & 0x00FF00FF00FF00FFull;
+        x = (x | (x >> 8)) & 0x0000FFFF0000FFFFull;
+        x = (x | (x >> 16)) & 0x00000000FFFFFFFFull;
+        return static_cast<uint32_t>(x);
+    };
+    return GridKey{static_cast<int>(compact(code) ^ 0x80000000u), static_cast<int>(compact(code >> 1) ^ 0x80000000u)};
+}
 
 struct GridEntry
 {
@@ -54,17 +103,75 @@ struct GridEntry
 
 struct KeyedGridEntry
 {
-    GridKey key;
+    uint64_t code; // GridMortonCode of the entry's cell
     GridEntry entry;
 };
 
 struct GridCellRange
 {
-    GridKey key;
+    uint64_t code = 0; // GridMortonCode
     uint32_t start = 0;
     uint32_t count = 0;
 };
 
+enum GridNeighborFlags : uint8_t
+{
+    GRID_NEIGHBOR_HAS_TEAM = 1u << 0,
+    GRID_NEIGHBOR_HAS_RADIUS = 1u << 1, // Radius or ObstacleRadius
+    GRID_NEIGHBOR_HAS_SEPARATION = 1u << 2,
+    GRID_NEIGHBOR_MOVER = 1u << 3, // store has Velocity (dynamic layer)
+};
+
+// Snapshot of the fields neighbor queries filter on; one per grid entry, same order.
+struct GridNeighbor
+{
+    float x = 0.0f;
+    float z = 0.0f;
+    float radius = 0.0f;     // Radius, else ObstacleRadius, else 0
+    float separation = 0.0f; // Separation, else 0
+    GridEntry entry{};
+    uint32_t entityIndex = UINT32_MAX;
+    uint8_t team = 0;
+    uint8_t flags = 0; // GridNeighborFlags
+    uint16_t _pad = 0;
+};
+static_assert(sizeof(GridNeighbor) == 32, "GridNeighbor should stay half a cache line");
+
+struct GridNeighborFilter
+{
+    enum class TeamMode : uint8_t
+    {
+        Any,   // no team test
+        Same,  // team == filter team (entities without Team are rejected)
+        Other, // team != filter team (entities without Team are rejected)
+    };
+
+    TeamMode teamMode = TeamMode::Any;
+    uint8_t team = 0;
+    uint8_t requireFlags = 0;                // all of these GridNeighborFlags must be set
+    uint32_t excludeStoreId = UINT32_MAX;    // skip this (store,row), usually the querying entity
+    uint32_t excludeRow = UINT32_MAX;
+
+    bool accepts(const GridNeighbor &n) const
+    {
+        if ((n.flags & requireFlags) != requireFlags)
+            return false;
+        if (n.entry.storeId == excludeStoreId && n.entry.row == excludeRow)
+            return false;
+        if (teamMode == TeamMode::Any)
+            return true;
+        if (!(n.flags & GRID_NEIGHBOR_HAS_TEAM))
+            return false;
+        return (teamMode == TeamMode::Same) == (n.team == team);
+    }
+};
+
+struct GridNeighborHit
+{
+    GridNeighbor neighbor;
+    float dist2 = 0.0f;
+};
+
 class SpatialIndexSystem : public Engine::ECS::SystemBase
 {
 public:
@@ -72,13 +179,17 @@ public:
     // TUNING CONSTANTS
     // =====================
     static constexpr uint32_t PARALLEL_ENTRY_THRESHOLD = 4096; // parallelize when there are enough entities to index
-    static constexpr uint32_t PARALLEL_CHUNK_SIZE = 1024;      // rows per chunk task
+    static constexpr uint32_t PARALLEL_ROW_COST_NS = 15;       // rough cost of keying one row (sets the rows per task)
+    static constexpr uint32_t PATCH_MAX_PERCENT = 25;          // cell changes above this share of the layer re-sort it instead of patching
+    static constexpr uint32_t PARALLEL_SORT_THRESHOLD = 16384; // radix sort in parallel chunks above this many entries
 
     SpatialIndexSystem(float cellSize = 2.0f) // default R in meters; adjust at runtime as needed
         : m_cellSize(cellSize)
     {
         setRequiredNames({"Position"}); // we index any entity that has Position
         // You may set excluded tags if desired: setExcludedNames({"Disabled","Dead"});
+        setReadNames({"Position", "Radius", "ObstacleRadius", "Separation", "Team"});
+        setWriteNames({"SpatialIndex"});
     }
 
     const char *name() const override { return "SpatialIndexSystem"; }
@@ -86,160 +197,207 @@ public:
     void buildMasks(Engine::ECS::ComponentRegistry &registry) override
     {
         Engine::ECS::SystemBase::buildMasks(registry);
+        m_positionId = registry.ensureId("Position");
         m_queryId = Engine::ECS::QueryManager::InvalidQuery;
+        m_storeStates.clear();
+        m_static.clear();
+        m_dynamic.clear();
+        for (uint8_t team : m_teamsPresent)
+            m_teamLayers[team].clear();
+        m_teamsPresent.clear();
+        m_teamLayersStale = true;
     }
 
-    void setCellSize(float cellSize) { m_cellSize = (cellSize > 1e-6f) ? cellSize : 1e-6f; }
+    void setCellSize(float cellSize)
+    {
+        const float c = (cellSize > 1e-6f) ? cellSize : 1e-6f;
+        if (c != m_cellSize)
+            m_forceRebuild = true; // every cached key is stale
+        m_cellSize = c;
+    }
     float getCellSize() const { return m_cellSize; }
 
-    // Debug/telemetry: counts from the most recent rebuild.
-    // - entriesIndexed: number of (store,row) pairs inserted (typically equals total entities with Position).
-    // - cellsBuilt: number of unique spatial cells created (unique GridKey count).
+    // false = rebuild both layers every frame (the old behavior; useful when comparing results).
+    void setIncremental(bool enabled) { m_incremental = enabled; }
+    bool incremental() const { return m_incremental; }
+
+    // Per-team mover layers (see Notes). Takes effect on the next update().
+    void setTeamLayers(bool enabled)
+    {
+        m_teamLayersEnabled = enabled;
+        m_teamLayersStale = true;
+        if (!enabled)
+        {
+            m_teamLayers.clear();
+            m_teamsPresent.clear();
+        }
+    }
+    bool teamLayers() const { return m_teamLayersEnabled; }
+
+    // Debug/telemetry: counts from the most recent update.
+    // - entriesIndexed: (store,row) pairs in the grid, both layers (typically equals total entities with Position).
+    // - cellsBuilt: cell ranges in both layers (a cell holding static and dynamic entries counts twice).
+    // - rowsRekeyed: rows whose key was recomputed this update (full rebuilds count every row of the layer).
+    // - cellChanges: dynamic rows that moved to another cell through the incremental patch.
+    // - staticRebuilt: whether the static layer was rebuilt this update.
     uint32_t lastEntriesIndexed() const { return m_lastEntriesIndexed; }
     uint32_t lastCellsBuilt() const { return m_lastCellsBuilt; }
 
-    // Rebuild the spatial hash grid for all entities with Position
-    void update(Engine::ECS::ECSContext &ecs, float /*dt*/) override
+    // Layers (entries, neighbor snapshots, cells, hash tables) and rebuild/patch scratch,
+    // under category "Navigation".
+    void reportMemory(Engine::MemoryReport &out) const
     {
-        m_lastEntriesIndexed = 0;
-        m_lastCellsBuilt = 0;
+        using Engine::MemoryReport;
+        auto layerBytes = [](const Layer &l)
+        {
+            return MemoryReport::bytesOf(l.entries) + MemoryReport::bytesOf(l.data) +
+                   MemoryReport::bytesOf(l.cells) + MemoryReport::bytesOf(l.table);
+        };
+        uint64_t layers = layerBytes(m_static) + layerBytes(m_dynamic);
+        for (const Layer &l : m_teamLayers)
+            layers += layerBytes(l);
+        const uint32_t entries = static_cast<uint32_t>(m_static.entries.size() + m_dynamic.entries.size());
+        out.add("Navigation", "Spatial index layers", layers, 0, entries);
 
-        // Option C: Flat list of entries, sorted by GridKey, then compacted into ranges.
-        // This avoids unordered_map contention and is friendly to parallel rebuilds.
-        m_entries.clear();
-        m_cells.clear();
+        uint64_t scratch = MemoryReport::bytesOf(m_storeStates) + MemoryReport::bytesOf(m_moves) +
+                           MemoryReport::bytesOf(m_removeIdx) + MemoryReport::bytesOf(m_patchIn) +
+                           MemoryReport::bytesOf(m_mergeScratch) + MemoryReport::bytesOf(m_storeOrder) +
+                           MemoryReport::bytesOf(m_sortScratch) + MemoryReport::bytesOf(m_radixScratch.counts) +
+                           MemoryReport::bytesOf(m_radixScratch.vary) + MemoryReport::bytesOf(m_dirtyRows);
+        for (const StoreState &s : m_storeStates)
+            scratch += MemoryReport::bytesOf(s.rowCodes);
+        out.add("Navigation", "Spatial index scratch", scratch, 0);
+    }
+    uint32_t lastRowsRekeyed() const { return m_lastRowsRekeyed; }
+    uint32_t lastCellChanges() const { return m_lastCellChanges; }
+    bool lastStaticRebuilt() const { return m_lastStaticRebuilt; }
+
+    // Bring both layers up to date for all entities with Position.
+    void update(Engine::ECS::ECSContext &ecs, float /*dt*/) override
+    {
+        m_lastRowsRekeyed = 0;
+        m_lastCellChanges = 0;
+        m_lastStaticRebuilt = false;
 
         if (m_queryId == Engine::ECS::QueryManager::InvalidQuery)
-            m_queryId = ecs.queries.createQuery(required(), excluded(), ecs.stores);
+        {
+            Engine::ECS::ComponentMask dirty;
+            dirty.set(m_positionId);
+            m_queryId = ecs.queries.createDirtyQuery(required(), excluded(), dirty, ecs.stores);
+            m_forceRebuild = true;
+        }
 
         const auto &q = ecs.queries.get(m_queryId);
+        if (m_storeStates.size() < q.matchingArchetypeIds.size())
+            m_storeStates.resize(q.matchingArchetypeIds.size());
+
+        // Spawns reserved ahead (ECSContext::reserve): the mover layer and its sort scratch
+        // grow once to the reservation instead of doubling while the wave arrives.
+        const uint32_t reserved = ecs.reservedEntities();
+        if (reserved > m_reservedEntities)
+        {
+            m_reservedEntities = reserved;
+            m_dynamic.entries.reserve(reserved);
+            m_dynamic.data.reserve(reserved);
+            m_sortScratch.reserve(reserved);
+        }
+
+        // Stores in archetype id order: filling layers in this order makes the stable radix sort
+        // produce (cell code, storeId, row) order, which is what entryLess describes.
+        m_storeOrder.resize(q.matchingArchetypeIds.size());
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_storeOrder.size()); ++i)
+            m_storeOrder[i] = i;
+        std::sort(m_storeOrder.begin(), m_storeOrder.end(), [&](uint32_t a, uint32_t b)
+                  { return q.matchingArchetypeIds[a] < q.matchingArchetypeIds[b]; });
+
+        const bool full = m_forceRebuild || !m_incremental;
+        bool rebuildStatic = full;
+        bool rebuildDynamic = full;
+        m_moves.clear();
 
-        auto addStoreEntries = [&](std::vector<KeyedGridEntry> &out, uint32_t archetypeId, uint32_t startRow, uint32_t count)
+        // Pass 1: detect structural changes and collect dynamic rows that changed cell.
+        for (size_t i = 0; i < q.matchingArchetypeIds.size(); ++i)
         {
+            const uint32_t archetypeId = q.matchingArchetypeIds[i];
             const Engine::ECS::ArchetypeStore *storePtr = ecs.stores.get(archetypeId);
-            if (!storePtr)
-                return;
+            StoreState &state = m_storeStates[i];
+
+            // Always consume, so stale bits don't pile up while a layer is being rebuilt anyway.
+            auto &dirtyRows = m_dirtyRows;
+            ecs.queries.consumeDirtyRows(m_queryId, archetypeId, dirtyRows);
+
+            if (!storePtr || !storePtr->hasPosition())
+                continue;
             const auto &store = *storePtr;
-            if (!store.hasPosition())
-                return;
+            const bool dynamic = store.hasVelocity();
 
-            const auto &positions = store.positions();
-            const uint32_t n = store.size();
-            if (startRow >= n)
-                return;
-            const uint32_t endRow = std::min(n, startRow + count);
+            const bool structural = !state.valid || state.structuralVersion != store.structuralVersion();
+            state.valid = true;
+            state.dynamic = dynamic;
+            state.structuralVersion = store.structuralVersion();
 
-            out.reserve(out.size() + (endRow - startRow));
-            for (uint32_t row = startRow; row < endRow; ++row)
+            bool &layerStale = dynamic ? rebuildDynamic : rebuildStatic;
+            if (structural)
+                layerStale = true;
+            if (layerStale || dirtyRows.empty())
+                continue;
+
+            if (!dynamic)
             {
-                const auto &p = positions[row];
-                const int gx = static_cast<int>(std::floor(p.x / m_cellSize));
-                const int gz = static_cast<int>(std::floor(p.z / m_cellSize));
-                out.push_back(KeyedGridEntry{GridKey{gx, gz}, GridEntry{archetypeId, row}});
+                rebuildStatic = true; // a static entity was moved explicitly
+                continue;
             }
-        };
 
-        Engine::JobSystem *js = ecs.jobSystem;
-        const bool hasWorkers = (js != nullptr) && (js->workerCount() > 0);
-
-        // Pre-scan stores to estimate entity count and build chunk tasks.
-        m_chunks.clear();
-        uint32_t totalEntities = 0;
-        if (hasWorkers)
-        {
-            for (uint32_t archetypeId : q.matchingArchetypeIds)
+            const auto &positions = store.positions();
+            const uint32_t n = store.size();
+            for (uint32_t row : dirtyRows)
             {
-                const Engine::ECS::ArchetypeStore *storePtr = ecs.stores.get(archetypeId);
-                if (!storePtr)
+                if (row >= n || row >= state.rowCodes.size())
                     continue;
-                const auto &store = *storePtr;
-                if (!store.hasPosition())
+                const uint64_t code = codeOf(positions[row]);
+                uint64_t &cached = state.rowCodes[row];
+                if (code == cached)
                     continue;
-                const uint32_t n = store.size();
-                totalEntities += n;
-                for (uint32_t start = 0; start < n; start += PARALLEL_CHUNK_SIZE)
-                {
-                    const uint32_t c = std::min(PARALLEL_CHUNK_SIZE, n - start);
-                    m_chunks.push_back(StoreChunk{archetypeId, start, c});
-                }
+                m_moves.push_back(CellMove{cached, KeyedGridEntry{code, GridEntry{archetypeId, row}}});
+                cached = code;
             }
+            m_lastRowsRekeyed += static_cast<uint32_t>(dirtyRows.size());
         }
 
-        const bool canParallel = hasWorkers && (totalEntities >= PARALLEL_ENTRY_THRESHOLD) && !m_chunks.empty();
-
-        if (canParallel)
-        {
-            const uint32_t scratchCount = js->workerCount() + 1; // + calling thread
-            if (m_workerScratch.size() != scratchCount)
-                m_workerScratch.resize(scratchCount);
-            for (auto &v : m_workerScratch)
-                v.clear();
-
-            js->parallelFor(static_cast<uint32_t>(m_chunks.size()),
-                            [&](uint32_t workerIndex, uint32_t i)
-                            {
-                                if (i >= m_chunks.size())
-                                    return;
-                                const StoreChunk &c = m_chunks[i];
-                                addStoreEntries(m_workerScratch[workerIndex], c.archetypeId, c.startRow, c.count);
-                            });
-
-            size_t total = 0;
-            for (const auto &v : m_workerScratch)
-                total += v.size();
-            m_entries.reserve(total);
-            for (const auto &v : m_workerScratch)
-                m_entries.insert(m_entries.end(), v.begin(), v.end());
+        if (rebuildStatic)
+        {
+            rebuildLayer(ecs, q, m_static, false);
+            refreshLayerData(ecs, m_static);
+            m_lastStaticRebuilt = true;
         }
-        else
+
+        const bool dynamicReordered = rebuildDynamic || !m_moves.empty();
+        if (rebuildDynamic)
         {
-            // Sequential fallback.
-            for (uint32_t archetypeId : q.matchingArchetypeIds)
-            {
-                const Engine::ECS::ArchetypeStore *storePtr = ecs.stores.get(archetypeId);
-                if (!storePtr)
-                    continue;
-                const auto &store = *storePtr;
-                if (!store.hasPosition())
-                    continue;
-                addStoreEntries(m_entries, archetypeId, 0u, store.size());
-            }
+            rebuildLayer(ecs, q, m_dynamic, true);
+        }
+        else if (!m_moves.empty())
+        {
+            const size_t limit = m_dynamic.entries.size() * PATCH_MAX_PERCENT / 100u;
+            if (m_moves.size() > limit)
+                resortDynamicFromCodes(q, ecs.jobSystem);
+            else
+                patchDynamic();
+            m_lastCellChanges = static_cast<uint32_t>(m_moves.size());
         }
 
-        if (m_entries.empty())
-            return;
+        // Movers change position every frame even when they stay in their cell.
+        refreshLayerData(ecs, m_dynamic);
 
-        // Sort by cell key, then by entry for determinism.
-        std::sort(m_entries.begin(), m_entries.end(), [](const KeyedGridEntry &a, const KeyedGridEntry &b)
-                  {
-                      GridKeyLess less;
-                      if (less(a.key, b.key))
-                          return true;
-                      if (less(b.key, a.key))
-                          return false;
-                      if (a.entry.storeId != b.entry.storeId)
-                          return a.entry.storeId < b.entry.storeId;
-                      return a.entry.row < b.entry.row; });
-
-        // Compact contiguous ranges per cell.
-        m_cells.reserve(m_entries.size() / 4 + 1);
-        GridKeyLess less;
-        uint32_t start = 0;
-        for (uint32_t i = 1; i < static_cast<uint32_t>(m_entries.size()); ++i)
-        {
-            const GridKey &prev = m_entries[start].key;
-            const GridKey &cur = m_entries[i].key;
-            const bool different = less(prev, cur) || less(cur, prev);
-            if (different)
-            {
-                m_cells.push_back(GridCellRange{prev, start, i - start});
-                start = i;
-            }
+        if (m_teamLayersEnabled)
+        {
+            refreshTeamLayers(dynamicReordered || m_teamLayersStale);
+            m_teamLayersStale = false;
         }
-        m_cells.push_back(GridCellRange{m_entries[start].key, start, static_cast<uint32_t>(m_entries.size()) - start});
 
-        m_lastEntriesIndexed = static_cast<uint32_t>(m_entries.size());
-        m_lastCellsBuilt = static_cast<uint32_t>(m_cells.size());
+        m_forceRebuild = false;
+        m_lastEntriesIndexed = static_cast<uint32_t>(m_static.entries.size() + m_dynamic.entries.size());
+        m_lastCellsBuilt = static_cast<uint32_t>(m_static.cells.size() + m_dynamic.cells.size());
     }
 
     // Visit candidate neighbors around (x,z): we scan the 3×3 neighborhood (cell, plus its 8 adjacent cells).
@@ -249,26 +407,13 @@ public:
     {
         const int gx = static_cast<int>(std::floor(x / m_cellSize));
         const int gz = static_cast<int>(std::floor(z / m_cellSize));
-        GridKeyLess less;
         for (int dx = -1; dx <= 1; ++dx)
         {
             for (int dy = -1; dy <= 1; ++dy)
             {
-                const GridKey key{gx + dx, gz + dy};
-                auto it = std::lower_bound(m_cells.begin(), m_cells.end(), key,
-                                           [&](const GridCellRange &cell, const GridKey &k)
-                                           { return less(cell.key, k); });
-                if (it == m_cells.end())
-                    continue;
-                if (less(key, it->key) || less(it->key, key))
-                    continue;
-
-                const uint32_t end = it->start + it->count;
-                for (uint32_t i = it->start; i < end; ++i)
-                {
-                    const auto &e = m_entries[i].entry;
-                    visit(e.storeId, e.row);
-                }
+                const uint64_t code = GridMortonCode(GridKey{gx + dx, gz + dy});
+                m_static.visitCell(code, visit);
+                m_dynamic.visitCell(code, visit);
             }
         }
     }
@@ -284,52 +429,676 @@ public:
         const int gx = static_cast<int>(std::floor(x / m_cellSize));
         const int gz = static_cast<int>(std::floor(z / m_cellSize));
 
-        GridKeyLess less;
         for (int dx = -k; dx <= k; ++dx)
         {
             for (int dz = -k; dz <= k; ++dz)
             {
-                const GridKey key{gx + dx, gz + dz};
-                auto it = std::lower_bound(m_cells.begin(), m_cells.end(), key,
-                                           [&](const GridCellRange &cell, const GridKey &k2)
-                                           { return less(cell.key, k2); });
-                if (it == m_cells.end())
-                    continue;
-                if (less(key, it->key) || less(it->key, key))
+                const uint64_t code = GridMortonCode(GridKey{gx + dx, gz + dz});
+                m_static.visitCell(code, visit);
+                m_dynamic.visitCell(code, visit);
+            }
+        }
+    }
+
+    // Visit candidates in every cell overlapping the X/Z rectangle [minX, maxX] x [minZ, maxZ]
+    // (e.g. a picking footprint on the ground). moversOnly skips the static layer. Callers apply
+    // the exact test. Large rectangles walk the occupied cells instead of every covered cell.
+    // Visitor signature: void(uint32_t storeId, uint32_t row)
+    template <typename Visitor>
+    void forEntitiesInRect(float minX, float minZ, float maxX, float maxZ, bool moversOnly, Visitor &&visit) const
+    {
+        if (!(minX <= maxX) || !(minZ <= maxZ))
+            return;
+        const GridKey lo{static_cast<int>(std::floor(minX / m_cellSize)), static_cast<int>(std::floor(minZ / m_cellSize))};
+        const GridKey hi{static_cast<int>(std::floor(maxX / m_cellSize)), static_cast<int>(std::floor(maxZ / m_cellSize))};
+        if (!moversOnly)
+            m_static.visitRect(lo, hi, visit);
+        m_dynamic.visitRect(lo, hi, visit);
+    }
+
+    // Entries (static and dynamic) in the cell containing (x,z): two lookups, no visiting.
+    // A cheap stand-in for how many neighbors a query there will see.
+    uint32_t cellOccupancy(float x, float z) const
+    {
+        const uint64_t code = GridMortonCode(GridKey{static_cast<int>(std::floor(x / m_cellSize)),
+                                                     static_cast<int>(std::floor(z / m_cellSize))});
+        const GridCellRange *s = m_static.findCell(code);
+        const GridCellRange *d = m_dynamic.findCell(code);
+        return (s ? s->count : 0u) + (d ? d->count : 0u);
+    }
+
+    // Same 3×3 neighborhood as forNeighbors, visiting the neighbor snapshots.
+    // Visitor signature: void(const GridNeighbor &n)
+    template <typename Visitor>
+    void forNeighborData(float x, float z, Visitor &&visit) const
+    {
+        const int gx = static_cast<int>(std::floor(x / m_cellSize));
+        const int gz = static_cast<int>(std::floor(z / m_cellSize));
+        for (int dx = -1; dx <= 1; ++dx)
+        {
+            for (int dz = -1; dz <= 1; ++dz)
+            {
+                const uint64_t code = GridMortonCode(GridKey{gx + dx, gz + dz});
+                m_static.visitCellData(code, visit);
+                m_dynamic.visitCellData(code, visit);
+            }
+        }
+    }
+
+    // Exact radius query: visits every neighbor the filter accepts with center distance <= radius.
+    // Visitor signature: void(const GridNeighbor &n, float dist2)
+    template <typename Visitor>
+    void queryRadius(float x, float z, float radiusMeters, const GridNeighborFilter &filter, Visitor &&visit) const
+    {
+        const float r = std::max(0.0f, radiusMeters);
+        const float r2 = r * r;
+        const int k = static_cast<int>(std::ceil(r / m_cellSize));
+        const int gx = static_cast<int>(std::floor(x / m_cellSize));
+        const int gz = static_cast<int>(std::floor(z / m_cellSize));
+
+        auto consider = [&](const GridNeighbor &n)
+        {
+            if (!filter.accepts(n))
+                return;
+            const float dx = n.x - x;
+            const float dz = n.z - z;
+            const float d2 = dx * dx + dz * dz;
+            if (d2 <= r2)
+                visit(n, d2);
+        };
+        for (int dx = -k; dx <= k; ++dx)
+        {
+            for (int dz = -k; dz <= k; ++dz)
+                visitFilteredCell(GridMortonCode(GridKey{gx + dx, gz + dz}), filter, consider);
+        }
+    }
+
+    // Up to k nearest neighbors within maxRadius, nearest first (ties: lower entity index first).
+    // Cells are scanned in rings around (x,z); the scan stops once no unvisited ring can beat the
+    // current k-th hit. accept(const GridNeighbor &) -> bool runs after the filter and distance
+    // test, for checks that need live store data (e.g. Health). Returns out.size().
+    template <typename Accept>
+    uint32_t queryKNearest(float x, float z, float maxRadius, uint32_t k, const GridNeighborFilter &filter,
+                           std::vector<GridNeighborHit> &out, Accept &&accept) const
+    {
+        out.clear();
+        if (k == 0)
+            return 0;
+
+        const float r = std::max(0.0f, maxRadius);
+        auto consider = [&](const GridNeighbor &n)
+        {
+            if (!filter.accepts(n))
+                return;
+            const float dx = n.x - x;
+            const float dz = n.z - z;
+            const float d2 = dx * dx + dz * dz;
+            if (d2 > r * r)
+                return;
+            if (out.size() == k && !hitLess(d2, n.entityIndex, out.back()))
+                return;
+            if (!accept(n))
+                return;
+
+            auto it = out.begin();
+            while (it != out.end() && !hitLess(d2, n.entityIndex, *it))
+                ++it;
+            out.insert(it, GridNeighborHit{n, d2});
+            if (out.size() > k)
+                out.pop_back();
+        };
+        scanRings(x, z, r, filter, consider, [&]()
+                  { return (out.size() == k) ? out.back().dist2 : r * r; });
+        return static_cast<uint32_t>(out.size());
+    }
+
+    uint32_t queryKNearest(float x, float z, float maxRadius, uint32_t k, const GridNeighborFilter &filter,
+                           std::vector<GridNeighborHit> &out) const
+    {
+        return queryKNearest(x, z, maxRadius, k, filter, out, [](const GridNeighbor &)
+                             { return true; });
+    }
+
+    // k = 1 without an output vector (safe to call from parallel loops). Returns false if nothing
+    // within maxRadius passes the filter and accept().
+    template <typename Accept>
+    bool findNearest(float x, float z, float maxRadius, const GridNeighborFilter &filter,
+                     GridNeighborHit &out, Accept &&accept) const
+    {
+        const float r = std::max(0.0f, maxRadius);
+        bool found = false;
+        auto consider = [&](const GridNeighbor &n)
+        {
+            if (!filter.accepts(n))
+                return;
+            const float dx = n.x - x;
+            const float dz = n.z - z;
+            const float d2 = dx * dx + dz * dz;
+            if (d2 > r * r)
+                return;
+            if (found && !hitLess(d2, n.entityIndex, out))
+                return;
+            if (!accept(n))
+                return;
+            out = GridNeighborHit{n, d2};
+            found = true;
+        };
+        scanRings(x, z, r, filter, consider, [&]()
+                  { return found ? out.dist2 : r * r; });
+        return found;
+    }
+
+private:
+    // One sorted entry list + its compacted cell ranges + a hash table over the cells.
+    struct Layer
+    {
+        static constexpr uint32_t EMPTY_SLOT = UINT32_MAX;
+
+        // Flat entry list, sorted by cell code (then store, row).
+        std::vector<KeyedGridEntry> entries;
+
+        // Neighbor snapshots, parallel to entries.
+        std::vector<GridNeighbor> data;
+
+        // Unique cells in code order with contiguous ranges into entries.
+        std::vector<GridCellRange> cells;
+
+        // Open addressing (linear probing) cell code -> index into cells; power-of-two size,
+        // at most half full.
+        std::vector<uint32_t> table;
+        uint32_t tableShift = 64;
+
+        void clear()
+        {
+            entries.clear();
+            data.clear();
+            cells.clear();
+            table.clear();
+        }
+
+        uint32_t slotOf(uint64_t code) const
+        {
+            return static_cast<uint32_t>((code * 0x9E3779B97F4A7C15ull) >> tableShift);
+        }
+
+        const GridCellRange *findCell(uint64_t code) const
+        {
+            if (table.empty())
+                return nullptr;
+            const uint32_t mask = static_cast<uint32_t>(table.size() - 1u);
+            for (uint32_t slot = slotOf(code);; slot = (slot + 1u) & mask)
+            {
+                const uint32_t idx = table[slot];
+                if (idx == EMPTY_SLOT)
+                    return nullptr;
+                if (cells[idx].code == code)
+                    return &cells[idx];
+            }
+        }
+
+        template <typename Visitor>
+        void visitCell(uint64_t code, Visitor &visit) const
+        {
+            const GridCellRange *cell = findCell(code);
+            if (!cell)
+                return;
+            const uint32_t end = cell->start + cell->count;
+            for (uint32_t i = cell->start; i < end; ++i)
+            {
+                const auto &e = entries[i].entry;
+                visit(e.storeId, e.row);
+            }
+        }
+
+        template <typename Visitor>
+        void visitCellData(uint64_t code, Visitor &visit) const
+        {
+            const GridCellRange *cell = findCell(code);
+            if (!cell || data.size() != entries.size())
+                return;
+            const uint32_t end = cell->start + cell->count;
+            for (uint32_t i = cell->start; i < end; ++i)
+                visit(data[i]);
+        }
+
+        // Cells with lo <= (gx, gz) <= hi: one lookup per covered cell, or one pass over the
+        // occupied cells when that is fewer.
+        template <typename Visitor>
+        void visitRect(const GridKey &lo, const GridKey &hi, Visitor &visit) const
+        {
+            const uint64_t covered = (uint64_t(int64_t(hi.gx) - lo.gx) + 1u) * (uint64_t(int64_t(hi.gz) - lo.gz) + 1u);
+            if (covered <= cells.size())
+            {
+                for (int gx = lo.gx; gx <= hi.gx; ++gx)
+                    for (int gz = lo.gz; gz <= hi.gz; ++gz)
+                        visitCell(GridMortonCode(GridKey{gx, gz}), visit);
+                return;
+            }
+            for (const GridCellRange &cell : cells)
+            {
+                const GridKey k = GridKeyFromMorton(cell.code);
+                if (k.gx < lo.gx || k.gx > hi.gx || k.gz < lo.gz || k.gz > hi.gz)
                     continue;
+                const uint32_t end = cell.start + cell.count;
+                for (uint32_t i = cell.start; i < end; ++i)
+                    visit(entries[i].entry.storeId, entries[i].entry.row);
+            }
+        }
 
-                const uint32_t end = it->start + it->count;
-                for (uint32_t i = it->start; i < end; ++i)
+        // Compact contiguous ranges per cell (entries must be sorted) and rebuild the hash table.
+        void finalize()
+        {
+            cells.clear();
+            table.clear();
+            if (entries.empty())
+                return;
+            cells.reserve(entries.size() / 4 + 1);
+            uint32_t start = 0;
+            for (uint32_t i = 1; i < static_cast<uint32_t>(entries.size()); ++i)
+            {
+                if (entries[i].code != entries[start].code)
                 {
-                    const auto &e = m_entries[i].entry;
-                    visit(e.storeId, e.row);
+                    cells.push_back(GridCellRange{entries[start].code, start, i - start});
+                    start = i;
                 }
             }
+            cells.push_back(GridCellRange{entries[start].code, start, static_cast<uint32_t>(entries.size()) - start});
+
+            uint32_t bits = 1;
+            while ((1ull << bits) < cells.size() * 2ull)
+                ++bits;
+            tableShift = 64u - bits;
+            table.assign(size_t(1) << bits, EMPTY_SLOT);
+            const uint32_t mask = static_cast<uint32_t>(table.size() - 1u);
+            for (uint32_t c = 0; c < static_cast<uint32_t>(cells.size()); ++c)
+            {
+                uint32_t slot = slotOf(cells[c].code);
+                while (table[slot] != EMPTY_SLOT)
+                    slot = (slot + 1u) & mask;
+                table[slot] = c;
+            }
         }
+    };
+
+    struct StoreState
+    {
+        bool valid = false;
+        bool dynamic = false;
+        uint32_t structuralVersion = 0;
+        std::vector<uint64_t> rowCodes; // dynamic stores only: cell code each row was indexed under
+    };
+
+    struct CellMove
+    {
+        uint64_t from;
+        KeyedGridEntry to;
+    };
+
+    // Layer order: cell code, then entry for determinism.
+    static bool entryLess(const KeyedGridEntry &a, const KeyedGridEntry &b)
+    {
+        if (a.code != b.code)
+            return a.code < b.code;
+        if (a.entry.storeId != b.entry.storeId)
+            return a.entry.storeId < b.entry.storeId;
+        return a.entry.row < b.entry.row;
     }
 
-private:
-    float m_cellSize; // equals neighbor radius R
+    uint64_t codeOf(const Engine::ECS::Position &p) const
+    {
+        return GridMortonCode(GridKey{static_cast<int>(std::floor(p.x / m_cellSize)),
+                                      static_cast<int>(std::floor(p.z / m_cellSize))});
+    }
 
-    // Flat entry list, sorted by GridKey.
-    std::vector<KeyedGridEntry> m_entries;
+    // Copy position/radius/separation/team/entity of every entry into layer.data.
+    void refreshLayerData(Engine::ECS::ECSContext &ecs, Layer &layer)
+    {
+        const uint32_t n = static_cast<uint32_t>(layer.entries.size());
+        layer.data.resize(n);
+        if (n == 0)
+            return;
 
-    // Sorted unique cells with contiguous ranges into m_entries.
-    std::vector<GridCellRange> m_cells;
+        auto fill = [&](uint32_t first, uint32_t last)
+        {
+            for (uint32_t i = first; i < last; ++i)
+            {
+                const GridEntry &e = layer.entries[i].entry;
+                const Engine::ECS::ArchetypeStore &store = *ecs.stores.get(e.storeId);
+                const auto &p = store.positions()[e.row];
+
+                GridNeighbor d;
+                d.x = p.x;
+                d.z = p.z;
+                d.entry = e;
+                d.entityIndex = store.entities()[e.row].index;
+                if (store.hasRadius())
+                {
+                    d.radius = store.radii()[e.row].r;
+                    d.flags |= GRID_NEIGHBOR_HAS_RADIUS;
+                }
+                else if (store.hasObstacleRadius())
+                {
+                    d.radius = store.obstacleRadii()[e.row].r;
+                    d.flags |= GRID_NEIGHBOR_HAS_RADIUS;
+                }
+                if (store.hasSeparation())
+                {
+                    d.separation = store.separations()[e.row].value;
+                    d.flags |= GRID_NEIGHBOR_HAS_SEPARATION;
+                }
+                if (store.hasTeam())
+                {
+                    d.team = store.teams()[e.row].id;
+                    d.flags |= GRID_NEIGHBOR_HAS_TEAM;
+                }
+                if (store.hasVelocity())
+                    d.flags |= GRID_NEIGHBOR_MOVER;
+                layer.data[i] = d;
+            }
+        };
+
+        Engine::JobSystem *js = ecs.jobSystem;
+        if (js && js->workerCount() > 0 && n >= PARALLEL_ENTRY_THRESHOLD)
+        {
+            js->parallelForRange(0u, n, js->autoGrain(n, PARALLEL_ROW_COST_NS),
+                                 [&](uint32_t /*workerIndex*/, uint32_t first, uint32_t last)
+                                 { fill(first, last); });
+        }
+        else
+        {
+            fill(0u, n);
+        }
+    }
 
-    // Per-worker scratch to build m_entries without contention.
-    std::vector<std::vector<KeyedGridEntry>> m_workerScratch;
+    static bool hitLess(float d2, uint32_t entityIndex, const GridNeighborHit &h)
+    {
+        if (d2 != h.dist2)
+            return d2 < h.dist2;
+        return entityIndex < h.neighbor.entityIndex;
+    }
 
-    struct StoreChunk
+    bool usesTeamLayers(const GridNeighborFilter &filter) const
     {
-        uint32_t archetypeId = 0;
-        uint32_t startRow = 0;
-        uint32_t count = 0;
-    };
-    std::vector<StoreChunk> m_chunks;
+        return m_teamLayersEnabled && !m_teamLayersStale && filter.teamMode != GridNeighborFilter::TeamMode::Any &&
+               (filter.requireFlags & GRID_NEIGHBOR_MOVER) != 0;
+    }
+
+    // Neighbor snapshots of one cell that can pass filter: the matching team layers when they
+    // hold every candidate (movers of a team), else both full layers.
+    template <typename Visitor>
+    void visitFilteredCell(uint64_t code, const GridNeighborFilter &filter, Visitor &visit) const
+    {
+        if (usesTeamLayers(filter))
+        {
+            const bool same = (filter.teamMode == GridNeighborFilter::TeamMode::Same);
+            for (uint8_t team : m_teamsPresent)
+            {
+                if ((team == filter.team) == same)
+                    m_teamLayers[team].visitCellData(code, visit);
+            }
+            return;
+        }
+        m_static.visitCellData(code, visit);
+        m_dynamic.visitCellData(code, visit);
+    }
+
+    // Split the dynamic layer by team. reorder = its entries changed (else only positions did,
+    // and the team layers keep their order and cells).
+    void refreshTeamLayers(bool reorder)
+    {
+        const uint32_t n = static_cast<uint32_t>(m_dynamic.entries.size());
+        if (reorder)
+        {
+            for (uint8_t team : m_teamsPresent)
+                m_teamLayers[team].clear();
+            m_teamsPresent.clear();
+
+            for (uint32_t i = 0; i < n; ++i)
+            {
+                const GridNeighbor &d = m_dynamic.data[i];
+                if (!(d.flags & GRID_NEIGHBOR_HAS_TEAM))
+                    continue;
+                if (d.team >= m_teamLayers.size())
+                    m_teamLayers.resize(static_cast<size_t>(d.team) + 1u);
+                Layer &layer = m_teamLayers[d.team];
+                if (layer.entries.empty())
+                    m_teamsPresent.push_back(d.team);
+                layer.entries.push_back(m_dynamic.entries[i]);
+                layer.data.push_back(d);
+            }
+            std::sort(m_teamsPresent.begin(), m_teamsPresent.end());
+            for (uint8_t team : m_teamsPresent)
+                m_teamLayers[team].finalize();
+            return;
+        }
+
+        // Same entries in the same order: copy the refreshed snapshots back in sequence. A Team
+        // written in place breaks the sequence; split again then.
+        for (uint8_t team : m_teamsPresent)
+            m_teamLayers[team].data.clear();
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            const GridNeighbor &d = m_dynamic.data[i];
+            if (!(d.flags & GRID_NEIGHBOR_HAS_TEAM))
+                continue;
+            Layer *layer = (d.team < m_teamLayers.size()) ? &m_teamLayers[d.team] : nullptr;
+            const size_t k = layer ? layer->data.size() : 0u;
+            if (!layer || k >= layer->entries.size() || layer->entries[k].entry.storeId != d.entry.storeId ||
+                layer->entries[k].entry.row != d.entry.row)
+            {
+                refreshTeamLayers(true);
+                return;
+            }
+            layer->data.push_back(d);
+        }
+    }
+
+    // Visit cells in square rings around (x,z) out to radius r. Before each ring, stop when even
+    // its closest point lies beyond cutoff() (squared distance any new hit has to beat).
+    template <typename Consider, typename Cutoff>
+    void scanRings(float x, float z, float r, const GridNeighborFilter &filter, Consider &consider, const Cutoff &cutoff) const
+    {
+        const int maxRing = static_cast<int>(std::ceil(r / m_cellSize));
+        const int gx = static_cast<int>(std::floor(x / m_cellSize));
+        const int gz = static_cast<int>(std::floor(z / m_cellSize));
+
+        auto visitCell = [&](int cx, int cz)
+        {
+            visitFilteredCell(GridMortonCode(GridKey{cx, cz}), filter, consider);
+        };
+
+        visitCell(gx, gz);
+        for (int ring = 1; ring <= maxRing; ++ring)
+        {
+            // Any point in ring `ring` is at least (ring - 1) cells away from (x,z).
+            const float bound = static_cast<float>(ring - 1) * m_cellSize;
+            if (bound * bound > cutoff())
+                break;
+
+            for (int d = -ring; d <= ring; ++d)
+            {
+                visitCell(gx + d, gz - ring);
+                visitCell(gx + d, gz + ring);
+            }
+            for (int d = -ring + 1; d <= ring - 1; ++d)
+            {
+                visitCell(gx - ring, gz + d);
+                visitCell(gx + ring, gz + d);
+            }
+        }
+    }
+
+    void sortLayer(Layer &layer, Engine::JobSystem *js)
+    {
+        Engine::RadixSort64(layer.entries, m_sortScratch, [](const KeyedGridEntry &e)
+                            { return e.code; }, m_radixScratch, js, PARALLEL_SORT_THRESHOLD);
+        layer.finalize();
+    }
+
+    // Re-key every row of the layer's stores, sort and compact.
+    void rebuildLayer(Engine::ECS::ECSContext &ecs, const Engine::ECS::Query &q, Layer &layer, bool dynamic)
+    {
+        // Option C: Flat list of entries, sorted by cell code, then compacted into ranges.
+        // Each row is written at its flat span index, so the parallel fill needs no per-worker
+        // scratch and the input order (archetype id, row) is deterministic for the stable sort.
+        layer.clear();
+
+        // Lay the layer's stores out as one flat row range; spans carry the match index so
+        // workers can reach the per-store code cache.
+        m_spans.clear();
+        for (uint32_t i : m_storeOrder)
+        {
+            const Engine::ECS::ArchetypeStore *storePtr = ecs.stores.get(q.matchingArchetypeIds[i]);
+            if (!storePtr || !storePtr->hasPosition() || storePtr->hasVelocity() != dynamic)
+                continue;
+            StoreState &state = m_storeStates[i];
+            if (dynamic)
+            {
+                state.rowCodes.reserve(storePtr->reservedRows());
+                state.rowCodes.resize(storePtr->size());
+            }
+            else
+                state.rowCodes.clear();
+            m_spans.add(i, storePtr->size());
+        }
+        const uint32_t totalEntities = m_spans.totalRows();
+        m_lastRowsRekeyed += totalEntities;
+        if (totalEntities == 0)
+            return;
+        layer.entries.resize(totalEntities);
+
+        auto fillSpan = [&](const Engine::ECS::StoreRowSpan &span, uint32_t startRow, uint32_t endRow)
+        {
+            const uint32_t matchIndex = span.archetypeId;
+            const uint32_t archetypeId = q.matchingArchetypeIds[matchIndex];
+            const auto &positions = ecs.stores.get(archetypeId)->positions();
+            uint64_t *rowCodes = dynamic ? m_storeStates[matchIndex].rowCodes.data() : nullptr;
+            KeyedGridEntry *out = layer.entries.data() + span.firstRow;
+
+            for (uint32_t row = startRow; row < endRow; ++row)
+            {
+                const uint64_t code = codeOf(positions[row]);
+                if (rowCodes)
+                    rowCodes[row] = code;
+                out[row] = KeyedGridEntry{code, GridEntry{archetypeId, row}};
+            }
+        };
+
+        Engine::JobSystem *js = ecs.jobSystem;
+        const bool hasWorkers = (js != nullptr) && (js->workerCount() > 0);
+        if (hasWorkers && totalEntities >= PARALLEL_ENTRY_THRESHOLD)
+        {
+            js->parallelForRange(0u, totalEntities, js->autoGrain(totalEntities, PARALLEL_ROW_COST_NS),
+                                 [&](uint32_t /*workerIndex*/, uint32_t first, uint32_t last)
+                                 { m_spans.forEachInRange(first, last, fillSpan); });
+        }
+        else
+        {
+            // Sequential fallback.
+            m_spans.forEachInRange(0u, totalEntities, fillSpan);
+        }
+
+        sortLayer(layer, js);
+    }
+
+    // Many rows changed cell: rebuild the dynamic entries from the cached codes (no position reads).
+    void resortDynamicFromCodes(const Engine::ECS::Query &q, Engine::JobSystem *js)
+    {
+        Layer &layer = m_dynamic;
+        layer.entries.clear();
+        for (uint32_t i : m_storeOrder)
+        {
+            const StoreState &state = m_storeStates[i];
+            if (!state.valid || !state.dynamic)
+                continue;
+            const uint32_t archetypeId = q.matchingArchetypeIds[i];
+            for (uint32_t row = 0; row < static_cast<uint32_t>(state.rowCodes.size()); ++row)
+                layer.entries.push_back(KeyedGridEntry{state.rowCodes[row], GridEntry{archetypeId, row}});
+        }
+        sortLayer(layer, js);
+    }
+
+    // Few rows changed cell: drop their old entries, merge the re-keyed ones back in. O(n + k log n).
+    void patchDynamic()
+    {
+        Layer &layer = m_dynamic;
+        auto &entries = layer.entries;
+
+        m_removeIdx.clear();
+        m_patchIn.clear();
+        for (const CellMove &m : m_moves)
+        {
+            const KeyedGridEntry old{m.from, m.to.entry};
+            auto it = std::lower_bound(entries.begin(), entries.end(), old, entryLess);
+            if (it != entries.end() && !entryLess(old, *it))
+                m_removeIdx.push_back(static_cast<uint32_t>(it - entries.begin()));
+            m_patchIn.push_back(m.to);
+        }
+        std::sort(m_removeIdx.begin(), m_removeIdx.end());
+        std::sort(m_patchIn.begin(), m_patchIn.end(), entryLess);
+
+        // Compact out the removed entries (stable, keeps the rest sorted).
+        size_t write = 0;
+        size_t r = 0;
+        for (size_t read = 0; read < entries.size(); ++read)
+        {
+            if (r < m_removeIdx.size() && m_removeIdx[r] == read)
+            {
+                ++r;
+                continue;
+            }
+            entries[write++] = entries[read];
+        }
+        entries.resize(write);
+
+        m_mergeScratch.clear();
+        m_mergeScratch.reserve(entries.size() + m_patchIn.size());
+        std::merge(entries.begin(), entries.end(), m_patchIn.begin(), m_patchIn.end(),
+                   std::back_inserter(m_mergeScratch), entryLess);
+        entries.swap(m_mergeScratch);
+        layer.finalize();
+    }
+
+    float m_cellSize; // equals neighbor radius R
+    bool m_incremental = true;
+    bool m_forceRebuild = true;
+
+    Layer m_static;  // stores without Velocity
+    Layer m_dynamic; // stores with Velocity
+
+    // setTeamLayers: movers with Team, one layer per team id (empty unless in m_teamsPresent).
+    bool m_teamLayersEnabled = false;
+    bool m_teamLayersStale = true; // not built yet for the current dynamic layer
+    std::vector<Layer> m_teamLayers;
+    std::vector<uint8_t> m_teamsPresent; // ascending
+
+    // Per matching store (index = position in the query's matchingArchetypeIds).
+    std::vector<StoreState> m_storeStates;
+
+    // Incremental patch scratch.
+    std::vector<CellMove> m_moves;
+    std::vector<uint32_t> m_removeIdx;
+    std::vector<KeyedGridEntry> m_patchIn;
+    std::vector<KeyedGridEntry> m_mergeScratch;
+
+    // Matching stores (match indices) in archetype id order.
+    std::vector<uint32_t> m_storeOrder;
+
+    // Radix sort scratch.
+    std::vector<KeyedGridEntry> m_sortScratch;
+    uint32_t m_reservedEntities = 0; // ECSContext::reservedEntities() the buffers were sized for
+    Engine::RadixSortScratch m_radixScratch;
+
+    // Layer stores as one flat row range for the parallel rebuild (span.archetypeId holds the match index).
+    Engine::ECS::StoreRowSpans m_spans;
 
     uint32_t m_lastEntriesIndexed = 0;
     uint32_t m_lastCellsBuilt = 0;
+    uint32_t m_lastRowsRekeyed = 0;
+    uint32_t m_lastCellChanges = 0;
+    bool m_lastStaticRebuilt = false;
 
+    uint32_t m_positionId = Engine::ECS::ComponentRegistry::InvalidID;
     Engine::ECS::QueryId m_queryId = Engine::ECS::QueryManager::InvalidQuery;
+    std::vector<uint32_t> m_dirtyRows; // consumeDirtyRows scratch, reused across stores and frames
 };
@@ -0,0 +1,175 @@
+#pragma once
+/*
+  SpatialReorderSystem.h
+  ----------------------
+  Purpose:
+    - Keep archetype store rows roughly in spatial order. Rows start in spawn order and
+      swap-removes scatter them further, so after a while units that stand next to each other
+      live far apart in the columns and neighbor loops (LocalAvoidanceSystem, CombatSystem,
+      SleepSystem) touch a new cache line for almost every neighbor.
+    - Every interval seconds of simulation time, each store with Position is sorted by the
+      Morton code of its rows' grid cells (SpatialIndexSystem's cell size and GridMortonCode),
+      so a cell's units, and their neighbor cells', end up in neighboring rows.
+
+  Notes:
+    - Off until setInterval(seconds > 0). Stores are reordered one per tick after the interval
+      elapsed, so one tick never pays for the whole world.
+    - A store whose rows are already mostly in order (fewer than SORTED_ENOUGH_FRACTION of
+      adjacent rows out of order) is left alone.
+    - Exclusive (declares no access): ECSContext::reorderRows moves rows under every system.
+      Results stay deterministic (the schedule depends on simulated time and positions only),
+      so lockstep peers reorder on the same ticks.
+
+  Suggested order per tick:
+    TransformHistorySystem -> SpatialReorderSystem -> ... -> SpatialIndexSystem
+*/
+
+#include "ECS/SystemFormat.h"
+#include "ECS/Components.h"
+#include "ECS/ArchetypeStore.h"
+
+#include "ECS/systems/SpatialIndexSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+class SpatialReorderSystem : public Engine::ECS::SystemBase
+{
+public:
+    // =====================
+    // TUNING CONSTANTS
+    // =====================
+    static constexpr uint32_t MIN_ROWS = 256;              // smaller stores fit in cache anyway
+    static constexpr float SORTED_ENOUGH_FRACTION = 0.05f; // out-of-order adjacent rows tolerated
+    static constexpr float INTERVAL_DEFAULT_SEC = 0.0f;    // off
+
+    struct Stats
+    {
+        uint32_t storesChecked = 0;
+        uint32_t storesReordered = 0;
+        uint32_t rowsMoved = 0; // rows that changed place in the last reorder
+    };
+
+    explicit SpatialReorderSystem(const SpatialIndexSystem *grid = nullptr)
+        : m_grid(grid)
+    {
+        setRequiredNames({"Position"});
+    }
+
+    const char *name() const override { return "SpatialReorderSystem"; }
+
+    void buildMasks(Engine::ECS::ComponentRegistry &registry) override
+    {
+        Engine::ECS::SystemBase::buildMasks(registry);
+        m_queryId = Engine::ECS::QueryManager::InvalidQuery;
+        m_pending.clear();
+    }
+
+    // Seconds of simulated time between passes; <= 0 turns reordering off.
+    void setInterval(float seconds)
+    {
+        m_interval = seconds;
+        reset();
+    }
+    float interval() const { return m_interval; }
+
+    // Restart the interval (lockstep start, loaded world): peers count from the same tick.
+    void reset()
+    {
+        m_elapsed = 0.0f;
+        m_pending.clear();
+    }
+
+    const Stats &stats() const { return m_stats; }
+
+    void update(Engine::ECS::ECSContext &ecs, float dt) override
+    {
+        m_stats.storesChecked = 0;
+        m_stats.storesReordered = 0;
+        if (m_interval <= 0.0f || dt <= 0.0f)
+            return;
+
+        if (m_queryId == Engine::ECS::QueryManager::InvalidQuery)
+            m_queryId = ecs.queries.createQuery(required(), excluded(), ecs.stores);
+
+        m_elapsed += dt;
+        if (m_pending.empty())
+        {
+            if (m_elapsed < m_interval)
+                return;
+            m_elapsed = 0.0f;
+            const auto &q = ecs.queries.get(m_queryId);
+            // Reverse so pop_back() visits stores in query order.
+            m_pending.assign(q.matchingArchetypeIds.rbegin(), q.matchingArchetypeIds.rend());
+        }
+
+        // At most one store actually sorted per tick.
+        while (!m_pending.empty())
+        {
+            const uint32_t archetypeId = m_pending.back();
+            m_pending.pop_back();
+            Engine::ECS::ArchetypeStore *store = ecs.stores.get(archetypeId);
+            if (!store || store->size() < MIN_ROWS || !store->hasPosition())
+                continue;
+            ++m_stats.storesChecked;
+            if (reorderStore(ecs, archetypeId, *store))
+                break;
+        }
+    }
+
+private:
+    // True when the store was reordered.
+    bool reorderStore(Engine::ECS::ECSContext &ecs, uint32_t archetypeId, Engine::ECS::ArchetypeStore &store)
+    {
+        const uint32_t n = store.size();
+        const float invCell = 1.0f / ((m_grid && m_grid->getCellSize() > 0.0f) ? m_grid->getCellSize() : 2.0f);
+        const auto positions = store.positions();
+
+        m_keys.resize(n);
+        uint32_t outOfOrder = 0;
+        for (uint32_t row = 0; row < n; ++row)
+        {
+            const auto &p = positions[row];
+            const GridKey cell{static_cast<int>(std::floor(p.x * invCell)), static_cast<int>(std::floor(p.z * invCell))};
+            m_keys[row] = Key{GridMortonCode(cell), row};
+            if (row > 0u && m_keys[row].code < m_keys[row - 1u].code)
+                ++outOfOrder;
+        }
+        if (static_cast<float>(outOfOrder) < static_cast<float>(n) * SORTED_ENOUGH_FRACTION)
+            return false;
+
+        // (code, row): ties keep their current order, so the result depends on the input only.
+        std::sort(m_keys.begin(), m_keys.end(), [](const Key &a, const Key &b)
+                  { return a.code != b.code ? a.code < b.code : a.row < b.row; });
+
+        m_order.resize(n);
+        uint32_t moved = 0;
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            m_order[i] = m_keys[i].row;
+            moved += (m_order[i] != i) ? 1u : 0u;
+        }
+
+        ecs.reorderRows(archetypeId, m_order.data());
+        ++m_stats.storesReordered;
+        m_stats.rowsMoved = moved;
+        return true;
+    }
+
+    struct Key
+    {
+        uint64_t code;
+        uint32_t row;
+    };
+
+    const SpatialIndexSystem *m_grid = nullptr; // not owned; cell size only
+    Engine::ECS::QueryId m_queryId = Engine::ECS::QueryManager::InvalidQuery;
+    float m_interval = INTERVAL_DEFAULT_SEC;
+    float m_elapsed = 0.0f;
+    std::vector<uint32_t> m_pending; // stores left in the current pass
+    std::vector<Key> m_keys;
+    std::vector<uint32_t> m_order;
+    Stats m_stats{};
+};
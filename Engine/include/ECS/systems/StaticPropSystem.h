@@ -0,0 +1,284 @@
+#pragma once
+/*
+  StaticPropSystem
+  ----------------
+  Purpose:
+    - Feeds entities tagged StaticProp (trees, grass, fences) to one StaticPropRenderPassModule
+      per model instead of RenderSystem's slot/pose path.
+    - Prefabs tagged StaticProp get no PosePalette, VisibilityState or RenderSlot, so
+      AnimationPlayback, PoseUpdate, VisibilityCulling, VisibleRenderGather and RenderSystem
+      never see them; the pass culls them on the GPU.
+
+  Incremental updates:
+    - Each prop's instance id in its pass is remembered per entity. Moves come from a dirty
+      query on WorldBounds (RenderTransformUpdateSystem marks it when the world sphere changes);
+      spawns/despawns are found by reconciling the stores whenever one of them changed
+      structurally, like NavGridBuilderSystem.
+    - Instance ids are reused lowest first so the pass's instance table stays dense.
+*/
+
+#include "ECS/SystemFormat.h"
+
+#include "assets/AssetManager.h"
+
+#include "Engine/Camera.h"
+#include "Engine/Renderer.h"
+#include "Engine/StaticPropRenderPassModule.h"
+#include "utils/MemoryReport.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+class StaticPropSystem : public Engine::ECS::SystemBase
+{
+public:
+    struct Stats
+    {
+        uint32_t propsAdded = 0;
+        uint32_t propsRemoved = 0;
+        uint32_t propsMoved = 0;
+    };
+
+    explicit StaticPropSystem(Engine::AssetManager *assets = nullptr)
+        : m_assets(assets)
+    {
+        setRequiredNames({"StaticProp", "RenderModel", "RenderTransform", "WorldBounds"});
+        setExcludedNames({"Disabled", "Dead"});
+        setReadNames({"RenderModel", "RenderTransform", "WorldBounds"});
+        setWriteNames({"Renderer"});
+    }
+
+    const char *name() const override { return "StaticPropSystem"; }
+
+    void setAssetManager(Engine::AssetManager *assets) { m_assets = assets; }
+    void setRenderer(Engine::Renderer *renderer) { m_renderer = renderer; }
+    void setCamera(Engine::Camera *camera)
+    {
+        m_camera = camera;
+        for (PassEntry &entry : m_passes)
+            entry.pass->setCamera(camera);
+    }
+
+    // Impostor switch distance of every pass, including ones created later (models cooked
+    // with an impostor only; see StaticPropRenderPassModule::setImpostorDistance).
+    void setImpostorDistance(float start, float blend)
+    {
+        m_impostorStart = start;
+        m_impostorBlend = blend;
+        for (PassEntry &entry : m_passes)
+            entry.pass->setImpostorDistance(start, blend);
+    }
+
+    const Stats &lastStats() const { return m_lastStats; }
+
+    void buildMasks(Engine::ECS::ComponentRegistry &registry) override
+    {
+        Engine::ECS::SystemBase::buildMasks(registry);
+        m_worldBoundsId = registry.ensureId("WorldBounds");
+        m_queryId = Engine::ECS::QueryManager::InvalidQuery;
+        m_storeVersions.clear(); // new query (e.g. after a restart): reconcile every prop once
+    }
+
+    void update(Engine::ECS::ECSContext &ecs, float /*dt*/) override
+    {
+        if (!m_assets || !m_renderer || !m_camera)
+            return;
+
+        if (m_queryId == Engine::ECS::QueryManager::InvalidQuery)
+        {
+            Engine::ECS::ComponentMask dirty;
+            dirty.set(m_worldBoundsId);
+            m_queryId = ecs.queries.createDirtyQuery(required(), excluded(), dirty, ecs.stores);
+        }
+
+        m_lastStats = Stats{};
+        const auto &q = ecs.queries.get(m_queryId);
+
+        bool structural = (m_storeVersions.size() != q.matchingArchetypeIds.size());
+        m_storeVersions.resize(q.matchingArchetypeIds.size(), UINT32_MAX);
+        for (size_t m = 0; m < q.matchingArchetypeIds.size(); ++m)
+        {
+            const Engine::ECS::ArchetypeStore *store = ecs.stores.get(q.matchingArchetypeIds[m]);
+            const uint32_t v = store ? store->structuralVersion() : 0u;
+            if (m_storeVersions[m] != v)
+            {
+                m_storeVersions[m] = v;
+                structural = true;
+            }
+        }
+
+        ++m_stamp;
+        if (structural)
+        {
+            for (uint32_t archetypeId : q.matchingArchetypeIds)
+            {
+                ecs.queries.discardDirtyRows(m_queryId, archetypeId);
+                const Engine::ECS::ArchetypeStore *store = ecs.stores.get(archetypeId);
+                if (!store)
+                    continue;
+                for (uint32_t row = 0; row < store->size(); ++row)
+                    syncProp(*store, row);
+            }
+            for (PropRecord &rec : m_records)
+            {
+                if (rec.present && rec.stamp != m_stamp)
+                    removeProp(rec);
+            }
+        }
+        else
+        {
+            for (uint32_t archetypeId : q.matchingArchetypeIds)
+            {
+                const Engine::ECS::ArchetypeStore *store = ecs.stores.get(archetypeId);
+                if (!store)
+                    continue;
+                ecs.queries.forEachDirtyRow(m_queryId, archetypeId, [&](uint32_t row)
+                                            {
+                                                if (row < store->size())
+                                                    syncProp(*store, row);
+                                            });
+            }
+        }
+    }
+
+    // Instance/cell buffers of every prop pass plus the per-entity records.
+    void reportMemory(Engine::MemoryReport &out) const
+    {
+        using Engine::MemoryReport;
+        uint64_t bytes = MemoryReport::bytesOf(m_records);
+        for (const PassEntry &entry : m_passes)
+        {
+            entry.pass->reportMemory(out);
+            bytes += MemoryReport::bytesOf(entry.freeIds);
+        }
+        out.add("Render", "Static prop records", bytes, 0, static_cast<uint32_t>(m_records.size()));
+    }
+
+private:
+    static constexpr uint32_t kNoPass = UINT32_MAX;
+
+    // One pass per model; ids are the pass's instance indices.
+    struct PassEntry
+    {
+        Engine::ModelHandle model{};
+        std::shared_ptr<Engine::StaticPropRenderPassModule> pass;
+        std::vector<uint32_t> freeIds; // min-heap: lowest free id first
+        uint32_t nextId = 0;
+    };
+
+    // What a prop entity last contributed to its pass.
+    struct PropRecord
+    {
+        uint32_t generation = 0;
+        bool present = false;
+        uint32_t stamp = 0;
+        uint32_t passIndex = kNoPass;
+        uint32_t instance = 0;
+        uint32_t transformVersion = 0; // RenderTransform::transformVersion last sent
+    };
+
+    uint32_t passFor(Engine::ModelHandle handle)
+    {
+        auto it = m_passByModel.find(handle.id);
+        if (it != m_passByModel.end())
+            return it->second;
+
+        PassEntry entry;
+        entry.model = handle;
+        entry.pass = std::make_shared<Engine::StaticPropRenderPassModule>();
+        entry.pass->setAssets(m_assets);
+        entry.pass->setModel(handle);
+        entry.pass->setCamera(m_camera);
+        entry.pass->setImpostorDistance(m_impostorStart, m_impostorBlend);
+        entry.pass->setEnabled(true);
+        m_renderer->registerPass(entry.pass);
+
+        const uint32_t index = static_cast<uint32_t>(m_passes.size());
+        m_passes.push_back(std::move(entry));
+        m_passByModel.emplace(handle.id, index);
+        return index;
+    }
+
+    static uint32_t acquireId(PassEntry &entry)
+    {
+        if (entry.freeIds.empty())
+            return entry.nextId++;
+        std::pop_heap(entry.freeIds.begin(), entry.freeIds.end(), std::greater<uint32_t>());
+        const uint32_t id = entry.freeIds.back();
+        entry.freeIds.pop_back();
+        return id;
+    }
+
+    void removeProp(PropRecord &rec)
+    {
+        PassEntry &entry = m_passes[rec.passIndex];
+        entry.pass->removeInstance(rec.instance);
+        entry.freeIds.push_back(rec.instance);
+        std::push_heap(entry.freeIds.begin(), entry.freeIds.end(), std::greater<uint32_t>());
+        rec.present = false;
+        rec.passIndex = kNoPass;
+        ++m_lastStats.propsRemoved;
+    }
+
+    // Brings the record of the prop at row up to date (add, move or model change); stamps it as seen.
+    void syncProp(const Engine::ECS::ArchetypeStore &store, uint32_t row)
+    {
+        const Engine::ECS::Entity e = store.entities()[row];
+        if (m_records.size() <= e.index)
+            m_records.resize(static_cast<size_t>(e.index) + 1u);
+        PropRecord &rec = m_records[e.index];
+
+        const Engine::ModelHandle handle = store.renderModels()[row].handle;
+        if (!handle.isValid())
+            return;
+        const uint32_t passIndex = passFor(handle);
+
+        // A recycled index whose old entity was not reconciled yet, or a swapped model.
+        if (rec.present && (rec.generation != e.generation || rec.passIndex != passIndex))
+            removeProp(rec);
+
+        rec.stamp = m_stamp;
+        const Engine::ECS::RenderTransform &transform = store.renderTransforms()[row];
+        if (rec.present && rec.transformVersion == transform.transformVersion)
+            return;
+
+        PassEntry &entry = m_passes[passIndex];
+        if (rec.present)
+        {
+            ++m_lastStats.propsMoved;
+        }
+        else
+        {
+            rec.instance = acquireId(entry);
+            ++m_lastStats.propsAdded;
+        }
+
+        rec.generation = e.generation;
+        rec.present = true;
+        rec.passIndex = passIndex;
+        rec.transformVersion = transform.transformVersion;
+        const Engine::ECS::WorldBounds &bounds = store.worldBounds()[row];
+        entry.pass->setInstance(rec.instance, transform.world, bounds.center, bounds.radius);
+    }
+
+    Engine::AssetManager *m_assets = nullptr;  // not owned
+    Engine::Renderer *m_renderer = nullptr;    // not owned
+    Engine::Camera *m_camera = nullptr;        // not owned
+    float m_impostorStart = Engine::StaticPropRenderPassModule::DEFAULT_IMPOSTOR_START;
+    float m_impostorBlend = Engine::StaticPropRenderPassModule::DEFAULT_IMPOSTOR_BLEND;
+
+    uint32_t m_worldBoundsId = Engine::ECS::ComponentRegistry::InvalidID;
+    Engine::ECS::QueryId m_queryId = Engine::ECS::QueryManager::InvalidQuery;
+    std::vector<uint32_t> m_storeVersions;
+    uint32_t m_stamp = 0;
+
+    std::vector<PassEntry> m_passes;
+    std::unordered_map<uint64_t, uint32_t> m_passByModel; // ModelHandle::id -> m_passes index
+    std::vector<PropRecord> m_records;                    // by entity index
+
+    Stats m_lastStats{};
+};
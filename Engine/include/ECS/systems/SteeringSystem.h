@@ -2,11 +2,25 @@
 
 #include "ECS/SystemFormat.h"
 #include "ECS/Components.h"
+#include "ECS/systems/CrowdFieldSystem.h"
+#include "ECS/systems/FlowField.h"
+#include "ECS/systems/NavGrid.h"
+#include "ECS/systems/PathStore.h"
 #include "utils/JobSystem.h"
+#include "utils/SimdMotion.h"
 
 #include <algorithm>
 #include <cmath>
-
+#include <limits>
+
+// Walks units along their MoveTarget: a group's flow field, or the Path planned for them.
+// With a NavGrid set, a Path is followed through its corridor (the cells the search walked,
+// PathStore): every step the unit finds its own cell in the corridor and string-pulls a funnel
+// through the cell edges ahead from where it stands, so a unit pushed aside by avoidance
+// re-aims at the next corner instead of walking back to a waypoint, and keeps its plan as long
+// as it is within its corridor or in sight of it. A unit that left it for good finishes the
+// plan on its waypoints. With a CrowdField set, units inside a crowd take the cheapest heading
+// near the desired one and the crowd's speed (CrowdFieldSystem).
 class SteeringSystem : public Engine::ECS::SystemBase
 {
 public:
@@ -14,16 +28,37 @@ public:
     // TUNING CONSTANTS
     // =====================
     static constexpr uint32_t PARALLEL_DIRTY_ROW_THRESHOLD = 256;
+    static constexpr uint32_t PARALLEL_GRAIN = 64;  // dirty rows per parallel range
+    static constexpr uint32_t BATCH = 4;            // lanes per SteerVelocity4 call
+    static constexpr float ACCELERATION = 15.0f;    // toward the desired velocity, 1/s
+    static constexpr uint32_t CORRIDOR_LOOKAHEAD = 8; // corridor cells searched ahead of the last known one
+    static constexpr uint32_t CORRIDOR_LOOKBACK = 4;  // ... and behind it (pushed back by avoidance)
+    static constexpr uint32_t FUNNEL_PORTALS = 24;    // cell edges string-pulled per step
+    static constexpr float PORTAL_MARGIN = 0.25f;     // of a cell, kept off each end of an edge
+    static constexpr uint32_t PARTIAL_REFINE_CELLS = 4; // partial plans ask for more this close to their end
 
     SteeringSystem()
     {
         // Position + Velocity + MoveTarget + MoveSpeed + Path + Facing required
         setRequiredNames({"Position", "Velocity", "MoveTarget", "MoveSpeed", "Path", "Facing"});
         setExcludedNames({"Disabled", "Dead"});
+        setReadNames({"Position", "MoveSpeed", "Radius", "Separation", "FlowField", "PathStore", "NavGrid", "CrowdField"});
+        setWriteNames({"Velocity", "MoveTarget", "Path", "Facing"});
     }
 
     const char *name() const override { return "SteeringSystem"; }
 
+    // Group-order fields owned by PathfindingSystem (Path::flowField handles point into it).
+    void setFlowFields(const FlowFieldCache *fields) { m_flowFields = fields; }
+    // Waypoints (Path::waypoints handles point into it), also owned by PathfindingSystem.
+    void setPathStore(const PathStore *paths) { m_paths = paths; }
+    // Grid the corridors index (PathfindingSystem's); nullptr = follow waypoints only.
+    void setNavGrid(const NavGrid *grid) { m_grid = grid; }
+    void setCorridorSteering(bool enabled) { m_useCorridors = enabled; }
+    // Congestion layer (CrowdFieldSystem's); nullptr = steer straight at the target.
+    void setCrowdField(const CrowdField *crowd) { m_crowd = crowd; }
+    bool corridorSteering() const { return m_useCorridors; }
+
     void buildMasks(Engine::ECS::ComponentRegistry &registry) override
     {
         Engine::ECS::SystemBase::buildMasks(registry);
@@ -63,7 +98,6 @@ public:
         // - Slow radius provides smooth deceleration near goal.
         const float stopRadius2 = 0.04f; // 0.2^2
         const float slowRadius = 2.0f;   // meters
-        const float slowRadius2 = slowRadius * slowRadius;
         const float waypointRadius2 = 0.30f; // 0.25^2
 
         // Limit turn speed to prevent jittery yaw flipping in dense obstacle fields.
@@ -77,16 +111,17 @@ public:
                 continue;
             auto &store = *storePtr;
 
-            auto dirtyRows = ecs.queries.consumeDirtyRows(m_queryId, archetypeId);
+            auto &dirtyRows = m_dirtyRows;
+            ecs.queries.consumeDirtyRows(m_queryId, archetypeId, dirtyRows);
             if (dirtyRows.empty())
                 continue;
 
-            auto &positions = const_cast<std::vector<Engine::ECS::Position> &>(store.positions());
-            auto &velocities = const_cast<std::vector<Engine::ECS::Velocity> &>(store.velocities());
-            auto &targets = const_cast<std::vector<Engine::ECS::MoveTarget> &>(store.moveTargets());
-            auto &speeds = const_cast<std::vector<Engine::ECS::MoveSpeed> &>(store.moveSpeeds());
-            auto &paths = const_cast<std::vector<Engine::ECS::Path> &>(store.paths());
-            auto &facings = const_cast<std::vector<Engine::ECS::Facing> &>(store.facings());
+            auto positions = store.positions();
+            auto velocities = store.velocities();
+            auto targets = store.moveTargets();
+            auto speeds = store.moveSpeeds();
+            auto paths = store.paths();
+            auto facings = store.facings();
 
             // Optional components: used to decide when a unit should consider itself "arrived".
             const bool hasRadius = store.hasRadius();
@@ -96,7 +131,66 @@ public:
 
             const uint32_t n = store.size();
 
-            auto processRow = [&](uint32_t i)
+            // Waypoints (and corridor) live in the PathStore block the path references.
+            auto viewOf = [this](const Engine::ECS::Path &p, PathStore::View &v) -> bool
+            {
+                return m_paths && m_paths->view(p.waypoints, v) && v.count >= p.count;
+            };
+
+            // Lanes of rows that still steer toward a target after target selection.
+            struct SteerLanes
+            {
+                uint32_t rows[BATCH];
+                float toX[BATCH], toZ[BATCH], speed[BATCH], arriveBias[BATCH];
+                float vx[BATCH], vz[BATCH], dirX[BATCH], dirZ[BATCH];
+                uint32_t count = 0;
+            };
+
+            // Accelerate the gathered lanes toward their targets, then turn them (yaw stays scalar).
+            auto flush = [&](SteerLanes &lanes)
+            {
+                if (lanes.count == 0)
+                    return;
+                for (uint32_t k = lanes.count; k < BATCH; ++k)
+                {
+                    // Idle lanes: any non-zero offset keeps the kernel finite.
+                    lanes.toX[k] = 1.0f;
+                    lanes.toZ[k] = 0.0f;
+                    lanes.speed[k] = 0.0f;
+                    lanes.arriveBias[k] = 1.0f;
+                    lanes.vx[k] = lanes.vz[k] = 0.0f;
+                }
+
+                Engine::simd::SteerVelocity4(lanes.toX, lanes.toZ, lanes.speed, lanes.arriveBias,
+                                             lanes.vx, lanes.vz, lanes.dirX, lanes.dirZ,
+                                             dt, ACCELERATION, slowRadius);
+
+                for (uint32_t k = 0; k < lanes.count; ++k)
+                {
+                    const uint32_t i = lanes.rows[k];
+                    auto &vel = velocities[i];
+                    auto &facing = facings[i];
+                    vel.x = lanes.vx[k];
+                    vel.z = lanes.vz[k];
+                    vel.y = 0.0f;
+
+                    const float desiredYaw = std::atan2(lanes.dirX[k], lanes.dirZ[k]);
+                    if (std::isfinite(desiredYaw) && std::isfinite(facing.yaw) && dt > 0.0f)
+                    {
+                        float delta = wrapPi(desiredYaw - facing.yaw);
+                        const float maxDelta = maxTurnRate * dt;
+                        delta = std::max(-maxDelta, std::min(maxDelta, delta));
+                        facing.yaw = wrapPi(facing.yaw + delta);
+                    }
+                    ecs.markDirty(m_facingId, archetypeId, i);
+                    ecs.markDirty(m_velocityId, archetypeId, i);
+                }
+                lanes.count = 0;
+            };
+
+            // Target selection, waypoint advance and arrival per row; rows still moving are queued
+            // for the batched velocity update.
+            auto processRow = [&](uint32_t i, SteerLanes &lanes)
             {
                 if (i >= n)
                     return;
@@ -106,7 +200,6 @@ public:
                 auto &tgt = targets[i];
                 const auto &spd = speeds[i];
                 auto &path = paths[i];
-                auto &facing = facings[i];
 
                 if (!tgt.active)
                     return;
@@ -114,12 +207,70 @@ public:
                 float tx = tgt.x;
                 float tz = tgt.z;
                 bool isFinal = true;
+                bool onField = false;
+                bool onCorridor = false;
+                bool corridorEnd = false;
+                const float *wpX = nullptr;
+                const float *wpZ = nullptr;
 
-                if (path.valid && path.current < path.count)
+                if (path.flowField != 0)
+                {
+                    float fx = 0.0f, fz = 0.0f;
+                    const FlowFieldCache::Step step = m_flowFields ? m_flowFields->steer(path.flowField, pos.x, pos.z, fx, fz)
+                                                                   : FlowFieldCache::Step::Lost;
+                    if (step == FlowFieldCache::Step::Follow)
+                    {
+                        tx = fx;
+                        tz = fz;
+                        isFinal = false;
+                        onField = true;
+                    }
+                    else
+                    {
+                        // Reached the group's goal rect (or left the field): PathfindingSystem
+                        // plans the rest with a per-unit path.
+                        path.flowField = 0;
+                        path.valid = false;
+                        ecs.markDirty(m_moveTargetId, archetypeId, i);
+                    }
+                }
+                else if (path.valid && path.current < path.count)
                 {
-                    tx = path.waypointsX[path.current];
-                    tz = path.waypointsZ[path.current];
-                    isFinal = false;
+                    PathStore::View v;
+                    if (viewOf(path, v))
+                    {
+                        wpX = v.x;
+                        wpZ = v.z;
+                        const uint8_t clearance = (m_grid && hasRadius && i < radii.size()) ? m_grid->clearanceFor(radii[i].r) : 0u;
+                        const uint32_t cellBefore = path.corridorCell;
+                        const CorridorStep step = m_useCorridors ? followCorridor(v, path, pos, clearance, waypointRadius2, tx, tz)
+                                                                 : CorridorStep::None;
+                        if (step != CorridorStep::None)
+                        {
+                            onCorridor = true;
+                            corridorEnd = (step == CorridorStep::End);
+                            isFinal = corridorEnd && !path.partial;
+
+                            // Partial (hierarchical) plan: request the next stretch while the unit
+                            // walks the last cells of this one.
+                            if (path.partial && path.corridorCell != cellBefore &&
+                                path.corridorCell + PARTIAL_REFINE_CELLS + 1u >= v.cellCount)
+                                ecs.markDirty(m_moveTargetId, archetypeId, i);
+                        }
+                        else
+                        {
+                            tx = wpX[path.current];
+                            tz = wpZ[path.current];
+                            isFinal = false;
+                        }
+                    }
+                    else
+                    {
+                        // Block is gone (row copied in from another world): replan.
+                        path.waypoints = 0;
+                        path.valid = false;
+                        ecs.markDirty(m_moveTargetId, archetypeId, i);
+                    }
                 }
 
                 float dx = tx - pos.x;
@@ -144,21 +295,42 @@ public:
                     radiusToCheck2 = std::max(stopRadius2, acceptR2);
                 }
 
-                if (d2 <= radiusToCheck2)
+                if (!onField && d2 <= radiusToCheck2)
                 {
                     if (isFinal)
                     {
                         vel.x = vel.y = vel.z = 0.0f;
                         tgt.active = 0;
                         path.valid = false;
+                        path.waypoints = 0; // the next PathStore sweep frees it
+                    }
+                    else if (onCorridor)
+                    {
+                        // Corners move on by themselves; only a partial plan's end is left.
+                        if (corridorEnd)
+                        {
+                            path.valid = false;
+                            path.waypoints = 0;
+                            tx = tgt.x;
+                            tz = tgt.z;
+                            dx = tx - pos.x;
+                            dz = tz - pos.z;
+                            d2 = dist2(dx, dz);
+                        }
                     }
                     else
                     {
                         path.current++;
+
+                        // Partial (hierarchical) plan: request the next stretch while the unit
+                        // walks toward the last refined waypoint.
+                        if (path.partial && path.current + 1u >= path.count)
+                            ecs.markDirty(m_moveTargetId, archetypeId, i);
+
                         if (path.current < path.count)
                         {
-                            tx = path.waypointsX[path.current];
-                            tz = path.waypointsZ[path.current];
+                            tx = wpX[path.current];
+                            tz = wpZ[path.current];
                             dx = tx - pos.x;
                             dz = tz - pos.z;
                             d2 = dist2(dx, dz);
@@ -166,6 +338,7 @@ public:
                         else
                         {
                             path.valid = false;
+                            path.waypoints = 0;
                             tx = tgt.x;
                             tz = tgt.z;
                             dx = tx - pos.x;
@@ -184,61 +357,265 @@ public:
 
                 if (d2 > 1e-8f)
                 {
-                    float dist = std::sqrt(d2);
-                    float invDist = 1.0f / dist;
-                    dx *= invDist;
-                    dz *= invDist;
-
                     float speed = spd.value;
-
-                    // Smooth arrival toward the final target.
-                    if (isFinal && d2 < slowRadius2)
+                    // In a crowd: the heading around the desired one that flows best, at the
+                    // crowd's pace (not while settling onto the final target).
+                    if (m_crowd && !(isFinal && d2 <= slowRadius * slowRadius))
                     {
-                        const float t = std::max(0.0f, std::min(dist / std::max(slowRadius, 1e-4f), 1.0f));
-                        speed *= t;
+                        const float dist = std::sqrt(d2);
+                        float hx = 0.0f, hz = 0.0f;
+                        if (m_crowd->steer(pos.x, pos.z, dx / dist, dz / dist, spd.value, hx, hz, speed))
+                        {
+                            dx = hx * dist;
+                            dz = hz * dist;
+                        }
                     }
 
-                    float targetVx = dx * speed;
-                    float targetVz = dz * speed;
-
-                    const float acceleration = 15.0f;
-
-                    float diffX = targetVx - vel.x;
-                    float diffZ = targetVz - vel.z;
-
-                    vel.x += diffX * acceleration * dt;
-                    vel.z += diffZ * acceleration * dt;
-                    vel.y = 0.0f;
-
-                    const float desiredYaw = std::atan2(dx, dz);
-                    if (std::isfinite(desiredYaw) && std::isfinite(facing.yaw) && dt > 0.0f)
-                    {
-                        float delta = wrapPi(desiredYaw - facing.yaw);
-                        const float maxDelta = maxTurnRate * dt;
-                        delta = std::max(-maxDelta, std::min(maxDelta, delta));
-                        facing.yaw = wrapPi(facing.yaw + delta);
-                    }
-                    ecs.markDirty(m_facingId, archetypeId, i);
+                    const uint32_t k = lanes.count++;
+                    lanes.rows[k] = i;
+                    lanes.toX[k] = dx;
+                    lanes.toZ[k] = dz;
+                    lanes.speed[k] = speed;
+                    // Smooth arrival toward the final target.
+                    lanes.arriveBias[k] = isFinal ? 0.0f : 1.0f;
+                    lanes.vx[k] = vel.x;
+                    lanes.vz[k] = vel.z;
+                    if (lanes.count == BATCH)
+                        flush(lanes);
+                    return;
                 }
 
                 ecs.markDirty(m_velocityId, archetypeId, i);
             };
 
-            if (ecs.jobSystem && dirtyRows.size() >= PARALLEL_DIRTY_ROW_THRESHOLD)
+            auto processRange = [&](uint32_t first, uint32_t last)
             {
-                ecs.jobSystem->parallelFor(static_cast<uint32_t>(dirtyRows.size()), [&](uint32_t /*worker*/, uint32_t item)
-                                           { processRow(dirtyRows[item]); });
+                SteerLanes lanes;
+                for (uint32_t k = first; k < last; ++k)
+                    processRow(dirtyRows[k], lanes);
+                flush(lanes);
+            };
+
+            const uint32_t count = static_cast<uint32_t>(dirtyRows.size());
+            if (ecs.jobSystem && count >= PARALLEL_DIRTY_ROW_THRESHOLD)
+            {
+                ecs.jobSystem->parallelForRange(0u, count, PARALLEL_GRAIN, [&](uint32_t /*worker*/, uint32_t first, uint32_t last)
+                                                { processRange(first, last); });
             }
             else
             {
-                for (uint32_t i : dirtyRows)
-                    processRow(i);
+                processRange(0u, count);
             }
         }
     }
 
 private:
+    enum class CorridorStep : uint8_t
+    {
+        None,   // no corridor (or left it): follow the waypoints
+        Corner, // steer at the first corner of the pulled string
+        End,    // the string reaches the plan's last waypoint
+    };
+
+    // Locates the unit in path's corridor (updating path.corridorCell) and writes the point to
+    // steer at to tx/tz: the first corner farther than minDist2 of the string pulled from the
+    // unit through the next FUNNEL_PORTALS edges. A unit outside the corridor keeps it while
+    // its cell sees the last known corridor cell; otherwise the path goes offCorridor.
+    CorridorStep followCorridor(const PathStore::View &v, Engine::ECS::Path &path, const Engine::ECS::Position &pos,
+                                uint8_t clearance, float minDist2, float &tx, float &tz) const
+    {
+        if (!m_grid || path.offCorridor || !v.cells || v.cellCount < 2u || path.corridorCell >= v.cellCount)
+            return CorridorStep::None;
+
+        const NavGrid &grid = *m_grid;
+        const int W = grid.width;
+        const int gx = grid.worldToGridX(pos.x);
+        const int gz = grid.worldToGridZ(pos.z);
+        const uint32_t cursor = path.corridorCell;
+        bool found = false;
+        if (grid.isValid(gx, gz))
+        {
+            const uint32_t cell = static_cast<uint32_t>(gz * W + gx);
+            const uint32_t ahead = std::min(v.cellCount, cursor + CORRIDOR_LOOKAHEAD + 1u);
+            for (uint32_t k = cursor; k < ahead && !found; ++k)
+            {
+                if (v.cells[k] == cell)
+                {
+                    path.corridorCell = k;
+                    found = true;
+                }
+            }
+            for (uint32_t k = cursor; k > 0u && cursor - k < CORRIDOR_LOOKBACK && !found; --k)
+            {
+                if (v.cells[k - 1u] == cell)
+                {
+                    path.corridorCell = k - 1u;
+                    found = true;
+                }
+            }
+        }
+        if (!found)
+        {
+            const int cx = static_cast<int>(v.cells[cursor]) % W;
+            const int cz = static_cast<int>(v.cells[cursor]) / W;
+            if (!grid.isValid(gx, gz) || !grid.lineCheckGrid(gx, gz, cx, cz, clearance))
+            {
+                path.offCorridor = true;
+                resumeWaypoints(v, path, pos);
+                return CorridorStep::None;
+            }
+        }
+
+        // Edges from the unit's cell on, then the end point as a closed portal.
+        struct Portal
+        {
+            float lx, lz, rx, rz;
+        };
+        Portal portals[FUNNEL_PORTALS + 1u];
+        uint32_t count = 0;
+        uint32_t k = path.corridorCell;
+        for (; k + 1u < v.cellCount && count < FUNNEL_PORTALS; ++k)
+        {
+            Portal &p = portals[count++];
+            portalBetween(v.cells[k], v.cells[k + 1u], p.lx, p.lz, p.rx, p.rz);
+        }
+        const bool reachesEnd = (k + 1u >= v.cellCount);
+        const float endX = reachesEnd ? v.x[v.count - 1u] : grid.gridToWorldX(static_cast<int>(v.cells[k]) % W);
+        const float endZ = reachesEnd ? v.z[v.count - 1u] : grid.gridToWorldZ(static_cast<int>(v.cells[k]) / W);
+        portals[count++] = Portal{endX, endZ, endX, endZ};
+
+        // Simple stupid funnel: left is counter-clockwise of the walking direction.
+        auto cross = [](float ax, float az, float bx, float bz)
+        { return ax * bz - az * bx; };
+        auto same = [](float ax, float az, float bx, float bz)
+        { return (ax - bx) * (ax - bx) + (az - bz) * (az - bz) < 1e-8f; };
+
+        float apexX = pos.x, apexZ = pos.z;
+        float leftX = apexX, leftZ = apexZ, rightX = apexX, rightZ = apexZ;
+        uint32_t leftIndex = 0, rightIndex = 0;
+        for (uint32_t i = 0, guard = 0; i < count && guard < 4u * count; ++i, ++guard)
+        {
+            const Portal &p = portals[i];
+            uint32_t corner = UINT32_MAX;
+            float cornerX = 0.0f, cornerZ = 0.0f;
+
+            if (cross(rightX - apexX, rightZ - apexZ, p.rx - apexX, p.rz - apexZ) >= 0.0f)
+            {
+                if (same(apexX, apexZ, rightX, rightZ) ||
+                    cross(leftX - apexX, leftZ - apexZ, p.rx - apexX, p.rz - apexZ) < 0.0f)
+                {
+                    rightX = p.rx;
+                    rightZ = p.rz;
+                    rightIndex = i;
+                }
+                else
+                {
+                    corner = leftIndex;
+                    cornerX = leftX;
+                    cornerZ = leftZ;
+                }
+            }
+            if (corner == UINT32_MAX && cross(leftX - apexX, leftZ - apexZ, p.lx - apexX, p.lz - apexZ) <= 0.0f)
+            {
+                if (same(apexX, apexZ, leftX, leftZ) ||
+                    cross(rightX - apexX, rightZ - apexZ, p.lx - apexX, p.lz - apexZ) > 0.0f)
+                {
+                    leftX = p.lx;
+                    leftZ = p.lz;
+                    leftIndex = i;
+                }
+                else
+                {
+                    corner = rightIndex;
+                    cornerX = rightX;
+                    cornerZ = rightZ;
+                }
+            }
+            if (corner == UINT32_MAX)
+                continue;
+
+            const float cdx = cornerX - pos.x, cdz = cornerZ - pos.z;
+            if (cdx * cdx + cdz * cdz > minDist2)
+            {
+                tx = cornerX;
+                tz = cornerZ;
+                return CorridorStep::Corner;
+            }
+            // Corner already reached: restart the funnel from it.
+            apexX = leftX = rightX = cornerX;
+            apexZ = leftZ = rightZ = cornerZ;
+            leftIndex = rightIndex = corner;
+            i = corner;
+        }
+
+        tx = endX;
+        tz = endZ;
+        return reachesEnd ? CorridorStep::End : CorridorStep::Corner;
+    }
+
+    // Edge shared by neighbor cells a -> b, PORTAL_MARGIN off both corners, as left/right seen
+    // walking from a to b; a diagonal step passes the shared corner (A*'s corner rule keeps the
+    // two cells beside it free). Cells that are not neighbors give b's center.
+    void portalBetween(uint32_t a, uint32_t b, float &lx, float &lz, float &rx, float &rz) const
+    {
+        const int W = m_grid->width;
+        const int ax = static_cast<int>(a) % W, az = static_cast<int>(a) / W;
+        const int dx = static_cast<int>(b) % W - ax, dz = static_cast<int>(b) / W - az;
+        const float half = 0.5f * m_grid->cellSize;
+        const float cx = m_grid->gridToWorldX(ax), cz = m_grid->gridToWorldZ(az);
+        if (std::abs(dx) > 1 || std::abs(dz) > 1)
+        {
+            lx = rx = m_grid->gridToWorldX(ax + dx);
+            lz = rz = m_grid->gridToWorldZ(az + dz);
+            return;
+        }
+        if (dx != 0 && dz != 0)
+        {
+            lx = rx = cx + static_cast<float>(dx) * half;
+            lz = rz = cz + static_cast<float>(dz) * half;
+            return;
+        }
+        const float extent = half - PORTAL_MARGIN * m_grid->cellSize;
+        const float ex = cx + static_cast<float>(dx) * half, ez = cz + static_cast<float>(dz) * half;
+        // Along the edge: perpendicular to the step, (-dz, dx) is counter-clockwise of it.
+        lx = ex - static_cast<float>(dz) * extent;
+        lz = ez + static_cast<float>(dx) * extent;
+        rx = ex + static_cast<float>(dz) * extent;
+        rz = ez - static_cast<float>(dx) * extent;
+    }
+
+    // Waypoint to continue from when the corridor is dropped: the nearest one ahead of the
+    // cursor, or the one after it when the unit is already past it.
+    static void resumeWaypoints(const PathStore::View &v, Engine::ECS::Path &path, const Engine::ECS::Position &pos)
+    {
+        uint32_t best = path.current;
+        float bestD2 = std::numeric_limits<float>::max();
+        for (uint32_t j = path.current; j < path.count; ++j)
+        {
+            const float dx = v.x[j] - pos.x, dz = v.z[j] - pos.z;
+            const float d2 = dx * dx + dz * dz;
+            if (d2 < bestD2)
+            {
+                bestD2 = d2;
+                best = j;
+            }
+        }
+        if (best + 1u < path.count)
+        {
+            const float sx = v.x[best + 1u] - v.x[best], sz = v.z[best + 1u] - v.z[best];
+            if ((pos.x - v.x[best]) * sx + (pos.z - v.z[best]) * sz > 0.0f)
+                ++best;
+        }
+        path.current = best;
+    }
+
+    const FlowFieldCache *m_flowFields = nullptr; // not owned
+    const PathStore *m_paths = nullptr;           // not owned
+    const NavGrid *m_grid = nullptr;              // not owned
+    const CrowdField *m_crowd = nullptr;          // not owned
+    bool m_useCorridors = true;
     Engine::ECS::QueryId m_queryId = Engine::ECS::QueryManager::InvalidQuery;
+    std::vector<uint32_t> m_dirtyRows; // consumeDirtyRows scratch, reused across stores and frames
     uint32_t m_positionId = Engine::ECS::ComponentRegistry::InvalidID;
     uint32_t m_velocityId = Engine::ECS::ComponentRegistry::InvalidID;
     uint32_t m_moveTargetId = Engine::ECS::ComponentRegistry::InvalidID;
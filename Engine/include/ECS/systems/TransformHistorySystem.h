@@ -0,0 +1,94 @@
+#pragma once
+
+#include "ECS/SystemFormat.h"
+#include "ECS/Components.h"
+
+#include <cstdint>
+
+// Copies Position/Facing into PreviousTransform at the start of every fixed simulation tick, so
+// RenderTransformUpdateSystem can draw entities between the last two ticks.
+// Must be the first system of the fixed-step schedule.
+// Only chunks whose Position or Facing changed since the previous tick are visited; a row whose
+// PreviousTransform changes is marked dirty so its render transform settles on the exact pose.
+class TransformHistorySystem : public Engine::ECS::SystemBase
+{
+public:
+    struct Stats
+    {
+        uint32_t chunksVisited = 0;
+        uint32_t rowsCopied = 0;
+    };
+
+    TransformHistorySystem()
+    {
+        setRequiredNames({"Position", "PreviousTransform"});
+        setExcludedNames({"Disabled", "Dead"});
+        setReadNames({"Position", "Facing"});
+        setWriteNames({"PreviousTransform"});
+    }
+
+    const char *name() const override { return "TransformHistorySystem"; }
+
+    void buildMasks(Engine::ECS::ComponentRegistry &registry) override
+    {
+        Engine::ECS::SystemBase::buildMasks(registry);
+        m_positionId = registry.ensureId("Position");
+        m_facingId = registry.ensureId("Facing");
+        m_previousId = registry.ensureId("PreviousTransform");
+        m_queryId = Engine::ECS::QueryManager::InvalidQuery;
+        m_lastVersion = 0;
+    }
+
+    const Stats &stats() const { return m_stats; }
+
+    void update(Engine::ECS::ECSContext &ecs, float /*dt*/) override
+    {
+        if (m_queryId == Engine::ECS::QueryManager::InvalidQuery)
+            m_queryId = ecs.queries.createQuery(required(), excluded(), ecs.stores);
+
+        m_stats = Stats{};
+        // Writes stamped later with the current version (same level, or outside the scheduler
+        // before it advances again) must still count next tick, so remember one version back.
+        const uint32_t since = m_lastVersion;
+        m_lastVersion = ecs.changeVersion() - 1u;
+
+        auto snapshot = [&](Engine::ECS::ArchetypeStore &store, uint32_t archetypeId, uint32_t /*chunk*/,
+                            uint32_t firstRow, uint32_t rowCount)
+        {
+            ++m_stats.chunksVisited;
+            auto positions = store.positions();
+            auto previous = store.previousTransforms();
+            const bool hasFacing = store.hasFacing();
+            auto facings = store.facings();
+
+            for (uint32_t row = firstRow; row < firstRow + rowCount; ++row)
+            {
+                const Engine::ECS::Position &pos = positions[row];
+                const float yaw = hasFacing ? facings[row].yaw : 0.0f;
+                Engine::ECS::PreviousTransform &prev = previous[row];
+                if (prev.valid && prev.x == pos.x && prev.y == pos.y && prev.z == pos.z && prev.yaw == yaw)
+                    continue;
+
+                prev.x = pos.x;
+                prev.y = pos.y;
+                prev.z = pos.z;
+                prev.yaw = yaw;
+                prev.valid = 1u;
+                ecs.markDirty(m_previousId, archetypeId, row);
+                ++m_stats.rowsCopied;
+            }
+        };
+
+        // A chunk touched in both columns is visited twice; the second pass finds nothing to copy.
+        ecs.forEachChangedChunk(m_queryId, m_positionId, since, snapshot);
+        ecs.forEachChangedChunk(m_queryId, m_facingId, since, snapshot);
+    }
+
+private:
+    Engine::ECS::QueryId m_queryId = Engine::ECS::QueryManager::InvalidQuery;
+    uint32_t m_lastVersion = 0; // ecs.changeVersion() at the previous tick
+    uint32_t m_positionId = Engine::ECS::ComponentRegistry::InvalidID;
+    uint32_t m_facingId = Engine::ECS::ComponentRegistry::InvalidID;
+    uint32_t m_previousId = Engine::ECS::ComponentRegistry::InvalidID;
+    Stats m_stats{};
+};
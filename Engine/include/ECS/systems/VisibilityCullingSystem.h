@@ -3,29 +3,45 @@
 #include "ECS/SystemFormat.h"
 #include "Engine/Frustum.h"
 #include "Engine/Camera.h"
+#include "Engine/HiZOcclusion.h"
 #include "utils/JobSystem.h"
 
+#include <algorithm>
+#include <limits>
+#include <vector>
+
 #if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
 #include <iostream>
 #endif
 
+// Per-entity frustum (and optional Hi-Z) visibility, written to the stores' visibility bits
+// (ArchetypeStore::visibleBits) and VisibilityState::visibleFrame.
+// Culls per store chunk first: each chunk keeps the box around its rows' world spheres, refreshed
+// only when WorldBounds changed in the chunk (chunk change versions) or the store's rows moved.
+// A chunk fully outside the frustum hides all its rows and one fully inside shows them, with no
+// per-row test (a whole word of bits at once); only rows of chunks that straddle a plane test their own sphere, eight rows per
+// Frustum::testSpheres8 call. Rows spawn in
+// batches, so a chunk's rows are mostly one group of neighbours and an RTS camera close to the
+// ground rejects most chunks outright.
 class VisibilityCullingSystem : public Engine::ECS::SystemBase
 {
 public:
     // =====================
     // TUNING CONSTANTS
     // =====================
-    // Parallelize when total rows tested across all matching stores exceeds this threshold.
+    // Parallelize when total rows across all matching stores exceeds this threshold.
     static constexpr uint32_t PARALLEL_TOTAL_ROW_THRESHOLD = 40;
 
-    // Chunk size (rows per task) for parallel culling.
-    static constexpr uint32_t PARALLEL_CHUNK_SIZE = 40;
+    // Rough cost of one row (ns); the job system derives the chunks per task from it.
+    static constexpr uint32_t PARALLEL_ROW_COST_NS = 20;
 
     VisibilityCullingSystem()
     {
-        // Requires render bounds and visibility state
-        setRequiredNames({"RenderBounds", "VisibilityState"});
+        // Requires world bounds and visibility state
+        setRequiredNames({"WorldBounds", "VisibilityState"});
         setExcludedNames({"Disabled", "Dead"});
+        setReadNames({"WorldBounds"});
+        setWriteNames({"VisibilityState"});
     }
 
     const char *name() const override { return "VisibilityCullingSystem"; }
@@ -34,16 +50,28 @@ public:
     {
         Engine::ECS::SystemBase::buildMasks(registry);
         m_visibilityStateId = registry.ensureId("VisibilityState");
+        m_worldBoundsId = registry.ensureId("WorldBounds");
         m_queryId = Engine::ECS::QueryManager::InvalidQuery;
+        m_storeBounds.clear();
+        m_lastVersion = 0;
     }
 
     void setCamera(Engine::Camera *camera) { m_camera = camera; }
 
+    // GPU culling mode: the frustum test moves to SModelRenderPassModule's compute pass, so every
+    // renderable is kept visible here (poses keep animating, render buckets hold all instances).
+    void setGpuCulling(bool enable) { m_gpuCulling = enable; }
+    bool gpuCulling() const { return m_gpuCulling; }
+
+    // Optional Hi-Z occlusion: frustum-visible entities hidden behind the previous frame's depth
+    // are marked invisible too, so pose/animation work skips them. Not owned; nullptr disables.
+    void setOcclusion(const Engine::HiZOcclusion *occlusion) { m_occlusion = occlusion; }
+
     void update(Engine::ECS::ECSContext &ecs, float dt) override
     {
         (void)dt;
 
-        if (!m_camera)
+        if (!m_camera && !m_gpuCulling)
             return;
 
         if (m_queryId == Engine::ECS::QueryManager::InvalidQuery)
@@ -52,13 +80,26 @@ public:
         m_frameCounter++;
         m_lastStats = Stats{};
 
-        // Build frustum from camera
-        glm::mat4 viewProj = m_camera->GetProjectionMatrix() * m_camera->GetViewMatrix();
-        Engine::Frustum frustum = Engine::Frustum::fromViewProjection(viewProj);
+        // Same convention as RenderTransformUpdateSystem: marks stamped at the current version count next time.
+        const uint32_t since = m_lastVersion;
+        m_lastVersion = ecs.changeVersion() - 1u;
+
+        // Build frustum from camera (unused in GPU culling mode)
+        Engine::Frustum frustum{};
+        if (!m_gpuCulling)
+        {
+            glm::mat4 viewProj = m_camera->GetProjectionMatrix() * m_camera->GetViewMatrix();
+            frustum = Engine::Frustum::fromViewProjection(viewProj);
+        }
+
+        const Engine::HiZOcclusion *occlusion = (m_occlusion && m_occlusion->ready()) ? m_occlusion : nullptr;
 
         const auto &q = ecs.queries.get(m_queryId);
 
-        // Build chunk list for parallel path (and compute total row count).
+        // One work item per non-empty chunk of every matching store, or per run of chunks that
+        // fills one 64-row visibility word when chunks are smaller than that, so no two lanes
+        // write the same word. Chunk boxes are sized here, on the calling thread, so the
+        // parallel part only writes entries it owns.
         m_chunks.clear();
         uint32_t totalRows = 0;
         for (uint32_t archetypeId : q.matchingArchetypeIds)
@@ -71,41 +112,177 @@ public:
                 continue;
             if (!store.signature().containsNone(excluded()))
                 continue;
-            if (!store.hasRenderBounds() || !store.hasVisibilityState())
+            if (!store.hasWorldBounds() || !store.hasVisibilityState())
                 continue;
 
             const uint32_t n = store.size();
             if (n == 0u)
                 continue;
 
-            totalRows += n;
+            if (archetypeId >= m_storeBounds.size())
+                m_storeBounds.resize(static_cast<size_t>(archetypeId) + 1u);
+            StoreBounds &sb = m_storeBounds[archetypeId];
+            if (sb.structuralVersion != store.structuralVersion() || sb.chunks.size() != store.chunkCount())
+            {
+                // Rows added, removed or swap-moved: every box is rebuilt.
+                sb.structuralVersion = store.structuralVersion();
+                sb.chunks.assign(store.chunkCount(), ChunkBounds{});
+            }
 
-            if (PARALLEL_CHUNK_SIZE == 0u)
+            const uint32_t chunksPerItem = std::max(1u, 64u / store.chunkCapacity());
+            for (uint32_t c = 0; c < store.chunkCount(); c += chunksPerItem)
             {
-                Chunk c;
-                c.archetypeId = archetypeId;
-                c.startRow = 0u;
-                c.endRow = n;
-                m_chunks.push_back(c);
+                const uint32_t chunkEnd = std::min(store.chunkCount(), c + chunksPerItem);
+                uint32_t rows = 0;
+                for (uint32_t k = c; k < chunkEnd; ++k)
+                    rows += store.chunkRows(k);
+                if (rows == 0u)
+                    continue;
+                m_chunks.push_back(ChunkItem{archetypeId, c, chunkEnd, c * store.chunkCapacity(), rows});
+                totalRows += rows;
             }
-            else
+        }
+
+        using Containment = Engine::Frustum::Containment;
+
+        // Sets bit 'row' of the store's visible words; rows of one item only.
+        auto cullChunk = [&](Engine::ECS::ArchetypeStore &store, uint32_t archetypeId, uint32_t chunk, Stats &stats)
+        {
+            auto worldBounds = store.worldBounds();
+            uint64_t *visible = store.visibleBits();
+            ChunkBounds &box = m_storeBounds[archetypeId].chunks[chunk];
+            const uint32_t rows = store.chunkRows(chunk);
+            const uint32_t first = chunk * store.chunkCapacity();
+            const uint32_t last = first + rows;
+            if (rows == 0u)
+                return;
+
+            if (!box.valid || box.rows != rows || store.chunkChangedSince(chunk, m_worldBoundsId, since))
             {
-                for (uint32_t start = 0u; start < n; start += PARALLEL_CHUNK_SIZE)
+                glm::vec3 mn(std::numeric_limits<float>::max());
+                glm::vec3 mx(-std::numeric_limits<float>::max());
+                for (uint32_t row = first; row < last; ++row)
                 {
-                    Chunk c;
-                    c.archetypeId = archetypeId;
-                    c.startRow = start;
-                    c.endRow = std::min<uint32_t>(n, start + PARALLEL_CHUNK_SIZE);
-                    m_chunks.push_back(c);
+                    const auto &b = worldBounds[row];
+                    mn = glm::min(mn, b.center - glm::vec3(b.radius));
+                    mx = glm::max(mx, b.center + glm::vec3(b.radius));
                 }
+                box.mn = mn;
+                box.mx = mx;
+                box.rows = rows;
+                box.valid = true;
+                stats.boxesRebuilt += 1u;
             }
-        }
 
-        const bool canParallel = (ecs.jobSystem && totalRows >= PARALLEL_TOTAL_ROW_THRESHOLD && !m_chunks.empty());
+            const Containment where = m_gpuCulling ? Containment::Inside : frustum.classifyAABB(box.mn, box.mx);
+            stats.chunks += 1u;
+            if (where == Containment::Outside)
+            {
+                stats.chunksRejected += 1u;
+                return; // bits stay cleared
+            }
+            if (where == Containment::Inside)
+            {
+                stats.chunksAccepted += 1u;
+                if (!occlusion)
+                {
+                    // Whole words at a time; chunks start on a word or inside one word.
+                    for (uint32_t row = first; row < last;)
+                    {
+                        const uint32_t bit = row & 63u;
+                        const uint32_t count = std::min(64u - bit, last - row);
+                        const uint64_t mask = (count == 64u) ? ~uint64_t{0} : (((uint64_t{1} << count) - 1u) << bit);
+                        visible[row >> 6] |= mask;
+                        row += count;
+                    }
+                    return;
+                }
+            }
+
+            // Straddling chunks test their spheres eight at a time: each group is gathered into
+            // SoA lanes (tail lanes padded with a zero sphere) and yields one bit per row.
+            uint32_t laneMask = 0u;
+            for (uint32_t row = first; row < last; ++row)
+            {
+                const auto &bounds = worldBounds[row];
+                bool nowVisible = (where == Containment::Inside);
+                if (where == Containment::Intersecting)
+                {
+                    const uint32_t lane = (row - first) & 7u;
+                    if (lane == 0u)
+                    {
+                        alignas(16) float cx[8] = {}, cy[8] = {}, cz[8] = {}, cr[8] = {};
+                        const uint32_t lanes = std::min(8u, last - row);
+                        for (uint32_t k = 0; k < lanes; ++k)
+                        {
+                            const auto &b = worldBounds[row + k];
+                            cx[k] = b.center.x;
+                            cy[k] = b.center.y;
+                            cz[k] = b.center.z;
+                            cr[k] = b.radius;
+                        }
+                        laneMask = frustum.testSpheres8(cx, cy, cz, cr);
+                    }
+                    stats.totalTested += 1u;
+                    nowVisible = (laneMask >> lane) & 1u;
+                }
+                if (nowVisible && occlusion && occlusion->isOccluded(bounds.center, bounds.radius))
+                {
+                    nowVisible = false;
+                    stats.occluded += 1u;
+                }
+                if (nowVisible)
+                    visible[row >> 6] |= uint64_t{1} << (row & 63u);
+            }
+        };
+
+        // Last frame's bits move to wasVisibleBits, the chunks rebuild the visible ones, and the
+        // rows that flipped are found a word at a time.
+        auto cullItem = [&](const ChunkItem &item, Stats &stats, std::vector<RowRef> *changed)
+        {
+            auto &store = *ecs.stores.get(item.archetypeId);
+            uint64_t *visible = store.visibleBits();
+            uint64_t *was = store.wasVisibleBits();
+            const uint32_t wordBegin = item.firstRow >> 6;
+            const uint32_t wordEnd = (item.firstRow + item.rows + 63u) >> 6;
+            for (uint32_t w = wordBegin; w < wordEnd; ++w)
+            {
+                was[w] = visible[w];
+                visible[w] = 0u;
+            }
+
+            for (uint32_t c = item.chunk; c < item.chunkEnd; ++c)
+                cullChunk(store, item.archetypeId, c, stats);
+
+            auto visibilityStates = store.visibilityState();
+            const uint32_t previousFrame = store.visibilityTestFrame();
+            for (uint32_t w = wordBegin; w < wordEnd; ++w)
+            {
+                const uint64_t now = visible[w];
+                const uint64_t before = was[w];
+                stats.visibleNow += Engine::ECS::popcount64(now);
+                stats.becameVisible += Engine::ECS::popcount64(now & ~before);
+                stats.becameInvisible += Engine::ECS::popcount64(before & ~now);
+
+                for (uint64_t flipped = now ^ before; flipped != 0u; flipped &= flipped - 1u)
+                {
+                    const uint32_t row = (w << 6) + Engine::ECS::ctz64(flipped);
+                    if ((before >> (row & 63u)) & 1u)
+                        visibilityStates[row].visibleFrame = previousFrame; // last frame it was seen
+                    if (changed)
+                        changed->push_back(RowRef{item.archetypeId, row});
+                    else
+                        ecs.markDirty(m_visibilityStateId, item.archetypeId, row);
+                }
+            }
+        };
+
+        const uint32_t chunkCount = static_cast<uint32_t>(m_chunks.size());
+        const bool canParallel = (ecs.jobSystem && totalRows >= PARALLEL_TOTAL_ROW_THRESHOLD && chunkCount > 1u);
 
         if (canParallel)
         {
-            const uint32_t scratchCount = ecs.jobSystem ? (ecs.jobSystem->workerCount() + 1u) : 1u;
+            const uint32_t scratchCount = ecs.jobSystem->workerCount() + 1u;
             if (m_workerStats.size() < scratchCount)
                 m_workerStats.resize(scratchCount);
             if (m_workerChanged.size() < scratchCount)
@@ -116,143 +293,46 @@ public:
                 m_workerChanged[i].clear();
             }
 
-            ecs.jobSystem->parallelFor(static_cast<uint32_t>(m_chunks.size()), [&](uint32_t workerIndex, uint32_t chunkIndex)
-                                       {
-                                           const uint32_t scratchIdx = std::min<uint32_t>(workerIndex, scratchCount - 1u);
-                                           Stats &stats = m_workerStats[scratchIdx];
-                                           auto &changed = m_workerChanged[scratchIdx];
-
-                                           const Chunk &chunk = m_chunks[chunkIndex];
-                                           auto *ptr = ecs.stores.get(chunk.archetypeId);
-                                           if (!ptr)
-                                               return;
-                                           auto &store = *ptr;
-                                           if (!store.hasRenderBounds() || !store.hasVisibilityState())
-                                               return;
-
-                                           auto &renderBounds = store.renderBounds();
-                                           auto &visibilityStates = store.visibilityState();
-                                           const uint32_t n = store.size();
-                                           const uint32_t start = std::min(chunk.startRow, n);
-                                           const uint32_t end = std::min(chunk.endRow, n);
-
-                                           for (uint32_t row = start; row < end; ++row)
-                                           {
-                                               auto &visibility = visibilityStates[row];
-                                               const auto &bounds = renderBounds[row];
-
-                                               stats.totalTested += 1u;
-
-                                               const bool prevVisible = visibility.visible;
-                                               visibility.wasVisibleLastFrame = prevVisible;
-
-                                               const bool nowVisible = frustum.testSphere(bounds.worldCenter, bounds.worldRadius);
-                                               visibility.visible = nowVisible;
-                                               visibility.lastTestFrame = m_frameCounter;
-
-                                               if (nowVisible)
-                                               {
-                                                   visibility.visibleFrame = m_frameCounter;
-                                                   stats.visibleNow += 1u;
-                                                   if (!prevVisible)
-                                                       stats.becameVisible += 1u;
-                                               }
-                                               else if (prevVisible)
-                                               {
-                                                   stats.becameInvisible += 1u;
-                                               }
-
-                                               if (nowVisible != prevVisible)
-                                               {
-                                                   RowRef rr;
-                                                   rr.archetypeId = chunk.archetypeId;
-                                                   rr.row = row;
-                                                   changed.push_back(rr);
-                                               }
-                                           }
-                                       });
+            const uint32_t rowsPerChunk = std::max(1u, totalRows / chunkCount);
+            const uint32_t grain = ecs.jobSystem->autoGrain(chunkCount, rowsPerChunk * PARALLEL_ROW_COST_NS);
+            ecs.jobSystem->parallelForRange(0u, chunkCount, grain, [&](uint32_t workerIndex, uint32_t first, uint32_t last)
+                                            {
+                const uint32_t scratchIdx = std::min<uint32_t>(workerIndex, scratchCount - 1u);
+                for (uint32_t i = first; i < last; ++i)
+                    cullItem(m_chunks[i], m_workerStats[scratchIdx], &m_workerChanged[scratchIdx]); });
 
             // Reduce stats and apply dirties on the main thread.
-            m_lastStats = Stats{};
             for (uint32_t i = 0u; i < scratchCount; ++i)
             {
-                m_lastStats.totalTested += m_workerStats[i].totalTested;
-                m_lastStats.visibleNow += m_workerStats[i].visibleNow;
-                m_lastStats.becameVisible += m_workerStats[i].becameVisible;
-                m_lastStats.becameInvisible += m_workerStats[i].becameInvisible;
-
+                m_lastStats += m_workerStats[i];
                 for (const RowRef &rr : m_workerChanged[i])
-                {
                     ecs.markDirty(m_visibilityStateId, rr.archetypeId, rr.row);
-                }
             }
         }
         else
         {
-            // Sequential fallback (existing behavior)
-            for (uint32_t archetypeId : q.matchingArchetypeIds)
-            {
-                auto *ptr = ecs.stores.get(archetypeId);
-                if (!ptr)
-                    continue;
-
-                auto &store = *ptr;
-                if (!store.signature().containsAll(required()))
-                    continue;
-                if (!store.signature().containsNone(excluded()))
-                    continue;
-                if (!store.hasRenderBounds() || !store.hasVisibilityState())
-                    continue;
-
-                auto &renderBounds = store.renderBounds();
-                auto &visibilityStates = store.visibilityState();
-                const uint32_t n = store.size();
-
-                for (uint32_t row = 0; row < n; ++row)
-                {
-                    auto &visibility = visibilityStates[row];
-                    const auto &bounds = renderBounds[row];
-
-                    m_lastStats.totalTested += 1u;
-
-                    // Store previous visibility for transition detection
-                    const bool prevVisible = visibility.visible;
-                    visibility.wasVisibleLastFrame = prevVisible;
-
-                    // Test sphere against frustum
-                    visibility.visible = frustum.testSphere(bounds.worldCenter, bounds.worldRadius);
-
-                    // Track when visibility changes
-                    visibility.lastTestFrame = m_frameCounter;
-
-                    if (visibility.visible)
-                    {
-                        visibility.visibleFrame = m_frameCounter;
-                        m_lastStats.visibleNow += 1u;
-                        if (!prevVisible)
-                            m_lastStats.becameVisible += 1u;
-                    }
-                    else if (prevVisible)
-                    {
-                        m_lastStats.becameInvisible += 1u;
-                    }
+            for (const ChunkItem &item : m_chunks)
+                cullItem(item, m_lastStats, nullptr);
+        }
 
-                    if (visibility.visible != prevVisible)
-                    {
-                        ecs.markDirty(m_visibilityStateId, archetypeId, row);
-                    }
-                }
-            }
+        for (uint32_t archetypeId : q.matchingArchetypeIds)
+        {
+            if (auto *store = ecs.stores.get(archetypeId))
+                store->setVisibilityTestFrame(m_frameCounter);
         }
 
 #if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
         if ((m_frameCounter % 120u) == 0u)
         {
             std::cout << "[VisibilityCullingSystem] frame=" << m_frameCounter
+                      << " chunks=" << m_lastStats.chunks
+                      << " rejected=" << m_lastStats.chunksRejected
+                      << " accepted=" << m_lastStats.chunksAccepted
                       << " tested=" << m_lastStats.totalTested
                       << " visible=" << m_lastStats.visibleNow
                       << " becameVisible=" << m_lastStats.becameVisible
                       << " becameInvisible=" << m_lastStats.becameInvisible
+                      << " occluded=" << m_lastStats.occluded
                       << "\n";
         }
 #endif
@@ -261,13 +341,6 @@ public:
     uint32_t getFrameCounter() const { return m_frameCounter; }
 
 private:
-    struct Chunk
-    {
-        uint32_t archetypeId = UINT32_MAX;
-        uint32_t startRow = 0;
-        uint32_t endRow = 0;
-    };
-
     struct RowRef
     {
         uint32_t archetypeId = UINT32_MAX;
@@ -276,19 +349,68 @@ private:
 
     struct Stats
     {
-        uint32_t totalTested = 0;
+        uint32_t totalTested = 0; // rows whose own sphere was tested (straddling chunks)
         uint32_t visibleNow = 0;
         uint32_t becameVisible = 0;
         uint32_t becameInvisible = 0;
+        uint32_t occluded = 0; // frustum-visible but hidden by Hi-Z
+        uint32_t chunks = 0;
+        uint32_t chunksRejected = 0; // box outside the frustum: rows hidden without a test
+        uint32_t chunksAccepted = 0; // box inside the frustum: rows shown without a test
+        uint32_t boxesRebuilt = 0;
+
+        Stats &operator+=(const Stats &o)
+        {
+            totalTested += o.totalTested;
+            visibleNow += o.visibleNow;
+            becameVisible += o.becameVisible;
+            becameInvisible += o.becameInvisible;
+            occluded += o.occluded;
+            chunks += o.chunks;
+            chunksRejected += o.chunksRejected;
+            chunksAccepted += o.chunksAccepted;
+            boxesRebuilt += o.boxesRebuilt;
+            return *this;
+        }
+    };
+
+    // Chunks [chunk, chunkEnd) of one store; starts on a visibility word.
+    struct ChunkItem
+    {
+        uint32_t archetypeId;
+        uint32_t chunk;
+        uint32_t chunkEnd;
+        uint32_t firstRow;
+        uint32_t rows;
+    };
+
+    // Box around the world spheres of one chunk's rows.
+    struct ChunkBounds
+    {
+        glm::vec3 mn{0.0f};
+        glm::vec3 mx{0.0f};
+        uint32_t rows = 0;
+        bool valid = false;
+    };
+
+    struct StoreBounds
+    {
+        uint32_t structuralVersion = UINT32_MAX;
+        std::vector<ChunkBounds> chunks;
     };
 
     Engine::Camera *m_camera = nullptr;
+    bool m_gpuCulling = false;
+    const Engine::HiZOcclusion *m_occlusion = nullptr;
     Engine::ECS::QueryId m_queryId = Engine::ECS::QueryManager::InvalidQuery;
     uint32_t m_visibilityStateId = Engine::ECS::ComponentRegistry::InvalidID;
+    uint32_t m_worldBoundsId = Engine::ECS::ComponentRegistry::InvalidID;
     uint32_t m_frameCounter = 0;
+    uint32_t m_lastVersion = 0; // ecs.changeVersion() at the previous update
     Stats m_lastStats{};
 
-    std::vector<Chunk> m_chunks;
+    std::vector<ChunkItem> m_chunks;           // this frame's work items
+    std::vector<StoreBounds> m_storeBounds;    // by archetype id
     std::vector<Stats> m_workerStats;
     std::vector<std::vector<RowRef>> m_workerChanged;
 };
@@ -1,15 +1,23 @@
 #pragma once
 
 #include "ECS/SystemFormat.h"
+#include "ECS/StoreRowSpans.h"
 #include "ECS/VisibleRender.h"
+#include "utils/FrameArena.h"
 #include "utils/JobSystem.h"
 
-#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
+#include "assets/AssetManager.h"
+#include "Engine/Camera.h"
+
 #include <algorithm>
+
+#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
 #include <iostream>
 #endif
 
-#include <unordered_map>
+#include <cmath>
+#include <limits>
+#include <vector>
 
 class VisibleRenderGatherSystem : public Engine::ECS::SystemBase
 {
@@ -20,13 +28,22 @@ public:
     // Parallelize when total renderables across matching stores exceeds this threshold.
     static constexpr uint32_t PARALLEL_TOTAL_ROW_THRESHOLD = 40;
 
-    // Chunk size (rows per task) for parallel gather.
-    static constexpr uint32_t PARALLEL_CHUNK_SIZE = 40;
+    // Rough cost of gathering one row (ns); the job system derives the rows per task from it.
+    static constexpr uint32_t PARALLEL_ROW_COST_NS = 40;
+
+    // Scales projected size before the LOD thresholds are applied (>1 keeps detail longer).
+    static constexpr float LOD_BIAS_DEFAULT = 1.0f;
+
+    // Depth sort: buckets with fewer refs keep gather order; keys are quantized to 16 bits over
+    // the bucket's own depth range (two 8-bit radix passes).
+    static constexpr uint32_t DEPTH_SORT_MIN_REFS = 16;
 
     VisibleRenderGatherSystem()
     {
         setRequiredNames({"RenderModel", "RenderTransform", "PosePalette", "VisibilityState"});
         setExcludedNames({"Disabled", "Dead"});
+        setReadNames({"RenderModel", "RenderTransform", "PosePalette", "VisibilityState", "WorldBounds"});
+        setWriteNames({"VisibleRenderBuckets"});
     }
 
     const char *name() const override { return "VisibleRenderGatherSystem"; }
@@ -37,6 +54,18 @@ public:
         m_queryId = Engine::ECS::QueryManager::InvalidQuery;
     }
 
+    // Mesh LODs: with a camera and assets set, rows with WorldBounds are bucketed by
+    // (model, level) from their projected radius against the model's cooked thresholds.
+    // Without either, every row stays at level 0.
+    void setCamera(const Engine::Camera *camera) { m_camera = camera; }
+    void setAssetManager(Engine::AssetManager *assets) { m_assets = assets; }
+    void setLodBias(float bias) { m_lodBias = std::max(bias, 0.0f); }
+    // Optional (needs a camera): refs of each bucket ordered by view depth, front to back for
+    // opaque models (early-Z rejects the hidden rows of a formation) and back to front for
+    // blended ones. Draws follow the order wherever the pass keeps its active-slot order.
+    void setDepthSort(bool enabled) { m_depthSort = enabled; }
+    bool depthSort() const { return m_depthSort; }
+
     const Engine::ECS::VisibleRenderBuckets &buckets() const { return m_buckets; }
     Engine::ECS::VisibleRenderBuckets &bucketsMut() { return m_buckets; }
 
@@ -50,17 +79,60 @@ public:
         m_buckets.frame = m_frameCounter;
         m_buckets.totalRenderables = 0;
         m_buckets.visibleRenderables = 0;
-        m_buckets.activeModelKeys.clear();
+        m_buckets.activeBuckets.clear();
 
         auto keyFromHandle = [](const Engine::ModelHandle &h) -> uint64_t
         {
             return (static_cast<uint64_t>(h.generation) << 32) | static_cast<uint64_t>(h.id);
         };
 
+        // Projected size = radius / (distance * tan(fovY / 2)), i.e. fraction of half the viewport height.
+        const bool lodEnabled = (m_camera != nullptr && m_assets != nullptr);
+        const glm::vec3 camPos = lodEnabled ? m_camera->GetPosition() : glm::vec3(0.0f);
+        const float invTanHalfFov = lodEnabled ? m_lodBias / std::max(std::tan(m_camera->GetFOV() * 0.5f), 1e-4f) : 0.0f;
+
+        const bool sortByDepth = (m_depthSort && m_camera != nullptr);
+        const glm::vec3 viewPos = m_camera ? m_camera->GetPosition() : glm::vec3(0.0f);
+        const glm::vec3 viewDir = m_camera ? m_camera->GetForward() : glm::vec3(0.0f, 0.0f, -1.0f);
+        auto viewDepthOf = [&](const Engine::ECS::WorldBounds *bounds, const glm::mat4 &world) -> float
+        {
+            const glm::vec3 center = bounds ? bounds->center : glm::vec3(world[3]);
+            return glm::dot(center - viewPos, viewDir);
+        };
+
+        // Per-caller cache: rows of one model are usually contiguous in a store.
+        struct LodCache
+        {
+            uint64_t key = UINT64_MAX;
+            const Engine::ModelAsset *asset = nullptr;
+        };
+        // outSize: the projected size (FLT_MAX when unknown or the camera is inside the bounds).
+        auto selectLod = [&](LodCache &cache, const Engine::ModelHandle &h, uint64_t key,
+                             const Engine::ECS::WorldBounds *bounds, float &outSize) -> uint32_t
+        {
+            outSize = std::numeric_limits<float>::max();
+            if (!lodEnabled || !bounds)
+                return 0u;
+
+            const float dist = glm::length(bounds->center - camPos);
+            if (dist <= bounds->radius)
+                return 0u;
+            outSize = bounds->radius * invTanHalfFov / dist;
+
+            if (cache.key != key)
+            {
+                cache.key = key;
+                cache.asset = m_assets->getModel(h);
+            }
+            if (!cache.asset || cache.asset->lodScreenSizes.empty())
+                return 0u;
+            return cache.asset->selectLod(outSize);
+        };
+
         const auto &q = ecs.queries.get(m_queryId);
 
-        // Build chunk list and total row count.
-        m_chunks.clear();
+        // One span per matching store, laid out back to back in a flat row range.
+        m_spans.clear();
         uint32_t totalRows = 0;
         for (uint32_t archetypeId : q.matchingArchetypeIds)
         {
@@ -80,30 +152,31 @@ public:
             if (n == 0u)
                 continue;
 
+            m_spans.add(archetypeId, n);
             totalRows += n;
+        }
 
-            if (PARALLEL_CHUNK_SIZE == 0u)
-            {
-                Chunk c;
-                c.archetypeId = archetypeId;
-                c.startRow = 0u;
-                c.endRow = n;
-                m_chunks.push_back(c);
-            }
-            else
+        const bool canParallel = (ecs.jobSystem && totalRows >= PARALLEL_TOTAL_ROW_THRESHOLD && !m_spans.empty());
+
+        // Starts bucket idx for this frame (first ref seen decides handle and level).
+        auto activate = [&](uint32_t idx, const Engine::ECS::VisibleRenderRef &first) -> Engine::ECS::VisibleModelBucket &
+        {
+            if (idx >= m_buckets.byModel.size())
+                m_buckets.byModel.resize(static_cast<size_t>(idx) + 1u);
+            Engine::ECS::VisibleModelBucket &bucket = m_buckets.byModel[idx];
+            if (bucket.lastUsedFrame != m_frameCounter)
             {
-                for (uint32_t start = 0u; start < n; start += PARALLEL_CHUNK_SIZE)
-                {
-                    Chunk c;
-                    c.archetypeId = archetypeId;
-                    c.startRow = start;
-                    c.endRow = std::min<uint32_t>(n, start + PARALLEL_CHUNK_SIZE);
-                    m_chunks.push_back(c);
-                }
+                bucket.lastUsedFrame = m_frameCounter;
+                bucket.handle = first.model;
+                bucket.modelKey = first.modelKey;
+                bucket.lod = first.lod;
+                bucket.maxScreenSize = 0.0f;
+                bucket.blend = false;
+                bucket.refs.clear();
+                m_buckets.activeBuckets.push_back(idx);
             }
-        }
-
-        const bool canParallel = (ecs.jobSystem && totalRows >= PARALLEL_TOTAL_ROW_THRESHOLD && !m_chunks.empty());
+            return bucket;
+        };
 
         if (canParallel)
         {
@@ -113,92 +186,101 @@ public:
             for (uint32_t i = 0u; i < scratchCount; ++i)
                 m_workerScratch[i].clearFrame();
 
-            ecs.jobSystem->parallelFor(static_cast<uint32_t>(m_chunks.size()), [&](uint32_t workerIndex, uint32_t chunkIndex)
+            // Each lane appends refs in row order plus the bucket of each; counts are per bucket.
+            const uint32_t grain = ecs.jobSystem->autoGrain(totalRows, PARALLEL_ROW_COST_NS);
+            ecs.jobSystem->parallelForRange(0u, totalRows, grain, [&](uint32_t workerIndex, uint32_t first, uint32_t last)
+                                            {
+                const uint32_t scratchIdx = std::min<uint32_t>(workerIndex, scratchCount - 1u);
+                WorkerScratch &scratch = m_workerScratch[scratchIdx];
+
+                m_spans.forEachInRange(first, last, [&](const Engine::ECS::StoreRowSpan &span, uint32_t start, uint32_t end)
                                        {
-                                           const uint32_t scratchIdx = std::min<uint32_t>(workerIndex, scratchCount - 1u);
-                                           WorkerScratch &scratch = m_workerScratch[scratchIdx];
-
-                                           const Chunk &chunk = m_chunks[chunkIndex];
-                                           auto *ptr = ecs.stores.get(chunk.archetypeId);
-                                           if (!ptr)
-                                               return;
-                                           auto &store = *ptr;
-                                           if (!store.hasRenderModel() || !store.hasRenderTransform() || !store.hasPosePalette() || !store.hasVisibilityState())
-                                               return;
-
-                                           const auto &entities = store.entities();
-                                           const auto &renderModels = store.renderModels();
-                                           const auto &renderTransforms = store.renderTransforms();
-                                           const auto &posePalettes = store.posePalettes();
-                                           const auto &visibilityStates = store.visibilityState();
-
-                                           const uint32_t n = store.size();
-                                           const uint32_t start = std::min(chunk.startRow, n);
-                                           const uint32_t end = std::min(chunk.endRow, n);
-
-                                           for (uint32_t row = start; row < end; ++row)
-                                           {
-                                               if (!visibilityStates[row].visible)
-                                                   continue;
-
-                                               const Engine::ModelHandle handle = renderModels[row].handle;
-                                               const uint64_t key = keyFromHandle(handle);
-
-                                               auto &bucket = scratch.byModel[key];
-                                               if (bucket.refs.empty())
-                                               {
-                                                   bucket.handle = handle;
-                                                   scratch.activeModelKeys.push_back(key);
-                                               }
-
-                                               Engine::ECS::VisibleRenderRef ref{};
-                                               ref.entity = entities[row];
-                                               ref.archetypeId = chunk.archetypeId;
-                                               ref.row = row;
-                                               ref.model = handle;
-                                               ref.modelKey = key;
-                                               ref.transformVersion = renderTransforms[row].transformVersion;
-                                               ref.poseVersion = posePalettes[row].poseVersion;
-                                               ref.visibleFrame = visibilityStates[row].visibleFrame;
-                                               ref.justBecameVisible = !visibilityStates[row].wasVisibleLastFrame;
-
-                                               bucket.refs.emplace_back(ref);
-                                               scratch.visibleRenderables += 1u;
-                                           }
-                                       });
-
-            // Serial merge into shared buckets.
+                    auto *ptr = ecs.stores.get(span.archetypeId);
+                    if (!ptr)
+                        return;
+                    auto &store = *ptr;
+
+                    const auto &entities = store.entities();
+                    const auto &renderModels = store.renderModels();
+                    const auto &renderTransforms = store.renderTransforms();
+                    const auto &posePalettes = store.posePalettes();
+                    const uint32_t visibleFrame = store.visibilityTestFrame();
+                    const auto bounds = store.worldBounds(); // empty when absent
+                    LodCache lodCache;
+
+                    store.forEachVisibleRow(start, end, [&](uint32_t row)
+                    {
+                        const Engine::ModelHandle handle = renderModels[row].handle;
+                        const uint64_t modelKey = keyFromHandle(handle);
+                        float screenSize = 0.0f;
+                        const uint32_t lod = selectLod(lodCache, handle, modelKey, !bounds.empty() ? &bounds[row] : nullptr, screenSize);
+                        const uint32_t idx = Engine::ECS::VisibleBucketIndex(handle, lod);
+
+                        if (idx >= scratch.counts.size())
+                        {
+                            scratch.counts.resize(static_cast<size_t>(idx) + 1u, 0u);
+                            scratch.maxSize.resize(static_cast<size_t>(idx) + 1u, 0.0f);
+                        }
+                        if (scratch.counts[idx]++ == 0u)
+                        {
+                            scratch.touched.push_back(Touched{idx, static_cast<uint32_t>(scratch.refs.size())});
+                            scratch.maxSize[idx] = screenSize;
+                        }
+                        else
+                        {
+                            scratch.maxSize[idx] = std::max(scratch.maxSize[idx], screenSize);
+                        }
+
+                        Engine::ECS::VisibleRenderRef ref{};
+                        ref.entity = entities[row];
+                        ref.archetypeId = span.archetypeId;
+                        ref.row = row;
+                        ref.model = handle;
+                        ref.modelKey = modelKey;
+                        ref.lod = lod;
+                        ref.transformVersion = renderTransforms[row].transformVersion;
+                        ref.poseVersion = posePalettes[row].poseVersion;
+                        ref.visibleFrame = visibleFrame;
+                        ref.justBecameVisible = !store.rowWasVisible(row);
+                        if (sortByDepth)
+                            ref.viewDepth = viewDepthOf(!bounds.empty() ? &bounds[row] : nullptr, renderTransforms[row].world);
+
+                        scratch.refs.emplace_back(ref);
+                        scratch.bucketOf.push_back(idx);
+                    }); }); });
+
+            // Prefix sums: size every bucket once and turn each lane's counts into its
+            // write offset inside the bucket (lanes land back to back, in lane order).
             m_buckets.totalRenderables = totalRows;
             m_buckets.visibleRenderables = 0u;
-            m_buckets.activeModelKeys.clear();
-
             for (uint32_t i = 0u; i < scratchCount; ++i)
             {
                 WorkerScratch &scratch = m_workerScratch[i];
-                m_buckets.visibleRenderables += scratch.visibleRenderables;
-
-                for (uint64_t key : scratch.activeModelKeys)
+                m_buckets.visibleRenderables += static_cast<uint32_t>(scratch.refs.size());
+                for (const Touched &t : scratch.touched)
                 {
-                    auto it = scratch.byModel.find(key);
-                    if (it == scratch.byModel.end())
-                        continue;
-
-                    WorkerBucket &localBucket = it->second;
+                    Engine::ECS::VisibleModelBucket &bucket = activate(t.bucket, scratch.refs[t.firstRef]);
+                    bucket.maxScreenSize = std::max(bucket.maxScreenSize, scratch.maxSize[t.bucket]);
+                    const uint32_t offset = static_cast<uint32_t>(bucket.refs.size());
+                    bucket.refs.resize(static_cast<size_t>(offset) + scratch.counts[t.bucket]);
+                    scratch.counts[t.bucket] = offset;
+                }
+            }
 
-                    auto &bucket = m_buckets.byModel[key];
-                    if (bucket.lastUsedFrame != m_frameCounter)
+            // Scatter: lanes write disjoint ranges of the sized buckets.
+            std::vector<Engine::ECS::VisibleModelBucket> &byModel = m_buckets.byModel;
+            ecs.jobSystem->parallelForRange(0u, scratchCount, 1u, [&](uint32_t, uint32_t first, uint32_t last)
+                                            {
+                for (uint32_t i = first; i < last; ++i)
+                {
+                    WorkerScratch &scratch = m_workerScratch[i];
+                    const size_t n = scratch.refs.size();
+                    for (size_t k = 0; k < n; ++k)
                     {
-                        bucket.lastUsedFrame = m_frameCounter;
-                        bucket.handle = localBucket.handle;
-                        bucket.refs.clear();
-                        m_buckets.activeModelKeys.push_back(key);
+                        const uint32_t idx = scratch.bucketOf[k];
+                        byModel[idx].refs[scratch.counts[idx]++] = scratch.refs[k];
                     }
-
-                    bucket.refs.insert(bucket.refs.end(),
-                                      std::make_move_iterator(localBucket.refs.begin()),
-                                      std::make_move_iterator(localBucket.refs.end()));
-                }
-            }
+                } });
         }
         else
         {
@@ -221,64 +303,62 @@ public:
                 const auto &renderModels = store.renderModels();
                 const auto &renderTransforms = store.renderTransforms();
                 const auto &posePalettes = store.posePalettes();
-                const auto &visibilityStates = store.visibilityState();
+                const uint32_t visibleFrame = store.visibilityTestFrame();
+                const auto bounds = store.worldBounds(); // empty when absent
                 const uint32_t n = store.size();
+                LodCache lodCache;
 
                 m_buckets.totalRenderables += n;
 
-                for (uint32_t row = 0; row < n; ++row)
+                store.forEachVisibleRow(0u, n, [&](uint32_t row)
                 {
-                    if (!visibilityStates[row].visible)
-                        continue;
-
                     const Engine::ModelHandle handle = renderModels[row].handle;
-                    const uint64_t key = keyFromHandle(handle);
-
-                    auto &bucket = m_buckets.byModel[key];
-                    if (bucket.lastUsedFrame != m_frameCounter)
-                    {
-                        bucket.lastUsedFrame = m_frameCounter;
-                        bucket.handle = handle;
-                        bucket.refs.clear();
-                        m_buckets.activeModelKeys.push_back(key);
-                    }
+                    const uint64_t modelKey = keyFromHandle(handle);
+                    float screenSize = 0.0f;
+                    const uint32_t lod = selectLod(lodCache, handle, modelKey, !bounds.empty() ? &bounds[row] : nullptr, screenSize);
 
                     Engine::ECS::VisibleRenderRef ref{};
                     ref.entity = entities[row];
                     ref.archetypeId = archetypeId;
                     ref.row = row;
                     ref.model = handle;
-                    ref.modelKey = key;
+                    ref.modelKey = modelKey;
+                    ref.lod = lod;
                     ref.transformVersion = renderTransforms[row].transformVersion;
                     ref.poseVersion = posePalettes[row].poseVersion;
-                    ref.visibleFrame = visibilityStates[row].visibleFrame;
-                    ref.justBecameVisible = !visibilityStates[row].wasVisibleLastFrame;
+                    ref.visibleFrame = visibleFrame;
+                    ref.justBecameVisible = !store.rowWasVisible(row);
+                    if (sortByDepth)
+                        ref.viewDepth = viewDepthOf(!bounds.empty() ? &bounds[row] : nullptr, renderTransforms[row].world);
 
+                    Engine::ECS::VisibleModelBucket &bucket = activate(Engine::ECS::VisibleBucketIndex(handle, lod), ref);
+                    bucket.maxScreenSize = std::max(bucket.maxScreenSize, screenSize);
                     bucket.refs.emplace_back(ref);
                     m_buckets.visibleRenderables += 1u;
-                }
+                });
             }
         }
 
+        // Consumers walk passes in bucket order, independent of which lane saw a model first.
+        std::sort(m_buckets.activeBuckets.begin(), m_buckets.activeBuckets.end());
+
+        if (sortByDepth)
+            sortBucketsByDepth(ecs);
+
 #if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
         if ((m_frameCounter % 120u) == 0u)
         {
             std::cout << "[VisibleRenderGatherSystem] frame=" << m_frameCounter
                       << " totalRenderables=" << m_buckets.totalRenderables
                       << " visibleRenderables=" << m_buckets.visibleRenderables
-                      << " visibleModels=" << static_cast<uint32_t>(m_buckets.activeModelKeys.size())
+                      << " visibleModels=" << static_cast<uint32_t>(m_buckets.activeBuckets.size())
                       << "\n";
 
             // Print a small "visible per model" summary (top-N by instance count).
-            std::vector<std::pair<uint32_t, uint64_t>> counts;
-            counts.reserve(m_buckets.activeModelKeys.size());
-            for (uint64_t key : m_buckets.activeModelKeys)
-            {
-                auto it = m_buckets.byModel.find(key);
-                if (it == m_buckets.byModel.end())
-                    continue;
-                counts.emplace_back(static_cast<uint32_t>(it->second.refs.size()), key);
-            }
+            Engine::FrameVector<std::pair<uint32_t, uint32_t>> counts;
+            counts.reserve(m_buckets.activeBuckets.size());
+            for (uint32_t idx : m_buckets.activeBuckets)
+                counts.emplace_back(static_cast<uint32_t>(m_buckets.byModel[idx].refs.size()), idx);
 
             std::sort(counts.begin(), counts.end(), [](const auto &a, const auto &b)
                       { return a.first > b.first; });
@@ -289,11 +369,9 @@ public:
                 std::cout << "[VisibleRenderGatherSystem] topVisibleModels=";
                 for (uint32_t i = 0; i < topN; ++i)
                 {
-                    auto it = m_buckets.byModel.find(counts[i].second);
-                    if (it == m_buckets.byModel.end())
-                        continue;
-                    const auto &h = it->second.handle;
-                    std::cout << " (" << h.id << ":" << h.generation << "," << counts[i].first << ")";
+                    const Engine::ECS::VisibleModelBucket &bucket = m_buckets.byModel[counts[i].second];
+                    const auto &h = bucket.handle;
+                    std::cout << " (" << h.id << ":" << h.generation << " lod" << bucket.lod << "," << counts[i].first << ")";
                 }
                 std::cout << "\n";
             }
@@ -302,30 +380,126 @@ public:
     }
 
 private:
-    struct Chunk
+    // Per active bucket: LSD radix sort of the refs on their 16-bit quantized depth, buckets
+    // spread over the workers (each worker sorts whole buckets with its own scratch).
+    void sortBucketsByDepth(Engine::ECS::ECSContext &ecs)
     {
-        uint32_t archetypeId = UINT32_MAX;
-        uint32_t startRow = 0u;
-        uint32_t endRow = 0u;
-    };
+        const uint32_t scratchCount = ecs.jobSystem ? (ecs.jobSystem->workerCount() + 1u) : 1u;
+        if (m_workerScratch.size() < scratchCount)
+            m_workerScratch.resize(scratchCount);
+
+        auto sortBucket = [&](WorkerScratch &scratch, Engine::ECS::VisibleModelBucket &bucket)
+        {
+            bucket.blend = modelBlends(bucket.handle);
+            std::vector<Engine::ECS::VisibleRenderRef> &refs = bucket.refs;
+            const uint32_t n = static_cast<uint32_t>(refs.size());
+            if (n < DEPTH_SORT_MIN_REFS)
+                return;
+
+            float minDepth = refs[0].viewDepth, maxDepth = refs[0].viewDepth;
+            for (const Engine::ECS::VisibleRenderRef &ref : refs)
+            {
+                minDepth = std::min(minDepth, ref.viewDepth);
+                maxDepth = std::max(maxDepth, ref.viewDepth);
+            }
+            if (!(maxDepth > minDepth))
+                return;
+
+            const float scale = 65535.0f / (maxDepth - minDepth);
+            scratch.sortKeys.resize(n);
+            scratch.sortKeysTmp.resize(n);
+            scratch.sortRefs.resize(n);
+            for (uint32_t i = 0; i < n; ++i)
+            {
+                const uint32_t key = static_cast<uint32_t>((refs[i].viewDepth - minDepth) * scale);
+                scratch.sortKeys[i] = static_cast<uint16_t>(bucket.blend ? 65535u - key : key);
+            }
+
+            // Two stable passes (low byte, then high byte); the second lands back in refs.
+            auto pass = [n](const uint16_t *keysIn, const Engine::ECS::VisibleRenderRef *in, uint16_t *keysOut,
+                            Engine::ECS::VisibleRenderRef *out, uint32_t shift)
+            {
+                uint32_t offsets[256] = {};
+                for (uint32_t i = 0; i < n; ++i)
+                    ++offsets[(keysIn[i] >> shift) & 0xFFu];
+                uint32_t sum = 0;
+                for (uint32_t &o : offsets)
+                {
+                    const uint32_t c = o;
+                    o = sum;
+                    sum += c;
+                }
+                for (uint32_t i = 0; i < n; ++i)
+                {
+                    const uint32_t at = offsets[(keysIn[i] >> shift) & 0xFFu]++;
+                    keysOut[at] = keysIn[i];
+                    out[at] = in[i];
+                }
+            };
+            pass(scratch.sortKeys.data(), refs.data(), scratch.sortKeysTmp.data(), scratch.sortRefs.data(), 0u);
+            pass(scratch.sortKeysTmp.data(), scratch.sortRefs.data(), scratch.sortKeys.data(), refs.data(), 8u);
+        };
+
+        std::vector<Engine::ECS::VisibleModelBucket> &byModel = m_buckets.byModel;
+        const std::vector<uint32_t> &active = m_buckets.activeBuckets;
+        if (ecs.jobSystem && active.size() > 1u)
+        {
+            ecs.jobSystem->parallelForRange(0u, static_cast<uint32_t>(active.size()), 1u, [&](uint32_t workerIndex, uint32_t first, uint32_t last)
+                                            {
+                WorkerScratch &scratch = m_workerScratch[std::min<uint32_t>(workerIndex, scratchCount - 1u)];
+                for (uint32_t i = first; i < last; ++i)
+                    sortBucket(scratch, byModel[active[i]]); });
+        }
+        else
+        {
+            for (uint32_t idx : active)
+                sortBucket(m_workerScratch[0], byModel[idx]);
+        }
+    }
 
-    struct WorkerBucket
+    // True when any primitive of the model is alpha blended (needs the assets; false without).
+    bool modelBlends(const Engine::ModelHandle &handle) const
     {
-        Engine::ModelHandle handle{};
-        std::vector<Engine::ECS::VisibleRenderRef> refs;
+        const Engine::ModelAsset *asset = m_assets ? m_assets->getModel(handle) : nullptr;
+        if (!asset)
+            return false;
+        for (const Engine::ModelPrimitive &prim : asset->primitives)
+        {
+            const Engine::MaterialAsset *mat = m_assets->getMaterial(prim.material);
+            if (mat && mat->alphaMode == 2u)
+                return true;
+        }
+        return false;
+    }
+
+    struct Touched
+    {
+        uint32_t bucket;   // VisibleBucketIndex
+        uint32_t firstRef; // index in refs of the lane's first ref for the bucket
     };
 
+    // Lane output of the parallel gather. counts is indexed by bucket and zero outside
+    // touched; the merge reuses it for write offsets. Everything keeps its capacity.
     struct WorkerScratch
     {
-        uint32_t visibleRenderables = 0u;
-        std::unordered_map<uint64_t, WorkerBucket> byModel;
-        std::vector<uint64_t> activeModelKeys;
+        std::vector<Engine::ECS::VisibleRenderRef> refs;
+        std::vector<uint32_t> bucketOf; // parallel to refs
+        std::vector<uint32_t> counts;
+        std::vector<float> maxSize; // by bucket, valid where counts is non-zero
+        std::vector<Touched> touched;
+
+        // Depth sort scratch (one bucket at a time).
+        std::vector<uint16_t> sortKeys;
+        std::vector<uint16_t> sortKeysTmp;
+        std::vector<Engine::ECS::VisibleRenderRef> sortRefs;
 
         void clearFrame()
         {
-            visibleRenderables = 0u;
-            activeModelKeys.clear();
-            byModel.clear();
+            for (const Touched &t : touched)
+                counts[t.bucket] = 0u;
+            touched.clear();
+            refs.clear();
+            bucketOf.clear();
         }
     };
 
@@ -334,6 +508,11 @@ private:
 
     Engine::ECS::VisibleRenderBuckets m_buckets;
 
-    std::vector<Chunk> m_chunks;
+    const Engine::Camera *m_camera = nullptr; // not owned
+    Engine::AssetManager *m_assets = nullptr; // not owned
+    float m_lodBias = LOD_BIAS_DEFAULT;
+    bool m_depthSort = false;
+
+    Engine::ECS::StoreRowSpans m_spans;
     std::vector<WorkerScratch> m_workerScratch;
 };
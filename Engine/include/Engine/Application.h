@@ -2,6 +2,7 @@
 #include <memory>
 #include <functional>
 #include <string>
+#include <vector>
 
 namespace Engine
 {
@@ -9,6 +10,8 @@ namespace Engine
     class VulkanContext;
     class Renderer;
     class ImGuiLayer;
+    class MemoryReport;
+    struct TelemetryConfig;
 
     struct TimeStep
     {
@@ -18,12 +21,20 @@ namespace Engine
     namespace ECS
     {
         struct ECSContext;
+        class SystemScheduler;
     }
 
     class Application
     {
     public:
+        // Disk/CPU-only work started on the JobSystem before the window and Vulkan device are
+        // created (file reads, decoding). Jobs must not touch the Application, renderer or ECS:
+        // they fill state shared with the derived class, which calls WaitForStartupJobs() before
+        // using it.
+        using StartupJob = std::function<void()>;
+
         Application();
+        explicit Application(std::vector<StartupJob> startupJobs);
         virtual ~Application();
 
         // Start main loop (blocks)
@@ -35,6 +46,17 @@ namespace Engine
         // Optional: called after render submission, for UI, etc.
         virtual void OnRender() {}
 
+        // Optional: advance the simulation for the next frame. Called once per frame after OnUpdate/
+        // OnRender have handed this frame's draw data to the render passes. With pipelined simulation
+        // it runs on a worker while drawFrame() records and submits that data, so it must not touch the
+        // renderer, ImGui, the window, the camera or the render-side systems fed by OnUpdate.
+        virtual void OnSimulate(TimeStep) {}
+
+        // Overlap OnSimulate with drawFrame() (needs JobSystem workers). Results are the same either
+        // way: OnSimulate always runs between this frame's draw and the next OnUpdate.
+        void SetPipelinedSimulation(bool enabled);
+        bool IsPipelinedSimulation() const;
+
         virtual void handleWindowEvent(const std::string &name);
 
         // Access to window
@@ -48,6 +70,9 @@ namespace Engine
 
         // Request application quit
         virtual void Close();
+        // Close() from inside a frame (OnUpdate/OnRender): runs when the next frame polls events,
+        // before ImGui or any update work starts.
+        void RequestClose();
 
         // Event callback dispatching (simple)
         using EventCallbackFn = std::function<void(const std::string &eventName)>;
@@ -63,6 +88,19 @@ namespace Engine
         // Toggle performance overlay visibility (no-op if monitor disabled).
         void TogglePerformanceMonitorOverlay();
 
+        // Contribute byte counts to the overlay's Memory section (no-op if monitor disabled).
+        // Called every half second on the main thread between frames.
+        void AddMemoryProvider(std::function<void(MemoryReport &)> provider);
+
+        // Stream performance telemetry (PerformanceMonitor::enableTelemetry). False if the monitor
+        // is disabled or the transport failed. Schedulers need Config::recordTimings.
+        bool EnableTelemetry(const TelemetryConfig &config);
+        void AddTelemetryScheduler(const ECS::SystemScheduler *scheduler, const std::string &label);
+
+    protected:
+        // Blocks until every startup job has finished (the calling thread helps run them).
+        void WaitForStartupJobs();
+
     private:
         struct Impl;
         std::unique_ptr<Impl> m_Impl;
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include "assets/Handles.h"
+#include "assets/TextureAsset.h"
+#include "utils/GpuAllocator.h"
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Engine
+{
+    class AssetManager;
+    class MemoryReport;
+    class VulkanContext;
+
+    // ------------------------------------------------------------
+    // Global bindless material table (VK_EXT_descriptor_indexing).
+    //
+    // - One descriptor set for the whole device: binding 0 is a partially bound, update-after-bind
+    //   array of MAX_TEXTURES combined image samplers, binding 1 an SSBO of GpuMaterial records.
+    //   Passes bind it once as set 1 and select a material with an index in their push constants,
+    //   so draws never rebind per material and can later be merged across models.
+    // - Textures and materials register on first use (materialIndex()) and keep their index for
+    //   the life of the table. New descriptors are written while earlier frames are in flight,
+    //   which update-unused-while-pending allows. Existing entries change only when texture
+    //   residency replaced a view (AssetManager::textureViewEpoch()); that swap waited for the
+    //   GPU, so no pending frame still reads them.
+    // - Index 0 of both tables is the fallback: a 1x1 white texture and a white opaque material.
+    //   A full table hands out the fallback instead of failing.
+    // - Owned by VulkanContext (created only when the device has descriptor indexing).
+    //   materialIndex() is locked: passes record on the job system workers.
+    // ------------------------------------------------------------
+    class BindlessMaterials
+    {
+    public:
+        // =====================
+        // TUNING CONSTANTS
+        // =====================
+        // Both well under the spec minimums for update-after-bind descriptors (500k samplers).
+        static constexpr uint32_t MAX_TEXTURES = 4096;
+        static constexpr uint32_t MAX_MATERIALS = 4096;
+        static constexpr uint32_t FALLBACK_INDEX = 0;
+
+        // std430 layout of one material (smodel_bindless.frag).
+        struct GpuMaterial
+        {
+            float baseColorFactor[4] = {1, 1, 1, 1};
+            float emissiveFactor[4] = {0, 0, 0, 0};
+            float params[4] = {0.5f, 0, 1, 1}; // x=alphaCutoff, y=alphaMode, z=metallic, w=roughness
+            // baseColor, normal, metallicRoughness, occlusion | emissive, unused x3
+            uint32_t textures[8] = {};
+        };
+        static_assert(sizeof(GpuMaterial) == 80, "GpuMaterial must match the shader's std430 layout");
+
+        BindlessMaterials() = default;
+        ~BindlessMaterials() = default;
+
+        BindlessMaterials(const BindlessMaterials &) = delete;
+        BindlessMaterials &operator=(const BindlessMaterials &) = delete;
+
+        bool create(VulkanContext &ctx);
+        void destroy();
+
+        VkDescriptorSetLayout layout() const { return m_layout; }
+        VkDescriptorSet set() const { return m_set; }
+
+        // Index of the material's GpuMaterial record, registering it (and its textures) if new.
+        uint32_t materialIndex(AssetManager &assets, MaterialHandle h);
+
+        uint32_t textureCount() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_textureCount;
+        }
+        uint32_t materialCount() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_materialCount;
+        }
+
+        // Material SSBO, fallback texture and the lookup maps, under category "Render".
+        void reportMemory(MemoryReport &out) const;
+
+    private:
+        uint32_t textureIndex(AssetManager &assets, TextureHandle h);
+        void refreshTextures(AssetManager &assets); // rewrites entries whose view was replaced
+        void writeTexture(uint32_t index, VkImageView view, VkSampler sampler);
+
+        VkDevice m_device = VK_NULL_HANDLE;
+        VkDescriptorSetLayout m_layout = VK_NULL_HANDLE;
+        VkDescriptorPool m_pool = VK_NULL_HANDLE;
+        VkDescriptorSet m_set = VK_NULL_HANDLE;
+
+        VkBuffer m_materialBuffer = VK_NULL_HANDLE;
+        GpuAllocation m_materialMemory;
+        GpuMaterial *m_materialsMapped = nullptr;
+
+        TextureAsset m_fallbackTexture;
+
+        mutable std::mutex m_mutex; // guards the maps, counts and descriptor writes below
+
+        std::unordered_map<uint64_t, uint32_t> m_textureIndex;  // TextureHandle::id -> array index
+        std::unordered_map<uint64_t, uint32_t> m_materialIndex; // MaterialHandle::id -> record
+        std::vector<TextureHandle> m_slotTextures; // array index -> texture
+        std::vector<VkImageView> m_slotViews;      // array index -> view last written
+        uint32_t m_textureEpoch = 0;
+
+        uint32_t m_textureCount = 0;
+        uint32_t m_materialCount = 0;
+        bool m_warnedFull = false;
+    };
+}
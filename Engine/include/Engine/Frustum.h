@@ -1,5 +1,8 @@
 #pragma once
 
+#include "utils/SimdFrustum.h"
+
+#include <cstdint>
 #include <glm/glm.hpp>
 
 namespace Engine
@@ -81,6 +84,13 @@ namespace Engine
                 glm::normalize(glm::vec3(far)),
                 far.w / glm::length(glm::vec3(far))};
 
+            for (int i = 0; i < 6; ++i)
+            {
+                f.packed[i][0] = f.planes[i].normal.x;
+                f.packed[i][1] = f.planes[i].normal.y;
+                f.packed[i][2] = f.planes[i].normal.z;
+                f.packed[i][3] = f.planes[i].distance;
+            }
             return f;
         }
 
@@ -98,6 +108,43 @@ namespace Engine
             return true; // inside all planes
         }
 
+        // testSphere for eight spheres in SoA lanes; bit i of the result is testSphere(c[i], r[i]).
+        // Callers with fewer than eight pad the tail lanes (their bits are ignored).
+        uint32_t testSpheres8(const float cx[8], const float cy[8], const float cz[8], const float r[8]) const
+        {
+            return simd::SpheresInsidePlanes4(packed, cx, cy, cz, r) |
+                   (simd::SpheresInsidePlanes4(packed, cx + 4, cy + 4, cz + 4, r + 4) << 4);
+        }
+
+        enum class Containment
+        {
+            Outside,      // fully behind one plane
+            Intersecting, // straddles at least one plane
+            Inside,       // fully in front of every plane
+        };
+
+        // Classify the box [mn, mx]. A box enclosing several spheres gives every one of them
+        // the same testSphere result when it is Outside or Inside.
+        Containment classifyAABB(const glm::vec3 &mn, const glm::vec3 &mx) const
+        {
+            Containment result = Containment::Inside;
+            for (int i = 0; i < 6; ++i)
+            {
+                const glm::vec3 &n = planes[i].normal;
+                // Corner furthest along the normal, and the one opposite it.
+                const glm::vec3 pos(n.x >= 0.0f ? mx.x : mn.x, n.y >= 0.0f ? mx.y : mn.y, n.z >= 0.0f ? mx.z : mn.z);
+                const glm::vec3 neg(n.x >= 0.0f ? mn.x : mx.x, n.y >= 0.0f ? mn.y : mx.y, n.z >= 0.0f ? mn.z : mx.z);
+                if (planes[i].testPoint(pos) < 0.0f)
+                    return Containment::Outside;
+                if (planes[i].testPoint(neg) < 0.0f)
+                    result = Containment::Intersecting;
+            }
+            return result;
+        }
+
+        // Plane i (0..5: left, right, bottom, top, near, far); used to feed GPU culling.
+        const FrustumPlane &plane(int i) const { return planes[i]; }
+
     private:
         enum class PlaneIndex : int
         {
@@ -110,6 +157,7 @@ namespace Engine
         };
 
         FrustumPlane planes[6];
+        float packed[6][4] = {}; // planes as (nx, ny, nz, d) rows for testSpheres8
     };
 
 } // namespace Engine
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+#include "Engine/HiZPyramid.h"
+
+namespace Engine
+{
+    // ============================================================
+    // HiZOcclusion
+    // ============================================================
+    // CPU Hi-Z occlusion test against the pyramid of an earlier frame.
+    //
+    // The pyramid is built on the GPU (Renderer::setHiZOcclusion, HiZPyramid); compute culls
+    // test against it there. For CPU culling, Renderer::setHiZReadbackCallback hands over the
+    // coarse levels of a completed frame (a few tens of KB) with the view-projection that
+    // rendered it; buildFromReadback() keeps a copy. Spheres are projected with that matrix, so
+    // the test stays conservative while the camera moves; the frustum test still runs on the
+    // current camera first.
+    //
+    // Results lag by one frame (more only when the GPU falls behind); anything newly revealed
+    // shows up one readback later. Queries never go finer than the first level read back.
+    // isOccluded() is const and safe to call from several threads between builds.
+    class HiZOcclusion
+    {
+    public:
+        static constexpr uint32_t MAX_QUERY_TEXELS = HiZPyramid::MAX_QUERY_TEXELS;
+
+        // Copy the pyramid from a readback; drops it when the readback is malformed.
+        void buildFromReadback(const HiZReadback &readback);
+
+        // Forget the pyramid (e.g. after a camera cut or restart).
+        void reset();
+
+        bool ready() const { return m_valid; }
+        uint64_t sourceFrame() const { return m_sourceFrame; }
+
+        // True only when every point of the sphere is behind the stored depth.
+        bool isOccluded(const glm::vec3 &center, float radius) const;
+
+    private:
+        struct Level
+        {
+            uint32_t width = 0;
+            uint32_t height = 0;
+            std::vector<float> depth; // max depth per texel
+        };
+
+        std::vector<Level> m_levels; // [0] = pyramid level m_levelBase
+        uint32_t m_levelBase = 0;
+        uint32_t m_baseWidth = 0; // pyramid level 0, for the texel mapping
+        uint32_t m_baseHeight = 0;
+        glm::mat4 m_viewProj{1.0f};
+        uint64_t m_sourceFrame = 0;
+        bool m_valid = false;
+    };
+}
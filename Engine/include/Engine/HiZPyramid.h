@@ -0,0 +1,147 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+#include "utils/GpuAllocator.h"
+
+namespace Engine
+{
+    class VulkanContext;
+
+    // Layout of the head of the HiZPyramid storage buffer (std430, see shaders/hiz_build.comp). The
+    // depth levels follow it as one float array; levels[i] = (offset into that array, width,
+    // height, 0). Level 0 is the max over BASE_BLOCK x BASE_BLOCK blocks of the rendered area,
+    // every further level the max of 2x2 texels of the one before, down to 1x1.
+    struct HiZPyramidHeader
+    {
+        static constexpr uint32_t MAX_LEVELS = 16;
+
+        glm::mat4 viewProj{1.0f}; // the camera that rendered the source depth
+        uint32_t levelCount = 0;
+        uint32_t valid = 0;
+        uint32_t sourceWidth = 0; // rendered area, framebuffer pixels
+        uint32_t sourceHeight = 0;
+        uint32_t levels[MAX_LEVELS][4] = {};
+    };
+    static_assert(sizeof(HiZPyramidHeader) == 336, "HiZPyramidHeader must match hiz_build.comp");
+
+    // Host copy of a completed frame's pyramid (Renderer::setHiZReadbackCallback): the header and
+    // levels firstLevel..levelCount-1 only, the finest of them at most
+    // HiZPyramid::READBACK_MAX_TEXELS texels.
+    struct HiZReadback
+    {
+        const HiZPyramidHeader *header = nullptr;
+        const float *depth = nullptr; // level firstLevel; level l at depth + levels[l][0] - levels[firstLevel][0]
+        uint32_t firstLevel = 0;
+        uint64_t frameSerial = 0; // Renderer::getFrameSerial() value of the frame that rendered it
+    };
+
+    // ============================================================
+    // HiZPyramid
+    // ============================================================
+    // Max-depth pyramid of the scene depth, built on the GPU after the scene pass (owned by the
+    // Renderer, see Renderer::setHiZOcclusion()).
+    //
+    // One device-local storage buffer holds the header and every level; it is rebuilt in place
+    // each frame, so a pass's compute cull in frame N reads the pyramid (and matrix) of frame
+    // N-1. The build is one dispatch per level; barriers against the previous readers are part
+    // of record().
+    //
+    // The optional readback copies only the coarse end of the pyramid (READBACK_MAX_TEXELS) into
+    // a host buffer per frame slot: tens of KB instead of the full depth buffer.
+    //
+    // With async compute the storage is shared with the compute queue, where culls read it.
+    class HiZPyramid
+    {
+    public:
+        // =====================
+        // TUNING CONSTANTS
+        // =====================
+        static constexpr uint32_t BASE_BLOCK = 4;              // framebuffer pixels per level-0 texel (each axis)
+        static constexpr uint32_t MAX_QUERY_TEXELS = 3;        // queries use the level where they span at most this many texels
+        static constexpr uint32_t READBACK_MAX_TEXELS = 16384; // finest level copied to the host (120x68 at 1080p)
+        static constexpr uint32_t MAX_LEVELS = HiZPyramidHeader::MAX_LEVELS;
+
+        HiZPyramid() = default;
+        ~HiZPyramid();
+        HiZPyramid(const HiZPyramid &) = delete;
+        HiZPyramid &operator=(const HiZPyramid &) = delete;
+
+        // Pipeline, sampler and per-frame sets. False on failure (nothing left created), e.g.
+        // without shaders/hiz_build.comp.spv.
+        bool create(VulkanContext &ctx, uint32_t frameCount);
+        void destroy();
+        bool created() const { return m_pipeline != VK_NULL_HANDLE; }
+
+        // Records the build of frame `frameSerial` from depthView (depth aspect only, in
+        // SHADER_READ_ONLY_OPTIMAL) over `extent`; the matrix is copied from the CameraBlock at
+        // cameraBuffer + cameraOffset. maxExtent sizes the storage (the full swapchain extent).
+        // With readback, the coarse levels are copied to the frame slot's host buffer as well.
+        // Call after the slot's fence was waited on; completedSerial as Renderer::getCompletedFrameSerial().
+        bool record(VkCommandBuffer cmd, uint32_t frameIndex, uint64_t frameSerial, uint64_t completedSerial,
+                    VkImageView depthView, VkExtent2D extent, VkExtent2D maxExtent,
+                    VkBuffer cameraBuffer, uint32_t cameraOffset, bool readback);
+
+        // The pyramid built by an earlier frame than `frameSerial`, or VK_NULL_HANDLE (nothing
+        // built into the current storage yet). Valid for reads recorded in that frame.
+        VkBuffer bufferFor(uint64_t frameSerial) const
+        {
+            return (m_builtSerial != UINT64_MAX && m_builtSerial < frameSerial) ? m_buffer : VK_NULL_HANDLE;
+        }
+
+        // Hands out the copy the slot's last submit recorded (once); false when there is none.
+        // Only after that submit completed.
+        bool takeReadback(uint32_t frameIndex, HiZReadback &out);
+        // Serial of the copy takeReadback() would return, UINT64_MAX when none is pending.
+        uint64_t pendingReadback(uint32_t frameIndex) const;
+
+        // Readback host buffers only (e.g. when nobody consumes them any more); GPU idle.
+        void destroyReadbacks();
+
+    private:
+        struct FrameSlot
+        {
+            VkDescriptorSet set = VK_NULL_HANDLE;
+            VkBuffer readback = VK_NULL_HANDLE;
+            GpuAllocation readbackMemory;
+            VkDeviceSize readbackBytes = 0;
+            uint32_t firstLevel = 0;
+            uint64_t frameSerial = 0;
+            bool pending = false;
+        };
+
+        struct RetiredBuffer
+        {
+            VkBuffer buffer = VK_NULL_HANDLE;
+            GpuAllocation memory;
+            uint64_t retireSerial = 0; // first frame that no longer uses it
+        };
+
+        // Level table for a source extent; returns the float count of all levels.
+        static uint32_t layoutLevels(VkExtent2D extent, HiZPyramidHeader &header);
+        bool ensureStorage(uint32_t floatCount, uint64_t frameSerial);
+        bool ensureReadback(FrameSlot &slot, VkDeviceSize bytes);
+        void releaseRetired(uint64_t completedSerial, bool all);
+
+        VkDevice m_device = VK_NULL_HANDLE;
+        VkPhysicalDevice m_physicalDevice = VK_NULL_HANDLE;
+        // Graphics + compute families with async compute (count 0 = exclusive storage).
+        uint32_t m_queueFamilies[2] = {0, 0};
+        uint32_t m_queueFamilyCount = 0;
+
+        VkDescriptorSetLayout m_setLayout = VK_NULL_HANDLE;
+        VkDescriptorPool m_pool = VK_NULL_HANDLE;
+        VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+        VkPipeline m_pipeline = VK_NULL_HANDLE;
+        VkSampler m_sampler = VK_NULL_HANDLE;
+        std::vector<FrameSlot> m_slots;
+
+        VkBuffer m_buffer = VK_NULL_HANDLE;
+        GpuAllocation m_memory;
+        uint32_t m_capacityFloats = 0; // depth floats m_buffer holds after the header
+        uint64_t m_builtSerial = UINT64_MAX;
+        std::vector<RetiredBuffer> m_retired;
+    };
+}
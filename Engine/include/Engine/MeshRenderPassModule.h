@@ -38,18 +38,16 @@ namespace Engine
         // Initialization
         void createDescriptorLayouts();
         void createDescriptorPool(size_t materialCount);
-        void createCameraUBO();
+        void createCameraSet();
         void createPipelinesForModel(VulkanContext &ctx, VkRenderPass pass);
         void createMaterialDescriptors();
         void createDummyTexture(VulkanContext &ctx);
 
         // Per-frame
-        void updateCameraUBO();
         void drawNode(VkCommandBuffer cmd, size_t primitiveIndex);
 
         // Helpers
         glm::mat4 computeModelMatrix(MeshAsset *mesh);
-        uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
         void cleanupResources();
 
         // Vulkan handles
@@ -68,18 +66,17 @@ namespace Engine
         VkDescriptorSet m_cameraDescriptorSet = VK_NULL_HANDLE;
         std::vector<VkDescriptorSet> m_materialDescriptorSets;
 
-        // Camera UBO
-        VkBuffer m_cameraUBO = VK_NULL_HANDLE;
-        VkDeviceMemory m_cameraUBOMemory = VK_NULL_HANDLE;
-        void *m_cameraUBOMapped = nullptr;
+        // Set 0 binding 0 is the renderer's shared CameraBlock (a dynamic UBO in its upload
+        // ring); the ring buffer it was last written with.
+        VkBuffer m_cameraRingBuffer = VK_NULL_HANDLE;
 
         // Per-material UBOs
         std::vector<VkBuffer> m_materialUBOs;
-        std::vector<VkDeviceMemory> m_materialUBOMemories;
+        std::vector<GpuAllocation> m_materialUBOMemories;
 
         // Dummy texture for missing textures
         VkImage m_dummyImage = VK_NULL_HANDLE;
-        VkDeviceMemory m_dummyImageMemory = VK_NULL_HANDLE;
+        GpuAllocation m_dummyImageMemory;
         VkImageView m_dummyImageView = VK_NULL_HANDLE;
         VkSampler m_dummySampler = VK_NULL_HANDLE;
 
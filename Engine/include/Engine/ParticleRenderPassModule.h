@@ -0,0 +1,212 @@
+#pragma once
+
+#include "Engine/Renderer.h"
+
+#include "Engine/Camera.h"
+#include "Engine/Pipeline.h"
+
+#include "utils/BufferUtils.h"
+#include "utils/MemoryReport.h"
+#include "utils/ParticleSpawnRing.h"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace Engine
+{
+    // ------------------------------------------------------------
+    // GPU particles for combat effects (hits, deaths, dust).
+    //
+    // - Gameplay pushes ParticleSpawn bursts into spawnRing() from any thread; recordPrePass()
+    //   drains it and uploads the bursts with their prefix offsets. No particle exists on the CPU.
+    // - particle_emit.comp expands the bursts into a fixed pool of MAX_PARTICLES, written round
+    //   robin from an emit cursor (a full pool overwrites its oldest particles).
+    // - particle_update.comp ages and integrates every particle that may still be alive and
+    //   appends the living ones to a compacted list, counting them into an indirect draw.
+    // - The Blend phase draws that list as camera-facing quads with additive blending, which is
+    //   order independent: no sort, and depth is tested but not written.
+    // - Nothing is dispatched or drawn once the last particle expired.
+    // ------------------------------------------------------------
+    class ParticleRenderPassModule final : public RenderPassModule
+    {
+    public:
+        // =====================
+        // TUNING CONSTANTS
+        // =====================
+        static constexpr uint32_t MAX_PARTICLES = 65536;       // pool size (power of two)
+        static constexpr uint32_t MAX_BURSTS_PER_FRAME = 2048; // further bursts wait a frame
+        static constexpr uint32_t MAX_EMIT_PER_FRAME = 16384;  // particles started per frame
+        static constexpr uint32_t MAX_PARTICLES_PER_BURST = 256;
+        static constexpr uint32_t LOCAL_SIZE = 64;             // particle_*.comp local_size_x
+        static constexpr float MAX_STEP_SECONDS = 0.1f;        // longer frames simulate this much
+
+        // Look and motion of one ParticleEffect; sizes in meters, speeds in m/s.
+        struct EffectDesc
+        {
+            glm::vec4 colorStart{1.0f}; // rgb is scaled by alpha (additive blending)
+            glm::vec4 colorEnd{1.0f, 1.0f, 1.0f, 0.0f};
+            float speedMin = 1.0f;
+            float speedMax = 2.0f;
+            float spread = 1.0f;   // 0 = along the spawn direction, 1 = any direction
+            float lift = 0.0f;     // added upward speed
+            float lifeMin = 0.5f;  // seconds
+            float lifeMax = 1.0f;
+            float sizeStart = 0.1f;
+            float sizeEnd = 0.1f;
+            float gravity = 9.81f; // m/s^2 down (negative rises)
+            float drag = 0.0f;     // 1/s
+            uint16_t defaultCount = 16;
+        };
+
+        struct Stats
+        {
+            uint32_t bursts = 0;      // drained this frame
+            uint32_t emitted = 0;     // particles started this frame
+            uint32_t simulated = 0;   // particles the update pass walked this frame
+            bool deferred = false;    // the frame budget was hit: the rest waits in the ring
+            uint64_t ringDropped = 0; // ParticleSpawnRing::dropped()
+        };
+
+        ParticleRenderPassModule();
+        ~ParticleRenderPassModule() override = default;
+
+        const char *getDebugName() const override { return "Particles"; }
+
+        void setEnabled(bool enabled) { m_enabled = enabled; }
+        void setCamera(Camera *camera) { m_camera = camera; }
+
+        // Producers push here from any thread; the pass owns it, so it lives as long as the pass.
+        ParticleSpawnRing &spawnRing() { return m_ring; }
+
+        // Effect table (defaults: orange hit sparks, dark red death burst, tan dust).
+        void setEffect(ParticleEffect effect, const EffectDesc &desc);
+        const EffectDesc &effect(ParticleEffect effect) const { return m_effects[static_cast<uint32_t>(effect)]; }
+
+        const Stats &stats() const { return m_stats; }
+
+        void onCreate(VulkanContext &ctx, VkRenderPass pass, const std::vector<VkFramebuffer> &fbs) override;
+        void recordPrePass(FrameContext &frameCtx, VkCommandBuffer cmd) override;
+        void record(FrameContext &frameCtx, VkCommandBuffer cmd) override;
+        void latchCamera(FrameContext &frameCtx) override;
+        bool recordsPhases() const override { return true; }
+        void recordPhase(FrameContext &frameCtx, VkCommandBuffer cmd, RenderPhase phase) override;
+        void onResize(VulkanContext &ctx, VkExtent2D newExtent) override;
+        void onDestroy(VulkanContext &ctx) override;
+
+        // Particle pool and per-frame buffers, under category "Render".
+        void reportMemory(MemoryReport &out) const;
+
+    private:
+        // std140 (particle_*.comp, particle.vert).
+        struct GpuEffect
+        {
+            glm::vec4 colorStart;
+            glm::vec4 colorEnd;
+            glm::vec4 motion; // x=speed min, y=speed max, z=spread, w=lift
+            glm::vec4 life;   // x=life min, y=life max, z=size start, w=size end
+            glm::vec4 forces; // x=gravity, y=drag
+        };
+
+        struct FrameUBO
+        {
+            glm::mat4 view{1.0f};
+            glm::mat4 proj{1.0f};
+            GpuEffect effects[PARTICLE_EFFECT_COUNT];
+        };
+
+        // std430 (particle_emit.comp).
+        struct GpuBurst
+        {
+            glm::vec4 position;  // w=ground height
+            glm::vec4 direction; // w=scale
+            glm::uvec4 info;     // x=effect, y=first particle of the burst, z=count, w=seed
+        };
+        static_assert(sizeof(GpuBurst) == 48, "GpuBurst must match particle_emit.comp");
+
+        // One pool entry (std430, particle_*.comp and particle.vert: 48 bytes).
+        static constexpr VkDeviceSize PARTICLE_BYTES = 48;
+
+        struct FrameData
+        {
+            VkDescriptorSet set = VK_NULL_HANDLE;
+
+            VkBuffer uniformBuffer = VK_NULL_HANDLE;
+            GpuAllocation uniformMemory;
+
+            VkBuffer burstBuffer = VK_NULL_HANDLE;
+            GpuAllocation burstMemory;
+
+            bool draw = false; // the update pass ran: the indirect count is this frame's
+        };
+
+        // Push constants of both compute shaders (uvec4 + vec4).
+        struct ComputePush
+        {
+            uint32_t emitBase = 0;  // pool index of this frame's first new particle
+            uint32_t emitCount = 0;
+            uint32_t burstCount = 0;
+            uint32_t simulateCount = 0;
+            float dt = 0.0f;
+            float time = 0.0f;
+            float pad0 = 0.0f;
+            float pad1 = 0.0f;
+        };
+
+        bool createBuffers(VulkanContext &ctx, size_t frameCount);
+        void destroyBuffers();
+        void createComputePipelines(VulkanContext &ctx);
+        void createGraphicsPipeline(VulkanContext &ctx, VkRenderPass pass);
+        void writeEffects(FrameData &frame) const;
+        uint32_t drainSpawns(FrameData &frame);
+
+    private:
+        bool m_enabled = true;
+        Camera *m_camera = nullptr; // not owned
+        ParticleSpawnRing m_ring;
+        std::array<EffectDesc, PARTICLE_EFFECT_COUNT> m_effects{};
+
+        VkDevice m_device = VK_NULL_HANDLE;
+        VkExtent2D m_extent{};
+
+        // Set 0 (all stages): 0 = frame UBO, 1 = bursts, 2 = particle pool, 3 = alive list,
+        // 4 = indirect draw command.
+        VkDescriptorSetLayout m_setLayout = VK_NULL_HANDLE;
+        VkDescriptorPool m_pool = VK_NULL_HANDLE;
+        std::vector<FrameData> m_frames;
+
+        VkPipelineLayout m_computeLayout = VK_NULL_HANDLE;
+        VkPipeline m_emitPipeline = VK_NULL_HANDLE;
+        VkPipeline m_updatePipeline = VK_NULL_HANDLE;
+        VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+        Pipeline m_pipeline;
+        bool m_ready = false; // pipelines exist (shaders found)
+
+        // Shared by every frame slot: frames run in order on the graphics queue.
+        VkBuffer m_particleBuffer = VK_NULL_HANDLE;
+        GpuAllocation m_particleMemory;
+        VkBuffer m_aliveBuffer = VK_NULL_HANDLE;
+        GpuAllocation m_aliveMemory;
+        VkBuffer m_indirectBuffer = VK_NULL_HANDLE;
+        GpuAllocation m_indirectMemory;
+
+        // Pool bookkeeping: the emit cursor, how much of the pool was ever written and when the
+        // last particle dies.
+        uint32_t m_emitCursor = 0;
+        uint32_t m_usedParticles = 0;
+        float m_time = 0.0f;
+        float m_aliveUntil = -1.0f;
+        std::chrono::steady_clock::time_point m_lastFrame{};
+        bool m_haveLastFrame = false;
+        uint32_t m_seed = 0;
+
+        std::vector<GpuBurst> m_bursts; // recordPrePass scratch
+        bool m_pendingSpawn = false;    // a burst popped but not uploaded (frame budget)
+        ParticleSpawn m_pending{};
+
+        Stats m_stats{};
+    };
+}
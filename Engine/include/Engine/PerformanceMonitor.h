@@ -1,13 +1,18 @@
 #pragma once
 
+#include "utils/MemoryReport.h"
+#include "utils/TelemetrySink.h"
+
 #include <chrono>
 #include <deque>
 #include <cstdint>
+#include <functional>
+#include <memory>
 #include <string>
+#include <vector>
 
 #if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
 #include <unordered_map>
-#include <vector>
 #endif
 
 namespace Engine
@@ -15,10 +20,12 @@ namespace Engine
     class Window;
     class Renderer;
     class VulkanContext;
+    class JobSystem;
 
     namespace ECS
     {
         struct ECSContext;
+        class SystemScheduler;
     }
 
     /**
@@ -30,6 +37,40 @@ namespace Engine
     class PerformanceMonitor
     {
     public:
+        // Frame-time distribution over the history window (HISTORY_SIZE frames).
+        struct FrameTimeStats
+        {
+            float p50Ms = 0.0f;
+            float p95Ms = 0.0f;
+            float p99Ms = 0.0f;
+            float maxMs = 0.0f;
+            float onePercentLowFps = 0.0f; // 1000 / mean of the slowest 1% of frames
+            uint32_t samples = 0;
+        };
+
+        // State of a frame that took longer than HITCH_FACTOR x the median frame time.
+        // Pass timings are the renderer's latest (GPU values lag by the frames in flight);
+        // systems are the ECS schedule trace of the last simulation tick (debug builds only).
+        struct HitchSnapshot
+        {
+            struct Timing
+            {
+                std::string name;
+                float cpuMs = 0.0f;
+                float gpuMs = 0.0f; // passes only
+            };
+
+            uint64_t frameIndex = 0;
+            float timeSec = 0.0f; // since init()
+            float frameMs = 0.0f;
+            float medianMs = 0.0f;
+            float cpuMs = 0.0f;
+            float gpuMs = 0.0f;
+            uint32_t drawCalls = 0;
+            std::vector<Timing> passes;
+            std::vector<Timing> systems;
+        };
+
         PerformanceMonitor();
         ~PerformanceMonitor();
 
@@ -48,6 +89,64 @@ namespace Engine
         // Optional: provide ECS context for schedule tracing display (debug-only UI).
         void setEcsContext(ECS::ECSContext *ecs) { m_ecs = ecs; }
 
+        // Optional: job system whose worker/loop metrics are sampled and shown.
+        void setJobSystem(JobSystem *jobs) { m_jobs = jobs; }
+
+        // Job system utilization over the last system-metrics interval (SYS_UPDATE_INTERVAL).
+        struct JobUtilization
+        {
+            struct Thread
+            {
+                float busyPercent = 0.0f;
+                float spinPercent = 0.0f;
+                float sleepPercent = 0.0f;
+                float waitPercent = 0.0f;
+                uint64_t jobs = 0;
+                uint64_t steals = 0;
+            };
+            struct Loop
+            {
+                std::string name;
+                uint64_t calls = 0;
+                uint64_t inlineCalls = 0;
+                uint64_t items = 0;
+                float serialFraction = 0.0f;
+                float wallMsPerFrame = 0.0f;
+            };
+
+            std::vector<Thread> threads; // workers, then the shared non-worker slot
+            std::vector<Loop> loops;     // by wall time, largest first
+        };
+        const JobUtilization &getJobUtilization() const { return m_jobUtilization; }
+
+        // Byte counts contributed by subsystems the monitor doesn't know about (AssetManager,
+        // gameplay systems). Providers run every SYS_UPDATE_INTERVAL on the main thread, between
+        // frames, so they may read their owner's state without locking.
+        using MemoryProvider = std::function<void(MemoryReport &)>;
+        void addMemoryProvider(MemoryProvider provider) { m_memoryProviders.push_back(std::move(provider)); }
+
+        // Latest report: ECS columns and entity tables, every provider's entries, then the GPU
+        // allocator's unattributed and reserved-but-unused bytes (category "GPU").
+        const MemoryReport &getMemoryReport() const { return m_memoryReport; }
+
+        // Heap allocations made by all threads during the last frame (0 without
+        // ENGINE_COUNT_ALLOCATIONS). With the check on, steady-state frames (past
+        // HITCH_MIN_HISTORY) that allocate are logged, at most once per second (debug builds).
+        uint64_t getFrameAllocations() const { return m_frameAllocations; }
+        void setAllocationCheck(bool enabled) { m_allocationCheck = enabled; }
+        bool isAllocationCheckEnabled() const { return m_allocationCheck; }
+
+        // Optional: stream every TelemetryConfig::intervalSec a Summary (this interval's frame-time
+        // percentiles, CPU/GPU ms, draw calls, VRAM/RSS, CPU %), the per-system timings of every
+        // added scheduler and, as they happen, up to maxHitchesPerInterval Hitch packets. Works
+        // with the overlay hidden; in production builds too. False if the transport failed.
+        bool enableTelemetry(const TelemetryConfig &config);
+        void disableTelemetry();
+        // Sampled once per frame (systemLastMs), so the scheduler needs Config::recordTimings.
+        // Not owned; must outlive the telemetry session.
+        void addTelemetryScheduler(const ECS::SystemScheduler *scheduler, const std::string &label);
+        const TelemetrySink *getTelemetry() const { return m_telemetry.get(); }
+
         /**
          * @brief Cleanup resources.
          */
@@ -103,6 +202,16 @@ namespace Engine
         float getCpuUsagePercent() const { return m_cpuUsagePercent; }
         float getRamUsedMB() const { return m_ramUsedMB; }
         const std::string &getGpuName() const { return m_gpuName; }
+        const FrameTimeStats &getFrameTimeStats() const { return m_frameStats; }
+
+        // Most recent hitches, oldest first (at most MAX_HITCHES are kept).
+        const std::deque<HitchSnapshot> &getHitches() const { return m_hitches; }
+        void clearHitches() { m_hitches.clear(); }
+
+        // Write the kept hitches for offline analysis. CSV has one row per pass/system timing
+        // (frame columns repeated); JSON has one object per hitch. Return false on I/O failure.
+        bool exportHitchesCsv(const std::string &path) const;
+        bool exportHitchesJson(const std::string &path) const;
         uint32_t getDrawCallCount() const { return m_drawCallCount; }
         uint32_t getResolutionWidth() const;
         uint32_t getResolutionHeight() const;
@@ -112,6 +221,14 @@ namespace Engine
         void querySystemInfo();     // One-time GPU name, total VRAM
         void updateSystemMetrics(); // Per-frame VRAM used, CPU %, RAM
         void queryVramViaVulkan();  // Cross-platform VRAM via VK_EXT_memory_budget
+        void captureHitch(float frameTimeMs);
+        void updateJobMetrics();
+        void updateMemoryReport();
+        void sampleTelemetryFrame(float frameTimeMs);
+        void emitTelemetry();
+        void emitTelemetrySession();
+        void emitTelemetryHitch(const HitchSnapshot &h);
+        uint32_t telemetryTimeMs() const;
 
     private:
         // References to engine systems
@@ -121,6 +238,33 @@ namespace Engine
 
         // Optional ECS pointer for schedule tracing.
         ECS::ECSContext *m_ecs = nullptr;
+        JobSystem *m_jobs = nullptr;
+        JobUtilization m_jobUtilization;
+        uint32_t m_framesSinceJobSample = 0;
+        std::vector<MemoryProvider> m_memoryProviders;
+        MemoryReport m_memoryReport;
+
+        // Telemetry: accumulated over the current interval, reset by emitTelemetry().
+        struct TelemetryScheduler
+        {
+            const ECS::SystemScheduler *scheduler = nullptr; // not owned
+            std::string label;
+            std::vector<float> sumMs; // per system index
+            std::vector<float> maxMs;
+            uint32_t samples = 0;
+        };
+        std::unique_ptr<TelemetrySink> m_telemetry;
+        std::vector<TelemetryScheduler> m_telemetrySchedulers;
+        std::vector<float> m_telemetryFrameMs;
+        double m_telemetryCpuMs = 0.0;
+        double m_telemetryGpuMs = 0.0;
+        uint64_t m_telemetryDrawCalls = 0;
+        uint64_t m_telemetryAllocations = 0;
+        uint32_t m_telemetryHitches = 0; // this interval, sent or not
+        float m_telemetryTimer = 0.0f;
+        float m_telemetrySessionTimer = 0.0f;
+        static constexpr float TELEMETRY_SESSION_INTERVAL = 60.0f; // Session packet repeat (s)
+        static constexpr size_t TELEMETRY_HITCH_ITEMS = 8;         // heaviest passes/systems per Hitch
 
         // Visibility toggle
         bool m_visible = false;
@@ -136,6 +280,22 @@ namespace Engine
         // Frame time history for percentile calculations (stores frame times in ms)
         static constexpr size_t HISTORY_SIZE = 300; // ~5 seconds at 60fps
         std::deque<float> m_frameTimeHistory;
+        std::vector<float> m_sortScratch; // reused by updateMetrics()
+        FrameTimeStats m_frameStats;
+
+        // Hitch capture: needs a full-ish history so the median means something.
+        static constexpr float HITCH_FACTOR = 2.0f;
+        static constexpr size_t HITCH_MIN_HISTORY = 60;
+        static constexpr size_t MAX_HITCHES = 64;
+        std::deque<HitchSnapshot> m_hitches;
+
+        // Heap allocation tracking (utils/AllocationCounter.h)
+        uint64_t m_allocTotalAtFrameEnd = 0;
+        uint64_t m_frameAllocations = 0;
+        bool m_allocationCheck = false;
+        TimePoint m_lastAllocWarning;
+        uint64_t m_frameIndex = 0;
+        TimePoint m_initTime;
 
         // Current metrics (raw values)
         float m_avgFPS = 0.0f;
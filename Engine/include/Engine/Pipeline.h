@@ -1,5 +1,8 @@
 #pragma once
 #include <vulkan/vulkan.h>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
 #include <vector>
 #include <string>
 
@@ -84,6 +87,12 @@ namespace Engine
     // Caller is responsible for destroying the returned module with vkDestroyShaderModule.
     static VkShaderModule createShaderModuleFromFile(VkDevice device, const std::string &spvPath);
 
+    // Read every *.spv under directory into a process-wide byte cache that
+    // createShaderModuleFromFile() checks before touching the disk. Thread-safe: Application runs
+    // it on a worker while the window and device are still being created. Returns files read.
+    static uint32_t preloadShaderFiles(const std::string &directory);
+    static void clearShaderFileCache();
+
   private:
     VkPipeline m_pipeline = VK_NULL_HANDLE;
     VkPipelineLayout m_layout = VK_NULL_HANDLE;
@@ -93,4 +102,43 @@ namespace Engine
     // wrapper will not destroy it.
     bool m_ownsLayout = false;
   };
+
+  // Specialization constant values for one shader stage. Values are 32-bit (int, uint, float or
+  // bool as VkBool32); the object must outlive the pipeline creation that points at info().
+  class PipelineSpecialization
+  {
+  public:
+    void set(uint32_t constantId, uint32_t value);
+    void setBool(uint32_t constantId, bool value) { set(constantId, value ? VK_TRUE : VK_FALSE); }
+    void clear();
+    bool empty() const { return m_entries.empty(); }
+
+    // Points stage.pSpecializationInfo at this object (nullptr when no constant is set).
+    void apply(VkPipelineShaderStageCreateInfo &stage);
+
+  private:
+    std::vector<VkSpecializationMapEntry> m_entries;
+    std::vector<uint32_t> m_data;
+    VkSpecializationInfo m_info{};
+  };
+
+  // Pipelines of one pass that differ only in specialization constants or fixed state, keyed by a
+  // caller-defined permutation key. Permutations are compiled up front (warm-up), so recording
+  // only looks them up.
+  class PipelinePermutationCache
+  {
+  public:
+    // Creates the permutation for key (replacing an existing one).
+    VkResult create(uint32_t key, const PipelineCreateInfo &info);
+
+    // nullptr when the permutation was not created.
+    const Pipeline *find(uint32_t key) const;
+    bool contains(uint32_t key) const { return find(key) != nullptr; }
+    size_t size() const { return m_pipelines.size(); }
+
+    void destroy(VkDevice device);
+
+  private:
+    std::unordered_map<uint32_t, std::unique_ptr<Pipeline>> m_pipelines;
+  };
 }
\ No newline at end of file
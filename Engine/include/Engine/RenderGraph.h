@@ -0,0 +1,257 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include "utils/GpuAllocator.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Engine
+{
+    // How a graph pass touches a resource. Each access maps to fixed pipeline stages, access
+    // masks and (for images) a layout; the graph derives every barrier from these.
+    enum class RGAccess : uint8_t
+    {
+        ColorAttachment = 0,
+        DepthAttachment,
+        DepthRead,          // depth test without writes / sampled as depth (read-only layout)
+        FragmentSampled,
+        ComputeSampled,
+        ComputeStorageRead,
+        ComputeStorageWrite,
+        VertexStorageRead,
+        IndirectRead,
+        TransferSrc,
+        TransferDst,
+        Count
+    };
+
+    struct RGResource
+    {
+        uint32_t index = UINT32_MAX;
+        bool valid() const { return index != UINT32_MAX; }
+    };
+
+    // A graph-owned image that lives for one frame between its first and last use.
+    struct RGImageDesc
+    {
+        VkFormat format = VK_FORMAT_UNDEFINED;
+        VkExtent2D extent{};
+        VkImageUsageFlags usage = 0;
+        VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+        uint32_t mipLevels = 1;
+
+        bool operator==(const RGImageDesc &o) const
+        {
+            return format == o.format && extent.width == o.extent.width && extent.height == o.extent.height &&
+                   usage == o.usage && aspect == o.aspect && mipLevels == o.mipLevels;
+        }
+    };
+
+    // ============================================================
+    // RenderGraph
+    // ============================================================
+    // Frame graph rebuilt every frame: passes declare what they read and write, then execute()
+    // records them in declaration order with the barriers and layout transitions derived from
+    // those declarations.
+    //
+    // - Resources are imported (swapchain, depth, persistent maps, readback buffers) or created
+    //   as transients. Imported resources flagged as outputs, and passes marked sideEffect(),
+    //   root the graph: a pass whose writes reach none of them is culled, and transients only
+    //   it used are never allocated.
+    // - Transient images exist per frame slot (the slot's fence guards them). Images whose
+    //   lifetimes (first..last live pass) do not overlap are bound to the same memory; the
+    //   first use of each one waits for the previous user of that memory and starts from
+    //   UNDEFINED.
+    // - Barriers: layout changes, read-after-write and write-after-write get an image/memory
+    //   barrier; write-after-read gets an execution dependency; a read by stages the last write
+    //   was already made visible to gets nothing. All barriers before a pass are one
+    //   vkCmdPipelineBarrier.
+    // - attach(): a render pass attachment. The render pass performs the incoming transition
+    //   (initialLayout UNDEFINED / its external dependency) and leaves the image in
+    //   finalLayout; the graph only adds a barrier for hazards earlier in the same frame.
+    //
+    // Build order per frame: beginFrame(slot), import/create, addPass()..., execute(cmd).
+    class RenderGraph
+    {
+    public:
+        using ExecuteFn = std::function<void(VkCommandBuffer cmd, const RenderGraph &graph)>;
+
+        class PassBuilder
+        {
+        public:
+            void read(RGResource res, RGAccess access) { use(res, access, false, VK_IMAGE_LAYOUT_UNDEFINED, false); }
+            void write(RGResource res, RGAccess access) { use(res, access, true, VK_IMAGE_LAYOUT_UNDEFINED, false); }
+            void attach(RGResource res, RGAccess access, VkImageLayout finalLayout)
+            {
+                use(res, access, access != RGAccess::DepthRead, finalLayout, true);
+            }
+            // Keep the pass even when nothing reads its writes (it updates state outside the graph).
+            void sideEffect();
+
+        private:
+            friend class RenderGraph;
+            PassBuilder(RenderGraph &graph, uint32_t pass) : m_graph(graph), m_pass(pass) {}
+            void use(RGResource res, RGAccess access, bool write, VkImageLayout finalLayout, bool attachment);
+
+            RenderGraph &m_graph;
+            uint32_t m_pass;
+        };
+
+        struct Stats
+        {
+            uint32_t passes = 0;          // declared this frame
+            uint32_t culled = 0;          // passes skipped: no consumer
+            uint32_t barriers = 0;        // image + buffer barriers recorded
+            uint32_t skippedBarriers = 0; // accesses that needed none (already visible / render pass)
+            uint32_t transientImages = 0;
+            VkDeviceSize transientBytes = 0; // memory bound this frame
+            VkDeviceSize aliasedBytes = 0;   // saved by aliasing (sum of images - bound memory)
+        };
+
+        RenderGraph() = default;
+        ~RenderGraph() = default; // call destroy() while the device is alive
+
+        RenderGraph(const RenderGraph &) = delete;
+        RenderGraph &operator=(const RenderGraph &) = delete;
+
+        void create(VkDevice device, VkPhysicalDevice physicalDevice, uint32_t frameCount);
+        // Transients of every slot (after vkDeviceWaitIdle).
+        void destroy();
+
+        // Start declaring frame slot's graph; drops last frame's declarations.
+        void beginFrame(uint32_t frameSlot);
+
+        // stageMask: stages the image's current contents/layout must wait for before the first
+        // use this frame (e.g. COLOR_ATTACHMENT_OUTPUT for a just-acquired swapchain image).
+        RGResource importImage(const char *name, VkImage image, VkImageView view, VkImageAspectFlags aspect,
+                               VkImageLayout layout, VkPipelineStageFlags stageMask, bool output);
+        RGResource importBuffer(const char *name, VkBuffer buffer, bool output);
+        RGResource createImage(const char *name, const RGImageDesc &desc);
+
+        // setup(PassBuilder &) runs immediately; execute runs from execute() unless culled.
+        template <typename SetupFn>
+        void addPass(const char *name, SetupFn &&setup, ExecuteFn execute)
+        {
+            const uint32_t index = static_cast<uint32_t>(m_passes.size());
+            m_passes.push_back(Pass{});
+            m_passes.back().name = name;
+            m_passes.back().execute = std::move(execute);
+            PassBuilder builder(*this, index);
+            setup(builder);
+        }
+
+        // Compile (cull, place transients, plan barriers) and record the frame into cmd.
+        void execute(VkCommandBuffer cmd);
+
+        // Valid inside a pass's execute function.
+        VkImage image(RGResource res) const;
+        VkImageView view(RGResource res) const;
+        VkBuffer buffer(RGResource res) const;
+
+        const Stats &stats() const { return m_stats; }
+
+    private:
+        struct Use
+        {
+            uint32_t resource = 0;
+            RGAccess access = RGAccess::FragmentSampled;
+            bool write = false;
+            bool attachment = false;
+            VkImageLayout finalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        };
+
+        struct Pass
+        {
+            std::string name;
+            ExecuteFn execute;
+            std::vector<Use> uses;
+            bool sideEffect = false;
+            bool live = false;
+        };
+
+        struct Resource
+        {
+            std::string name;
+            bool isImage = true;
+            bool imported = false;
+            bool output = false;
+            VkImage image = VK_NULL_HANDLE;
+            VkImageView view = VK_NULL_HANDLE;
+            VkBuffer buffer = VK_NULL_HANDLE;
+            VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+            RGImageDesc desc{};     // transients
+            uint32_t transient = UINT32_MAX; // index into the slot's images
+            uint32_t firstPass = UINT32_MAX; // live uses
+            uint32_t lastPass = 0;
+
+            // Tracked while recording.
+            VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+            VkPipelineStageFlags writeStages = 0; // last write (or the import's stageMask)
+            VkAccessFlags writeAccess = 0;
+            VkPipelineStageFlags readStages = 0;    // reads since that write
+            VkPipelineStageFlags visibleStages = 0; // stages the write was made visible to
+            bool touched = false;                   // used earlier this frame
+        };
+
+        // A transient image of one frame slot, kept while the graph's transients stay the same.
+        struct TransientImage
+        {
+            RGImageDesc desc{};
+            VkImage image = VK_NULL_HANDLE;
+            VkImageView view = VK_NULL_HANDLE;
+            VkMemoryRequirements requirements{};
+            uint32_t memory = 0; // index into Slot::memories
+            uint32_t firstPass = 0;
+            uint32_t lastPass = 0;
+        };
+
+        struct TransientMemory
+        {
+            GpuAllocation allocation;
+            VkDeviceSize size = 0;
+            VkDeviceSize alignment = 1;
+            uint32_t typeBits = ~0u;
+            std::vector<uint32_t> images; // sharing it, in first-use order
+
+            // Tracked while recording: the last user's stages and writes.
+            VkPipelineStageFlags stages = 0;
+            VkAccessFlags writeAccess = 0;
+        };
+
+        struct Slot
+        {
+            std::vector<TransientImage> images;
+            std::vector<TransientMemory> memories;
+            uint64_t signature = 0; // descs + lifetimes the images were placed for
+        };
+
+        struct AccessInfo
+        {
+            VkPipelineStageFlags stages;
+            VkAccessFlags access;
+            VkImageLayout layout;
+        };
+        static AccessInfo accessInfo(RGAccess access);
+
+        void cull();
+        bool placeTransients(Slot &slot);
+        void destroySlot(Slot &slot);
+        void recordBarriers(VkCommandBuffer cmd, const Pass &pass, Slot &slot);
+
+        VkDevice m_device = VK_NULL_HANDLE;
+        VkPhysicalDevice m_physicalDevice = VK_NULL_HANDLE;
+        std::vector<Slot> m_slots;
+        uint32_t m_slot = 0;
+
+        std::vector<Pass> m_passes;
+        std::vector<Resource> m_resources;
+
+        // execute() scratch
+        std::vector<VkImageMemoryBarrier> m_imageBarriers;
+
+        Stats m_stats{};
+    };
+}
@@ -1,16 +1,77 @@
 #pragma once
 
 #include <vulkan/vulkan.h>
+#include <deque>
 #include <vector>
 #include <memory>
 #include <functional>
 #include "Structs/FrameContextStruct.h"
+#include "Engine/Pipeline.h"
+#include "Engine/HiZPyramid.h"
+#include "Engine/RenderGraph.h"
+#include "Engine/ShadowCascades.h"
+#include "Engine/SwapChain.h"
+#include "utils/DynamicResolution.h"
+#include "utils/FrameLimiter.h"
+#include "utils/FrameUploadRing.h"
+#include "utils/GpuAllocator.h"
+
+#include <glm/glm.hpp>
 
 namespace Engine
 {
     class VulkanContext;
     class SwapChain;
     class RenderPassModule;
+    class JobSystem;
+    class Camera;
+
+    // The view camera of a frame, written once by the renderer into its upload ring
+    // (FrameContext::cameraOffset) and shared by every pass (std140). Passes whose camera UBO
+    // starts with view/proj/position bind it directly or copy the prefix into their own block.
+    struct CameraBlock
+    {
+        glm::mat4 view{1.0f};
+        glm::mat4 proj{1.0f};
+        glm::vec4 position{0.0f, 0.0f, 0.0f, 1.0f};
+        glm::vec4 viewport{0.0f}; // x=width, y=height, z=1/width, w=1/height (swapchain extent)
+        glm::mat4 viewProj{1.0f};
+    };
+
+    // Draw order inside the main render pass. The renderer records phase-major: every pass's
+    // DepthPrepass, then every pass's Opaque, Mask and Blend, so geometry of one kind from all
+    // models is contiguous and blended draws land after every opaque one.
+    enum class RenderPhase : uint32_t
+    {
+        DepthPrepass = 0, // depth only, opaque + masked (draws only when FrameContext::depthPrepass)
+        Opaque,
+        Mask,
+        Blend,
+        Count
+    };
+    static constexpr uint32_t RENDER_PHASE_COUNT = static_cast<uint32_t>(RenderPhase::Count);
+
+    // Where RenderPassModule::buildGraph() adds its passes in the frame graph.
+    enum class GraphStage : uint32_t
+    {
+        BeforeScene = 0, // after the pre-passes and shadows, before the main render pass
+        AfterScene,      // after the main render pass, before the depth readback and upscale
+    };
+
+    // The frame graph's scene targets, imported by the renderer every frame.
+    struct RenderGraphTargets
+    {
+        RGResource color; // swapchain image, or the scene colour image with resolution scaling
+        RGResource depth;
+    };
+
+    // How far the CPU may run ahead of the GPU (see Renderer::setLatencyMode).
+    enum class LatencyMode : uint32_t
+    {
+        Throughput = 0, // up to getFramesInFlight() frames queued; CPU and GPU overlap fully
+        LowLatency,     // the next frame starts only once the previous one finished on the GPU
+    };
+
     // Renderer: owns the main on-screen VkRenderPass, per-swapchain VkFramebuffer objects,
     // and per-frame command pools/buffers and synchronization objects. It calls registered
     // RenderPassModule::record() while the main render pass is active.
@@ -20,6 +81,10 @@ namespace Engine
     public:
         struct CpuFrameTimings
         {
+            // Before the frame's input/update (waitForLatency); not part of drawFrameTotalMs.
+            float limiterWaitMs = 0.0f;
+            float latencyWaitMs = 0.0f;
+
             float waitFenceMs = 0.0f;
             float acquireMs = 0.0f;
 
@@ -28,12 +93,15 @@ namespace Engine
             float cmdBeginMs = 0.0f;
             float timestampResetMs = 0.0f;
             float renderPassBeginMs = 0.0f;
+            float shadowRecordMs = 0.0f; // RenderPassModule::recordShadow for every redrawn cascade
             float passesRecordMs = 0.0f;
             float imguiRecordMs = 0.0f;
             float renderPassEndMs = 0.0f;
             float cmdEndMs = 0.0f;
 
+            float asyncComputeMs = 0.0f; // recordAsyncCompute for every pass + compute submit
             float recordMs = 0.0f;
+            float latchMs = 0.0f; // late-latch callback + RenderPassModule::latchCamera
             float submitMs = 0.0f;
 
             // Can block if the driver needs results; timed separately.
@@ -49,6 +117,44 @@ namespace Engine
             const char *name = "";
             float recordMs = 0.0f;
         };
+
+        // GPU cost of one pass from a completed frame: time between timestamps written around
+        // recordPrePass() and record(), plus shader invocation counts when pipeline statistics
+        // are on (all zero otherwise). Invocations cover both the pre-pass and the main record.
+        // For phased passes (RenderPassModule::recordsPhases) record covers the Opaque phase only:
+        // queries can't span the other passes' phases recorded in between.
+        struct PassGpuTiming
+        {
+            const char *name = "";
+            float prePassMs = 0.0f;
+            float recordMs = 0.0f;
+            uint64_t vertexInvocations = 0;
+            uint64_t fragmentInvocations = 0;
+            uint64_t computeInvocations = 0;
+        };
+
+        // Passes past this many (in registration order) get no GPU timings.
+        static constexpr uint32_t MAX_GPU_TIMED_PASSES = 16;
+
+        // CPU copy of the depth attachment of a completed frame (see setDepthReadbackCallback).
+        // data holds width*height 32-bit texels, row-major: floats for D32 formats, and 24-bit
+        // UNORM in the low bits for D24_UNORM_S8_UINT (use depthAt()).
+        struct DepthReadback
+        {
+            const void *data = nullptr;
+            uint32_t width = 0;
+            uint32_t height = 0;
+            VkFormat format = VK_FORMAT_UNDEFINED;
+            uint64_t frameSerial = 0; // getFrameSerial() value of the frame that rendered it
+
+            float depthAt(uint32_t x, uint32_t y) const
+            {
+                const uint32_t *texels = static_cast<const uint32_t *>(data);
+                if (format == VK_FORMAT_D24_UNORM_S8_UINT)
+                    return static_cast<float>(texels[y * width + x] & 0x00FFFFFFu) / 16777215.0f;
+                return static_cast<const float *>(data)[y * width + x];
+            }
+        };
         Renderer(VulkanContext *ctx, SwapChain *swapchain, uint32_t maxFramesInFlight = 2);
         ~Renderer();
 
@@ -63,6 +169,14 @@ namespace Engine
         // Per-frame draw: acquire, record main render pass, submit, present
         void drawFrame();
 
+        // Window resize: recreates the swapchain (oldSwapchain handoff) and the size-dependent
+        // targets (depth, framebuffers, upscale targets) without a device idle wait; the replaced
+        // ones are destroyed once the frames using them completed. Passes only get onResize().
+        // Returns true when the swapchain format changed, which rebuilds the main render pass
+        // (idle wait, passes' onDestroy()/onCreate()): anything else built against
+        // getMainRenderPass() must then be recreated too.
+        bool resize(VkExtent2D extent);
+
         // Register a RenderPassModule to be invoked each frame. If init() was already called,
         // the module's onCreate(...) will be invoked immediately so it can allocate resources.
         void registerPass(std::shared_ptr<RenderPassModule> pass);
@@ -76,12 +190,63 @@ namespace Engine
         VkRenderPass getMainRenderPass() const { return m_mainRenderPass; }
         VkExtent2D getExtent() const { return m_extent; }
 
+        // Resolution scaling: below scale 1 the main render pass draws into the top-left
+        // getRenderExtent() region of a full-size offscreen colour target, and an upscale pass
+        // (bilinear plus optional contrast-adaptive sharpening) fills the swapchain image, with
+        // ImGui drawn on top at native resolution. At scale 1 passes draw straight into the
+        // swapchain. Passes must set their viewport/scissor from FrameContext::renderExtent.
+        // Pipelines made against getMainRenderPass() work in every mode (compatible passes).
+        //
+        // setDynamicResolution(true) drives the scale from the GPU frame time (config below);
+        // otherwise setRenderScale() fixes it. The GPU time includes waits for the swapchain
+        // image, so keep the target below the display interval when vsync is on.
+        void setDynamicResolution(bool enable);
+        bool isDynamicResolution() const { return m_dynamicResolution; }
+        void setDynamicResolutionConfig(const DynamicResolution::Config &cfg) { m_resolutionController.setConfig(cfg); }
+        const DynamicResolution::Config &getDynamicResolutionConfig() const { return m_resolutionController.config(); }
+        void setRenderScale(float scale);
+        float getRenderScale() const { return m_renderScale; } // in use (either mode)
+        VkExtent2D getRenderExtent() const { return m_renderExtent; }
+        void setUpscaleSharpness(float sharpness) { m_upscaleSharpness = std::min(std::max(sharpness, 0.0f), 1.0f); }
+        float getUpscaleSharpness() const { return m_upscaleSharpness; }
+        // False once the upscale resources failed to build (e.g. missing shaders): the scale then stays at 1.
+        bool isResolutionScalingSupported() const { return !m_upscaleFailed; }
+
         // Index of the frame slot that will be used by the next drawFrame() call.
         uint32_t getCurrentFrameIndex() const { return m_currentFrame; }
 
-        // Number of per-frame slots (frames in flight) owned by the renderer.
+        // Number of per-frame slots owned by the renderer (the constructor's maxFramesInFlight).
         uint32_t getMaxFramesInFlight() const { return m_maxFrames; }
 
+        // Frames cycled through, 1..getMaxFramesInFlight() (default: min(2, max)). Fewer frames
+        // queue less input latency; more hide CPU/GPU spikes. Takes effect at the next drawFrame().
+        void setFramesInFlight(uint32_t count);
+        uint32_t getFramesInFlight() const { return m_framesInFlight; }
+
+        // LowLatency makes waitForLatency() block until the last submitted frame completed (was
+        // shown, with present wait), so input is sampled right before the frame that shows it
+        // instead of frames ahead of it.
+        void setLatencyMode(LatencyMode mode) { m_latencyMode = mode; }
+        LatencyMode getLatencyMode() const { return m_latencyMode; }
+
+        // Frame rate cap applied in waitForLatency() (<= 0: uncapped). Combine with VSyncMode::Off
+        // for a tear-free cap below the display rate.
+        void setFrameRateLimit(float fps) { m_frameLimiter.setTargetFps(fps); }
+        float getFrameRateLimit() const { return m_frameLimiter.targetFps(); }
+
+        // True when presents carry ids and LowLatency waits for them to be displayed.
+        bool isPresentWaitActive() const;
+
+        // Called by the application loop before polling input for the next frame: frame rate cap,
+        // then the LowLatency wait. Returns at once when neither is active.
+        void waitForLatency();
+
+        // Late latching: called on the drawing thread after every pass was recorded and right
+        // before submit, followed by RenderPassModule::latchCamera() for every pass. Update the
+        // camera from the newest input here; passes then write their camera UBOs from it.
+        using LateLatchCallback = std::function<void()>;
+        void setLateLatchCallback(LateLatchCallback callback) { m_lateLatchCallback = std::move(callback); }
+
         // Wait for the current frame slot to become available (its in-flight fence is signaled).
         // Useful when preparing per-frame uploads *before* calling drawFrame().
         bool waitForCurrentFrameFence();
@@ -90,6 +255,41 @@ namespace Engine
         using ImGuiRenderCallback = std::function<void(VkCommandBuffer)>;
         void setImGuiRenderCallback(ImGuiRenderCallback callback) { m_imguiRenderCallback = callback; }
 
+        // Multithreaded recording: each registered pass (and the ImGui callback) records into its
+        // own secondary command buffer, passes in parallel on JobSystem workers, and the primary
+        // buffer executes them in registration order. Falls back to inline recording without a
+        // job system/workers or with fewer than two passes.
+        void setJobSystem(JobSystem *jobs) { m_jobSystem = jobs; }
+        void setParallelRecording(bool enable) { m_parallelRecording = enable; }
+        bool isParallelRecording() const { return m_parallelRecording; }
+
+        // Optional: copy the depth attachment to host memory after every frame. The callback runs
+        // inside drawFrame() once that frame's fence has signaled (typically 1-2 frames later),
+        // just before the slot is reused. Pass an empty function to stop the readback.
+        using DepthReadbackCallback = std::function<void(const DepthReadback &)>;
+        void setDepthReadbackCallback(DepthReadbackCallback callback);
+
+        // GPU Hi-Z occlusion: after the scene, a compute pass reduces this frame's depth into a
+        // max-depth pyramid (HiZPyramid) that FrameContext::hiZPyramid hands to the next frame's
+        // compute culls. Off by default; needs a depth format that can be sampled.
+        void setHiZOcclusion(bool enable) { m_hiZOcclusion = enable; }
+        bool isHiZOcclusion() const { return m_hiZOcclusion; }
+
+        // Optional: host copy of the pyramid's coarse levels (at most about
+        // HiZPyramid::READBACK_MAX_TEXELS * 4/3 floats) for CPU culling. Runs inside drawFrame()
+        // for every frame found complete (its fence signaled: usually the previous frame), oldest
+        // first; the data is valid during the call. Builds the pyramid while set, even with
+        // setHiZOcclusion(false). Pass an empty function to stop the readback.
+        using HiZReadbackCallback = std::function<void(const HiZReadback &)>;
+        void setHiZReadbackCallback(HiZReadbackCallback callback);
+
+        // Increments once per recorded frame; the serial of the frame the next drawFrame() records.
+        uint64_t getFrameSerial() const { return m_frameSerial; }
+        // Every frame with a serial below this has finished on the GPU (its fence was waited on),
+        // so resources those frames used can be destroyed. Trails getFrameSerial() by about
+        // getFramesInFlight() + 1.
+        uint64_t getCompletedFrameSerial() const { return m_completedFrameSerial; }
+
         // Get the last measured GPU frame time in milliseconds
         float getGpuTimeMs() const { return m_gpuTimeMs; }
 
@@ -99,6 +299,52 @@ namespace Engine
         // Per-pass CPU timings from the most recent drawFrame().
         const std::vector<PassCpuTiming> &getCpuPassTimings() const { return m_passCpuTimings; }
 
+        // Per-pass GPU timings of the most recently completed frame (m_maxFrames behind the
+        // CPU). Empty when the device has no graphics timestamps.
+        const std::vector<PassGpuTiming> &getGpuPassTimings() const { return m_passGpuTimings; }
+
+        // Depth-only prepass of opaque and masked geometry before the colour phases (phased passes
+        // only): later opaque/masked fragments fail the depth test instead of shading hidden
+        // surfaces. Pays off with heavy overdraw (dense foliage); costs a second vertex pass.
+        void setDepthPrepass(bool enable) { m_depthPrepass = enable; }
+        bool isDepthPrepass() const { return m_depthPrepass; }
+
+        // Async compute: passes record compute work (RenderPassModule::recordAsyncCompute) on the
+        // dedicated compute queue, submitted before this frame's graphics work so it overlaps the
+        // previous frame's fragment shading; the graphics submit waits for it on a timeline
+        // semaphore. On by default; inactive without VulkanContext::HasAsyncCompute(). The GPU
+        // pass timings do not cover work moved to the compute queue.
+        void setAsyncCompute(bool enable) { m_asyncCompute = enable; }
+        bool isAsyncComputeEnabled() const { return m_asyncCompute; }
+        bool isAsyncComputeActive() const { return m_asyncCompute && m_computeTimeline != VK_NULL_HANDLE; }
+
+        // Pipeline statistics queries (vertex/fragment/compute invocations per pass). Off by
+        // default: they cost a begin/end query per pass and some drivers serialize around them.
+        void setPipelineStatistics(bool enable) { m_pipelineStatsEnabled = enable; }
+        bool isPipelineStatisticsEnabled() const { return m_pipelineStatsEnabled; }
+        bool isPipelineStatisticsSupported() const { return m_pipelineStatsQueryPool != VK_NULL_HANDLE; }
+
+        // Cascaded shadow maps of the scene's directional light, created by init() before the
+        // passes' onCreate(). Passes cast through RenderPassModule::shadowCaster()/recordShadow()
+        // and receive through FrameContext::shadow. Needs setCamera() to draw anything.
+        ShadowCascades &shadows() { return m_shadows; }
+        const ShadowCascades &shadows() const { return m_shadows; }
+
+        // View camera of the shared CameraBlock (and of the shadow cascades). The renderer sets its
+        // aspect from the swapchain extent at late latch. Without one the block holds a fixed
+        // fallback view.
+        void setCamera(Camera *camera);
+
+        // Per-frame uniform/storage ring every pass sub-allocates from (FrameContext::uploads).
+        // Created by init() before the passes' onCreate(); setUploadRingSize() before init().
+        void setUploadRingSize(VkDeviceSize bytesPerFrame) { m_uploadRingBytes = bytesPerFrame; }
+        FrameUploadRing &uploadRing() { return m_uploadRing; }
+        const FrameUploadRing &uploadRing() const { return m_uploadRing; }
+
+        // The frame graph drawFrame() records through (RenderPassModule::buildGraph()); stats()
+        // are the last frame's barriers, culled passes and transient memory.
+        const RenderGraph &renderGraph() const { return m_graph; }
+
     private:
         VulkanContext *m_ctx = nullptr;
         SwapChain *m_swapchain = nullptr;
@@ -107,8 +353,24 @@ namespace Engine
         VkQueue m_presentQueue = VK_NULL_HANDLE;
 
         uint32_t m_maxFrames = 2;
+        uint32_t m_framesInFlight = 2;
+        LatencyMode m_latencyMode = LatencyMode::Throughput;
+        LateLatchCallback m_lateLatchCallback;
+        uint32_t m_lastSubmittedFrame = UINT32_MAX; // slot of the latest submit (waitForLatency)
+        FrameLimiter m_frameLimiter;
+        uint64_t m_presentId = 0;     // id of the latest present (present wait only)
+        uint64_t m_presentIdBase = 0; // ids up to this one belong to an older swapchain
         bool m_initialized = false;
 
+        // Async compute: one timeline per queue, each value = one submit. Graphics waits for the
+        // frame's compute value; compute waits for a graphics value on request.
+        VkQueue m_computeQueue = VK_NULL_HANDLE;
+        bool m_asyncCompute = true;
+        VkSemaphore m_computeTimeline = VK_NULL_HANDLE;
+        VkSemaphore m_graphicsTimeline = VK_NULL_HANDLE;
+        uint64_t m_computeTimelineValue = 0;  // last signal submitted on the compute queue
+        uint64_t m_graphicsTimelineValue = 0; // last signal submitted on the graphics queue
+
         // Main render-pass and per-swapchain framebuffers
         VkRenderPass m_mainRenderPass = VK_NULL_HANDLE;
         std::vector<VkFramebuffer> m_framebuffers;
@@ -118,8 +380,32 @@ namespace Engine
         // Depth attachment resources (one per swapchain image)
         VkFormat m_depthFormat = VK_FORMAT_UNDEFINED;
         std::vector<VkImage> m_depthImages;
-        std::vector<VkDeviceMemory> m_depthMemories;
+        std::vector<GpuAllocation> m_depthMemories;
         std::vector<VkImageView> m_depthImageViews;
+        std::vector<VkImageView> m_depthSampleViews; // depth aspect only, for the Hi-Z build; empty when not sampleable
+
+        // Resolution scaling. Both render passes are compatible with m_mainRenderPass: the scene
+        // pass only ends in SHADER_READ_ONLY, the upscale pass carries the (discarded) depth
+        // attachment so ImGui's pipeline, made for the main pass, is valid in it too.
+        bool m_dynamicResolution = false;
+        DynamicResolution m_resolutionController;
+        float m_fixedRenderScale = 1.0f;
+        float m_renderScale = 1.0f;
+        VkExtent2D m_renderExtent{};
+        float m_upscaleSharpness = 0.25f;
+        bool m_upscaleCreated = false; // built on first use below scale 1; targets follow the swapchain
+        bool m_upscaleFailed = false;
+        VkRenderPass m_sceneRenderPass = VK_NULL_HANDLE;
+        VkRenderPass m_upscaleRenderPass = VK_NULL_HANDLE;
+        std::vector<VkImage> m_sceneColorImages; // one per swapchain image, like depth
+        std::vector<GpuAllocation> m_sceneColorMemories;
+        std::vector<VkImageView> m_sceneColorViews;
+        std::vector<VkFramebuffer> m_sceneFramebuffers;
+        VkSampler m_upscaleSampler = VK_NULL_HANDLE;
+        VkDescriptorSetLayout m_upscaleSetLayout = VK_NULL_HANDLE;
+        VkDescriptorPool m_upscalePool = VK_NULL_HANDLE;
+        std::vector<VkDescriptorSet> m_upscaleSets; // per swapchain image
+        Pipeline m_upscalePipeline;
 
         std::vector<FrameContext> m_frames;
         uint32_t m_currentFrame = 0;
@@ -127,15 +413,95 @@ namespace Engine
         // Registered render-pass modules that will record into the main render pass.
         std::vector<std::shared_ptr<RenderPassModule>> m_passes;
 
+        ShadowCascades m_shadows;
+        std::vector<ShadowCaster> m_passShadowCasters; // shadowCaster() of every pass, this frame
+
+        // Shared per-frame constants.
+        FrameUploadRing m_uploadRing;
+        RenderGraph m_graph;
+        RenderGraphTargets m_graphTargets{};
+        VkDeviceSize m_uploadRingBytes = FrameUploadRing::DEFAULT_BYTES_PER_FRAME;
+        Camera *m_camera = nullptr; // not owned
+        CameraBlock m_cameraBlock{};
+        uint8_t *m_cameraMapped = nullptr; // this frame's block in m_uploadRing
+
         // Optional ImGui render callback
         ImGuiRenderCallback m_imguiRenderCallback;
 
+        // Parallel recording: per frame slot, one command pool per job-system thread (workers plus the
+        // calling thread) handing out secondary buffers; pools are reset once the slot's fence signals.
+        struct SecondaryPool
+        {
+            VkCommandPool pool = VK_NULL_HANDLE;
+            std::vector<VkCommandBuffer> buffers;
+            uint32_t used = 0;
+        };
+        JobSystem *m_jobSystem = nullptr;
+        bool m_parallelRecording = false;
+        std::vector<std::vector<SecondaryPool>> m_secondaryPools; // [frame slot][thread]
+        std::vector<VkCommandBuffer> m_passSecondaries;           // [phase][pass], this frame
+        bool m_depthPrepass = false;
+
+        // Optional depth readback (one host-visible buffer per frame slot)
+        struct DepthReadbackSlot
+        {
+            VkBuffer buffer = VK_NULL_HANDLE;
+            GpuAllocation memory;
+            uint32_t width = 0; // buffer capacity (full extent)
+            uint32_t height = 0;
+            VkExtent2D copied{}; // region of the pending copy (the render extent)
+            uint64_t frameSerial = 0;
+            bool pending = false; // a copy was recorded and not yet delivered
+        };
+        DepthReadbackCallback m_depthReadbackCallback;
+        std::vector<DepthReadbackSlot> m_depthReadbacks;
+
+        // Hi-Z pyramid (built on first use)
+        HiZPyramid m_hiZ;
+        bool m_hiZOcclusion = false;
+        bool m_hiZFailed = false;
+        HiZReadbackCallback m_hiZReadbackCallback;
+        uint64_t m_hiZDeliveredSerial = 0; // newest readback handed out + 1
+        uint64_t m_frameSerial = 0;
+        uint64_t m_completedFrameSerial = 0;
+
+        // Targets replaced by a resize, destroyed once every frame recorded before it completed.
+        struct RetiredTargets
+        {
+            uint64_t retireSerial = 0; // first frame serial that no longer uses them
+            SwapChain::Retired swapchain;
+            std::vector<VkFramebuffer> framebuffers;
+            std::vector<VkImageView> imageViews;
+            std::vector<VkImage> images;
+            std::vector<GpuAllocation> memories;
+            VkDescriptorPool descriptorPool = VK_NULL_HANDLE; // upscale sets of the old targets
+        };
+        std::deque<RetiredTargets> m_retiredTargets; // retireSerial ascending
+
         // GPU timestamp query support
         VkQueryPool m_timestampQueryPool = VK_NULL_HANDLE;
         float m_timestampPeriod = 1.0f; // Nanoseconds per timestamp tick
         float m_gpuTimeMs = 0.0f;       // Last measured GPU time in milliseconds
         bool m_timestampsSupported = false;
 
+        // Per frame slot: [frame start, frame end] then, per timed pass,
+        // [pre-pass begin, pre-pass end, record begin, record end].
+        static constexpr uint32_t TIMESTAMPS_PER_FRAME = 2 + 4 * MAX_GPU_TIMED_PASSES;
+        // Per frame slot and timed pass: one query around the pre-pass, one around record().
+        static constexpr uint32_t STATS_PER_FRAME = 2 * MAX_GPU_TIMED_PASSES;
+        VkQueryPool m_pipelineStatsQueryPool = VK_NULL_HANDLE;
+        bool m_pipelineStatsEnabled = false;
+
+        // What the slot's last submission wrote, so results are read back for the right passes.
+        struct GpuQuerySlot
+        {
+            std::vector<const char *> passNames; // one per timed pass
+            bool pipelineStats = false;
+        };
+        std::vector<GpuQuerySlot> m_gpuQuerySlots;
+        std::vector<PassGpuTiming> m_passGpuTimings;
+        bool m_frameStatsActive = false; // pipeline stats queries are written this frame
+
         CpuFrameTimings m_cpuTimings{};
         std::vector<PassCpuTiming> m_passCpuTimings;
 
@@ -154,12 +520,63 @@ namespace Engine
         void createDepthResources();
         void destroyDepthResources();
 
-        // Swapchain-dependent recreate helper
-        void recreateSwapchainDependent();
+        // Secondary command buffer helpers
+        bool shouldRecordSecondary() const;
+        bool ensureSecondaryPools(uint32_t frameSlot, uint32_t threadCount);
+        void destroySecondaryPools();
+        VkCommandBuffer acquireSecondary(uint32_t frameSlot, uint32_t threadIndex);
+        // ImGui is included unless it is drawn after the upscale instead.
+        void recordPassesSecondary(FrameContext &frame, VkRenderPass renderPass, VkFramebuffer framebuffer, bool withImGui);
+        // One phase of one pass (queries, profiling zone, CPU time accumulated per pass).
+        void recordPassPhase(FrameContext &frame, VkCommandBuffer cmd, size_t passIndex, RenderPhase phase);
+
+        // Depth readback helpers
+        void destroyDepthReadbacks();
+        bool ensureDepthReadback(DepthReadbackSlot &slot);
+        void recordDepthReadback(VkCommandBuffer cmd, uint32_t imageIndex, VkExtent2D region, DepthReadbackSlot &slot);
+
+        // Hi-Z helpers
+        bool hiZActive(); // the pyramid is built this frame (creates it on first use)
+        void deliverHiZReadbacks();
+
+        // Resolution scaling helpers (swapchain-dependent: rebuilt with the framebuffers)
+        bool createUpscaleResources();
+        void createUpscaleTargets(); // scene colour targets + their sets; throws on failure
+        void destroyUpscaleResources();
+        bool updateRenderExtent(); // true when this frame renders offscreen and upscales
+        void recordUpscale(VkCommandBuffer cmd, uint32_t imageIndex);
+
+        // Rewinds the ring's segment for the frame slot and reserves the shared camera block.
+        void beginUploadFrame(FrameContext &frame);
+        // Fills the shared camera block from m_camera (late latch).
+        void writeCameraBlock(FrameContext &frame);
+
+        // Shadow cascades: beginFrame() from the passes' casters, then (after their pre-passes)
+        // the static cascades due for a redraw and the dynamic overlay.
+        void beginShadowFrame(FrameContext &frame);
+        void recordShadows(FrameContext &frame);
+
+        // Records and submits every pass's recordAsyncCompute(); returns true when the graphics
+        // submit has to wait for m_computeTimelineValue.
+        bool submitAsyncCompute(FrameContext &frame);
+
+        // Swapchain-dependent recreate helper; see resize().
+        bool recreateSwapchain(VkExtent2D extent);
+        // Swapchain (and everything depending on it) after SwapChain::SetVSyncMode.
+        void applyPendingSwapchainChange();
+        // Moves the size-dependent targets into a deferred destroy entry (ends the current ones).
+        void retireSwapchainTargets(SwapChain::Retired &swapchain);
+        // Destroys entries whose frames completed (all: after vkDeviceWaitIdle).
+        void releaseRetiredTargets(bool all);
 
         // GPU timestamp helpers
         void createTimestampQueryPool();
         void destroyTimestampQueryPool();
+        void readPassGpuTimings(uint32_t frameSlot);
+        // Bracket pass i's pre-pass (prePass = true) or record() with timestamps and, when
+        // m_frameStatsActive, a pipeline statistics query. No-op for untimed passes.
+        void beginPassQueries(VkCommandBuffer cmd, size_t passIndex, bool prePass);
+        void endPassQueries(VkCommandBuffer cmd, size_t passIndex, bool prePass);
     };
 
     class RenderPassModule
@@ -173,9 +590,83 @@ namespace Engine
         // Called after the main render pass and framebuffers are created
         virtual void onCreate(VulkanContext &ctx, VkRenderPass pass, const std::vector<VkFramebuffer> &fbs) = 0;
 
-        // Record drawing commands for this pass into the provided command buffer
+        // Optional: record work that must run outside the main render pass (compute, transfers).
+        // Called for every module before the main render pass begins.
+        virtual void recordPrePass(FrameContext &frameCtx, VkCommandBuffer cmd)
+        {
+            (void)frameCtx;
+            (void)cmd;
+        }
+
+        // Optional: record compute work for the async compute queue (Renderer::setAsyncCompute).
+        // Called for every module before recordPrePass(), on frames where the queue is in use
+        // (FrameContext::asyncCompute). The submit runs beside the previous frame's graphics work
+        // and this frame's indirect draws and vertex shaders wait for it. Return false when
+        // nothing was recorded (do the work in recordPrePass() instead). Buffers shared with
+        // graphics need concurrent sharing (CreateBuffer queue families); set
+        // frameCtx.computeWaitsForGraphics when the work reads what the last graphics submit wrote.
+        virtual bool recordAsyncCompute(FrameContext &frameCtx, VkCommandBuffer cmd)
+        {
+            (void)frameCtx;
+            (void)cmd;
+            return false;
+        }
+
+        // Record drawing commands for this pass into the provided command buffer. With parallel
+        // recording enabled (Renderer::setParallelRecording) cmd is a secondary buffer inside the
+        // main render pass and passes may record concurrently with each other; dynamic state
+        // (viewport/scissor) must be set by the pass itself.
         virtual void record(FrameContext &frameCtx, VkCommandBuffer cmd) = 0;
 
+        // Phase-ordered recording: a pass returning true from recordsPhases() gets recordPhase()
+        // for every RenderPhase each frame, in order and on one thread (per-frame preparation can
+        // run in the DepthPrepass call), instead of record(). Parallel recording gives every
+        // phase its own secondary buffer. Other passes record() in the Opaque phase.
+        virtual bool recordsPhases() const { return false; }
+        virtual void recordPhase(FrameContext &frameCtx, VkCommandBuffer cmd, RenderPhase phase)
+        {
+            if (phase == RenderPhase::Opaque)
+                record(frameCtx, cmd);
+        }
+
+        // Optional: write camera-dependent per-frame data (view/projection UBOs in host-visible
+        // memory) here rather than in record(). Called on the drawing thread after all passes were
+        // recorded and right before submit, with the frame's buffers no longer in use by the GPU.
+        // CPU-side culling done earlier still used the camera of record time.
+        virtual void latchCamera(FrameContext &frameCtx)
+        {
+            (void)frameCtx;
+        }
+
+        // Return false if record() touches state shared with other passes; the pass is then
+        // recorded on the calling thread after the parallel ones.
+        virtual bool supportsParallelRecord() const { return true; }
+
+        // Optional shadow casting (Renderer::shadows()). Queried once per frame before
+        // recordPrePass(); FrameContext::shadow then says which cascades are drawn. Static casters
+        // are cached: shadowContentVersion() must change whenever what they draw changes.
+        virtual ShadowCaster shadowCaster() const { return ShadowCaster::None; }
+        virtual uint64_t shadowContentVersion() const { return 0; }
+        // Draw depth for one cascade layer, after every pass's recordPrePass() and outside the
+        // main render pass: cmd is inside info.renderPass with viewport and scissor set.
+        virtual void recordShadow(FrameContext &frameCtx, VkCommandBuffer cmd, const ShadowCasterInfo &info)
+        {
+            (void)frameCtx;
+            (void)cmd;
+            (void)info;
+        }
+
+        // Optional: add offscreen passes (HZB, post, custom targets) to the frame graph. Declared
+        // reads/writes give them their barriers and transient images; a pass nothing consumes is
+        // culled. Called every frame for each stage, after recordPrePass() was declared.
+        virtual void buildGraph(FrameContext &frameCtx, RenderGraph &graph, GraphStage stage, const RenderGraphTargets &targets)
+        {
+            (void)frameCtx;
+            (void)graph;
+            (void)stage;
+            (void)targets;
+        }
+
         // Called when swapchain/extent changes
         virtual void onResize(VulkanContext &ctx, VkExtent2D newExtent) = 0;
 
@@ -4,6 +4,7 @@
 #include "assets/AssetManager.h"
 #include "assets/TextureAsset.h"
 #include "Engine/Camera.h"
+#include "utils/MemoryReport.h"
 #include <glm/glm.hpp>
 #include <vulkan/vulkan.h>
 #include <vector>
@@ -11,6 +12,7 @@
 
 namespace Engine
 {
+    class BindlessMaterials;
 
     // RenderPassModule to render a cooked .smodel (ModelAsset) without node graph.
     // Draws all primitives at identity transform (or a caller-provided model matrix).
@@ -32,9 +34,21 @@ namespace Engine
         void setModel(ModelHandle h)
         {
             m_model = h;
+            m_drawListModel = nullptr; // rebuild draw list on next record
             refreshModelMatrix();
         }
 
+        // Mesh LOD level drawn by this pass (0 = full detail). Primitives that cover a whole
+        // mesh switch to its simplified index range; levels past a mesh's chain use its coarsest.
+        void setLod(uint32_t level)
+        {
+            if (level == m_lod)
+                return;
+            m_lod = level;
+            m_drawListModel = nullptr; // rebuild draw list on next record
+        }
+        uint32_t lod() const { return m_lod; }
+
         void setCamera(Camera *cam) { m_camera = cam; }
 
         // Slot-based instancing:
@@ -43,21 +57,85 @@ namespace Engine
         //   gl_InstanceIndex -> slotIndex -> instanceWorld/palettes.
         void setSlotLayout(uint32_t nodeCount, uint32_t jointCount);
         void ensureSlotCapacity(uint32_t slotCapacity);
+        // Drop slots >= slotCount (the caller moved everything below it). CPU arrays shrink now,
+        // slot buffers at the next upload once they are mostly empty.
+        void trimSlotCapacity(uint32_t slotCount);
         void setActiveSlots(const uint32_t *slotIndices, uint32_t count);
 
         void setSlotWorld(uint32_t slotIndex, const glm::mat4 &world);
+
+        // GPU culling: the active-slot list is treated as candidates; a compute pass tests each
+        // slot's world bounding sphere (setSlotBounds) against the camera frustum, compacts the
+        // visible slots and writes the indirect instance counts. With Renderer::setHiZOcclusion()
+        // it also drops slots behind the previous frame's depth (FrameContext::hiZPyramid). Falls
+        // back to culling the candidates on the CPU when the compute/indirect path is unavailable.
+        // With Renderer async compute and resident slot data, the slot copies, the pose dispatch
+        // and the cull run on the compute queue (recordAsyncCompute()), except in frames that
+        // cull meshlets or build the pose tables. Frames that copy or pose slots make that submit
+        // wait for the previous graphics submit (whose vertex shaders read the resident buffers);
+        // frames that only cull overlap with it.
+        void setGpuCulling(bool enable) { m_gpuCulling = enable; }
+        bool gpuCullingEnabled() const { return m_gpuCulling; }
+        void setSlotBounds(uint32_t slotIndex, const glm::vec3 &worldCenter, float worldRadius);
+
+        // Meshlet culling (default on): full-detail draws of a model cooked with meshlets are
+        // culled per cluster (frustum + backface cone) for every instance. With mesh shaders a
+        // task stage culls and launches the survivors; otherwise, on GPU-culled frames with
+        // draw-indirect-count, smodel_meshlet_cull.comp appends one indexed command per visible
+        // meshlet. Skinned meshlets are tested around their anchor joint with inflated bounds.
+        void setMeshletCulling(bool enable) { m_meshletCulling = enable; }
+        bool meshletCullingEnabled() const { return m_meshletCulling; }
         void setSlotPose(uint32_t slotIndex,
                  const glm::mat4 *nodeGlobals, uint32_t nodeCount,
                  const glm::mat4 *jointMatrices, uint32_t jointCount);
 
+        // Resident slot data (default): worlds, bounds and palettes live in device-local buffers
+        // shared by all frames. recordPrePass() copies only slots whose transform/pose epoch
+        // changed, through a per-frame staging buffer, so idle instances upload nothing (on the
+        // async compute queue when the frame culls there, see setGpuCulling()).
+        // Disabled (or on allocation failure) every frame keeps its own host-visible copy.
+        void setResidentSlotData(bool enable);
+        bool residentSlotData() const { return m_residentSlotData; }
+
+        // GPU pose evaluation: the model's clip data is uploaded once and smodel_pose.comp
+        // evaluates local TRS, the hierarchy and the joint palette of every slot whose
+        // animation changed, writing the resident palettes in one dispatch. Slots fed through
+        // setSlotAnimation() skip the CPU palettes entirely; setSlotPose() still works for
+        // the rest. Needs resident slot data and the compute shader (gpuPoseReady()).
+        void setGpuPose(bool enable) { m_gpuPose = enable; }
+        bool gpuPoseReady() const { return m_gpuPose && m_poseReady && m_residentSlotData && !m_poseDataFailed; }
+        // baked: sample the model's baked palettes (distant LOD) when it has them.
+        // blendWeight < 1 crossfades from blendFromClip at blendFromTimeSec (ignored when baked).
+        void setSlotAnimation(uint32_t slotIndex, uint32_t clipIndex, float timeSec, bool baked = false,
+                              uint32_t blendFromClip = 0, float blendFromTimeSec = 0.0f, float blendWeight = 1.0f);
+
         // Column-major 4x4 matrix (16 floats). Defaults to identity.
         void setModelMatrix(const float *m16);
 
+        // Shadow casting (Renderer::shadows()): Dynamic (default) redraws every frame, Static goes
+        // into the cached maps and redraws when the active slots, transforms or poses change.
+        // Every active slot casts, culled per cascade by its bounds (slots without bounds cast
+        // into every cascade); needs resident slot data. Opaque and masked draws cast.
+        void setShadowCaster(ShadowCaster caster) { m_shadowCaster = caster; }
+        ShadowCaster shadowCaster() const override;
+        uint64_t shadowContentVersion() const override;
+        void recordShadow(FrameContext &frameCtx, VkCommandBuffer cmd, const ShadowCasterInfo &info) override;
+
         void onCreate(VulkanContext &ctx, VkRenderPass pass, const std::vector<VkFramebuffer> &fbs) override;
+        bool recordAsyncCompute(FrameContext &frameCtx, VkCommandBuffer cmd) override;
+        void recordPrePass(FrameContext &frameCtx, VkCommandBuffer cmd) override;
         void record(FrameContext &frameCtx, VkCommandBuffer cmd) override;
+        // Opaque/mask/blend groups go to their RenderPhase; the DepthPrepass call also prepares the
+        // frame (slot uploads) for the phases after it. The camera UBO is the renderer's block.
+        bool recordsPhases() const override { return true; }
+        void recordPhase(FrameContext &frameCtx, VkCommandBuffer cmd, RenderPhase phase) override;
         void onResize(VulkanContext &ctx, VkExtent2D newExtent) override;
         void onDestroy(VulkanContext &ctx) override;
 
+        // Per-frame and resident palettes, the other slot/draw buffers and the CPU slot arrays,
+        // under category "Render". Call from the thread that records this pass.
+        void reportMemory(MemoryReport &out) const;
+
     private:
         struct PushConstantsModel
         {
@@ -71,7 +149,7 @@ namespace Engine
 
             // Pad to match GLSL uvec4 nodeInfo
             uint32_t _pad0 = 0;
-            uint32_t _pad1 = 0;
+            uint32_t materialIndex = 0; // nodeInfo.w: BindlessMaterials record (smodel_bindless.frag)
 
             // Skinning info:
             // - skinBaseJoint: base offset into joint palette for this primitive's skin
@@ -95,37 +173,236 @@ namespace Engine
 
         struct CameraFrame
         {
-            VkBuffer buffer = VK_NULL_HANDLE;
-            VkDeviceMemory memory = VK_NULL_HANDLE;
-            void *mapped = nullptr;
             VkDescriptorSet set = VK_NULL_HANDLE;
 
+            // Binding 0 of set/shadowSet: the renderer's CameraBlock (its view/proj prefix is
+            // CameraUBO), a dynamic UBO in the frame upload ring bound at cameraOffset.
+            VkBuffer cameraRingBuffer = VK_NULL_HANDLE; // ring buffer last written into set
+            uint32_t cameraOffset = 0;
+
             // Tracks which active-slot list has been uploaded into this frame's SSBO.
             uint64_t lastUploadedActiveSlotsVersion = 0;
 
             VkBuffer paletteBuffer = VK_NULL_HANDLE;
-            VkDeviceMemory paletteMemory = VK_NULL_HANDLE;
+            GpuAllocation paletteMemory;
             void *paletteMapped = nullptr;
             uint32_t paletteCapacityMatrices = 0;
 
             VkBuffer jointPaletteBuffer = VK_NULL_HANDLE;
-            VkDeviceMemory jointPaletteMemory = VK_NULL_HANDLE;
+            GpuAllocation jointPaletteMemory;
             void *jointPaletteMapped = nullptr;
             uint32_t jointPaletteCapacityMatrices = 0;
 
             VkBuffer instanceWorldBuffer = VK_NULL_HANDLE;
-            VkDeviceMemory instanceWorldMemory = VK_NULL_HANDLE;
+            GpuAllocation instanceWorldMemory;
             void *instanceWorldMapped = nullptr;
             uint32_t instanceWorldCapacitySlots = 0;
 
             VkBuffer activeSlotsBuffer = VK_NULL_HANDLE;
-            VkDeviceMemory activeSlotsMemory = VK_NULL_HANDLE;
+            GpuAllocation activeSlotsMemory;
             void *activeSlotsMapped = nullptr;
             uint32_t activeSlotsCapacity = 0;
 
             // Per-slot incremental upload tracking for this frame's buffers.
             std::vector<uint32_t> uploadedTransformEpoch;
             std::vector<uint32_t> uploadedPoseEpoch;
+
+            // Indirect path: per-draw data SSBO (binding 5) + VkDrawIndexedIndirectCommand array.
+            VkBuffer drawDataBuffer = VK_NULL_HANDLE;
+            GpuAllocation drawDataMemory;
+            void *drawDataMapped = nullptr;
+            uint32_t drawDataCapacity = 0;
+
+            VkBuffer indirectBuffer = VK_NULL_HANDLE;
+            GpuAllocation indirectMemory;
+            void *indirectMapped = nullptr;
+            uint32_t indirectCapacity = 0;
+
+            // Commands are rewritten only when the draw list or the instance count changes.
+            uint64_t lastUploadedDrawListVersion = 0;
+            uint32_t lastUploadedInstanceCount = 0;
+
+            // GPU culling inputs: slot-indexed bounds (vec4) + candidate slot list, and a
+            // device-written visible counter. cullSet binds them for smodel_cull.comp.
+            VkBuffer boundsBuffer = VK_NULL_HANDLE;
+            GpuAllocation boundsMemory;
+            void *boundsMapped = nullptr;
+            uint32_t boundsCapacitySlots = 0;
+
+            VkBuffer candidatesBuffer = VK_NULL_HANDLE;
+            GpuAllocation candidatesMemory;
+            void *candidatesMapped = nullptr;
+            uint32_t candidatesCapacity = 0;
+            uint64_t lastUploadedCandidatesVersion = 0;
+
+            VkBuffer counterBuffer = VK_NULL_HANDLE;
+            GpuAllocation counterMemory;
+
+            VkDescriptorSet cullSet = VK_NULL_HANDLE;
+            VkBuffer cullSetBuffers[6] = {}; // buffers last written into cullSet
+
+            // Resident mode: per-frame staging for changed slots, copied into m_resident.
+            VkBuffer deltaBuffer = VK_NULL_HANDLE;
+            GpuAllocation deltaMemory;
+            void *deltaMapped = nullptr;
+            VkDeviceSize deltaCapacity = 0;
+
+            // Which buffers bindings 1-3 point at: 0 = this frame's own, else m_resident.generation.
+            uint32_t slotBuffersBinding = 0;
+            // recordPrePass() brought m_resident up to date for this frame's active slots.
+            bool residentUploaded = false;
+
+            // GPU pose inputs (uvec4 per evaluated slot) + the set binding them for smodel_pose.comp.
+            VkBuffer poseInputBuffer = VK_NULL_HANDLE;
+            GpuAllocation poseInputMemory;
+            void *poseInputMapped = nullptr;
+            uint32_t poseInputCapacity = 0;
+
+            VkDescriptorSet poseSet = VK_NULL_HANDLE;
+            VkBuffer poseSetBuffers[4] = {}; // buffers last written into poseSet
+
+            // Meshlet culling: frustum/camera UBO (host-visible) for the task and compute stages,
+            // and for the compute path the per-group command arrays + their device-written counts.
+            VkBuffer meshletCullBuffer = VK_NULL_HANDLE;
+            GpuAllocation meshletCullMemory;
+            void *meshletCullMapped = nullptr;
+
+            VkBuffer meshletCommandBuffer = VK_NULL_HANDLE;
+            GpuAllocation meshletCommandMemory;
+            uint32_t meshletCommandCapacity = 0;
+
+            VkBuffer groupCountBuffer = VK_NULL_HANDLE;
+            GpuAllocation groupCountMemory;
+            uint32_t groupCountCapacity = 0;
+
+            VkDescriptorSet meshletSet = VK_NULL_HANDLE;
+            VkBuffer meshletSetBuffers[6] = {}; // buffers last written into meshletSet
+
+            // Shadow casters: per-cascade slot lists back to back (host-visible), binding 4 of
+            // shadowSet. The set uses the camera layout; bindings 1-3 point at m_resident.
+            VkBuffer shadowSlotsBuffer = VK_NULL_HANDLE;
+            GpuAllocation shadowSlotsMemory;
+            void *shadowSlotsMapped = nullptr;
+            uint32_t shadowSlotsCapacity = 0;
+            VkDescriptorSet shadowSet = VK_NULL_HANDLE;
+            VkBuffer shadowSetBuffers[6] = {}; // buffers last written into shadowSet
+            uint32_t shadowFirst[ShadowFrame::MAX_CASCADES] = {};
+            uint32_t shadowCount[ShadowFrame::MAX_CASCADES] = {};
+            // recordPrePass() filled the lists for this frame's cascades.
+            bool shadowPrepared = false;
+
+            // recordPrePass() wrote this frame's meshlet UBO / appended its meshlet commands.
+            bool meshletsPrepared = false;
+            bool meshletCommands = false;
+
+            // Set by recordPrePass() when this frame's active slots were produced on the GPU.
+            bool gpuCulled = false;
+            // recordAsyncCompute() uploaded, posed and culled this frame on the compute queue.
+            bool asyncCulled = false;
+            // recordAsyncCompute() already aged the retired buffers this frame.
+            bool retiredAged = false;
+            // Indirect instance counts were last written by the cull shader (not the CPU).
+            bool indirectGpuCounts = false;
+        };
+
+        // Device-local slot data shared by every frame (resident mode).
+        struct ResidentSlotData
+        {
+            VkBuffer worldBuffer = VK_NULL_HANDLE;
+            GpuAllocation worldMemory;
+            uint32_t worldCapacitySlots = 0;
+
+            VkBuffer paletteBuffer = VK_NULL_HANDLE;
+            GpuAllocation paletteMemory;
+            uint32_t paletteCapacityMatrices = 0;
+
+            VkBuffer jointPaletteBuffer = VK_NULL_HANDLE;
+            GpuAllocation jointPaletteMemory;
+            uint32_t jointPaletteCapacityMatrices = 0;
+
+            VkBuffer boundsBuffer = VK_NULL_HANDLE;
+            GpuAllocation boundsMemory;
+            uint32_t boundsCapacitySlots = 0;
+
+            // Bumped whenever a buffer is replaced; frames rebind when theirs is older.
+            uint32_t generation = 0;
+
+            std::vector<uint32_t> uploadedTransformEpoch;
+            std::vector<uint32_t> uploadedPoseEpoch;
+        };
+
+        // Replaced resident buffer, destroyed once no in-flight frame can reference it.
+        struct RetiredBuffer
+        {
+            VkBuffer buffer = VK_NULL_HANDLE;
+            GpuAllocation memory;
+            uint32_t framesLeft = 0;
+        };
+
+        // Word offsets into the per-model pose data buffer (see smodel_pose.comp).
+        struct PoseDataLayout
+        {
+            uint32_t order = 0;
+            uint32_t rest = 0;
+            uint32_t clipTable = 0;
+            uint32_t samplers = 0;
+            uint32_t times = 0;
+            uint32_t values = 0;
+            uint32_t joints = 0;
+            uint32_t clipCount = 0;
+            uint32_t nodeCount = 0;
+            uint32_t jointCount = 0;
+
+            // Baked palettes (optional): clip table (uvec4 per clip) + frames.
+            uint32_t bakedClips = 0;
+            uint32_t bakedFrames = 0;
+            uint32_t bakedClipCount = 0;
+            float bakedSampleRate = 0.0f;
+        };
+
+        struct SlotAnimation
+        {
+            uint32_t clipIndex = 0;
+            float timeSec = 0.0f;
+            bool baked = false;
+            uint32_t blendFromClip = 0;
+            float blendFromTimeSec = 0.0f;
+            float blendWeight = 1.0f;
+        };
+
+        // One primitive draw of the model, flattened from the node graph once per model.
+        struct StaticDraw
+        {
+            uint32_t pass = 0; // glTF alpha mode: 0=OPAQUE, 1=MASK, 2=BLEND
+            MaterialHandle material{};
+            uint32_t indexCount = 0;
+            uint32_t firstIndex = 0;  // includes the mesh's offset into its (shared) index buffer
+            int32_t vertexOffset = 0; // includes the mesh's offset into its (shared) vertex buffer
+            uint32_t nodeIndex = 0;
+            uint32_t skinBaseJoint = 0;
+            uint32_t skinJointCount = 0;
+            bool textured = true; // material has a base colour texture
+            VkBuffer vertexBuffer = VK_NULL_HANDLE;
+            VkBuffer indexBuffer = VK_NULL_HANDLE;
+            VkIndexType indexType = VK_INDEX_TYPE_UINT16;
+            // ModelAsset::meshlets tiling the draw; 0 when it is not drawn by meshlet.
+            uint32_t firstMeshlet = 0;
+            uint32_t meshletCount = 0;
+        };
+
+        // Consecutive draws (in m_draws) with the same pass + material + skinned/rigid (and all or
+        // none drawn by meshlet): one pipeline permutation and one indirect call.
+        struct DrawGroup
+        {
+            uint32_t pass = 0;
+            MaterialHandle material{};
+            bool skinned = false;
+            bool textured = true;
+            uint32_t firstDraw = 0;
+            uint32_t drawCount = 0;
+            // Range of the group's meshlets in the meshlet data buffer (draw order).
+            uint32_t firstMeshlet = 0;
+            uint32_t meshletCount = 0;
         };
 
         void destroyResources();
@@ -133,15 +410,97 @@ namespace Engine
         bool refreshModelMatrix();
         bool createCameraResources(VulkanContext &ctx, size_t frameCount);
         void destroyCameraResources();
+        bool bindCameraBlock(CameraFrame &frame, const FrameContext &frameCtx);
         bool ensurePaletteCapacity(CameraFrame &frame, uint32_t neededMatrices);
         bool ensureJointPaletteCapacity(CameraFrame &frame, uint32_t neededMatrices);
 
         bool ensureInstanceWorldCapacity(CameraFrame &frame, uint32_t neededSlots);
         bool ensureActiveSlotsCapacity(CameraFrame &frame, uint32_t needed);
+        bool ensureDrawDataCapacity(CameraFrame &frame, uint32_t neededDraws);
+        bool ensureIndirectCapacity(CameraFrame &frame, uint32_t neededDraws);
+        bool ensureCullCapacity(CameraFrame &frame, uint32_t slotCapacity, uint32_t candidates);
+
+        bool createCullResources(VulkanContext &ctx);
+        void destroyCullResources();
+        bool uploadSlotData(CameraFrame &frame, const uint32_t *slots, uint32_t count);
+        // Cull checks, capacities and host writes (no commands); false when the frame CPU-culls.
+        bool prepareSlotCull(CameraFrame &frame, bool resident);
+        // Frustum/occlusion cull and compaction; the barrier to the draws only on graphicsQueue.
+        void dispatchSlotCull(const FrameContext &frameCtx, CameraFrame &frame, VkCommandBuffer cmd, bool graphicsQueue);
+
+        bool ensureResidentBuffer(VkBuffer &buffer, GpuAllocation &memory, uint32_t &capacity,
+                                  uint32_t needed, VkDeviceSize elementSize);
+        bool ensureResidentCapacity(uint32_t slotCapacity);
+        bool shrinkResidentCapacity(uint32_t slotCount);
+        bool ensureDeltaCapacity(CameraFrame &frame, VkDeviceSize bytes);
+        void bindSlotBuffers(CameraFrame &frame, bool resident);
+        // readStages: the stages that read the resident buffers after the copies (the barriers).
+        bool uploadResidentSlotData(CameraFrame &frame, VkCommandBuffer cmd, VkPipelineStageFlags readStages);
+        void releaseRetiredBuffers(bool all);
+        void retireBuffer(VkBuffer &buffer, GpuAllocation &memory);
+
+        bool createPoseResources(VulkanContext &ctx);
+        void destroyPoseResources();
+        bool preparePoseData(VkCommandBuffer cmd);
+        bool buildPoseData(const ModelAsset &model, VkCommandBuffer cmd);
+        bool ensurePoseInputCapacity(CameraFrame &frame, uint32_t needed);
+        void dispatchGpuPoses(CameraFrame &frame, VkCommandBuffer cmd, VkPipelineStageFlags readStages);
+
+        bool createMeshletResources(VulkanContext &ctx);
+        void destroyMeshletResources();
+        bool buildMeshletData(const ModelAsset &model, VkCommandBuffer cmd);
+        bool ensureMeshletCommandCapacity(CameraFrame &frame, uint32_t commands, uint32_t groups);
+        // Meshlet data + this frame's UBO and set; false when the frame draws without meshlets.
+        bool prepareMeshlets(CameraFrame &frame, VkCommandBuffer cmd);
+        bool meshletsInUse(const ModelAsset &model) const;
+        void dispatchMeshletCull(CameraFrame &frame, VkCommandBuffer cmd, uint32_t candidateCount);
+        // Mesh shader launch of the group fits the task workgroup limits.
+        bool meshTasksFit(const DrawGroup &g, uint32_t instanceCount) const;
+        // Shader stages reading slot data: vertex + compute, and task/mesh on the mesh shader path.
+        VkPipelineStageFlags slotReadStages() const;
+        void destroyResidentResources();
+        uint32_t cullCandidatesOnCpu();
+
+        // Shadow casting: slot lists of this frame's cascades, and the depth pipelines for the
+        // shadow render pass (made on first use, when the pass is known).
+        bool ensureShadowSlotsCapacity(CameraFrame &frame, uint32_t needed);
+        void prepareShadowSlots(CameraFrame &frame, const ShadowFrame &shadow);
+        bool createShadowPipelines(const ShadowCasterInfo &info);
+        void destroyShadowPipelines();
+
+        void rebuildDrawList(const ModelAsset &model);
+        void fillPushConstants(PushConstantsModel &pc, const MaterialAsset &mat) const;
+        void bindBindlessSet(VkCommandBuffer cmd, VkPipelineLayout layout) const;
+        void bindReceiverSet(VkCommandBuffer cmd, VkPipelineLayout layout) const;
+        // Bindless: sets pc.materialIndex. Otherwise binds the group's material set.
+        void bindMaterial(VkCommandBuffer cmd, VkPipelineLayout layout, const DrawGroup &g, const MaterialAsset *mat, PushConstantsModel &pc);
+        void writeIndirectCommands(CameraFrame &frame, uint32_t instanceCount, bool gpuCounts);
+        bool prepareFrame(FrameContext &frameCtx);
+        // Permutation drawing the group in the phase; null when the phase skips its pass.
+        const Pipeline *phasePipeline(RenderPhase phase, const DrawGroup &g, bool indirect, bool meshTasks = false) const;
+        // False for the opaque depth prepass (vertex stage only: no material to bind).
+        static bool hasFragmentStage(RenderPhase phase, const DrawGroup &g)
+        {
+            return !(phase == RenderPhase::DepthPrepass && g.pass == 0u);
+        }
+
+        // Specialization constant ids, shared with smodel*.vert / smodel*.frag.
+        static constexpr uint32_t SPEC_ALPHA_MODE = 0;
+        static constexpr uint32_t SPEC_BASE_TEXTURE = 1;
+        static constexpr uint32_t SPEC_SKINNED = 2;
+
+        static uint32_t permutationKey(bool depthPrepass, uint32_t pass, bool skinned, bool textured, bool indirect, bool meshTasks = false)
+        {
+            return pass | (skinned ? 4u : 0u) | (textured ? 8u : 0u) | (depthPrepass ? 16u : 0u) | (indirect ? 32u : 0u) |
+                   (meshTasks ? 64u : 0u);
+        }
+        void recordIndirect(CameraFrame &frame, VkCommandBuffer cmd, uint32_t instanceCount, bool gpuCounts, RenderPhase phase);
+        void recordDirect(CameraFrame *frame, VkCommandBuffer cmd, uint32_t instanceCount, RenderPhase phase);
 
         bool createMaterialResources(VulkanContext &ctx);
         void destroyMaterialResources();
         VkDescriptorSet getOrCreateMaterialSet(MaterialHandle h, const MaterialAsset *mat);
+        void writeMaterialSet(VkDescriptorSet set, const MaterialAsset *mat);
 
         VkPipelineColorBlendStateCreateInfo makeBlendState(bool enableBlend, VkPipelineColorBlendAttachmentState &outAttachment) const;
 
@@ -150,24 +509,128 @@ namespace Engine
         VkPhysicalDevice m_physicalDevice = VK_NULL_HANDLE;
         VkExtent2D m_extent{};
 
+        // Graphics + compute families when the renderer runs async compute: the buffers the
+        // copies, pose dispatch and cull touch are then shared concurrently (count 0 = exclusive).
+        uint32_t m_queueFamilies[2] = {0, 0};
+        uint32_t m_queueFamilyCount = 0;
+
         AssetManager *m_assets = nullptr;
         ModelHandle m_model{};
         Camera *m_camera = nullptr;
 
         bool m_enabled = true;
 
+        // Camera set, material set, shadow receiver set (FrameContext::shadow).
         VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
-        Pipeline m_pipelineOpaque;
-        Pipeline m_pipelineMask;
-        Pipeline m_pipelineBlend;
+        VkDescriptorSetLayout m_receiverSetLayout = VK_NULL_HANDLE;
+
+        // Shadow casters: camera layout (shadowSet), material layout, caster set; keyed by
+        // shadowKey(). Opaque draws are vertex-only, masked ones alpha-test in shadow_mask*.frag.
+        ShadowCaster m_shadowCaster = ShadowCaster::Dynamic;
+        VkPipelineLayout m_shadowPipelineLayout = VK_NULL_HANDLE;
+        PipelinePermutationCache m_shadowPermutations;
+        VkRenderPass m_shadowRenderPass = VK_NULL_HANDLE; // pass the permutations were made for
+        VkPipelineCache m_pipelineCache = VK_NULL_HANDLE;
+        bool m_shadowFailed = false;
+        uint64_t m_modelMatrixVersion = 0; // setModelMatrix() calls, for shadowContentVersion()
+        static uint32_t shadowKey(uint32_t pass, bool skinned, bool textured)
+        {
+            return pass | (skinned ? 4u : 0u) | (textured ? 8u : 0u);
+        }
+
+        // Every pipeline of the pass, by permutationKey(): colour (per alpha pass) and depth
+        // prepass, skinned or rigid, with or without a base texture, direct or indirect.
+        // Depth prepass (RenderPhase::DepthPrepass): opaque has no fragment stage, mask keeps the
+        // fragment shader for its alpha test with colour writes off. The opaque/mask colour
+        // pipelines test LESS_OR_EQUAL so they pass on the depth laid down here.
+        // Indirect variants (smodel_indirect.vert) are only created when the device supports
+        // drawIndirectFirstInstance and the shader is present; otherwise record() draws directly.
+        // Meshlet variants (task + mesh stage) use m_meshPipelineLayout and exist only with mesh
+        // shader support.
+        PipelinePermutationCache m_permutations;
+        bool m_indirectReady = false;
+        bool m_multiDrawIndirect = false;
+
+        // What prepareFrame() decided for this frame; the phases after it draw with it.
+        struct PhaseFrame
+        {
+            CameraFrame *camFrame = nullptr;
+            uint32_t instances = 0;
+            bool gpuCounts = false; // instance counts written by smodel_cull.comp
+            bool indirect = false;
+            bool ready = false;
+            VkDescriptorSet receiverSet = VK_NULL_HANDLE; // FrameContext::shadow, set 2
+        };
+        PhaseFrame m_phaseFrame{};
+
+        // GPU culling (smodel_cull.comp); m_cullReady when the compute pipeline exists.
+        bool m_gpuCulling = false;
+        bool m_cullReady = false;
+        VkDescriptorSetLayout m_cullSetLayout = VK_NULL_HANDLE;
+        VkDescriptorPool m_cullPool = VK_NULL_HANDLE;
+        VkPipelineLayout m_cullPipelineLayout = VK_NULL_HANDLE;
+        VkPipeline m_cullPipeline = VK_NULL_HANDLE;
+
+        // GPU pose evaluation (smodel_pose.comp); m_poseReady when the compute pipeline exists.
+        bool m_gpuPose = false;
+        bool m_poseReady = false;
+        bool m_poseDataFailed = false;
+        bool m_poseDispatchable = false; // this frame's slots may be routed to the dispatch
+        VkDescriptorSetLayout m_poseSetLayout = VK_NULL_HANDLE;
+        VkDescriptorPool m_posePool = VK_NULL_HANDLE;
+        VkPipelineLayout m_posePipelineLayout = VK_NULL_HANDLE;
+        VkPipeline m_posePipeline = VK_NULL_HANDLE;
+
+        // Meshlet culling. Set 3 of the mesh shader pipelines (m_meshPipelineLayout: camera,
+        // material, receiver, meshlet set) and set 1 of smodel_meshlet_cull.comp. m_meshletStages: the
+        // stages reading the camera and meshlet sets besides the vertex shader.
+        bool m_meshletCulling = true;
+        bool m_meshShaderReady = false;
+        bool m_meshletComputeReady = false;
+        VkShaderStageFlags m_meshletStages = 0;
+        VkDescriptorSetLayout m_meshletSetLayout = VK_NULL_HANDLE;
+        VkDescriptorPool m_meshletPool = VK_NULL_HANDLE;
+        VkPipelineLayout m_meshPipelineLayout = VK_NULL_HANDLE;
+        VkPipelineLayout m_meshletCullPipelineLayout = VK_NULL_HANDLE;
+        VkPipeline m_meshletCullPipeline = VK_NULL_HANDLE;
+        PFN_vkCmdDrawMeshTasksEXT m_cmdDrawMeshTasks = nullptr;
+        PFN_vkCmdDrawIndexedIndirectCountKHR m_cmdDrawIndexedIndirectCount = nullptr;
+        uint32_t m_maxTaskWorkGroupCount[2] = {0, 0};
+        uint32_t m_maxTaskWorkGroupTotal = 0;
+        uint32_t m_maxComputeWorkGroupCountY = 0;
+
+        // Device-local meshlet records + vertex/triangle tables of the current draw list.
+        VkBuffer m_meshletDataBuffer = VK_NULL_HANDLE;
+        GpuAllocation m_meshletDataMemory;
+        uint64_t m_meshletDataVersion = 0; // m_drawListVersion the buffer was built for
+        uint32_t m_meshletRecordCount = 0;
+        bool m_meshletDataFailed = false;
+        std::vector<uint32_t> m_meshletWords;
+
+        // Device-local clip/hierarchy/skin tables for m_poseDataModel.
+        VkBuffer m_poseDataBuffer = VK_NULL_HANDLE;
+        GpuAllocation m_poseDataMemory;
+        const ModelAsset *m_poseDataModel = nullptr;
+        PoseDataLayout m_poseLayout{};
+        std::vector<uint32_t> m_poseWords;
 
         VkDescriptorSetLayout m_cameraSetLayout = VK_NULL_HANDLE;
         VkDescriptorPool m_cameraPool = VK_NULL_HANDLE;
         std::vector<CameraFrame> m_cameraFrames;
 
+        // Global bindless table when the device has descriptor indexing: bound once as set 1, and
+        // the per-material sets below stay empty.
+        BindlessMaterials *m_bindless = nullptr; // not owned
+
         VkDescriptorSetLayout m_materialSetLayout = VK_NULL_HANDLE;
         VkDescriptorPool m_materialPool = VK_NULL_HANDLE;
-        std::unordered_map<uint64_t, VkDescriptorSet> m_materialSetCache;
+        // Sets are rewritten in place when AssetManager::textureViewEpoch() moves (texture residency).
+        struct CachedMaterialSet
+        {
+            VkDescriptorSet set = VK_NULL_HANDLE;
+            uint32_t textureEpoch = 0;
+        };
+        std::unordered_map<uint64_t, CachedMaterialSet> m_materialSetCache;
 
         // Slot-based CPU-side data (indexed by stable slot index).
         uint32_t m_slotNodeCount = 0;
@@ -180,6 +643,13 @@ namespace Engine
         std::vector<uint32_t> m_slotTransformEpoch;
         uint32_t m_transformEpochCounter = 1;
 
+        // World bounding spheres per slot (xyz=center, w=radius); shares the transform epoch.
+        std::vector<glm::vec4> m_slotBounds;
+        // CPU fallback for GPU culling: visible subset of m_activeSlots this frame.
+        std::vector<uint32_t> m_cpuCulledSlots;
+        // Per-cascade caster lists of this frame, staged for CameraFrame::shadowSlotsBuffer.
+        std::vector<uint32_t> m_shadowSlots;
+
         // Flattened node globals: [slot][node]
         std::vector<glm::mat4> m_nodePalette;
         // Flattened joint matrices: [slot][joint]
@@ -187,6 +657,31 @@ namespace Engine
         std::vector<uint32_t> m_slotPoseEpoch;
         uint32_t m_poseEpochCounter = 1;
 
+        // Per slot: 1 = pose comes from setSlotAnimation() (GPU), 0 = CPU palettes above.
+        std::vector<uint8_t> m_slotGpuPose;
+        std::vector<SlotAnimation> m_slotAnimations;
+        // Slots evaluated by this frame's pose dispatch (filled by uploadResidentSlotData).
+        std::vector<uint32_t> m_gpuPoseSlots;
+
+        // Resident slot data + scratch for the per-frame delta copies.
+        bool m_residentSlotData = true;
+        bool m_residentAwaitingCompute = false; // next async frame waits for the graphics submit's copies
+        ResidentSlotData m_resident;
+        std::vector<RetiredBuffer> m_retiredBuffers;
+        std::vector<VkBufferCopy> m_worldCopies;
+        std::vector<VkBufferCopy> m_boundsCopies;
+        std::vector<VkBufferCopy> m_paletteCopies;
+        std::vector<VkBufferCopy> m_jointCopies;
+
+        // Static draw list for the current model (rebuilt when the model changes).
+        std::vector<StaticDraw> m_draws;
+        std::vector<DrawGroup> m_drawGroups;
+        const ModelAsset *m_drawListModel = nullptr;
+        uint32_t m_lod = 0;
+        size_t m_drawListPrimitiveCount = 0;
+        uint64_t m_drawListVersion = 0;
+        bool m_drawsShareBuffers = false; // every draw uses the same VB/IB (merged model upload)
+
         TextureAsset m_fallbackWhiteTexture;
 
         PushConstantsModel m_pc{};
@@ -0,0 +1,231 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+#include "utils/GpuAllocator.h"
+
+namespace Engine
+{
+    class VulkanContext;
+    class Camera;
+
+    // Which shadow map a RenderPassModule draws into (RenderPassModule::shadowCaster()).
+    enum class ShadowCaster : uint32_t
+    {
+        None = 0,
+        Static,  // cached: redrawn only when its cascade moves or the pass's content version changes
+        Dynamic, // overlay: cleared and redrawn every frame
+    };
+
+    // Handed to RenderPassModule::recordShadow() inside a cascade's depth-only render pass.
+    // Caster pipelines are made against renderPass (same for every cascade and both maps) and
+    // bind `set` with setLayout: binding 0 = the ShadowUBO below (vertex stage), so a shader
+    // picks viewProj[cascade].
+    struct ShadowCasterInfo
+    {
+        VkRenderPass renderPass = VK_NULL_HANDLE;
+        VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;
+        VkDescriptorSet set = VK_NULL_HANDLE;
+        glm::mat4 viewProj{1.0f};
+        uint32_t cascade = 0;
+        ShadowCaster layer = ShadowCaster::None;
+        VkExtent2D extent{};
+        // Depth bias for caster pipelines (dynamic state is not used).
+        float depthBiasConstant = 0.0f;
+        float depthBiasSlope = 0.0f;
+    };
+
+    // This frame's cascades, set on FrameContext::shadow before the renderer calls recordPrePass().
+    // Receivers bind receiverSet (ShadowCascades::createReceiverSetLayout) and sample both maps.
+    struct ShadowFrame
+    {
+        static constexpr uint32_t MAX_CASCADES = 4;
+
+        VkDescriptorSet receiverSet = VK_NULL_HANDLE;
+        uint32_t cascadeCount = 0; // 0 = shadows off (receivers still bind the set)
+        uint32_t staticMask = 0;   // cascades whose static map is redrawn this frame
+        bool dynamic = false;      // the dynamic overlay is redrawn this frame
+        glm::mat4 viewProj[MAX_CASCADES];
+        // Light-space extent per cascade, for casterVisible(): 1/half width and 1/depth range.
+        float invHalfExtent[MAX_CASCADES] = {};
+        float invDepthRange[MAX_CASCADES] = {};
+
+        // True when a caster layer of this pass is drawn this frame.
+        bool draws(ShadowCaster layer) const
+        {
+            if (cascadeCount == 0)
+                return false;
+            return layer == ShadowCaster::Static ? staticMask != 0u : (layer == ShadowCaster::Dynamic && dynamic);
+        }
+
+        // Conservative world sphere vs cascade box test for caster culling.
+        bool casterVisible(uint32_t cascade, const glm::vec3 &center, float radius) const
+        {
+            const glm::vec4 p = viewProj[cascade] * glm::vec4(center, 1.0f);
+            const float rx = radius * invHalfExtent[cascade];
+            const float rz = radius * invDepthRange[cascade];
+            return p.x >= -1.0f - rx && p.x <= 1.0f + rx &&
+                   p.y >= -1.0f - rx && p.y <= 1.0f + rx &&
+                   p.z >= -rz && p.z <= 1.0f + rz;
+        }
+    };
+
+    // ============================================================
+    // ShadowCascades
+    // ============================================================
+    // Cascaded shadow maps for one directional light, owned by the Renderer.
+    //
+    // Every cascade has two depth layers: a static map holding ShadowCaster::Static passes
+    // (obstacles, props), cached over frames, and a dynamic overlay holding Dynamic passes
+    // (units), redrawn each frame. Receivers take the darker of the two.
+    //
+    // Cascades are fitted to bounding spheres of the camera frustum slices (so their size does
+    // not change when the camera turns) and the sphere centers are snapped in light space to a
+    // grid CACHE_SNAP_TEXELS texels wide, the radius padded by one grid step. A cascade's matrix
+    // therefore only changes when the camera crosses a grid line, and its static map is redrawn
+    // then, or when a static pass reports new content (shadowContentVersion()). The overlay uses
+    // the same matrices. The light direction or camera projection changing redraws everything.
+    class ShadowCascades
+    {
+    public:
+        // =====================
+        // TUNING CONSTANTS
+        // =====================
+        static constexpr uint32_t MAX_CASCADES = ShadowFrame::MAX_CASCADES;
+        static constexpr uint32_t DEFAULT_CASCADES = 4;
+        static constexpr uint32_t DEFAULT_RESOLUTION = 2048;
+        static constexpr float DEFAULT_DISTANCE = 250.0f; // meters covered by the last cascade
+        static constexpr float SPLIT_LAMBDA = 0.75f;      // practical split: 1 = logarithmic, 0 = uniform
+        static constexpr uint32_t CACHE_SNAP_TEXELS = 64; // cascade centers move in steps of this many texels
+        static constexpr float CASTER_EXTENT = 100.0f;    // meters above a cascade's sphere still casting into it
+        static constexpr float DEPTH_BIAS_CONSTANT = 2.0f;
+        static constexpr float DEPTH_BIAS_SLOPE = 2.5f;
+        static constexpr float NORMAL_OFFSET_TEXELS = 1.5f; // receiver offset along the normal
+
+        ShadowCascades() = default;
+        ~ShadowCascades();
+        ShadowCascades(const ShadowCascades &) = delete;
+        ShadowCascades &operator=(const ShadowCascades &) = delete;
+
+        // Maps, render pass, sampler and per-frame sets. False on failure (nothing left created).
+        bool create(VulkanContext &ctx, uint32_t frameCount);
+        void destroy();
+        bool created() const { return m_renderPass != VK_NULL_HANDLE; }
+
+        // Layout of ShadowFrame::receiverSet: binding 0 = ShadowUBO, 1 = static map array,
+        // 2 = dynamic map array (sampler2DArrayShadow), fragment stage. Passes create their own
+        // copy for their pipeline layouts (identically defined layouts are compatible).
+        static VkResult createReceiverSetLayout(VkDevice device, VkDescriptorSetLayout &outLayout);
+
+        // Off: cascadeCount is 0 and receivers are fully lit.
+        void setEnabled(bool enable) { m_enabled = enable; }
+        bool isEnabled() const { return m_enabled; }
+        void setCamera(const Camera *camera) { m_camera = camera; }
+        // Direction toward the light (world space); also the receivers' lighting direction.
+        void setLightDirection(const glm::vec3 &towardLight);
+        const glm::vec3 &lightDirection() const { return m_lightDir; }
+        void setDistance(float meters);
+        float distance() const { return m_distance; }
+        void setCascadeCount(uint32_t count);
+        uint32_t cascadeCount() const { return m_cascadeCount; }
+        // Map size in texels; takes effect at the next create().
+        void setResolution(uint32_t texels) { m_resolution = texels < 256u ? 256u : texels; }
+        uint32_t resolution() const { return m_resolution; }
+
+        // Fits this frame's cascades and writes the frame slot's UBO. staticVersion combines the
+        // content versions of every static pass; hasDynamic is true when any pass is a Dynamic
+        // caster. Call once per frame after the slot's fence was waited on.
+        const ShadowFrame &beginFrame(uint32_t frameIndex, uint64_t staticVersion, bool hasDynamic);
+
+        // Render pass of one cascade layer (clears it); casters record between the two calls.
+        // begin returns the info to hand to RenderPassModule::recordShadow().
+        ShadowCasterInfo beginCascade(VkCommandBuffer cmd, uint32_t frameIndex, uint32_t cascade, ShadowCaster layer);
+        void endCascade(VkCommandBuffer cmd);
+        // After the static cascades in staticMask were drawn: they are cached from now on.
+        void markStaticDrawn(uint32_t staticMask);
+
+        struct Stats
+        {
+            uint64_t staticRedraws = 0; // cascade layers redrawn so far
+            uint64_t dynamicRedraws = 0;
+        };
+        const Stats &stats() const { return m_stats; }
+
+    private:
+        struct ShadowUBO
+        {
+            glm::mat4 viewProj[MAX_CASCADES];
+            glm::vec4 lightDir;   // xyz = toward the light, w = cascade count
+            glm::vec4 params;     // x = 1 / resolution, y = normal offset (texels)
+            glm::vec4 texelWorld; // world size of one texel per cascade
+        };
+
+        struct FrameSlot
+        {
+            VkBuffer buffer = VK_NULL_HANDLE;
+            GpuAllocation memory;
+            VkDescriptorSet casterSet = VK_NULL_HANDLE;
+            VkDescriptorSet receiverSet = VK_NULL_HANDLE;
+        };
+
+        // Snapped light-space placement of one cascade; the static map is valid for one key.
+        struct CascadeKey
+        {
+            int64_t x = 0;
+            int64_t y = 0;
+            int64_t z = 0;
+            float radius = 0.0f;
+            bool operator==(const CascadeKey &o) const { return x == o.x && y == o.y && z == o.z && radius == o.radius; }
+            bool operator!=(const CascadeKey &o) const { return !(*this == o); }
+        };
+
+        struct DepthArray
+        {
+            VkImage image = VK_NULL_HANDLE;
+            GpuAllocation memory;
+            VkImageView arrayView = VK_NULL_HANDLE; // sampled
+            VkImageView layerViews[MAX_CASCADES] = {};
+            VkFramebuffer framebuffers[MAX_CASCADES] = {};
+        };
+
+        bool createDepthArray(DepthArray &arr);
+        void destroyDepthArray(DepthArray &arr);
+        bool createRenderPass();
+        bool createDescriptors(uint32_t frameCount);
+        bool clearAllLayers(VulkanContext &ctx);
+        void fitCascades();
+
+        VkDevice m_device = VK_NULL_HANDLE;
+        VkPhysicalDevice m_physicalDevice = VK_NULL_HANDLE;
+
+        const Camera *m_camera = nullptr;
+        bool m_enabled = true;
+        glm::vec3 m_lightDir = glm::normalize(glm::vec3(0.3f, 0.7f, 0.2f)); // the shaders' former fixed light
+        float m_distance = DEFAULT_DISTANCE;
+        uint32_t m_cascadeCount = DEFAULT_CASCADES;
+        uint32_t m_resolution = DEFAULT_RESOLUTION;
+
+        VkFormat m_format = VK_FORMAT_D16_UNORM;
+        VkRenderPass m_renderPass = VK_NULL_HANDLE;
+        DepthArray m_static;
+        DepthArray m_dynamic;
+        VkSampler m_sampler = VK_NULL_HANDLE;
+
+        VkDescriptorSetLayout m_casterSetLayout = VK_NULL_HANDLE;
+        VkDescriptorSetLayout m_receiverSetLayout = VK_NULL_HANDLE;
+        VkDescriptorPool m_pool = VK_NULL_HANDLE;
+        std::vector<FrameSlot> m_slots;
+
+        ShadowFrame m_frame{};
+        float m_texelWorld[MAX_CASCADES] = {};
+        CascadeKey m_keys[MAX_CASCADES];
+        CascadeKey m_cachedKeys[MAX_CASCADES];
+        uint32_t m_cachedMask = 0;       // cascades whose static map matches m_cachedKeys
+        uint64_t m_cachedStaticVersion = 0;
+        bool m_dynamicDirty = false;     // the overlay holds casters from an earlier frame
+
+        Stats m_stats{};
+    };
+} // namespace Engine
@@ -0,0 +1,373 @@
+#pragma once
+#include "Engine/Renderer.h"
+#include "Engine/Pipeline.h"
+#include "assets/AssetManager.h"
+#include "assets/TextureAsset.h"
+#include "Engine/Camera.h"
+#include "utils/MemoryReport.h"
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <unordered_map>
+
+namespace Engine
+{
+    class BindlessMaterials;
+
+    // ------------------------------------------------------------
+    // Instanced renderer for static props (trees, grass, fences) of one model.
+    //
+    // - No pose, palette or per-frame slot list: setInstance() stores the world matrix and world
+    //   bounding sphere once, and recordPrePass() uploads the instance table into a device-local
+    //   buffer only after instances were added, moved or removed.
+    // - Instances are bucketed into CELL_SIZE x CELL_SIZE cells on XZ. staticprop_cull.comp runs
+    //   one workgroup per cell: the cell sphere is tested first and only cells that pass test
+    //   their instances, so a far or off-screen forest costs one sphere test per cell.
+    // - Instances fade out between the fade distances (dithered discard) and are culled past
+    //   the end distance.
+    // - Draws every primitive with one indirect command whose instance count the cull shader
+    //   writes; phases follow SModelRenderPassModule (depth prepass, opaque, mask, blend).
+    // - With Renderer async compute the cull runs on the compute queue (recordAsyncCompute()),
+    //   except in frames that upload the instance table.
+    // - Models cooked with an octahedral impostor (GltfToSmodel --impostor) switch to one
+    //   camera-facing quad per instance past the impostor distance: the cull shader splits
+    //   visible instances into a mesh list and an impostor list, dithered across a short
+    //   cross-fade band, and the impostors draw with one non-indexed indirect command.
+    // - Needs the compute cull shader; without it the pass stays disabled (there is no CPU path).
+    // - Casts into the cached static shadow maps (Renderer::shadows()): per cascade, the cells
+    //   whose sphere touches it draw their instances directly; redrawn after instance uploads.
+    // ------------------------------------------------------------
+    class StaticPropRenderPassModule : public RenderPassModule
+    {
+    public:
+        // =====================
+        // TUNING CONSTANTS
+        // =====================
+        static constexpr float CELL_SIZE = 32.0f;          // meters: cull cell edge on XZ
+        static constexpr uint32_t CULL_GROUP_SIZE = 64;    // staticprop_cull.comp local size
+        static constexpr float DEFAULT_FADE_START = 250.0f;
+        static constexpr float DEFAULT_FADE_END = 300.0f;
+        static constexpr float DEFAULT_IMPOSTOR_START = 120.0f; // meters: impostors fade in here
+        static constexpr float DEFAULT_IMPOSTOR_BLEND = 20.0f;  // meters: mesh/impostor cross-fade
+
+        struct Stats
+        {
+            uint32_t instances = 0; // live instances
+            uint32_t cells = 0;     // non-empty cells
+            uint32_t uploads = 0;   // instance table uploads so far
+            uint64_t uploadBytes = 0;
+        };
+
+        StaticPropRenderPassModule() = default;
+        ~StaticPropRenderPassModule() override;
+
+        const char *getDebugName() const override { return "StaticProps"; }
+
+        void setEnabled(bool en) { m_enabled = en; }
+        void setAssets(AssetManager *assets) { m_assets = assets; }
+        void setModel(ModelHandle h)
+        {
+            m_model = h;
+            m_drawListModel = nullptr; // rebuild draw list on next record
+        }
+        void setCamera(Camera *cam) { m_camera = cam; }
+        // Static shadow caster (default on); needs staticprop_shadow.vert.
+        void setCastShadows(bool cast) { m_castShadows = cast; }
+
+        // Instances fade from fully drawn at start to gone at end (meters from the camera).
+        void setFadeDistances(float start, float end);
+        // Impostor instances from start on; the full mesh is gone by start + blend. start <= 0
+        // draws full meshes at every distance. No effect on models without an impostor.
+        void setImpostorDistance(float start, float blend);
+
+        // Instance indices are chosen by the caller (dense, reused after removeInstance()).
+        void setInstance(uint32_t index, const glm::mat4 &world, const glm::vec3 &worldCenter, float worldRadius);
+        void removeInstance(uint32_t index);
+        uint32_t instanceCapacity() const { return static_cast<uint32_t>(m_instances.size()); }
+
+        // False when the cull shader is missing (the pass draws nothing).
+        bool ready() const { return m_cullReady; }
+        // False when the impostor shaders are missing (full meshes at every distance).
+        bool impostorsReady() const { return m_impostorReady; }
+        const Stats &stats() const { return m_stats; }
+
+        void onCreate(VulkanContext &ctx, VkRenderPass pass, const std::vector<VkFramebuffer> &fbs) override;
+        bool recordAsyncCompute(FrameContext &frameCtx, VkCommandBuffer cmd) override;
+        void recordPrePass(FrameContext &frameCtx, VkCommandBuffer cmd) override;
+        void record(FrameContext &frameCtx, VkCommandBuffer cmd) override;
+        void latchCamera(FrameContext &frameCtx) override;
+        bool recordsPhases() const override { return true; }
+        void recordPhase(FrameContext &frameCtx, VkCommandBuffer cmd, RenderPhase phase) override;
+        void onResize(VulkanContext &ctx, VkExtent2D newExtent) override;
+        void onDestroy(VulkanContext &ctx) override;
+
+        ShadowCaster shadowCaster() const override;
+        uint64_t shadowContentVersion() const override;
+        void recordShadow(FrameContext &frameCtx, VkCommandBuffer cmd, const ShadowCasterInfo &info) override;
+
+        // Resident instance/cell buffers, per-frame buffers and the CPU tables, under category
+        // "Render". Call from the thread that records this pass.
+        void reportMemory(MemoryReport &out) const;
+
+    private:
+        // std430 layouts (staticprop.vert / staticprop_cull.comp).
+        struct GpuInstance
+        {
+            glm::mat4 world;
+            glm::vec4 sphere; // xyz=world center, w=radius (< 0: removed)
+        };
+        struct GpuCell
+        {
+            glm::vec4 sphere;   // bounds of the cell's instance spheres
+            uint32_t first = 0; // into the cell-sorted instance list
+            uint32_t count = 0;
+            uint32_t _pad[2] = {};
+        };
+        static_assert(sizeof(GpuInstance) == 80, "GpuInstance must match the shaders' std430 layout");
+        static_assert(sizeof(GpuCell) == 32, "GpuCell must match staticprop_cull.comp");
+
+        struct PushConstantsProp
+        {
+            float node[16]; // model fit * node global
+            float baseColorFactor[4];
+            float materialParams[4]; // x=alphaCutoff, y=alphaMode
+            uint32_t materialIndex = 0; // BindlessMaterials record (staticprop_bindless.frag)
+            uint32_t _pad[3] = {};
+        };
+        static_assert(sizeof(PushConstantsProp) == 112, "PushConstantsProp must match the staticprop shaders");
+
+        struct PushConstantsImpostor
+        {
+            float fit[16];
+            float sphere[4];    // xyz=capture center, w=radius (model space)
+            uint32_t info[4] = {}; // x=frames per side, y=smodel::ImpostorMapping, z=bindless material index
+        };
+        static_assert(sizeof(PushConstantsImpostor) == 96, "PushConstantsImpostor must match staticprop_impostor.vert");
+
+        // staticprop_shadow.vert / shadow_mask*.frag: laid out like SModel's block up to its
+        // nodeInfo, so the mask shaders serve both passes.
+        struct PushConstantsShadow
+        {
+            float node[16];
+            float baseColorFactor[4];
+            float materialParams[4];
+            uint32_t info[4] = {}; // z=cascade, w=bindless material index
+        };
+        static_assert(sizeof(PushConstantsShadow) == 112, "PushConstantsShadow must match staticprop_shadow.vert");
+
+        struct CameraUBO
+        {
+            glm::mat4 view;
+            glm::mat4 proj;
+            glm::vec4 cameraPos;
+            glm::vec4 fade; // x=fade end, y=1/(end-start), z=mesh end (impostors), w=1/cross-fade
+        };
+
+        struct FrameData
+        {
+            // Camera UBO: this frame's allocation in the renderer's upload ring (dynamic offset),
+            // written by latchCamera(); cameraRingBuffer is the buffer last written into drawSet.
+            VkBuffer cameraRingBuffer = VK_NULL_HANDLE;
+            uint32_t cameraOffset = 0;
+            void *cameraMapped = nullptr;
+
+            // Visible instance ids, written by the cull shader (device-local).
+            VkBuffer visibleBuffer = VK_NULL_HANDLE;
+            GpuAllocation visibleMemory;
+            uint32_t visibleCapacity = 0;
+            // Impostor instance ids (same capacity).
+            VkBuffer impostorVisibleBuffer = VK_NULL_HANDLE;
+            GpuAllocation impostorVisibleMemory;
+
+            // One command per draw plus the impostor's VkDrawIndirectCommand after them; the
+            // cull shader writes instanceCount.
+            VkBuffer indirectBuffer = VK_NULL_HANDLE;
+            GpuAllocation indirectMemory;
+            void *indirectMapped = nullptr;
+            uint32_t indirectCapacity = 0;
+            uint64_t uploadedDrawListVersion = 0;
+
+            VkBuffer counterBuffer = VK_NULL_HANDLE;
+            GpuAllocation counterMemory;
+
+            VkDescriptorSet drawSet = VK_NULL_HANDLE;
+            VkDescriptorSet cullSet = VK_NULL_HANDLE;
+            // Shadow casters: instances + cell-sorted ids (rewritten when the generation moves).
+            VkDescriptorSet shadowSet = VK_NULL_HANDLE;
+            uint32_t boundShadowGeneration = 0;
+            // Resident generation + visible buffer the sets were last written with.
+            uint32_t boundGeneration = 0;
+            VkBuffer boundVisible = VK_NULL_HANDLE;
+            VkBuffer boundImpostorVisible = VK_NULL_HANDLE;
+            VkBuffer boundIndirect = VK_NULL_HANDLE;
+
+            // recordPrePass() culled this frame; the phases draw.
+            bool culled = false;
+            // recordAsyncCompute() recorded this frame's cull on the compute queue.
+            bool asyncCulled = false;
+        };
+
+        // Replaced resident buffer, destroyed once no in-flight frame can reference it.
+        struct RetiredBuffer
+        {
+            VkBuffer buffer = VK_NULL_HANDLE;
+            GpuAllocation memory;
+            uint32_t framesLeft = 0;
+        };
+
+        // One primitive draw of the model, flattened from the node graph once per model.
+        struct PropDraw
+        {
+            uint32_t pass = 0; // glTF alpha mode: 0=OPAQUE, 1=MASK, 2=BLEND
+            MaterialHandle material{};
+            uint32_t indexCount = 0;
+            uint32_t firstIndex = 0;
+            int32_t vertexOffset = 0;
+            glm::mat4 node{1.0f}; // model fit * node global
+            VkBuffer vertexBuffer = VK_NULL_HANDLE;
+            VkBuffer indexBuffer = VK_NULL_HANDLE;
+            VkIndexType indexType = VK_INDEX_TYPE_UINT16;
+        };
+
+        bool createFrameResources(VulkanContext &ctx, size_t frameCount);
+        void destroyFrameResources();
+        bool createMaterialResources(VulkanContext &ctx);
+        void destroyMaterialResources();
+        VkDescriptorSet getOrCreateMaterialSet(MaterialHandle h, const MaterialAsset *mat);
+        void writeMaterialSet(VkDescriptorSet set, const MaterialAsset *mat);
+        void createPipelines(VulkanContext &ctx, VkRenderPass pass);
+        bool createImpostorResources(VulkanContext &ctx, VkRenderPass pass);
+        void destroyImpostorResources();
+        VkDescriptorSet impostorMaterialSet(const MaterialAsset *mat);
+        bool impostorsActive() const;
+        void recordImpostors(FrameData &frame, VkCommandBuffer cmd);
+        bool createCullResources(VulkanContext &ctx);
+        void destroyCullResources();
+        bool createShadowPipelines(const ShadowCasterInfo &info);
+        void destroyShadowPipelines();
+        void destroyResources();
+
+        void rebuildDrawList(const ModelAsset &model);
+        void rebuildCells();
+        bool uploadInstances(VkCommandBuffer cmd);
+        bool ensureResidentBuffer(VkBuffer &buffer, GpuAllocation &memory, VkDeviceSize &capacity, VkDeviceSize needed);
+        bool ensureFrameCapacity(FrameData &frame, uint32_t instances, uint32_t draws);
+        void bindFrameSets(FrameData &frame);
+        bool allocateCameraUBO(FrameContext &frameCtx, FrameData &frame);
+        bool canCull(const FrameData &frame);
+        bool prepareFrameCull(FrameData &frame);
+        // Counter reset + both cull dispatches. graphicsQueue adds the barrier to the draws.
+        void recordCull(FrameData &frame, VkCommandBuffer cmd, bool graphicsQueue);
+        void retireBuffer(VkBuffer &buffer, GpuAllocation &memory);
+        void releaseRetiredBuffers(bool all);
+        const Pipeline *phasePipeline(RenderPhase phase, uint32_t pass) const;
+
+    private:
+        VkDevice m_device = VK_NULL_HANDLE;
+        VkPhysicalDevice m_physicalDevice = VK_NULL_HANDLE;
+        VkExtent2D m_extent{};
+
+        // Graphics + compute families when the renderer can cull on the async compute queue:
+        // buffers the cull touches are then shared concurrently (count 0 = exclusive).
+        uint32_t m_queueFamilies[2] = {0, 0};
+        uint32_t m_queueFamilyCount = 0;
+
+        AssetManager *m_assets = nullptr;
+        ModelHandle m_model{};
+        Camera *m_camera = nullptr;
+        bool m_enabled = true;
+
+        float m_fadeStart = DEFAULT_FADE_START;
+        float m_fadeEnd = DEFAULT_FADE_END;
+        float m_impostorStart = DEFAULT_IMPOSTOR_START;
+        float m_impostorBlend = DEFAULT_IMPOSTOR_BLEND;
+
+        // Draw set, material set, shadow receiver set (FrameContext::shadow).
+        VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+        VkDescriptorSetLayout m_receiverSetLayout = VK_NULL_HANDLE;
+        Pipeline m_pipelineOpaque;
+        Pipeline m_pipelineMask;
+        Pipeline m_pipelineBlend;
+        // Depth prepass of opaque + masked draws. Keeps the fragment shader: the distance fade
+        // discards in every pass.
+        Pipeline m_pipelineDepth;
+
+        // Impostor quads (Mask phase). Own layout: its set 1 holds two atlases without bindless.
+        bool m_impostorReady = false;
+        VkPipelineLayout m_impostorPipelineLayout = VK_NULL_HANDLE;
+        Pipeline m_pipelineImpostor;
+        VkDescriptorSetLayout m_impostorSetLayout = VK_NULL_HANDLE;
+        VkDescriptorPool m_impostorPool = VK_NULL_HANDLE;
+        VkDescriptorSet m_impostorSet = VK_NULL_HANDLE;
+        uint64_t m_impostorSetMaterial = 0; // MaterialHandle::id last written into m_impostorSet
+        uint32_t m_impostorSetEpoch = 0;
+
+        // Shadow casters: shadow set, material set, caster set. Made on first use against the
+        // shadow render pass; masked draws alpha-test in shadow_mask*.frag when it exists.
+        bool m_castShadows = true;
+        bool m_shadowFailed = false;
+        VkPipelineCache m_pipelineCache = VK_NULL_HANDLE;
+        VkRenderPass m_shadowRenderPass = VK_NULL_HANDLE;
+        VkDescriptorSetLayout m_shadowSetLayout = VK_NULL_HANDLE;
+        VkPipelineLayout m_shadowPipelineLayout = VK_NULL_HANDLE;
+        Pipeline m_pipelineShadow;
+        Pipeline m_pipelineShadowMask;
+        bool m_shadowMaskReady = false;
+        std::vector<uint32_t> m_shadowRuns; // recordShadow() scratch: first, count per run of cells
+
+        bool m_cullReady = false;
+        VkDescriptorSetLayout m_cullSetLayout = VK_NULL_HANDLE;
+        VkPipelineLayout m_cullPipelineLayout = VK_NULL_HANDLE;
+        VkPipeline m_cullPipeline = VK_NULL_HANDLE;
+
+        VkDescriptorSetLayout m_drawSetLayout = VK_NULL_HANDLE;
+        VkDescriptorPool m_framePool = VK_NULL_HANDLE;
+        std::vector<FrameData> m_frames;
+
+        BindlessMaterials *m_bindless = nullptr; // not owned
+        VkDescriptorSetLayout m_materialSetLayout = VK_NULL_HANDLE;
+        VkDescriptorPool m_materialPool = VK_NULL_HANDLE;
+        // Sets are rewritten in place when AssetManager::textureViewEpoch() moves (texture residency).
+        struct CachedMaterialSet
+        {
+            VkDescriptorSet set = VK_NULL_HANDLE;
+            uint32_t textureEpoch = 0;
+        };
+        std::unordered_map<uint64_t, CachedMaterialSet> m_materialSetCache;
+        TextureAsset m_fallbackWhiteTexture;
+
+        // CPU instance table (index = caller's instance id) and the cell layout built from it.
+        std::vector<GpuInstance> m_instances;
+        std::vector<uint32_t> m_cellInstances; // live instance ids sorted by cell
+        std::vector<GpuCell> m_cells;
+        std::vector<uint64_t> m_cellKeys;      // rebuildCells() scratch: cell key << 32 | instance
+        uint32_t m_liveInstances = 0;
+        bool m_instancesDirty = false;
+        bool m_uploadAwaitingCompute = false; // next async cull waits for the upload's graphics submit
+
+        // Device-local copies, replaced (and retired) when they need to grow.
+        VkBuffer m_instanceBuffer = VK_NULL_HANDLE;
+        GpuAllocation m_instanceMemory;
+        VkDeviceSize m_instanceBytes = 0;
+        VkBuffer m_cellInstanceBuffer = VK_NULL_HANDLE;
+        GpuAllocation m_cellInstanceMemory;
+        VkDeviceSize m_cellInstanceBytes = 0;
+        VkBuffer m_cellBuffer = VK_NULL_HANDLE;
+        GpuAllocation m_cellMemory;
+        VkDeviceSize m_cellBytes = 0;
+        uint32_t m_uploadedCells = 0;
+        uint32_t m_generation = 1; // bumped when a resident buffer is replaced
+        std::vector<RetiredBuffer> m_retiredBuffers;
+
+        std::vector<PropDraw> m_draws;
+        const ModelAsset *m_drawListModel = nullptr;
+        size_t m_drawListPrimitiveCount = 0;
+        uint64_t m_drawListVersion = 0;
+        // The draw list model's impostor (invalid material = none).
+        MaterialHandle m_impostorMaterial{};
+        PushConstantsImpostor m_impostorConstants{};
+
+        Stats m_stats{};
+    };
+
+} // namespace Engine
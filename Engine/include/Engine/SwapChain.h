@@ -5,6 +5,16 @@
 
 namespace Engine
 {
+    // Present mode preference (SwapChain::SetVSyncMode). Unsupported modes fall back to FIFO,
+    // which every device supports.
+    enum class VSyncMode : uint32_t
+    {
+        Auto = 0, // MAILBOX if available, else FIFO (ENGINE_PRESENT_MODE may override)
+        On,       // FIFO: capped to the display rate, no tearing
+        Off,      // MAILBOX (uncapped, no tearing), else IMMEDIATE (tearing)
+        Adaptive, // FIFO_RELAXED: vsync, but late frames tear instead of waiting a refresh
+    };
+
     class SwapChain
     {
     public:
@@ -26,12 +36,35 @@ namespace Engine
         // Recreate the swapchain (e.g., on window resize). Caller should ensure device is idle or use fences.
         void Recreate(VkExtent2D newExtent);
 
+        // A swapchain replaced by RecreateRetiring(), still owned by the caller.
+        struct Retired
+        {
+            VkSwapchainKHR swapchain = VK_NULL_HANDLE;
+            std::vector<VkImageView> imageViews;
+        };
+
+        // Recreate without waiting for the device: the current swapchain is handed to the new one
+        // as oldSwapchain and returned (with its views) in `retired`. Destroy both once the frames
+        // that presented from it have completed.
+        void RecreateRetiring(VkExtent2D newExtent, Retired &retired);
+
         // Accessors
         VkSwapchainKHR GetSwapchain() const { return m_Swapchain; }
+        const std::vector<VkImage> &GetImages() const { return m_Images; }
         const std::vector<VkImageView> &GetImageViews() const { return m_ImageViews; }
         VkFormat GetImageFormat() const { return m_ImageFormat; }
         VkExtent2D GetExtent() const { return m_Extent; }
 
+        // Takes effect when the swapchain is recreated; the renderer does that at the start of its
+        // next frame while IsRecreatePending().
+        void SetVSyncMode(VSyncMode mode);
+        VSyncMode GetVSyncMode() const { return m_VSyncMode; }
+        bool IsRecreatePending() const { return m_RecreatePending; }
+
+        // Mode the current swapchain was created with, and the surface's supported modes.
+        VkPresentModeKHR GetPresentMode() const { return m_PresentMode; }
+        bool IsPresentModeSupported(VkPresentModeKHR mode) const;
+
     private:
         // internal helpers (similar to previous free functions)
         VkSurfaceFormatKHR chooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR> &available) const;
@@ -51,6 +84,11 @@ namespace Engine
         VkFormat m_ImageFormat = VK_FORMAT_UNDEFINED;
         VkExtent2D m_Extent{};
 
+        VSyncMode m_VSyncMode = VSyncMode::Auto;
+        VkPresentModeKHR m_PresentMode = VK_PRESENT_MODE_FIFO_KHR;
+        std::vector<VkPresentModeKHR> m_AvailablePresentModes;
+        bool m_RecreatePending = false;
+
         // Initial extent (window size) provided by VulkanContext when constructing
         VkExtent2D m_InitialExtent{};
     };
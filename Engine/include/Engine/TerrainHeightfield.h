@@ -0,0 +1,91 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Engine
+{
+    // ------------------------------------------------------------
+    // CPU heightfield and splat source for TerrainRenderPassModule.
+    //
+    // - Heights are a regular XZ grid of 16-bit samples (height = offset + sample * scale), so a
+    //   4 km map at 1 m spacing stays around 32 MB. heightAt() is bilinear and clamps to the edge.
+    // - Splat weights (RGBA = terrain layers 0..3) come from an optional RGBA8 map of the same
+    //   resolution; without one they are derived from slope (steep ground blends to layer 1).
+    // - A min/max pyramid over MINMAX_LEAF x MINMAX_LEAF cell blocks answers heightRange()
+    //   conservatively in a handful of lookups (terrain node culling).
+    // - revision() changes whenever the data changes; the terrain pass re-streams its tiles.
+    // ------------------------------------------------------------
+    class TerrainHeightfield
+    {
+    public:
+        // =====================
+        // TUNING CONSTANTS
+        // =====================
+        static constexpr uint32_t MINMAX_LEAF = 8; // cells per pyramid leaf side
+
+        TerrainHeightfield() = default;
+
+        // Constant height over [originX, originX + extentX] x [originZ, originZ + extentZ].
+        void createFlat(float originX, float originZ, float extentX, float extentZ, float height = 0.0f);
+
+        // Raw little-endian uint16 samples, row-major (width samples per row, depth rows).
+        bool loadRaw16(const std::string &path, uint32_t width, uint32_t depth, float spacing,
+                       float originX, float originZ, float heightScale, float heightOffset);
+
+        // Raw RGBA8 splat weights, same resolution as the heights. Returns false (and keeps the
+        // slope-derived weights) when the file is missing or the size does not match.
+        bool loadSplatRaw(const std::string &path);
+
+        bool valid() const { return m_width >= 2 && m_depth >= 2; }
+
+        float heightAt(float x, float z) const;
+        // Normalized weights of layers 0..3 at (x, z); 'footprint' is the sample distance the
+        // caller renders at (slope is measured across it).
+        glm::vec4 splatAt(float x, float z, float footprint) const;
+
+        // Conservative height bounds of the XZ rectangle.
+        void heightRange(float x0, float z0, float x1, float z1, float &outMin, float &outMax) const;
+
+        float originX() const { return m_originX; }
+        float originZ() const { return m_originZ; }
+        float extentX() const { return m_spacingX * static_cast<float>(m_width - 1); }
+        float extentZ() const { return m_spacingZ * static_cast<float>(m_depth - 1); }
+        float minHeight() const { return m_minHeight; }
+        float maxHeight() const { return m_maxHeight; }
+        uint32_t revision() const { return m_revision; }
+
+        uint64_t memoryBytes() const;
+
+    private:
+        float sampleHeight(uint32_t ix, uint32_t iz) const
+        {
+            return m_heightOffset + static_cast<float>(m_samples[static_cast<size_t>(iz) * m_width + ix]) * m_heightScale;
+        }
+        void buildMinMax();
+
+        uint32_t m_width = 0; // samples along X
+        uint32_t m_depth = 0; // samples along Z
+        float m_spacingX = 1.0f;
+        float m_spacingZ = 1.0f;
+        float m_originX = 0.0f;
+        float m_originZ = 0.0f;
+        float m_heightScale = 1.0f;
+        float m_heightOffset = 0.0f;
+        float m_minHeight = 0.0f;
+        float m_maxHeight = 0.0f;
+
+        std::vector<uint16_t> m_samples;
+        std::vector<uint8_t> m_splat; // RGBA8 per sample; empty = slope-derived
+
+        // m_minMax[level][by * dimX + bx] = (min, max); level 0 blocks are MINMAX_LEAF cells wide.
+        std::vector<std::vector<glm::vec2>> m_minMax;
+        std::vector<uint32_t> m_minMaxDimX;
+        std::vector<uint32_t> m_minMaxDimZ;
+
+        uint32_t m_revision = 0;
+    };
+}
@@ -0,0 +1,235 @@
+#pragma once
+
+#include "Engine/Renderer.h"
+
+#include "assets/AssetManager.h"
+#include "assets/Handles.h"
+#include "assets/TextureAsset.h"
+
+#include "Engine/Camera.h"
+#include "Engine/Frustum.h"
+#include "Engine/Pipeline.h"
+
+#include "utils/BufferUtils.h"
+#include "utils/MemoryReport.h"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace Engine
+{
+    class TerrainHeightfield;
+
+    // ------------------------------------------------------------
+    // Quadtree terrain (CDLOD-style) over a TerrainHeightfield.
+    //
+    // - One static PATCH_QUADS x PATCH_QUADS grid mesh is drawn instanced, once per selected node.
+    //   Nodes are selected top-down each frame: a node is split while it reaches into the next
+    //   finer LOD range, so the node count (and cost) depends on the view, not the map size.
+    // - Vertices morph to the next coarser grid towards the end of their node's range, so
+    //   neighbouring levels meet without cracks or popping.
+    // - Heights and splat weights stream into a TILE_CACHE_LAYERS texture-array cache, one layer
+    //   per node, at most TILE_UPLOADS_PER_FRAME per frame (nearest first). A node whose tile is
+    //   not resident yet samples its nearest resident ancestor; root tiles are pinned.
+    // - Fragments blend up to LAYER_COUNT tiled layer textures by the splat weights.
+    // ------------------------------------------------------------
+    class TerrainRenderPassModule final : public RenderPassModule
+    {
+    public:
+        // =====================
+        // TUNING CONSTANTS
+        // =====================
+        static constexpr uint32_t PATCH_QUADS = 32;               // grid quads per node side
+        static constexpr uint32_t TILE_SAMPLES = PATCH_QUADS + 3; // 33 vertices + 1 border sample per side
+        static constexpr uint32_t MAX_LOD_LEVELS = 10;
+        static constexpr uint32_t MAX_NODES = 1024; // per frame; further nodes are dropped
+        static constexpr uint32_t TILE_CACHE_LAYERS = 256;
+        static constexpr uint32_t TILE_UPLOADS_PER_FRAME = 8;
+        static constexpr float MORPH_START = 0.7f; // fraction of a LOD band where morphing begins
+        static constexpr uint32_t LAYER_COUNT = 4;
+
+        struct Config
+        {
+            float baseSpacing = 1.0f;       // meters between vertices at LOD 0
+            float lod0Range = 96.0f;        // LOD 0 band; each level doubles it (>= 2 LOD 0 nodes)
+            float maxViewDistance = 4000.0f;
+        };
+
+        struct Stats
+        {
+            uint32_t nodes = 0;         // drawn this frame
+            uint32_t lodLevels = 0;
+            uint32_t tilesResident = 0;
+            uint32_t tileUploads = 0;   // this frame
+            uint32_t tileFallbacks = 0; // nodes drawn from an ancestor's tile this frame
+        };
+
+        TerrainRenderPassModule() = default;
+        ~TerrainRenderPassModule() override = default;
+
+        const char *getDebugName() const override { return "Terrain"; }
+
+        void setEnabled(bool enabled) { m_enabled = enabled; }
+        void setAssets(AssetManager *assets) { m_assets = assets; }
+        void setCamera(Camera *camera) { m_camera = camera; }
+        void setConfig(const Config &cfg) { m_cfg = cfg; }
+
+        // Not owned; must outlive the pass. Tiles re-stream when its revision changes.
+        void setHeightfield(const TerrainHeightfield *heightfield) { m_heightfield = heightfield; }
+
+        // Layer textures blended by the splat weights (layer 0 = flat ground). Unset layers use
+        // layer 0's texture. Takes effect when the pass is created.
+        void setLayerTexture(uint32_t layer, TextureHandle tex, float metersPerRepeat);
+
+        const Stats &stats() const { return m_stats; }
+
+        void onCreate(VulkanContext &ctx, VkRenderPass pass, const std::vector<VkFramebuffer> &fbs) override;
+        void recordPrePass(FrameContext &frameCtx, VkCommandBuffer cmd) override;
+        void record(FrameContext &frameCtx, VkCommandBuffer cmd) override;
+        void latchCamera(FrameContext &frameCtx) override;
+        bool recordsPhases() const override { return true; }
+        void recordPhase(FrameContext &frameCtx, VkCommandBuffer cmd, RenderPhase phase) override;
+        void onResize(VulkanContext &ctx, VkExtent2D newExtent) override;
+        void onDestroy(VulkanContext &ctx) override;
+
+        // Tile cache, patch mesh and per-frame buffers, under category "Render".
+        void reportMemory(MemoryReport &out) const;
+
+    private:
+        struct CameraUBO
+        {
+            glm::mat4 view{1.0f};
+            glm::mat4 proj{1.0f};
+            glm::vec4 cameraPos{0.0f};
+            glm::vec4 layerScale{1.0f}; // per layer: 1 / metersPerRepeat
+        };
+
+        // std430 layout (terrain.vert).
+        struct GpuNode
+        {
+            glm::vec4 node;  // xy=origin (x, z), z=size, w=lod
+            glm::vec4 tile;  // xy=tile origin, z=1/tile size, w=cache layer
+            glm::vec4 morph; // x=start, y=end distance
+        };
+        static_assert(sizeof(GpuNode) == 48, "GpuNode must match terrain.vert");
+
+        struct FrameData
+        {
+            VkDescriptorSet set = VK_NULL_HANDLE;
+
+            // Camera UBO: sub-allocated from the renderer's upload ring every frame and bound
+            // with a dynamic offset; cameraRingBuffer is the buffer last written into set.
+            VkBuffer cameraRingBuffer = VK_NULL_HANDLE;
+            uint32_t cameraOffset = 0;
+            uint8_t *cameraMapped = nullptr; // this frame's allocation, written by latchCamera()
+
+            VkBuffer nodeBuffer = VK_NULL_HANDLE;
+            GpuAllocation nodeMemory;
+
+            // Tile bytes copied into the cache images this frame.
+            VkBuffer stagingBuffer = VK_NULL_HANDLE;
+            GpuAllocation stagingMemory;
+
+            uint32_t nodeCount = 0;
+        };
+
+        struct TileSlot
+        {
+            uint64_t key = UINT64_MAX; // UINT64_MAX = free
+            uint32_t lastUsedFrame = 0;
+            bool pinned = false;
+        };
+
+        struct SelectedNode
+        {
+            uint32_t lod = 0;
+            uint32_t ix = 0;
+            uint32_t iz = 0;
+            float distance = 0.0f;
+        };
+
+        static uint64_t tileKey(uint32_t lod, uint32_t ix, uint32_t iz)
+        {
+            return (static_cast<uint64_t>(lod) << 48) | (static_cast<uint64_t>(ix) << 24) | static_cast<uint64_t>(iz);
+        }
+
+        bool createFrameResources(VulkanContext &ctx, size_t frameCount);
+        bool allocateCameraUBO(FrameContext &frameCtx, FrameData &frame);
+        void destroyFrameResources();
+        bool createTileCache(VulkanContext &ctx);
+        void destroyTileCache();
+        bool createPatchMesh(VulkanContext &ctx);
+        void createPipelines(VulkanContext &ctx, VkRenderPass pass);
+        void writeLayerDescriptors();
+
+        float nodeSize(uint32_t lod) const;
+        float lodRange(uint32_t lod) const;
+        void selectNodes(const glm::vec3 &cameraPos, const glm::mat4 &viewProj);
+        void selectNode(uint32_t lod, uint32_t ix, uint32_t iz);
+        void resetTileCache();
+        uint32_t acquireTileSlot();
+        void buildTile(uint32_t lod, uint32_t ix, uint32_t iz, float *heights, uint8_t *splat) const;
+        void streamTiles(FrameData &frame, VkCommandBuffer cmd);
+
+    private:
+        bool m_enabled = true;
+        AssetManager *m_assets = nullptr;                  // not owned
+        Camera *m_camera = nullptr;                        // not owned
+        const TerrainHeightfield *m_heightfield = nullptr; // not owned
+        Config m_cfg{};
+
+        std::array<TextureHandle, LAYER_COUNT> m_layerTextures{};
+        std::array<float, LAYER_COUNT> m_layerMetersPerRepeat{5.0f, 5.0f, 5.0f, 5.0f};
+
+        VkDevice m_device = VK_NULL_HANDLE;
+        VkPhysicalDevice m_physicalDevice = VK_NULL_HANDLE;
+        VkExtent2D m_extent{};
+
+        VkDescriptorSetLayout m_setLayout = VK_NULL_HANDLE;
+        VkDescriptorPool m_pool = VK_NULL_HANDLE;
+        std::vector<FrameData> m_frames;
+
+        // Frame set + shadow receiver set (FrameContext::shadow, set 1).
+        VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+        VkDescriptorSetLayout m_receiverSetLayout = VK_NULL_HANDLE;
+        Pipeline m_pipeline;
+        Pipeline m_pipelineDepth; // depth prepass: no colour writes
+
+        // Patch grid: (PATCH_QUADS + 1)^2 vertices of integer grid coordinates.
+        VertexBufferHandle m_patchVB{};
+        IndexBufferHandle m_patchIB{};
+        uint32_t m_patchIndexCount = 0;
+
+        // Tile cache: height (R32F) and splat (RGBA8) arrays, one layer per resident node.
+        VkImage m_heightImage = VK_NULL_HANDLE;
+        GpuAllocation m_heightMemory;
+        VkImageView m_heightView = VK_NULL_HANDLE;
+        VkImage m_splatImage = VK_NULL_HANDLE;
+        GpuAllocation m_splatMemory;
+        VkImageView m_splatView = VK_NULL_HANDLE;
+        VkSampler m_tileSampler = VK_NULL_HANDLE;
+        bool m_tileImagesInitialized = false;
+        TextureAsset m_fallbackWhiteTexture;
+
+        std::vector<TileSlot> m_tileSlots;
+        std::unordered_map<uint64_t, uint32_t> m_tileByKey; // tileKey -> cache layer
+        uint32_t m_tileRevision = UINT32_MAX;              // heightfield revision of the cache
+
+        // Per-frame selection (recordPrePass scratch).
+        uint32_t m_lodCount = 0;
+        uint32_t m_rootsX = 0;
+        uint32_t m_rootsZ = 0;
+        glm::vec3 m_selectCamera{0.0f};
+        Frustum m_selectFrustum{};
+        std::vector<SelectedNode> m_selected;
+        std::vector<GpuNode> m_gpuNodes;
+        std::vector<uint32_t> m_missing; // indices into m_selected without a resident tile
+
+        uint32_t m_frameCounter = 0;
+        Stats m_stats{};
+    };
+}
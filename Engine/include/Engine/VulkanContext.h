@@ -1,5 +1,6 @@
 #pragma once
 #include "Structs/QueueFamilyStruct.h"
+#include "utils/GpuAllocator.h"
 #include <vulkan/vulkan.h>
 #include <optional>
 #include <vector>
@@ -9,10 +10,14 @@ namespace Engine
 {
     class Window;
     class SwapChain; // Forward declaration of SwapChain
+    class BindlessMaterials;
+    class JobSystem;
     class VulkanContext
     {
     public:
-        VulkanContext(Window &window);
+        // With jobs, Init() reads PIPELINE_CACHE_FILE on a worker while the instance and device
+        // are created.
+        VulkanContext(Window &window, JobSystem *jobs = nullptr);
         ~VulkanContext();
 
         void Init();
@@ -27,6 +32,49 @@ namespace Engine
         uint32_t GetGraphicsQueueFamilyIndex() const { return m_SelectedDeviceInfo.queueFamilyIndices.graphicsFamily.value(); }
         SwapChain *GetSwapChain() const { return m_SwapChain.get(); }
 
+        // Dedicated compute queue (a family without graphics) plus timeline semaphores: what the
+        // Renderer needs to overlap compute with the previous frame's graphics work.
+        bool HasAsyncCompute() const { return m_ComputeQueue != VK_NULL_HANDLE && m_HasTimelineSemaphore; }
+        VkQueue GetComputeQueue() const { return m_ComputeQueue; }
+        uint32_t GetComputeQueueFamilyIndex() const { return m_SelectedDeviceInfo.queueFamilyIndices.computeFamily.value_or(GetGraphicsQueueFamilyIndex()); }
+
+        // Dedicated transfer queue (a family with neither graphics nor compute); VK_NULL_HANDLE
+        // when the device has none. Resources filled on it and read by graphics need concurrent
+        // sharing or a queue family ownership transfer.
+        VkQueue GetTransferQueue() const { return m_TransferQueue; }
+        uint32_t GetTransferQueueFamilyIndex() const { return m_SelectedDeviceInfo.queueFamilyIndices.transferFamily.value_or(GetGraphicsQueueFamilyIndex()); }
+
+        // VK_KHR_timeline_semaphore (VkSemaphoreTypeCreateInfoKHR / VkTimelineSemaphoreSubmitInfoKHR).
+        bool HasTimelineSemaphore() const { return m_HasTimelineSemaphore; }
+
+        // Device memory sub-allocator; buffer/image utilities pick it up through the device.
+        GpuAllocator &GetAllocator() { return m_Allocator; }
+
+        // Pipeline cache shared by all passes. Loaded from PIPELINE_CACHE_FILE at Init() when the
+        // file was written for the same device and driver, saved back at Shutdown().
+        VkPipelineCache GetPipelineCache() const { return m_PipelineCache; }
+        static constexpr const char *PIPELINE_CACHE_FILE = "pipeline_cache.bin";
+
+        // VK_EXT_descriptor_indexing with the features BindlessMaterials needs.
+        bool HasDescriptorIndexing() const { return m_HasDescriptorIndexing; }
+        // Global texture array + material SSBO shared by all passes; nullptr without descriptor indexing.
+        BindlessMaterials *GetBindlessMaterials() const { return m_Bindless.get(); }
+
+        // VK_KHR_present_id + VK_KHR_present_wait: presents can carry an id (VkPresentIdKHR) and
+        // WaitForPresent() blocks until that present was shown (or the timeout passed).
+        bool HasPresentWait() const { return m_HasPresentWait; }
+        VkResult WaitForPresent(VkSwapchainKHR swapchain, uint64_t presentId, uint64_t timeoutNs) const
+        {
+            return m_WaitForPresent ? m_WaitForPresent(m_Device, swapchain, presentId, timeoutNs) : VK_ERROR_EXTENSION_NOT_PRESENT;
+        }
+
+        // VK_KHR_draw_indirect_count (vkCmdDrawIndexedIndirectCountKHR).
+        bool HasDrawIndirectCount() const { return m_HasDrawIndirectCount; }
+
+        // VK_EXT_mesh_shader with task and mesh shaders enabled, and its limits.
+        bool HasMeshShader() const { return m_HasMeshShader; }
+        const VkPhysicalDeviceMeshShaderPropertiesEXT &GetMeshShaderProperties() const { return m_MeshShaderProperties; }
+
     private:
         void createInstance();
         void createSurface();
@@ -42,6 +90,9 @@ namespace Engine
 
         void createLogicalDevice();
 
+        void createPipelineCache();
+        void savePipelineCache();
+
         bool checkValidationLayerSupport();
         void populateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT &createInfo);
 
@@ -60,6 +111,32 @@ namespace Engine
         VkDevice m_Device = VK_NULL_HANDLE;       // logical device
         VkQueue m_GraphicsQueue = VK_NULL_HANDLE; // graphics queue handle
         VkQueue m_PresentQueue = VK_NULL_HANDLE;
+        VkQueue m_ComputeQueue = VK_NULL_HANDLE;  // dedicated family only
+        VkQueue m_TransferQueue = VK_NULL_HANDLE; // dedicated family only
+
+        GpuAllocator m_Allocator;
+        VkPipelineCache m_PipelineCache = VK_NULL_HANDLE;
+        JobSystem *m_Jobs = nullptr;            // not owned
+        std::vector<char> m_PipelineCacheFile; // raw file bytes, read ahead of createPipelineCache()
+
+        bool m_HasPhysicalDeviceProperties2 = false;
+        bool m_HasDescriptorIndexing = false;
+        VkPhysicalDeviceDescriptorIndexingFeaturesEXT m_DescriptorIndexingFeatures{}; // device create pNext
+        std::unique_ptr<BindlessMaterials> m_Bindless;
+
+        bool m_HasPresentWait = false;
+        VkPhysicalDevicePresentIdFeaturesKHR m_PresentIdFeatures{};     // device create pNext
+        VkPhysicalDevicePresentWaitFeaturesKHR m_PresentWaitFeatures{}; // device create pNext
+        PFN_vkWaitForPresentKHR m_WaitForPresent = nullptr;
+
+        bool m_HasTimelineSemaphore = false;
+        VkPhysicalDeviceTimelineSemaphoreFeaturesKHR m_TimelineSemaphoreFeatures{}; // device create pNext
+
+        uint32_t m_InstanceApiVersion = VK_API_VERSION_1_0;
+        bool m_HasDrawIndirectCount = false;
+        bool m_HasMeshShader = false;
+        VkPhysicalDeviceMeshShaderFeaturesEXT m_MeshShaderFeatures{}; // device create pNext
+        VkPhysicalDeviceMeshShaderPropertiesEXT m_MeshShaderProperties{};
 
         std::unique_ptr<SwapChain> m_SwapChain;
     };
@@ -1,5 +1,11 @@
 #pragma once
 #include <vulkan/vulkan.h>
+namespace Engine
+{
+    struct ShadowFrame;
+    struct CameraBlock;
+    class FrameUploadRing;
+}
 // Per-frame resources (one slot per in-flight frame)
 struct FrameContext
 {
@@ -8,5 +14,31 @@ struct FrameContext
     VkSemaphore imageAcquiredSemaphore = VK_NULL_HANDLE;
     VkSemaphore renderFinishedSemaphore = VK_NULL_HANDLE;
     VkFence inFlightFence = VK_NULL_HANDLE;
+    // Async compute (Renderer::setAsyncCompute): pool/buffer on the dedicated compute family.
+    VkCommandPool computeCommandPool = VK_NULL_HANDLE;
+    VkCommandBuffer computeCommandBuffer = VK_NULL_HANDLE;
     uint32_t frameIndex = 0;
+    // Area the main render pass draws this frame (viewport/scissor); below the swapchain extent
+    // with resolution scaling (Renderer::setRenderScale).
+    VkExtent2D renderExtent{};
+    bool depthPrepass = false; // Renderer::setDepthPrepass(): RenderPhase::DepthPrepass draws depth this frame
+    bool asyncCompute = false; // RenderPassModule::recordAsyncCompute() is called this frame
+    // Set by recordAsyncCompute(): the compute submit first waits for the previous graphics submit.
+    bool computeWaitsForGraphics = false;
+    // Renderer frame serial + 1 of the last submit that signals inFlightFence; 0 = none yet.
+    uint64_t submittedSerialEnd = 0;
+    // This frame's shadow cascades (Renderer::shadows()), set before recordPrePass(); receivers
+    // bind its receiverSet. Null only outside Renderer::drawFrame().
+    const Engine::ShadowFrame *shadow = nullptr;
+    // Per-frame constants (Renderer::uploadRing()): passes sub-allocate their UBOs here and bind
+    // them with dynamic offsets. Null when the ring could not be created.
+    Engine::FrameUploadRing *uploads = nullptr;
+    // The shared camera block in that ring: bind uploads->buffer() as a dynamic uniform buffer
+    // (range sizeof(CameraBlock)) at cameraOffset. Its contents are written at late latch;
+    // camera points at the CPU copy from then on (null before Renderer::latchCamera).
+    uint32_t cameraOffset = 0;
+    const Engine::CameraBlock *camera = nullptr;
+    // Hi-Z pyramid of an earlier frame (Renderer::setHiZOcclusion, layout in HiZPyramid.h) for
+    // compute culls recorded in recordPrePass(); read-only. Null when off or not built yet.
+    VkBuffer hiZPyramid = VK_NULL_HANDLE;
 };
\ No newline at end of file
@@ -9,6 +9,11 @@ namespace Engine
         std::optional<uint32_t> graphicsFamily;
         std::optional<uint32_t> presentFamily;
 
+        // Optional dedicated families: compute without graphics (async compute) and transfer
+        // without graphics or compute (DMA engine). Unset when the device has none.
+        std::optional<uint32_t> computeFamily;
+        std::optional<uint32_t> transferFamily;
+
         bool isComplete() const
         {
             return graphicsFamily.has_value() && presentFamily.has_value();
@@ -1,11 +1,14 @@
 #pragma once
 #include <vulkan/vulkan.h>
 #include <cstdint>
+#include <deque>
+#include <functional>
 #include <string>
 #include <unordered_map>
 #include <memory>
 #include <vector>
 
+#include "assets/AssetSlotTable.h"
 #include "assets/Handles.h"
 
 #include "assets/MeshFormats.h"
@@ -18,11 +21,23 @@
 #include "assets/MaterialAsset.h"
 #include "assets/ModelAsset.h"
 
+#include "utils/JobSystem.h"
+#include "utils/MemoryReport.h"
+#include "utils/StagingRing.h"
+
 namespace Engine
 {
+    class AssetPack;
+    using AssetPackList = std::vector<std::shared_ptr<const AssetPack>>;
+
     // ---------------------------
     // AssetManager
     // ---------------------------
+    // Loading, reloading, streaming continuations and collection run on the owning (main)
+    // thread. getModel(), getMesh(), getMaterial(), getTexture() and modelState() resolve through
+    // lock-free slot tables and may be called from any thread, e.g. JobSystem workers, while the
+    // owner mutates the tables. A pointer they return stays valid for the frame being recorded:
+    // collected or reloaded assets go through the deferred destroy queue below.
     class AssetManager
     {
     public:
@@ -34,19 +49,63 @@ namespace Engine
 
         // Existing mesh API
         MeshHandle loadMesh(const std::string &cookedMeshPath);
-        MeshAsset *getMesh(MeshHandle h);
+        MeshAsset *getMesh(MeshHandle h) const;
 
         void addRef(MeshHandle h);
         void release(MeshHandle h);
 
         // New smodel/model API
         ModelHandle loadModel(const std::string &cookedModelPath);
-        ModelAsset *getModel(ModelHandle h);
+        ModelAsset *getModel(ModelHandle h) const;
+
+        // Hot reload: re-reads the model's file and swaps the new contents in under the same
+        // handle. The previous meshes, materials and textures are released to the GC, so they
+        // are destroyed once frames using them retire. Returns false, leaving the model as it
+        // was, when the handle is not resident or the file does not load.
+        bool reloadModel(ModelHandle h);
+        // File the model was loaded from (empty for stale handles and models built in code).
+        std::string modelPath(ModelHandle h) const;
+        // reloadModel() for every resident model whose loose file changed since it was loaded
+        // (models read from a pack are skipped). Reloaded handles are appended to outReloaded.
+        uint32_t reloadChangedModels(std::vector<ModelHandle> *outReloaded = nullptr);
+
+        // Streaming: returns a handle immediately and loads the model in the background through
+        // the JobSystem given to setJobSystem(). Until the model is resident the handle is
+        // Pending and getModel() returns nullptr, so renderers simply skip it. Without a job
+        // system this is the same as loadModel(). loadModel() on a pending path finishes the
+        // load synchronously and returns the same handle.
+        void setJobSystem(JobSystem *jobs) { m_jobs = jobs; }
+
+        // Model textures (PNG/JPG) decode in parallel on the job system and, while enabled
+        // (default), get their mip chains box-filtered on the CPU too, so the upload is plain
+        // per-level copies instead of a serialized blit chain per texture.
+        void setCpuMipGeneration(bool enabled) { m_cpuMipChains = enabled; }
+
+        // GltfToSmodel cooks meshes in vertex cache / overdraw / fetch order. Older files can
+        // get the same pass on the loading thread while enabled (default off: no load cost).
+        void setOptimizeUncookedMeshes(bool enabled) { m_optimizeUncookedMeshes = enabled; }
 
-        MaterialAsset *getMaterial(MaterialHandle h);
-        TextureAsset *getTexture(TextureHandle h);
+        // Dedicated transfer queue (VulkanContext::GetTransferQueue()): mesh buffer copies and
+        // texture uploads are recorded there and handed to the graphics family with queue
+        // ownership barriers, leaving mip blits and layout changes on the graphics queue. A null
+        // queue or the graphics family turns it off. Call before the first upload.
+        void setTransferQueue(VkQueue transferQueue, uint32_t transferQueueFamilyIndex);
+        ModelHandle requestModel(const std::string &cookedModelPath);
+        AssetState modelState(ModelHandle h) const;
+        bool isModelReady(ModelHandle h) const { return modelState(h) == AssetState::Ready; }
+
+        MaterialAsset *getMaterial(MaterialHandle h) const;
+        TextureAsset *getTexture(TextureHandle h) const;
         TextureHandle loadTextureFromFile(const std::string &filePath);
 
+        // Async API: file reads, .smodel parsing and image decoding run as a JobSystem job; the
+        // GPU upload and registration run as a main-thread continuation, i.e. inside
+        // JobSystem::runMainThreadJobs(). onLoaded is called there with the handle (invalid on
+        // failure), owned by the caller exactly like the result of the synchronous call.
+        // Nothing is called if the AssetManager is destroyed first.
+        JobHandle loadModelAsync(const std::string &cookedModelPath, JobSystem &jobs, std::function<void(ModelHandle)> onLoaded);
+        JobHandle loadTextureFromFileAsync(const std::string &filePath, JobSystem &jobs, std::function<void(TextureHandle)> onLoaded);
+
         void addRef(ModelHandle h);
         void release(ModelHandle h);
 
@@ -56,26 +115,200 @@ namespace Engine
         void addRef(TextureHandle h);
         void release(TextureHandle h);
 
-        // Collect all zero-ref assets (and clear caches)
+        // Asset packs (see AssetPack.h): every load that takes a path (models, image textures,
+        // residency re-reads) looks in the mounted packs, newest first, before the file system.
+        // Uncompressed .smodel entries are parsed in place from the pack's mapping; compressed
+        // ones are decoded into memory. Mount before loading; a pack stays mapped while loads
+        // or resident assets still use its bytes. Returns false if the pack cannot be opened.
+        bool mountPack(const std::string &packPath);
+
+        // Upload batching: between beginUploadBatch() and endUploadBatch() every mesh, texture and
+        // model finalized on this thread records its copies and mip generation into one command
+        // buffer; endUploadBatch() submits it once with one fence and waits once. Handles returned
+        // inside a batch are registered immediately but must not be drawn before the batch ends.
+        // Batches nest (the outermost end submits). garbageCollect() is a no-op while one is open.
+        void beginUploadBatch();
+        bool endUploadBatch();
+        bool uploadBatchOpen() const { return m_uploadBatch != nullptr; }
+
+        // Collect all zero-ref assets (and clear caches) in one call. Meshes and textures go
+        // through the deferred destroy queue below once frame serials are known.
         void garbageCollect();
 
+        // ------------------------------------------------------------
+        // Incremental collection + deferred GPU destruction
+        // ------------------------------------------------------------
+        // release() remembers assets whose count drops to zero. garbageCollectStep() collects
+        // those in dependency order (models, materials, meshes, textures) until budgetMs is
+        // spent and resumes there on the next call, so unloading a level spreads over frames
+        // instead of walking every asset at once. Collected meshes and textures are not
+        // destroyed right away: they are queued with the serial of the frame being recorded and
+        // destroyed (within the same budget) once the renderer reports that frame complete.
+        //
+        // setFrameSerials() takes Renderer::getFrameSerial() and getCompletedFrameSerial(), once
+        // per frame before collecting. Until it is first called nothing is known about frames in
+        // flight and collected objects are destroyed immediately, so callers must have waited
+        // for the device (the pre-queue behaviour). No-ops inside an upload batch.
+        void setFrameSerials(uint64_t recordingSerial, uint64_t completedSerial);
+        void garbageCollectStep(float budgetMs);
+        // Destroys everything queued, ready or not; only after vkDeviceWaitIdle.
+        void flushDeferredDestroys();
+
+        struct GarbageStats
+        {
+            uint32_t pendingCandidates = 0; // released to zero, not yet looked at
+            uint32_t queuedDestroys = 0;    // collected/replaced assets waiting for their frame
+            uint64_t queuedBytes = 0;
+            uint64_t collectedAssets = 0;   // running total
+        };
+        GarbageStats garbageStats() const;
+
+        // Meshes, textures and models (CPU-side model data and GPU buffers/images), plus the
+        // staging ring, under category "Assets".
+        void reportMemory(MemoryReport &out) const;
+
+        // ------------------------------------------------------------
+        // Texture residency (VRAM budget)
+        // ------------------------------------------------------------
+        // Renderers report how large each drawn model is on screen (noteModelOnScreen). The
+        // textures of reported models are streamed by mip level: updateTextureResidency() keeps
+        // the levels their largest recent use needs, trims textures unseen for idleFrames to a
+        // small tail, and while the VK_EXT_memory_budget budget is exceeded drops further top
+        // levels, least recently used textures first, then those with the largest top level.
+        // Textures never reported (terrain layers, UI, ...) stay fully resident.
+        //
+        // Trims copy the kept levels on the GPU; restores re-read the image file or .smodel on
+        // the JobSystem and upload from a main-thread continuation. Every swap waits for its
+        // upload (and with it the frames in flight), so the old image is destroyed right away;
+        // passes that cache descriptors rewrite them when textureViewEpoch() changes.
+        struct TextureResidencyConfig
+        {
+            bool enabled = true;
+            float budgetFraction = 0.85f;    // share of the device-local budget the process may fill
+            uint64_t maxTextureBytes = 0;    // extra cap on resident texture bytes (0 = none)
+            uint32_t updateIntervalFrames = 8;
+            uint32_t idleFrames = 300;       // frames without a use before a texture counts as off screen
+            uint32_t idleMaxDim = 64;        // off-screen textures keep the levels up to this size
+            float texelsPerPixel = 1.0f;     // texels kept across one screen pixel of the model (>1 = sharper)
+            uint64_t maxRestoreBytesPerUpdate = 32ull * 1024ull * 1024ull;
+        };
+
+        struct TextureResidencyStats
+        {
+            uint32_t streamedTextures = 0;  // textures reported at least once
+            uint32_t trimmedTextures = 0;   // streamed textures below their full chain
+            uint32_t pendingRestores = 0;
+            uint64_t residentBytes = 0;     // all textures
+            uint64_t fullChainBytes = 0;    // all textures, as if fully resident
+            uint64_t targetBytes = 0;       // texture bytes the budget leaves room for
+            uint64_t trimmedLevels = 0;     // running totals
+            uint64_t restoredLevels = 0;
+            bool overBudget = false;        // even the coarsest allowed tails do not fit
+            bool budgetExtension = false;   // VK_EXT_memory_budget numbers (else allocator totals)
+        };
+
+        void setTextureResidency(const TextureResidencyConfig &config) { m_residency = config; }
+        const TextureResidencyConfig &textureResidency() const { return m_residency; }
+        const TextureResidencyStats &textureResidencyStats() const { return m_residencyStats; }
+
+        // screenPixels: the model's largest on-screen extent this frame (use a large value when
+        // unknown). Cheap: a few lookups per call, no GPU work.
+        void noteModelOnScreen(ModelHandle h, float screenPixels);
+
+        // Once per frame on the owning thread, before passes record. No-op inside an upload batch.
+        void updateTextureResidency();
+
+        // Bumped whenever a texture's image view is replaced.
+        uint32_t textureViewEpoch() const { return m_textureViewEpoch; }
+
     private:
-        MeshHandle createMeshFromData_Internal(const MeshData &data, const std::string &path, uint32_t initialRef);
+        // CPU-side load results (parsed file + decoded pixels). Prepare functions touch no
+        // AssetManager state (packs: a snapshot of m_packs) and may run on any thread; finalize functions upload to the GPU
+        // and register the asset (owning thread only).
+        struct PreparedTexture;
+        struct PreparedModel;
+
+        static bool prepareTexture_Internal(const AssetPackList *packs, const std::string &filePath, PreparedTexture &out);
+        TextureHandle finalizeTexture_Internal(const PreparedTexture &prepared);
+
+        // Residency: source pixels of one texture (image file, or texture sourceTexture of an
+        // .smodel) re-read to restore dropped levels.
+        struct TextureReload;
+        static bool prepareTextureReload_Internal(const AssetPackList *packs, const std::string &sourcePath, int32_t sourceTexture, TextureReload &out);
+        void finishTextureRestore_Internal(uint64_t id, uint32_t generation, uint32_t baseMip, const TextureReload *reload);
+        void requestTextureRestore_Internal(uint64_t id, uint32_t baseMip);
+
+        // jobs (optional): fans texture decoding out across workers; cpuMips: build RGBA8 mip chains
+        // on the CPU so finalize only copies them.
+        static bool prepareModel_Internal(const AssetPackList *packs, JobSystem *jobs, bool cpuMips, bool optimizeMeshes, const std::string &cookedModelPath, PreparedModel &out);
+        // target: pending entry to fill in; an empty handle registers a new model.
+        ModelHandle finalizeModel_Internal(const PreparedModel &prepared, ModelHandle target = ModelHandle{});
+        void failPendingModel_Internal(ModelHandle h);
+
+        MeshHandle createMeshFromData_Internal(const MeshDataView &data, const std::string &path, uint32_t initialRef);
+        MeshHandle registerMesh_Internal(std::unique_ptr<MeshAsset> asset, const std::string &path, uint32_t initialRef);
+        StagingRing *stagingRing_Internal();
+
+        // Returns the open batch, or begins 'local' as a single-use upload (nullptr on failure).
+        UploadContext *beginUpload_Internal(UploadContext &local);
+        // Submits and waits for single-use uploads; batched uploads are submitted by endUploadBatch().
+        bool endUpload_Internal(UploadContext &ctx);
+        // Destroy a failed asset once no recorded command can still reference it.
+        void discardTexture_Internal(std::unique_ptr<TextureAsset> tex);
+        void discardMesh_Internal(std::unique_ptr<MeshAsset> mesh);
+        // Collect one entry if it still has no references (gc helpers; ids may be stale).
+        bool collectModel_Internal(uint64_t id);
+        bool collectMaterial_Internal(uint64_t id);
+        bool collectMesh_Internal(uint64_t id);
+        bool collectTexture_Internal(uint64_t id);
+        // Queues a collected GPU asset for its frames in flight (or destroys it, see setFrameSerials).
+        void retireMesh_Internal(std::unique_ptr<MeshAsset> mesh);
+        void retireTexture_Internal(std::unique_ptr<TextureAsset> tex);
+        void retireMaterial_Internal(std::unique_ptr<MaterialAsset> mat);
+        void retireModel_Internal(std::unique_ptr<ModelAsset> model);
         TextureHandle createTexture_Internal(std::unique_ptr<TextureAsset> tex, uint32_t initialRef);
         MaterialHandle createMaterial_Internal(std::unique_ptr<MaterialAsset> mat, uint32_t initialRef);
         ModelHandle createModel_Internal(std::unique_ptr<ModelAsset> model, const std::string &path, uint32_t initialRef);
 
     private:
+        // Persistent staging memory for upload copies; larger uploads fall back to dedicated
+        // staging buffers.
+        static constexpr VkDeviceSize STAGING_RING_BYTES = 64ull * 1024ull * 1024ull;
+
+        // garbageCollectStep() reads the clock once per this many collected/destroyed items.
+        static constexpr uint32_t GC_CLOCK_CHECK_INTERVAL = 16;
+
         VkDevice m_device = VK_NULL_HANDLE;
         VkPhysicalDevice m_phys = VK_NULL_HANDLE;
+
+        // Expires with the AssetManager; async continuations check it before touching 'this'.
+        std::shared_ptr<int> m_lifetimeToken = std::make_shared<int>(0);
+        JobSystem *m_jobs = nullptr;
+        bool m_cpuMipChains = true;
+        bool m_optimizeUncookedMeshes = false;
+        // Replaced, never modified, on mount: async loads hold the list they started with.
+        std::shared_ptr<const AssetPackList> m_packs;
+        StagingRing m_stagingRing;
+        bool m_stagingRingFailed = false;
+
+        // Upload command buffers come from one transient pool, created on first use.
+        VkCommandPool m_uploadPool = VK_NULL_HANDLE;
+        std::unique_ptr<UploadContext> m_uploadBatch;
+        uint32_t m_uploadBatchDepth = 0;
+        std::vector<std::unique_ptr<TextureAsset>> m_batchDiscardedTextures;
+        std::vector<std::unique_ptr<MeshAsset>> m_batchDiscardedMeshes;
         VkQueue m_graphicsQueue = VK_NULL_HANDLE;
         uint32_t m_graphicsQueueFamilyIndex = 0;
+        // setTransferQueue(); its pool is created on first use like m_uploadPool.
+        VkQueue m_transferQueue = VK_NULL_HANDLE;
+        uint32_t m_transferQueueFamilyIndex = 0;
+        VkCommandPool m_transferPool = VK_NULL_HANDLE;
 
-        // Separate ID spaces
-        uint64_t m_nextMeshID = 1;
-        uint64_t m_nextTextureID = 1;
-        uint64_t m_nextMaterialID = 1;
-        uint64_t m_nextModelID = 1;
+        // Separate id spaces; the lock-free read side of the entry maps below.
+        AssetSlotTable<MeshAsset> m_meshSlots;
+        AssetSlotTable<TextureAsset> m_textureSlots;
+        AssetSlotTable<MaterialAsset> m_materialSlots;
+        AssetSlotTable<ModelAsset> m_modelSlots;
 
         // ---------------------------
         // Mesh entries
@@ -96,10 +329,25 @@ namespace Engine
             std::unique_ptr<TextureAsset> asset;
             uint32_t generation = 1;
             uint32_t refCount = 0;
+
+            // Residency
+            std::string sourcePath;      // image file or .smodel the levels are re-read from
+            int32_t sourceTexture = -1;  // texture index in the .smodel; -1 = image file
+            uint32_t lastUseFrame = 0;   // residency frame of the last reported use; 0 = never (not streamed)
+            float pendingPixels = 0.0f;  // largest screen size reported since the last update
+            float neededPixels = 0.0f;   // same, as of the last update that had a report
+            bool restorePending = false;
         };
 
         std::unordered_map<uint64_t, TextureEntry> m_textures;
 
+        TextureResidencyConfig m_residency;
+        TextureResidencyStats m_residencyStats;
+        uint32_t m_residencyFrame = 1; // 0 is TextureEntry::lastUseFrame's "never"
+        uint32_t m_lastResidencyUpdate = 0;
+        uint32_t m_textureViewEpoch = 0;
+        bool m_hasMemoryBudget = false;
+
         // ---------------------------
         // Material entries
         // ---------------------------
@@ -124,6 +372,8 @@ namespace Engine
             uint32_t generation = 1;
             uint32_t refCount = 0;
             std::string path;
+            AssetState state = AssetState::Ready;
+            int64_t sourceWriteTime = 0; // loose file's write time at load (0: packed or unknown)
 
             // Dependencies: meshes + materials used by this model
             std::vector<MeshHandle> meshDeps;
@@ -135,6 +385,29 @@ namespace Engine
 
         std::unordered_map<uint64_t, ModelEntry> m_models;
         std::unordered_map<std::string, ModelHandle> m_modelPathCache;
+
+        // ---------------------------
+        // Garbage collection
+        // ---------------------------
+        // Ids released to zero (or created unreferenced); re-checked when collected.
+        std::vector<uint64_t> m_gcModels;
+        std::vector<uint64_t> m_gcMaterials;
+        std::vector<uint64_t> m_gcMeshes;
+        std::vector<uint64_t> m_gcTextures;
+
+        struct DeferredDestroy
+        {
+            std::unique_ptr<MeshAsset> mesh;
+            std::unique_ptr<TextureAsset> texture;
+            std::unique_ptr<MaterialAsset> material; // CPU only: kept for workers that resolved it
+            std::unique_ptr<ModelAsset> model;
+            uint64_t retireSerial = 0; // destroyed once every frame up to this one completed
+        };
+        std::deque<DeferredDestroy> m_deferredDestroys; // retireSerial ascending
+        bool m_frameSerialsKnown = false;
+        uint64_t m_recordingSerial = 0;
+        uint64_t m_completedSerial = 0;
+        uint64_t m_collectedAssets = 0;
     };
 
 } // namespace Engine
\ No newline at end of file
@@ -0,0 +1,115 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "utils/MappedFile.h"
+
+namespace Engine
+{
+    // ------------------------------------------------------------
+    // Asset pack (.spak): cooked files behind one table of contents
+    // ------------------------------------------------------------
+    // Layout: PackHeader, the entries (each starting on a PACK_ALIGNMENT boundary), the TOC
+    // (PackEntryRecord[entryCount], sorted by pathHash) and the path string table.
+    //
+    // A compressed entry (PACK_ENTRY_LZ4) is split into PACK_BLOCK_SIZE pieces of the original
+    // bytes, each an independent LZ4 block: the entry starts with one uint32 per block (stored
+    // size; PACK_BLOCK_STORED_RAW set when the block did not shrink and is kept as is), followed
+    // by the blocks back to back. Uncompressed entries are the file bytes verbatim and can be
+    // used in place from the mapping.
+    //
+    // Paths are stored as the game asks for them (PackPathNormalize: forward slashes, '.' and
+    // '..' folded), so a mounted pack answers the same strings that would open loose files.
+    static constexpr uint32_t PACK_MAGIC = 0x4B415053u; // "SPAK"
+    static constexpr uint32_t PACK_VERSION = 1;
+    static constexpr uint64_t PACK_ALIGNMENT = 4096;
+    static constexpr uint32_t PACK_BLOCK_SIZE = 64u * 1024u;
+
+    static constexpr uint32_t PACK_ENTRY_LZ4 = 1u << 0;
+    static constexpr uint32_t PACK_BLOCK_STORED_RAW = 0x80000000u;
+
+    struct PackHeader
+    {
+        uint32_t magic = PACK_MAGIC;
+        uint32_t version = PACK_VERSION;
+        uint32_t entryCount = 0;
+        uint32_t blockSize = PACK_BLOCK_SIZE;
+        uint64_t tocOffset = 0;
+        uint64_t stringTableOffset = 0;
+        uint64_t stringTableSize = 0;
+        uint64_t fileSizeBytes = 0;
+    };
+    static_assert(sizeof(PackHeader) == 48, "PackHeader is a file format struct");
+
+    struct PackEntryRecord
+    {
+        uint64_t pathHash = 0;   // PackPathHash of the path
+        uint64_t dataOffset = 0; // from the start of the pack, PACK_ALIGNMENT aligned
+        uint64_t storedSize = 0; // bytes in the pack
+        uint64_t rawSize = 0;    // bytes of the original file
+        uint32_t pathOffset = 0; // into the string table (not null-terminated)
+        uint32_t pathLength = 0;
+        uint32_t flags = 0;      // PACK_ENTRY_*
+        uint32_t reserved = 0;
+    };
+    static_assert(sizeof(PackEntryRecord) == 48, "PackEntryRecord is a file format struct");
+
+    std::string PackPathNormalize(const std::string &path);
+    uint64_t PackPathHash(const std::string &normalizedPath); // 64-bit FNV-1a
+
+    // Read-only view of a pack. The whole file is one memory mapping (one open handle, paged in
+    // with sequential read-ahead), so lookups and reads never touch the file system. All const
+    // members are safe to call from several threads at once.
+    class AssetPack
+    {
+    public:
+        bool open(const std::string &path, std::string &outError);
+        void close();
+        bool isOpen() const { return m_header != nullptr; }
+        const std::string &path() const { return m_path; }
+
+        // nullptr when the pack has no such path.
+        const PackEntryRecord *find(const std::string &path) const;
+
+        // Uncompressed entries: the bytes in the mapping (valid while the pack is open).
+        // Compressed entries: nullptr, use read().
+        const uint8_t *data(const PackEntryRecord &entry) const;
+
+        // Original bytes of any entry.
+        bool read(const PackEntryRecord &entry, std::vector<uint8_t> &out) const;
+
+        uint32_t entryCount() const { return m_header ? m_header->entryCount : 0u; }
+        const PackEntryRecord &entry(uint32_t index) const { return m_toc[index]; }
+        std::string entryPath(const PackEntryRecord &entry) const;
+
+    private:
+        MappedFile m_file;
+        std::string m_path;
+        const PackHeader *m_header = nullptr;
+        const PackEntryRecord *m_toc = nullptr;
+        const char *m_strings = nullptr;
+    };
+
+    // Builds a pack in memory order of add(); write() sorts the TOC.
+    class AssetPackWriter
+    {
+    public:
+        // compress: store as LZ4 blocks, unless no block shrinks (the entry is then kept raw).
+        void add(const std::string &path, std::vector<uint8_t> bytes, bool compress);
+        bool write(const std::string &outPath, std::string &outError) const;
+
+    private:
+        struct PendingEntry
+        {
+            std::string path; // normalized
+            std::vector<uint8_t> bytes;
+            bool compress = false;
+        };
+        std::vector<PendingEntry> m_entries;
+        std::unordered_map<std::string, size_t> m_index; // path -> m_entries slot (re-adding replaces)
+    };
+
+} // namespace Engine
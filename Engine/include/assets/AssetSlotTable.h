@@ -0,0 +1,215 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace Engine
+{
+    // Residency of a streamed asset (see AssetManager::requestModel).
+    enum class AssetState : uint8_t
+    {
+        Invalid, // unknown or stale handle
+        Pending, // handle issued, data still loading
+        Ready,   // resident; getModel() returns the asset
+        Failed   // load failed; the handle never becomes ready
+    };
+
+    // ============================================================
+    // AssetSlotTable
+    // ============================================================
+    // Generational handle table for one asset type: the owning thread creates, updates and
+    // removes entries while any thread resolves handles without a lock.
+    //
+    // - Slots live in fixed-size chunks that are never moved or freed before the table, so a
+    //   reader can index them while the owner grows the table.
+    // - A slot holds the asset pointer and one atomic word {generation, version, state}. Readers
+    //   load the word, the pointer, then the word again and retry if it changed in between, so a
+    //   pointer is only returned together with the generation it was published under.
+    // - remove() bumps the slot's generation and puts it on the free list. Ids carry the slot
+    //   index in the low 32 bits and its generation in the high 32 bits: a reused slot never
+    //   hands out an id seen before, so caches keyed by id stay correct.
+    // - The table does not own the assets. A pointer resolved on a worker may be used until the
+    //   owner retires the asset; AssetManager retires through its frame-serial destroy queue.
+    template <typename T>
+    class AssetSlotTable
+    {
+    public:
+        // =====================
+        // TUNING CONSTANTS
+        // =====================
+        static constexpr uint32_t CHUNK_SHIFT = 10; // 1024 slots (16 KiB) per chunk
+        static constexpr uint32_t CHUNK_SLOTS = 1u << CHUNK_SHIFT;
+        static constexpr uint32_t MAX_CHUNKS = 4096; // live assets of one type: 4M
+
+        struct Key
+        {
+            uint64_t id = 0;
+            uint32_t generation = 0;
+        };
+
+        AssetSlotTable() = default;
+        ~AssetSlotTable()
+        {
+            for (auto &chunk : m_chunks)
+                delete[] chunk.load(std::memory_order_relaxed);
+        }
+
+        AssetSlotTable(const AssetSlotTable &) = delete;
+        AssetSlotTable &operator=(const AssetSlotTable &) = delete;
+
+        // -------- owner thread --------
+
+        // Key{} when every slot is taken.
+        Key create(T *asset, AssetState state)
+        {
+            uint32_t index;
+            if (!m_freeSlots.empty())
+            {
+                index = m_freeSlots.back();
+                m_freeSlots.pop_back();
+            }
+            else
+            {
+                if ((m_slotCount >> CHUNK_SHIFT) >= MAX_CHUNKS)
+                    return Key{};
+                index = m_slotCount++;
+                if ((index & (CHUNK_SLOTS - 1u)) == 0u)
+                    m_chunks[index >> CHUNK_SHIFT].store(new Slot[CHUNK_SLOTS], std::memory_order_release);
+            }
+
+            Slot &s = slot(index);
+            const uint32_t generation = generationOf(s.word.load(std::memory_order_relaxed));
+            s.asset.store(asset, std::memory_order_seq_cst);
+            s.word.store(pack(generation, 0u, state), std::memory_order_seq_cst);
+            return Key{(static_cast<uint64_t>(generation) << 32) | (index + 1u), generation};
+        }
+
+        // Replace the asset and/or state of a live entry.
+        void publish(uint64_t id, uint32_t generation, T *asset, AssetState state)
+        {
+            Slot *s = find(id);
+            if (!s)
+                return;
+            const uint64_t word = s->word.load(std::memory_order_relaxed);
+            if (generationOf(word) != generation)
+                return;
+            s->asset.store(asset, std::memory_order_seq_cst);
+            s->word.store(pack(generation, versionOf(word) + 1u, state), std::memory_order_seq_cst);
+        }
+
+        void setState(uint64_t id, uint32_t generation, AssetState state)
+        {
+            Slot *s = find(id);
+            if (!s)
+                return;
+            const uint64_t word = s->word.load(std::memory_order_relaxed);
+            if (generationOf(word) != generation)
+                return;
+            s->word.store(pack(generation, versionOf(word) + 1u, state), std::memory_order_seq_cst);
+        }
+
+        // Stale handles resolve to nullptr from now on; the slot is reused by a later create().
+        void remove(uint64_t id, uint32_t generation)
+        {
+            Slot *s = find(id);
+            if (!s)
+                return;
+            const uint64_t word = s->word.load(std::memory_order_relaxed);
+            if (generationOf(word) != generation)
+                return;
+            uint32_t next = generation + 1u;
+            if (next == 0u)
+                next = 1u; // 0 is never a live generation
+            s->asset.store(nullptr, std::memory_order_seq_cst);
+            s->word.store(pack(next, 0u, AssetState::Invalid), std::memory_order_seq_cst);
+            m_freeSlots.push_back(static_cast<uint32_t>(id) - 1u);
+        }
+
+        // Drop every entry (the owner destroyed the assets).
+        void clear()
+        {
+            for (uint32_t i = 0; i < m_slotCount; ++i)
+            {
+                Slot &s = slot(i);
+                const uint64_t word = s.word.load(std::memory_order_relaxed);
+                if (stateOf(word) == AssetState::Invalid)
+                    continue;
+                remove((static_cast<uint64_t>(generationOf(word)) << 32) | (i + 1u), generationOf(word));
+            }
+        }
+
+        uint32_t capacity() const { return m_slotCount; }
+
+        // -------- any thread --------
+
+        // The asset published for the handle (nullptr for stale handles and pending entries).
+        T *resolve(uint64_t id, uint32_t generation) const
+        {
+            const Slot *s = find(id);
+            if (!s)
+                return nullptr;
+            for (;;)
+            {
+                const uint64_t before = s->word.load(std::memory_order_seq_cst);
+                if (generationOf(before) != generation)
+                    return nullptr;
+                T *asset = s->asset.load(std::memory_order_seq_cst);
+                if (s->word.load(std::memory_order_seq_cst) == before)
+                    return asset;
+                // Republished while reading: the next pass sees the new pointer or a new generation.
+            }
+        }
+
+        AssetState state(uint64_t id, uint32_t generation) const
+        {
+            const Slot *s = find(id);
+            if (!s)
+                return AssetState::Invalid;
+            const uint64_t word = s->word.load(std::memory_order_seq_cst);
+            return (generationOf(word) == generation) ? stateOf(word) : AssetState::Invalid;
+        }
+
+        template <typename Handle>
+        T *resolve(const Handle &h) const { return resolve(h.id, h.generation); }
+        template <typename Handle>
+        AssetState state(const Handle &h) const { return state(h.id, h.generation); }
+
+    private:
+        struct Slot
+        {
+            std::atomic<uint64_t> word{pack(1u, 0u, AssetState::Invalid)};
+            std::atomic<T *> asset{nullptr};
+        };
+
+        // [generation:32][version:24][state:8]
+        static constexpr uint64_t pack(uint32_t generation, uint32_t version, AssetState state)
+        {
+            return (static_cast<uint64_t>(generation) << 32) | (static_cast<uint64_t>(version & 0xFFFFFFu) << 8) |
+                   static_cast<uint64_t>(state);
+        }
+        static uint32_t generationOf(uint64_t word) { return static_cast<uint32_t>(word >> 32); }
+        static uint32_t versionOf(uint64_t word) { return static_cast<uint32_t>(word >> 8) & 0xFFFFFFu; }
+        static AssetState stateOf(uint64_t word) { return static_cast<AssetState>(word & 0xFFu); }
+
+        Slot &slot(uint32_t index) const
+        {
+            return m_chunks[index >> CHUNK_SHIFT].load(std::memory_order_relaxed)[index & (CHUNK_SLOTS - 1u)];
+        }
+
+        Slot *find(uint64_t id) const
+        {
+            const uint32_t low = static_cast<uint32_t>(id);
+            if (low == 0u)
+                return nullptr;
+            const uint32_t index = low - 1u;
+            if ((index >> CHUNK_SHIFT) >= MAX_CHUNKS)
+                return nullptr;
+            Slot *chunk = m_chunks[index >> CHUNK_SHIFT].load(std::memory_order_acquire);
+            return chunk ? &chunk[index & (CHUNK_SLOTS - 1u)] : nullptr;
+        }
+
+        std::atomic<Slot *> m_chunks[MAX_CHUNKS]{};
+        uint32_t m_slotCount = 0;           // owner thread
+        std::vector<uint32_t> m_freeSlots;  // owner thread
+    };
+}
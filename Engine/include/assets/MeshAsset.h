@@ -1,8 +1,11 @@
 #pragma once
 #include <vulkan/vulkan.h>
 #include <cstdint>
+#include <memory>
+#include <vector>
 #include "assets/MeshFormats.h"
 #include "utils/BufferUtils.h"
+#include "utils/ImageUtils.h" // UploadContext
 
 namespace Engine
 {
@@ -22,26 +25,94 @@ namespace Engine
                     VkQueue queue,
                     const MeshData &data);
 
+        // Same, reading vertex/index bytes directly from a non-owning view.
+        // Both copies go into one command buffer and one submit.
+        bool upload(VkDevice device,
+                    VkPhysicalDevice phys,
+                    VkCommandPool commandPool,
+                    VkQueue queue,
+                    const MeshDataView &data);
+
+        // Record the copies into an open upload context (staged through ctx.ring when set).
+        // Buffers are usable once the context has been submitted and waited for; if that
+        // submit fails the caller must destroy() the mesh.
+        bool uploadDeferred(UploadContext &ctx, const MeshDataView &data);
+
+        // Upload several meshes into ONE shared vertex buffer and ONE index buffer; outMeshes[i]
+        // becomes a range of them (see getFirstIndex/getVertexOffset). Used for a model's meshes
+        // so its primitives can be drawn without rebinding. All views must share vertexStride;
+        // 16-bit indices are widened when any mesh needs 32-bit ones. The buffers are freed
+        // when the last mesh sharing them is destroyed.
+        static bool uploadMergedDeferred(UploadContext &ctx, const MeshDataView *meshes, uint32_t count, MeshAsset *const *outMeshes);
+
         // Destroy GPU resources
         void destroy(VkDevice device);
 
         // Accessors for rendering
-        VkBuffer getVertexBuffer() const { return m_vb.buffer; }
-        VkBuffer getIndexBuffer() const { return m_ib.buffer; }
+        VkBuffer getVertexBuffer() const { return m_shared ? m_shared->vb.buffer : m_vb.buffer; }
+        VkBuffer getIndexBuffer() const { return m_shared ? m_shared->ib.buffer : m_ib.buffer; }
+        // Where this mesh's range starts inside its (possibly shared) buffers; add to draw offsets.
+        uint32_t getFirstIndex() const { return m_firstIndex; }
+        int32_t getVertexOffset() const { return m_vertexOffset; }
         uint32_t getIndexCount() const { return m_indexCount; }
         VkIndexType getIndexType() const { return m_indexType; }
         uint32_t getVertexStride() const { return m_vertexStride; }
+        // Part of an uploadMergedDeferred() batch; that vertex buffer is a storage buffer too.
+        bool isMerged() const { return m_shared != nullptr; }
         const float *getAABBMin() const { return m_aabbMin; }
         const float *getAABBMax() const { return m_aabbMax; }
 
+        // LOD levels beyond 0 (simplified index ranges in the same index buffer).
+        uint32_t getLodCount() const { return static_cast<uint32_t>(m_lods.size()); }
+        // Index range for a level; 0 is the full mesh, levels past the chain use the coarsest one.
+        void getLodRange(uint32_t level, uint32_t &firstIndex, uint32_t &indexCount) const
+        {
+            if (level == 0 || m_lods.empty())
+            {
+                firstIndex = m_firstIndex;
+                indexCount = m_indexCount;
+                return;
+            }
+            const Lod &l = m_lods[(level <= m_lods.size() ? level : m_lods.size()) - 1];
+            firstIndex = l.firstIndex;
+            indexCount = l.indexCount;
+        }
+        // Device memory behind this mesh. Merged meshes report an equal share of their shared
+        // buffers, so summing every mesh of a model gives the buffers' size once.
+        uint64_t getGpuBytes() const
+        {
+            if (m_shared)
+                return (m_shared->vb.memory.size + m_shared->ib.memory.size) / static_cast<uint64_t>(m_shared.use_count());
+            return m_vb.memory.size + m_ib.memory.size;
+        }
+
+        float getLodScreenSize(uint32_t level) const { return (level >= 1 && level <= m_lods.size()) ? m_lods[level - 1].screenSize : 0.0f; }
+
     private:
+        struct Lod
+        {
+            uint32_t firstIndex = 0;
+            uint32_t indexCount = 0;
+            float screenSize = 0.0f;
+        };
+
+        struct SharedBuffers
+        {
+            VertexBufferHandle vb{};
+            IndexBufferHandle ib{};
+        };
+
         VertexBufferHandle m_vb{};
         IndexBufferHandle m_ib{};
+        std::shared_ptr<SharedBuffers> m_shared; // set for merged meshes (m_vb/m_ib unused)
+        uint32_t m_firstIndex = 0;
+        int32_t m_vertexOffset = 0;
         uint32_t m_indexCount = 0;
         VkIndexType m_indexType = VK_INDEX_TYPE_UINT32;
         uint32_t m_vertexStride = 0;
         float m_aabbMin[3]{};
         float m_aabbMax[3]{};
+        std::vector<Lod> m_lods;
     };
 
 } // namespace Engine
\ No newline at end of file
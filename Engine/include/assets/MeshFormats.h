@@ -32,6 +32,52 @@ namespace Engine
         float aabbMax[3]{};
     };
 
+    // Simplified index list over the same vertices (one LOD level); same indexFormat as the mesh.
+    struct MeshLodView
+    {
+        const void *indices = nullptr;
+        uint32_t indexCount = 0;
+        float screenSize = 0.0f; // use when projected radius / half viewport height is below this
+    };
+
+    // Non-owning mesh source (e.g. pointing into a memory-mapped .smodel blob).
+    // Uploads copy straight from these pointers into staging memory.
+    struct MeshDataView
+    {
+        const uint8_t *vertexBytes = nullptr; // vertexCount * vertexStride bytes
+        uint64_t vertexByteSize = 0;
+        const void *indices = nullptr;        // uint16 when indexFormat==0, uint32 when 1
+        uint32_t vertexCount = 0;
+        uint32_t indexCount = 0;
+        uint32_t vertexStride = 0;
+        uint32_t indexFormat = 1;
+        float aabbMin[3]{};
+        float aabbMax[3]{};
+
+        // Optional LOD levels 1..lodCount (coarser first-to-last); uploaded after the base indices.
+        const MeshLodView *lods = nullptr;
+        uint32_t lodCount = 0;
+    };
+
+    inline MeshDataView makeMeshDataView(const MeshData &data)
+    {
+        MeshDataView v;
+        v.vertexBytes = data.vertexBytes.data();
+        v.vertexByteSize = data.vertexBytes.size();
+        v.indices = (data.indexFormat == 1) ? static_cast<const void *>(data.indices32.data())
+                                            : static_cast<const void *>(data.indices16.data());
+        v.vertexCount = data.vertexCount;
+        v.indexCount = data.indexCount;
+        v.vertexStride = data.vertexStride;
+        v.indexFormat = data.indexFormat;
+        for (int i = 0; i < 3; ++i)
+        {
+            v.aabbMin[i] = data.aabbMin[i];
+            v.aabbMax[i] = data.aabbMax[i];
+        }
+        return v;
+    }
+
     // Returns true on success, fills MeshData
     bool LoadSMeshV0FromFile(const std::string &path, MeshData &out);
 
@@ -0,0 +1,73 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Engine
+{
+    // ------------------------------------------------------------
+    // Offline-style index/vertex ordering for triangle lists (meshoptimizer-like).
+    //
+    // - OptimizeVertexCache: Forsyth's linear-speed reordering for the post-transform cache.
+    // - OptimizeOverdraw: splits the cache-ordered list at hard cache boundaries and draws
+    //   outward-facing clusters first, so the depth test rejects more of what follows. Only
+    //   boundaries where the cache restarts anyway are cut, so cache efficiency is kept.
+    // - OptimizeVertexFetch: renumbers vertices in first-use order so fetches walk memory
+    //   forward; every list indexing the vertices is rewritten.
+    //
+    // OptimizeMesh runs all three. The cook tools (GltfToSmodel, ObjToSmesh) apply it, so loads
+    // do no mesh work; AssetManager::setOptimizeUncookedMeshes is an opt-in fallback for
+    // .smodel files cooked without it.
+    //
+    // BuildMeshlets / ComputeMeshletBounds cut an (already ordered) list into the small clusters
+    // mesh shaders and per-cluster culling work on; the cook tool runs them after OptimizeMesh.
+    // ------------------------------------------------------------
+    void OptimizeVertexCache(uint32_t *indices, size_t indexCount, size_t vertexCount);
+
+    // positions: float3 at the start of each vertex, vertexStride bytes apart.
+    void OptimizeOverdraw(uint32_t *indices, size_t indexCount,
+                          const uint8_t *vertices, size_t vertexCount, size_t vertexStride);
+
+    // Reorders vertices (vertexStride bytes each) in place by first use over lists[0..listCount),
+    // in order, and remaps every list. Unreferenced vertices move to the end.
+    void OptimizeVertexFetch(uint8_t *vertices, size_t vertexCount, size_t vertexStride,
+                             std::vector<uint32_t> *lists, size_t listCount);
+
+    // lists[0] is the full-detail index list (cache + overdraw order); the others (LOD levels
+    // over the same vertices) get cache order. Then one vertex fetch reorder for all of them.
+    void OptimizeMesh(uint8_t *vertices, size_t vertexCount, size_t vertexStride,
+                      std::vector<uint32_t> *lists, size_t listCount);
+
+    // One cluster of BuildMeshlets: triangles [firstTriangle, firstTriangle + triangleCount) of
+    // the source list, with their vertices listed once at vertexOffset.. of the vertex array.
+    struct Meshlet
+    {
+        uint32_t firstTriangle = 0;
+        uint32_t vertexOffset = 0;   // into the meshlet vertex array
+        uint32_t triangleOffset = 0; // into the meshlet triangle array (3 local indices each)
+        uint32_t vertexCount = 0;
+        uint32_t triangleCount = 0;
+    };
+
+    // Mesh-space culling bounds: sphere, plus a backface cone (cutoff 1 = never culled).
+    struct MeshletBounds
+    {
+        float center[3] = {0.0f, 0.0f, 0.0f};
+        float radius = 0.0f;
+        float coneAxis[3] = {0.0f, 0.0f, 1.0f};
+        float coneCutoff = 1.0f;
+    };
+
+    // Greedy scan in list order: a meshlet ends when the next triangle would exceed either limit,
+    // so no triangle moves and every meshlet is also a contiguous range of the list. Cache-ordered
+    // input (OptimizeMesh) keeps them compact. meshletVertices gets mesh vertex indices,
+    // meshletTriangles per-meshlet local indices (maxVertices <= 256).
+    void BuildMeshlets(const uint32_t *indices, size_t indexCount, size_t vertexCount,
+                       uint32_t maxVertices, uint32_t maxTriangles, std::vector<Meshlet> &meshlets,
+                       std::vector<uint32_t> &meshletVertices, std::vector<uint8_t> &meshletTriangles);
+
+    // positions: float3 at the start of each vertex, vertexStride bytes apart.
+    MeshletBounds ComputeMeshletBounds(const Meshlet &meshlet, const uint32_t *meshletVertices,
+                                       const uint8_t *meshletTriangles, const uint8_t *vertices, size_t vertexStride);
+
+} // namespace Engine
@@ -9,6 +9,10 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include "assets/Handles.h" // MeshHandle, MaterialHandle
 #include "assets/model/SModelAnimationRecords.h"
+#include "assets/model/SModelBakedAnimation.h"
+#include "assets/model/SModelQuantizedAnimation.h"
+#include "utils/SimdMat4.h"
+#include "utils/SimdQuat.h"
 
 namespace Engine
 {
@@ -28,6 +32,27 @@ namespace Engine
 
         // Skinning (V4): -1 means unskinned.
         int32_t skinIndex = -1;
+
+        // Meshlets (V4.6): ModelAsset::meshlets[firstMeshlet, +meshletCount) tile this
+        // primitive's index range. Zero when the model has none or the primitive draws part
+        // of its mesh.
+        uint32_t firstMeshlet = 0;
+        uint32_t meshletCount = 0;
+    };
+
+    // One smodel::SModelMeshletRecord, mesh-relative like the file.
+    struct ModelMeshlet
+    {
+        uint32_t firstIndex = 0; // into the mesh's index list
+        uint32_t triangleCount = 0;
+        uint32_t vertexOffset = 0;   // into ModelAsset::meshletVertices
+        uint32_t triangleOffset = 0; // byte into ModelAsset::meshletTriangles
+        uint32_t vertexCount = 0;
+        int32_t anchorJoint = -1; // skin-local, -1 = rigid
+        float center[3]{0.0f, 0.0f, 0.0f};
+        float radius = 0.0f;
+        float coneAxis[3]{0.0f, 0.0f, 1.0f};
+        float coneCutoff = 1.0f;
     };
 
     struct ModelAsset
@@ -41,6 +66,16 @@ namespace Engine
             bool playing = false;
         };
 
+        // Rotation key interpolation of raw (unquantized) clips in samplePoseTRS and the
+        // evaluate*PoseInto calls. Nlerp: shortest-arc normalized lerp, four channels per SIMD
+        // batch; indistinguishable from slerp at 30 Hz+ key rates and free of trig. Quantized
+        // clips always use nlerp.
+        enum class RotationSampling : uint8_t
+        {
+            Slerp,
+            Nlerp
+        };
+
         struct NodeTRS
         {
             glm::vec3 t{0.0f, 0.0f, 0.0f};
@@ -71,6 +106,12 @@ namespace Engine
         std::vector<uint32_t> nodeChildIndices;
         uint32_t rootNodeIndex{0};
 
+        // Parent-before-child walk from the roots (first visit wins, like the recursive walk)
+        // so globals are one flat loop. evalParents[node] is the parent the node inherits
+        // from (~0 = root, ~1 = unreachable, keeps identity). Built by buildEvaluationOrder().
+        std::vector<uint32_t> evalOrder;
+        std::vector<uint32_t> evalParents;
+
         // ------------------------------------------------------------
         // Skinning (V4)
         // ------------------------------------------------------------
@@ -102,6 +143,40 @@ namespace Engine
         std::vector<float> animTimes;
         std::vector<float> animValues;
 
+        // Baked palettes (V4.2, optional): see smodel::SModelBakedAnimationHeader for the
+        // frame layout. Empty unless the model was cooked with --bake-anim.
+        float bakedSampleRate = 0.0f;
+        std::vector<smodel::SModelBakedClipRecord> bakedClips;
+        std::vector<float> bakedFrames;
+
+        // Quantized clips (V4.4, optional): see smodel::SModelQuantizedAnimHeader. When present
+        // CPU evaluation samples these (decoded on demand) instead of the raw channels.
+        float quantizedSampleRate = 0.0f;
+        std::vector<smodel::SModelQuantizedClipRecord> quantizedClips;
+        std::vector<smodel::SModelQuantizedTrackRecord> quantizedTracks;
+        std::vector<uint16_t> quantizedData;
+
+        // Mesh LOD thresholds (V4.3, optional): lodScreenSizes[l] is the projected size below
+        // which level l + 1 is drawn (descending). Empty unless cooked with --lods.
+        std::vector<float> lodScreenSizes;
+
+        // Octahedral impostor (V4.5, optional): see smodel::SModelImpostorHeader. The material's
+        // baseColor / normal textures are the albedo and normal+depth atlases; it is one of the
+        // model's material dependencies. Invalid unless cooked with --impostor.
+        MaterialHandle impostorMaterial{};
+        uint32_t impostorFrames = 0;  // frames per atlas side
+        uint32_t impostorMapping = 0; // smodel::ImpostorMapping
+        float impostorCenter[3]{0.0f, 0.0f, 0.0f};
+        float impostorRadius = 0.0f;
+        bool hasImpostor() const { return impostorMaterial.isValid() && impostorFrames >= 2u; }
+
+        // Meshlets (V4.6, optional): see smodel::SModelMeshletHeader. Empty unless cooked with
+        // --meshlets (or a .meshlets.json sidecar).
+        std::vector<ModelMeshlet> meshlets;
+        std::vector<uint32_t> meshletVertices; // mesh-local vertex indices
+        std::vector<uint8_t> meshletTriangles; // 3 meshlet-local indices per triangle
+        bool hasMeshlets() const { return !meshlets.empty(); }
+
         // Optional debug name (string table later)
         const char *debugName = "";
 
@@ -143,6 +218,28 @@ namespace Engine
             return lo;
         }
 
+        // Same result as FindKeyInterval, continuing from the interval found last time: forward
+        // playback advances at most a few keys, so only backward jumps (loop wrap) or large
+        // skips fall back to the binary search. cursor is updated in place.
+        static inline uint32_t FindKeyIntervalFrom(const float *times, uint32_t count, float t, uint32_t &cursor)
+        {
+            static constexpr uint32_t MAX_FORWARD_STEPS = 4;
+
+            if (count <= 1)
+                return cursor = 0;
+            uint32_t i = cursor;
+            if (i <= count - 2 && times[i] <= t)
+            {
+                for (uint32_t step = 0; step < MAX_FORWARD_STEPS; ++step)
+                {
+                    if (i + 2 >= count || times[i + 1] > t)
+                        return cursor = i;
+                    ++i;
+                }
+            }
+            return cursor = FindKeyInterval(times, count, t);
+        }
+
         static inline float ComputeAlpha(float t0, float t1, float t)
         {
             float dt = t1 - t0;
@@ -156,14 +253,16 @@ namespace Engine
             return a;
         }
 
-        static inline glm::vec3 SampleVec3(const float *times, const float *values, uint32_t keyCount, float t)
+        // cursor: optional per-channel interval cache (see FindKeyIntervalFrom).
+        static inline glm::vec3 SampleVec3(const float *times, const float *values, uint32_t keyCount, float t,
+                                           uint32_t *cursor = nullptr)
         {
             if (keyCount == 0)
                 return glm::vec3(0.0f);
             if (keyCount == 1)
                 return glm::vec3(values[0], values[1], values[2]);
 
-            uint32_t i = FindKeyInterval(times, keyCount, t);
+            uint32_t i = cursor ? FindKeyIntervalFrom(times, keyCount, t, *cursor) : FindKeyInterval(times, keyCount, t);
             float t0 = times[i];
             float t1 = times[i + 1];
             float a = ComputeAlpha(t0, t1, t);
@@ -175,7 +274,8 @@ namespace Engine
             return glm::mix(p0, p1, a);
         }
 
-        static inline glm::quat SampleQuat(const float *times, const float *values, uint32_t keyCount, float t)
+        static inline glm::quat SampleQuat(const float *times, const float *values, uint32_t keyCount, float t,
+                                           uint32_t *cursor = nullptr)
         {
             if (keyCount == 0)
                 return glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
@@ -186,7 +286,7 @@ namespace Engine
                 return glm::normalize(q);
             }
 
-            uint32_t i = FindKeyInterval(times, keyCount, t);
+            uint32_t i = cursor ? FindKeyIntervalFrom(times, keyCount, t, *cursor) : FindKeyInterval(times, keyCount, t);
             float t0 = times[i];
             float t1 = times[i + 1];
             float a = ComputeAlpha(t0, t1, t);
@@ -206,49 +306,138 @@ namespace Engine
             return glm::normalize(glm::slerp(q0, q1, a));
         }
 
+        inline void buildEvaluationOrder()
+        {
+            const uint32_t nodeCount = static_cast<uint32_t>(nodes.size());
+            const uint32_t U32_MAX = ~0u;
+            evalOrder.clear();
+            evalOrder.reserve(nodeCount);
+            evalParents.assign(nodeCount, U32_MAX - 1u);
+
+            std::vector<uint8_t> visited(nodeCount, 0);
+            std::vector<std::pair<uint32_t, uint32_t>> stack;
+            for (uint32_t root = 0; root < nodeCount; ++root)
+            {
+                if (nodes[root].parentIndex != U32_MAX)
+                    continue;
+                stack.emplace_back(root, U32_MAX);
+                while (!stack.empty())
+                {
+                    const auto [node, parent] = stack.back();
+                    stack.pop_back();
+                    if (node >= nodeCount || visited[node])
+                        continue;
+                    visited[node] = 1;
+                    evalOrder.push_back(node);
+                    evalParents[node] = parent;
+
+                    const ModelNode &n = nodes[node];
+                    if (n.childCount == 0 || n.firstChildIndex == U32_MAX)
+                        continue;
+                    // Reverse push so children pop in declaration order.
+                    for (uint32_t ci = n.childCount; ci-- > 0;)
+                    {
+                        const uint32_t childSlot = n.firstChildIndex + ci;
+                        if (childSlot < nodeChildIndices.size())
+                            stack.emplace_back(nodeChildIndices[childSlot], node);
+                    }
+                }
+            }
+        }
+
+        inline bool hasEvaluationOrder() const
+        {
+            return evalParents.size() == nodes.size();
+        }
+
         inline void recomputeGlobals()
         {
             const uint32_t nodeCount = static_cast<uint32_t>(nodes.size());
             if (nodeCount == 0)
                 return;
 
-            const uint32_t U32_MAX = ~0u;
-            std::vector<uint8_t> visited(nodeCount, 0);
-
-            std::function<void(uint32_t, const glm::mat4 &)> compute = [&](uint32_t nodeIdx, const glm::mat4 &parentGlobal)
+            if (!hasEvaluationOrder())
+                buildEvaluationOrder();
+            for (uint32_t node : evalOrder)
             {
-                if (nodeIdx >= nodeCount)
-                    return;
-                if (visited[nodeIdx])
-                    return;
-                visited[nodeIdx] = 1;
+                const uint32_t parent = evalParents[node];
+                ModelNode &n = nodes[node];
+                if (parent >= nodeCount)
+                    n.globalMatrix = n.localMatrix;
+                else
+                    simd::MulMat4(nodes[parent].globalMatrix, n.localMatrix, n.globalMatrix);
+            }
+        }
 
-                ModelNode &n = nodes[nodeIdx];
-                n.globalMatrix = parentGlobal * n.localMatrix;
+        inline bool hasQuantizedAnimation() const
+        {
+            return quantizedSampleRate > 0.0f && !quantizedClips.empty() && quantizedClips.size() == animClips.size();
+        }
 
-                if (n.childCount == 0)
-                    return;
-                if (n.firstChildIndex == U32_MAX)
-                    return;
+        // Overwrite the animated TRS of every track of a quantized clip at time t. Frames are
+        // contiguous per clip, so this reads two adjacent runs of words with no key search.
+        inline void sampleQuantizedInto(uint32_t clipIndex, float t, std::vector<NodeTRS> &trs) const
+        {
+            const auto &clip = quantizedClips[std::min(clipIndex, static_cast<uint32_t>(quantizedClips.size() - 1))];
+            const float framePos = std::clamp(t, 0.0f, clip.durationSec) * quantizedSampleRate;
+            const uint32_t f0 = std::min(static_cast<uint32_t>(framePos), clip.frameCount - 1);
+            const uint32_t f1 = std::min(f0 + 1, clip.frameCount - 1);
+            const float a = std::clamp(framePos - static_cast<float>(f0), 0.0f, 1.0f);
 
-                const uint32_t start = n.firstChildIndex;
-                for (uint32_t ci = 0; ci < n.childCount; ++ci)
+            const uint16_t *w0 = quantizedData.data() + clip.dataOffset + static_cast<size_t>(f0) * clip.frameWords;
+            const uint16_t *w1 = quantizedData.data() + clip.dataOffset + static_cast<size_t>(f1) * clip.frameWords;
+
+            for (uint32_t k = 0; k < clip.trackCount; ++k)
+            {
+                const auto &tr = quantizedTracks[clip.firstTrack + k];
+                if (tr.targetNode >= trs.size())
+                    continue;
+                NodeTRS &out = trs[tr.targetNode];
+
+                if (tr.path == (uint16_t)smodel::SModelAnimPath::Rotation)
                 {
-                    const uint32_t child = nodeChildIndices[start + ci];
-                    compute(child, n.globalMatrix);
+                    float q[4];
+                    if (tr.encoding == (uint16_t)smodel::QuantizedTrackEncoding::Constant)
+                    {
+                        q[0] = tr.rangeMin[0];
+                        q[1] = tr.rangeMin[1];
+                        q[2] = tr.rangeMin[2];
+                        q[3] = tr.rangeExtent[0];
+                    }
+                    else
+                    {
+                        float q1[4];
+                        smodel::DecodeQuatSmallest3(w0 + tr.wordOffset, q);
+                        smodel::DecodeQuatSmallest3(w1 + tr.wordOffset, q1);
+                        const float d = q[0] * q1[0] + q[1] * q1[1] + q[2] * q1[2] + q[3] * q1[3];
+                        const float sgn = (d < 0.0f) ? -1.0f : 1.0f;
+                        for (int c = 0; c < 4; ++c)
+                            q[c] = q[c] + (q1[c] * sgn - q[c]) * a; // frames are close: nlerp
+                    }
+                    out.r = glm::normalize(glm::quat(q[3], q[0], q[1], q[2]));
+                    continue;
                 }
-            };
 
-            for (uint32_t i = 0; i < nodeCount; ++i)
-            {
-                if (nodes[i].parentIndex == U32_MAX)
-                    compute(i, glm::mat4(1.0f));
+                glm::vec3 v(tr.rangeMin[0], tr.rangeMin[1], tr.rangeMin[2]);
+                if (tr.encoding != (uint16_t)smodel::QuantizedTrackEncoding::Constant)
+                {
+                    for (int c = 0; c < 3; ++c)
+                    {
+                        const float v0 = smodel::DecodeRange16(w0[tr.wordOffset + c], tr.rangeMin[c], tr.rangeExtent[c]);
+                        const float v1 = smodel::DecodeRange16(w1[tr.wordOffset + c], tr.rangeMin[c], tr.rangeExtent[c]);
+                        v[c] = v0 + (v1 - v0) * a;
+                    }
+                }
+                if (tr.path == (uint16_t)smodel::SModelAnimPath::Translation)
+                    out.t = v;
+                else if (tr.path == (uint16_t)smodel::SModelAnimPath::Scale)
+                    out.s = v;
             }
         }
 
         inline void updateAnimation(float dtSeconds)
         {
-            if (animClips.empty() || animChannels.empty() || animSamplers.empty())
+            if (animClips.empty() || ((animChannels.empty() || animSamplers.empty()) && !hasQuantizedAnimation()))
                 return;
             if (!animState.playing)
                 return;
@@ -289,8 +478,11 @@ namespace Engine
                 animatedTRS.assign(nodes.size(), NodeTRS{});
             }
 
+            if (hasQuantizedAnimation())
+                sampleQuantizedInto(clipIndex, t, animatedTRS);
+
             const uint32_t clipFirst = clip.firstChannel;
-            const uint32_t clipCount = clip.channelCount;
+            const uint32_t clipCount = hasQuantizedAnimation() ? 0u : clip.channelCount;
             for (uint32_t ci = 0; ci < clipCount; ci++)
             {
                 const uint32_t chIdx = clipFirst + ci;
@@ -339,35 +531,98 @@ namespace Engine
             recomputeGlobals();
         }
 
-        // Evaluate clip at an explicit time into globalsOut (nodeCount matrices).
-        // This does not mutate nodes/local/global matrices, so it can be used per entity.
-        inline void evaluatePoseInto(uint32_t clipIndex, float timeSec,
-                                     std::vector<NodeTRS> &trsScratch,
-                                     std::vector<glm::mat4> &localsScratch,
-                                     std::vector<glm::mat4> &globalsOut,
-                                     std::vector<uint8_t> &visitedScratch) const
+        // Coarsest level whose threshold the projected size (bounding radius / half viewport
+        // height) falls under; 0 = full detail.
+        inline uint32_t selectLod(float screenSize) const
+        {
+            uint32_t level = 0;
+            while (level < lodScreenSizes.size() && screenSize < lodScreenSizes[level])
+                ++level;
+            return level;
+        }
+
+        inline bool hasBakedAnimation() const
+        {
+            return bakedSampleRate > 0.0f && !bakedClips.empty() && !bakedFrames.empty();
+        }
+
+        // Sample the baked palettes at an explicit time: two frame fetches and a lerp per matrix,
+        // no channel sampling or hierarchy walk. Only valid when hasBakedAnimation().
+        inline void sampleBakedPoseInto(uint32_t clipIndex, float timeSec,
+                                        std::vector<glm::mat4> &nodesOut,
+                                        std::vector<glm::mat4> &jointsOut) const
+        {
+            nodesOut.resize(nodes.size());
+            jointsOut.resize(totalJointCount);
+            sampleBakedPoseInto(clipIndex, timeSec, nodesOut.data(), jointsOut.data());
+        }
+
+        // Same, into caller storage of nodes.size() and totalJointCount matrices.
+        inline void sampleBakedPoseInto(uint32_t clipIndex, float timeSec, glm::mat4 *nodesOut, glm::mat4 *jointsOut) const
         {
             const uint32_t nodeCount = static_cast<uint32_t>(nodes.size());
-            globalsOut.assign(nodeCount, glm::mat4(1.0f));
-            if (nodeCount == 0)
-                return;
+            const uint32_t jointCount = totalJointCount;
 
-            trsScratch.resize(nodeCount);
-            localsScratch.resize(nodeCount);
-            visitedScratch.assign(nodeCount, 0);
+            const auto &clip = bakedClips[std::min(clipIndex, static_cast<uint32_t>(bakedClips.size() - 1))];
+            const float t = std::min(std::max(timeSec, 0.0f), clip.durationSec);
+            const float framePos = t * bakedSampleRate;
+            const uint32_t f0 = std::min(static_cast<uint32_t>(framePos), clip.frameCount - 1u);
+            const uint32_t f1 = std::min(f0 + 1u, clip.frameCount - 1u);
+            const float a = std::min(std::max(framePos - static_cast<float>(f0), 0.0f), 1.0f);
 
-            // Start from rest pose if available.
-            if (restTRS.size() == nodes.size())
+            const size_t frameFloats = static_cast<size_t>(smodel::BakedFrameFloats(nodeCount, jointCount));
+            const float *r0 = bakedFrames.data() + (static_cast<size_t>(clip.firstFrame) + f0) * frameFloats;
+            const float *r1 = bakedFrames.data() + (static_cast<size_t>(clip.firstFrame) + f1) * frameFloats;
+
+            auto unpack = [&](uint32_t m) -> glm::mat4
             {
-                trsScratch = restTRS;
-            }
+                // Three stored rows -> column-major mat4 with an implicit (0, 0, 0, 1) bottom row.
+                glm::mat4 out(1.0f);
+                for (uint32_t row = 0; row < 3; ++row)
+                {
+                    for (uint32_t col = 0; col < 4; ++col)
+                    {
+                        const size_t ix = static_cast<size_t>(m) * 12u + row * 4u + col;
+                        out[col][row] = r0[ix] + (r1[ix] - r0[ix]) * a;
+                    }
+                }
+                return out;
+            };
+
+            for (uint32_t i = 0; i < nodeCount; ++i)
+                nodesOut[i] = unpack(i);
+            for (uint32_t j = 0; j < jointCount; ++j)
+                jointsOut[j] = unpack(nodeCount + j);
+        }
+
+        // Channels in a clip (size of a per-instance key cursor cache for it).
+        inline uint32_t clipChannelCount(uint32_t clipIndex) const
+        {
+            if (animClips.empty())
+                return 0u;
+            return animClips[std::min(clipIndex, static_cast<uint32_t>(animClips.size() - 1))].channelCount;
+        }
+
+        // Evaluate clip at an explicit time into globalsOut (nodeCount matrices).
+        // This does not mutate nodes/local/global matrices, so it can be used per entity.
+        // keyCursors (optional): clipChannelCount(clipIndex) entries owned by the instance, kept
+        // across calls for the same clip so sampling resumes from the previous key intervals.
+        // Rest pose with every channel of clipIndex applied at timeSec (quantized or raw keys).
+        // rotation picks how raw rotation keys are interpolated (see RotationSampling).
+        inline void samplePoseTRS(uint32_t clipIndex, float timeSec, std::vector<NodeTRS> &trsOut,
+                                  uint32_t *keyCursors = nullptr,
+                                  RotationSampling rotation = RotationSampling::Slerp) const
+        {
+            if (restTRS.size() == nodes.size())
+                trsOut = restTRS;
             else
+                trsOut.assign(nodes.size(), NodeTRS{});
+
+            if (hasQuantizedAnimation())
             {
-                for (uint32_t i = 0; i < nodeCount; ++i)
-                    trsScratch[i] = NodeTRS{};
+                sampleQuantizedInto(clipIndex, timeSec, trsOut);
             }
-
-            if (!animClips.empty() && !animChannels.empty() && !animSamplers.empty())
+            else if (!animClips.empty() && !animChannels.empty() && !animSamplers.empty())
             {
                 const uint32_t safeClip = std::min(clipIndex, static_cast<uint32_t>(animClips.size() - 1));
                 const auto &clip = animClips[safeClip];
@@ -375,6 +630,7 @@ namespace Engine
                 const float t = timeSec;
                 const uint32_t clipFirst = clip.firstChannel;
                 const uint32_t clipCount = clip.channelCount;
+                NlerpBatch nlerp;
                 for (uint32_t ci = 0; ci < clipCount; ci++)
                 {
                     const uint32_t chIdx = clipFirst + ci;
@@ -386,7 +642,7 @@ namespace Engine
                         continue;
                     const auto &s = animSamplers[ch.samplerIndex];
 
-                    if (ch.targetNode >= trsScratch.size())
+                    if (ch.targetNode >= trsOut.size())
                         continue;
 
                     if (s.timeCount == 0)
@@ -401,24 +657,170 @@ namespace Engine
                     else
                         continue;
 
+                    uint32_t *cursor = keyCursors ? &keyCursors[ci] : nullptr;
                     if (ch.path == (uint16_t)smodel::SModelAnimPath::Translation)
                     {
-                        trsScratch[ch.targetNode].t = SampleVec3(times, values, s.timeCount, t);
+                        trsOut[ch.targetNode].t = SampleVec3(times, values, s.timeCount, t, cursor);
                     }
                     else if (ch.path == (uint16_t)smodel::SModelAnimPath::Scale)
                     {
-                        trsScratch[ch.targetNode].s = SampleVec3(times, values, s.timeCount, t);
+                        trsOut[ch.targetNode].s = SampleVec3(times, values, s.timeCount, t, cursor);
                     }
                     else if (ch.path == (uint16_t)smodel::SModelAnimPath::Rotation)
                     {
-                        trsScratch[ch.targetNode].r = SampleQuat(times, values, s.timeCount, t);
+                        if (rotation == RotationSampling::Nlerp)
+                            nlerp.add(times, values, s.timeCount, t, cursor, &trsOut[ch.targetNode].r);
+                        else
+                            trsOut[ch.targetNode].r = SampleQuat(times, values, s.timeCount, t, cursor);
                     }
                 }
+                nlerp.flush();
+            }
+        }
+
+        // Rotation channels of one samplePoseTRS call gathered into SoA lanes, four per
+        // simd::NlerpQuat4; results land in their targets in channel order.
+        struct NlerpBatch
+        {
+            float x0[4], y0[4], z0[4], w0[4];
+            float x1[4], y1[4], z1[4], w1[4];
+            float alpha[4];
+            glm::quat *out[4];
+            uint32_t lanes = 0;
+
+            inline void add(const float *times, const float *values, uint32_t keyCount, float t, uint32_t *cursor,
+                            glm::quat *target)
+            {
+                if (keyCount < 2)
+                {
+                    *target = SampleQuat(times, values, keyCount, t, cursor);
+                    return;
+                }
+                const uint32_t i = cursor ? FindKeyIntervalFrom(times, keyCount, t, *cursor) : FindKeyInterval(times, keyCount, t);
+                const float *v0 = values + i * 4; // stored XYZW
+                const float *v1 = values + (i + 1) * 4;
+                x0[lanes] = v0[0];
+                y0[lanes] = v0[1];
+                z0[lanes] = v0[2];
+                w0[lanes] = v0[3];
+                x1[lanes] = v1[0];
+                y1[lanes] = v1[1];
+                z1[lanes] = v1[2];
+                w1[lanes] = v1[3];
+                alpha[lanes] = ComputeAlpha(times[i], times[i + 1], t);
+                out[lanes] = target;
+                if (++lanes == 4u)
+                    flush();
             }
 
-            for (uint32_t i = 0; i < nodeCount; ++i)
-                localsScratch[i] = ComposeTRS(trsScratch[i]);
+            inline void flush()
+            {
+                if (lanes == 0)
+                    return;
+                for (uint32_t k = lanes; k < 4u; ++k)
+                {
+                    x0[k] = y0[k] = z0[k] = x1[k] = y1[k] = z1[k] = alpha[k] = 0.0f;
+                    w0[k] = w1[k] = 1.0f;
+                }
+                simd::NlerpQuat4(x0, y0, z0, w0, x1, y1, z1, w1, alpha);
+                for (uint32_t k = 0; k < lanes; ++k)
+                    *out[k] = glm::quat(w0[k], x0[k], y0[k], z0[k]);
+                lanes = 0;
+            }
+        };
+
+        // a = mix(a, b, weightB) per node; rotations take the shortest arc (nlerp).
+        static inline void BlendTRS(std::vector<NodeTRS> &a, const std::vector<NodeTRS> &b, float weightB)
+        {
+            const size_t count = std::min(a.size(), b.size());
+            const float wa = 1.0f - weightB;
+            for (size_t i = 0; i < count; ++i)
+            {
+                NodeTRS &x = a[i];
+                const NodeTRS &y = b[i];
+                x.t = x.t * wa + y.t * weightB;
+                x.s = x.s * wa + y.s * weightB;
+                const float wb = (glm::dot(x.r, y.r) < 0.0f) ? -weightB : weightB;
+                x.r = glm::normalize(glm::quat(x.r.w * wa + y.r.w * wb, x.r.x * wa + y.r.x * wb,
+                                               x.r.y * wa + y.r.y * wb, x.r.z * wa + y.r.z * wb));
+            }
+        }
+
+        inline void evaluatePoseInto(uint32_t clipIndex, float timeSec,
+                                     std::vector<NodeTRS> &trsScratch,
+                                     std::vector<glm::mat4> &localsScratch,
+                                     std::vector<glm::mat4> &globalsOut,
+                                     std::vector<uint8_t> &visitedScratch,
+                                     uint32_t *keyCursors = nullptr,
+                                     RotationSampling rotation = RotationSampling::Slerp) const
+        {
+            if (nodes.empty())
+            {
+                globalsOut.clear();
+                return;
+            }
+            samplePoseTRS(clipIndex, timeSec, trsScratch, keyCursors, rotation);
+            composeGlobals(trsScratch, localsScratch, globalsOut, visitedScratch);
+        }
+
+        // Crossfade: clipIndex with weight, fromClip with 1 - weight. Both clips are sampled to
+        // TRS and mixed per node before one compose + hierarchy walk, so a fade costs a single
+        // evaluation plus the second clip's channel sampling. keyCursors belong to clipIndex.
+        inline void evaluateBlendedPoseInto(uint32_t clipIndex, float timeSec,
+                                            uint32_t fromClip, float fromTimeSec, float weight,
+                                            std::vector<NodeTRS> &trsScratch,
+                                            std::vector<NodeTRS> &blendScratch,
+                                            std::vector<glm::mat4> &localsScratch,
+                                            std::vector<glm::mat4> &globalsOut,
+                                            std::vector<uint8_t> &visitedScratch,
+                                            uint32_t *keyCursors = nullptr,
+                                            RotationSampling rotation = RotationSampling::Slerp) const
+        {
+            if (nodes.empty())
+            {
+                globalsOut.clear();
+                return;
+            }
+            samplePoseTRS(clipIndex, timeSec, trsScratch, keyCursors, rotation);
+            if (weight < 1.0f)
+            {
+                samplePoseTRS(fromClip, fromTimeSec, blendScratch, nullptr, rotation);
+                // trs = mix(from, to, weight): blend into the "from" pose, then swap back.
+                BlendTRS(blendScratch, trsScratch, std::max(weight, 0.0f));
+                trsScratch.swap(blendScratch);
+            }
+            composeGlobals(trsScratch, localsScratch, globalsOut, visitedScratch);
+        }
+
+        // Local matrices from trs, then globals parent-before-child (unreachable nodes stay identity).
+        inline void composeGlobals(const std::vector<NodeTRS> &trs,
+                                   std::vector<glm::mat4> &localsScratch,
+                                   std::vector<glm::mat4> &globalsOut,
+                                   std::vector<uint8_t> &visitedScratch) const
+        {
+            const uint32_t nodeCount = static_cast<uint32_t>(nodes.size());
+            globalsOut.assign(nodeCount, glm::mat4(1.0f));
+            if (nodeCount == 0 || trs.size() != nodeCount)
+                return;
+            localsScratch.resize(nodeCount);
+            visitedScratch.assign(nodeCount, 0);
+
+            simd::ComposeTRSBatch(trs.data(), nodeCount, localsScratch.data());
+
+            if (hasEvaluationOrder())
+            {
+                for (uint32_t node : evalOrder)
+                {
+                    const uint32_t parent = evalParents[node];
+                    if (parent >= nodeCount)
+                        globalsOut[node] = localsScratch[node];
+                    else
+                        simd::MulMat4(globalsOut[parent], localsScratch[node], globalsOut[node]);
+                }
+                return;
+            }
 
+            // No evaluation order (model assembled outside AssetManager): recursive walk.
             const uint32_t U32_MAX = ~0u;
 
             std::function<void(uint32_t, const glm::mat4 &)> compute = [&](uint32_t nodeIdx, const glm::mat4 &parentGlobal)
@@ -14,6 +14,7 @@
 #include "assets/model/SModelEnums.h"
 #include "assets/model/SModelHeader.h"
 #include "assets/model/SModelMeshRecord.h"
+#include "assets/model/SModelPackedVertex.h"
 #include "assets/model/SModelPrimitiveRecord.h"
 #include "assets/model/SModelTextureRecord.h"
 #include "assets/model/SModelMaterialRecord.h"
@@ -22,6 +23,11 @@
 #include "assets/model/SModelSkinRecord.h"
 
 #include "assets/model/SModelAnimationRecords.h"
+#include "assets/model/SModelBakedAnimation.h"
+#include "assets/model/SModelMeshLod.h"
+#include "assets/model/SModelQuantizedAnimation.h"
+#include "assets/model/SModelImpostor.h"
+#include "assets/model/SModelMeshlet.h"
 namespace Engine::smodel
 {
     // 'SMOD' little-endian magic
@@ -1,10 +1,12 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "assets/ModelFormat.h" // umbrella include for SModel structs
+#include "utils/MappedFile.h"
 
 namespace Engine::smodel
 {
@@ -13,14 +15,18 @@ namespace Engine::smodel
     // ------------------------------------------------------------
     // Owns file bytes and provides typed views (pointers) into it.
     // AssetManager will use this to build GPU resources later.
+    // The file is memory-mapped (no heap copy); fileBytes is only used when mapping fails.
+    // Moving the view is fine (mapped pages and vector storage do not move), copying is not.
     struct SModelFileView
     {
-        std::vector<uint8_t> fileBytes; // owns the whole file memory
+        MappedFile mapping;             // read-only mapping of the whole file
+        std::vector<uint8_t> fileBytes; // fallback copy when the file could not be mapped
+        std::shared_ptr<const void> owner; // keeps external bytes alive (LoadSModelMemory), e.g. a mounted pack
 
-        // Header pointer inside fileBytes
+        // Header pointer inside the file bytes
         const SModelHeader *header = nullptr;
 
-        // Record table pointers inside fileBytes
+        // Record table pointers inside the file bytes
         const SModelMeshRecord *meshes = nullptr;
         const SModelPrimitiveRecord *primitives = nullptr;
         const SModelMaterialRecord *materials = nullptr;
@@ -43,6 +49,28 @@ namespace Engine::smodel
         const uint32_t *skinJointNodeIndices = nullptr;
         const float *skinInverseBindMatrices = nullptr;
 
+        // Baked animation palettes (V4.2, optional; null when absent)
+        const SModelBakedAnimationHeader *bakedAnimation = nullptr;
+        const SModelBakedClipRecord *bakedClips = nullptr;
+        const float *bakedData = nullptr;
+
+        // Mesh LOD chains (V4.3, optional; null when absent)
+        const SModelMeshLodHeader *meshLods = nullptr;
+        const SModelMeshLodRecord *meshLodRecords = nullptr;
+
+        // Quantized animation clips (V4.4, optional; null when absent)
+        const SModelQuantizedAnimHeader *quantizedAnim = nullptr;
+        const SModelQuantizedClipRecord *quantizedClips = nullptr;
+        const SModelQuantizedTrackRecord *quantizedTracks = nullptr;
+        const uint16_t *quantizedData = nullptr;
+
+        // Octahedral impostor atlases (V4.5, optional; null when absent)
+        const SModelImpostorHeader *impostor = nullptr;
+
+        // Meshlets (V4.6, optional; null when absent)
+        const SModelMeshletHeader *meshlets = nullptr;
+        const SModelMeshletRecord *meshletRecords = nullptr;
+
         // String table start pointer (C-string table)
         const char *stringTable = nullptr;
 
@@ -122,4 +150,10 @@ namespace Engine::smodel
     // If it fails, outError will contain a short reason.
     bool LoadSModelFile(const std::string &path, SModelFileView &outView, std::string &outError);
 
+    // Same validation over bytes already in memory. LoadSModelMemory views 'data' in place (it
+    // must be 8-byte aligned and stay valid while 'owner' lives); LoadSModelBytes takes the
+    // bytes over.
+    bool LoadSModelMemory(const uint8_t *data, size_t size, std::shared_ptr<const void> owner, SModelFileView &outView, std::string &outError);
+    bool LoadSModelBytes(std::vector<uint8_t> &&bytes, SModelFileView &outView, std::string &outError);
+
 }
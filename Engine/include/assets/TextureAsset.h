@@ -1,6 +1,9 @@
 #pragma once
 #include <vulkan/vulkan.h>
+#include <cstddef>
 #include <cstdint>
+#include <vector>
+#include "utils/GpuAllocator.h"
 
 namespace Engine
 {
@@ -19,6 +22,26 @@ namespace Engine
         TextureAsset() = default;
         ~TextureAsset() = default;
 
+        // ------------------------------------------------------------
+        // CPU decode (PNG/JPG -> RGBA8). No Vulkan; safe on worker threads.
+        // ------------------------------------------------------------
+        static bool decodeImageRGBA8(
+            const uint8_t *encodedBytes,
+            size_t encodedSize,
+            std::vector<uint8_t> &outPixels,
+            uint32_t &outWidth,
+            uint32_t &outHeight);
+
+        // Full RGBA8 mip chain (2x2 box filter, odd edges repeat their last texel), levels back to
+        // back starting with the source image. sRGB images are filtered in linear space, matching
+        // the GPU blits of uploadRGBA8_Deferred. Returns the level count. No Vulkan.
+        static uint32_t buildMipChainRGBA8(
+            const uint8_t *rgbaPixels,
+            uint32_t width,
+            uint32_t height,
+            bool srgb,
+            std::vector<uint8_t> &outChain);
+
         // ------------------------------------------------------------
         // Optimized upload path (records commands, NO submit)
         // ------------------------------------------------------------
@@ -35,6 +58,22 @@ namespace Engine
             VkSamplerMipmapMode mipMode,
             float maxAnisotropy);
 
+        // Uploads a chain from buildMipChainRGBA8 with one copy per level (no blits).
+        bool uploadRGBA8MipChain_Deferred(
+            UploadContext &ctx,
+            const uint8_t *chainPixels,
+            size_t chainBytes,
+            uint32_t width,
+            uint32_t height,
+            uint32_t mipLevels,
+            bool srgbFormat,
+            VkSamplerAddressMode wrapU,
+            VkSamplerAddressMode wrapV,
+            VkFilter minFilter,
+            VkFilter magFilter,
+            VkSamplerMipmapMode mipMode,
+            float maxAnisotropy);
+
         bool uploadEncodedImage_Deferred(
             UploadContext &ctx,
             const uint8_t *encodedBytes,
@@ -47,10 +86,56 @@ namespace Engine
             VkSamplerMipmapMode mipMode,
             float maxAnisotropy);
 
+        // ------------------------------------------------------------
+        // Block-compressed upload (BC7/ASTC, cooked mip chain; no decode, no mip generation)
+        // ------------------------------------------------------------
+        // blockData holds mipLevels levels back to back, 16 bytes per 4x4 block (see
+        // smodel::BlockCompressedMipChainBytes). Fails when the device cannot sample 'format'.
+        bool uploadBlockCompressed_Deferred(
+            UploadContext &ctx,
+            const uint8_t *blockData,
+            size_t blockDataSize,
+            uint32_t width,
+            uint32_t height,
+            uint32_t mipLevels,
+            VkFormat format,
+            VkSamplerAddressMode wrapU,
+            VkSamplerAddressMode wrapV,
+            VkFilter minFilter,
+            VkFilter magFilter,
+            VkSamplerMipmapMode mipMode,
+            float maxAnisotropy);
+
+        // True when 'format' can be sampled from an optimal-tiling image.
+        static bool isFormatSampleable(VkPhysicalDevice physicalDevice, VkFormat format);
+
+        // ------------------------------------------------------------
+        // Mip residency (AssetManager::updateTextureResidency)
+        // ------------------------------------------------------------
+        // A texture may hold only the tail [baseMip, fullMipLevels) of its chain. These build
+        // that tail into a fresh texture with no sampler; once the upload has completed,
+        // swapResidency() moves it into the live texture (which keeps its sampler: maxLod is
+        // relative to the view, so it clamps to the levels present) and the old image is
+        // destroyed with the replacement.
+        //
+        // Copies the levels from src, which must hold all of them (baseMip >= src.getBaseMip()).
+        bool copyMipTail_Deferred(UploadContext &ctx, const TextureAsset &src, uint32_t baseMip);
+
+        // Records the levels from source pixels shaped like 'like': the full RGBA8 image
+        // (downsampled to baseMip on the CPU, lower levels blitted) or the full block-compressed chain.
+        bool uploadMipTail_Deferred(UploadContext &ctx, const TextureAsset &like, uint32_t baseMip,
+                                    const uint8_t *data, size_t dataSize);
+
+        // Swaps image, memory, view and resident extent; sampler, format and full chain stay.
+        void swapResidency(TextureAsset &other);
+
+        // Estimated device bytes of the tail [baseMip, fullMipLevels).
+        uint64_t bytesForBaseMip(uint32_t baseMip) const;
+
         // Destroy GPU resources (used by AssetManager when freeing)
         void destroy(VkDevice device);
 
-        // Accessors
+        // Accessors (width, height and mip levels are those of the resident image)
         VkImage getImage() const { return m_image; }
         VkImageView getView() const { return m_view; }
         VkSampler getSampler() const { return m_sampler; }
@@ -58,12 +143,19 @@ namespace Engine
         uint32_t getHeight() const { return m_height; }
         uint32_t getMipLevels() const { return m_mipLevels; }
         VkFormat getFormat() const { return m_format; }
+        uint64_t getGpuBytes() const { return m_memory.size; }
+
+        uint32_t getBaseMip() const { return m_baseMip; } // levels of the full chain not resident
+        uint32_t getFullWidth() const { return m_fullWidth; }
+        uint32_t getFullHeight() const { return m_fullHeight; }
+        uint32_t getFullMipLevels() const { return m_fullMipLevels; }
+        bool isBlockCompressed() const { return m_blockCompressed; }
 
         bool isValid() const { return m_image != VK_NULL_HANDLE; }
 
     private:
         VkImage m_image = VK_NULL_HANDLE;
-        VkDeviceMemory m_memory = VK_NULL_HANDLE;
+        GpuAllocation m_memory;
         VkImageView m_view = VK_NULL_HANDLE;
         VkSampler m_sampler = VK_NULL_HANDLE;
 
@@ -71,6 +163,12 @@ namespace Engine
         uint32_t m_height = 0;
         uint32_t m_mipLevels = 1;
         VkFormat m_format = VK_FORMAT_R8G8B8A8_UNORM;
+
+        uint32_t m_baseMip = 0;
+        uint32_t m_fullWidth = 0;
+        uint32_t m_fullHeight = 0;
+        uint32_t m_fullMipLevels = 1;
+        bool m_blockCompressed = false;
     };
 
 } // namespace Engine
@@ -0,0 +1,76 @@
+#pragma once
+#include <cstdint>
+
+namespace Engine::smodel
+{
+    // SModelHeader::flags bits
+    enum SModelHeaderFlags : uint32_t
+    {
+        // V4.2: an SModelBakedAnimationHeader immediately follows SModelHeader.
+        SMODEL_FLAG_BAKED_ANIMATION = (1u << 0),
+
+        // V4.3: an SModelMeshLodHeader follows the extension headers above (see SModelMeshLod.h).
+        SMODEL_FLAG_MESH_LODS = (1u << 1),
+
+        // V4.4: an SModelQuantizedAnimHeader follows (see SModelQuantizedAnimation.h).
+        SMODEL_FLAG_QUANTIZED_ANIMATION = (1u << 2),
+
+        // Index lists are already vertex-cache/overdraw ordered and vertices are in fetch
+        // order (see MeshOptimizer.h). Set by GltfToSmodel unless --no-optimize; the runtime's
+        // opt-in fallback pass skips these files. No extension header.
+        SMODEL_FLAG_OPTIMIZED_MESHES = (1u << 3),
+
+        // V4.5: an SModelImpostorHeader follows (see SModelImpostor.h).
+        SMODEL_FLAG_IMPOSTOR = (1u << 4),
+
+        // V4.6: an SModelMeshletHeader follows (see SModelMeshlet.h).
+        SMODEL_FLAG_MESHLETS = (1u << 5),
+    };
+
+#pragma pack(push, 1)
+
+    // ============================================================
+    // Baked Animation (V4.2, optional)
+    // ============================================================
+    // Every clip sampled offline at a fixed rate into ready-to-use palettes, so distant
+    // instances can fetch (clip, time) instead of evaluating channels and the hierarchy.
+    //
+    // Frame layout: nodeCount node globals, then jointCount joint matrices (global *
+    // inverseBind, flattened across skins like the runtime joint palette). Each matrix is
+    // stored as its top three rows (12 floats); the bottom row is always (0, 0, 0, 1).
+    // Clip frame f is sampled at min(f / sampleRate, durationSec).
+    //
+    // Offsets are absolute byte offsets from file start (like other offsets).
+    struct SModelBakedAnimationHeader
+    {
+        float sampleRate; // frames per second
+        uint32_t nodeCount;
+        uint32_t jointCount;
+        uint32_t clipCount; // matches header.animClipsCount
+
+        uint32_t clipsOffset; // SModelBakedClipRecord[clipCount]
+        uint32_t dataOffset;  // float rows
+        uint32_t dataCount;   // number of floats
+        uint32_t _reserved;
+    };
+
+    struct SModelBakedClipRecord
+    {
+        uint32_t firstFrame; // frame index into the data section
+        uint32_t frameCount; // >= 1
+        float durationSec;
+        uint32_t _pad;
+    };
+
+#pragma pack(pop)
+
+    static_assert(sizeof(SModelBakedAnimationHeader) == 32, "SModelBakedAnimationHeader size mismatch");
+    static_assert(sizeof(SModelBakedClipRecord) == 16, "SModelBakedClipRecord size mismatch");
+
+    // Floats per baked frame for a model layout.
+    inline uint64_t BakedFrameFloats(uint32_t nodeCount, uint32_t jointCount)
+    {
+        return (uint64_t(nodeCount) + uint64_t(jointCount)) * 12u;
+    }
+
+} // namespace Engine::smodel
@@ -28,6 +28,10 @@ namespace Engine::smodel
         // Skinning (V4)
         VTX_JOINTS = (1u << 4),  // JOINTS0 (u16x4)
         VTX_WEIGHTS = (1u << 5), // WEIGHTS0 (f32x4)
+
+        // Vertices are SModelPackedVertex (36 bytes, see SModelPackedVertex.h) instead of
+        // VertexPNTTJW; the attribute bits above still say which ones carry data.
+        VTX_PACKED = (1u << 6),
     };
 
     // ============================================================
@@ -44,12 +48,16 @@ namespace Engine::smodel
     };
 
     // Image encoding describes how the texture bytes are stored in the blob.
-    // Phase 1: embed PNG/JPG bytes (compressed) and decode at runtime.
+    // - PNG/JPG : encoded file bytes, decoded at runtime (mips generated on the GPU)
+    // - BC7/ASTC: GPU block-compressed (4x4 blocks, 16 bytes each) with a precomputed mip
+    //             chain; uploaded as-is (v4.1+, see SModelTextureRecord)
     enum class ImageEncoding : uint32_t
     {
         PNG = 0,
         JPG = 1,
-        RAW = 2 // optional future (raw RGBA8 stored directly)
+        RAW = 2, // RGBA8 rows stored directly (width x height x 4 bytes, no mips)
+        BC7 = 3,
+        ASTC4x4 = 4
     };
 
     // ============================================================
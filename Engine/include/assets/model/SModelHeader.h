@@ -25,7 +25,7 @@ namespace Engine::smodel
         uint16_t versionMinor; // 0
 
         uint32_t fileSizeBytes; // entire file size (validation)
-        uint32_t flags;         // reserved for future use (0 for v1)
+        uint32_t flags;         // SModelHeaderFlags (v4.2+), 0 otherwise
 
         // Counts for each record table
         uint32_t meshCount;      // number of mesh records (VB/IB blobs)
@@ -0,0 +1,113 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+
+#include "assets/model/SModelHeader.h"
+#include "assets/model/SModelBakedAnimation.h"
+#include "assets/model/SModelMeshLod.h"
+#include "assets/model/SModelQuantizedAnimation.h"
+
+namespace Engine::smodel
+{
+#pragma pack(push, 1)
+
+    // ============================================================
+    // Octahedral impostor (V4.5, optional)
+    // ============================================================
+    // The model rendered offline from framesPerSide x framesPerSide directions into two atlases
+    // of square frames, so far instances can be drawn as one camera-facing quad:
+    //   albedoTexture : RGB = base color (sRGB), A = coverage
+    //   normalTexture : RGB = model-space normal * 0.5 + 0.5, A = depth toward the viewer,
+    //                   0.5 + 0.5 * dot(p - center, viewDir) / radius
+    // Frame (x, y) sits at atlas column x, row y and was captured orthographically along
+    // ImpostorFrameDirection(x / (n - 1), y / (n - 1)) over the sphere (center, radius), with
+    // ImpostorFrameBasis() as its right/up axes. Both are model space (before any fit scale).
+    // Texture indices point into the regular texture table; no material references them.
+    struct SModelImpostorHeader
+    {
+        uint32_t framesPerSide;   // n >= 2
+        uint32_t frameResolution; // pixels per frame edge
+        int32_t albedoTexture;
+        int32_t normalTexture;
+
+        float center[3];
+        float radius;
+
+        uint32_t mapping; // ImpostorMapping
+        uint32_t _reserved[3];
+    };
+
+#pragma pack(pop)
+
+    static_assert(sizeof(SModelImpostorHeader) == 48, "SModelImpostorHeader size mismatch");
+
+    enum class ImpostorMapping : uint32_t
+    {
+        Sphere = 0,     // full octahedron: views from every direction
+        Hemisphere = 1, // upper half only (props standing on the ground), twice the frames per view
+    };
+
+    // Upper bound on framesPerSide accepted by the loader.
+    static constexpr uint32_t SMODEL_MAX_IMPOSTOR_FRAMES = 32;
+
+    // Follows the quantized animation header (extension headers are in flag-bit order).
+    inline uint64_t ImpostorHeaderOffset(uint32_t flags)
+    {
+        uint64_t offset = QuantizedAnimHeaderOffset(flags);
+        if (flags & SMODEL_FLAG_QUANTIZED_ANIMATION)
+            offset += sizeof(SModelQuantizedAnimHeader);
+        return offset;
+    }
+
+    // ------------------------------------------------------------
+    // Shared frame mapping (cook tool + staticprop_impostor.vert)
+    // ------------------------------------------------------------
+    // Grid coordinates (gx, gy) in [0, 1] -> unit direction from the center toward the viewer (y up).
+    inline void ImpostorFrameDirection(float gx, float gy, ImpostorMapping mapping, float out[3])
+    {
+        const float u = gx * 2.0f - 1.0f;
+        const float v = gy * 2.0f - 1.0f;
+        float x, y, z;
+        if (mapping == ImpostorMapping::Hemisphere)
+        {
+            // Octahedron's upper half, rotated 45 degrees to fill the square.
+            x = 0.5f * (u - v);
+            z = 0.5f * (u + v);
+            y = 1.0f - std::fabs(x) - std::fabs(z);
+        }
+        else
+        {
+            x = u;
+            z = v;
+            y = 1.0f - std::fabs(u) - std::fabs(v);
+            if (y < 0.0f)
+            {
+                x = (1.0f - std::fabs(v)) * (u >= 0.0f ? 1.0f : -1.0f);
+                z = (1.0f - std::fabs(u)) * (v >= 0.0f ? 1.0f : -1.0f);
+            }
+        }
+        const float len = std::sqrt(x * x + y * y + z * z);
+        out[0] = x / len;
+        out[1] = y / len;
+        out[2] = z / len;
+    }
+
+    // Right/up axes of the frame looking back along dir (world up, or -z when looking straight down).
+    inline void ImpostorFrameBasis(const float dir[3], float right[3], float up[3])
+    {
+        const float ux = 0.0f;
+        const float uy = std::fabs(dir[1]) > 0.999f ? 0.0f : 1.0f;
+        const float uz = std::fabs(dir[1]) > 0.999f ? -1.0f : 0.0f;
+        right[0] = uy * dir[2] - uz * dir[1];
+        right[1] = uz * dir[0] - ux * dir[2];
+        right[2] = ux * dir[1] - uy * dir[0];
+        const float len = std::sqrt(right[0] * right[0] + right[1] * right[1] + right[2] * right[2]);
+        right[0] /= len;
+        right[1] /= len;
+        right[2] /= len;
+        up[0] = dir[1] * right[2] - dir[2] * right[1];
+        up[1] = dir[2] * right[0] - dir[0] * right[2];
+        up[2] = dir[0] * right[1] - dir[1] * right[0];
+    }
+
+} // namespace Engine::smodel
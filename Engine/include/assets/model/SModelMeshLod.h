@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+
+#include "assets/model/SModelHeader.h"
+#include "assets/model/SModelBakedAnimation.h"
+
+namespace Engine::smodel
+{
+#pragma pack(push, 1)
+
+    // ============================================================
+    // Mesh LOD chains (V4.3, optional)
+    // ============================================================
+    // Simplified index lists cooked per mesh. Every level indexes the mesh's own vertex
+    // buffer (same indexType as the mesh), so a LOD is just another index range at draw time.
+    //
+    // A level is meant for instances whose projected bounding radius, as a fraction of half
+    // the viewport height, is below screenSize. Levels of one mesh are stored in ascending
+    // order (1, 2, ...); level 0 is the mesh record itself.
+    struct SModelMeshLodHeader
+    {
+        uint32_t lodCount;   // number of SModelMeshLodRecord entries
+        uint32_t lodsOffset; // absolute byte offset of SModelMeshLodRecord[lodCount]
+        uint32_t maxLevels;  // highest level present in any mesh
+        uint32_t _reserved;
+    };
+
+    struct SModelMeshLodRecord
+    {
+        uint32_t meshIndex;
+        uint32_t level; // >= 1
+        uint32_t indexCount;
+        float screenSize;
+
+        // Blob offsets are relative to header.blobOffset
+        uint64_t indexDataOffset;
+        uint64_t indexDataSize;
+    };
+
+#pragma pack(pop)
+
+    static_assert(sizeof(SModelMeshLodHeader) == 16, "SModelMeshLodHeader size mismatch");
+    static_assert(sizeof(SModelMeshLodRecord) == 32, "SModelMeshLodRecord size mismatch");
+
+    // Upper bound on levels per mesh accepted by the loader.
+    static constexpr uint32_t SMODEL_MAX_MESH_LODS = 8;
+
+    // Extension headers follow SModelHeader in flag-bit order.
+    inline uint64_t MeshLodHeaderOffset(uint32_t flags)
+    {
+        uint64_t offset = sizeof(SModelHeader);
+        if (flags & SMODEL_FLAG_BAKED_ANIMATION)
+            offset += sizeof(SModelBakedAnimationHeader);
+        return offset;
+    }
+
+} // namespace Engine::smodel
@@ -0,0 +1,76 @@
+#pragma once
+#include <cstdint>
+
+#include "assets/model/SModelImpostor.h"
+
+namespace Engine::smodel
+{
+#pragma pack(push, 1)
+
+    // ============================================================
+    // Meshlets (V4.6, optional)
+    // ============================================================
+    // Every mesh's full-detail index list cut into small clusters (at most maxVertices vertices
+    // and maxTriangles triangles) with bounds for per-cluster culling. Meshlets cover
+    // consecutive triangles of the list in order, so meshlet i is also the index range
+    // [firstIndex, firstIndex + 3 * triangleCount) of its mesh and can be drawn without the
+    // local tables below. Those are for mesh shaders:
+    //   vertex data   : uint32 mesh-local vertex index, vertexOffset.. per meshlet
+    //   triangle data : uint8 x3 per triangle, indices into the meshlet's vertex list
+    // Files with meshlets also carry SMODEL_FLAG_OPTIMIZED_MESHES: the runtime must not
+    // reorder vertices or triangles underneath them.
+    struct SModelMeshletHeader
+    {
+        uint32_t meshletCount;  // SModelMeshletRecord entries, sorted by meshIndex
+        uint32_t meshletsOffset; // absolute byte offset of SModelMeshletRecord[meshletCount]
+        uint32_t maxVertices;
+        uint32_t maxTriangles;
+
+        uint32_t vertexCount;       // uint32 entries in the vertex data
+        uint32_t triangleByteCount; // bytes in the triangle data (3 per triangle)
+
+        // Blob offsets are relative to header.blobOffset
+        uint64_t vertexDataOffset;
+        uint64_t triangleDataOffset;
+    };
+
+    // Bounds are mesh space (bind pose for skinned meshes).
+    struct SModelMeshletRecord
+    {
+        uint32_t meshIndex;
+        uint32_t firstIndex;     // into the mesh's index list
+        uint32_t vertexOffset;   // first entry in the vertex data
+        uint32_t triangleOffset; // first byte in the triangle data
+        uint16_t vertexCount;
+        uint16_t triangleCount;
+        int32_t anchorJoint; // skin-local joint with the most weight over the vertices, -1 = rigid
+
+        float center[3];
+        float radius;
+
+        // Backface cone: the whole meshlet faces away from a viewer at p when
+        // dot(center - p, coneAxis) >= coneCutoff * |center - p| + radius. Cutoff 1 = never.
+        float coneAxis[3];
+        float coneCutoff;
+    };
+
+#pragma pack(pop)
+
+    static_assert(sizeof(SModelMeshletHeader) == 40, "SModelMeshletHeader size mismatch");
+    static_assert(sizeof(SModelMeshletRecord) == 56, "SModelMeshletRecord size mismatch");
+
+    // Limits accepted by the loader (the cook tool writes 64 / 124: the sizes mesh shader
+    // hardware prefers, with room for 4-byte aligned primitive output).
+    static constexpr uint32_t SMODEL_MAX_MESHLET_VERTICES = 64;
+    static constexpr uint32_t SMODEL_MAX_MESHLET_TRIANGLES = 124;
+
+    // Follows the impostor header (extension headers are in flag-bit order).
+    inline uint64_t MeshletHeaderOffset(uint32_t flags)
+    {
+        uint64_t offset = ImpostorHeaderOffset(flags);
+        if (flags & SMODEL_FLAG_IMPOSTOR)
+            offset += sizeof(SModelImpostorHeader);
+        return offset;
+    }
+
+} // namespace Engine::smodel
@@ -0,0 +1,179 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace Engine::smodel
+{
+#pragma pack(push, 1)
+
+    // ============================================================
+    // Vertex layouts
+    // ============================================================
+    // VertexPNTTJW (72 bytes): what the cook tool has always written.
+    //   0  float3 position | 12 float3 normal | 24 float2 uv0 | 32 float4 tangent
+    //   48 uint16x4 joints | 56 float4 weights
+    //
+    // SModelPackedVertex (36 bytes, mesh layoutFlags has VTX_PACKED): what the GPU buffers
+    // hold. GltfToSmodel writes packed meshes with the encoders below; the runtime packs the
+    // VertexPNTTJW meshes of older files at load.
+    //   normal  : octahedral, snorm16x2
+    //   uv0     : half2
+    //   tangent : snorm8x4 (xyz direction, w = handedness sign)
+    //   weights : unorm8x4, rounded so the four sum to exactly 255
+    // Positions stay float3. Quantizing against mesh bounds (unorm16x3 + pad) would save 4 of
+    // the 36 bytes, but every position reader would need the bounds: the SModel, indirect and
+    // shadow vertex shaders (push block already at the 128-byte floor), the meshlet mesh shader
+    // reading the storage buffer, and the CPU-side meshlet/impostor/AABB paths. Folding the
+    // dequantization into the node and joint palettes does not work per mesh either: one palette
+    // entry serves every mesh under that node or skin.
+    struct SModelPackedVertex
+    {
+        float position[3];
+        int16_t normalOct[2];
+        uint16_t uv0[2];
+        int8_t tangent[4];
+        uint16_t joints[4];
+        uint8_t weights[4];
+    };
+
+#pragma pack(pop)
+
+    static_assert(sizeof(SModelPackedVertex) == 36, "SModelPackedVertex size mismatch");
+
+    static constexpr uint32_t SMODEL_VERTEX_STRIDE = 72;        // VertexPNTTJW
+    static constexpr uint32_t SMODEL_PACKED_VERTEX_STRIDE = 36; // SModelPackedVertex
+
+    // ------------------------------------------------------------
+    // Shared encode (cook tool + runtime); decode lives in the vertex shaders
+    // ------------------------------------------------------------
+    inline int16_t EncodeSnorm16(float v)
+    {
+        const float c = v < -1.0f ? -1.0f : (v > 1.0f ? 1.0f : v);
+        return static_cast<int16_t>(std::lround(c * 32767.0f));
+    }
+
+    inline int8_t EncodeSnorm8(float v)
+    {
+        const float c = v < -1.0f ? -1.0f : (v > 1.0f ? 1.0f : v);
+        return static_cast<int8_t>(std::lround(c * 127.0f));
+    }
+
+    // Octahedral mapping of a unit vector onto [-1, 1]^2 (lower hemisphere folded over).
+    inline void EncodeOctNormal(const float n[3], int16_t out[2])
+    {
+        const float l1 = std::fabs(n[0]) + std::fabs(n[1]) + std::fabs(n[2]);
+        if (l1 <= 0.0f)
+        {
+            out[0] = 0;
+            out[1] = 0;
+            return;
+        }
+        float x = n[0] / l1;
+        float y = n[1] / l1;
+        if (n[2] < 0.0f)
+        {
+            const float fx = (1.0f - std::fabs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+            const float fy = (1.0f - std::fabs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+            x = fx;
+            y = fy;
+        }
+        out[0] = EncodeSnorm16(x);
+        out[1] = EncodeSnorm16(y);
+    }
+
+    // IEEE binary16, round to nearest even; overflow saturates to infinity, NaN stays NaN.
+    inline uint16_t EncodeHalf(float v)
+    {
+        uint32_t f;
+        std::memcpy(&f, &v, sizeof(f));
+        const uint32_t sign = (f >> 16) & 0x8000u;
+        const uint32_t absBits = f & 0x7FFFFFFFu;
+
+        if (absBits >= 0x7F800000u) // inf / NaN
+            return static_cast<uint16_t>(sign | 0x7C00u | (absBits > 0x7F800000u ? 0x200u : 0u));
+        if (absBits >= 0x477FF000u) // rounds past the largest half
+            return static_cast<uint16_t>(sign | 0x7C00u);
+        if (absBits < 0x38800000u) // half subnormal (or zero)
+        {
+            if (absBits < 0x33000000u)
+                return static_cast<uint16_t>(sign);
+            const uint32_t exp = absBits >> 23;
+            const uint32_t mant = (absBits & 0x007FFFFFu) | 0x00800000u;
+            const uint32_t shift = 126u - exp; // 14..24
+            uint32_t h = mant >> shift;
+            const uint32_t rem = mant & ((1u << shift) - 1u);
+            const uint32_t halfway = 1u << (shift - 1u);
+            if (rem > halfway || (rem == halfway && (h & 1u)))
+                ++h;
+            return static_cast<uint16_t>(sign | h);
+        }
+
+        uint32_t h = ((absBits - 0x38000000u) >> 13);
+        const uint32_t rem = absBits & 0x1FFFu;
+        if (rem > 0x1000u || (rem == 0x1000u && (h & 1u)))
+            ++h;
+        return static_cast<uint16_t>(sign | h);
+    }
+
+    // Four weights to unorm8 summing to 255 (largest remainders get the leftover units), so
+    // the decoded skin matrix stays an affine blend.
+    inline void EncodeWeights(const float w[4], uint8_t out[4])
+    {
+        float sum = 0.0f;
+        for (int i = 0; i < 4; ++i)
+            sum += (w[i] > 0.0f) ? w[i] : 0.0f;
+        if (sum <= 0.0f)
+        {
+            out[0] = 255;
+            out[1] = out[2] = out[3] = 0;
+            return;
+        }
+
+        float rem[4];
+        int total = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            const float scaled = ((w[i] > 0.0f) ? w[i] : 0.0f) / sum * 255.0f;
+            const int q = static_cast<int>(scaled);
+            out[i] = static_cast<uint8_t>(q);
+            rem[i] = scaled - static_cast<float>(q);
+            total += q;
+        }
+        for (; total < 255; ++total)
+        {
+            int best = 0;
+            for (int i = 1; i < 4; ++i)
+                best = (rem[i] > rem[best]) ? i : best;
+            ++out[best];
+            rem[best] = -1.0f;
+        }
+    }
+
+    // Packs vertexCount VertexPNTTJW vertices (72-byte stride, any alignment) into dst.
+    inline void PackVerticesPNTTJW(const uint8_t *src, uint32_t vertexCount, SModelPackedVertex *dst)
+    {
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            const uint8_t *s = src + uint64_t(v) * SMODEL_VERTEX_STRIDE;
+            float pos[3], nrm[3], uv[2], tan[4], wgt[4];
+            std::memcpy(pos, s + 0, sizeof(pos));
+            std::memcpy(nrm, s + 12, sizeof(nrm));
+            std::memcpy(uv, s + 24, sizeof(uv));
+            std::memcpy(tan, s + 32, sizeof(tan));
+            std::memcpy(wgt, s + 56, sizeof(wgt));
+
+            SModelPackedVertex &d = dst[v];
+            std::memcpy(d.position, pos, sizeof(pos));
+            EncodeOctNormal(nrm, d.normalOct);
+            d.uv0[0] = EncodeHalf(uv[0]);
+            d.uv0[1] = EncodeHalf(uv[1]);
+            for (int i = 0; i < 3; ++i)
+                d.tangent[i] = EncodeSnorm8(tan[i]);
+            d.tangent[3] = (tan[3] < 0.0f) ? int8_t(-127) : int8_t(127);
+            std::memcpy(d.joints, s + 48, sizeof(d.joints));
+            EncodeWeights(wgt, d.weights);
+        }
+    }
+
+} // namespace Engine::smodel
@@ -0,0 +1,155 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+
+#include "assets/model/SModelHeader.h"
+#include "assets/model/SModelBakedAnimation.h"
+#include "assets/model/SModelMeshLod.h"
+
+namespace Engine::smodel
+{
+#pragma pack(push, 1)
+
+    // ============================================================
+    // Quantized Animation (V4.4, optional)
+    // ============================================================
+    // Every clip resampled at one uniform rate, so sampling is two frame fetches and a lerp
+    // with no key search. A clip's animated tracks are interleaved per frame:
+    //   frame f = data[clip.dataOffset + f * clip.frameWords .. + frameWords) (uint16 words)
+    // Encodings per track:
+    //   Vec3Range16 : 3 words, each component min + extent * (word / 65535)
+    //   QuatSmallest3: 3 words, smallest-three (2-bit index of the dropped largest component,
+    //                  3 x 15-bit components in [-1/sqrt2, 1/sqrt2]), w = dropped >= 0
+    //   Constant    : 0 words, value in rangeMin (vec3) or rangeMin + rangeExtent[0] (quat xyzw)
+    // Clip frame f is sampled at min(f / sampleRate, durationSec).
+    //
+    // Section offsets are absolute byte offsets from file start; clip dataOffset is in words
+    // from the start of the data section.
+    struct SModelQuantizedAnimHeader
+    {
+        float sampleRate;    // frames per second
+        uint32_t clipCount;  // matches header.animClipsCount
+        uint32_t trackCount; // total over all clips
+
+        uint32_t clipsOffset;  // SModelQuantizedClipRecord[clipCount]
+        uint32_t tracksOffset; // SModelQuantizedTrackRecord[trackCount]
+        uint32_t dataOffset;   // uint16 words
+        uint32_t dataWords;
+
+        uint32_t _reserved;
+    };
+
+    struct SModelQuantizedClipRecord
+    {
+        uint32_t firstTrack;
+        uint32_t trackCount;
+        uint32_t frameCount; // >= 1
+        uint32_t frameWords; // words per frame (animated tracks only)
+
+        uint32_t dataOffset; // first word of frame 0
+        float durationSec;
+        uint32_t _pad[2];
+    };
+
+    enum class QuantizedTrackEncoding : uint16_t
+    {
+        Constant = 0,
+        Vec3Range16 = 1,
+        QuatSmallest3 = 2,
+    };
+
+    struct SModelQuantizedTrackRecord
+    {
+        uint16_t targetNode;
+        uint16_t path;       // SModelAnimPath
+        uint16_t encoding;   // QuantizedTrackEncoding
+        uint16_t wordOffset; // within the clip's frame
+
+        float rangeMin[3];
+        float rangeExtent[3];
+    };
+
+#pragma pack(pop)
+
+    static_assert(sizeof(SModelQuantizedAnimHeader) == 32, "SModelQuantizedAnimHeader size mismatch");
+    static_assert(sizeof(SModelQuantizedClipRecord) == 32, "SModelQuantizedClipRecord size mismatch");
+    static_assert(sizeof(SModelQuantizedTrackRecord) == 32, "SModelQuantizedTrackRecord size mismatch");
+
+    // Follows the mesh LOD header (extension headers are in flag-bit order).
+    inline uint64_t QuantizedAnimHeaderOffset(uint32_t flags)
+    {
+        uint64_t offset = MeshLodHeaderOffset(flags);
+        if (flags & SMODEL_FLAG_MESH_LODS)
+            offset += sizeof(SModelMeshLodHeader);
+        return offset;
+    }
+
+    // ------------------------------------------------------------
+    // Shared encode/decode (cook tool + runtime)
+    // ------------------------------------------------------------
+    inline uint16_t EncodeRange16(float v, float min, float extent)
+    {
+        if (extent <= 0.0f)
+            return 0;
+        const float n = (v - min) / extent;
+        const float c = n < 0.0f ? 0.0f : (n > 1.0f ? 1.0f : n);
+        return static_cast<uint16_t>(std::lround(c * 65535.0f));
+    }
+
+    inline float DecodeRange16(uint16_t w, float min, float extent)
+    {
+        return min + extent * (static_cast<float>(w) * (1.0f / 65535.0f));
+    }
+
+    // q = xyzw, need not be normalized.
+    inline void EncodeQuatSmallest3(const float q[4], uint16_t out[3])
+    {
+        const float len = std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+        const float inv = (len > 0.0f) ? 1.0f / len : 0.0f;
+        float n[4] = {q[0] * inv, q[1] * inv, q[2] * inv, (len > 0.0f) ? q[3] * inv : 1.0f};
+
+        uint32_t largest = 0;
+        for (uint32_t i = 1; i < 4; ++i)
+            if (std::fabs(n[i]) > std::fabs(n[largest]))
+                largest = i;
+        const float sign = (n[largest] < 0.0f) ? -1.0f : 1.0f;
+
+        static constexpr float RANGE = 0.70710678f; // 1 / sqrt(2)
+        uint64_t bits = largest;
+        uint32_t shift = 2;
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+            if (i == largest)
+                continue;
+            const float v = n[i] * sign / RANGE * 0.5f + 0.5f;
+            const float c = v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v);
+            bits |= static_cast<uint64_t>(std::lround(c * 32767.0f)) << shift;
+            shift += 15;
+        }
+        out[0] = static_cast<uint16_t>(bits);
+        out[1] = static_cast<uint16_t>(bits >> 16);
+        out[2] = static_cast<uint16_t>(bits >> 32);
+    }
+
+    // out = xyzw, normalized.
+    inline void DecodeQuatSmallest3(const uint16_t in[3], float out[4])
+    {
+        static constexpr float RANGE = 0.70710678f;
+        const uint64_t bits = uint64_t(in[0]) | (uint64_t(in[1]) << 16) | (uint64_t(in[2]) << 32);
+        const uint32_t largest = static_cast<uint32_t>(bits & 3u);
+
+        uint32_t shift = 2;
+        float sum = 0.0f;
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+            if (i == largest)
+                continue;
+            const float v = static_cast<float>((bits >> shift) & 0x7FFFu) * (1.0f / 32767.0f);
+            out[i] = (v * 2.0f - 1.0f) * RANGE;
+            sum += out[i] * out[i];
+            shift += 15;
+        }
+        out[largest] = std::sqrt(sum < 1.0f ? 1.0f - sum : 0.0f);
+    }
+
+} // namespace Engine::smodel
@@ -1,5 +1,6 @@
 #pragma once
 #include <cstdint>
+#include "assets/model/SModelEnums.h"
 
 namespace Engine::smodel
 {
@@ -14,6 +15,9 @@ namespace Engine::smodel
     // - embedded compressed image bytes (PNG/JPG) in the blob section
     //
     // Runtime will decode bytes to RGBA8 and upload to VkImage.
+    //
+    // Block-compressed encodings (BC7/ASTC4x4, v4.1+) instead store every mip level back to
+    // back (mip 0 first, 4x4 blocks row-major); width/height/mipLevels describe the chain.
     struct SModelTextureRecord
     {
         // Offset into string table (0 = none)
@@ -36,12 +40,33 @@ namespace Engine::smodel
         uint64_t imageDataOffset; // start of PNG/JPG bytes
         uint64_t imageDataSize;   // compressed image byte size
 
-        uint32_t reserved0;
-        uint32_t reserved1;
+        // Block-compressed only (0 for PNG/JPG, whose size lives in the encoded bytes).
+        // Formerly reserved0/reserved1, so older files read as zero.
+        uint16_t width;
+        uint16_t height;
+        uint32_t mipLevels;
     };
 
 #pragma pack(pop)
 
     static_assert(sizeof(SModelTextureRecord) == 64, "SModelTextureRecord size mismatch");
 
+    inline bool IsBlockCompressed(uint32_t encoding)
+    {
+        return encoding == uint32_t(ImageEncoding::BC7) || encoding == uint32_t(ImageEncoding::ASTC4x4);
+    }
+
+    // Bytes of 'mipLevels' levels starting at width x height, 16 bytes per 4x4 block.
+    inline uint64_t BlockCompressedMipChainBytes(uint32_t width, uint32_t height, uint32_t mipLevels)
+    {
+        uint64_t total = 0;
+        for (uint32_t i = 0; i < mipLevels; ++i)
+        {
+            total += uint64_t((width + 3u) / 4u) * uint64_t((height + 3u) / 4u) * 16u;
+            width = (width > 1u) ? (width >> 1) : 1u;
+            height = (height > 1u) ? (height >> 1) : 1u;
+        }
+        return total;
+    }
+
 } // namespace Engine::smodel
\ No newline at end of file
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+
+// ------------------------------------------------------------
+// Heap allocation counter for the zero-allocations-per-frame goal.
+//
+// - Built with ENGINE_COUNT_ALLOCATIONS=1 (CMake option, on by default), AllocationCounter.cpp
+//   replaces the global operator new/delete family with malloc-backed versions that bump a
+//   process-wide and a per-thread counter (one relaxed atomic add and one thread-local add).
+// - PerformanceMonitor turns total() into allocations per frame for the overlay and, with
+//   setAllocationCheck(true), reports steady-state frames that allocate.
+// - ScopedNoAllocation marks a region that must not allocate on the calling thread; debug
+//   builds assert at scope exit if it did.
+// - With ENGINE_COUNT_ALLOCATIONS=0 nothing is replaced and every count reads 0.
+// ------------------------------------------------------------
+#ifndef ENGINE_COUNT_ALLOCATIONS
+#define ENGINE_COUNT_ALLOCATIONS 0
+#endif
+
+namespace Engine::AllocationCounter
+{
+    constexpr bool enabled() { return ENGINE_COUNT_ALLOCATIONS != 0; }
+
+    // Allocations since process start, all threads.
+    uint64_t total();
+
+    // Allocations made by the calling thread since it started.
+    uint64_t thisThread();
+
+    class ScopedNoAllocation
+    {
+    public:
+        explicit ScopedNoAllocation(const char *what) : m_what(what), m_start(thisThread()) {}
+        ~ScopedNoAllocation();
+
+        ScopedNoAllocation(const ScopedNoAllocation &) = delete;
+        ScopedNoAllocation &operator=(const ScopedNoAllocation &) = delete;
+
+        uint64_t allocations() const { return thisThread() - m_start; }
+
+    private:
+        const char *m_what;
+        uint64_t m_start;
+    };
+}
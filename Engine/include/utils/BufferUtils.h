@@ -1,6 +1,7 @@
 #pragma once
 #include <vulkan/vulkan.h>
 #include <cstdint>
+#include "utils/GpuAllocator.h"
 
 namespace Engine
 {
@@ -8,15 +9,33 @@ namespace Engine
     struct VertexBufferHandle
     {
         VkBuffer buffer = VK_NULL_HANDLE;
-        VkDeviceMemory memory = VK_NULL_HANDLE;
+        GpuAllocation memory;
     };
 
     struct IndexBufferHandle
     {
         VkBuffer buffer = VK_NULL_HANDLE;
-        VkDeviceMemory memory = VK_NULL_HANDLE;
+        GpuAllocation memory;
     };
 
+    // Create a buffer backed by the device's GpuAllocator. Host-visible buffers are persistently
+    // mapped through outMemory.mapped (do not vkMapMemory shared memory).
+    // With two or more distinct queue families the buffer is VK_SHARING_MODE_CONCURRENT between
+    // them (e.g. written on the async compute queue, read by graphics); otherwise exclusive.
+    VkResult CreateBuffer(
+        VkDevice device,
+        VkPhysicalDevice physicalDevice,
+        VkDeviceSize size,
+        VkBufferUsageFlags usage,
+        VkMemoryPropertyFlags properties,
+        VkBuffer &outBuffer,
+        GpuAllocation &outMemory,
+        uint32_t queueFamilyCount = 0,
+        const uint32_t *queueFamilies = nullptr);
+
+    // Destroy a buffer created by CreateBuffer and release its memory. Safe on null handles.
+    void DestroyBuffer(VkDevice device, VkBuffer &buffer, GpuAllocation &memory);
+
     // Host-visible vertex buffer (used as a staging source).
     // Implementation should create with usage:
     //   VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT
@@ -52,7 +71,9 @@ namespace Engine
         VkDeviceSize size,
         VkBufferUsageFlags usage,
         VkBuffer &outBuffer,
-        VkDeviceMemory &outMemory);
+        GpuAllocation &outMemory,
+        uint32_t queueFamilyCount = 0,
+        const uint32_t *queueFamilies = nullptr);
 
     // Copy bytes from src to dst using a one-time command buffer.
     // Requirements:
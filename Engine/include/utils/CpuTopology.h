@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace Engine
+{
+    // Logical CPUs of the machine with their core, package, NUMA node and core type, as far as
+    // the OS reports them (Linux sysfs, Windows GetLogicalProcessorInformationEx). Used by
+    // JobSystem to keep loop workers off efficiency cores and to pin threads.
+    //
+    // - efficiencyClass follows the Windows convention: higher is faster. Hybrid CPUs (Intel
+    //   P/E cores, ARM big.LITTLE) report more than one class; everything else reports 0 only.
+    // - smtPrimary marks the first logical CPU of each physical core, so "one thread per
+    //   physical core" is the set of primaries.
+    // - Windows: processor group 0 only (up to 64 logical CPUs). Unknown platforms and failed
+    //   queries fall back to std::thread::hardware_concurrency() CPUs of one class.
+    struct CpuTopology
+    {
+        struct LogicalCpu
+        {
+            uint32_t id = 0;       // OS CPU number (affinity bit)
+            uint32_t core = 0;     // physical core, unique over packages
+            uint32_t package = 0;
+            uint32_t numaNode = 0;
+            uint8_t efficiencyClass = 0;
+            bool smtPrimary = true;
+        };
+
+        std::vector<LogicalCpu> cpus; // ordered by id
+
+        static CpuTopology detect();
+
+        bool hybrid() const;
+        bool isPerformance(const LogicalCpu &cpu) const { return cpu.efficiencyClass == m_maxClass; }
+
+        uint32_t logicalCount() const { return static_cast<uint32_t>(cpus.size()); }
+        uint32_t physicalCoreCount() const;
+        uint32_t numaNodeCount() const;
+
+        // Performance-core CPUs: SMT primaries first (by NUMA node, package, core), then their
+        // siblings, so taking a prefix spreads threads over physical cores of one node first.
+        std::vector<uint32_t> performanceCpus() const;
+        // Every CPU of a lower efficiency class (empty unless hybrid()).
+        std::vector<uint32_t> efficiencyCpus() const;
+
+    private:
+        void finish(); // sets m_maxClass, SMT primaries and the order
+        uint8_t m_maxClass = 0;
+    };
+
+    // Restrict the calling thread to the given CPU ids. False if unsupported or refused.
+    bool setCurrentThreadAffinity(const std::vector<uint32_t> &cpuIds);
+
+    // Scheduling hint for the calling thread: below normal for background workers.
+    void setCurrentThreadBackgroundPriority();
+}
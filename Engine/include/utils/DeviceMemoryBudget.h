@@ -0,0 +1,28 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstdint>
+
+namespace Engine
+{
+    // ============================================================
+    // Device-local memory budget (VK_EXT_memory_budget)
+    // ============================================================
+    // Sums over the device-local heaps. With the extension, 'budget' is what the driver says this
+    // process can use right now (it shrinks when other applications take VRAM) and 'usage' is
+    // what the process uses, counted by the driver. Without it, budget is the heap size and usage
+    // is unknown (fromBudgetExtension = false, usage = 0).
+    struct DeviceMemoryBudget
+    {
+        VkDeviceSize heapSize = 0;
+        VkDeviceSize budget = 0;
+        VkDeviceSize usage = 0;
+        bool fromBudgetExtension = false;
+    };
+
+    // True when the physical device offers VK_EXT_memory_budget (VulkanContext enables it then).
+    bool HasMemoryBudgetExtension(VkPhysicalDevice physicalDevice);
+
+    // Cheap enough to call every frame.
+    DeviceMemoryBudget QueryDeviceLocalBudget(VkPhysicalDevice physicalDevice, bool hasBudgetExtension);
+
+} // namespace Engine
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+// ------------------------------------------------------------
+// Render scale controller driven by GPU frame time.
+//
+// - update() takes the GPU time of the latest completed frame and returns the render scale
+//   (fraction of the output width/height) to use next. Pixel cost goes with scale^2, so the
+//   scale that would hit the target is scale * sqrt(target / gpu).
+// - Drops quickly (a battle starting must not cost several long frames) and rises slowly, only
+//   with clear headroom, so the scale does not oscillate around the target.
+// - Changes are quantized to SCALE_STEP and held for at least HOLD_FRAMES: GPU timings arrive
+//   frames late and a new scale must show up in them before it is judged.
+// ------------------------------------------------------------
+namespace Engine
+{
+    class DynamicResolution
+    {
+    public:
+        // =====================
+        // TUNING CONSTANTS
+        // =====================
+        static constexpr float SCALE_STEP = 0.05f;
+        static constexpr int HOLD_FRAMES = 8;
+        static constexpr float DOWN_THRESHOLD = 0.95f; // of the target: scale down above this
+        static constexpr float UP_THRESHOLD = 0.80f;   // of the target: scale up below this
+        static constexpr float SMOOTHING = 0.2f;       // GPU time EMA weight of a new sample
+
+        struct Config
+        {
+            float targetGpuMs = 16.0f;
+            float minScale = 0.5f;
+            float maxScale = 1.0f;
+        };
+
+        void setConfig(const Config &cfg)
+        {
+            m_cfg = cfg;
+            m_cfg.minScale = std::clamp(m_cfg.minScale, 0.1f, 1.0f);
+            m_cfg.maxScale = std::clamp(m_cfg.maxScale, m_cfg.minScale, 1.0f);
+            m_scale = std::clamp(m_scale, m_cfg.minScale, m_cfg.maxScale);
+        }
+        const Config &config() const { return m_cfg; }
+
+        float scale() const { return m_scale; }
+        float smoothedGpuMs() const { return m_gpuMs; }
+
+        void reset(float scale = 1.0f)
+        {
+            m_scale = std::clamp(scale, m_cfg.minScale, m_cfg.maxScale);
+            m_gpuMs = 0.0f;
+            m_hold = HOLD_FRAMES;
+        }
+
+        float update(float gpuMs)
+        {
+            if (gpuMs <= 0.0f || m_cfg.targetGpuMs <= 0.0f)
+                return m_scale;
+
+            m_gpuMs = (m_gpuMs <= 0.0f) ? gpuMs : m_gpuMs + (gpuMs - m_gpuMs) * SMOOTHING;
+            if (m_hold > 0)
+            {
+                --m_hold;
+                return m_scale;
+            }
+
+            const float target = m_cfg.targetGpuMs;
+            // Spikes react to the raw sample, recovery to the smoothed one.
+            float ideal;
+            if (gpuMs > target * DOWN_THRESHOLD)
+                ideal = m_scale * std::sqrt(target * DOWN_THRESHOLD / gpuMs);
+            else if (m_gpuMs < target * UP_THRESHOLD)
+                ideal = std::min(m_scale * std::sqrt(target * UP_THRESHOLD / m_gpuMs), m_scale + SCALE_STEP);
+            else
+                return m_scale;
+
+            // Rounded down: a step up must fit entirely, a step down must cover the overrun.
+            const float stepped = std::floor(ideal / SCALE_STEP + 1e-3f) * SCALE_STEP;
+            const float next = std::clamp(stepped, m_cfg.minScale, m_cfg.maxScale);
+            if (std::fabs(next - m_scale) >= SCALE_STEP * 0.5f)
+            {
+                m_scale = next;
+                m_hold = HOLD_FRAMES;
+            }
+            return m_scale;
+        }
+
+    private:
+        Config m_cfg{};
+        float m_scale = 1.0f;
+        float m_gpuMs = 0.0f; // EMA of the reported GPU time
+        int m_hold = 0;
+    };
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+// ------------------------------------------------------------
+// Fixed-step accumulator for decoupling simulation from the render rate.
+//
+// - advance(frameDt) returns how many steps of stepSeconds() to simulate this frame; the
+//   remainder stays in the accumulator and alpha() (0..1) says how far the frame lies between
+//   the last two simulated states, for render interpolation.
+// - At most maxStepsPerFrame steps per frame: after a long hitch the excess time is dropped
+//   instead of simulating ever more steps per frame (spiral of death).
+// - stepSeconds <= 0 disables the fixed step: every frame is one step of the frame dt.
+// ------------------------------------------------------------
+namespace Engine
+{
+    class FixedTimestep
+    {
+    public:
+        struct Config
+        {
+            float stepSeconds = 1.0f / 30.0f;
+            uint32_t maxStepsPerFrame = 4;
+        };
+
+        struct Stats
+        {
+            uint32_t steps = 0;          // last advance()
+            uint64_t totalSteps = 0;
+            float droppedSeconds = 0.0f; // time discarded by maxStepsPerFrame, total
+        };
+
+        void setConfig(const Config &cfg)
+        {
+            m_cfg = cfg;
+            m_accumulator = 0.0f;
+        }
+        const Config &config() const { return m_cfg; }
+        const Stats &stats() const { return m_stats; }
+
+        bool enabled() const { return m_cfg.stepSeconds > 0.0f; }
+
+        // dt of every step of the last advance().
+        float stepSeconds() const { return enabled() ? m_cfg.stepSeconds : m_frameDt; }
+
+        uint32_t advance(float frameDt)
+        {
+            m_frameDt = std::max(frameDt, 0.0f);
+            if (!enabled())
+            {
+                m_stats.steps = m_frameDt > 0.0f ? 1u : 0u;
+                m_stats.totalSteps += m_stats.steps;
+                return m_stats.steps;
+            }
+
+            m_accumulator += m_frameDt;
+            uint32_t steps = static_cast<uint32_t>(m_accumulator / m_cfg.stepSeconds);
+            if (steps > m_cfg.maxStepsPerFrame)
+            {
+                const float kept = m_accumulator - static_cast<float>(steps) * m_cfg.stepSeconds;
+                m_stats.droppedSeconds += static_cast<float>(steps - m_cfg.maxStepsPerFrame) * m_cfg.stepSeconds;
+                steps = m_cfg.maxStepsPerFrame;
+                m_accumulator = static_cast<float>(steps) * m_cfg.stepSeconds + kept;
+            }
+            m_accumulator -= static_cast<float>(steps) * m_cfg.stepSeconds;
+            m_accumulator = std::max(m_accumulator, 0.0f);
+
+            m_stats.steps = steps;
+            m_stats.totalSteps += steps;
+            return steps;
+        }
+
+        // Position of the current frame between the previous and the latest step (1 when disabled).
+        float alpha() const
+        {
+            return enabled() ? std::min(m_accumulator / m_cfg.stepSeconds, 1.0f) : 1.0f;
+        }
+
+        void reset() { m_accumulator = 0.0f; }
+
+    private:
+        Config m_cfg{};
+        Stats m_stats{};
+        float m_accumulator = 0.0f;
+        float m_frameDt = 0.0f;
+    };
+}
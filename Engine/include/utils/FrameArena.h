@@ -0,0 +1,197 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+namespace Engine
+{
+    // ------------------------------------------------------------
+    // Per-thread bump allocator for scratch that dies with the frame.
+    //
+    // - FrameArena::local() is the calling thread's arena (workers, main thread, loaders each
+    //   get their own), so allocating takes no lock: an epoch check and a pointer bump.
+    // - FrameArena::endFrame() (Application, once per frame after the simulation job joined)
+    //   bumps a global epoch; every arena rewinds lazily on its next allocation. Memory from an
+    //   arena is therefore only valid until the end of the frame it was taken in: keep it inside
+    //   a system update or a render pass record, never in members, and don't use it from work
+    //   that spans frames (asset loads, background jobs).
+    // - An arena that overflows its block chains another one; the next rewind replaces the chain
+    //   with a single block of the combined size, so after a few frames the steady state makes
+    //   no heap allocations at all.
+    // - FrameVector<T> is a std::vector over the calling thread's arena. Growth abandons the old
+    //   buffer inside the arena (deallocate is a no-op), so reserve() what you can.
+    // ------------------------------------------------------------
+    class FrameArena
+    {
+    public:
+        // =====================
+        // TUNING CONSTANTS
+        // =====================
+        static constexpr size_t INITIAL_BLOCK_BYTES = 256u * 1024u;
+        static constexpr size_t MAX_ALIGN = alignof(std::max_align_t);
+
+        struct Stats
+        {
+            uint32_t arenas = 0;        // threads that ever used their arena
+            uint64_t reservedBytes = 0; // block bytes held by all arenas
+            uint64_t peakFrameBytes = 0; // largest single-thread use seen in one frame
+        };
+
+        FrameArena() = default;
+        ~FrameArena() { releaseBlocks(); }
+
+        FrameArena(const FrameArena &) = delete;
+        FrameArena &operator=(const FrameArena &) = delete;
+
+        static FrameArena &local()
+        {
+            thread_local FrameArena arena;
+            return arena;
+        }
+
+        // Invalidate every arena's allocations (they rewind on next use).
+        static void endFrame() { s_epoch.fetch_add(1u, std::memory_order_release); }
+
+        static Stats stats()
+        {
+            Stats s;
+            s.arenas = s_arenas.load(std::memory_order_relaxed);
+            s.reservedBytes = s_reservedBytes.load(std::memory_order_relaxed);
+            s.peakFrameBytes = s_peakFrameBytes.load(std::memory_order_relaxed);
+            return s;
+        }
+
+        void *allocate(size_t bytes, size_t align = MAX_ALIGN)
+        {
+            syncEpoch();
+            uintptr_t p = (m_cursor + (align - 1u)) & ~static_cast<uintptr_t>(align - 1u);
+            if (m_blocks.empty() || p + bytes > m_end)
+            {
+                addBlock(bytes + align);
+                p = (m_cursor + (align - 1u)) & ~static_cast<uintptr_t>(align - 1u);
+            }
+            m_cursor = p + bytes;
+            m_frameBytes += bytes;
+            return reinterpret_cast<void *>(p);
+        }
+
+        template <typename T>
+        T *allocateArray(size_t count)
+        {
+            return static_cast<T *>(allocate(count * sizeof(T), alignof(T)));
+        }
+
+        // Bytes handed out since the last rewind (padding excluded).
+        size_t usedBytes() const { return m_frameBytes; }
+
+    private:
+        struct Block
+        {
+            void *data;
+            size_t bytes;
+        };
+
+        void syncEpoch()
+        {
+            const uint64_t epoch = s_epoch.load(std::memory_order_acquire);
+            if (epoch == m_epoch)
+                return;
+            m_epoch = epoch;
+            rewind();
+        }
+
+        void rewind()
+        {
+            uint64_t peak = s_peakFrameBytes.load(std::memory_order_relaxed);
+            while (m_frameBytes > peak && !s_peakFrameBytes.compare_exchange_weak(peak, m_frameBytes, std::memory_order_relaxed))
+            {
+            }
+            m_frameBytes = 0;
+
+            // Overflowed last frame: one block big enough for all of it.
+            if (m_blocks.size() > 1u)
+            {
+                size_t total = 0;
+                for (const Block &b : m_blocks)
+                    total += b.bytes;
+                releaseBlocks();
+                addBlock(total);
+                return;
+            }
+            if (!m_blocks.empty())
+                m_cursor = reinterpret_cast<uintptr_t>(m_blocks.back().data);
+        }
+
+        void addBlock(size_t minBytes)
+        {
+            if (!m_registered)
+            {
+                m_registered = true;
+                s_arenas.fetch_add(1u, std::memory_order_relaxed);
+            }
+            const size_t last = m_blocks.empty() ? INITIAL_BLOCK_BYTES / 2u : m_blocks.back().bytes;
+            const size_t bytes = std::max(minBytes, last * 2u);
+            void *data = ::operator new(bytes, std::align_val_t(MAX_ALIGN));
+            m_blocks.push_back(Block{data, bytes});
+            s_reservedBytes.fetch_add(bytes, std::memory_order_relaxed);
+            m_cursor = reinterpret_cast<uintptr_t>(data);
+            m_end = m_cursor + bytes;
+        }
+
+        void releaseBlocks()
+        {
+            for (const Block &b : m_blocks)
+            {
+                ::operator delete(b.data, std::align_val_t(MAX_ALIGN));
+                s_reservedBytes.fetch_sub(b.bytes, std::memory_order_relaxed);
+            }
+            m_blocks.clear();
+            m_cursor = m_end = 0;
+        }
+
+        std::vector<Block> m_blocks; // newest last; allocations come from the newest
+        uintptr_t m_cursor = 0;
+        uintptr_t m_end = 0;
+        size_t m_frameBytes = 0;
+        uint64_t m_epoch = 0;
+        bool m_registered = false;
+
+        static inline std::atomic<uint64_t> s_epoch{0};
+        static inline std::atomic<uint32_t> s_arenas{0};
+        static inline std::atomic<uint64_t> s_reservedBytes{0};
+        static inline std::atomic<uint64_t> s_peakFrameBytes{0};
+    };
+
+    // STL allocator over the arena of the thread that constructed it.
+    template <typename T>
+    class FrameAllocator
+    {
+    public:
+        using value_type = T;
+
+        FrameAllocator() : m_arena(&FrameArena::local()) {}
+        explicit FrameAllocator(FrameArena &arena) : m_arena(&arena) {}
+        template <typename U>
+        FrameAllocator(const FrameAllocator<U> &other) : m_arena(other.arena()) {}
+
+        T *allocate(size_t n) { return m_arena->allocateArray<T>(n); }
+        void deallocate(T *, size_t) {}
+
+        FrameArena *arena() const { return m_arena; }
+
+        template <typename U>
+        bool operator==(const FrameAllocator<U> &o) const { return m_arena == o.arena(); }
+        template <typename U>
+        bool operator!=(const FrameAllocator<U> &o) const { return m_arena != o.arena(); }
+
+    private:
+        FrameArena *m_arena; // not owned
+    };
+
+    template <typename T>
+    using FrameVector = std::vector<T, FrameAllocator<T>>;
+}
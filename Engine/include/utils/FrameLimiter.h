@@ -0,0 +1,81 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+// ------------------------------------------------------------
+// Frame rate cap with precise sleep plus spin.
+//
+// - wait() blocks until the next frame deadline (1 / targetFps after the previous one). It
+//   sleeps while the remaining time is above the learned oversleep of the OS timer and spins
+//   (yielding) for the rest, so the cap is accurate without burning a core for the whole frame.
+// - Deadlines advance by whole periods; a frame that ran late starts a new schedule instead of
+//   letting the following frames catch up in a burst.
+// - targetFps <= 0 disables the cap (wait() returns at once).
+// ------------------------------------------------------------
+namespace Engine
+{
+    class FrameLimiter
+    {
+    public:
+        // =====================
+        // TUNING CONSTANTS
+        // =====================
+        static constexpr double MIN_SPIN_MS = 0.5;  // always spin at least this long
+        static constexpr double MAX_SPIN_MS = 20.0; // coarse timers (15.6 ms) degrade to spinning
+
+        void setTargetFps(float fps)
+        {
+            m_targetFps = std::max(fps, 0.0f);
+            m_hasDeadline = false;
+        }
+        float targetFps() const { return m_targetFps; }
+        bool enabled() const { return m_targetFps > 0.0f; }
+
+        // Returns the milliseconds spent waiting.
+        float wait()
+        {
+            using Clock = std::chrono::steady_clock;
+            using Ms = std::chrono::duration<double, std::milli>;
+
+            if (!enabled())
+                return 0.0f;
+
+            const Clock::time_point start = Clock::now();
+            const Clock::duration period = std::chrono::duration_cast<Clock::duration>(Ms(1000.0 / m_targetFps));
+            if (!m_hasDeadline || start > m_deadline + period)
+            {
+                m_deadline = start + period;
+                m_hasDeadline = true;
+                return 0.0f;
+            }
+
+            const double spinMs = std::clamp(m_oversleepMs, MIN_SPIN_MS, MAX_SPIN_MS);
+            for (;;)
+            {
+                const Clock::time_point now = Clock::now();
+                const double remainingMs = Ms(m_deadline - now).count();
+                if (remainingMs <= spinMs)
+                    break;
+
+                // Sleep in short slices and learn how far the OS overshoots them.
+                const double sliceMs = std::min(remainingMs - spinMs, 1.0);
+                std::this_thread::sleep_for(Ms(sliceMs));
+                const double overshootMs = Ms(Clock::now() - now).count() - sliceMs;
+                m_oversleepMs = std::max(overshootMs, m_oversleepMs * 0.95 + overshootMs * 0.05);
+            }
+            while (Clock::now() < m_deadline)
+                std::this_thread::yield();
+
+            m_deadline += period;
+            return static_cast<float>(Ms(Clock::now() - start).count());
+        }
+
+    private:
+        float m_targetFps = 0.0f;
+        bool m_hasDeadline = false;
+        std::chrono::steady_clock::time_point m_deadline{};
+        double m_oversleepMs = 1.0; // running estimate of sleep_for() overshoot
+    };
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include "utils/GpuAllocator.h"
+#include <atomic>
+#include <cstdint>
+
+namespace Engine
+{
+    // ============================================================
+    // FrameUploadRing
+    // ============================================================
+    // One persistently mapped host-visible buffer for per-frame constants (camera blocks, pass
+    // UBOs, small SSBO uploads), split into one segment per frame slot. Passes sub-allocate
+    // from the current segment every frame and bind the result with a dynamic offset, so a
+    // pass needs no buffer, memory or descriptor set per frame slot for its constants.
+    //
+    // - beginFrame(slot) rewinds that slot's segment; call it once the slot's fence signaled.
+    // - allocate() is lock-free (one CAS on the segment cursor) and may be called from parallel
+    //   recording. Data written through Allocation::mapped is visible to the frame's submit
+    //   (host-coherent memory).
+    // - A full segment fails the allocation (counted in stats()); raise the per-frame size.
+    class FrameUploadRing
+    {
+    public:
+        // =====================
+        // TUNING CONSTANTS
+        // =====================
+        static constexpr VkDeviceSize DEFAULT_BYTES_PER_FRAME = 1ull << 20;
+
+        struct Allocation
+        {
+            VkBuffer buffer = VK_NULL_HANDLE;
+            VkDeviceSize offset = 0;   // from the start of buffer (dynamic offsets take this)
+            uint8_t *mapped = nullptr; // already offset
+
+            bool valid() const { return mapped != nullptr; }
+            uint32_t dynamicOffset() const { return static_cast<uint32_t>(offset); }
+        };
+
+        struct Stats
+        {
+            VkDeviceSize usedBytes = 0; // current frame so far
+            VkDeviceSize peakBytes = 0; // largest frame since create()
+            uint64_t failed = 0;        // allocations that did not fit, since create()
+        };
+
+        FrameUploadRing() = default;
+        ~FrameUploadRing() = default; // call destroy() while the device is alive
+
+        FrameUploadRing(const FrameUploadRing &) = delete;
+        FrameUploadRing &operator=(const FrameUploadRing &) = delete;
+
+        VkResult create(VkDevice device, VkPhysicalDevice physicalDevice, uint32_t frameCount,
+                        VkDeviceSize bytesPerFrame = DEFAULT_BYTES_PER_FRAME);
+        void destroy();
+
+        bool valid() const { return m_buffer != VK_NULL_HANDLE; }
+        VkBuffer buffer() const { return m_buffer; }
+        VkDeviceSize bytesPerFrame() const { return m_segmentBytes; }
+        VkDeviceSize memoryBytes() const { return m_segmentBytes * m_frameCount; }
+
+        void beginFrame(uint32_t frameSlot);
+
+        // size bytes at a multiple of alignment (power of two) in the current frame's segment.
+        bool allocate(VkDeviceSize size, VkDeviceSize alignment, Allocation &out);
+        // Aligned for a (dynamic) uniform / storage buffer binding on this device.
+        bool allocateUniform(VkDeviceSize size, Allocation &out) { return allocate(size, m_uniformAlignment, out); }
+        bool allocateStorage(VkDeviceSize size, Allocation &out) { return allocate(size, m_storageAlignment, out); }
+
+        Stats stats() const;
+
+    private:
+        VkDevice m_device = VK_NULL_HANDLE;
+        VkBuffer m_buffer = VK_NULL_HANDLE;
+        GpuAllocation m_memory;
+        uint8_t *m_mapped = nullptr;
+
+        uint32_t m_frameCount = 0;
+        VkDeviceSize m_segmentBytes = 0;
+        VkDeviceSize m_uniformAlignment = 256;
+        VkDeviceSize m_storageAlignment = 256;
+
+        VkDeviceSize m_segmentBase = 0;               // current frame's segment
+        std::atomic<VkDeviceSize> m_cursor{0};        // bytes used in it
+        VkDeviceSize m_peak = 0;
+        std::atomic<uint64_t> m_failed{0};
+    };
+}
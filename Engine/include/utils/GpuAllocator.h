@@ -0,0 +1,128 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace Engine
+{
+    // One sub-allocation handed out by GpuAllocator (or a dedicated allocation when no allocator
+    // is registered for the device). Resources bind at (memory, offset); never vkMapMemory /
+    // vkFreeMemory the memory directly — several resources share it. Host-visible allocations
+    // are persistently mapped: use 'mapped'.
+    struct GpuAllocation
+    {
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkDeviceSize offset = 0;
+        VkDeviceSize size = 0;
+        void *mapped = nullptr; // already offset; null for device-local memory
+        uint32_t block = UINT32_MAX; // UINT32_MAX = dedicated VkDeviceMemory
+
+        bool valid() const { return memory != VK_NULL_HANDLE; }
+    };
+
+    // Buffers and optimal-tiling images never share a block, so bufferImageGranularity never
+    // has to be honoured between neighbours.
+    enum class GpuResourceKind : uint8_t
+    {
+        Linear,
+        Optimal
+    };
+
+    // ============================================================
+    // GpuAllocator
+    // ============================================================
+    // Block sub-allocator for device memory, owned by VulkanContext. Each memory type gets a list
+    // of large VkDeviceMemory blocks carved with a first-fit free list (adjacent free ranges are
+    // merged on free). Requests larger than half a block get their own allocation. This keeps the
+    // vkAllocateMemory count far below maxMemoryAllocationCount and removes a driver round trip
+    // from every buffer/texture created while loading.
+    //
+    // The free functions below (AllocateBufferMemory, ...) find the allocator registered for a
+    // VkDevice, so utilities that only receive (device, physicalDevice) still sub-allocate.
+    class GpuAllocator
+    {
+    public:
+        static constexpr VkDeviceSize DEFAULT_BLOCK_SIZE = 64ull * 1024ull * 1024ull;
+
+        struct Stats
+        {
+            uint32_t deviceAllocations = 0; // live VkDeviceMemory objects (blocks + dedicated)
+            uint32_t subAllocations = 0;
+            VkDeviceSize reservedBytes = 0; // bytes held in VkDeviceMemory
+            VkDeviceSize usedBytes = 0;     // bytes handed out to resources
+        };
+
+        GpuAllocator() = default;
+        ~GpuAllocator() = default; // call shutdown() while the device is alive
+
+        GpuAllocator(const GpuAllocator &) = delete;
+        GpuAllocator &operator=(const GpuAllocator &) = delete;
+
+        // Registers this allocator for 'device' (see forDevice()).
+        void init(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize blockSize = DEFAULT_BLOCK_SIZE);
+
+        // Frees every block. Resources still bound to them must already be destroyed.
+        void shutdown();
+
+        bool findMemoryType(uint32_t typeBits, VkMemoryPropertyFlags props, uint32_t &outIndex) const;
+
+        VkResult allocate(const VkMemoryRequirements &req, VkMemoryPropertyFlags props, GpuResourceKind kind, GpuAllocation &out);
+        void free(GpuAllocation &alloc);
+
+        Stats stats() const;
+
+        static GpuAllocator *forDevice(VkDevice device);
+
+    private:
+        struct Range
+        {
+            VkDeviceSize offset = 0;
+            VkDeviceSize size = 0;
+        };
+
+        struct Block
+        {
+            VkDeviceMemory memory = VK_NULL_HANDLE; // null = slot unused
+            VkDeviceSize size = 0;
+            VkDeviceSize used = 0;
+            uint8_t *mapped = nullptr;
+            uint32_t memoryType = 0;
+            GpuResourceKind kind = GpuResourceKind::Linear;
+            uint32_t liveCount = 0;
+            std::vector<Range> freeRanges; // sorted by offset, never adjacent
+        };
+
+        bool tryAllocateFromBlock(Block &b, const VkMemoryRequirements &req, VkDeviceSize &outOffset);
+        void releaseRange(Block &b, VkDeviceSize offset, VkDeviceSize size);
+        VkResult allocateDedicated(const VkMemoryRequirements &req, uint32_t memoryType, GpuAllocation &out);
+        VkResult createBlock(uint32_t memoryType, GpuResourceKind kind, VkDeviceSize size, uint32_t &outIndex);
+        void destroyBlock(Block &b);
+
+    private:
+        VkDevice m_device = VK_NULL_HANDLE;
+        VkPhysicalDeviceMemoryProperties m_memProps{};
+        VkDeviceSize m_blockSize = DEFAULT_BLOCK_SIZE;
+
+        mutable std::mutex m_mutex;
+        std::vector<Block> m_blocks;
+        uint32_t m_dedicatedCount = 0;
+        VkDeviceSize m_dedicatedBytes = 0;
+        uint32_t m_subAllocCount = 0;
+    };
+
+    // First memory type in typeBits that has all of props.
+    bool FindMemoryType(VkPhysicalDevice physicalDevice, uint32_t typeBits, VkMemoryPropertyFlags props, uint32_t &outIndex);
+
+    // Allocate memory for an existing resource and bind it. Uses the device's registered
+    // GpuAllocator, or a dedicated vkAllocateMemory when there is none.
+    VkResult AllocateBufferMemory(VkDevice device, VkPhysicalDevice physicalDevice, VkBuffer buffer,
+                                  VkMemoryPropertyFlags props, GpuAllocation &out);
+    // Pass GpuResourceKind::Linear for VK_IMAGE_TILING_LINEAR images.
+    VkResult AllocateImageMemory(VkDevice device, VkPhysicalDevice physicalDevice, VkImage image,
+                                 VkMemoryPropertyFlags props, GpuAllocation &out,
+                                 GpuResourceKind kind = GpuResourceKind::Optimal);
+
+    // Release an allocation from either path and reset it.
+    void FreeGpuMemory(VkDevice device, GpuAllocation &alloc);
+}
@@ -2,9 +2,12 @@
 #include <vulkan/vulkan.h>
 #include <cstdint>
 #include <vector>
+#include "utils/GpuAllocator.h"
 
 namespace Engine
 {
+    class StagingRing;
+
     // ============================================================
     // Staging buffer handle
     // ============================================================
@@ -13,7 +16,7 @@ namespace Engine
     struct StagingBufferHandle
     {
         VkBuffer buffer = VK_NULL_HANDLE;
-        VkDeviceMemory memory = VK_NULL_HANDLE;
+        GpuAllocation memory;
         VkDeviceSize size = 0;
     };
 
@@ -39,6 +42,10 @@ namespace Engine
     //   ... record transitions + buffer copies for multiple textures ...
     //   EndSubmitAndWait(ctx);
     //
+    // With UseTransferQueue() the buffer copies and the uploads into newly created images (the
+    // ones transitioned from UNDEFINED to TRANSFER_DST) run on a dedicated transfer queue; the
+    // graphics family acquires them before cmd runs. Routed copies must target resources created
+    // for this upload (their earlier contents are not carried over).
     struct UploadContext
     {
         VkDevice device = VK_NULL_HANDLE;
@@ -52,6 +59,24 @@ namespace Engine
         // We'll collect them here and destroy at the end.
         std::vector<StagingBufferHandle> pendingStaging;
 
+        // Optional persistent staging ring (set before recording). StageBytes() takes space from
+        // it when the bytes fit and falls back to a dedicated staging buffer otherwise.
+        StagingRing *ring = nullptr;
+
+        // Transfer queue routing (UseTransferQueue()); transferCmd is null when not in use.
+        struct TransferImage
+        {
+            VkImage image = VK_NULL_HANDLE;
+            VkImageSubresourceRange range{};
+        };
+        VkQueue transferQueue = VK_NULL_HANDLE;
+        VkCommandPool transferPool = VK_NULL_HANDLE;
+        VkCommandBuffer transferCmd = VK_NULL_HANDLE;
+        uint32_t transferFamily = 0;
+        uint32_t graphicsFamily = 0;
+        std::vector<VkBuffer> transferBuffers;     // copy destinations to hand to graphicsFamily
+        std::vector<TransferImage> transferImages; // images uploaded on transferCmd
+
         bool begun = false;
     };
 
@@ -62,9 +87,29 @@ namespace Engine
         VkCommandPool commandPool,
         VkQueue queue);
 
+    // Routes the upload's copies through transferQueue (after BeginUploadContext, before
+    // recording). transferPool belongs to transferFamily. False (graphics queue only) when the
+    // families match or the command buffer cannot be allocated.
+    bool UseTransferQueue(
+        UploadContext &ctx,
+        VkCommandPool transferPool,
+        VkQueue transferQueue,
+        uint32_t transferFamily,
+        uint32_t graphicsFamily);
+
     // Submits command buffer, waits for completion, destroys staging buffers, frees cmd buffer.
+    // A transfer queue submit goes first; the graphics submit waits for it on a semaphore.
     bool EndSubmitAndWait(UploadContext &ctx);
 
+    // Copy bytes into staging memory owned by this upload (ring or dedicated buffer) and return
+    // where they landed; use the result as the source of a recorded copy.
+    bool StageBytes(
+        UploadContext &ctx,
+        const void *dataBytes,
+        VkDeviceSize dataSize,
+        VkBuffer &outBuffer,
+        VkDeviceSize &outOffset);
+
     // ============================================================
     // Image creation helpers
     // ============================================================
@@ -79,7 +124,7 @@ namespace Engine
         VkFormat format,
         VkImageUsageFlags usage,
         VkImage &outImage,
-        VkDeviceMemory &outMemory);
+        GpuAllocation &outMemory);
 
     // Create a 2D GPU image with explicit mip levels.
     VkResult CreateImage2D(
@@ -91,7 +136,7 @@ namespace Engine
         VkImageUsageFlags usage,
         uint32_t mipLevels,
         VkImage &outImage,
-        VkDeviceMemory &outMemory);
+        GpuAllocation &outMemory);
 
     // Create an image view for sampling.
     VkResult CreateImageView2D(
@@ -113,8 +158,9 @@ namespace Engine
     // ============================================================
     // Command recording helpers (NO submit here!)
     // ============================================================
-    // These functions RECORD commands into ctx.cmd.
-    // They do not submit / wait. That is handled in EndSubmitAndWait().
+    // These functions RECORD commands into ctx.cmd (buffer copies and new-image uploads into
+    // ctx.transferCmd when it is set). They do not submit / wait. That is handled in
+    // EndSubmitAndWait().
 
     void CmdTransitionImageLayout(
         UploadContext &ctx,
@@ -123,12 +169,43 @@ namespace Engine
         VkImageLayout newLayout,
         VkImageAspectFlags aspectFlags);
 
+    // Same, covering mips [0, mipLevels).
+    void CmdTransitionImageLayout(
+        UploadContext &ctx,
+        VkImage image,
+        VkImageLayout oldLayout,
+        VkImageLayout newLayout,
+        VkImageAspectFlags aspectFlags,
+        uint32_t mipLevels);
+
+    void CmdCopyBuffer(
+        UploadContext &ctx,
+        VkBuffer src,
+        VkDeviceSize srcOffset,
+        VkBuffer dst,
+        VkDeviceSize size,
+        VkDeviceSize dstOffset = 0);
+
     void CmdCopyBufferToImage(
         UploadContext &ctx,
         VkBuffer buffer,
         VkImage image,
         uint32_t width,
-        uint32_t height);
+        uint32_t height,
+        VkDeviceSize bufferOffset = 0,
+        uint32_t mipLevel = 0);
+
+    // Copies levels [srcBaseMip, srcBaseMip + levelCount) of src into levels [0, levelCount) of
+    // dst; width/height are the extent of src level srcBaseMip. Expects src in
+    // TRANSFER_SRC_OPTIMAL and dst in TRANSFER_DST_OPTIMAL.
+    void CmdCopyImageMips(
+        UploadContext &ctx,
+        VkImage src,
+        uint32_t srcBaseMip,
+        VkImage dst,
+        uint32_t width,
+        uint32_t height,
+        uint32_t levelCount);
 
     // Record mipmap generation via blits for a 2D color image.
     // Expects mip 0 to be in TRANSFER_DST_OPTIMAL.
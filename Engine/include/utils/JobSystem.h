@@ -3,58 +3,334 @@
 #include <atomic>
 #include <condition_variable>
 #include <cstdint>
+#include <deque>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
+#include "utils/CpuTopology.h"
+
 namespace Engine
 {
-    // A small, barrier-style job system meant for predictable "parallel-for" style workloads.
-    // - No per-job allocations.
-    // - Workers are persistent threads.
-    // - Each parallelFor call distributes indices via an atomic counter.
-    //
-    // This is intentionally minimal: enough to safely introduce parallelism system-by-system.
+    class JobHandle;
+
+    // Scheduling class of a submit()/then() job. High jobs are taken before Normal, Normal
+    // before Background; Background jobs go to the background workers when there are any.
+    enum class JobPriority : uint8_t
+    {
+        High,      // latency critical: the frame waits for it (pipelined simulation)
+        Normal,
+        Background // streaming, decoding, cooking
+    };
+
+    // A small work-stealing job system meant for predictable "parallel-for" style workloads.
+    // - No per-job allocations (loop state lives on the caller's stack).
+    // - Workers are persistent threads, each owning a deque of range tasks.
+    // - A loop starts as one range; whoever executes a range splits it in half and pushes the
+    //   upper half onto its own deque until the range is small enough. Idle workers steal the
+    //   oldest (largest) ranges from other deques.
+    // - parallelFor may be called from inside a job (nested loops) and from several threads
+    //   at once. A waiting caller keeps executing tasks until its own loop is finished.
+    // - parallelForRange hands whole sub-ranges to a templated callback, so the per-item loop
+    //   is inlined into the caller's code and there is one indirect call per range only.
+    // - submit()/then() start fire-and-forget jobs (file IO, decoding) that run on workers
+    //   without blocking the caller. thenOnMainThread() queues a continuation that runs inside
+    //   runMainThreadJobs(), for steps that must happen on the render thread (GPU uploads).
+    // - takeMetrics() reports per-thread busy/idle/sleep/wait time, steals and per-loop
+    //   (per profiler zone) caller-vs-worker item split, for tuning parallel thresholds.
+    // - Workers are loop workers [0, loopWorkerCount()) or background workers after them.
+    //   Background workers never steal loop ranges: a range on a slow core would hold up the
+    //   whole parallelFor. With Config::AutoWorkers on a hybrid CPU, loop workers go to the
+    //   performance cores (one less than their logical CPUs; the caller keeps one) and
+    //   background workers to the efficiency cores, at below-normal priority.
     class JobSystem
     {
     public:
         using JobFn = std::function<void(uint32_t workerIndex, uint32_t itemIndex)>;
 
+        // Time and work of one thread slot. Slots [0, workerCount()) are workers; the last slot
+        // is shared by every other thread (main, simulation caller) helping with loops.
+        struct ThreadMetrics
+        {
+            uint64_t busyNs = 0;  // executing loop ranges and async jobs
+            uint64_t spinNs = 0;  // worker looking for work before going to sleep
+            uint64_t sleepNs = 0; // worker blocked on the wake condition variable
+            uint64_t waitNs = 0;  // parallelFor caller / wait() with nothing left to help with
+            uint64_t ranges = 0;
+            uint64_t items = 0;
+            uint64_t jobs = 0;   // submit()/then() jobs run
+            uint64_t steals = 0; // ranges taken from another thread's queue
+        };
+
+        // One loop call site, keyed by the profiler zone active when the loop started
+        // (SystemScheduler names it after the system). callerItems / items is the share the
+        // calling thread ran itself; inlineCalls ran entirely on the caller (at or below grain).
+        struct LoopMetrics
+        {
+            const char *name = nullptr;
+            uint64_t calls = 0;
+            uint64_t inlineCalls = 0;
+            uint64_t items = 0;
+            uint64_t callerItems = 0;
+            uint64_t wallNs = 0; // caller time from start to completion
+
+            float serialFraction() const { return items ? static_cast<float>(callerItems) / static_cast<float>(items) : 0.0f; }
+        };
+
+        struct Metrics
+        {
+            uint64_t windowNs = 0;              // time covered, since the previous takeMetrics()
+            std::vector<ThreadMetrics> threads; // workerCount() + 1 entries
+            std::vector<LoopMetrics> loops;     // unordered
+        };
+
+        // Pass as grain to let the job system choose one (see autoGrain()).
+        static constexpr uint32_t AutoGrain = 0;
+
+        struct Config
+        {
+            static constexpr uint32_t AutoWorkers = UINT32_MAX;
+
+            // AutoWorkers: derived from the CPU topology (see the class comment). Otherwise
+            // that many loop workers, spread over performance cores first.
+            uint32_t workerCount = AutoWorkers;
+            // Auto only: background workers on efficiency cores (hybrid CPUs).
+            bool backgroundWorkers = true;
+            // One CPU per loop worker (SMT primaries first) instead of the set of performance
+            // cores. The calling thread is never pinned; its core is left out when possible.
+            bool pinWorkers = false;
+        };
+
         // If workerCount == 0, the job system runs work on the calling thread only.
         explicit JobSystem(uint32_t workerCount);
+        explicit JobSystem(const Config &config);
         ~JobSystem();
 
         JobSystem(const JobSystem &) = delete;
         JobSystem &operator=(const JobSystem &) = delete;
 
         uint32_t workerCount() const { return m_workerCount; }
+        // Workers that execute parallelFor ranges; the rest only run submitted jobs.
+        uint32_t loopWorkerCount() const { return m_loopWorkerCount; }
         bool isRunning() const { return m_running; }
+        const CpuTopology &topology() const { return m_topology; }
 
         // Run fn over [0, itemCount) in parallel. Blocks until complete.
+        // workerIndex is in [0, workerCount()]: worker threads use their own index, any other
+        // thread (main thread, tools) uses workerCount(). Callers that size per-worker scratch
+        // as workerCount() + 1 stay valid for nested loops.
         void parallelFor(uint32_t itemCount, const JobFn &fn);
 
+        // Run fn(workerIndex, first, last) over disjoint sub-ranges covering [begin, end).
+        // Blocks until complete. Ranges are never shorter than grain items (except the tail);
+        // AutoGrain uses autoGrain(end - begin). workerIndex follows the parallelFor rules.
+        // Ranges at or below the grain run directly on the calling thread.
+        template <typename Fn>
+        void parallelForRange(uint32_t begin, uint32_t end, uint32_t grain, const Fn &fn)
+        {
+            if (end <= begin)
+                return;
+
+            struct Ctx
+            {
+                const Fn *fn;
+                uint32_t base;
+            };
+            const Ctx ctx{&fn, begin};
+            runRange([](const void *p, uint32_t workerIndex, uint32_t first, uint32_t last)
+                     {
+                         const Ctx &c = *static_cast<const Ctx *>(p);
+                         (*c.fn)(workerIndex, c.base + first, c.base + last); },
+                     &ctx, end - begin, grain);
+        }
+
+        // Grain size for itemCount items: about four ranges per thread so stealing
+        // can balance uneven items. itemCostNs is a rough per-item cost estimate (0 = unknown);
+        // when given, ranges are kept long enough to amortize the cost of scheduling them.
+        uint32_t autoGrain(uint32_t itemCount, uint32_t itemCostNs = 0) const;
+
+        // True when the calling thread is currently executing a parallelFor item.
+        static bool isInsideJob();
+
+        // Index of the calling thread by the parallelFor rules: its own index on a worker of this
+        // job system, workerCount() anywhere else. Handy for per-thread scratch outside a loop body.
+        uint32_t currentWorkerIndex() const;
+
+        // Start fn on a worker and return immediately. Without workers fn runs inline.
+        JobHandle submit(std::function<void()> fn, JobPriority priority = JobPriority::Normal);
+
+        // Start fn on a worker once 'after' has finished (immediately if it already has, or if
+        // 'after' is empty).
+        JobHandle then(const JobHandle &after, std::function<void()> fn, JobPriority priority = JobPriority::Normal);
+
+        // Queue fn for runMainThreadJobs() once 'after' has finished.
+        JobHandle thenOnMainThread(const JobHandle &after, std::function<void()> fn);
+        JobHandle postToMainThread(std::function<void()> fn);
+
+        // Run queued main-thread jobs on the calling thread; returns how many ran. Call once per
+        // frame from the thread that owns the renderer. Jobs queued while running are picked up
+        // within the same call as long as maxJobs allows.
+        uint32_t runMainThreadJobs(uint32_t maxJobs = UINT32_MAX);
+
+        // Block until the job has finished, executing other tasks meanwhile. A non-worker thread
+        // (the frame loop) helps with parallelFor ranges, the awaited job itself and High jobs
+        // only; Normal and Background jobs stay with the workers, so a streaming job never
+        // stalls the frame. Waiting for a main-thread job from the thread that calls
+        // runMainThreadJobs() never returns.
+        void wait(const JobHandle &job);
+
+        // Counters accumulated since the previous call (or construction), then reset. Idle
+        // phases are added when they end, so a thread asleep right now shows up next window.
+        // Counting costs two clock reads per range/job and a short lock per loop; off skips both.
+        Metrics takeMetrics();
+        void setMetricsEnabled(bool enable) { m_metricsEnabled.store(enable, std::memory_order_relaxed); }
+        bool metricsEnabled() const { return m_metricsEnabled.load(std::memory_order_relaxed); }
+
     private:
+        friend class JobHandle;
+
+        // Type-erased loop body: runs items [first, last).
+        using RangeFn = void (*)(const void *ctx, uint32_t workerIndex, uint32_t first, uint32_t last);
+
+        // One in-flight loop. Lives on the stack of the thread that called parallelFor.
+        struct TaskGroup
+        {
+            RangeFn invoke = nullptr;
+            const void *ctx = nullptr;
+            uint32_t grain = 1;
+            const char *zoneName = nullptr; // caller's profiler zone, reused for its ranges
+            std::atomic<uint32_t> remaining{0};
+        };
+
+        // Shared state of a submitted job. Heap allocated; 'self' keeps it alive while queued or
+        // running, handles keep it alive for isDone()/wait().
+        struct AsyncJob
+        {
+            std::function<void()> fn;
+            bool mainThread = false;
+            JobPriority priority = JobPriority::Normal;
+            std::atomic<bool> done{false};
+
+            std::mutex mutex; // guards continuations and the done transition
+            std::vector<std::shared_ptr<AsyncJob>> continuations;
+
+            std::shared_ptr<AsyncJob> self;
+        };
+
+        struct Task
+        {
+            TaskGroup *group = nullptr;
+            uint32_t begin = 0;
+            uint32_t end = 0;
+        };
+
+        // Per-worker deque: the owner pushes/pops at the back, thieves take from the front.
+        // Protected by a mutex that is uncontended except while stealing.
+        struct WorkQueue
+        {
+            std::mutex mutex;
+            std::vector<Task> tasks;
+            size_t head = 0;
+        };
+
+        JobHandle addJob(std::function<void()> fn, const JobHandle &after, bool mainThread, JobPriority priority);
+        void schedule(AsyncJob *job);
+        void runJob(AsyncJob *job);
+        void completeJob(AsyncJob *job);
+        // Highest priority job the calling thread may run (background workers skip High).
+        bool popAsync(AsyncJob *&out);
+        // For wait() on a non-worker thread: `awaited` if it is still queued, else a High job.
+        bool popAwaited(const AsyncJob *awaited, AsyncJob *&out);
+        bool asyncReadyFor(bool backgroundWorker) const;
+        void wakeOne();
+        void wakeForJob(JobPriority priority);
+
+        void startWorkers(const Config &config);
+        bool isBackgroundWorker(uint32_t index) const { return index >= m_loopWorkerCount && index < m_workerCount; }
+
+        void runRange(RangeFn invoke, const void *ctx, uint32_t itemCount, uint32_t grain);
+        void runGroup(TaskGroup &group, uint32_t itemCount);
+        // Returns the number of items this call ran itself (the rest were pushed for thieves).
+        uint32_t execute(const Task &task, uint32_t workerIndex);
+        void push(const Task &task);
+        bool popLocal(uint32_t queueIndex, Task &out);
+        bool steal(uint32_t thiefQueue, Task &out);
+        bool findTask(Task &out);
+
         void workerMain(uint32_t workerIndex);
 
+        // Relaxed atomics: the shared non-worker slot can have several writers.
+        struct alignas(64) ThreadCounters
+        {
+            std::atomic<uint64_t> busyNs{0};
+            std::atomic<uint64_t> spinNs{0};
+            std::atomic<uint64_t> sleepNs{0};
+            std::atomic<uint64_t> waitNs{0};
+            std::atomic<uint64_t> ranges{0};
+            std::atomic<uint64_t> items{0};
+            std::atomic<uint64_t> jobs{0};
+            std::atomic<uint64_t> steals{0};
+        };
+        ThreadCounters &counters() { return m_counters[currentWorkerIndex()]; }
+        bool countingMetrics() const { return m_metricsEnabled.load(std::memory_order_relaxed); }
+        void recordLoop(const char *name, bool inlined, uint32_t items, uint32_t callerItems, uint64_t wallNs);
+
     private:
         uint32_t m_workerCount = 0;
+        uint32_t m_loopWorkerCount = 0;
         std::vector<std::thread> m_workers;
+        CpuTopology m_topology;
 
         std::atomic<bool> m_running{false};
 
-        // Serialize submissions; this job system runs one parallelFor at a time.
-        std::mutex m_submitMutex;
+        // Queues [0, workerCount) belong to workers; queue[workerCount] is the shared injection
+        // queue used by non-worker threads.
+        std::vector<std::unique_ptr<WorkQueue>> m_queues;
+
+        // Sleep/wake for idle workers; background workers wait on their own condition variable
+        // so a loop task's wake-up never lands on a thread that won't take it.
+        std::atomic<uint32_t> m_queuedTasks{0};
+        std::atomic<uint32_t> m_sleepers{0};
+        std::atomic<uint32_t> m_backgroundSleepers{0};
+        std::mutex m_sleepMutex;
+        std::condition_variable m_cvWork;
+        std::condition_variable m_cvBackground;
+
+        // Async jobs. Ready worker jobs wait in their own FIFOs (one per priority) that only idle
+        // workers (and wait(), see popAwaited()) drain, so a thread helping with a parallelFor
+        // never picks up a long background job.
+        static constexpr uint32_t PRIORITY_COUNT = 3;
+        std::atomic<uint32_t> m_asyncInFlight{0};
+        std::atomic<uint32_t> m_asyncQueued[PRIORITY_COUNT]{};
+        std::atomic<bool> m_stopping{false};
+        std::mutex m_asyncMutex;
+        std::deque<AsyncJob *> m_asyncJobs[PRIORITY_COUNT];
+        std::mutex m_mainMutex;
+        std::deque<AsyncJob *> m_mainJobs;
+
+        // Metrics (see takeMetrics()).
+        std::atomic<bool> m_metricsEnabled{true};
+        std::unique_ptr<ThreadCounters[]> m_counters; // workerCount + 1
+        std::atomic<uint64_t> m_metricsSinceNs{0};
+        std::mutex m_loopMutex;
+        std::unordered_map<const char *, LoopMetrics> m_loops;
+    };
 
-        // Current job group
-        std::mutex m_mutex;
-        std::condition_variable m_cvStart;
-        std::condition_variable m_cvDone;
-        uint64_t m_jobId = 0;
-        uint32_t m_activeWorkers = 0;
+    // Handle to a job started with JobSystem::submit()/then(). Cheap to copy.
+    // An empty handle counts as finished.
+    class JobHandle
+    {
+    public:
+        JobHandle() = default;
 
-        std::atomic<uint32_t> m_nextIndex{0};
-        uint32_t m_itemCount = 0;
-        JobFn m_jobFn;
+        bool valid() const { return m_job != nullptr; }
+        bool isDone() const { return !m_job || m_job->done.load(std::memory_order_acquire); }
+
+    private:
+        friend class JobSystem;
+        std::shared_ptr<JobSystem::AsyncJob> m_job;
     };
 }
@@ -0,0 +1,39 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Engine
+{
+    // Read-only memory mapping of a whole file. The OS pages bytes in on first touch and can
+    // drop them again under memory pressure, so large cooked files are never copied into a
+    // heap buffer. Move-only; the mapping is released on destruction.
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+        MappedFile(MappedFile &&other) noexcept;
+        MappedFile &operator=(MappedFile &&other) noexcept;
+
+        // Returns false if the file cannot be opened or mapped (empty files cannot be mapped).
+        bool open(const std::string &path);
+        void close();
+
+        bool isOpen() const { return m_data != nullptr; }
+        const uint8_t *data() const { return m_data; }
+        size_t size() const { return m_size; }
+
+    private:
+        const uint8_t *m_data = nullptr;
+        size_t m_size = 0;
+
+#ifdef _WIN32
+        void *m_file = nullptr;    // HANDLE
+        void *m_mapping = nullptr; // HANDLE
+#endif
+    };
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Engine
+{
+    // ------------------------------------------------------------
+    // Byte counts per subsystem, filled on demand by whoever owns the memory.
+    //
+    // - Owners expose reportMemory(MemoryReport &) (AssetManager, SModelRenderPassModule, the
+    //   spatial/nav systems) and add one entry per thing worth telling apart.
+    // - CPU bytes are container capacity, not size: what the allocator actually holds.
+    // - GPU bytes are the GpuAllocation sizes of live resources (sub-allocated ranges, so the
+    //   allocator's reserved-but-unused block space is reported separately).
+    // - PerformanceMonitor collects reports from registered providers every system-metrics
+    //   interval; nothing here runs per frame.
+    // ------------------------------------------------------------
+    class MemoryReport
+    {
+    public:
+        struct Entry
+        {
+            std::string category; // "ECS", "Assets", "Render", "Navigation", ...
+            std::string name;     // column, asset kind, buffer group
+            uint64_t cpuBytes = 0;
+            uint64_t gpuBytes = 0;
+            uint32_t count = 0; // items behind the entry (rows, textures, buffers), 0 = n/a
+        };
+
+        void add(const std::string &category, const std::string &name, uint64_t cpuBytes, uint64_t gpuBytes, uint32_t count = 0)
+        {
+            for (Entry &e : m_entries)
+            {
+                if (e.category == category && e.name == name)
+                {
+                    e.cpuBytes += cpuBytes;
+                    e.gpuBytes += gpuBytes;
+                    e.count += count;
+                    return;
+                }
+            }
+            m_entries.push_back(Entry{category, name, cpuBytes, gpuBytes, count});
+        }
+
+        const std::vector<Entry> &entries() const { return m_entries; }
+        void clear() { m_entries.clear(); }
+
+        uint64_t totalCpuBytes() const
+        {
+            uint64_t sum = 0;
+            for (const Entry &e : m_entries)
+                sum += e.cpuBytes;
+            return sum;
+        }
+
+        uint64_t totalGpuBytes() const
+        {
+            uint64_t sum = 0;
+            for (const Entry &e : m_entries)
+                sum += e.gpuBytes;
+            return sum;
+        }
+
+        // Heap bytes held by a vector (capacity, excluding the vector object itself).
+        template <typename T>
+        static uint64_t bytesOf(const std::vector<T> &v)
+        {
+            return static_cast<uint64_t>(v.capacity()) * sizeof(T);
+        }
+
+    private:
+        std::vector<Entry> m_entries;
+    };
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace Engine
+{
+    // Effects known to ParticleRenderPassModule (its effect table is indexed by these).
+    enum class ParticleEffect : uint8_t
+    {
+        Hit = 0, // sparks where a blow lands
+        Death,   // burst when a unit falls
+        Dust,    // slow puff kicked up from the ground
+        Count
+    };
+    static constexpr uint32_t PARTICLE_EFFECT_COUNT = static_cast<uint32_t>(ParticleEffect::Count);
+
+    // One emission request: a burst of `count` particles of one effect. The GPU expands it, so a
+    // hit costs gameplay one ring push whatever the particle count.
+    struct ParticleSpawn
+    {
+        glm::vec3 position{0.0f};
+        float ground = -1e30f;     // particles settle at this height (world Y)
+        glm::vec3 direction{0.0f}; // emission bias (unit or zero = all around)
+        float scale = 1.0f;        // size and speed multiplier
+        ParticleEffect effect = ParticleEffect::Hit;
+        uint16_t count = 0;        // 0 = the effect's default
+    };
+
+    // ============================================================
+    // ParticleSpawnRing
+    // ============================================================
+    // Bounded lock-free queue of ParticleSpawn between gameplay and the particle pass.
+    //
+    // Any number of threads may push() at once (combat decisions run in parallelFor, the
+    // simulation may run on a worker while the frame is recorded); one consumer pops, the
+    // particle pass in recordPrePass(). Each cell carries a sequence number telling producers
+    // and the consumer whose turn it is (Vyukov's bounded queue), so a push is one CAS on the
+    // write cursor plus a release store, and never waits. A full ring drops the request
+    // (counted in dropped()): effects are cosmetic and the next frame drains it.
+    class ParticleSpawnRing
+    {
+    public:
+        // =====================
+        // TUNING CONSTANTS
+        // =====================
+        static constexpr uint32_t DEFAULT_CAPACITY = 8192; // rounded up to a power of two
+
+        explicit ParticleSpawnRing(uint32_t capacity = DEFAULT_CAPACITY)
+        {
+            uint32_t cap = 2;
+            while (cap < capacity)
+                cap <<= 1;
+            m_mask = cap - 1u;
+            m_cells.reset(new Cell[cap]);
+            for (uint32_t i = 0; i < cap; ++i)
+                m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        ParticleSpawnRing(const ParticleSpawnRing &) = delete;
+        ParticleSpawnRing &operator=(const ParticleSpawnRing &) = delete;
+
+        uint32_t capacity() const { return static_cast<uint32_t>(m_mask + 1u); }
+
+        // Thread-safe. False (and counted) when the ring is full.
+        bool push(const ParticleSpawn &spawn)
+        {
+            size_t pos = m_tail.load(std::memory_order_relaxed);
+            Cell *cell = nullptr;
+            for (;;)
+            {
+                cell = &m_cells[pos & m_mask];
+                const size_t seq = cell->sequence.load(std::memory_order_acquire);
+                const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+                if (diff == 0)
+                {
+                    if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if (diff < 0)
+                {
+                    m_dropped.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+                else
+                {
+                    pos = m_tail.load(std::memory_order_relaxed);
+                }
+            }
+            cell->spawn = spawn;
+            cell->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Single consumer. False when empty (or the oldest push is still being written).
+        bool pop(ParticleSpawn &out)
+        {
+            Cell &cell = m_cells[m_head & m_mask];
+            if (cell.sequence.load(std::memory_order_acquire) != m_head + 1)
+                return false;
+            out = cell.spawn;
+            cell.sequence.store(m_head + m_mask + 1, std::memory_order_release);
+            ++m_head;
+            return true;
+        }
+
+        // Pushes lost to a full ring so far.
+        uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+        uint64_t memoryBytes() const { return uint64_t(capacity()) * sizeof(Cell); }
+
+    private:
+        struct Cell
+        {
+            std::atomic<size_t> sequence{0};
+            ParticleSpawn spawn{};
+        };
+
+        std::unique_ptr<Cell[]> m_cells;
+        size_t m_mask = 0;
+        alignas(64) std::atomic<size_t> m_tail{0}; // producers
+        alignas(64) size_t m_head = 0;             // consumer only
+        std::atomic<uint64_t> m_dropped{0};
+    };
+}
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// ------------------------------------------------------------
+// Scoped profiler zones that stay on in release builds.
+//
+// - ENGINE_PROFILE_ZONE("Name") times the enclosing scope. Names are static strings (literals,
+//   SystemBase::name(), RenderPassModule::getDebugName()); only the pointer is stored.
+// - Each thread writes finished zones into its own ring (ZONES_PER_THREAD entries, oldest
+//   overwritten), so recording takes no lock and allocates nothing: two clock reads and four
+//   relaxed stores per zone. Rings are registered once per thread (lock-free slot claim).
+// - writeChromeTrace() copies every ring and writes Chrome trace JSON (chrome://tracing,
+//   Perfetto); Application binds it to F12. Zones still open are not exported.
+// - Built with ENGINE_TRACY=1 (CMake option ENGINE_TRACY), zones and frame marks are also
+//   streamed to a connected Tracy client.
+// - ENGINE_PROFILER=0 compiles every macro out; setEnabled(false) skips recording at runtime.
+// ------------------------------------------------------------
+#ifndef ENGINE_PROFILER
+#define ENGINE_PROFILER 1
+#endif
+
+#ifndef ENGINE_TRACY
+#define ENGINE_TRACY 0
+#endif
+
+namespace Engine::Profiler
+{
+    static constexpr uint32_t ZONES_PER_THREAD = 8192; // ~several frames of history per thread
+    static constexpr uint32_t MAX_THREADS = 64;        // threads past this record nothing
+
+    // Finished zone as stored in a ring. Fields are atomics so an export racing a writer reads
+    // torn entries at worst (dropped by the head re-check), never undefined behavior.
+    struct ZoneRecord
+    {
+        std::atomic<const char *> name{nullptr};
+        std::atomic<uint64_t> startNs{0};
+        std::atomic<uint64_t> endNs{0};
+        std::atomic<uint32_t> depth{0};
+    };
+
+    struct ThreadRing
+    {
+        ZoneRecord zones[ZONES_PER_THREAD];
+        std::atomic<uint64_t> head{0}; // zones ever written; slot = head % ZONES_PER_THREAD
+        std::atomic<const char *> threadName{nullptr};
+        uint32_t threadIndex = 0; // registration order, used as tid in exports
+    };
+
+    namespace detail
+    {
+        inline std::atomic<bool> g_enabled{true};
+
+        // Claim a ring for the calling thread (nullptr once MAX_THREADS are taken).
+        ThreadRing *registerThread();
+
+        struct ThreadState
+        {
+            ThreadRing *ring = nullptr;
+            bool registered = false;
+            uint32_t depth = 0;
+            const char *current = nullptr; // innermost open zone
+        };
+        inline thread_local ThreadState t_state;
+
+        inline ThreadState &registeredState()
+        {
+            ThreadState &ts = t_state;
+            if (!ts.registered)
+            {
+                ts.ring = registerThread();
+                ts.registered = true;
+            }
+            return ts;
+        }
+
+        // Single writer per ring: fill the slot, then publish it by advancing head.
+        inline void record(ThreadRing &ring, const char *name, uint64_t startNs, uint64_t endNs, uint32_t depth)
+        {
+            const uint64_t h = ring.head.load(std::memory_order_relaxed);
+            ZoneRecord &z = ring.zones[h % ZONES_PER_THREAD];
+            z.name.store(name, std::memory_order_relaxed);
+            z.startNs.store(startNs, std::memory_order_relaxed);
+            z.endNs.store(endNs, std::memory_order_relaxed);
+            z.depth.store(depth, std::memory_order_relaxed);
+            ring.head.store(h + 1u, std::memory_order_release);
+        }
+
+        uint64_t tracyBegin(const char *name, const char *file, uint32_t line);
+        void tracyEnd(uint64_t ctx);
+    } // namespace detail
+
+    // Steady clock in nanoseconds (same epoch for every thread).
+    inline uint64_t nowNs()
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                         std::chrono::steady_clock::now().time_since_epoch())
+                                         .count());
+    }
+
+    inline bool enabled() { return detail::g_enabled.load(std::memory_order_relaxed); }
+    inline void setEnabled(bool on) { detail::g_enabled.store(on, std::memory_order_relaxed); }
+
+    // Label for the calling thread in exports and Tracy ("Main", "Worker 2").
+    void setThreadName(const char *name);
+
+    // Innermost open zone on the calling thread (nullptr outside zones). JobSystem tags loop
+    // ranges with it, so worker zones read as the system that started the loop.
+    inline const char *currentZoneName() { return detail::t_state.current; }
+
+    // Frame boundary for Tracy and an instant "Frame" marker in Chrome traces.
+    void markFrame();
+
+    // Write every recorded zone as Chrome trace JSON. Returns false if the file can't be written.
+    bool writeChromeTrace(const std::string &path);
+
+    // Drop recorded zones (rings stay registered).
+    void clear();
+
+    class ScopedZone
+    {
+    public:
+        explicit ScopedZone(const char *name, const char *file = nullptr, uint32_t line = 0)
+        {
+            if (!enabled())
+                return;
+            detail::ThreadState &ts = detail::registeredState();
+            m_state = &ts;
+            m_name = name;
+            m_parent = ts.current;
+            m_depth = ts.depth++;
+            ts.current = name;
+#if ENGINE_TRACY
+            m_tracy = detail::tracyBegin(name, file, line);
+#else
+            (void)file;
+            (void)line;
+#endif
+            m_startNs = nowNs();
+        }
+
+        ~ScopedZone()
+        {
+            if (!m_state)
+                return;
+            const uint64_t endNs = nowNs();
+#if ENGINE_TRACY
+            detail::tracyEnd(m_tracy);
+#endif
+            m_state->depth = m_depth;
+            m_state->current = m_parent;
+
+            if (m_state->ring)
+                detail::record(*m_state->ring, m_name, m_startNs, endNs, m_depth);
+        }
+
+        ScopedZone(const ScopedZone &) = delete;
+        ScopedZone &operator=(const ScopedZone &) = delete;
+
+    private:
+        detail::ThreadState *m_state = nullptr;
+        const char *m_name = nullptr;
+        const char *m_parent = nullptr;
+        uint64_t m_startNs = 0;
+        uint32_t m_depth = 0;
+#if ENGINE_TRACY
+        uint64_t m_tracy = 0;
+#endif
+    };
+} // namespace Engine::Profiler
+
+#define ENGINE_PROFILE_CONCAT_INNER(a, b) a##b
+#define ENGINE_PROFILE_CONCAT(a, b) ENGINE_PROFILE_CONCAT_INNER(a, b)
+
+#if ENGINE_PROFILER
+#define ENGINE_PROFILE_ZONE(name) \
+    ::Engine::Profiler::ScopedZone ENGINE_PROFILE_CONCAT(engineProfileZone_, __LINE__)((name), __FILE__, __LINE__)
+#define ENGINE_PROFILE_FRAME() ::Engine::Profiler::markFrame()
+#else
+#define ENGINE_PROFILE_ZONE(name) ((void)0)
+#define ENGINE_PROFILE_FRAME() ((void)0)
+#endif
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "utils/JobSystem.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// ------------------------------------------------------------
+// Stable LSD radix sort by a 64-bit key (8 bits per pass).
+//
+// - Digits that are identical across all keys are skipped, so keys that only use their low
+//   bits (small grids, small ids) cost as many passes as they have distinct bytes.
+// - Parallel mode splits the array into one fixed chunk per thread; each pass counts per
+//   chunk, prefixes digit-major/chunk-minor and scatters per chunk. The chunking does not
+//   depend on scheduling, so the result is identical to the sequential sort.
+// - Stable: items with equal keys keep their input order.
+// ------------------------------------------------------------
+namespace Engine
+{
+    // Caller-owned scratch so repeated sorts don't allocate.
+    struct RadixSortScratch
+    {
+        std::vector<uint32_t> counts; // chunk * 256 + digit
+        std::vector<uint64_t> vary;   // per chunk: bits that differ from the first key
+    };
+
+    // Sorts items by keyOf(item) (returns uint64_t). tmp is resized to items.size() and
+    // holds garbage afterwards. js may be null (sequential).
+    template <typename T, typename KeyFn>
+    inline void RadixSort64(std::vector<T> &items, std::vector<T> &tmp, const KeyFn &keyOf,
+                            RadixSortScratch &scratch, JobSystem *js = nullptr,
+                            uint32_t parallelThreshold = 16384)
+    {
+        static constexpr uint32_t MIN_CHUNK_ITEMS = 4096;
+
+        const uint32_t n = static_cast<uint32_t>(items.size());
+        if (n < 2u)
+            return;
+        tmp.resize(n);
+
+        const bool parallel = (js != nullptr) && (js->workerCount() > 0) && (n >= parallelThreshold);
+        const uint32_t chunks = parallel ? std::max(1u, std::min(js->workerCount() + 1u, n / MIN_CHUNK_ITEMS)) : 1u;
+        auto chunkBegin = [&](uint32_t c)
+        { return static_cast<uint32_t>(static_cast<uint64_t>(n) * c / chunks); };
+        auto forChunks = [&](const auto &fn)
+        {
+            if (chunks == 1u)
+            {
+                fn(0u);
+                return;
+            }
+            js->parallelForRange(0u, chunks, 1u, [&](uint32_t /*workerIndex*/, uint32_t first, uint32_t last)
+                                 {
+                                     for (uint32_t c = first; c < last; ++c)
+                                         fn(c); });
+        };
+
+        // Bits that differ between keys; passes over constant digits are skipped.
+        const uint64_t key0 = keyOf(items[0]);
+        scratch.vary.assign(chunks, 0ull);
+        forChunks([&](uint32_t c)
+                  {
+                      uint64_t v = 0;
+                      const uint32_t end = chunkBegin(c + 1u);
+                      for (uint32_t i = chunkBegin(c); i < end; ++i)
+                          v |= keyOf(items[i]) ^ key0;
+                      scratch.vary[c] = v; });
+        uint64_t vary = 0;
+        for (uint64_t v : scratch.vary)
+            vary |= v;
+        if (vary == 0)
+            return;
+
+        scratch.counts.resize(static_cast<size_t>(chunks) * 256u);
+        T *src = items.data();
+        T *dst = tmp.data();
+
+        for (uint32_t shift = 0; shift < 64u; shift += 8u)
+        {
+            if (((vary >> shift) & 0xFFull) == 0)
+                continue;
+
+            forChunks([&](uint32_t c)
+                      {
+                          uint32_t *h = scratch.counts.data() + static_cast<size_t>(c) * 256u;
+                          std::fill(h, h + 256, 0u);
+                          const uint32_t end = chunkBegin(c + 1u);
+                          for (uint32_t i = chunkBegin(c); i < end; ++i)
+                              ++h[(keyOf(src[i]) >> shift) & 0xFFu]; });
+
+            // Exclusive prefix: digit-major, chunk-minor keeps the sort stable.
+            uint32_t sum = 0;
+            for (uint32_t d = 0; d < 256u; ++d)
+            {
+                for (uint32_t c = 0; c < chunks; ++c)
+                {
+                    uint32_t &x = scratch.counts[static_cast<size_t>(c) * 256u + d];
+                    const uint32_t count = x;
+                    x = sum;
+                    sum += count;
+                }
+            }
+
+            forChunks([&](uint32_t c)
+                      {
+                          uint32_t *h = scratch.counts.data() + static_cast<size_t>(c) * 256u;
+                          const uint32_t end = chunkBegin(c + 1u);
+                          for (uint32_t i = chunkBegin(c); i < end; ++i)
+                              dst[h[(keyOf(src[i]) >> shift) & 0xFFu]++] = src[i]; });
+
+            std::swap(src, dst);
+        }
+
+        if (src != items.data())
+            items.swap(tmp);
+    }
+
+} // namespace Engine
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "utils/SimdMat4.h"
+
+#include <cstdint>
+
+// ------------------------------------------------------------
+// Batched sphere-vs-planes test for frustum culling (Frustum::testSpheres8).
+//
+// - Spheres arrive in SoA lanes (cx[], cy[], cz[], r[]); every plane is splatted once and
+//   tested against four spheres per register, so the six planes cost six madd chains per four
+//   spheres instead of up to six dependent dot products per sphere.
+// - The result is a bitmask: bit i set when sphere i is on the positive side of (or touches)
+//   every plane. A NaN distance rejects nothing, same as FrustumPlane::testSphere() < 0.
+// - Same backends as utils/SimdMat4.h (SSE2 / NEON / scalar, ENGINE_SIMD_MATH=0 for scalar).
+//   Two 4-wide registers per group of eight keep AVX optional: x86-64 only guarantees SSE2.
+// ------------------------------------------------------------
+namespace Engine::simd
+{
+    namespace detail
+    {
+#if defined(ENGINE_SIMD_SSE)
+        // Bits of the lanes where a < 0.
+        inline uint32_t NegativeMask(F4 a) { return static_cast<uint32_t>(_mm_movemask_ps(_mm_cmplt_ps(a, _mm_setzero_ps()))); }
+#elif defined(ENGINE_SIMD_NEON)
+        inline uint32_t NegativeMask(F4 a)
+        {
+            static const uint32_t bits[4] = {1u, 2u, 4u, 8u};
+            return vaddvq_u32(vandq_u32(vcltq_f32(a, vdupq_n_f32(0.0f)), vld1q_u32(bits)));
+        }
+#else
+        inline uint32_t NegativeMask(F4 a)
+        {
+            uint32_t m = 0u;
+            for (int i = 0; i < 4; ++i)
+                m |= (a.v[i] < 0.0f) ? (1u << i) : 0u;
+            return m;
+        }
+#endif
+    } // namespace detail
+
+    // planes: six (nx, ny, nz, d) rows. Returns the 4-bit mask of the spheres inside all of them.
+    inline uint32_t SpheresInsidePlanes4(const float planes[6][4], const float cx[4], const float cy[4],
+                                         const float cz[4], const float r[4])
+    {
+        using namespace detail;
+        const F4 X = Load(cx), Y = Load(cy), Z = Load(cz), R = Load(r);
+        uint32_t outside = 0u;
+        for (int i = 0; i < 6; ++i)
+        {
+            // Same order as testPoint(c) + r: dot(n, c), then d, then r.
+            const F4 dot = Add(Add(Mul(Splat(planes[i][0]), X), Mul(Splat(planes[i][1]), Y)), Mul(Splat(planes[i][2]), Z));
+            const F4 d = Add(Add(dot, Splat(planes[i][3])), R);
+            outside |= NegativeMask(d);
+        }
+        return ~outside & 0xFu;
+    }
+
+} // namespace Engine::simd
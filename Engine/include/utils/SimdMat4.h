@@ -0,0 +1,193 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// ------------------------------------------------------------
+// 4x4 matrix kernels for pose evaluation (column-major, same layout as glm::mat4).
+//
+// - MulMat4: a * b, one column per register (4 broadcasts + 4 madds per column).
+// - ComposeTRSBatch: T * R * S for many nodes at once. Four nodes are gathered into SoA
+//   lanes (one register per component), the rotation/scale terms are computed for all four
+//   in parallel and transposed back into each node's columns.
+//
+// The backend is chosen at compile time: SSE2 on x86-64 (baseline, always available) and
+// NEON on AArch64 (baseline as well), scalar everywhere else. Define ENGINE_SIMD_MATH=0 to
+// force the scalar path when comparing results.
+// ------------------------------------------------------------
+#ifndef ENGINE_SIMD_MATH
+#define ENGINE_SIMD_MATH 1
+#endif
+
+#if ENGINE_SIMD_MATH && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define ENGINE_SIMD_SSE 1
+#include <emmintrin.h>
+#elif ENGINE_SIMD_MATH && (defined(__aarch64__) || defined(_M_ARM64))
+#define ENGINE_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace Engine::simd
+{
+    namespace detail
+    {
+#if defined(ENGINE_SIMD_SSE)
+        using F4 = __m128;
+        inline F4 Load(const float *p) { return _mm_loadu_ps(p); }
+        inline void Store(float *p, F4 v) { _mm_storeu_ps(p, v); }
+        inline F4 Set(float x, float y, float z, float w) { return _mm_set_ps(w, z, y, x); }
+        inline F4 Splat(float v) { return _mm_set1_ps(v); }
+        inline F4 Add(F4 a, F4 b) { return _mm_add_ps(a, b); }
+        inline F4 Sub(F4 a, F4 b) { return _mm_sub_ps(a, b); }
+        inline F4 Mul(F4 a, F4 b) { return _mm_mul_ps(a, b); }
+        inline void Transpose(F4 &r0, F4 &r1, F4 &r2, F4 &r3) { _MM_TRANSPOSE4_PS(r0, r1, r2, r3); }
+#elif defined(ENGINE_SIMD_NEON)
+        using F4 = float32x4_t;
+        inline F4 Load(const float *p) { return vld1q_f32(p); }
+        inline void Store(float *p, F4 v) { vst1q_f32(p, v); }
+        inline F4 Set(float x, float y, float z, float w)
+        {
+            const float v[4] = {x, y, z, w};
+            return vld1q_f32(v);
+        }
+        inline F4 Splat(float v) { return vdupq_n_f32(v); }
+        inline F4 Add(F4 a, F4 b) { return vaddq_f32(a, b); }
+        inline F4 Sub(F4 a, F4 b) { return vsubq_f32(a, b); }
+        inline F4 Mul(F4 a, F4 b) { return vmulq_f32(a, b); }
+        inline void Transpose(F4 &r0, F4 &r1, F4 &r2, F4 &r3)
+        {
+            const F4 t0 = vzip1q_f32(r0, r2);
+            const F4 t1 = vzip2q_f32(r0, r2);
+            const F4 t2 = vzip1q_f32(r1, r3);
+            const F4 t3 = vzip2q_f32(r1, r3);
+            r0 = vzip1q_f32(t0, t2);
+            r1 = vzip2q_f32(t0, t2);
+            r2 = vzip1q_f32(t1, t3);
+            r3 = vzip2q_f32(t1, t3);
+        }
+#else
+        struct F4
+        {
+            float v[4];
+        };
+        inline F4 Load(const float *p) { return F4{{p[0], p[1], p[2], p[3]}}; }
+        inline void Store(float *p, F4 a)
+        {
+            for (int i = 0; i < 4; ++i)
+                p[i] = a.v[i];
+        }
+        inline F4 Set(float x, float y, float z, float w) { return F4{{x, y, z, w}}; }
+        inline F4 Splat(float v) { return F4{{v, v, v, v}}; }
+        inline F4 Add(F4 a, F4 b) { return F4{{a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]}}; }
+        inline F4 Sub(F4 a, F4 b) { return F4{{a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]}}; }
+        inline F4 Mul(F4 a, F4 b) { return F4{{a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]}}; }
+        inline void Transpose(F4 &r0, F4 &r1, F4 &r2, F4 &r3)
+        {
+            const F4 a = r0, b = r1, c = r2, d = r3;
+            r0 = F4{{a.v[0], b.v[0], c.v[0], d.v[0]}};
+            r1 = F4{{a.v[1], b.v[1], c.v[1], d.v[1]}};
+            r2 = F4{{a.v[2], b.v[2], c.v[2], d.v[2]}};
+            r3 = F4{{a.v[3], b.v[3], c.v[3], d.v[3]}};
+        }
+#endif
+
+        // Column j as a float pointer (the whole vec4, not its first member).
+        inline float *Col(glm::mat4 &m, int j) { return reinterpret_cast<float *>(&m[j]); }
+        inline const float *Col(const glm::mat4 &m, int j) { return reinterpret_cast<const float *>(&m[j]); }
+    } // namespace detail
+
+    // out = a * b. out may alias a or b.
+    inline void MulMat4(const glm::mat4 &a, const glm::mat4 &b, glm::mat4 &out)
+    {
+        using namespace detail;
+        const F4 a0 = Load(Col(a, 0));
+        const F4 a1 = Load(Col(a, 1));
+        const F4 a2 = Load(Col(a, 2));
+        const F4 a3 = Load(Col(a, 3));
+
+        F4 cols[4];
+        for (int j = 0; j < 4; ++j)
+        {
+            const float *bj = Col(b, j);
+            F4 c = Mul(a0, Splat(bj[0]));
+            c = Add(c, Mul(a1, Splat(bj[1])));
+            c = Add(c, Mul(a2, Splat(bj[2])));
+            c = Add(c, Mul(a3, Splat(bj[3])));
+            cols[j] = c;
+        }
+        for (int j = 0; j < 4; ++j)
+            Store(Col(out, j), cols[j]);
+    }
+
+    // out[i] = translate(t) * mat4_cast(normalize(r)) * scale(s) for every element of trs,
+    // which needs .t (vec3), .r (quat) and .s (vec3) members (ModelAsset::NodeTRS).
+    template <typename TRS>
+    inline void ComposeTRSBatch(const TRS *trs, uint32_t count, glm::mat4 *out)
+    {
+        using namespace detail;
+        for (uint32_t base = 0; base < count; base += 4u)
+        {
+            const uint32_t lanes = (count - base < 4u) ? (count - base) : 4u;
+
+            // Gather (normalizing like glm::normalize: zero-length -> identity rotation).
+            float qx[4] = {0.0f, 0.0f, 0.0f, 0.0f}, qy[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+            float qz[4] = {0.0f, 0.0f, 0.0f, 0.0f}, qw[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+            float sx[4] = {1.0f, 1.0f, 1.0f, 1.0f}, sy[4] = {1.0f, 1.0f, 1.0f, 1.0f}, sz[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+            for (uint32_t k = 0; k < lanes; ++k)
+            {
+                const TRS &x = trs[base + k];
+                const float len = std::sqrt(x.r.x * x.r.x + x.r.y * x.r.y + x.r.z * x.r.z + x.r.w * x.r.w);
+                if (len > 0.0f)
+                {
+                    const float inv = 1.0f / len;
+                    qx[k] = x.r.x * inv;
+                    qy[k] = x.r.y * inv;
+                    qz[k] = x.r.z * inv;
+                    qw[k] = x.r.w * inv;
+                }
+                sx[k] = x.s.x;
+                sy[k] = x.s.y;
+                sz[k] = x.s.z;
+            }
+
+            const F4 X = Load(qx), Y = Load(qy), Z = Load(qz), W = Load(qw);
+            const F4 two = Splat(2.0f), one = Splat(1.0f);
+            const F4 xx = Mul(X, X), yy = Mul(Y, Y), zz = Mul(Z, Z);
+            const F4 xy = Mul(X, Y), xz = Mul(X, Z), yz = Mul(Y, Z);
+            const F4 wx = Mul(W, X), wy = Mul(W, Y), wz = Mul(W, Z);
+            const F4 SX = Load(sx), SY = Load(sy), SZ = Load(sz);
+
+            // Row r of column c, for four nodes per register.
+            F4 c0[4] = {Mul(Sub(one, Mul(two, Add(yy, zz))), SX),
+                        Mul(Mul(two, Add(xy, wz)), SX),
+                        Mul(Mul(two, Sub(xz, wy)), SX),
+                        Splat(0.0f)};
+            F4 c1[4] = {Mul(Mul(two, Sub(xy, wz)), SY),
+                        Mul(Sub(one, Mul(two, Add(xx, zz))), SY),
+                        Mul(Mul(two, Add(yz, wx)), SY),
+                        Splat(0.0f)};
+            F4 c2[4] = {Mul(Mul(two, Add(xz, wy)), SZ),
+                        Mul(Mul(two, Sub(yz, wx)), SZ),
+                        Mul(Sub(one, Mul(two, Add(xx, yy))), SZ),
+                        Splat(0.0f)};
+
+            // After the transpose, element k is node k's column.
+            Transpose(c0[0], c0[1], c0[2], c0[3]);
+            Transpose(c1[0], c1[1], c1[2], c1[3]);
+            Transpose(c2[0], c2[1], c2[2], c2[3]);
+
+            for (uint32_t k = 0; k < lanes; ++k)
+            {
+                glm::mat4 &m = out[base + k];
+                const TRS &x = trs[base + k];
+                Store(Col(m, 0), c0[k]);
+                Store(Col(m, 1), c1[k]);
+                Store(Col(m, 2), c2[k]);
+                Store(Col(m, 3), Set(x.t.x, x.t.y, x.t.z, 1.0f));
+            }
+        }
+    }
+
+} // namespace Engine::simd
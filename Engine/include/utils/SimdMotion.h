@@ -0,0 +1,109 @@
+#pragma once
+
+#include "utils/SimdMat4.h"
+
+#include <cstdint>
+
+// ------------------------------------------------------------
+// Four-lane motion kernels for MovementSystem and SteeringSystem.
+//
+// - Callers gather four rows into SoA lanes (one float[4] per component), run a kernel and
+//   scatter the lanes back; the branchy per-row work (finite checks, navgrid, dirty marks,
+//   path bookkeeping) stays scalar around it.
+// - Clamps are branch-free: a length limit becomes a scale min(limit / length, 1), which is
+//   exactly 1 below the limit (x / 0 = inf also yields 1).
+// - Same backends as utils/SimdMat4.h (SSE2 / NEON / scalar, ENGINE_SIMD_MATH=0 for scalar).
+// ------------------------------------------------------------
+namespace Engine::simd
+{
+    namespace detail
+    {
+#if defined(ENGINE_SIMD_SSE)
+        inline F4 Div(F4 a, F4 b) { return _mm_div_ps(a, b); }
+        inline F4 Sqrt(F4 a) { return _mm_sqrt_ps(a); }
+        inline F4 Min(F4 a, F4 b) { return _mm_min_ps(a, b); } // b if either is NaN
+#elif defined(ENGINE_SIMD_NEON)
+        inline F4 Div(F4 a, F4 b) { return vdivq_f32(a, b); }
+        inline F4 Sqrt(F4 a) { return vsqrtq_f32(a); }
+        inline F4 Min(F4 a, F4 b)
+        {
+            // Match SSE: b if either is NaN.
+            return vbslq_f32(vcltq_f32(a, b), a, b);
+        }
+#else
+        inline F4 Div(F4 a, F4 b) { return F4{{a.v[0] / b.v[0], a.v[1] / b.v[1], a.v[2] / b.v[2], a.v[3] / b.v[3]}}; }
+        inline F4 Sqrt(F4 a) { return F4{{std::sqrt(a.v[0]), std::sqrt(a.v[1]), std::sqrt(a.v[2]), std::sqrt(a.v[3])}}; }
+        inline F4 Min(F4 a, F4 b)
+        {
+            F4 r;
+            for (int i = 0; i < 4; ++i)
+                r.v[i] = (a.v[i] < b.v[i]) ? a.v[i] : b.v[i];
+            return r;
+        }
+#endif
+
+        // min(limit / sqrt(len2), 1): 1 unless the length exceeds limit (NaN -> 1 as well).
+        inline F4 LimitScale(F4 len2, F4 limit) { return Min(Div(limit, Sqrt(len2)), Splat(1.0f)); }
+    } // namespace detail
+
+    // Four movers, in place: clamp |v| to maxSpeed, step d = v * dt, clamp |d| to maxStep and
+    // scale v by the same factor so velocity stays consistent with the step taken.
+    inline void IntegrateVelocity4(float vx[4], float vy[4], float vz[4],
+                                   float dx[4], float dy[4], float dz[4],
+                                   float dt, float maxSpeed, float maxStep)
+    {
+        using namespace detail;
+        F4 X = Load(vx), Y = Load(vy), Z = Load(vz);
+
+        const F4 v2 = Add(Add(Mul(X, X), Mul(Y, Y)), Mul(Z, Z));
+        const F4 speedScale = LimitScale(v2, Splat(maxSpeed));
+        X = Mul(X, speedScale);
+        Y = Mul(Y, speedScale);
+        Z = Mul(Z, speedScale);
+
+        const F4 DT = Splat(dt);
+        F4 DX = Mul(X, DT), DY = Mul(Y, DT), DZ = Mul(Z, DT);
+        const F4 step2 = Add(Add(Mul(DX, DX), Mul(DY, DY)), Mul(DZ, DZ));
+        const F4 stepScale = LimitScale(step2, Splat(maxStep));
+        DX = Mul(DX, stepScale);
+        DY = Mul(DY, stepScale);
+        DZ = Mul(DZ, stepScale);
+
+        Store(vx, Mul(X, stepScale));
+        Store(vy, Mul(Y, stepScale));
+        Store(vz, Mul(Z, stepScale));
+        Store(dx, DX);
+        Store(dy, DY);
+        Store(dz, DZ);
+    }
+
+    // Four steering lanes on the ground plane. (toX, toZ) is the offset to each lane's target
+    // (non-zero length), speed its MoveSpeed. arriveBias is 0 for lanes heading to their final
+    // target (speed ramps down inside slowRadius) and 1 for waypoints (full speed).
+    // Outputs the unit direction to the target and velocity accelerated toward dir * speed.
+    inline void SteerVelocity4(const float toX[4], const float toZ[4], const float speed[4], const float arriveBias[4],
+                               float vx[4], float vz[4], float dirX[4], float dirZ[4],
+                               float dt, float acceleration, float slowRadius)
+    {
+        using namespace detail;
+        const F4 TX = Load(toX), TZ = Load(toZ);
+        const F4 dist = Sqrt(Add(Mul(TX, TX), Mul(TZ, TZ)));
+        const F4 invDist = Div(Splat(1.0f), dist);
+        const F4 DX = Mul(TX, invDist), DZ = Mul(TZ, invDist);
+
+        // dist / slowRadius is >= 0, so only the upper end needs clamping.
+        const F4 ramp = Min(Add(Div(dist, Splat(slowRadius)), Load(arriveBias)), Splat(1.0f));
+        const F4 s = Mul(Load(speed), ramp);
+
+        const F4 gain = Splat(acceleration * dt);
+        F4 VX = Load(vx), VZ = Load(vz);
+        VX = Add(VX, Mul(Sub(Mul(DX, s), VX), gain));
+        VZ = Add(VZ, Mul(Sub(Mul(DZ, s), VZ), gain));
+
+        Store(vx, VX);
+        Store(vz, VZ);
+        Store(dirX, DX);
+        Store(dirZ, DZ);
+    }
+
+} // namespace Engine::simd
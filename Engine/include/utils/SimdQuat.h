@@ -0,0 +1,79 @@
+#pragma once
+
+#include "utils/SimdMat4.h"
+
+#include <cmath>
+#include <cstdint>
+
+// ------------------------------------------------------------
+// Four-lane quaternion kernels for animation sampling (ModelAsset::RotationSampling::Nlerp).
+//
+// - Callers gather four channels' key pairs into SoA lanes (one float[4] per component) and
+//   scatter the results; key search and cursors stay scalar around it.
+// - Nlerp takes the shortest arc (q1 negated where dot(q0, q1) < 0) and renormalizes. With unit
+//   keys on the same hemisphere the lerp never gets shorter than cos(45 deg), so the divide
+//   needs no zero guard; a zero-length key yields NaN lanes.
+// - Same backends as utils/SimdMat4.h (SSE2 / NEON / scalar, ENGINE_SIMD_MATH=0 for scalar).
+// ------------------------------------------------------------
+namespace Engine::simd
+{
+    namespace detail
+    {
+#if defined(ENGINE_SIMD_SSE)
+        // v with its sign flipped in lanes where s is negative (-0 included).
+        inline F4 FlipSignBy(F4 v, F4 s) { return _mm_xor_ps(v, _mm_and_ps(s, _mm_set1_ps(-0.0f))); }
+        inline F4 InvSqrt(F4 a) { return _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(a)); }
+#elif defined(ENGINE_SIMD_NEON)
+        inline F4 FlipSignBy(F4 v, F4 s)
+        {
+            const uint32x4_t sign = vandq_u32(vreinterpretq_u32_f32(s), vdupq_n_u32(0x80000000u));
+            return vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(v), sign));
+        }
+        inline F4 InvSqrt(F4 a) { return vdivq_f32(vdupq_n_f32(1.0f), vsqrtq_f32(a)); }
+#else
+        inline F4 FlipSignBy(F4 v, F4 s)
+        {
+            F4 r;
+            for (int i = 0; i < 4; ++i)
+                r.v[i] = std::signbit(s.v[i]) ? -v.v[i] : v.v[i];
+            return r;
+        }
+        inline F4 InvSqrt(F4 a)
+        {
+            F4 r;
+            for (int i = 0; i < 4; ++i)
+                r.v[i] = 1.0f / std::sqrt(a.v[i]);
+            return r;
+        }
+#endif
+    } // namespace detail
+
+    // Four rotations: normalize(mix(q0, ±q1, a)), in place into the q0 lanes. Lanes not in use
+    // should hold a valid pair (e.g. identity, a = 0).
+    inline void NlerpQuat4(float x0[4], float y0[4], float z0[4], float w0[4],
+                           const float x1[4], const float y1[4], const float z1[4], const float w1[4],
+                           const float alpha[4])
+    {
+        using namespace detail;
+        const F4 X0 = Load(x0), Y0 = Load(y0), Z0 = Load(z0), W0 = Load(w0);
+        F4 X1 = Load(x1), Y1 = Load(y1), Z1 = Load(z1), W1 = Load(w1);
+
+        const F4 d = Add(Add(Mul(X0, X1), Mul(Y0, Y1)), Add(Mul(Z0, Z1), Mul(W0, W1)));
+        X1 = FlipSignBy(X1, d);
+        Y1 = FlipSignBy(Y1, d);
+        Z1 = FlipSignBy(Z1, d);
+        W1 = FlipSignBy(W1, d);
+
+        const F4 A = Load(alpha);
+        const F4 X = Add(X0, Mul(Sub(X1, X0), A));
+        const F4 Y = Add(Y0, Mul(Sub(Y1, Y0), A));
+        const F4 Z = Add(Z0, Mul(Sub(Z1, Z0), A));
+        const F4 W = Add(W0, Mul(Sub(W1, W0), A));
+
+        const F4 inv = InvSqrt(Add(Add(Mul(X, X), Mul(Y, Y)), Add(Mul(Z, Z), Mul(W, W))));
+        Store(x0, Mul(X, inv));
+        Store(y0, Mul(Y, inv));
+        Store(z0, Mul(Z, inv));
+        Store(w0, Mul(W, inv));
+    }
+} // namespace Engine::simd
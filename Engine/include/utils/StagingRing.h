@@ -0,0 +1,101 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include "utils/GpuAllocator.h"
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace Engine
+{
+    // ============================================================
+    // StagingRing
+    // ============================================================
+    // One persistent, persistently mapped host-visible buffer that upload commands copy from.
+    // Space is handed out front to back and wraps around; everything allocated between two
+    // beginSubmit() calls forms a region that is recycled once the fence returned by
+    // beginSubmit() has signaled. This replaces a vkAllocateMemory + map per staging copy.
+    //
+    // Typical usage (see UploadContext):
+    //   StagingRing::Allocation a;
+    //   if (ring.allocate(bytes, 16, a)) { memcpy(a.mapped, src, bytes); vkCmdCopyBuffer(cmd, a.buffer, dst, ...); }
+    //   VkFence f = ring.beginSubmit();
+    //   vkQueueSubmit(queue, 1, &submit, f);   // or ring.cancelSubmit() if the submit failed
+    class StagingRing
+    {
+    public:
+        struct Allocation
+        {
+            VkBuffer buffer = VK_NULL_HANDLE;
+            VkDeviceSize offset = 0;
+            uint8_t *mapped = nullptr; // already offset; host-coherent memory
+        };
+
+        StagingRing() = default;
+        ~StagingRing() = default; // call destroy() while the device is alive
+
+        StagingRing(const StagingRing &) = delete;
+        StagingRing &operator=(const StagingRing &) = delete;
+
+        // With two or more queue families (e.g. graphics + transfer) the buffer is shared
+        // concurrently between them.
+        VkResult create(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize capacity,
+                        uint32_t queueFamilyCount = 0, const uint32_t *queueFamilies = nullptr);
+
+        // Waits for all in-flight regions, then frees the buffer and fences.
+        void destroy();
+
+        bool valid() const { return m_buffer != VK_NULL_HANDLE; }
+        VkDeviceSize capacity() const { return m_capacity; }
+
+        // Reserve size bytes aligned to alignment (power of two). Recycles finished regions and,
+        // if the ring is full, waits for the oldest in-flight one. Returns false when the request
+        // can never fit (larger than the ring, or the ring is filled by the not yet submitted
+        // region); callers then fall back to a dedicated staging buffer.
+        bool allocate(VkDeviceSize size, VkDeviceSize alignment, Allocation &out);
+
+        // Close the current region. The returned fence (unsignaled) must be passed to the
+        // vkQueueSubmit that consumes the region's copies. Returns VK_NULL_HANDLE when nothing
+        // was allocated since the last call.
+        VkFence beginSubmit();
+
+        // The submit for the region returned by the last beginSubmit() did not happen; release it.
+        void cancelSubmit();
+
+        // Recycle regions whose fences have signaled (non-blocking).
+        void retire();
+
+    private:
+        struct Region
+        {
+            VkDeviceSize begin = 0;
+            VkDeviceSize end = 0;
+            VkFence fence = VK_NULL_HANDLE;
+        };
+
+        bool tryPlace(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize &outOffset) const;
+        void popOldest();
+        VkFence acquireFence();
+
+    private:
+        VkDevice m_device = VK_NULL_HANDLE;
+        VkBuffer m_buffer = VK_NULL_HANDLE;
+        GpuAllocation m_memory;
+        uint8_t *m_mapped = nullptr;
+        VkDeviceSize m_capacity = 0;
+
+        // In-use bytes are [m_tail, m_head) circularly (m_empty disambiguates head == tail).
+        VkDeviceSize m_head = 0;
+        VkDeviceSize m_tail = 0;
+        bool m_empty = true;
+
+        // Allocations not yet covered by beginSubmit().
+        bool m_openUsed = false;
+        VkDeviceSize m_openBegin = 0;
+
+        // cancelSubmit() is only valid right after a beginSubmit() that returned a fence.
+        bool m_cancelable = false;
+
+        std::deque<Region> m_inFlight;
+        std::vector<VkFence> m_freeFences;
+    };
+}
@@ -0,0 +1,154 @@
+#pragma once
+/*
+  TelemetrySink.h
+  ---------------
+  Purpose:
+    - Compact binary packets for unattended machines (kiosks, demo rigs, playtest PCs): either
+      UDP datagrams to a collector or a ring of local segment files, so regressions can be found
+      across many real-hardware sessions. PerformanceMonitor is the producer
+      (PerformanceMonitor::enableTelemetry).
+
+  Usage:
+    - TelemetryConfig cfg; TelemetryConfig::parse("udp:10.0.0.5:17800", cfg); sink.open(cfg);
+    - sink.beginPacket(TelemetryPacket::Summary, timeMs); sink.putF32(...); sink.endPacket();
+      sink.flush() once per reporting interval.
+
+  Notes:
+    - Native-endian fields (little-endian on every target the engine ships) after a
+      TelemetryPacketHeader; strings are u8 length + bytes.
+    - A packet never exceeds TELEMETRY_MAX_PACKET_BYTES (fits one unfragmented datagram);
+      producers split lists across packets with remaining().
+    - UDP is fire-and-forget on a non-blocking socket: a full send buffer drops the packet
+      (counted in droppedPackets()). File records are a u16 size followed by the packet; a
+      segment that would exceed segmentBytes rotates to the next file, truncating it.
+    - Main thread only; packets are batched and written by flush().
+*/
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace Engine
+{
+    static constexpr uint32_t TELEMETRY_MAGIC = 0x4C455453u; // "STEL"
+    static constexpr uint16_t TELEMETRY_VERSION = 1;
+    static constexpr size_t TELEMETRY_MAX_PACKET_BYTES = 1200;
+
+    enum class TelemetryPacket : uint8_t
+    {
+        Session = 1, // machine description; repeated so a collector that missed the first one learns it
+        Summary = 2, // frame-time percentiles and system metrics of one interval
+        Systems = 3, // per-system timings of one interval (may span several packets)
+        Hitch = 4    // one HitchSnapshot, heaviest passes/systems only
+    };
+
+    struct TelemetryPacketHeader
+    {
+        uint32_t magic = TELEMETRY_MAGIC;
+        uint16_t version = TELEMETRY_VERSION;
+        uint8_t kind = 0; // TelemetryPacket
+        uint8_t reserved = 0;
+        uint64_t sessionId = 0;
+        uint32_t sequence = 0; // per session, gaps = lost datagrams
+        uint32_t timeMs = 0;   // producer clock (PerformanceMonitor: since init())
+    };
+    static_assert(sizeof(TelemetryPacketHeader) == 24, "TelemetryPacketHeader is sent verbatim");
+
+    struct TelemetryConfig
+    {
+        enum class Transport : uint8_t
+        {
+            None,
+            Udp,
+            FileRing
+        };
+
+        Transport transport = Transport::None;
+        std::string host = "127.0.0.1"; // IPv4 address or name (Udp)
+        uint16_t port = 17800;
+        std::string filePrefix = "telemetry"; // <prefix>.<n>.bin (FileRing)
+        uint32_t segmentBytes = 1u << 20;
+        uint32_t segmentCount = 4;
+
+        // Sampling: seconds per Summary/Systems interval, the fraction of sessions that report at
+        // all (decided once from the session id) and a cap on Hitch packets per interval.
+        float intervalSec = 5.0f;
+        float sessionSampleRate = 1.0f;
+        uint32_t maxHitchesPerInterval = 4;
+
+        uint64_t sessionId = 0; // 0: random
+
+        // "udp:host:port" or "file:prefix"; false (out unchanged) for anything else.
+        static bool parse(const std::string &spec, TelemetryConfig &out);
+    };
+
+    class TelemetrySink
+    {
+    public:
+        TelemetrySink() = default;
+        ~TelemetrySink();
+
+        TelemetrySink(const TelemetrySink &) = delete;
+        TelemetrySink &operator=(const TelemetrySink &) = delete;
+
+        // False if the transport could not be set up. An open sink of a session that was not
+        // sampled (sessionSampleRate) accepts packets and discards them.
+        bool open(const TelemetryConfig &config);
+        void close();
+        bool isOpen() const { return m_open; }
+        bool sampled() const { return m_sampled; }
+
+        const TelemetryConfig &config() const { return m_config; }
+        uint64_t sessionId() const { return m_config.sessionId; }
+
+        void beginPacket(TelemetryPacket kind, uint32_t timeMs);
+        // Bytes still free in the current packet.
+        size_t remaining() const { return TELEMETRY_MAX_PACKET_BYTES - m_packet.size(); }
+        void putU8(uint8_t v) { putRaw(&v, sizeof(v)); }
+        void putU16(uint16_t v) { putRaw(&v, sizeof(v)); }
+        void putU32(uint32_t v) { putRaw(&v, sizeof(v)); }
+        void putU64(uint64_t v) { putRaw(&v, sizeof(v)); }
+        void putF32(float v) { putRaw(&v, sizeof(v)); }
+        // Truncated to 255 bytes (and to what fits).
+        void putString(const std::string &s);
+        // Bytes put so far (header included); with patchU16, a count written after its list.
+        size_t packetSize() const { return m_packet.size(); }
+        void patchU16(size_t offset, uint16_t v);
+        void endPacket();
+
+        // Send/write every packet since the last flush.
+        void flush();
+
+        uint64_t sentPackets() const { return m_sentPackets; }
+        uint64_t sentBytes() const { return m_sentBytes; }
+        uint64_t droppedPackets() const { return m_droppedPackets; }
+
+    private:
+        void putRaw(const void *data, size_t size);
+        void writeFileRecords();
+        void sendDatagrams();
+
+        TelemetryConfig m_config;
+        bool m_open = false;
+        bool m_sampled = false;
+        uint32_t m_sequence = 0;
+
+        std::vector<uint8_t> m_packet; // packet being built
+        std::vector<uint8_t> m_batch;  // finished packets, each prefixed by its u16 size
+        bool m_packetOverflow = false; // a put did not fit: the packet is dropped
+
+        // Udp
+        intptr_t m_socket = -1;
+        std::vector<uint8_t> m_address; // sockaddr_in
+
+        // FileRing
+        std::ofstream m_file;
+        uint32_t m_segment = 0;
+        uint64_t m_segmentUsed = 0;
+
+        uint64_t m_sentPackets = 0;
+        uint64_t m_sentBytes = 0;
+        uint64_t m_droppedPackets = 0;
+    };
+}
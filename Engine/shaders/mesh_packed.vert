@@ -0,0 +1,15 @@
+#version 450
+// mesh.vert for SModel packed vertices (SModelPackedVertex, 36 bytes).
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec2 inNormalOct; // octahedral, snorm16
+layout(location = 2) in vec2 inUV;        // half
+
+layout(location = 0) out vec3 vNormal;
+
+void main() {
+    vec3 n = vec3(inNormalOct, 1.0 - abs(inNormalOct.x) - abs(inNormalOct.y));
+    if (n.z < 0.0)
+        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    vNormal = normalize(n);
+    gl_Position = vec4(inPosition, 1.0);
+}
@@ -0,0 +1,17 @@
+#version 450
+
+// Round soft sprite, additive (ParticleRenderPassModule blends ONE, ONE): rgb scaled by alpha.
+layout(location = 0) in vec4 vColor;
+layout(location = 1) in vec2 vCorner;
+
+layout(location = 0) out vec4 outColor;
+
+void main()
+{
+    float r2 = dot(vCorner, vCorner);
+    if (r2 >= 1.0)
+        discard;
+    float falloff = (1.0 - r2) * (1.0 - r2);
+    float a = vColor.a * falloff;
+    outColor = vec4(vColor.rgb * a, a);
+}
@@ -0,0 +1,67 @@
+#version 450
+
+// Camera-facing quads for ParticleRenderPassModule: one instance per entry of the alive list,
+// six vertices each (no vertex buffers). Size and colour run from start to end over the
+// particle's life.
+
+const uint EFFECT_COUNT = 3u; // PARTICLE_EFFECT_COUNT
+
+struct Effect
+{
+    vec4 colorStart;
+    vec4 colorEnd;
+    vec4 motion;
+    vec4 life; // z=size start, w=size end
+    vec4 forces;
+};
+
+layout(set = 0, binding = 0) uniform FrameUBO
+{
+    mat4 view;
+    mat4 proj;
+    Effect effects[EFFECT_COUNT];
+} frameData;
+
+struct Particle
+{
+    vec4 position; // w=age
+    vec4 velocity; // w=lifetime
+    uvec4 info;    // x=effect, w=scale (float bits)
+};
+
+layout(set = 0, binding = 2, std430) readonly buffer Particles
+{
+    Particle particles[];
+} pool;
+
+layout(set = 0, binding = 3, std430) readonly buffer Alive
+{
+    uint ids[];
+} alive;
+
+layout(location = 0) out vec4 vColor;
+layout(location = 1) out vec2 vCorner;
+
+const vec2 CORNERS[6] = vec2[](vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(1.0, 1.0),
+                               vec2(-1.0, -1.0), vec2(1.0, 1.0), vec2(-1.0, 1.0));
+
+void main()
+{
+    Particle p = pool.particles[alive.ids[gl_InstanceIndex]];
+    Effect e = frameData.effects[min(p.info.x, EFFECT_COUNT - 1u)];
+
+    float t = clamp(p.position.w / max(p.velocity.w, 1e-4), 0.0, 1.0);
+    float size = mix(e.life.z, e.life.w, t) * uintBitsToFloat(p.info.w);
+
+    // Camera right and up are the first two rows of the view matrix.
+    mat4 view = frameData.view;
+    vec3 right = vec3(view[0][0], view[1][0], view[2][0]);
+    vec3 up = vec3(view[0][1], view[1][1], view[2][1]);
+
+    vec2 corner = CORNERS[gl_VertexIndex];
+    vec3 world = p.position.xyz + (right * corner.x + up * corner.y) * size;
+    gl_Position = frameData.proj * view * vec4(world, 1.0);
+
+    vColor = mix(e.colorStart, e.colorEnd, t);
+    vCorner = corner;
+}
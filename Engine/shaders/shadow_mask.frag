@@ -0,0 +1,27 @@
+#version 450
+
+// Alpha test of masked shadow casters (SModel and static props): no colour output, the
+// depth is written by the fixed function.
+layout(location = 1) in vec2 vUV0;
+
+layout(set = 1, binding = 0) uniform sampler2D uBaseColor;
+
+// The first 112 bytes of both passes' push blocks.
+layout(push_constant) uniform PushConstants
+{
+    mat4 model;
+    vec4 baseColorFactor;
+    vec4 materialParams; // x=alphaCutoff
+    uvec4 info;
+} pc;
+
+layout(constant_id = 1) const bool BASE_TEXTURE = true;
+
+void main()
+{
+    float alpha = pc.baseColorFactor.a;
+    if (BASE_TEXTURE)
+        alpha *= texture(uBaseColor, vUV0).a;
+    if (alpha < pc.materialParams.x)
+        discard;
+}
@@ -0,0 +1,41 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+// shadow_mask.frag with the material read from the bindless table (info.w).
+layout(location = 1) in vec2 vUV0;
+
+layout(set = 1, binding = 0) uniform sampler2D uTextures[];
+
+struct Material
+{
+    vec4 baseColorFactor;
+    vec4 emissiveFactor;
+    vec4 params;    // x=alphaCutoff
+    uvec4 textures0; // x=baseColor
+    uvec4 textures1;
+};
+
+layout(std430, set = 1, binding = 1) readonly buffer Materials
+{
+    Material materials[];
+};
+
+layout(push_constant) uniform PushConstants
+{
+    mat4 model;
+    vec4 baseColorFactor;
+    vec4 materialParams;
+    uvec4 info; // w=material index
+} pc;
+
+layout(constant_id = 1) const bool BASE_TEXTURE = true;
+
+void main()
+{
+    Material m = materials[pc.info.w];
+    float alpha = m.baseColorFactor.a;
+    if (BASE_TEXTURE)
+        alpha *= texture(uTextures[m.textures0.x], vUV0).a;
+    if (alpha < m.params.x)
+        discard;
+}
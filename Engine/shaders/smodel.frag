@@ -2,9 +2,20 @@
 
 layout(location = 0) in vec3 vNormal;
 layout(location = 1) in vec2 vUV0;
+layout(location = 2) in vec3 vWorldPos;
 
 layout(set = 1, binding = 0) uniform sampler2D uBaseColor;
 
+// Cascaded shadow maps (Renderer::shadows()): static and dynamic caster layers per cascade.
+layout(set = 2, binding = 0) uniform ShadowUBO {
+    mat4 viewProj[4];
+    vec4 lightDir;   // xyz=toward the light, w=cascade count (0 = off)
+    vec4 params;     // x=1/map size, y=normal offset in texels
+    vec4 texelWorld; // meters per texel per cascade
+} shadow;
+layout(set = 2, binding = 1) uniform sampler2DArrayShadow uStaticShadow;
+layout(set = 2, binding = 2) uniform sampler2DArrayShadow uDynamicShadow;
+
 layout(push_constant) uniform PushConstants
 {
     mat4 model;
@@ -14,26 +25,58 @@ layout(push_constant) uniform PushConstants
 
 layout(location = 0) out vec4 outColor;
 
+// Specialization constants (SModelRenderPassModule builds one pipeline per combination).
+// ALPHA_MODE: 0=Opaque, 1=Mask, 2=Blend; -1 reads it per draw from the material.
+// BASE_TEXTURE: false when the material has no base colour texture (the factor alone).
+layout(constant_id = 0) const int ALPHA_MODE = -1;
+layout(constant_id = 1) const bool BASE_TEXTURE = true;
+
+// Lit fraction: the first cascade holding the point, 2x2 comparison taps in both layers.
+// Explicit zero gradients: the cascade loop is not uniform control flow.
+float shadowFactor(vec3 worldPos, vec3 n)
+{
+    int count = int(shadow.lightDir.w + 0.5);
+    float border = 2.0 * shadow.params.x;
+    for (int c = 0; c < count; ++c)
+    {
+        // Normal offset of a few texels of this cascade against acne on slopes.
+        vec3 p = worldPos + n * (shadow.texelWorld[c] * shadow.params.y);
+        vec4 q = shadow.viewProj[c] * vec4(p, 1.0); // orthographic: w = 1
+        vec2 uv = q.xy * 0.5 + 0.5;
+        if (any(lessThan(uv, vec2(border))) || any(greaterThan(uv, vec2(1.0 - border))) || q.z > 1.0)
+            continue;
+
+        float h = 0.5 * shadow.params.x;
+        float lit = 0.0;
+        for (int k = 0; k < 4; ++k)
+        {
+            vec2 o = vec2((k & 1) != 0 ? h : -h, (k & 2) != 0 ? h : -h);
+            vec4 coord = vec4(uv + o, float(c), q.z);
+            lit += min(textureGrad(uStaticShadow, coord, vec2(0.0), vec2(0.0)),
+                       textureGrad(uDynamicShadow, coord, vec2(0.0), vec2(0.0)));
+        }
+        return lit * 0.25;
+    }
+    return 1.0;
+}
+
 void main()
 {
     vec3 n = normalize(vNormal);
 
-    vec4 tex = texture(uBaseColor, vUV0);
-    vec4 base = tex * pc.baseColorFactor;
+    vec4 base = pc.baseColorFactor;
+    if (BASE_TEXTURE)
+        base *= texture(uBaseColor, vUV0);
 
-    // alphaMode: 0=Opaque, 1=Mask, 2=Blend
-    float alphaMode = pc.materialParams.y;
-    float alphaCutoff = pc.materialParams.x;
-    if (alphaMode > 0.5 && alphaMode < 1.5)
-    {
-        if (base.a < alphaCutoff)
-            discard;
-    }
+    int alphaMode = ALPHA_MODE >= 0 ? ALPHA_MODE : int(pc.materialParams.y + 0.5);
+    if (alphaMode == 1 && base.a < pc.materialParams.x)
+        discard;
 
-    vec3 lightDir = normalize(vec3(0.3, 0.7, 0.2));
+    vec3 lightDir = shadow.lightDir.xyz;
     float ndotl = clamp(dot(n, lightDir), 0.0, 1.0);
+    float sun = ndotl > 0.0 ? shadowFactor(vWorldPos, n) : 0.0;
     vec3 ambient = vec3(0.2);
-    vec3 lit = ambient + ndotl * vec3(0.8);
+    vec3 lit = ambient + ndotl * sun * vec3(0.8);
 
     outColor = vec4(base.rgb * lit, base.a);
 }
@@ -1,14 +1,14 @@
 #version 450
 
-// SModel v4 vertex layout (VertexPNTTJW):
+// SModel packed vertex layout (SModelPackedVertex, 36 bytes):
 // location 0: vec3 position
-// location 1: vec3 normal
-// location 2: vec2 uv0
-// location 3: vec4 tangent
+// location 1: vec2 normal (octahedral, snorm16)
+// location 2: vec2 uv0 (half)
+// location 3: vec4 tangent (snorm8)
 // location 8: uvec4 joints (u16x4)
-// location 9: vec4 weights
+// location 9: vec4 weights (unorm8)
 layout(location = 0) in vec3 inPosition;
-layout(location = 1) in vec3 inNormal;
+layout(location = 1) in vec2 inNormalOct;
 layout(location = 2) in vec2 inUV0;
 layout(location = 3) in vec4 inTangent;
 
@@ -55,9 +55,26 @@ layout(push_constant) uniform PushConstants
 
 layout(location = 0) out vec3 vNormal;
 layout(location = 1) out vec2 vUV0;
+layout(location = 2) out vec3 vWorldPos; // shadow lookup
+
+// SKINNED: 1 skinned, 0 rigid (node palette), -1 decides per draw from skinJointCount.
+// Prepass and colour pipelines of a draw use the same value.
+layout(constant_id = 2) const int SKINNED = -1;
+
+// Same depth in the depth prepass and colour pipelines (they test LESS_OR_EQUAL against it).
+invariant gl_Position;
+
+vec3 decodeOctNormal(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0)
+        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    return normalize(n);
+}
 
 void main()
 {
+    vec3 inNormal = decodeOctNormal(inNormalOct);
     uint instanceIndex = uint(gl_InstanceIndex);
     uint slot = activeSlots.slotIndex[instanceIndex];
     mat4 instanceWorld = inst.instanceWorlds[slot];
@@ -72,7 +89,8 @@ void main()
     vec4 modelPos;
     vec3 modelNormal;
 
-    if (skinJointCount > 0u)
+    bool skinned = SKINNED >= 0 ? SKINNED == 1 : skinJointCount > 0u;
+    if (skinned)
     {
         // Skinning: joint matrices already bring vertices into model space.
         // Build a weighted skin matrix from up to 4 joints.
@@ -106,5 +124,6 @@ void main()
     mat3 normalMat = mat3(transpose(inverse(M)));
     vNormal = normalize(normalMat * modelNormal);
     vUV0 = inUV0;
+    vWorldPos = worldPos.xyz;
     gl_Position = cam.proj * cam.view * worldPos;
 }
@@ -0,0 +1,104 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout(location = 0) in vec3 vNormal;
+layout(location = 1) in vec2 vUV0;
+layout(location = 2) in vec3 vWorldPos;
+
+// Global bindless table (BindlessMaterials): index 0 of both arrays is the white fallback.
+layout(set = 1, binding = 0) uniform sampler2D uTextures[];
+
+struct Material
+{
+    vec4 baseColorFactor;
+    vec4 emissiveFactor;
+    vec4 params;    // x=alphaCutoff, y=alphaMode, z=metallic, w=roughness
+    uvec4 textures0; // baseColor, normal, metallicRoughness, occlusion
+    uvec4 textures1; // x=emissive
+};
+
+layout(std430, set = 1, binding = 1) readonly buffer Materials
+{
+    Material materials[];
+};
+
+// Shadow receiver set, see smodel.frag.
+layout(set = 2, binding = 0) uniform ShadowUBO {
+    mat4 viewProj[4];
+    vec4 lightDir;
+    vec4 params;
+    vec4 texelWorld;
+} shadow;
+layout(set = 2, binding = 1) uniform sampler2DArrayShadow uStaticShadow;
+layout(set = 2, binding = 2) uniform sampler2DArrayShadow uDynamicShadow;
+
+layout(push_constant) uniform PushConstants
+{
+    mat4 model;
+    vec4 baseColorFactor;
+    vec4 materialParams;
+    uvec4 nodeInfo; // w=material index
+    uvec4 skinInfo;
+} pc;
+
+layout(location = 0) out vec4 outColor;
+
+// Specialization constants (SModelRenderPassModule builds one pipeline per combination).
+// ALPHA_MODE: 0=Opaque, 1=Mask, 2=Blend; -1 reads it per draw from the material.
+// BASE_TEXTURE: false when the material has no base colour texture (the factor alone).
+layout(constant_id = 0) const int ALPHA_MODE = -1;
+layout(constant_id = 1) const bool BASE_TEXTURE = true;
+
+float shadowFactor(vec3 worldPos, vec3 n)
+{
+    int count = int(shadow.lightDir.w + 0.5);
+    float border = 2.0 * shadow.params.x;
+    for (int c = 0; c < count; ++c)
+    {
+        vec3 p = worldPos + n * (shadow.texelWorld[c] * shadow.params.y);
+        vec4 q = shadow.viewProj[c] * vec4(p, 1.0);
+        vec2 uv = q.xy * 0.5 + 0.5;
+        if (any(lessThan(uv, vec2(border))) || any(greaterThan(uv, vec2(1.0 - border))) || q.z > 1.0)
+            continue;
+
+        float h = 0.5 * shadow.params.x;
+        float lit = 0.0;
+        for (int k = 0; k < 4; ++k)
+        {
+            vec2 o = vec2((k & 1) != 0 ? h : -h, (k & 2) != 0 ? h : -h);
+            vec4 coord = vec4(uv + o, float(c), q.z);
+            lit += min(textureGrad(uStaticShadow, coord, vec2(0.0), vec2(0.0)),
+                       textureGrad(uDynamicShadow, coord, vec2(0.0), vec2(0.0)));
+        }
+        return lit * 0.25;
+    }
+    return 1.0;
+}
+
+void main()
+{
+    vec3 n = normalize(vNormal);
+
+    // Push-constant index: dynamically uniform per draw, no nonuniformEXT needed.
+    Material m = materials[pc.nodeInfo.w];
+
+    vec4 base = m.baseColorFactor;
+    if (BASE_TEXTURE)
+        base *= texture(uTextures[m.textures0.x], vUV0);
+
+    int alphaMode = ALPHA_MODE >= 0 ? ALPHA_MODE : int(m.params.y + 0.5);
+    if (alphaMode == 1 && base.a < m.params.x)
+        discard;
+
+    vec3 lightDir = shadow.lightDir.xyz;
+    float ndotl = clamp(dot(n, lightDir), 0.0, 1.0);
+    float sun = ndotl > 0.0 ? shadowFactor(vWorldPos, n) : 0.0;
+    vec3 ambient = vec3(0.2);
+    vec3 lit = ambient + ndotl * sun * vec3(0.8);
+
+    vec3 emissive = m.emissiveFactor.rgb;
+    if (m.textures1.x != 0u)
+        emissive *= texture(uTextures[m.textures1.x], vUV0).rgb;
+
+    outColor = vec4(base.rgb * lit + emissive, base.a);
+}
@@ -0,0 +1,143 @@
+#version 450
+
+// Indirect-draw variant of smodel.vert (see SModelRenderPassModule::recordIndirect).
+// SModel packed vertex layout (SModelPackedVertex, 36 bytes):
+// location 0: vec3 position
+// location 1: vec2 normal (octahedral, snorm16)
+// location 2: vec2 uv0 (half)
+// location 3: vec4 tangent (snorm8)
+// location 8: uvec4 joints (u16x4)
+// location 9: vec4 weights (unorm8)
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec2 inNormalOct;
+layout(location = 2) in vec2 inUV0;
+layout(location = 3) in vec4 inTangent;
+
+layout(location = 8) in uvec4 inJoints;
+layout(location = 9) in vec4 inWeights;
+
+layout(set = 0, binding = 0) uniform CameraUBO {
+    mat4 view;
+    mat4 proj;
+} cam;
+
+// Flattened node globals: [instance][node]
+layout(set = 0, binding = 1, std430) readonly buffer NodePalette
+{
+    mat4 nodeGlobals[];
+} palette;
+
+// Flattened joint matrices: [instance][joint]
+layout(set = 0, binding = 2, std430) readonly buffer JointPalette
+{
+    mat4 jointMats[];
+} joints;
+
+// Slot-indexed instance world transforms: [slot]
+layout(set = 0, binding = 3, std430) readonly buffer InstanceWorlds
+{
+    mat4 instanceWorlds[];
+} inst;
+
+// Active slot indirection: local instance -> slot
+layout(set = 0, binding = 4, std430) readonly buffer ActiveSlots
+{
+    uint slotIndex[];
+} activeSlots;
+
+// Per-draw data for indirect draws: x=nodeIndex, y=skinBaseJoint, z=skinJointCount
+layout(set = 0, binding = 5, std430) readonly buffer DrawData
+{
+    uvec4 draws[];
+} drawData;
+
+layout(push_constant) uniform PushConstants
+{
+    mat4 model;
+    vec4 baseColorFactor;
+    vec4 materialParams;
+    uvec4 nodeInfo; // y=nodeCount, z=instanceCount (x unused)
+    uvec4 skinInfo; // z=jointPaletteStride (x/y unused)
+} pc;
+
+layout(location = 0) out vec3 vNormal;
+layout(location = 1) out vec2 vUV0;
+layout(location = 2) out vec3 vWorldPos; // shadow lookup
+
+// SKINNED: 1 skinned, 0 rigid (node palette), -1 decides per draw from skinJointCount.
+// Prepass and colour pipelines of a draw use the same value.
+layout(constant_id = 2) const int SKINNED = -1;
+
+// Same depth in the depth prepass and colour pipelines (they test LESS_OR_EQUAL against it).
+invariant gl_Position;
+
+vec3 decodeOctNormal(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0)
+        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    return normalize(n);
+}
+
+void main()
+{
+    vec3 inNormal = decodeOctNormal(inNormalOct);
+    // Indirect commands use firstInstance = drawIndex * instanceCount, so gl_InstanceIndex
+    // (which includes firstInstance) encodes both the draw and the instance within it.
+    // Core Vulkan 1.0: no gl_DrawID / shader draw parameters needed.
+    uint instanceCount = max(pc.nodeInfo.z, 1u);
+    uint drawIndex = uint(gl_InstanceIndex) / instanceCount;
+    uint instanceIndex = uint(gl_InstanceIndex) - drawIndex * instanceCount;
+    uvec4 draw = drawData.draws[drawIndex];
+
+    uint slot = activeSlots.slotIndex[instanceIndex];
+    mat4 instanceWorld = inst.instanceWorlds[slot];
+    uint nodeIndex = draw.x;
+    uint nodeCount = max(pc.nodeInfo.y, 1u);
+
+    uint skinBase = draw.y;
+    uint skinJointCount = draw.z;
+    uint jointStride = max(pc.skinInfo.z, 1u);
+
+    mat4 M;
+    vec4 modelPos;
+    vec3 modelNormal;
+
+    bool skinned = SKINNED >= 0 ? SKINNED == 1 : skinJointCount > 0u;
+    if (skinned)
+    {
+        // Skinning: joint matrices already bring vertices into model space.
+        // Build a weighted skin matrix from up to 4 joints.
+        mat4 skinM = mat4(0.0);
+        vec4 w = inWeights;
+
+        // Clamp joint indices to skinJointCount to avoid OOB.
+        uvec4 j = min(inJoints, uvec4(max(skinJointCount - 1u, 0u)));
+
+        uint base = slot * jointStride + skinBase;
+        skinM += w.x * joints.jointMats[base + j.x];
+        skinM += w.y * joints.jointMats[base + j.y];
+        skinM += w.z * joints.jointMats[base + j.z];
+        skinM += w.w * joints.jointMats[base + j.w];
+
+        modelPos = skinM * vec4(inPosition, 1.0);
+        modelNormal = normalize(mat3(skinM) * inNormal);
+
+        M = instanceWorld * pc.model;
+    }
+    else
+    {
+        // Unskinned: use node transform palette.
+        mat4 nodeM = palette.nodeGlobals[slot * nodeCount + nodeIndex];
+        M = instanceWorld * pc.model * nodeM;
+        modelPos = vec4(inPosition, 1.0);
+        modelNormal = inNormal;
+    }
+
+    vec4 worldPos = M * modelPos;
+    mat3 normalMat = mat3(transpose(inverse(M)));
+    vNormal = normalize(normalMat * modelNormal);
+    vUV0 = inUV0;
+    vWorldPos = worldPos.xyz;
+    gl_Position = cam.proj * cam.view * worldPos;
+}
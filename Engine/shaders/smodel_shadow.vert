@@ -0,0 +1,81 @@
+#version 450
+
+// SModelRenderPassModule shadow casters: depth of every slot in this cascade's caster list.
+// Vertex layout as smodel.vert (SModelPackedVertex); only position, uv0 and skinning are read.
+layout(location = 0) in vec3 inPosition;
+layout(location = 2) in vec2 inUV0;
+
+layout(location = 8) in uvec4 inJoints;
+layout(location = 9) in vec4 inWeights;
+
+// Set 0 is the camera layout written with the resident slot buffers.
+layout(set = 0, binding = 1, std430) readonly buffer NodePalette
+{
+    mat4 nodeGlobals[];
+} palette;
+
+layout(set = 0, binding = 2, std430) readonly buffer JointPalette
+{
+    mat4 jointMats[];
+} joints;
+
+layout(set = 0, binding = 3, std430) readonly buffer InstanceWorlds
+{
+    mat4 instanceWorlds[];
+} inst;
+
+// Per-cascade caster lists back to back; firstInstance starts the cascade's list.
+layout(set = 0, binding = 4, std430) readonly buffer ShadowSlots
+{
+    uint slotIndex[];
+} casters;
+
+layout(set = 2, binding = 0) uniform ShadowUBO {
+    mat4 viewProj[4];
+    vec4 lightDir;
+    vec4 params;
+    vec4 texelWorld;
+} shadow;
+
+layout(push_constant) uniform PushConstants
+{
+    mat4 model;
+    vec4 baseColorFactor;
+    vec4 materialParams;
+    uvec4 nodeInfo; // x=nodeIndex, y=nodeCount, z=cascade, w=material index
+    uvec4 skinInfo; // x=skinBaseJoint, y=skinJointCount, z=jointPaletteStride
+} pc;
+
+layout(location = 1) out vec2 vUV0;
+
+layout(constant_id = 2) const int SKINNED = -1;
+
+void main()
+{
+    uint slot = casters.slotIndex[uint(gl_InstanceIndex)];
+    mat4 instanceWorld = inst.instanceWorlds[slot];
+    uint nodeCount = max(pc.nodeInfo.y, 1u);
+    uint skinJointCount = pc.skinInfo.y;
+    uint jointStride = max(pc.skinInfo.z, 1u);
+
+    vec4 worldPos;
+    bool skinned = SKINNED >= 0 ? SKINNED == 1 : skinJointCount > 0u;
+    if (skinned)
+    {
+        uvec4 j = min(inJoints, uvec4(max(skinJointCount - 1u, 0u)));
+        uint base = slot * jointStride + pc.skinInfo.x;
+        mat4 skinM = inWeights.x * joints.jointMats[base + j.x]
+                   + inWeights.y * joints.jointMats[base + j.y]
+                   + inWeights.z * joints.jointMats[base + j.z]
+                   + inWeights.w * joints.jointMats[base + j.w];
+        worldPos = instanceWorld * pc.model * (skinM * vec4(inPosition, 1.0));
+    }
+    else
+    {
+        mat4 nodeM = palette.nodeGlobals[slot * nodeCount + pc.nodeInfo.x];
+        worldPos = instanceWorld * pc.model * nodeM * vec4(inPosition, 1.0);
+    }
+
+    vUV0 = inUV0;
+    gl_Position = shadow.viewProj[pc.nodeInfo.z] * worldPos;
+}
@@ -0,0 +1,92 @@
+#version 450
+
+layout(location = 0) in vec3 vNormal;
+layout(location = 1) in vec2 vUV0;
+layout(location = 2) flat in float vFade;
+layout(location = 3) in vec3 vWorldPos;
+
+layout(set = 1, binding = 0) uniform sampler2D uBaseColor;
+
+// Shadow receiver set, see smodel.frag.
+layout(set = 2, binding = 0) uniform ShadowUBO {
+    mat4 viewProj[4];
+    vec4 lightDir;
+    vec4 params;
+    vec4 texelWorld;
+} shadow;
+layout(set = 2, binding = 1) uniform sampler2DArrayShadow uStaticShadow;
+layout(set = 2, binding = 2) uniform sampler2DArrayShadow uDynamicShadow;
+
+layout(push_constant) uniform PushConstants
+{
+    mat4 node;
+    vec4 baseColorFactor;
+    vec4 materialParams; // x=alphaCutoff, y=alphaMode
+    uvec4 materialInfo;
+} pc;
+
+layout(location = 0) out vec4 outColor;
+
+// 4x4 ordered dither: distance fade without sorting or blending.
+float bayer4(vec2 p)
+{
+    const float m[16] = float[16](0.0, 8.0, 2.0, 10.0,
+                                  12.0, 4.0, 14.0, 6.0,
+                                  3.0, 11.0, 1.0, 9.0,
+                                  15.0, 7.0, 13.0, 5.0);
+    ivec2 i = ivec2(p) & 3;
+    return (m[i.y * 4 + i.x] + 0.5) / 16.0;
+}
+
+float shadowFactor(vec3 worldPos, vec3 n)
+{
+    int count = int(shadow.lightDir.w + 0.5);
+    float border = 2.0 * shadow.params.x;
+    for (int c = 0; c < count; ++c)
+    {
+        vec3 p = worldPos + n * (shadow.texelWorld[c] * shadow.params.y);
+        vec4 q = shadow.viewProj[c] * vec4(p, 1.0);
+        vec2 uv = q.xy * 0.5 + 0.5;
+        if (any(lessThan(uv, vec2(border))) || any(greaterThan(uv, vec2(1.0 - border))) || q.z > 1.0)
+            continue;
+
+        float h = 0.5 * shadow.params.x;
+        float lit = 0.0;
+        for (int k = 0; k < 4; ++k)
+        {
+            vec2 o = vec2((k & 1) != 0 ? h : -h, (k & 2) != 0 ? h : -h);
+            vec4 coord = vec4(uv + o, float(c), q.z);
+            lit += min(textureGrad(uStaticShadow, coord, vec2(0.0), vec2(0.0)),
+                       textureGrad(uDynamicShadow, coord, vec2(0.0), vec2(0.0)));
+        }
+        return lit * 0.25;
+    }
+    return 1.0;
+}
+
+void main()
+{
+    if (vFade < bayer4(gl_FragCoord.xy))
+        discard;
+
+    vec3 n = normalize(vNormal);
+
+    vec4 base = texture(uBaseColor, vUV0) * pc.baseColorFactor;
+
+    // alphaMode: 0=Opaque, 1=Mask, 2=Blend
+    float alphaMode = pc.materialParams.y;
+    float alphaCutoff = pc.materialParams.x;
+    if (alphaMode > 0.5 && alphaMode < 1.5)
+    {
+        if (base.a < alphaCutoff)
+            discard;
+    }
+
+    vec3 lightDir = shadow.lightDir.xyz;
+    float ndotl = clamp(dot(n, lightDir), 0.0, 1.0);
+    float sun = ndotl > 0.0 ? shadowFactor(vWorldPos, n) : 0.0;
+    vec3 ambient = vec3(0.2);
+    vec3 lit = ambient + ndotl * sun * vec3(0.8);
+
+    outColor = vec4(base.rgb * lit, base.a);
+}
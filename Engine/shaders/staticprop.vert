@@ -0,0 +1,76 @@
+#version 450
+
+// StaticPropRenderPassModule: one instanced indirect draw per model primitive.
+// Reads position, normal and uv0 of the SModel packed vertex layout (SModelPackedVertex, 36 bytes).
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec2 inNormalOct; // octahedral, snorm16
+layout(location = 2) in vec2 inUV0;       // half
+
+layout(set = 0, binding = 0) uniform CameraUBO {
+    mat4 view;
+    mat4 proj;
+    vec4 cameraPos;
+    vec4 fade; // x=fade end, y=1/(end-start), z=mesh end when impostors take over, w=1/cross-fade
+} cam;
+
+struct Instance
+{
+    mat4 world;
+    vec4 sphere; // xyz=world center, w=radius
+};
+
+// Resident instance table, indexed by instance id
+layout(set = 0, binding = 1, std430) readonly buffer Instances
+{
+    Instance instances[];
+} inst;
+
+// Visible instance ids written by staticprop_cull.comp
+layout(set = 0, binding = 2, std430) readonly buffer Visible
+{
+    uint ids[];
+} visible;
+
+layout(push_constant) uniform PushConstants
+{
+    mat4 node; // model fit * node global
+    vec4 baseColorFactor;
+    vec4 materialParams;
+    uvec4 materialInfo; // x=bindless material index
+} pc;
+
+layout(location = 0) out vec3 vNormal;
+layout(location = 1) out vec2 vUV0;
+layout(location = 2) flat out float vFade;
+layout(location = 3) out vec3 vWorldPos; // shadow lookup
+
+// Same depth in the depth prepass and colour pipelines (they test LESS_OR_EQUAL against it).
+invariant gl_Position;
+
+vec3 decodeOctNormal(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0)
+        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    return normalize(n);
+}
+
+void main()
+{
+    vec3 inNormal = decodeOctNormal(inNormalOct);
+    Instance i = inst.instances[visible.ids[gl_InstanceIndex]];
+    mat4 M = i.world * pc.node;
+
+    // 1 inside the fade start, 0 at the fade end; per instance so the whole prop dissolves.
+    // The impostor cross-fade dissolves the mesh the same way (staticprop_impostor.frag keeps
+    // exactly the pixels this discards).
+    float d = distance(cam.cameraPos.xyz, i.sphere.xyz);
+    vFade = min(clamp((cam.fade.x - d) * cam.fade.y, 0.0, 1.0), clamp((cam.fade.z - d) * cam.fade.w, 0.0, 1.0));
+
+    mat3 normalMat = mat3(transpose(inverse(M)));
+    vNormal = normalize(normalMat * inNormal);
+    vUV0 = inUV0;
+    vec4 worldPos = M * vec4(inPosition, 1.0);
+    vWorldPos = worldPos.xyz;
+    gl_Position = cam.proj * cam.view * worldPos;
+}
@@ -0,0 +1,79 @@
+#version 450
+
+// Impostor quad of StaticPropRenderPassModule (staticprop_impostor.vert): blends the three
+// nearest frames, lights the baked normals and pushes depth back onto the captured surface.
+layout(location = 0) in vec2 vFrameUV0;
+layout(location = 1) in vec2 vFrameUV1;
+layout(location = 2) in vec2 vFrameUV2;
+layout(location = 3) flat in vec3 vWeights;
+layout(location = 4) flat in vec4 vFrames01;
+layout(location = 5) flat in vec4 vFrame2Fade; // xy=frame 2, z=distance fade, w=mesh fade
+layout(location = 6) in vec3 vViewPos;
+layout(location = 7) flat in vec3 vLightDir;
+layout(location = 8) flat in float vRadius;
+
+layout(set = 0, binding = 0) uniform CameraUBO {
+    mat4 view;
+    mat4 proj;
+    vec4 cameraPos;
+    vec4 fade;
+} cam;
+
+// Impostor atlases: rgb=albedo, a=coverage / rgb=normal, a=depth
+layout(set = 1, binding = 0) uniform sampler2D uAlbedo;
+layout(set = 1, binding = 1) uniform sampler2D uNormalDepth;
+
+layout(push_constant) uniform PushConstants
+{
+    mat4 fit;
+    vec4 sphere;
+    uvec4 info; // x=frames per side
+} pc;
+
+layout(location = 0) out vec4 outColor;
+// Only ever moved away from the quad: keeps early depth rejection against nearer geometry.
+layout(depth_greater) out float gl_FragDepth;
+
+// 4x4 ordered dither (see staticprop.frag).
+float bayer4(vec2 p)
+{
+    const float m[16] = float[16](0.0, 8.0, 2.0, 10.0,
+                                  12.0, 4.0, 14.0, 6.0,
+                                  3.0, 11.0, 1.0, 9.0,
+                                  15.0, 7.0, 13.0, 5.0);
+    ivec2 i = ivec2(p) & 3;
+    return (m[i.y * 4 + i.x] + 0.5) / 16.0;
+}
+
+vec2 atlasUV(vec2 cell, vec2 uv)
+{
+    return (cell + clamp(uv, 0.0, 1.0)) / float(pc.info.x);
+}
+
+void main()
+{
+    // Keeps exactly the pixels the mesh discards inside the cross-fade.
+    float b = bayer4(gl_FragCoord.xy);
+    if (vFrame2Fade.z < b || b <= vFrame2Fade.w)
+        discard;
+
+    vec2 uv0 = atlasUV(vFrames01.xy, vFrameUV0);
+    vec2 uv1 = atlasUV(vFrames01.zw, vFrameUV1);
+    vec2 uv2 = atlasUV(vFrame2Fade.xy, vFrameUV2);
+
+    vec4 albedo = texture(uAlbedo, uv0) * vWeights.x + texture(uAlbedo, uv1) * vWeights.y + texture(uAlbedo, uv2) * vWeights.z;
+    if (albedo.a < 0.5)
+        discard;
+    vec4 nd = texture(uNormalDepth, uv0) * vWeights.x + texture(uNormalDepth, uv1) * vWeights.y + texture(uNormalDepth, uv2) * vWeights.z;
+
+    vec3 n = normalize(nd.rgb * 2.0 - 1.0);
+    float ndotl = clamp(dot(n, vLightDir), 0.0, 1.0);
+    vec3 ambient = vec3(0.2);
+    vec3 lit = ambient + ndotl * vec3(0.8);
+    outColor = vec4(albedo.rgb * lit, 1.0);
+
+    // The quad sits on the sphere's front; depth 1 is the front, 0 the back (2 radii behind).
+    vec3 p = vViewPos + normalize(vViewPos) * ((1.0 - nd.a) * 2.0 * vRadius);
+    vec4 clip = cam.proj * vec4(p, 1.0);
+    gl_FragDepth = clip.z / clip.w;
+}
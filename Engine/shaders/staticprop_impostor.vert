@@ -0,0 +1,157 @@
+#version 450
+
+// StaticPropRenderPassModule: far instances as one camera-facing quad (6 vertices, no vertex
+// buffer) textured from the model's octahedral impostor atlases (smodel::SModelImpostorHeader).
+// The three captured frames nearest the view direction are blended; the frame mapping must
+// match smodel::ImpostorFrameDirection / ImpostorFrameBasis (SModelImpostor.h).
+layout(set = 0, binding = 0) uniform CameraUBO {
+    mat4 view;
+    mat4 proj;
+    vec4 cameraPos;
+    vec4 fade; // x=fade end, y=1/(end-start), z=mesh end, w=1/cross-fade
+} cam;
+
+struct Instance
+{
+    mat4 world;
+    vec4 sphere; // xyz=world center, w=radius
+};
+
+layout(set = 0, binding = 1, std430) readonly buffer Instances
+{
+    Instance instances[];
+} inst;
+
+// Impostor instance ids written by staticprop_cull.comp
+layout(set = 0, binding = 3, std430) readonly buffer ImpostorVisible
+{
+    uint ids[];
+} visible;
+
+layout(push_constant) uniform PushConstants
+{
+    mat4 fit;    // model fit (the node globals are baked into the capture)
+    vec4 sphere; // xyz=capture center, w=radius (model space)
+    uvec4 info;  // x=frames per side, y=mapping (0=sphere, 1=hemisphere), z=bindless material index
+} pc;
+
+layout(location = 0) out vec2 vFrameUV0; // frame-local, [0, 1] inside the capture
+layout(location = 1) out vec2 vFrameUV1;
+layout(location = 2) out vec2 vFrameUV2;
+layout(location = 3) flat out vec3 vWeights;
+layout(location = 4) flat out vec4 vFrames01; // atlas cells of frames 0 and 1
+layout(location = 5) flat out vec4 vFrame2Fade; // xy=frame 2, z=distance fade, w=mesh fade
+layout(location = 6) out vec3 vViewPos;
+layout(location = 7) flat out vec3 vLightDir; // model space
+layout(location = 8) flat out float vRadius;  // world units
+
+vec3 frameDirection(vec2 g)
+{
+    vec2 uv = g * 2.0 - 1.0;
+    vec3 d;
+    if (pc.info.y == 1u)
+    {
+        d.x = 0.5 * (uv.x - uv.y);
+        d.z = 0.5 * (uv.x + uv.y);
+        d.y = 1.0 - abs(d.x) - abs(d.z);
+    }
+    else
+    {
+        d = vec3(uv.x, 1.0 - abs(uv.x) - abs(uv.y), uv.y);
+        if (d.y < 0.0)
+            d.xz = (1.0 - abs(uv.yx)) * vec2(uv.x >= 0.0 ? 1.0 : -1.0, uv.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return normalize(d);
+}
+
+// Inverse of frameDirection: grid coordinates in [0, 1].
+vec2 frameGrid(vec3 v)
+{
+    if (pc.info.y == 1u)
+    {
+        v.y = max(v.y, 0.0);
+        v /= max(abs(v.x) + abs(v.y) + abs(v.z), 1e-6);
+        return vec2(v.x + v.z, v.z - v.x) * 0.5 + 0.5;
+    }
+    v /= max(abs(v.x) + abs(v.y) + abs(v.z), 1e-6);
+    vec2 uv = v.xz;
+    if (v.y < 0.0)
+        uv = (1.0 - abs(v.zx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.z >= 0.0 ? 1.0 : -1.0);
+    return uv * 0.5 + 0.5;
+}
+
+void frameBasis(vec3 dir, out vec3 right, out vec3 up)
+{
+    vec3 ref = abs(dir.y) > 0.999 ? vec3(0.0, 0.0, -1.0) : vec3(0.0, 1.0, 0.0);
+    right = normalize(cross(ref, dir));
+    up = cross(dir, right);
+}
+
+// Frame-local uv of an offset from the center in that frame's projection.
+vec2 frameUV(vec2 cell, float n, vec3 offset, float r)
+{
+    vec3 right, up;
+    frameBasis(frameDirection(cell / (n - 1.0)), right, up);
+    return vec2(0.5 + 0.5 * dot(offset, right) / r, 0.5 - 0.5 * dot(offset, up) / r);
+}
+
+void main()
+{
+    const vec2 corners[6] = vec2[6](vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(1.0, 1.0),
+                                    vec2(-1.0, -1.0), vec2(1.0, 1.0), vec2(-1.0, 1.0));
+
+    Instance i = inst.instances[visible.ids[gl_InstanceIndex]];
+    mat4 M = i.world * pc.fit;
+    mat3 invM3 = inverse(mat3(M));
+    vec3 c = pc.sphere.xyz;
+    float r = pc.sphere.w;
+
+    // View direction in model space (from the center toward the camera).
+    vec3 camModel = invM3 * (cam.cameraPos.xyz - M[3].xyz);
+    vec3 v = normalize(camModel - c);
+
+    // The grid triangle around v: its three frames and barycentric weights.
+    float n = float(pc.info.x);
+    vec2 g = frameGrid(v) * (n - 1.0);
+    vec2 base = clamp(floor(g), vec2(0.0), vec2(n - 2.0));
+    vec2 f = g - base;
+    vec2 cell0, cell1, cell2;
+    if (f.x + f.y <= 1.0)
+    {
+        cell0 = base;
+        cell1 = base + vec2(1.0, 0.0);
+        cell2 = base + vec2(0.0, 1.0);
+        vWeights = vec3(1.0 - f.x - f.y, f.x, f.y);
+    }
+    else
+    {
+        cell0 = base + vec2(1.0, 1.0);
+        cell1 = base + vec2(0.0, 1.0);
+        cell2 = base + vec2(1.0, 0.0);
+        vWeights = vec3(f.x + f.y - 1.0, 1.0 - f.x, 1.0 - f.y);
+    }
+
+    // Quad on the capture sphere's front plane, facing the camera.
+    vec3 right, up;
+    frameBasis(v, right, up);
+    vec2 corner = corners[gl_VertexIndex % 6];
+    vec3 offset = (corner.x * right + corner.y * up) * r;
+    vec3 pos = c + offset + v * r;
+
+    vFrameUV0 = frameUV(cell0, n, offset, r);
+    vFrameUV1 = frameUV(cell1, n, offset, r);
+    vFrameUV2 = frameUV(cell2, n, offset, r);
+    vFrames01 = vec4(cell0, cell1);
+
+    // Same per-instance fades as staticprop.vert.
+    float d = distance(cam.cameraPos.xyz, i.sphere.xyz);
+    vFrame2Fade = vec4(cell2, clamp((cam.fade.x - d) * cam.fade.y, 0.0, 1.0), clamp((cam.fade.z - d) * cam.fade.w, 0.0, 1.0));
+
+    // n_world . L == n_model . (M^-1 L): light the baked model-space normals directly.
+    vLightDir = normalize(invM3 * normalize(vec3(0.3, 0.7, 0.2)));
+    vRadius = r * length(M[0].xyz);
+
+    vec4 viewPos = cam.view * (M * vec4(pos, 1.0));
+    vViewPos = viewPos.xyz;
+    gl_Position = cam.proj * viewPos;
+}
@@ -0,0 +1,46 @@
+#version 450
+
+// StaticPropRenderPassModule shadow casters: one direct draw per primitive and run of cells
+// touching the cascade; gl_InstanceIndex indexes the cell-sorted instance ids.
+layout(location = 0) in vec3 inPosition;
+layout(location = 2) in vec2 inUV0;
+
+struct Instance
+{
+    mat4 world;
+    vec4 sphere;
+};
+
+layout(set = 0, binding = 0, std430) readonly buffer Instances
+{
+    Instance instances[];
+} inst;
+
+layout(set = 0, binding = 1, std430) readonly buffer CellInstances
+{
+    uint ids[];
+} cells;
+
+layout(set = 2, binding = 0) uniform ShadowUBO {
+    mat4 viewProj[4];
+    vec4 lightDir;
+    vec4 params;
+    vec4 texelWorld;
+} shadow;
+
+layout(push_constant) uniform PushConstants
+{
+    mat4 node; // model fit * node global
+    vec4 baseColorFactor;
+    vec4 materialParams;
+    uvec4 info; // z=cascade, w=bindless material index
+} pc;
+
+layout(location = 1) out vec2 vUV0;
+
+void main()
+{
+    Instance i = inst.instances[cells.ids[gl_InstanceIndex]];
+    vUV0 = inUV0;
+    gl_Position = shadow.viewProj[pc.info.z] * (i.world * pc.node * vec4(inPosition, 1.0));
+}
@@ -0,0 +1,73 @@
+#version 450
+
+layout(location = 0) in vec3 vNormal;
+layout(location = 1) in vec2 vWorldXZ;
+layout(location = 2) in vec4 vSplat;
+layout(location = 3) in vec3 vWorldPos;
+
+layout(set = 0, binding = 0) uniform CameraUBO {
+    mat4 view;
+    mat4 proj;
+    vec4 cameraPos;
+    vec4 layerScale; // per layer: 1 / meters per repeat
+} cam;
+
+// Tiled layer textures blended by the splat weights (unset layers alias layer 0).
+layout(set = 0, binding = 4) uniform sampler2D uLayers[4];
+
+// Shadow receiver set, see smodel.frag.
+layout(set = 1, binding = 0) uniform ShadowUBO {
+    mat4 viewProj[4];
+    vec4 lightDir;
+    vec4 params;
+    vec4 texelWorld;
+} shadow;
+layout(set = 1, binding = 1) uniform sampler2DArrayShadow uStaticShadow;
+layout(set = 1, binding = 2) uniform sampler2DArrayShadow uDynamicShadow;
+
+layout(location = 0) out vec4 outColor;
+
+float shadowFactor(vec3 worldPos, vec3 n)
+{
+    int count = int(shadow.lightDir.w + 0.5);
+    float border = 2.0 * shadow.params.x;
+    for (int c = 0; c < count; ++c)
+    {
+        vec3 p = worldPos + n * (shadow.texelWorld[c] * shadow.params.y);
+        vec4 q = shadow.viewProj[c] * vec4(p, 1.0);
+        vec2 uv = q.xy * 0.5 + 0.5;
+        if (any(lessThan(uv, vec2(border))) || any(greaterThan(uv, vec2(1.0 - border))) || q.z > 1.0)
+            continue;
+
+        float h = 0.5 * shadow.params.x;
+        float lit = 0.0;
+        for (int k = 0; k < 4; ++k)
+        {
+            vec2 o = vec2((k & 1) != 0 ? h : -h, (k & 2) != 0 ? h : -h);
+            vec4 coord = vec4(uv + o, float(c), q.z);
+            lit += min(textureGrad(uStaticShadow, coord, vec2(0.0), vec2(0.0)),
+                       textureGrad(uDynamicShadow, coord, vec2(0.0), vec2(0.0)));
+        }
+        return lit * 0.25;
+    }
+    return 1.0;
+}
+
+void main()
+{
+    vec3 n = normalize(vNormal);
+
+    // Unconditional samples: implicit derivatives need uniform control flow.
+    vec3 base = texture(uLayers[0], vWorldXZ * cam.layerScale.x).rgb * vSplat.x
+              + texture(uLayers[1], vWorldXZ * cam.layerScale.y).rgb * vSplat.y
+              + texture(uLayers[2], vWorldXZ * cam.layerScale.z).rgb * vSplat.z
+              + texture(uLayers[3], vWorldXZ * cam.layerScale.w).rgb * vSplat.w;
+
+    vec3 lightDir = shadow.lightDir.xyz;
+    float ndotl = clamp(dot(n, lightDir), 0.0, 1.0);
+    float sun = ndotl > 0.0 ? shadowFactor(vWorldPos, n) : 0.0;
+    vec3 ambient = vec3(0.2);
+    vec3 lit = ambient + ndotl * sun * vec3(0.8);
+
+    outColor = vec4(base * lit, 1.0);
+}
@@ -0,0 +1,92 @@
+#version 450
+
+// TerrainRenderPassModule: one instanced draw of the patch grid, one instance per selected node.
+layout(location = 0) in vec2 inGrid; // integer grid coordinate, 0..32
+
+layout(set = 0, binding = 0) uniform CameraUBO {
+    mat4 view;
+    mat4 proj;
+    vec4 cameraPos;
+    vec4 layerScale; // per layer: 1 / meters per repeat
+} cam;
+
+struct Node
+{
+    vec4 node;  // xy=origin (x, z), z=size, w=lod
+    vec4 tile;  // xy=tile origin, z=1/tile size, w=cache layer
+    vec4 morph; // x=start, y=end distance
+};
+
+layout(set = 0, binding = 1, std430) readonly buffer Nodes
+{
+    Node nodes[];
+} sel;
+
+// Tile cache: 35x35 texels per layer, the 33x33 patch vertices plus a 1-texel border.
+layout(set = 0, binding = 2) uniform sampler2DArray uHeightTiles;
+layout(set = 0, binding = 3) uniform sampler2DArray uSplatTiles;
+
+layout(location = 0) out vec3 vNormal;
+layout(location = 1) out vec2 vWorldXZ;
+layout(location = 2) out vec4 vSplat;
+layout(location = 3) out vec3 vWorldPos; // shadow lookup
+
+// Same depth in the depth prepass and colour pipelines (they test LESS_OR_EQUAL against it).
+invariant gl_Position;
+
+const float PATCH_QUADS = 32.0;
+
+// Texel coordinate of xz in the node's tile (fractional when the tile is an ancestor's).
+vec2 tileTexel(Node n, vec2 xz)
+{
+    return (xz - n.tile.xy) * n.tile.z * PATCH_QUADS + 1.0;
+}
+
+// Bilinear by hand: R32F is not guaranteed to be linearly filterable.
+vec4 fetchBilinear(sampler2DArray tex, vec2 t, int layer)
+{
+    vec2 f = clamp(t, vec2(0.0), vec2(33.999));
+    ivec2 i = ivec2(floor(f));
+    vec2 w = f - vec2(i);
+    vec4 a = texelFetch(tex, ivec3(i, layer), 0);
+    vec4 b = texelFetch(tex, ivec3(i + ivec2(1, 0), layer), 0);
+    vec4 c = texelFetch(tex, ivec3(i + ivec2(0, 1), layer), 0);
+    vec4 d = texelFetch(tex, ivec3(i + ivec2(1, 1), layer), 0);
+    return mix(mix(a, b, w.x), mix(c, d, w.x), w.y);
+}
+
+float heightAt(Node n, vec2 xz, int layer)
+{
+    return fetchBilinear(uHeightTiles, tileTexel(n, xz), layer).r;
+}
+
+void main()
+{
+    Node n = sel.nodes[gl_InstanceIndex];
+    int layer = int(n.tile.w + 0.5);
+    float spacing = n.node.z / PATCH_QUADS;
+
+    // Morph odd vertices onto the next coarser grid across the end of the node's LOD band.
+    vec2 xz = n.node.xy + inGrid * spacing;
+    float dist = distance(cam.cameraPos.xyz, vec3(xz.x, heightAt(n, xz, layer), xz.y));
+    float k = clamp((dist - n.morph.x) / max(n.morph.y - n.morph.x, 1e-3), 0.0, 1.0);
+    vec2 g = inGrid - fract(inGrid * 0.5) * 2.0 * k;
+    xz = n.node.xy + g * spacing;
+
+    float h = heightAt(n, xz, layer);
+
+    // Central differences one tile texel apart.
+    float d = 1.0 / (n.tile.z * PATCH_QUADS);
+    float hL = heightAt(n, xz - vec2(d, 0.0), layer);
+    float hR = heightAt(n, xz + vec2(d, 0.0), layer);
+    float hD = heightAt(n, xz - vec2(0.0, d), layer);
+    float hU = heightAt(n, xz + vec2(0.0, d), layer);
+    vNormal = normalize(vec3(hL - hR, 2.0 * d, hD - hU));
+
+    vec4 splat = fetchBilinear(uSplatTiles, tileTexel(n, xz), layer);
+    vSplat = splat / max(splat.x + splat.y + splat.z + splat.w, 1e-3);
+    vWorldXZ = xz;
+    vWorldPos = vec3(xz.x, h, xz.y);
+
+    gl_Position = cam.proj * cam.view * vec4(xz.x, h, xz.y, 1.0);
+}
@@ -0,0 +1,45 @@
+#version 450
+
+layout(location = 0) in vec2 vUv;
+
+// Full-size scene colour; the frame was rendered into its top-left render extent.
+layout(set = 0, binding = 0) uniform sampler2D uScene;
+
+layout(push_constant) uniform Push {
+    vec2 uvScale;    // render extent / scene image size
+    vec2 uvMax;      // centre of the last rendered texel: taps never read past the region
+    vec2 texel;      // 1 / scene image size
+    float sharpness; // 0 = plain bilinear .. 1 = strongest
+    float _pad;
+} pc;
+
+layout(location = 0) out vec4 outColor;
+
+vec3 tap(vec2 uv)
+{
+    return texture(uScene, clamp(uv, pc.texel * 0.5, pc.uvMax)).rgb;
+}
+
+void main()
+{
+    vec2 uv = vUv * pc.uvScale;
+    vec3 c = tap(uv);
+
+    if (pc.sharpness > 0.0)
+    {
+        // Contrast-adaptive sharpening (FSR1 RCAS / CAS style): a negative-lobe cross filter
+        // whose weight shrinks where the neighbourhood is already close to clipping.
+        vec3 n = tap(uv - vec2(0.0, pc.texel.y));
+        vec3 s = tap(uv + vec2(0.0, pc.texel.y));
+        vec3 w = tap(uv - vec2(pc.texel.x, 0.0));
+        vec3 e = tap(uv + vec2(pc.texel.x, 0.0));
+
+        vec3 mn = min(c, min(min(n, s), min(w, e)));
+        vec3 mx = max(c, max(max(n, s), max(w, e)));
+        vec3 amp = sqrt(clamp(min(mn, 1.0 - mx) / max(mx, vec3(1e-4)), 0.0, 1.0));
+        vec3 lobe = amp * (-1.0 / mix(8.0, 5.0, pc.sharpness));
+        c = clamp((c + (n + s + w + e) * lobe) / (1.0 + 4.0 * lobe), 0.0, 1.0);
+    }
+
+    outColor = vec4(c, 1.0);
+}
@@ -0,0 +1,132 @@
+#include "utils/AllocationCounter.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
+#include <cstdio>
+#endif
+
+namespace Engine::AllocationCounter
+{
+    namespace
+    {
+        std::atomic<uint64_t> g_total{0};
+        thread_local uint64_t t_count = 0;
+    } // namespace
+
+    namespace detail
+    {
+        inline void count()
+        {
+            g_total.fetch_add(1u, std::memory_order_relaxed);
+            ++t_count;
+        }
+    } // namespace detail
+
+    uint64_t total() { return g_total.load(std::memory_order_relaxed); }
+    uint64_t thisThread() { return t_count; }
+
+    ScopedNoAllocation::~ScopedNoAllocation()
+    {
+        const uint64_t n = allocations();
+#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
+        if (n > 0u)
+            std::fprintf(stderr, "[AllocationCounter] %s made %llu heap allocation(s)\n",
+                         m_what ? m_what : "(scope)", static_cast<unsigned long long>(n));
+#endif
+        assert(n == 0u && "heap allocation inside a ScopedNoAllocation region");
+        (void)n;
+    }
+} // namespace Engine::AllocationCounter
+
+#if ENGINE_COUNT_ALLOCATIONS
+
+namespace
+{
+    void *allocOrNull(std::size_t size)
+    {
+        Engine::AllocationCounter::detail::count();
+        return std::malloc(size ? size : 1u);
+    }
+
+    void *allocOrThrow(std::size_t size)
+    {
+        for (;;)
+        {
+            if (void *p = allocOrNull(size))
+                return p;
+            std::new_handler handler = std::get_new_handler();
+            if (!handler)
+                throw std::bad_alloc();
+            handler();
+        }
+    }
+
+    void *alignedAllocOrNull(std::size_t size, std::size_t align)
+    {
+        Engine::AllocationCounter::detail::count();
+        if (size == 0u)
+            size = 1u;
+#ifdef _WIN32
+        return _aligned_malloc(size, align);
+#else
+        void *p = nullptr;
+        return posix_memalign(&p, align < sizeof(void *) ? sizeof(void *) : align, size) == 0 ? p : nullptr;
+#endif
+    }
+
+    void *alignedAllocOrThrow(std::size_t size, std::size_t align)
+    {
+        for (;;)
+        {
+            if (void *p = alignedAllocOrNull(size, align))
+                return p;
+            std::new_handler handler = std::get_new_handler();
+            if (!handler)
+                throw std::bad_alloc();
+            handler();
+        }
+    }
+
+    void alignedFree(void *p)
+    {
+#ifdef _WIN32
+        _aligned_free(p);
+#else
+        std::free(p);
+#endif
+    }
+} // namespace
+
+void *operator new(std::size_t size) { return allocOrThrow(size); }
+void *operator new[](std::size_t size) { return allocOrThrow(size); }
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept { return allocOrNull(size); }
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept { return allocOrNull(size); }
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+void operator delete(void *p, const std::nothrow_t &) noexcept { std::free(p); }
+void operator delete[](void *p, const std::nothrow_t &) noexcept { std::free(p); }
+
+void *operator new(std::size_t size, std::align_val_t align) { return alignedAllocOrThrow(size, static_cast<std::size_t>(align)); }
+void *operator new[](std::size_t size, std::align_val_t align) { return alignedAllocOrThrow(size, static_cast<std::size_t>(align)); }
+void *operator new(std::size_t size, std::align_val_t align, const std::nothrow_t &) noexcept { return alignedAllocOrNull(size, static_cast<std::size_t>(align)); }
+void *operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t &) noexcept { return alignedAllocOrNull(size, static_cast<std::size_t>(align)); }
+
+void operator delete(void *p, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete[](void *p, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete(void *p, std::align_val_t, const std::nothrow_t &) noexcept { alignedFree(p); }
+void operator delete[](void *p, std::align_val_t, const std::nothrow_t &) noexcept { alignedFree(p); }
+
+#endif // ENGINE_COUNT_ALLOCATIONS
@@ -1,19 +1,26 @@
 #include "Engine/Application.h"
 #include "Engine/Window.h"
 #include "Engine/VulkanContext.h"
+#include "Engine/BindlessMaterials.h"
 #include "Engine/Renderer.h"
 #include "Engine/SwapChain.h"
 #include "Engine/ImGuiLayer.h"
 #include "Engine/PerformanceMonitor.h"
+#include "Engine/Pipeline.h"
 #include "ECS/ECSContext.h"
 #include "Engine/ImGuiLayer.h"
+#include "utils/FrameArena.h"
 #include "utils/JobSystem.h"
+#include "utils/Profiler.h"
 #include <iostream>
 #include <chrono>
 #include <algorithm>
 
 namespace Engine
 {
+    // Upper bound of main-thread continuations (e.g. GPU uploads of assets loaded in the
+    // background) finished per frame, so a burst of completed loads is spread over frames.
+    static constexpr uint32_t MAIN_THREAD_JOBS_PER_FRAME = 4;
 
     struct Application::Impl
     {
@@ -23,14 +30,35 @@ namespace Engine
         std::unique_ptr<ImGuiLayer> imguiLayer;
         std::unique_ptr<PerformanceMonitor> perfMonitor;
         bool running = true;
+        bool closeRequested = false;
+        bool pipelinedSimulation = false;
         EventCallbackFn eventCallback;
         std::unique_ptr<ECS::ECSContext> ecs;
         std::unique_ptr<JobSystem> jobSystem;
+        std::vector<JobHandle> startupJobs;
     };
 
     Application::Application()
+        : Application(std::vector<StartupJob>{})
+    {
+    }
+
+    Application::Application(std::vector<StartupJob> startupJobs)
         : m_Impl(std::make_unique<Impl>())
     {
+        // Loop workers on the performance cores, streaming on the efficiency cores (if any).
+        // Created first so file reads run while the window and device come up on this thread.
+        m_Impl->jobSystem = std::make_unique<JobSystem>(JobSystem::Config{});
+
+        // SPIR-V for every pass the Renderer and the app create below.
+        m_Impl->startupJobs.push_back(m_Impl->jobSystem->submit([]()
+                                                                { (void)Pipeline::preloadShaderFiles("shaders"); }));
+        for (StartupJob &job : startupJobs)
+        {
+            if (job)
+                m_Impl->startupJobs.push_back(m_Impl->jobSystem->submit(std::move(job)));
+        }
+
         // Create window (platform-specific implementation returns a concrete Window)
         m_Impl->window = Window::Create({"Engine Window", 1280, 720});
 
@@ -38,7 +66,8 @@ namespace Engine
                                          { this->handleWindowEvent(e); });
 
         // Create Vulkan context (owns instance, surface creation using the window handle)
-        m_Impl->vkContext = std::make_unique<VulkanContext>(*m_Impl->window);
+        m_Impl->vkContext = std::make_unique<VulkanContext>(*m_Impl->window, m_Impl->jobSystem.get());
+        // 4 frame slots; 2 are cycled by default (Renderer::setFramesInFlight).
         m_Impl->renderer = std::make_unique<Renderer>(m_Impl->vkContext.get(), m_Impl->vkContext->GetSwapChain(), 4);
 
         // Initialize renderer now that swapchain exists
@@ -53,6 +82,9 @@ namespace Engine
         // Initialize performance monitor
         m_Impl->perfMonitor = std::make_unique<PerformanceMonitor>();
         m_Impl->perfMonitor->init(m_Impl->vkContext.get(), m_Impl->renderer.get(), m_Impl->window.get());
+        if (BindlessMaterials *bindless = m_Impl->vkContext->GetBindlessMaterials())
+            m_Impl->perfMonitor->addMemoryProvider([bindless](MemoryReport &out)
+                                                   { bindless->reportMemory(out); });
 
         // Set up ImGui render callback to render performance overlay
         m_Impl->imguiLayer->setRenderCallback([this]()
@@ -69,19 +101,32 @@ namespace Engine
             } });
 
         m_Impl->ecs = std::make_unique<ECS::ECSContext>();
-
-        const uint32_t hw = std::max(1u, std::thread::hardware_concurrency());
-        const uint32_t workerThreads = (hw > 1u) ? (hw - 1u) : 0u;
-        m_Impl->jobSystem = std::make_unique<JobSystem>(workerThreads);
         m_Impl->ecs->SetJobSystem(m_Impl->jobSystem.get());
 
+        // Record render passes into secondary command buffers on the workers.
+        m_Impl->renderer->setJobSystem(m_Impl->jobSystem.get());
+        m_Impl->renderer->setParallelRecording(true);
+
         if (m_Impl->perfMonitor)
         {
             m_Impl->perfMonitor->setEcsContext(m_Impl->ecs.get());
+            m_Impl->perfMonitor->setJobSystem(m_Impl->jobSystem.get());
         }
     }
 
-    Application::~Application() = default;
+    Application::~Application()
+    {
+        // A derived ctor that threw may not have waited; the jobs write into its shared state.
+        if (m_Impl && m_Impl->jobSystem)
+            WaitForStartupJobs();
+    }
+
+    void Application::WaitForStartupJobs()
+    {
+        for (const JobHandle &job : m_Impl->startupJobs)
+            m_Impl->jobSystem->wait(job);
+        m_Impl->startupJobs.clear();
+    }
 
     void Application::SetPerformanceMonitorEnabled(bool enabled)
     {
@@ -103,6 +148,16 @@ namespace Engine
         }
     }
 
+    void Application::SetPipelinedSimulation(bool enabled)
+    {
+        m_Impl->pipelinedSimulation = enabled;
+    }
+
+    bool Application::IsPipelinedSimulation() const
+    {
+        return m_Impl->pipelinedSimulation;
+    }
+
     void Application::TogglePerformanceMonitorOverlay()
     {
         if (!m_Impl || !m_Impl->perfMonitor)
@@ -110,11 +165,34 @@ namespace Engine
         m_Impl->perfMonitor->toggle();
     }
 
+    void Application::AddMemoryProvider(std::function<void(MemoryReport &)> provider)
+    {
+        if (!m_Impl || !m_Impl->perfMonitor)
+            return;
+        m_Impl->perfMonitor->addMemoryProvider(std::move(provider));
+    }
+
+    bool Application::EnableTelemetry(const TelemetryConfig &config)
+    {
+        if (!m_Impl || !m_Impl->perfMonitor)
+            return false;
+        return m_Impl->perfMonitor->enableTelemetry(config);
+    }
+
+    void Application::AddTelemetryScheduler(const ECS::SystemScheduler *scheduler, const std::string &label)
+    {
+        if (!m_Impl || !m_Impl->perfMonitor)
+            return;
+        m_Impl->perfMonitor->addTelemetryScheduler(scheduler, label);
+    }
+
     void Application::Run()
     {
+        Profiler::setThreadName("Main");
         auto lastFrameTime = std::chrono::steady_clock::now();
         while (m_Impl->running)
         {
+            ENGINE_PROFILE_FRAME();
             const auto now = std::chrono::steady_clock::now();
             const float deltaSeconds = std::chrono::duration<float>(now - lastFrameTime).count();
             lastFrameTime = now;
@@ -125,14 +203,25 @@ namespace Engine
                 m_Impl->perfMonitor->beginFrame();
             }
 
+            // Low-latency mode: let the GPU drain before sampling this frame's input.
+            m_Impl->renderer->waitForLatency();
+
             // Poll window events
             m_Impl->window->OnUpdate();
+            if (m_Impl->closeRequested)
+            {
+                m_Impl->closeRequested = false;
+                Close();
+            }
 
             // If a window event requested shutdown (Escape/WindowClose), stop cleanly
             // before running any further update/render work for this frame.
             if (!m_Impl->running)
                 break;
 
+            // Finish async work that must run on this thread.
+            m_Impl->jobSystem->runMainThreadJobs(MAIN_THREAD_JOBS_PER_FRAME);
+
             // Begin ImGui frame
             if (m_Impl->imguiLayer && m_Impl->imguiLayer->isInitialized())
             {
@@ -142,8 +231,14 @@ namespace Engine
             // User update/render hooks
             TimeStep ts{};
             ts.DeltaSeconds = deltaSeconds;
-            OnUpdate(ts);
-            OnRender();
+            {
+                ENGINE_PROFILE_ZONE("Application::OnUpdate");
+                OnUpdate(ts);
+            }
+            {
+                ENGINE_PROFILE_ZONE("Application::OnRender");
+                OnRender();
+            }
 
             // End ImGui frame (this also calls the render callback)
             if (m_Impl->imguiLayer && m_Impl->imguiLayer->isInitialized())
@@ -151,8 +246,30 @@ namespace Engine
                 m_Impl->imguiLayer->endFrame();
             }
 
-            // Draw one frame (includes ImGui rendering)
+            // Draw one frame (includes ImGui rendering) and simulate the next one. The render
+            // passes only read what OnUpdate/OnRender gave them, so the two can overlap.
+            JobHandle simulation;
+            if (m_Impl->pipelinedSimulation && m_Impl->jobSystem->workerCount() > 0)
+                simulation = m_Impl->jobSystem->submit([this, ts]()
+                                                       {
+                                                           ENGINE_PROFILE_ZONE("Application::OnSimulate");
+                                                           OnSimulate(ts); },
+                                                       JobPriority::High);
             m_Impl->renderer->drawFrame();
+            if (simulation.valid())
+            {
+                ENGINE_PROFILE_ZONE("Application::waitSimulation");
+                m_Impl->jobSystem->wait(simulation);
+            }
+            else
+            {
+                ENGINE_PROFILE_ZONE("Application::OnSimulate");
+                OnSimulate(ts);
+            }
+
+            // Both this frame's draw data and the next frame's simulation are done with their
+            // frame arena scratch.
+            FrameArena::endFrame();
 
             // End performance monitoring
             if (m_Impl->perfMonitor)
@@ -174,25 +291,38 @@ namespace Engine
         {
             Close();
         }
+        if (name == "F12Pressed")
+        {
+            // Last few frames of profiler zones, for chrome://tracing or ui.perfetto.dev.
+            const std::string path = "stratosphere_trace.json";
+            const bool ok = Profiler::writeChromeTrace(path);
+            // Hitch snapshots next to it (frames over 2x the median frame time).
+            const bool hitchesOk = !m_Impl->perfMonitor ||
+                                   (m_Impl->perfMonitor->exportHitchesJson("stratosphere_hitches.json") &&
+                                    m_Impl->perfMonitor->exportHitchesCsv("stratosphere_hitches.csv"));
+#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
+            std::cerr << "[Profiler] " << (ok ? "wrote " : "failed to write ") << path << "\n";
+            if (m_Impl->perfMonitor)
+                std::cerr << "[Profiler] " << (hitchesOk ? "wrote " : "failed to write ")
+                          << "stratosphere_hitches.json/.csv\n";
+#else
+            (void)ok;
+            (void)hitchesOk;
+#endif
+        }
         if (name == "WindowResize")
         {
             // Notify renderer that swapchain-dependent resources must be recreated
             if (m_Impl->renderer)
             {
-                // Cleanup ImGui before renderer cleanup
-                if (m_Impl->imguiLayer)
-                {
-                    m_Impl->imguiLayer->cleanup();
-                }
-
-                m_Impl->renderer->cleanup(); // Destroy renderer and all its resources
+                // Frames in flight keep the old targets; pipelines survive unless the format changed.
                 VkExtent2D new_extent = {m_Impl->window->GetWidth(), m_Impl->window->GetHeight()};
-                m_Impl->vkContext->GetSwapChain()->Recreate(new_extent);                // destroy the swapchain and recreate with new extents
-                m_Impl->renderer->init(m_Impl->vkContext->GetSwapChain()->GetExtent()); // Re-initialize renderer resources
+                const bool renderPassRebuilt = m_Impl->renderer->resize(new_extent);
 
                 // Reinitialize ImGui with new render pass
-                if (m_Impl->imguiLayer)
+                if (renderPassRebuilt && m_Impl->imguiLayer)
                 {
+                    m_Impl->imguiLayer->cleanup();
                     uint32_t imageCount = static_cast<uint32_t>(m_Impl->vkContext->GetSwapChain()->GetImageViews().size());
                     m_Impl->imguiLayer->init(*m_Impl->vkContext, *m_Impl->window,
                                              m_Impl->renderer->getMainRenderPass(), imageCount);
@@ -230,6 +360,11 @@ namespace Engine
         return m_Impl->imguiLayer.get();
     }
 
+    void Application::RequestClose()
+    {
+        m_Impl->closeRequested = true;
+    }
+
     void Application::Close()
     {
         // Signal loop exit first
@@ -1,5 +1,10 @@
 #include "assets/AssetManager.h"
+#include "assets/AssetPack.h"
+#include "assets/MeshOptimizer.h"
+#include "utils/DeviceMemoryBudget.h"
+#include "utils/GpuAllocator.h"
 #include "utils/ImageUtils.h" // UploadContext
+#include "utils/Profiler.h"
 
 // Needed for glm/gtx/* headers (matrix_decompose)
 #define GLM_ENABLE_EXPERIMENTAL
@@ -10,10 +15,13 @@
 #include <utility>
 #include <cstring>
 #include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <unordered_set>
 #include <functional>
 #include <iostream>
 
+#include <filesystem>
 #include <fstream>
 #include <iterator>
 
@@ -61,6 +69,52 @@ namespace Engine
         }
     }
 
+    // Block-compressed encodings -> VkFormat (VK_FORMAT_UNDEFINED for PNG/JPG)
+    static VkFormat toVkCompressedFormat(uint32_t encoding, bool srgb)
+    {
+        switch (static_cast<Engine::smodel::ImageEncoding>(encoding))
+        {
+        case Engine::smodel::ImageEncoding::BC7:
+            return srgb ? VK_FORMAT_BC7_SRGB_BLOCK : VK_FORMAT_BC7_UNORM_BLOCK;
+        case Engine::smodel::ImageEncoding::ASTC4x4:
+            return srgb ? VK_FORMAT_ASTC_4x4_SRGB_BLOCK : VK_FORMAT_ASTC_4x4_UNORM_BLOCK;
+        default:
+            return VK_FORMAT_UNDEFINED;
+        }
+    }
+
+    // .smodel texture record pixels -> RGBA8 (RAW rows are copied, PNG/JPG decoded).
+    static bool decodeModelTexture(const Engine::smodel::SModelTextureRecord &t, const uint8_t *bytes, size_t sizeBytes,
+                                   std::vector<uint8_t> &rgba, uint32_t &width, uint32_t &height)
+    {
+        if (t.encoding == static_cast<uint32_t>(Engine::smodel::ImageEncoding::RAW))
+        {
+            width = t.width;
+            height = t.height;
+            rgba.assign(bytes, bytes + static_cast<size_t>(width) * height * 4u);
+            return true;
+        }
+        return TextureAsset::decodeImageRGBA8(bytes, sizeBytes, rgba, width, height);
+    }
+
+    // Heap bytes of a model's CPU-side data (node graph, skins, animation and LOD tables).
+    static uint64_t ModelCpuBytes(const ModelAsset &m)
+    {
+        uint64_t bytes = MemoryReport::bytesOf(m.primitives) + MemoryReport::bytesOf(m.nodes) +
+                         MemoryReport::bytesOf(m.nodePrimitiveIndices) + MemoryReport::bytesOf(m.nodeChildIndices) +
+                         MemoryReport::bytesOf(m.evalOrder) + MemoryReport::bytesOf(m.evalParents) +
+                         MemoryReport::bytesOf(m.skins) + MemoryReport::bytesOf(m.restTRS) +
+                         MemoryReport::bytesOf(m.animatedTRS) + MemoryReport::bytesOf(m.animClips) +
+                         MemoryReport::bytesOf(m.animChannels) + MemoryReport::bytesOf(m.animSamplers) +
+                         MemoryReport::bytesOf(m.animTimes) + MemoryReport::bytesOf(m.animValues) +
+                         MemoryReport::bytesOf(m.bakedClips) + MemoryReport::bytesOf(m.bakedFrames) +
+                         MemoryReport::bytesOf(m.quantizedClips) + MemoryReport::bytesOf(m.quantizedTracks) +
+                         MemoryReport::bytesOf(m.quantizedData) + MemoryReport::bytesOf(m.lodScreenSizes);
+        for (const ModelAsset::ModelSkin &skin : m.skins)
+            bytes += MemoryReport::bytesOf(skin.jointNodeIndices) + MemoryReport::bytesOf(skin.inverseBind);
+        return bytes;
+    }
+
     static VkSamplerMipmapMode toVkMip(uint32_t m)
     {
         // 0=None,1=Nearest,2=Linear
@@ -88,10 +142,21 @@ namespace Engine
           m_graphicsQueue(graphicsQueue),
           m_graphicsQueueFamilyIndex(graphicsQueueFamilyIndex)
     {
+        m_hasMemoryBudget = HasMemoryBudgetExtension(phys);
     }
 
     AssetManager::~AssetManager()
     {
+        // Flush an unbalanced batch so nothing below is still referenced by recorded commands.
+        if (m_uploadBatch)
+        {
+            m_uploadBatchDepth = 1;
+            endUploadBatch();
+        }
+
+        // The owner waited for the device before destroying us.
+        flushDeferredDestroys();
+
         // Destroy meshes
         for (auto &kv : m_meshes)
         {
@@ -106,7 +171,18 @@ namespace Engine
                 kv.second.asset->destroy(m_device);
         }
 
+        m_stagingRing.destroy();
+
+        if (m_uploadPool != VK_NULL_HANDLE)
+            vkDestroyCommandPool(m_device, m_uploadPool, nullptr);
+        if (m_transferPool != VK_NULL_HANDLE)
+            vkDestroyCommandPool(m_device, m_transferPool, nullptr);
+
         // Materials + Models are CPU only (no gpu destroy needed)
+        m_meshSlots.clear();
+        m_textureSlots.clear();
+        m_materialSlots.clear();
+        m_modelSlots.clear();
         m_meshes.clear();
         m_textures.clear();
         m_materials.clear();
@@ -121,6 +197,7 @@ namespace Engine
     // ------------------------------------------------------------
     MeshHandle AssetManager::loadMesh(const std::string &cookedMeshPath)
     {
+        ENGINE_PROFILE_ZONE("AssetManager::loadMesh");
         auto it = m_meshPathCache.find(cookedMeshPath);
         if (it != m_meshPathCache.end())
         {
@@ -132,21 +209,16 @@ namespace Engine
         if (!LoadSMeshV0FromFile(cookedMeshPath, data))
             return MeshHandle{};
 
-        MeshHandle h = createMeshFromData_Internal(data, cookedMeshPath, 1);
+        MeshHandle h = createMeshFromData_Internal(makeMeshDataView(data), cookedMeshPath, 1);
         if (h.isValid())
             m_meshPathCache.emplace(cookedMeshPath, h);
 
         return h;
     }
 
-    MeshAsset *AssetManager::getMesh(MeshHandle h)
+    MeshAsset *AssetManager::getMesh(MeshHandle h) const
     {
-        auto it = m_meshes.find(h.id);
-        if (it == m_meshes.end())
-            return nullptr;
-        if (it->second.generation != h.generation)
-            return nullptr;
-        return it->second.asset.get();
+        return m_meshSlots.resolve(h);
     }
 
     void AssetManager::addRef(MeshHandle h)
@@ -161,110 +233,453 @@ namespace Engine
         auto it = m_meshes.find(h.id);
         if (it != m_meshes.end() && it->second.generation == h.generation)
         {
-            if (it->second.refCount > 0)
-                it->second.refCount--;
+            if (it->second.refCount > 0 && --it->second.refCount == 0)
+                m_gcMeshes.push_back(h.id);
         }
     }
 
-    MeshHandle AssetManager::createMeshFromData_Internal(const MeshData &data, const std::string &path, uint32_t initialRef)
+    MeshHandle AssetManager::createMeshFromData_Internal(const MeshDataView &data, const std::string &path, uint32_t initialRef)
     {
-        // Transient pool per mesh upload
-        VkCommandPoolCreateInfo poolInfo{};
-        poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-        poolInfo.queueFamilyIndex = m_graphicsQueueFamilyIndex;
-        poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
-
-        VkCommandPool uploadPool = VK_NULL_HANDLE;
-        VkResult pr = vkCreateCommandPool(m_device, &poolInfo, nullptr, &uploadPool);
-        if (pr != VK_SUCCESS)
+        Engine::UploadContext local{};
+        Engine::UploadContext *upload = beginUpload_Internal(local);
+        if (!upload)
             return MeshHandle{};
 
         auto asset = std::make_unique<MeshAsset>();
-        const bool ok = asset->upload(m_device, m_phys, uploadPool, m_graphicsQueue, data);
-
-        vkDestroyCommandPool(m_device, uploadPool, nullptr);
+        bool ok = asset->uploadDeferred(*upload, data);
+        ok = endUpload_Internal(*upload) && ok;
 
         if (!ok)
+        {
+            discardMesh_Internal(std::move(asset));
             return MeshHandle{};
+        }
 
-        const uint64_t id = m_nextMeshID++;
+        return registerMesh_Internal(std::move(asset), path, initialRef);
+    }
+
+    MeshHandle AssetManager::registerMesh_Internal(std::unique_ptr<MeshAsset> asset, const std::string &path, uint32_t initialRef)
+    {
+        const auto key = m_meshSlots.create(asset.get(), AssetState::Ready);
+        if (key.id == 0)
+        {
+            discardMesh_Internal(std::move(asset));
+            return MeshHandle{};
+        }
+        const uint64_t id = key.id;
         MeshEntry entry;
         entry.asset = std::move(asset);
-        entry.generation = 1;
+        entry.generation = key.generation;
         entry.refCount = initialRef;
         entry.path = path;
 
         m_meshes.emplace(id, std::move(entry));
+        if (initialRef == 0)
+            m_gcMeshes.push_back(id); // collected by a later gc step unless addRef'd first
 
         MeshHandle h;
         h.id = id;
-        h.generation = 1;
+        h.generation = key.generation;
         return h;
     }
 
+    void AssetManager::setTransferQueue(VkQueue transferQueue, uint32_t transferQueueFamilyIndex)
+    {
+        if (transferQueueFamilyIndex == m_graphicsQueueFamilyIndex)
+            transferQueue = VK_NULL_HANDLE;
+        if (transferQueue == m_transferQueue && transferQueueFamilyIndex == m_transferQueueFamilyIndex)
+            return;
+
+        // The ring's sharing mode and the pool's family follow the queue: both are recreated on
+        // the next upload (the ring waits for its in-flight regions).
+        m_stagingRing.destroy();
+        m_stagingRingFailed = false;
+        if (m_transferPool != VK_NULL_HANDLE)
+            vkDestroyCommandPool(m_device, m_transferPool, nullptr);
+        m_transferPool = VK_NULL_HANDLE;
+
+        m_transferQueue = transferQueue;
+        m_transferQueueFamilyIndex = transferQueueFamilyIndex;
+    }
+
+    StagingRing *AssetManager::stagingRing_Internal()
+    {
+        // Created on first upload; a failed creation just means dedicated staging buffers.
+        // Ring copies are read by the transfer queue when there is one.
+        if (!m_stagingRing.valid() && !m_stagingRingFailed)
+        {
+            const uint32_t families[2] = {m_graphicsQueueFamilyIndex, m_transferQueueFamilyIndex};
+            const uint32_t familyCount = (m_transferQueue != VK_NULL_HANDLE) ? 2u : 0u;
+            m_stagingRingFailed = (m_stagingRing.create(m_device, m_phys, STAGING_RING_BYTES, familyCount, families) != VK_SUCCESS);
+        }
+        return m_stagingRing.valid() ? &m_stagingRing : nullptr;
+    }
+
+    Engine::UploadContext *AssetManager::beginUpload_Internal(Engine::UploadContext &local)
+    {
+        if (m_uploadBatch)
+            return m_uploadBatch.get();
+
+        if (m_uploadPool == VK_NULL_HANDLE)
+        {
+            VkCommandPoolCreateInfo poolInfo{};
+            poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+            poolInfo.queueFamilyIndex = m_graphicsQueueFamilyIndex;
+            poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+            if (vkCreateCommandPool(m_device, &poolInfo, nullptr, &m_uploadPool) != VK_SUCCESS)
+            {
+                m_uploadPool = VK_NULL_HANDLE;
+                return nullptr;
+            }
+        }
+
+        if (!Engine::BeginUploadContext(local, m_device, m_phys, m_uploadPool, m_graphicsQueue))
+            return nullptr;
+        local.ring = stagingRing_Internal();
+
+        // A failed pool or command buffer just keeps the copies on the graphics queue.
+        if (m_transferQueue != VK_NULL_HANDLE && m_transferPool == VK_NULL_HANDLE)
+        {
+            VkCommandPoolCreateInfo poolInfo{};
+            poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+            poolInfo.queueFamilyIndex = m_transferQueueFamilyIndex;
+            poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+            if (vkCreateCommandPool(m_device, &poolInfo, nullptr, &m_transferPool) != VK_SUCCESS)
+            {
+                m_transferPool = VK_NULL_HANDLE;
+                m_transferQueue = VK_NULL_HANDLE;
+            }
+        }
+        if (m_transferPool != VK_NULL_HANDLE)
+            Engine::UseTransferQueue(local, m_transferPool, m_transferQueue, m_transferQueueFamilyIndex, m_graphicsQueueFamilyIndex);
+        return &local;
+    }
+
+    bool AssetManager::endUpload_Internal(Engine::UploadContext &ctx)
+    {
+        if (&ctx == m_uploadBatch.get())
+            return true;
+        return Engine::EndSubmitAndWait(ctx);
+    }
+
+    void AssetManager::discardTexture_Internal(std::unique_ptr<TextureAsset> tex)
+    {
+        if (!tex)
+            return;
+        if (m_uploadBatch)
+            m_batchDiscardedTextures.push_back(std::move(tex));
+        else
+            tex->destroy(m_device);
+    }
+
+    void AssetManager::discardMesh_Internal(std::unique_ptr<MeshAsset> mesh)
+    {
+        if (!mesh)
+            return;
+        if (m_uploadBatch)
+            m_batchDiscardedMeshes.push_back(std::move(mesh));
+        else
+            mesh->destroy(m_device);
+    }
+
+    void AssetManager::beginUploadBatch()
+    {
+        if (m_uploadBatchDepth++ > 0)
+            return;
+
+        // If the batch cannot start, uploads simply submit one at a time.
+        auto batch = std::make_unique<Engine::UploadContext>();
+        if (beginUpload_Internal(*batch) == batch.get())
+            m_uploadBatch = std::move(batch);
+    }
+
+    bool AssetManager::endUploadBatch()
+    {
+        if (m_uploadBatchDepth == 0)
+            return false;
+        if (--m_uploadBatchDepth > 0)
+            return true;
+
+        bool ok = true;
+        if (m_uploadBatch)
+        {
+            ok = Engine::EndSubmitAndWait(*m_uploadBatch);
+            m_uploadBatch.reset();
+        }
+
+        for (auto &t : m_batchDiscardedTextures)
+            t->destroy(m_device);
+        for (auto &m : m_batchDiscardedMeshes)
+            m->destroy(m_device);
+        m_batchDiscardedTextures.clear();
+        m_batchDiscardedMeshes.clear();
+        return ok;
+    }
+
     // ------------------------------------------------------------
     // Texture API
     // ------------------------------------------------------------
     TextureHandle AssetManager::createTexture_Internal(std::unique_ptr<TextureAsset> tex, uint32_t initialRef)
     {
-        const uint64_t id = m_nextTextureID++;
+        const auto key = m_textureSlots.create(tex.get(), AssetState::Ready);
+        if (key.id == 0)
+        {
+            retireTexture_Internal(std::move(tex));
+            return TextureHandle{};
+        }
+        const uint64_t id = key.id;
         TextureEntry e;
         e.asset = std::move(tex);
-        e.generation = 1;
+        e.generation = key.generation;
         e.refCount = initialRef;
 
         m_textures.emplace(id, std::move(e));
+        if (initialRef == 0)
+            m_gcTextures.push_back(id);
 
         TextureHandle h;
         h.id = id;
-        h.generation = 1;
+        h.generation = key.generation;
         return h;
     }
 
-    TextureAsset *AssetManager::getTexture(TextureHandle h)
+    TextureAsset *AssetManager::getTexture(TextureHandle h) const
     {
-        auto it = m_textures.find(h.id);
-        if (it == m_textures.end())
-            return nullptr;
-        if (it->second.generation != h.generation)
+        return m_textureSlots.resolve(h);
+    }
+
+    // ------------------------------------------------------------
+    // Asset packs
+    // ------------------------------------------------------------
+    bool AssetManager::mountPack(const std::string &packPath)
+    {
+        auto pack = std::make_shared<AssetPack>();
+        std::string err;
+        if (!pack->open(packPath, err))
+        {
+#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
+            std::cerr << "[AssetManager] mountPack: " << err << "\n";
+#endif
+            return false;
+        }
+
+        auto packs = m_packs ? std::make_shared<AssetPackList>(*m_packs) : std::make_shared<AssetPackList>();
+        packs->push_back(std::move(pack));
+        m_packs = std::move(packs);
+        return true;
+    }
+
+    // Newest mounted pack holding 'path' (nullptr: load from the file system).
+    static const std::shared_ptr<const AssetPack> *FindPacked(const AssetPackList *packs, const std::string &path,
+                                                             const PackEntryRecord *&outEntry)
+    {
+        if (!packs)
             return nullptr;
-        return it->second.asset.get();
+        for (auto it = packs->rbegin(); it != packs->rend(); ++it)
+        {
+            if ((outEntry = (*it)->find(path)) != nullptr)
+                return &*it;
+        }
+        return nullptr;
     }
 
-    Engine::TextureHandle AssetManager::loadTextureFromFile(const std::string &filePath)
+    static bool LoadSModelSource(const AssetPackList *packs, const std::string &path,
+                                 Engine::smodel::SModelFileView &out, std::string &outError)
     {
-        // Read file contents into a vector<uint8_t>
-        std::ifstream file(filePath, std::ios::binary | std::ios::ate);
-        if (!file)
-            return TextureHandle{};
+        const PackEntryRecord *entry = nullptr;
+        const std::shared_ptr<const AssetPack> *pack = FindPacked(packs, path, entry);
+        if (!pack)
+            return Engine::smodel::LoadSModelFile(path, out, outError);
 
-        const std::streamsize size = file.tellg();
-        if (size <= 0)
-            return TextureHandle{};
+        // In place: the view keeps the pack (and its mapping) alive.
+        if (const uint8_t *bytes = (*pack)->data(*entry))
+            return Engine::smodel::LoadSModelMemory(bytes, static_cast<size_t>(entry->rawSize), *pack, out, outError);
 
-        file.seekg(0, std::ios::beg);
         std::vector<uint8_t> bytes;
-        bytes.resize(static_cast<size_t>(size));
-        if (!file.read(reinterpret_cast<char *>(bytes.data()), size))
-            return TextureHandle{};
+        if (!(*pack)->read(*entry, bytes))
+        {
+            outError = "Corrupt pack entry " + path + " in " + (*pack)->path();
+            return false;
+        }
+        return Engine::smodel::LoadSModelBytes(std::move(bytes), out, outError);
+    }
 
-        // Create upload pool for single texture (similar to loadModel)
-        VkCommandPoolCreateInfo poolInfo{};
-        poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-        poolInfo.queueFamilyIndex = m_graphicsQueueFamilyIndex;
-        poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    // Write time of the loose file behind 'path'; 0 when it is served from a pack or missing.
+    static int64_t SourceWriteTime(const AssetPackList *packs, const std::string &path)
+    {
+        const PackEntryRecord *entry = nullptr;
+        if (FindPacked(packs, path, entry))
+            return 0;
+        std::error_code ec;
+        const auto t = std::filesystem::last_write_time(path, ec);
+        return ec ? 0 : static_cast<int64_t>(t.time_since_epoch().count());
+    }
 
-        VkCommandPool uploadPool = VK_NULL_HANDLE;
-        VkResult pr = vkCreateCommandPool(m_device, &poolInfo, nullptr, &uploadPool);
-        if (pr != VK_SUCCESS)
-            return TextureHandle{};
+    // Whole file for decoding: in place from a pack's mapping when stored raw, else in 'storage'.
+    static bool ReadSourceBytes(const AssetPackList *packs, const std::string &path, std::vector<uint8_t> &storage,
+                                const uint8_t *&outData, size_t &outSize)
+    {
+        const PackEntryRecord *entry = nullptr;
+        if (const std::shared_ptr<const AssetPack> *pack = FindPacked(packs, path, entry))
+        {
+            outData = (*pack)->data(*entry);
+            outSize = static_cast<size_t>(entry->rawSize);
+            if (outData)
+                return outSize > 0;
+            if (!(*pack)->read(*entry, storage))
+                return false;
+        }
+        else
+        {
+            std::ifstream file(path, std::ios::binary | std::ios::ate);
+            if (!file)
+                return false;
+
+            const std::streamsize size = file.tellg();
+            if (size <= 0)
+                return false;
+
+            file.seekg(0, std::ios::beg);
+            storage.resize(static_cast<size_t>(size));
+            if (!file.read(reinterpret_cast<char *>(storage.data()), size))
+                return false;
+        }
+        outData = storage.data();
+        outSize = storage.size();
+        return outSize > 0;
+    }
+
+    // ------------------------------------------------------------
+    // CPU-side load results
+    // ------------------------------------------------------------
+    struct AssetManager::PreparedTexture
+    {
+        std::string path; // image file (prepareTexture_Internal only)
+        std::vector<uint8_t> rgba;
+        uint32_t width = 0;
+        uint32_t height = 0;
+
+        // Block-compressed model textures skip decoding: 'blocks' points into the model's blob.
+        // For RGBA8, mipLevels > 1 means rgba holds the CPU-built chain (buildMipChainRGBA8).
+        const uint8_t *blocks = nullptr;
+        size_t blockBytes = 0;
+        uint32_t mipLevels = 0;
+    };
+
+    struct AssetManager::PreparedModel
+    {
+        std::string path;
+        int64_t sourceWriteTime = 0;
+        Engine::smodel::SModelFileView view;
+
+        // Decoded pixels, one per view.textures[i]
+        std::vector<PreparedTexture> textures;
+
+        // VertexPNTTJW meshes packed to SModelPackedVertex; meshes already cooked packed
+        // (VTX_PACKED) are read from the blob and have no range here.
+        std::vector<Engine::smodel::SModelPackedVertex> packedVertices;
+        std::vector<uint64_t> packedFirst; // per mesh: first vertex in packedVertices, UINT64_MAX if none
 
-        Engine::UploadContext upload{};
-        if (!Engine::BeginUploadContext(upload, m_device, m_phys, uploadPool, m_graphicsQueue))
+        // Reordered index lists of packed meshes (MeshOptimizer), in the mesh's index type:
+        // levelOffsets[0] is the base list, then one per LOD record of the mesh in file order.
+        // Empty bytes: the blob's indices are used.
+        struct OptimizedIndices
         {
-            vkDestroyCommandPool(m_device, uploadPool, nullptr);
-            return TextureHandle{};
+            std::vector<uint8_t> bytes;
+            std::vector<size_t> levelOffsets;
+        };
+        std::vector<OptimizedIndices> optimizedIndices; // per mesh
+    };
+
+    struct AssetManager::TextureReload
+    {
+        Engine::smodel::SModelFileView view; // keeps the block data of .smodel textures mapped
+        PreparedTexture pixels;
+    };
+
+    // Cache/overdraw/fetch ordering for one packed mesh (its vertices are already a private copy).
+    static void OptimizePreparedMesh(const Engine::smodel::SModelFileView &view, uint32_t meshIndex,
+                                     Engine::smodel::SModelPackedVertex *vertices,
+                                     std::vector<uint8_t> &outBytes, std::vector<size_t> &outLevelOffsets)
+    {
+        const auto &mr = view.meshes[meshIndex];
+        const bool wide = (mr.indexType != uint32_t(Engine::smodel::IndexType::U16));
+
+        auto widen = [&](const uint8_t *src, uint32_t count, std::vector<uint32_t> &dst)
+        {
+            dst.resize(count);
+            if (wide)
+                std::memcpy(dst.data(), src, size_t(count) * sizeof(uint32_t));
+            else
+            {
+                for (uint32_t i = 0; i < count; ++i)
+                {
+                    uint16_t v;
+                    std::memcpy(&v, src + size_t(i) * sizeof(uint16_t), sizeof(v));
+                    dst[i] = v;
+                }
+            }
+        };
+
+        std::vector<std::vector<uint32_t>> lists(1);
+        widen(view.blob + mr.indexDataOffset, mr.indexCount, lists[0]);
+        for (uint32_t i = 0; view.meshLods && i < view.meshLods->lodCount; i++)
+        {
+            const auto &lr = view.meshLodRecords[i];
+            if (lr.meshIndex != meshIndex)
+                continue;
+            lists.emplace_back();
+            widen(view.blob + lr.indexDataOffset, lr.indexCount, lists.back());
+        }
+
+        Engine::OptimizeMesh(reinterpret_cast<uint8_t *>(vertices), mr.vertexCount, Engine::smodel::SMODEL_PACKED_VERTEX_STRIDE,
+                             lists.data(), lists.size());
+
+        const size_t indexSize = wide ? sizeof(uint32_t) : sizeof(uint16_t);
+        size_t total = 0;
+        for (const auto &l : lists)
+            total += l.size();
+        outBytes.resize(total * indexSize);
+        outLevelOffsets.clear();
+        size_t cursor = 0;
+        for (const auto &l : lists)
+        {
+            outLevelOffsets.push_back(cursor);
+            for (uint32_t idx : l)
+            {
+                if (wide)
+                    std::memcpy(&outBytes[cursor], &idx, sizeof(uint32_t));
+                else
+                {
+                    const uint16_t v = static_cast<uint16_t>(idx);
+                    std::memcpy(&outBytes[cursor], &v, sizeof(uint16_t));
+                }
+                cursor += indexSize;
+            }
         }
+    }
+
+    bool AssetManager::prepareTexture_Internal(const AssetPackList *packs, const std::string &filePath, PreparedTexture &out)
+    {
+        ENGINE_PROFILE_ZONE("AssetManager::prepareTexture");
+        out.path = filePath;
+
+        std::vector<uint8_t> storage;
+        const uint8_t *bytes = nullptr;
+        size_t size = 0;
+        if (!ReadSourceBytes(packs, filePath, storage, bytes, size))
+            return false;
+
+        return TextureAsset::decodeImageRGBA8(bytes, size, out.rgba, out.width, out.height);
+    }
+
+    Engine::TextureHandle AssetManager::finalizeTexture_Internal(const PreparedTexture &prepared)
+    {
+        ENGINE_PROFILE_ZONE("AssetManager::finalizeTexture");
+        Engine::UploadContext local{};
+        Engine::UploadContext *upload = beginUpload_Internal(local);
+        if (!upload)
+            return TextureHandle{};
 
         auto tex = std::make_unique<TextureAsset>();
 
@@ -277,37 +692,61 @@ namespace Engine
         const VkSamplerMipmapMode mipM = toVkMip(2); // Linear mipmap
         const float maxAnisotropy = 1.0f;
 
-        if (!tex->uploadEncodedImage_Deferred(
-                upload,
-                bytes.data(),
-                bytes.size(),
-                isSRGB,
-                wrapU,
-                wrapV,
-                minF,
-                magF,
-                mipM,
-                maxAnisotropy))
-        {
-            Engine::EndSubmitAndWait(upload);
-            vkDestroyCommandPool(m_device, uploadPool, nullptr);
-            return TextureHandle{};
-        }
-
-        // Submit and wait (similar to loadModel)
-        if (!Engine::EndSubmitAndWait(upload))
+        bool ok = tex->uploadRGBA8_Deferred(
+            *upload,
+            prepared.rgba.data(),
+            prepared.width,
+            prepared.height,
+            isSRGB,
+            wrapU,
+            wrapV,
+            minF,
+            magF,
+            mipM,
+            maxAnisotropy);
+
+        // Submit and wait, unless this is part of an upload batch
+        ok = endUpload_Internal(*upload) && ok;
+        if (!ok)
         {
-            vkDestroyCommandPool(m_device, uploadPool, nullptr);
+            discardTexture_Internal(std::move(tex));
             return TextureHandle{};
         }
 
-        vkDestroyCommandPool(m_device, uploadPool, nullptr);
-
         // Create a texture entry with refCount = 1 (caller gets an owned handle)
         TextureHandle th = createTexture_Internal(std::move(tex), 1);
+        m_textures[th.id].sourcePath = prepared.path;
         return th;
     }
 
+    Engine::TextureHandle AssetManager::loadTextureFromFile(const std::string &filePath)
+    {
+        PreparedTexture prepared;
+        if (!prepareTexture_Internal(m_packs.get(), filePath, prepared))
+            return TextureHandle{};
+        return finalizeTexture_Internal(prepared);
+    }
+
+    JobHandle AssetManager::loadTextureFromFileAsync(const std::string &filePath, JobSystem &jobs, std::function<void(TextureHandle)> onLoaded)
+    {
+        auto prepared = std::make_shared<PreparedTexture>();
+        auto ok = std::make_shared<bool>(false);
+
+        JobHandle read = jobs.submit([packs = m_packs, filePath, prepared, ok]()
+                                     { *ok = prepareTexture_Internal(packs.get(), filePath, *prepared); },
+                                     JobPriority::Background);
+
+        std::weak_ptr<int> alive = m_lifetimeToken;
+        return jobs.thenOnMainThread(read, [this, alive, prepared, ok, onLoaded = std::move(onLoaded)]()
+                                     {
+                                         if (alive.expired())
+                                             return;
+                                         const TextureHandle h = *ok ? finalizeTexture_Internal(*prepared) : TextureHandle{};
+                                         if (onLoaded)
+                                             onLoaded(h);
+                                     });
+    }
+
     void AssetManager::addRef(TextureHandle h)
     {
         auto it = m_textures.find(h.id);
@@ -320,8 +759,8 @@ namespace Engine
         auto it = m_textures.find(h.id);
         if (it != m_textures.end() && it->second.generation == h.generation)
         {
-            if (it->second.refCount > 0)
-                it->second.refCount--;
+            if (it->second.refCount > 0 && --it->second.refCount == 0)
+                m_gcTextures.push_back(h.id);
         }
     }
 
@@ -330,10 +769,13 @@ namespace Engine
     // ------------------------------------------------------------
     MaterialHandle AssetManager::createMaterial_Internal(std::unique_ptr<MaterialAsset> mat, uint32_t initialRef)
     {
-        const uint64_t id = m_nextMaterialID++;
+        const auto key = m_materialSlots.create(mat.get(), AssetState::Ready);
+        if (key.id == 0)
+            return MaterialHandle{};
+        const uint64_t id = key.id;
         MaterialEntry e;
         e.asset = std::move(mat);
-        e.generation = 1;
+        e.generation = key.generation;
         e.refCount = initialRef;
 
         // Gather dependency handles (textures)
@@ -352,21 +794,18 @@ namespace Engine
         }
 
         m_materials.emplace(id, std::move(e));
+        if (initialRef == 0)
+            m_gcMaterials.push_back(id);
 
         MaterialHandle h;
         h.id = id;
-        h.generation = 1;
+        h.generation = key.generation;
         return h;
     }
 
-    MaterialAsset *AssetManager::getMaterial(MaterialHandle h)
+    MaterialAsset *AssetManager::getMaterial(MaterialHandle h) const
     {
-        auto it = m_materials.find(h.id);
-        if (it == m_materials.end())
-            return nullptr;
-        if (it->second.generation != h.generation)
-            return nullptr;
-        return it->second.asset.get();
+        return m_materialSlots.resolve(h);
     }
 
     void AssetManager::addRef(MaterialHandle h)
@@ -381,8 +820,8 @@ namespace Engine
         auto it = m_materials.find(h.id);
         if (it != m_materials.end() && it->second.generation == h.generation)
         {
-            if (it->second.refCount > 0)
-                it->second.refCount--;
+            if (it->second.refCount > 0 && --it->second.refCount == 0)
+                m_gcMaterials.push_back(h.id);
         }
     }
 
@@ -391,64 +830,309 @@ namespace Engine
     // ------------------------------------------------------------
     ModelHandle AssetManager::createModel_Internal(std::unique_ptr<ModelAsset> model, const std::string &path, uint32_t initialRef)
     {
-        const uint64_t id = m_nextModelID++;
+        const auto key = m_modelSlots.create(model.get(), AssetState::Ready);
+        if (key.id == 0)
+            return ModelHandle{};
+        const uint64_t id = key.id;
         ModelEntry e;
         e.asset = std::move(model);
-        e.generation = 1;
+        e.generation = key.generation;
         e.refCount = initialRef;
         e.path = path;
 
         // Dependencies (fill later in loadModel)
         m_models.emplace(id, std::move(e));
+        if (initialRef == 0)
+            m_gcModels.push_back(id);
 
         ModelHandle h;
         h.id = id;
-        h.generation = 1;
+        h.generation = key.generation;
         return h;
     }
 
-    ModelHandle AssetManager::loadModel(const std::string &cookedModelPath)
+    bool AssetManager::prepareModel_Internal(const AssetPackList *packs, JobSystem *jobs, bool cpuMips, bool optimizeMeshes, const std::string &cookedModelPath, PreparedModel &out)
     {
-        auto it = m_modelPathCache.find(cookedModelPath);
-        if (it != m_modelPathCache.end())
-        {
-            addRef(it->second);
-            return it->second;
-        }
+        ENGINE_PROFILE_ZONE("AssetManager::prepareModel");
+        out.path = cookedModelPath;
+        out.sourceWriteTime = SourceWriteTime(packs, cookedModelPath);
 
         // --------------------------
         // Parse cooked .smodel file
         // --------------------------
-        Engine::smodel::SModelFileView view;
         std::string err;
-        if (!Engine::smodel::LoadSModelFile(cookedModelPath, view, err))
+        if (!LoadSModelSource(packs, cookedModelPath, out.view, err))
         {
 #if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
             std::cerr << "[AssetManager] loadModel: Failed to load .smodel: " << err << "\n";
 #endif
-            return ModelHandle{};
+            return false;
         }
 
         // --------------------------
-        // Create upload pool for all textures (single submit)
+        // Decode textures (CPU), one worker per texture
         // --------------------------
-        VkCommandPoolCreateInfo poolInfo{};
-        poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-        poolInfo.queueFamilyIndex = m_graphicsQueueFamilyIndex;
-        poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
-
-        VkCommandPool uploadPool = VK_NULL_HANDLE;
-        VkResult pr = vkCreateCommandPool(m_device, &poolInfo, nullptr, &uploadPool);
-        if (pr != VK_SUCCESS)
-            return ModelHandle{};
+        const auto &view = out.view;
+        out.textures.resize(view.textureCount());
+        std::vector<uint8_t> decoded(view.textureCount(), 1u);
+        auto decodeRange = [&](uint32_t, uint32_t first, uint32_t last)
+        {
+            for (uint32_t i = first; i < last; i++)
+            {
+                const auto &t = view.textures[i];
+                const uint8_t *bytes = view.blob + t.imageDataOffset;
+                const size_t sizeBytes = static_cast<size_t>(t.imageDataSize);
+
+                PreparedTexture &pt = out.textures[i];
+                if (Engine::smodel::IsBlockCompressed(t.encoding))
+                {
+                    // Cooked BC7/ASTC: already GPU-ready, nothing to decode.
+                    pt.blocks = bytes;
+                    pt.blockBytes = sizeBytes;
+                    pt.width = t.width;
+                    pt.height = t.height;
+                    pt.mipLevels = t.mipLevels;
+                    continue;
+                }
+
+                if (!decodeModelTexture(t, bytes, sizeBytes, pt.rgba, pt.width, pt.height))
+                {
+                    decoded[i] = 0u;
+                    continue;
+                }
+
+                if (cpuMips)
+                {
+                    std::vector<uint8_t> chain;
+                    pt.mipLevels = TextureAsset::buildMipChainRGBA8(pt.rgba.data(), pt.width, pt.height, t.colorSpace == 1, chain);
+                    pt.rgba.swap(chain);
+                }
+            }
+        };
+        // Nested inside the load job is fine: the waiting worker runs decode ranges itself.
+        if (jobs)
+            jobs->parallelForRange(0, view.textureCount(), 1, decodeRange);
+        else
+            decodeRange(0, 0, view.textureCount());
+
+        for (uint32_t i = 0; i < view.textureCount(); i++)
+        {
+            if (!decoded[i])
+            {
+#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
+                std::cerr << "[AssetManager] loadModel: Failed to decode texture " << i << " of " << cookedModelPath << "\n";
+#endif
+                return false;
+            }
+        }
+
+        // --------------------------
+        // Pack vertices (CPU): 72-byte VertexPNTTJW -> 36-byte SModelPackedVertex
+        // --------------------------
+        out.packedFirst.assign(view.meshCount(), UINT64_MAX);
+        uint64_t packedCount = 0;
+        for (uint32_t i = 0; i < view.meshCount(); i++)
+        {
+            const auto &mr = view.meshes[i];
+            if (!(mr.layoutFlags & Engine::smodel::VTX_PACKED) && mr.vertexStride == Engine::smodel::SMODEL_VERTEX_STRIDE)
+            {
+                out.packedFirst[i] = packedCount;
+                packedCount += mr.vertexCount;
+            }
+        }
+        out.packedVertices.resize(static_cast<size_t>(packedCount));
+        for (uint32_t i = 0; i < view.meshCount(); i++)
+        {
+            if (out.packedFirst[i] == UINT64_MAX)
+                continue;
+            const auto &mr = view.meshes[i];
+            Engine::smodel::PackVerticesPNTTJW(view.blob + mr.vertexDataOffset, mr.vertexCount,
+                                               out.packedVertices.data() + out.packedFirst[i]);
+        }
+
+        // --------------------------
+        // Vertex cache / overdraw / fetch order (CPU): opt-in fallback for files cooked
+        // before the cook tool ran it (SMODEL_FLAG_OPTIMIZED_MESHES)
+        // --------------------------
+        out.optimizedIndices.assign(view.meshCount(), {});
+        if (optimizeMeshes && !(view.header->flags & Engine::smodel::SMODEL_FLAG_OPTIMIZED_MESHES))
+        {
+            ENGINE_PROFILE_ZONE("AssetManager::optimizeMeshes");
+            for (uint32_t i = 0; i < view.meshCount(); i++)
+            {
+                if (out.packedFirst[i] == UINT64_MAX)
+                    continue; // vertices still in the read-only blob
+                auto &oi = out.optimizedIndices[i];
+                OptimizePreparedMesh(view, i, out.packedVertices.data() + out.packedFirst[i], oi.bytes, oi.levelOffsets);
+            }
+        }
 
-        Engine::UploadContext upload{};
-        if (!Engine::BeginUploadContext(upload, m_device, m_phys, uploadPool, m_graphicsQueue))
+        return true;
+    }
+
+    ModelHandle AssetManager::loadModel(const std::string &cookedModelPath)
+    {
+        auto it = m_modelPathCache.find(cookedModelPath);
+        if (it != m_modelPathCache.end())
         {
-            vkDestroyCommandPool(m_device, uploadPool, nullptr);
+            const ModelHandle h = it->second;
+            if (modelState(h) == AssetState::Pending)
+            {
+                // Requested but still streaming: finish it here, the background result is dropped.
+                PreparedModel prepared;
+                if (!prepareModel_Internal(m_packs.get(), m_jobs, m_cpuMipChains, m_optimizeUncookedMeshes, cookedModelPath, prepared) || !finalizeModel_Internal(prepared, h).isValid())
+                {
+                    failPendingModel_Internal(h);
+                    return ModelHandle{};
+                }
+            }
+
+            addRef(h);
+            return h;
+        }
+
+        PreparedModel prepared;
+        if (!prepareModel_Internal(m_packs.get(), m_jobs, m_cpuMipChains, m_optimizeUncookedMeshes, cookedModelPath, prepared))
             return ModelHandle{};
+        return finalizeModel_Internal(prepared);
+    }
+
+    ModelHandle AssetManager::requestModel(const std::string &cookedModelPath)
+    {
+        auto it = m_modelPathCache.find(cookedModelPath);
+        if (it != m_modelPathCache.end())
+        {
+            addRef(it->second);
+            return it->second;
         }
 
+        if (!m_jobs)
+            return loadModel(cookedModelPath);
+
+        // Register an empty entry now; the continuation fills it in place so the handle stays valid.
+        const ModelHandle h = createModel_Internal(nullptr, cookedModelPath, 1);
+        if (!h.isValid())
+            return h;
+        m_models[h.id].state = AssetState::Pending;
+        m_modelSlots.setState(h.id, h.generation, AssetState::Pending);
+        m_modelPathCache.emplace(cookedModelPath, h);
+
+        auto prepared = std::make_shared<PreparedModel>();
+        auto ok = std::make_shared<bool>(false);
+
+        JobHandle parse = m_jobs->submit([packs = m_packs, jobs = m_jobs, cpuMips = m_cpuMipChains, optimize = m_optimizeUncookedMeshes, cookedModelPath, prepared, ok]()
+                                         { *ok = prepareModel_Internal(packs.get(), jobs, cpuMips, optimize, cookedModelPath, *prepared); },
+                                         JobPriority::Background);
+
+        std::weak_ptr<int> alive = m_lifetimeToken;
+        m_jobs->thenOnMainThread(parse, [this, alive, prepared, ok, h]()
+                                 {
+                                     if (alive.expired())
+                                         return;
+
+                                     // Finished synchronously or collected while loading.
+                                     if (modelState(h) != AssetState::Pending)
+                                         return;
+
+                                     if (!*ok || !finalizeModel_Internal(*prepared, h).isValid())
+                                         failPendingModel_Internal(h);
+                                 });
+        return h;
+    }
+
+    AssetState AssetManager::modelState(ModelHandle h) const
+    {
+        return m_modelSlots.state(h);
+    }
+
+    void AssetManager::failPendingModel_Internal(ModelHandle h)
+    {
+        auto it = m_models.find(h.id);
+        if (it == m_models.end() || it->second.generation != h.generation)
+            return;
+
+        // Keep the entry for outstanding handles, but let the next request retry the file.
+        auto cached = m_modelPathCache.find(it->second.path);
+        if (cached != m_modelPathCache.end() && cached->second.id == h.id)
+            m_modelPathCache.erase(cached);
+        it->second.path.clear();
+        it->second.state = AssetState::Failed;
+        m_modelSlots.setState(h.id, h.generation, AssetState::Failed);
+
+#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
+        std::cerr << "[AssetManager] requestModel: load failed (handle " << h.id << ")\n";
+#endif
+    }
+
+    JobHandle AssetManager::loadModelAsync(const std::string &cookedModelPath, JobSystem &jobs, std::function<void(ModelHandle)> onLoaded)
+    {
+        // Already resident: still report through the main-thread queue so callers see one behavior.
+        auto it = m_modelPathCache.find(cookedModelPath);
+        if (it != m_modelPathCache.end() && isModelReady(it->second))
+        {
+            addRef(it->second);
+            const ModelHandle h = it->second;
+            std::weak_ptr<int> alive = m_lifetimeToken;
+            return jobs.postToMainThread([alive, h, onLoaded = std::move(onLoaded)]()
+                                         {
+                                             if (!alive.expired() && onLoaded)
+                                                 onLoaded(h);
+                                         });
+        }
+
+        auto prepared = std::make_shared<PreparedModel>();
+        auto ok = std::make_shared<bool>(false);
+
+        JobHandle parse = jobs.submit([packs = m_packs, jobs = &jobs, cpuMips = m_cpuMipChains, optimize = m_optimizeUncookedMeshes, cookedModelPath, prepared, ok]()
+                                      { *ok = prepareModel_Internal(packs.get(), jobs, cpuMips, optimize, cookedModelPath, *prepared); },
+                                      JobPriority::Background);
+
+        std::weak_ptr<int> alive = m_lifetimeToken;
+        return jobs.thenOnMainThread(parse, [this, alive, prepared, ok, onLoaded = std::move(onLoaded)]()
+                                     {
+                                         if (alive.expired())
+                                             return;
+
+                                         ModelHandle h{};
+                                         auto cached = m_modelPathCache.find(prepared->path);
+                                         if (cached != m_modelPathCache.end())
+                                         {
+                                             // Loaded or requested by someone else in the meantime.
+                                             const ModelHandle existing = cached->second;
+                                             if (modelState(existing) == AssetState::Pending &&
+                                                 (!*ok || !finalizeModel_Internal(*prepared, existing).isValid()))
+                                                 failPendingModel_Internal(existing);
+
+                                             if (isModelReady(existing))
+                                             {
+                                                 addRef(existing);
+                                                 h = existing;
+                                             }
+                                         }
+                                         else if (*ok)
+                                         {
+                                             h = finalizeModel_Internal(*prepared);
+                                         }
+
+                                         if (onLoaded)
+                                             onLoaded(h);
+                                     });
+    }
+
+    ModelHandle AssetManager::finalizeModel_Internal(const PreparedModel &prepared, ModelHandle target)
+    {
+        ENGINE_PROFILE_ZONE("AssetManager::finalizeModel");
+        const std::string &cookedModelPath = prepared.path;
+        const Engine::smodel::SModelFileView &view = prepared.view;
+
+        // --------------------------
+        // One upload for all textures and meshes (or the caller's open batch)
+        // --------------------------
+        Engine::UploadContext local{};
+        Engine::UploadContext *upload = beginUpload_Internal(local);
+        if (!upload)
+            return ModelHandle{};
+
         // --------------------------
         // Upload textures (deferred)
         // --------------------------
@@ -467,43 +1151,165 @@ namespace Engine
             const VkFilter magF = toVkFilter(t.magFilter);
             const VkSamplerMipmapMode mipM = toVkMip(t.mipFilter);
 
-            const uint8_t *bytes = view.blob + t.imageDataOffset;
-            const size_t sizeBytes = static_cast<size_t>(t.imageDataSize);
+            // Pixels were decoded (or block data located) in prepareModel_Internal.
+            const PreparedTexture &pixels = prepared.textures[i];
 
             auto tex = std::make_unique<TextureAsset>();
 
             // IMPORTANT:
             // We create textures with refCount=0 (materials will addRef them)
             // This avoids leaking textures when model is destroyed.
-            if (!tex->uploadEncodedImage_Deferred(
-                    upload,
-                    bytes,
-                    sizeBytes,
+            bool uploaded = false;
+            if (pixels.blocks)
+            {
+                const VkFormat format = toVkCompressedFormat(t.encoding, isSRGB);
+                uploaded = tex->uploadBlockCompressed_Deferred(
+                    *upload,
+                    pixels.blocks,
+                    pixels.blockBytes,
+                    pixels.width,
+                    pixels.height,
+                    pixels.mipLevels,
+                    format,
+                    wrapU,
+                    wrapV,
+                    minF,
+                    magF,
+                    mipM,
+                    t.maxAnisotropy);
+#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
+                if (!uploaded && !TextureAsset::isFormatSampleable(m_phys, format))
+                    std::cerr << "[AssetManager] loadModel: GPU cannot sample compressed texture " << i << " of " << cookedModelPath
+                              << " (recook with GltfToSmodel --tex png)\n";
+#endif
+            }
+            else if (pixels.mipLevels > 1)
+            {
+                uploaded = tex->uploadRGBA8MipChain_Deferred(
+                    *upload,
+                    pixels.rgba.data(),
+                    pixels.rgba.size(),
+                    pixels.width,
+                    pixels.height,
+                    pixels.mipLevels,
+                    isSRGB,
+                    wrapU,
+                    wrapV,
+                    minF,
+                    magF,
+                    mipM,
+                    t.maxAnisotropy);
+            }
+            else
+            {
+                uploaded = tex->uploadRGBA8_Deferred(
+                    *upload,
+                    pixels.rgba.data(),
+                    pixels.width,
+                    pixels.height,
                     isSRGB,
                     wrapU,
                     wrapV,
                     minF,
                     magF,
                     mipM,
-                    t.maxAnisotropy))
+                    t.maxAnisotropy);
+            }
+
+            if (!uploaded)
             {
-                // Cleanup on failure
-                Engine::EndSubmitAndWait(upload);
-                vkDestroyCommandPool(m_device, uploadPool, nullptr);
+                // Cleanup on failure (textures registered so far have no refs and are collected)
+                endUpload_Internal(*upload);
+                discardTexture_Internal(std::move(tex));
                 return ModelHandle{};
             }
 
             textureHandles[i] = createTexture_Internal(std::move(tex), 0);
+            TextureEntry &entry = m_textures[textureHandles[i].id];
+            entry.sourcePath = cookedModelPath;
+            entry.sourceTexture = static_cast<int32_t>(i);
         }
 
-        // ONE SUBMIT for all textures
-        if (!Engine::EndSubmitAndWait(upload))
+        // --------------------------
+        // Upload meshes (deferred, same submit)
+        // Vertex/index bytes stay in the (mapped) blob; they are copied once, into staging.
+        // --------------------------
+        // All meshes of a model go into one shared vertex/index buffer when their layouts agree,
+        // so the model's primitives can be drawn with a single VB/IB bind (and indirectly).
+        std::vector<std::unique_ptr<MeshAsset>> meshAssets(view.meshCount());
+        std::vector<MeshDataView> meshViews(view.meshCount());
+        std::vector<MeshAsset *> meshPtrs(view.meshCount());
+        std::vector<std::vector<MeshLodView>> meshLods(view.meshCount());
+
+        // V4.3: LOD index lists ride along with their mesh (records are ascending per mesh)
+        for (uint32_t i = 0; view.meshLods && i < view.meshLods->lodCount; i++)
         {
-            vkDestroyCommandPool(m_device, uploadPool, nullptr);
-            return ModelHandle{};
+            const auto &lr = view.meshLodRecords[i];
+            MeshLodView lod;
+            lod.indices = view.blob + lr.indexDataOffset;
+            lod.indexCount = lr.indexCount;
+            lod.screenSize = lr.screenSize;
+            const auto &oi = prepared.optimizedIndices[lr.meshIndex];
+            const size_t level = meshLods[lr.meshIndex].size() + 1;
+            if (!oi.bytes.empty() && level < oi.levelOffsets.size())
+                lod.indices = oi.bytes.data() + oi.levelOffsets[level];
+            meshLods[lr.meshIndex].push_back(lod);
+        }
+
+        for (uint32_t i = 0; i < view.meshCount(); i++)
+        {
+            const auto &mr = view.meshes[i];
+
+            MeshDataView &md = meshViews[i];
+            md.vertexCount = mr.vertexCount;
+            md.indexCount = mr.indexCount;
+            md.vertexStride = mr.vertexStride;
+            md.indexFormat = (mr.indexType == 0) ? 0 : 1;
+
+            std::memcpy(md.aabbMin, mr.aabbMin, sizeof(md.aabbMin));
+            std::memcpy(md.aabbMax, mr.aabbMax, sizeof(md.aabbMax));
+
+            md.vertexBytes = view.blob + mr.vertexDataOffset;
+            md.vertexByteSize = mr.vertexDataSize;
+            if (prepared.packedFirst[i] != UINT64_MAX)
+            {
+                // Packed in prepareModel_Internal; GPU buffers only ever hold the packed layout.
+                md.vertexBytes = reinterpret_cast<const uint8_t *>(prepared.packedVertices.data() + prepared.packedFirst[i]);
+                md.vertexByteSize = uint64_t(mr.vertexCount) * Engine::smodel::SMODEL_PACKED_VERTEX_STRIDE;
+                md.vertexStride = Engine::smodel::SMODEL_PACKED_VERTEX_STRIDE;
+            }
+            md.indices = view.blob + mr.indexDataOffset;
+            if (!prepared.optimizedIndices[i].bytes.empty())
+                md.indices = prepared.optimizedIndices[i].bytes.data();
+            md.lods = meshLods[i].data();
+            md.lodCount = static_cast<uint32_t>(meshLods[i].size());
+
+            meshAssets[i] = std::make_unique<MeshAsset>();
+            meshPtrs[i] = meshAssets[i].get();
+        }
+
+        const bool merged = !meshAssets.empty() &&
+                            MeshAsset::uploadMergedDeferred(*upload, meshViews.data(), view.meshCount(), meshPtrs.data());
+        if (!merged)
+        {
+            for (uint32_t i = 0; i < view.meshCount(); i++)
+            {
+                meshAssets[i]->destroy(m_device);
+                if (!meshAssets[i]->uploadDeferred(*upload, meshViews[i]))
+                {
+                    // A failed mesh stays an invalid handle, as before.
+                    discardMesh_Internal(std::move(meshAssets[i]));
+                }
+            }
         }
 
-        vkDestroyCommandPool(m_device, uploadPool, nullptr);
+        // ONE SUBMIT for all textures and meshes
+        if (!endUpload_Internal(*upload))
+        {
+            for (auto &m : meshAssets)
+                discardMesh_Internal(std::move(m));
+            return ModelHandle{};
+        }
 
         // --------------------------
         // Create materials (CPU only)
@@ -573,8 +1379,24 @@ namespace Engine
             }
         }
 
+        // V4.5: the impostor atlases get a masked material of their own (no primitive uses it)
+        MaterialHandle impostorMaterial{};
+        if (view.impostor)
+        {
+            auto mat = std::make_unique<MaterialAsset>();
+            mat->debugName = "impostor";
+            mat->baseColorTexture = textureHandles[static_cast<uint32_t>(view.impostor->albedoTexture)];
+            mat->normalTexture = textureHandles[static_cast<uint32_t>(view.impostor->normalTexture)];
+            mat->alphaMode = 1; // MASK
+            mat->alphaCutoff = 0.5f;
+            mat->doubleSided = 1;
+            impostorMaterial = createMaterial_Internal(std::move(mat), 0);
+            addRef(textureHandles[static_cast<uint32_t>(view.impostor->albedoTexture)]);
+            addRef(textureHandles[static_cast<uint32_t>(view.impostor->normalTexture)]);
+        }
+
         // --------------------------
-        // Create meshes (GPU upload)
+        // Register meshes (uploaded above)
         // Model will addRef() meshes it uses
         // --------------------------
         std::vector<MeshHandle> meshHandles;
@@ -582,37 +1404,9 @@ namespace Engine
 
         for (uint32_t i = 0; i < view.meshCount(); i++)
         {
-            const auto &mr = view.meshes[i];
-
-            MeshData md;
-            md.vertexCount = mr.vertexCount;
-            md.indexCount = mr.indexCount;
-            md.vertexStride = mr.vertexStride;
-            md.indexFormat = (mr.indexType == 0) ? 0 : 1;
-
-            std::memcpy(md.aabbMin, mr.aabbMin, sizeof(md.aabbMin));
-            std::memcpy(md.aabbMax, mr.aabbMax, sizeof(md.aabbMax));
-
-            // Copy vertex bytes from blob
-            const uint8_t *vb = view.blob + mr.vertexDataOffset;
-            md.vertexBytes.assign(vb, vb + mr.vertexDataSize);
-
-            // Copy index bytes
-            const uint8_t *ib = view.blob + mr.indexDataOffset;
-
-            if (md.indexFormat == 0)
-            {
-                md.indices16.resize(md.indexCount);
-                std::memcpy(md.indices16.data(), ib, md.indexCount * sizeof(uint16_t));
-            }
-            else
-            {
-                md.indices32.resize(md.indexCount);
-                std::memcpy(md.indices32.data(), ib, md.indexCount * sizeof(uint32_t));
-            }
-
             // Create mesh with refCount=0 (model will addRef as needed)
-            meshHandles[i] = createMeshFromData_Internal(md, cookedModelPath + "#mesh" + std::to_string(i), 0);
+            if (meshAssets[i])
+                meshHandles[i] = registerMesh_Internal(std::move(meshAssets[i]), cookedModelPath + "#mesh" + std::to_string(i), 0);
         }
 
         // --------------------------
@@ -700,6 +1494,58 @@ namespace Engine
             }
         }
 
+        if (impostorMaterial.isValid())
+        {
+            addRef(impostorMaterial);
+            matDeps.push_back(impostorMaterial);
+            model->impostorMaterial = impostorMaterial;
+            model->impostorFrames = view.impostor->framesPerSide;
+            model->impostorMapping = view.impostor->mapping;
+            std::memcpy(model->impostorCenter, view.impostor->center, sizeof(model->impostorCenter));
+            model->impostorRadius = view.impostor->radius;
+        }
+
+        // V4.6: meshlets, attached to the primitives that draw their whole mesh
+        if (view.meshlets && view.meshlets->meshletCount > 0)
+        {
+            const uint32_t count = view.meshlets->meshletCount;
+            std::vector<uint32_t> meshFirst(view.meshCount(), 0), meshCount(view.meshCount(), 0);
+            model->meshlets.resize(count);
+            for (uint32_t i = 0; i < count; i++)
+            {
+                const auto &r = view.meshletRecords[i];
+                ModelMeshlet &m = model->meshlets[i];
+                m.firstIndex = r.firstIndex;
+                m.triangleCount = r.triangleCount;
+                m.vertexOffset = r.vertexOffset;
+                m.triangleOffset = r.triangleOffset;
+                m.vertexCount = r.vertexCount;
+                m.anchorJoint = r.anchorJoint;
+                std::memcpy(m.center, r.center, sizeof(m.center));
+                m.radius = r.radius;
+                std::memcpy(m.coneAxis, r.coneAxis, sizeof(m.coneAxis));
+                m.coneCutoff = r.coneCutoff;
+
+                if (meshCount[r.meshIndex]++ == 0)
+                    meshFirst[r.meshIndex] = i; // records are sorted by mesh
+            }
+
+            const uint8_t *vertexData = view.blob + view.meshlets->vertexDataOffset;
+            model->meshletVertices.resize(view.meshlets->vertexCount);
+            std::memcpy(model->meshletVertices.data(), vertexData, model->meshletVertices.size() * sizeof(uint32_t));
+            const uint8_t *triangleData = view.blob + view.meshlets->triangleDataOffset;
+            model->meshletTriangles.assign(triangleData, triangleData + view.meshlets->triangleByteCount);
+
+            for (uint32_t i = 0; i < view.primitiveCount(); i++)
+            {
+                const auto &p = view.primitives[i];
+                if (p.firstIndex != 0 || p.vertexOffset != 0 || p.indexCount != view.meshes[p.meshIndex].indexCount)
+                    continue;
+                model->primitives[i].firstMeshlet = meshFirst[p.meshIndex];
+                model->primitives[i].meshletCount = meshCount[p.meshIndex];
+            }
+        }
+
         // --------------------------
         // V4: Populate skin tables (optional)
         // --------------------------
@@ -974,6 +1820,36 @@ namespace Engine
             std::memcpy(model->animValues.data(), view.animValues, sizeof(float) * view.animValuesCount());
         }
 
+        // V4.2: baked palettes, only when their layout matches what this model ended up with.
+        if (view.bakedAnimation && view.bakedAnimation->sampleRate > 0.0f &&
+            view.bakedAnimation->nodeCount == model->nodes.size() &&
+            view.bakedAnimation->jointCount == model->totalJointCount &&
+            view.bakedAnimation->clipCount == model->animClips.size())
+        {
+            model->bakedSampleRate = view.bakedAnimation->sampleRate;
+            model->bakedClips.assign(view.bakedClips, view.bakedClips + view.bakedAnimation->clipCount);
+            model->bakedFrames.assign(view.bakedData, view.bakedData + view.bakedAnimation->dataCount);
+        }
+
+        // V4.4: quantized clips, only when they describe this model's clip list.
+        if (view.quantizedAnim && view.quantizedAnim->sampleRate > 0.0f &&
+            view.quantizedAnim->clipCount == model->animClips.size())
+        {
+            model->quantizedSampleRate = view.quantizedAnim->sampleRate;
+            model->quantizedClips.assign(view.quantizedClips, view.quantizedClips + view.quantizedAnim->clipCount);
+            model->quantizedTracks.assign(view.quantizedTracks, view.quantizedTracks + view.quantizedAnim->trackCount);
+            model->quantizedData.assign(view.quantizedData, view.quantizedData + view.quantizedAnim->dataWords);
+        }
+
+        // V4.3: per-level thresholds for the whole model (the loosest one any mesh asks for)
+        for (uint32_t i = 0; view.meshLods && i < view.meshLods->lodCount; i++)
+        {
+            const auto &lr = view.meshLodRecords[i];
+            if (model->lodScreenSizes.size() < lr.level)
+                model->lodScreenSizes.resize(lr.level, 0.0f);
+            model->lodScreenSizes[lr.level - 1] = std::max(model->lodScreenSizes[lr.level - 1], lr.screenSize);
+        }
+
 #if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
         if (view.animClipCount() > 0)
         {
@@ -1000,14 +1876,48 @@ namespace Engine
             model->restTRS[i] = DecomposeTRS(local);
             model->animatedTRS[i] = model->restTRS[i];
         }
+        model->buildEvaluationOrder();
 
         model->animState.clipIndex = 0;
         model->animState.timeSec = 0.0f;
         model->animState.loop = true;
         model->animState.playing = true;
 
+        // Streamed: fill the pending entry (already cached and referenced by its requesters)
+        if (target.isValid())
+        {
+            auto targetIt = m_models.find(target.id);
+            if (targetIt == m_models.end() || targetIt->second.generation != target.generation)
+            {
+                // Collected while loading; nobody holds the handle anymore.
+                for (auto &mh : meshDeps)
+                    release(mh);
+                for (auto &mat : matDeps)
+                    release(mat);
+                return ModelHandle{};
+            }
+
+            // A reload replaces a model workers may be reading: it retires like a collected one.
+            m_modelSlots.publish(target.id, target.generation, model.get(), AssetState::Ready);
+            retireModel_Internal(std::move(targetIt->second.asset));
+            targetIt->second.asset = std::move(model);
+            targetIt->second.meshDeps = std::move(meshDeps);
+            targetIt->second.materialDeps = std::move(matDeps);
+            targetIt->second.state = AssetState::Ready;
+            targetIt->second.sourceWriteTime = prepared.sourceWriteTime;
+            return target;
+        }
+
         // Register model and cache it
         ModelHandle modelHandle = createModel_Internal(std::move(model), cookedModelPath, 1);
+        if (!modelHandle.isValid())
+        {
+            for (auto &mh : meshDeps)
+                release(mh);
+            for (auto &mat : matDeps)
+                release(mat);
+            return ModelHandle{};
+        }
 
         // Fill dependency lists inside the ModelEntry
         auto modelIt = m_models.find(modelHandle.id);
@@ -1015,20 +1925,89 @@ namespace Engine
         {
             modelIt->second.meshDeps = std::move(meshDeps);
             modelIt->second.materialDeps = std::move(matDeps);
+            modelIt->second.sourceWriteTime = prepared.sourceWriteTime;
         }
 
         m_modelPathCache.emplace(cookedModelPath, modelHandle);
         return modelHandle;
     }
 
-    ModelAsset *AssetManager::getModel(ModelHandle h)
+    bool AssetManager::reloadModel(ModelHandle h)
     {
+        ENGINE_PROFILE_ZONE("AssetManager::reloadModel");
         auto it = m_models.find(h.id);
-        if (it == m_models.end())
-            return nullptr;
-        if (it->second.generation != h.generation)
-            return nullptr;
-        return it->second.asset.get();
+        if (it == m_models.end() || it->second.generation != h.generation || it->second.state != AssetState::Ready ||
+            it->second.path.empty())
+            return false;
+
+        PreparedModel prepared;
+        if (!prepareModel_Internal(m_packs.get(), m_jobs, m_cpuMipChains, m_optimizeUncookedMeshes, it->second.path, prepared))
+            return false;
+
+        // finalize fills the entry in place as it does for a streamed model; the old
+        // dependencies are held here until the new ones are in.
+        std::vector<MeshHandle> oldMeshes = std::move(it->second.meshDeps);
+        std::vector<MaterialHandle> oldMaterials = std::move(it->second.materialDeps);
+        it->second.meshDeps.clear();
+        it->second.materialDeps.clear();
+
+        if (!finalizeModel_Internal(prepared, h).isValid())
+        {
+            auto restore = m_models.find(h.id);
+            if (restore != m_models.end())
+            {
+                restore->second.meshDeps = std::move(oldMeshes);
+                restore->second.materialDeps = std::move(oldMaterials);
+            }
+            return false;
+        }
+
+        for (auto &mh : oldMeshes)
+            release(mh);
+        for (auto &mat : oldMaterials)
+            release(mat);
+
+#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
+        std::cerr << "[AssetManager] Reloaded model " << prepared.path << "\n";
+#endif
+        return true;
+    }
+
+    std::string AssetManager::modelPath(ModelHandle h) const
+    {
+        auto it = m_models.find(h.id);
+        if (it == m_models.end() || it->second.generation != h.generation)
+            return std::string{};
+        return it->second.path;
+    }
+
+    uint32_t AssetManager::reloadChangedModels(std::vector<ModelHandle> *outReloaded)
+    {
+        std::vector<ModelHandle> changed;
+        for (const auto &kv : m_models)
+        {
+            const ModelEntry &e = kv.second;
+            if (e.state != AssetState::Ready || e.path.empty() || e.sourceWriteTime == 0)
+                continue;
+            if (SourceWriteTime(m_packs.get(), e.path) != e.sourceWriteTime)
+                changed.push_back(ModelHandle{kv.first, e.generation});
+        }
+
+        uint32_t reloaded = 0;
+        for (const ModelHandle h : changed)
+        {
+            if (!reloadModel(h))
+                continue;
+            ++reloaded;
+            if (outReloaded)
+                outReloaded->push_back(h);
+        }
+        return reloaded;
+    }
+
+    ModelAsset *AssetManager::getModel(ModelHandle h) const
+    {
+        return m_modelSlots.resolve(h);
     }
 
     void AssetManager::addRef(ModelHandle h)
@@ -1043,83 +2022,603 @@ namespace Engine
         auto it = m_models.find(h.id);
         if (it != m_models.end() && it->second.generation == h.generation)
         {
-            if (it->second.refCount > 0)
-                it->second.refCount--;
+            if (it->second.refCount > 0 && --it->second.refCount == 0)
+                m_gcModels.push_back(h.id);
         }
     }
 
     // ------------------------------------------------------------
     // Garbage collection with dependency release
     // ------------------------------------------------------------
+    bool AssetManager::collectModel_Internal(uint64_t id)
+    {
+        auto it = m_models.find(id);
+        if (it == m_models.end() || it->second.refCount != 0)
+            return false;
+
+        // Release model deps
+        for (auto &mh : it->second.meshDeps)
+            release(mh);
+        for (auto &mat : it->second.materialDeps)
+            release(mat);
+
+        m_modelPathCache.erase(it->second.path);
+        m_modelSlots.remove(id, it->second.generation);
+        retireModel_Internal(std::move(it->second.asset));
+        m_models.erase(it);
+        ++m_collectedAssets;
+        return true;
+    }
+
+    bool AssetManager::collectMaterial_Internal(uint64_t id)
+    {
+        auto it = m_materials.find(id);
+        if (it == m_materials.end() || it->second.refCount != 0)
+            return false;
+
+        // Release textures referenced by this material
+        for (auto &th : it->second.textureDeps)
+            release(th);
+        m_materialSlots.remove(id, it->second.generation);
+        retireMaterial_Internal(std::move(it->second.asset));
+        m_materials.erase(it);
+        ++m_collectedAssets;
+        return true;
+    }
+
+    bool AssetManager::collectMesh_Internal(uint64_t id)
+    {
+        auto it = m_meshes.find(id);
+        if (it == m_meshes.end() || it->second.refCount != 0)
+            return false;
+
+        m_meshSlots.remove(id, it->second.generation);
+        retireMesh_Internal(std::move(it->second.asset));
+        m_meshPathCache.erase(it->second.path);
+        m_meshes.erase(it);
+        ++m_collectedAssets;
+        return true;
+    }
+
+    bool AssetManager::collectTexture_Internal(uint64_t id)
+    {
+        auto it = m_textures.find(id);
+        if (it == m_textures.end() || it->second.refCount != 0)
+            return false;
+
+        m_textureSlots.remove(id, it->second.generation);
+        retireTexture_Internal(std::move(it->second.asset));
+        m_textures.erase(it);
+        ++m_collectedAssets;
+        return true;
+    }
+
+    void AssetManager::retireMesh_Internal(std::unique_ptr<MeshAsset> mesh)
+    {
+        if (!mesh)
+            return;
+        if (!m_frameSerialsKnown)
+        {
+            mesh->destroy(m_device);
+            return;
+        }
+        DeferredDestroy d;
+        d.mesh = std::move(mesh);
+        d.retireSerial = m_recordingSerial;
+        m_deferredDestroys.push_back(std::move(d));
+    }
+
+    void AssetManager::retireTexture_Internal(std::unique_ptr<TextureAsset> tex)
+    {
+        if (!tex)
+            return;
+        if (!m_frameSerialsKnown)
+        {
+            tex->destroy(m_device);
+            return;
+        }
+        DeferredDestroy d;
+        d.texture = std::move(tex);
+        d.retireSerial = m_recordingSerial;
+        m_deferredDestroys.push_back(std::move(d));
+    }
+
+    void AssetManager::retireMaterial_Internal(std::unique_ptr<MaterialAsset> mat)
+    {
+        if (!mat || !m_frameSerialsKnown)
+            return; // nothing on the GPU; without serials nobody may still be reading it
+        DeferredDestroy d;
+        d.material = std::move(mat);
+        d.retireSerial = m_recordingSerial;
+        m_deferredDestroys.push_back(std::move(d));
+    }
+
+    void AssetManager::retireModel_Internal(std::unique_ptr<ModelAsset> model)
+    {
+        if (!model || !m_frameSerialsKnown)
+            return;
+        DeferredDestroy d;
+        d.model = std::move(model);
+        d.retireSerial = m_recordingSerial;
+        m_deferredDestroys.push_back(std::move(d));
+    }
+
+    void AssetManager::setFrameSerials(uint64_t recordingSerial, uint64_t completedSerial)
+    {
+        m_frameSerialsKnown = true;
+        // Serials only grow; the queue relies on it for its order.
+        m_recordingSerial = std::max(m_recordingSerial, recordingSerial);
+        m_completedSerial = std::max(m_completedSerial, completedSerial);
+    }
+
     void AssetManager::garbageCollect()
     {
-        // 1) Destroy models with refCount == 0
-        for (auto it = m_models.begin(); it != m_models.end();)
+        // Recorded batch commands may still reference zero-ref assets.
+        if (m_uploadBatch)
+            return;
+
+        ENGINE_PROFILE_ZONE("AssetManager::garbageCollect");
+
+        // One pass per stage, in dependency order: collecting a model releases its meshes and
+        // materials, a material its textures. Ids are gathered first since collecting erases.
+        std::vector<uint64_t> ids;
+        auto collectAll = [&ids](const auto &entries, auto &&collect)
         {
-            if (it->second.refCount == 0)
-            {
-                // Release model deps
-                for (auto &mh : it->second.meshDeps)
-                    release(mh);
-                for (auto &mat : it->second.materialDeps)
-                    release(mat);
+            ids.clear();
+            for (const auto &kv : entries)
+                if (kv.second.refCount == 0)
+                    ids.push_back(kv.first);
+            for (uint64_t id : ids)
+                collect(id);
+        };
+
+        collectAll(m_models, [this](uint64_t id) { collectModel_Internal(id); });
+        collectAll(m_materials, [this](uint64_t id) { collectMaterial_Internal(id); });
+        collectAll(m_meshes, [this](uint64_t id) { collectMesh_Internal(id); });
+        collectAll(m_textures, [this](uint64_t id) { collectTexture_Internal(id); });
+
+        // Everything with no references is gone; what the candidate lists still hold is stale.
+        m_gcModels.clear();
+        m_gcMaterials.clear();
+        m_gcMeshes.clear();
+        m_gcTextures.clear();
+    }
 
-                m_modelPathCache.erase(it->second.path);
-                it = m_models.erase(it);
-            }
-            else
-            {
-                ++it;
-            }
+    void AssetManager::garbageCollectStep(float budgetMs)
+    {
+        if (m_uploadBatch)
+            return;
+        if (m_deferredDestroys.empty() && m_gcModels.empty() && m_gcMaterials.empty() &&
+            m_gcMeshes.empty() && m_gcTextures.empty())
+            return;
+
+        ENGINE_PROFILE_ZONE("AssetManager::garbageCollectStep");
+
+        using Clock = std::chrono::steady_clock;
+        const Clock::time_point deadline =
+            Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float, std::milli>(std::max(budgetMs, 0.0f)));
+
+        // At least GC_CLOCK_CHECK_INTERVAL items per call, so any budget makes progress.
+        uint32_t work = 0;
+        auto outOfTime = [&]()
+        {
+            return (++work % GC_CLOCK_CHECK_INTERVAL) == 0 && Clock::now() >= deadline;
+        };
+
+        // 1) Destroy what the GPU is done with first: it frees memory the soonest.
+        while (!m_deferredDestroys.empty() && m_deferredDestroys.front().retireSerial < m_completedSerial)
+        {
+            DeferredDestroy &d = m_deferredDestroys.front();
+            if (d.mesh)
+                d.mesh->destroy(m_device);
+            if (d.texture)
+                d.texture->destroy(m_device);
+            m_deferredDestroys.pop_front();
+            if (outOfTime())
+                return;
         }
 
-        // 2) Destroy materials with refCount == 0
-        for (auto it = m_materials.begin(); it != m_materials.end();)
+        // 2) Candidates, stage by stage. A stage only starts once the ones before it are empty,
+        //    so a time-out resumes at the earliest stage that still has work.
+        auto drain = [&](std::vector<uint64_t> &candidates, bool (AssetManager::*collect)(uint64_t))
         {
-            if (it->second.refCount == 0)
+            while (!candidates.empty())
             {
-                // Release textures referenced by this material
-                for (auto &th : it->second.textureDeps)
-                    release(th);
-                it = m_materials.erase(it);
+                const uint64_t id = candidates.back();
+                candidates.pop_back();
+                (this->*collect)(id);
+                if (outOfTime())
+                    return false;
             }
-            else
+            return true;
+        };
+
+        if (!drain(m_gcModels, &AssetManager::collectModel_Internal))
+            return;
+        if (!drain(m_gcMaterials, &AssetManager::collectMaterial_Internal))
+            return;
+        if (!drain(m_gcMeshes, &AssetManager::collectMesh_Internal))
+            return;
+        drain(m_gcTextures, &AssetManager::collectTexture_Internal);
+    }
+
+    void AssetManager::flushDeferredDestroys()
+    {
+        for (DeferredDestroy &d : m_deferredDestroys)
+        {
+            if (d.mesh)
+                d.mesh->destroy(m_device);
+            if (d.texture)
+                d.texture->destroy(m_device);
+        }
+        m_deferredDestroys.clear();
+    }
+
+    AssetManager::GarbageStats AssetManager::garbageStats() const
+    {
+        GarbageStats out;
+        out.pendingCandidates = static_cast<uint32_t>(m_gcModels.size() + m_gcMaterials.size() +
+                                                      m_gcMeshes.size() + m_gcTextures.size());
+        out.queuedDestroys = static_cast<uint32_t>(m_deferredDestroys.size());
+        for (const DeferredDestroy &d : m_deferredDestroys)
+        {
+            if (d.mesh)
+                out.queuedBytes += d.mesh->getGpuBytes();
+            if (d.texture)
+                out.queuedBytes += d.texture->getGpuBytes();
+        }
+        out.collectedAssets = m_collectedAssets;
+        return out;
+    }
+
+    // ------------------------------------------------------------
+    // Memory accounting
+    // ------------------------------------------------------------
+    void AssetManager::reportMemory(MemoryReport &out) const
+    {
+        uint64_t meshGpu = 0;
+        for (const auto &kv : m_meshes)
+            if (kv.second.asset)
+                meshGpu += kv.second.asset->getGpuBytes();
+        out.add("Assets", "Meshes", 0, meshGpu, static_cast<uint32_t>(m_meshes.size()));
+
+        uint64_t textureGpu = 0;
+        for (const auto &kv : m_textures)
+            if (kv.second.asset)
+                textureGpu += kv.second.asset->getGpuBytes();
+        out.add("Assets", "Textures", 0, textureGpu, static_cast<uint32_t>(m_textures.size()));
+
+        uint64_t modelCpu = 0;
+        for (const auto &kv : m_models)
+            if (kv.second.asset)
+                modelCpu += ModelCpuBytes(*kv.second.asset);
+        out.add("Assets", "Models", modelCpu, 0, static_cast<uint32_t>(m_models.size()));
+
+        const GarbageStats garbage = garbageStats();
+        out.add("Assets", "Pending destroy", 0, garbage.queuedBytes, garbage.queuedDestroys);
+
+        out.add("Assets", "Staging ring", 0, m_stagingRing.capacity());
+    }
+
+    // ------------------------------------------------------------
+    // Texture residency
+    // ------------------------------------------------------------
+    // Coarsest level whose larger side still spans 'texels' (0 when the full size is needed).
+    static uint32_t BaseMipForTexels(const TextureAsset &tex, float texels)
+    {
+        const float maxDim = static_cast<float>(std::max(tex.getFullWidth(), tex.getFullHeight()));
+        if (!(texels < maxDim))
+            return 0u;
+        const float levels = std::floor(std::log2(maxDim / std::max(texels, 1.0f)));
+        return std::min(static_cast<uint32_t>(levels), tex.getFullMipLevels() - 1u);
+    }
+
+    void AssetManager::noteModelOnScreen(ModelHandle h, float screenPixels)
+    {
+        auto modelIt = m_models.find(h.id);
+        if (modelIt == m_models.end() || modelIt->second.generation != h.generation || modelIt->second.state != AssetState::Ready)
+            return;
+
+        const float pixels = std::max(screenPixels, 0.0f);
+        for (const MaterialHandle &mh : modelIt->second.materialDeps)
+        {
+            auto matIt = m_materials.find(mh.id);
+            if (matIt == m_materials.end() || matIt->second.generation != mh.generation)
+                continue;
+            for (const TextureHandle &th : matIt->second.textureDeps)
             {
-                ++it;
+                auto texIt = m_textures.find(th.id);
+                if (texIt == m_textures.end() || texIt->second.generation != th.generation)
+                    continue;
+                TextureEntry &e = texIt->second;
+                if (e.sourcePath.empty())
+                    continue;
+                e.lastUseFrame = m_residencyFrame;
+                e.pendingPixels = std::max(e.pendingPixels, pixels);
             }
         }
+    }
+
+    bool AssetManager::prepareTextureReload_Internal(const AssetPackList *packs, const std::string &sourcePath, int32_t sourceTexture, TextureReload &out)
+    {
+        ENGINE_PROFILE_ZONE("AssetManager::prepareTextureReload");
+        if (sourceTexture < 0)
+            return prepareTexture_Internal(packs, sourcePath, out.pixels);
+
+        std::string err;
+        if (!LoadSModelSource(packs, sourcePath, out.view, err))
+            return false;
+        if (static_cast<uint32_t>(sourceTexture) >= out.view.textureCount())
+            return false;
+
+        const auto &t = out.view.textures[sourceTexture];
+        const uint8_t *bytes = out.view.blob + t.imageDataOffset;
+        const size_t sizeBytes = static_cast<size_t>(t.imageDataSize);
+
+        PreparedTexture &pt = out.pixels;
+        if (Engine::smodel::IsBlockCompressed(t.encoding))
+        {
+            pt.blocks = bytes;
+            pt.blockBytes = sizeBytes;
+            pt.width = t.width;
+            pt.height = t.height;
+            pt.mipLevels = t.mipLevels;
+            return true;
+        }
+        return decodeModelTexture(t, bytes, sizeBytes, pt.rgba, pt.width, pt.height);
+    }
+
+    void AssetManager::finishTextureRestore_Internal(uint64_t id, uint32_t generation, uint32_t baseMip, const TextureReload *reload)
+    {
+        auto it = m_textures.find(id);
+        if (it == m_textures.end() || it->second.generation != generation)
+            return;
+        TextureEntry &e = it->second;
+        e.restorePending = false;
+
+        TextureAsset *tex = e.asset.get();
+        if (!reload || !tex || !tex->isValid() || baseMip >= tex->getBaseMip() || m_uploadBatch)
+            return;
+
+        // The source must still be what was first uploaded (the file may have changed on disk).
+        const PreparedTexture &px = reload->pixels;
+        const bool blocks = (px.blocks != nullptr);
+        if (blocks != tex->isBlockCompressed() || px.width != tex->getFullWidth() || px.height != tex->getFullHeight())
+            return;
+        if (blocks && px.mipLevels != tex->getFullMipLevels())
+            return;
+
+        Engine::UploadContext local{};
+        Engine::UploadContext *upload = beginUpload_Internal(local);
+        if (!upload)
+            return;
+
+        TextureAsset next;
+        bool ok = next.uploadMipTail_Deferred(*upload, *tex, baseMip,
+                                              blocks ? px.blocks : px.rgba.data(),
+                                              blocks ? px.blockBytes : px.rgba.size());
+        ok = endUpload_Internal(*upload) && ok;
+        if (ok)
+        {
+            m_residencyStats.restoredLevels += tex->getBaseMip() - baseMip;
+            tex->swapResidency(next);
+            ++m_textureViewEpoch;
+        }
+        next.destroy(m_device);
+    }
+
+    void AssetManager::requestTextureRestore_Internal(uint64_t id, uint32_t baseMip)
+    {
+        auto it = m_textures.find(id);
+        if (it == m_textures.end())
+            return;
+        TextureEntry &e = it->second;
+        e.restorePending = true;
+
+        const uint32_t generation = e.generation;
+        const std::string path = e.sourcePath;
+        const int32_t sourceTexture = e.sourceTexture;
+        auto reload = std::make_shared<TextureReload>();
+        auto ok = std::make_shared<bool>(false);
+
+        if (!m_jobs)
+        {
+            *ok = prepareTextureReload_Internal(m_packs.get(), path, sourceTexture, *reload);
+            finishTextureRestore_Internal(id, generation, baseMip, *ok ? reload.get() : nullptr);
+            return;
+        }
+
+        JobHandle read = m_jobs->submit([packs = m_packs, path, sourceTexture, reload, ok]()
+                                        { *ok = prepareTextureReload_Internal(packs.get(), path, sourceTexture, *reload); },
+                                        JobPriority::Background);
+
+        std::weak_ptr<int> alive = m_lifetimeToken;
+        m_jobs->thenOnMainThread(read, [this, alive, id, generation, baseMip, reload, ok]()
+                                 {
+                                     if (alive.expired())
+                                         return;
+                                     finishTextureRestore_Internal(id, generation, baseMip, *ok ? reload.get() : nullptr); });
+    }
+
+    void AssetManager::updateTextureResidency()
+    {
+        ++m_residencyFrame;
+        if (!m_residency.enabled || m_uploadBatch)
+            return;
+        if (m_residencyFrame - m_lastResidencyUpdate < std::max(m_residency.updateIntervalFrames, 1u))
+            return;
+        m_lastResidencyUpdate = m_residencyFrame;
+
+        ENGINE_PROFILE_ZONE("AssetManager::updateTextureResidency");
+
+        TextureResidencyStats stats{};
+        stats.trimmedLevels = m_residencyStats.trimmedLevels;
+        stats.restoredLevels = m_residencyStats.restoredLevels;
+        stats.budgetExtension = m_hasMemoryBudget;
+
+        // 1) What each streamed texture needs, from its largest use since the last update.
+        struct Plan
+        {
+            uint64_t id = 0;
+            TextureAsset *tex = nullptr;
+            uint32_t lastUse = 0;
+            uint32_t current = 0;  // resident base mip
+            uint32_t planned = 0;
+            uint32_t coarsest = 0; // pressure never trims past this
+        };
+        std::vector<Plan> plans;
+        uint64_t plannedBytes = 0;
 
-        // 3) Destroy meshes with refCount == 0
-        for (auto it = m_meshes.begin(); it != m_meshes.end();)
+        for (auto &kv : m_textures)
         {
-            if (it->second.refCount == 0)
+            TextureEntry &e = kv.second;
+            TextureAsset *tex = e.asset.get();
+            if (!tex || !tex->isValid())
+                continue;
+
+            const uint64_t resident = tex->getGpuBytes();
+            stats.residentBytes += resident;
+            stats.fullChainBytes += resident + tex->bytesForBaseMip(0) - tex->bytesForBaseMip(tex->getBaseMip());
+
+            if (e.lastUseFrame == 0 || tex->getFullMipLevels() < 2u)
             {
-                if (it->second.asset)
-                    it->second.asset->destroy(m_device);
+                plannedBytes += resident;
+                continue;
+            }
 
-                m_meshPathCache.erase(it->second.path);
-                it = m_meshes.erase(it);
+            stats.streamedTextures += 1u;
+            if (tex->getBaseMip() > 0u)
+                stats.trimmedTextures += 1u;
+
+            if (e.pendingPixels > 0.0f)
+            {
+                e.neededPixels = e.pendingPixels;
+                e.pendingPixels = 0.0f;
             }
-            else
+
+            uint32_t coarsest = 0;
+            while (coarsest + 1u < tex->getFullMipLevels() &&
+                   std::max(tex->getFullWidth() >> coarsest, tex->getFullHeight() >> coarsest) > m_residency.idleMaxDim)
+                ++coarsest;
+
+            const bool idle = (m_residencyFrame - e.lastUseFrame) > m_residency.idleFrames;
+            const uint32_t wanted = idle ? coarsest : std::min(BaseMipForTexels(*tex, e.neededPixels * m_residency.texelsPerPixel), coarsest);
+
+            Plan p;
+            p.id = kv.first;
+            p.tex = tex;
+            p.lastUse = e.lastUseFrame;
+            p.current = tex->getBaseMip();
+            p.planned = wanted;
+            p.coarsest = coarsest;
+            // One level of slack before trimming a texture in use, so zoom jitter does not copy
+            // back and forth; a texture with a restore in flight stays as it is.
+            if (!idle && wanted == p.current + 1u)
+                p.planned = p.current;
+            if (e.restorePending)
             {
-                ++it;
+                stats.pendingRestores += 1u;
+                p.planned = p.current;
+                p.coarsest = p.current;
             }
+            plannedBytes += tex->bytesForBaseMip(p.planned);
+            plans.push_back(p);
         }
 
-        // 4) Destroy textures with refCount == 0
-        for (auto it = m_textures.begin(); it != m_textures.end();)
+        // 2) Bytes left for textures: the process budget minus everything else it holds.
+        const DeviceMemoryBudget mem = QueryDeviceLocalBudget(m_phys, m_hasMemoryBudget);
+        uint64_t usage = mem.usage;
+        if (!mem.fromBudgetExtension)
         {
-            if (it->second.refCount == 0)
+            if (GpuAllocator *allocator = GpuAllocator::forDevice(m_device))
+                usage = allocator->stats().reservedBytes;
+        }
+        const float fraction = std::min(std::max(m_residency.budgetFraction, 0.0f), 1.0f);
+        const uint64_t allowed = static_cast<uint64_t>(static_cast<double>(mem.budget) * fraction);
+        const uint64_t other = (usage > stats.residentBytes) ? usage - stats.residentBytes : 0u;
+        uint64_t target = (allowed > other) ? allowed - other : 0u;
+        if (m_residency.maxTextureBytes > 0u)
+            target = std::min(target, m_residency.maxTextureBytes);
+        stats.targetBytes = target;
+
+        // 3) Over budget: drop one top level per round, least recently used textures first and
+        //    then the largest, until the plan fits or every texture is at its coarsest tail.
+        if (plannedBytes > target)
+        {
+            std::sort(plans.begin(), plans.end(), [](const Plan &a, const Plan &b)
+                      {
+                          if (a.lastUse != b.lastUse)
+                              return a.lastUse < b.lastUse;
+                          return a.tex->bytesForBaseMip(a.planned) > b.tex->bytesForBaseMip(b.planned); });
+
+            bool progress = true;
+            while (plannedBytes > target && progress)
             {
-                if (it->second.asset)
-                    it->second.asset->destroy(m_device);
-                it = m_textures.erase(it);
+                progress = false;
+                for (Plan &p : plans)
+                {
+                    if (p.planned >= p.coarsest)
+                        continue;
+                    plannedBytes -= p.tex->bytesForBaseMip(p.planned) - p.tex->bytesForBaseMip(p.planned + 1u);
+                    p.planned += 1u;
+                    progress = true;
+                    if (plannedBytes <= target)
+                        break;
+                }
             }
+            stats.overBudget = (plannedBytes > target);
+        }
+
+        // 4) Trims: one upload copies every kept tail; then the images swap.
+        Engine::UploadContext local{};
+        Engine::UploadContext *upload = nullptr;
+        std::vector<std::pair<TextureAsset *, std::unique_ptr<TextureAsset>>> swaps;
+        for (const Plan &p : plans)
+        {
+            if (p.planned <= p.current)
+                continue;
+            if (!upload && !(upload = beginUpload_Internal(local)))
+                break;
+            auto next = std::make_unique<TextureAsset>();
+            if (next->copyMipTail_Deferred(*upload, *p.tex, p.planned))
+                swaps.emplace_back(p.tex, std::move(next));
             else
+                next->destroy(m_device); // fails before recording anything
+        }
+        if (upload)
+        {
+            const bool ok = endUpload_Internal(*upload);
+            for (auto &swap : swaps)
             {
-                ++it;
+                if (ok)
+                {
+                    stats.trimmedLevels += swap.second->getBaseMip() - swap.first->getBaseMip();
+                    swap.first->swapResidency(*swap.second);
+                }
+                swap.second->destroy(m_device);
             }
+            if (ok && !swaps.empty())
+                ++m_textureViewEpoch;
+        }
+
+        m_residencyStats = stats;
+
+        // 5) Restores, most recently used first, up to maxRestoreBytesPerUpdate of new levels.
+        std::sort(plans.begin(), plans.end(), [](const Plan &a, const Plan &b)
+                  { return a.lastUse > b.lastUse; });
+        uint64_t restoreBytes = 0;
+        for (const Plan &p : plans)
+        {
+            if (p.planned >= p.current)
+                continue;
+            const uint64_t added = p.tex->bytesForBaseMip(p.planned) - p.tex->bytesForBaseMip(p.current);
+            if (restoreBytes > 0u && restoreBytes + added > m_residency.maxRestoreBytesPerUpdate)
+                break;
+            restoreBytes += added;
+            if (m_jobs)
+                m_residencyStats.pendingRestores += 1u;
+            requestTextureRestore_Internal(p.id, p.planned);
         }
     }
 
-} // namespace Engine
\ No newline at end of file
+} // namespace Engine
@@ -0,0 +1,469 @@
+#include "assets/AssetPack.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace Engine
+{
+    // ------------------------------------------------------------
+    // LZ4 block format (https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md)
+    // ------------------------------------------------------------
+    // Greedy single-probe compressor: its ratio trails the reference encoder a little, but the
+    // output is plain LZ4 and decompression speed, which is all loading sees, is the same.
+    static constexpr size_t LZ4_MIN_MATCH = 4;
+    static constexpr size_t LZ4_LAST_LITERALS = 5; // the last 5 bytes are always literals
+    static constexpr size_t LZ4_MF_LIMIT = 12;     // the last match starts at least 12 bytes before the end
+    static constexpr uint32_t LZ4_HASH_BITS = 12;
+    static constexpr size_t LZ4_MAX_OFFSET = 65535;
+
+    static uint8_t *Lz4WriteLength(uint8_t *op, size_t length)
+    {
+        while (length >= 255)
+        {
+            *op++ = 255;
+            length -= 255;
+        }
+        *op++ = static_cast<uint8_t>(length);
+        return op;
+    }
+
+    // Returns the compressed size, or 0 if it does not fit in dstCapacity.
+    static size_t Lz4CompressBlock(const uint8_t *src, size_t srcSize, uint8_t *dst, size_t dstCapacity)
+    {
+        uint32_t table[1u << LZ4_HASH_BITS] = {};
+        uint8_t *op = dst;
+        uint8_t *const oend = dst + dstCapacity;
+        size_t anchor = 0;
+
+        auto emit = [&](size_t literalLength, size_t offset, size_t matchLength) -> bool
+        {
+            // Worst case: token, literal length bytes, literals, offset, match length bytes.
+            const size_t worst = 1 + literalLength / 255 + 1 + literalLength + 2 + matchLength / 255 + 1;
+            if (worst > static_cast<size_t>(oend - op))
+                return false;
+
+            uint8_t *token = op++;
+            *token = static_cast<uint8_t>(std::min<size_t>(literalLength, 15) << 4);
+            if (literalLength >= 15)
+                op = Lz4WriteLength(op, literalLength - 15);
+            std::memcpy(op, src + anchor, literalLength);
+            op += literalLength;
+
+            if (matchLength == 0) // last sequence: literals only
+                return true;
+
+            *op++ = static_cast<uint8_t>(offset & 0xFFu);
+            *op++ = static_cast<uint8_t>(offset >> 8);
+            const size_t ml = matchLength - LZ4_MIN_MATCH;
+            *token |= static_cast<uint8_t>(std::min<size_t>(ml, 15));
+            if (ml >= 15)
+                op = Lz4WriteLength(op, ml - 15);
+            return true;
+        };
+
+        if (srcSize > LZ4_MF_LIMIT)
+        {
+            const size_t matchLimit = srcSize - LZ4_LAST_LITERALS;
+            const size_t startLimit = srcSize - LZ4_MF_LIMIT;
+            size_t ip = 0;
+            while (ip < startLimit)
+            {
+                uint32_t seq;
+                std::memcpy(&seq, src + ip, sizeof(seq));
+                const uint32_t h = (seq * 2654435761u) >> (32u - LZ4_HASH_BITS);
+                const size_t ref = table[h];
+                table[h] = static_cast<uint32_t>(ip);
+
+                uint32_t refSeq = 0;
+                if (ref < ip && ip - ref <= LZ4_MAX_OFFSET)
+                    std::memcpy(&refSeq, src + ref, sizeof(refSeq));
+                if (ref >= ip || ip - ref > LZ4_MAX_OFFSET || refSeq != seq)
+                {
+                    ++ip;
+                    continue;
+                }
+
+                size_t matchLength = LZ4_MIN_MATCH;
+                while (ip + matchLength < matchLimit && src[ref + matchLength] == src[ip + matchLength])
+                    ++matchLength;
+
+                if (!emit(ip - anchor, ip - ref, matchLength))
+                    return 0;
+                ip += matchLength;
+                anchor = ip;
+            }
+        }
+
+        if (!emit(srcSize - anchor, 0, 0))
+            return 0;
+        return static_cast<size_t>(op - dst);
+    }
+
+    // Decodes exactly dstSize bytes; false on malformed input.
+    static bool Lz4DecompressBlock(const uint8_t *src, size_t srcSize, uint8_t *dst, size_t dstSize)
+    {
+        const uint8_t *ip = src;
+        const uint8_t *const iend = src + srcSize;
+        uint8_t *op = dst;
+        uint8_t *const oend = dst + dstSize;
+
+        auto readLength = [&](size_t &length) -> bool
+        {
+            uint8_t b = 255;
+            while (b == 255)
+            {
+                if (ip >= iend)
+                    return false;
+                b = *ip++;
+                length += b;
+            }
+            return true;
+        };
+
+        while (ip < iend)
+        {
+            const uint8_t token = *ip++;
+
+            size_t literalLength = token >> 4;
+            if (literalLength == 15 && !readLength(literalLength))
+                return false;
+            if (literalLength > static_cast<size_t>(iend - ip) || literalLength > static_cast<size_t>(oend - op))
+                return false;
+            std::memcpy(op, ip, literalLength);
+            op += literalLength;
+            ip += literalLength;
+
+            if (ip == iend) // last sequence
+                break;
+
+            if (iend - ip < 2)
+                return false;
+            const size_t offset = static_cast<size_t>(ip[0]) | (static_cast<size_t>(ip[1]) << 8);
+            ip += 2;
+            if (offset == 0 || offset > static_cast<size_t>(op - dst))
+                return false;
+
+            size_t matchLength = token & 15u;
+            if (matchLength == 15 && !readLength(matchLength))
+                return false;
+            matchLength += LZ4_MIN_MATCH;
+            if (matchLength > static_cast<size_t>(oend - op))
+                return false;
+
+            const uint8_t *match = op - offset;
+            if (offset >= matchLength)
+            {
+                std::memcpy(op, match, matchLength);
+                op += matchLength;
+            }
+            else
+            {
+                // Overlapping copy repeats the last 'offset' bytes.
+                for (size_t i = 0; i < matchLength; ++i)
+                    *op++ = *match++;
+            }
+        }
+        return op == oend;
+    }
+
+    // ------------------------------------------------------------
+    // Paths
+    // ------------------------------------------------------------
+    std::string PackPathNormalize(const std::string &path)
+    {
+        std::string s = path;
+        std::replace(s.begin(), s.end(), '\\', '/');
+        return std::filesystem::path(s).lexically_normal().generic_string();
+    }
+
+    uint64_t PackPathHash(const std::string &normalizedPath)
+    {
+        uint64_t h = 1469598103934665603ull;
+        for (const char c : normalizedPath)
+        {
+            h ^= static_cast<uint8_t>(c);
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+
+    static bool RangeInside(uint64_t offset, uint64_t size, uint64_t total)
+    {
+        return offset <= total && size <= total - offset;
+    }
+
+    // ------------------------------------------------------------
+    // AssetPack
+    // ------------------------------------------------------------
+    bool AssetPack::open(const std::string &path, std::string &outError)
+    {
+        close();
+        outError.clear();
+
+        if (!m_file.open(path))
+        {
+            outError = "Failed to map pack: " + path;
+            return false;
+        }
+
+        const uint8_t *base = m_file.data();
+        const uint64_t size = static_cast<uint64_t>(m_file.size());
+        if (size < sizeof(PackHeader))
+        {
+            outError = "File too small to contain PackHeader.";
+            close();
+            return false;
+        }
+
+        const PackHeader *header = reinterpret_cast<const PackHeader *>(base);
+        if (header->magic != PACK_MAGIC || header->version != PACK_VERSION || header->blockSize == 0)
+        {
+            outError = "Pack header incompatible (bad magic or unsupported version).";
+            close();
+            return false;
+        }
+        if (header->fileSizeBytes != size ||
+            !RangeInside(header->tocOffset, uint64_t(header->entryCount) * sizeof(PackEntryRecord), size) ||
+            header->tocOffset % alignof(PackEntryRecord) != 0 ||
+            !RangeInside(header->stringTableOffset, header->stringTableSize, size))
+        {
+            outError = "Pack TOC or string table out of bounds.";
+            close();
+            return false;
+        }
+
+        const PackEntryRecord *toc = reinterpret_cast<const PackEntryRecord *>(base + header->tocOffset);
+        for (uint32_t i = 0; i < header->entryCount; ++i)
+        {
+            const PackEntryRecord &e = toc[i];
+            if (!RangeInside(e.dataOffset, e.storedSize, size) ||
+                !RangeInside(e.pathOffset, e.pathLength, header->stringTableSize) ||
+                (i > 0 && toc[i - 1].pathHash > e.pathHash))
+            {
+                outError = "Pack entry " + std::to_string(i) + " is malformed.";
+                close();
+                return false;
+            }
+        }
+
+        m_path = path;
+        m_header = header;
+        m_toc = toc;
+        m_strings = reinterpret_cast<const char *>(base + header->stringTableOffset);
+        return true;
+    }
+
+    void AssetPack::close()
+    {
+        m_file.close();
+        m_path.clear();
+        m_header = nullptr;
+        m_toc = nullptr;
+        m_strings = nullptr;
+    }
+
+    const PackEntryRecord *AssetPack::find(const std::string &path) const
+    {
+        if (!m_header)
+            return nullptr;
+
+        const std::string key = PackPathNormalize(path);
+        const uint64_t hash = PackPathHash(key);
+        const PackEntryRecord *end = m_toc + m_header->entryCount;
+        const PackEntryRecord *it = std::lower_bound(m_toc, end, hash, [](const PackEntryRecord &e, uint64_t h)
+                                                     { return e.pathHash < h; });
+        for (; it != end && it->pathHash == hash; ++it)
+        {
+            if (it->pathLength == key.size() && std::memcmp(m_strings + it->pathOffset, key.data(), key.size()) == 0)
+                return it;
+        }
+        return nullptr;
+    }
+
+    const uint8_t *AssetPack::data(const PackEntryRecord &entry) const
+    {
+        if (!m_header || (entry.flags & PACK_ENTRY_LZ4))
+            return nullptr;
+        return m_file.data() + entry.dataOffset;
+    }
+
+    bool AssetPack::read(const PackEntryRecord &entry, std::vector<uint8_t> &out) const
+    {
+        if (!m_header)
+            return false;
+
+        const uint8_t *stored = m_file.data() + entry.dataOffset;
+        out.resize(static_cast<size_t>(entry.rawSize));
+        if (!(entry.flags & PACK_ENTRY_LZ4))
+        {
+            if (entry.storedSize != entry.rawSize)
+                return false;
+            if (!out.empty())
+                std::memcpy(out.data(), stored, out.size());
+            return true;
+        }
+
+        const uint64_t blockSize = m_header->blockSize;
+        const uint64_t blockCount = (entry.rawSize + blockSize - 1) / blockSize;
+        if (blockCount * sizeof(uint32_t) > entry.storedSize)
+            return false;
+
+        const uint8_t *cursor = stored + blockCount * sizeof(uint32_t);
+        const uint8_t *const end = stored + entry.storedSize;
+        for (uint64_t b = 0; b < blockCount; ++b)
+        {
+            uint32_t word;
+            std::memcpy(&word, stored + b * sizeof(uint32_t), sizeof(word));
+            const size_t blockBytes = word & ~PACK_BLOCK_STORED_RAW;
+            const size_t rawBytes = static_cast<size_t>(std::min(blockSize, entry.rawSize - b * blockSize));
+            if (blockBytes > static_cast<size_t>(end - cursor))
+                return false;
+
+            uint8_t *dst = out.data() + b * blockSize;
+            if (word & PACK_BLOCK_STORED_RAW)
+            {
+                if (blockBytes != rawBytes)
+                    return false;
+                std::memcpy(dst, cursor, rawBytes);
+            }
+            else if (!Lz4DecompressBlock(cursor, blockBytes, dst, rawBytes))
+            {
+                return false;
+            }
+            cursor += blockBytes;
+        }
+        return true;
+    }
+
+    std::string AssetPack::entryPath(const PackEntryRecord &entry) const
+    {
+        if (!m_strings)
+            return {};
+        return std::string(m_strings + entry.pathOffset, entry.pathLength);
+    }
+
+    // ------------------------------------------------------------
+    // AssetPackWriter
+    // ------------------------------------------------------------
+    void AssetPackWriter::add(const std::string &path, std::vector<uint8_t> bytes, bool compress)
+    {
+        const std::string key = PackPathNormalize(path);
+        auto found = m_index.find(key);
+        if (found != m_index.end())
+        {
+            m_entries[found->second].bytes = std::move(bytes);
+            m_entries[found->second].compress = compress;
+            return;
+        }
+        m_index.emplace(key, m_entries.size());
+        m_entries.push_back(PendingEntry{key, std::move(bytes), compress});
+    }
+
+    // LZ4 blocks of PACK_BLOCK_SIZE, or empty when nothing shrinks (store the entry raw).
+    static std::vector<uint8_t> CompressEntry(const std::vector<uint8_t> &raw)
+    {
+        const size_t blockCount = (raw.size() + PACK_BLOCK_SIZE - 1) / PACK_BLOCK_SIZE;
+        std::vector<uint8_t> out(blockCount * sizeof(uint32_t));
+        std::vector<uint8_t> scratch(PACK_BLOCK_SIZE);
+        bool anyCompressed = false;
+
+        for (size_t b = 0; b < blockCount; ++b)
+        {
+            const uint8_t *src = raw.data() + b * PACK_BLOCK_SIZE;
+            const size_t rawBytes = std::min<size_t>(PACK_BLOCK_SIZE, raw.size() - b * PACK_BLOCK_SIZE);
+
+            // Must beat the raw size to be worth a decode.
+            const size_t packed = Lz4CompressBlock(src, rawBytes, scratch.data(), rawBytes - 1);
+            uint32_t word;
+            if (packed != 0)
+            {
+                word = static_cast<uint32_t>(packed);
+                out.insert(out.end(), scratch.begin(), scratch.begin() + packed);
+                anyCompressed = true;
+            }
+            else
+            {
+                word = static_cast<uint32_t>(rawBytes) | PACK_BLOCK_STORED_RAW;
+                out.insert(out.end(), src, src + rawBytes);
+            }
+            std::memcpy(out.data() + b * sizeof(uint32_t), &word, sizeof(word));
+        }
+
+        if (!anyCompressed)
+            out.clear();
+        return out;
+    }
+
+    bool AssetPackWriter::write(const std::string &outPath, std::string &outError) const
+    {
+        outError.clear();
+
+        std::ofstream out(outPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open())
+        {
+            outError = "Failed to create pack: " + outPath;
+            return false;
+        }
+
+        auto alignTo = [&out](uint64_t alignment)
+        {
+            const uint64_t pos = static_cast<uint64_t>(out.tellp());
+            const uint64_t pad = (alignment - pos % alignment) % alignment;
+            static const char zeros[PACK_ALIGNMENT] = {};
+            out.write(zeros, static_cast<std::streamsize>(pad));
+        };
+
+        PackHeader header{};
+        header.entryCount = static_cast<uint32_t>(m_entries.size());
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+        std::vector<PackEntryRecord> toc;
+        std::string strings;
+        toc.reserve(m_entries.size());
+        for (const PendingEntry &e : m_entries)
+        {
+            std::vector<uint8_t> packed;
+            if (e.compress && !e.bytes.empty())
+                packed = CompressEntry(e.bytes);
+            const std::vector<uint8_t> &stored = packed.empty() ? e.bytes : packed;
+
+            alignTo(PACK_ALIGNMENT);
+            PackEntryRecord r{};
+            r.pathHash = PackPathHash(e.path);
+            r.dataOffset = static_cast<uint64_t>(out.tellp());
+            r.storedSize = stored.size();
+            r.rawSize = e.bytes.size();
+            r.pathOffset = static_cast<uint32_t>(strings.size());
+            r.pathLength = static_cast<uint32_t>(e.path.size());
+            r.flags = packed.empty() ? 0u : PACK_ENTRY_LZ4;
+            out.write(reinterpret_cast<const char *>(stored.data()), static_cast<std::streamsize>(stored.size()));
+            strings += e.path;
+            toc.push_back(r);
+        }
+
+        std::stable_sort(toc.begin(), toc.end(), [](const PackEntryRecord &a, const PackEntryRecord &b)
+                         { return a.pathHash < b.pathHash; });
+
+        alignTo(alignof(PackEntryRecord));
+        header.tocOffset = static_cast<uint64_t>(out.tellp());
+        out.write(reinterpret_cast<const char *>(toc.data()), static_cast<std::streamsize>(toc.size() * sizeof(PackEntryRecord)));
+
+        header.stringTableOffset = static_cast<uint64_t>(out.tellp());
+        header.stringTableSize = strings.size();
+        out.write(strings.data(), static_cast<std::streamsize>(strings.size()));
+
+        header.fileSizeBytes = static_cast<uint64_t>(out.tellp());
+        out.seekp(0);
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+        if (!out)
+        {
+            outError = "Failed to write pack: " + outPath;
+            return false;
+        }
+        return true;
+    }
+
+} // namespace Engine
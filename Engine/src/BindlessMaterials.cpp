@@ -0,0 +1,284 @@
+#include "Engine/BindlessMaterials.h"
+#include "Engine/VulkanContext.h"
+#include "assets/AssetManager.h"
+#include "assets/MaterialAsset.h"
+#include "utils/BufferUtils.h"
+#include "utils/ImageUtils.h"
+#include "utils/MemoryReport.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
+#include <iostream>
+#endif
+
+namespace Engine
+{
+    bool BindlessMaterials::create(VulkanContext &ctx)
+    {
+        m_device = ctx.GetDevice();
+
+        std::array<VkDescriptorSetLayoutBinding, 2> bindings{};
+        bindings[0].binding = 0;
+        bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        bindings[0].descriptorCount = MAX_TEXTURES;
+        bindings[0].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+        bindings[1].binding = 1;
+        bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[1].descriptorCount = 1;
+        bindings[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+        // Textures register while frames using the set are in flight; unregistered slots stay empty.
+        const std::array<VkDescriptorBindingFlagsEXT, 2> bindingFlags = {
+            VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT |
+                VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT,
+            0u};
+        VkDescriptorSetLayoutBindingFlagsCreateInfoEXT flagsInfo{};
+        flagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+        flagsInfo.bindingCount = static_cast<uint32_t>(bindingFlags.size());
+        flagsInfo.pBindingFlags = bindingFlags.data();
+
+        VkDescriptorSetLayoutCreateInfo dsl{};
+        dsl.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        dsl.pNext = &flagsInfo;
+        dsl.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT;
+        dsl.bindingCount = static_cast<uint32_t>(bindings.size());
+        dsl.pBindings = bindings.data();
+        if (vkCreateDescriptorSetLayout(m_device, &dsl, nullptr, &m_layout) != VK_SUCCESS)
+            return false;
+
+        std::array<VkDescriptorPoolSize, 2> poolSizes{};
+        poolSizes[0] = {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, MAX_TEXTURES};
+        poolSizes[1] = {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1};
+
+        VkDescriptorPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT;
+        poolInfo.maxSets = 1;
+        poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+        poolInfo.pPoolSizes = poolSizes.data();
+        if (vkCreateDescriptorPool(m_device, &poolInfo, nullptr, &m_pool) != VK_SUCCESS)
+            return false;
+
+        VkDescriptorSetAllocateInfo alloc{};
+        alloc.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        alloc.descriptorPool = m_pool;
+        alloc.descriptorSetCount = 1;
+        alloc.pSetLayouts = &m_layout;
+        if (vkAllocateDescriptorSets(m_device, &alloc, &m_set) != VK_SUCCESS)
+            return false;
+
+        // Materials are written once on registration and never change: host-visible is enough.
+        const VkDeviceSize materialBytes = static_cast<VkDeviceSize>(MAX_MATERIALS) * sizeof(GpuMaterial);
+        if (CreateBuffer(m_device, ctx.GetPhysicalDevice(), materialBytes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                         m_materialBuffer, m_materialMemory) != VK_SUCCESS)
+            return false;
+        m_materialsMapped = static_cast<GpuMaterial *>(m_materialMemory.mapped);
+        if (!m_materialsMapped)
+            return false;
+
+        VkDescriptorBufferInfo mbi{};
+        mbi.buffer = m_materialBuffer;
+        mbi.offset = 0;
+        mbi.range = materialBytes;
+
+        VkWriteDescriptorSet write{};
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = m_set;
+        write.dstBinding = 1;
+        write.dstArrayElement = 0;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        write.descriptorCount = 1;
+        write.pBufferInfo = &mbi;
+        vkUpdateDescriptorSets(m_device, 1, &write, 0, nullptr);
+
+        // Fallback 1x1 white texture (sRGB) at index 0.
+        {
+            VkCommandPoolCreateInfo cpInfo{};
+            cpInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+            cpInfo.queueFamilyIndex = ctx.GetGraphicsQueueFamilyIndex();
+            cpInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+            VkCommandPool uploadPool = VK_NULL_HANDLE;
+            if (vkCreateCommandPool(m_device, &cpInfo, nullptr, &uploadPool) != VK_SUCCESS)
+                return false;
+
+            UploadContext upload{};
+            bool ok = BeginUploadContext(upload, m_device, ctx.GetPhysicalDevice(), uploadPool, ctx.GetGraphicsQueue());
+            const uint8_t white[4] = {255, 255, 255, 255};
+            ok = ok && m_fallbackTexture.uploadRGBA8_Deferred(upload, white, 1, 1, true,
+                                                              VK_SAMPLER_ADDRESS_MODE_REPEAT, VK_SAMPLER_ADDRESS_MODE_REPEAT,
+                                                              VK_FILTER_LINEAR, VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_NEAREST, 1.0f);
+            ok = ok && EndSubmitAndWait(upload);
+            vkDestroyCommandPool(m_device, uploadPool, nullptr);
+            if (!ok)
+                return false;
+        }
+        writeTexture(FALLBACK_INDEX, m_fallbackTexture.getView(), m_fallbackTexture.getSampler());
+        m_textureCount = 1;
+
+        m_materialsMapped[FALLBACK_INDEX] = GpuMaterial{};
+        m_materialCount = 1;
+        return true;
+    }
+
+    void BindlessMaterials::destroy()
+    {
+        // Called after the device went idle.
+        m_textureIndex.clear();
+        m_materialIndex.clear();
+        m_textureCount = 0;
+        m_materialCount = 0;
+        if (m_device == VK_NULL_HANDLE)
+            return;
+
+        m_materialsMapped = nullptr;
+        DestroyBuffer(m_device, m_materialBuffer, m_materialMemory);
+        if (m_fallbackTexture.isValid())
+            m_fallbackTexture.destroy(m_device);
+
+        if (m_pool != VK_NULL_HANDLE)
+        {
+            vkDestroyDescriptorPool(m_device, m_pool, nullptr); // frees m_set
+            m_pool = VK_NULL_HANDLE;
+            m_set = VK_NULL_HANDLE;
+        }
+        if (m_layout != VK_NULL_HANDLE)
+        {
+            vkDestroyDescriptorSetLayout(m_device, m_layout, nullptr);
+            m_layout = VK_NULL_HANDLE;
+        }
+        m_device = VK_NULL_HANDLE;
+    }
+
+    void BindlessMaterials::writeTexture(uint32_t index, VkImageView view, VkSampler sampler)
+    {
+        VkDescriptorImageInfo di{};
+        di.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        di.imageView = view;
+        di.sampler = sampler;
+
+        VkWriteDescriptorSet write{};
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = m_set;
+        write.dstBinding = 0;
+        write.dstArrayElement = index;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        write.descriptorCount = 1;
+        write.pImageInfo = &di;
+        vkUpdateDescriptorSets(m_device, 1, &write, 0, nullptr);
+    }
+
+    uint32_t BindlessMaterials::textureIndex(AssetManager &assets, TextureHandle h)
+    {
+        if (!h.isValid())
+            return FALLBACK_INDEX;
+
+        auto it = m_textureIndex.find(h.id);
+        if (it != m_textureIndex.end())
+            return it->second;
+
+        TextureAsset *tex = assets.getTexture(h);
+        if (!tex || tex->getView() == VK_NULL_HANDLE || tex->getSampler() == VK_NULL_HANDLE)
+            return FALLBACK_INDEX; // not uploaded yet: ask again next time
+        if (m_textureCount >= MAX_TEXTURES)
+        {
+#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
+            if (!m_warnedFull)
+                std::cerr << "[BindlessMaterials] texture table full (" << MAX_TEXTURES << "), using the fallback\n";
+#endif
+            m_warnedFull = true;
+            return FALLBACK_INDEX;
+        }
+
+        const uint32_t index = m_textureCount++;
+        writeTexture(index, tex->getView(), tex->getSampler());
+        m_textureIndex.emplace(h.id, index);
+        if (m_slotTextures.size() <= index)
+        {
+            m_slotTextures.resize(static_cast<size_t>(index) + 1u);
+            m_slotViews.resize(static_cast<size_t>(index) + 1u, VK_NULL_HANDLE);
+        }
+        m_slotTextures[index] = h;
+        m_slotViews[index] = tex->getView();
+        return index;
+    }
+
+    void BindlessMaterials::refreshTextures(AssetManager &assets)
+    {
+        m_textureEpoch = assets.textureViewEpoch();
+        const uint32_t count = std::min<uint32_t>(m_textureCount, static_cast<uint32_t>(m_slotTextures.size()));
+        for (uint32_t index = FALLBACK_INDEX + 1u; index < count; ++index)
+        {
+            TextureAsset *tex = assets.getTexture(m_slotTextures[index]);
+            if (!tex || tex->getView() == VK_NULL_HANDLE || tex->getView() == m_slotViews[index])
+                continue;
+            writeTexture(index, tex->getView(), tex->getSampler());
+            m_slotViews[index] = tex->getView();
+        }
+    }
+
+    uint32_t BindlessMaterials::materialIndex(AssetManager &assets, MaterialHandle h)
+    {
+        if (!h.isValid() || !m_materialsMapped)
+            return FALLBACK_INDEX;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (assets.textureViewEpoch() != m_textureEpoch)
+            refreshTextures(assets);
+
+        auto it = m_materialIndex.find(h.id);
+        if (it != m_materialIndex.end())
+            return it->second;
+
+        const MaterialAsset *mat = assets.getMaterial(h);
+        if (!mat)
+            return FALLBACK_INDEX;
+        if (m_materialCount >= MAX_MATERIALS)
+        {
+#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
+            if (!m_warnedFull)
+                std::cerr << "[BindlessMaterials] material table full (" << MAX_MATERIALS << "), using the fallback\n";
+#endif
+            m_warnedFull = true;
+            return FALLBACK_INDEX;
+        }
+
+        GpuMaterial gm{};
+        std::memcpy(gm.baseColorFactor, mat->baseColorFactor, sizeof(mat->baseColorFactor));
+        std::memcpy(gm.emissiveFactor, mat->emissiveFactor, sizeof(mat->emissiveFactor));
+        gm.params[0] = mat->alphaCutoff;
+        gm.params[1] = static_cast<float>(mat->alphaMode);
+        gm.params[2] = mat->metallicFactor;
+        gm.params[3] = mat->roughnessFactor;
+        gm.textures[0] = textureIndex(assets, mat->baseColorTexture);
+        gm.textures[1] = textureIndex(assets, mat->normalTexture);
+        gm.textures[2] = textureIndex(assets, mat->metallicRoughnessTexture);
+        gm.textures[3] = textureIndex(assets, mat->occlusionTexture);
+        gm.textures[4] = textureIndex(assets, mat->emissiveTexture);
+
+        // A texture still streaming in would be baked in as the fallback: retry later instead.
+        auto pending = [&](TextureHandle t, uint32_t index)
+        { return t.isValid() && index == FALLBACK_INDEX && m_textureCount < MAX_TEXTURES; };
+        if (pending(mat->baseColorTexture, gm.textures[0]) || pending(mat->normalTexture, gm.textures[1]) ||
+            pending(mat->metallicRoughnessTexture, gm.textures[2]) || pending(mat->occlusionTexture, gm.textures[3]) ||
+            pending(mat->emissiveTexture, gm.textures[4]))
+            return FALLBACK_INDEX;
+
+        const uint32_t index = m_materialCount++;
+        m_materialsMapped[index] = gm;
+        m_materialIndex.emplace(h.id, index);
+        return index;
+    }
+
+    void BindlessMaterials::reportMemory(MemoryReport &out) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const uint64_t mapBytes = (m_textureIndex.size() + m_materialIndex.size()) * (sizeof(std::pair<const uint64_t, uint32_t>) + sizeof(void *)) +
+                                  (m_textureIndex.bucket_count() + m_materialIndex.bucket_count()) * sizeof(void *);
+        out.add("Render", "Bindless materials", mapBytes, m_materialMemory.size + m_fallbackTexture.getGpuBytes(), m_materialCount);
+    }
+}
@@ -1,208 +1,142 @@
 #include "utils/BufferUtils.h"
 #include <cstring>
-#include <stdexcept>
 
 namespace Engine
 {
-    static uint32_t findMemoryType(VkPhysicalDevice phys, uint32_t typeFilter, VkMemoryPropertyFlags properties)
-    {
-        VkPhysicalDeviceMemoryProperties memProps;
-        vkGetPhysicalDeviceMemoryProperties(phys, &memProps);
-        for (uint32_t i = 0; i < memProps.memoryTypeCount; ++i)
-        {
-            if ((typeFilter & (1u << i)) && (memProps.memoryTypes[i].propertyFlags & properties) == properties)
-            {
-                return i;
-            }
-        }
-        throw std::runtime_error("Failed to find suitable memory type");
-    }
-
-    VkResult CreateOrUpdateVertexBuffer(
+    VkResult CreateBuffer(
         VkDevice device,
         VkPhysicalDevice physicalDevice,
-        const void *vertexData,
-        VkDeviceSize dataSize,
-        VertexBufferHandle &handle)
+        VkDeviceSize size,
+        VkBufferUsageFlags usage,
+        VkMemoryPropertyFlags properties,
+        VkBuffer &outBuffer,
+        GpuAllocation &outMemory,
+        uint32_t queueFamilyCount,
+        const uint32_t *queueFamilies)
     {
-        if (!vertexData || dataSize == 0)
-        {
-            return VK_ERROR_INITIALIZATION_FAILED;
-        }
+        VkBufferCreateInfo bi{};
+        bi.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        bi.size = size;
+        bi.usage = usage;
+        bi.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
-        bool needCreate = (handle.buffer == VK_NULL_HANDLE);
-        VkMemoryRequirements req{};
-        if (!needCreate)
+        // Concurrent only across distinct families (the same family twice is invalid).
+        if (queueFamilyCount > 1 && queueFamilies)
         {
-            vkGetBufferMemoryRequirements(device, handle.buffer, &req);
-            if (req.size < dataSize)
+            bool distinct = true;
+            for (uint32_t i = 1; i < queueFamilyCount && distinct; ++i)
             {
-                vkDestroyBuffer(device, handle.buffer, nullptr);
-                handle.buffer = VK_NULL_HANDLE;
-                vkFreeMemory(device, handle.memory, nullptr);
-                handle.memory = VK_NULL_HANDLE;
-                needCreate = true;
+                for (uint32_t j = 0; j < i; ++j)
+                {
+                    if (queueFamilies[i] == queueFamilies[j])
+                    {
+                        distinct = false;
+                        break;
+                    }
+                }
             }
-        }
-
-        if (needCreate)
-        {
-            VkBufferCreateInfo bi{};
-            bi.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-            bi.size = dataSize;
-            // Include TRANSFER_SRC so this host-visible buffer can be the staging source.
-            bi.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-            bi.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-            VkBuffer buffer = VK_NULL_HANDLE;
-            VkResult r = vkCreateBuffer(device, &bi, nullptr, &buffer);
-            if (r != VK_SUCCESS)
-                return r;
-
-            vkGetBufferMemoryRequirements(device, buffer, &req);
-
-            VkMemoryAllocateInfo ai{};
-            ai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-            ai.allocationSize = req.size;
-            ai.memoryTypeIndex = findMemoryType(physicalDevice, req.memoryTypeBits,
-                                                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-            VkDeviceMemory mem = VK_NULL_HANDLE;
-            r = vkAllocateMemory(device, &ai, nullptr, &mem);
-            if (r != VK_SUCCESS)
+            if (distinct)
             {
-                vkDestroyBuffer(device, buffer, nullptr);
-                return r;
-            }
-
-            r = vkBindBufferMemory(device, buffer, mem, 0);
-            if (r != VK_SUCCESS)
-            {
-                vkDestroyBuffer(device, buffer, nullptr);
-                vkFreeMemory(device, mem, nullptr);
-                return r;
+                bi.sharingMode = VK_SHARING_MODE_CONCURRENT;
+                bi.queueFamilyIndexCount = queueFamilyCount;
+                bi.pQueueFamilyIndices = queueFamilies;
             }
-
-            handle.buffer = buffer;
-            handle.memory = mem;
         }
 
-        void *mapped = nullptr;
-        VkResult r = vkMapMemory(device, handle.memory, 0, dataSize, 0, &mapped);
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkResult r = vkCreateBuffer(device, &bi, nullptr, &buffer);
+        if (r != VK_SUCCESS)
+            return r;
+
+        r = AllocateBufferMemory(device, physicalDevice, buffer, properties, outMemory);
         if (r != VK_SUCCESS)
+        {
+            vkDestroyBuffer(device, buffer, nullptr);
             return r;
-        std::memcpy(mapped, vertexData, static_cast<size_t>(dataSize));
-        vkUnmapMemory(device, handle.memory);
+        }
 
+        outBuffer = buffer;
         return VK_SUCCESS;
     }
 
-    void DestroyVertexBuffer(VkDevice device, VertexBufferHandle &handle)
+    void DestroyBuffer(VkDevice device, VkBuffer &buffer, GpuAllocation &memory)
     {
-        if (handle.buffer != VK_NULL_HANDLE)
-        {
-            vkDestroyBuffer(device, handle.buffer, nullptr);
-            handle.buffer = VK_NULL_HANDLE;
-        }
-        if (handle.memory != VK_NULL_HANDLE)
+        if (buffer != VK_NULL_HANDLE)
         {
-            vkFreeMemory(device, handle.memory, nullptr);
-            handle.memory = VK_NULL_HANDLE;
+            vkDestroyBuffer(device, buffer, nullptr);
+            buffer = VK_NULL_HANDLE;
         }
+        FreeGpuMemory(device, memory);
     }
 
-    // Index buffer (host-visible, also a staging source)
-    VkResult CreateOrUpdateIndexBuffer(
+    // Shared by the host-visible vertex/index paths: (re)create when too small, then copy in.
+    static VkResult createOrUpdateHostBuffer(
         VkDevice device,
         VkPhysicalDevice physicalDevice,
-        const void *indexData,
+        const void *data,
         VkDeviceSize dataSize,
-        IndexBufferHandle &handle)
+        VkBufferUsageFlags usage,
+        VkBuffer &buffer,
+        GpuAllocation &memory)
     {
-        if (!indexData || dataSize == 0)
+        if (!data || dataSize == 0)
         {
             return VK_ERROR_INITIALIZATION_FAILED;
         }
 
-        bool needCreate = (handle.buffer == VK_NULL_HANDLE);
-        VkMemoryRequirements req{};
-        if (!needCreate)
+        if (buffer != VK_NULL_HANDLE && memory.size < dataSize)
         {
-            vkGetBufferMemoryRequirements(device, handle.buffer, &req);
-            if (req.size < dataSize)
-            {
-                vkDestroyBuffer(device, handle.buffer, nullptr);
-                handle.buffer = VK_NULL_HANDLE;
-                vkFreeMemory(device, handle.memory, nullptr);
-                handle.memory = VK_NULL_HANDLE;
-                needCreate = true;
-            }
+            DestroyBuffer(device, buffer, memory);
         }
 
-        if (needCreate)
+        if (buffer == VK_NULL_HANDLE)
         {
-            VkBufferCreateInfo bi{};
-            bi.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-            bi.size = dataSize;
             // Include TRANSFER_SRC so this host-visible buffer can be the staging source.
-            bi.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-            bi.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-            VkBuffer buffer = VK_NULL_HANDLE;
-            VkResult r = vkCreateBuffer(device, &bi, nullptr, &buffer);
+            VkResult r = CreateBuffer(device, physicalDevice, dataSize, usage | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                      buffer, memory);
             if (r != VK_SUCCESS)
                 return r;
+        }
 
-            vkGetBufferMemoryRequirements(device, buffer, &req);
-
-            VkMemoryAllocateInfo ai{};
-            ai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-            ai.allocationSize = req.size;
-            ai.memoryTypeIndex = findMemoryType(physicalDevice, req.memoryTypeBits,
-                                                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-            VkDeviceMemory mem = VK_NULL_HANDLE;
-            r = vkAllocateMemory(device, &ai, nullptr, &mem);
-            if (r != VK_SUCCESS)
-            {
-                vkDestroyBuffer(device, buffer, nullptr);
-                return r;
-            }
+        if (!memory.mapped)
+            return VK_ERROR_MEMORY_MAP_FAILED;
+        std::memcpy(memory.mapped, data, static_cast<size_t>(dataSize));
 
-            r = vkBindBufferMemory(device, buffer, mem, 0);
-            if (r != VK_SUCCESS)
-            {
-                vkDestroyBuffer(device, buffer, nullptr);
-                vkFreeMemory(device, mem, nullptr);
-                return r;
-            }
+        return VK_SUCCESS;
+    }
 
-            handle.buffer = buffer;
-            handle.memory = mem;
-        }
+    VkResult CreateOrUpdateVertexBuffer(
+        VkDevice device,
+        VkPhysicalDevice physicalDevice,
+        const void *vertexData,
+        VkDeviceSize dataSize,
+        VertexBufferHandle &handle)
+    {
+        return createOrUpdateHostBuffer(device, physicalDevice, vertexData, dataSize,
+                                        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, handle.buffer, handle.memory);
+    }
 
-        void *mapped = nullptr;
-        VkResult r = vkMapMemory(device, handle.memory, 0, dataSize, 0, &mapped);
-        if (r != VK_SUCCESS)
-            return r;
-        std::memcpy(mapped, indexData, static_cast<size_t>(dataSize));
-        vkUnmapMemory(device, handle.memory);
+    void DestroyVertexBuffer(VkDevice device, VertexBufferHandle &handle)
+    {
+        DestroyBuffer(device, handle.buffer, handle.memory);
+    }
 
-        return VK_SUCCESS;
+    // Index buffer (host-visible, also a staging source)
+    VkResult CreateOrUpdateIndexBuffer(
+        VkDevice device,
+        VkPhysicalDevice physicalDevice,
+        const void *indexData,
+        VkDeviceSize dataSize,
+        IndexBufferHandle &handle)
+    {
+        return createOrUpdateHostBuffer(device, physicalDevice, indexData, dataSize,
+                                        VK_BUFFER_USAGE_INDEX_BUFFER_BIT, handle.buffer, handle.memory);
     }
 
     void DestroyIndexBuffer(VkDevice device, IndexBufferHandle &handle)
     {
-        if (handle.buffer != VK_NULL_HANDLE)
-        {
-            vkDestroyBuffer(device, handle.buffer, nullptr);
-            handle.buffer = VK_NULL_HANDLE;
-        }
-        if (handle.memory != VK_NULL_HANDLE)
-        {
-            vkFreeMemory(device, handle.memory, nullptr);
-            handle.memory = VK_NULL_HANDLE;
-        }
+        DestroyBuffer(device, handle.buffer, handle.memory);
     }
 
     // Device-local buffer creation (not mappable)
@@ -212,47 +146,13 @@ namespace Engine
         VkDeviceSize size,
         VkBufferUsageFlags usage,
         VkBuffer &outBuffer,
-        VkDeviceMemory &outMemory)
+        GpuAllocation &outMemory,
+        uint32_t queueFamilyCount,
+        const uint32_t *queueFamilies)
     {
-        VkBufferCreateInfo bi{};
-        bi.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-        bi.size = size;
-        bi.usage = usage; // caller must include VK_BUFFER_USAGE_TRANSFER_DST_BIT
-        bi.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-        VkBuffer buffer = VK_NULL_HANDLE;
-        VkResult r = vkCreateBuffer(device, &bi, nullptr, &buffer);
-        if (r != VK_SUCCESS)
-            return r;
-
-        VkMemoryRequirements req{};
-        vkGetBufferMemoryRequirements(device, buffer, &req);
-
-        VkMemoryAllocateInfo ai{};
-        ai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        ai.allocationSize = req.size;
-        ai.memoryTypeIndex = findMemoryType(physicalDevice, req.memoryTypeBits,
-                                            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-
-        VkDeviceMemory mem = VK_NULL_HANDLE;
-        r = vkAllocateMemory(device, &ai, nullptr, &mem);
-        if (r != VK_SUCCESS)
-        {
-            vkDestroyBuffer(device, buffer, nullptr);
-            return r;
-        }
-
-        r = vkBindBufferMemory(device, buffer, mem, 0);
-        if (r != VK_SUCCESS)
-        {
-            vkDestroyBuffer(device, buffer, nullptr);
-            vkFreeMemory(device, mem, nullptr);
-            return r;
-        }
-
-        outBuffer = buffer;
-        outMemory = mem;
-        return VK_SUCCESS;
+        // caller must include VK_BUFFER_USAGE_TRANSFER_DST_BIT
+        return CreateBuffer(device, physicalDevice, size, usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, outBuffer, outMemory,
+                            queueFamilyCount, queueFamilies);
     }
 
     // One-shot buffer copy (submit and wait idle)
@@ -0,0 +1,355 @@
+#include "utils/CpuTopology.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <thread>
+#include <tuple>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <fstream>
+#include <string>
+#endif
+
+namespace Engine
+{
+    namespace
+    {
+#if defined(__linux__)
+        bool readText(const std::string &path, std::string &out)
+        {
+            std::ifstream in(path);
+            if (!in)
+                return false;
+            std::getline(in, out);
+            return true;
+        }
+
+        bool readUint(const std::string &path, uint32_t &out)
+        {
+            std::string s;
+            if (!readText(path, s) || s.empty())
+                return false;
+            out = static_cast<uint32_t>(std::strtoul(s.c_str(), nullptr, 10));
+            return true;
+        }
+
+        // sysfs CPU list: "0-3,8,10-11".
+        std::vector<uint32_t> parseCpuList(const std::string &list)
+        {
+            std::vector<uint32_t> out;
+            size_t pos = 0;
+            while (pos < list.size())
+            {
+                size_t comma = list.find(',', pos);
+                if (comma == std::string::npos)
+                    comma = list.size();
+                const std::string part = list.substr(pos, comma - pos);
+                const size_t dash = part.find('-');
+                if (!part.empty())
+                {
+                    const uint32_t first = static_cast<uint32_t>(std::strtoul(part.c_str(), nullptr, 10));
+                    const uint32_t last = (dash == std::string::npos)
+                                              ? first
+                                              : static_cast<uint32_t>(std::strtoul(part.c_str() + dash + 1, nullptr, 10));
+                    for (uint32_t c = first; c <= last && c < 4096u; ++c)
+                        out.push_back(c);
+                }
+                pos = comma + 1;
+            }
+            return out;
+        }
+
+        bool detectLinux(CpuTopology &t)
+        {
+            std::string online;
+            if (!readText("/sys/devices/system/cpu/online", online))
+                return false;
+            const std::vector<uint32_t> ids = parseCpuList(online);
+            if (ids.empty())
+                return false;
+
+            // Intel hybrid parts expose one PMU per core type.
+            std::vector<uint32_t> atomCpus;
+            std::string atom;
+            if (readText("/sys/devices/cpu_atom/cpus", atom))
+                atomCpus = parseCpuList(atom);
+
+            std::map<uint32_t, uint32_t> capacities; // ARM big.LITTLE: cpu_capacity per id
+            std::map<std::pair<uint32_t, uint32_t>, uint32_t> coreIndex;
+            for (uint32_t id : ids)
+            {
+                const std::string base = "/sys/devices/system/cpu/cpu" + std::to_string(id);
+                CpuTopology::LogicalCpu cpu;
+                cpu.id = id;
+                uint32_t coreId = id;
+                (void)readUint(base + "/topology/core_id", coreId);
+                (void)readUint(base + "/topology/physical_package_id", cpu.package);
+                const auto key = std::make_pair(cpu.package, coreId);
+                auto it = coreIndex.emplace(key, static_cast<uint32_t>(coreIndex.size())).first;
+                cpu.core = it->second;
+
+                uint32_t capacity = 0;
+                if (readUint(base + "/cpu_capacity", capacity))
+                    capacities[id] = capacity;
+                if (!atomCpus.empty())
+                    cpu.efficiencyClass = std::find(atomCpus.begin(), atomCpus.end(), id) != atomCpus.end() ? 0u : 1u;
+                t.cpus.push_back(cpu);
+            }
+
+            if (atomCpus.empty() && !capacities.empty())
+            {
+                // Rank the distinct capacities: the largest gets the highest class.
+                std::vector<uint32_t> distinct;
+                for (const auto &kv : capacities)
+                    distinct.push_back(kv.second);
+                std::sort(distinct.begin(), distinct.end());
+                distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+                for (CpuTopology::LogicalCpu &cpu : t.cpus)
+                {
+                    auto it = capacities.find(cpu.id);
+                    if (it != capacities.end())
+                        cpu.efficiencyClass = static_cast<uint8_t>(
+                            std::lower_bound(distinct.begin(), distinct.end(), it->second) - distinct.begin());
+                }
+            }
+
+            for (uint32_t node = 0; node < 1024u; ++node)
+            {
+                std::string list;
+                if (!readText("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist", list))
+                {
+                    if (node > 0u)
+                        break;
+                    continue;
+                }
+                for (uint32_t id : parseCpuList(list))
+                {
+                    for (CpuTopology::LogicalCpu &cpu : t.cpus)
+                    {
+                        if (cpu.id == id)
+                            cpu.numaNode = node;
+                    }
+                }
+            }
+            return true;
+        }
+#elif defined(_WIN32)
+        bool detectWindows(CpuTopology &t)
+        {
+            DWORD bytes = 0;
+            GetLogicalProcessorInformationEx(RelationAll, nullptr, &bytes);
+            if (GetLastError() != ERROR_INSUFFICIENT_BUFFER || bytes == 0)
+                return false;
+            std::vector<uint8_t> buffer(bytes);
+            auto *info = reinterpret_cast<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX *>(buffer.data());
+            if (!GetLogicalProcessorInformationEx(RelationAll, info, &bytes))
+                return false;
+
+            // Group 0 masks; cores, packages and nodes come in any order.
+            std::vector<std::pair<KAFFINITY, uint32_t>> nodes; // mask, node number
+            std::vector<KAFFINITY> packages;
+            uint32_t core = 0;
+            for (DWORD offset = 0; offset < bytes;)
+            {
+                auto *entry = reinterpret_cast<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX *>(buffer.data() + offset);
+                if (entry->Relationship == RelationProcessorCore)
+                {
+                    const PROCESSOR_RELATIONSHIP &p = entry->Processor;
+                    bool first = true;
+                    for (WORD g = 0; g < p.GroupCount; ++g)
+                    {
+                        if (p.GroupMask[g].Group != 0)
+                            continue;
+                        const KAFFINITY mask = p.GroupMask[g].Mask;
+                        for (uint32_t bit = 0; bit < sizeof(KAFFINITY) * 8u; ++bit)
+                        {
+                            if (!(mask & (static_cast<KAFFINITY>(1) << bit)))
+                                continue;
+                            CpuTopology::LogicalCpu cpu;
+                            cpu.id = bit;
+                            cpu.core = core;
+                            cpu.efficiencyClass = p.EfficiencyClass;
+                            cpu.smtPrimary = first;
+                            first = false;
+                            t.cpus.push_back(cpu);
+                        }
+                    }
+                    ++core;
+                }
+                else if (entry->Relationship == RelationNumaNode)
+                {
+                    if (entry->NumaNode.GroupMask.Group == 0)
+                        nodes.emplace_back(entry->NumaNode.GroupMask.Mask, entry->NumaNode.NodeNumber);
+                }
+                else if (entry->Relationship == RelationProcessorPackage)
+                {
+                    const PROCESSOR_RELATIONSHIP &p = entry->Processor;
+                    KAFFINITY mask = 0;
+                    for (WORD g = 0; g < p.GroupCount; ++g)
+                    {
+                        if (p.GroupMask[g].Group == 0)
+                            mask |= p.GroupMask[g].Mask;
+                    }
+                    packages.push_back(mask);
+                }
+                offset += entry->Size;
+            }
+            for (CpuTopology::LogicalCpu &cpu : t.cpus)
+            {
+                const KAFFINITY bit = static_cast<KAFFINITY>(1) << cpu.id;
+                for (const auto &node : nodes)
+                {
+                    if (node.first & bit)
+                        cpu.numaNode = node.second;
+                }
+                for (size_t p = 0; p < packages.size(); ++p)
+                {
+                    if (packages[p] & bit)
+                        cpu.package = static_cast<uint32_t>(p);
+                }
+            }
+            return !t.cpus.empty();
+        }
+#endif
+    }
+
+    CpuTopology CpuTopology::detect()
+    {
+        CpuTopology t;
+        bool ok = false;
+#if defined(__linux__)
+        ok = detectLinux(t);
+#elif defined(_WIN32)
+        ok = detectWindows(t);
+#endif
+        if (!ok)
+        {
+            t.cpus.clear();
+            const uint32_t n = std::max(1u, std::thread::hardware_concurrency());
+            for (uint32_t i = 0; i < n; ++i)
+            {
+                LogicalCpu cpu;
+                cpu.id = i;
+                cpu.core = i;
+                t.cpus.push_back(cpu);
+            }
+        }
+        t.finish();
+        return t;
+    }
+
+    void CpuTopology::finish()
+    {
+        std::sort(cpus.begin(), cpus.end(), [](const LogicalCpu &a, const LogicalCpu &b)
+                  { return a.id < b.id; });
+        m_maxClass = 0;
+        std::vector<uint32_t> seenCores;
+        for (LogicalCpu &cpu : cpus)
+        {
+            m_maxClass = std::max(m_maxClass, cpu.efficiencyClass);
+            cpu.smtPrimary = std::find(seenCores.begin(), seenCores.end(), cpu.core) == seenCores.end();
+            if (cpu.smtPrimary)
+                seenCores.push_back(cpu.core);
+        }
+    }
+
+    bool CpuTopology::hybrid() const
+    {
+        for (const LogicalCpu &cpu : cpus)
+        {
+            if (cpu.efficiencyClass != m_maxClass)
+                return true;
+        }
+        return false;
+    }
+
+    uint32_t CpuTopology::physicalCoreCount() const
+    {
+        uint32_t n = 0;
+        for (const LogicalCpu &cpu : cpus)
+            n += cpu.smtPrimary ? 1u : 0u;
+        return n;
+    }
+
+    uint32_t CpuTopology::numaNodeCount() const
+    {
+        uint32_t maxNode = 0;
+        for (const LogicalCpu &cpu : cpus)
+            maxNode = std::max(maxNode, cpu.numaNode);
+        return cpus.empty() ? 0u : maxNode + 1u;
+    }
+
+    std::vector<uint32_t> CpuTopology::performanceCpus() const
+    {
+        std::vector<const LogicalCpu *> picked;
+        for (const LogicalCpu &cpu : cpus)
+        {
+            if (isPerformance(cpu))
+                picked.push_back(&cpu);
+        }
+        std::stable_sort(picked.begin(), picked.end(), [](const LogicalCpu *a, const LogicalCpu *b)
+                         { return std::make_tuple(!a->smtPrimary, a->numaNode, a->package, a->core) <
+                                  std::make_tuple(!b->smtPrimary, b->numaNode, b->package, b->core); });
+        std::vector<uint32_t> out;
+        out.reserve(picked.size());
+        for (const LogicalCpu *cpu : picked)
+            out.push_back(cpu->id);
+        return out;
+    }
+
+    std::vector<uint32_t> CpuTopology::efficiencyCpus() const
+    {
+        std::vector<uint32_t> out;
+        for (const LogicalCpu &cpu : cpus)
+        {
+            if (!isPerformance(cpu))
+                out.push_back(cpu.id);
+        }
+        return out;
+    }
+
+    bool setCurrentThreadAffinity(const std::vector<uint32_t> &cpuIds)
+    {
+        if (cpuIds.empty())
+            return false;
+#if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (uint32_t id : cpuIds)
+        {
+            if (id < CPU_SETSIZE)
+                CPU_SET(id, &set);
+        }
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#elif defined(_WIN32)
+        DWORD_PTR mask = 0;
+        for (uint32_t id : cpuIds)
+        {
+            if (id < sizeof(DWORD_PTR) * 8u)
+                mask |= static_cast<DWORD_PTR>(1) << id;
+        }
+        return mask != 0 && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#else
+        return false;
+#endif
+    }
+
+    void setCurrentThreadBackgroundPriority()
+    {
+#if defined(__linux__)
+        // The nice value of a Linux thread is per thread id.
+        (void)setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 10);
+#elif defined(_WIN32)
+        (void)SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+#endif
+    }
+}
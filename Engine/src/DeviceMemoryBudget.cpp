@@ -0,0 +1,59 @@
+#include "utils/DeviceMemoryBudget.h"
+
+#include <cstring>
+#include <vector>
+
+namespace Engine
+{
+    bool HasMemoryBudgetExtension(VkPhysicalDevice physicalDevice)
+    {
+        if (physicalDevice == VK_NULL_HANDLE)
+            return false;
+
+        uint32_t extCount = 0;
+        vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extCount, nullptr);
+        std::vector<VkExtensionProperties> exts(extCount);
+        vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extCount, exts.data());
+        for (const auto &ext : exts)
+        {
+            if (std::strcmp(ext.extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0)
+                return true;
+        }
+        return false;
+    }
+
+    DeviceMemoryBudget QueryDeviceLocalBudget(VkPhysicalDevice physicalDevice, bool hasBudgetExtension)
+    {
+        DeviceMemoryBudget out{};
+        if (physicalDevice == VK_NULL_HANDLE)
+            return out;
+
+        VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProps{};
+        budgetProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+        VkPhysicalDeviceMemoryProperties2 memProps2{};
+        memProps2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+        memProps2.pNext = hasBudgetExtension ? &budgetProps : nullptr;
+
+        vkGetPhysicalDeviceMemoryProperties2(physicalDevice, &memProps2);
+
+        const VkPhysicalDeviceMemoryProperties &props = memProps2.memoryProperties;
+        for (uint32_t i = 0; i < props.memoryHeapCount; i++)
+        {
+            if (!(props.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT))
+                continue;
+            out.heapSize += props.memoryHeaps[i].size;
+            if (hasBudgetExtension)
+            {
+                out.budget += budgetProps.heapBudget[i];
+                out.usage += budgetProps.heapUsage[i];
+            }
+        }
+
+        out.fromBudgetExtension = hasBudgetExtension;
+        if (!hasBudgetExtension)
+            out.budget = out.heapSize;
+        return out;
+    }
+
+} // namespace Engine
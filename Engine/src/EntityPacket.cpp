@@ -0,0 +1,217 @@
+#include "ECS/EntityPacket.h"
+
+#include "ECS/ECSContext.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Engine::ECS
+{
+    // ------------------------------------------------------------
+    // Packing
+    // ------------------------------------------------------------
+    uint32_t packEntities(const ECSContext &ecs, const Entity *entities, uint32_t count, const ComponentMask &excluded,
+                          std::vector<uint8_t> &out)
+    {
+        struct Ref
+        {
+            uint32_t archetypeId;
+            uint32_t row;
+        };
+        std::vector<Ref> refs;
+        refs.reserve(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const EntityRecord *rec = ecs.entities.find(entities[i]);
+            const ArchetypeStore *store = rec ? ecs.stores.get(rec->archetypeId) : nullptr;
+            if (store && rec->row < store->size())
+                refs.push_back(Ref{rec->archetypeId, rec->row});
+        }
+        out.clear();
+        if (refs.empty())
+            return 0;
+
+        // Group by archetype; rows ascending keeps each column read in address order.
+        std::sort(refs.begin(), refs.end(), [](const Ref &a, const Ref &b)
+                  { return a.archetypeId != b.archetypeId ? a.archetypeId < b.archetypeId : a.row < b.row; });
+        refs.erase(std::unique(refs.begin(), refs.end(), [](const Ref &a, const Ref &b)
+                               { return a.archetypeId == b.archetypeId && a.row == b.row; }),
+                   refs.end());
+
+        const ComponentRegistry &registry = ecs.components;
+        const uint32_t componentCount = registry.count();
+
+        EntityPacketHeader header;
+        header.componentCount = componentCount;
+        for (size_t i = 0; i < refs.size(); ++i)
+            header.storeCount += (i == 0 || refs[i].archetypeId != refs[i - 1].archetypeId) ? 1u : 0u;
+
+        SnapshotWriter w;
+        w.bytes.swap(out); // reuse the caller's capacity
+        w.put(header);
+        w.align();
+        writeComponentTable(w, registry);
+
+        std::vector<uint32_t> signature;
+        for (size_t begin = 0; begin < refs.size();)
+        {
+            const uint32_t archetypeId = refs[begin].archetypeId;
+            size_t end = begin;
+            while (end < refs.size() && refs[end].archetypeId == archetypeId)
+                ++end;
+            const uint32_t rows = static_cast<uint32_t>(end - begin);
+            const ArchetypeStore &store = *ecs.stores.get(archetypeId);
+
+            signature.clear();
+            for (uint32_t id = 0; id < componentCount; ++id)
+            {
+                if (store.signature().has(id) && !excluded.has(id))
+                    signature.push_back(id);
+            }
+            uint32_t columnCount = 0;
+            for (const ComponentColumn &column : store.columns())
+                columnCount += (column.type().trivial && !excluded.has(column.componentId())) ? 1u : 0u;
+
+            StoreRecord rec;
+            rec.archetypeId = archetypeId;
+            rec.rowCount = rows;
+            rec.signatureCount = static_cast<uint32_t>(signature.size());
+            rec.columnCount = columnCount;
+            w.put(rec);
+            w.append(signature.data(), signature.size() * sizeof(uint32_t));
+            w.align();
+            const std::vector<Entity> &storeEntities = store.entities();
+            for (size_t i = begin; i < end; ++i)
+                w.put(storeEntities[refs[i].row]);
+            w.align();
+
+            for (const ComponentColumn &column : store.columns())
+            {
+                const ComponentTypeInfo &type = column.type();
+                if (!type.trivial || excluded.has(column.componentId()))
+                    continue;
+
+                ColumnRecord colRec;
+                colRec.componentId = column.componentId();
+                colRec.elementSize = type.size;
+                colRec.byteCount = static_cast<uint64_t>(type.size) * rows;
+                w.put(colRec);
+                w.align();
+                for (size_t i = begin; i < end; ++i)
+                    w.append(column.at(refs[i].row), type.size);
+                w.align();
+            }
+            begin = end;
+        }
+
+        out.swap(w.bytes);
+        return static_cast<uint32_t>(refs.size());
+    }
+
+    // ------------------------------------------------------------
+    // Reading
+    // ------------------------------------------------------------
+    bool EntityPacketReader::open(const uint8_t *data, size_t size, ComponentRegistry &registry, std::string &outError)
+    {
+        m_stores.clear();
+        m_entityCount = 0;
+
+        SnapshotReader r{data, size, 0};
+        EntityPacketHeader header;
+        if (!r.get(header) || header.magic != ENTITY_PACKET_MAGIC)
+        {
+            outError = "Entity packet: bad magic";
+            return false;
+        }
+        if (header.version != ENTITY_PACKET_VERSION)
+        {
+            outError = "Entity packet: unsupported version " + std::to_string(header.version);
+            return false;
+        }
+        if (!r.align())
+        {
+            outError = "Entity packet: truncated";
+            return false;
+        }
+
+        ComponentIdMap idMap;
+        std::string mismatch;
+        if (!readComponentTable(r, header.componentCount, registry, idMap, mismatch))
+        {
+            outError = mismatch.empty() ? "Entity packet: truncated component table"
+                                        : "Entity packet: component '" + mismatch + "' has a different layout here";
+            return false;
+        }
+
+        std::vector<SnapshotStoreView> stores(header.storeCount);
+        uint32_t entityCount = 0;
+        for (SnapshotStoreView &view : stores)
+        {
+            const char *what = nullptr;
+            if (!readStoreSection(r, idMap, view, what))
+            {
+                outError = std::string("Entity packet: ") + what;
+                return false;
+            }
+            entityCount += view.rowCount;
+        }
+
+        m_stores = std::move(stores);
+        m_entityCount = entityCount;
+        return true;
+    }
+
+    void EntityPacketReader::copyRow(const SnapshotStoreView &store, uint32_t row, ArchetypeStore &dstStore, uint32_t dstRow)
+    {
+        for (const SnapshotColumnView &col : store.columns)
+        {
+            ComponentColumn *column = dstStore.findColumn(col.componentId);
+            if (column && column->type().size == col.elementSize)
+                std::memcpy(column->at(dstRow), col.bytes + static_cast<size_t>(row) * col.elementSize, col.elementSize);
+        }
+    }
+
+    void resetPacketHandles(const ComponentRegistry &registry, ArchetypeStore &store, uint32_t first, uint32_t count)
+    {
+        resetForeignHandles(store, first, count, registry.getId("Path"), registry.getId("RenderSlot"));
+        ColumnView<CombatMemory> memories = store.column<CombatMemory>(registry.getId("CombatMemory"));
+        if (memories.empty())
+            return;
+        for (uint32_t row = first, end = first + count; row < end; ++row)
+        {
+            memories[row].targetEnemy = Entity{};
+            memories[row].nextScanTick = 0;
+        }
+    }
+
+    Entity unpackRow(ECSContext &ecs, const SnapshotStoreView &store, uint32_t row)
+    {
+        const uint32_t archetypeId = ecs.archetypes.getOrCreate(store.signature);
+        ArchetypeStore *dst = ecs.stores.getOrCreate(archetypeId, store.signature, ecs.components);
+        if (!dst)
+            return Entity{};
+
+        const Entity e = ecs.entities.create();
+        const uint32_t dstRow = dst->createRow(e);
+        ecs.entities.attach(e, archetypeId, dstRow);
+        EntityPacketReader::copyRow(store, row, *dst, dstRow);
+        resetPacketHandles(ecs.components, *dst, dstRow, 1);
+        ecs.queries.markRowDirtyAll(archetypeId, dstRow, dst->size());
+        return e;
+    }
+
+    bool unpackRowInto(ECSContext &ecs, const SnapshotStoreView &store, uint32_t row, Entity existing)
+    {
+        if (!ecs.moveEntity(existing, store.signature))
+            return false;
+        const EntityRecord *rec = ecs.entities.find(existing);
+        ArchetypeStore *dst = rec ? ecs.stores.get(rec->archetypeId) : nullptr;
+        if (!dst || rec->row >= dst->size())
+            return false;
+
+        EntityPacketReader::copyRow(store, row, *dst, rec->row);
+        resetPacketHandles(ecs.components, *dst, rec->row, 1);
+        ecs.queries.markRowDirtyAll(rec->archetypeId, rec->row, dst->size());
+        return true;
+    }
+}
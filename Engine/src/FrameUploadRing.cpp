@@ -0,0 +1,102 @@
+#include "utils/FrameUploadRing.h"
+#include "utils/BufferUtils.h"
+
+#include <algorithm>
+
+namespace Engine
+{
+    static VkDeviceSize alignUp(VkDeviceSize v, VkDeviceSize alignment)
+    {
+        return (alignment > 1) ? ((v + alignment - 1) & ~(alignment - 1)) : v;
+    }
+
+    VkResult FrameUploadRing::create(VkDevice device, VkPhysicalDevice physicalDevice, uint32_t frameCount,
+                                     VkDeviceSize bytesPerFrame)
+    {
+        destroy();
+        if (frameCount == 0 || bytesPerFrame == 0)
+            return VK_ERROR_INITIALIZATION_FAILED;
+
+        VkPhysicalDeviceProperties props{};
+        vkGetPhysicalDeviceProperties(physicalDevice, &props);
+        m_uniformAlignment = std::max<VkDeviceSize>(props.limits.minUniformBufferOffsetAlignment, 16);
+        m_storageAlignment = std::max<VkDeviceSize>(props.limits.minStorageBufferOffsetAlignment, 16);
+
+        // Every segment starts on a boundary both kinds of binding accept.
+        const VkDeviceSize align = std::max(m_uniformAlignment, m_storageAlignment);
+        const VkDeviceSize segment = alignUp(bytesPerFrame, align);
+
+        const VkResult r = CreateBuffer(device, physicalDevice, segment * frameCount,
+                                        VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                        m_buffer, m_memory);
+        if (r != VK_SUCCESS || !m_memory.mapped)
+        {
+            DestroyBuffer(device, m_buffer, m_memory);
+            return (r != VK_SUCCESS) ? r : VkResult(VK_ERROR_MEMORY_MAP_FAILED);
+        }
+
+        m_device = device;
+        m_mapped = static_cast<uint8_t *>(m_memory.mapped);
+        m_frameCount = frameCount;
+        m_segmentBytes = segment;
+        m_segmentBase = 0;
+        m_cursor.store(0, std::memory_order_relaxed);
+        m_peak = 0;
+        m_failed.store(0, std::memory_order_relaxed);
+        return VK_SUCCESS;
+    }
+
+    void FrameUploadRing::destroy()
+    {
+        if (m_device == VK_NULL_HANDLE)
+            return;
+        DestroyBuffer(m_device, m_buffer, m_memory);
+        m_device = VK_NULL_HANDLE;
+        m_mapped = nullptr;
+        m_frameCount = 0;
+        m_segmentBytes = 0;
+    }
+
+    void FrameUploadRing::beginFrame(uint32_t frameSlot)
+    {
+        if (!m_mapped)
+            return;
+        m_peak = std::max(m_peak, m_cursor.load(std::memory_order_relaxed));
+        m_segmentBase = static_cast<VkDeviceSize>(frameSlot % m_frameCount) * m_segmentBytes;
+        m_cursor.store(0, std::memory_order_relaxed);
+    }
+
+    bool FrameUploadRing::allocate(VkDeviceSize size, VkDeviceSize alignment, Allocation &out)
+    {
+        out = Allocation{};
+        if (!m_mapped || size == 0)
+            return false;
+
+        VkDeviceSize cur = m_cursor.load(std::memory_order_relaxed);
+        VkDeviceSize begin = 0;
+        do
+        {
+            begin = alignUp(cur, alignment);
+            if (begin + size > m_segmentBytes)
+            {
+                m_failed.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        } while (!m_cursor.compare_exchange_weak(cur, begin + size, std::memory_order_relaxed));
+
+        out.buffer = m_buffer;
+        out.offset = m_segmentBase + begin;
+        out.mapped = m_mapped + out.offset;
+        return true;
+    }
+
+    FrameUploadRing::Stats FrameUploadRing::stats() const
+    {
+        Stats s;
+        s.usedBytes = m_cursor.load(std::memory_order_relaxed);
+        s.peakBytes = std::max(m_peak, s.usedBytes);
+        s.failed = m_failed.load(std::memory_order_relaxed);
+        return s;
+    }
+}
@@ -67,6 +67,9 @@ namespace Engine
                     if (key == GLFW_KEY_ENTER) d->EventCallback("EnterPressed");
                     if (key == GLFW_KEY_F1) d->EventCallback("F1Pressed");
                     if (key == GLFW_KEY_F2) d->EventCallback("F2Pressed");
+                    if (key == GLFW_KEY_F5 && action == GLFW_PRESS) d->EventCallback("F5Pressed");
+                    if (key == GLFW_KEY_F9 && action == GLFW_PRESS) d->EventCallback("F9Pressed");
+                    if (key == GLFW_KEY_F12 && action == GLFW_PRESS) d->EventCallback("F12Pressed");
                 }
                 if (action == GLFW_RELEASE) {
                     auto d = static_cast<GLFWWindowData*>(glfwGetWindowUserPointer(wnd));
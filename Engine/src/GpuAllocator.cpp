@@ -0,0 +1,460 @@
+#include "utils/GpuAllocator.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace Engine
+{
+    namespace
+    {
+        std::mutex g_registryMutex;
+        std::vector<std::pair<VkDevice, GpuAllocator *>> g_registry;
+
+        VkDeviceSize alignUp(VkDeviceSize v, VkDeviceSize alignment)
+        {
+            return (alignment > 1) ? ((v + alignment - 1) & ~(alignment - 1)) : v;
+        }
+
+        void registerAllocator(VkDevice device, GpuAllocator *allocator)
+        {
+            std::lock_guard<std::mutex> lock(g_registryMutex);
+            for (auto &e : g_registry)
+            {
+                if (e.first == device)
+                {
+                    e.second = allocator;
+                    return;
+                }
+            }
+            g_registry.emplace_back(device, allocator);
+        }
+
+        void unregisterAllocator(GpuAllocator *allocator)
+        {
+            std::lock_guard<std::mutex> lock(g_registryMutex);
+            g_registry.erase(std::remove_if(g_registry.begin(), g_registry.end(),
+                                            [&](const auto &e)
+                                            { return e.second == allocator; }),
+                             g_registry.end());
+        }
+    }
+
+    // ============================================================
+    // GpuAllocator
+    // ============================================================
+
+    void GpuAllocator::init(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize blockSize)
+    {
+        shutdown();
+
+        m_device = device;
+        m_blockSize = (blockSize > 0) ? blockSize : DEFAULT_BLOCK_SIZE;
+        vkGetPhysicalDeviceMemoryProperties(physicalDevice, &m_memProps);
+
+        registerAllocator(device, this);
+    }
+
+    void GpuAllocator::shutdown()
+    {
+        if (m_device == VK_NULL_HANDLE)
+            return;
+
+        unregisterAllocator(this);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (Block &b : m_blocks)
+            destroyBlock(b);
+        m_blocks.clear();
+        m_dedicatedCount = 0;
+        m_dedicatedBytes = 0;
+        m_subAllocCount = 0;
+        m_device = VK_NULL_HANDLE;
+    }
+
+    GpuAllocator *GpuAllocator::forDevice(VkDevice device)
+    {
+        std::lock_guard<std::mutex> lock(g_registryMutex);
+        for (const auto &e : g_registry)
+        {
+            if (e.first == device)
+                return e.second;
+        }
+        return nullptr;
+    }
+
+    bool GpuAllocator::findMemoryType(uint32_t typeBits, VkMemoryPropertyFlags props, uint32_t &outIndex) const
+    {
+        for (uint32_t i = 0; i < m_memProps.memoryTypeCount; ++i)
+        {
+            if ((typeBits & (1u << i)) && (m_memProps.memoryTypes[i].propertyFlags & props) == props)
+            {
+                outIndex = i;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    VkResult GpuAllocator::allocate(const VkMemoryRequirements &req, VkMemoryPropertyFlags props, GpuResourceKind kind, GpuAllocation &out)
+    {
+        out = GpuAllocation{};
+        if (m_device == VK_NULL_HANDLE || req.size == 0)
+            return VK_ERROR_INITIALIZATION_FAILED;
+
+        uint32_t memoryType = 0;
+        if (!findMemoryType(req.memoryTypeBits, props, memoryType))
+            return VK_ERROR_FEATURE_NOT_PRESENT;
+
+        // Small heaps (e.g. host-visible VRAM windows) get proportionally smaller blocks.
+        const VkDeviceSize heapSize = m_memProps.memoryHeaps[m_memProps.memoryTypes[memoryType].heapIndex].size;
+        const VkDeviceSize blockSize = std::max<VkDeviceSize>(std::min(m_blockSize, heapSize / 8), 1);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (req.size > blockSize / 2)
+            return allocateDedicated(req, memoryType, out);
+
+        VkDeviceSize offset = 0;
+        uint32_t blockIndex = UINT32_MAX;
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_blocks.size()); ++i)
+        {
+            Block &b = m_blocks[i];
+            if (b.memory == VK_NULL_HANDLE || b.memoryType != memoryType || b.kind != kind)
+                continue;
+            if (tryAllocateFromBlock(b, req, offset))
+            {
+                blockIndex = i;
+                break;
+            }
+        }
+
+        if (blockIndex == UINT32_MAX)
+        {
+            const VkResult r = createBlock(memoryType, kind, blockSize, blockIndex);
+            if (r != VK_SUCCESS)
+            {
+                // Out of room for a whole block; the request itself may still fit.
+                return allocateDedicated(req, memoryType, out);
+            }
+            tryAllocateFromBlock(m_blocks[blockIndex], req, offset);
+        }
+
+        Block &b = m_blocks[blockIndex];
+        b.used += req.size;
+        b.liveCount++;
+        m_subAllocCount++;
+
+        out.memory = b.memory;
+        out.offset = offset;
+        out.size = req.size;
+        out.mapped = b.mapped ? (b.mapped + offset) : nullptr;
+        out.block = blockIndex;
+        return VK_SUCCESS;
+    }
+
+    void GpuAllocator::free(GpuAllocation &alloc)
+    {
+        if (!alloc.valid())
+            return;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (alloc.block == UINT32_MAX)
+        {
+            if (alloc.mapped)
+                vkUnmapMemory(m_device, alloc.memory);
+            vkFreeMemory(m_device, alloc.memory, nullptr);
+            if (m_dedicatedCount > 0)
+            {
+                m_dedicatedCount--;
+                m_dedicatedBytes -= std::min(m_dedicatedBytes, alloc.size);
+            }
+            alloc = GpuAllocation{};
+            return;
+        }
+
+        if (alloc.block < m_blocks.size() && m_blocks[alloc.block].memory == alloc.memory)
+        {
+            Block &b = m_blocks[alloc.block];
+            releaseRange(b, alloc.offset, alloc.size);
+            b.used -= alloc.size;
+            b.liveCount--;
+            m_subAllocCount--;
+
+            if (b.liveCount == 0)
+            {
+                // Keep one empty block per pool so load/unload cycles don't thrash vkAllocateMemory.
+                const bool hasSibling = std::any_of(m_blocks.begin(), m_blocks.end(), [&](const Block &o)
+                                                    { return &o != &b && o.memory != VK_NULL_HANDLE &&
+                                                             o.memoryType == b.memoryType && o.kind == b.kind; });
+                if (hasSibling)
+                    destroyBlock(b);
+            }
+        }
+        alloc = GpuAllocation{};
+    }
+
+    GpuAllocator::Stats GpuAllocator::stats() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Stats s{};
+        s.deviceAllocations = m_dedicatedCount;
+        s.subAllocations = m_subAllocCount;
+        s.reservedBytes = m_dedicatedBytes;
+        s.usedBytes = m_dedicatedBytes;
+        for (const Block &b : m_blocks)
+        {
+            if (b.memory == VK_NULL_HANDLE)
+                continue;
+            s.deviceAllocations++;
+            s.reservedBytes += b.size;
+            s.usedBytes += b.used;
+        }
+        return s;
+    }
+
+    bool GpuAllocator::tryAllocateFromBlock(Block &b, const VkMemoryRequirements &req, VkDeviceSize &outOffset)
+    {
+        for (size_t i = 0; i < b.freeRanges.size(); ++i)
+        {
+            const Range r = b.freeRanges[i];
+            const VkDeviceSize start = alignUp(r.offset, req.alignment);
+            const VkDeviceSize end = r.offset + r.size;
+            if (start + req.size > end)
+                continue;
+
+            // Replace the range by the (possibly empty) alignment gap and tail.
+            const Range head{r.offset, start - r.offset};
+            const Range tail{start + req.size, end - (start + req.size)};
+            b.freeRanges.erase(b.freeRanges.begin() + static_cast<std::ptrdiff_t>(i));
+            if (tail.size > 0)
+                b.freeRanges.insert(b.freeRanges.begin() + static_cast<std::ptrdiff_t>(i), tail);
+            if (head.size > 0)
+                b.freeRanges.insert(b.freeRanges.begin() + static_cast<std::ptrdiff_t>(i), head);
+
+            outOffset = start;
+            return true;
+        }
+        return false;
+    }
+
+    void GpuAllocator::releaseRange(Block &b, VkDeviceSize offset, VkDeviceSize size)
+    {
+        auto it = std::lower_bound(b.freeRanges.begin(), b.freeRanges.end(), offset,
+                                   [](const Range &r, VkDeviceSize o)
+                                   { return r.offset < o; });
+        it = b.freeRanges.insert(it, Range{offset, size});
+
+        // Merge with the following range, then with the preceding one.
+        auto next = it + 1;
+        if (next != b.freeRanges.end() && it->offset + it->size == next->offset)
+        {
+            it->size += next->size;
+            it = b.freeRanges.erase(next) - 1;
+        }
+        if (it != b.freeRanges.begin())
+        {
+            auto prev = it - 1;
+            if (prev->offset + prev->size == it->offset)
+            {
+                prev->size += it->size;
+                b.freeRanges.erase(it);
+            }
+        }
+    }
+
+    VkResult GpuAllocator::allocateDedicated(const VkMemoryRequirements &req, uint32_t memoryType, GpuAllocation &out)
+    {
+        VkMemoryAllocateInfo ai{};
+        ai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        ai.allocationSize = req.size;
+        ai.memoryTypeIndex = memoryType;
+
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkResult r = vkAllocateMemory(m_device, &ai, nullptr, &memory);
+        if (r != VK_SUCCESS)
+            return r;
+
+        void *mapped = nullptr;
+        if (m_memProps.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+        {
+            r = vkMapMemory(m_device, memory, 0, VK_WHOLE_SIZE, 0, &mapped);
+            if (r != VK_SUCCESS)
+            {
+                vkFreeMemory(m_device, memory, nullptr);
+                return r;
+            }
+        }
+
+        m_dedicatedCount++;
+        m_dedicatedBytes += req.size;
+
+        out.memory = memory;
+        out.offset = 0;
+        out.size = req.size;
+        out.mapped = mapped;
+        out.block = UINT32_MAX;
+        return VK_SUCCESS;
+    }
+
+    VkResult GpuAllocator::createBlock(uint32_t memoryType, GpuResourceKind kind, VkDeviceSize size, uint32_t &outIndex)
+    {
+        VkMemoryAllocateInfo ai{};
+        ai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        ai.allocationSize = size;
+        ai.memoryTypeIndex = memoryType;
+
+        Block b{};
+        VkResult r = vkAllocateMemory(m_device, &ai, nullptr, &b.memory);
+        if (r != VK_SUCCESS)
+            return r;
+
+        if (m_memProps.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+        {
+            void *mapped = nullptr;
+            r = vkMapMemory(m_device, b.memory, 0, VK_WHOLE_SIZE, 0, &mapped);
+            if (r != VK_SUCCESS)
+            {
+                vkFreeMemory(m_device, b.memory, nullptr);
+                return r;
+            }
+            b.mapped = static_cast<uint8_t *>(mapped);
+        }
+
+        b.size = size;
+        b.memoryType = memoryType;
+        b.kind = kind;
+        b.freeRanges.push_back(Range{0, size});
+
+        // Reuse a released slot so live allocations keep their block index.
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_blocks.size()); ++i)
+        {
+            if (m_blocks[i].memory == VK_NULL_HANDLE)
+            {
+                m_blocks[i] = std::move(b);
+                outIndex = i;
+                return VK_SUCCESS;
+            }
+        }
+        m_blocks.push_back(std::move(b));
+        outIndex = static_cast<uint32_t>(m_blocks.size() - 1);
+        return VK_SUCCESS;
+    }
+
+    void GpuAllocator::destroyBlock(Block &b)
+    {
+        if (b.memory == VK_NULL_HANDLE)
+            return;
+        if (b.mapped)
+            vkUnmapMemory(m_device, b.memory);
+        vkFreeMemory(m_device, b.memory, nullptr);
+        b = Block{};
+    }
+
+    // ============================================================
+    // Free functions
+    // ============================================================
+
+    bool FindMemoryType(VkPhysicalDevice physicalDevice, uint32_t typeBits, VkMemoryPropertyFlags props, uint32_t &outIndex)
+    {
+        VkPhysicalDeviceMemoryProperties memProps{};
+        vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProps);
+        for (uint32_t i = 0; i < memProps.memoryTypeCount; ++i)
+        {
+            if ((typeBits & (1u << i)) && (memProps.memoryTypes[i].propertyFlags & props) == props)
+            {
+                outIndex = i;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static VkResult allocateForRequirements(VkDevice device, VkPhysicalDevice physicalDevice, const VkMemoryRequirements &req,
+                                            VkMemoryPropertyFlags props, GpuResourceKind kind, GpuAllocation &out)
+    {
+        if (GpuAllocator *allocator = GpuAllocator::forDevice(device))
+            return allocator->allocate(req, props, kind, out);
+
+        out = GpuAllocation{};
+        uint32_t memoryType = 0;
+        if (!FindMemoryType(physicalDevice, req.memoryTypeBits, props, memoryType))
+            return VK_ERROR_FEATURE_NOT_PRESENT;
+
+        VkMemoryAllocateInfo ai{};
+        ai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        ai.allocationSize = req.size;
+        ai.memoryTypeIndex = memoryType;
+
+        VkResult r = vkAllocateMemory(device, &ai, nullptr, &out.memory);
+        if (r != VK_SUCCESS)
+            return r;
+
+        if (props & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+        {
+            r = vkMapMemory(device, out.memory, 0, VK_WHOLE_SIZE, 0, &out.mapped);
+            if (r != VK_SUCCESS)
+            {
+                vkFreeMemory(device, out.memory, nullptr);
+                out = GpuAllocation{};
+                return r;
+            }
+        }
+        out.size = req.size;
+        return VK_SUCCESS;
+    }
+
+    VkResult AllocateBufferMemory(VkDevice device, VkPhysicalDevice physicalDevice, VkBuffer buffer,
+                                  VkMemoryPropertyFlags props, GpuAllocation &out)
+    {
+        VkMemoryRequirements req{};
+        vkGetBufferMemoryRequirements(device, buffer, &req);
+
+        VkResult r = allocateForRequirements(device, physicalDevice, req, props, GpuResourceKind::Linear, out);
+        if (r != VK_SUCCESS)
+            return r;
+
+        r = vkBindBufferMemory(device, buffer, out.memory, out.offset);
+        if (r != VK_SUCCESS)
+            FreeGpuMemory(device, out);
+        return r;
+    }
+
+    VkResult AllocateImageMemory(VkDevice device, VkPhysicalDevice physicalDevice, VkImage image,
+                                 VkMemoryPropertyFlags props, GpuAllocation &out, GpuResourceKind kind)
+    {
+        VkMemoryRequirements req{};
+        vkGetImageMemoryRequirements(device, image, &req);
+
+        VkResult r = allocateForRequirements(device, physicalDevice, req, props, kind, out);
+        if (r != VK_SUCCESS)
+            return r;
+
+        r = vkBindImageMemory(device, image, out.memory, out.offset);
+        if (r != VK_SUCCESS)
+            FreeGpuMemory(device, out);
+        return r;
+    }
+
+    void FreeGpuMemory(VkDevice device, GpuAllocation &alloc)
+    {
+        if (!alloc.valid())
+            return;
+
+        if (GpuAllocator *allocator = GpuAllocator::forDevice(device))
+        {
+            allocator->free(alloc);
+            return;
+        }
+
+        // Dedicated allocations own their memory. Block sub-allocations without an allocator
+        // mean it already shut down and released the block.
+        if (alloc.block == UINT32_MAX)
+        {
+            if (alloc.mapped)
+                vkUnmapMemory(device, alloc.memory);
+            vkFreeMemory(device, alloc.memory, nullptr);
+        }
+        alloc = GpuAllocation{};
+    }
+}
@@ -0,0 +1,105 @@
+#include "Engine/HiZOcclusion.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Engine
+{
+    void HiZOcclusion::reset()
+    {
+        m_levels.clear();
+        m_valid = false;
+    }
+
+    void HiZOcclusion::buildFromReadback(const HiZReadback &readback)
+    {
+        m_valid = false;
+        if (!readback.header || !readback.depth)
+            return;
+
+        const HiZPyramidHeader &h = *readback.header;
+        if (!h.valid || h.levelCount == 0u || h.levelCount > HiZPyramidHeader::MAX_LEVELS || readback.firstLevel >= h.levelCount)
+            return;
+
+        const uint32_t first = readback.firstLevel;
+        m_levels.resize(h.levelCount - first);
+        for (uint32_t li = first; li < h.levelCount; ++li)
+        {
+            Level &dst = m_levels[li - first];
+            dst.width = h.levels[li][1];
+            dst.height = h.levels[li][2];
+            const float *src = readback.depth + (h.levels[li][0] - h.levels[first][0]);
+            dst.depth.assign(src, src + size_t(dst.width) * dst.height);
+        }
+
+        m_levelBase = first;
+        m_baseWidth = h.levels[0][1];
+        m_baseHeight = h.levels[0][2];
+        m_viewProj = h.viewProj;
+        m_sourceFrame = readback.frameSerial;
+        m_valid = true;
+    }
+
+    bool HiZOcclusion::isOccluded(const glm::vec3 &center, float radius) const
+    {
+        if (!m_valid || m_levels.empty())
+            return false;
+
+        // Screen rectangle and nearest depth of the sphere's bounding box.
+        float minX = 1.0f, minY = 1.0f, maxX = -1.0f, maxY = -1.0f;
+        float minZ = 1.0f;
+        for (uint32_t i = 0; i < 8u; ++i)
+        {
+            const glm::vec3 corner = center + glm::vec3((i & 1u) ? radius : -radius,
+                                                        (i & 2u) ? radius : -radius,
+                                                        (i & 4u) ? radius : -radius);
+            const glm::vec4 clip = m_viewProj * glm::vec4(corner, 1.0f);
+            if (clip.w <= 1e-4f)
+                return false; // crosses the camera plane
+
+            const float invW = 1.0f / clip.w;
+            const float x = clip.x * invW;
+            const float y = clip.y * invW;
+            const float z = clip.z * invW;
+            minX = std::min(minX, x);
+            maxX = std::max(maxX, x);
+            minY = std::min(minY, y);
+            maxY = std::max(maxY, y);
+            minZ = std::min(minZ, z);
+        }
+
+        if (minZ <= 0.0f)
+            return false; // reaches in front of the near plane
+        if (minX < -1.0f || maxX > 1.0f || minY < -1.0f || maxY > 1.0f)
+            return false; // (partly) outside the stored view: no depth to test against
+
+        // Texels on pyramid level 0 (same mapping as the GPU test), then the first level where
+        // the rectangle is small enough, no finer than the levels read back.
+        auto toTexel = [](float ndc, uint32_t size) -> uint32_t
+        {
+            const float t = std::clamp(ndc * 0.5f + 0.5f, 0.0f, 1.0f) * static_cast<float>(size);
+            return std::min(static_cast<uint32_t>(t), size - 1u);
+        };
+        const uint32_t x0 = toTexel(minX, m_baseWidth);
+        const uint32_t x1 = toTexel(maxX, m_baseWidth);
+        const uint32_t y0 = toTexel(minY, m_baseHeight);
+        const uint32_t y1 = toTexel(maxY, m_baseHeight);
+
+        uint32_t li = m_levelBase;
+        while (li + 1u < m_levelBase + m_levels.size() &&
+               ((x1 >> li) - (x0 >> li) + 1u > MAX_QUERY_TEXELS || (y1 >> li) - (y0 >> li) + 1u > MAX_QUERY_TEXELS))
+        {
+            ++li;
+        }
+
+        const Level &level = m_levels[li - m_levelBase];
+        float maxDepth = 0.0f;
+        for (uint32_t y = (y0 >> li); y <= (y1 >> li); ++y)
+        {
+            for (uint32_t x = (x0 >> li); x <= (x1 >> li); ++x)
+                maxDepth = std::max(maxDepth, level.depth[size_t(y) * level.width + x]);
+        }
+
+        return minZ > maxDepth;
+    }
+}
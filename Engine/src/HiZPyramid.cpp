@@ -0,0 +1,428 @@
+#include "Engine/HiZPyramid.h"
+
+#include "Engine/Pipeline.h"
+#include "Engine/Renderer.h"
+#include "Engine/VulkanContext.h"
+#include "utils/BufferUtils.h"
+
+#include <algorithm>
+#include <exception>
+
+namespace Engine
+{
+    HiZPyramid::~HiZPyramid()
+    {
+        destroy();
+    }
+
+    bool HiZPyramid::create(VulkanContext &ctx, uint32_t frameCount)
+    {
+        destroy();
+        m_device = ctx.GetDevice();
+        m_physicalDevice = ctx.GetPhysicalDevice();
+        frameCount = std::max(frameCount, 1u);
+
+        // Async compute culls read the pyramid on the compute queue.
+        m_queueFamilyCount = 0;
+        if (ctx.HasAsyncCompute())
+        {
+            m_queueFamilies[0] = ctx.GetGraphicsQueueFamilyIndex();
+            m_queueFamilies[1] = ctx.GetComputeQueueFamilyIndex();
+            m_queueFamilyCount = 2;
+        }
+
+        // Set 0: scene depth, pyramid, camera block
+        VkDescriptorSetLayoutBinding bindings[3]{};
+        bindings[0].binding = 0;
+        bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        bindings[1].binding = 1;
+        bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[2].binding = 2;
+        bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+        for (VkDescriptorSetLayoutBinding &b : bindings)
+        {
+            b.descriptorCount = 1;
+            b.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        }
+
+        VkDescriptorSetLayoutCreateInfo dsl{};
+        dsl.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        dsl.bindingCount = 3;
+        dsl.pBindings = bindings;
+
+        VkDescriptorPoolSize poolSizes[3]{};
+        poolSizes[0] = {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, frameCount};
+        poolSizes[1] = {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, frameCount};
+        poolSizes[2] = {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, frameCount};
+
+        VkDescriptorPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.maxSets = frameCount;
+        poolInfo.poolSizeCount = 3;
+        poolInfo.pPoolSizes = poolSizes;
+
+        // Depth is read with texelFetch; the sampler only has to exist.
+        VkSamplerCreateInfo si{};
+        si.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        si.magFilter = VK_FILTER_NEAREST;
+        si.minFilter = VK_FILTER_NEAREST;
+        si.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+        si.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        si.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        si.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        si.maxLod = 0.0f;
+
+        // Push constants: uvec4 info (see hiz_build.comp)
+        VkPushConstantRange pcRange{};
+        pcRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pcRange.offset = 0;
+        pcRange.size = sizeof(uint32_t) * 4u;
+
+        bool ok = vkCreateDescriptorSetLayout(m_device, &dsl, nullptr, &m_setLayout) == VK_SUCCESS &&
+                  vkCreateDescriptorPool(m_device, &poolInfo, nullptr, &m_pool) == VK_SUCCESS &&
+                  vkCreateSampler(m_device, &si, nullptr, &m_sampler) == VK_SUCCESS;
+
+        if (ok)
+        {
+            std::vector<VkDescriptorSetLayout> layouts(frameCount, m_setLayout);
+            std::vector<VkDescriptorSet> sets(frameCount, VK_NULL_HANDLE);
+            VkDescriptorSetAllocateInfo allocInfo{};
+            allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+            allocInfo.descriptorPool = m_pool;
+            allocInfo.descriptorSetCount = frameCount;
+            allocInfo.pSetLayouts = layouts.data();
+            ok = vkAllocateDescriptorSets(m_device, &allocInfo, sets.data()) == VK_SUCCESS;
+            if (ok)
+            {
+                m_slots.resize(frameCount);
+                for (uint32_t i = 0; i < frameCount; ++i)
+                    m_slots[i].set = sets[i];
+            }
+        }
+
+        if (ok)
+        {
+            VkPipelineLayoutCreateInfo plInfo{};
+            plInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+            plInfo.setLayoutCount = 1;
+            plInfo.pSetLayouts = &m_setLayout;
+            plInfo.pushConstantRangeCount = 1;
+            plInfo.pPushConstantRanges = &pcRange;
+            ok = vkCreatePipelineLayout(m_device, &plInfo, nullptr, &m_pipelineLayout) == VK_SUCCESS;
+        }
+
+        VkShaderModule comp = VK_NULL_HANDLE;
+        if (ok)
+        {
+            try
+            {
+                comp = Pipeline::createShaderModuleFromFile(m_device, "shaders/hiz_build.comp.spv");
+            }
+            catch (const std::exception &)
+            {
+                ok = false;
+            }
+        }
+
+        if (ok)
+        {
+            VkComputePipelineCreateInfo cpi{};
+            cpi.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+            cpi.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+            cpi.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+            cpi.stage.module = comp;
+            cpi.stage.pName = "main";
+            cpi.layout = m_pipelineLayout;
+            ok = vkCreateComputePipelines(m_device, ctx.GetPipelineCache(), 1, &cpi, nullptr, &m_pipeline) == VK_SUCCESS;
+        }
+        if (comp != VK_NULL_HANDLE)
+            vkDestroyShaderModule(m_device, comp, nullptr);
+
+        if (!ok)
+        {
+            destroy();
+            return false;
+        }
+        return true;
+    }
+
+    void HiZPyramid::destroy()
+    {
+        if (m_device == VK_NULL_HANDLE)
+            return;
+
+        destroyReadbacks();
+        m_slots.clear();
+        releaseRetired(0, true);
+        DestroyBuffer(m_device, m_buffer, m_memory);
+        m_capacityFloats = 0;
+        m_builtSerial = UINT64_MAX;
+
+        if (m_pipeline != VK_NULL_HANDLE)
+            vkDestroyPipeline(m_device, m_pipeline, nullptr);
+        m_pipeline = VK_NULL_HANDLE;
+        if (m_pipelineLayout != VK_NULL_HANDLE)
+            vkDestroyPipelineLayout(m_device, m_pipelineLayout, nullptr);
+        m_pipelineLayout = VK_NULL_HANDLE;
+        if (m_sampler != VK_NULL_HANDLE)
+            vkDestroySampler(m_device, m_sampler, nullptr);
+        m_sampler = VK_NULL_HANDLE;
+        if (m_pool != VK_NULL_HANDLE)
+            vkDestroyDescriptorPool(m_device, m_pool, nullptr);
+        m_pool = VK_NULL_HANDLE;
+        if (m_setLayout != VK_NULL_HANDLE)
+            vkDestroyDescriptorSetLayout(m_device, m_setLayout, nullptr);
+        m_setLayout = VK_NULL_HANDLE;
+
+        m_device = VK_NULL_HANDLE;
+    }
+
+    void HiZPyramid::destroyReadbacks()
+    {
+        for (FrameSlot &slot : m_slots)
+        {
+            DestroyBuffer(m_device, slot.readback, slot.readbackMemory);
+            slot.readbackBytes = 0;
+            slot.pending = false;
+        }
+    }
+
+    uint32_t HiZPyramid::layoutLevels(VkExtent2D extent, HiZPyramidHeader &header)
+    {
+        uint32_t w = std::max(1u, (extent.width + BASE_BLOCK - 1u) / BASE_BLOCK);
+        uint32_t h = std::max(1u, (extent.height + BASE_BLOCK - 1u) / BASE_BLOCK);
+        uint32_t offset = 0;
+        uint32_t count = 0;
+        for (;;)
+        {
+            header.levels[count][0] = offset;
+            header.levels[count][1] = w;
+            header.levels[count][2] = h;
+            header.levels[count][3] = 0;
+            offset += w * h;
+            ++count;
+            if ((w == 1u && h == 1u) || count == MAX_LEVELS)
+                break;
+            w = std::max(1u, (w + 1u) / 2u);
+            h = std::max(1u, (h + 1u) / 2u);
+        }
+        header.levelCount = count;
+        header.sourceWidth = extent.width;
+        header.sourceHeight = extent.height;
+        return offset;
+    }
+
+    void HiZPyramid::releaseRetired(uint64_t completedSerial, bool all)
+    {
+        auto done = [&](RetiredBuffer &r)
+        {
+            if (!all && r.retireSerial > completedSerial)
+                return false;
+            DestroyBuffer(m_device, r.buffer, r.memory);
+            return true;
+        };
+        m_retired.erase(std::remove_if(m_retired.begin(), m_retired.end(), done), m_retired.end());
+    }
+
+    bool HiZPyramid::ensureStorage(uint32_t floatCount, uint64_t frameSerial)
+    {
+        if (m_buffer != VK_NULL_HANDLE && m_capacityFloats >= floatCount)
+            return true;
+
+        // This frame's culls may already have recorded reads of the old buffer.
+        if (m_buffer != VK_NULL_HANDLE)
+            m_retired.push_back(RetiredBuffer{m_buffer, m_memory, frameSerial + 1u});
+        m_buffer = VK_NULL_HANDLE;
+        m_memory = GpuAllocation{};
+        m_capacityFloats = 0;
+        m_builtSerial = UINT64_MAX;
+
+        const VkDeviceSize bytes = sizeof(HiZPyramidHeader) + VkDeviceSize(floatCount) * sizeof(float);
+        if (CreateBuffer(m_device, m_physicalDevice, bytes,
+                         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_buffer, m_memory, m_queueFamilyCount, m_queueFamilies) != VK_SUCCESS)
+        {
+            DestroyBuffer(m_device, m_buffer, m_memory);
+            return false;
+        }
+        m_capacityFloats = floatCount;
+        return true;
+    }
+
+    bool HiZPyramid::ensureReadback(FrameSlot &slot, VkDeviceSize bytes)
+    {
+        if (slot.readback != VK_NULL_HANDLE && slot.readbackBytes >= bytes)
+            return true;
+
+        // The slot's fence has signaled, so its old buffer is no longer in use.
+        DestroyBuffer(m_device, slot.readback, slot.readbackMemory);
+        slot.readbackBytes = 0;
+        slot.pending = false;
+        if (CreateBuffer(m_device, m_physicalDevice, bytes, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                         slot.readback, slot.readbackMemory) != VK_SUCCESS ||
+            !slot.readbackMemory.mapped)
+        {
+            DestroyBuffer(m_device, slot.readback, slot.readbackMemory);
+            return false;
+        }
+        slot.readbackBytes = bytes;
+        return true;
+    }
+
+    bool HiZPyramid::record(VkCommandBuffer cmd, uint32_t frameIndex, uint64_t frameSerial, uint64_t completedSerial,
+                            VkImageView depthView, VkExtent2D extent, VkExtent2D maxExtent,
+                            VkBuffer cameraBuffer, uint32_t cameraOffset, bool readback)
+    {
+        if (!m_retired.empty())
+            releaseRetired(completedSerial, false);
+        if (!created() || frameIndex >= m_slots.size() || depthView == VK_NULL_HANDLE || cameraBuffer == VK_NULL_HANDLE)
+            return false;
+        if (extent.width == 0 || extent.height == 0)
+            return false;
+
+        // Sized for the full extent: resolution scaling moves the render extent every few frames.
+        HiZPyramidHeader header{};
+        const uint32_t capacity = layoutLevels(VkExtent2D{std::max(extent.width, maxExtent.width),
+                                                          std::max(extent.height, maxExtent.height)},
+                                               header);
+        if (!ensureStorage(capacity, frameSerial))
+            return false;
+        header = HiZPyramidHeader{};
+        const uint32_t floatCount = layoutLevels(extent, header);
+        header.valid = 1u;
+
+        FrameSlot &slot = m_slots[frameIndex];
+        slot.pending = false;
+
+        VkDescriptorImageInfo depthInfo{};
+        depthInfo.sampler = m_sampler;
+        depthInfo.imageView = depthView;
+        depthInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        VkDescriptorBufferInfo pyramidInfo{m_buffer, 0, VK_WHOLE_SIZE};
+        VkDescriptorBufferInfo cameraInfo{cameraBuffer, 0, sizeof(CameraBlock)};
+
+        VkWriteDescriptorSet writes[3]{};
+        for (uint32_t i = 0; i < 3u; ++i)
+        {
+            writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[i].dstSet = slot.set;
+            writes[i].dstBinding = i;
+            writes[i].descriptorCount = 1;
+        }
+        writes[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        writes[0].pImageInfo = &depthInfo;
+        writes[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[1].pBufferInfo = &pyramidInfo;
+        writes[2].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+        writes[2].pBufferInfo = &cameraInfo;
+        vkUpdateDescriptorSets(m_device, 3, writes, 0, nullptr);
+
+        // Earlier readers (this frame's culls, the last readback copy) before the rewrite. Culls on
+        // the async compute queue are covered by the submit's timeline wait at DRAW_INDIRECT,
+        // which this barrier chains with.
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+        // Level table (everything after the matrix, which the shader copies from the camera block).
+        const VkDeviceSize tableOffset = sizeof(glm::mat4);
+        vkCmdUpdateBuffer(cmd, m_buffer, tableOffset, sizeof(HiZPyramidHeader) - tableOffset,
+                          reinterpret_cast<const uint8_t *>(&header) + tableOffset);
+
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipeline);
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelineLayout, 0, 1, &slot.set, 1, &cameraOffset);
+
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        for (uint32_t level = 0; level < header.levelCount; ++level)
+        {
+            if (level > 0u)
+            {
+                vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                     0, 1, &barrier, 0, nullptr, 0, nullptr);
+            }
+            const uint32_t info[4] = {level, extent.width, extent.height, 0u};
+            vkCmdPushConstants(cmd, m_pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(info), info);
+            vkCmdDispatch(cmd, (header.levels[level][1] + 7u) / 8u, (header.levels[level][2] + 7u) / 8u, 1);
+        }
+
+        // For the next frame's culls and the readback copy below.
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             0, 1, &barrier, 0, nullptr, 0, nullptr);
+        m_builtSerial = frameSerial;
+
+        if (!readback)
+            return true;
+
+        // Header plus the levels from the first one within READBACK_MAX_TEXELS, tightly packed.
+        uint32_t first = 0;
+        while (first + 1u < header.levelCount &&
+               header.levels[first][1] * header.levels[first][2] > READBACK_MAX_TEXELS)
+            ++first;
+        const VkDeviceSize suffixBytes = VkDeviceSize(floatCount - header.levels[first][0]) * sizeof(float);
+        if (!ensureReadback(slot, sizeof(HiZPyramidHeader) + suffixBytes))
+            return true;
+
+        VkBufferCopy regions[2]{};
+        regions[0].srcOffset = 0;
+        regions[0].dstOffset = 0;
+        regions[0].size = sizeof(HiZPyramidHeader);
+        regions[1].srcOffset = sizeof(HiZPyramidHeader) + VkDeviceSize(header.levels[first][0]) * sizeof(float);
+        regions[1].dstOffset = sizeof(HiZPyramidHeader);
+        regions[1].size = suffixBytes;
+        vkCmdCopyBuffer(cmd, m_buffer, slot.readback, 2, regions);
+
+        VkBufferMemoryBarrier toHost{};
+        toHost.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        toHost.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        toHost.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        toHost.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toHost.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toHost.buffer = slot.readback;
+        toHost.offset = 0;
+        toHost.size = VK_WHOLE_SIZE;
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+                             0, 0, nullptr, 1, &toHost, 0, nullptr);
+
+        slot.firstLevel = first;
+        slot.frameSerial = frameSerial;
+        slot.pending = true;
+        return true;
+    }
+
+    uint64_t HiZPyramid::pendingReadback(uint32_t frameIndex) const
+    {
+        if (frameIndex >= m_slots.size() || !m_slots[frameIndex].pending)
+            return UINT64_MAX;
+        return m_slots[frameIndex].frameSerial;
+    }
+
+    bool HiZPyramid::takeReadback(uint32_t frameIndex, HiZReadback &out)
+    {
+        if (frameIndex >= m_slots.size())
+            return false;
+        FrameSlot &slot = m_slots[frameIndex];
+        if (!slot.pending || !slot.readbackMemory.mapped)
+            return false;
+        slot.pending = false;
+
+        const uint8_t *base = static_cast<const uint8_t *>(slot.readbackMemory.mapped);
+        out.header = reinterpret_cast<const HiZPyramidHeader *>(base);
+        out.depth = reinterpret_cast<const float *>(base + sizeof(HiZPyramidHeader));
+        out.firstLevel = slot.firstLevel;
+        out.frameSerial = slot.frameSerial;
+        return true;
+    }
+}
@@ -49,7 +49,7 @@ namespace Engine
         initInfo.Device = ctx.GetDevice();
         initInfo.QueueFamily = ctx.GetGraphicsQueueFamilyIndex();
         initInfo.Queue = ctx.GetGraphicsQueue();
-        initInfo.PipelineCache = VK_NULL_HANDLE;
+        initInfo.PipelineCache = ctx.GetPipelineCache();
         initInfo.DescriptorPool = m_descriptorPool;
         initInfo.Subpass = 0;
         initInfo.MinImageCount = imageCount;
@@ -1,27 +1,10 @@
 #include "utils/ImageUtils.h"
+#include "utils/StagingRing.h"
+#include <algorithm>
 #include <cstring>
-#include <stdexcept>
 
 namespace Engine
 {
-    // ============================================================
-    // Memory helper
-    // ============================================================
-
-    static uint32_t findMemoryType(VkPhysicalDevice phys, uint32_t typeBits, VkMemoryPropertyFlags props)
-    {
-        VkPhysicalDeviceMemoryProperties memProps{};
-        vkGetPhysicalDeviceMemoryProperties(phys, &memProps);
-
-        for (uint32_t i = 0; i < memProps.memoryTypeCount; ++i)
-        {
-            if ((typeBits & (1u << i)) && (memProps.memoryTypes[i].propertyFlags & props) == props)
-                return i;
-        }
-
-        throw std::runtime_error("ImageUtils: failed to find suitable memory type");
-    }
-
     // ============================================================
     // Staging buffer
     // ============================================================
@@ -46,41 +29,18 @@ namespace Engine
         if (r != VK_SUCCESS)
             return r;
 
-        VkMemoryRequirements req{};
-        vkGetBufferMemoryRequirements(device, out.buffer, &req);
-
-        VkMemoryAllocateInfo ai{};
-        ai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        ai.allocationSize = req.size;
-        ai.memoryTypeIndex = findMemoryType(
-            physicalDevice, req.memoryTypeBits,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-        r = vkAllocateMemory(device, &ai, nullptr, &out.memory);
-        if (r != VK_SUCCESS)
+        r = AllocateBufferMemory(device, physicalDevice, out.buffer,
+                                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                 out.memory);
+        if (r != VK_SUCCESS || !out.memory.mapped)
         {
             vkDestroyBuffer(device, out.buffer, nullptr);
+            FreeGpuMemory(device, out.memory);
             out.buffer = VK_NULL_HANDLE;
-            return r;
+            return (r != VK_SUCCESS) ? r : VkResult(VK_ERROR_MEMORY_MAP_FAILED);
         }
 
-        r = vkBindBufferMemory(device, out.buffer, out.memory, 0);
-        if (r != VK_SUCCESS)
-        {
-            vkDestroyBuffer(device, out.buffer, nullptr);
-            vkFreeMemory(device, out.memory, nullptr);
-            out.buffer = VK_NULL_HANDLE;
-            out.memory = VK_NULL_HANDLE;
-            return r;
-        }
-
-        void *mapped = nullptr;
-        r = vkMapMemory(device, out.memory, 0, dataSize, 0, &mapped);
-        if (r != VK_SUCCESS)
-            return r;
-
-        std::memcpy(mapped, dataBytes, static_cast<size_t>(dataSize));
-        vkUnmapMemory(device, out.memory);
+        std::memcpy(out.memory.mapped, dataBytes, static_cast<size_t>(dataSize));
 
         out.size = dataSize;
         return VK_SUCCESS;
@@ -93,11 +53,7 @@ namespace Engine
             vkDestroyBuffer(device, h.buffer, nullptr);
             h.buffer = VK_NULL_HANDLE;
         }
-        if (h.memory != VK_NULL_HANDLE)
-        {
-            vkFreeMemory(device, h.memory, nullptr);
-            h.memory = VK_NULL_HANDLE;
-        }
+        FreeGpuMemory(device, h.memory);
         h.size = 0;
     }
 
@@ -117,6 +73,11 @@ namespace Engine
         ctx.commandPool = commandPool;
         ctx.queue = queue;
         ctx.pendingStaging.clear();
+        ctx.transferQueue = VK_NULL_HANDLE;
+        ctx.transferPool = VK_NULL_HANDLE;
+        ctx.transferCmd = VK_NULL_HANDLE;
+        ctx.transferBuffers.clear();
+        ctx.transferImages.clear();
         ctx.begun = false;
 
         // Allocate one primary command buffer
@@ -146,6 +107,156 @@ namespace Engine
         return true;
     }
 
+    bool UseTransferQueue(
+        UploadContext &ctx,
+        VkCommandPool transferPool,
+        VkQueue transferQueue,
+        uint32_t transferFamily,
+        uint32_t graphicsFamily)
+    {
+        if (!ctx.begun || ctx.transferCmd != VK_NULL_HANDLE)
+            return false;
+        if (transferPool == VK_NULL_HANDLE || transferQueue == VK_NULL_HANDLE || transferFamily == graphicsFamily)
+            return false;
+
+        VkCommandBufferAllocateInfo alloc{};
+        alloc.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        alloc.commandPool = transferPool;
+        alloc.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        alloc.commandBufferCount = 1;
+
+        VkCommandBuffer cmd = VK_NULL_HANDLE;
+        if (vkAllocateCommandBuffers(ctx.device, &alloc, &cmd) != VK_SUCCESS)
+            return false;
+
+        VkCommandBufferBeginInfo begin{};
+        begin.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        begin.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        if (vkBeginCommandBuffer(cmd, &begin) != VK_SUCCESS)
+        {
+            vkFreeCommandBuffers(ctx.device, transferPool, 1, &cmd);
+            return false;
+        }
+
+        ctx.transferQueue = transferQueue;
+        ctx.transferPool = transferPool;
+        ctx.transferCmd = cmd;
+        ctx.transferFamily = transferFamily;
+        ctx.graphicsFamily = graphicsFamily;
+        ctx.transferBuffers.clear();
+        ctx.transferImages.clear();
+        return true;
+    }
+
+    // Release (recorded at the end of transferCmd) or acquire (recorded into cmd) of everything
+    // the transfer queue wrote. Images stay in TRANSFER_DST_OPTIMAL for the graphics commands.
+    static void recordOwnershipTransfer(const UploadContext &ctx, VkCommandBuffer cmd, bool release)
+    {
+        std::vector<VkBufferMemoryBarrier> buffers(ctx.transferBuffers.size());
+        for (size_t i = 0; i < buffers.size(); ++i)
+        {
+            VkBufferMemoryBarrier &b = buffers[i];
+            b.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            b.srcAccessMask = release ? VK_ACCESS_TRANSFER_WRITE_BIT : 0;
+            b.dstAccessMask = release ? 0 : (VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT);
+            b.srcQueueFamilyIndex = ctx.transferFamily;
+            b.dstQueueFamilyIndex = ctx.graphicsFamily;
+            b.buffer = ctx.transferBuffers[i];
+            b.offset = 0;
+            b.size = VK_WHOLE_SIZE;
+        }
+
+        std::vector<VkImageMemoryBarrier> images(ctx.transferImages.size());
+        for (size_t i = 0; i < images.size(); ++i)
+        {
+            VkImageMemoryBarrier &b = images[i];
+            b.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            b.srcAccessMask = release ? VK_ACCESS_TRANSFER_WRITE_BIT : 0;
+            b.dstAccessMask = release ? 0 : (VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT);
+            b.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            b.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            b.srcQueueFamilyIndex = ctx.transferFamily;
+            b.dstQueueFamilyIndex = ctx.graphicsFamily;
+            b.image = ctx.transferImages[i].image;
+            b.subresourceRange = ctx.transferImages[i].range;
+        }
+
+        vkCmdPipelineBarrier(
+            cmd,
+            release ? VK_PIPELINE_STAGE_TRANSFER_BIT : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+            release ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT : VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+            0,
+            0, nullptr,
+            static_cast<uint32_t>(buffers.size()), buffers.data(),
+            static_cast<uint32_t>(images.size()), images.data());
+    }
+
+    static void releaseTransferObjects(UploadContext &ctx, VkCommandBuffer &acquireCmd, VkSemaphore &transferDone)
+    {
+        if (transferDone != VK_NULL_HANDLE)
+            vkDestroySemaphore(ctx.device, transferDone, nullptr);
+        transferDone = VK_NULL_HANDLE;
+        if (acquireCmd != VK_NULL_HANDLE)
+            vkFreeCommandBuffers(ctx.device, ctx.commandPool, 1, &acquireCmd);
+        acquireCmd = VK_NULL_HANDLE;
+        if (ctx.transferCmd != VK_NULL_HANDLE)
+            vkFreeCommandBuffers(ctx.device, ctx.transferPool, 1, &ctx.transferCmd);
+        ctx.transferCmd = VK_NULL_HANDLE;
+        ctx.transferBuffers.clear();
+        ctx.transferImages.clear();
+    }
+
+    // Ends and submits transferCmd (signaling transferDone) and records the matching acquire into
+    // acquireCmd. Nothing routed: frees transferCmd and leaves both outputs null.
+    static bool submitTransfer(UploadContext &ctx, VkCommandBuffer &acquireCmd, VkSemaphore &transferDone)
+    {
+        if (ctx.transferBuffers.empty() && ctx.transferImages.empty())
+        {
+            releaseTransferObjects(ctx, acquireCmd, transferDone);
+            return true;
+        }
+
+        recordOwnershipTransfer(ctx, ctx.transferCmd, true);
+        if (vkEndCommandBuffer(ctx.transferCmd) != VK_SUCCESS)
+            return false;
+
+        VkCommandBufferAllocateInfo alloc{};
+        alloc.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        alloc.commandPool = ctx.commandPool;
+        alloc.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        alloc.commandBufferCount = 1;
+        if (vkAllocateCommandBuffers(ctx.device, &alloc, &acquireCmd) != VK_SUCCESS)
+        {
+            acquireCmd = VK_NULL_HANDLE;
+            return false;
+        }
+
+        VkCommandBufferBeginInfo begin{};
+        begin.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        begin.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        if (vkBeginCommandBuffer(acquireCmd, &begin) != VK_SUCCESS)
+            return false;
+        recordOwnershipTransfer(ctx, acquireCmd, false);
+        if (vkEndCommandBuffer(acquireCmd) != VK_SUCCESS)
+            return false;
+
+        VkSemaphoreCreateInfo si{};
+        si.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        if (vkCreateSemaphore(ctx.device, &si, nullptr, &transferDone) != VK_SUCCESS)
+        {
+            transferDone = VK_NULL_HANDLE;
+            return false;
+        }
+
+        VkSubmitInfo submit{};
+        submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submit.commandBufferCount = 1;
+        submit.pCommandBuffers = &ctx.transferCmd;
+        submit.signalSemaphoreCount = 1;
+        submit.pSignalSemaphores = &transferDone;
+        return vkQueueSubmit(ctx.transferQueue, 1, &submit, VK_NULL_HANDLE) == VK_SUCCESS;
+    }
+
     bool EndSubmitAndWait(UploadContext &ctx)
     {
         if (!ctx.begun || ctx.cmd == VK_NULL_HANDLE)
@@ -155,29 +266,71 @@ namespace Engine
         if (r != VK_SUCCESS)
             return false;
 
-        // Fence so we can wait for completion (better than queueWaitIdle spam)
-        VkFence fence = VK_NULL_HANDLE;
-        VkFenceCreateInfo fi{};
-        fi.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-        r = vkCreateFence(ctx.device, &fi, nullptr, &fence);
-        if (r != VK_SUCCESS)
+        // Fence so we can wait for completion (better than queueWaitIdle spam).
+        // Ring-staged copies use the ring's fence so their region is recycled when it signals.
+        VkFence fence = ctx.ring ? ctx.ring->beginSubmit() : VK_NULL_HANDLE;
+        const bool ringFence = (fence != VK_NULL_HANDLE);
+        if (!ringFence)
+        {
+            VkFenceCreateInfo fi{};
+            fi.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+            r = vkCreateFence(ctx.device, &fi, nullptr, &fence);
+            if (r != VK_SUCCESS)
+                return false;
+        }
+
+        // Transfer queue copies first; the acquire runs ahead of cmd in the graphics submit.
+        VkCommandBuffer acquireCmd = VK_NULL_HANDLE;
+        VkSemaphore transferDone = VK_NULL_HANDLE;
+        if (ctx.transferCmd != VK_NULL_HANDLE && !submitTransfer(ctx, acquireCmd, transferDone))
+        {
+            // Nothing waits on a semaphore whose submit failed; one that was submitted must be
+            // waited out before its command buffer goes.
+            if (transferDone != VK_NULL_HANDLE)
+                vkQueueWaitIdle(ctx.transferQueue);
+            releaseTransferObjects(ctx, acquireCmd, transferDone);
+            if (ringFence)
+                ctx.ring->cancelSubmit();
+            else
+                vkDestroyFence(ctx.device, fence, nullptr);
             return false;
+        }
+
+        const VkCommandBuffer cmds[2] = {acquireCmd, ctx.cmd};
+        const VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
 
         VkSubmitInfo submit{};
         submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submit.commandBufferCount = 1;
-        submit.pCommandBuffers = &ctx.cmd;
+        submit.commandBufferCount = acquireCmd != VK_NULL_HANDLE ? 2u : 1u;
+        submit.pCommandBuffers = acquireCmd != VK_NULL_HANDLE ? cmds : &ctx.cmd;
+        if (transferDone != VK_NULL_HANDLE)
+        {
+            submit.waitSemaphoreCount = 1;
+            submit.pWaitSemaphores = &transferDone;
+            submit.pWaitDstStageMask = &waitStage;
+        }
 
         r = vkQueueSubmit(ctx.queue, 1, &submit, fence);
         if (r != VK_SUCCESS)
         {
-            vkDestroyFence(ctx.device, fence, nullptr);
+            if (ringFence)
+                ctx.ring->cancelSubmit();
+            else
+                vkDestroyFence(ctx.device, fence, nullptr);
+            if (transferDone != VK_NULL_HANDLE)
+                vkQueueWaitIdle(ctx.transferQueue);
+            releaseTransferObjects(ctx, acquireCmd, transferDone);
             return false;
         }
 
         // Wait once for the whole model upload
         r = vkWaitForFences(ctx.device, 1, &fence, VK_TRUE, UINT64_MAX);
-        vkDestroyFence(ctx.device, fence, nullptr);
+        if (ringFence)
+            ctx.ring->retire();
+        else
+            vkDestroyFence(ctx.device, fence, nullptr);
+        if (r == VK_SUCCESS)
+            releaseTransferObjects(ctx, acquireCmd, transferDone);
 
         if (r != VK_SUCCESS)
             return false;
@@ -195,6 +348,36 @@ namespace Engine
         return true;
     }
 
+    bool StageBytes(
+        UploadContext &ctx,
+        const void *dataBytes,
+        VkDeviceSize dataSize,
+        VkBuffer &outBuffer,
+        VkDeviceSize &outOffset)
+    {
+        if (!dataBytes || dataSize == 0)
+            return false;
+
+        // 16 bytes covers every texel block and index/vertex copy alignment we use.
+        StagingRing::Allocation a{};
+        if (ctx.ring && ctx.ring->allocate(dataSize, 16, a))
+        {
+            std::memcpy(a.mapped, dataBytes, static_cast<size_t>(dataSize));
+            outBuffer = a.buffer;
+            outOffset = a.offset;
+            return true;
+        }
+
+        StagingBufferHandle staging{};
+        if (CreateStagingBuffer(ctx.device, ctx.physicalDevice, dataBytes, dataSize, staging) != VK_SUCCESS)
+            return false;
+        ctx.pendingStaging.push_back(staging);
+
+        outBuffer = staging.buffer;
+        outOffset = 0;
+        return true;
+    }
+
     // ============================================================
     // Image creation
     // ============================================================
@@ -207,7 +390,7 @@ namespace Engine
         VkFormat format,
         VkImageUsageFlags usage,
         VkImage &outImage,
-        VkDeviceMemory &outMemory)
+        GpuAllocation &outMemory)
     {
         return CreateImage2D(device, physicalDevice, width, height, format, usage, 1u, outImage, outMemory);
     }
@@ -221,7 +404,7 @@ namespace Engine
         VkImageUsageFlags usage,
         uint32_t mipLevels,
         VkImage &outImage,
-        VkDeviceMemory &outMemory)
+        GpuAllocation &outMemory)
     {
         VkImageCreateInfo ii{};
         ii.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -242,15 +425,7 @@ namespace Engine
         if (r != VK_SUCCESS)
             return r;
 
-        VkMemoryRequirements req{};
-        vkGetImageMemoryRequirements(device, outImage, &req);
-
-        VkMemoryAllocateInfo ai{};
-        ai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        ai.allocationSize = req.size;
-        ai.memoryTypeIndex = findMemoryType(physicalDevice, req.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-
-        r = vkAllocateMemory(device, &ai, nullptr, &outMemory);
+        r = AllocateImageMemory(device, physicalDevice, outImage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, outMemory);
         if (r != VK_SUCCESS)
         {
             vkDestroyImage(device, outImage, nullptr);
@@ -258,16 +433,6 @@ namespace Engine
             return r;
         }
 
-        r = vkBindImageMemory(device, outImage, outMemory, 0);
-        if (r != VK_SUCCESS)
-        {
-            vkDestroyImage(device, outImage, nullptr);
-            vkFreeMemory(device, outMemory, nullptr);
-            outImage = VK_NULL_HANDLE;
-            outMemory = VK_NULL_HANDLE;
-            return r;
-        }
-
         return VK_SUCCESS;
     }
 
@@ -354,6 +519,17 @@ namespace Engine
         VkImageLayout oldLayout,
         VkImageLayout newLayout,
         VkImageAspectFlags aspectFlags)
+    {
+        CmdTransitionImageLayout(ctx, image, oldLayout, newLayout, aspectFlags, 1);
+    }
+
+    void CmdTransitionImageLayout(
+        UploadContext &ctx,
+        VkImage image,
+        VkImageLayout oldLayout,
+        VkImageLayout newLayout,
+        VkImageAspectFlags aspectFlags,
+        uint32_t mipLevels)
     {
         VkImageMemoryBarrier barrier{};
         barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -365,7 +541,7 @@ namespace Engine
 
         barrier.subresourceRange.aspectMask = aspectFlags;
         barrier.subresourceRange.baseMipLevel = 0;
-        barrier.subresourceRange.levelCount = 1;
+        barrier.subresourceRange.levelCount = mipLevels;
         barrier.subresourceRange.baseArrayLayer = 0;
         barrier.subresourceRange.layerCount = 1;
 
@@ -376,8 +552,17 @@ namespace Engine
         barrier.srcAccessMask = srcAccess;
         barrier.dstAccessMask = dstAccess;
 
+        // A new image starts its upload on the transfer queue.
+        VkCommandBuffer cmd = ctx.cmd;
+        if (ctx.transferCmd != VK_NULL_HANDLE && oldLayout == VK_IMAGE_LAYOUT_UNDEFINED &&
+            newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
+        {
+            cmd = ctx.transferCmd;
+            ctx.transferImages.push_back({image, barrier.subresourceRange});
+        }
+
         vkCmdPipelineBarrier(
-            ctx.cmd,
+            cmd,
             srcStage,
             dstStage,
             0,
@@ -386,28 +571,64 @@ namespace Engine
             1, &barrier);
     }
 
+    void CmdCopyBuffer(
+        UploadContext &ctx,
+        VkBuffer src,
+        VkDeviceSize srcOffset,
+        VkBuffer dst,
+        VkDeviceSize size,
+        VkDeviceSize dstOffset)
+    {
+        VkBufferCopy region{};
+        region.srcOffset = srcOffset;
+        region.dstOffset = dstOffset;
+        region.size = size;
+
+        if (ctx.transferCmd != VK_NULL_HANDLE)
+        {
+            if (std::find(ctx.transferBuffers.begin(), ctx.transferBuffers.end(), dst) == ctx.transferBuffers.end())
+                ctx.transferBuffers.push_back(dst);
+            vkCmdCopyBuffer(ctx.transferCmd, src, dst, 1, &region);
+            return;
+        }
+        vkCmdCopyBuffer(ctx.cmd, src, dst, 1, &region);
+    }
+
     void CmdCopyBufferToImage(
         UploadContext &ctx,
         VkBuffer buffer,
         VkImage image,
         uint32_t width,
-        uint32_t height)
+        uint32_t height,
+        VkDeviceSize bufferOffset,
+        uint32_t mipLevel)
     {
         VkBufferImageCopy region{};
-        region.bufferOffset = 0;
+        region.bufferOffset = bufferOffset;
         region.bufferRowLength = 0;
         region.bufferImageHeight = 0;
 
         region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        region.imageSubresource.mipLevel = 0;
+        region.imageSubresource.mipLevel = mipLevel;
         region.imageSubresource.baseArrayLayer = 0;
         region.imageSubresource.layerCount = 1;
 
         region.imageOffset = {0, 0, 0};
         region.imageExtent = {width, height, 1};
 
+        // Images whose upload started on the transfer queue (CmdTransitionImageLayout) stay there.
+        VkCommandBuffer cmd = ctx.cmd;
+        for (const UploadContext::TransferImage &t : ctx.transferImages)
+        {
+            if (t.image == image)
+            {
+                cmd = ctx.transferCmd;
+                break;
+            }
+        }
+
         vkCmdCopyBufferToImage(
-            ctx.cmd,
+            cmd,
             buffer,
             image,
             VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
@@ -415,6 +636,41 @@ namespace Engine
             &region);
     }
 
+    void CmdCopyImageMips(
+        UploadContext &ctx,
+        VkImage src,
+        uint32_t srcBaseMip,
+        VkImage dst,
+        uint32_t width,
+        uint32_t height,
+        uint32_t levelCount)
+    {
+        std::vector<VkImageCopy> regions(levelCount); // value-initialized: zero offsets
+        uint32_t w = width, h = height;
+        for (uint32_t i = 0; i < levelCount; ++i)
+        {
+            VkImageCopy &r = regions[i];
+            r.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            r.srcSubresource.mipLevel = srcBaseMip + i;
+            r.srcSubresource.baseArrayLayer = 0;
+            r.srcSubresource.layerCount = 1;
+            r.dstSubresource = r.srcSubresource;
+            r.dstSubresource.mipLevel = i;
+            r.extent = {w, h, 1};
+            w = (w > 1u) ? (w >> 1) : 1u;
+            h = (h > 1u) ? (h >> 1) : 1u;
+        }
+
+        vkCmdCopyImage(
+            ctx.cmd,
+            src,
+            VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            dst,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            levelCount,
+            regions.data());
+    }
+
     bool CmdGenerateMipmaps(
         UploadContext &ctx,
         VkImage image,
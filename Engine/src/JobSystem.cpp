@@ -1,38 +1,160 @@
 #include "utils/JobSystem.h"
+#include "utils/Profiler.h"
 
 #include <algorithm>
+#include <cstdio>
 
 namespace Engine
 {
+    namespace
+    {
+        // Set while a thread executes items of a parallelFor (workers and participating callers).
+        thread_local bool t_insideJob = false;
+
+        // Identifies worker threads: the owning job system and the worker's index.
+        thread_local const JobSystem *t_owner = nullptr;
+        thread_local uint32_t t_workerIndex = 0;
+
+        struct InsideJobScope
+        {
+            bool prev;
+            InsideJobScope() : prev(t_insideJob) { t_insideJob = true; }
+            ~InsideJobScope() { t_insideJob = prev; }
+        };
+
+        // Empty tasks budget before an idle worker goes to sleep.
+        constexpr uint32_t IDLE_SPINS_BEFORE_SLEEP = 64;
+
+        // Target number of range tasks per thread for automatically chosen grain sizes.
+        constexpr uint32_t TASKS_PER_THREAD = 4;
+
+        // Minimum work per range when the item cost is known (push/steal/wake cost a few
+        // hundred ns to a few us; 10us ranges keep that overhead around 10% or less).
+        constexpr uint32_t MIN_RANGE_NS = 10000;
+    }
+
+    bool JobSystem::isInsideJob()
+    {
+        return t_insideJob;
+    }
+
     JobSystem::JobSystem(uint32_t workerCount)
-        : m_workerCount(workerCount)
     {
+        Config config;
+        config.workerCount = workerCount;
+        startWorkers(config);
+    }
+
+    JobSystem::JobSystem(const Config &config)
+    {
+        startWorkers(config);
+    }
+
+    void JobSystem::startWorkers(const Config &config)
+    {
+        m_topology = CpuTopology::detect();
+        const std::vector<uint32_t> performance = m_topology.performanceCpus();
+        const std::vector<uint32_t> efficiency = m_topology.efficiencyCpus();
+        const bool hybrid = m_topology.hybrid();
+
+        uint32_t backgroundCount = 0;
+        if (config.workerCount == Config::AutoWorkers)
+        {
+            m_loopWorkerCount = (performance.size() > 1u) ? static_cast<uint32_t>(performance.size() - 1u) : 0u;
+            backgroundCount = (config.backgroundWorkers && hybrid) ? static_cast<uint32_t>(efficiency.size()) : 0u;
+        }
+        else
+        {
+            m_loopWorkerCount = config.workerCount;
+        }
+        m_workerCount = m_loopWorkerCount + backgroundCount;
+
+        m_counters = std::make_unique<ThreadCounters[]>(m_workerCount + 1u);
+        m_metricsSinceNs.store(Profiler::nowNs(), std::memory_order_relaxed);
+
         if (m_workerCount == 0)
         {
             m_running.store(false, std::memory_order_release);
             return;
         }
 
+        // CPUs each worker may run on (empty = anywhere). Pinned loop workers start one CPU in,
+        // leaving the first performance core to the thread that owns the job system.
+        std::vector<std::vector<uint32_t>> affinity(m_workerCount);
+        std::vector<uint32_t> byPreference = performance;
+        byPreference.insert(byPreference.end(), efficiency.begin(), efficiency.end());
+        for (uint32_t i = 0; i < m_loopWorkerCount; ++i)
+        {
+            if (config.pinWorkers && !byPreference.empty())
+            {
+                const size_t skip = (m_loopWorkerCount < byPreference.size()) ? 1u : 0u;
+                affinity[i] = {byPreference[(i + skip) % byPreference.size()]};
+            }
+            else if (hybrid && m_loopWorkerCount <= performance.size())
+                affinity[i] = performance;
+        }
+        for (uint32_t i = m_loopWorkerCount; i < m_workerCount; ++i)
+            affinity[i] = efficiency;
+
+        m_queues.reserve(m_workerCount + 1u);
+        for (uint32_t i = 0; i < m_workerCount + 1u; ++i)
+        {
+            m_queues.emplace_back(std::make_unique<WorkQueue>());
+            m_queues.back()->tasks.reserve(64);
+        }
+
         m_running.store(true, std::memory_order_release);
         m_workers.reserve(m_workerCount);
         for (uint32_t i = 0; i < m_workerCount; ++i)
         {
-            m_workers.emplace_back([this, i]()
-                                   { this->workerMain(i); });
+            m_workers.emplace_back([this, i, cpus = std::move(affinity[i])]()
+                                   {
+                                       if (!cpus.empty())
+                                           (void)setCurrentThreadAffinity(cpus);
+                                       if (isBackgroundWorker(i))
+                                           setCurrentThreadBackgroundPriority();
+                                       this->workerMain(i); });
         }
     }
 
     JobSystem::~JobSystem()
     {
+        // Finish outstanding async jobs. Main-thread jobs are cancelled (marked done without
+        // running): the frame loop that would have run them is gone, and whatever they capture
+        // (renderer, asset manager) may already be destroyed.
+        m_stopping.store(true, std::memory_order_seq_cst);
+        while (m_asyncInFlight.load(std::memory_order_acquire) > 0u)
+        {
+            std::deque<AsyncJob *> cancelled;
+            {
+                std::lock_guard<std::mutex> lock(m_mainMutex);
+                cancelled.swap(m_mainJobs);
+            }
+            for (AsyncJob *job : cancelled)
+            {
+                job->fn = nullptr;
+                completeJob(job);
+            }
+
+            Task t;
+            AsyncJob *next = nullptr;
+            if (m_workerCount > 0 && findTask(t))
+                execute(t, currentWorkerIndex());
+            else if (popAsync(next))
+                runJob(next);
+            else
+                std::this_thread::yield();
+        }
+
         if (!m_running.load(std::memory_order_acquire))
             return;
 
         {
-            std::lock_guard<std::mutex> lock(m_mutex);
-            m_running.store(false, std::memory_order_release);
-            ++m_jobId; // wake all
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+            m_running.store(false, std::memory_order_seq_cst);
         }
-        m_cvStart.notify_all();
+        m_cvWork.notify_all();
+        m_cvBackground.notify_all();
 
         for (auto &t : m_workers)
         {
@@ -42,99 +164,616 @@ namespace Engine
         m_workers.clear();
     }
 
+    uint32_t JobSystem::currentWorkerIndex() const
+    {
+        return (t_owner == this) ? t_workerIndex : m_workerCount;
+    }
+
+    uint32_t JobSystem::autoGrain(uint32_t itemCount, uint32_t itemCostNs) const
+    {
+        const uint32_t threads = m_loopWorkerCount + 1u;
+        uint32_t grain = std::max<uint32_t>(1u, itemCount / (threads * TASKS_PER_THREAD));
+        if (itemCostNs > 0u)
+            grain = std::max<uint32_t>(grain, (MIN_RANGE_NS + itemCostNs - 1u) / itemCostNs);
+        return grain;
+    }
+
     void JobSystem::parallelFor(uint32_t itemCount, const JobFn &fn)
     {
         if (itemCount == 0)
             return;
 
-        // This job system supports one in-flight parallelFor at a time.
-        std::lock_guard<std::mutex> submitLock(m_submitMutex);
+        runRange([](const void *ctx, uint32_t workerIndex, uint32_t first, uint32_t last)
+                 {
+                     const JobFn &f = *static_cast<const JobFn *>(ctx);
+                     for (uint32_t i = first; i < last; ++i)
+                         f(workerIndex, i); },
+                 &fn, itemCount, autoGrain(itemCount));
+    }
+
+    void JobSystem::runRange(RangeFn invoke, const void *ctx, uint32_t itemCount, uint32_t grain)
+    {
+        if (grain == AutoGrain)
+            grain = autoGrain(itemCount);
+
+        // No loop workers, or not worth splitting: run on calling thread.
+        if (m_loopWorkerCount == 0 || itemCount <= grain || !m_running.load(std::memory_order_acquire))
+        {
+            const bool counting = countingMetrics();
+            const uint64_t t0 = counting ? Profiler::nowNs() : 0u;
+            {
+                InsideJobScope scope;
+                invoke(ctx, currentWorkerIndex(), 0u, itemCount);
+            }
+            if (counting)
+            {
+                const uint64_t elapsed = Profiler::nowNs() - t0;
+                ThreadCounters &c = counters();
+                c.busyNs.fetch_add(elapsed, std::memory_order_relaxed);
+                c.ranges.fetch_add(1u, std::memory_order_relaxed);
+                c.items.fetch_add(itemCount, std::memory_order_relaxed);
+                recordLoop(Profiler::currentZoneName(), true, itemCount, itemCount, elapsed);
+            }
+            return;
+        }
+
+        TaskGroup group;
+        group.invoke = invoke;
+        group.ctx = ctx;
+        group.grain = grain;
+        group.zoneName = Profiler::currentZoneName();
+        runGroup(group, itemCount);
+    }
+
+    void JobSystem::recordLoop(const char *name, bool inlined, uint32_t items, uint32_t callerItems, uint64_t wallNs)
+    {
+        std::lock_guard<std::mutex> lock(m_loopMutex);
+        LoopMetrics &m = m_loops[name];
+        m.name = name;
+        ++m.calls;
+        m.inlineCalls += inlined ? 1u : 0u;
+        m.items += items;
+        m.callerItems += callerItems;
+        m.wallNs += wallNs;
+    }
+
+    JobSystem::Metrics JobSystem::takeMetrics()
+    {
+        Metrics out;
+        const uint64_t now = Profiler::nowNs();
+        out.windowNs = now - m_metricsSinceNs.exchange(now, std::memory_order_relaxed);
+
+        out.threads.resize(m_workerCount + 1u);
+        for (uint32_t i = 0; i <= m_workerCount; ++i)
+        {
+            ThreadCounters &c = m_counters[i];
+            ThreadMetrics &t = out.threads[i];
+            t.busyNs = c.busyNs.exchange(0u, std::memory_order_relaxed);
+            t.spinNs = c.spinNs.exchange(0u, std::memory_order_relaxed);
+            t.sleepNs = c.sleepNs.exchange(0u, std::memory_order_relaxed);
+            t.waitNs = c.waitNs.exchange(0u, std::memory_order_relaxed);
+            t.ranges = c.ranges.exchange(0u, std::memory_order_relaxed);
+            t.items = c.items.exchange(0u, std::memory_order_relaxed);
+            t.jobs = c.jobs.exchange(0u, std::memory_order_relaxed);
+            t.steals = c.steals.exchange(0u, std::memory_order_relaxed);
+        }
+
+        std::unordered_map<const char *, LoopMetrics> loops;
+        {
+            std::lock_guard<std::mutex> lock(m_loopMutex);
+            loops.swap(m_loops);
+        }
+        out.loops.reserve(loops.size());
+        for (const auto &kv : loops)
+            out.loops.push_back(kv.second);
+        return out;
+    }
+
+    JobHandle JobSystem::submit(std::function<void()> fn, JobPriority priority)
+    {
+        return addJob(std::move(fn), JobHandle{}, false, priority);
+    }
+
+    JobHandle JobSystem::then(const JobHandle &after, std::function<void()> fn, JobPriority priority)
+    {
+        return addJob(std::move(fn), after, false, priority);
+    }
+
+    JobHandle JobSystem::thenOnMainThread(const JobHandle &after, std::function<void()> fn)
+    {
+        return addJob(std::move(fn), after, true, JobPriority::Normal);
+    }
+
+    JobHandle JobSystem::postToMainThread(std::function<void()> fn)
+    {
+        return addJob(std::move(fn), JobHandle{}, true, JobPriority::Normal);
+    }
+
+    JobHandle JobSystem::addJob(std::function<void()> fn, const JobHandle &after, bool mainThread, JobPriority priority)
+    {
+        auto job = std::make_shared<AsyncJob>();
+        job->fn = std::move(fn);
+        job->mainThread = mainThread;
+        job->priority = priority;
+        job->self = job;
+        m_asyncInFlight.fetch_add(1u, std::memory_order_acq_rel);
+
+        bool ready = true;
+        if (after.m_job)
+        {
+            std::lock_guard<std::mutex> lock(after.m_job->mutex);
+            if (!after.m_job->done.load(std::memory_order_acquire))
+            {
+                after.m_job->continuations.push_back(job);
+                ready = false;
+            }
+        }
+
+        JobHandle h;
+        h.m_job = job;
+        if (ready)
+            schedule(job.get());
+        return h;
+    }
+
+    void JobSystem::schedule(AsyncJob *job)
+    {
+        if (job->mainThread)
+        {
+            if (m_stopping.load(std::memory_order_acquire))
+            {
+                job->fn = nullptr;
+                completeJob(job);
+                return;
+            }
+            std::lock_guard<std::mutex> lock(m_mainMutex);
+            m_mainJobs.push_back(job);
+            return;
+        }
 
         // No workers: run on calling thread.
         if (m_workerCount == 0 || !m_running.load(std::memory_order_acquire))
         {
-            for (uint32_t i = 0; i < itemCount; ++i)
-                fn(0, i);
+            runJob(job);
             return;
         }
 
+        const uint32_t p = static_cast<uint32_t>(job->priority);
         {
-            std::lock_guard<std::mutex> lock(m_mutex);
-            m_jobFn = fn;
-            m_itemCount = itemCount;
-            m_nextIndex.store(0, std::memory_order_release);
-            m_activeWorkers = m_workerCount;
-            ++m_jobId;
+            std::lock_guard<std::mutex> lock(m_asyncMutex);
+            m_asyncJobs[p].push_back(job);
+            m_asyncQueued[p].fetch_add(1u, std::memory_order_seq_cst);
         }
+        wakeForJob(job->priority);
+    }
 
-        // Wake workers.
-        m_cvStart.notify_all();
+    bool JobSystem::popAsync(AsyncJob *&out)
+    {
+        // Loop workers leave Background jobs to the background workers when there are any;
+        // background workers serve Background first and never take High.
+        static constexpr JobPriority ANY[] = {JobPriority::High, JobPriority::Normal, JobPriority::Background};
+        static constexpr JobPriority LOOP[] = {JobPriority::High, JobPriority::Normal};
+        static constexpr JobPriority BACKGROUND[] = {JobPriority::Background, JobPriority::Normal};
 
-        // The calling thread participates as "workerIndex = m_workerCount".
-        while (true)
+        const uint32_t self = currentWorkerIndex();
+        const JobPriority *order = ANY;
+        uint32_t count = 3u;
+        if (isBackgroundWorker(self))
         {
-            const uint32_t idx = m_nextIndex.fetch_add(1, std::memory_order_acq_rel);
-            if (idx >= itemCount)
-                break;
-            fn(m_workerCount, idx);
+            order = BACKGROUND;
+            count = 2u;
         }
+        else if (self < m_loopWorkerCount && m_workerCount > m_loopWorkerCount)
+        {
+            order = LOOP;
+            count = 2u;
+        }
+
+        bool any = false;
+        for (uint32_t i = 0; i < count; ++i)
+            any = any || m_asyncQueued[static_cast<uint32_t>(order[i])].load(std::memory_order_acquire) > 0u;
+        if (!any)
+            return false;
 
-        // Wait for workers to finish.
-        std::unique_lock<std::mutex> lock(m_mutex);
-        m_cvDone.wait(lock, [this]()
-                      { return m_activeWorkers == 0; });
-        m_jobFn = nullptr;
-        m_itemCount = 0;
+        std::lock_guard<std::mutex> lock(m_asyncMutex);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const uint32_t p = static_cast<uint32_t>(order[i]);
+            if (m_asyncJobs[p].empty())
+                continue;
+            out = m_asyncJobs[p].front();
+            m_asyncJobs[p].pop_front();
+            m_asyncQueued[p].fetch_sub(1u, std::memory_order_acq_rel);
+            return true;
+        }
+        return false;
     }
 
-    void JobSystem::workerMain(uint32_t workerIndex)
+    bool JobSystem::popAwaited(const AsyncJob *awaited, AsyncJob *&out)
+    {
+        const uint32_t high = static_cast<uint32_t>(JobPriority::High);
+        const uint32_t own = static_cast<uint32_t>(awaited->priority);
+        if (m_asyncQueued[own].load(std::memory_order_acquire) == 0u &&
+            m_asyncQueued[high].load(std::memory_order_acquire) == 0u)
+            return false;
+
+        std::lock_guard<std::mutex> lock(m_asyncMutex);
+        std::deque<AsyncJob *> &queue = m_asyncJobs[own];
+        auto it = std::find(queue.begin(), queue.end(), awaited);
+        uint32_t p = own;
+        if (it == queue.end())
+        {
+            if (m_asyncJobs[high].empty())
+                return false;
+            it = m_asyncJobs[high].begin();
+            p = high;
+        }
+        out = *it;
+        m_asyncJobs[p].erase(it);
+        m_asyncQueued[p].fetch_sub(1u, std::memory_order_acq_rel);
+        return true;
+    }
+
+    bool JobSystem::asyncReadyFor(bool backgroundWorker) const
+    {
+        auto queued = [this](JobPriority p)
+        { return m_asyncQueued[static_cast<uint32_t>(p)].load(std::memory_order_seq_cst); };
+        if (backgroundWorker)
+            return queued(JobPriority::Normal) + queued(JobPriority::Background) > 0u;
+        const bool takesBackground = m_workerCount == m_loopWorkerCount;
+        return queued(JobPriority::High) + queued(JobPriority::Normal) +
+                   (takesBackground ? queued(JobPriority::Background) : 0u) >
+               0u;
+    }
+
+    void JobSystem::runJob(AsyncJob *job)
     {
-        uint64_t seenJobId = 0;
-        while (true)
+        if (job->fn)
         {
-            JobFn fn;
-            uint32_t count = 0;
+            const bool counting = countingMetrics();
+            const uint64_t t0 = counting ? Profiler::nowNs() : 0u;
             {
-                std::unique_lock<std::mutex> lock(m_mutex);
-                m_cvStart.wait(lock, [this, &seenJobId]()
-                               { return !m_running.load(std::memory_order_acquire) || m_jobId != seenJobId; });
+                ENGINE_PROFILE_ZONE("JobSystem::job");
+                job->fn();
+            }
+            if (counting)
+            {
+                ThreadCounters &c = counters();
+                c.busyNs.fetch_add(Profiler::nowNs() - t0, std::memory_order_relaxed);
+                c.jobs.fetch_add(1u, std::memory_order_relaxed);
+            }
+        }
+        completeJob(job);
+    }
+
+    void JobSystem::completeJob(AsyncJob *job)
+    {
+        std::vector<std::shared_ptr<AsyncJob>> next;
+        {
+            std::lock_guard<std::mutex> lock(job->mutex);
+            job->done.store(true, std::memory_order_release);
+            next.swap(job->continuations);
+        }
+
+        // Release captures now rather than when the last handle goes away.
+        job->fn = nullptr;
+
+        for (auto &c : next)
+            schedule(c.get());
 
-                if (!m_running.load(std::memory_order_acquire))
+        // May destroy the job (if no handle is left).
+        std::shared_ptr<AsyncJob> keepAlive = std::move(job->self);
+        m_asyncInFlight.fetch_sub(1u, std::memory_order_acq_rel);
+    }
+
+    uint32_t JobSystem::runMainThreadJobs(uint32_t maxJobs)
+    {
+        uint32_t ran = 0;
+        while (ran < maxJobs)
+        {
+            AsyncJob *job = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(m_mainMutex);
+                if (m_mainJobs.empty())
                     break;
+                job = m_mainJobs.front();
+                m_mainJobs.pop_front();
+            }
 
-                seenJobId = m_jobId;
+            runJob(job);
+            ++ran;
+        }
+        return ran;
+    }
 
-                fn = m_jobFn;
-                count = m_itemCount;
+    void JobSystem::wait(const JobHandle &job)
+    {
+        // A worker waiting inside a job may take whatever its queues allow; any other thread
+        // only takes what this wait depends on (see popAwaited()).
+        const uint32_t self = currentWorkerIndex();
+        const bool worker = self < m_workerCount;
+        uint64_t idleSince = 0;
+        while (!job.isDone())
+        {
+            Task t;
+            AsyncJob *next = nullptr;
+            if (m_workerCount > 0 && findTask(t))
+                execute(t, self);
+            else if (worker ? popAsync(next) : (job.m_job && popAwaited(job.m_job.get(), next)))
+                runJob(next);
+            else
+            {
+                if (idleSince == 0 && countingMetrics())
+                    idleSince = Profiler::nowNs();
+                std::this_thread::yield();
+                continue;
             }
+            if (idleSince != 0)
+            {
+                counters().waitNs.fetch_add(Profiler::nowNs() - idleSince, std::memory_order_relaxed);
+                idleSince = 0;
+            }
+        }
+        if (idleSince != 0)
+            counters().waitNs.fetch_add(Profiler::nowNs() - idleSince, std::memory_order_relaxed);
+    }
+
+    void JobSystem::runGroup(TaskGroup &group, uint32_t itemCount)
+    {
+        group.remaining.store(itemCount, std::memory_order_release);
+
+        const bool counting = countingMetrics();
+        const uint64_t start = counting ? Profiler::nowNs() : 0u;
+        const uint32_t self = currentWorkerIndex();
+        uint32_t callerItems = execute(Task{&group, 0u, itemCount}, self);
 
-            // Execute until exhausted.
-            while (true)
+        // Help until every item of this loop has finished. Tasks from other loops may be
+        // executed meanwhile; that is what makes nested and concurrent loops progress.
+        uint64_t idleSince = 0;
+        while (group.remaining.load(std::memory_order_acquire) > 0u)
+        {
+            Task t;
+            if (findTask(t))
             {
-                const uint32_t idx = m_nextIndex.fetch_add(1, std::memory_order_acq_rel);
-                if (idx >= count)
-                    break;
-                if (fn)
-                    fn(workerIndex, idx);
+                if (idleSince != 0)
+                {
+                    counters().waitNs.fetch_add(Profiler::nowNs() - idleSince, std::memory_order_relaxed);
+                    idleSince = 0;
+                }
+                const uint32_t ran = execute(t, self);
+                if (t.group == &group)
+                    callerItems += ran;
+            }
+            else
+            {
+                if (idleSince == 0 && counting)
+                    idleSince = Profiler::nowNs();
+                std::this_thread::yield();
+            }
+        }
+
+        if (counting)
+        {
+            const uint64_t end = Profiler::nowNs();
+            if (idleSince != 0)
+                counters().waitNs.fetch_add(end - idleSince, std::memory_order_relaxed);
+            recordLoop(group.zoneName, false, itemCount, callerItems, end - start);
+        }
+    }
+
+    uint32_t JobSystem::execute(const Task &task, uint32_t workerIndex)
+    {
+        TaskGroup &group = *task.group;
+        const uint32_t begin = task.begin;
+        uint32_t end = task.end;
+
+        // Lazy binary splitting: publish the upper half for thieves, keep the lower half.
+        while (end - begin > group.grain)
+        {
+            const uint32_t mid = begin + (end - begin) / 2u;
+            push(Task{&group, mid, end});
+            end = mid;
+        }
+
+        const bool counting = countingMetrics();
+        const uint64_t t0 = counting ? Profiler::nowNs() : 0u;
+        {
+            ENGINE_PROFILE_ZONE(group.zoneName ? group.zoneName : "JobSystem::range");
+            InsideJobScope scope;
+            group.invoke(group.ctx, workerIndex, begin, end);
+        }
+        if (counting)
+        {
+            ThreadCounters &c = m_counters[workerIndex];
+            c.busyNs.fetch_add(Profiler::nowNs() - t0, std::memory_order_relaxed);
+            c.ranges.fetch_add(1u, std::memory_order_relaxed);
+            c.items.fetch_add(end - begin, std::memory_order_relaxed);
+        }
+
+        // Last access to 'group': the owner may return (and destroy it) once this reaches 0.
+        const uint32_t ran = end - begin;
+        group.remaining.fetch_sub(ran, std::memory_order_acq_rel);
+        return ran;
+    }
+
+    void JobSystem::push(const Task &task)
+    {
+        WorkQueue &q = *m_queues[currentWorkerIndex()];
+        {
+            std::lock_guard<std::mutex> lock(q.mutex);
+            q.tasks.push_back(task);
+            m_queuedTasks.fetch_add(1u, std::memory_order_seq_cst);
+        }
+
+        wakeOne();
+    }
+
+    void JobSystem::wakeOne()
+    {
+        if (m_sleepers.load(std::memory_order_seq_cst) > 0u)
+        {
+            // Taking the sleep mutex orders this notify after a sleeper's predicate check.
+            {
+                std::lock_guard<std::mutex> lock(m_sleepMutex);
             }
+            m_cvWork.notify_one();
+        }
+    }
 
-            // Signal done.
+    void JobSystem::wakeForJob(JobPriority priority)
+    {
+        const bool haveBackground = m_workerCount > m_loopWorkerCount;
+        const bool backgroundAsleep = m_backgroundSleepers.load(std::memory_order_seq_cst) > 0u;
+        const bool loopAsleep = m_sleepers.load(std::memory_order_seq_cst) > 0u;
+        bool toBackground = false;
+        if (priority == JobPriority::Background)
+            toBackground = haveBackground;
+        else if (priority == JobPriority::Normal)
+            toBackground = !loopAsleep && backgroundAsleep;
+        if (!toBackground)
+        {
+            wakeOne();
+            return;
+        }
+        if (backgroundAsleep)
+        {
             {
-                std::lock_guard<std::mutex> lock(m_mutex);
-                if (m_activeWorkers > 0)
-                    --m_activeWorkers;
-                if (m_activeWorkers == 0)
-                    m_cvDone.notify_one();
+                std::lock_guard<std::mutex> lock(m_sleepMutex);
             }
+            m_cvBackground.notify_one();
         }
+    }
+
+    bool JobSystem::popLocal(uint32_t queueIndex, Task &out)
+    {
+        WorkQueue &q = *m_queues[queueIndex];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.tasks.size() <= q.head)
+            return false;
+
+        out = q.tasks.back();
+        q.tasks.pop_back();
+        if (q.head >= q.tasks.size())
+        {
+            q.tasks.clear();
+            q.head = 0;
+        }
+        m_queuedTasks.fetch_sub(1u, std::memory_order_acq_rel);
+        return true;
+    }
 
-        // Thread exits.
+    bool JobSystem::steal(uint32_t thiefQueue, Task &out)
+    {
+        const uint32_t queueCount = static_cast<uint32_t>(m_queues.size());
+        for (uint32_t n = 1; n <= queueCount; ++n)
         {
-            std::lock_guard<std::mutex> lock(m_mutex);
-            if (m_activeWorkers > 0)
-                --m_activeWorkers;
-            if (m_activeWorkers == 0)
-                m_cvDone.notify_one();
+            const uint32_t victim = (thiefQueue + n) % queueCount;
+            WorkQueue &q = *m_queues[victim];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (q.tasks.size() <= q.head)
+                continue;
+
+            // Oldest task = largest remaining range of that queue.
+            out = q.tasks[q.head++];
+            if (victim != thiefQueue && countingMetrics())
+                m_counters[thiefQueue].steals.fetch_add(1u, std::memory_order_relaxed);
+            if (q.head >= q.tasks.size())
+            {
+                q.tasks.clear();
+                q.head = 0;
+            }
+            m_queuedTasks.fetch_sub(1u, std::memory_order_acq_rel);
+            return true;
         }
+        return false;
+    }
+
+    bool JobSystem::findTask(Task &out)
+    {
+        if (m_queuedTasks.load(std::memory_order_acquire) == 0u)
+            return false;
+
+        const uint32_t self = currentWorkerIndex();
+        if (popLocal(self, out))
+            return true;
+        return steal(self, out);
+    }
+
+    void JobSystem::workerMain(uint32_t workerIndex)
+    {
+        t_owner = this;
+        t_workerIndex = workerIndex;
+
+        const bool background = isBackgroundWorker(workerIndex);
+
+        // Exports keep the pointer, so names live as long as the process.
+        static char s_names[Profiler::MAX_THREADS][16];
+        if (workerIndex < Profiler::MAX_THREADS)
+        {
+            std::snprintf(s_names[workerIndex], sizeof(s_names[workerIndex]), background ? "Background %u" : "Worker %u",
+                          workerIndex);
+            Profiler::setThreadName(s_names[workerIndex]);
+        }
+
+        ThreadCounters &counters = m_counters[workerIndex];
+        uint32_t idleSpins = 0;
+        uint64_t idleSince = 0; // start of the current spin phase (0 = busy or not counting)
+        auto endSpin = [&]()
+        {
+            if (idleSince != 0)
+            {
+                counters.spinNs.fetch_add(Profiler::nowNs() - idleSince, std::memory_order_relaxed);
+                idleSince = 0;
+            }
+        };
+
+        while (m_running.load(std::memory_order_acquire))
+        {
+            Task t;
+            if (!background && findTask(t))
+            {
+                endSpin();
+                execute(t, workerIndex);
+                idleSpins = 0;
+                continue;
+            }
+
+            // Background jobs only when there is no loop work to help with.
+            AsyncJob *job = nullptr;
+            if (popAsync(job))
+            {
+                endSpin();
+                runJob(job);
+                idleSpins = 0;
+                continue;
+            }
+
+            if (++idleSpins < IDLE_SPINS_BEFORE_SLEEP)
+            {
+                if (idleSince == 0 && countingMetrics())
+                    idleSince = Profiler::nowNs();
+                std::this_thread::yield();
+                continue;
+            }
+            idleSpins = 0;
+            endSpin();
+
+            const uint64_t sleepStart = countingMetrics() ? Profiler::nowNs() : 0u;
+            {
+                std::unique_lock<std::mutex> lock(m_sleepMutex);
+                std::atomic<uint32_t> &sleepers = background ? m_backgroundSleepers : m_sleepers;
+                sleepers.fetch_add(1u, std::memory_order_seq_cst);
+                (background ? m_cvBackground : m_cvWork).wait(lock, [this, background]()
+                                                              { return !m_running.load(std::memory_order_seq_cst) ||
+                                                                       (!background && m_queuedTasks.load(std::memory_order_seq_cst) > 0u) ||
+                                                                       asyncReadyFor(background); });
+                sleepers.fetch_sub(1u, std::memory_order_seq_cst);
+            }
+            if (sleepStart != 0)
+                counters.sleepNs.fetch_add(Profiler::nowNs() - sleepStart, std::memory_order_relaxed);
+        }
+        endSpin();
+
+        t_owner = nullptr;
     }
 }
@@ -1,8 +1,24 @@
 #include "assets/MeshAsset.h"
 #include <cstring>
+#include <vector>
 
 namespace Engine
 {
+    namespace
+    {
+        // Base indices plus every LOD level; false if a level has no data.
+        bool TotalIndexCount(const MeshDataView &m, uint64_t &outCount)
+        {
+            outCount = m.indexCount;
+            for (uint32_t l = 0; l < m.lodCount; ++l)
+            {
+                if (!m.lods || !m.lods[l].indices || m.lods[l].indexCount == 0)
+                    return false;
+                outCount += m.lods[l].indexCount;
+            }
+            return true;
+        }
+    } // namespace
 
     bool MeshAsset::upload(VkDevice device,
                            VkPhysicalDevice phys,
@@ -10,111 +26,291 @@ namespace Engine
                            VkQueue queue,
                            const MeshData &data)
     {
-        // 1) Vertex: create host-visible staging buffer and fill it
-        VertexBufferHandle stagingVB{};
-        VkResult rv = CreateOrUpdateVertexBuffer(
-            device, phys,
-            data.vertexBytes.data(),
-            static_cast<VkDeviceSize>(data.vertexBytes.size()),
-            stagingVB);
+        return upload(device, phys, commandPool, queue, makeMeshDataView(data));
+    }
+
+    bool MeshAsset::upload(VkDevice device,
+                           VkPhysicalDevice phys,
+                           VkCommandPool commandPool,
+                           VkQueue queue,
+                           const MeshDataView &data)
+    {
+        UploadContext ctx{};
+        if (!BeginUploadContext(ctx, device, phys, commandPool, queue))
+            return false;
+
+        if (!uploadDeferred(ctx, data))
+        {
+            EndSubmitAndWait(ctx);
+            destroy(device);
+            return false;
+        }
+
+        if (!EndSubmitAndWait(ctx))
+        {
+            destroy(device);
+            return false;
+        }
+        return true;
+    }
+
+    bool MeshAsset::uploadDeferred(UploadContext &ctx, const MeshDataView &data)
+    {
+        if (!ctx.begun || !data.vertexBytes || data.vertexByteSize == 0 || !data.indices || data.indexCount == 0)
+            return false;
+
+        uint64_t totalIndices = 0;
+        if (!TotalIndexCount(data, totalIndices) || totalIndices > uint64_t(UINT32_MAX))
+            return false;
+
+        const VkDeviceSize vertexBytes = static_cast<VkDeviceSize>(data.vertexByteSize);
+        const VkDeviceSize indexSize = (data.indexFormat == 1) ? sizeof(uint32_t) : sizeof(uint16_t);
+        const VkDeviceSize indexBytes = static_cast<VkDeviceSize>(totalIndices) * indexSize;
+
+        // 1) Device-local destinations
+        VkResult rv = CreateDeviceLocalBuffer(
+            ctx.device, ctx.physicalDevice,
+            vertexBytes,
+            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            m_vb.buffer, m_vb.memory);
         if (rv != VK_SUCCESS)
             return false;
 
-        // 2) Vertex: create device-local destination and copy
-        VkBuffer dstVBuffer = VK_NULL_HANDLE;
-        VkDeviceMemory dstVMemory = VK_NULL_HANDLE;
         rv = CreateDeviceLocalBuffer(
-            device, phys,
-            static_cast<VkDeviceSize>(data.vertexBytes.size()),
-            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-            dstVBuffer, dstVMemory);
+            ctx.device, ctx.physicalDevice,
+            indexBytes,
+            VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            m_ib.buffer, m_ib.memory);
         if (rv != VK_SUCCESS)
         {
-            DestroyVertexBuffer(device, stagingVB);
+            DestroyVertexBuffer(ctx.device, m_vb);
             return false;
         }
-        rv = CopyBuffer(device, commandPool, queue,
-                        stagingVB.buffer, dstVBuffer,
-                        static_cast<VkDeviceSize>(data.vertexBytes.size()));
-        // Free staging after copy
-        DestroyVertexBuffer(device, stagingVB);
-        if (rv != VK_SUCCESS)
+
+        // 2) Stage bytes (ring or dedicated buffer, freed by the context) and record the copies
+        VkBuffer src = VK_NULL_HANDLE;
+        VkDeviceSize srcOffset = 0;
+        if (!StageBytes(ctx, data.vertexBytes, vertexBytes, src, srcOffset))
         {
-            vkDestroyBuffer(device, dstVBuffer, nullptr);
-            vkFreeMemory(device, dstVMemory, nullptr);
+            destroy(ctx.device);
             return false;
         }
-        // Store device-local vertex buffer
-        m_vb.buffer = dstVBuffer;
-        m_vb.memory = dstVMemory;
-
-        // 3) Index: create host-visible staging buffer and fill it
-        IndexBufferHandle stagingIB{};
-        VkDeviceSize indexBytes = 0;
-        if (data.indexFormat == 1)
-        {
-            indexBytes = static_cast<VkDeviceSize>(data.indices32.size() * sizeof(uint32_t));
-            rv = CreateOrUpdateIndexBuffer(
-                device, phys,
-                data.indices32.data(),
-                indexBytes,
-                stagingIB);
-            m_indexType = VK_INDEX_TYPE_UINT32;
-            m_indexCount = data.indexCount;
+        CmdCopyBuffer(ctx, src, srcOffset, m_vb.buffer, vertexBytes);
+
+        // Base indices first, then each LOD level back to back.
+        m_lods.clear();
+        uint32_t indexCursor = 0;
+        for (uint32_t l = 0; l <= data.lodCount; ++l)
+        {
+            const void *indices = (l == 0) ? data.indices : data.lods[l - 1].indices;
+            const uint32_t count = (l == 0) ? data.indexCount : data.lods[l - 1].indexCount;
+            const VkDeviceSize bytes = VkDeviceSize(count) * indexSize;
+            if (!StageBytes(ctx, indices, bytes, src, srcOffset))
+            {
+                destroy(ctx.device);
+                return false;
+            }
+            CmdCopyBuffer(ctx, src, srcOffset, m_ib.buffer, bytes, VkDeviceSize(indexCursor) * indexSize);
+            if (l > 0)
+                m_lods.push_back({indexCursor, count, data.lods[l - 1].screenSize});
+            indexCursor += count;
         }
-        else
-        {
-            indexBytes = static_cast<VkDeviceSize>(data.indices16.size() * sizeof(uint16_t));
-            rv = CreateOrUpdateIndexBuffer(
-                device, phys,
-                data.indices16.data(),
-                indexBytes,
-                stagingIB);
-            m_indexType = VK_INDEX_TYPE_UINT16;
-            m_indexCount = data.indexCount;
+
+        // 3) Make the copies visible to vertex input in later submissions
+        VkBufferMemoryBarrier barriers[2]{};
+        for (VkBufferMemoryBarrier &b : barriers)
+        {
+            b.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            b.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            b.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            b.offset = 0;
+            b.size = VK_WHOLE_SIZE;
         }
-        if (rv != VK_SUCCESS)
+        barriers[0].dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+        barriers[0].buffer = m_vb.buffer;
+        barriers[1].dstAccessMask = VK_ACCESS_INDEX_READ_BIT;
+        barriers[1].buffer = m_ib.buffer;
+        vkCmdPipelineBarrier(ctx.cmd,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                             0, 0, nullptr, 2, barriers, 0, nullptr);
+
+        // 4) Store metadata and copy AABB
+        m_indexType = (data.indexFormat == 1) ? VK_INDEX_TYPE_UINT32 : VK_INDEX_TYPE_UINT16;
+        m_indexCount = data.indexCount;
+        m_vertexStride = data.vertexStride;
+        std::memcpy(m_aabbMin, data.aabbMin, sizeof(m_aabbMin));
+        std::memcpy(m_aabbMax, data.aabbMax, sizeof(m_aabbMax));
+
+        return true;
+    }
+
+    bool MeshAsset::uploadMergedDeferred(UploadContext &ctx, const MeshDataView *meshes, uint32_t count, MeshAsset *const *outMeshes)
+    {
+        if (!ctx.begun || !meshes || !outMeshes || count == 0)
+            return false;
+
+        // 1) Layout: vertices back to back (stride-aligned), indices back to back
+        const uint32_t stride = meshes[0].vertexStride;
+        bool wide = false;
+        uint64_t totalVertexBytes = 0;
+        uint64_t totalIndices = 0;
+        for (uint32_t i = 0; i < count; ++i)
         {
-            // Clean up vertex device-local resources
-            DestroyVertexBuffer(device, m_vb);
+            const MeshDataView &m = meshes[i];
+            if (!m.vertexBytes || m.vertexByteSize == 0 || !m.indices || m.indexCount == 0 || m.vertexStride != stride || stride == 0)
+                return false;
+            uint64_t meshIndices = 0;
+            if (!TotalIndexCount(m, meshIndices))
+                return false;
+            wide = wide || (m.indexFormat == 1);
+            totalVertexBytes += m.vertexByteSize;
+            totalIndices += meshIndices;
+        }
+        if (totalVertexBytes / stride > uint64_t(INT32_MAX) || totalIndices > uint64_t(UINT32_MAX))
             return false;
+
+        const VkDeviceSize indexSize = wide ? sizeof(uint32_t) : sizeof(uint16_t);
+
+        // Sources already laid out like the shared buffers (GltfToSmodel writes merged streams):
+        // one staging copy per buffer instead of one per mesh and LOD level.
+        bool vertexRun = true;
+        bool indexRun = true;
+        const uint8_t *nextVertex = meshes[0].vertexBytes;
+        const uint8_t *nextIndex = static_cast<const uint8_t *>(meshes[0].indices);
+        for (uint32_t i = 0; i < count && (vertexRun || indexRun); ++i)
+        {
+            const MeshDataView &m = meshes[i];
+            vertexRun = vertexRun && m.vertexBytes == nextVertex;
+            nextVertex = m.vertexBytes + m.vertexByteSize;
+            indexRun = indexRun && (m.indexFormat == 1) == wide;
+            for (uint32_t l = 0; indexRun && l <= m.lodCount; ++l)
+            {
+                const uint8_t *indices = static_cast<const uint8_t *>((l == 0) ? m.indices : m.lods[l - 1].indices);
+                const uint32_t levelCount = (l == 0) ? m.indexCount : m.lods[l - 1].indexCount;
+                indexRun = indices == nextIndex;
+                nextIndex = indices + VkDeviceSize(levelCount) * indexSize;
+            }
         }
 
-        // 4) Index: create device-local destination and copy
-        VkBuffer dstIBuffer = VK_NULL_HANDLE;
-        VkDeviceMemory dstIMemory = VK_NULL_HANDLE;
+        // Storage usage too: the meshlet path (SModelRenderPassModule) fetches vertices in
+        // mesh shaders straight from the shared buffer.
+        auto shared = std::make_shared<SharedBuffers>();
+        VkResult rv = CreateDeviceLocalBuffer(
+            ctx.device, ctx.physicalDevice,
+            totalVertexBytes,
+            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            shared->vb.buffer, shared->vb.memory);
+        if (rv != VK_SUCCESS)
+            return false;
+
         rv = CreateDeviceLocalBuffer(
-            device, phys,
-            indexBytes,
+            ctx.device, ctx.physicalDevice,
+            totalIndices * indexSize,
             VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-            dstIBuffer, dstIMemory);
+            shared->ib.buffer, shared->ib.memory);
         if (rv != VK_SUCCESS)
         {
-            DestroyIndexBuffer(device, stagingIB);
-            DestroyVertexBuffer(device, m_vb);
+            DestroyVertexBuffer(ctx.device, shared->vb);
             return false;
         }
-        rv = CopyBuffer(device, commandPool, queue,
-                        stagingIB.buffer, dstIBuffer,
-                        indexBytes);
-        // Free staging after copy
-        DestroyIndexBuffer(device, stagingIB);
-        if (rv != VK_SUCCESS)
+
+        auto fail = [&]()
         {
-            vkDestroyBuffer(device, dstIBuffer, nullptr);
-            vkFreeMemory(device, dstIMemory, nullptr);
-            DestroyVertexBuffer(device, m_vb);
+            DestroyVertexBuffer(ctx.device, shared->vb);
+            DestroyIndexBuffer(ctx.device, shared->ib);
             return false;
+        };
+
+        // 2) Stage + copy each mesh into its range (or each run in one go)
+        VkBuffer src = VK_NULL_HANDLE;
+        VkDeviceSize srcOffset = 0;
+        if (vertexRun)
+        {
+            if (!StageBytes(ctx, meshes[0].vertexBytes, totalVertexBytes, src, srcOffset))
+                return fail();
+            CmdCopyBuffer(ctx, src, srcOffset, shared->vb.buffer, totalVertexBytes, 0);
+        }
+        if (indexRun)
+        {
+            if (!StageBytes(ctx, meshes[0].indices, totalIndices * indexSize, src, srcOffset))
+                return fail();
+            CmdCopyBuffer(ctx, src, srcOffset, shared->ib.buffer, totalIndices * indexSize, 0);
         }
-        // Store device-local index buffer
-        m_ib.buffer = dstIBuffer;
-        m_ib.memory = dstIMemory;
 
-        // 5) Store vertex stride and copy AABB
-        m_vertexStride = data.vertexStride;
-        std::memcpy(m_aabbMin, data.aabbMin, sizeof(m_aabbMin));
-        std::memcpy(m_aabbMax, data.aabbMax, sizeof(m_aabbMax));
+        std::vector<uint32_t> widened;
+        VkDeviceSize vertexCursor = 0;
+        uint32_t indexCursor = 0;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const MeshDataView &m = meshes[i];
+
+            if (!vertexRun)
+            {
+                if (!StageBytes(ctx, m.vertexBytes, m.vertexByteSize, src, srcOffset))
+                    return fail();
+                CmdCopyBuffer(ctx, src, srcOffset, shared->vb.buffer, m.vertexByteSize, vertexCursor);
+            }
 
+            MeshAsset &out = *outMeshes[i];
+            out.destroy(ctx.device);
+
+            // Base indices, then this mesh's LOD levels right behind them.
+            const uint32_t meshFirstIndex = indexCursor;
+            for (uint32_t l = 0; l <= m.lodCount; ++l)
+            {
+                const void *indices = (l == 0) ? m.indices : m.lods[l - 1].indices;
+                const uint32_t levelCount = (l == 0) ? m.indexCount : m.lods[l - 1].indexCount;
+                const void *indexSrc = indices;
+                if (wide && m.indexFormat != 1)
+                {
+                    const uint16_t *narrow = static_cast<const uint16_t *>(indices);
+                    widened.assign(narrow, narrow + levelCount);
+                    indexSrc = widened.data();
+                }
+                const VkDeviceSize indexBytes = VkDeviceSize(levelCount) * indexSize;
+                if (!indexRun)
+                {
+                    if (!StageBytes(ctx, indexSrc, indexBytes, src, srcOffset))
+                        return fail();
+                    CmdCopyBuffer(ctx, src, srcOffset, shared->ib.buffer, indexBytes, VkDeviceSize(indexCursor) * indexSize);
+                }
+                if (l > 0)
+                    out.m_lods.push_back({indexCursor, levelCount, m.lods[l - 1].screenSize});
+                indexCursor += levelCount;
+            }
+
+            out.m_shared = shared;
+            out.m_firstIndex = meshFirstIndex;
+            out.m_vertexOffset = static_cast<int32_t>(vertexCursor / stride);
+            out.m_indexType = wide ? VK_INDEX_TYPE_UINT32 : VK_INDEX_TYPE_UINT16;
+            out.m_indexCount = m.indexCount;
+            out.m_vertexStride = stride;
+            std::memcpy(out.m_aabbMin, m.aabbMin, sizeof(out.m_aabbMin));
+            std::memcpy(out.m_aabbMax, m.aabbMax, sizeof(out.m_aabbMax));
+
+            vertexCursor += m.vertexByteSize;
+        }
+
+        // 3) Make the copies visible to vertex input in later submissions
+        VkBufferMemoryBarrier barriers[2]{};
+        for (VkBufferMemoryBarrier &b : barriers)
+        {
+            b.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            b.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            b.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            b.offset = 0;
+            b.size = VK_WHOLE_SIZE;
+        }
+        // (and to mesh shader reads: ALL_COMMANDS, the mesh stage bits need the extension)
+        barriers[0].dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+        barriers[0].buffer = shared->vb.buffer;
+        barriers[1].dstAccessMask = VK_ACCESS_INDEX_READ_BIT;
+        barriers[1].buffer = shared->ib.buffer;
+        vkCmdPipelineBarrier(ctx.cmd,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                             0, 0, nullptr, 2, barriers, 0, nullptr);
         return true;
     }
 
@@ -122,7 +318,20 @@ namespace Engine
     {
         DestroyVertexBuffer(device, m_vb);
         DestroyIndexBuffer(device, m_ib);
+        if (m_shared)
+        {
+            // Last mesh of a merged set frees the shared buffers.
+            if (m_shared.use_count() == 1)
+            {
+                DestroyVertexBuffer(device, m_shared->vb);
+                DestroyIndexBuffer(device, m_shared->ib);
+            }
+            m_shared.reset();
+        }
+        m_firstIndex = 0;
+        m_vertexOffset = 0;
         m_indexCount = 0;
+        m_lods.clear();
     }
 
-} // namespace Engine
\ No newline at end of file
+} // namespace Engine
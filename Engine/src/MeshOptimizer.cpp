@@ -0,0 +1,463 @@
+#include "assets/MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Engine
+{
+    namespace
+    {
+        // =====================
+        // TUNING CONSTANTS
+        // =====================
+        // Forsyth's published values; the simulated cache is larger than any real one so the
+        // order degrades gracefully on smaller hardware caches.
+        constexpr int CACHE_SIZE = 32;
+        constexpr float CACHE_DECAY_POWER = 1.5f;
+        constexpr float LAST_TRI_SCORE = 0.75f;
+        constexpr float VALENCE_BOOST_SCALE = 2.0f;
+        constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+        // FIFO size used to find the overdraw pass's cluster boundaries (conservative: smaller
+        // than real caches, so a boundary there is a restart on any GPU).
+        constexpr uint32_t OVERDRAW_FIFO_SIZE = 16;
+
+        float vertexScore(int cachePos, uint32_t remaining)
+        {
+            if (remaining == 0)
+                return -1.0f; // no triangles left: never pulls anything in
+
+            float score = 0.0f;
+            if (cachePos >= 0)
+            {
+                // The last triangle's vertices get a fixed score so the strip does not just
+                // continue from its newest edge.
+                if (cachePos < 3)
+                    score = LAST_TRI_SCORE;
+                else
+                    score = std::pow(1.0f - static_cast<float>(cachePos - 3) / static_cast<float>(CACHE_SIZE - 3),
+                                     CACHE_DECAY_POWER);
+            }
+            // Finish vertices with few triangles left (avoids stranding lone triangles).
+            return score + VALENCE_BOOST_SCALE * std::pow(static_cast<float>(remaining), -VALENCE_BOOST_POWER);
+        }
+
+        void readPosition(const uint8_t *vertices, size_t stride, uint32_t v, float out[3])
+        {
+            std::memcpy(out, vertices + size_t(v) * stride, sizeof(float) * 3);
+        }
+
+        bool indicesInRange(const uint32_t *indices, size_t indexCount, size_t vertexCount)
+        {
+            for (size_t i = 0; i < indexCount; ++i)
+            {
+                if (indices[i] >= vertexCount)
+                    return false;
+            }
+            return true;
+        }
+    }
+
+    void OptimizeVertexCache(uint32_t *indices, size_t indexCount, size_t vertexCount)
+    {
+        const size_t triCount = indexCount / 3;
+        if (triCount < 2 || vertexCount == 0 || !indicesInRange(indices, triCount * 3, vertexCount))
+            return;
+
+        // Vertex -> triangle adjacency (CSR); the live part of a vertex's list is its first
+        // remaining[v] entries.
+        std::vector<uint32_t> remaining(vertexCount, 0);
+        for (size_t i = 0; i < triCount * 3; ++i)
+            ++remaining[indices[i]];
+        std::vector<uint32_t> offsets(vertexCount + 1, 0);
+        for (size_t v = 0; v < vertexCount; ++v)
+            offsets[v + 1] = offsets[v] + remaining[v];
+        std::vector<uint32_t> adjacency(triCount * 3);
+        {
+            std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+            for (size_t t = 0; t < triCount; ++t)
+            {
+                for (int k = 0; k < 3; ++k)
+                    adjacency[cursor[indices[t * 3 + k]]++] = static_cast<uint32_t>(t);
+            }
+        }
+
+        std::vector<int> cachePos(vertexCount, -1);
+        std::vector<float> vScore(vertexCount);
+        for (size_t v = 0; v < vertexCount; ++v)
+            vScore[v] = vertexScore(-1, remaining[v]);
+
+        std::vector<float> tScore(triCount);
+        for (size_t t = 0; t < triCount; ++t)
+            tScore[t] = vScore[indices[t * 3]] + vScore[indices[t * 3 + 1]] + vScore[indices[t * 3 + 2]];
+        std::vector<uint8_t> emitted(triCount, 0);
+
+        std::vector<uint32_t> out(triCount * 3);
+        uint32_t cache[CACHE_SIZE + 3];
+        uint32_t newCache[CACHE_SIZE + 3];
+        int cacheCount = 0;
+        size_t scan = 0; // fallback: first triangle not emitted yet
+        int64_t best = -1;
+
+        for (size_t o = 0; o < triCount; ++o)
+        {
+            if (best < 0)
+            {
+                // Nothing in the cache leads anywhere: restart at the next unused triangle.
+                while (scan < triCount && emitted[scan])
+                    ++scan;
+                if (scan == triCount)
+                    break;
+                best = static_cast<int64_t>(scan);
+            }
+
+            const size_t t = static_cast<size_t>(best);
+            emitted[t] = 1;
+            const uint32_t tv[3] = {indices[t * 3], indices[t * 3 + 1], indices[t * 3 + 2]};
+            std::memcpy(&out[o * 3], tv, sizeof(tv));
+
+            // Drop the triangle from its vertices' live adjacency.
+            for (uint32_t v : tv)
+            {
+                uint32_t *list = &adjacency[offsets[v]];
+                const uint32_t live = remaining[v];
+                for (uint32_t i = 0; i < live; ++i)
+                {
+                    if (list[i] == t)
+                    {
+                        std::swap(list[i], list[live - 1]);
+                        break;
+                    }
+                }
+                --remaining[v];
+            }
+
+            // LRU: this triangle's vertices to the front; the tail falls out past CACHE_SIZE.
+            int n = 0;
+            for (uint32_t v : tv)
+                newCache[n++] = v;
+            for (int i = 0; i < cacheCount; ++i)
+            {
+                const uint32_t c = cache[i];
+                if (c != tv[0] && c != tv[1] && c != tv[2])
+                    newCache[n++] = c;
+            }
+
+            for (int i = 0; i < n; ++i)
+            {
+                const uint32_t v = newCache[i];
+                cachePos[v] = (i < CACHE_SIZE) ? i : -1;
+                const float s = vertexScore(cachePos[v], remaining[v]);
+                const float delta = s - vScore[v];
+                vScore[v] = s;
+                const uint32_t *list = &adjacency[offsets[v]];
+                for (uint32_t k = 0; k < remaining[v]; ++k)
+                    tScore[list[k]] += delta;
+            }
+
+            // Next: best live triangle touching the cache.
+            best = -1;
+            float bestScore = -1.0f;
+            cacheCount = std::min(n, CACHE_SIZE);
+            for (int i = 0; i < cacheCount; ++i)
+            {
+                const uint32_t v = newCache[i];
+                cache[i] = v;
+                const uint32_t *list = &adjacency[offsets[v]];
+                for (uint32_t k = 0; k < remaining[v]; ++k)
+                {
+                    if (tScore[list[k]] > bestScore)
+                    {
+                        bestScore = tScore[list[k]];
+                        best = list[k];
+                    }
+                }
+            }
+        }
+
+        std::memcpy(indices, out.data(), triCount * 3 * sizeof(uint32_t));
+    }
+
+    void OptimizeOverdraw(uint32_t *indices, size_t indexCount,
+                          const uint8_t *vertices, size_t vertexCount, size_t vertexStride)
+    {
+        const size_t triCount = indexCount / 3;
+        if (triCount < 2 || !vertices || vertexStride < sizeof(float) * 3 ||
+            !indicesInRange(indices, triCount * 3, vertexCount))
+            return;
+
+        // 1) Clusters: cut where a triangle misses on all three vertices (the cache restarts).
+        std::vector<uint32_t> stamp(vertexCount, 0);
+        uint32_t time = OVERDRAW_FIFO_SIZE + 1;
+        std::vector<size_t> starts;
+        for (size_t t = 0; t < triCount; ++t)
+        {
+            int misses = 0;
+            for (int k = 0; k < 3; ++k)
+            {
+                const uint32_t v = indices[t * 3 + k];
+                if (time - stamp[v] >= OVERDRAW_FIFO_SIZE)
+                {
+                    stamp[v] = time++;
+                    ++misses;
+                }
+            }
+            if (t == 0 || misses == 3)
+                starts.push_back(t);
+        }
+        if (starts.size() < 2)
+            return;
+        starts.push_back(triCount);
+
+        // 2) Area-weighted centroid and normal per cluster; mesh centroid from all triangles.
+        const size_t clusterCount = starts.size() - 1;
+        std::vector<float> clusterData(clusterCount * 6, 0.0f); // centroid*area (3), normal (3)
+        std::vector<float> clusterArea(clusterCount, 0.0f);
+        float meshCenter[3] = {0.0f, 0.0f, 0.0f};
+        float meshArea = 0.0f;
+        for (size_t c = 0; c < clusterCount; ++c)
+        {
+            float *d = &clusterData[c * 6];
+            for (size_t t = starts[c]; t < starts[c + 1]; ++t)
+            {
+                float p0[3], p1[3], p2[3];
+                readPosition(vertices, vertexStride, indices[t * 3], p0);
+                readPosition(vertices, vertexStride, indices[t * 3 + 1], p1);
+                readPosition(vertices, vertexStride, indices[t * 3 + 2], p2);
+                const float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+                const float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+                const float n[3] = {e1[1] * e2[2] - e1[2] * e2[1],
+                                    e1[2] * e2[0] - e1[0] * e2[2],
+                                    e1[0] * e2[1] - e1[1] * e2[0]}; // |n| = 2 * area
+                const float area = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+                for (int k = 0; k < 3; ++k)
+                {
+                    const float centroid = (p0[k] + p1[k] + p2[k]) * (1.0f / 3.0f);
+                    d[k] += centroid * area;
+                    d[3 + k] += n[k];
+                    meshCenter[k] += centroid * area;
+                }
+                clusterArea[c] += area;
+                meshArea += area;
+            }
+        }
+        if (meshArea <= 0.0f)
+            return;
+        for (float &m : meshCenter)
+            m /= meshArea;
+
+        // 3) Outward-facing clusters (far along their own normal from the centre) first.
+        std::vector<float> key(clusterCount, 0.0f);
+        for (size_t c = 0; c < clusterCount; ++c)
+        {
+            const float *d = &clusterData[c * 6];
+            const float nl = std::sqrt(d[3] * d[3] + d[4] * d[4] + d[5] * d[5]);
+            if (clusterArea[c] <= 0.0f || nl <= 0.0f)
+                continue;
+            float dot = 0.0f;
+            for (int k = 0; k < 3; ++k)
+                dot += (d[k] / clusterArea[c] - meshCenter[k]) * (d[3 + k] / nl);
+            key[c] = dot;
+        }
+
+        std::vector<uint32_t> order(clusterCount);
+        for (size_t c = 0; c < clusterCount; ++c)
+            order[c] = static_cast<uint32_t>(c);
+        std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b)
+                         { return key[a] > key[b]; });
+
+        std::vector<uint32_t> out;
+        out.reserve(triCount * 3);
+        for (uint32_t c : order)
+            out.insert(out.end(), indices + starts[c] * 3, indices + starts[c + 1] * 3);
+        std::memcpy(indices, out.data(), out.size() * sizeof(uint32_t));
+    }
+
+    void OptimizeVertexFetch(uint8_t *vertices, size_t vertexCount, size_t vertexStride,
+                             std::vector<uint32_t> *lists, size_t listCount)
+    {
+        if (!vertices || vertexCount == 0 || vertexStride == 0)
+            return;
+        for (size_t l = 0; l < listCount; ++l)
+        {
+            if (!indicesInRange(lists[l].data(), lists[l].size(), vertexCount))
+                return;
+        }
+
+        std::vector<uint32_t> remap(vertexCount, UINT32_MAX);
+        uint32_t next = 0;
+        for (size_t l = 0; l < listCount; ++l)
+        {
+            for (uint32_t idx : lists[l])
+            {
+                if (remap[idx] == UINT32_MAX)
+                    remap[idx] = next++;
+            }
+        }
+        for (size_t v = 0; v < vertexCount; ++v)
+        {
+            if (remap[v] == UINT32_MAX)
+                remap[v] = next++;
+        }
+
+        const std::vector<uint8_t> original(vertices, vertices + vertexCount * vertexStride);
+        for (size_t v = 0; v < vertexCount; ++v)
+            std::memcpy(vertices + size_t(remap[v]) * vertexStride, original.data() + v * vertexStride, vertexStride);
+        for (size_t l = 0; l < listCount; ++l)
+        {
+            for (uint32_t &idx : lists[l])
+                idx = remap[idx];
+        }
+    }
+
+    void OptimizeMesh(uint8_t *vertices, size_t vertexCount, size_t vertexStride,
+                      std::vector<uint32_t> *lists, size_t listCount)
+    {
+        if (!lists || listCount == 0)
+            return;
+        for (size_t l = 0; l < listCount; ++l)
+        {
+            if (!indicesInRange(lists[l].data(), lists[l].size(), vertexCount))
+                return; // malformed: leave the source order alone
+        }
+
+        for (size_t l = 0; l < listCount; ++l)
+            OptimizeVertexCache(lists[l].data(), lists[l].size(), vertexCount);
+        OptimizeOverdraw(lists[0].data(), lists[0].size(), vertices, vertexCount, vertexStride);
+        OptimizeVertexFetch(vertices, vertexCount, vertexStride, lists, listCount);
+    }
+
+    void BuildMeshlets(const uint32_t *indices, size_t indexCount, size_t vertexCount,
+                       uint32_t maxVertices, uint32_t maxTriangles, std::vector<Meshlet> &meshlets,
+                       std::vector<uint32_t> &meshletVertices, std::vector<uint8_t> &meshletTriangles)
+    {
+        meshlets.clear();
+        meshletVertices.clear();
+        meshletTriangles.clear();
+        const size_t triCount = indexCount / 3;
+        maxVertices = std::min<uint32_t>(maxVertices, 256u);
+        if (triCount == 0 || maxVertices < 3 || maxTriangles == 0 || !indicesInRange(indices, triCount * 3, vertexCount))
+            return;
+
+        // local[v]: v's slot in the current meshlet, valid while owner[v] is its index.
+        std::vector<uint8_t> local(vertexCount, 0);
+        std::vector<uint32_t> owner(vertexCount, UINT32_MAX);
+        Meshlet current{};
+
+        for (size_t t = 0; t < triCount; ++t)
+        {
+            const uint32_t *tri = indices + t * 3;
+            const uint32_t id = static_cast<uint32_t>(meshlets.size());
+            uint32_t added = 0;
+            for (int k = 0; k < 3; ++k)
+            {
+                const bool repeat = (k > 0 && tri[k] == tri[0]) || (k > 1 && tri[k] == tri[1]);
+                if (owner[tri[k]] != id && !repeat)
+                    ++added;
+            }
+
+            if (current.vertexCount + added > maxVertices || current.triangleCount + 1 > maxTriangles)
+            {
+                meshlets.push_back(current);
+                current = Meshlet{};
+                current.firstTriangle = static_cast<uint32_t>(t);
+                current.vertexOffset = static_cast<uint32_t>(meshletVertices.size());
+                current.triangleOffset = static_cast<uint32_t>(meshletTriangles.size() / 3);
+            }
+
+            const uint32_t cur = static_cast<uint32_t>(meshlets.size());
+            for (int k = 0; k < 3; ++k)
+            {
+                const uint32_t v = tri[k];
+                if (owner[v] != cur)
+                {
+                    owner[v] = cur;
+                    local[v] = static_cast<uint8_t>(current.vertexCount++);
+                    meshletVertices.push_back(v);
+                }
+                meshletTriangles.push_back(local[v]);
+            }
+            ++current.triangleCount;
+        }
+        meshlets.push_back(current);
+    }
+
+    MeshletBounds ComputeMeshletBounds(const Meshlet &meshlet, const uint32_t *meshletVertices,
+                                       const uint8_t *meshletTriangles, const uint8_t *vertices, size_t vertexStride)
+    {
+        MeshletBounds b{};
+        if (meshlet.vertexCount == 0 || meshlet.triangleCount == 0)
+            return b;
+
+        // Sphere: AABB centre, radius to the farthest vertex.
+        float mn[3], mx[3];
+        readPosition(vertices, vertexStride, meshletVertices[meshlet.vertexOffset], mn);
+        std::memcpy(mx, mn, sizeof(mx));
+        for (uint32_t i = 1; i < meshlet.vertexCount; ++i)
+        {
+            float p[3];
+            readPosition(vertices, vertexStride, meshletVertices[meshlet.vertexOffset + i], p);
+            for (int k = 0; k < 3; ++k)
+            {
+                mn[k] = std::min(mn[k], p[k]);
+                mx[k] = std::max(mx[k], p[k]);
+            }
+        }
+        for (int k = 0; k < 3; ++k)
+            b.center[k] = 0.5f * (mn[k] + mx[k]);
+        float r2 = 0.0f;
+        for (uint32_t i = 0; i < meshlet.vertexCount; ++i)
+        {
+            float p[3];
+            readPosition(vertices, vertexStride, meshletVertices[meshlet.vertexOffset + i], p);
+            const float d[3] = {p[0] - b.center[0], p[1] - b.center[1], p[2] - b.center[2]};
+            r2 = std::max(r2, d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+        }
+        b.radius = std::sqrt(r2);
+
+        // Cone: mean of the unit face normals; its half-angle reaches the least aligned one.
+        std::vector<float> normals;
+        normals.reserve(size_t(meshlet.triangleCount) * 3);
+        float axis[3] = {0.0f, 0.0f, 0.0f};
+        const uint8_t *tris = meshletTriangles + size_t(meshlet.triangleOffset) * 3;
+        for (uint32_t t = 0; t < meshlet.triangleCount; ++t)
+        {
+            float p0[3], p1[3], p2[3];
+            readPosition(vertices, vertexStride, meshletVertices[meshlet.vertexOffset + tris[t * 3]], p0);
+            readPosition(vertices, vertexStride, meshletVertices[meshlet.vertexOffset + tris[t * 3 + 1]], p1);
+            readPosition(vertices, vertexStride, meshletVertices[meshlet.vertexOffset + tris[t * 3 + 2]], p2);
+            const float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+            const float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+            float n[3] = {e1[1] * e2[2] - e1[2] * e2[1],
+                          e1[2] * e2[0] - e1[0] * e2[2],
+                          e1[0] * e2[1] - e1[1] * e2[0]};
+            const float len = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            if (len <= 0.0f)
+                continue; // degenerate: faces nowhere
+            for (int k = 0; k < 3; ++k)
+            {
+                n[k] /= len;
+                axis[k] += n[k];
+                normals.push_back(n[k]);
+            }
+        }
+
+        const float axisLen = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+        if (normals.empty() || axisLen <= 0.0f)
+            return b;
+        for (int k = 0; k < 3; ++k)
+            axis[k] /= axisLen;
+
+        float minDot = 1.0f;
+        for (size_t i = 0; i < normals.size(); i += 3)
+            minDot = std::min(minDot, normals[i] * axis[0] + normals[i + 1] * axis[1] + normals[i + 2] * axis[2]);
+
+        std::memcpy(b.coneAxis, axis, sizeof(axis));
+        // Normals spread past ~84 degrees from the axis: some triangle faces every viewer.
+        if (minDot > 0.1f)
+            b.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+        return b;
+    }
+
+} // namespace Engine
@@ -3,8 +3,10 @@
 #include "Engine/VulkanContext.h"
 #include "Engine/SwapChain.h"
 #include "Engine/Camera.h"
+#include "utils/BufferUtils.h"
 #include "utils/ImageUtils.h"
 #include "assets/AssetManager.h"
+#include "assets/model/SModelPackedVertex.h"
 #include <stdexcept>
 #include <iostream>
 #include <cstring>
@@ -81,7 +83,7 @@ namespace Engine
         // Create resources
         createDescriptorLayouts();
         createDescriptorPool(materialCount);
-        createCameraUBO();
+        createCameraSet();
         createDummyTexture(ctx);
         createPipelinesForModel(ctx, pass);
         createMaterialDescriptors();
@@ -93,8 +95,6 @@ namespace Engine
 
     void MeshRenderPassModule::record(FrameContext &frameCtx, VkCommandBuffer cmd)
     {
-        (void)frameCtx;
-
         if (!m_enabled || !m_camera || !m_assetManager)
             return;
         if (m_extent.width == 0 || m_extent.height == 0)
@@ -106,27 +106,45 @@ namespace Engine
         if (!model || model->primitives.empty())
             return;
 
-        // Update camera UBO
-        updateCameraUBO();
+        // Camera: the renderer's shared block (view, proj, position) in its upload ring.
+        if (!frameCtx.uploads)
+            return;
+        if (m_cameraRingBuffer != frameCtx.uploads->buffer())
+        {
+            VkDescriptorBufferInfo bufferInfo{};
+            bufferInfo.buffer = frameCtx.uploads->buffer();
+            bufferInfo.offset = 0;
+            bufferInfo.range = sizeof(CameraBlock);
+
+            VkWriteDescriptorSet write{};
+            write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            write.dstSet = m_cameraDescriptorSet;
+            write.dstBinding = 0;
+            write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+            write.descriptorCount = 1;
+            write.pBufferInfo = &bufferInfo;
+            vkUpdateDescriptorSets(m_device, 1, &write, 0, nullptr);
+            m_cameraRingBuffer = frameCtx.uploads->buffer();
+        }
 
         // Set viewport and scissor
         VkViewport vp{};
         vp.x = 0.0f;
         vp.y = 0.0f;
-        vp.width = static_cast<float>(m_extent.width);
-        vp.height = static_cast<float>(m_extent.height);
+        vp.width = static_cast<float>(frameCtx.renderExtent.width);
+        vp.height = static_cast<float>(frameCtx.renderExtent.height);
         vp.minDepth = 0.0f;
         vp.maxDepth = 1.0f;
         vkCmdSetViewport(cmd, 0, 1, &vp);
 
         VkRect2D sc{};
         sc.offset = {0, 0};
-        sc.extent = m_extent;
+        sc.extent = frameCtx.renderExtent;
         vkCmdSetScissor(cmd, 0, 1, &sc);
 
         // Bind camera descriptor (set 0)
         vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout,
-                                0, 1, &m_cameraDescriptorSet, 0, nullptr);
+                                0, 1, &m_cameraDescriptorSet, 1, &frameCtx.cameraOffset);
 
         // Draw each primitive
         for (size_t i = 0; i < model->primitives.size(); ++i)
@@ -212,8 +230,10 @@ namespace Engine
         vkCmdPushConstants(cmd, m_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT,
                            0, sizeof(glm::mat4), &modelMat);
 
-        // Draw
-        vkCmdDrawIndexed(cmd, prim.indexCount, 1, prim.firstIndex, prim.vertexOffset, 0);
+        // Draw (mesh offsets are non-zero when the model's meshes share one buffer)
+        vkCmdDrawIndexed(cmd, prim.indexCount, 1,
+                         mesh->getFirstIndex() + prim.firstIndex,
+                         mesh->getVertexOffset() + prim.vertexOffset, 0);
     }
 
     // ============================================================================
@@ -222,10 +242,10 @@ namespace Engine
 
     void MeshRenderPassModule::createDescriptorLayouts()
     {
-        // Set 0: Camera UBO
+        // Set 0: Camera UBO (Renderer's CameraBlock, dynamic offset per frame)
         VkDescriptorSetLayoutBinding camBinding{};
         camBinding.binding = 0;
-        camBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        camBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
         camBinding.descriptorCount = 1;
         camBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
 
@@ -277,11 +297,13 @@ namespace Engine
         if (materialCount == 0)
             materialCount = 1;
 
-        std::vector<VkDescriptorPoolSize> poolSizes(2);
+        std::vector<VkDescriptorPoolSize> poolSizes(3);
         poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        poolSizes[0].descriptorCount = static_cast<uint32_t>(1 + materialCount);
+        poolSizes[0].descriptorCount = static_cast<uint32_t>(materialCount);
         poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
         poolSizes[1].descriptorCount = static_cast<uint32_t>(materialCount * 5);
+        poolSizes[2].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+        poolSizes[2].descriptorCount = 1;
 
         VkDescriptorPoolCreateInfo poolInfo{};
         poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
@@ -297,108 +319,24 @@ namespace Engine
     }
 
     // ============================================================================
-    // Camera UBO
+    // Camera set
     // ============================================================================
 
-    void MeshRenderPassModule::createCameraUBO()
+    // The set's buffer is written on first record(), once the renderer's upload ring is known.
+    void MeshRenderPassModule::createCameraSet()
     {
-        VkBufferCreateInfo bufInfo{};
-        bufInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-        bufInfo.size = sizeof(glm::mat4) * 2 + sizeof(glm::vec4);
-        bufInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-        bufInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-        VkResult r = vkCreateBuffer(m_device, &bufInfo, nullptr, &m_cameraUBO);
-        if (r != VK_SUCCESS)
-        {
-            throw std::runtime_error("MeshRenderPassModule: failed to create camera UBO");
-        }
-
-        VkMemoryRequirements memReq;
-        vkGetBufferMemoryRequirements(m_device, m_cameraUBO, &memReq);
-
-        VkMemoryAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocInfo.allocationSize = memReq.size;
-        allocInfo.memoryTypeIndex = findMemoryType(memReq.memoryTypeBits,
-                                                   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-        r = vkAllocateMemory(m_device, &allocInfo, nullptr, &m_cameraUBOMemory);
-        if (r != VK_SUCCESS)
-        {
-            vkDestroyBuffer(m_device, m_cameraUBO, nullptr);
-            m_cameraUBO = VK_NULL_HANDLE;
-            throw std::runtime_error("MeshRenderPassModule: failed to allocate camera UBO memory");
-        }
-
-        r = vkBindBufferMemory(m_device, m_cameraUBO, m_cameraUBOMemory, 0);
-        if (r != VK_SUCCESS)
-        {
-            vkFreeMemory(m_device, m_cameraUBOMemory, nullptr);
-            vkDestroyBuffer(m_device, m_cameraUBO, nullptr);
-            throw std::runtime_error("MeshRenderPassModule: failed to bind camera UBO memory");
-        }
-
-        // Persistently map the memory
-        r = vkMapMemory(m_device, m_cameraUBOMemory, 0, VK_WHOLE_SIZE, 0, &m_cameraUBOMapped);
-        if (r != VK_SUCCESS)
-        {
-            throw std::runtime_error("MeshRenderPassModule: failed to map camera UBO memory");
-        }
-
-        // Allocate descriptor set
         VkDescriptorSetAllocateInfo allocDesc{};
         allocDesc.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
         allocDesc.descriptorPool = m_descriptorPool;
         allocDesc.descriptorSetCount = 1;
         allocDesc.pSetLayouts = &m_cameraSetLayout;
 
-        r = vkAllocateDescriptorSets(m_device, &allocDesc, &m_cameraDescriptorSet);
+        VkResult r = vkAllocateDescriptorSets(m_device, &allocDesc, &m_cameraDescriptorSet);
         if (r != VK_SUCCESS)
         {
             throw std::runtime_error("MeshRenderPassModule: failed to allocate camera descriptor set");
         }
-
-        // Write descriptor
-        VkDescriptorBufferInfo bufferInfo{};
-        bufferInfo.buffer = m_cameraUBO;
-        bufferInfo.offset = 0;
-        bufferInfo.range = VK_WHOLE_SIZE;
-
-        VkWriteDescriptorSet write{};
-        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        write.dstSet = m_cameraDescriptorSet;
-        write.dstBinding = 0;
-        write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        write.descriptorCount = 1;
-        write.pBufferInfo = &bufferInfo;
-
-        vkUpdateDescriptorSets(m_device, 1, &write, 0, nullptr);
-    }
-
-    // ============================================================================
-    // Update camera UBO
-    // ============================================================================
-
-    void MeshRenderPassModule::updateCameraUBO()
-    {
-        if (!m_camera || !m_cameraUBOMapped)
-            return;
-
-        struct CameraUBO
-        {
-            glm::mat4 view;
-            glm::mat4 proj;
-            glm::vec3 cameraPos;
-            float _pad;
-        } ubo;
-
-        ubo.view = m_camera->GetViewMatrix();
-        ubo.proj = m_camera->GetProjectionMatrix();
-        ubo.cameraPos = m_camera->GetPosition();
-        ubo._pad = 0.0f;
-
-        std::memcpy(m_cameraUBOMapped, &ubo, sizeof(CameraUBO));
+        m_cameraRingBuffer = VK_NULL_HANDLE;
     }
 
     // ============================================================================
@@ -426,29 +364,17 @@ namespace Engine
             throw std::runtime_error("MeshRenderPassModule: failed to create dummy image");
         }
 
-        VkMemoryRequirements memReq;
-        vkGetImageMemoryRequirements(m_device, m_dummyImage, &memReq);
-
-        VkMemoryAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocInfo.allocationSize = memReq.size;
-        allocInfo.memoryTypeIndex = findMemoryType(memReq.memoryTypeBits,
-                                                   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-        r = vkAllocateMemory(m_device, &allocInfo, nullptr, &m_dummyImageMemory);
+        r = AllocateImageMemory(m_device, m_phys, m_dummyImage,
+                                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                m_dummyImageMemory, GpuResourceKind::Linear);
         if (r != VK_SUCCESS)
         {
             throw std::runtime_error("MeshRenderPassModule: failed to allocate dummy image memory");
         }
 
-        vkBindImageMemory(m_device, m_dummyImage, m_dummyImageMemory, 0);
-
-        // Write white pixel
-        void *p = nullptr;
-        vkMapMemory(m_device, m_dummyImageMemory, 0, VK_WHOLE_SIZE, 0, &p);
+        // Write white pixel (linear tiling, so subresource offset 0 is the first texel)
         uint8_t white[4] = {255, 255, 255, 255};
-        std::memcpy(p, white, 4);
-        vkUnmapMemory(m_device, m_dummyImageMemory);
+        std::memcpy(m_dummyImageMemory.mapped, white, 4);
 
         // Transition layout using upload pool
         if (m_uploadPool != VK_NULL_HANDLE)
@@ -581,11 +507,17 @@ namespace Engine
             throw std::runtime_error("MeshRenderPassModule: failed to load shader modules");
         }
 
+        // Model meshes are uploaded packed (octahedral normal, half uv): own vertex shader.
+        VkShaderModule vertPacked = VK_NULL_HANDLE;
+        if (strides.count(smodel::SMODEL_PACKED_VERTEX_STRIDE))
+            vertPacked = Pipeline::createShaderModuleFromFile(ctx.GetDevice(), "shaders/mesh_packed.vert.spv");
+
         // Create pipeline for each stride
         for (uint32_t stride : strides)
         {
             PipelineCreateInfo pci{};
             pci.device = ctx.GetDevice();
+            pci.pipelineCache = ctx.GetPipelineCache();
             pci.renderPass = pass;
             pci.subpass = 0;
 
@@ -593,7 +525,8 @@ namespace Engine
             VkPipelineShaderStageCreateInfo vs{};
             vs.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
             vs.stage = VK_SHADER_STAGE_VERTEX_BIT;
-            vs.module = vert;
+            const bool packed = (stride == smodel::SMODEL_PACKED_VERTEX_STRIDE);
+            vs.module = packed ? vertPacked : vert;
             vs.pName = "main";
 
             VkPipelineShaderStageCreateInfo fs{};
@@ -611,7 +544,7 @@ namespace Engine
             bindingDesc.stride = stride;
             bindingDesc.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
 
-            // Attributes (pos/normal/uv at standard offsets)
+            // Attributes (pos/normal/uv at standard offsets, or the packed SModel ones)
             VkVertexInputAttributeDescription attrs[3]{};
             attrs[0].location = 0;
             attrs[0].binding = 0;
@@ -620,13 +553,13 @@ namespace Engine
 
             attrs[1].location = 1;
             attrs[1].binding = 0;
-            attrs[1].format = VK_FORMAT_R32G32B32_SFLOAT;
+            attrs[1].format = packed ? VK_FORMAT_R16G16_SNORM : VK_FORMAT_R32G32B32_SFLOAT;
             attrs[1].offset = 12;
 
             attrs[2].location = 2;
             attrs[2].binding = 0;
-            attrs[2].format = VK_FORMAT_R32G32_SFLOAT;
-            attrs[2].offset = 24;
+            attrs[2].format = packed ? VK_FORMAT_R16G16_SFLOAT : VK_FORMAT_R32G32_SFLOAT;
+            attrs[2].offset = packed ? 16 : 24;
 
             VkPipelineVertexInputStateCreateInfo vi{};
             vi.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
@@ -682,6 +615,8 @@ namespace Engine
 
         vkDestroyShaderModule(ctx.GetDevice(), vert, nullptr);
         vkDestroyShaderModule(ctx.GetDevice(), frag, nullptr);
+        if (vertPacked != VK_NULL_HANDLE)
+            vkDestroyShaderModule(ctx.GetDevice(), vertPacked, nullptr);
     }
 
     // ============================================================================
@@ -721,25 +656,9 @@ namespace Engine
 
             // Create material UBO
             VkBuffer ubo = VK_NULL_HANDLE;
-            VkDeviceMemory uboMem = VK_NULL_HANDLE;
-
-            VkBufferCreateInfo bufInfo{};
-            bufInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-            bufInfo.size = sizeof(float) * 8;
-            bufInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-            bufInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-            vkCreateBuffer(m_device, &bufInfo, nullptr, &ubo);
-
-            VkMemoryRequirements memReq;
-            vkGetBufferMemoryRequirements(m_device, ubo, &memReq);
-
-            VkMemoryAllocateInfo memAllocInfo{};
-            memAllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-            memAllocInfo.allocationSize = memReq.size;
-            memAllocInfo.memoryTypeIndex = findMemoryType(memReq.memoryTypeBits,
-                                                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-            vkAllocateMemory(m_device, &memAllocInfo, nullptr, &uboMem);
-            vkBindBufferMemory(m_device, ubo, uboMem, 0);
+            GpuAllocation uboMem;
+            CreateBuffer(m_device, m_phys, sizeof(float) * 8, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, ubo, uboMem);
 
             // Fill UBO
             struct MaterialUBO
@@ -768,10 +687,8 @@ namespace Engine
             uboData.pad[0] = 0.0f;
             uboData.pad[1] = 0.0f;
 
-            void *data = nullptr;
-            vkMapMemory(m_device, uboMem, 0, sizeof(MaterialUBO), 0, &data);
-            std::memcpy(data, &uboData, sizeof(MaterialUBO));
-            vkUnmapMemory(m_device, uboMem);
+            if (uboMem.mapped)
+                std::memcpy(uboMem.mapped, &uboData, sizeof(MaterialUBO));
 
             m_materialUBOs.push_back(ubo);
             m_materialUBOMemories.push_back(uboMem);
@@ -870,10 +787,7 @@ namespace Engine
         // Material UBOs
         for (size_t i = 0; i < m_materialUBOs.size(); ++i)
         {
-            if (m_materialUBOs[i] != VK_NULL_HANDLE)
-                vkDestroyBuffer(m_device, m_materialUBOs[i], nullptr);
-            if (m_materialUBOMemories[i] != VK_NULL_HANDLE)
-                vkFreeMemory(m_device, m_materialUBOMemories[i], nullptr);
+            DestroyBuffer(m_device, m_materialUBOs[i], m_materialUBOMemories[i]);
         }
         m_materialUBOs.clear();
         m_materialUBOMemories.clear();
@@ -892,22 +806,7 @@ namespace Engine
         }
         m_pipelines.clear();
 
-        // Camera UBO (unmap if mapped)
-        if (m_cameraUBOMapped && m_cameraUBOMemory != VK_NULL_HANDLE)
-        {
-            vkUnmapMemory(m_device, m_cameraUBOMemory);
-            m_cameraUBOMapped = nullptr;
-        }
-        if (m_cameraUBO != VK_NULL_HANDLE)
-        {
-            vkDestroyBuffer(m_device, m_cameraUBO, nullptr);
-            m_cameraUBO = VK_NULL_HANDLE;
-        }
-        if (m_cameraUBOMemory != VK_NULL_HANDLE)
-        {
-            vkFreeMemory(m_device, m_cameraUBOMemory, nullptr);
-            m_cameraUBOMemory = VK_NULL_HANDLE;
-        }
+        m_cameraRingBuffer = VK_NULL_HANDLE;
 
         // Descriptor layouts
         if (m_cameraSetLayout != VK_NULL_HANDLE)
@@ -944,11 +843,7 @@ namespace Engine
             vkDestroyImage(m_device, m_dummyImage, nullptr);
             m_dummyImage = VK_NULL_HANDLE;
         }
-        if (m_dummyImageMemory != VK_NULL_HANDLE)
-        {
-            vkFreeMemory(m_device, m_dummyImageMemory, nullptr);
-            m_dummyImageMemory = VK_NULL_HANDLE;
-        }
+        FreeGpuMemory(m_device, m_dummyImageMemory);
 
         // Upload pool
         if (m_uploadPool != VK_NULL_HANDLE)
@@ -958,20 +853,4 @@ namespace Engine
         }
     }
 
-    // ============================================================================
-    // Helper: find memory type
-    // ============================================================================
-
-    uint32_t MeshRenderPassModule::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const
-    {
-        VkPhysicalDeviceMemoryProperties memProps;
-        vkGetPhysicalDeviceMemoryProperties(m_phys, &memProps);
-        for (uint32_t i = 0; i < memProps.memoryTypeCount; ++i)
-        {
-            if ((typeFilter & (1u << i)) && (memProps.memoryTypes[i].propertyFlags & properties) == properties)
-                return i;
-        }
-        throw std::runtime_error("MeshRenderPassModule: failed to find suitable memory type");
-    }
-
 } // namespace Engine
@@ -0,0 +1,627 @@
+#include "Engine/ParticleRenderPassModule.h"
+
+#include "Engine/VulkanContext.h"
+#include "Engine/SwapChain.h"
+#include "Engine/PerformanceMonitor.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace Engine
+{
+    namespace
+    {
+        static_assert((ParticleRenderPassModule::MAX_PARTICLES & (ParticleRenderPassModule::MAX_PARTICLES - 1u)) == 0u,
+                      "MAX_PARTICLES must be a power of two (particle_emit.comp wraps with a mask)");
+
+        uint32_t hashSeed(uint32_t v)
+        {
+            v ^= v >> 16;
+            v *= 0x7feb352du;
+            v ^= v >> 15;
+            v *= 0x846ca68bu;
+            v ^= v >> 16;
+            return v;
+        }
+    }
+
+    ParticleRenderPassModule::ParticleRenderPassModule()
+    {
+        EffectDesc &hit = m_effects[static_cast<uint32_t>(ParticleEffect::Hit)];
+        hit.colorStart = glm::vec4(1.0f, 0.85f, 0.45f, 1.0f);
+        hit.colorEnd = glm::vec4(1.0f, 0.3f, 0.05f, 0.0f);
+        hit.speedMin = 3.0f;
+        hit.speedMax = 7.0f;
+        hit.spread = 0.6f;
+        hit.lift = 1.0f;
+        hit.lifeMin = 0.2f;
+        hit.lifeMax = 0.45f;
+        hit.sizeStart = 0.05f;
+        hit.sizeEnd = 0.02f;
+        hit.gravity = 9.81f;
+        hit.drag = 1.5f;
+        hit.defaultCount = 24;
+
+        EffectDesc &death = m_effects[static_cast<uint32_t>(ParticleEffect::Death)];
+        death.colorStart = glm::vec4(0.7f, 0.08f, 0.05f, 0.9f);
+        death.colorEnd = glm::vec4(0.25f, 0.02f, 0.02f, 0.0f);
+        death.speedMin = 1.0f;
+        death.speedMax = 3.5f;
+        death.spread = 1.0f;
+        death.lift = 1.5f;
+        death.lifeMin = 0.5f;
+        death.lifeMax = 1.0f;
+        death.sizeStart = 0.08f;
+        death.sizeEnd = 0.04f;
+        death.gravity = 9.81f;
+        death.drag = 0.8f;
+        death.defaultCount = 48;
+
+        EffectDesc &dust = m_effects[static_cast<uint32_t>(ParticleEffect::Dust)];
+        dust.colorStart = glm::vec4(0.35f, 0.3f, 0.22f, 0.35f);
+        dust.colorEnd = glm::vec4(0.3f, 0.26f, 0.2f, 0.0f);
+        dust.speedMin = 0.4f;
+        dust.speedMax = 1.5f;
+        dust.spread = 1.0f;
+        dust.lift = 0.4f;
+        dust.lifeMin = 1.0f;
+        dust.lifeMax = 2.0f;
+        dust.sizeStart = 0.3f;
+        dust.sizeEnd = 0.9f;
+        dust.gravity = -0.2f;
+        dust.drag = 2.0f;
+        dust.defaultCount = 16;
+    }
+
+    void ParticleRenderPassModule::setEffect(ParticleEffect effect, const EffectDesc &desc)
+    {
+        const uint32_t index = static_cast<uint32_t>(effect);
+        if (index >= PARTICLE_EFFECT_COUNT)
+            return;
+        m_effects[index] = desc;
+    }
+
+    void ParticleRenderPassModule::onCreate(VulkanContext &ctx, VkRenderPass pass, const std::vector<VkFramebuffer> &fbs)
+    {
+        m_device = ctx.GetDevice();
+        m_extent = ctx.GetSwapChain() ? ctx.GetSwapChain()->GetExtent() : VkExtent2D{};
+
+        const size_t frameCount = (fbs.empty() ? 1u : fbs.size());
+        if (!createBuffers(ctx, frameCount))
+            throw std::runtime_error("ParticleRenderPassModule: failed to create buffers");
+
+        // Without the shaders the pass stays idle (and drains the ring so it never fills up).
+        m_ready = false;
+        try
+        {
+            createComputePipelines(ctx);
+            createGraphicsPipeline(ctx, pass);
+            m_ready = true;
+        }
+        catch (const std::exception &e)
+        {
+#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
+            std::cerr << "[ParticleRenderPassModule] disabled: " << e.what() << "\n";
+#else
+            (void)e;
+#endif
+        }
+
+        m_emitCursor = 0;
+        m_usedParticles = 0;
+        m_aliveUntil = -1.0f;
+        m_haveLastFrame = false;
+    }
+
+    void ParticleRenderPassModule::onResize(VulkanContext &ctx, VkExtent2D newExtent)
+    {
+        (void)ctx;
+        m_extent = newExtent;
+    }
+
+    void ParticleRenderPassModule::onDestroy(VulkanContext &ctx)
+    {
+        (void)ctx;
+
+        if (m_device == VK_NULL_HANDLE)
+            return;
+
+        m_pipeline.destroy(m_device);
+        if (m_pipelineLayout != VK_NULL_HANDLE)
+        {
+            vkDestroyPipelineLayout(m_device, m_pipelineLayout, nullptr);
+            m_pipelineLayout = VK_NULL_HANDLE;
+        }
+        if (m_emitPipeline != VK_NULL_HANDLE)
+        {
+            vkDestroyPipeline(m_device, m_emitPipeline, nullptr);
+            m_emitPipeline = VK_NULL_HANDLE;
+        }
+        if (m_updatePipeline != VK_NULL_HANDLE)
+        {
+            vkDestroyPipeline(m_device, m_updatePipeline, nullptr);
+            m_updatePipeline = VK_NULL_HANDLE;
+        }
+        if (m_computeLayout != VK_NULL_HANDLE)
+        {
+            vkDestroyPipelineLayout(m_device, m_computeLayout, nullptr);
+            m_computeLayout = VK_NULL_HANDLE;
+        }
+        m_ready = false;
+
+        destroyBuffers();
+
+        m_device = VK_NULL_HANDLE;
+        m_extent = {};
+    }
+
+    bool ParticleRenderPassModule::createBuffers(VulkanContext &ctx, size_t frameCount)
+    {
+        destroyBuffers();
+
+        // 0: frame UBO (camera + effect table), 1: bursts, 2: particle pool, 3: alive list,
+        // 4: indirect draw command
+        VkDescriptorSetLayoutBinding bindings[5]{};
+        for (uint32_t i = 0; i < 5u; ++i)
+        {
+            bindings[i].binding = i;
+            bindings[i].descriptorType = i == 0 ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            bindings[i].descriptorCount = 1;
+            bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT;
+        }
+
+        VkDescriptorSetLayoutCreateInfo dsl{};
+        dsl.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        dsl.bindingCount = 5;
+        dsl.pBindings = bindings;
+        if (vkCreateDescriptorSetLayout(ctx.GetDevice(), &dsl, nullptr, &m_setLayout) != VK_SUCCESS)
+            return false;
+
+        const uint32_t frames = static_cast<uint32_t>(frameCount);
+        VkDescriptorPoolSize poolSizes[2]{};
+        poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        poolSizes[0].descriptorCount = frames;
+        poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        poolSizes[1].descriptorCount = frames * 4u;
+
+        VkDescriptorPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.maxSets = frames;
+        poolInfo.poolSizeCount = 2;
+        poolInfo.pPoolSizes = poolSizes;
+        if (vkCreateDescriptorPool(ctx.GetDevice(), &poolInfo, nullptr, &m_pool) != VK_SUCCESS)
+            return false;
+
+        std::vector<VkDescriptorSetLayout> layouts(frameCount, m_setLayout);
+        std::vector<VkDescriptorSet> sets(frameCount, VK_NULL_HANDLE);
+        VkDescriptorSetAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = m_pool;
+        allocInfo.descriptorSetCount = frames;
+        allocInfo.pSetLayouts = layouts.data();
+        if (vkAllocateDescriptorSets(ctx.GetDevice(), &allocInfo, sets.data()) != VK_SUCCESS)
+            return false;
+
+        // Pool, alive list and draw command: device local, written only by the compute passes
+        // (and the command's vertex count by vkCmdUpdateBuffer).
+        if (CreateDeviceLocalBuffer(ctx.GetDevice(), ctx.GetPhysicalDevice(), VkDeviceSize(MAX_PARTICLES) * PARTICLE_BYTES,
+                                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                    m_particleBuffer, m_particleMemory) != VK_SUCCESS)
+            return false;
+        if (CreateDeviceLocalBuffer(ctx.GetDevice(), ctx.GetPhysicalDevice(), VkDeviceSize(MAX_PARTICLES) * sizeof(uint32_t),
+                                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                    m_aliveBuffer, m_aliveMemory) != VK_SUCCESS)
+            return false;
+        if (CreateDeviceLocalBuffer(ctx.GetDevice(), ctx.GetPhysicalDevice(), sizeof(VkDrawIndirectCommand),
+                                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                    m_indirectBuffer, m_indirectMemory) != VK_SUCCESS)
+            return false;
+
+        const VkMemoryPropertyFlags hostProps = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+        m_frames.resize(frameCount);
+        for (size_t i = 0; i < frameCount; ++i)
+        {
+            FrameData &f = m_frames[i];
+            f.set = sets[i];
+
+            if (CreateBuffer(ctx.GetDevice(), ctx.GetPhysicalDevice(), sizeof(FrameUBO), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                             hostProps, f.uniformBuffer, f.uniformMemory) != VK_SUCCESS ||
+                !f.uniformMemory.mapped)
+                return false;
+
+            if (CreateBuffer(ctx.GetDevice(), ctx.GetPhysicalDevice(), VkDeviceSize(MAX_BURSTS_PER_FRAME) * sizeof(GpuBurst),
+                             VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, hostProps, f.burstBuffer, f.burstMemory) != VK_SUCCESS ||
+                !f.burstMemory.mapped)
+                return false;
+
+            const VkBuffer buffers[5] = {f.uniformBuffer, f.burstBuffer, m_particleBuffer, m_aliveBuffer, m_indirectBuffer};
+            VkDescriptorBufferInfo infos[5]{};
+            VkWriteDescriptorSet writes[5]{};
+            for (uint32_t b = 0; b < 5u; ++b)
+            {
+                infos[b].buffer = buffers[b];
+                infos[b].offset = 0;
+                infos[b].range = VK_WHOLE_SIZE;
+
+                writes[b].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                writes[b].dstSet = f.set;
+                writes[b].dstBinding = b;
+                writes[b].descriptorType = bindings[b].descriptorType;
+                writes[b].descriptorCount = 1;
+                writes[b].pBufferInfo = &infos[b];
+            }
+            vkUpdateDescriptorSets(ctx.GetDevice(), 5, writes, 0, nullptr);
+        }
+        return true;
+    }
+
+    void ParticleRenderPassModule::destroyBuffers()
+    {
+        for (FrameData &f : m_frames)
+        {
+            DestroyBuffer(m_device, f.uniformBuffer, f.uniformMemory);
+            DestroyBuffer(m_device, f.burstBuffer, f.burstMemory);
+            f.set = VK_NULL_HANDLE;
+        }
+        m_frames.clear();
+
+        DestroyBuffer(m_device, m_particleBuffer, m_particleMemory);
+        DestroyBuffer(m_device, m_aliveBuffer, m_aliveMemory);
+        DestroyBuffer(m_device, m_indirectBuffer, m_indirectMemory);
+
+        if (m_pool != VK_NULL_HANDLE)
+        {
+            vkDestroyDescriptorPool(m_device, m_pool, nullptr);
+            m_pool = VK_NULL_HANDLE;
+        }
+        if (m_setLayout != VK_NULL_HANDLE)
+        {
+            vkDestroyDescriptorSetLayout(m_device, m_setLayout, nullptr);
+            m_setLayout = VK_NULL_HANDLE;
+        }
+    }
+
+    void ParticleRenderPassModule::createComputePipelines(VulkanContext &ctx)
+    {
+        VkPushConstantRange pcRange{};
+        pcRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pcRange.offset = 0;
+        pcRange.size = sizeof(ComputePush);
+
+        VkPipelineLayoutCreateInfo plInfo{};
+        plInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        plInfo.setLayoutCount = 1;
+        plInfo.pSetLayouts = &m_setLayout;
+        plInfo.pushConstantRangeCount = 1;
+        plInfo.pPushConstantRanges = &pcRange;
+        if (vkCreatePipelineLayout(ctx.GetDevice(), &plInfo, nullptr, &m_computeLayout) != VK_SUCCESS)
+            throw std::runtime_error("failed to create compute pipeline layout");
+
+        auto createOne = [&](const char *path, VkPipeline &out)
+        {
+            VkShaderModule comp = Pipeline::createShaderModuleFromFile(ctx.GetDevice(), path);
+
+            VkComputePipelineCreateInfo cpi{};
+            cpi.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+            cpi.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+            cpi.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+            cpi.stage.module = comp;
+            cpi.stage.pName = "main";
+            cpi.layout = m_computeLayout;
+
+            const VkResult r = vkCreateComputePipelines(ctx.GetDevice(), ctx.GetPipelineCache(), 1, &cpi, nullptr, &out);
+            vkDestroyShaderModule(ctx.GetDevice(), comp, nullptr);
+            if (r != VK_SUCCESS)
+                throw std::runtime_error(std::string("failed to create compute pipeline ") + path);
+        };
+        createOne("shaders/particle_emit.comp.spv", m_emitPipeline);
+        createOne("shaders/particle_update.comp.spv", m_updatePipeline);
+    }
+
+    void ParticleRenderPassModule::createGraphicsPipeline(VulkanContext &ctx, VkRenderPass pass)
+    {
+        VkPipelineLayoutCreateInfo plInfo{};
+        plInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        plInfo.setLayoutCount = 1;
+        plInfo.pSetLayouts = &m_setLayout;
+        if (vkCreatePipelineLayout(ctx.GetDevice(), &plInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS)
+            throw std::runtime_error("failed to create pipeline layout");
+
+        PipelineCreateInfo pci{};
+        pci.device = ctx.GetDevice();
+        pci.pipelineCache = ctx.GetPipelineCache();
+        pci.renderPass = pass;
+        pci.subpass = 0;
+        pci.pipelineLayout = m_pipelineLayout;
+
+        VkShaderModule vert = Pipeline::createShaderModuleFromFile(pci.device, "shaders/particle.vert.spv");
+        VkShaderModule frag = VK_NULL_HANDLE;
+        try
+        {
+            frag = Pipeline::createShaderModuleFromFile(pci.device, "shaders/particle.frag.spv");
+        }
+        catch (const std::exception &)
+        {
+            vkDestroyShaderModule(pci.device, vert, nullptr);
+            throw;
+        }
+
+        VkPipelineShaderStageCreateInfo vs{};
+        vs.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        vs.stage = VK_SHADER_STAGE_VERTEX_BIT;
+        vs.module = vert;
+        vs.pName = "main";
+
+        VkPipelineShaderStageCreateInfo fs{};
+        fs.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        fs.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+        fs.module = frag;
+        fs.pName = "main";
+
+        pci.shaderStages = {vs, fs};
+
+        // No vertex buffers: particle.vert builds the quad from gl_VertexIndex.
+        VkPipelineRasterizationStateCreateInfo rs{};
+        rs.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+        rs.depthClampEnable = VK_FALSE;
+        rs.rasterizerDiscardEnable = VK_FALSE;
+        rs.polygonMode = VK_POLYGON_MODE_FILL;
+        rs.lineWidth = 1.0f;
+        rs.cullMode = VK_CULL_MODE_NONE;
+        rs.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+        rs.depthBiasEnable = VK_FALSE;
+        pci.rasterization = rs;
+        pci.rasterizationProvided = true;
+
+        VkPipelineDepthStencilStateCreateInfo ds{};
+        ds.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+        ds.depthTestEnable = VK_TRUE;
+        ds.depthWriteEnable = VK_FALSE;
+        ds.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+        ds.depthBoundsTestEnable = VK_FALSE;
+        ds.stencilTestEnable = VK_FALSE;
+        pci.depthStencil = ds;
+        pci.depthStencilProvided = true;
+
+        // Additive (premultiplied by the shader): the result does not depend on draw order.
+        VkPipelineColorBlendAttachmentState att{};
+        att.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+                             VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+        att.blendEnable = VK_TRUE;
+        att.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+        att.dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
+        att.colorBlendOp = VK_BLEND_OP_ADD;
+        att.srcAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+        att.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+        att.alphaBlendOp = VK_BLEND_OP_ADD;
+
+        VkPipelineColorBlendStateCreateInfo cb{};
+        cb.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+        cb.logicOpEnable = VK_FALSE;
+        cb.attachmentCount = 1;
+        cb.pAttachments = &att;
+        pci.colorBlend = cb;
+        pci.colorBlendProvided = true;
+
+        pci.dynamicStates = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+
+        const VkResult r = m_pipeline.create(pci);
+
+        vkDestroyShaderModule(pci.device, vert, nullptr);
+        vkDestroyShaderModule(pci.device, frag, nullptr);
+
+        if (r != VK_SUCCESS)
+            throw std::runtime_error("failed to create particle pipeline");
+    }
+
+    void ParticleRenderPassModule::writeEffects(FrameData &frame) const
+    {
+        GpuEffect effects[PARTICLE_EFFECT_COUNT];
+        for (uint32_t i = 0; i < PARTICLE_EFFECT_COUNT; ++i)
+        {
+            const EffectDesc &d = m_effects[i];
+            effects[i].colorStart = d.colorStart;
+            effects[i].colorEnd = d.colorEnd;
+            effects[i].motion = glm::vec4(d.speedMin, d.speedMax, std::clamp(d.spread, 0.0f, 1.0f), d.lift);
+            effects[i].life = glm::vec4(d.lifeMin, std::max(d.lifeMax, d.lifeMin), d.sizeStart, d.sizeEnd);
+            effects[i].forces = glm::vec4(d.gravity, std::max(d.drag, 0.0f), 0.0f, 0.0f);
+        }
+        std::memcpy(static_cast<uint8_t *>(frame.uniformMemory.mapped) + offsetof(FrameUBO, effects), effects, sizeof(effects));
+    }
+
+    uint32_t ParticleRenderPassModule::drainSpawns(FrameData &frame)
+    {
+        m_bursts.clear();
+        uint32_t total = 0;
+
+        // False when the frame's budget is used up; the burst then waits for the next frame.
+        auto take = [&](const ParticleSpawn &s) -> bool
+        {
+            const uint32_t effect = static_cast<uint32_t>(s.effect);
+            if (effect >= PARTICLE_EFFECT_COUNT)
+                return true;
+            const EffectDesc &desc = m_effects[effect];
+            const uint32_t count = std::min<uint32_t>(s.count != 0 ? s.count : desc.defaultCount, MAX_PARTICLES_PER_BURST);
+            if (count == 0)
+                return true;
+            if (m_bursts.size() >= MAX_BURSTS_PER_FRAME || total + count > MAX_EMIT_PER_FRAME)
+                return false;
+
+            GpuBurst b{};
+            b.position = glm::vec4(s.position, s.ground);
+            b.direction = glm::vec4(s.direction, std::max(s.scale, 0.01f));
+            b.info = glm::uvec4(effect, total, count, hashSeed(++m_seed));
+            m_bursts.push_back(b);
+            total += count;
+            m_aliveUntil = std::max(m_aliveUntil, m_time + std::max(desc.lifeMax, desc.lifeMin));
+            return true;
+        };
+
+        if (m_pendingSpawn && take(m_pending))
+            m_pendingSpawn = false;
+
+        ParticleSpawn s;
+        while (!m_pendingSpawn && m_ring.pop(s))
+        {
+            if (!take(s))
+            {
+                m_pending = s;
+                m_pendingSpawn = true;
+            }
+        }
+
+        if (!m_bursts.empty())
+            std::memcpy(frame.burstMemory.mapped, m_bursts.data(), m_bursts.size() * sizeof(GpuBurst));
+
+        m_stats.bursts = static_cast<uint32_t>(m_bursts.size());
+        m_stats.emitted = total;
+        m_stats.deferred = m_pendingSpawn;
+        return total;
+    }
+
+    void ParticleRenderPassModule::recordPrePass(FrameContext &frameCtx, VkCommandBuffer cmd)
+    {
+        m_stats.bursts = 0;
+        m_stats.emitted = 0;
+        m_stats.simulated = 0;
+        m_stats.ringDropped = m_ring.dropped();
+
+        if (m_frames.empty())
+            return;
+        FrameData &frame = m_frames[frameCtx.frameIndex % static_cast<uint32_t>(m_frames.size())];
+        frame.draw = false;
+
+        const auto now = std::chrono::steady_clock::now();
+        float dt = m_haveLastFrame ? std::chrono::duration<float>(now - m_lastFrame).count() : 0.0f;
+        dt = std::clamp(dt, 0.0f, MAX_STEP_SECONDS);
+        m_lastFrame = now;
+        m_haveLastFrame = true;
+        m_time += dt;
+
+        if (!m_enabled || !m_ready)
+        {
+            ParticleSpawn discard;
+            while (m_ring.pop(discard))
+            {
+            }
+            m_pendingSpawn = false;
+            return;
+        }
+
+        writeEffects(frame);
+        const uint32_t emitCount = drainSpawns(frame);
+        if (emitCount == 0 && m_time > m_aliveUntil)
+            return; // every particle expired: no dispatch, no draw
+
+        // Last frame's draw read the pool and the command; its dispatches wrote them.
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+        // Six vertices per living particle; the update pass counts the instances.
+        const VkDrawIndirectCommand reset{6u, 0u, 0u, 0u};
+        vkCmdUpdateBuffer(cmd, m_indirectBuffer, 0, sizeof(reset), &reset);
+
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_computeLayout, 0, 1, &frame.set, 0, nullptr);
+
+        ComputePush push{};
+        push.dt = dt;
+        push.time = m_time;
+
+        if (emitCount > 0)
+        {
+            push.emitBase = m_emitCursor;
+            push.emitCount = emitCount;
+            push.burstCount = static_cast<uint32_t>(m_bursts.size());
+            vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_emitPipeline);
+            vkCmdPushConstants(cmd, m_computeLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(push), &push);
+            vkCmdDispatch(cmd, (emitCount + LOCAL_SIZE - 1u) / LOCAL_SIZE, 1, 1);
+
+            barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+            vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+            m_emitCursor = (m_emitCursor + emitCount) & (MAX_PARTICLES - 1u);
+            m_usedParticles = std::min(MAX_PARTICLES, m_usedParticles + emitCount);
+        }
+
+        // Only the part of the pool that was ever written can hold living particles.
+        push.simulateCount = m_usedParticles;
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_updatePipeline);
+        vkCmdPushConstants(cmd, m_computeLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(push), &push);
+        vkCmdDispatch(cmd, (m_usedParticles + LOCAL_SIZE - 1u) / LOCAL_SIZE, 1, 1);
+
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+                             0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+        m_stats.simulated = m_usedParticles;
+        frame.draw = true;
+    }
+
+    void ParticleRenderPassModule::latchCamera(FrameContext &frameCtx)
+    {
+        if (m_frames.empty() || !m_enabled || !m_camera)
+            return;
+
+        // Camera part only: recordPrePass() wrote the effect table behind it.
+        FrameData &frame = m_frames[frameCtx.frameIndex % static_cast<uint32_t>(m_frames.size())];
+        const glm::mat4 matrices[2] = {m_camera->GetViewMatrix(), m_camera->GetProjectionMatrix()};
+        std::memcpy(frame.uniformMemory.mapped, matrices, sizeof(matrices));
+    }
+
+    void ParticleRenderPassModule::record(FrameContext &frameCtx, VkCommandBuffer cmd)
+    {
+        recordPhase(frameCtx, cmd, RenderPhase::Blend);
+    }
+
+    void ParticleRenderPassModule::recordPhase(FrameContext &frameCtx, VkCommandBuffer cmd, RenderPhase phase)
+    {
+        if (phase != RenderPhase::Blend || !m_ready || m_frames.empty() || !m_camera)
+            return;
+
+        const FrameData &frame = m_frames[frameCtx.frameIndex % static_cast<uint32_t>(m_frames.size())];
+        if (!frame.draw)
+            return;
+
+        const VkExtent2D ext = frameCtx.renderExtent;
+        VkViewport vp{0.0f, 0.0f, static_cast<float>(ext.width), static_cast<float>(ext.height), 0.0f, 1.0f};
+        VkRect2D sc{{0, 0}, ext};
+        vkCmdSetViewport(cmd, 0, 1, &vp);
+        vkCmdSetScissor(cmd, 0, 1, &sc);
+
+        m_pipeline.bind(cmd);
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 0, 1, &frame.set, 0, nullptr);
+
+        // One quad instance per living particle, counted on the GPU.
+        vkCmdDrawIndirect(cmd, m_indirectBuffer, 0, 1, sizeof(VkDrawIndirectCommand));
+        DrawCallCounter::increment();
+    }
+
+    void ParticleRenderPassModule::reportMemory(MemoryReport &out) const
+    {
+        uint64_t frameBytes = 0;
+        for (const FrameData &f : m_frames)
+            frameBytes += f.uniformMemory.size + f.burstMemory.size;
+
+        const uint64_t cpuBytes = m_ring.memoryBytes() + MemoryReport::bytesOf(m_bursts);
+        out.add("Render", "Particles", cpuBytes,
+                m_particleMemory.size + m_aliveMemory.size + m_indirectMemory.size + frameBytes, MAX_PARTICLES);
+    }
+}
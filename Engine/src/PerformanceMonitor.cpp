@@ -1,7 +1,15 @@
 #include "Engine/PerformanceMonitor.h"
 #include "Engine/VulkanContext.h"
 #include "Engine/Renderer.h"
+#include "Engine/SwapChain.h"
 #include "Engine/Window.h"
+#include "utils/AllocationCounter.h"
+#include "utils/DeviceMemoryBudget.h"
+#include "utils/FrameArena.h"
+#include "utils/GpuAllocator.h"
+#include "utils/JobSystem.h"
+#include "ECS/ECSContext.h"
+#include "ECS/SystemScheduler.h"
 
 #include <imgui.h>
 #include <algorithm>
@@ -12,10 +20,9 @@
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <thread>
 
-#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
-#include "ECS/ECSContext.h"
-#endif
+#include <nlohmann/json.hpp>
 
 #ifdef _WIN32
 #define NOMINMAX
@@ -85,6 +92,10 @@ namespace Engine
         m_window = window;
         m_initialized = true;
         m_frameTimeHistory.clear();
+        m_frameStats = FrameTimeStats{};
+        m_hitches.clear();
+        m_frameIndex = 0;
+        m_initTime = Clock::now();
 
         querySystemInfo(); // GPU name, total VRAM, DXGI adapter, initial CPU times
     }
@@ -122,18 +133,7 @@ namespace Engine
         m_vramTotalMB = static_cast<float>(totalDeviceLocal) / (1024.0f * 1024.0f);
 
         // --- Check VK_EXT_memory_budget support ---
-        uint32_t extCount = 0;
-        vkEnumerateDeviceExtensionProperties(m_ctx->GetPhysicalDevice(), nullptr, &extCount, nullptr);
-        std::vector<VkExtensionProperties> exts(extCount);
-        vkEnumerateDeviceExtensionProperties(m_ctx->GetPhysicalDevice(), nullptr, &extCount, exts.data());
-        for (const auto &ext : exts)
-        {
-            if (std::strcmp(ext.extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0)
-            {
-                m_hasMemoryBudget = true;
-                break;
-            }
-        }
+        m_hasMemoryBudget = HasMemoryBudgetExtension(m_ctx->GetPhysicalDevice());
         if (m_hasMemoryBudget)
         {
 #if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
@@ -184,28 +184,9 @@ namespace Engine
         if (!m_ctx || !m_hasMemoryBudget)
             return;
 
-        VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProps{};
-        budgetProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
-
-        VkPhysicalDeviceMemoryProperties2 memProps2{};
-        memProps2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
-        memProps2.pNext = &budgetProps;
-
-        vkGetPhysicalDeviceMemoryProperties2(m_ctx->GetPhysicalDevice(), &memProps2);
-
-        // Sum device-local heaps
-        VkDeviceSize totalBudget = 0;
-        VkDeviceSize totalUsage = 0;
-        for (uint32_t i = 0; i < memProps2.memoryProperties.memoryHeapCount; i++)
-        {
-            if (memProps2.memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
-            {
-                totalBudget += budgetProps.heapBudget[i];
-                totalUsage += budgetProps.heapUsage[i];
-            }
-        }
+        const DeviceMemoryBudget budget = QueryDeviceLocalBudget(m_ctx->GetPhysicalDevice(), true);
 
-        m_vramUsedMB = static_cast<float>(totalUsage) / (1024.0f * 1024.0f);
+        m_vramUsedMB = static_cast<float>(budget.usage) / (1024.0f * 1024.0f);
         // Keep m_vramTotalMB as the physical GPU VRAM (set once in querySystemInfo)
     }
 
@@ -376,6 +357,14 @@ namespace Engine
         // CPU time is the time spent between beginFrame and endFrame
         m_cpuTimeMs = std::chrono::duration<float, std::milli>(now - m_frameStart).count();
 
+        // Compare against the median of the frames before this one
+        ++m_frameIndex;
+        if (m_frameTimeHistory.size() >= HITCH_MIN_HISTORY && m_frameStats.p50Ms > 0.0f &&
+            frameTimeMs > HITCH_FACTOR * m_frameStats.p50Ms)
+        {
+            captureHitch(frameTimeMs);
+        }
+
         // Store frame time in history
         m_frameTimeHistory.push_back(frameTimeMs);
         if (m_frameTimeHistory.size() > HISTORY_SIZE)
@@ -386,6 +375,19 @@ namespace Engine
         // Get draw call count from global counter
         m_lastFrameDrawCalls = DrawCallCounter::get();
 
+        const uint64_t allocTotal = AllocationCounter::total();
+        m_frameAllocations = allocTotal - m_allocTotalAtFrameEnd;
+        m_allocTotalAtFrameEnd = allocTotal;
+#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
+        if (m_allocationCheck && m_frameAllocations > 0u && m_frameTimeHistory.size() >= HITCH_MIN_HISTORY &&
+            now - m_lastAllocWarning >= std::chrono::seconds(1))
+        {
+            m_lastAllocWarning = now;
+            std::cout << "[PerformanceMonitor] frame " << m_frameIndex << " made " << m_frameAllocations
+                      << " heap allocation(s); use FrameArena/FrameVector or persistent scratch\n";
+        }
+#endif
+
         // Get GPU time from renderer if available
         if (m_renderer)
         {
@@ -409,10 +411,13 @@ namespace Engine
         }
 
         // Update system metrics less frequently (500ms) to reduce overhead
+        ++m_framesSinceJobSample;
         m_sysUpdateTimer += frameTimeMs / 1000.0f;
         if (m_sysUpdateTimer >= SYS_UPDATE_INTERVAL)
         {
             updateSystemMetrics();
+            updateJobMetrics();
+            updateMemoryReport();
 
             // Smooth VRAM and CPU % so the overlay doesn't jump around
             m_smoothedVramUsedMB = EMA_SMOOTHING_FACTOR * m_vramUsedMB +
@@ -422,6 +427,9 @@ namespace Engine
             m_sysUpdateTimer = 0.0f;
         }
 
+        if (m_telemetry)
+            sampleTelemetryFrame(frameTimeMs);
+
         m_frameTimeMs = frameTimeMs;
     }
 
@@ -456,7 +464,244 @@ namespace Engine
         float avgFrameTime = totalTime / static_cast<float>(m_frameTimeHistory.size());
         m_avgFPS = (avgFrameTime > 0.0f) ? (1000.0f / avgFrameTime) : 0.0f;
 
-        // Calculate percentile FPS
+        // Percentiles (nearest rank) over a sorted copy; 300 floats, every 100ms.
+        m_sortScratch.assign(m_frameTimeHistory.begin(), m_frameTimeHistory.end());
+        std::sort(m_sortScratch.begin(), m_sortScratch.end());
+        const size_t n = m_sortScratch.size();
+        auto percentile = [&](float p)
+        {
+            const size_t rank = static_cast<size_t>(std::ceil(p * static_cast<float>(n)));
+            return m_sortScratch[std::min(n, std::max<size_t>(rank, 1)) - 1];
+        };
+        m_frameStats.p50Ms = percentile(0.50f);
+        m_frameStats.p95Ms = percentile(0.95f);
+        m_frameStats.p99Ms = percentile(0.99f);
+        m_frameStats.maxMs = m_sortScratch.back();
+        m_frameStats.samples = static_cast<uint32_t>(n);
+
+        // 1% low: the mean of the slowest 1% of frames (at least one), as FPS.
+        const size_t worst = std::max<size_t>(n / 100, 1);
+        const float worstSum = std::accumulate(m_sortScratch.end() - static_cast<std::ptrdiff_t>(worst),
+                                               m_sortScratch.end(), 0.0f);
+        const float worstMean = worstSum / static_cast<float>(worst);
+        m_frameStats.onePercentLowFps = (worstMean > 0.0f) ? (1000.0f / worstMean) : 0.0f;
+    }
+
+    void PerformanceMonitor::updateJobMetrics()
+    {
+        if (!m_jobs)
+            return;
+
+        const JobSystem::Metrics m = m_jobs->takeMetrics();
+        const uint32_t frames = std::max(1u, m_framesSinceJobSample);
+        m_framesSinceJobSample = 0;
+        if (m.windowNs == 0)
+            return;
+
+        const float window = static_cast<float>(m.windowNs);
+        auto percent = [&](uint64_t ns)
+        { return 100.0f * static_cast<float>(ns) / window; };
+
+        m_jobUtilization.threads.resize(m.threads.size());
+        for (size_t i = 0; i < m.threads.size(); ++i)
+        {
+            const JobSystem::ThreadMetrics &t = m.threads[i];
+            JobUtilization::Thread &out = m_jobUtilization.threads[i];
+            out.busyPercent = percent(t.busyNs);
+            out.spinPercent = percent(t.spinNs);
+            out.sleepPercent = percent(t.sleepNs);
+            out.waitPercent = percent(t.waitNs);
+            out.jobs = t.jobs;
+            out.steals = t.steals;
+        }
+
+        m_jobUtilization.loops.clear();
+        m_jobUtilization.loops.reserve(m.loops.size());
+        for (const JobSystem::LoopMetrics &l : m.loops)
+        {
+            JobUtilization::Loop out;
+            out.name = l.name ? l.name : "(no zone)";
+            out.calls = l.calls;
+            out.inlineCalls = l.inlineCalls;
+            out.items = l.items;
+            out.serialFraction = l.serialFraction();
+            out.wallMsPerFrame = static_cast<float>(l.wallNs) / 1000000.0f / static_cast<float>(frames);
+            m_jobUtilization.loops.push_back(std::move(out));
+        }
+        std::sort(m_jobUtilization.loops.begin(), m_jobUtilization.loops.end(),
+                  [](const JobUtilization::Loop &a, const JobUtilization::Loop &b)
+                  { return a.wallMsPerFrame > b.wallMsPerFrame; });
+    }
+
+    void PerformanceMonitor::updateMemoryReport()
+    {
+        m_memoryReport.clear();
+
+        if (m_ecs)
+        {
+            // Columns occupy capacity x size bytes of every chunk of their store, filled or not.
+            uint64_t chunkBytes = 0;
+            uint64_t columnBytes = 0;
+            for (const auto &store : m_ecs->stores.stores())
+            {
+                if (!store)
+                    continue;
+                const uint64_t rows = static_cast<uint64_t>(store->chunkCount()) * store->chunkCapacity();
+                chunkBytes += static_cast<uint64_t>(store->chunkCount()) * ECS::ChunkPool::CHUNK_BYTES;
+                for (const ECS::ComponentColumn &column : store->columns())
+                {
+                    const uint64_t bytes = rows * column.type().size;
+                    columnBytes += bytes;
+                    m_memoryReport.add("ECS", m_ecs->components.getName(column.componentId()), bytes, 0, store->size());
+                }
+                m_memoryReport.add("ECS", "Store entity lists", MemoryReport::bytesOf(store->entities()), 0, store->size());
+            }
+            // Chunk headers (change versions) and the tail a chunk's columns don't fill.
+            m_memoryReport.add("ECS", "Chunk headers/padding", chunkBytes > columnBytes ? chunkBytes - columnBytes : 0, 0);
+
+            const ECS::ChunkPool::Stats &pool = m_ecs->stores.chunkPool().stats();
+            m_memoryReport.add("ECS", "Free chunks (pooled)", static_cast<uint64_t>(pool.free) * ECS::ChunkPool::CHUNK_BYTES, 0, pool.free);
+            m_memoryReport.add("ECS", "Entity records", m_ecs->entities.memoryBytes(), 0, m_ecs->entities.aliveCount());
+        }
+
+        for (const MemoryProvider &provider : m_memoryProviders)
+            provider(m_memoryReport);
+
+        // What the allocator hands out but nobody above claimed (swapchain-adjacent targets,
+        // pipelines' helper buffers, ...), and block space not handed out at all.
+        if (m_ctx)
+        {
+            if (const GpuAllocator *alloc = GpuAllocator::forDevice(m_ctx->GetDevice()))
+            {
+                const GpuAllocator::Stats st = alloc->stats();
+                const uint64_t attributed = m_memoryReport.totalGpuBytes();
+                const uint64_t used = static_cast<uint64_t>(st.usedBytes);
+                m_memoryReport.add("GPU", "Unattributed", 0, used > attributed ? used - attributed : 0, st.subAllocations);
+                m_memoryReport.add("GPU", "Reserved, unused", 0,
+                                   st.reservedBytes > st.usedBytes ? static_cast<uint64_t>(st.reservedBytes - st.usedBytes) : 0,
+                                   st.deviceAllocations);
+            }
+        }
+    }
+
+    void PerformanceMonitor::captureHitch(float frameTimeMs)
+    {
+        HitchSnapshot h;
+        h.frameIndex = m_frameIndex;
+        h.timeSec = std::chrono::duration<float>(Clock::now() - m_initTime).count();
+        h.frameMs = frameTimeMs;
+        h.medianMs = m_frameStats.p50Ms;
+        h.cpuMs = m_cpuTimeMs;
+        h.drawCalls = DrawCallCounter::get();
+
+        if (m_renderer)
+        {
+            h.gpuMs = m_renderer->getGpuTimeMs();
+            const auto &cpuPasses = m_renderer->getCpuPassTimings();
+            const auto &gpuPasses = m_renderer->getGpuPassTimings();
+            h.passes.reserve(cpuPasses.size());
+            for (size_t i = 0; i < cpuPasses.size(); ++i)
+            {
+                HitchSnapshot::Timing t;
+                t.name = cpuPasses[i].name ? cpuPasses[i].name : "";
+                t.cpuMs = cpuPasses[i].recordMs;
+                if (i < gpuPasses.size())
+                    t.gpuMs = gpuPasses[i].prePassMs + gpuPasses[i].recordMs;
+                h.passes.push_back(std::move(t));
+            }
+        }
+
+#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
+        if (m_ecs)
+        {
+            for (const auto &ev : m_ecs->trace.snapshotEvents())
+            {
+                HitchSnapshot::Timing t;
+                t.name = ev.name;
+                t.cpuMs = ev.ms;
+                h.systems.push_back(std::move(t));
+            }
+        }
+#endif
+
+        m_hitches.push_back(std::move(h));
+        if (m_hitches.size() > MAX_HITCHES)
+            m_hitches.pop_front();
+
+        if (m_telemetry)
+            emitTelemetryHitch(m_hitches.back());
+    }
+
+    bool PerformanceMonitor::exportHitchesCsv(const std::string &path) const
+    {
+        std::ofstream out(path, std::ios::trunc);
+        if (!out)
+            return false;
+
+        out << "frame,timeSec,frameMs,medianMs,cpuMs,gpuMs,drawCalls,kind,name,itemCpuMs,itemGpuMs\n";
+        for (const HitchSnapshot &h : m_hitches)
+        {
+            std::ostringstream frame;
+            frame << h.frameIndex << ',' << h.timeSec << ',' << h.frameMs << ',' << h.medianMs << ','
+                  << h.cpuMs << ',' << h.gpuMs << ',' << h.drawCalls;
+            // Pass/system names are identifiers, no commas or quotes to escape.
+            auto rows = [&](const char *kind, const std::vector<HitchSnapshot::Timing> &items)
+            {
+                for (const HitchSnapshot::Timing &t : items)
+                    out << frame.str() << ',' << kind << ',' << t.name << ',' << t.cpuMs << ',' << t.gpuMs << '\n';
+            };
+            if (h.passes.empty() && h.systems.empty())
+                out << frame.str() << ",frame,,,\n";
+            rows("pass", h.passes);
+            rows("system", h.systems);
+        }
+        return static_cast<bool>(out);
+    }
+
+    bool PerformanceMonitor::exportHitchesJson(const std::string &path) const
+    {
+        std::ofstream out(path, std::ios::trunc);
+        if (!out)
+            return false;
+
+        auto timings = [](const std::vector<HitchSnapshot::Timing> &items, bool gpu)
+        {
+            nlohmann::json arr = nlohmann::json::array();
+            for (const HitchSnapshot::Timing &t : items)
+            {
+                nlohmann::json j = {{"name", t.name}, {"cpuMs", t.cpuMs}};
+                if (gpu)
+                    j["gpuMs"] = t.gpuMs;
+                arr.push_back(std::move(j));
+            }
+            return arr;
+        };
+
+        nlohmann::json hitches = nlohmann::json::array();
+        for (const HitchSnapshot &h : m_hitches)
+        {
+            hitches.push_back({{"frame", h.frameIndex},
+                               {"timeSec", h.timeSec},
+                               {"frameMs", h.frameMs},
+                               {"medianMs", h.medianMs},
+                               {"cpuMs", h.cpuMs},
+                               {"gpuMs", h.gpuMs},
+                               {"drawCalls", h.drawCalls},
+                               {"passes", timings(h.passes, true)},
+                               {"systems", timings(h.systems, false)}});
+        }
+
+        const nlohmann::json doc = {{"hitchFactor", HITCH_FACTOR},
+                                    {"stats",
+                                     {{"p50Ms", m_frameStats.p50Ms},
+                                      {"p95Ms", m_frameStats.p95Ms},
+                                      {"p99Ms", m_frameStats.p99Ms},
+                                      {"maxMs", m_frameStats.maxMs},
+                                      {"onePercentLowFps", m_frameStats.onePercentLowFps},
+                                      {"samples", m_frameStats.samples}}},
+                                    {"hitches", std::move(hitches)}};
+        out << doc.dump(2) << '\n';
+        return static_cast<bool>(out);
     }
 
     uint32_t PerformanceMonitor::getResolutionWidth() const
@@ -473,6 +718,248 @@ namespace Engine
         return 0;
     }
 
+    // -----------------------------------------------------------------------
+    // Telemetry
+    // -----------------------------------------------------------------------
+    bool PerformanceMonitor::enableTelemetry(const TelemetryConfig &config)
+    {
+        auto sink = std::make_unique<TelemetrySink>();
+        if (!sink->open(config))
+        {
+#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
+            std::cerr << "[PerformanceMonitor] Telemetry transport failed to open\n";
+#endif
+            return false;
+        }
+        m_telemetry = std::move(sink);
+        m_telemetryFrameMs.clear();
+        m_telemetryFrameMs.reserve(static_cast<size_t>(m_telemetry->config().intervalSec * 240.0f));
+        m_telemetryTimer = 0.0f;
+        m_telemetrySessionTimer = TELEMETRY_SESSION_INTERVAL; // first frame, once schedulers are added
+#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
+        std::cout << "[PerformanceMonitor] Telemetry session " << std::hex << m_telemetry->sessionId() << std::dec
+                  << (m_telemetry->sampled() ? "" : " (not sampled)") << "\n";
+#endif
+        return true;
+    }
+
+    void PerformanceMonitor::disableTelemetry()
+    {
+        m_telemetry.reset(); // close() flushes what is batched
+    }
+
+    void PerformanceMonitor::addTelemetryScheduler(const ECS::SystemScheduler *scheduler, const std::string &label)
+    {
+        if (!scheduler)
+            return;
+        TelemetryScheduler t;
+        t.scheduler = scheduler;
+        t.label = label;
+        m_telemetrySchedulers.push_back(std::move(t));
+    }
+
+    uint32_t PerformanceMonitor::telemetryTimeMs() const
+    {
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - m_initTime).count());
+    }
+
+    void PerformanceMonitor::sampleTelemetryFrame(float frameTimeMs)
+    {
+        if (m_telemetrySessionTimer >= TELEMETRY_SESSION_INTERVAL)
+        {
+            emitTelemetrySession();
+            m_telemetry->flush();
+            m_telemetrySessionTimer = 0.0f;
+        }
+
+        if (m_telemetryFrameMs.size() < m_telemetryFrameMs.capacity())
+            m_telemetryFrameMs.push_back(frameTimeMs); // beyond ~240 fps the tail of the interval is dropped
+        m_telemetryCpuMs += m_cpuTimeMs;
+        m_telemetryGpuMs += m_gpuTimeMs;
+        m_telemetryDrawCalls += m_lastFrameDrawCalls;
+        m_telemetryAllocations += m_frameAllocations;
+
+        for (TelemetryScheduler &t : m_telemetrySchedulers)
+        {
+            const uint32_t n = t.scheduler->systemCount();
+            if (t.sumMs.size() != n)
+            {
+                t.sumMs.assign(n, 0.0f);
+                t.maxMs.assign(n, 0.0f);
+                t.samples = 0;
+            }
+            for (uint32_t i = 0; i < n; ++i)
+            {
+                const float ms = t.scheduler->systemLastMs(i);
+                t.sumMs[i] += ms;
+                t.maxMs[i] = std::max(t.maxMs[i], ms);
+            }
+            ++t.samples;
+        }
+
+        const float dt = frameTimeMs / 1000.0f;
+        m_telemetryTimer += dt;
+        m_telemetrySessionTimer += dt;
+        if (m_telemetryTimer >= m_telemetry->config().intervalSec)
+        {
+            emitTelemetry();
+            m_telemetryTimer = 0.0f;
+        }
+    }
+
+    void PerformanceMonitor::emitTelemetrySession()
+    {
+        TelemetrySink &sink = *m_telemetry;
+        sink.beginPacket(TelemetryPacket::Session, telemetryTimeMs());
+        sink.putString(m_gpuName);
+        sink.putF32(m_vramTotalMB);
+        sink.putU32(std::thread::hardware_concurrency());
+        sink.putU32(getResolutionWidth());
+        sink.putU32(getResolutionHeight());
+        sink.putU32(static_cast<uint32_t>(sink.config().intervalSec * 1000.0f));
+#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
+        sink.putU8(0);
+#else
+        sink.putU8(1); // production build
+#endif
+        sink.putU8(static_cast<uint8_t>(m_telemetrySchedulers.size()));
+        for (const TelemetryScheduler &t : m_telemetrySchedulers)
+            sink.putString(t.label);
+        sink.endPacket();
+    }
+
+    void PerformanceMonitor::emitTelemetry()
+    {
+        TelemetrySink &sink = *m_telemetry;
+        const uint32_t timeMs = telemetryTimeMs();
+
+        // Summary: percentiles of this interval's frames (nearest rank), not the overlay history.
+        std::vector<float> &ms = m_telemetryFrameMs;
+        const uint32_t frames = static_cast<uint32_t>(ms.size());
+        std::sort(ms.begin(), ms.end());
+        auto percentile = [&](float p)
+        {
+            if (ms.empty())
+                return 0.0f;
+            const size_t rank = static_cast<size_t>(std::ceil(p * static_cast<float>(ms.size())));
+            return ms[std::min(ms.size(), std::max<size_t>(rank, 1)) - 1];
+        };
+        const float total = std::accumulate(ms.begin(), ms.end(), 0.0f);
+        const size_t worst = std::min(std::max<size_t>(ms.size() / 100, 1), ms.size());
+        const float worstSum = std::accumulate(ms.end() - static_cast<std::ptrdiff_t>(worst), ms.end(), 0.0f);
+        const float perFrame = frames ? 1.0f / static_cast<float>(frames) : 0.0f;
+
+        sink.beginPacket(TelemetryPacket::Summary, timeMs);
+        sink.putU64(m_frameIndex);
+        sink.putU32(frames);
+        sink.putF32(percentile(0.50f));
+        sink.putF32(percentile(0.95f));
+        sink.putF32(percentile(0.99f));
+        sink.putF32(ms.empty() ? 0.0f : ms.back());
+        sink.putF32(worstSum > 0.0f ? 1000.0f * static_cast<float>(worst) / worstSum : 0.0f);
+        sink.putF32(total > 0.0f ? 1000.0f * static_cast<float>(frames) / total : 0.0f);
+        sink.putF32(static_cast<float>(m_telemetryCpuMs) * perFrame);
+        sink.putF32(static_cast<float>(m_telemetryGpuMs) * perFrame);
+        sink.putF32(static_cast<float>(m_telemetryDrawCalls) * perFrame);
+        sink.putF32(static_cast<float>(m_telemetryAllocations) * perFrame);
+        sink.putF32(m_vramUsedMB);
+        sink.putF32(m_vramTotalMB);
+        sink.putF32(m_ramUsedMB);
+        sink.putF32(m_cpuUsagePercent);
+        sink.putU32(m_telemetryHitches);
+        sink.endPacket();
+
+        // Systems: mean/max ms over the sampled frames, split so no packet overflows.
+        for (size_t s = 0; s < m_telemetrySchedulers.size(); ++s)
+        {
+            TelemetryScheduler &t = m_telemetrySchedulers[s];
+            const uint32_t n = static_cast<uint32_t>(t.sumMs.size());
+            const float inv = t.samples ? 1.0f / static_cast<float>(t.samples) : 0.0f;
+            uint32_t i = 0;
+            while (i < n)
+            {
+                // u8 scheduler, u16 first system, u16 count (patched below), then entries.
+                sink.beginPacket(TelemetryPacket::Systems, timeMs);
+                sink.putU8(static_cast<uint8_t>(s));
+                sink.putU16(static_cast<uint16_t>(i));
+                const size_t countAt = sink.packetSize();
+                sink.putU16(0);
+                uint16_t count = 0;
+                for (; i < n; ++i)
+                {
+                    const ECS::SystemBase *system = t.scheduler->systemAt(i);
+                    const std::string name = system ? system->name() : std::string();
+                    const size_t entry = 1 + std::min<size_t>(name.size(), 255u) + 2 * sizeof(float);
+                    if (entry > sink.remaining() && count > 0)
+                        break;
+                    sink.putString(name);
+                    sink.putF32(t.sumMs[i] * inv);
+                    sink.putF32(t.maxMs[i]);
+                    ++count;
+                }
+                sink.patchU16(countAt, count);
+                sink.endPacket();
+            }
+            std::fill(t.sumMs.begin(), t.sumMs.end(), 0.0f);
+            std::fill(t.maxMs.begin(), t.maxMs.end(), 0.0f);
+            t.samples = 0;
+        }
+
+        sink.flush();
+        ms.clear();
+        m_telemetryCpuMs = 0.0;
+        m_telemetryGpuMs = 0.0;
+        m_telemetryDrawCalls = 0;
+        m_telemetryAllocations = 0;
+        m_telemetryHitches = 0;
+    }
+
+    void PerformanceMonitor::emitTelemetryHitch(const HitchSnapshot &h)
+    {
+        TelemetrySink &sink = *m_telemetry;
+        if (m_telemetryHitches++ >= sink.config().maxHitchesPerInterval)
+            return; // still counted in the next Summary
+
+        // Heaviest items first; names are short identifiers, so 8 + 8 fit one packet.
+        auto heaviest = [](const std::vector<HitchSnapshot::Timing> &items)
+        {
+            std::vector<const HitchSnapshot::Timing *> out;
+            out.reserve(items.size());
+            for (const HitchSnapshot::Timing &t : items)
+                out.push_back(&t);
+            const size_t keep = std::min(out.size(), TELEMETRY_HITCH_ITEMS);
+            std::partial_sort(out.begin(), out.begin() + static_cast<std::ptrdiff_t>(keep), out.end(),
+                              [](const HitchSnapshot::Timing *a, const HitchSnapshot::Timing *b)
+                              { return a->cpuMs + a->gpuMs > b->cpuMs + b->gpuMs; });
+            out.resize(keep);
+            return out;
+        };
+
+        sink.beginPacket(TelemetryPacket::Hitch, telemetryTimeMs());
+        sink.putU64(h.frameIndex);
+        sink.putF32(h.frameMs);
+        sink.putF32(h.medianMs);
+        sink.putF32(h.cpuMs);
+        sink.putF32(h.gpuMs);
+        sink.putU32(h.drawCalls);
+        const auto passes = heaviest(h.passes);
+        sink.putU8(static_cast<uint8_t>(passes.size()));
+        for (const HitchSnapshot::Timing *t : passes)
+        {
+            sink.putString(t->name);
+            sink.putF32(t->cpuMs);
+            sink.putF32(t->gpuMs);
+        }
+        const auto systems = heaviest(h.systems);
+        sink.putU8(static_cast<uint8_t>(systems.size()));
+        for (const HitchSnapshot::Timing *t : systems)
+        {
+            sink.putString(t->name);
+            sink.putF32(t->cpuMs);
+        }
+        sink.endPacket();
+    }
+
     void PerformanceMonitor::renderOverlay()
     {
         if (!m_visible || !m_initialized)
@@ -555,6 +1042,21 @@ namespace Engine
                 ImGui::Text("  DrawFrame:  %.2f ms", m_frameTimeMs);
             }
 
+            if (m_frameStats.samples > 0)
+            {
+                ImGui::Text("  p50 %.2f  p95 %.2f  p99 %.2f  max %.2f ms",
+                            m_frameStats.p50Ms, m_frameStats.p95Ms, m_frameStats.p99Ms, m_frameStats.maxMs);
+                ImGui::Text("  1%% low: %.1f FPS", m_frameStats.onePercentLowFps);
+                if (!m_hitches.empty())
+                {
+                    const HitchSnapshot &last = m_hitches.back();
+                    ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 0.4f, 0.4f, 1.0f));
+                    ImGui::Text("  Hitches: %zu (last %.1f ms, frame %llu)", m_hitches.size(), last.frameMs,
+                                static_cast<unsigned long long>(last.frameIndex));
+                    ImGui::PopStyleColor();
+                }
+            }
+
             ImGui::Spacing();
 
             // --- VRAM Section ---
@@ -644,9 +1146,234 @@ namespace Engine
             ImGui::Text("Rendering");
             ImGui::PopStyleColor();
             ImGui::Text("  Draw Calls: %u", m_lastFrameDrawCalls);
+            if (AllocationCounter::enabled())
+            {
+                const FrameArena::Stats arena = FrameArena::stats();
+                ImGui::Text("  Heap allocs/frame: %llu", static_cast<unsigned long long>(m_frameAllocations));
+                ImGui::TextDisabled("    frame arenas %u, %.1f MB reserved, peak %.1f KB",
+                                    arena.arenas, static_cast<float>(arena.reservedBytes) / (1024.0f * 1024.0f),
+                                    static_cast<float>(arena.peakFrameBytes) / 1024.0f);
+                ImGui::Checkbox("  Warn on allocating frames", &m_allocationCheck);
+            }
 
             ImGui::Spacing();
 
+            // --- Job System Section ---
+            if (!m_jobUtilization.threads.empty())
+            {
+                ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 1.0f, 0.4f, 1.0f));
+                ImGui::Text("Jobs");
+                ImGui::PopStyleColor();
+
+                const size_t workers = m_jobUtilization.threads.size() - 1;
+                for (size_t i = 0; i < m_jobUtilization.threads.size(); ++i)
+                {
+                    const JobUtilization::Thread &t = m_jobUtilization.threads[i];
+                    if (i < workers)
+                        ImGui::Text("  W%-2zu busy %3.0f%%  spin %3.0f%%  sleep %3.0f%%  steals %llu",
+                                    i, t.busyPercent, t.spinPercent, t.sleepPercent,
+                                    static_cast<unsigned long long>(t.steals));
+                    else
+                        ImGui::Text("  Caller busy %3.0f%%  wait %3.0f%%", t.busyPercent, t.waitPercent);
+                }
+
+                // Top loops: a high serial share or mostly-inline calls point at a threshold to revisit.
+                const size_t shown = std::min<size_t>(m_jobUtilization.loops.size(), 6);
+                for (size_t i = 0; i < shown; ++i)
+                {
+                    const JobUtilization::Loop &l = m_jobUtilization.loops[i];
+                    ImGui::TextDisabled("  %-22s %5.2f ms  serial %3.0f%%  inline %llu/%llu",
+                                        l.name.c_str(), l.wallMsPerFrame, 100.0f * l.serialFraction,
+                                        static_cast<unsigned long long>(l.inlineCalls),
+                                        static_cast<unsigned long long>(l.calls));
+                }
+
+                ImGui::Spacing();
+            }
+
+            // --- Memory Section ---
+            const std::vector<MemoryReport::Entry> &memEntries = m_memoryReport.entries();
+            if (!memEntries.empty())
+            {
+                ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 1.0f, 0.4f, 1.0f));
+                ImGui::Text("Memory");
+                ImGui::PopStyleColor();
+
+                constexpr float MB = 1.0f / (1024.0f * 1024.0f);
+                ImGui::Text("  Tracked: CPU %.1f MB  GPU %.1f MB",
+                            static_cast<float>(m_memoryReport.totalCpuBytes()) * MB,
+                            static_cast<float>(m_memoryReport.totalGpuBytes()) * MB);
+
+                // One tree node per category, in first-reported order.
+                std::vector<std::string> categories;
+                for (const MemoryReport::Entry &e : memEntries)
+                    if (std::find(categories.begin(), categories.end(), e.category) == categories.end())
+                        categories.push_back(e.category);
+
+                std::vector<const MemoryReport::Entry *> sorted;
+                for (const std::string &category : categories)
+                {
+                    sorted.clear();
+                    uint64_t cpu = 0, gpu = 0;
+                    for (const MemoryReport::Entry &e : memEntries)
+                    {
+                        if (e.category != category)
+                            continue;
+                        sorted.push_back(&e);
+                        cpu += e.cpuBytes;
+                        gpu += e.gpuBytes;
+                    }
+
+                    const std::string label = "  " + category + "##mem";
+                    if (ImGui::TreeNode(label.c_str(), "%-10s CPU %7.2f MB  GPU %7.2f MB", category.c_str(),
+                                        static_cast<float>(cpu) * MB, static_cast<float>(gpu) * MB))
+                    {
+                        // Largest entries first; the tail of small columns isn't worth the lines.
+                        std::sort(sorted.begin(), sorted.end(), [](const MemoryReport::Entry *a, const MemoryReport::Entry *b)
+                                  { return a->cpuBytes + a->gpuBytes > b->cpuBytes + b->gpuBytes; });
+                        const size_t shown = std::min<size_t>(sorted.size(), 12);
+                        for (size_t k = 0; k < shown; ++k)
+                        {
+                            const MemoryReport::Entry &e = *sorted[k];
+                            ImGui::TextDisabled("%-26s %8.2f / %8.2f MB  x%u", e.name.c_str(),
+                                                static_cast<float>(e.cpuBytes) * MB,
+                                                static_cast<float>(e.gpuBytes) * MB, e.count);
+                        }
+                        if (sorted.size() > shown)
+                            ImGui::TextDisabled("(+%zu more)", sorted.size() - shown);
+                        ImGui::TreePop();
+                    }
+                }
+
+                ImGui::Spacing();
+            }
+
+            // --- Per-pass GPU Section ---
+            if (m_renderer && !m_renderer->getGpuPassTimings().empty())
+            {
+                ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 1.0f, 0.4f, 1.0f));
+                ImGui::Text("GPU Passes");
+                ImGui::PopStyleColor();
+
+                const bool stats = m_renderer->isPipelineStatisticsEnabled();
+                for (const Renderer::PassGpuTiming &pt : m_renderer->getGpuPassTimings())
+                {
+                    if (!pt.name || !pt.name[0])
+                        continue;
+                    ImGui::Text("  %-18s %6.2f ms", pt.name, pt.prePassMs + pt.recordMs);
+                    if (pt.prePassMs > 0.0f)
+                    {
+                        ImGui::SameLine();
+                        ImGui::TextDisabled("(pre %.2f)", pt.prePassMs);
+                    }
+                    if (stats)
+                    {
+                        ImGui::TextDisabled("    VS %llu  FS %llu  CS %llu",
+                                            static_cast<unsigned long long>(pt.vertexInvocations),
+                                            static_cast<unsigned long long>(pt.fragmentInvocations),
+                                            static_cast<unsigned long long>(pt.computeInvocations));
+                    }
+                }
+
+                if (m_renderer->isPipelineStatisticsSupported())
+                {
+                    bool enable = stats;
+                    if (ImGui::Checkbox("  Pipeline statistics", &enable))
+                        m_renderer->setPipelineStatistics(enable);
+                }
+
+                bool prepass = m_renderer->isDepthPrepass();
+                if (ImGui::Checkbox("  Depth prepass", &prepass))
+                    m_renderer->setDepthPrepass(prepass);
+
+                if (m_ctx && m_ctx->HasAsyncCompute())
+                {
+                    bool async = m_renderer->isAsyncComputeEnabled();
+                    if (ImGui::Checkbox("  Async compute", &async))
+                        m_renderer->setAsyncCompute(async);
+                    ImGui::SameLine();
+                    ImGui::TextDisabled("record+submit %.2f ms", m_renderer->getCpuFrameTimings().asyncComputeMs);
+                }
+
+                ImGui::Spacing();
+            }
+
+            if (m_renderer)
+            {
+                ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 1.0f, 0.4f, 1.0f));
+                ImGui::Text("Latency");
+                ImGui::PopStyleColor();
+
+                int frames = static_cast<int>(m_renderer->getFramesInFlight());
+                if (ImGui::SliderInt("  Frames in flight", &frames, 1, static_cast<int>(m_renderer->getMaxFramesInFlight())))
+                    m_renderer->setFramesInFlight(static_cast<uint32_t>(frames));
+
+                bool lowLatency = m_renderer->getLatencyMode() == LatencyMode::LowLatency;
+                if (ImGui::Checkbox("  Low latency", &lowLatency))
+                    m_renderer->setLatencyMode(lowLatency ? LatencyMode::LowLatency : LatencyMode::Throughput);
+
+                if (SwapChain *swapchain = m_ctx ? m_ctx->GetSwapChain() : nullptr)
+                {
+                    const char *modes[] = {"Auto", "On", "Off", "Adaptive"};
+                    int mode = static_cast<int>(swapchain->GetVSyncMode());
+                    if (ImGui::Combo("  VSync", &mode, modes, 4))
+                        swapchain->SetVSyncMode(static_cast<VSyncMode>(mode));
+
+                    const VkPresentModeKHR pm = swapchain->GetPresentMode();
+                    ImGui::SameLine();
+                    ImGui::TextDisabled("(%s)", pm == VK_PRESENT_MODE_MAILBOX_KHR        ? "MAILBOX"
+                                                : pm == VK_PRESENT_MODE_IMMEDIATE_KHR    ? "IMMEDIATE"
+                                                : pm == VK_PRESENT_MODE_FIFO_RELAXED_KHR ? "FIFO_RELAXED"
+                                                                                         : "FIFO");
+                }
+
+                float fpsCap = m_renderer->getFrameRateLimit();
+                if (ImGui::DragFloat("  FPS cap (0 = off)", &fpsCap, 1.0f, 0.0f, 500.0f, "%.0f"))
+                    m_renderer->setFrameRateLimit(fpsCap);
+
+                const Renderer::CpuFrameTimings &ct = m_renderer->getCpuFrameTimings();
+                ImGui::TextDisabled("  Cap %.2f ms  Latency wait %.2f ms%s  Fence %.2f ms  Latch %.2f ms",
+                                    ct.limiterWaitMs, ct.latencyWaitMs, m_renderer->isPresentWaitActive() ? " (present)" : "",
+                                    ct.waitFenceMs, ct.latchMs);
+                ImGui::Spacing();
+            }
+
+            if (m_renderer && m_renderer->isResolutionScalingSupported())
+            {
+                ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 1.0f, 0.4f, 1.0f));
+                ImGui::Text("Resolution");
+                ImGui::PopStyleColor();
+
+                bool dynamic = m_renderer->isDynamicResolution();
+                if (ImGui::Checkbox("  Dynamic resolution", &dynamic))
+                    m_renderer->setDynamicResolution(dynamic);
+
+                if (dynamic)
+                {
+                    DynamicResolution::Config cfg = m_renderer->getDynamicResolutionConfig();
+                    bool changed = ImGui::DragFloat("  GPU target (ms)", &cfg.targetGpuMs, 0.1f, 2.0f, 50.0f, "%.1f");
+                    changed |= ImGui::SliderFloat("  Min scale", &cfg.minScale, 0.25f, 1.0f, "%.2f");
+                    if (changed)
+                        m_renderer->setDynamicResolutionConfig(cfg);
+                }
+                else
+                {
+                    float scale = m_renderer->getRenderScale();
+                    if (ImGui::SliderFloat("  Render scale", &scale, 0.25f, 1.0f, "%.2f"))
+                        m_renderer->setRenderScale(scale);
+                }
+
+                float sharpness = m_renderer->getUpscaleSharpness();
+                if (ImGui::SliderFloat("  Sharpen", &sharpness, 0.0f, 1.0f, "%.2f"))
+                    m_renderer->setUpscaleSharpness(sharpness);
+
+                const VkExtent2D re = m_renderer->getRenderExtent();
+                const VkExtent2D oe = m_renderer->getExtent();
+                ImGui::TextDisabled("  %ux%u -> %ux%u (%.0f%%)", re.width, re.height, oe.width, oe.height,
+                                    m_renderer->getRenderScale() * 100.0f);
+                ImGui::Spacing();
+            }
+
             ImGui::Separator();
             ImGui::TextDisabled("Press F1 to toggle");
         }
@@ -3,9 +3,60 @@
 #include <stdexcept>
 #include <vector>
 #include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <unordered_map>
 
 namespace Engine
 {
+    namespace
+    {
+        // SPIR-V bytes keyed by the path the passes open them with ("shaders/x.spv").
+        std::mutex s_shaderFileMutex;
+        std::unordered_map<std::string, std::vector<char>> s_shaderFiles;
+
+        bool readBinaryFile(const std::string &path, std::vector<char> &out)
+        {
+            std::ifstream file(path, std::ios::binary | std::ios::ate);
+            if (!file.is_open())
+                return false;
+            const size_t size = static_cast<size_t>(file.tellg());
+            file.seekg(0);
+            out.resize(size);
+            file.read(out.data(), static_cast<std::streamsize>(size));
+            return static_cast<bool>(file);
+        }
+    }
+
+    uint32_t Pipeline::preloadShaderFiles(const std::string &directory)
+    {
+        std::error_code ec;
+        std::filesystem::directory_iterator it(directory, ec);
+        if (ec)
+            return 0;
+
+        uint32_t count = 0;
+        for (const auto &entry : it)
+        {
+            if (!entry.is_regular_file(ec) || entry.path().extension() != ".spv")
+                continue;
+            // Same spelling as the literal paths the passes pass in.
+            const std::string key = directory + "/" + entry.path().filename().string();
+            std::vector<char> bytes;
+            if (!readBinaryFile(entry.path().string(), bytes))
+                continue;
+            std::lock_guard<std::mutex> lock(s_shaderFileMutex);
+            s_shaderFiles[key] = std::move(bytes);
+            ++count;
+        }
+        return count;
+    }
+
+    void Pipeline::clearShaderFileCache()
+    {
+        std::lock_guard<std::mutex> lock(s_shaderFileMutex);
+        s_shaderFiles.clear();
+    }
     Pipeline::~Pipeline()
     {
         // Explicit destroy must be called by owner with the VkDevice.
@@ -14,16 +65,18 @@ namespace Engine
 
     VkShaderModule Pipeline::createShaderModuleFromFile(VkDevice device, const std::string &spvPath)
     {
-        std::ifstream file(spvPath, std::ios::binary | std::ios::ate);
-        if (!file.is_open())
+        // Kept in the cache: passes rebuild their pipelines (and modules) on swapchain resize.
+        std::vector<char> buffer;
+        {
+            std::lock_guard<std::mutex> lock(s_shaderFileMutex);
+            auto it = s_shaderFiles.find(spvPath);
+            if (it != s_shaderFiles.end())
+                buffer = it->second;
+        }
+        if (buffer.empty() && !readBinaryFile(spvPath, buffer))
         {
             throw std::runtime_error("Failed to open SPV file: " + spvPath);
         }
-        size_t size = (size_t)file.tellg();
-        file.seekg(0);
-        std::vector<char> buffer(size);
-        file.read(buffer.data(), size);
-        file.close();
 
         VkShaderModuleCreateInfo createInfo{};
         createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
@@ -226,4 +279,69 @@ namespace Engine
             vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline);
         }
     }
-}
\ No newline at end of file
+
+    void PipelineSpecialization::set(uint32_t constantId, uint32_t value)
+    {
+        for (const VkSpecializationMapEntry &e : m_entries)
+        {
+            if (e.constantID == constantId)
+            {
+                m_data[e.offset / sizeof(uint32_t)] = value;
+                return;
+            }
+        }
+        VkSpecializationMapEntry e{};
+        e.constantID = constantId;
+        e.offset = static_cast<uint32_t>(m_data.size() * sizeof(uint32_t));
+        e.size = sizeof(uint32_t);
+        m_entries.push_back(e);
+        m_data.push_back(value);
+    }
+
+    void PipelineSpecialization::clear()
+    {
+        m_entries.clear();
+        m_data.clear();
+    }
+
+    void PipelineSpecialization::apply(VkPipelineShaderStageCreateInfo &stage)
+    {
+        if (m_entries.empty())
+        {
+            stage.pSpecializationInfo = nullptr;
+            return;
+        }
+        m_info.mapEntryCount = static_cast<uint32_t>(m_entries.size());
+        m_info.pMapEntries = m_entries.data();
+        m_info.dataSize = m_data.size() * sizeof(uint32_t);
+        m_info.pData = m_data.data();
+        stage.pSpecializationInfo = &m_info;
+    }
+
+    VkResult PipelinePermutationCache::create(uint32_t key, const PipelineCreateInfo &info)
+    {
+        auto pipeline = std::make_unique<Pipeline>();
+        const VkResult r = pipeline->create(info);
+        if (r != VK_SUCCESS)
+            return r;
+
+        std::unique_ptr<Pipeline> &slot = m_pipelines[key];
+        if (slot)
+            slot->destroy(info.device);
+        slot = std::move(pipeline);
+        return VK_SUCCESS;
+    }
+
+    const Pipeline *PipelinePermutationCache::find(uint32_t key) const
+    {
+        auto it = m_pipelines.find(key);
+        return it != m_pipelines.end() ? it->second.get() : nullptr;
+    }
+
+    void PipelinePermutationCache::destroy(VkDevice device)
+    {
+        for (auto &kv : m_pipelines)
+            kv.second->destroy(device);
+        m_pipelines.clear();
+    }
+}
@@ -0,0 +1,444 @@
+#include "ECS/Prefab.h"
+
+#if !defined(ENGINE_HEADLESS) || !ENGINE_HEADLESS
+#include "assets/AssetManager.h"
+#endif
+
+#include <nlohmann/json.hpp>
+
+#include <iostream>
+
+namespace Engine::ECS
+{
+    namespace
+    {
+        using json = nlohmann::json;
+
+        float numberOr(const json &obj, const char *key, float fallback)
+        {
+            auto it = obj.find(key);
+            return (it != obj.end() && it->is_number()) ? it->get<float>() : fallback;
+        }
+
+        uint32_t uintOr(const json &obj, const char *key, uint32_t fallback)
+        {
+            auto it = obj.find(key);
+            return (it != obj.end() && it->is_number()) ? it->get<uint32_t>() : fallback;
+        }
+
+        // defaults[name] if it is an object, else nullptr.
+        const json *section(const json &defaults, const char *name)
+        {
+            auto it = defaults.find(name);
+            return (it != defaults.end() && it->is_object()) ? &*it : nullptr;
+        }
+    }
+
+#if !defined(ENGINE_HEADLESS) || !ENGINE_HEADLESS
+    bool renderBoundsFromModel(Engine::AssetManager &assets, Engine::ModelHandle handle, RenderBounds &rb)
+    {
+        Engine::ModelAsset *asset = assets.getModel(handle);
+        if (!asset || !asset->hasBounds)
+            return false;
+
+        const glm::vec3 bmin{asset->boundsMin[0], asset->boundsMin[1], asset->boundsMin[2]};
+        const glm::vec3 bmax{asset->boundsMax[0], asset->boundsMax[1], asset->boundsMax[2]};
+        rb.localCenter = (bmin + bmax) * 0.5f;
+
+        const glm::vec3 ext = (bmax - bmin) * 0.5f;
+        rb.localRadius = glm::length(ext);
+        if (!(rb.localRadius > 1e-5f) || !std::isfinite(rb.localRadius))
+            rb.localRadius = 1.0f;
+        return true;
+    }
+#endif
+
+    // assets == nullptr: headless, see the overload without an AssetManager. ENGINE_HEADLESS
+    // builds have no AssetManager and always take that path.
+    static Prefab loadPrefab(const std::string &jsonText,
+                             ComponentRegistry &registry,
+                             ArchetypeManager &archetypes,
+                             Engine::AssetManager *assets,
+                             bool streamModels)
+    {
+        Prefab p;
+
+        json root = json::parse(jsonText, nullptr, /*allow_exceptions=*/false);
+        if (root.is_discarded() || !root.is_object())
+        {
+            std::cerr << "[Prefab] Warning: invalid JSON\n";
+            root = json::object();
+        }
+
+        // Extract name
+        if (auto it = root.find("name"); it != root.end() && it->is_string())
+            p.name = it->get<std::string>();
+
+        // Extract components array
+        if (auto it = root.find("components"); it != root.end() && it->is_array())
+        {
+            std::vector<std::string> names;
+            for (const json &item : *it)
+            {
+                if (item.is_string())
+                    names.push_back(item.get<std::string>());
+            }
+            p.signature = buildSignatureFromNames(names, registry);
+        }
+
+        // Optional visuals: if a model is present, load it and apply a RenderModel default.
+        // JSON schema: "visual": { "model": "path", "yawOffsetDeg" | "yawOffsetRad": number }
+        if (const json *visual = section(root, "visual"))
+        {
+            auto itModel = visual->find("model");
+            const std::string modelPath = (itModel != visual->end() && itModel->is_string()) ? itModel->get<std::string>() : std::string{};
+            if (!modelPath.empty())
+            {
+                // Optional yaw offset (helps fix authored forward axis mismatches).
+                constexpr float kDegToRad = 3.14159265358979323846f / 180.0f;
+                const float yawOffsetRad = visual->contains("yawOffsetDeg") ? numberOr(*visual, "yawOffsetDeg", 0.0f) * kDegToRad
+                                                                            : numberOr(*visual, "yawOffsetRad", 0.0f);
+
+                Engine::ModelHandle h{};
+#if !defined(ENGINE_HEADLESS) || !ENGINE_HEADLESS
+                if (assets)
+                    h = streamModels ? assets->requestModel(modelPath) : assets->loadModel(modelPath);
+#else
+                (void)streamModels;
+#endif
+                if (h.isValid())
+                {
+                    const uint32_t rmId = registry.ensureId("RenderModel");
+                    p.signature.set(rmId);
+
+                    RenderModel rm{};
+                    rm.handle = h;
+                    rm.yawOffset = yawOffsetRad;
+                    p.defaults[rmId] = rm;
+                }
+                else if (assets)
+                {
+                    std::cerr << "[Prefab] Warning: Failed to load model mesh: " << modelPath << " for prefab " << p.name << "\n";
+                }
+
+                // Per-entity animation state. Headless loads keep it too: gameplay (combat,
+                // locomotion) drives it even when nothing is drawn. Static props never animate.
+                if ((h.isValid() || !assets) && !p.signature.has(registry.ensureId("StaticProp")))
+                {
+                    const uint32_t raId = registry.ensureId("RenderAnimation");
+                    p.signature.set(raId);
+
+                    RenderAnimation ra{};
+                    ra.clipIndex = 0;
+                    ra.playing = false;
+                    ra.loop = true;
+                    ra.speed = 1.0f;
+                    ra.timeSec = 0.0f;
+                    p.defaults[raId] = ra;
+                }
+            }
+        }
+
+        // If an entity can be rendered, ensure it also has a PosePalette so rendering can reuse cached transforms.
+        // (RenderSystem currently requires PosePalette.)
+        {
+            const uint32_t rmId = registry.ensureId("RenderModel");
+            const bool staticProp = p.signature.has(registry.ensureId("StaticProp"));
+            if (staticProp)
+            {
+                // StaticPropSystem draws these through an instanced pass: no pose, animation
+                // or CPU visibility, so drop anything the JSON listed for the skinned path.
+                for (const char *unused : {"RenderAnimation", "PosePalette", "VisibilityState", "RenderSlot"})
+                {
+                    const uint32_t id = registry.ensureId(unused);
+                    p.signature.clear(id);
+                    p.defaults.erase(id);
+                }
+            }
+            if (p.signature.has(rmId))
+            {
+                if (!staticProp)
+                {
+                    const uint32_t ppId = registry.ensureId("PosePalette");
+                    p.signature.set(ppId);
+                    if (p.defaults.find(ppId) == p.defaults.end())
+                        p.defaults.emplace(ppId, PosePalette{});
+                }
+
+                // Render-side transform cache (world matrix + version).
+                const uint32_t rtId = registry.ensureId("RenderTransform");
+                p.signature.set(rtId);
+                if (p.defaults.find(rtId) == p.defaults.end())
+                    p.defaults.emplace(rtId, RenderTransform{});
+
+                // Per-entity render scale (defaults to 1.0).
+                const uint32_t rsId = registry.ensureId("RenderScale");
+                p.signature.set(rsId);
+                if (p.defaults.find(rsId) == p.defaults.end())
+                    p.defaults.emplace(rsId, RenderScale{});
+
+                if (!staticProp)
+                {
+                    // Visibility runtime state.
+                    const uint32_t vsId = registry.ensureId("VisibilityState");
+                    p.signature.set(vsId);
+                    if (p.defaults.find(vsId) == p.defaults.end())
+                        p.defaults.emplace(vsId, VisibilityState{});
+
+                    // Instance slot in the model's render pass.
+                    const uint32_t slId = registry.ensureId("RenderSlot");
+                    p.signature.set(slId);
+                    if (p.defaults.find(slId) == p.defaults.end())
+                        p.defaults.emplace(slId, RenderSlot{});
+                }
+
+                // Moving entities render interpolated between fixed simulation ticks.
+                const uint32_t velId = registry.ensureId("Velocity");
+                if (p.signature.has(velId))
+                {
+                    const uint32_t ptId = registry.ensureId("PreviousTransform");
+                    p.signature.set(ptId);
+                    if (p.defaults.find(ptId) == p.defaults.end())
+                        p.defaults.emplace(ptId, PreviousTransform{});
+                }
+
+                // Render bounds: derive from model metadata when possible, otherwise use conservative defaults.
+                const uint32_t rbId = registry.ensureId("RenderBounds");
+                p.signature.set(rbId);
+                if (p.defaults.find(rbId) == p.defaults.end())
+                {
+                    RenderBounds rb{};
+
+                    auto itRm = p.defaults.find(rmId);
+                    if (itRm != p.defaults.end() && std::holds_alternative<RenderModel>(itRm->second))
+                    {
+#if !defined(ENGINE_HEADLESS) || !ENGINE_HEADLESS
+                        const RenderModel &rm = std::get<RenderModel>(itRm->second);
+                        renderBoundsFromModel(*assets, rm.handle, rb);
+#endif
+                    }
+
+                    p.defaults.emplace(rbId, rb);
+                }
+
+                // World sphere, RenderTransformUpdateSystem's output; the model-space one until then.
+                const uint32_t wbId = registry.ensureId("WorldBounds");
+                p.signature.set(wbId);
+                if (p.defaults.find(wbId) == p.defaults.end())
+                {
+                    WorldBounds wb{};
+                    if (const RenderBounds *rb = std::get_if<RenderBounds>(&p.defaults.at(rbId)))
+                        wb = WorldBounds{rb->localCenter, rb->localRadius};
+                    p.defaults.emplace(wbId, wb);
+                }
+            }
+        }
+
+        // Avoiding movers can fall asleep when idle (SleepSystem).
+        {
+            const uint32_t velId = registry.ensureId("Velocity");
+            const uint32_t apId = registry.ensureId("AvoidanceParams");
+            if (p.signature.has(velId) && p.signature.has(apId))
+            {
+                const uint32_t ssId = registry.ensureId("SleepState");
+                p.signature.set(ssId);
+                if (p.defaults.find(ssId) == p.defaults.end())
+                    p.defaults.emplace(ssId, SleepState{});
+            }
+        }
+
+        // Combatants keep their target and engagement state in a column (CombatSystem).
+        if (p.signature.has(registry.ensureId("AttackCooldown")))
+        {
+            const uint32_t cmId = registry.ensureId("CombatMemory");
+            p.signature.set(cmId);
+            if (p.defaults.find(cmId) == p.defaults.end())
+                p.defaults.emplace(cmId, CombatMemory{});
+        }
+
+        // Resolve archetype (after any signature adjustments like RenderMesh)
+        p.archetypeId = archetypes.getOrCreate(p.signature);
+
+        // Typed defaults. Older files put the component objects at the top level.
+        const json *defaultsObj = section(root, "defaults");
+        const json &defs = defaultsObj ? *defaultsObj : root;
+
+        if (const json *o = section(defs, "Position"))
+            p.defaults.emplace(registry.ensureId("Position"), Position{numberOr(*o, "x", 0.0f), numberOr(*o, "y", 0.0f), numberOr(*o, "z", 0.0f)});
+
+        if (const json *o = section(defs, "Velocity"))
+            p.defaults.emplace(registry.ensureId("Velocity"), Velocity{numberOr(*o, "x", 0.0f), numberOr(*o, "y", 0.0f), numberOr(*o, "z", 0.0f)});
+
+        if (const json *o = section(defs, "Health"))
+        {
+            Health h{};
+            h.value = numberOr(*o, "value", h.value);
+            p.defaults.emplace(registry.ensureId("Health"), h);
+        }
+
+        if (const json *o = section(defs, "MoveTarget"))
+        {
+            MoveTarget t{};
+            t.x = numberOr(*o, "x", t.x);
+            t.y = numberOr(*o, "y", t.y);
+            t.z = numberOr(*o, "z", t.z);
+            t.active = static_cast<uint8_t>(uintOr(*o, "active", t.active));
+            p.defaults.emplace(registry.ensureId("MoveTarget"), t);
+        }
+
+        if (const json *o = section(defs, "MoveSpeed"))
+        {
+            MoveSpeed s{};
+            s.value = numberOr(*o, "value", s.value);
+            p.defaults.emplace(registry.ensureId("MoveSpeed"), s);
+        }
+
+        if (const json *o = section(defs, "Radius"))
+        {
+            Radius r{};
+            r.r = numberOr(*o, "r", r.r);
+            p.defaults.emplace(registry.ensureId("Radius"), r);
+        }
+
+        if (const json *o = section(defs, "LocomotionClips"))
+        {
+            LocomotionClips clips{};
+            clips.idleClip = uintOr(*o, "idleClip", clips.idleClip);
+            clips.walkClip = uintOr(*o, "walkClip", clips.walkClip);
+            clips.runClip = uintOr(*o, "runClip", clips.runClip);
+            p.defaults.emplace(registry.ensureId("LocomotionClips"), clips);
+        }
+
+        if (const json *o = section(defs, "CombatClips"))
+        {
+            CombatClips clips{};
+            clips.attackStart = uintOr(*o, "attackStart", clips.attackStart);
+            clips.attackEnd = uintOr(*o, "attackEnd", clips.attackEnd);
+            clips.damageStart = uintOr(*o, "damageStart", clips.damageStart);
+            clips.damageEnd = uintOr(*o, "damageEnd", clips.damageEnd);
+            clips.deathStart = uintOr(*o, "deathStart", clips.deathStart);
+            clips.deathEnd = uintOr(*o, "deathEnd", clips.deathEnd);
+            p.defaults.emplace(registry.ensureId("CombatClips"), clips);
+        }
+
+        // If LocomotionClips is provided, default RenderAnimation to idleClip.
+        {
+            const uint32_t locoId = registry.ensureId("LocomotionClips");
+            const uint32_t raId = registry.ensureId("RenderAnimation");
+            auto itLoco = p.defaults.find(locoId);
+            auto itRA = p.defaults.find(raId);
+            if (itLoco != p.defaults.end() && itRA != p.defaults.end() &&
+                std::holds_alternative<LocomotionClips>(itLoco->second) &&
+                std::holds_alternative<RenderAnimation>(itRA->second))
+            {
+                const auto &loco = std::get<LocomotionClips>(itLoco->second);
+                auto ra = std::get<RenderAnimation>(itRA->second);
+                ra.clipIndex = loco.idleClip;
+                ra.timeSec = 0.0f;
+                ra.playing = false;
+                ra.loop = true;
+                itRA->second = ra;
+            }
+        }
+
+        if (const json *o = section(defs, "Separation"))
+        {
+            Separation s{};
+            s.value = numberOr(*o, "value", s.value);
+            p.defaults.emplace(registry.ensureId("Separation"), s);
+        }
+
+        if (const json *o = section(defs, "AvoidanceParams"))
+        {
+            AvoidanceParams ap{};
+            ap.strength = numberOr(*o, "strength", ap.strength);
+            ap.maxAccel = numberOr(*o, "maxAccel", ap.maxAccel);
+            ap.blend = numberOr(*o, "blend", ap.blend);
+            ap.predictionTime = numberOr(*o, "predictionTime", ap.predictionTime);
+            ap.nearGoalRadius = numberOr(*o, "nearGoalRadius", ap.nearGoalRadius);
+            ap.nearGoalBoost = numberOr(*o, "nearGoalBoost", ap.nearGoalBoost);
+            ap.stoppedBoost = numberOr(*o, "stoppedBoost", ap.stoppedBoost);
+            ap.pressureBoost = numberOr(*o, "pressureBoost", ap.pressureBoost);
+            ap.interactSlack = numberOr(*o, "interactSlack", ap.interactSlack);
+            ap.falloffWeight = numberOr(*o, "falloffWeight", ap.falloffWeight);
+            ap.predictiveWeight = numberOr(*o, "predictiveWeight", ap.predictiveWeight);
+            ap.maxStopSpeed = numberOr(*o, "maxStopSpeed", ap.maxStopSpeed);
+            p.defaults.emplace(registry.ensureId("AvoidanceParams"), ap);
+        }
+
+        if (const json *o = section(defs, "Facing"))
+        {
+            Facing f{};
+            f.yaw = numberOr(*o, "yaw", f.yaw);
+            p.defaults.emplace(registry.ensureId("Facing"), f);
+        }
+
+        if (const json *o = section(defs, "RenderScale"))
+        {
+            RenderScale s{};
+            s.uniform = numberOr(*o, "uniform", s.uniform);
+            if (!std::isfinite(s.uniform) || s.uniform <= 0.0f)
+                s.uniform = 1.0f;
+            p.defaults[registry.ensureId("RenderScale")] = s;
+        }
+
+        if (const json *o = section(defs, "ObstacleRadius"))
+        {
+            ObstacleRadius orad{};
+            orad.r = numberOr(*o, "r", orad.r);
+            p.defaults.emplace(registry.ensureId("ObstacleRadius"), orad);
+        }
+
+        // Path has no JSON fields for now; only make sure the ID exists.
+        if (defs.contains("Path"))
+            (void)registry.ensureId("Path");
+
+        if (const json *o = section(defs, "Team"))
+        {
+            Team t{};
+            t.id = static_cast<uint8_t>(uintOr(*o, "id", t.id));
+            p.defaults.emplace(registry.ensureId("Team"), t);
+        }
+
+        if (const json *o = section(defs, "AttackCooldown"))
+        {
+            AttackCooldown ac{};
+            ac.timer = numberOr(*o, "timer", ac.timer);
+            ac.interval = numberOr(*o, "interval", ac.interval);
+            p.defaults.emplace(registry.ensureId("AttackCooldown"), ac);
+        }
+
+        // Validate defaults align with signature; drop mismatches to keep consistency.
+        if (!p.validateDefaults())
+        {
+            for (auto it = p.defaults.begin(); it != p.defaults.end();)
+            {
+                if (!p.signature.has(it->first))
+                    it = p.defaults.erase(it);
+                else
+                    ++it;
+            }
+        }
+
+        p.compile();
+        return p;
+    }
+
+#if !defined(ENGINE_HEADLESS) || !ENGINE_HEADLESS
+    Prefab loadPrefabFromJson(const std::string &jsonText,
+                              ComponentRegistry &registry,
+                              ArchetypeManager &archetypes,
+                              Engine::AssetManager &assets,
+                              bool streamModels)
+    {
+        return loadPrefab(jsonText, registry, archetypes, &assets, streamModels);
+    }
+#endif
+
+    Prefab loadPrefabFromJson(const std::string &jsonText,
+                              ComponentRegistry &registry,
+                              ArchetypeManager &archetypes)
+    {
+        return loadPrefab(jsonText, registry, archetypes, nullptr, false);
+    }
+}
@@ -0,0 +1,223 @@
+#include "utils/Profiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#if ENGINE_TRACY
+#include <tracy/TracyC.h>
+#endif
+
+namespace Engine::Profiler
+{
+    namespace
+    {
+        // Rings are never freed: a thread that exits keeps its history for the next export.
+        std::atomic<ThreadRing *> g_rings[MAX_THREADS];
+        std::atomic<uint32_t> g_ringCount{0};
+
+        // markFrame() records a zone with this name; exports turn it into an instant event.
+        const char *const FRAME_MARKER = "Frame";
+
+        struct ExportZone
+        {
+            const char *name;
+            uint64_t startNs;
+            uint64_t endNs;
+            uint32_t depth;
+        };
+
+        // Consistent copy of a ring: entries a writer may have overwritten meanwhile are dropped.
+        void copyRing(const ThreadRing &ring, std::vector<ExportZone> &out)
+        {
+            const uint64_t head = ring.head.load(std::memory_order_acquire);
+            const uint64_t first = head > ZONES_PER_THREAD ? head - ZONES_PER_THREAD : 0u;
+            const size_t base = out.size();
+            for (uint64_t i = first; i < head; ++i)
+            {
+                const ZoneRecord &z = ring.zones[i % ZONES_PER_THREAD];
+                out.push_back(ExportZone{z.name.load(std::memory_order_relaxed),
+                                         z.startNs.load(std::memory_order_relaxed),
+                                         z.endNs.load(std::memory_order_relaxed),
+                                         z.depth.load(std::memory_order_relaxed)});
+            }
+
+            // Slot i is safe as long as the writer has not started on index i + ZONES_PER_THREAD.
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const uint64_t after = ring.head.load(std::memory_order_relaxed);
+            const uint64_t valid = (after >= ZONES_PER_THREAD) ? after - ZONES_PER_THREAD + 1u : 0u;
+            if (valid > first)
+            {
+                const size_t drop = static_cast<size_t>(std::min<uint64_t>(valid - first, head - first));
+                out.erase(out.begin() + static_cast<std::ptrdiff_t>(base),
+                          out.begin() + static_cast<std::ptrdiff_t>(base + drop));
+            }
+        }
+
+        void writeJsonString(std::FILE *f, const char *s)
+        {
+            std::fputc('"', f);
+            for (; s && *s; ++s)
+            {
+                const char c = *s;
+                if (c == '"' || c == '\\')
+                {
+                    std::fputc('\\', f);
+                    std::fputc(c, f);
+                }
+                else if (static_cast<unsigned char>(c) < 0x20)
+                    std::fprintf(f, "\\u%04x", static_cast<unsigned>(c));
+                else
+                    std::fputc(c, f);
+            }
+            std::fputc('"', f);
+        }
+    } // namespace
+
+    namespace detail
+    {
+        ThreadRing *registerThread()
+        {
+            const uint32_t slot = g_ringCount.fetch_add(1u, std::memory_order_relaxed);
+            if (slot >= MAX_THREADS)
+                return nullptr;
+            ThreadRing *ring = new ThreadRing();
+            ring->threadIndex = slot;
+            g_rings[slot].store(ring, std::memory_order_release);
+            return ring;
+        }
+
+#if ENGINE_TRACY
+        uint64_t tracyBegin(const char *name, const char *file, uint32_t line)
+        {
+            const char *src = file ? file : "";
+            const uint64_t srcloc = ___tracy_alloc_srcloc_name(line, src, std::strlen(src), "", 0,
+                                                               name, std::strlen(name));
+            const TracyCZoneCtx ctx = ___tracy_emit_zone_begin_alloc(srcloc, 1);
+            return (static_cast<uint64_t>(ctx.active ? 1u : 0u) << 32) | ctx.id;
+        }
+
+        void tracyEnd(uint64_t packed)
+        {
+            TracyCZoneCtx ctx{};
+            ctx.id = static_cast<uint32_t>(packed);
+            ctx.active = static_cast<int>(packed >> 32);
+            ___tracy_emit_zone_end(ctx);
+        }
+#else
+        uint64_t tracyBegin(const char *, const char *, uint32_t) { return 0u; }
+        void tracyEnd(uint64_t) {}
+#endif
+    } // namespace detail
+
+    void setThreadName(const char *name)
+    {
+        detail::ThreadState &ts = detail::registeredState();
+        if (ts.ring)
+            ts.ring->threadName.store(name, std::memory_order_release);
+#if ENGINE_TRACY
+        ___tracy_set_thread_name(name);
+#endif
+    }
+
+    void markFrame()
+    {
+#if ENGINE_TRACY
+        ___tracy_emit_frame_mark(nullptr);
+#endif
+        if (!enabled())
+            return;
+        detail::ThreadState &ts = detail::registeredState();
+        if (ts.ring)
+        {
+            const uint64_t now = nowNs();
+            detail::record(*ts.ring, FRAME_MARKER, now, now, ts.depth);
+        }
+    }
+
+    bool writeChromeTrace(const std::string &path)
+    {
+        std::FILE *f = std::fopen(path.c_str(), "wb");
+        if (!f)
+            return false;
+
+        const uint32_t rings = std::min(g_ringCount.load(std::memory_order_acquire), MAX_THREADS);
+        std::vector<ExportZone> zones;
+        zones.reserve(static_cast<size_t>(ZONES_PER_THREAD) * 2u);
+
+        // Timestamps relative to the oldest exported zone keep the numbers short.
+        struct Span
+        {
+            const ThreadRing *ring;
+            size_t first, last;
+        };
+        std::vector<Span> spans;
+        for (uint32_t i = 0; i < rings; ++i)
+        {
+            const ThreadRing *ring = g_rings[i].load(std::memory_order_acquire);
+            if (!ring)
+                continue;
+            const size_t first = zones.size();
+            copyRing(*ring, zones);
+            spans.push_back(Span{ring, first, zones.size()});
+        }
+        uint64_t origin = UINT64_MAX;
+        for (const ExportZone &z : zones)
+            if (z.name)
+                origin = std::min(origin, z.startNs);
+
+        std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", f);
+        bool firstEvent = true;
+        auto separator = [&]()
+        {
+            if (!firstEvent)
+                std::fputs(",\n", f);
+            firstEvent = false;
+        };
+
+        for (const Span &s : spans)
+        {
+            const uint32_t tid = s.ring->threadIndex;
+            if (const char *threadName = s.ring->threadName.load(std::memory_order_acquire))
+            {
+                separator();
+                std::fprintf(f, "{\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"name\":\"thread_name\",\"args\":{\"name\":", tid);
+                writeJsonString(f, threadName);
+                std::fputs("}}", f);
+            }
+            for (size_t i = s.first; i < s.last; ++i)
+            {
+                const ExportZone &z = zones[i];
+                if (!z.name)
+                    continue;
+                const double ts = static_cast<double>(z.startNs - origin) / 1000.0;
+                separator();
+                if (z.name == FRAME_MARKER)
+                {
+                    std::fprintf(f, "{\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"name\":\"Frame\"}", tid, ts);
+                    continue;
+                }
+                const double dur = static_cast<double>(z.endNs - z.startNs) / 1000.0;
+                std::fprintf(f, "{\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"name\":", tid, ts, dur);
+                writeJsonString(f, z.name);
+                std::fputs("}", f);
+            }
+        }
+        std::fputs("\n]}\n", f);
+        return std::fclose(f) == 0;
+    }
+
+    void clear()
+    {
+        const uint32_t rings = std::min(g_ringCount.load(std::memory_order_acquire), MAX_THREADS);
+        for (uint32_t i = 0; i < rings; ++i)
+        {
+            ThreadRing *ring = g_rings[i].load(std::memory_order_acquire);
+            if (!ring)
+                continue;
+            for (ZoneRecord &z : ring->zones)
+                z.name.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+} // namespace Engine::Profiler
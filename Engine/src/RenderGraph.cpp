@@ -0,0 +1,547 @@
+#include "Engine/RenderGraph.h"
+#include "utils/ImageUtils.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace Engine
+{
+    static uint64_t mixSignature(uint64_t h, uint64_t v)
+    {
+        h ^= v + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+        return h;
+    }
+
+    RenderGraph::AccessInfo RenderGraph::accessInfo(RGAccess access)
+    {
+        switch (access)
+        {
+        case RGAccess::ColorAttachment:
+            return {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                    VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                    VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+        case RGAccess::DepthAttachment:
+            return {VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                    VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                    VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL};
+        case RGAccess::DepthRead:
+            return {VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT |
+                        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                    VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_SHADER_READ_BIT,
+                    VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL};
+        case RGAccess::FragmentSampled:
+            return {VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+        case RGAccess::ComputeSampled:
+            return {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+        case RGAccess::ComputeStorageRead:
+            return {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL};
+        case RGAccess::ComputeStorageWrite:
+            return {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+                    VK_IMAGE_LAYOUT_GENERAL};
+        case RGAccess::VertexStorageRead:
+            return {VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL};
+        case RGAccess::IndirectRead:
+            return {VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED};
+        case RGAccess::TransferSrc:
+            return {VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL};
+        case RGAccess::TransferDst:
+            return {VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL};
+        default:
+            return {VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL};
+        }
+    }
+
+    // ------------------------------------------------------------
+    // Declaration
+    // ------------------------------------------------------------
+
+    void RenderGraph::PassBuilder::sideEffect()
+    {
+        m_graph.m_passes[m_pass].sideEffect = true;
+    }
+
+    void RenderGraph::PassBuilder::use(RGResource res, RGAccess access, bool write, VkImageLayout finalLayout, bool attachment)
+    {
+        if (!res.valid() || res.index >= m_graph.m_resources.size())
+            return;
+        Use u;
+        u.resource = res.index;
+        u.access = access;
+        u.write = write;
+        u.attachment = attachment;
+        u.finalLayout = finalLayout;
+        m_graph.m_passes[m_pass].uses.push_back(u);
+    }
+
+    void RenderGraph::create(VkDevice device, VkPhysicalDevice physicalDevice, uint32_t frameCount)
+    {
+        destroy();
+        m_device = device;
+        m_physicalDevice = physicalDevice;
+        m_slots.resize(std::max(frameCount, 1u));
+    }
+
+    void RenderGraph::destroy()
+    {
+        for (Slot &slot : m_slots)
+            destroySlot(slot);
+        m_slots.clear();
+        m_passes.clear();
+        m_resources.clear();
+        m_device = VK_NULL_HANDLE;
+    }
+
+    void RenderGraph::beginFrame(uint32_t frameSlot)
+    {
+        m_slot = m_slots.empty() ? 0u : frameSlot % static_cast<uint32_t>(m_slots.size());
+        m_passes.clear();
+        m_resources.clear();
+        m_stats = Stats{};
+    }
+
+    RGResource RenderGraph::importImage(const char *name, VkImage image, VkImageView view, VkImageAspectFlags aspect,
+                                        VkImageLayout layout, VkPipelineStageFlags stageMask, bool output)
+    {
+        Resource r;
+        r.name = name;
+        r.imported = true;
+        r.output = output;
+        r.image = image;
+        r.view = view;
+        r.aspect = aspect;
+        r.layout = layout;
+        r.writeStages = stageMask;
+        m_resources.push_back(std::move(r));
+        return RGResource{static_cast<uint32_t>(m_resources.size() - 1)};
+    }
+
+    RGResource RenderGraph::importBuffer(const char *name, VkBuffer buffer, bool output)
+    {
+        Resource r;
+        r.name = name;
+        r.isImage = false;
+        r.imported = true;
+        r.output = output;
+        r.buffer = buffer;
+        m_resources.push_back(std::move(r));
+        return RGResource{static_cast<uint32_t>(m_resources.size() - 1)};
+    }
+
+    RGResource RenderGraph::createImage(const char *name, const RGImageDesc &desc)
+    {
+        Resource r;
+        r.name = name;
+        r.desc = desc;
+        r.aspect = desc.aspect;
+        m_resources.push_back(std::move(r));
+        return RGResource{static_cast<uint32_t>(m_resources.size() - 1)};
+    }
+
+    VkImage RenderGraph::image(RGResource res) const
+    {
+        return res.index < m_resources.size() ? m_resources[res.index].image : VK_NULL_HANDLE;
+    }
+
+    VkImageView RenderGraph::view(RGResource res) const
+    {
+        return res.index < m_resources.size() ? m_resources[res.index].view : VK_NULL_HANDLE;
+    }
+
+    VkBuffer RenderGraph::buffer(RGResource res) const
+    {
+        return res.index < m_resources.size() ? m_resources[res.index].buffer : VK_NULL_HANDLE;
+    }
+
+    // ------------------------------------------------------------
+    // Compile
+    // ------------------------------------------------------------
+
+    void RenderGraph::cull()
+    {
+        // Backwards: a pass is live when it has side effects or writes something a later live
+        // pass (or the outside) reads; its reads are then needed in turn.
+        std::vector<uint8_t> needed(m_resources.size(), 0);
+        for (size_t i = 0; i < m_resources.size(); ++i)
+            needed[i] = m_resources[i].output ? 1u : 0u;
+
+        for (size_t p = m_passes.size(); p-- > 0;)
+        {
+            Pass &pass = m_passes[p];
+            pass.live = pass.sideEffect;
+            for (const Use &u : pass.uses)
+            {
+                if (u.write && needed[u.resource])
+                    pass.live = true;
+            }
+            if (!pass.live)
+            {
+                ++m_stats.culled;
+                continue;
+            }
+            for (const Use &u : pass.uses)
+            {
+                // Attachments that load their contents read them as well.
+                if (!u.write || u.attachment)
+                    needed[u.resource] = 1u;
+            }
+        }
+
+        for (uint32_t p = 0; p < static_cast<uint32_t>(m_passes.size()); ++p)
+        {
+            if (!m_passes[p].live)
+                continue;
+            for (const Use &u : m_passes[p].uses)
+            {
+                Resource &r = m_resources[u.resource];
+                r.firstPass = std::min(r.firstPass, p);
+                r.lastPass = std::max(r.lastPass, p);
+            }
+        }
+    }
+
+    void RenderGraph::destroySlot(Slot &slot)
+    {
+        for (TransientImage &t : slot.images)
+        {
+            if (t.view != VK_NULL_HANDLE)
+                vkDestroyImageView(m_device, t.view, nullptr);
+            if (t.image != VK_NULL_HANDLE)
+                vkDestroyImage(m_device, t.image, nullptr);
+        }
+        for (TransientMemory &m : slot.memories)
+            FreeGpuMemory(m_device, m.allocation);
+        slot.images.clear();
+        slot.memories.clear();
+        slot.signature = 0;
+    }
+
+    bool RenderGraph::placeTransients(Slot &slot)
+    {
+        // Live transients in declaration order; the placement is kept while they stay the same.
+        uint64_t signature = 0x51ed270b27u;
+        uint32_t count = 0;
+        for (Resource &r : m_resources)
+        {
+            if (r.imported || r.firstPass == UINT32_MAX)
+                continue;
+            r.transient = count++;
+            signature = mixSignature(signature, static_cast<uint64_t>(r.desc.format));
+            signature = mixSignature(signature, (static_cast<uint64_t>(r.desc.extent.width) << 32) | r.desc.extent.height);
+            signature = mixSignature(signature, (static_cast<uint64_t>(r.desc.usage) << 32) | r.desc.aspect);
+            signature = mixSignature(signature, (static_cast<uint64_t>(r.firstPass) << 32) | r.lastPass);
+            signature = mixSignature(signature, r.desc.mipLevels);
+        }
+        signature = mixSignature(signature, count);
+
+        if (signature != slot.signature || slot.images.size() != count)
+        {
+            // The slot's fence was waited on: its previous transients are idle.
+            destroySlot(slot);
+            slot.images.resize(count);
+            for (const Resource &r : m_resources)
+            {
+                if (r.transient == UINT32_MAX)
+                    continue;
+                TransientImage &t = slot.images[r.transient];
+                t.desc = r.desc;
+                t.firstPass = r.firstPass;
+                t.lastPass = r.lastPass;
+
+                VkImageCreateInfo ci{};
+                ci.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+                ci.imageType = VK_IMAGE_TYPE_2D;
+                ci.format = r.desc.format;
+                ci.extent = {std::max(r.desc.extent.width, 1u), std::max(r.desc.extent.height, 1u), 1u};
+                ci.mipLevels = std::max(r.desc.mipLevels, 1u);
+                ci.arrayLayers = 1;
+                ci.samples = VK_SAMPLE_COUNT_1_BIT;
+                ci.tiling = VK_IMAGE_TILING_OPTIMAL;
+                ci.usage = r.desc.usage;
+                ci.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+                ci.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+                if (vkCreateImage(m_device, &ci, nullptr, &t.image) != VK_SUCCESS)
+                {
+                    destroySlot(slot);
+                    return false;
+                }
+                vkGetImageMemoryRequirements(m_device, t.image, &t.requirements);
+            }
+
+            // Largest first; each image joins the first memory whose users it never overlaps.
+            std::vector<uint32_t> order(count);
+            for (uint32_t i = 0; i < count; ++i)
+                order[i] = i;
+            std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b)
+                             { return slot.images[a].requirements.size > slot.images[b].requirements.size; });
+
+            for (uint32_t i : order)
+            {
+                TransientImage &t = slot.images[i];
+                uint32_t chosen = UINT32_MAX;
+                for (uint32_t m = 0; m < static_cast<uint32_t>(slot.memories.size()) && chosen == UINT32_MAX; ++m)
+                {
+                    const TransientMemory &mem = slot.memories[m];
+                    if ((mem.typeBits & t.requirements.memoryTypeBits) == 0u)
+                        continue;
+                    bool overlaps = false;
+                    for (uint32_t other : mem.images)
+                    {
+                        const TransientImage &o = slot.images[other];
+                        if (t.firstPass <= o.lastPass && o.firstPass <= t.lastPass)
+                            overlaps = true;
+                    }
+                    if (!overlaps)
+                        chosen = m;
+                }
+                if (chosen == UINT32_MAX)
+                {
+                    chosen = static_cast<uint32_t>(slot.memories.size());
+                    slot.memories.push_back(TransientMemory{});
+                }
+                TransientMemory &mem = slot.memories[chosen];
+                mem.size = std::max(mem.size, t.requirements.size);
+                mem.alignment = std::max(mem.alignment, t.requirements.alignment);
+                mem.typeBits &= t.requirements.memoryTypeBits;
+                mem.images.push_back(i);
+                t.memory = chosen;
+            }
+
+            for (TransientMemory &mem : slot.memories)
+            {
+                std::sort(mem.images.begin(), mem.images.end(), [&](uint32_t a, uint32_t b)
+                          { return slot.images[a].firstPass < slot.images[b].firstPass; });
+
+                VkMemoryRequirements req{};
+                req.size = mem.size;
+                req.alignment = mem.alignment;
+                req.memoryTypeBits = mem.typeBits;
+
+                VkResult res = VK_ERROR_OUT_OF_DEVICE_MEMORY;
+                if (GpuAllocator *allocator = GpuAllocator::forDevice(m_device))
+                {
+                    res = allocator->allocate(req, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, GpuResourceKind::Optimal, mem.allocation);
+                }
+                else
+                {
+                    uint32_t type = 0;
+                    if (FindMemoryType(m_physicalDevice, req.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, type))
+                    {
+                        VkMemoryAllocateInfo ai{};
+                        ai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+                        ai.allocationSize = req.size;
+                        ai.memoryTypeIndex = type;
+                        res = vkAllocateMemory(m_device, &ai, nullptr, &mem.allocation.memory);
+                        mem.allocation.size = req.size;
+                    }
+                }
+                if (res != VK_SUCCESS)
+                {
+                    destroySlot(slot);
+                    return false;
+                }
+                for (uint32_t i : mem.images)
+                {
+                    TransientImage &t = slot.images[i];
+                    if (vkBindImageMemory(m_device, t.image, mem.allocation.memory, mem.allocation.offset) != VK_SUCCESS ||
+                        CreateImageView2D(m_device, t.image, t.desc.format, t.desc.aspect, std::max(t.desc.mipLevels, 1u), t.view) != VK_SUCCESS)
+                    {
+                        destroySlot(slot);
+                        return false;
+                    }
+                }
+            }
+            slot.signature = signature;
+        }
+
+        VkDeviceSize imageBytes = 0;
+        for (const TransientImage &t : slot.images)
+            imageBytes += t.requirements.size;
+        for (const TransientMemory &mem : slot.memories)
+            m_stats.transientBytes += mem.size;
+        m_stats.transientImages = count;
+        m_stats.aliasedBytes = imageBytes - std::min(imageBytes, m_stats.transientBytes);
+
+        for (Resource &r : m_resources)
+        {
+            if (r.transient == UINT32_MAX)
+                continue;
+            r.image = slot.images[r.transient].image;
+            r.view = slot.images[r.transient].view;
+        }
+        for (TransientMemory &mem : slot.memories)
+        {
+            mem.stages = 0;
+            mem.writeAccess = 0;
+        }
+        return true;
+    }
+
+    // ------------------------------------------------------------
+    // Record
+    // ------------------------------------------------------------
+
+    void RenderGraph::recordBarriers(VkCommandBuffer cmd, const Pass &pass, Slot &slot)
+    {
+        m_imageBarriers.clear();
+        VkPipelineStageFlags srcStages = 0;
+        VkPipelineStageFlags dstStages = 0;
+        VkAccessFlags bufferSrcAccess = 0;
+        VkAccessFlags bufferDstAccess = 0;
+        bool bufferBarrier = false;
+
+        for (const Use &u : pass.uses)
+        {
+            Resource &r = m_resources[u.resource];
+            const AccessInfo info = accessInfo(u.access);
+
+            // First use of an aliased transient: wait for the memory's previous user, discard.
+            VkPipelineStageFlags prevStages = r.writeStages | r.readStages;
+            VkAccessFlags prevAccess = r.writeAccess;
+            if (r.transient != UINT32_MAX && !r.touched)
+            {
+                const TransientMemory &mem = slot.memories[slot.images[r.transient].memory];
+                prevStages = mem.stages;
+                prevAccess = mem.writeAccess;
+                r.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+            }
+
+            const bool hazardWrite = r.writeAccess != 0 && (info.stages & ~r.visibleStages) != 0;
+            const bool hazardRead = u.write && r.readStages != 0;
+            const bool aliasWait = r.transient != UINT32_MAX && !r.touched && prevStages != 0;
+
+            if (r.isImage)
+            {
+                const VkImageLayout wanted = info.layout;
+                bool needed = false;
+                VkImageMemoryBarrier b{};
+                b.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+                b.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                b.image = r.image;
+                b.subresourceRange.aspectMask = r.aspect;
+                b.subresourceRange.baseMipLevel = 0;
+                b.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+                b.subresourceRange.baseArrayLayer = 0;
+                b.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+
+                if (u.attachment)
+                {
+                    // The render pass transitions it; only hazards from this frame remain.
+                    if (r.touched && (hazardWrite || hazardRead))
+                    {
+                        b.oldLayout = b.newLayout = r.layout;
+                        needed = true;
+                    }
+                }
+                else if (r.layout != wanted || hazardWrite || hazardRead || aliasWait)
+                {
+                    b.oldLayout = r.layout;
+                    b.newLayout = wanted;
+                    needed = true;
+                }
+
+                if (needed)
+                {
+                    b.srcAccessMask = prevAccess;
+                    b.dstAccessMask = info.access;
+                    m_imageBarriers.push_back(b);
+                    srcStages |= prevStages;
+                    dstStages |= info.stages;
+                }
+                else
+                {
+                    ++m_stats.skippedBarriers;
+                }
+            }
+            else
+            {
+                if (r.touched && (hazardWrite || hazardRead))
+                {
+                    bufferBarrier = true;
+                    bufferSrcAccess |= prevAccess;
+                    bufferDstAccess |= info.access;
+                    srcStages |= prevStages;
+                    dstStages |= info.stages;
+                }
+                else
+                {
+                    ++m_stats.skippedBarriers;
+                }
+            }
+
+            // State after this pass.
+            const VkImageLayout after = (u.attachment && u.finalLayout != VK_IMAGE_LAYOUT_UNDEFINED) ? u.finalLayout
+                                                                                                 : (r.isImage ? info.layout : VK_IMAGE_LAYOUT_UNDEFINED);
+            if (u.write)
+            {
+                r.writeStages = info.stages;
+                r.writeAccess = info.access & (VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                                               VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT);
+                r.readStages = 0;
+                r.visibleStages = 0;
+            }
+            else
+            {
+                r.readStages |= info.stages;
+                r.visibleStages |= info.stages;
+            }
+            r.layout = after;
+            r.touched = true;
+
+            if (r.transient != UINT32_MAX)
+            {
+                TransientMemory &mem = slot.memories[slot.images[r.transient].memory];
+                mem.stages = r.writeStages | r.readStages;
+                mem.writeAccess = r.writeAccess;
+            }
+        }
+
+        if (m_imageBarriers.empty() && !bufferBarrier)
+            return;
+
+        VkMemoryBarrier mb{};
+        mb.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        mb.srcAccessMask = bufferSrcAccess;
+        mb.dstAccessMask = bufferDstAccess;
+
+        if (srcStages == 0)
+            srcStages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+        vkCmdPipelineBarrier(cmd, srcStages, dstStages, 0,
+                             bufferBarrier ? 1u : 0u, bufferBarrier ? &mb : nullptr,
+                             0, nullptr,
+                             static_cast<uint32_t>(m_imageBarriers.size()), m_imageBarriers.data());
+        m_stats.barriers += static_cast<uint32_t>(m_imageBarriers.size()) + (bufferBarrier ? 1u : 0u);
+    }
+
+    void RenderGraph::execute(VkCommandBuffer cmd)
+    {
+        m_stats.passes = static_cast<uint32_t>(m_passes.size());
+        if (m_slots.empty())
+            return;
+
+        cull();
+        Slot &slot = m_slots[m_slot];
+        if (!placeTransients(slot))
+        {
+            // Passes using transients cannot run; the rest still can.
+            fprintf(stderr, "RenderGraph: failed to place transient images\n");
+            for (Pass &pass : m_passes)
+            {
+                for (const Use &u : pass.uses)
+                {
+                    if (!m_resources[u.resource].imported)
+                        pass.live = false;
+                }
+            }
+        }
+
+        for (const Pass &pass : m_passes)
+        {
+            if (!pass.live)
+                continue;
+            recordBarriers(cmd, pass, slot);
+            if (pass.execute)
+                pass.execute(cmd, *this);
+        }
+    }
+}
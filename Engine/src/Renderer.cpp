@@ -2,13 +2,30 @@
 #include <iostream>
 #include <cstring>
 #include <chrono>
+#include <algorithm>
 #include "Engine/Renderer.h"
+#include "Engine/Camera.h"
 #include "Engine/VulkanContext.h"
 #include "Engine/SwapChain.h"
 #include "utils/ImageUtils.h"
+#include "utils/BufferUtils.h"
+#include "utils/JobSystem.h"
+#include "utils/Profiler.h"
+
+#include <glm/gtc/matrix_transform.hpp>
 
 namespace Engine
 {
+    // Push block of shaders/upscale.frag.
+    struct UpscalePush
+    {
+        float uvScale[2];
+        float uvMax[2];
+        float texel[2];
+        float sharpness;
+        float pad;
+    };
+
     static VkFormat findSupportedFormat(
         VkPhysicalDevice phys,
         const std::vector<VkFormat> &candidates,
@@ -51,7 +68,8 @@ namespace Engine
     }
 
     Renderer::Renderer(VulkanContext *ctx, SwapChain *swapchain, uint32_t maxFramesInFlight)
-        : m_ctx(ctx), m_swapchain(swapchain), m_maxFrames(maxFramesInFlight)
+        : m_ctx(ctx), m_swapchain(swapchain), m_maxFrames(std::max(1u, maxFramesInFlight)),
+          m_framesInFlight(std::min(2u, std::max(1u, maxFramesInFlight)))
     {
         if (!m_ctx || !m_swapchain)
         {
@@ -62,6 +80,7 @@ namespace Engine
         m_device = m_ctx->GetDevice();
         m_graphicsQueue = m_ctx->GetGraphicsQueue();
         m_presentQueue = m_ctx->GetPresentQueue();
+        m_computeQueue = m_ctx->GetComputeQueue();
 
         m_swapchainImageFormat = m_swapchain->GetImageFormat();
         m_extent = m_swapchain->GetExtent();
@@ -108,6 +127,13 @@ namespace Engine
         createCommandPoolsAndBuffers();
         createTimestampQueryPool();
 
+        // Before the passes: their pipelines include the shadow receiver set.
+        if (!m_shadows.create(*m_ctx, m_maxFrames))
+            throw std::runtime_error("Renderer: failed to create shadow cascades");
+        if (m_uploadRing.create(m_device, m_ctx->GetPhysicalDevice(), m_maxFrames, m_uploadRingBytes) != VK_SUCCESS)
+            throw std::runtime_error("Renderer: failed to create the frame upload ring");
+        m_graph.create(m_device, m_ctx->GetPhysicalDevice(), m_maxFrames);
+
         // notify registered passes so they can create pipelines/resources that depend on renderpass/framebuffers
         for (auto &p : m_passes)
         {
@@ -137,6 +163,13 @@ namespace Engine
         createCommandPoolsAndBuffers();
         createTimestampQueryPool();
 
+        // Before the passes: their pipelines include the shadow receiver set.
+        if (!m_shadows.create(*m_ctx, m_maxFrames))
+            throw std::runtime_error("Renderer: failed to create shadow cascades");
+        if (m_uploadRing.create(m_device, m_ctx->GetPhysicalDevice(), m_maxFrames, m_uploadRingBytes) != VK_SUCCESS)
+            throw std::runtime_error("Renderer: failed to create the frame upload ring");
+        m_graph.create(m_device, m_ctx->GetPhysicalDevice(), m_maxFrames);
+
         // notify registered passes so they can create pipelines/resources that depend on renderpass/framebuffers
         for (auto &p : m_passes)
         {
@@ -162,7 +195,14 @@ namespace Engine
                 p->onDestroy(*m_ctx);
         }
 
+        m_shadows.destroy();
+        m_hiZ.destroy();
+        m_uploadRing.destroy();
+        m_graph.destroy();
+        m_cameraMapped = nullptr;
         destroyTimestampQueryPool();
+        destroyDepthReadbacks();
+        destroySecondaryPools();
         destroyCommandPoolsAndBuffers();
         destroySyncObjects();
 
@@ -176,7 +216,9 @@ namespace Engine
         }
         m_framebuffers.clear();
 
+        destroyUpscaleResources();
         destroyDepthResources();
+        releaseRetiredTargets(true);
 
         // Destroy main render pass
         if (m_mainRenderPass != VK_NULL_HANDLE)
@@ -185,6 +227,8 @@ namespace Engine
             m_mainRenderPass = VK_NULL_HANDLE;
         }
 
+        m_lastSubmittedFrame = UINT32_MAX;
+        m_presentIdBase = m_presentId; // the caller recreates the swapchain before init()
         m_initialized = false;
     }
 
@@ -223,7 +267,8 @@ namespace Engine
         depthAttachment.format = m_depthFormat;
         depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
         depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-        depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        // Stored so the optional depth readback (occlusion culling) can copy it after the pass.
+        depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
         depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
         depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
         depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
@@ -247,7 +292,9 @@ namespace Engine
         VkSubpassDependency dependency{};
         dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
         dependency.dstSubpass = 0;
-        dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+        // TRANSFER covers the previous frame's optional depth readback (write-after-read on depth).
+        dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+                                  VK_PIPELINE_STAGE_TRANSFER_BIT;
         dependency.srcAccessMask = 0;
         dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
         dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
@@ -308,10 +355,17 @@ namespace Engine
             throw std::runtime_error("Renderer::createDepthResources - failed to find supported depth format");
         }
 
+        // Sampled by the Hi-Z build where the format allows it.
+        VkFormatProperties props{};
+        vkGetPhysicalDeviceFormatProperties(m_ctx->GetPhysicalDevice(), m_depthFormat, &props);
+        const bool sampleable = (props.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) != 0;
+
         const auto &imageViews = m_swapchain->GetImageViews();
         m_depthImages.resize(imageViews.size(), VK_NULL_HANDLE);
-        m_depthMemories.resize(imageViews.size(), VK_NULL_HANDLE);
+        m_depthMemories.resize(imageViews.size());
         m_depthImageViews.resize(imageViews.size(), VK_NULL_HANDLE);
+        if (sampleable)
+            m_depthSampleViews.resize(imageViews.size(), VK_NULL_HANDLE);
 
         for (size_t i = 0; i < imageViews.size(); ++i)
         {
@@ -321,7 +375,8 @@ namespace Engine
                 m_extent.width,
                 m_extent.height,
                 m_depthFormat,
-                VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+                VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+                    (sampleable ? VK_IMAGE_USAGE_SAMPLED_BIT : 0u),
                 m_depthImages[i],
                 m_depthMemories[i]);
             if (r != VK_SUCCESS)
@@ -339,6 +394,13 @@ namespace Engine
             {
                 throw std::runtime_error("Renderer::createDepthResources - failed to create depth image view");
             }
+
+            // Sampled views may name only one aspect of a depth/stencil format.
+            if (sampleable &&
+                CreateImageView2D(m_device, m_depthImages[i], m_depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT, m_depthSampleViews[i]) != VK_SUCCESS)
+            {
+                throw std::runtime_error("Renderer::createDepthResources - failed to create depth sample view");
+            }
         }
     }
 
@@ -352,6 +414,14 @@ namespace Engine
                 iv = VK_NULL_HANDLE;
             }
         }
+        for (auto &iv : m_depthSampleViews)
+        {
+            if (iv != VK_NULL_HANDLE)
+            {
+                vkDestroyImageView(m_device, iv, nullptr);
+                iv = VK_NULL_HANDLE;
+            }
+        }
         for (auto &img : m_depthImages)
         {
             if (img != VK_NULL_HANDLE)
@@ -362,57 +432,516 @@ namespace Engine
         }
         for (auto &mem : m_depthMemories)
         {
-            if (mem != VK_NULL_HANDLE)
-            {
-                vkFreeMemory(m_device, mem, nullptr);
-                mem = VK_NULL_HANDLE;
-            }
+            FreeGpuMemory(m_device, mem);
         }
         m_depthImageViews.clear();
+        m_depthSampleViews.clear();
         m_depthImages.clear();
         m_depthMemories.clear();
     }
 
-    void Renderer::recreateSwapchainDependent()
+    bool Renderer::createUpscaleResources()
     {
-        vkDeviceWaitIdle(m_device);
+        destroyUpscaleResources();
 
-        // Destroy pass-owned resources that depend on renderpass/framebuffers
-        for (auto &p : m_passes)
+        const auto &imageViews = m_swapchain->GetImageViews();
+        if (m_depthImageViews.size() != imageViews.size())
+            return false;
+
+        try
         {
-            if (p)
-                p->onDestroy(*m_ctx);
+            // Scene pass: the main pass, ending in SHADER_READ_ONLY for the upscale.
+            VkAttachmentDescription attachments[2]{};
+            attachments[0].format = m_swapchainImageFormat;
+            attachments[0].samples = VK_SAMPLE_COUNT_1_BIT;
+            attachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+            attachments[0].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+            attachments[0].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+            attachments[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+            attachments[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            attachments[0].finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+            attachments[1].format = m_depthFormat;
+            attachments[1].samples = VK_SAMPLE_COUNT_1_BIT;
+            attachments[1].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+            attachments[1].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+            attachments[1].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+            attachments[1].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+            attachments[1].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            attachments[1].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+            VkAttachmentReference colorRef{0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+            VkAttachmentReference depthRef{1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL};
+
+            VkSubpassDescription subpass{};
+            subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+            subpass.colorAttachmentCount = 1;
+            subpass.pColorAttachments = &colorRef;
+            subpass.pDepthStencilAttachment = &depthRef;
+
+            VkSubpassDependency deps[1]{};
+            // In: as the main pass, plus the previous upscale's sampling of this image (write-after-read).
+            deps[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+            deps[0].dstSubpass = 0;
+            deps[0].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+                                   VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+            deps[0].srcAccessMask = 0;
+            deps[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+            deps[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+            // Out: the frame graph makes the colour writes visible to the upscale's sampling.
+
+            VkRenderPassCreateInfo rpInfo{};
+            rpInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+            rpInfo.attachmentCount = 2;
+            rpInfo.pAttachments = attachments;
+            rpInfo.subpassCount = 1;
+            rpInfo.pSubpasses = &subpass;
+            rpInfo.dependencyCount = 1;
+            rpInfo.pDependencies = deps;
+            if (vkCreateRenderPass(m_device, &rpInfo, nullptr, &m_sceneRenderPass) != VK_SUCCESS)
+                throw std::runtime_error("Renderer::createUpscaleResources - failed to create scene render pass");
+
+            // Upscale pass: writes every swapchain pixel; depth is only there for compatibility.
+            attachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+            attachments[0].finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+            attachments[1].loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+            attachments[1].storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+
+            // TRANSFER / COMPUTE: the depth readback and Hi-Z build recorded just before still read
+            // the depth image.
+            deps[0].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT |
+                                   VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+            if (vkCreateRenderPass(m_device, &rpInfo, nullptr, &m_upscaleRenderPass) != VK_SUCCESS)
+                throw std::runtime_error("Renderer::createUpscaleResources - failed to create upscale render pass");
+
+            if (CreateTextureSampler(m_device, m_ctx->GetPhysicalDevice(),
+                                     VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+                                     VK_FILTER_LINEAR, VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_NEAREST,
+                                     1.0f, m_upscaleSampler) != VK_SUCCESS)
+                throw std::runtime_error("Renderer::createUpscaleResources - failed to create sampler");
+
+            VkDescriptorSetLayoutBinding binding{};
+            binding.binding = 0;
+            binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            binding.descriptorCount = 1;
+            binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+            VkDescriptorSetLayoutCreateInfo layoutInfo{};
+            layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+            layoutInfo.bindingCount = 1;
+            layoutInfo.pBindings = &binding;
+            if (vkCreateDescriptorSetLayout(m_device, &layoutInfo, nullptr, &m_upscaleSetLayout) != VK_SUCCESS)
+                throw std::runtime_error("Renderer::createUpscaleResources - failed to create set layout");
+
+            PipelineCreateInfo pci{};
+            pci.device = m_device;
+            pci.pipelineCache = m_ctx->GetPipelineCache();
+            pci.renderPass = m_upscaleRenderPass;
+            pci.subpass = 0;
+            pci.descriptorSetLayouts = {m_upscaleSetLayout};
+            pci.pushConstantRanges = {VkPushConstantRange{VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(UpscalePush)}};
+
+            VkShaderModule vert = Pipeline::createShaderModuleFromFile(m_device, "shaders/upscale.vert.spv");
+            VkShaderModule frag = VK_NULL_HANDLE;
+            try
+            {
+                frag = Pipeline::createShaderModuleFromFile(m_device, "shaders/upscale.frag.spv");
+            }
+            catch (...)
+            {
+                vkDestroyShaderModule(m_device, vert, nullptr);
+                throw;
+            }
+
+            VkPipelineShaderStageCreateInfo vs{};
+            vs.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+            vs.stage = VK_SHADER_STAGE_VERTEX_BIT;
+            vs.module = vert;
+            vs.pName = "main";
+
+            VkPipelineShaderStageCreateInfo fs{};
+            fs.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+            fs.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+            fs.module = frag;
+            fs.pName = "main";
+            pci.shaderStages = {vs, fs};
+
+            // Fullscreen triangle from gl_VertexIndex: no vertex input, no culling, no depth.
+            VkPipelineRasterizationStateCreateInfo rs{};
+            rs.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+            rs.polygonMode = VK_POLYGON_MODE_FILL;
+            rs.lineWidth = 1.0f;
+            rs.cullMode = VK_CULL_MODE_NONE;
+            rs.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+            pci.rasterization = rs;
+            pci.rasterizationProvided = true;
+
+            pci.dynamicStates = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+
+            const VkResult r = m_upscalePipeline.create(pci);
+            vkDestroyShaderModule(m_device, vert, nullptr);
+            vkDestroyShaderModule(m_device, frag, nullptr);
+            if (r != VK_SUCCESS)
+                throw std::runtime_error("Renderer::createUpscaleResources - failed to create upscale pipeline");
+
+            createUpscaleTargets();
+        }
+        catch (const std::exception &e)
+        {
+#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
+            std::cerr << "[Renderer] resolution scaling disabled: " << e.what() << "\n";
+#endif
+            destroyUpscaleResources();
+            m_upscaleFailed = true;
+            return false;
         }
 
-        for (auto fb : m_framebuffers)
+        m_upscaleCreated = true;
+        return true;
+    }
+
+    void Renderer::createUpscaleTargets()
+    {
+        const size_t count = m_swapchain->GetImageViews().size();
+
+        // Full-size scene targets: a scale change only moves the render area.
+        m_sceneColorImages.resize(count, VK_NULL_HANDLE);
+        m_sceneColorMemories.resize(count);
+        m_sceneColorViews.resize(count, VK_NULL_HANDLE);
+        m_sceneFramebuffers.resize(count, VK_NULL_HANDLE);
+        for (size_t i = 0; i < count; ++i)
         {
-            if (fb != VK_NULL_HANDLE)
-                vkDestroyFramebuffer(m_device, fb, nullptr);
+            if (CreateImage2D(m_device, m_ctx->GetPhysicalDevice(), m_extent.width, m_extent.height,
+                              m_swapchainImageFormat,
+                              VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                              m_sceneColorImages[i], m_sceneColorMemories[i]) != VK_SUCCESS)
+                throw std::runtime_error("Renderer::createUpscaleTargets - failed to create scene colour image");
+            if (CreateImageView2D(m_device, m_sceneColorImages[i], m_swapchainImageFormat,
+                                  VK_IMAGE_ASPECT_COLOR_BIT, m_sceneColorViews[i]) != VK_SUCCESS)
+                throw std::runtime_error("Renderer::createUpscaleTargets - failed to create scene colour view");
+
+            VkImageView fbViews[2] = {m_sceneColorViews[i], m_depthImageViews[i]};
+            VkFramebufferCreateInfo fbInfo{};
+            fbInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+            fbInfo.renderPass = m_sceneRenderPass;
+            fbInfo.attachmentCount = 2;
+            fbInfo.pAttachments = fbViews;
+            fbInfo.width = m_extent.width;
+            fbInfo.height = m_extent.height;
+            fbInfo.layers = 1;
+            if (vkCreateFramebuffer(m_device, &fbInfo, nullptr, &m_sceneFramebuffers[i]) != VK_SUCCESS)
+                throw std::runtime_error("Renderer::createUpscaleTargets - failed to create scene framebuffer");
         }
-        m_framebuffers.clear();
 
-        destroyDepthResources();
+        // Sets of their own: the previous targets' sets may still be bound by frames in flight.
+        VkDescriptorPoolSize poolSize{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, static_cast<uint32_t>(count)};
+        VkDescriptorPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.maxSets = static_cast<uint32_t>(count);
+        poolInfo.poolSizeCount = 1;
+        poolInfo.pPoolSizes = &poolSize;
+        if (vkCreateDescriptorPool(m_device, &poolInfo, nullptr, &m_upscalePool) != VK_SUCCESS)
+            throw std::runtime_error("Renderer::createUpscaleTargets - failed to create descriptor pool");
+
+        std::vector<VkDescriptorSetLayout> layouts(count, m_upscaleSetLayout);
+        m_upscaleSets.assign(count, VK_NULL_HANDLE);
+        VkDescriptorSetAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = m_upscalePool;
+        allocInfo.descriptorSetCount = static_cast<uint32_t>(count);
+        allocInfo.pSetLayouts = layouts.data();
+        if (vkAllocateDescriptorSets(m_device, &allocInfo, m_upscaleSets.data()) != VK_SUCCESS)
+            throw std::runtime_error("Renderer::createUpscaleTargets - failed to allocate descriptor sets");
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            VkDescriptorImageInfo imageInfo{};
+            imageInfo.sampler = m_upscaleSampler;
+            imageInfo.imageView = m_sceneColorViews[i];
+            imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+            VkWriteDescriptorSet write{};
+            write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            write.dstSet = m_upscaleSets[i];
+            write.dstBinding = 0;
+            write.descriptorCount = 1;
+            write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            write.pImageInfo = &imageInfo;
+            vkUpdateDescriptorSets(m_device, 1, &write, 0, nullptr);
+        }
+    }
 
-        if (m_mainRenderPass != VK_NULL_HANDLE)
+    void Renderer::destroyUpscaleResources()
+    {
+        m_upscalePipeline.destroy(m_device);
+        if (m_upscalePool != VK_NULL_HANDLE)
         {
-            vkDestroyRenderPass(m_device, m_mainRenderPass, nullptr);
-            m_mainRenderPass = VK_NULL_HANDLE;
+            vkDestroyDescriptorPool(m_device, m_upscalePool, nullptr); // frees the sets
+            m_upscalePool = VK_NULL_HANDLE;
         }
+        m_upscaleSets.clear();
+        if (m_upscaleSetLayout != VK_NULL_HANDLE)
+        {
+            vkDestroyDescriptorSetLayout(m_device, m_upscaleSetLayout, nullptr);
+            m_upscaleSetLayout = VK_NULL_HANDLE;
+        }
+        if (m_upscaleSampler != VK_NULL_HANDLE)
+        {
+            vkDestroySampler(m_device, m_upscaleSampler, nullptr);
+            m_upscaleSampler = VK_NULL_HANDLE;
+        }
+        for (auto fb : m_sceneFramebuffers)
+        {
+            if (fb != VK_NULL_HANDLE)
+                vkDestroyFramebuffer(m_device, fb, nullptr);
+        }
+        m_sceneFramebuffers.clear();
+        for (auto iv : m_sceneColorViews)
+        {
+            if (iv != VK_NULL_HANDLE)
+                vkDestroyImageView(m_device, iv, nullptr);
+        }
+        m_sceneColorViews.clear();
+        for (auto img : m_sceneColorImages)
+        {
+            if (img != VK_NULL_HANDLE)
+                vkDestroyImage(m_device, img, nullptr);
+        }
+        m_sceneColorImages.clear();
+        for (auto &mem : m_sceneColorMemories)
+            FreeGpuMemory(m_device, mem);
+        m_sceneColorMemories.clear();
+        if (m_upscaleRenderPass != VK_NULL_HANDLE)
+        {
+            vkDestroyRenderPass(m_device, m_upscaleRenderPass, nullptr);
+            m_upscaleRenderPass = VK_NULL_HANDLE;
+        }
+        if (m_sceneRenderPass != VK_NULL_HANDLE)
+        {
+            vkDestroyRenderPass(m_device, m_sceneRenderPass, nullptr);
+            m_sceneRenderPass = VK_NULL_HANDLE;
+        }
+        m_upscaleCreated = false;
+    }
+
+    void Renderer::setDynamicResolution(bool enable)
+    {
+        if (enable && !m_dynamicResolution)
+            m_resolutionController.reset(m_renderScale);
+        m_dynamicResolution = enable;
+    }
+
+    void Renderer::setRenderScale(float scale)
+    {
+        m_fixedRenderScale = std::clamp(scale, 0.25f, 1.0f);
+    }
 
-        // Swapchain itself has been recreated by caller.
+    bool Renderer::updateRenderExtent()
+    {
+        float scale = m_dynamicResolution ? m_resolutionController.scale() : m_fixedRenderScale;
+        if (scale < 1.0f && !m_upscaleCreated && !m_upscaleFailed)
+            createUpscaleResources(); // nothing references the new resources yet: no idle wait
+        if (!m_upscaleCreated)
+            scale = 1.0f;
+
+        m_renderScale = scale;
+        m_renderExtent.width = std::max(1u, static_cast<uint32_t>(static_cast<float>(m_extent.width) * scale));
+        m_renderExtent.height = std::max(1u, static_cast<uint32_t>(static_cast<float>(m_extent.height) * scale));
+        if (scale >= 1.0f)
+            m_renderExtent = m_extent;
+        return m_renderExtent.width != m_extent.width || m_renderExtent.height != m_extent.height;
+    }
+
+    void Renderer::recordUpscale(VkCommandBuffer cmd, uint32_t imageIndex)
+    {
+        VkRenderPassBeginInfo rpBegin{};
+        rpBegin.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        rpBegin.renderPass = m_upscaleRenderPass;
+        rpBegin.framebuffer = m_framebuffers[imageIndex];
+        rpBegin.renderArea.offset = {0, 0};
+        rpBegin.renderArea.extent = m_extent;
+        vkCmdBeginRenderPass(cmd, &rpBegin, VK_SUBPASS_CONTENTS_INLINE);
+
+        m_upscalePipeline.bind(cmd);
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_upscalePipeline.getLayout(),
+                                0, 1, &m_upscaleSets[imageIndex], 0, nullptr);
+
+        VkViewport vp{};
+        vp.x = 0.0f;
+        vp.y = 0.0f;
+        vp.width = static_cast<float>(m_extent.width);
+        vp.height = static_cast<float>(m_extent.height);
+        vp.minDepth = 0.0f;
+        vp.maxDepth = 1.0f;
+        VkRect2D sc{{0, 0}, m_extent};
+        vkCmdSetViewport(cmd, 0, 1, &vp);
+        vkCmdSetScissor(cmd, 0, 1, &sc);
+
+        const float w = static_cast<float>(m_extent.width);
+        const float h = static_cast<float>(m_extent.height);
+        UpscalePush push{};
+        push.uvScale[0] = static_cast<float>(m_renderExtent.width) / w;
+        push.uvScale[1] = static_cast<float>(m_renderExtent.height) / h;
+        push.uvMax[0] = (static_cast<float>(m_renderExtent.width) - 0.5f) / w;
+        push.uvMax[1] = (static_cast<float>(m_renderExtent.height) - 0.5f) / h;
+        push.texel[0] = 1.0f / w;
+        push.texel[1] = 1.0f / h;
+        push.sharpness = m_upscaleSharpness;
+        vkCmdPushConstants(cmd, m_upscalePipeline.getLayout(), VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(push), &push);
+        vkCmdDraw(cmd, 3, 1, 0, 0);
+
+        // UI at native resolution, on top of the upscaled frame.
+        if (m_imguiRenderCallback)
+            m_imguiRenderCallback(cmd);
+
+        vkCmdEndRenderPass(cmd);
+    }
+
+    bool Renderer::resize(VkExtent2D extent)
+    {
+        if (!m_initialized || extent.width == 0 || extent.height == 0)
+            return false; // minimized: keep the current swapchain until the window comes back
+        return recreateSwapchain(extent);
+    }
+
+    bool Renderer::recreateSwapchain(VkExtent2D extent)
+    {
+        ENGINE_PROFILE_ZONE("Renderer::recreateSwapchain");
+
+        // Everything sized by the swapchain moves to the deferred queue; frames still in flight
+        // keep drawing into it and presenting from the old swapchain.
+        SwapChain::Retired oldSwapchain;
+        m_swapchain->RecreateRetiring(extent, oldSwapchain);
+        retireSwapchainTargets(oldSwapchain);
+
+        // Readbacks of the old extent are stale; buffers are re-created at the new size on demand.
+        for (auto &rb : m_depthReadbacks)
+            rb.pending = false;
+
+        const bool formatChanged = m_swapchain->GetImageFormat() != m_swapchainImageFormat;
         m_swapchainImageFormat = m_swapchain->GetImageFormat();
         m_extent = m_swapchain->GetExtent();
+        m_presentIdBase = m_presentId;
+
+        if (formatChanged)
+        {
+            // The render pass (and every pipeline made against it) is incompatible: full rebuild.
+            vkDeviceWaitIdle(m_device);
+            releaseRetiredTargets(true);
+            for (auto &p : m_passes)
+            {
+                if (p)
+                    p->onDestroy(*m_ctx);
+            }
+            destroyUpscaleResources(); // rebuilt in the new format on the next scaled frame
+            if (m_mainRenderPass != VK_NULL_HANDLE)
+            {
+                vkDestroyRenderPass(m_device, m_mainRenderPass, nullptr);
+                m_mainRenderPass = VK_NULL_HANDLE;
+            }
+        }
 
         createDepthResources();
-        createMainRenderPass();
+        if (m_mainRenderPass == VK_NULL_HANDLE)
+            createMainRenderPass();
         createFramebuffers();
 
+        if (m_upscaleCreated)
+        {
+            try
+            {
+                createUpscaleTargets();
+            }
+            catch (const std::exception &e)
+            {
+#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
+                std::cerr << "[Renderer] resolution scaling disabled: " << e.what() << "\n";
+#endif
+                // Partial targets and the pipeline go with destroyUpscaleResources() at cleanup.
+                m_upscaleCreated = false;
+                m_upscaleFailed = true;
+            }
+        }
+
+        // Pipelines use dynamic viewport/scissor: a size change only needs the new extent.
         for (auto &p : m_passes)
         {
             if (!p)
                 continue;
             p->onResize(*m_ctx, m_extent);
-            p->onCreate(*m_ctx, m_mainRenderPass, m_framebuffers);
+            if (formatChanged)
+                p->onCreate(*m_ctx, m_mainRenderPass, m_framebuffers);
+        }
+        return formatChanged;
+    }
+
+    void Renderer::retireSwapchainTargets(SwapChain::Retired &swapchain)
+    {
+        RetiredTargets retired;
+        retired.retireSerial = m_frameSerial;
+
+        retired.framebuffers = std::move(m_framebuffers);
+        retired.framebuffers.insert(retired.framebuffers.end(), m_sceneFramebuffers.begin(), m_sceneFramebuffers.end());
+        retired.imageViews = std::move(m_depthImageViews);
+        retired.imageViews.insert(retired.imageViews.end(), m_sceneColorViews.begin(), m_sceneColorViews.end());
+        retired.imageViews.insert(retired.imageViews.end(), m_depthSampleViews.begin(), m_depthSampleViews.end());
+        retired.images = std::move(m_depthImages);
+        retired.images.insert(retired.images.end(), m_sceneColorImages.begin(), m_sceneColorImages.end());
+        retired.memories = std::move(m_depthMemories);
+        retired.memories.insert(retired.memories.end(), m_sceneColorMemories.begin(), m_sceneColorMemories.end());
+        retired.descriptorPool = m_upscalePool;
+        retired.swapchain = std::move(swapchain);
+
+        m_framebuffers.clear();
+        m_depthImageViews.clear();
+        m_depthSampleViews.clear();
+        m_depthImages.clear();
+        m_depthMemories.clear();
+        m_sceneFramebuffers.clear();
+        m_sceneColorViews.clear();
+        m_sceneColorImages.clear();
+        m_sceneColorMemories.clear();
+        m_upscalePool = VK_NULL_HANDLE;
+        m_upscaleSets.clear();
+
+        m_retiredTargets.push_back(std::move(retired));
+    }
+
+    void Renderer::releaseRetiredTargets(bool all)
+    {
+        // No present fence without VK_EXT_swapchain_maintenance1: the frame's fence is the signal
+        // that its present was queued and the old swapchain's images are no longer used.
+        while (!m_retiredTargets.empty() &&
+               (all || m_retiredTargets.front().retireSerial <= m_completedFrameSerial))
+        {
+            RetiredTargets &r = m_retiredTargets.front();
+            for (VkFramebuffer fb : r.framebuffers)
+            {
+                if (fb != VK_NULL_HANDLE)
+                    vkDestroyFramebuffer(m_device, fb, nullptr);
+            }
+            for (VkImageView iv : r.imageViews)
+            {
+                if (iv != VK_NULL_HANDLE)
+                    vkDestroyImageView(m_device, iv, nullptr);
+            }
+            for (VkImage img : r.images)
+            {
+                if (img != VK_NULL_HANDLE)
+                    vkDestroyImage(m_device, img, nullptr);
+            }
+            for (GpuAllocation &mem : r.memories)
+                FreeGpuMemory(m_device, mem);
+            if (r.descriptorPool != VK_NULL_HANDLE)
+                vkDestroyDescriptorPool(m_device, r.descriptorPool, nullptr);
+            for (VkImageView iv : r.swapchain.imageViews)
+            {
+                if (iv != VK_NULL_HANDLE)
+                    vkDestroyImageView(m_device, iv, nullptr);
+            }
+            if (r.swapchain.swapchain != VK_NULL_HANDLE)
+                vkDestroySwapchainKHR(m_device, r.swapchain.swapchain, nullptr);
+            m_retiredTargets.pop_front();
         }
     }
 
@@ -441,6 +970,26 @@ namespace Engine
                 throw std::runtime_error("Renderer::createSyncObjects - failed to create fence");
             }
         }
+
+        // Async compute timelines (shared by all slots: values only ever increase).
+        m_computeTimelineValue = 0;
+        m_graphicsTimelineValue = 0;
+        if (m_ctx->HasAsyncCompute())
+        {
+            VkSemaphoreTypeCreateInfoKHR typeInfo{};
+            typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR;
+            typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+            typeInfo.initialValue = 0;
+            VkSemaphoreCreateInfo timelineInfo{};
+            timelineInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+            timelineInfo.pNext = &typeInfo;
+
+            if (vkCreateSemaphore(m_device, &timelineInfo, nullptr, &m_computeTimeline) != VK_SUCCESS ||
+                vkCreateSemaphore(m_device, &timelineInfo, nullptr, &m_graphicsTimeline) != VK_SUCCESS)
+            {
+                throw std::runtime_error("Renderer::createSyncObjects - failed to create timeline semaphores");
+            }
+        }
     }
 
     void Renderer::createCommandPoolsAndBuffers()
@@ -470,13 +1019,251 @@ namespace Engine
             {
                 throw std::runtime_error("Renderer::createCommandPoolsAndBuffers - failed to allocate command buffer");
             }
+
+            if (!m_ctx->HasAsyncCompute())
+                continue;
+
+            poolInfo.queueFamilyIndex = m_ctx->GetComputeQueueFamilyIndex();
+            if (vkCreateCommandPool(m_device, &poolInfo, nullptr, &f.computeCommandPool) != VK_SUCCESS)
+            {
+                throw std::runtime_error("Renderer::createCommandPoolsAndBuffers - failed to create compute command pool");
+            }
+
+            allocInfo.commandPool = f.computeCommandPool;
+            if (vkAllocateCommandBuffers(m_device, &allocInfo, &f.computeCommandBuffer) != VK_SUCCESS)
+            {
+                throw std::runtime_error("Renderer::createCommandPoolsAndBuffers - failed to allocate compute command buffer");
+            }
+        }
+    }
+
+    void Renderer::setFramesInFlight(uint32_t count)
+    {
+        m_framesInFlight = std::clamp(count, 1u, m_maxFrames);
+        // Slots past the new count are left alone; each slot still waits on its own fence.
+        if (m_currentFrame >= m_framesInFlight)
+            m_currentFrame = 0;
+    }
+
+    bool Renderer::isPresentWaitActive() const
+    {
+        return m_ctx->HasPresentWait() && m_latencyMode == LatencyMode::LowLatency;
+    }
+
+    void Renderer::waitForLatency()
+    {
+        m_cpuTimings.limiterWaitMs = 0.0f;
+        m_cpuTimings.latencyWaitMs = 0.0f;
+
+        if (m_frameLimiter.enabled())
+        {
+            ENGINE_PROFILE_ZONE("Renderer::frameLimiter");
+            m_cpuTimings.limiterWaitMs = m_frameLimiter.wait();
         }
+
+        if (!m_initialized || m_latencyMode != LatencyMode::LowLatency || m_lastSubmittedFrame >= m_frames.size())
+            return;
+
+        ENGINE_PROFILE_ZONE("Renderer::waitForLatency");
+        const auto t0 = std::chrono::high_resolution_clock::now();
+        bool waited = false;
+        if (m_ctx->HasPresentWait() && m_presentId > m_presentIdBase)
+        {
+            // Bounded: a minimized window or a driver that never reports the present must not hang.
+            constexpr uint64_t kPresentWaitTimeoutNs = 100ull * 1000ull * 1000ull;
+            const VkResult r = m_ctx->WaitForPresent(m_swapchain->GetSwapchain(), m_presentId, kPresentWaitTimeoutNs);
+            waited = (r == VK_SUCCESS);
+        }
+        if (!waited)
+        {
+            const FrameContext &last = m_frames[m_lastSubmittedFrame];
+            if (vkWaitForFences(m_device, 1, &last.inFlightFence, VK_TRUE, UINT64_MAX) == VK_SUCCESS &&
+                last.submittedSerialEnd > m_completedFrameSerial)
+                m_completedFrameSerial = last.submittedSerialEnd;
+        }
+        m_cpuTimings.latencyWaitMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - t0).count();
+    }
+
+    void Renderer::setCamera(Camera *camera)
+    {
+        m_camera = camera;
+        m_shadows.setCamera(camera);
+    }
+
+    void Renderer::beginUploadFrame(FrameContext &frame)
+    {
+        frame.uploads = nullptr;
+        frame.cameraOffset = 0;
+        frame.camera = nullptr;
+        m_cameraMapped = nullptr;
+        if (!m_uploadRing.valid())
+            return;
+
+        // The slot's fence was waited on: the GPU is done with its segment.
+        m_uploadRing.beginFrame(m_currentFrame);
+        FrameUploadRing::Allocation block;
+        if (!m_uploadRing.allocateUniform(sizeof(CameraBlock), block))
+            return;
+        frame.uploads = &m_uploadRing;
+        frame.cameraOffset = block.dynamicOffset();
+        m_cameraMapped = block.mapped;
+    }
+
+    void Renderer::writeCameraBlock(FrameContext &frame)
+    {
+        const float w = static_cast<float>(std::max(1u, m_extent.width));
+        const float h = static_cast<float>(std::max(1u, m_extent.height));
+        CameraBlock &b = m_cameraBlock;
+        if (m_camera)
+        {
+            m_camera->SetAspect(w / h);
+            b.view = m_camera->GetViewMatrix();
+            b.proj = m_camera->GetProjectionMatrix();
+            b.position = glm::vec4(m_camera->GetPosition(), 1.0f);
+        }
+        else
+        {
+            b.view = glm::lookAt(glm::vec3(0, 0, 3), glm::vec3(0, 0, 0), glm::vec3(0, 1, 0));
+            b.proj = glm::perspective(glm::radians(60.0f), w / h, 0.1f, 100.0f);
+            b.proj[1][1] *= -1.0f;
+            b.position = glm::vec4(0.0f, 0.0f, 3.0f, 1.0f);
+        }
+        b.viewport = glm::vec4(w, h, 1.0f / w, 1.0f / h);
+        b.viewProj = b.proj * b.view;
+
+        if (m_cameraMapped)
+            std::memcpy(m_cameraMapped, &b, sizeof(CameraBlock));
+        frame.camera = &m_cameraBlock;
+    }
+
+    void Renderer::beginShadowFrame(FrameContext &frame)
+    {
+        frame.shadow = nullptr;
+        m_passShadowCasters.assign(m_passes.size(), ShadowCaster::None);
+        if (!m_shadows.created())
+            return;
+
+        // Static content: every static pass's version mixed with its index, so a pass turning
+        // static or leaving also invalidates the cache.
+        uint64_t staticVersion = 0;
+        bool hasDynamic = false;
+        for (size_t i = 0; i < m_passes.size(); ++i)
+        {
+            if (!m_passes[i])
+                continue;
+            const ShadowCaster caster = m_passes[i]->shadowCaster();
+            m_passShadowCasters[i] = caster;
+            if (caster == ShadowCaster::Static)
+            {
+                staticVersion ^= m_passes[i]->shadowContentVersion() + (static_cast<uint64_t>(i) + 1u) * 0x9E3779B97F4A7C15ull;
+                staticVersion *= 0x100000001B3ull;
+            }
+            else if (caster == ShadowCaster::Dynamic)
+            {
+                hasDynamic = true;
+            }
+        }
+        frame.shadow = &m_shadows.beginFrame(m_currentFrame, staticVersion, hasDynamic);
+    }
+
+    void Renderer::recordShadows(FrameContext &frame)
+    {
+        if (!frame.shadow)
+            return;
+        const ShadowFrame &shadow = *frame.shadow;
+        if (shadow.staticMask == 0u && !shadow.dynamic)
+            return;
+        ENGINE_PROFILE_ZONE("Renderer::shadows");
+
+        auto drawLayer = [&](uint32_t cascade, ShadowCaster layer)
+        {
+            const ShadowCasterInfo info = m_shadows.beginCascade(frame.commandBuffer, m_currentFrame, cascade, layer);
+            for (size_t i = 0; i < m_passes.size(); ++i)
+            {
+                if (m_passes[i] && m_passShadowCasters[i] == layer)
+                    m_passes[i]->recordShadow(frame, frame.commandBuffer, info);
+            }
+            m_shadows.endCascade(frame.commandBuffer);
+        };
+
+        for (uint32_t c = 0; c < shadow.cascadeCount; ++c)
+        {
+            if (shadow.staticMask & (1u << c))
+                drawLayer(c, ShadowCaster::Static);
+        }
+        m_shadows.markStaticDrawn(shadow.staticMask);
+
+        if (shadow.dynamic)
+        {
+            for (uint32_t c = 0; c < shadow.cascadeCount; ++c)
+                drawLayer(c, ShadowCaster::Dynamic);
+        }
+    }
+
+    bool Renderer::submitAsyncCompute(FrameContext &frame)
+    {
+        frame.asyncCompute = isAsyncComputeActive() && frame.computeCommandBuffer != VK_NULL_HANDLE;
+        frame.computeWaitsForGraphics = false;
+        if (!frame.asyncCompute)
+            return false;
+        ENGINE_PROFILE_ZONE("Renderer::asyncCompute");
+
+        // The slot's fence covers its previous compute submit too: that graphics submit waited for it.
+        vkResetCommandBuffer(frame.computeCommandBuffer, 0);
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        vkBeginCommandBuffer(frame.computeCommandBuffer, &beginInfo);
+
+        bool recorded = false;
+        for (auto &p : m_passes)
+        {
+            if (p && p->recordAsyncCompute(frame, frame.computeCommandBuffer))
+                recorded = true;
+        }
+        vkEndCommandBuffer(frame.computeCommandBuffer);
+        if (!recorded)
+            return false;
+
+        const bool waitGraphics = frame.computeWaitsForGraphics && m_graphicsTimelineValue > 0;
+        const uint64_t waitValue = m_graphicsTimelineValue;
+        const uint64_t signalValue = m_computeTimelineValue + 1;
+        const VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT;
+
+        VkTimelineSemaphoreSubmitInfoKHR timelineInfo{};
+        timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+        timelineInfo.waitSemaphoreValueCount = waitGraphics ? 1u : 0u;
+        timelineInfo.pWaitSemaphoreValues = &waitValue;
+        timelineInfo.signalSemaphoreValueCount = 1;
+        timelineInfo.pSignalSemaphoreValues = &signalValue;
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.pNext = &timelineInfo;
+        submitInfo.waitSemaphoreCount = waitGraphics ? 1u : 0u;
+        submitInfo.pWaitSemaphores = &m_graphicsTimeline;
+        submitInfo.pWaitDstStageMask = &waitStage;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &frame.computeCommandBuffer;
+        submitInfo.signalSemaphoreCount = 1;
+        submitInfo.pSignalSemaphores = &m_computeTimeline;
+        if (vkQueueSubmit(m_computeQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+            return false;
+
+        m_computeTimelineValue = signalValue;
+        return true;
+    }
+
+    void Renderer::applyPendingSwapchainChange()
+    {
+        recreateSwapchain(m_swapchain->GetExtent());
     }
 
     void Renderer::drawFrame()
     {
         if (!m_initialized)
             return;
+        ENGINE_PROFILE_ZONE("Renderer::drawFrame");
 
         using Clock = std::chrono::high_resolution_clock;
         auto msSince = [](Clock::time_point a, Clock::time_point b) -> float
@@ -495,18 +1282,26 @@ namespace Engine
                 m_cpuTimings.cmdBeginMs +
                 m_cpuTimings.timestampResetMs +
                 m_cpuTimings.renderPassBeginMs +
+                m_cpuTimings.shadowRecordMs +
                 m_cpuTimings.passesRecordMs +
                 m_cpuTimings.imguiRecordMs +
                 m_cpuTimings.renderPassEndMs +
                 m_cpuTimings.cmdEndMs +
+                m_cpuTimings.asyncComputeMs +
+                m_cpuTimings.latchMs +
                 m_cpuTimings.submitMs +
                 m_cpuTimings.queryResultsMs +
                 m_cpuTimings.presentMs;
             m_cpuTimings.otherMs = m_cpuTimings.drawFrameTotalMs - accounted;
         };
 
+        // Present mode changes need a new swapchain; do it before this frame touches any slot.
+        if (m_swapchain->IsRecreatePending())
+            applyPendingSwapchainChange();
+
         FrameContext &frame = m_frames[m_currentFrame];
         frame.frameIndex = m_currentFrame;
+        frame.depthPrepass = m_depthPrepass;
 
         // Clear per-pass timings each frame (reused storage).
         if (m_passCpuTimings.size() != m_passes.size())
@@ -524,9 +1319,17 @@ namespace Engine
 
         // Wait for previous frame to finish
         auto t0 = Clock::now();
-        VkResult r = vkWaitForFences(m_device, 1, &frame.inFlightFence, VK_TRUE, UINT64_MAX);
+        VkResult r;
+        {
+            ENGINE_PROFILE_ZONE("Renderer::waitFence");
+            r = vkWaitForFences(m_device, 1, &frame.inFlightFence, VK_TRUE, UINT64_MAX);
+        }
         auto t1 = Clock::now();
         m_cpuTimings.waitFenceMs = msSince(t0, t1);
+        if (r == VK_SUCCESS && frame.submittedSerialEnd > m_completedFrameSerial)
+            m_completedFrameSerial = frame.submittedSerialEnd;
+        if (r == VK_SUCCESS && !m_retiredTargets.empty())
+            releaseRetiredTargets(false);
         if (r != VK_SUCCESS)
         {
             fprintf(stderr, "vkWaitForFences failed: %d\n", r);
@@ -542,7 +1345,7 @@ namespace Engine
         {
             const auto queryT0 = Clock::now();
 
-            const uint32_t completedStartQuery = m_currentFrame * 2;
+            const uint32_t completedStartQuery = m_currentFrame * TIMESTAMPS_PER_FRAME;
             uint64_t timestamps[2] = {0, 0};
             VkResult queryResult = vkGetQueryPoolResults(
                 m_device,
@@ -559,12 +1362,34 @@ namespace Engine
                 const uint64_t ticksDelta = timestamps[1] - timestamps[0];
                 const float nanoseconds = static_cast<float>(ticksDelta) * m_timestampPeriod;
                 m_gpuTimeMs = nanoseconds / 1000000.0f;
+                if (m_dynamicResolution)
+                    m_resolutionController.update(m_gpuTimeMs);
             }
+            readPassGpuTimings(m_currentFrame);
 
             const auto queryT1 = Clock::now();
             m_cpuTimings.queryResultsMs = msSince(queryT0, queryT1);
         }
 
+        // Deliver the depth copy made by this slot's previous submission (complete after the fence wait).
+        if (m_currentFrame < m_depthReadbacks.size())
+        {
+            DepthReadbackSlot &rb = m_depthReadbacks[m_currentFrame];
+            if (rb.pending && m_depthReadbackCallback && rb.memory.mapped)
+            {
+                DepthReadback out{};
+                out.data = rb.memory.mapped;
+                out.width = rb.copied.width;
+                out.height = rb.copied.height;
+                out.format = m_depthFormat;
+                out.frameSerial = rb.frameSerial;
+                m_depthReadbackCallback(out);
+            }
+            rb.pending = false;
+        }
+        if (m_hiZReadbackCallback)
+            deliverHiZReadbacks();
+
         // Acquire next image
         t0 = Clock::now();
         uint32_t imageIndex = 0;
@@ -581,9 +1406,7 @@ namespace Engine
         if (acquireRes == VK_ERROR_OUT_OF_DATE_KHR)
         {
             // Window resized or swapchain invalid -> recreate and skip this frame
-            m_swapchain->Recreate(m_extent);
-            // Framebuffers/renderpass depend on swapchain.
-            recreateSwapchainDependent();
+            recreateSwapchain(m_extent);
             finalizeCpuTotals();
             return; // IMPORTANT: we did NOT reset the fence, so next frame’s wait will pass.
         }
@@ -594,6 +1417,17 @@ namespace Engine
             return; // Do not reset the fence on failure paths
         }
 
+        const bool scaled = updateRenderExtent();
+        frame.renderExtent = m_renderExtent;
+        const bool hiZ = hiZActive();
+        frame.hiZPyramid = hiZ ? m_hiZ.bufferFor(m_frameSerial) : VK_NULL_HANDLE;
+        beginUploadFrame(frame);
+
+        // Compute first: it can start while the previous frame's graphics work is still running.
+        t0 = Clock::now();
+        const bool waitForCompute = submitAsyncCompute(frame);
+        m_cpuTimings.asyncComputeMs = msSince(t0, Clock::now());
+
         // Record command buffer
         t0 = Clock::now();
         vkResetCommandBuffer(frame.commandBuffer, 0);
@@ -610,68 +1444,209 @@ namespace Engine
 
         t0 = Clock::now();
 
-        // GPU timestamp: reset queries for this frame
-        const uint32_t startQuery = m_currentFrame * 2;
+        // GPU timestamp: reset queries for this frame (frame pair and every per-pass query;
+        // resets must happen outside the render pass, so secondaries only write)
+        const uint32_t startQuery = m_currentFrame * TIMESTAMPS_PER_FRAME;
         const uint32_t endQuery = startQuery + 1;
+        m_frameStatsActive = m_pipelineStatsEnabled && m_pipelineStatsQueryPool != VK_NULL_HANDLE;
+        if (m_currentFrame < m_gpuQuerySlots.size())
+        {
+            GpuQuerySlot &slot = m_gpuQuerySlots[m_currentFrame];
+            const size_t timed = std::min<size_t>(m_passes.size(), MAX_GPU_TIMED_PASSES);
+            slot.passNames.resize(timed);
+            for (size_t i = 0; i < timed; ++i)
+                slot.passNames[i] = m_passes[i] ? m_passes[i]->getDebugName() : "";
+            slot.pipelineStats = m_frameStatsActive;
+        }
         if (m_timestampsSupported && m_timestampQueryPool != VK_NULL_HANDLE)
         {
-            vkCmdResetQueryPool(frame.commandBuffer, m_timestampQueryPool, startQuery, 2);
+            vkCmdResetQueryPool(frame.commandBuffer, m_timestampQueryPool, startQuery, TIMESTAMPS_PER_FRAME);
             // Write start timestamp (at top of pipe for earliest possible time)
             vkCmdWriteTimestamp(frame.commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_timestampQueryPool, startQuery);
         }
+        if (m_frameStatsActive)
+        {
+            vkCmdResetQueryPool(frame.commandBuffer, m_pipelineStatsQueryPool,
+                                m_currentFrame * STATS_PER_FRAME, STATS_PER_FRAME);
+        }
         t1 = Clock::now();
         m_cpuTimings.timestampResetMs = msSince(t0, t1);
 
-        // Begin render pass
+        // Cascades first: pre-passes upload what their shadow draws need.
+        beginShadowFrame(frame);
+
+        const bool secondary = shouldRecordSecondary() &&
+                               ensureSecondaryPools(m_currentFrame, m_jobSystem->workerCount() + 1u);
+
+        // Frame graph: the renderer's own passes plus whatever the modules add around the scene.
+        // The swapchain image waits for the acquire semaphore (COLOR_ATTACHMENT_OUTPUT).
+        m_graph.beginFrame(m_currentFrame);
+        const VkImageAspectFlags depthAspect = depthAspectFlags(m_depthFormat);
+        const RGResource swapchainImage = m_graph.importImage("Swapchain", m_swapchain->GetImages()[imageIndex],
+                                                              m_swapchain->GetImageViews()[imageIndex], VK_IMAGE_ASPECT_COLOR_BIT,
+                                                              VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, true);
+        m_graphTargets.depth = m_graph.importImage("SceneDepth", m_depthImages[imageIndex], m_depthImageViews[imageIndex], depthAspect,
+                                                   VK_IMAGE_LAYOUT_UNDEFINED,
+                                                   VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, false);
+        m_graphTargets.color = scaled ? m_graph.importImage("SceneColor", m_sceneColorImages[imageIndex], m_sceneColorViews[imageIndex],
+                                                            VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_UNDEFINED,
+                                                            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, false)
+                                      : swapchainImage;
+
+        // Pre-pass work (compute culling etc.) must be recorded outside the render pass; it
+        // writes module-owned buffers the graph does not see.
+        m_graph.addPass("PrePasses", [](RenderGraph::PassBuilder &b)
+                        { b.sideEffect(); },
+                        [&](VkCommandBuffer cmd, const RenderGraph &)
+                        {
+                            for (size_t i = 0; i < m_passes.size(); ++i)
+                            {
+                                auto &p = m_passes[i];
+                                if (p)
+                                {
+                                    ENGINE_PROFILE_ZONE(p->getDebugName());
+                                    beginPassQueries(cmd, i, true);
+                                    p->recordPrePass(frame, cmd);
+                                    endPassQueries(cmd, i, true);
+                                }
+                            }
+                        });
+
+        // The cascade maps are persistent (static ones are cached across frames) and synchronized
+        // by the shadow render pass itself.
+        m_graph.addPass("Shadows", [](RenderGraph::PassBuilder &b)
+                        { b.sideEffect(); },
+                        [&](VkCommandBuffer, const RenderGraph &)
+                        {
+                            const auto s0 = Clock::now();
+                            recordShadows(frame);
+                            m_cpuTimings.shadowRecordMs = msSince(s0, Clock::now());
+                        });
+
+        for (auto &p : m_passes)
+        {
+            if (p)
+                p->buildGraph(frame, m_graph, GraphStage::BeforeScene, m_graphTargets);
+        }
+
+        // Scaled: offscreen target, only its top-left render extent is drawn (and cleared).
+        VkRenderPassBeginInfo rpBegin{};
         VkClearValue clears[2]{};
         clears[0].color = {{0.02f, 0.02f, 0.04f, 1.0f}};
         clears[1].depthStencil = {1.0f, 0};
-
-        VkRenderPassBeginInfo rpBegin{};
         rpBegin.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-        rpBegin.renderPass = m_mainRenderPass;
-        rpBegin.framebuffer = m_framebuffers[imageIndex];
+        rpBegin.renderPass = scaled ? m_sceneRenderPass : m_mainRenderPass;
+        rpBegin.framebuffer = scaled ? m_sceneFramebuffers[imageIndex] : m_framebuffers[imageIndex];
         rpBegin.renderArea.offset = {0, 0};
-        rpBegin.renderArea.extent = m_extent;
+        rpBegin.renderArea.extent = m_renderExtent;
         rpBegin.clearValueCount = 2;
         rpBegin.pClearValues = clears;
 
-        t0 = Clock::now();
-        vkCmdBeginRenderPass(frame.commandBuffer, &rpBegin, VK_SUBPASS_CONTENTS_INLINE);
-        t1 = Clock::now();
-        m_cpuTimings.renderPassBeginMs = msSince(t0, t1);
+        m_graph.addPass("Scene", [&](RenderGraph::PassBuilder &b)
+                        {
+                            b.attach(m_graphTargets.color, RGAccess::ColorAttachment,
+                                     scaled ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+                            b.attach(m_graphTargets.depth, RGAccess::DepthAttachment, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+                        },
+                        [&](VkCommandBuffer cmd, const RenderGraph &)
+                        {
+                            auto s0 = Clock::now();
+                            vkCmdBeginRenderPass(cmd, &rpBegin,
+                                                 secondary ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE);
+                            m_cpuTimings.renderPassBeginMs = msSince(s0, Clock::now());
+
+                            if (secondary)
+                            {
+                                // Passes + ImGui into secondary buffers; timings are filled in by the helper.
+                                recordPassesSecondary(frame, rpBegin.renderPass, rpBegin.framebuffer, !scaled);
+                            }
+                            else
+                            {
+                                // Let modules record draw commands, phase-major
+                                s0 = Clock::now();
+                                for (uint32_t phase = 0; phase < RENDER_PHASE_COUNT; ++phase)
+                                {
+                                    for (size_t i = 0; i < m_passes.size(); ++i)
+                                    {
+                                        if (m_passes[i])
+                                            recordPassPhase(frame, cmd, i, static_cast<RenderPhase>(phase));
+                                    }
+                                }
+                                m_cpuTimings.passesRecordMs = msSince(s0, Clock::now());
+
+                                // Render ImGui if callback is set (after the upscale when scaled)
+                                s0 = Clock::now();
+                                if (m_imguiRenderCallback && !scaled)
+                                    m_imguiRenderCallback(cmd);
+                                m_cpuTimings.imguiRecordMs = msSince(s0, Clock::now());
+                            }
+
+                            s0 = Clock::now();
+                            vkCmdEndRenderPass(cmd);
+                            m_cpuTimings.renderPassEndMs = msSince(s0, Clock::now());
+                        });
 
-        // Let modules record draw commands
-        t0 = Clock::now();
-        for (size_t i = 0; i < m_passes.size(); ++i)
+        for (auto &p : m_passes)
         {
-            auto &p = m_passes[i];
-            if (!p)
-                continue;
+            if (p)
+                p->buildGraph(frame, m_graph, GraphStage::AfterScene, m_graphTargets);
+        }
 
-            const auto passT0 = Clock::now();
-            p->record(frame, frame.commandBuffer);
-            const auto passT1 = Clock::now();
+        // Hi-Z pyramid of this frame's depth for the next frame's culls; writes renderer-owned
+        // buffers the graph does not see.
+        if (hiZ && frame.uploads)
+        {
+            m_graph.addPass("HiZBuild", [&](RenderGraph::PassBuilder &b)
+                            {
+                                b.read(m_graphTargets.depth, RGAccess::ComputeSampled);
+                                b.sideEffect();
+                            },
+                            [this, &frame, imageIndex](VkCommandBuffer cmd, const RenderGraph &)
+                            {
+                                m_hiZ.record(cmd, m_currentFrame, m_frameSerial, m_completedFrameSerial,
+                                             m_depthSampleViews[imageIndex], m_renderExtent, m_extent,
+                                             frame.uploads->buffer(), frame.cameraOffset,
+                                             static_cast<bool>(m_hiZReadbackCallback));
+                            });
+        }
 
-            m_passCpuTimings[i].name = p->getDebugName();
-            m_passCpuTimings[i].recordMs = msSince(passT0, passT1);
+        if (m_depthReadbackCallback)
+        {
+            if (m_depthReadbacks.size() != m_maxFrames)
+                m_depthReadbacks.resize(m_maxFrames);
+            DepthReadbackSlot &rb = m_depthReadbacks[m_currentFrame];
+            if (ensureDepthReadback(rb))
+            {
+                const RGResource readback = m_graph.importBuffer("DepthReadback", rb.buffer, true);
+                m_graph.addPass("DepthReadback", [&](RenderGraph::PassBuilder &b)
+                                {
+                                    b.read(m_graphTargets.depth, RGAccess::TransferSrc);
+                                    b.write(readback, RGAccess::TransferDst);
+                                },
+                                [this, imageIndex, &rb](VkCommandBuffer cmd, const RenderGraph &)
+                                { recordDepthReadback(cmd, imageIndex, m_renderExtent, rb); });
+            }
         }
-        t1 = Clock::now();
-        m_cpuTimings.passesRecordMs = msSince(t0, t1);
 
-        // Render ImGui if callback is set
-        t0 = Clock::now();
-        if (m_imguiRenderCallback)
+        if (scaled)
         {
-            m_imguiRenderCallback(frame.commandBuffer);
+            m_graph.addPass("Upscale", [&](RenderGraph::PassBuilder &b)
+                            {
+                                b.read(m_graphTargets.color, RGAccess::FragmentSampled);
+                                b.attach(swapchainImage, RGAccess::ColorAttachment, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+                            },
+                            [&](VkCommandBuffer cmd, const RenderGraph &)
+                            {
+                                const auto s0 = Clock::now();
+                                recordUpscale(cmd, imageIndex);
+                                m_cpuTimings.imguiRecordMs += msSince(s0, Clock::now());
+                            });
         }
-        t1 = Clock::now();
-        m_cpuTimings.imguiRecordMs = msSince(t0, t1);
 
-        t0 = Clock::now();
-        vkCmdEndRenderPass(frame.commandBuffer);
-        t1 = Clock::now();
-        m_cpuTimings.renderPassEndMs = msSince(t0, t1);
+        m_cpuTimings.shadowRecordMs = 0.0f;
+        m_cpuTimings.passesRecordMs = 0.0f;
+        m_cpuTimings.imguiRecordMs = 0.0f;
+        m_graph.execute(frame.commandBuffer);
 
         // GPU timestamp: write end timestamp (at bottom of pipe for latest possible time)
         if (m_timestampsSupported && m_timestampQueryPool != VK_NULL_HANDLE)
@@ -690,26 +1665,68 @@ namespace Engine
             m_cpuTimings.cmdBeginMs +
             m_cpuTimings.timestampResetMs +
             m_cpuTimings.renderPassBeginMs +
+            m_cpuTimings.shadowRecordMs +
             m_cpuTimings.passesRecordMs +
             m_cpuTimings.imguiRecordMs +
             m_cpuTimings.renderPassEndMs +
             m_cpuTimings.cmdEndMs;
 
-        // Submit to graphics queue
+        // Late latch: recording is done, so camera UBOs written now reflect the newest input.
         t0 = Clock::now();
-        VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT};
+        {
+            ENGINE_PROFILE_ZONE("Renderer::latchCamera");
+            if (m_lateLatchCallback)
+                m_lateLatchCallback();
+            writeCameraBlock(frame);
+            for (auto &p : m_passes)
+            {
+                if (p)
+                    p->latchCamera(frame);
+            }
+        }
+        t1 = Clock::now();
+        m_cpuTimings.latchMs = msSince(t0, t1);
+
+        // Submit to graphics queue. With async compute, indirect draws and vertex shading wait for
+        // this frame's compute submit and the graphics timeline counts the submit.
+        t0 = Clock::now();
+        VkSemaphore waitSemaphores[] = {frame.imageAcquiredSemaphore, m_computeTimeline};
+        VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
+                                             VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT};
+        const uint64_t waitValues[] = {0, m_computeTimelineValue}; // binary semaphores ignore values
+        VkSemaphore signalSemaphores[] = {frame.renderFinishedSemaphore, m_graphicsTimeline};
+        const uint64_t signalValues[] = {0, m_graphicsTimelineValue + 1};
+        const bool signalTimeline = m_graphicsTimeline != VK_NULL_HANDLE;
+
         VkSubmitInfo submitInfo{};
         submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submitInfo.waitSemaphoreCount = 1;
-        submitInfo.pWaitSemaphores = &frame.imageAcquiredSemaphore;
+        submitInfo.waitSemaphoreCount = waitForCompute ? 2u : 1u;
+        submitInfo.pWaitSemaphores = waitSemaphores;
         submitInfo.pWaitDstStageMask = waitStages;
         submitInfo.commandBufferCount = 1;
         submitInfo.pCommandBuffers = &frame.commandBuffer;
-        submitInfo.signalSemaphoreCount = 1;
-        submitInfo.pSignalSemaphores = &frame.renderFinishedSemaphore;
+        submitInfo.signalSemaphoreCount = signalTimeline ? 2u : 1u;
+        submitInfo.pSignalSemaphores = signalSemaphores;
+
+        VkTimelineSemaphoreSubmitInfoKHR timelineInfo{};
+        if (signalTimeline)
+        {
+            timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+            timelineInfo.waitSemaphoreValueCount = submitInfo.waitSemaphoreCount;
+            timelineInfo.pWaitSemaphoreValues = waitValues;
+            timelineInfo.signalSemaphoreValueCount = submitInfo.signalSemaphoreCount;
+            timelineInfo.pSignalSemaphoreValues = signalValues;
+            submitInfo.pNext = &timelineInfo;
+        }
 
         vkResetFences(m_device, 1, &frame.inFlightFence);
-        vkQueueSubmit(m_graphicsQueue, 1, &submitInfo, frame.inFlightFence);
+        if (vkQueueSubmit(m_graphicsQueue, 1, &submitInfo, frame.inFlightFence) == VK_SUCCESS)
+        {
+            frame.submittedSerialEnd = m_frameSerial + 1;
+            if (signalTimeline)
+                m_graphicsTimelineValue += 1;
+        }
+        m_lastSubmittedFrame = m_currentFrame;
         t1 = Clock::now();
         m_cpuTimings.submitMs = msSince(t0, t1);
 
@@ -724,13 +1741,380 @@ namespace Engine
         presentInfo.pSwapchains = swapchains;
         presentInfo.pImageIndices = &imageIndex;
 
-        vkQueuePresentKHR(m_presentQueue, &presentInfo);
+        // Present id for VK_KHR_present_wait pacing (waitForLatency).
+        VkPresentIdKHR presentId{};
+        uint64_t presentIdValue = 0;
+        if (m_ctx->HasPresentWait())
+        {
+            presentIdValue = m_presentId + 1;
+            presentId.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+            presentId.swapchainCount = 1;
+            presentId.pPresentIds = &presentIdValue;
+            presentInfo.pNext = &presentId;
+        }
+
+        {
+            ENGINE_PROFILE_ZONE("Renderer::present");
+            vkQueuePresentKHR(m_presentQueue, &presentInfo);
+        }
+        if (presentIdValue != 0)
+            m_presentId = presentIdValue;
         t1 = Clock::now();
         m_cpuTimings.presentMs = msSince(t0, t1);
 
         finalizeCpuTotals();
         // Advance frame index
-        m_currentFrame = (m_currentFrame + 1) % m_maxFrames;
+        m_currentFrame = (m_currentFrame + 1) % m_framesInFlight;
+        ++m_frameSerial;
+    }
+
+    bool Renderer::shouldRecordSecondary() const
+    {
+        if (!m_parallelRecording || !m_jobSystem || m_jobSystem->workerCount() == 0u)
+            return false;
+
+        // A single pass gains nothing from another thread and pays for the secondary buffer.
+        uint32_t passCount = 0;
+        for (const auto &p : m_passes)
+        {
+            if (p)
+                ++passCount;
+        }
+        return passCount >= 2u;
+    }
+
+    bool Renderer::ensureSecondaryPools(uint32_t frameSlot, uint32_t threadCount)
+    {
+        if (m_secondaryPools.size() != m_maxFrames)
+            m_secondaryPools.resize(m_maxFrames);
+
+        auto &pools = m_secondaryPools[frameSlot];
+        while (pools.size() < threadCount)
+        {
+            VkCommandPoolCreateInfo poolInfo{};
+            poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+            poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+            poolInfo.queueFamilyIndex = m_ctx->GetGraphicsQueueFamilyIndex();
+
+            SecondaryPool sp{};
+            if (vkCreateCommandPool(m_device, &poolInfo, nullptr, &sp.pool) != VK_SUCCESS)
+                return false;
+            pools.push_back(std::move(sp));
+        }
+
+        // The slot's fence has signaled: everything recorded from these pools has executed.
+        for (SecondaryPool &sp : pools)
+        {
+            if (sp.used > 0u)
+                vkResetCommandPool(m_device, sp.pool, 0);
+            sp.used = 0;
+        }
+        return true;
+    }
+
+    void Renderer::destroySecondaryPools()
+    {
+        for (auto &pools : m_secondaryPools)
+        {
+            for (SecondaryPool &sp : pools)
+            {
+                // Destroying the pool frees its command buffers.
+                if (sp.pool != VK_NULL_HANDLE)
+                    vkDestroyCommandPool(m_device, sp.pool, nullptr);
+            }
+        }
+        m_secondaryPools.clear();
+        m_passSecondaries.clear();
+    }
+
+    VkCommandBuffer Renderer::acquireSecondary(uint32_t frameSlot, uint32_t threadIndex)
+    {
+        auto &pools = m_secondaryPools[frameSlot];
+        SecondaryPool &sp = pools[std::min<size_t>(threadIndex, pools.size() - 1u)];
+        if (sp.used == sp.buffers.size())
+        {
+            VkCommandBufferAllocateInfo allocInfo{};
+            allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            allocInfo.commandPool = sp.pool;
+            allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+            allocInfo.commandBufferCount = 1;
+
+            VkCommandBuffer cmd = VK_NULL_HANDLE;
+            if (vkAllocateCommandBuffers(m_device, &allocInfo, &cmd) != VK_SUCCESS)
+                return VK_NULL_HANDLE;
+            sp.buffers.push_back(cmd);
+        }
+        return sp.buffers[sp.used++];
+    }
+
+    void Renderer::recordPassesSecondary(FrameContext &frame, VkRenderPass renderPass, VkFramebuffer framebuffer, bool withImGui)
+    {
+        using Clock = std::chrono::high_resolution_clock;
+        auto msSince = [](const Clock::time_point &a, const Clock::time_point &b) -> float
+        {
+            return std::chrono::duration<float, std::milli>(b - a).count();
+        };
+
+        const uint32_t frameSlot = m_currentFrame;
+        const uint32_t callerThread = m_jobSystem->workerCount();
+
+        VkCommandBufferInheritanceInfo inherit{};
+        inherit.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+        inherit.renderPass = renderPass;
+        inherit.subpass = 0;
+        inherit.framebuffer = framebuffer;
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+        beginInfo.pInheritanceInfo = &inherit;
+
+        const size_t passCount = m_passes.size();
+        m_passSecondaries.assign(passCount * RENDER_PHASE_COUNT, VK_NULL_HANDLE);
+
+        // All phases of one pass on one thread, each into its own secondary buffer.
+        auto recordPass = [&](uint32_t threadIndex, size_t i)
+        {
+            auto &p = m_passes[i];
+            for (uint32_t phase = 0; phase < RENDER_PHASE_COUNT; ++phase)
+            {
+                if (!p->recordsPhases() && static_cast<RenderPhase>(phase) != RenderPhase::Opaque)
+                    continue;
+                VkCommandBuffer cmd = acquireSecondary(frameSlot, threadIndex);
+                if (cmd == VK_NULL_HANDLE)
+                    return;
+
+                vkBeginCommandBuffer(cmd, &beginInfo);
+                recordPassPhase(frame, cmd, i, static_cast<RenderPhase>(phase));
+                vkEndCommandBuffer(cmd);
+                m_passSecondaries[phase * passCount + i] = cmd;
+            }
+        };
+
+        auto t0 = Clock::now();
+        // One pass per task; each worker only touches its own pool, so no locking is needed.
+        m_jobSystem->parallelForRange(0u, static_cast<uint32_t>(m_passes.size()), 1u,
+                                      [&](uint32_t workerIndex, uint32_t first, uint32_t last)
+                                      {
+                                          for (uint32_t i = first; i < last; ++i)
+                                          {
+                                              if (m_passes[i] && m_passes[i]->supportsParallelRecord())
+                                                  recordPass(workerIndex, i);
+                                          }
+                                      });
+        for (size_t i = 0; i < m_passes.size(); ++i)
+        {
+            if (m_passes[i] && !m_passes[i]->supportsParallelRecord())
+                recordPass(callerThread, i);
+        }
+        auto t1 = Clock::now();
+        m_cpuTimings.passesRecordMs = msSince(t0, t1);
+
+        // ImGui last, on the calling thread (ImGui state is not thread-safe).
+        t0 = Clock::now();
+        VkCommandBuffer imguiCmd = VK_NULL_HANDLE;
+        if (m_imguiRenderCallback && withImGui)
+        {
+            imguiCmd = acquireSecondary(frameSlot, callerThread);
+            if (imguiCmd != VK_NULL_HANDLE)
+            {
+                vkBeginCommandBuffer(imguiCmd, &beginInfo);
+                m_imguiRenderCallback(imguiCmd);
+                vkEndCommandBuffer(imguiCmd);
+            }
+        }
+
+        // Phase-major, registration order inside a phase: same draw order as inline recording.
+        std::vector<VkCommandBuffer> &order = m_passSecondaries;
+        order.erase(std::remove(order.begin(), order.end(), VK_NULL_HANDLE), order.end());
+        if (imguiCmd != VK_NULL_HANDLE)
+            order.push_back(imguiCmd);
+        if (!order.empty())
+            vkCmdExecuteCommands(frame.commandBuffer, static_cast<uint32_t>(order.size()), order.data());
+        t1 = Clock::now();
+        m_cpuTimings.imguiRecordMs = msSince(t0, t1);
+    }
+
+    void Renderer::recordPassPhase(FrameContext &frame, VkCommandBuffer cmd, size_t passIndex, RenderPhase phase)
+    {
+        using Clock = std::chrono::high_resolution_clock;
+
+        RenderPassModule &p = *m_passes[passIndex];
+        const bool phased = p.recordsPhases();
+        if (!phased && phase != RenderPhase::Opaque)
+            return;
+
+        // GPU queries bracket one command range per pass: the Opaque phase.
+        const bool timed = phase == RenderPhase::Opaque;
+        const auto t0 = Clock::now();
+        {
+            ENGINE_PROFILE_ZONE(p.getDebugName());
+            if (timed)
+                beginPassQueries(cmd, passIndex, false);
+            if (phased)
+                p.recordPhase(frame, cmd, phase);
+            else
+                p.record(frame, cmd);
+            if (timed)
+                endPassQueries(cmd, passIndex, false);
+        }
+        const auto t1 = Clock::now();
+
+        m_passCpuTimings[passIndex].name = p.getDebugName();
+        m_passCpuTimings[passIndex].recordMs += std::chrono::duration<float, std::milli>(t1 - t0).count();
+    }
+
+    void Renderer::setDepthReadbackCallback(DepthReadbackCallback callback)
+    {
+        m_depthReadbackCallback = std::move(callback);
+        if (!m_depthReadbackCallback && m_initialized && !m_depthReadbacks.empty())
+        {
+            // Buffers may still be referenced by in-flight frames.
+            vkDeviceWaitIdle(m_device);
+            destroyDepthReadbacks();
+        }
+    }
+
+    void Renderer::setHiZReadbackCallback(HiZReadbackCallback callback)
+    {
+        m_hiZReadbackCallback = std::move(callback);
+        if (!m_hiZReadbackCallback && m_initialized && m_hiZ.created())
+        {
+            // Buffers may still be referenced by in-flight frames.
+            vkDeviceWaitIdle(m_device);
+            m_hiZ.destroyReadbacks();
+        }
+    }
+
+    bool Renderer::hiZActive()
+    {
+        if (!m_hiZOcclusion && !m_hiZReadbackCallback)
+            return false;
+        if (m_depthSampleViews.size() != m_depthImages.size() || m_depthSampleViews.empty())
+            return false;
+        if (!m_hiZ.created() && !m_hiZFailed && !m_hiZ.create(*m_ctx, m_maxFrames))
+        {
+#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
+            std::cerr << "[Renderer] Hi-Z occlusion disabled: failed to create the pyramid pass\n";
+#endif
+            m_hiZFailed = true;
+        }
+        return m_hiZ.created();
+    }
+
+    void Renderer::deliverHiZReadbacks()
+    {
+        // The current slot was waited on; other slots whose fence already signaled are done too,
+        // so their copies go out now instead of when the slot comes around again.
+        for (;;)
+        {
+            uint32_t next = UINT32_MAX;
+            uint64_t nextSerial = UINT64_MAX;
+            for (uint32_t i = 0; i < m_framesInFlight; ++i)
+            {
+                const uint64_t serial = m_hiZ.pendingReadback(i);
+                if (serial >= nextSerial)
+                    continue;
+                if (i != m_currentFrame && vkGetFenceStatus(m_device, m_frames[i].inFlightFence) != VK_SUCCESS)
+                    continue;
+                next = i;
+                nextSerial = serial;
+            }
+            if (next == UINT32_MAX)
+                return;
+
+            HiZReadback out{};
+            if (!m_hiZ.takeReadback(next, out))
+                return;
+            if (out.frameSerial >= m_hiZDeliveredSerial)
+            {
+                m_hiZDeliveredSerial = out.frameSerial + 1u;
+                m_hiZReadbackCallback(out);
+            }
+        }
+    }
+
+    bool Renderer::ensureDepthReadback(DepthReadbackSlot &slot)
+    {
+        if (slot.buffer != VK_NULL_HANDLE && slot.width == m_extent.width && slot.height == m_extent.height)
+            return true;
+
+        // This slot's fence has signaled, so its old buffer is no longer in use.
+        DestroyBuffer(m_device, slot.buffer, slot.memory);
+        slot.width = slot.height = 0;
+        slot.pending = false;
+
+        if (m_extent.width == 0 || m_extent.height == 0)
+            return false;
+
+        // Depth aspect copies are 4 bytes per texel for every format findDepthFormat() picks.
+        const VkDeviceSize bytes = VkDeviceSize(m_extent.width) * VkDeviceSize(m_extent.height) * 4u;
+        VkResult r = CreateBuffer(m_device,
+                                  m_ctx->GetPhysicalDevice(),
+                                  bytes,
+                                  VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                  slot.buffer,
+                                  slot.memory);
+        if (r != VK_SUCCESS || !slot.memory.mapped)
+        {
+            DestroyBuffer(m_device, slot.buffer, slot.memory);
+            return false;
+        }
+        slot.width = m_extent.width;
+        slot.height = m_extent.height;
+        return true;
+    }
+
+    void Renderer::recordDepthReadback(VkCommandBuffer cmd, uint32_t imageIndex, VkExtent2D region, DepthReadbackSlot &slot)
+    {
+        if (imageIndex >= m_depthImages.size())
+            return;
+        const VkImage image = m_depthImages[imageIndex];
+
+        // The frame graph moved depth to TRANSFER_SRC_OPTIMAL after the scene's writes.
+
+        // Only the rendered region (below the full extent with resolution scaling), tightly packed.
+        slot.copied.width = std::min(region.width, slot.width);
+        slot.copied.height = std::min(region.height, slot.height);
+
+        VkBufferImageCopy copy{};
+        copy.bufferOffset = 0;
+        copy.bufferRowLength = 0;
+        copy.bufferImageHeight = 0;
+        copy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+        copy.imageSubresource.mipLevel = 0;
+        copy.imageSubresource.baseArrayLayer = 0;
+        copy.imageSubresource.layerCount = 1;
+        copy.imageOffset = {0, 0, 0};
+        copy.imageExtent = {slot.copied.width, slot.copied.height, 1};
+        vkCmdCopyImageToBuffer(cmd, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, slot.buffer, 1, &copy);
+
+        VkBufferMemoryBarrier toHost{};
+        toHost.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        toHost.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        toHost.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        toHost.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toHost.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toHost.buffer = slot.buffer;
+        toHost.offset = 0;
+        toHost.size = VK_WHOLE_SIZE;
+        vkCmdPipelineBarrier(cmd,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_HOST_BIT,
+                             0, 0, nullptr, 1, &toHost, 0, nullptr);
+
+        // The next frame's render pass clears depth from UNDEFINED, so the image can stay in
+        // TRANSFER_SRC_OPTIMAL.
+        slot.frameSerial = m_frameSerial;
+        slot.pending = true;
+    }
+
+    void Renderer::destroyDepthReadbacks()
+    {
+        for (auto &rb : m_depthReadbacks)
+            DestroyBuffer(m_device, rb.buffer, rb.memory);
+        m_depthReadbacks.clear();
     }
 
     bool Renderer::waitForCurrentFrameFence()
@@ -767,6 +2151,16 @@ namespace Engine
                 f.inFlightFence = VK_NULL_HANDLE;
             }
         }
+        if (m_computeTimeline != VK_NULL_HANDLE)
+        {
+            vkDestroySemaphore(m_device, m_computeTimeline, nullptr);
+            m_computeTimeline = VK_NULL_HANDLE;
+        }
+        if (m_graphicsTimeline != VK_NULL_HANDLE)
+        {
+            vkDestroySemaphore(m_device, m_graphicsTimeline, nullptr);
+            m_graphicsTimeline = VK_NULL_HANDLE;
+        }
     }
 
     void Renderer::destroyCommandPoolsAndBuffers()
@@ -779,6 +2173,12 @@ namespace Engine
                 f.commandPool = VK_NULL_HANDLE;
                 f.commandBuffer = VK_NULL_HANDLE;
             }
+            if (f.computeCommandPool != VK_NULL_HANDLE)
+            {
+                vkDestroyCommandPool(m_device, f.computeCommandPool, nullptr);
+                f.computeCommandPool = VK_NULL_HANDLE;
+                f.computeCommandBuffer = VK_NULL_HANDLE;
+            }
         }
     }
 
@@ -799,18 +2199,131 @@ namespace Engine
         m_timestampPeriod = props.limits.timestampPeriod; // Nanoseconds per tick
         m_timestampsSupported = true;
 
-        // Create a query pool with 2 queries per frame (start and end)
-        // We use 2 * maxFrames to have per-frame queries
+        // One block of TIMESTAMPS_PER_FRAME queries per frame slot (frame start/end, then
+        // begin/end pairs for each pass's pre-pass and record)
         VkQueryPoolCreateInfo poolInfo{};
         poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
         poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
-        poolInfo.queryCount = m_maxFrames * 2; // 2 timestamps per frame
+        poolInfo.queryCount = m_maxFrames * TIMESTAMPS_PER_FRAME;
 
         if (vkCreateQueryPool(m_device, &poolInfo, nullptr, &m_timestampQueryPool) != VK_SUCCESS)
         {
             m_timestampsSupported = false;
             m_timestampQueryPool = VK_NULL_HANDLE;
         }
+
+        m_gpuQuerySlots.assign(m_maxFrames, GpuQuerySlot{});
+        m_passGpuTimings.clear();
+
+        // Pipeline statistics need the pipelineStatisticsQuery feature, which VulkanContext
+        // enables whenever the device reports it.
+        VkPhysicalDeviceFeatures features{};
+        vkGetPhysicalDeviceFeatures(m_ctx->GetPhysicalDevice(), &features);
+        if (features.pipelineStatisticsQuery == VK_TRUE)
+        {
+            VkQueryPoolCreateInfo statsInfo{};
+            statsInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+            statsInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+            statsInfo.queryCount = m_maxFrames * STATS_PER_FRAME;
+            // Result order follows bit order: vertex, fragment, compute.
+            statsInfo.pipelineStatistics = VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+                                           VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT |
+                                           VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+            if (vkCreateQueryPool(m_device, &statsInfo, nullptr, &m_pipelineStatsQueryPool) != VK_SUCCESS)
+                m_pipelineStatsQueryPool = VK_NULL_HANDLE;
+        }
+    }
+
+    void Renderer::beginPassQueries(VkCommandBuffer cmd, size_t passIndex, bool prePass)
+    {
+        if (passIndex >= MAX_GPU_TIMED_PASSES)
+            return;
+        const uint32_t pass = static_cast<uint32_t>(passIndex);
+        if (m_timestampsSupported && m_timestampQueryPool != VK_NULL_HANDLE)
+        {
+            const uint32_t q = m_currentFrame * TIMESTAMPS_PER_FRAME + 2u + pass * 4u + (prePass ? 0u : 2u);
+            vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_timestampQueryPool, q);
+        }
+        if (m_frameStatsActive)
+        {
+            const uint32_t q = m_currentFrame * STATS_PER_FRAME + pass * 2u + (prePass ? 0u : 1u);
+            vkCmdBeginQuery(cmd, m_pipelineStatsQueryPool, q, 0);
+        }
+    }
+
+    void Renderer::endPassQueries(VkCommandBuffer cmd, size_t passIndex, bool prePass)
+    {
+        if (passIndex >= MAX_GPU_TIMED_PASSES)
+            return;
+        const uint32_t pass = static_cast<uint32_t>(passIndex);
+        if (m_frameStatsActive)
+        {
+            const uint32_t q = m_currentFrame * STATS_PER_FRAME + pass * 2u + (prePass ? 0u : 1u);
+            vkCmdEndQuery(cmd, m_pipelineStatsQueryPool, q);
+        }
+        if (m_timestampsSupported && m_timestampQueryPool != VK_NULL_HANDLE)
+        {
+            const uint32_t q = m_currentFrame * TIMESTAMPS_PER_FRAME + 2u + pass * 4u + (prePass ? 1u : 3u);
+            vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_timestampQueryPool, q);
+        }
+    }
+
+    void Renderer::readPassGpuTimings(uint32_t frameSlot)
+    {
+        if (frameSlot >= m_gpuQuerySlots.size())
+            return;
+        const GpuQuerySlot &slot = m_gpuQuerySlots[frameSlot];
+        const uint32_t timed = static_cast<uint32_t>(slot.passNames.size());
+        m_passGpuTimings.assign(timed, PassGpuTiming{});
+        if (timed == 0)
+            return;
+
+        // Passes that skipped a query (null module, no secondary buffer) read as unavailable,
+        // so each result carries its availability word instead of failing the whole read.
+        uint64_t ts[4 * MAX_GPU_TIMED_PASSES][2] = {};
+        const VkResult tsResult = vkGetQueryPoolResults(
+            m_device, m_timestampQueryPool, frameSlot * TIMESTAMPS_PER_FRAME + 2u, timed * 4u,
+            sizeof(ts), ts, sizeof(ts[0]), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+        auto spanMs = [&](uint32_t begin) -> float
+        {
+            const uint64_t *a = ts[begin];
+            const uint64_t *b = ts[begin + 1];
+            if (!a[1] || !b[1] || b[0] <= a[0])
+                return 0.0f;
+            return static_cast<float>(b[0] - a[0]) * m_timestampPeriod / 1000000.0f;
+        };
+
+        uint64_t stats[STATS_PER_FRAME][4] = {};
+        VkResult statsResult = VK_NOT_READY;
+        if (slot.pipelineStats && m_pipelineStatsQueryPool != VK_NULL_HANDLE)
+        {
+            statsResult = vkGetQueryPoolResults(
+                m_device, m_pipelineStatsQueryPool, frameSlot * STATS_PER_FRAME, timed * 2u,
+                sizeof(stats), stats, sizeof(stats[0]), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+        }
+
+        for (uint32_t i = 0; i < timed; ++i)
+        {
+            PassGpuTiming &out = m_passGpuTimings[i];
+            out.name = slot.passNames[i];
+            if (tsResult == VK_SUCCESS || tsResult == VK_NOT_READY)
+            {
+                out.prePassMs = spanMs(i * 4u);
+                out.recordMs = spanMs(i * 4u + 2u);
+            }
+            if (statsResult == VK_SUCCESS || statsResult == VK_NOT_READY)
+            {
+                for (uint32_t q = i * 2u; q < i * 2u + 2u; ++q)
+                {
+                    if (!stats[q][3])
+                        continue;
+                    out.vertexInvocations += stats[q][0];
+                    out.fragmentInvocations += stats[q][1];
+                    out.computeInvocations += stats[q][2];
+                }
+            }
+        }
     }
 
     void Renderer::destroyTimestampQueryPool()
@@ -820,6 +2333,13 @@ namespace Engine
             vkDestroyQueryPool(m_device, m_timestampQueryPool, nullptr);
             m_timestampQueryPool = VK_NULL_HANDLE;
         }
+        if (m_pipelineStatsQueryPool != VK_NULL_HANDLE)
+        {
+            vkDestroyQueryPool(m_device, m_pipelineStatsQueryPool, nullptr);
+            m_pipelineStatsQueryPool = VK_NULL_HANDLE;
+        }
+        m_gpuQuerySlots.clear();
+        m_passGpuTimings.clear();
         m_timestampsSupported = false;
     }
 }
\ No newline at end of file
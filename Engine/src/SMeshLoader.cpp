@@ -1,6 +1,7 @@
 #include "assets/MeshFormats.h"
 #include <cstdio>
 #include <cstring>
+#include <utility>
 
 namespace Engine
 {
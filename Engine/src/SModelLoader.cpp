@@ -79,41 +79,11 @@ namespace Engine
         }
 
         // ------------------------------------------------------------
-        // LoadSModelFile
+        // Validation + typed views over the file bytes (shared by the loaders below)
         // ------------------------------------------------------------
 
-        bool LoadSModelFile(const std::string &path, SModelFileView &outView, std::string &outError)
+        static bool parseSModelBytes(const uint8_t *fileData, uint64_t uFileSize, SModelFileView &outView, std::string &outError)
         {
-            outError.clear();
-            outView = SModelFileView{}; // reset
-
-            // --------------------------
-            // Read file bytes
-            // --------------------------
-            std::ifstream file(path, std::ios::binary | std::ios::ate);
-            if (!file.is_open())
-            {
-                outError = "Failed to open file: " + path;
-                return false;
-            }
-
-            const std::streamsize fileSize = file.tellg();
-            if (fileSize <= 0)
-            {
-                outError = "File is empty: " + path;
-                return false;
-            }
-
-            file.seekg(0, std::ios::beg);
-
-            outView.fileBytes.resize(static_cast<size_t>(fileSize));
-            if (!file.read(reinterpret_cast<char *>(outView.fileBytes.data()), fileSize))
-            {
-                outError = "Failed to read file bytes: " + path;
-                return false;
-            }
-
-            const uint64_t uFileSize = static_cast<uint64_t>(outView.fileBytes.size());
             if (uFileSize < sizeof(SModelHeader))
             {
                 outError = "File too small to contain SModelHeader.";
@@ -123,7 +93,7 @@ namespace Engine
             // --------------------------
             // Interpret header
             // --------------------------
-            outView.header = reinterpret_cast<const SModelHeader *>(outView.fileBytes.data());
+            outView.header = reinterpret_cast<const SModelHeader *>(fileData);
 
             // Basic compatibility
             if (!isHeaderCompatible(*outView.header))
@@ -248,10 +218,141 @@ namespace Engine
                 }
             }
 
+            // V4.2: baked animation (header extension right after SModelHeader)
+            const SModelBakedAnimationHeader *baked = nullptr;
+            if (outView.header->flags & SMODEL_FLAG_BAKED_ANIMATION)
+            {
+                if (!isRangeInsideFile(sizeof(SModelHeader), sizeof(SModelBakedAnimationHeader), uFileSize))
+                {
+                    outError = "Baked animation header out of file bounds.";
+                    return false;
+                }
+                baked = reinterpret_cast<const SModelBakedAnimationHeader *>(fileData + sizeof(SModelHeader));
+                if (!tableRangeValid<SModelBakedClipRecord>(baked->clipsOffset, baked->clipCount, uFileSize, outError))
+                    return false;
+                if (!tableRangeValid<float>(baked->dataOffset, baked->dataCount, uFileSize, outError))
+                    return false;
+
+                const SModelBakedClipRecord *clips = reinterpret_cast<const SModelBakedClipRecord *>(fileData + baked->clipsOffset);
+                const uint64_t frameFloats = BakedFrameFloats(baked->nodeCount, baked->jointCount);
+                for (uint32_t i = 0; i < baked->clipCount; ++i)
+                {
+                    const uint64_t endFloat = (uint64_t(clips[i].firstFrame) + clips[i].frameCount) * frameFloats;
+                    if (clips[i].frameCount == 0 || endFloat > baked->dataCount)
+                    {
+                        outError = "Baked animation clip frames out of range.";
+                        return false;
+                    }
+                }
+            }
+
+            // V4.3: mesh LOD chains (extension header after any earlier ones)
+            const SModelMeshLodHeader *meshLods = nullptr;
+            if (outView.header->flags & SMODEL_FLAG_MESH_LODS)
+            {
+                const uint64_t lodHeaderOffset = MeshLodHeaderOffset(outView.header->flags);
+                if (!isRangeInsideFile(lodHeaderOffset, sizeof(SModelMeshLodHeader), uFileSize))
+                {
+                    outError = "Mesh LOD header out of file bounds.";
+                    return false;
+                }
+                meshLods = reinterpret_cast<const SModelMeshLodHeader *>(fileData + lodHeaderOffset);
+                if (!tableRangeValid<SModelMeshLodRecord>(meshLods->lodsOffset, meshLods->lodCount, uFileSize, outError))
+                    return false;
+            }
+
+            // V4.4: quantized animation (extension header after any earlier ones)
+            const SModelQuantizedAnimHeader *quantized = nullptr;
+            if (outView.header->flags & SMODEL_FLAG_QUANTIZED_ANIMATION)
+            {
+                const uint64_t qHeaderOffset = QuantizedAnimHeaderOffset(outView.header->flags);
+                if (!isRangeInsideFile(qHeaderOffset, sizeof(SModelQuantizedAnimHeader), uFileSize))
+                {
+                    outError = "Quantized animation header out of file bounds.";
+                    return false;
+                }
+                quantized = reinterpret_cast<const SModelQuantizedAnimHeader *>(fileData + qHeaderOffset);
+                if (!tableRangeValid<SModelQuantizedClipRecord>(quantized->clipsOffset, quantized->clipCount, uFileSize, outError))
+                    return false;
+                if (!tableRangeValid<SModelQuantizedTrackRecord>(quantized->tracksOffset, quantized->trackCount, uFileSize, outError))
+                    return false;
+                if (!tableRangeValid<uint16_t>(quantized->dataOffset, quantized->dataWords, uFileSize, outError))
+                    return false;
+
+                const SModelQuantizedClipRecord *clips = reinterpret_cast<const SModelQuantizedClipRecord *>(fileData + quantized->clipsOffset);
+                const SModelQuantizedTrackRecord *tracks = reinterpret_cast<const SModelQuantizedTrackRecord *>(fileData + quantized->tracksOffset);
+                for (uint32_t i = 0; i < quantized->clipCount; ++i)
+                {
+                    const SModelQuantizedClipRecord &c = clips[i];
+                    const uint64_t endWord = uint64_t(c.dataOffset) + uint64_t(c.frameCount) * c.frameWords;
+                    if (c.frameCount == 0 || uint64_t(c.firstTrack) + c.trackCount > quantized->trackCount || endWord > quantized->dataWords)
+                    {
+                        outError = "Quantized animation clip out of range (clipIndex=" + std::to_string(i) + ")";
+                        return false;
+                    }
+                    for (uint32_t t = 0; t < c.trackCount; ++t)
+                    {
+                        const SModelQuantizedTrackRecord &tr = tracks[c.firstTrack + t];
+                        const uint32_t words = (tr.encoding == uint16_t(QuantizedTrackEncoding::Constant)) ? 0u : 3u;
+                        if (tr.encoding > uint16_t(QuantizedTrackEncoding::QuatSmallest3) || uint32_t(tr.wordOffset) + words > c.frameWords)
+                        {
+                            outError = "Quantized animation track out of range (clipIndex=" + std::to_string(i) + ")";
+                            return false;
+                        }
+                    }
+                }
+            }
+
+            // V4.5: octahedral impostor (extension header after any earlier ones)
+            const SModelImpostorHeader *impostor = nullptr;
+            if (outView.header->flags & SMODEL_FLAG_IMPOSTOR)
+            {
+                const uint64_t iHeaderOffset = ImpostorHeaderOffset(outView.header->flags);
+                if (!isRangeInsideFile(iHeaderOffset, sizeof(SModelImpostorHeader), uFileSize))
+                {
+                    outError = "Impostor header out of file bounds.";
+                    return false;
+                }
+                impostor = reinterpret_cast<const SModelImpostorHeader *>(fileData + iHeaderOffset);
+                const uint32_t textureCount = outView.header->textureCount;
+                if (impostor->framesPerSide < 2 || impostor->framesPerSide > SMODEL_MAX_IMPOSTOR_FRAMES ||
+                    impostor->frameResolution == 0 || !(impostor->radius > 0.0f) ||
+                    impostor->mapping > uint32_t(ImpostorMapping::Hemisphere) ||
+                    impostor->albedoTexture < 0 || uint32_t(impostor->albedoTexture) >= textureCount ||
+                    impostor->normalTexture < 0 || uint32_t(impostor->normalTexture) >= textureCount)
+                {
+                    outError = "Impostor header references invalid frames/textures.";
+                    return false;
+                }
+            }
+
+            // V4.6: meshlets (extension header after any earlier ones). They index vertices and
+            // triangles in file order, which only holds when the runtime keeps that order.
+            const SModelMeshletHeader *meshlets = nullptr;
+            if (outView.header->flags & SMODEL_FLAG_MESHLETS)
+            {
+                const uint64_t mHeaderOffset = MeshletHeaderOffset(outView.header->flags);
+                if (!isRangeInsideFile(mHeaderOffset, sizeof(SModelMeshletHeader), uFileSize))
+                {
+                    outError = "Meshlet header out of file bounds.";
+                    return false;
+                }
+                meshlets = reinterpret_cast<const SModelMeshletHeader *>(fileData + mHeaderOffset);
+                if (!(outView.header->flags & SMODEL_FLAG_OPTIMIZED_MESHES) ||
+                    meshlets->maxVertices == 0 || meshlets->maxVertices > SMODEL_MAX_MESHLET_VERTICES ||
+                    meshlets->maxTriangles == 0 || meshlets->maxTriangles > SMODEL_MAX_MESHLET_TRIANGLES)
+                {
+                    outError = "Meshlet header has invalid limits (or meshes not cooked in order).";
+                    return false;
+                }
+                if (!tableRangeValid<SModelMeshletRecord>(meshlets->meshletsOffset, meshlets->meshletCount, uFileSize, outError))
+                    return false;
+            }
+
             // --------------------------
             // Build pointers/views
             // --------------------------
-            const uint8_t *base = outView.fileBytes.data();
+            const uint8_t *base = fileData;
 
             outView.meshes = reinterpret_cast<const SModelMeshRecord *>(base + outView.header->meshesOffset);
             outView.primitives = reinterpret_cast<const SModelPrimitiveRecord *>(base + outView.header->primitivesOffset);
@@ -306,6 +407,35 @@ namespace Engine
                     return false;
             }
 
+            if (baked)
+            {
+                outView.bakedAnimation = baked;
+                outView.bakedClips = reinterpret_cast<const SModelBakedClipRecord *>(base + baked->clipsOffset);
+                outView.bakedData = reinterpret_cast<const float *>(base + baked->dataOffset);
+            }
+
+            if (quantized)
+            {
+                outView.quantizedAnim = quantized;
+                outView.quantizedClips = reinterpret_cast<const SModelQuantizedClipRecord *>(base + quantized->clipsOffset);
+                outView.quantizedTracks = reinterpret_cast<const SModelQuantizedTrackRecord *>(base + quantized->tracksOffset);
+                outView.quantizedData = reinterpret_cast<const uint16_t *>(base + quantized->dataOffset);
+            }
+
+            outView.impostor = impostor;
+
+            if (meshLods)
+            {
+                outView.meshLods = meshLods;
+                outView.meshLodRecords = reinterpret_cast<const SModelMeshLodRecord *>(base + meshLods->lodsOffset);
+            }
+
+            if (meshlets)
+            {
+                outView.meshlets = meshlets;
+                outView.meshletRecords = reinterpret_cast<const SModelMeshletRecord *>(base + meshlets->meshletsOffset);
+            }
+
             // --------------------------
             // Validate record internal offsets (blob offsets)
             // --------------------------
@@ -347,6 +477,78 @@ namespace Engine
                 }
             }
 
+            // Validate mesh LOD index slices (levels ascending per mesh, same index type as the mesh)
+            for (uint32_t i = 0; outView.meshLods && i < outView.meshLods->lodCount; i++)
+            {
+                const SModelMeshLodRecord &l = outView.meshLodRecords[i];
+                if (l.meshIndex >= outView.header->meshCount || l.level == 0 || l.level > SMODEL_MAX_MESH_LODS)
+                {
+                    outError = "Mesh LOD record references invalid mesh/level (lodIndex=" + std::to_string(i) + ")";
+                    return false;
+                }
+
+                const SModelMeshRecord &m = outView.meshes[l.meshIndex];
+                const uint64_t indexSize = (m.indexType == uint32_t(IndexType::U16)) ? 2u : 4u;
+                if (l.indexDataOffset + l.indexDataSize > blobSize || uint64_t(l.indexCount) * indexSize > l.indexDataSize)
+                {
+                    outError = "Mesh LOD index data slice out of blob bounds (lodIndex=" + std::to_string(i) + ")";
+                    return false;
+                }
+
+                if (i > 0)
+                {
+                    const SModelMeshLodRecord &prev = outView.meshLodRecords[i - 1];
+                    if (prev.meshIndex == l.meshIndex && prev.level >= l.level)
+                    {
+                        outError = "Mesh LOD levels not ascending (lodIndex=" + std::to_string(i) + ")";
+                        return false;
+                    }
+                }
+            }
+
+            // Validate meshlets: slices inside the blob, ranges inside their mesh, sorted by mesh
+            if (outView.meshlets)
+            {
+                const SModelMeshletHeader &mh = *outView.meshlets;
+                if (mh.vertexDataOffset + uint64_t(mh.vertexCount) * sizeof(uint32_t) > blobSize ||
+                    mh.triangleDataOffset + mh.triangleByteCount > blobSize)
+                {
+                    outError = "Meshlet data slice out of blob bounds.";
+                    return false;
+                }
+
+                const uint32_t *meshletVertices = reinterpret_cast<const uint32_t *>(outView.blob + mh.vertexDataOffset);
+                for (uint32_t i = 0; i < mh.meshletCount; i++)
+                {
+                    const SModelMeshletRecord &r = outView.meshletRecords[i];
+                    if (r.meshIndex >= outView.header->meshCount || (i > 0 && outView.meshletRecords[i - 1].meshIndex > r.meshIndex) ||
+                        r.vertexCount == 0 || r.vertexCount > mh.maxVertices || r.triangleCount == 0 || r.triangleCount > mh.maxTriangles ||
+                        uint64_t(r.vertexOffset) + r.vertexCount > mh.vertexCount ||
+                        uint64_t(r.triangleOffset) + uint64_t(r.triangleCount) * 3u > mh.triangleByteCount)
+                    {
+                        outError = "Meshlet record out of range (meshletIndex=" + std::to_string(i) + ")";
+                        return false;
+                    }
+
+                    const SModelMeshRecord &m = outView.meshes[r.meshIndex];
+                    if (uint64_t(r.firstIndex) + uint64_t(r.triangleCount) * 3u > m.indexCount)
+                    {
+                        outError = "Meshlet index range outside its mesh (meshletIndex=" + std::to_string(i) + ")";
+                        return false;
+                    }
+                    for (uint32_t v = 0; v < r.vertexCount; v++)
+                    {
+                        uint32_t vertex;
+                        std::memcpy(&vertex, meshletVertices + r.vertexOffset + v, sizeof(vertex));
+                        if (vertex >= m.vertexCount)
+                        {
+                            outError = "Meshlet references invalid vertex (meshletIndex=" + std::to_string(i) + ")";
+                            return false;
+                        }
+                    }
+                }
+            }
+
             // Validate texture image slices
             for (uint32_t i = 0; i < outView.header->textureCount; i++)
             {
@@ -357,6 +559,21 @@ namespace Engine
                     outError = "Texture image data slice out of blob bounds (textureIndex=" + std::to_string(i) + ")";
                     return false;
                 }
+
+                if (IsBlockCompressed(t.encoding) &&
+                    (t.width == 0 || t.height == 0 || t.mipLevels == 0 ||
+                     t.imageDataSize < BlockCompressedMipChainBytes(t.width, t.height, t.mipLevels)))
+                {
+                    outError = "Compressed texture mip chain does not match its record (textureIndex=" + std::to_string(i) + ")";
+                    return false;
+                }
+
+                if (t.encoding == uint32_t(ImageEncoding::RAW) &&
+                    (t.width == 0 || t.height == 0 || t.imageDataSize < uint64_t(t.width) * t.height * 4u))
+                {
+                    outError = "Raw texture size does not match its record (textureIndex=" + std::to_string(i) + ")";
+                    return false;
+                }
             }
 
             // Validate primitive references
@@ -634,5 +851,83 @@ namespace Engine
             return true;
         }
 
+        // ------------------------------------------------------------
+        // LoadSModelFile
+        // ------------------------------------------------------------
+
+        bool LoadSModelFile(const std::string &path, SModelFileView &outView, std::string &outError)
+        {
+            outError.clear();
+            outView = SModelFileView{}; // reset
+
+            // --------------------------
+            // Map file bytes (fallback: read into fileBytes)
+            // --------------------------
+            const uint8_t *fileData = nullptr;
+            uint64_t uFileSize = 0;
+
+            if (outView.mapping.open(path))
+            {
+                fileData = outView.mapping.data();
+                uFileSize = static_cast<uint64_t>(outView.mapping.size());
+            }
+            else
+            {
+                std::ifstream file(path, std::ios::binary | std::ios::ate);
+                if (!file.is_open())
+                {
+                    outError = "Failed to open file: " + path;
+                    return false;
+                }
+
+                const std::streamsize fileSize = file.tellg();
+                if (fileSize <= 0)
+                {
+                    outError = "File is empty: " + path;
+                    return false;
+                }
+
+                file.seekg(0, std::ios::beg);
+
+                outView.fileBytes.resize(static_cast<size_t>(fileSize));
+                if (!file.read(reinterpret_cast<char *>(outView.fileBytes.data()), fileSize))
+                {
+                    outError = "Failed to read file bytes: " + path;
+                    return false;
+                }
+
+                fileData = outView.fileBytes.data();
+                uFileSize = static_cast<uint64_t>(outView.fileBytes.size());
+            }
+
+            return parseSModelBytes(fileData, uFileSize, outView, outError);
+        }
+
+        bool LoadSModelMemory(const uint8_t *data, size_t size, std::shared_ptr<const void> owner, SModelFileView &outView, std::string &outError)
+        {
+            outError.clear();
+            outView = SModelFileView{};
+            outView.owner = std::move(owner);
+            if (!data || size == 0)
+            {
+                outError = "Empty .smodel data.";
+                return false;
+            }
+            return parseSModelBytes(data, static_cast<uint64_t>(size), outView, outError);
+        }
+
+        bool LoadSModelBytes(std::vector<uint8_t> &&bytes, SModelFileView &outView, std::string &outError)
+        {
+            outError.clear();
+            outView = SModelFileView{};
+            outView.fileBytes = std::move(bytes);
+            if (outView.fileBytes.empty())
+            {
+                outError = "Empty .smodel data.";
+                return false;
+            }
+            return parseSModelBytes(outView.fileBytes.data(), static_cast<uint64_t>(outView.fileBytes.size()), outView, outError);
+        }
+
     } // namespace smodel
 } // namespace Engine
@@ -1,23 +1,72 @@
 #include "Engine/SModelRenderPassModule.h"
 #include "Engine/VulkanContext.h"
+#include "Engine/BindlessMaterials.h"
 #include "Engine/SwapChain.h"
 #include "Engine/PerformanceMonitor.h"
 #include "assets/ModelAsset.h"
 #include "assets/MeshAsset.h"
 #include "assets/MaterialAsset.h"
+#include "assets/model/SModelPackedVertex.h"
+#include "assets/model/SModelMeshlet.h"
+#include "utils/BufferUtils.h"
 #include "utils/ImageUtils.h"
 
 #include <algorithm>
 #include <array>
 #include <cstring>
 #include <stdexcept>
+#include "Engine/Frustum.h"
 #include <unordered_set>
+#include <utility>
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
 namespace Engine
 {
 
+    // smodel_pose.comp input per instance: uvec4 (slot, clip, time, baked) + uvec4 (blend from
+    // clip, from time, weight, unused).
+    static constexpr uint32_t POSE_INPUT_WORDS = 8u;
+
+    // Meshlet data: MESHLET_RECORD_WORDS per meshlet (layout in smodel_meshlet_cull.comp), then the
+    // vertex and triangle tables. smodel_meshlet.task tests MESHLET_TASK_GROUP meshlets per workgroup.
+    static constexpr uint32_t MESHLET_RECORD_WORDS = 16u;
+    static constexpr uint32_t MESHLET_TASK_GROUP = 32u;
+    static constexpr VkShaderStageFlags MESH_PUSH_STAGES = VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT | VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    // TUNING CONSTANTS
+    // Skinned meshlets carry bind-pose bounds moved by their anchor joint only: the sphere grows
+    // and the cone cutoff loosens to keep the vertices other joints move inside the test.
+    static constexpr float MESHLET_SKINNED_RADIUS_SCALE = 1.5f;
+    static constexpr float MESHLET_SKINNED_CONE_MARGIN = 0.2f;
+    // Compute path: meshlets x candidates commands per frame at most (20 bytes each); a larger
+    // frame draws the whole meshes instead.
+    static constexpr uint32_t MESHLET_MAX_COMMANDS = 1u << 20;
+
+    // smodel_meshlet_cull.comp / smodel_meshlet.task uniform block (set 1 / 3, binding 3).
+    struct MeshletCullUBO
+    {
+        float model[16];
+        float planes[6][4];
+        float cameraPos[4];
+        float skinned[4]; // x=radius scale, y=cone cutoff margin
+    };
+
+    // Slot arrays and buffers are given back once they hold SLOT_SHRINK_RATIO times the slots in
+    // use (never below SLOT_SHRINK_MIN_SLOTS), so capacity grown for a big battle does not stay.
+    static constexpr uint32_t SLOT_SHRINK_RATIO = 4u;
+    static constexpr uint32_t SLOT_SHRINK_MIN_SLOTS = 256u;
+
+    static uint32_t slotShrinkTarget(uint32_t slotsInUse)
+    {
+        return std::max(slotsInUse, SLOT_SHRINK_MIN_SLOTS);
+    }
+
+    static bool slotStorageOversized(size_t capacitySlots, uint32_t slotsInUse)
+    {
+        return capacitySlots > static_cast<size_t>(slotShrinkTarget(slotsInUse)) * SLOT_SHRINK_RATIO;
+    }
+
     static void setIdentity(float outM[16])
     {
         std::memset(outM, 0, sizeof(float) * 16);
@@ -156,9 +205,19 @@ namespace Engine
         if (m_materialPool == VK_NULL_HANDLE || m_materialSetLayout == VK_NULL_HANDLE)
             return VK_NULL_HANDLE;
 
+        const uint32_t epoch = m_assets ? m_assets->textureViewEpoch() : 0u;
         auto it = m_materialSetCache.find(h.id);
         if (it != m_materialSetCache.end())
-            return it->second;
+        {
+            // A texture's view was replaced since the write: no earlier frame is still pending
+            // (the swap waited for the GPU), so the set is rewritten in place.
+            if (it->second.textureEpoch != epoch)
+            {
+                writeMaterialSet(it->second.set, mat);
+                it->second.textureEpoch = epoch;
+            }
+            return it->second.set;
+        }
 
         VkDescriptorSetAllocateInfo alloc{};
         alloc.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
@@ -170,6 +229,14 @@ namespace Engine
         if (vkAllocateDescriptorSets(m_device, &alloc, &set) != VK_SUCCESS)
             return VK_NULL_HANDLE;
 
+        writeMaterialSet(set, mat);
+
+        m_materialSetCache.emplace(h.id, CachedMaterialSet{set, epoch});
+        return set;
+    }
+
+    void SModelRenderPassModule::writeMaterialSet(VkDescriptorSet set, const MaterialAsset *mat)
+    {
         VkImageView view = m_fallbackWhiteTexture.getView();
         VkSampler sampler = m_fallbackWhiteTexture.getSampler();
 
@@ -199,13 +266,11 @@ namespace Engine
         write.descriptorCount = 1;
         write.pImageInfo = &di;
         vkUpdateDescriptorSets(m_device, 1, &write, 0, nullptr);
-
-        m_materialSetCache.emplace(h.id, set);
-        return set;
     }
 
     void SModelRenderPassModule::setModelMatrix(const float *m16)
     {
+        m_modelMatrixVersion += 1u;
         if (!m16)
         {
             setIdentity(m_pc.model);
@@ -241,6 +306,7 @@ namespace Engine
         {
             cf.uploadedPoseEpoch.clear();
         }
+        m_resident.uploadedPoseEpoch.clear();
     }
 
     void SModelRenderPassModule::ensureSlotCapacity(uint32_t slotCapacity)
@@ -250,8 +316,12 @@ namespace Engine
             return;
 
         m_slotWorlds.resize(slotCapacity, glm::mat4(1.0f));
+        // Unknown bounds never cull: huge radius.
+        m_slotBounds.resize(slotCapacity, glm::vec4(0.0f, 0.0f, 0.0f, 1e30f));
         m_slotTransformEpoch.resize(slotCapacity, 1u);
         m_slotPoseEpoch.resize(slotCapacity, 1u);
+        m_slotGpuPose.resize(slotCapacity, 0u);
+        m_slotAnimations.resize(slotCapacity);
 
         const size_t nodeTotal = static_cast<size_t>(slotCapacity) * static_cast<size_t>(std::max<uint32_t>(m_slotNodeCount, 1u));
         if (m_nodePalette.size() < nodeTotal)
@@ -269,6 +339,50 @@ namespace Engine
         }
     }
 
+    void SModelRenderPassModule::trimSlotCapacity(uint32_t slotCount)
+    {
+        const uint32_t cur = static_cast<uint32_t>(m_slotWorlds.size());
+        if (slotCount >= cur)
+            return;
+
+        const size_t nodeStride = std::max<uint32_t>(m_slotNodeCount, 1u);
+        const size_t jointStride = std::max<uint32_t>(m_slotJointCount, 1u);
+        m_slotWorlds.resize(slotCount);
+        m_slotBounds.resize(slotCount);
+        m_slotTransformEpoch.resize(slotCount);
+        m_slotPoseEpoch.resize(slotCount);
+        m_slotGpuPose.resize(slotCount);
+        m_slotAnimations.resize(slotCount);
+        m_nodePalette.resize(std::min(m_nodePalette.size(), slotCount * nodeStride));
+        m_jointPalette.resize(std::min(m_jointPalette.size(), slotCount * jointStride));
+
+        auto trimEpochs = [slotCount](std::vector<uint32_t> &epochs)
+        {
+            if (epochs.size() > slotCount)
+                epochs.resize(slotCount);
+        };
+        for (auto &cf : m_cameraFrames)
+        {
+            trimEpochs(cf.uploadedTransformEpoch);
+            trimEpochs(cf.uploadedPoseEpoch);
+        }
+        trimEpochs(m_resident.uploadedTransformEpoch);
+        trimEpochs(m_resident.uploadedPoseEpoch);
+
+        // GPU buffers follow at the next upload (uploadSlotData / uploadResidentSlotData).
+        if (slotStorageOversized(m_slotWorlds.capacity(), slotCount))
+        {
+            m_slotWorlds.shrink_to_fit();
+            m_slotBounds.shrink_to_fit();
+            m_slotTransformEpoch.shrink_to_fit();
+            m_slotPoseEpoch.shrink_to_fit();
+            m_slotGpuPose.shrink_to_fit();
+            m_slotAnimations.shrink_to_fit();
+            m_nodePalette.shrink_to_fit();
+            m_jointPalette.shrink_to_fit();
+        }
+    }
+
     void SModelRenderPassModule::setActiveSlots(const uint32_t *slotIndices, uint32_t count)
     {
         std::vector<uint32_t> next;
@@ -291,6 +405,14 @@ namespace Engine
         m_slotTransformEpoch[slotIndex] = m_transformEpochCounter;
     }
 
+    void SModelRenderPassModule::setSlotBounds(uint32_t slotIndex, const glm::vec3 &worldCenter, float worldRadius)
+    {
+        ensureSlotCapacity(slotIndex + 1u);
+        m_slotBounds[slotIndex] = glm::vec4(worldCenter, worldRadius);
+        m_transformEpochCounter += 1u;
+        m_slotTransformEpoch[slotIndex] = m_transformEpochCounter;
+    }
+
     void SModelRenderPassModule::setSlotPose(uint32_t slotIndex,
                                              const glm::mat4 *nodeGlobals, uint32_t nodeCount,
                                              const glm::mat4 *jointMatrices, uint32_t jointCount)
@@ -325,6 +447,35 @@ namespace Engine
                       glm::mat4(1.0f));
         }
 
+        m_slotGpuPose[slotIndex] = 0u;
+        m_poseEpochCounter += 1u;
+        m_slotPoseEpoch[slotIndex] = m_poseEpochCounter;
+    }
+
+    void SModelRenderPassModule::setSlotAnimation(uint32_t slotIndex, uint32_t clipIndex, float timeSec, bool baked,
+                                                  uint32_t blendFromClip, float blendFromTimeSec, float blendWeight)
+    {
+        ensureSlotCapacity(slotIndex + 1u);
+
+        if (blendWeight >= 1.0f)
+        {
+            blendFromClip = 0;
+            blendFromTimeSec = 0.0f;
+            blendWeight = 1.0f;
+        }
+
+        SlotAnimation &anim = m_slotAnimations[slotIndex];
+        if (m_slotGpuPose[slotIndex] && anim.clipIndex == clipIndex && anim.timeSec == timeSec && anim.baked == baked &&
+            anim.blendFromClip == blendFromClip && anim.blendFromTimeSec == blendFromTimeSec && anim.blendWeight == blendWeight)
+            return; // same sample: the resident palette is already correct
+
+        anim.clipIndex = clipIndex;
+        anim.timeSec = timeSec;
+        anim.baked = baked;
+        anim.blendFromClip = blendFromClip;
+        anim.blendFromTimeSec = blendFromTimeSec;
+        anim.blendWeight = blendWeight;
+        m_slotGpuPose[slotIndex] = 1u;
         m_poseEpochCounter += 1u;
         m_slotPoseEpoch[slotIndex] = m_poseEpochCounter;
     }
@@ -432,26 +583,61 @@ namespace Engine
         (void)fbs;
         m_device = ctx.GetDevice();
         m_physicalDevice = ctx.GetPhysicalDevice();
+        m_pipelineCache = ctx.GetPipelineCache();
         m_extent = ctx.GetSwapChain() ? ctx.GetSwapChain()->GetExtent() : VkExtent2D{};
 
+        // Slot, pose and cull buffers are written on the async compute queue when it is in use.
+        m_queueFamilyCount = 0;
+        if (ctx.HasAsyncCompute())
+        {
+            m_queueFamilies[0] = ctx.GetGraphicsQueueFamilyIndex();
+            m_queueFamilies[1] = ctx.GetComputeQueueFamilyIndex();
+            m_queueFamilyCount = 2;
+        }
+
         // Default model matrix: center/scale from bounds if available
         if (!refreshModelMatrix())
         {
             setIdentity(m_pc.model);
         }
 
+        // Stages besides the vertex shader reading the camera set: the meshlet cull (compute) and
+        // the mesh shader path.
+        m_meshletStages = VK_SHADER_STAGE_COMPUTE_BIT;
+        if (ctx.HasMeshShader())
+            m_meshletStages |= VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT;
+
         const size_t frameCount = fbs.size();
         if (!createCameraResources(ctx, frameCount > 0 ? frameCount : 1))
         {
             throw std::runtime_error("SModelRenderPassModule: failed to create camera resources");
         }
 
-        if (!createMaterialResources(ctx))
+        m_bindless = ctx.GetBindlessMaterials();
+        if (!m_bindless && !createMaterialResources(ctx))
         {
             throw std::runtime_error("SModelRenderPassModule: failed to create material resources");
         }
 
+        // Optional: meshlet culling. Its set layout goes into the mesh shader pipelines below.
+        const bool meshletSets = createMeshletResources(ctx);
+
         createPipelines(ctx, pass);
+
+        // Optional: GPU culling (compute). Missing shader/indirect support -> CPU fallback.
+        m_cullReady = m_indirectReady && createCullResources(ctx);
+        if (!m_cullReady)
+            destroyCullResources();
+
+        // Optional: GPU pose evaluation (compute). Missing shader -> poses stay on the CPU.
+        m_poseReady = createPoseResources(ctx);
+        if (!m_poseReady)
+            destroyPoseResources();
+
+        // The compute meshlet path appends to the GPU cull results. Neither path -> whole meshes.
+        m_meshletComputeReady = meshletSets && m_meshletComputeReady && m_cullReady;
+        if (!m_meshShaderReady && !m_meshletComputeReady)
+            destroyMeshletResources();
     }
 
     VkPipelineColorBlendStateCreateInfo SModelRenderPassModule::makeBlendState(bool enableBlend, VkPipelineColorBlendAttachmentState &outAttachment) const
@@ -488,38 +674,45 @@ namespace Engine
 
         VkDescriptorSetLayoutBinding camBinding{};
         camBinding.binding = 0;
-        camBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        camBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
         camBinding.descriptorCount = 1;
-        camBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        camBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | (m_meshletStages & VK_SHADER_STAGE_MESH_BIT_EXT);
 
         VkDescriptorSetLayoutBinding paletteBinding{};
         paletteBinding.binding = 1;
         paletteBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
         paletteBinding.descriptorCount = 1;
-        paletteBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        paletteBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | m_meshletStages;
 
         VkDescriptorSetLayoutBinding jointPaletteBinding{};
         jointPaletteBinding.binding = 2;
         jointPaletteBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
         jointPaletteBinding.descriptorCount = 1;
-        jointPaletteBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        jointPaletteBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | m_meshletStages;
 
         VkDescriptorSetLayoutBinding instanceWorldBinding{};
         instanceWorldBinding.binding = 3;
         instanceWorldBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
         instanceWorldBinding.descriptorCount = 1;
-        instanceWorldBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        instanceWorldBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | m_meshletStages;
 
         VkDescriptorSetLayoutBinding activeSlotsBinding{};
         activeSlotsBinding.binding = 4;
         activeSlotsBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
         activeSlotsBinding.descriptorCount = 1;
-        activeSlotsBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        activeSlotsBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | m_meshletStages;
+
+        // Per-draw data for the indirect path (unused by smodel.vert)
+        VkDescriptorSetLayoutBinding drawDataBinding{};
+        drawDataBinding.binding = 5;
+        drawDataBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        drawDataBinding.descriptorCount = 1;
+        drawDataBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | m_meshletStages;
 
         VkDescriptorSetLayoutCreateInfo dsl{};
         dsl.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-        VkDescriptorSetLayoutBinding bindings[5] = {camBinding, paletteBinding, jointPaletteBinding, instanceWorldBinding, activeSlotsBinding};
-        dsl.bindingCount = 5;
+        VkDescriptorSetLayoutBinding bindings[6] = {camBinding, paletteBinding, jointPaletteBinding, instanceWorldBinding, activeSlotsBinding, drawDataBinding};
+        dsl.bindingCount = 6;
         dsl.pBindings = bindings;
 
         if (vkCreateDescriptorSetLayout(ctx.GetDevice(), &dsl, nullptr, &m_cameraSetLayout) != VK_SUCCESS)
@@ -527,16 +720,17 @@ namespace Engine
             return false;
         }
 
-        // Pool: one uniform buffer descriptor + two storage buffer descriptors per frame
+        // Pool: one dynamic uniform buffer descriptor + five storage buffer descriptors per set,
+        // two sets per frame (camera set + shadow caster set)
         VkDescriptorPoolSize poolSizes[2]{};
-        poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        poolSizes[0].descriptorCount = static_cast<uint32_t>(frameCount);
+        poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+        poolSizes[0].descriptorCount = static_cast<uint32_t>(frameCount) * 2u;
         poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-        poolSizes[1].descriptorCount = static_cast<uint32_t>(frameCount) * 4u;
+        poolSizes[1].descriptorCount = static_cast<uint32_t>(frameCount) * 10u;
 
         VkDescriptorPoolCreateInfo poolInfo{};
         poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-        poolInfo.maxSets = static_cast<uint32_t>(frameCount);
+        poolInfo.maxSets = static_cast<uint32_t>(frameCount) * 2u;
         poolInfo.poolSizeCount = 2;
         poolInfo.pPoolSizes = poolSizes;
 
@@ -545,208 +739,128 @@ namespace Engine
             return false;
         }
 
-        std::vector<VkDescriptorSetLayout> layouts(frameCount, m_cameraSetLayout);
+        std::vector<VkDescriptorSetLayout> layouts(frameCount * 2u, m_cameraSetLayout);
         VkDescriptorSetAllocateInfo allocInfo{};
         allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
         allocInfo.descriptorPool = m_cameraPool;
-        allocInfo.descriptorSetCount = static_cast<uint32_t>(frameCount);
+        allocInfo.descriptorSetCount = static_cast<uint32_t>(frameCount) * 2u;
         allocInfo.pSetLayouts = layouts.data();
 
         m_cameraFrames.resize(frameCount);
 
-        std::vector<VkDescriptorSet> sets(frameCount, VK_NULL_HANDLE);
+        std::vector<VkDescriptorSet> sets(frameCount * 2u, VK_NULL_HANDLE);
         if (vkAllocateDescriptorSets(ctx.GetDevice(), &allocInfo, sets.data()) != VK_SUCCESS)
         {
             return false;
         }
 
-        auto findMemoryType = [&](uint32_t typeFilter, VkMemoryPropertyFlags properties, uint32_t &typeIndex) -> bool
-        {
-            VkPhysicalDeviceMemoryProperties memProps{};
-            vkGetPhysicalDeviceMemoryProperties(ctx.GetPhysicalDevice(), &memProps);
-            for (uint32_t i = 0; i < memProps.memoryTypeCount; ++i)
-            {
-                if ((typeFilter & (1u << i)) && (memProps.memoryTypes[i].propertyFlags & properties) == properties)
-                {
-                    typeIndex = i;
-                    return true;
-                }
-            }
-            return false;
-        };
-
-        const VkDeviceSize bufSize = sizeof(CameraUBO);
         for (size_t i = 0; i < frameCount; ++i)
         {
             CameraFrame &cf = m_cameraFrames[i];
             cf.set = sets[i];
-
-            VkBufferCreateInfo binfo{};
-            binfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-            binfo.size = bufSize;
-            binfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-            binfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-            if (vkCreateBuffer(ctx.GetDevice(), &binfo, nullptr, &cf.buffer) != VK_SUCCESS)
-                return false;
-
-            VkMemoryRequirements memReq{};
-            vkGetBufferMemoryRequirements(ctx.GetDevice(), cf.buffer, &memReq);
-
-            VkMemoryAllocateInfo mai{};
-            mai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-            mai.allocationSize = memReq.size;
-            uint32_t memType = 0;
-            if (!findMemoryType(memReq.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, memType))
-                return false;
-            mai.memoryTypeIndex = memType;
-
-            if (vkAllocateMemory(ctx.GetDevice(), &mai, nullptr, &cf.memory) != VK_SUCCESS)
-                return false;
-
-            vkBindBufferMemory(ctx.GetDevice(), cf.buffer, cf.memory, 0);
-
-            // Camera UBO (host-visible, coherent, persistently mapped)
-            cf.mapped = nullptr;
-            if (vkMapMemory(ctx.GetDevice(), cf.memory, 0, VK_WHOLE_SIZE, 0, &cf.mapped) != VK_SUCCESS)
-                return false;
+            cf.shadowSet = sets[frameCount + i]; // written by prepareShadowSlots()
+            cf.cameraRingBuffer = VK_NULL_HANDLE; // binding 0 is written by bindCameraBlock()
 
             // Palette SSBO (host-visible, coherent, persistently mapped)
             constexpr uint32_t kDefaultPaletteCapacityMatrices = 1024;
             cf.paletteCapacityMatrices = kDefaultPaletteCapacityMatrices;
 
-            VkBufferCreateInfo pbinfo{};
-            pbinfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-            pbinfo.size = static_cast<VkDeviceSize>(cf.paletteCapacityMatrices) * sizeof(glm::mat4);
-            pbinfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
-            pbinfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-            if (vkCreateBuffer(ctx.GetDevice(), &pbinfo, nullptr, &cf.paletteBuffer) != VK_SUCCESS)
-                return false;
-
-            VkMemoryRequirements pmemReq{};
-            vkGetBufferMemoryRequirements(ctx.GetDevice(), cf.paletteBuffer, &pmemReq);
-
-            VkMemoryAllocateInfo pmai{};
-            pmai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-            pmai.allocationSize = pmemReq.size;
-            uint32_t pmemType = 0;
-            if (!findMemoryType(pmemReq.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, pmemType))
-                return false;
-            pmai.memoryTypeIndex = pmemType;
-
-            if (vkAllocateMemory(ctx.GetDevice(), &pmai, nullptr, &cf.paletteMemory) != VK_SUCCESS)
+            if (CreateBuffer(ctx.GetDevice(), ctx.GetPhysicalDevice(), static_cast<VkDeviceSize>(cf.paletteCapacityMatrices) * sizeof(glm::mat4), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, cf.paletteBuffer, cf.paletteMemory) != VK_SUCCESS)
                 return false;
 
-            vkBindBufferMemory(ctx.GetDevice(), cf.paletteBuffer, cf.paletteMemory, 0);
-
-            cf.paletteMapped = nullptr;
-            if (vkMapMemory(ctx.GetDevice(), cf.paletteMemory, 0, VK_WHOLE_SIZE, 0, &cf.paletteMapped) != VK_SUCCESS)
+            cf.paletteMapped = cf.paletteMemory.mapped;
+            if (!cf.paletteMapped)
                 return false;
 
             // Joint palette SSBO (host-visible, coherent, persistently mapped)
             constexpr uint32_t kDefaultJointPaletteCapacityMatrices = 1024;
             cf.jointPaletteCapacityMatrices = kDefaultJointPaletteCapacityMatrices;
 
-            VkBufferCreateInfo jbinfo{};
-            jbinfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-            jbinfo.size = static_cast<VkDeviceSize>(cf.jointPaletteCapacityMatrices) * sizeof(glm::mat4);
-            jbinfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
-            jbinfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-            if (vkCreateBuffer(ctx.GetDevice(), &jbinfo, nullptr, &cf.jointPaletteBuffer) != VK_SUCCESS)
-                return false;
-
-            VkMemoryRequirements jmemReq{};
-            vkGetBufferMemoryRequirements(ctx.GetDevice(), cf.jointPaletteBuffer, &jmemReq);
-
-            VkMemoryAllocateInfo jmai{};
-            jmai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-            jmai.allocationSize = jmemReq.size;
-            uint32_t jmemType = 0;
-            if (!findMemoryType(jmemReq.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, jmemType))
-                return false;
-            jmai.memoryTypeIndex = jmemType;
-
-            if (vkAllocateMemory(ctx.GetDevice(), &jmai, nullptr, &cf.jointPaletteMemory) != VK_SUCCESS)
+            if (CreateBuffer(ctx.GetDevice(), ctx.GetPhysicalDevice(), static_cast<VkDeviceSize>(cf.jointPaletteCapacityMatrices) * sizeof(glm::mat4), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, cf.jointPaletteBuffer, cf.jointPaletteMemory) != VK_SUCCESS)
                 return false;
 
-            vkBindBufferMemory(ctx.GetDevice(), cf.jointPaletteBuffer, cf.jointPaletteMemory, 0);
-
-            cf.jointPaletteMapped = nullptr;
-            if (vkMapMemory(ctx.GetDevice(), cf.jointPaletteMemory, 0, VK_WHOLE_SIZE, 0, &cf.jointPaletteMapped) != VK_SUCCESS)
+            cf.jointPaletteMapped = cf.jointPaletteMemory.mapped;
+            if (!cf.jointPaletteMapped)
                 return false;
 
             // Instance world SSBO (host-visible, coherent, persistently mapped)
             constexpr uint32_t kDefaultInstanceWorldCapacitySlots = 256;
             cf.instanceWorldCapacitySlots = kDefaultInstanceWorldCapacitySlots;
 
-            VkBufferCreateInfo iwinfo{};
-            iwinfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-            iwinfo.size = static_cast<VkDeviceSize>(cf.instanceWorldCapacitySlots) * sizeof(glm::mat4);
-            iwinfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
-            iwinfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            if (CreateBuffer(ctx.GetDevice(), ctx.GetPhysicalDevice(), static_cast<VkDeviceSize>(cf.instanceWorldCapacitySlots) * sizeof(glm::mat4), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, cf.instanceWorldBuffer, cf.instanceWorldMemory) != VK_SUCCESS)
+                return false;
 
-            if (vkCreateBuffer(ctx.GetDevice(), &iwinfo, nullptr, &cf.instanceWorldBuffer) != VK_SUCCESS)
+            cf.instanceWorldMapped = cf.instanceWorldMemory.mapped;
+            if (!cf.instanceWorldMapped)
                 return false;
 
-            VkMemoryRequirements iwMemReq{};
-            vkGetBufferMemoryRequirements(ctx.GetDevice(), cf.instanceWorldBuffer, &iwMemReq);
+            // Active slots SSBO (host-visible, coherent, persistently mapped)
+            constexpr uint32_t kDefaultActiveSlotsCapacity = 256;
+            cf.activeSlotsCapacity = kDefaultActiveSlotsCapacity;
 
-            VkMemoryAllocateInfo iwMai{};
-            iwMai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-            iwMai.allocationSize = iwMemReq.size;
-            uint32_t iwMemType = 0;
-            if (!findMemoryType(iwMemReq.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, iwMemType))
+            if (CreateBuffer(ctx.GetDevice(), ctx.GetPhysicalDevice(), static_cast<VkDeviceSize>(cf.activeSlotsCapacity) * sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, cf.activeSlotsBuffer, cf.activeSlotsMemory,
+                             m_queueFamilyCount, m_queueFamilies) != VK_SUCCESS)
                 return false;
-            iwMai.memoryTypeIndex = iwMemType;
 
-            if (vkAllocateMemory(ctx.GetDevice(), &iwMai, nullptr, &cf.instanceWorldMemory) != VK_SUCCESS)
+            cf.activeSlotsMapped = cf.activeSlotsMemory.mapped;
+            if (!cf.activeSlotsMapped)
                 return false;
 
-            vkBindBufferMemory(ctx.GetDevice(), cf.instanceWorldBuffer, cf.instanceWorldMemory, 0);
+            // Draw data SSBO + indirect commands (host-visible, coherent, persistently mapped)
+            constexpr uint32_t kDefaultDrawCapacity = 64;
+            cf.drawDataCapacity = kDefaultDrawCapacity;
 
-            cf.instanceWorldMapped = nullptr;
-            if (vkMapMemory(ctx.GetDevice(), cf.instanceWorldMemory, 0, VK_WHOLE_SIZE, 0, &cf.instanceWorldMapped) != VK_SUCCESS)
+            if (CreateBuffer(ctx.GetDevice(), ctx.GetPhysicalDevice(), static_cast<VkDeviceSize>(cf.drawDataCapacity) * sizeof(uint32_t) * 4u, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, cf.drawDataBuffer, cf.drawDataMemory) != VK_SUCCESS)
                 return false;
 
-            // Active slots SSBO (host-visible, coherent, persistently mapped)
-            constexpr uint32_t kDefaultActiveSlotsCapacity = 256;
-            cf.activeSlotsCapacity = kDefaultActiveSlotsCapacity;
+            cf.drawDataMapped = cf.drawDataMemory.mapped;
+            if (!cf.drawDataMapped)
+                return false;
 
-            VkBufferCreateInfo asInfo{};
-            asInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-            asInfo.size = static_cast<VkDeviceSize>(cf.activeSlotsCapacity) * sizeof(uint32_t);
-            asInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
-            asInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            cf.indirectCapacity = kDefaultDrawCapacity;
+
+            if (CreateBuffer(ctx.GetDevice(), ctx.GetPhysicalDevice(), static_cast<VkDeviceSize>(cf.indirectCapacity) * sizeof(VkDrawIndexedIndirectCommand), VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, cf.indirectBuffer, cf.indirectMemory,
+                             m_queueFamilyCount, m_queueFamilies) != VK_SUCCESS)
+                return false;
 
-            if (vkCreateBuffer(ctx.GetDevice(), &asInfo, nullptr, &cf.activeSlotsBuffer) != VK_SUCCESS)
+            cf.indirectMapped = cf.indirectMemory.mapped;
+            if (!cf.indirectMapped)
                 return false;
 
-            VkMemoryRequirements asMemReq{};
-            vkGetBufferMemoryRequirements(ctx.GetDevice(), cf.activeSlotsBuffer, &asMemReq);
+            // Culling inputs (host-visible) + visible counter (device-local, cleared per frame)
+            constexpr uint32_t kDefaultCullCapacity = 256;
+            cf.boundsCapacitySlots = kDefaultCullCapacity;
 
-            VkMemoryAllocateInfo asMai{};
-            asMai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-            asMai.allocationSize = asMemReq.size;
-            uint32_t asMemType = 0;
-            if (!findMemoryType(asMemReq.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, asMemType))
+            if (CreateBuffer(ctx.GetDevice(), ctx.GetPhysicalDevice(), static_cast<VkDeviceSize>(cf.boundsCapacitySlots) * sizeof(glm::vec4), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, cf.boundsBuffer, cf.boundsMemory,
+                             m_queueFamilyCount, m_queueFamilies) != VK_SUCCESS)
                 return false;
-            asMai.memoryTypeIndex = asMemType;
 
-            if (vkAllocateMemory(ctx.GetDevice(), &asMai, nullptr, &cf.activeSlotsMemory) != VK_SUCCESS)
+            cf.boundsMapped = cf.boundsMemory.mapped;
+            if (!cf.boundsMapped)
                 return false;
 
-            vkBindBufferMemory(ctx.GetDevice(), cf.activeSlotsBuffer, cf.activeSlotsMemory, 0);
+            cf.candidatesCapacity = kDefaultCullCapacity;
 
-            cf.activeSlotsMapped = nullptr;
-            if (vkMapMemory(ctx.GetDevice(), cf.activeSlotsMemory, 0, VK_WHOLE_SIZE, 0, &cf.activeSlotsMapped) != VK_SUCCESS)
+            if (CreateBuffer(ctx.GetDevice(), ctx.GetPhysicalDevice(), static_cast<VkDeviceSize>(cf.candidatesCapacity) * sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, cf.candidatesBuffer, cf.candidatesMemory,
+                             m_queueFamilyCount, m_queueFamilies) != VK_SUCCESS)
+                return false;
+
+            cf.candidatesMapped = cf.candidatesMemory.mapped;
+            if (!cf.candidatesMapped)
                 return false;
 
-            VkDescriptorBufferInfo dbi{};
-            dbi.buffer = cf.buffer;
-            dbi.offset = 0;
-            dbi.range = bufSize;
+            if (CreateDeviceLocalBuffer(ctx.GetDevice(), ctx.GetPhysicalDevice(), sizeof(uint32_t),
+                                        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, cf.counterBuffer, cf.counterMemory,
+                                        m_queueFamilyCount, m_queueFamilies) != VK_SUCCESS)
+                return false;
 
             VkDescriptorBufferInfo pbi{};
             pbi.buffer = cf.paletteBuffer;
@@ -768,15 +882,12 @@ namespace Engine
             asbi.offset = 0;
             asbi.range = static_cast<VkDeviceSize>(cf.activeSlotsCapacity) * sizeof(uint32_t);
 
-            VkWriteDescriptorSet writes[5]{};
-            writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            writes[0].dstSet = cf.set;
-            writes[0].dstBinding = 0;
-            writes[0].dstArrayElement = 0;
-            writes[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-            writes[0].descriptorCount = 1;
-            writes[0].pBufferInfo = &dbi;
+            VkDescriptorBufferInfo ddbi{};
+            ddbi.buffer = cf.drawDataBuffer;
+            ddbi.offset = 0;
+            ddbi.range = static_cast<VkDeviceSize>(cf.drawDataCapacity) * sizeof(uint32_t) * 4u;
 
+            VkWriteDescriptorSet writes[6]{};
             writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
             writes[1].dstSet = cf.set;
             writes[1].dstBinding = 1;
@@ -809,7 +920,15 @@ namespace Engine
             writes[4].descriptorCount = 1;
             writes[4].pBufferInfo = &asbi;
 
-            vkUpdateDescriptorSets(ctx.GetDevice(), 5, writes, 0, nullptr);
+            writes[5].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[5].dstSet = cf.set;
+            writes[5].dstBinding = 5;
+            writes[5].dstArrayElement = 0;
+            writes[5].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writes[5].descriptorCount = 1;
+            writes[5].pBufferInfo = &ddbi;
+
+            vkUpdateDescriptorSets(ctx.GetDevice(), 5, writes + 1, 0, nullptr);
 
             // Per-frame upload epoch tracking (resized by ensureSlotCapacity as needed).
             cf.uploadedTransformEpoch.clear();
@@ -823,94 +942,63 @@ namespace Engine
     {
         for (auto &cf : m_cameraFrames)
         {
-            if (cf.mapped && cf.memory != VK_NULL_HANDLE)
-            {
-                vkUnmapMemory(m_device, cf.memory);
-                cf.mapped = nullptr;
-            }
-
-            if (cf.paletteMapped && cf.paletteMemory != VK_NULL_HANDLE)
-            {
-                vkUnmapMemory(m_device, cf.paletteMemory);
-                cf.paletteMapped = nullptr;
-            }
-
-            if (cf.jointPaletteMapped && cf.jointPaletteMemory != VK_NULL_HANDLE)
-            {
-                vkUnmapMemory(m_device, cf.jointPaletteMemory);
-                cf.jointPaletteMapped = nullptr;
-            }
-
-            if (cf.instanceWorldMapped && cf.instanceWorldMemory != VK_NULL_HANDLE)
-            {
-                vkUnmapMemory(m_device, cf.instanceWorldMemory);
-                cf.instanceWorldMapped = nullptr;
-            }
-
-            if (cf.activeSlotsMapped && cf.activeSlotsMemory != VK_NULL_HANDLE)
-            {
-                vkUnmapMemory(m_device, cf.activeSlotsMemory);
-                cf.activeSlotsMapped = nullptr;
-            }
+            cf.paletteMapped = nullptr;
+            cf.jointPaletteMapped = nullptr;
+            cf.instanceWorldMapped = nullptr;
+            cf.activeSlotsMapped = nullptr;
+            cf.drawDataMapped = nullptr;
+            cf.indirectMapped = nullptr;
+            cf.boundsMapped = nullptr;
+            cf.candidatesMapped = nullptr;
 
-            if (cf.paletteBuffer != VK_NULL_HANDLE)
-            {
-                vkDestroyBuffer(m_device, cf.paletteBuffer, nullptr);
-                cf.paletteBuffer = VK_NULL_HANDLE;
-            }
-            if (cf.paletteMemory != VK_NULL_HANDLE)
-            {
-                vkFreeMemory(m_device, cf.paletteMemory, nullptr);
-                cf.paletteMemory = VK_NULL_HANDLE;
-            }
+            DestroyBuffer(m_device, cf.paletteBuffer, cf.paletteMemory);
             cf.paletteCapacityMatrices = 0;
 
-            if (cf.jointPaletteBuffer != VK_NULL_HANDLE)
-            {
-                vkDestroyBuffer(m_device, cf.jointPaletteBuffer, nullptr);
-                cf.jointPaletteBuffer = VK_NULL_HANDLE;
-            }
-            if (cf.jointPaletteMemory != VK_NULL_HANDLE)
-            {
-                vkFreeMemory(m_device, cf.jointPaletteMemory, nullptr);
-                cf.jointPaletteMemory = VK_NULL_HANDLE;
-            }
+            DestroyBuffer(m_device, cf.jointPaletteBuffer, cf.jointPaletteMemory);
             cf.jointPaletteCapacityMatrices = 0;
 
-            if (cf.instanceWorldBuffer != VK_NULL_HANDLE)
-            {
-                vkDestroyBuffer(m_device, cf.instanceWorldBuffer, nullptr);
-                cf.instanceWorldBuffer = VK_NULL_HANDLE;
-            }
-            if (cf.instanceWorldMemory != VK_NULL_HANDLE)
-            {
-                vkFreeMemory(m_device, cf.instanceWorldMemory, nullptr);
-                cf.instanceWorldMemory = VK_NULL_HANDLE;
-            }
+            DestroyBuffer(m_device, cf.instanceWorldBuffer, cf.instanceWorldMemory);
             cf.instanceWorldCapacitySlots = 0;
 
-            if (cf.activeSlotsBuffer != VK_NULL_HANDLE)
-            {
-                vkDestroyBuffer(m_device, cf.activeSlotsBuffer, nullptr);
-                cf.activeSlotsBuffer = VK_NULL_HANDLE;
-            }
-            if (cf.activeSlotsMemory != VK_NULL_HANDLE)
-            {
-                vkFreeMemory(m_device, cf.activeSlotsMemory, nullptr);
-                cf.activeSlotsMemory = VK_NULL_HANDLE;
-            }
+            DestroyBuffer(m_device, cf.activeSlotsBuffer, cf.activeSlotsMemory);
             cf.activeSlotsCapacity = 0;
 
-            if (cf.buffer != VK_NULL_HANDLE)
-            {
-                vkDestroyBuffer(m_device, cf.buffer, nullptr);
-                cf.buffer = VK_NULL_HANDLE;
-            }
-            if (cf.memory != VK_NULL_HANDLE)
-            {
-                vkFreeMemory(m_device, cf.memory, nullptr);
-                cf.memory = VK_NULL_HANDLE;
-            }
+            DestroyBuffer(m_device, cf.drawDataBuffer, cf.drawDataMemory);
+            cf.drawDataCapacity = 0;
+
+            DestroyBuffer(m_device, cf.indirectBuffer, cf.indirectMemory);
+            cf.indirectCapacity = 0;
+            cf.lastUploadedDrawListVersion = 0;
+            cf.lastUploadedInstanceCount = 0;
+            cf.indirectGpuCounts = false;
+
+            DestroyBuffer(m_device, cf.boundsBuffer, cf.boundsMemory);
+            cf.boundsCapacitySlots = 0;
+
+            DestroyBuffer(m_device, cf.candidatesBuffer, cf.candidatesMemory);
+            cf.candidatesCapacity = 0;
+            cf.lastUploadedCandidatesVersion = 0;
+
+            DestroyBuffer(m_device, cf.counterBuffer, cf.counterMemory);
+
+            cf.deltaMapped = nullptr;
+            DestroyBuffer(m_device, cf.deltaBuffer, cf.deltaMemory);
+            cf.deltaCapacity = 0;
+            cf.slotBuffersBinding = 0;
+            cf.residentUploaded = false;
+
+            cf.cullSet = VK_NULL_HANDLE; // freed with m_cullPool
+            std::fill(std::begin(cf.cullSetBuffers), std::end(cf.cullSetBuffers), VK_NULL_HANDLE);
+            cf.gpuCulled = false;
+
+            cf.shadowSlotsMapped = nullptr;
+            DestroyBuffer(m_device, cf.shadowSlotsBuffer, cf.shadowSlotsMemory);
+            cf.shadowSlotsCapacity = 0;
+            cf.shadowSet = VK_NULL_HANDLE;
+            std::fill(std::begin(cf.shadowSetBuffers), std::end(cf.shadowSetBuffers), VK_NULL_HANDLE);
+            cf.shadowPrepared = false;
+
+            cf.cameraRingBuffer = VK_NULL_HANDLE;
             cf.set = VK_NULL_HANDLE;
 
             cf.uploadedTransformEpoch.clear();
@@ -943,64 +1031,15 @@ namespace Engine
         while (newCap < neededMatrices)
             newCap *= 2u;
 
-        if (frame.paletteMapped && frame.paletteMemory != VK_NULL_HANDLE)
-        {
-            vkUnmapMemory(m_device, frame.paletteMemory);
-            frame.paletteMapped = nullptr;
-        }
-        if (frame.paletteBuffer != VK_NULL_HANDLE)
-        {
-            vkDestroyBuffer(m_device, frame.paletteBuffer, nullptr);
-            frame.paletteBuffer = VK_NULL_HANDLE;
-        }
-        if (frame.paletteMemory != VK_NULL_HANDLE)
-        {
-            vkFreeMemory(m_device, frame.paletteMemory, nullptr);
-            frame.paletteMemory = VK_NULL_HANDLE;
-        }
-
-        auto findMemoryType = [&](uint32_t typeFilter, VkMemoryPropertyFlags properties, uint32_t &typeIndex) -> bool
-        {
-            VkPhysicalDeviceMemoryProperties memProps{};
-            vkGetPhysicalDeviceMemoryProperties(m_physicalDevice, &memProps);
-            for (uint32_t i = 0; i < memProps.memoryTypeCount; ++i)
-            {
-                if ((typeFilter & (1u << i)) && (memProps.memoryTypes[i].propertyFlags & properties) == properties)
-                {
-                    typeIndex = i;
-                    return true;
-                }
-            }
-            return false;
-        };
-
-        VkBufferCreateInfo binfo{};
-        binfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-        binfo.size = static_cast<VkDeviceSize>(newCap) * sizeof(glm::mat4);
-        binfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
-        binfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-        if (vkCreateBuffer(m_device, &binfo, nullptr, &frame.paletteBuffer) != VK_SUCCESS)
-            return false;
-
-        VkMemoryRequirements memReq{};
-        vkGetBufferMemoryRequirements(m_device, frame.paletteBuffer, &memReq);
-
-        VkMemoryAllocateInfo mai{};
-        mai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        mai.allocationSize = memReq.size;
-        uint32_t memType = 0;
-        if (!findMemoryType(memReq.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, memType))
-            return false;
-        mai.memoryTypeIndex = memType;
+        frame.paletteMapped = nullptr;
+        DestroyBuffer(m_device, frame.paletteBuffer, frame.paletteMemory);
 
-        if (vkAllocateMemory(m_device, &mai, nullptr, &frame.paletteMemory) != VK_SUCCESS)
+        if (CreateBuffer(m_device, m_physicalDevice, static_cast<VkDeviceSize>(newCap) * sizeof(glm::mat4), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, frame.paletteBuffer, frame.paletteMemory) != VK_SUCCESS)
             return false;
 
-        vkBindBufferMemory(m_device, frame.paletteBuffer, frame.paletteMemory, 0);
-
-        frame.paletteMapped = nullptr;
-        if (vkMapMemory(m_device, frame.paletteMemory, 0, VK_WHOLE_SIZE, 0, &frame.paletteMapped) != VK_SUCCESS)
+        frame.paletteMapped = frame.paletteMemory.mapped;
+        if (!frame.paletteMapped)
             return false;
 
         frame.paletteCapacityMatrices = newCap;
@@ -1038,64 +1077,15 @@ namespace Engine
         while (newCap < neededMatrices)
             newCap *= 2u;
 
-        if (frame.jointPaletteMapped && frame.jointPaletteMemory != VK_NULL_HANDLE)
-        {
-            vkUnmapMemory(m_device, frame.jointPaletteMemory);
-            frame.jointPaletteMapped = nullptr;
-        }
-        if (frame.jointPaletteBuffer != VK_NULL_HANDLE)
-        {
-            vkDestroyBuffer(m_device, frame.jointPaletteBuffer, nullptr);
-            frame.jointPaletteBuffer = VK_NULL_HANDLE;
-        }
-        if (frame.jointPaletteMemory != VK_NULL_HANDLE)
-        {
-            vkFreeMemory(m_device, frame.jointPaletteMemory, nullptr);
-            frame.jointPaletteMemory = VK_NULL_HANDLE;
-        }
-
-        auto findMemoryType = [&](uint32_t typeFilter, VkMemoryPropertyFlags properties, uint32_t &typeIndex) -> bool
-        {
-            VkPhysicalDeviceMemoryProperties memProps{};
-            vkGetPhysicalDeviceMemoryProperties(m_physicalDevice, &memProps);
-            for (uint32_t i = 0; i < memProps.memoryTypeCount; ++i)
-            {
-                if ((typeFilter & (1u << i)) && (memProps.memoryTypes[i].propertyFlags & properties) == properties)
-                {
-                    typeIndex = i;
-                    return true;
-                }
-            }
-            return false;
-        };
-
-        VkBufferCreateInfo binfo{};
-        binfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-        binfo.size = static_cast<VkDeviceSize>(newCap) * sizeof(glm::mat4);
-        binfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
-        binfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-        if (vkCreateBuffer(m_device, &binfo, nullptr, &frame.jointPaletteBuffer) != VK_SUCCESS)
-            return false;
-
-        VkMemoryRequirements memReq{};
-        vkGetBufferMemoryRequirements(m_device, frame.jointPaletteBuffer, &memReq);
-
-        VkMemoryAllocateInfo mai{};
-        mai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        mai.allocationSize = memReq.size;
-        uint32_t memType = 0;
-        if (!findMemoryType(memReq.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, memType))
-            return false;
-        mai.memoryTypeIndex = memType;
+        frame.jointPaletteMapped = nullptr;
+        DestroyBuffer(m_device, frame.jointPaletteBuffer, frame.jointPaletteMemory);
 
-        if (vkAllocateMemory(m_device, &mai, nullptr, &frame.jointPaletteMemory) != VK_SUCCESS)
+        if (CreateBuffer(m_device, m_physicalDevice, static_cast<VkDeviceSize>(newCap) * sizeof(glm::mat4), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, frame.jointPaletteBuffer, frame.jointPaletteMemory) != VK_SUCCESS)
             return false;
 
-        vkBindBufferMemory(m_device, frame.jointPaletteBuffer, frame.jointPaletteMemory, 0);
-
-        frame.jointPaletteMapped = nullptr;
-        if (vkMapMemory(m_device, frame.jointPaletteMemory, 0, VK_WHOLE_SIZE, 0, &frame.jointPaletteMapped) != VK_SUCCESS)
+        frame.jointPaletteMapped = frame.jointPaletteMemory.mapped;
+        if (!frame.jointPaletteMapped)
             return false;
 
         frame.jointPaletteCapacityMatrices = newCap;
@@ -1133,64 +1123,15 @@ namespace Engine
         while (newCap < neededSlots)
             newCap *= 2u;
 
-        if (frame.instanceWorldMapped && frame.instanceWorldMemory != VK_NULL_HANDLE)
-        {
-            vkUnmapMemory(m_device, frame.instanceWorldMemory);
-            frame.instanceWorldMapped = nullptr;
-        }
-        if (frame.instanceWorldBuffer != VK_NULL_HANDLE)
-        {
-            vkDestroyBuffer(m_device, frame.instanceWorldBuffer, nullptr);
-            frame.instanceWorldBuffer = VK_NULL_HANDLE;
-        }
-        if (frame.instanceWorldMemory != VK_NULL_HANDLE)
-        {
-            vkFreeMemory(m_device, frame.instanceWorldMemory, nullptr);
-            frame.instanceWorldMemory = VK_NULL_HANDLE;
-        }
-
-        auto findMemoryType = [&](uint32_t typeFilter, VkMemoryPropertyFlags properties, uint32_t &typeIndex) -> bool
-        {
-            VkPhysicalDeviceMemoryProperties memProps{};
-            vkGetPhysicalDeviceMemoryProperties(m_physicalDevice, &memProps);
-            for (uint32_t i = 0; i < memProps.memoryTypeCount; ++i)
-            {
-                if ((typeFilter & (1u << i)) && (memProps.memoryTypes[i].propertyFlags & properties) == properties)
-                {
-                    typeIndex = i;
-                    return true;
-                }
-            }
-            return false;
-        };
-
-        VkBufferCreateInfo binfo{};
-        binfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-        binfo.size = static_cast<VkDeviceSize>(newCap) * sizeof(glm::mat4);
-        binfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
-        binfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-        if (vkCreateBuffer(m_device, &binfo, nullptr, &frame.instanceWorldBuffer) != VK_SUCCESS)
-            return false;
-
-        VkMemoryRequirements memReq{};
-        vkGetBufferMemoryRequirements(m_device, frame.instanceWorldBuffer, &memReq);
-
-        VkMemoryAllocateInfo mai{};
-        mai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        mai.allocationSize = memReq.size;
-        uint32_t memType = 0;
-        if (!findMemoryType(memReq.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, memType))
-            return false;
-        mai.memoryTypeIndex = memType;
+        frame.instanceWorldMapped = nullptr;
+        DestroyBuffer(m_device, frame.instanceWorldBuffer, frame.instanceWorldMemory);
 
-        if (vkAllocateMemory(m_device, &mai, nullptr, &frame.instanceWorldMemory) != VK_SUCCESS)
+        if (CreateBuffer(m_device, m_physicalDevice, static_cast<VkDeviceSize>(newCap) * sizeof(glm::mat4), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, frame.instanceWorldBuffer, frame.instanceWorldMemory) != VK_SUCCESS)
             return false;
 
-        vkBindBufferMemory(m_device, frame.instanceWorldBuffer, frame.instanceWorldMemory, 0);
-
-        frame.instanceWorldMapped = nullptr;
-        if (vkMapMemory(m_device, frame.instanceWorldMemory, 0, VK_WHOLE_SIZE, 0, &frame.instanceWorldMapped) != VK_SUCCESS)
+        frame.instanceWorldMapped = frame.instanceWorldMemory.mapped;
+        if (!frame.instanceWorldMapped)
             return false;
 
         frame.instanceWorldCapacitySlots = newCap;
@@ -1227,64 +1168,16 @@ namespace Engine
         while (newCap < needed)
             newCap *= 2u;
 
-        if (frame.activeSlotsMapped && frame.activeSlotsMemory != VK_NULL_HANDLE)
-        {
-            vkUnmapMemory(m_device, frame.activeSlotsMemory);
-            frame.activeSlotsMapped = nullptr;
-        }
-        if (frame.activeSlotsBuffer != VK_NULL_HANDLE)
-        {
-            vkDestroyBuffer(m_device, frame.activeSlotsBuffer, nullptr);
-            frame.activeSlotsBuffer = VK_NULL_HANDLE;
-        }
-        if (frame.activeSlotsMemory != VK_NULL_HANDLE)
-        {
-            vkFreeMemory(m_device, frame.activeSlotsMemory, nullptr);
-            frame.activeSlotsMemory = VK_NULL_HANDLE;
-        }
-
-        auto findMemoryType = [&](uint32_t typeFilter, VkMemoryPropertyFlags properties, uint32_t &typeIndex) -> bool
-        {
-            VkPhysicalDeviceMemoryProperties memProps{};
-            vkGetPhysicalDeviceMemoryProperties(m_physicalDevice, &memProps);
-            for (uint32_t i = 0; i < memProps.memoryTypeCount; ++i)
-            {
-                if ((typeFilter & (1u << i)) && (memProps.memoryTypes[i].propertyFlags & properties) == properties)
-                {
-                    typeIndex = i;
-                    return true;
-                }
-            }
-            return false;
-        };
-
-        VkBufferCreateInfo binfo{};
-        binfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-        binfo.size = static_cast<VkDeviceSize>(newCap) * sizeof(uint32_t);
-        binfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
-        binfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-        if (vkCreateBuffer(m_device, &binfo, nullptr, &frame.activeSlotsBuffer) != VK_SUCCESS)
-            return false;
-
-        VkMemoryRequirements memReq{};
-        vkGetBufferMemoryRequirements(m_device, frame.activeSlotsBuffer, &memReq);
-
-        VkMemoryAllocateInfo mai{};
-        mai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        mai.allocationSize = memReq.size;
-        uint32_t memType = 0;
-        if (!findMemoryType(memReq.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, memType))
-            return false;
-        mai.memoryTypeIndex = memType;
+        frame.activeSlotsMapped = nullptr;
+        DestroyBuffer(m_device, frame.activeSlotsBuffer, frame.activeSlotsMemory);
 
-        if (vkAllocateMemory(m_device, &mai, nullptr, &frame.activeSlotsMemory) != VK_SUCCESS)
+        if (CreateBuffer(m_device, m_physicalDevice, static_cast<VkDeviceSize>(newCap) * sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, frame.activeSlotsBuffer, frame.activeSlotsMemory,
+                         m_queueFamilyCount, m_queueFamilies) != VK_SUCCESS)
             return false;
 
-        vkBindBufferMemory(m_device, frame.activeSlotsBuffer, frame.activeSlotsMemory, 0);
-
-        frame.activeSlotsMapped = nullptr;
-        if (vkMapMemory(m_device, frame.activeSlotsMemory, 0, VK_WHOLE_SIZE, 0, &frame.activeSlotsMapped) != VK_SUCCESS)
+        frame.activeSlotsMapped = frame.activeSlotsMemory.mapped;
+        if (!frame.activeSlotsMapped)
             return false;
 
         frame.activeSlotsCapacity = newCap;
@@ -1307,420 +1200,3012 @@ namespace Engine
         return true;
     }
 
-    void SModelRenderPassModule::createPipelines(VulkanContext &ctx, VkRenderPass pass)
+    bool SModelRenderPassModule::ensureDrawDataCapacity(CameraFrame &frame, uint32_t neededDraws)
     {
-        if (m_cameraSetLayout == VK_NULL_HANDLE)
-        {
-            throw std::runtime_error("SModelRenderPassModule: camera descriptor set layout not created");
-        }
-        if (m_materialSetLayout == VK_NULL_HANDLE)
-        {
-            throw std::runtime_error("SModelRenderPassModule: material descriptor set layout not created");
-        }
-
-        // Shared pipeline layout: camera set + push constants.
+        if (neededDraws <= frame.drawDataCapacity)
+            return true;
+        if (m_device == VK_NULL_HANDLE || m_physicalDevice == VK_NULL_HANDLE)
+            return false;
+        if (frame.set == VK_NULL_HANDLE)
+            return false;
+
+        uint32_t newCap = std::max<uint32_t>(1u, frame.drawDataCapacity);
+        while (newCap < neededDraws)
+            newCap *= 2u;
+
+        frame.drawDataMapped = nullptr;
+        DestroyBuffer(m_device, frame.drawDataBuffer, frame.drawDataMemory);
+
+        const VkDeviceSize bytes = static_cast<VkDeviceSize>(newCap) * sizeof(uint32_t) * 4u;
+        if (CreateBuffer(m_device, m_physicalDevice, bytes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, frame.drawDataBuffer, frame.drawDataMemory) != VK_SUCCESS)
+            return false;
+
+        frame.drawDataMapped = frame.drawDataMemory.mapped;
+        if (!frame.drawDataMapped)
+            return false;
+
+        frame.drawDataCapacity = newCap;
+        frame.lastUploadedDrawListVersion = 0;
+
+        VkDescriptorBufferInfo bi{};
+        bi.buffer = frame.drawDataBuffer;
+        bi.offset = 0;
+        bi.range = bytes;
+
+        VkWriteDescriptorSet write{};
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = frame.set;
+        write.dstBinding = 5;
+        write.dstArrayElement = 0;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        write.descriptorCount = 1;
+        write.pBufferInfo = &bi;
+        vkUpdateDescriptorSets(m_device, 1, &write, 0, nullptr);
+        return true;
+    }
+
+    bool SModelRenderPassModule::ensureIndirectCapacity(CameraFrame &frame, uint32_t neededDraws)
+    {
+        if (neededDraws <= frame.indirectCapacity)
+            return true;
+        if (m_device == VK_NULL_HANDLE || m_physicalDevice == VK_NULL_HANDLE)
+            return false;
+
+        uint32_t newCap = std::max<uint32_t>(1u, frame.indirectCapacity);
+        while (newCap < neededDraws)
+            newCap *= 2u;
+
+        frame.indirectMapped = nullptr;
+        DestroyBuffer(m_device, frame.indirectBuffer, frame.indirectMemory);
+
+        if (CreateBuffer(m_device, m_physicalDevice, static_cast<VkDeviceSize>(newCap) * sizeof(VkDrawIndexedIndirectCommand), VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, frame.indirectBuffer, frame.indirectMemory,
+                         m_queueFamilyCount, m_queueFamilies) != VK_SUCCESS)
+            return false;
+
+        frame.indirectMapped = frame.indirectMemory.mapped;
+        if (!frame.indirectMapped)
+            return false;
+
+        frame.indirectCapacity = newCap;
+        frame.lastUploadedDrawListVersion = 0;
+        return true;
+    }
+
+    bool SModelRenderPassModule::ensureCullCapacity(CameraFrame &frame, uint32_t slotCapacity, uint32_t candidates)
+    {
+        if (m_device == VK_NULL_HANDLE || m_physicalDevice == VK_NULL_HANDLE)
+            return false;
+
+        // The cull descriptor set is rewritten by recordPrePass() when a buffer handle changes.
+        if (slotCapacity > frame.boundsCapacitySlots)
+        {
+            uint32_t newCap = std::max<uint32_t>(1u, frame.boundsCapacitySlots);
+            while (newCap < slotCapacity)
+                newCap *= 2u;
+
+            frame.boundsMapped = nullptr;
+            DestroyBuffer(m_device, frame.boundsBuffer, frame.boundsMemory);
+
+            if (CreateBuffer(m_device, m_physicalDevice, static_cast<VkDeviceSize>(newCap) * sizeof(glm::vec4), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, frame.boundsBuffer, frame.boundsMemory,
+                             m_queueFamilyCount, m_queueFamilies) != VK_SUCCESS)
+                return false;
+
+            frame.boundsMapped = frame.boundsMemory.mapped;
+            if (!frame.boundsMapped)
+                return false;
+
+            frame.boundsCapacitySlots = newCap;
+            // Bounds ride on the transform epoch: force a full re-upload.
+            if (!frame.uploadedTransformEpoch.empty())
+                std::fill(frame.uploadedTransformEpoch.begin(), frame.uploadedTransformEpoch.end(), 0u);
+        }
+
+        if (candidates > frame.candidatesCapacity)
+        {
+            uint32_t newCap = std::max<uint32_t>(1u, frame.candidatesCapacity);
+            while (newCap < candidates)
+                newCap *= 2u;
+
+            frame.candidatesMapped = nullptr;
+            DestroyBuffer(m_device, frame.candidatesBuffer, frame.candidatesMemory);
+
+            if (CreateBuffer(m_device, m_physicalDevice, static_cast<VkDeviceSize>(newCap) * sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, frame.candidatesBuffer, frame.candidatesMemory,
+                             m_queueFamilyCount, m_queueFamilies) != VK_SUCCESS)
+                return false;
+
+            frame.candidatesMapped = frame.candidatesMemory.mapped;
+            if (!frame.candidatesMapped)
+                return false;
+
+            frame.candidatesCapacity = newCap;
+            frame.lastUploadedCandidatesVersion = 0;
+        }
+        return true;
+    }
+
+    bool SModelRenderPassModule::createCullResources(VulkanContext &ctx)
+    {
+        destroyCullResources();
+        if (m_cameraFrames.empty())
+            return false;
+
+        // Set 0: candidates, bounds, visible slots, indirect commands, counter, Hi-Z pyramid
+        VkDescriptorSetLayoutBinding bindings[6]{};
+        for (uint32_t i = 0; i < 6u; ++i)
+        {
+            bindings[i].binding = i;
+            bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            bindings[i].descriptorCount = 1;
+            bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        }
+
+        VkDescriptorSetLayoutCreateInfo dsl{};
+        dsl.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        dsl.bindingCount = 6;
+        dsl.pBindings = bindings;
+        if (vkCreateDescriptorSetLayout(ctx.GetDevice(), &dsl, nullptr, &m_cullSetLayout) != VK_SUCCESS)
+            return false;
+
+        const uint32_t frameCount = static_cast<uint32_t>(m_cameraFrames.size());
+
+        VkDescriptorPoolSize poolSize{};
+        poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        poolSize.descriptorCount = frameCount * 6u;
+
+        VkDescriptorPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.maxSets = frameCount;
+        poolInfo.poolSizeCount = 1;
+        poolInfo.pPoolSizes = &poolSize;
+        if (vkCreateDescriptorPool(ctx.GetDevice(), &poolInfo, nullptr, &m_cullPool) != VK_SUCCESS)
+            return false;
+
+        std::vector<VkDescriptorSetLayout> layouts(frameCount, m_cullSetLayout);
+        std::vector<VkDescriptorSet> sets(frameCount, VK_NULL_HANDLE);
+        VkDescriptorSetAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = m_cullPool;
+        allocInfo.descriptorSetCount = frameCount;
+        allocInfo.pSetLayouts = layouts.data();
+        if (vkAllocateDescriptorSets(ctx.GetDevice(), &allocInfo, sets.data()) != VK_SUCCESS)
+            return false;
+        for (uint32_t i = 0; i < frameCount; ++i)
+        {
+            m_cameraFrames[i].cullSet = sets[i];
+            std::fill(std::begin(m_cameraFrames[i].cullSetBuffers), std::end(m_cameraFrames[i].cullSetBuffers), VK_NULL_HANDLE);
+        }
+
+        // Push constants: 6 frustum planes + uvec4 info (see smodel_cull.comp)
+        VkPushConstantRange pcRange{};
+        pcRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pcRange.offset = 0;
+        pcRange.size = sizeof(float) * 4u * 6u + sizeof(uint32_t) * 4u;
+
+        VkPipelineLayoutCreateInfo plInfo{};
+        plInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        plInfo.setLayoutCount = 1;
+        plInfo.pSetLayouts = &m_cullSetLayout;
+        plInfo.pushConstantRangeCount = 1;
+        plInfo.pPushConstantRanges = &pcRange;
+        if (vkCreatePipelineLayout(ctx.GetDevice(), &plInfo, nullptr, &m_cullPipelineLayout) != VK_SUCCESS)
+            return false;
+
+        VkShaderModule comp = VK_NULL_HANDLE;
+        try
+        {
+            comp = Pipeline::createShaderModuleFromFile(ctx.GetDevice(), "shaders/smodel_cull.comp.spv");
+        }
+        catch (const std::exception &)
+        {
+            return false;
+        }
+
+        VkComputePipelineCreateInfo cpi{};
+        cpi.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        cpi.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        cpi.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        cpi.stage.module = comp;
+        cpi.stage.pName = "main";
+        cpi.layout = m_cullPipelineLayout;
+
+        const VkResult r = vkCreateComputePipelines(ctx.GetDevice(), ctx.GetPipelineCache(), 1, &cpi, nullptr, &m_cullPipeline);
+        vkDestroyShaderModule(ctx.GetDevice(), comp, nullptr);
+        return r == VK_SUCCESS;
+    }
+
+    void SModelRenderPassModule::destroyCullResources()
+    {
+        m_cullReady = false;
+        if (m_device == VK_NULL_HANDLE)
+            return;
+
+        if (m_cullPipeline != VK_NULL_HANDLE)
+        {
+            vkDestroyPipeline(m_device, m_cullPipeline, nullptr);
+            m_cullPipeline = VK_NULL_HANDLE;
+        }
+        if (m_cullPipelineLayout != VK_NULL_HANDLE)
+        {
+            vkDestroyPipelineLayout(m_device, m_cullPipelineLayout, nullptr);
+            m_cullPipelineLayout = VK_NULL_HANDLE;
+        }
+        for (auto &cf : m_cameraFrames)
+            cf.cullSet = VK_NULL_HANDLE;
+        if (m_cullPool != VK_NULL_HANDLE)
+        {
+            vkDestroyDescriptorPool(m_device, m_cullPool, nullptr);
+            m_cullPool = VK_NULL_HANDLE;
+        }
+        if (m_cullSetLayout != VK_NULL_HANDLE)
+        {
+            vkDestroyDescriptorSetLayout(m_device, m_cullSetLayout, nullptr);
+            m_cullSetLayout = VK_NULL_HANDLE;
+        }
+    }
+
+    bool SModelRenderPassModule::createPoseResources(VulkanContext &ctx)
+    {
+        destroyPoseResources();
+        if (m_cameraFrames.empty())
+            return false;
+
+        // Set 0: inputs, pose data, node palette, joint palette
+        VkDescriptorSetLayoutBinding bindings[4]{};
+        for (uint32_t i = 0; i < 4u; ++i)
+        {
+            bindings[i].binding = i;
+            bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            bindings[i].descriptorCount = 1;
+            bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        }
+
+        VkDescriptorSetLayoutCreateInfo dsl{};
+        dsl.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        dsl.bindingCount = 4;
+        dsl.pBindings = bindings;
+        if (vkCreateDescriptorSetLayout(ctx.GetDevice(), &dsl, nullptr, &m_poseSetLayout) != VK_SUCCESS)
+            return false;
+
+        const uint32_t frameCount = static_cast<uint32_t>(m_cameraFrames.size());
+
+        VkDescriptorPoolSize poolSize{};
+        poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        poolSize.descriptorCount = frameCount * 4u;
+
+        VkDescriptorPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.maxSets = frameCount;
+        poolInfo.poolSizeCount = 1;
+        poolInfo.pPoolSizes = &poolSize;
+        if (vkCreateDescriptorPool(ctx.GetDevice(), &poolInfo, nullptr, &m_posePool) != VK_SUCCESS)
+            return false;
+
+        std::vector<VkDescriptorSetLayout> layouts(frameCount, m_poseSetLayout);
+        std::vector<VkDescriptorSet> sets(frameCount, VK_NULL_HANDLE);
+        VkDescriptorSetAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = m_posePool;
+        allocInfo.descriptorSetCount = frameCount;
+        allocInfo.pSetLayouts = layouts.data();
+        if (vkAllocateDescriptorSets(ctx.GetDevice(), &allocInfo, sets.data()) != VK_SUCCESS)
+            return false;
+        for (uint32_t i = 0; i < frameCount; ++i)
+        {
+            m_cameraFrames[i].poseSet = sets[i];
+            std::fill(std::begin(m_cameraFrames[i].poseSetBuffers), std::end(m_cameraFrames[i].poseSetBuffers), VK_NULL_HANDLE);
+        }
+
+        // Push constants: counts + three uvec4 of word offsets (see smodel_pose.comp)
+        VkPushConstantRange pcRange{};
+        pcRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pcRange.offset = 0;
+        pcRange.size = sizeof(uint32_t) * 16u;
+
+        VkPipelineLayoutCreateInfo plInfo{};
+        plInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        plInfo.setLayoutCount = 1;
+        plInfo.pSetLayouts = &m_poseSetLayout;
+        plInfo.pushConstantRangeCount = 1;
+        plInfo.pPushConstantRanges = &pcRange;
+        if (vkCreatePipelineLayout(ctx.GetDevice(), &plInfo, nullptr, &m_posePipelineLayout) != VK_SUCCESS)
+            return false;
+
+        VkShaderModule comp = VK_NULL_HANDLE;
+        try
+        {
+            comp = Pipeline::createShaderModuleFromFile(ctx.GetDevice(), "shaders/smodel_pose.comp.spv");
+        }
+        catch (const std::exception &)
+        {
+            return false;
+        }
+
+        VkComputePipelineCreateInfo cpi{};
+        cpi.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        cpi.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        cpi.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        cpi.stage.module = comp;
+        cpi.stage.pName = "main";
+        cpi.layout = m_posePipelineLayout;
+
+        const VkResult r = vkCreateComputePipelines(ctx.GetDevice(), ctx.GetPipelineCache(), 1, &cpi, nullptr, &m_posePipeline);
+        vkDestroyShaderModule(ctx.GetDevice(), comp, nullptr);
+        return r == VK_SUCCESS;
+    }
+
+    void SModelRenderPassModule::destroyPoseResources()
+    {
+        m_poseReady = false;
+        m_poseDispatchable = false;
+        if (m_device == VK_NULL_HANDLE)
+            return;
+
+        for (auto &cf : m_cameraFrames)
+        {
+            cf.poseInputMapped = nullptr;
+            DestroyBuffer(m_device, cf.poseInputBuffer, cf.poseInputMemory);
+            cf.poseInputCapacity = 0;
+            cf.poseSet = VK_NULL_HANDLE; // freed with m_posePool
+            std::fill(std::begin(cf.poseSetBuffers), std::end(cf.poseSetBuffers), VK_NULL_HANDLE);
+        }
+
+        DestroyBuffer(m_device, m_poseDataBuffer, m_poseDataMemory);
+        m_poseDataModel = nullptr;
+        m_poseLayout = PoseDataLayout{};
+
+        if (m_posePipeline != VK_NULL_HANDLE)
+        {
+            vkDestroyPipeline(m_device, m_posePipeline, nullptr);
+            m_posePipeline = VK_NULL_HANDLE;
+        }
+        if (m_posePipelineLayout != VK_NULL_HANDLE)
+        {
+            vkDestroyPipelineLayout(m_device, m_posePipelineLayout, nullptr);
+            m_posePipelineLayout = VK_NULL_HANDLE;
+        }
+        if (m_posePool != VK_NULL_HANDLE)
+        {
+            vkDestroyDescriptorPool(m_device, m_posePool, nullptr);
+            m_posePool = VK_NULL_HANDLE;
+        }
+        if (m_poseSetLayout != VK_NULL_HANDLE)
+        {
+            vkDestroyDescriptorSetLayout(m_device, m_poseSetLayout, nullptr);
+            m_poseSetLayout = VK_NULL_HANDLE;
+        }
+    }
+
+    bool SModelRenderPassModule::preparePoseData(VkCommandBuffer cmd)
+    {
+        if (!m_assets || !m_model.isValid())
+            return false;
+
+        const ModelAsset *model = m_assets->getModel(m_model);
+        if (!model || model->nodes.empty())
+            return false;
+
+        // The dispatch writes whole slots laid out by setSlotLayout(); both must agree.
+        const uint32_t nodeCount = static_cast<uint32_t>(model->nodes.size());
+        if (m_slotNodeCount != nodeCount || m_slotJointCount != model->totalJointCount)
+            return false;
+
+        if (m_poseDataModel == model && m_poseLayout.nodeCount == nodeCount && m_poseLayout.jointCount == model->totalJointCount)
+            return true;
+
+        // smodel_pose.comp samples raw channels; models cooked with only quantized clips stay on the CPU.
+        if (model->hasQuantizedAnimation() && model->animSamplers.empty())
+        {
+            m_poseDataFailed = true;
+            return false;
+        }
+
+        if (!buildPoseData(*model, cmd))
+        {
+            // Out of memory: leave every pose to the CPU from now on.
+            m_poseDataFailed = true;
+            return false;
+        }
+        return true;
+    }
+
+    bool SModelRenderPassModule::buildPoseData(const ModelAsset &model, VkCommandBuffer cmd)
+    {
+        constexpr uint32_t kNone = ~0u;
+        constexpr uint32_t kUnreached = ~1u;
+
+        const uint32_t nodeCount = static_cast<uint32_t>(model.nodes.size());
+        const bool hasClips = !model.animClips.empty() && !model.animChannels.empty() && !model.animSamplers.empty();
+
+        PoseDataLayout layout{};
+        layout.nodeCount = nodeCount;
+        layout.jointCount = model.totalJointCount;
+        layout.clipCount = hasClips ? static_cast<uint32_t>(model.animClips.size()) : 0u;
+
+        std::vector<uint32_t> &words = m_poseWords;
+        words.clear();
+        auto pushFloat = [&](float f)
+        {
+            uint32_t w = 0;
+            std::memcpy(&w, &f, sizeof(w));
+            words.push_back(w);
+        };
+
+        // Parent-before-child order, with the parent each node inherits from when walked
+        // from the roots (matches evaluatePoseInto; unreachable nodes stay identity).
+        layout.order = static_cast<uint32_t>(words.size());
+        {
+            std::vector<uint8_t> visited(nodeCount, 0u);
+            std::vector<std::pair<uint32_t, uint32_t>> stack;
+            for (uint32_t root = 0; root < nodeCount; ++root)
+            {
+                if (model.nodes[root].parentIndex != kNone)
+                    continue;
+                stack.emplace_back(root, kNone);
+                while (!stack.empty())
+                {
+                    const auto [node, parent] = stack.back();
+                    stack.pop_back();
+                    if (node >= nodeCount || visited[node])
+                        continue;
+                    visited[node] = 1u;
+                    words.push_back(node);
+                    words.push_back(parent);
+
+                    const ModelAsset::ModelNode &n = model.nodes[node];
+                    if (n.childCount == 0 || n.firstChildIndex == kNone)
+                        continue;
+                    for (uint32_t ci = n.childCount; ci-- > 0;)
+                    {
+                        const uint32_t childSlot = n.firstChildIndex + ci;
+                        if (childSlot < model.nodeChildIndices.size())
+                            stack.emplace_back(model.nodeChildIndices[childSlot], node);
+                    }
+                }
+            }
+            for (uint32_t i = 0; i < nodeCount; ++i)
+            {
+                if (visited[i])
+                    continue;
+                words.push_back(i);
+                words.push_back(kUnreached);
+            }
+        }
+
+        layout.rest = static_cast<uint32_t>(words.size());
+        const bool hasRest = model.restTRS.size() == model.nodes.size();
+        for (uint32_t i = 0; i < nodeCount; ++i)
+        {
+            const ModelAsset::NodeTRS trs = hasRest ? model.restTRS[i] : ModelAsset::NodeTRS{};
+            const float rest[12] = {trs.t.x, trs.t.y, trs.t.z, 0.0f,
+                                    trs.r.x, trs.r.y, trs.r.z, trs.r.w,
+                                    trs.s.x, trs.s.y, trs.s.z, 0.0f};
+            for (float f : rest)
+                pushFloat(f);
+        }
+
+        // Per (clip, node): the sampler driving T/R/S, after the same validity checks as the
+        // CPU path. Later channels win, as they overwrite earlier ones there.
+        layout.clipTable = static_cast<uint32_t>(words.size());
+        words.resize(words.size() + static_cast<size_t>(layout.clipCount) * nodeCount * 3u, kNone);
+        for (uint32_t c = 0; c < layout.clipCount; ++c)
+        {
+            const auto &clip = model.animClips[c];
+            for (uint32_t ci = 0; ci < clip.channelCount; ++ci)
+            {
+                const uint32_t chIdx = clip.firstChannel + ci;
+                if (chIdx >= model.animChannels.size())
+                    break;
+
+                const auto &ch = model.animChannels[chIdx];
+                if (ch.samplerIndex >= model.animSamplers.size() || ch.targetNode >= nodeCount)
+                    continue;
+                const auto &smp = model.animSamplers[ch.samplerIndex];
+                if (smp.timeCount == 0 || smp.firstTime + smp.timeCount > model.animTimes.size())
+                    continue;
+                if (smp.firstValue + smp.valueCount > model.animValues.size())
+                    continue;
+
+                uint32_t path = 0;
+                if (ch.path == (uint16_t)smodel::SModelAnimPath::Translation)
+                    path = 0;
+                else if (ch.path == (uint16_t)smodel::SModelAnimPath::Rotation)
+                    path = 1;
+                else if (ch.path == (uint16_t)smodel::SModelAnimPath::Scale)
+                    path = 2;
+                else
+                    continue;
+
+                words[layout.clipTable + (static_cast<size_t>(c) * nodeCount + ch.targetNode) * 3u + path] = ch.samplerIndex;
+            }
+        }
+
+        layout.samplers = static_cast<uint32_t>(words.size());
+        if (hasClips)
+        {
+            for (const auto &smp : model.animSamplers)
+            {
+                words.push_back(smp.firstTime);
+                words.push_back(smp.timeCount);
+                words.push_back(smp.firstValue);
+                words.push_back(0u);
+            }
+        }
+
+        layout.times = static_cast<uint32_t>(words.size());
+        if (hasClips)
+        {
+            const size_t base = words.size();
+            words.resize(base + model.animTimes.size());
+            std::memcpy(words.data() + base, model.animTimes.data(), sizeof(float) * model.animTimes.size());
+        }
+
+        layout.values = static_cast<uint32_t>(words.size());
+        if (hasClips)
+        {
+            const size_t base = words.size();
+            words.resize(base + model.animValues.size());
+            std::memcpy(words.data() + base, model.animValues.data(), sizeof(float) * model.animValues.size());
+        }
+
+        // Palette joints: node + inverse bind; unmapped joints stay identity like the CPU path.
+        layout.joints = static_cast<uint32_t>(words.size());
+        {
+            const size_t base = words.size();
+            words.resize(base + static_cast<size_t>(layout.jointCount) * 17u, 0u);
+            const glm::mat4 identity(1.0f);
+            for (uint32_t j = 0; j < layout.jointCount; ++j)
+            {
+                words[base + j * 17u] = kNone;
+                std::memcpy(&words[base + j * 17u + 1u], glm::value_ptr(identity), sizeof(glm::mat4));
+            }
+            for (const auto &skin : model.skins)
+            {
+                for (uint32_t j = 0; j < skin.jointCount; ++j)
+                {
+                    if (j >= skin.jointNodeIndices.size() || j >= skin.inverseBind.size())
+                        continue;
+                    const uint32_t outIx = skin.jointBase + j;
+                    if (outIx >= layout.jointCount || skin.jointNodeIndices[j] >= nodeCount)
+                        continue;
+                    words[base + outIx * 17u] = skin.jointNodeIndices[j];
+                    std::memcpy(&words[base + outIx * 17u + 1u], glm::value_ptr(skin.inverseBind[j]), sizeof(glm::mat4));
+                }
+            }
+        }
+
+        // Baked palettes: a frame fetch + lerp per matrix instead of the clip evaluation.
+        if (model.hasBakedAnimation() && model.bakedClips.size() == model.animClips.size())
+        {
+            layout.bakedClipCount = static_cast<uint32_t>(model.bakedClips.size());
+            layout.bakedSampleRate = model.bakedSampleRate;
+
+            layout.bakedClips = static_cast<uint32_t>(words.size());
+            for (const auto &clip : model.bakedClips)
+            {
+                words.push_back(clip.firstFrame);
+                words.push_back(clip.frameCount);
+                pushFloat(clip.durationSec);
+                words.push_back(0u);
+            }
+
+            layout.bakedFrames = static_cast<uint32_t>(words.size());
+            const size_t base = words.size();
+            words.resize(base + model.bakedFrames.size());
+            std::memcpy(words.data() + base, model.bakedFrames.data(), sizeof(float) * model.bakedFrames.size());
+        }
+
+        const VkDeviceSize bytes = static_cast<VkDeviceSize>(words.size()) * sizeof(uint32_t);
+
+        VkBuffer staging = VK_NULL_HANDLE;
+        GpuAllocation stagingMemory;
+        if (CreateBuffer(m_device, m_physicalDevice, bytes, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, staging, stagingMemory) != VK_SUCCESS ||
+            !stagingMemory.mapped)
+        {
+            DestroyBuffer(m_device, staging, stagingMemory);
+            return false;
+        }
+        std::memcpy(stagingMemory.mapped, words.data(), static_cast<size_t>(bytes));
+
+        // The previous model's tables may still be read by frames in flight.
+        retireBuffer(m_poseDataBuffer, m_poseDataMemory);
+        m_poseDataModel = nullptr;
+        if (CreateDeviceLocalBuffer(m_device, m_physicalDevice, bytes,
+                                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                    m_poseDataBuffer, m_poseDataMemory, m_queueFamilyCount, m_queueFamilies) != VK_SUCCESS)
+        {
+            DestroyBuffer(m_device, staging, stagingMemory);
+            return false;
+        }
+
+        // Visibility to the dispatch comes from the transfer barrier in dispatchGpuPoses().
+        const VkBufferCopy region{0, 0, bytes};
+        vkCmdCopyBuffer(cmd, staging, m_poseDataBuffer, 1, &region);
+        retireBuffer(staging, stagingMemory);
+
+        m_poseLayout = layout;
+        m_poseDataModel = &model;
+        words.clear();
+
+        // Slots evaluated against the old tables must be evaluated again.
+        std::fill(m_resident.uploadedPoseEpoch.begin(), m_resident.uploadedPoseEpoch.end(), 0u);
+        return true;
+    }
+
+    bool SModelRenderPassModule::ensurePoseInputCapacity(CameraFrame &frame, uint32_t needed)
+    {
+        if (needed <= frame.poseInputCapacity)
+            return true;
+
+        uint32_t newCap = std::max<uint32_t>(64u, frame.poseInputCapacity);
+        while (newCap < needed)
+            newCap *= 2u;
+
+        // This frame's fence has signaled: its input buffer is idle.
+        frame.poseInputMapped = nullptr;
+        frame.poseInputCapacity = 0;
+        DestroyBuffer(m_device, frame.poseInputBuffer, frame.poseInputMemory);
+
+        if (CreateBuffer(m_device, m_physicalDevice, static_cast<VkDeviceSize>(newCap) * sizeof(uint32_t) * POSE_INPUT_WORDS, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, frame.poseInputBuffer, frame.poseInputMemory,
+                         m_queueFamilyCount, m_queueFamilies) != VK_SUCCESS)
+            return false;
+
+        frame.poseInputMapped = frame.poseInputMemory.mapped;
+        if (!frame.poseInputMapped)
+            return false;
+
+        frame.poseInputCapacity = newCap;
+        return true;
+    }
+
+    void SModelRenderPassModule::dispatchGpuPoses(CameraFrame &frame, VkCommandBuffer cmd, VkPipelineStageFlags readStages)
+    {
+        const uint32_t count = static_cast<uint32_t>(m_gpuPoseSlots.size());
+        if (count == 0)
+            return;
+
+        if (!ensurePoseInputCapacity(frame, count))
+        {
+            // Nothing was evaluated: hand these slots back to the CPU palettes.
+            for (uint32_t slot : m_gpuPoseSlots)
+                m_resident.uploadedPoseEpoch[slot] = 0u;
+            m_gpuPoseSlots.clear();
+            m_poseDataFailed = true;
+            return;
+        }
+
+        auto *items = static_cast<uint32_t *>(frame.poseInputMapped);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const uint32_t slot = m_gpuPoseSlots[i];
+            const SlotAnimation &anim = m_slotAnimations[slot];
+            uint32_t *item = items + i * POSE_INPUT_WORDS;
+            item[0] = slot;
+            item[1] = anim.clipIndex;
+            std::memcpy(&item[2], &anim.timeSec, sizeof(float));
+            item[3] = (anim.baked && m_poseLayout.bakedClipCount > 0u) ? 1u : 0u;
+            item[4] = anim.blendFromClip;
+            std::memcpy(&item[5], &anim.blendFromTimeSec, sizeof(float));
+            std::memcpy(&item[6], &anim.blendWeight, sizeof(float));
+            item[7] = 0u;
+        }
+
+        // (Re)point the pose set at the current buffers (they move when capacities grow).
+        const VkBuffer buffers[4] = {frame.poseInputBuffer, m_poseDataBuffer, m_resident.paletteBuffer, m_resident.jointPaletteBuffer};
+        if (!std::equal(std::begin(buffers), std::end(buffers), std::begin(frame.poseSetBuffers)))
+        {
+            VkDescriptorBufferInfo infos[4]{};
+            VkWriteDescriptorSet writes[4]{};
+            for (uint32_t i = 0; i < 4u; ++i)
+            {
+                infos[i].buffer = buffers[i];
+                infos[i].offset = 0;
+                infos[i].range = VK_WHOLE_SIZE;
+
+                writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                writes[i].dstSet = frame.poseSet;
+                writes[i].dstBinding = i;
+                writes[i].dstArrayElement = 0;
+                writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                writes[i].descriptorCount = 1;
+                writes[i].pBufferInfo = &infos[i];
+                frame.poseSetBuffers[i] = buffers[i];
+            }
+            vkUpdateDescriptorSets(m_device, 4, writes, 0, nullptr);
+        }
+
+        struct PosePushConstants
+        {
+            uint32_t counts[4];
+            uint32_t offsets0[4];
+            uint32_t offsets1[4];
+            uint32_t offsets2[4];
+        } ppc{};
+        ppc.counts[0] = count;
+        ppc.counts[1] = m_poseLayout.nodeCount;
+        ppc.counts[2] = std::max<uint32_t>(m_slotJointCount, 1u);
+        ppc.counts[3] = m_poseLayout.jointCount;
+        ppc.offsets0[0] = m_poseLayout.order;
+        ppc.offsets0[1] = m_poseLayout.rest;
+        ppc.offsets0[2] = m_poseLayout.clipTable;
+        ppc.offsets0[3] = m_poseLayout.samplers;
+        ppc.offsets1[0] = m_poseLayout.times;
+        ppc.offsets1[1] = m_poseLayout.values;
+        ppc.offsets1[2] = m_poseLayout.joints;
+        ppc.offsets1[3] = m_poseLayout.clipCount;
+        ppc.offsets2[0] = m_poseLayout.bakedClips;
+        ppc.offsets2[1] = m_poseLayout.bakedFrames;
+        ppc.offsets2[2] = m_poseLayout.bakedClipCount;
+        std::memcpy(&ppc.offsets2[3], &m_poseLayout.bakedSampleRate, sizeof(float));
+
+        // Pose tables / CPU palette copies (transfer) and earlier frames' palette reads
+        // (write-after-read) must finish before the dispatch writes the resident palettes.
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT | readStages,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_posePipeline);
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_posePipelineLayout, 0, 1, &frame.poseSet, 0, nullptr);
+        vkCmdPushConstants(cmd, m_posePipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(ppc), &ppc);
+        vkCmdDispatch(cmd, (count + 63u) / 64u, 1, 1);
+
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, readStages,
+                             0, 1, &barrier, 0, nullptr, 0, nullptr);
+    }
+
+    VkPipelineStageFlags SModelRenderPassModule::slotReadStages() const
+    {
+        VkPipelineStageFlags stages = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+        if (m_meshShaderReady)
+            stages |= VK_PIPELINE_STAGE_TASK_SHADER_BIT_EXT | VK_PIPELINE_STAGE_MESH_SHADER_BIT_EXT;
+        return stages;
+    }
+
+    bool SModelRenderPassModule::createMeshletResources(VulkanContext &ctx)
+    {
+        destroyMeshletResources();
+        if (m_cameraFrames.empty())
+            return false;
+
+        // Mesh shaders must hold a cooked meshlet per workgroup and the task payload (32 ids + instance).
+        const VkPhysicalDeviceMeshShaderPropertiesEXT &meshProps = ctx.GetMeshShaderProperties();
+        const bool meshShader = ctx.HasMeshShader() &&
+                                meshProps.maxMeshOutputVertices >= smodel::SMODEL_MAX_MESHLET_VERTICES &&
+                                meshProps.maxMeshOutputPrimitives >= smodel::SMODEL_MAX_MESHLET_TRIANGLES &&
+                                meshProps.maxTaskPayloadSize >= sizeof(uint32_t) * (MESHLET_TASK_GROUP + 1u);
+        if (!meshShader && !ctx.HasDrawIndirectCount())
+            return false;
+
+        // Set: meshlet data, vertex buffer, visible counter, cull UBO, meshlet commands, group counts
+        VkDescriptorSetLayoutBinding bindings[6]{};
+        for (uint32_t i = 0; i < 6u; ++i)
+        {
+            bindings[i].binding = i;
+            bindings[i].descriptorType = i == 3u ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            bindings[i].descriptorCount = 1;
+            bindings[i].stageFlags = m_meshletStages;
+        }
+
+        VkDescriptorSetLayoutCreateInfo dsl{};
+        dsl.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        dsl.bindingCount = 6;
+        dsl.pBindings = bindings;
+        if (vkCreateDescriptorSetLayout(ctx.GetDevice(), &dsl, nullptr, &m_meshletSetLayout) != VK_SUCCESS)
+            return false;
+
+        const uint32_t frameCount = static_cast<uint32_t>(m_cameraFrames.size());
+
+        VkDescriptorPoolSize poolSizes[2]{};
+        poolSizes[0].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        poolSizes[0].descriptorCount = frameCount * 5u;
+        poolSizes[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        poolSizes[1].descriptorCount = frameCount;
+
+        VkDescriptorPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.maxSets = frameCount;
+        poolInfo.poolSizeCount = 2;
+        poolInfo.pPoolSizes = poolSizes;
+        if (vkCreateDescriptorPool(ctx.GetDevice(), &poolInfo, nullptr, &m_meshletPool) != VK_SUCCESS)
+            return false;
+
+        std::vector<VkDescriptorSetLayout> layouts(frameCount, m_meshletSetLayout);
+        std::vector<VkDescriptorSet> sets(frameCount, VK_NULL_HANDLE);
+        VkDescriptorSetAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = m_meshletPool;
+        allocInfo.descriptorSetCount = frameCount;
+        allocInfo.pSetLayouts = layouts.data();
+        if (vkAllocateDescriptorSets(ctx.GetDevice(), &allocInfo, sets.data()) != VK_SUCCESS)
+            return false;
+
+        for (uint32_t i = 0; i < frameCount; ++i)
+        {
+            CameraFrame &cf = m_cameraFrames[i];
+            cf.meshletSet = sets[i];
+            std::fill(std::begin(cf.meshletSetBuffers), std::end(cf.meshletSetBuffers), VK_NULL_HANDLE);
+
+            if (CreateBuffer(ctx.GetDevice(), ctx.GetPhysicalDevice(), sizeof(MeshletCullUBO), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, cf.meshletCullBuffer, cf.meshletCullMemory) != VK_SUCCESS)
+                return false;
+            cf.meshletCullMapped = cf.meshletCullMemory.mapped;
+            if (!cf.meshletCullMapped)
+                return false;
+
+            // Bound by every meshlet set, also on the mesh shader path that leaves them unused.
+            constexpr uint32_t kDefaultMeshletCommands = 1024;
+            constexpr uint32_t kDefaultMeshletGroups = 64;
+            if (!ensureMeshletCommandCapacity(cf, kDefaultMeshletCommands, kDefaultMeshletGroups))
+                return false;
+        }
+
+        if (meshShader)
+        {
+            m_cmdDrawMeshTasks = reinterpret_cast<PFN_vkCmdDrawMeshTasksEXT>(vkGetDeviceProcAddr(ctx.GetDevice(), "vkCmdDrawMeshTasksEXT"));
+            m_maxTaskWorkGroupCount[0] = meshProps.maxTaskWorkGroupCount[0];
+            m_maxTaskWorkGroupCount[1] = meshProps.maxTaskWorkGroupCount[1];
+            m_maxTaskWorkGroupTotal = meshProps.maxTaskWorkGroupTotalCount;
+        }
+
+        // Compute path: smodel_meshlet_cull.comp (set 0 = camera set, set 1 = meshlet set).
+        if (ctx.HasDrawIndirectCount())
+        {
+            m_cmdDrawIndexedIndirectCount = reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCountKHR>(
+                vkGetDeviceProcAddr(ctx.GetDevice(), "vkCmdDrawIndexedIndirectCountKHR"));
+
+            VkPhysicalDeviceProperties props{};
+            vkGetPhysicalDeviceProperties(ctx.GetPhysicalDevice(), &props);
+            m_maxComputeWorkGroupCountY = props.limits.maxComputeWorkGroupCount[1];
+
+            // Push constants: meshlet count, candidates, node count, joint palette stride
+            VkPushConstantRange pcRange{};
+            pcRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+            pcRange.offset = 0;
+            pcRange.size = sizeof(uint32_t) * 4u;
+
+            const VkDescriptorSetLayout setLayouts[2] = {m_cameraSetLayout, m_meshletSetLayout};
+            VkPipelineLayoutCreateInfo plInfo{};
+            plInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+            plInfo.setLayoutCount = 2;
+            plInfo.pSetLayouts = setLayouts;
+            plInfo.pushConstantRangeCount = 1;
+            plInfo.pPushConstantRanges = &pcRange;
+
+            VkShaderModule comp = VK_NULL_HANDLE;
+            try
+            {
+                comp = Pipeline::createShaderModuleFromFile(ctx.GetDevice(), "shaders/smodel_meshlet_cull.comp.spv");
+            }
+            catch (const std::exception &)
+            {
+                comp = VK_NULL_HANDLE;
+            }
+
+            if (m_cmdDrawIndexedIndirectCount && comp != VK_NULL_HANDLE &&
+                vkCreatePipelineLayout(ctx.GetDevice(), &plInfo, nullptr, &m_meshletCullPipelineLayout) == VK_SUCCESS)
+            {
+                VkComputePipelineCreateInfo cpi{};
+                cpi.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+                cpi.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+                cpi.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+                cpi.stage.module = comp;
+                cpi.stage.pName = "main";
+                cpi.layout = m_meshletCullPipelineLayout;
+                m_meshletComputeReady = vkCreateComputePipelines(ctx.GetDevice(), ctx.GetPipelineCache(), 1, &cpi, nullptr, &m_meshletCullPipeline) == VK_SUCCESS;
+            }
+            if (comp != VK_NULL_HANDLE)
+                vkDestroyShaderModule(ctx.GetDevice(), comp, nullptr);
+        }
+        return m_cmdDrawMeshTasks != nullptr || m_meshletComputeReady;
+    }
+
+    void SModelRenderPassModule::destroyMeshletResources()
+    {
+        m_meshShaderReady = false;
+        m_meshletComputeReady = false;
+        m_cmdDrawMeshTasks = nullptr;
+        m_cmdDrawIndexedIndirectCount = nullptr;
+        if (m_device == VK_NULL_HANDLE)
+            return;
+
+        for (auto &cf : m_cameraFrames)
+        {
+            cf.meshletCullMapped = nullptr;
+            DestroyBuffer(m_device, cf.meshletCullBuffer, cf.meshletCullMemory);
+            DestroyBuffer(m_device, cf.meshletCommandBuffer, cf.meshletCommandMemory);
+            cf.meshletCommandCapacity = 0;
+            DestroyBuffer(m_device, cf.groupCountBuffer, cf.groupCountMemory);
+            cf.groupCountCapacity = 0;
+            cf.meshletSet = VK_NULL_HANDLE; // freed with m_meshletPool
+            std::fill(std::begin(cf.meshletSetBuffers), std::end(cf.meshletSetBuffers), VK_NULL_HANDLE);
+            cf.meshletsPrepared = false;
+            cf.meshletCommands = false;
+        }
+
+        DestroyBuffer(m_device, m_meshletDataBuffer, m_meshletDataMemory);
+        m_meshletDataVersion = 0;
+        m_meshletRecordCount = 0;
+
+        if (m_meshletCullPipeline != VK_NULL_HANDLE)
+        {
+            vkDestroyPipeline(m_device, m_meshletCullPipeline, nullptr);
+            m_meshletCullPipeline = VK_NULL_HANDLE;
+        }
+        if (m_meshletCullPipelineLayout != VK_NULL_HANDLE)
+        {
+            vkDestroyPipelineLayout(m_device, m_meshletCullPipelineLayout, nullptr);
+            m_meshletCullPipelineLayout = VK_NULL_HANDLE;
+        }
+        if (m_meshletPool != VK_NULL_HANDLE)
+        {
+            vkDestroyDescriptorPool(m_device, m_meshletPool, nullptr);
+            m_meshletPool = VK_NULL_HANDLE;
+        }
+        if (m_meshletSetLayout != VK_NULL_HANDLE)
+        {
+            vkDestroyDescriptorSetLayout(m_device, m_meshletSetLayout, nullptr);
+            m_meshletSetLayout = VK_NULL_HANDLE;
+        }
+    }
+
+    bool SModelRenderPassModule::ensureMeshletCommandCapacity(CameraFrame &frame, uint32_t commands, uint32_t groups)
+    {
+        // This frame's fence has signaled: its command arrays are idle.
+        if (commands > frame.meshletCommandCapacity)
+        {
+            uint32_t newCap = std::max<uint32_t>(1024u, frame.meshletCommandCapacity);
+            while (newCap < commands)
+                newCap *= 2u;
+
+            frame.meshletCommandCapacity = 0;
+            DestroyBuffer(m_device, frame.meshletCommandBuffer, frame.meshletCommandMemory);
+            if (CreateDeviceLocalBuffer(m_device, m_physicalDevice, static_cast<VkDeviceSize>(newCap) * sizeof(VkDrawIndexedIndirectCommand),
+                                        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                                        frame.meshletCommandBuffer, frame.meshletCommandMemory) != VK_SUCCESS)
+                return false;
+            frame.meshletCommandCapacity = newCap;
+        }
+
+        if (groups > frame.groupCountCapacity)
+        {
+            uint32_t newCap = std::max<uint32_t>(64u, frame.groupCountCapacity);
+            while (newCap < groups)
+                newCap *= 2u;
+
+            frame.groupCountCapacity = 0;
+            DestroyBuffer(m_device, frame.groupCountBuffer, frame.groupCountMemory);
+            if (CreateDeviceLocalBuffer(m_device, m_physicalDevice, static_cast<VkDeviceSize>(newCap) * sizeof(uint32_t),
+                                        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                        frame.groupCountBuffer, frame.groupCountMemory) != VK_SUCCESS)
+                return false;
+            frame.groupCountCapacity = newCap;
+        }
+        return true;
+    }
+
+    bool SModelRenderPassModule::buildMeshletData(const ModelAsset &model, VkCommandBuffer cmd)
+    {
+        m_meshletDataVersion = m_drawListVersion;
+        m_meshletRecordCount = 0;
+
+        uint32_t count = 0;
+        for (const DrawGroup &g : m_drawGroups)
+            count += g.meshletCount;
+        if (count == 0)
+            return true; // nothing in this draw list is drawn by meshlet
+
+        // Records in draw order (so each group's meshlets are contiguous), then the model's
+        // vertex table and its triangle bytes packed four to a word.
+        const uint32_t vertexBase = count * MESHLET_RECORD_WORDS;
+        const uint32_t triangleBase = vertexBase + static_cast<uint32_t>(model.meshletVertices.size());
+        auto &words = m_meshletWords;
+        words.assign(triangleBase + (model.meshletTriangles.size() + 3u) / 4u, 0u);
+
+        uint32_t record = 0;
+        for (uint32_t gi = 0; gi < static_cast<uint32_t>(m_drawGroups.size()); ++gi)
+        {
+            const DrawGroup &g = m_drawGroups[gi];
+            for (uint32_t k = 0; k < g.drawCount && g.meshletCount > 0; ++k)
+            {
+                const uint32_t drawIndex = g.firstDraw + k;
+                const StaticDraw &d = m_draws[drawIndex];
+                for (uint32_t j = 0; j < d.meshletCount; ++j, ++record)
+                {
+                    const ModelMeshlet &m = model.meshlets[d.firstMeshlet + j];
+                    uint32_t *r = &words[static_cast<size_t>(record) * MESHLET_RECORD_WORDS];
+                    std::memcpy(&r[0], m.center, sizeof(m.center));
+                    std::memcpy(&r[3], &m.radius, sizeof(float));
+                    std::memcpy(&r[4], m.coneAxis, sizeof(m.coneAxis));
+                    std::memcpy(&r[7], &m.coneCutoff, sizeof(float));
+                    r[8] = d.firstIndex + m.firstIndex;
+                    r[9] = m.triangleCount | (m.vertexCount << 16);
+                    r[10] = vertexBase + m.vertexOffset;
+                    r[11] = triangleBase * 4u + m.triangleOffset;
+                    r[12] = drawIndex;
+                    r[13] = gi;
+                    r[14] = g.firstMeshlet;
+                    // Skinned draws ignore their node: bounds follow the anchor joint's palette matrix.
+                    r[15] = ~0u;
+                    if (d.skinJointCount > 0u)
+                        r[15] = d.skinBaseJoint + std::min<uint32_t>(static_cast<uint32_t>(std::max(m.anchorJoint, 0)), d.skinJointCount - 1u);
+                }
+            }
+        }
+        std::memcpy(words.data() + vertexBase, model.meshletVertices.data(), sizeof(uint32_t) * model.meshletVertices.size());
+        std::memcpy(words.data() + triangleBase, model.meshletTriangles.data(), model.meshletTriangles.size());
+
+        const VkDeviceSize bytes = static_cast<VkDeviceSize>(words.size()) * sizeof(uint32_t);
+
+        VkBuffer staging = VK_NULL_HANDLE;
+        GpuAllocation stagingMemory;
+        if (CreateBuffer(m_device, m_physicalDevice, bytes, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, staging, stagingMemory) != VK_SUCCESS ||
+            !stagingMemory.mapped)
+        {
+            DestroyBuffer(m_device, staging, stagingMemory);
+            return false;
+        }
+        std::memcpy(stagingMemory.mapped, words.data(), static_cast<size_t>(bytes));
+        words.clear();
+
+        // The previous draw list's records may still be read by frames in flight.
+        retireBuffer(m_meshletDataBuffer, m_meshletDataMemory);
+        if (CreateDeviceLocalBuffer(m_device, m_physicalDevice, bytes,
+                                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                    m_meshletDataBuffer, m_meshletDataMemory) != VK_SUCCESS)
+        {
+            DestroyBuffer(m_device, staging, stagingMemory);
+            return false;
+        }
+
+        const VkBufferCopy region{0, 0, bytes};
+        vkCmdCopyBuffer(cmd, staging, m_meshletDataBuffer, 1, &region);
+        retireBuffer(staging, stagingMemory);
+
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, slotReadStages(), 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+        m_meshletRecordCount = count;
+        return true;
+    }
+
+    bool SModelRenderPassModule::prepareMeshlets(CameraFrame &frame, VkCommandBuffer cmd)
+    {
+        if (!m_meshletCulling || (!m_meshShaderReady && !m_meshletComputeReady) || m_meshletDataFailed)
+            return false;
+        if (!m_camera || !m_assets || !m_model.isValid() || frame.meshletSet == VK_NULL_HANDLE)
+            return false;
+        if (m_extent.width == 0 || m_extent.height == 0)
+            return false;
+
+        ModelAsset *model = m_assets->getModel(m_model);
+        if (!model || model->primitives.empty() || !model->hasMeshlets())
+            return false;
+
+        if (m_drawListModel != model || m_drawListPrimitiveCount != model->primitives.size())
+            rebuildDrawList(*model);
+        if (m_draws.empty() || !m_drawsShareBuffers)
+            return false;
+
+        if (m_meshletDataVersion != m_drawListVersion && !buildMeshletData(*model, cmd))
+        {
+            // Out of memory: whole meshes from now on.
+            m_meshletDataFailed = true;
+            return false;
+        }
+        if (m_meshletRecordCount == 0)
+            return false;
+
+        if (!ensureDrawDataCapacity(frame, static_cast<uint32_t>(m_draws.size())))
+            return false;
+
+        // Compute path: a command slot for every meshlet of every candidate.
+        if (m_meshletComputeReady && !m_meshShaderReady && m_gpuCulling)
+        {
+            const uint64_t commands = static_cast<uint64_t>(m_meshletRecordCount) * m_activeSlots.size();
+            if (commands <= MESHLET_MAX_COMMANDS &&
+                !ensureMeshletCommandCapacity(frame, static_cast<uint32_t>(commands), static_cast<uint32_t>(m_drawGroups.size())))
+                return false;
+        }
+
+        MeshletCullUBO ubo{};
+        std::memcpy(ubo.model, m_pc.model, sizeof(ubo.model));
+        m_camera->SetAspect(static_cast<float>(m_extent.width) / static_cast<float>(m_extent.height));
+        const Frustum frustum = Frustum::fromViewProjection(m_camera->GetProjectionMatrix() * m_camera->GetViewMatrix());
+        for (int i = 0; i < 6; ++i)
+        {
+            const FrustumPlane &pl = frustum.plane(i);
+            ubo.planes[i][0] = pl.normal.x;
+            ubo.planes[i][1] = pl.normal.y;
+            ubo.planes[i][2] = pl.normal.z;
+            ubo.planes[i][3] = pl.distance;
+        }
+        const glm::vec3 &eye = m_camera->GetPosition();
+        ubo.cameraPos[0] = eye.x;
+        ubo.cameraPos[1] = eye.y;
+        ubo.cameraPos[2] = eye.z;
+        ubo.skinned[0] = MESHLET_SKINNED_RADIUS_SCALE;
+        ubo.skinned[1] = MESHLET_SKINNED_CONE_MARGIN;
+        std::memcpy(frame.meshletCullMapped, &ubo, sizeof(ubo));
+
+        // (Re)point the meshlet set at the current buffers.
+        const VkBuffer buffers[6] = {m_meshletDataBuffer, m_draws[0].vertexBuffer, frame.counterBuffer,
+                                     frame.meshletCullBuffer, frame.meshletCommandBuffer, frame.groupCountBuffer};
+        if (!std::equal(std::begin(buffers), std::end(buffers), std::begin(frame.meshletSetBuffers)))
+        {
+            VkDescriptorBufferInfo infos[6]{};
+            VkWriteDescriptorSet writes[6]{};
+            for (uint32_t i = 0; i < 6u; ++i)
+            {
+                infos[i].buffer = buffers[i];
+                infos[i].offset = 0;
+                infos[i].range = VK_WHOLE_SIZE;
+
+                writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                writes[i].dstSet = frame.meshletSet;
+                writes[i].dstBinding = i;
+                writes[i].dstArrayElement = 0;
+                writes[i].descriptorType = i == 3u ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                writes[i].descriptorCount = 1;
+                writes[i].pBufferInfo = &infos[i];
+                frame.meshletSetBuffers[i] = buffers[i];
+            }
+            vkUpdateDescriptorSets(m_device, 6, writes, 0, nullptr);
+        }
+
+        frame.meshletsPrepared = true;
+        return true;
+    }
+
+    void SModelRenderPassModule::dispatchMeshletCull(CameraFrame &frame, VkCommandBuffer cmd, uint32_t candidateCount)
+    {
+        frame.meshletCommands = false;
+        if (!frame.meshletsPrepared || !m_meshletComputeReady || m_meshShaderReady)
+            return;
+
+        const uint32_t groupCount = static_cast<uint32_t>(m_drawGroups.size());
+        const uint64_t commands = static_cast<uint64_t>(m_meshletRecordCount) * candidateCount;
+        if (candidateCount > m_maxComputeWorkGroupCountY || commands > MESHLET_MAX_COMMANDS ||
+            commands > frame.meshletCommandCapacity || groupCount > frame.groupCountCapacity)
+            return;
+
+        vkCmdFillBuffer(cmd, frame.groupCountBuffer, 0, sizeof(uint32_t) * groupCount, 0u);
+
+        // Group counts cleared, visible slots + counter from the slot cull.
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+        const VkDescriptorSet sets[2] = {frame.set, frame.meshletSet};
+        const uint32_t info[4] = {m_meshletRecordCount, candidateCount,
+                                  std::max<uint32_t>(m_slotNodeCount, 1u), std::max<uint32_t>(m_slotJointCount, 1u)};
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_meshletCullPipeline);
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_meshletCullPipelineLayout, 0, 2, sets, 1, &frame.cameraOffset);
+        vkCmdPushConstants(cmd, m_meshletCullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(info), info);
+        vkCmdDispatch(cmd, (m_meshletRecordCount + 63u) / 64u, candidateCount, 1);
+
+        frame.meshletCommands = true;
+    }
+
+    bool SModelRenderPassModule::meshTasksFit(const DrawGroup &g, uint32_t instanceCount) const
+    {
+        const uint32_t x = (g.meshletCount + MESHLET_TASK_GROUP - 1u) / MESHLET_TASK_GROUP;
+        return x <= m_maxTaskWorkGroupCount[0] && instanceCount <= m_maxTaskWorkGroupCount[1] &&
+               static_cast<uint64_t>(x) * instanceCount <= m_maxTaskWorkGroupTotal;
+    }
+
+    void SModelRenderPassModule::createPipelines(VulkanContext &ctx, VkRenderPass pass)
+    {
+        if (m_cameraSetLayout == VK_NULL_HANDLE)
+        {
+            throw std::runtime_error("SModelRenderPassModule: camera descriptor set layout not created");
+        }
+        const VkDescriptorSetLayout materialLayout = m_bindless ? m_bindless->layout() : m_materialSetLayout;
+        if (materialLayout == VK_NULL_HANDLE)
+        {
+            throw std::runtime_error("SModelRenderPassModule: material descriptor set layout not created");
+        }
+
+        // Shadow receiver set (Renderer::shadows()), bound at set 2 on every colour draw.
+        if (m_receiverSetLayout == VK_NULL_HANDLE &&
+            ShadowCascades::createReceiverSetLayout(ctx.GetDevice(), m_receiverSetLayout) != VK_SUCCESS)
+        {
+            throw std::runtime_error("SModelRenderPassModule: failed to create shadow receiver set layout");
+        }
+
+        // Shared pipeline layout: camera set, material set, shadow receiver set + push constants.
+        VkPushConstantRange pcRange{};
+        pcRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+        pcRange.offset = 0;
+        pcRange.size = sizeof(PushConstantsModel);
+
+        VkPipelineLayoutCreateInfo plInfo{};
+        plInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        VkDescriptorSetLayout setLayouts[3] = {m_cameraSetLayout, materialLayout, m_receiverSetLayout};
+        plInfo.setLayoutCount = 3;
+        plInfo.pSetLayouts = setLayouts;
+        plInfo.pushConstantRangeCount = 1;
+        plInfo.pPushConstantRanges = &pcRange;
+
+        if (vkCreatePipelineLayout(ctx.GetDevice(), &plInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS)
+        {
+            throw std::runtime_error("SModelRenderPassModule: failed to create pipeline layout");
+        }
+
+        // Common pipeline create info
+        PipelineCreateInfo pci{};
+        pci.device = ctx.GetDevice();
+        pci.pipelineCache = ctx.GetPipelineCache();
+        pci.renderPass = pass;
+        pci.subpass = 0;
+        pci.pipelineLayout = m_pipelineLayout;
+
+        // Load shader modules
+        VkShaderModule vert = Pipeline::createShaderModuleFromFile(pci.device, "shaders/smodel.vert.spv");
+        VkShaderModule frag = Pipeline::createShaderModuleFromFile(pci.device, m_bindless ? "shaders/smodel_bindless.frag.spv" : "shaders/smodel.frag.spv");
+        if (vert == VK_NULL_HANDLE || frag == VK_NULL_HANDLE)
+        {
+            throw std::runtime_error("SModelRenderPassModule: failed to load shader modules (smodel.vert/frag.spv)");
+        }
+
+        VkPipelineShaderStageCreateInfo vs{};
+        vs.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        vs.stage = VK_SHADER_STAGE_VERTEX_BIT;
+        vs.module = vert;
+        vs.pName = "main";
+
+        VkPipelineShaderStageCreateInfo fs{};
+        fs.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        fs.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+        fs.module = frag;
+        fs.pName = "main";
+
+        pci.shaderStages = {vs, fs};
+
+        // Vertex input:
+        //  binding 0: SModelPackedVertex (36 bytes; AssetManager packs VertexPNTTJW at load)
+        // Instance data comes from SSBOs via slot indirection (no instanced vertex attributes).
+        std::array<VkVertexInputBindingDescription, 1> bindingDescs{};
+        bindingDescs[0].binding = 0;
+        bindingDescs[0].stride = smodel::SMODEL_PACKED_VERTEX_STRIDE;
+        bindingDescs[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+        std::array<VkVertexInputAttributeDescription, 6> attrs{};
+        attrs[0] = {0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0};   // pos
+        attrs[1] = {1, 0, VK_FORMAT_R16G16_SNORM, 12};      // normal (octahedral)
+        attrs[2] = {2, 0, VK_FORMAT_R16G16_SFLOAT, 16};     // uv0 (half)
+        attrs[3] = {3, 0, VK_FORMAT_R8G8B8A8_SNORM, 20};    // tangent
+
+        // Skinning inputs
+        attrs[4] = {8, 0, VK_FORMAT_R16G16B16A16_UINT, 24}; // joints (u16x4)
+        attrs[5] = {9, 0, VK_FORMAT_R8G8B8A8_UNORM, 32};    // weights (unorm8x4)
+
+        VkPipelineVertexInputStateCreateInfo vi{};
+        vi.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+        vi.vertexBindingDescriptionCount = static_cast<uint32_t>(bindingDescs.size());
+        vi.pVertexBindingDescriptions = bindingDescs.data();
+        vi.vertexAttributeDescriptionCount = static_cast<uint32_t>(attrs.size());
+        vi.pVertexAttributeDescriptions = attrs.data();
+        pci.vertexInput = vi;
+        pci.vertexInputProvided = true;
+
+        // Input assembly: triangle list
+        VkPipelineInputAssemblyStateCreateInfo ia{};
+        ia.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+        ia.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+        ia.primitiveRestartEnable = VK_FALSE;
+        pci.inputAssembly = ia;
+        pci.inputAssemblyProvided = true;
+
+        // Rasterization: no cull (safe for now; honors doubleSided by default)
+        VkPipelineRasterizationStateCreateInfo rs{};
+        rs.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+        rs.depthClampEnable = VK_FALSE;
+        rs.rasterizerDiscardEnable = VK_FALSE;
+        rs.polygonMode = VK_POLYGON_MODE_FILL;
+        rs.lineWidth = 1.0f;
+        rs.cullMode = VK_CULL_MODE_NONE;
+        rs.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+        rs.depthBiasEnable = VK_FALSE;
+        pci.rasterization = rs;
+        pci.rasterizationProvided = true;
+
+        // Dynamic viewport/scissor
+        pci.dynamicStates = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+
+        // Depth/stencil (main render pass has a depth attachment)
+        VkPipelineDepthStencilStateCreateInfo ds{};
+        ds.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+        ds.depthTestEnable = VK_TRUE;
+        ds.depthWriteEnable = VK_TRUE;
+        // LESS_OR_EQUAL: opaque/masked surfaces pass on the depth the prepass wrote for them.
+        ds.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+        ds.depthBoundsTestEnable = VK_FALSE;
+        ds.stencilTestEnable = VK_FALSE;
+        pci.depthStencil = ds;
+        pci.depthStencilProvided = true;
+
+        // Permutations (warm-up): every pass x skinned/rigid x base texture or not, colour and
+        // depth prepass, direct and indirect. The alpha mode, skinning and texture branches of the
+        // shaders fold away per pipeline (specialization constants, see smodel.frag / smodel.vert).
+        VkPipelineColorBlendAttachmentState attOpaque{};
+        const VkPipelineColorBlendStateCreateInfo cbOpaque = makeBlendState(false, attOpaque);
+        VkPipelineColorBlendAttachmentState attBlend{};
+        const VkPipelineColorBlendStateCreateInfo cbBlend = makeBlendState(true, attBlend);
+        // Depth prepass: depth writes on, colour writes off. Opaque needs no fragment stage.
+        VkPipelineColorBlendAttachmentState attDepth{};
+        VkPipelineColorBlendStateCreateInfo cbDepth = makeBlendState(false, attDepth);
+        attDepth.colorWriteMask = 0;
+
+        PipelineSpecialization vertSpec;
+        PipelineSpecialization fragSpec;
+        // taskModule set: vertModule is the mesh stage of the meshlet variants (one task stage ahead).
+        auto createPermutations = [&](VkShaderModule vertModule, bool indirect, VkShaderModule taskModule) -> bool
+        {
+            bool ok = true;
+            const bool meshTasks = taskModule != VK_NULL_HANDLE;
+            VkPipelineShaderStageCreateInfo vsPerm = vs;
+            VkPipelineShaderStageCreateInfo fsPerm = fs;
+            VkPipelineShaderStageCreateInfo tsPerm = vs;
+            vsPerm.module = vertModule;
+            if (meshTasks)
+            {
+                vsPerm.stage = VK_SHADER_STAGE_MESH_BIT_EXT;
+                tsPerm.stage = VK_SHADER_STAGE_TASK_BIT_EXT;
+                tsPerm.module = taskModule;
+            }
+            for (uint32_t skinned = 0; skinned < 2u; ++skinned)
+            {
+                vertSpec.set(SPEC_SKINNED, skinned);
+                vertSpec.apply(vsPerm);
+                for (uint32_t textured = 0; textured < 2u; ++textured)
+                {
+                    fragSpec.setBool(SPEC_BASE_TEXTURE, textured != 0u);
+                    for (uint32_t alphaPass = 0; alphaPass < 3u; ++alphaPass)
+                    {
+                        fragSpec.set(SPEC_ALPHA_MODE, alphaPass);
+                        fragSpec.apply(fsPerm);
+                        if (meshTasks)
+                            pci.shaderStages = {tsPerm, vsPerm, fsPerm};
+                        else
+                            pci.shaderStages = {vsPerm, fsPerm};
+
+                        // Colour: LESS_OR_EQUAL so opaque/masked surfaces pass on the prepass depth;
+                        // transparent tests depth but does not write it.
+                        pci.colorBlend = alphaPass == 2u ? cbBlend : cbOpaque;
+                        pci.depthStencil.depthWriteEnable = alphaPass == 2u ? VK_FALSE : VK_TRUE;
+                        pci.depthStencil.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+                        ok &= m_permutations.create(permutationKey(false, alphaPass, skinned != 0u, textured != 0u, indirect, meshTasks), pci) == VK_SUCCESS;
+
+                        if (alphaPass == 2u || (alphaPass == 0u && textured != 0u))
+                            continue; // no blend prepass; opaque's has no fragment stage to specialize
+                        pci.colorBlend = cbDepth;
+                        pci.depthStencil.depthWriteEnable = VK_TRUE;
+                        pci.depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+                        if (alphaPass == 0u)
+                        {
+                            if (meshTasks)
+                                pci.shaderStages = {tsPerm, vsPerm};
+                            else
+                                pci.shaderStages = {vsPerm};
+                        }
+                        ok &= m_permutations.create(permutationKey(true, alphaPass, skinned != 0u, textured != 0u, indirect, meshTasks), pci) == VK_SUCCESS;
+                    }
+                }
+            }
+            return ok;
+        };
+
+        m_permutations.destroy(pci.device);
+        const bool directOk = createPermutations(vert, false, VK_NULL_HANDLE);
+
+        // Indirect variants: same state, vertex shader reads per-draw data (binding 5).
+        // firstInstance must be honored by indirect commands (drawIndirectFirstInstance); VulkanContext
+        // enables it whenever the device supports it. Missing shader/feature -> direct path only.
+        m_indirectReady = false;
+        m_multiDrawIndirect = false;
+        {
+            VkPhysicalDeviceFeatures supported{};
+            vkGetPhysicalDeviceFeatures(ctx.GetPhysicalDevice(), &supported);
+
+            VkShaderModule vertIndirect = VK_NULL_HANDLE;
+            if (supported.drawIndirectFirstInstance)
+            {
+                try
+                {
+                    vertIndirect = Pipeline::createShaderModuleFromFile(pci.device, "shaders/smodel_indirect.vert.spv");
+                }
+                catch (const std::exception &)
+                {
+                    vertIndirect = VK_NULL_HANDLE;
+                }
+            }
+
+            if (vertIndirect != VK_NULL_HANDLE)
+            {
+                m_indirectReady = createPermutations(vertIndirect, true, VK_NULL_HANDLE);
+                m_multiDrawIndirect = m_indirectReady && supported.multiDrawIndirect;
+                vkDestroyShaderModule(pci.device, vertIndirect, nullptr);
+            }
+        }
+
+        // Meshlet variants (smodel_meshlet.task/.mesh, no vertex input): groups drawn by meshlet
+        // in recordIndirect(). Own layout: the meshlet set is set 3 (after the receiver set) and
+        // the task/mesh stages read the push constants.
+        m_meshShaderReady = false;
+        if (m_indirectReady && m_cmdDrawMeshTasks && m_meshletSetLayout != VK_NULL_HANDLE)
+        {
+            VkShaderModule task = VK_NULL_HANDLE;
+            VkShaderModule mesh = VK_NULL_HANDLE;
+            try
+            {
+                task = Pipeline::createShaderModuleFromFile(pci.device, "shaders/smodel_meshlet.task.spv");
+                mesh = Pipeline::createShaderModuleFromFile(pci.device, "shaders/smodel_meshlet.mesh.spv");
+            }
+            catch (const std::exception &)
+            {
+                // Not built: those groups draw whole meshes.
+            }
+
+            if (task != VK_NULL_HANDLE && mesh != VK_NULL_HANDLE)
+            {
+                VkPushConstantRange meshRange{};
+                meshRange.stageFlags = MESH_PUSH_STAGES;
+                meshRange.offset = 0;
+                meshRange.size = sizeof(PushConstantsModel);
+
+                VkDescriptorSetLayout meshSetLayouts[4] = {m_cameraSetLayout, materialLayout, m_receiverSetLayout, m_meshletSetLayout};
+                plInfo.setLayoutCount = 4;
+                plInfo.pSetLayouts = meshSetLayouts;
+                plInfo.pPushConstantRanges = &meshRange;
+                if (vkCreatePipelineLayout(pci.device, &plInfo, nullptr, &m_meshPipelineLayout) == VK_SUCCESS)
+                {
+                    pci.pipelineLayout = m_meshPipelineLayout;
+                    m_meshShaderReady = createPermutations(mesh, true, task);
+                    pci.pipelineLayout = m_pipelineLayout;
+                }
+            }
+            if (task != VK_NULL_HANDLE)
+                vkDestroyShaderModule(pci.device, task, nullptr);
+            if (mesh != VK_NULL_HANDLE)
+                vkDestroyShaderModule(pci.device, mesh, nullptr);
+        }
+
+        // Cleanup shader modules
+        vkDestroyShaderModule(pci.device, vert, nullptr);
+        vkDestroyShaderModule(pci.device, frag, nullptr);
+
+        if (!directOk)
+        {
+            throw std::runtime_error("SModelRenderPassModule: failed to create one or more pipelines");
+        }
+    }
+
+    void SModelRenderPassModule::record(FrameContext &frameCtx, VkCommandBuffer cmd)
+    {
+        for (uint32_t phase = 0; phase < RENDER_PHASE_COUNT; ++phase)
+            recordPhase(frameCtx, cmd, static_cast<RenderPhase>(phase));
+    }
+
+    void SModelRenderPassModule::recordPhase(FrameContext &frameCtx, VkCommandBuffer cmd, RenderPhase phase)
+    {
+        // The renderer starts every frame with the DepthPrepass call, on this pass's thread.
+        if (phase == RenderPhase::DepthPrepass)
+            m_phaseFrame.ready = prepareFrame(frameCtx);
+        if (!m_phaseFrame.ready)
+            return;
+        if (phase == RenderPhase::DepthPrepass && !frameCtx.depthPrepass)
+            return;
+
+        // Render extent, not m_extent: below it with resolution scaling.
+        const VkExtent2D ext = frameCtx.renderExtent;
+        VkViewport vp{0.0f, 0.0f, static_cast<float>(ext.width), static_cast<float>(ext.height), 0.0f, 1.0f};
+        VkRect2D sc{{0, 0}, ext};
+        vkCmdSetViewport(cmd, 0, 1, &vp);
+        vkCmdSetScissor(cmd, 0, 1, &sc);
+
+        const PhaseFrame &pf = m_phaseFrame;
+        if (pf.indirect)
+            recordIndirect(*pf.camFrame, cmd, pf.instances, pf.gpuCounts, phase);
+        else
+            recordDirect(pf.camFrame, cmd, pf.instances, phase);
+    }
+
+    bool SModelRenderPassModule::bindCameraBlock(CameraFrame &frame, const FrameContext &frameCtx)
+    {
+        if (!frameCtx.uploads || !frameCtx.uploads->valid() || frame.set == VK_NULL_HANDLE)
+            return false;
+
+        frame.cameraOffset = frameCtx.cameraOffset;
+        const VkBuffer ring = frameCtx.uploads->buffer();
+        if (frame.cameraRingBuffer == ring)
+            return true;
+
+        VkDescriptorBufferInfo info{};
+        info.buffer = ring;
+        info.offset = 0;
+        info.range = sizeof(CameraUBO);
+
+        VkWriteDescriptorSet write{};
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = frame.set;
+        write.dstBinding = 0;
+        write.dstArrayElement = 0;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+        write.descriptorCount = 1;
+        write.pBufferInfo = &info;
+        vkUpdateDescriptorSets(m_device, 1, &write, 0, nullptr);
+        frame.cameraRingBuffer = ring;
+        return true;
+    }
+
+    bool SModelRenderPassModule::prepareFrame(FrameContext &frameCtx)
+    {
+        m_phaseFrame = PhaseFrame{};
+        m_phaseFrame.receiverSet = frameCtx.shadow ? frameCtx.shadow->receiverSet : VK_NULL_HANDLE;
+        if (!m_enabled)
+            return false;
+        if (!m_assets || !m_model.isValid())
+            return false;
+        if (m_extent.width == 0 || m_extent.height == 0)
+            return false;
+
+        ModelAsset *model = m_assets->getModel(m_model);
+        if (!model || model->primitives.empty())
+            return false;
+
+        // The camera UBO is the renderer's CameraBlock (latched); culling below uses the camera as of now.
+        if (m_camera)
+            m_camera->SetAspect(static_cast<float>(m_extent.width) / static_cast<float>(m_extent.height));
+
+        const uint32_t instanceCount = static_cast<uint32_t>(m_activeSlots.size());
+        if (instanceCount == 0)
+            return false;
+
+        const uint32_t slotCapacity = static_cast<uint32_t>(m_slotWorlds.size());
+        if (slotCapacity == 0)
+            return false;
+
+        // Flatten node graph -> static draw list (once per model)
+        if (m_drawListModel != model || m_drawListPrimitiveCount != model->primitives.size())
+            rebuildDrawList(*model);
+        if (m_draws.empty())
+            return false;
+
+        const uint32_t camIndex = (!m_cameraFrames.empty()) ? (frameCtx.frameIndex % static_cast<uint32_t>(m_cameraFrames.size())) : 0;
+        CameraFrame *camFrame = (!m_cameraFrames.empty()) ? &m_cameraFrames[camIndex] : nullptr;
+        if (!camFrame || !bindCameraBlock(*camFrame, frameCtx))
+            return false;
+
+        // Culled on the GPU in recordPrePass(): slot data is uploaded and instance counts are
+        // written by the cull shader.
+        if (camFrame && camFrame->gpuCulled)
+        {
+            camFrame->gpuCulled = false;
+            m_phaseFrame.camFrame = camFrame;
+            m_phaseFrame.instances = instanceCount;
+            m_phaseFrame.gpuCounts = true;
+            m_phaseFrame.indirect = true;
+            return true;
+        }
+
+        uint32_t drawInstances = instanceCount;
+        if (camFrame)
+        {
+            if (m_gpuCulling)
+            {
+                // GPU culling requested but unavailable: cull the candidates here instead.
+                drawInstances = cullCandidatesOnCpu();
+                if (drawInstances == 0)
+                    return false;
+                if (!ensureActiveSlotsCapacity(*camFrame, drawInstances))
+                    return false;
+                if (!camFrame->residentUploaded && !uploadSlotData(*camFrame, m_cpuCulledSlots.data(), drawInstances))
+                    return false;
+
+                std::memcpy(camFrame->activeSlotsMapped, m_cpuCulledSlots.data(), sizeof(uint32_t) * drawInstances);
+                camFrame->lastUploadedActiveSlotsVersion = 0;
+            }
+            else
+            {
+                if (!ensureActiveSlotsCapacity(*camFrame, instanceCount))
+                    return false;
+                if (!camFrame->residentUploaded && !uploadSlotData(*camFrame, m_activeSlots.data(), instanceCount))
+                    return false;
+
+                // Upload active slot indirection for this frame.
+                if (camFrame->activeSlotsMapped && camFrame->lastUploadedActiveSlotsVersion != m_activeSlotsVersion)
+                {
+                    std::memcpy(camFrame->activeSlotsMapped, m_activeSlots.data(), sizeof(uint32_t) * instanceCount);
+                    camFrame->lastUploadedActiveSlotsVersion = m_activeSlotsVersion;
+                }
+            }
+        }
+
+        m_phaseFrame.camFrame = camFrame;
+        m_phaseFrame.instances = drawInstances;
+        m_phaseFrame.indirect = m_indirectReady && m_drawsShareBuffers && camFrame && camFrame->set != VK_NULL_HANDLE;
+        return true;
+    }
+
+    const Pipeline *SModelRenderPassModule::phasePipeline(RenderPhase phase, const DrawGroup &g, bool indirect, bool meshTasks) const
+    {
+        switch (phase)
+        {
+        case RenderPhase::DepthPrepass:
+            if (g.pass > 1u)
+                return nullptr;
+            // The opaque prepass has no fragment stage: one permutation for both texture states.
+            return m_permutations.find(permutationKey(true, g.pass, g.skinned, g.pass == 1u && g.textured, indirect, meshTasks));
+        case RenderPhase::Opaque:
+        case RenderPhase::Mask:
+        case RenderPhase::Blend:
+        {
+            const uint32_t phasePass = phase == RenderPhase::Opaque ? 0u : (phase == RenderPhase::Mask ? 1u : 2u);
+            if (g.pass != phasePass)
+                return nullptr;
+            return m_permutations.find(permutationKey(false, g.pass, g.skinned, g.textured, indirect, meshTasks));
+        }
+        default:
+            return nullptr;
+        }
+    }
+
+    bool SModelRenderPassModule::uploadSlotData(CameraFrame &frame, const uint32_t *slots, uint32_t count)
+    {
+        const uint32_t slotCapacity = static_cast<uint32_t>(m_slotWorlds.size());
+        const uint32_t nodeCount = std::max<uint32_t>(m_slotNodeCount, 1u);
+        const uint32_t jointStride = std::max<uint32_t>(m_slotJointCount, 1u);
+
+        // Mostly empty after trimSlotCapacity(): this frame's fence signaled, so its copies can be
+        // recreated smaller right away (the ensure calls destroy the old buffers).
+        if (slotStorageOversized(frame.instanceWorldCapacitySlots, slotCapacity))
+        {
+            const uint32_t keep = slotShrinkTarget(slotCapacity);
+            frame.instanceWorldCapacitySlots = 0;
+            frame.paletteCapacityMatrices = 0;
+            frame.jointPaletteCapacityMatrices = 0;
+            if (!ensureInstanceWorldCapacity(frame, keep) || !ensurePaletteCapacity(frame, keep * nodeCount) ||
+                !ensureJointPaletteCapacity(frame, keep * jointStride))
+                return false;
+        }
+
+        if (!ensureInstanceWorldCapacity(frame, slotCapacity))
+            return false;
+        if (!ensurePaletteCapacity(frame, slotCapacity * nodeCount))
+            return false;
+        if (!ensureJointPaletteCapacity(frame, slotCapacity * jointStride))
+            return false;
+        if (m_gpuCulling && !ensureCullCapacity(frame, slotCapacity, 0u))
+            return false;
+
+        bindSlotBuffers(frame, false);
+
+        frame.uploadedTransformEpoch.resize(slotCapacity, 0u);
+        frame.uploadedPoseEpoch.resize(slotCapacity, 0u);
+
+        // Incremental per-slot uploads for the given slots.
+        const auto *worldSrc = m_slotWorlds.data();
+        const auto *nodeSrc = m_nodePalette.data();
+        const auto *jointSrc = m_jointPalette.data();
+
+        auto *worldDstBytes = static_cast<uint8_t *>(frame.instanceWorldMapped);
+        auto *nodeDstBytes = static_cast<uint8_t *>(frame.paletteMapped);
+        auto *jointDstBytes = static_cast<uint8_t *>(frame.jointPaletteMapped);
+        auto *boundsDst = m_gpuCulling ? static_cast<glm::vec4 *>(frame.boundsMapped) : nullptr;
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const uint32_t slot = slots[i];
+            if (slot >= slotCapacity)
+                continue;
+
+            if (worldDstBytes && frame.uploadedTransformEpoch[slot] != m_slotTransformEpoch[slot])
+            {
+                std::memcpy(worldDstBytes + static_cast<size_t>(slot) * sizeof(glm::mat4),
+                            &worldSrc[slot],
+                            sizeof(glm::mat4));
+                if (boundsDst)
+                    boundsDst[slot] = m_slotBounds[slot];
+                frame.uploadedTransformEpoch[slot] = m_slotTransformEpoch[slot];
+            }
+
+            if (frame.uploadedPoseEpoch[slot] != m_slotPoseEpoch[slot])
+            {
+                if (nodeDstBytes)
+                {
+                    const size_t nodeBase = static_cast<size_t>(slot) * static_cast<size_t>(nodeCount);
+                    std::memcpy(nodeDstBytes + nodeBase * sizeof(glm::mat4),
+                                nodeSrc + nodeBase,
+                                sizeof(glm::mat4) * nodeCount);
+                }
+
+                if (jointDstBytes)
+                {
+                    const size_t jointBase = static_cast<size_t>(slot) * static_cast<size_t>(jointStride);
+                    std::memcpy(jointDstBytes + jointBase * sizeof(glm::mat4),
+                                jointSrc + jointBase,
+                                sizeof(glm::mat4) * jointStride);
+                }
+
+                frame.uploadedPoseEpoch[slot] = m_slotPoseEpoch[slot];
+            }
+        }
+        return true;
+    }
+
+    void SModelRenderPassModule::setResidentSlotData(bool enable)
+    {
+        if (enable == m_residentSlotData)
+            return;
+        m_residentSlotData = enable;
+        // Resident contents went stale while per-frame copies were in use.
+        std::fill(m_resident.uploadedTransformEpoch.begin(), m_resident.uploadedTransformEpoch.end(), 0u);
+        std::fill(m_resident.uploadedPoseEpoch.begin(), m_resident.uploadedPoseEpoch.end(), 0u);
+    }
+
+    bool SModelRenderPassModule::ensureResidentBuffer(VkBuffer &buffer, GpuAllocation &memory, uint32_t &capacity,
+                                                      uint32_t needed, VkDeviceSize elementSize)
+    {
+        if (needed <= capacity)
+            return true;
+
+        uint32_t newCap = std::max<uint32_t>(1u, capacity);
+        while (newCap < needed)
+            newCap *= 2u;
+
+        retireBuffer(buffer, memory);
+        capacity = 0;
+
+        if (CreateDeviceLocalBuffer(m_device, m_physicalDevice, static_cast<VkDeviceSize>(newCap) * elementSize,
+                                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, buffer, memory,
+                                    m_queueFamilyCount, m_queueFamilies) != VK_SUCCESS)
+            return false;
+
+        capacity = newCap;
+        m_resident.generation += 1u;
+        // New buffer starts empty: every slot uploads again.
+        std::fill(m_resident.uploadedTransformEpoch.begin(), m_resident.uploadedTransformEpoch.end(), 0u);
+        std::fill(m_resident.uploadedPoseEpoch.begin(), m_resident.uploadedPoseEpoch.end(), 0u);
+        return true;
+    }
+
+    bool SModelRenderPassModule::ensureResidentCapacity(uint32_t slotCapacity)
+    {
+        if (m_device == VK_NULL_HANDLE || m_physicalDevice == VK_NULL_HANDLE)
+            return false;
+
+        const uint32_t nodeCount = std::max<uint32_t>(m_slotNodeCount, 1u);
+        const uint32_t jointStride = std::max<uint32_t>(m_slotJointCount, 1u);
+        ResidentSlotData &r = m_resident;
+        return ensureResidentBuffer(r.worldBuffer, r.worldMemory, r.worldCapacitySlots, slotCapacity, sizeof(glm::mat4)) &&
+               ensureResidentBuffer(r.boundsBuffer, r.boundsMemory, r.boundsCapacitySlots, slotCapacity, sizeof(glm::vec4)) &&
+               ensureResidentBuffer(r.paletteBuffer, r.paletteMemory, r.paletteCapacityMatrices, slotCapacity * nodeCount, sizeof(glm::mat4)) &&
+               ensureResidentBuffer(r.jointPaletteBuffer, r.jointPaletteMemory, r.jointPaletteCapacityMatrices, slotCapacity * jointStride, sizeof(glm::mat4));
+    }
+
+    bool SModelRenderPassModule::shrinkResidentCapacity(uint32_t slotCount)
+    {
+        ResidentSlotData &r = m_resident;
+        if (!slotStorageOversized(r.worldCapacitySlots, slotCount))
+            return true;
+
+        // Frames in flight may still read the old buffers: retire them and start over at the
+        // next power of two; every slot uploads again into the new ones.
+        retireBuffer(r.worldBuffer, r.worldMemory);
+        retireBuffer(r.boundsBuffer, r.boundsMemory);
+        retireBuffer(r.paletteBuffer, r.paletteMemory);
+        retireBuffer(r.jointPaletteBuffer, r.jointPaletteMemory);
+        r.worldCapacitySlots = 0;
+        r.boundsCapacitySlots = 0;
+        r.paletteCapacityMatrices = 0;
+        r.jointPaletteCapacityMatrices = 0;
+        return ensureResidentCapacity(slotShrinkTarget(slotCount));
+    }
+
+    bool SModelRenderPassModule::ensureDeltaCapacity(CameraFrame &frame, VkDeviceSize bytes)
+    {
+        if (bytes <= frame.deltaCapacity)
+            return true;
+
+        VkDeviceSize newCap = std::max<VkDeviceSize>(64u * 1024u, frame.deltaCapacity);
+        while (newCap < bytes)
+            newCap *= 2u;
+
+        // This frame's fence has signaled: its staging buffer is idle.
+        frame.deltaMapped = nullptr;
+        frame.deltaCapacity = 0;
+        DestroyBuffer(m_device, frame.deltaBuffer, frame.deltaMemory);
+
+        if (CreateBuffer(m_device, m_physicalDevice, newCap, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, frame.deltaBuffer, frame.deltaMemory,
+                         m_queueFamilyCount, m_queueFamilies) != VK_SUCCESS)
+            return false;
+
+        frame.deltaMapped = frame.deltaMemory.mapped;
+        if (!frame.deltaMapped)
+            return false;
+
+        frame.deltaCapacity = newCap;
+        return true;
+    }
+
+    void SModelRenderPassModule::bindSlotBuffers(CameraFrame &frame, bool resident)
+    {
+        const uint32_t wanted = resident ? m_resident.generation : 0u;
+        if (frame.slotBuffersBinding == wanted || frame.set == VK_NULL_HANDLE)
+            return;
+
+        VkDescriptorBufferInfo infos[3]{};
+        if (resident)
+        {
+            infos[0] = {m_resident.paletteBuffer, 0, static_cast<VkDeviceSize>(m_resident.paletteCapacityMatrices) * sizeof(glm::mat4)};
+            infos[1] = {m_resident.jointPaletteBuffer, 0, static_cast<VkDeviceSize>(m_resident.jointPaletteCapacityMatrices) * sizeof(glm::mat4)};
+            infos[2] = {m_resident.worldBuffer, 0, static_cast<VkDeviceSize>(m_resident.worldCapacitySlots) * sizeof(glm::mat4)};
+        }
+        else
+        {
+            infos[0] = {frame.paletteBuffer, 0, static_cast<VkDeviceSize>(frame.paletteCapacityMatrices) * sizeof(glm::mat4)};
+            infos[1] = {frame.jointPaletteBuffer, 0, static_cast<VkDeviceSize>(frame.jointPaletteCapacityMatrices) * sizeof(glm::mat4)};
+            infos[2] = {frame.instanceWorldBuffer, 0, static_cast<VkDeviceSize>(frame.instanceWorldCapacitySlots) * sizeof(glm::mat4)};
+
+            // The frame's own copies were not maintained while resident data was bound.
+            std::fill(frame.uploadedTransformEpoch.begin(), frame.uploadedTransformEpoch.end(), 0u);
+            std::fill(frame.uploadedPoseEpoch.begin(), frame.uploadedPoseEpoch.end(), 0u);
+        }
+
+        VkWriteDescriptorSet writes[3]{};
+        for (uint32_t i = 0; i < 3u; ++i)
+        {
+            writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[i].dstSet = frame.set;
+            writes[i].dstBinding = 1u + i; // 1 = node palette, 2 = joint palette, 3 = instance worlds
+            writes[i].dstArrayElement = 0;
+            writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writes[i].descriptorCount = 1;
+            writes[i].pBufferInfo = &infos[i];
+        }
+        vkUpdateDescriptorSets(m_device, 3, writes, 0, nullptr);
+        frame.slotBuffersBinding = wanted;
+    }
+
+    bool SModelRenderPassModule::uploadResidentSlotData(CameraFrame &frame, VkCommandBuffer cmd, VkPipelineStageFlags readStages)
+    {
+        m_gpuPoseSlots.clear();
+        m_worldCopies.clear();
+        m_boundsCopies.clear();
+        m_paletteCopies.clear();
+        m_jointCopies.clear();
+
+        const uint32_t slotCapacity = static_cast<uint32_t>(m_slotWorlds.size());
+        const uint32_t nodeCount = std::max<uint32_t>(m_slotNodeCount, 1u);
+        const uint32_t jointStride = std::max<uint32_t>(m_slotJointCount, 1u);
+
+        if (!shrinkResidentCapacity(slotCapacity) || !ensureResidentCapacity(slotCapacity))
+            return false;
+
+        m_resident.uploadedTransformEpoch.resize(slotCapacity, 0u);
+        m_resident.uploadedPoseEpoch.resize(slotCapacity, 0u);
+
+        // Size the delta first so the staging buffer is (re)created at most once.
+        // Animated slots on the GPU path only need their (clip, time) in the pose dispatch.
+        const VkDeviceSize transformBytes = sizeof(glm::mat4) + sizeof(glm::vec4);
+        const VkDeviceSize poseBytes = static_cast<VkDeviceSize>(nodeCount + jointStride) * sizeof(glm::mat4);
+        VkDeviceSize deltaBytes = 0;
+        for (uint32_t slot : m_activeSlots)
+        {
+            if (slot >= slotCapacity)
+                continue;
+            if (m_resident.uploadedTransformEpoch[slot] != m_slotTransformEpoch[slot])
+                deltaBytes += transformBytes;
+            if (m_resident.uploadedPoseEpoch[slot] != m_slotPoseEpoch[slot])
+            {
+                if (m_poseDispatchable && m_slotGpuPose[slot])
+                {
+                    m_gpuPoseSlots.push_back(slot);
+                    m_resident.uploadedPoseEpoch[slot] = m_slotPoseEpoch[slot];
+                }
+                else
+                {
+                    deltaBytes += poseBytes;
+                }
+            }
+        }
+
+        bindSlotBuffers(frame, true);
+        if (deltaBytes == 0)
+            return true; // static/idle instances: nothing to copy
+
+        if (!ensureDeltaCapacity(frame, deltaBytes))
+            return false;
+
+        auto *dst = static_cast<uint8_t *>(frame.deltaMapped);
+        VkDeviceSize offset = 0;
+        auto stage = [&](std::vector<VkBufferCopy> &copies, const void *src, VkDeviceSize bytes, VkDeviceSize dstOffset)
+        {
+            std::memcpy(dst + offset, src, static_cast<size_t>(bytes));
+            copies.push_back(VkBufferCopy{offset, dstOffset, bytes});
+            offset += bytes;
+        };
+
+        for (uint32_t slot : m_activeSlots)
+        {
+            if (slot >= slotCapacity)
+                continue;
+
+            if (m_resident.uploadedTransformEpoch[slot] != m_slotTransformEpoch[slot])
+            {
+                stage(m_worldCopies, &m_slotWorlds[slot], sizeof(glm::mat4), static_cast<VkDeviceSize>(slot) * sizeof(glm::mat4));
+                stage(m_boundsCopies, &m_slotBounds[slot], sizeof(glm::vec4), static_cast<VkDeviceSize>(slot) * sizeof(glm::vec4));
+                m_resident.uploadedTransformEpoch[slot] = m_slotTransformEpoch[slot];
+            }
+
+            if (m_resident.uploadedPoseEpoch[slot] != m_slotPoseEpoch[slot])
+            {
+                const size_t nodeBase = static_cast<size_t>(slot) * nodeCount;
+                const size_t jointBase = static_cast<size_t>(slot) * jointStride;
+                stage(m_paletteCopies, m_nodePalette.data() + nodeBase, sizeof(glm::mat4) * nodeCount, nodeBase * sizeof(glm::mat4));
+                stage(m_jointCopies, m_jointPalette.data() + jointBase, sizeof(glm::mat4) * jointStride, jointBase * sizeof(glm::mat4));
+                m_resident.uploadedPoseEpoch[slot] = m_slotPoseEpoch[slot];
+            }
+        }
+
+        // Earlier frames' vertex/cull shaders may still read the resident buffers (write-after-read).
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        vkCmdPipelineBarrier(cmd, readStages,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+        auto copy = [&](VkBuffer target, const std::vector<VkBufferCopy> &copies)
+        {
+            if (!copies.empty())
+                vkCmdCopyBuffer(cmd, frame.deltaBuffer, target, static_cast<uint32_t>(copies.size()), copies.data());
+        };
+        copy(m_resident.worldBuffer, m_worldCopies);
+        copy(m_resident.boundsBuffer, m_boundsCopies);
+        copy(m_resident.paletteBuffer, m_paletteCopies);
+        copy(m_resident.jointPaletteBuffer, m_jointCopies);
+
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, readStages,
+                             0, 1, &barrier, 0, nullptr, 0, nullptr);
+        return true;
+    }
+
+    void SModelRenderPassModule::retireBuffer(VkBuffer &buffer, GpuAllocation &memory)
+    {
+        // Earlier frames may still read the old buffer; destroy it a full frame cycle later.
+        if (buffer == VK_NULL_HANDLE)
+            return;
+
+        RetiredBuffer rb{};
+        rb.buffer = buffer;
+        rb.memory = memory;
+        rb.framesLeft = static_cast<uint32_t>(m_cameraFrames.size()) + 1u;
+        m_retiredBuffers.push_back(rb);
+        buffer = VK_NULL_HANDLE;
+        memory = GpuAllocation{};
+    }
+
+    void SModelRenderPassModule::releaseRetiredBuffers(bool all)
+    {
+        size_t keep = 0;
+        for (RetiredBuffer &rb : m_retiredBuffers)
+        {
+            if (all || rb.framesLeft <= 1u)
+            {
+                DestroyBuffer(m_device, rb.buffer, rb.memory);
+                continue;
+            }
+            rb.framesLeft -= 1u;
+            m_retiredBuffers[keep++] = rb;
+        }
+        m_retiredBuffers.resize(keep);
+    }
+
+    void SModelRenderPassModule::destroyResidentResources()
+    {
+        // Called after the renderer waited for the device to go idle.
+        releaseRetiredBuffers(true);
+
+        ResidentSlotData &r = m_resident;
+        DestroyBuffer(m_device, r.worldBuffer, r.worldMemory);
+        DestroyBuffer(m_device, r.boundsBuffer, r.boundsMemory);
+        DestroyBuffer(m_device, r.paletteBuffer, r.paletteMemory);
+        DestroyBuffer(m_device, r.jointPaletteBuffer, r.jointPaletteMemory);
+        r.worldCapacitySlots = 0;
+        r.boundsCapacitySlots = 0;
+        r.paletteCapacityMatrices = 0;
+        r.jointPaletteCapacityMatrices = 0;
+        r.uploadedTransformEpoch.clear();
+        r.uploadedPoseEpoch.clear();
+        // generation keeps counting so stale frame bindings never match a new buffer set.
+    }
+
+    uint32_t SModelRenderPassModule::cullCandidatesOnCpu()
+    {
+        m_cpuCulledSlots.clear();
+        if (!m_camera)
+        {
+            m_cpuCulledSlots = m_activeSlots;
+            return static_cast<uint32_t>(m_cpuCulledSlots.size());
+        }
+
+        const Frustum frustum = Frustum::fromViewProjection(m_camera->GetProjectionMatrix() * m_camera->GetViewMatrix());
+        const uint32_t slotCapacity = static_cast<uint32_t>(m_slotBounds.size());
+        const uint32_t activeCount = static_cast<uint32_t>(m_activeSlots.size());
+        for (uint32_t base = 0; base < activeCount;)
+        {
+            // Gather up to eight live slots into SoA lanes, then one batched test.
+            uint32_t slots[8];
+            alignas(16) float cx[8] = {}, cy[8] = {}, cz[8] = {}, cr[8] = {};
+            uint32_t lanes = 0;
+            for (; base < activeCount && lanes < 8u; ++base)
+            {
+                const uint32_t slot = m_activeSlots[base];
+                if (slot >= slotCapacity)
+                    continue;
+                const glm::vec4 &b = m_slotBounds[slot];
+                slots[lanes] = slot;
+                cx[lanes] = b.x;
+                cy[lanes] = b.y;
+                cz[lanes] = b.z;
+                cr[lanes] = b.w;
+                ++lanes;
+            }
+            const uint32_t mask = frustum.testSpheres8(cx, cy, cz, cr);
+            for (uint32_t k = 0; k < lanes; ++k)
+            {
+                if ((mask >> k) & 1u)
+                    m_cpuCulledSlots.push_back(slots[k]);
+            }
+        }
+        return static_cast<uint32_t>(m_cpuCulledSlots.size());
+    }
+
+    bool SModelRenderPassModule::meshletsInUse(const ModelAsset &model) const
+    {
+        return m_meshletCulling && (m_meshShaderReady || m_meshletComputeReady) && !m_meshletDataFailed && model.hasMeshlets();
+    }
+
+    bool SModelRenderPassModule::recordAsyncCompute(FrameContext &frameCtx, VkCommandBuffer cmd)
+    {
+        if (m_cameraFrames.empty() || m_queueFamilyCount == 0)
+            return false;
+
+        CameraFrame &frame = m_cameraFrames[frameCtx.frameIndex % static_cast<uint32_t>(m_cameraFrames.size())];
+        frame.asyncCulled = false;
+        if (!m_enabled || !m_residentSlotData || m_activeSlots.empty() || m_slotWorlds.empty())
+            return false;
+
+        // Meshlet culling reads the cull results in task/compute stages of the graphics queue and
+        // a pose table build is a one-off copy: those frames run in recordPrePass().
+        const ModelAsset *model = (m_assets && m_model.isValid()) ? m_assets->getModel(m_model) : nullptr;
+        if (!model || meshletsInUse(*model))
+            return false;
+        if (gpuPoseReady() && frame.poseSet != VK_NULL_HANDLE && m_poseDataModel != model)
+            return false;
+
+        // Everything that can fail before a command is recorded.
+        if (!prepareSlotCull(frame, true))
+            return false;
+
+        // Once per frame (recordPrePass() skips it): this slot's fence has signaled.
+        releaseRetiredBuffers(false);
+        frame.retiredAged = true;
+
+        m_poseDispatchable = gpuPoseReady() && frame.poseSet != VK_NULL_HANDLE && preparePoseData(cmd);
+        if (!uploadResidentSlotData(frame, cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT))
+        {
+            // Out of device memory (or staging): recordPrePass() goes on with per-frame copies.
+            m_residentSlotData = false;
+            return false;
+        }
+        frame.residentUploaded = true;
+        dispatchGpuPoses(frame, cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+        // The copies and the pose dispatch overwrite resident data the previous frame's vertex
+        // shaders read; graphics-queue uploads and the Hi-Z pyramid come from that submit too.
+        const bool residentWritten = !m_worldCopies.empty() || !m_boundsCopies.empty() || !m_paletteCopies.empty() ||
+                                     !m_jointCopies.empty() || !m_gpuPoseSlots.empty();
+        if (residentWritten || m_residentAwaitingCompute || frameCtx.hiZPyramid != VK_NULL_HANDLE)
+            frameCtx.computeWaitsForGraphics = true;
+        m_residentAwaitingCompute = false;
+
+        dispatchSlotCull(frameCtx, frame, cmd, false);
+        frame.asyncCulled = true;
+        return true;
+    }
+
+    void SModelRenderPassModule::recordPrePass(FrameContext &frameCtx, VkCommandBuffer cmd)
+    {
+        if (m_cameraFrames.empty())
+            return;
+
+        CameraFrame &frame = m_cameraFrames[frameCtx.frameIndex % static_cast<uint32_t>(m_cameraFrames.size())];
+        const bool asyncCulled = frame.asyncCulled;
+        frame.asyncCulled = false;
+        frame.gpuCulled = asyncCulled;
+        frame.residentUploaded = asyncCulled;
+        frame.meshletsPrepared = false;
+        frame.meshletCommands = false;
+        frame.shadowPrepared = false;
+
+        // Once per frame: this slot's fence has signaled, so retired buffers age by one frame.
+        if (!frame.retiredAged)
+            releaseRetiredBuffers(false);
+        frame.retiredAged = false;
+
+        if (!m_enabled || !bindCameraBlock(frame, frameCtx))
+            return;
+
+        // Copy changed slots into the resident buffers (transfers must precede the render pass),
+        // unless recordAsyncCompute() did so on the compute queue along with the cull.
+        if (!asyncCulled && m_residentSlotData && !m_activeSlots.empty() && !m_slotWorlds.empty())
+        {
+            // Pose tables must be in place before animated slots are routed to the GPU.
+            m_poseDispatchable = gpuPoseReady() && frame.poseSet != VK_NULL_HANDLE && preparePoseData(cmd);
+
+            if (uploadResidentSlotData(frame, cmd, slotReadStages()))
+            {
+                frame.residentUploaded = true;
+                dispatchGpuPoses(frame, cmd, slotReadStages());
+                // The next async compute submit reads what this submit writes.
+                m_residentAwaitingCompute = true;
+            }
+            else
+            {
+                // Out of device memory (or staging): keep going with per-frame host-visible copies.
+                m_residentSlotData = false;
+            }
+        }
+
+        // Meshlet records (rebuilt with the draw list) and this frame's frustum for their cull.
+        if (!asyncCulled)
+            prepareMeshlets(frame, cmd);
+
+        // Caster lists for the cascades drawn this frame (recordShadow() runs after the prepasses).
+        if (frameCtx.shadow && frameCtx.shadow->draws(m_shadowCaster) && frame.residentUploaded)
+            prepareShadowSlots(frame, *frameCtx.shadow);
+
+        if (asyncCulled || !prepareSlotCull(frame, frame.residentUploaded))
+            return;
+        dispatchSlotCull(frameCtx, frame, cmd, true);
+        frame.gpuCulled = true;
+    }
+
+    bool SModelRenderPassModule::prepareSlotCull(CameraFrame &frame, bool resident)
+    {
+        if (!m_gpuCulling || !m_cullReady || !m_camera)
+            return false;
+        if (!m_assets || !m_model.isValid() || frame.set == VK_NULL_HANDLE || frame.cullSet == VK_NULL_HANDLE)
+            return false;
+        if (m_extent.width == 0 || m_extent.height == 0)
+            return false;
+
+        ModelAsset *model = m_assets->getModel(m_model);
+        if (!model || model->primitives.empty())
+            return false;
+
+        const uint32_t candidateCount = static_cast<uint32_t>(m_activeSlots.size());
+        const uint32_t slotCapacity = static_cast<uint32_t>(m_slotWorlds.size());
+        if (candidateCount == 0 || slotCapacity == 0)
+            return false;
+
+        if (m_drawListModel != model || m_drawListPrimitiveCount != model->primitives.size())
+            rebuildDrawList(*model);
+        if (m_draws.empty() || !m_drawsShareBuffers)
+            return false;
+        const uint32_t drawCount = static_cast<uint32_t>(m_draws.size());
+
+        // Binding 4 (visible slots) holds up to every candidate; commands stride by candidateCount.
+        if (!ensureActiveSlotsCapacity(frame, candidateCount) ||
+            !ensureCullCapacity(frame, resident ? 0u : slotCapacity, candidateCount) ||
+            !ensureDrawDataCapacity(frame, drawCount) ||
+            !ensureIndirectCapacity(frame, drawCount))
+            return false;
+        if (!resident && !uploadSlotData(frame, m_activeSlots.data(), candidateCount))
+            return false;
+
+        if (frame.lastUploadedCandidatesVersion != m_activeSlotsVersion)
+        {
+            std::memcpy(frame.candidatesMapped, m_activeSlots.data(), sizeof(uint32_t) * candidateCount);
+            frame.lastUploadedCandidatesVersion = m_activeSlotsVersion;
+        }
+        // Binding 4 is written by the GPU from here on; a later CPU frame must re-upload it.
+        frame.lastUploadedActiveSlotsVersion = 0;
+
+        writeIndirectCommands(frame, candidateCount, true);
+        return true;
+    }
+
+    void SModelRenderPassModule::dispatchSlotCull(const FrameContext &frameCtx, CameraFrame &frame, VkCommandBuffer cmd, bool graphicsQueue)
+    {
+        const uint32_t candidateCount = static_cast<uint32_t>(m_activeSlots.size());
+        const uint32_t drawCount = static_cast<uint32_t>(m_draws.size());
+
+        // (Re)point the cull set at the current buffers (they move when capacities grow). Without
+        // a Hi-Z pyramid binding 5 holds the bounds, unread (occlusion off in the push constants).
+        const VkBuffer boundsBuffer = frame.residentUploaded ? m_resident.boundsBuffer : frame.boundsBuffer;
+        const VkBuffer hiZ = frameCtx.hiZPyramid;
+        const VkBuffer buffers[6] = {frame.candidatesBuffer, boundsBuffer, frame.activeSlotsBuffer, frame.indirectBuffer, frame.counterBuffer,
+                                     hiZ != VK_NULL_HANDLE ? hiZ : boundsBuffer};
+        if (!std::equal(std::begin(buffers), std::end(buffers), std::begin(frame.cullSetBuffers)))
+        {
+            VkDescriptorBufferInfo infos[6]{};
+            VkWriteDescriptorSet writes[6]{};
+            for (uint32_t i = 0; i < 6u; ++i)
+            {
+                infos[i].buffer = buffers[i];
+                infos[i].offset = 0;
+                infos[i].range = VK_WHOLE_SIZE;
+
+                writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                writes[i].dstSet = frame.cullSet;
+                writes[i].dstBinding = i;
+                writes[i].dstArrayElement = 0;
+                writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                writes[i].descriptorCount = 1;
+                writes[i].pBufferInfo = &infos[i];
+                frame.cullSetBuffers[i] = buffers[i];
+            }
+            vkUpdateDescriptorSets(m_device, 6, writes, 0, nullptr);
+        }
+
+        struct CullPushConstants
+        {
+            float planes[6][4];
+            uint32_t candidateCount;
+            uint32_t drawCount;
+            uint32_t mode;
+            uint32_t occlusion; // test against the Hi-Z pyramid of binding 5
+        } cpc{};
+
+        const float aspect = static_cast<float>(m_extent.width) / static_cast<float>(m_extent.height);
+        m_camera->SetAspect(aspect);
+        const Frustum frustum = Frustum::fromViewProjection(m_camera->GetProjectionMatrix() * m_camera->GetViewMatrix());
+        for (int i = 0; i < 6; ++i)
+        {
+            const FrustumPlane &pl = frustum.plane(i);
+            cpc.planes[i][0] = pl.normal.x;
+            cpc.planes[i][1] = pl.normal.y;
+            cpc.planes[i][2] = pl.normal.z;
+            cpc.planes[i][3] = pl.distance;
+        }
+        cpc.candidateCount = candidateCount;
+        cpc.drawCount = drawCount;
+        cpc.occlusion = hiZ != VK_NULL_HANDLE ? 1u : 0u;
+
+        // Reset the visible counter
+        vkCmdFillBuffer(cmd, frame.counterBuffer, 0, sizeof(uint32_t), 0u);
+
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_cullPipeline);
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_cullPipelineLayout, 0, 1, &frame.cullSet, 0, nullptr);
+
+        // Pass 1: test + compact
+        cpc.mode = 0u;
+        vkCmdPushConstants(cmd, m_cullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(cpc), &cpc);
+        vkCmdDispatch(cmd, (candidateCount + 63u) / 64u, 1, 1);
+
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+        // Pass 2: visible count -> every draw command
+        cpc.mode = 1u;
+        vkCmdPushConstants(cmd, m_cullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(cpc), &cpc);
+        vkCmdDispatch(cmd, (drawCount + 63u) / 64u, 1, 1);
+
+        // Per-meshlet commands over the visible slots (compute path).
+        dispatchMeshletCull(frame, cmd, candidateCount);
+
+        // Results feed the indirect draws (commands, meshlet counts) and the vertex/task shaders
+        // (visible slots, counter). On the compute queue the graphics submit's timeline wait
+        // covers this.
+        if (!graphicsQueue)
+            return;
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | slotReadStages(),
+                             0, 1, &barrier, 0, nullptr, 0, nullptr);
+    }
+
+    ShadowCaster SModelRenderPassModule::shadowCaster() const
+    {
+        // Casters are drawn from the resident slot buffers only.
+        if (!m_enabled || m_shadowFailed || !m_residentSlotData || m_activeSlots.empty())
+            return ShadowCaster::None;
+        return m_shadowCaster;
+    }
+
+    uint64_t SModelRenderPassModule::shadowContentVersion() const
+    {
+        // Every counter only grows, so any slot, transform, pose or draw list change moves the sum.
+        return m_activeSlotsVersion + m_transformEpochCounter + m_poseEpochCounter + m_drawListVersion + m_modelMatrixVersion;
+    }
+
+    bool SModelRenderPassModule::ensureShadowSlotsCapacity(CameraFrame &frame, uint32_t needed)
+    {
+        if (needed <= frame.shadowSlotsCapacity)
+            return true;
+        if (m_device == VK_NULL_HANDLE || m_physicalDevice == VK_NULL_HANDLE)
+            return false;
+
+        uint32_t newCap = std::max<uint32_t>(256u, frame.shadowSlotsCapacity);
+        while (newCap < needed)
+            newCap *= 2u;
+
+        frame.shadowSlotsMapped = nullptr;
+        frame.shadowSlotsCapacity = 0;
+        DestroyBuffer(m_device, frame.shadowSlotsBuffer, frame.shadowSlotsMemory);
+
+        if (CreateBuffer(m_device, m_physicalDevice, static_cast<VkDeviceSize>(newCap) * sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, frame.shadowSlotsBuffer, frame.shadowSlotsMemory) != VK_SUCCESS)
+            return false;
+
+        frame.shadowSlotsMapped = frame.shadowSlotsMemory.mapped;
+        if (!frame.shadowSlotsMapped)
+            return false;
+        frame.shadowSlotsCapacity = newCap;
+        return true;
+    }
+
+    void SModelRenderPassModule::prepareShadowSlots(CameraFrame &frame, const ShadowFrame &shadow)
+    {
+        if (frame.shadowSet == VK_NULL_HANDLE || m_activeSlots.empty())
+            return;
+
+        // Static casters only redraw the cascades in staticMask; the overlay redraws all of them.
+        const uint32_t cascades = std::min(shadow.cascadeCount, ShadowFrame::MAX_CASCADES);
+        const uint32_t drawMask = m_shadowCaster == ShadowCaster::Static ? shadow.staticMask : ((1u << cascades) - 1u);
+        const uint32_t slotCapacity = static_cast<uint32_t>(m_slotBounds.size());
+
+        m_shadowSlots.clear();
+        for (uint32_t c = 0; c < ShadowFrame::MAX_CASCADES; ++c)
+        {
+            frame.shadowFirst[c] = static_cast<uint32_t>(m_shadowSlots.size());
+            if (c < cascades && (drawMask & (1u << c)) != 0u)
+            {
+                for (uint32_t slot : m_activeSlots)
+                {
+                    if (slot >= slotCapacity)
+                        continue;
+                    const glm::vec4 &b = m_slotBounds[slot];
+                    if (shadow.casterVisible(c, glm::vec3(b), b.w))
+                        m_shadowSlots.push_back(slot);
+                }
+            }
+            frame.shadowCount[c] = static_cast<uint32_t>(m_shadowSlots.size()) - frame.shadowFirst[c];
+        }
+
+        const uint32_t total = static_cast<uint32_t>(m_shadowSlots.size());
+        if (total == 0 || !ensureShadowSlotsCapacity(frame, total))
+            return;
+        std::memcpy(frame.shadowSlotsMapped, m_shadowSlots.data(), sizeof(uint32_t) * total);
+
+        // Camera layout: 0 = camera UBO, 1-3 = resident slot data, 4 = caster lists. Binding 5
+        // (per-draw data) is not read by smodel_shadow.vert and points at the lists as well.
+        const VkBuffer buffers[6] = {frame.cameraRingBuffer, m_resident.paletteBuffer, m_resident.jointPaletteBuffer,
+                                     m_resident.worldBuffer, frame.shadowSlotsBuffer, frame.shadowSlotsBuffer};
+        if (!std::equal(std::begin(buffers), std::end(buffers), std::begin(frame.shadowSetBuffers)))
+        {
+            VkDescriptorBufferInfo infos[6]{};
+            VkWriteDescriptorSet writes[6]{};
+            for (uint32_t i = 0; i < 6u; ++i)
+            {
+                infos[i].buffer = buffers[i];
+                infos[i].offset = 0;
+                infos[i].range = i == 0u ? sizeof(CameraUBO) : VK_WHOLE_SIZE;
+
+                writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                writes[i].dstSet = frame.shadowSet;
+                writes[i].dstBinding = i;
+                writes[i].dstArrayElement = 0;
+                writes[i].descriptorType = i == 0u ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                writes[i].descriptorCount = 1;
+                writes[i].pBufferInfo = &infos[i];
+                frame.shadowSetBuffers[i] = buffers[i];
+            }
+            vkUpdateDescriptorSets(m_device, 6, writes, 0, nullptr);
+        }
+        frame.shadowPrepared = true;
+    }
+
+    bool SModelRenderPassModule::createShadowPipelines(const ShadowCasterInfo &info)
+    {
+        destroyShadowPipelines();
+        m_shadowRenderPass = info.renderPass;
+
+        const VkDescriptorSetLayout materialLayout = m_bindless ? m_bindless->layout() : m_materialSetLayout;
+        if (m_cameraSetLayout == VK_NULL_HANDLE || materialLayout == VK_NULL_HANDLE || info.setLayout == VK_NULL_HANDLE)
+            return false;
+
         VkPushConstantRange pcRange{};
         pcRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
         pcRange.offset = 0;
         pcRange.size = sizeof(PushConstantsModel);
 
+        VkDescriptorSetLayout setLayouts[3] = {m_cameraSetLayout, materialLayout, info.setLayout};
         VkPipelineLayoutCreateInfo plInfo{};
         plInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-        VkDescriptorSetLayout setLayouts[2] = {m_cameraSetLayout, m_materialSetLayout};
-        plInfo.setLayoutCount = 2;
+        plInfo.setLayoutCount = 3;
         plInfo.pSetLayouts = setLayouts;
         plInfo.pushConstantRangeCount = 1;
         plInfo.pPushConstantRanges = &pcRange;
+        if (vkCreatePipelineLayout(m_device, &plInfo, nullptr, &m_shadowPipelineLayout) != VK_SUCCESS)
+            return false;
 
-        if (vkCreatePipelineLayout(ctx.GetDevice(), &plInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS)
+        // Optional shaders: without them the model casts no shadow.
+        VkShaderModule vert = VK_NULL_HANDLE;
+        VkShaderModule frag = VK_NULL_HANDLE;
+        try
         {
-            throw std::runtime_error("SModelRenderPassModule: failed to create pipeline layout");
+            vert = Pipeline::createShaderModuleFromFile(m_device, "shaders/smodel_shadow.vert.spv");
+            frag = Pipeline::createShaderModuleFromFile(m_device, m_bindless ? "shaders/shadow_mask_bindless.frag.spv" : "shaders/shadow_mask.frag.spv");
         }
-
-        // Common pipeline create info
-        PipelineCreateInfo pci{};
-        pci.device = ctx.GetDevice();
-        pci.renderPass = pass;
-        pci.subpass = 0;
-        pci.pipelineLayout = m_pipelineLayout;
-
-        // Load shader modules
-        VkShaderModule vert = Pipeline::createShaderModuleFromFile(pci.device, "shaders/smodel.vert.spv");
-        VkShaderModule frag = Pipeline::createShaderModuleFromFile(pci.device, "shaders/smodel.frag.spv");
-        if (vert == VK_NULL_HANDLE || frag == VK_NULL_HANDLE)
+        catch (const std::exception &)
         {
-            throw std::runtime_error("SModelRenderPassModule: failed to load shader modules (smodel.vert/frag.spv)");
+            // Masked draws cast as opaque without the fragment shader.
+        }
+        if (vert == VK_NULL_HANDLE)
+        {
+            if (frag != VK_NULL_HANDLE)
+                vkDestroyShaderModule(m_device, frag, nullptr);
+            return false;
         }
 
-        VkPipelineShaderStageCreateInfo vs{};
-        vs.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-        vs.stage = VK_SHADER_STAGE_VERTEX_BIT;
-        vs.module = vert;
-        vs.pName = "main";
-
-        VkPipelineShaderStageCreateInfo fs{};
-        fs.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-        fs.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-        fs.module = frag;
-        fs.pName = "main";
-
-        pci.shaderStages = {vs, fs};
-
-        // Vertex input:
-        //  binding 0: VertexPNTTJW (72 bytes)
-        // Instance data comes from SSBOs via slot indirection (no instanced vertex attributes).
-        std::array<VkVertexInputBindingDescription, 1> bindingDescs{};
-        bindingDescs[0].binding = 0;
-        bindingDescs[0].stride = 72;
-        bindingDescs[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+        PipelineCreateInfo pci{};
+        pci.device = m_device;
+        pci.pipelineCache = m_pipelineCache;
+        pci.renderPass = info.renderPass;
+        pci.subpass = 0;
+        pci.pipelineLayout = m_shadowPipelineLayout;
 
-        std::array<VkVertexInputAttributeDescription, 6> attrs{};
-        attrs[0] = {0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0};     // pos
-        attrs[1] = {1, 0, VK_FORMAT_R32G32B32_SFLOAT, 12};    // normal
-        attrs[2] = {2, 0, VK_FORMAT_R32G32_SFLOAT, 24};       // uv0
-        attrs[3] = {3, 0, VK_FORMAT_R32G32B32A32_SFLOAT, 32}; // tangent
+        // Position, uv0 (alpha test) and the skinning inputs of SModelPackedVertex.
+        VkVertexInputBindingDescription binding{};
+        binding.binding = 0;
+        binding.stride = smodel::SMODEL_PACKED_VERTEX_STRIDE;
+        binding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
 
-        // Skinning inputs
-        attrs[4] = {8, 0, VK_FORMAT_R16G16B16A16_UINT, 48};   // joints (u16x4)
-        attrs[5] = {9, 0, VK_FORMAT_R32G32B32A32_SFLOAT, 56}; // weights (f32x4)
+        std::array<VkVertexInputAttributeDescription, 4> attrs{};
+        attrs[0] = {0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0};
+        attrs[1] = {2, 0, VK_FORMAT_R16G16_SFLOAT, 16};
+        attrs[2] = {8, 0, VK_FORMAT_R16G16B16A16_UINT, 24};
+        attrs[3] = {9, 0, VK_FORMAT_R8G8B8A8_UNORM, 32};
 
         VkPipelineVertexInputStateCreateInfo vi{};
         vi.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-        vi.vertexBindingDescriptionCount = static_cast<uint32_t>(bindingDescs.size());
-        vi.pVertexBindingDescriptions = bindingDescs.data();
+        vi.vertexBindingDescriptionCount = 1;
+        vi.pVertexBindingDescriptions = &binding;
         vi.vertexAttributeDescriptionCount = static_cast<uint32_t>(attrs.size());
         vi.pVertexAttributeDescriptions = attrs.data();
         pci.vertexInput = vi;
         pci.vertexInputProvided = true;
 
-        // Input assembly: triangle list
         VkPipelineInputAssemblyStateCreateInfo ia{};
         ia.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
         ia.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-        ia.primitiveRestartEnable = VK_FALSE;
         pci.inputAssembly = ia;
         pci.inputAssemblyProvided = true;
 
-        // Rasterization: no cull (safe for now; honors doubleSided by default)
+        // No culling: open meshes and double-sided materials still cast from both sides.
         VkPipelineRasterizationStateCreateInfo rs{};
         rs.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-        rs.depthClampEnable = VK_FALSE;
-        rs.rasterizerDiscardEnable = VK_FALSE;
         rs.polygonMode = VK_POLYGON_MODE_FILL;
         rs.lineWidth = 1.0f;
         rs.cullMode = VK_CULL_MODE_NONE;
         rs.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
-        rs.depthBiasEnable = VK_FALSE;
+        rs.depthBiasEnable = VK_TRUE;
+        rs.depthBiasConstantFactor = info.depthBiasConstant;
+        rs.depthBiasSlopeFactor = info.depthBiasSlope;
         pci.rasterization = rs;
         pci.rasterizationProvided = true;
 
-        // Dynamic viewport/scissor
         pci.dynamicStates = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
 
-        // Depth/stencil (main render pass has a depth attachment)
         VkPipelineDepthStencilStateCreateInfo ds{};
         ds.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
         ds.depthTestEnable = VK_TRUE;
         ds.depthWriteEnable = VK_TRUE;
         ds.depthCompareOp = VK_COMPARE_OP_LESS;
-        ds.depthBoundsTestEnable = VK_FALSE;
-        ds.stencilTestEnable = VK_FALSE;
         pci.depthStencil = ds;
         pci.depthStencilProvided = true;
 
-        // Pipelines: OPAQUE / MASK / BLEND (mask currently uses same state as opaque)
-        VkPipelineColorBlendAttachmentState attOpaque{};
-        VkPipelineColorBlendStateCreateInfo cbOpaque = makeBlendState(false, attOpaque);
-        pci.colorBlend = cbOpaque;
+        // Depth only: no colour attachment.
+        VkPipelineColorBlendStateCreateInfo cb{};
+        cb.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+        cb.attachmentCount = 0;
+        pci.colorBlend = cb;
         pci.colorBlendProvided = true;
-        VkResult r0 = m_pipelineOpaque.create(pci);
 
-        VkPipelineColorBlendAttachmentState attMask{};
-        VkPipelineColorBlendStateCreateInfo cbMask = makeBlendState(false, attMask);
-        pci.colorBlend = cbMask;
-        pci.colorBlendProvided = true;
-        VkResult r1 = m_pipelineMask.create(pci);
+        VkPipelineShaderStageCreateInfo vs{};
+        vs.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        vs.stage = VK_SHADER_STAGE_VERTEX_BIT;
+        vs.module = vert;
+        vs.pName = "main";
 
-        VkPipelineColorBlendAttachmentState attBlend{};
-        VkPipelineColorBlendStateCreateInfo cbBlend = makeBlendState(true, attBlend);
-        pci.colorBlend = cbBlend;
-        pci.colorBlendProvided = true;
+        VkPipelineShaderStageCreateInfo fs = vs;
+        fs.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+        fs.module = frag;
 
-        // Transparent: test depth but don't write
-        pci.depthStencil.depthWriteEnable = VK_FALSE;
-        VkResult r2 = m_pipelineBlend.create(pci);
+        PipelineSpecialization vertSpec;
+        PipelineSpecialization fragSpec;
+        bool ok = true;
+        for (uint32_t skinned = 0; skinned < 2u; ++skinned)
+        {
+            vertSpec.set(SPEC_SKINNED, skinned);
+            vertSpec.apply(vs);
+            pci.shaderStages = {vs};
+            ok &= m_shadowPermutations.create(shadowKey(0u, skinned != 0u, false), pci) == VK_SUCCESS;
+
+            if (frag == VK_NULL_HANDLE)
+                continue;
+            for (uint32_t textured = 0; textured < 2u; ++textured)
+            {
+                fragSpec.setBool(SPEC_BASE_TEXTURE, textured != 0u);
+                fragSpec.apply(fs);
+                pci.shaderStages = {vs, fs};
+                ok &= m_shadowPermutations.create(shadowKey(1u, skinned != 0u, textured != 0u), pci) == VK_SUCCESS;
+            }
+        }
 
-        // Cleanup shader modules
-        vkDestroyShaderModule(pci.device, vert, nullptr);
-        vkDestroyShaderModule(pci.device, frag, nullptr);
+        vkDestroyShaderModule(m_device, vert, nullptr);
+        if (frag != VK_NULL_HANDLE)
+            vkDestroyShaderModule(m_device, frag, nullptr);
+        return ok;
+    }
 
-        if (r0 != VK_SUCCESS || r1 != VK_SUCCESS || r2 != VK_SUCCESS)
+    void SModelRenderPassModule::destroyShadowPipelines()
+    {
+        if (m_device == VK_NULL_HANDLE)
+            return;
+        m_shadowPermutations.destroy(m_device);
+        if (m_shadowPipelineLayout != VK_NULL_HANDLE)
         {
-            throw std::runtime_error("SModelRenderPassModule: failed to create one or more pipelines");
+            vkDestroyPipelineLayout(m_device, m_shadowPipelineLayout, nullptr);
+            m_shadowPipelineLayout = VK_NULL_HANDLE;
         }
+        m_shadowRenderPass = VK_NULL_HANDLE;
     }
 
-    void SModelRenderPassModule::record(FrameContext &frameCtx, VkCommandBuffer cmd)
+    void SModelRenderPassModule::recordShadow(FrameContext &frameCtx, VkCommandBuffer cmd, const ShadowCasterInfo &info)
     {
-        if (!m_enabled)
-            return;
-        if (!m_assets || !m_model.isValid())
+        if (m_cameraFrames.empty() || !m_assets || m_draws.empty() || !m_drawsShareBuffers)
             return;
-        if (m_extent.width == 0 || m_extent.height == 0)
+        CameraFrame &frame = m_cameraFrames[frameCtx.frameIndex % static_cast<uint32_t>(m_cameraFrames.size())];
+        if (!frame.shadowPrepared || info.cascade >= ShadowFrame::MAX_CASCADES || frame.shadowCount[info.cascade] == 0u)
             return;
 
-        ModelAsset *model = m_assets->getModel(m_model);
-        if (!model || model->primitives.empty())
+        if (info.renderPass != m_shadowRenderPass && !m_shadowFailed)
+        {
+            m_shadowFailed = !createShadowPipelines(info);
+            if (m_shadowFailed)
+                destroyShadowPipelines();
+        }
+        if (m_shadowFailed)
             return;
 
-        VkViewport vp{0.0f, 0.0f, static_cast<float>(m_extent.width), static_cast<float>(m_extent.height), 0.0f, 1.0f};
-        VkRect2D sc{{0, 0}, {m_extent.width, m_extent.height}};
-        vkCmdSetViewport(cmd, 0, 1, &vp);
-        vkCmdSetScissor(cmd, 0, 1, &sc);
+        VkBuffer vb = m_draws[0].vertexBuffer;
+        VkDeviceSize vbOffset = 0;
+        vkCmdBindVertexBuffers(cmd, 0, 1, &vb, &vbOffset);
+        vkCmdBindIndexBuffer(cmd, m_draws[0].indexBuffer, 0, m_draws[0].indexType);
 
-        // Update camera UBO for this frame
-        const uint32_t camIndex = (!m_cameraFrames.empty()) ? (frameCtx.frameIndex % static_cast<uint32_t>(m_cameraFrames.size())) : 0;
-        CameraFrame *camFrame = (!m_cameraFrames.empty()) ? &m_cameraFrames[camIndex] : nullptr;
-        if (camFrame && camFrame->mapped)
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_shadowPipelineLayout, 0, 1, &frame.shadowSet, 1, &frame.cameraOffset);
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_shadowPipelineLayout, 2, 1, &info.set, 0, nullptr);
+        bindBindlessSet(cmd, m_shadowPipelineLayout);
+
+        // gl_InstanceIndex runs over this cascade's list: firstInstance = its offset.
+        const uint32_t first = frame.shadowFirst[info.cascade];
+        const uint32_t count = frame.shadowCount[info.cascade];
+        const Pipeline *boundPipe = nullptr;
+        for (const DrawGroup &g : m_drawGroups)
         {
-            CameraUBO ubo{};
-            const float aspect = (m_extent.height > 0) ? (static_cast<float>(m_extent.width) / static_cast<float>(m_extent.height)) : 1.0f;
-            if (m_camera)
+            if (g.pass > 1u)
+                continue; // blended surfaces cast no shadow
+            const bool masked = g.pass == 1u && m_shadowPermutations.find(shadowKey(1u, g.skinned, g.textured)) != nullptr;
+            const Pipeline *pipe = m_shadowPermutations.find(shadowKey(masked ? 1u : 0u, g.skinned, masked && g.textured));
+            MaterialAsset *mat = m_assets->getMaterial(g.material);
+            if (!pipe || !mat)
+                continue;
+            if (pipe != boundPipe)
             {
-                m_camera->SetAspect(aspect);
-                ubo.view = m_camera->GetViewMatrix();
-                ubo.proj = m_camera->GetProjectionMatrix();
+                pipe->bind(cmd);
+                boundPipe = pipe;
             }
-            else
+
+            PushConstantsModel pc{};
+            fillPushConstants(pc, *mat);
+            if (masked)
+                bindMaterial(cmd, m_shadowPipelineLayout, g, mat, pc);
+            pc._pad0 = info.cascade; // nodeInfo.z: ShadowUBO::viewProj index
+
+            for (uint32_t k = 0; k < g.drawCount; ++k)
             {
-                glm::mat4 view = glm::lookAt(glm::vec3(0, 0, 3), glm::vec3(0, 0, 0), glm::vec3(0, 1, 0));
-                glm::mat4 proj = glm::perspective(glm::radians(60.0f), aspect, 0.1f, 100.0f);
-                proj[1][1] *= -1.0f;
-                ubo.view = view;
-                ubo.proj = proj;
+                const StaticDraw &d = m_draws[g.firstDraw + k];
+                pc.nodeIndex = d.nodeIndex;
+                pc.skinBaseJoint = d.skinBaseJoint;
+                pc.skinJointCount = d.skinJointCount;
+                vkCmdPushConstants(cmd, m_shadowPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(PushConstantsModel), &pc);
+                vkCmdDrawIndexed(cmd, d.indexCount, count, d.firstIndex, d.vertexOffset, first);
+                DrawCallCounter::increment();
             }
-
-            std::memcpy(camFrame->mapped, &ubo, sizeof(CameraUBO));
         }
+    }
 
-        const uint32_t instanceCount = static_cast<uint32_t>(m_activeSlots.size());
-        if (instanceCount == 0)
-            return;
-
-        const uint32_t slotCapacity = static_cast<uint32_t>(m_slotWorlds.size());
-        if (slotCapacity == 0)
-            return;
-
-        const uint32_t nodeCount = std::max<uint32_t>(m_slotNodeCount, 1u);
-        const uint32_t jointStride = std::max<uint32_t>(m_slotJointCount, 1u);
+    void SModelRenderPassModule::rebuildDrawList(const ModelAsset &model)
+    {
+        m_draws.clear();
+        m_drawGroups.clear();
+        m_drawListModel = &model;
+        m_drawListPrimitiveCount = model.primitives.size();
+        m_drawListVersion += 1u;
 
-        if (camFrame)
+        auto addDraw = [&](const ModelPrimitive &prim, uint32_t nodeIndex)
         {
-            if (!ensureInstanceWorldCapacity(*camFrame, slotCapacity))
+            MeshAsset *mesh = m_assets->getMesh(prim.mesh);
+            MaterialAsset *mat = m_assets->getMaterial(prim.material);
+            if (!mesh || !mat || prim.indexCount == 0)
                 return;
-            if (!ensureActiveSlotsCapacity(*camFrame, instanceCount))
+            if (mesh->getVertexBuffer() == VK_NULL_HANDLE || mesh->getIndexBuffer() == VK_NULL_HANDLE)
                 return;
-            if (!ensurePaletteCapacity(*camFrame, slotCapacity * nodeCount))
-                return;
-            if (!ensureJointPaletteCapacity(*camFrame, slotCapacity * jointStride))
+            if (mat->alphaMode > 2u)
                 return;
 
-            camFrame->uploadedTransformEpoch.resize(slotCapacity, 0u);
-            camFrame->uploadedPoseEpoch.resize(slotCapacity, 0u);
+            StaticDraw d{};
+            d.pass = mat->alphaMode;
+            d.material = prim.material;
+            d.textured = mat->baseColorTexture.isValid();
+            d.indexCount = prim.indexCount;
+            d.firstIndex = mesh->getFirstIndex() + prim.firstIndex;
+            if (m_lod > 0 && mesh->getLodCount() > 0 && prim.firstIndex == 0 && prim.indexCount == mesh->getIndexCount())
+                mesh->getLodRange(m_lod, d.firstIndex, d.indexCount);
+            d.vertexOffset = mesh->getVertexOffset() + prim.vertexOffset;
+            d.nodeIndex = nodeIndex;
+            if (prim.skinIndex >= 0 && static_cast<uint32_t>(prim.skinIndex) < model.skins.size())
+            {
+                const auto &skin = model.skins[static_cast<uint32_t>(prim.skinIndex)];
+                d.skinBaseJoint = skin.jointBase;
+                d.skinJointCount = skin.jointCount;
+            }
+            d.vertexBuffer = mesh->getVertexBuffer();
+            d.indexBuffer = mesh->getIndexBuffer();
+            d.indexType = mesh->getIndexType();
+            // Meshlets tile the full-detail range; the mesh shaders read the merged vertex buffer.
+            if (m_lod == 0 && prim.meshletCount > 0 && mesh->isMerged() &&
+                mesh->getVertexStride() == smodel::SMODEL_PACKED_VERTEX_STRIDE &&
+                prim.firstMeshlet + prim.meshletCount <= model.meshlets.size())
+            {
+                d.firstMeshlet = prim.firstMeshlet;
+                d.meshletCount = prim.meshletCount;
+            }
+            m_draws.push_back(d);
+        };
+
+        if (!model.nodes.empty())
+        {
+            for (uint32_t nodeIndex = 0; nodeIndex < static_cast<uint32_t>(model.nodes.size()); ++nodeIndex)
+            {
+                const auto &node = model.nodes[nodeIndex];
+                for (uint32_t k = 0; k < node.primitiveCount; ++k)
+                {
+                    const uint32_t primIndex = model.nodePrimitiveIndices[node.firstPrimitiveIndex + k];
+                    if (primIndex < model.primitives.size())
+                        addDraw(model.primitives[primIndex], nodeIndex);
+                }
+            }
+        }
+        else
+        {
+            // No node graph: every primitive at node 0
+            for (const ModelPrimitive &prim : model.primitives)
+                addDraw(prim, 0);
+        }
 
-            // Upload active slot indirection for this frame.
-            if (camFrame->activeSlotsMapped && camFrame->lastUploadedActiveSlotsVersion != m_activeSlotsVersion)
+        // Pass ordering like glTF (0=OPAQUE,1=MASK,2=BLEND), then by material, skinned/rigid and
+        // meshlets or not so each group is one pipeline permutation + one descriptor bind + one
+        // indirect call. Stable: keeps node order inside a group.
+        std::stable_sort(m_draws.begin(), m_draws.end(), [](const StaticDraw &a, const StaticDraw &b)
+                         {
+                             if (a.pass != b.pass)
+                                 return a.pass < b.pass;
+                             if (a.material.id != b.material.id)
+                                 return a.material.id < b.material.id;
+                             if ((a.skinJointCount > 0u) != (b.skinJointCount > 0u))
+                                 return (a.skinJointCount > 0u) < (b.skinJointCount > 0u);
+                             return (a.meshletCount > 0u) < (b.meshletCount > 0u); });
+
+        m_drawsShareBuffers = true;
+        uint32_t meshletCursor = 0;
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_draws.size()); ++i)
+        {
+            const StaticDraw &d = m_draws[i];
+            if (d.vertexBuffer != m_draws[0].vertexBuffer || d.indexBuffer != m_draws[0].indexBuffer || d.indexType != m_draws[0].indexType)
+                m_drawsShareBuffers = false;
+
+            const bool skinned = d.skinJointCount > 0u;
+            const bool meshlets = d.meshletCount > 0u;
+            if (m_drawGroups.empty() || m_drawGroups.back().pass != d.pass || m_drawGroups.back().material.id != d.material.id ||
+                m_drawGroups.back().skinned != skinned || (m_drawGroups.back().meshletCount > 0u) != meshlets)
             {
-                std::memcpy(camFrame->activeSlotsMapped, m_activeSlots.data(), sizeof(uint32_t) * instanceCount);
-                camFrame->lastUploadedActiveSlotsVersion = m_activeSlotsVersion;
+                DrawGroup g{};
+                g.pass = d.pass;
+                g.material = d.material;
+                g.skinned = skinned;
+                g.textured = d.textured;
+                g.firstDraw = i;
+                g.firstMeshlet = meshletCursor;
+                m_drawGroups.push_back(g);
             }
+            m_drawGroups.back().drawCount += 1u;
+            m_drawGroups.back().meshletCount += d.meshletCount;
+            meshletCursor += d.meshletCount;
+        }
+    }
 
-            // Incremental per-slot uploads for active slots.
-            const auto *worldSrc = m_slotWorlds.data();
-            const auto *nodeSrc = m_nodePalette.data();
-            const auto *jointSrc = m_jointPalette.data();
+    void SModelRenderPassModule::fillPushConstants(PushConstantsModel &pc, const MaterialAsset &mat) const
+    {
+        std::memcpy(pc.model, m_pc.model, sizeof(pc.model));
+        std::memcpy(pc.baseColorFactor, mat.baseColorFactor, sizeof(pc.baseColorFactor));
+        pc.materialParams[0] = mat.alphaCutoff;
+        pc.materialParams[1] = static_cast<float>(mat.alphaMode);
+        pc.materialParams[2] = 0.0f;
+        pc.materialParams[3] = 0.0f;
+        pc.nodeCount = std::max<uint32_t>(m_slotNodeCount, 1u);
+        pc.jointPaletteStride = std::max<uint32_t>(m_slotJointCount, 1u);
+    }
 
-            auto *worldDstBytes = static_cast<uint8_t *>(camFrame->instanceWorldMapped);
-            auto *nodeDstBytes = static_cast<uint8_t *>(camFrame->paletteMapped);
-            auto *jointDstBytes = static_cast<uint8_t *>(camFrame->jointPaletteMapped);
+    void SModelRenderPassModule::bindBindlessSet(VkCommandBuffer cmd, VkPipelineLayout layout) const
+    {
+        // Same pipeline layout for every pipeline drawn with it: set 1 survives the pipeline and
+        // set-0 binds that follow (until a meshlet group switches layouts).
+        if (!m_bindless)
+            return;
+        VkDescriptorSet set = m_bindless->set();
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 1, 1, &set, 0, nullptr);
+    }
 
-            for (uint32_t i = 0; i < instanceCount; ++i)
-            {
-                const uint32_t slot = m_activeSlots[i];
-                if (slot >= slotCapacity)
-                    continue;
+    void SModelRenderPassModule::bindReceiverSet(VkCommandBuffer cmd, VkPipelineLayout layout) const
+    {
+        if (m_phaseFrame.receiverSet == VK_NULL_HANDLE)
+            return;
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 2, 1, &m_phaseFrame.receiverSet, 0, nullptr);
+    }
 
-                if (worldDstBytes && camFrame->uploadedTransformEpoch[slot] != m_slotTransformEpoch[slot])
-                {
-                    std::memcpy(worldDstBytes + static_cast<size_t>(slot) * sizeof(glm::mat4),
-                                &worldSrc[slot],
-                                sizeof(glm::mat4));
-                    camFrame->uploadedTransformEpoch[slot] = m_slotTransformEpoch[slot];
-                }
+    void SModelRenderPassModule::bindMaterial(VkCommandBuffer cmd, VkPipelineLayout layout, const DrawGroup &g, const MaterialAsset *mat, PushConstantsModel &pc)
+    {
+        if (m_bindless)
+        {
+            // Resolved per record rather than cached in the group: a material whose textures are
+            // still loading gets the fallback until they register.
+            pc.materialIndex = m_bindless->materialIndex(*m_assets, g.material);
+            return;
+        }
 
-                if (camFrame->uploadedPoseEpoch[slot] != m_slotPoseEpoch[slot])
-                {
-                    if (nodeDstBytes)
-                    {
-                        const size_t nodeBase = static_cast<size_t>(slot) * static_cast<size_t>(nodeCount);
-                        std::memcpy(nodeDstBytes + nodeBase * sizeof(glm::mat4),
-                                    nodeSrc + nodeBase,
-                                    sizeof(glm::mat4) * nodeCount);
-                    }
+        VkDescriptorSet matSet = getOrCreateMaterialSet(g.material, mat);
+        if (matSet != VK_NULL_HANDLE)
+        {
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 1, 1, &matSet, 0, nullptr);
+        }
+    }
 
-                    if (jointDstBytes)
-                    {
-                        const size_t jointBase = static_cast<size_t>(slot) * static_cast<size_t>(jointStride);
-                        std::memcpy(jointDstBytes + jointBase * sizeof(glm::mat4),
-                                    jointSrc + jointBase,
-                                    sizeof(glm::mat4) * jointStride);
-                    }
+    void SModelRenderPassModule::writeIndirectCommands(CameraFrame &frame, uint32_t instanceCount, bool gpuCounts)
+    {
+        // Commands + per-draw data change only with the draw list or the instance count (or when
+        // the cull shader last owned the instance counts).
+        if (frame.lastUploadedDrawListVersion == m_drawListVersion && frame.lastUploadedInstanceCount == instanceCount &&
+            frame.indirectGpuCounts == gpuCounts)
+            return;
 
-                    camFrame->uploadedPoseEpoch[slot] = m_slotPoseEpoch[slot];
-                }
-            }
+        const uint32_t drawCount = static_cast<uint32_t>(m_draws.size());
+        auto *cmds = static_cast<VkDrawIndexedIndirectCommand *>(frame.indirectMapped);
+        auto *drawData = static_cast<uint32_t *>(frame.drawDataMapped);
+        for (uint32_t i = 0; i < drawCount; ++i)
+        {
+            const StaticDraw &d = m_draws[i];
+            cmds[i].indexCount = d.indexCount;
+            cmds[i].instanceCount = instanceCount; // overwritten by smodel_cull.comp when gpuCounts
+            cmds[i].firstIndex = d.firstIndex;
+            cmds[i].vertexOffset = d.vertexOffset;
+            cmds[i].firstInstance = i * instanceCount; // decoded in smodel_indirect.vert
+
+            drawData[i * 4u + 0u] = d.nodeIndex;
+            drawData[i * 4u + 1u] = d.skinBaseJoint;
+            drawData[i * 4u + 2u] = d.skinJointCount;
+            drawData[i * 4u + 3u] = static_cast<uint32_t>(d.vertexOffset); // meshlet paths
         }
+        frame.lastUploadedDrawListVersion = m_drawListVersion;
+        frame.lastUploadedInstanceCount = instanceCount;
+        frame.indirectGpuCounts = gpuCounts;
+    }
 
-        // Pass ordering like glTF: 0=OPAQUE,1=MASK,2=BLEND
-        for (uint32_t pass = 0; pass < 3; ++pass)
+    void SModelRenderPassModule::recordIndirect(CameraFrame &frame, VkCommandBuffer cmd, uint32_t instanceCount, bool gpuCounts, RenderPhase phase)
+    {
+        const uint32_t drawCount = static_cast<uint32_t>(m_draws.size());
+        if (!ensureDrawDataCapacity(frame, drawCount) || !ensureIndirectCapacity(frame, drawCount))
         {
-            const Pipeline *pipe = nullptr;
-            if (pass == 0)
-                pipe = &m_pipelineOpaque;
-            else if (pass == 1)
-                pipe = &m_pipelineMask;
-            else
-                pipe = &m_pipelineBlend;
+            recordDirect(&frame, cmd, instanceCount, phase);
+            return;
+        }
 
-            pipe->bind(cmd);
+        writeIndirectCommands(frame, instanceCount, gpuCounts);
 
-            if (camFrame && camFrame->set != VK_NULL_HANDLE)
-            {
-                vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 0, 1, &camFrame->set, 0, nullptr);
-            }
+        // One VB/IB for the whole model (merged upload)
+        VkBuffer vb = m_draws[0].vertexBuffer;
+        VkDeviceSize vbOffset = 0;
+        vkCmdBindVertexBuffers(cmd, 0, 1, &vb, &vbOffset);
+        vkCmdBindIndexBuffer(cmd, m_draws[0].indexBuffer, 0, m_draws[0].indexType);
 
-            if (!model->nodes.empty())
+        bindBindlessSet(cmd, m_pipelineLayout);
+        bindReceiverSet(cmd, m_pipelineLayout);
+
+        // Meshlet groups: task/mesh shaders when available, else the commands appended by
+        // smodel_meshlet_cull.comp (GPU-culled frames only).
+        const bool meshletFrame = frame.meshletsPrepared && m_meshletDataVersion == m_drawListVersion;
+        const bool meshTasks = meshletFrame && m_meshShaderReady;
+        const bool meshletCommands = meshletFrame && frame.meshletCommands && gpuCounts;
+
+        const Pipeline *boundPipe = nullptr;
+        VkPipelineLayout boundLayout = m_pipelineLayout;
+        for (uint32_t gi = 0; gi < static_cast<uint32_t>(m_drawGroups.size()); ++gi)
+        {
+            const DrawGroup &g = m_drawGroups[gi];
+            const bool groupTasks = meshTasks && g.meshletCount > 0u && meshTasksFit(g, instanceCount);
+            const Pipeline *pipe = phasePipeline(phase, g, true, groupTasks);
+            if (!pipe)
+                continue;
+            MaterialAsset *mat = m_assets->getMaterial(g.material);
+            if (!mat)
+                continue;
+
+            const VkPipelineLayout layout = groupTasks ? m_meshPipelineLayout : m_pipelineLayout;
+            if (pipe != boundPipe)
             {
-                // Draw by nodes: push base model matrix + node index; vertex shader fetches node matrix from palette
-                const glm::mat4 baseM = glm::make_mat4(m_pc.model);
-                for (uint32_t nodeIndex = 0; nodeIndex < static_cast<uint32_t>(model->nodes.size()); ++nodeIndex)
+                pipe->bind(cmd);
+                vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 0, 1, &frame.set, 1, &frame.cameraOffset);
+                if (layout != boundLayout)
                 {
-                    const auto &node = model->nodes[nodeIndex];
+                    // The layouts differ in their push constant stages, so no set carries over.
+                    bindBindlessSet(cmd, layout);
+                    bindReceiverSet(cmd, layout);
+                    if (groupTasks)
+                        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 3, 1, &frame.meshletSet, 0, nullptr);
+                    boundLayout = layout;
+                }
+                boundPipe = pipe;
+            }
 
-                    for (uint32_t k = 0; k < node.primitiveCount; ++k)
-                    {
-                        const uint32_t primIndex = model->nodePrimitiveIndices[node.firstPrimitiveIndex + k];
-                        if (primIndex >= model->primitives.size())
-                            continue;
-                        const ModelPrimitive &prim = model->primitives[primIndex];
-
-                        MeshAsset *mesh = m_assets->getMesh(prim.mesh);
-                        MaterialAsset *mat = m_assets->getMaterial(prim.material);
-                        if (!mesh || !mat)
-                            continue;
-                        if (mat->alphaMode != pass)
-                            continue;
-
-                        VkDescriptorSet matSet = getOrCreateMaterialSet(prim.material, mat);
-                        if (matSet != VK_NULL_HANDLE)
-                        {
-                            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 1, 1, &matSet, 0, nullptr);
-                        }
+            PushConstantsModel pc{};
+            fillPushConstants(pc, *mat);
+            if (hasFragmentStage(phase, g))
+                bindMaterial(cmd, layout, g, mat, pc);
+            pc._pad0 = instanceCount; // nodeInfo.z: instances per draw
 
-                        PushConstantsModel pc{};
-                        std::memcpy(pc.model, glm::value_ptr(baseM), sizeof(pc.model));
-                        std::memcpy(pc.baseColorFactor, mat->baseColorFactor, sizeof(pc.baseColorFactor));
-                        pc.materialParams[0] = mat->alphaCutoff;
-                        pc.materialParams[1] = static_cast<float>(mat->alphaMode);
-                        pc.materialParams[2] = 0.0f;
-                        pc.materialParams[3] = 0.0f;
-                        pc.nodeIndex = nodeIndex;
-                        pc.nodeCount = nodeCount;
-
-                        // Skinning per-primitive
-                        pc.jointPaletteStride = jointStride;
-                        if (prim.skinIndex >= 0 && static_cast<uint32_t>(prim.skinIndex) < model->skins.size())
-                        {
-                            const auto &skin = model->skins[static_cast<uint32_t>(prim.skinIndex)];
-                            pc.skinBaseJoint = skin.jointBase;
-                            pc.skinJointCount = skin.jointCount;
-                        }
-                        else
-                        {
-                            pc.skinBaseJoint = 0;
-                            pc.skinJointCount = 0;
-                        }
-                        vkCmdPushConstants(cmd, m_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(PushConstantsModel), &pc);
+            if (groupTasks)
+            {
+                // smodel_meshlet.task: nodeInfo.x/skinInfo.x = the group's meshlets, skinInfo.w = GPU-culled.
+                pc.nodeIndex = g.firstMeshlet;
+                pc.skinBaseJoint = g.meshletCount;
+                pc.flags = gpuCounts ? 1u : 0u;
+                vkCmdPushConstants(cmd, layout, MESH_PUSH_STAGES, 0, sizeof(PushConstantsModel), &pc);
+                m_cmdDrawMeshTasks(cmd, (g.meshletCount + MESHLET_TASK_GROUP - 1u) / MESHLET_TASK_GROUP, instanceCount, 1);
+                DrawCallCounter::increment();
+                continue;
+            }
 
-                        VkBuffer vb = mesh->getVertexBuffer();
-                        VkBuffer ib = mesh->getIndexBuffer();
-                        if (vb == VK_NULL_HANDLE || ib == VK_NULL_HANDLE || prim.indexCount == 0)
-                            continue;
+            vkCmdPushConstants(cmd, m_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(PushConstantsModel), &pc);
 
-                        VkDeviceSize vbOffset = 0;
-                        vkCmdBindVertexBuffers(cmd, 0, 1, &vb, &vbOffset);
-                        vkCmdBindIndexBuffer(cmd, ib, 0, mesh->getIndexType());
+            if (meshletCommands && g.meshletCount > 0u)
+            {
+                // Up to meshletCount x instanceCount commands from g.firstMeshlet x instanceCount on.
+                const VkDeviceSize meshletOffset = static_cast<VkDeviceSize>(g.firstMeshlet) * instanceCount * sizeof(VkDrawIndexedIndirectCommand);
+                m_cmdDrawIndexedIndirectCount(cmd, frame.meshletCommandBuffer, meshletOffset, frame.groupCountBuffer, gi * sizeof(uint32_t),
+                                              g.meshletCount * instanceCount, sizeof(VkDrawIndexedIndirectCommand));
+                DrawCallCounter::increment();
+                continue;
+            }
 
-                        vkCmdDrawIndexed(cmd, prim.indexCount, instanceCount, prim.firstIndex, prim.vertexOffset, 0);
-                        DrawCallCounter::increment();
-                    }
-                }
+            const VkDeviceSize offset = static_cast<VkDeviceSize>(g.firstDraw) * sizeof(VkDrawIndexedIndirectCommand);
+            if (m_multiDrawIndirect)
+            {
+                vkCmdDrawIndexedIndirect(cmd, frame.indirectBuffer, offset, g.drawCount, sizeof(VkDrawIndexedIndirectCommand));
+                DrawCallCounter::increment();
             }
             else
             {
-                // Fallback: draw all primitives with base model matrix
-                const glm::mat4 baseM = glm::make_mat4(m_pc.model);
-                for (const ModelPrimitive &prim : model->primitives)
+                for (uint32_t k = 0; k < g.drawCount; ++k)
                 {
-                    MeshAsset *mesh = m_assets->getMesh(prim.mesh);
-                    MaterialAsset *mat = m_assets->getMaterial(prim.material);
-                    if (!mesh || !mat)
-                        continue;
-                    if (mat->alphaMode != pass)
-                        continue;
+                    vkCmdDrawIndexedIndirect(cmd, frame.indirectBuffer, offset + k * sizeof(VkDrawIndexedIndirectCommand), 1, sizeof(VkDrawIndexedIndirectCommand));
+                    DrawCallCounter::increment();
+                }
+            }
+        }
+    }
 
-                    VkDescriptorSet matSet = getOrCreateMaterialSet(prim.material, mat);
-                    if (matSet != VK_NULL_HANDLE)
-                    {
-                        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 1, 1, &matSet, 0, nullptr);
-                    }
+    void SModelRenderPassModule::recordDirect(CameraFrame *frame, VkCommandBuffer cmd, uint32_t instanceCount, RenderPhase phase)
+    {
+        const Pipeline *boundPipe = nullptr;
+        VkBuffer boundVB = VK_NULL_HANDLE;
+        VkBuffer boundIB = VK_NULL_HANDLE;
+        bindBindlessSet(cmd, m_pipelineLayout);
+        bindReceiverSet(cmd, m_pipelineLayout);
 
-                    PushConstantsModel pc{};
-                    std::memcpy(pc.model, glm::value_ptr(baseM), sizeof(pc.model));
-                    std::memcpy(pc.baseColorFactor, mat->baseColorFactor, sizeof(pc.baseColorFactor));
-                    pc.materialParams[0] = mat->alphaCutoff;
-                    pc.materialParams[1] = static_cast<float>(mat->alphaMode);
-                    pc.materialParams[2] = 0.0f;
-                    pc.materialParams[3] = 0.0f;
-                    pc.nodeIndex = 0;
-                    pc.nodeCount = nodeCount;
-
-                    pc.jointPaletteStride = jointStride;
-                    if (prim.skinIndex >= 0 && static_cast<uint32_t>(prim.skinIndex) < model->skins.size())
-                    {
-                        const auto &skin = model->skins[static_cast<uint32_t>(prim.skinIndex)];
-                        pc.skinBaseJoint = skin.jointBase;
-                        pc.skinJointCount = skin.jointCount;
-                    }
-                    else
-                    {
-                        pc.skinBaseJoint = 0;
-                        pc.skinJointCount = 0;
-                    }
-                    vkCmdPushConstants(cmd, m_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(PushConstantsModel), &pc);
+        for (const DrawGroup &g : m_drawGroups)
+        {
+            const Pipeline *pipe = phasePipeline(phase, g, false);
+            if (!pipe)
+                continue;
+            MaterialAsset *mat = m_assets->getMaterial(g.material);
+            if (!mat)
+                continue;
+
+            if (pipe != boundPipe)
+            {
+                pipe->bind(cmd);
+                if (frame && frame->set != VK_NULL_HANDLE)
+                {
+                    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 0, 1, &frame->set, 1, &frame->cameraOffset);
+                }
+                boundPipe = pipe;
+            }
 
-                    VkBuffer vb = mesh->getVertexBuffer();
-                    VkBuffer ib = mesh->getIndexBuffer();
-                    if (vb == VK_NULL_HANDLE || ib == VK_NULL_HANDLE || prim.indexCount == 0)
-                        continue;
+            PushConstantsModel pc{};
+            fillPushConstants(pc, *mat);
+            if (hasFragmentStage(phase, g))
+                bindMaterial(cmd, m_pipelineLayout, g, mat, pc);
 
-                    VkDeviceSize vbOffset = 0;
-                    vkCmdBindVertexBuffers(cmd, 0, 1, &vb, &vbOffset);
-                    vkCmdBindIndexBuffer(cmd, ib, 0, mesh->getIndexType());
+            for (uint32_t k = 0; k < g.drawCount; ++k)
+            {
+                const StaticDraw &d = m_draws[g.firstDraw + k];
 
-                    vkCmdDrawIndexed(cmd, prim.indexCount, instanceCount, prim.firstIndex, prim.vertexOffset, 0);
-                    DrawCallCounter::increment();
+                // Vertex shader fetches the node matrix from palette[slot][nodeIndex]
+                pc.nodeIndex = d.nodeIndex;
+                pc.skinBaseJoint = d.skinBaseJoint;
+                pc.skinJointCount = d.skinJointCount;
+                vkCmdPushConstants(cmd, m_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(PushConstantsModel), &pc);
+
+                // Merged models share one VB/IB: bind only when it changes
+                if (d.vertexBuffer != boundVB)
+                {
+                    VkDeviceSize vbOffset = 0;
+                    vkCmdBindVertexBuffers(cmd, 0, 1, &d.vertexBuffer, &vbOffset);
+                    boundVB = d.vertexBuffer;
+                }
+                if (d.indexBuffer != boundIB)
+                {
+                    vkCmdBindIndexBuffer(cmd, d.indexBuffer, 0, d.indexType);
+                    boundIB = d.indexBuffer;
                 }
+
+                vkCmdDrawIndexed(cmd, d.indexCount, instanceCount, d.firstIndex, d.vertexOffset, 0);
+                DrawCallCounter::increment();
             }
         }
     }
@@ -1731,23 +4216,80 @@ namespace Engine
         m_extent = newExtent;
     }
 
+    void SModelRenderPassModule::reportMemory(MemoryReport &out) const
+    {
+        uint64_t framePalettes = 0;
+        uint64_t frameBuffers = 0;
+        uint64_t cpu = 0;
+        for (const CameraFrame &f : m_cameraFrames)
+        {
+            framePalettes += f.paletteMemory.size + f.jointPaletteMemory.size;
+            frameBuffers += f.instanceWorldMemory.size + f.activeSlotsMemory.size +
+                            f.drawDataMemory.size + f.indirectMemory.size + f.boundsMemory.size +
+                            f.candidatesMemory.size + f.counterMemory.size + f.deltaMemory.size +
+                            f.poseInputMemory.size + f.meshletCullMemory.size + f.meshletCommandMemory.size +
+                            f.groupCountMemory.size + f.shadowSlotsMemory.size;
+            cpu += MemoryReport::bytesOf(f.uploadedTransformEpoch) + MemoryReport::bytesOf(f.uploadedPoseEpoch);
+        }
+
+        const uint64_t residentPalettes = m_resident.paletteMemory.size + m_resident.jointPaletteMemory.size;
+        uint64_t residentBuffers = m_resident.worldMemory.size + m_resident.boundsMemory.size + m_poseDataMemory.size +
+                                   m_meshletDataMemory.size;
+        for (const RetiredBuffer &r : m_retiredBuffers)
+            residentBuffers += r.memory.size;
+
+        cpu += MemoryReport::bytesOf(m_resident.uploadedTransformEpoch) + MemoryReport::bytesOf(m_resident.uploadedPoseEpoch) +
+               MemoryReport::bytesOf(m_activeSlots) + MemoryReport::bytesOf(m_slotWorlds) +
+               MemoryReport::bytesOf(m_slotTransformEpoch) + MemoryReport::bytesOf(m_slotBounds) +
+               MemoryReport::bytesOf(m_cpuCulledSlots) + MemoryReport::bytesOf(m_shadowSlots) + MemoryReport::bytesOf(m_slotPoseEpoch) +
+               MemoryReport::bytesOf(m_slotGpuPose) + MemoryReport::bytesOf(m_slotAnimations) +
+               MemoryReport::bytesOf(m_gpuPoseSlots) + MemoryReport::bytesOf(m_poseWords) + MemoryReport::bytesOf(m_meshletWords) +
+               MemoryReport::bytesOf(m_draws) + MemoryReport::bytesOf(m_drawGroups);
+        const uint64_t cpuPalettes = MemoryReport::bytesOf(m_nodePalette) + MemoryReport::bytesOf(m_jointPalette);
+
+        out.add("Render", "SModel palettes (per frame)", 0, framePalettes, 1);
+        out.add("Render", "SModel palettes (resident)", cpuPalettes, residentPalettes, 1);
+        out.add("Render", "SModel slot/draw buffers", cpu, frameBuffers + residentBuffers + m_fallbackWhiteTexture.getGpuBytes(), 1);
+    }
+
     void SModelRenderPassModule::destroyResources()
     {
         if (m_device == VK_NULL_HANDLE)
             return;
 
+        destroyCullResources();
+        destroyPoseResources();
+        destroyMeshletResources();
+        destroyResidentResources();
         destroyCameraResources();
         destroyMaterialResources();
 
-        m_pipelineOpaque.destroy(m_device);
-        m_pipelineMask.destroy(m_device);
-        m_pipelineBlend.destroy(m_device);
+        m_permutations.destroy(m_device);
+        destroyShadowPipelines();
+        m_shadowFailed = false;
+        m_indirectReady = false;
+        m_phaseFrame = PhaseFrame{};
+
+        m_draws.clear();
+        m_drawGroups.clear();
+        m_drawListModel = nullptr;
+        m_drawListPrimitiveCount = 0;
 
         if (m_pipelineLayout != VK_NULL_HANDLE)
         {
             vkDestroyPipelineLayout(m_device, m_pipelineLayout, nullptr);
             m_pipelineLayout = VK_NULL_HANDLE;
         }
+        if (m_meshPipelineLayout != VK_NULL_HANDLE)
+        {
+            vkDestroyPipelineLayout(m_device, m_meshPipelineLayout, nullptr);
+            m_meshPipelineLayout = VK_NULL_HANDLE;
+        }
+        if (m_receiverSetLayout != VK_NULL_HANDLE)
+        {
+            vkDestroyDescriptorSetLayout(m_device, m_receiverSetLayout, nullptr);
+            m_receiverSetLayout = VK_NULL_HANDLE;
+        }
 
         if (m_cameraSetLayout != VK_NULL_HANDLE)
         {
@@ -0,0 +1,587 @@
+#include "Engine/ShadowCascades.h"
+
+#include "Engine/Camera.h"
+#include "Engine/VulkanContext.h"
+#include "utils/BufferUtils.h"
+#include "utils/ImageUtils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Engine
+{
+    ShadowCascades::~ShadowCascades()
+    {
+        destroy();
+    }
+
+    void ShadowCascades::setLightDirection(const glm::vec3 &towardLight)
+    {
+        const float len = glm::length(towardLight);
+        if (!(len > 1e-6f))
+            return;
+        const glm::vec3 dir = towardLight / len;
+        if (dir == m_lightDir)
+            return;
+        m_lightDir = dir;
+        m_cachedMask = 0; // every static map was rendered along the old direction
+    }
+
+    void ShadowCascades::setDistance(float meters)
+    {
+        m_distance = std::max(meters, 1.0f);
+    }
+
+    void ShadowCascades::setCascadeCount(uint32_t count)
+    {
+        m_cascadeCount = std::min(std::max(count, 1u), MAX_CASCADES);
+    }
+
+    VkResult ShadowCascades::createReceiverSetLayout(VkDevice device, VkDescriptorSetLayout &outLayout)
+    {
+        VkDescriptorSetLayoutBinding bindings[3]{};
+        bindings[0].binding = 0;
+        bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        bindings[0].descriptorCount = 1;
+        bindings[0].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+        for (uint32_t i = 1; i < 3u; ++i)
+        {
+            bindings[i].binding = i;
+            bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            bindings[i].descriptorCount = 1;
+            bindings[i].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+        }
+
+        VkDescriptorSetLayoutCreateInfo info{};
+        info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        info.bindingCount = 3;
+        info.pBindings = bindings;
+        return vkCreateDescriptorSetLayout(device, &info, nullptr, &outLayout);
+    }
+
+    bool ShadowCascades::create(VulkanContext &ctx, uint32_t frameCount)
+    {
+        destroy();
+        m_device = ctx.GetDevice();
+        m_physicalDevice = ctx.GetPhysicalDevice();
+
+        // D16 is plenty for the short orthographic ranges; D32 where D16 can't be sampled.
+        m_format = VK_FORMAT_UNDEFINED;
+        bool linearFilter = false;
+        for (VkFormat candidate : {VK_FORMAT_D16_UNORM, VK_FORMAT_D32_SFLOAT})
+        {
+            VkFormatProperties props{};
+            vkGetPhysicalDeviceFormatProperties(m_physicalDevice, candidate, &props);
+            const VkFormatFeatureFlags needed = VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT;
+            if ((props.optimalTilingFeatures & needed) == needed)
+            {
+                m_format = candidate;
+                linearFilter = (props.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT) != 0;
+                break;
+            }
+        }
+        if (m_format == VK_FORMAT_UNDEFINED)
+            return false;
+
+        // Border = lit: receivers outside every cascade are never shadowed.
+        VkSamplerCreateInfo si{};
+        si.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        si.magFilter = linearFilter ? VK_FILTER_LINEAR : VK_FILTER_NEAREST;
+        si.minFilter = si.magFilter;
+        si.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+        si.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
+        si.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
+        si.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        si.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
+        si.compareEnable = VK_TRUE;
+        si.compareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+        si.maxLod = 0.0f;
+
+        const bool ok = createRenderPass() &&
+                        createDepthArray(m_static) &&
+                        createDepthArray(m_dynamic) &&
+                        vkCreateSampler(m_device, &si, nullptr, &m_sampler) == VK_SUCCESS &&
+                        createDescriptors(std::max(frameCount, 1u)) &&
+                        clearAllLayers(ctx);
+        if (!ok)
+        {
+            destroy();
+            return false;
+        }
+
+        m_cachedMask = 0;
+        m_dynamicDirty = false;
+        return true;
+    }
+
+    bool ShadowCascades::createRenderPass()
+    {
+        // Every draw clears its layer, so the old contents are never loaded.
+        VkAttachmentDescription depth{};
+        depth.format = m_format;
+        depth.samples = VK_SAMPLE_COUNT_1_BIT;
+        depth.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        depth.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        depth.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        depth.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        depth.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        depth.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        VkAttachmentReference depthRef{};
+        depthRef.attachment = 0;
+        depthRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+        VkSubpassDescription subpass{};
+        subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        subpass.pDepthStencilAttachment = &depthRef;
+
+        // In: earlier frames' receivers are done sampling the layer. Out: this frame's sample it.
+        VkSubpassDependency deps[2]{};
+        deps[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+        deps[0].dstSubpass = 0;
+        deps[0].srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        deps[0].srcAccessMask = 0;
+        deps[0].dstStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        deps[0].dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+        deps[1].srcSubpass = 0;
+        deps[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+        deps[1].srcStageMask = VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        deps[1].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        deps[1].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        deps[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+        VkRenderPassCreateInfo rp{};
+        rp.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+        rp.attachmentCount = 1;
+        rp.pAttachments = &depth;
+        rp.subpassCount = 1;
+        rp.pSubpasses = &subpass;
+        rp.dependencyCount = 2;
+        rp.pDependencies = deps;
+        return vkCreateRenderPass(m_device, &rp, nullptr, &m_renderPass) == VK_SUCCESS;
+    }
+
+    bool ShadowCascades::createDepthArray(DepthArray &arr)
+    {
+        VkImageCreateInfo ii{};
+        ii.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        ii.imageType = VK_IMAGE_TYPE_2D;
+        ii.extent = {m_resolution, m_resolution, 1};
+        ii.mipLevels = 1;
+        ii.arrayLayers = MAX_CASCADES;
+        ii.format = m_format;
+        ii.tiling = VK_IMAGE_TILING_OPTIMAL;
+        ii.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        ii.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+        ii.samples = VK_SAMPLE_COUNT_1_BIT;
+        ii.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        if (vkCreateImage(m_device, &ii, nullptr, &arr.image) != VK_SUCCESS)
+            return false;
+        if (AllocateImageMemory(m_device, m_physicalDevice, arr.image, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, arr.memory) != VK_SUCCESS)
+            return false;
+
+        VkImageViewCreateInfo vi{};
+        vi.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        vi.image = arr.image;
+        vi.viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+        vi.format = m_format;
+        vi.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+        vi.subresourceRange.baseMipLevel = 0;
+        vi.subresourceRange.levelCount = 1;
+        vi.subresourceRange.baseArrayLayer = 0;
+        vi.subresourceRange.layerCount = MAX_CASCADES;
+        if (vkCreateImageView(m_device, &vi, nullptr, &arr.arrayView) != VK_SUCCESS)
+            return false;
+
+        for (uint32_t layer = 0; layer < MAX_CASCADES; ++layer)
+        {
+            vi.viewType = VK_IMAGE_VIEW_TYPE_2D;
+            vi.subresourceRange.baseArrayLayer = layer;
+            vi.subresourceRange.layerCount = 1;
+            if (vkCreateImageView(m_device, &vi, nullptr, &arr.layerViews[layer]) != VK_SUCCESS)
+                return false;
+
+            VkFramebufferCreateInfo fi{};
+            fi.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+            fi.renderPass = m_renderPass;
+            fi.attachmentCount = 1;
+            fi.pAttachments = &arr.layerViews[layer];
+            fi.width = m_resolution;
+            fi.height = m_resolution;
+            fi.layers = 1;
+            if (vkCreateFramebuffer(m_device, &fi, nullptr, &arr.framebuffers[layer]) != VK_SUCCESS)
+                return false;
+        }
+        return true;
+    }
+
+    void ShadowCascades::destroyDepthArray(DepthArray &arr)
+    {
+        for (uint32_t layer = 0; layer < MAX_CASCADES; ++layer)
+        {
+            if (arr.framebuffers[layer] != VK_NULL_HANDLE)
+                vkDestroyFramebuffer(m_device, arr.framebuffers[layer], nullptr);
+            if (arr.layerViews[layer] != VK_NULL_HANDLE)
+                vkDestroyImageView(m_device, arr.layerViews[layer], nullptr);
+            arr.framebuffers[layer] = VK_NULL_HANDLE;
+            arr.layerViews[layer] = VK_NULL_HANDLE;
+        }
+        if (arr.arrayView != VK_NULL_HANDLE)
+            vkDestroyImageView(m_device, arr.arrayView, nullptr);
+        arr.arrayView = VK_NULL_HANDLE;
+        if (arr.image != VK_NULL_HANDLE)
+            vkDestroyImage(m_device, arr.image, nullptr);
+        arr.image = VK_NULL_HANDLE;
+        FreeGpuMemory(m_device, arr.memory);
+    }
+
+    bool ShadowCascades::createDescriptors(uint32_t frameCount)
+    {
+        VkDescriptorSetLayoutBinding casterBinding{};
+        casterBinding.binding = 0;
+        casterBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        casterBinding.descriptorCount = 1;
+        casterBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+        VkDescriptorSetLayoutCreateInfo dsl{};
+        dsl.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        dsl.bindingCount = 1;
+        dsl.pBindings = &casterBinding;
+        if (vkCreateDescriptorSetLayout(m_device, &dsl, nullptr, &m_casterSetLayout) != VK_SUCCESS)
+            return false;
+        if (createReceiverSetLayout(m_device, m_receiverSetLayout) != VK_SUCCESS)
+            return false;
+
+        // Per frame: caster set (UBO) + receiver set (UBO + two maps).
+        VkDescriptorPoolSize sizes[2]{};
+        sizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        sizes[0].descriptorCount = frameCount * 2u;
+        sizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        sizes[1].descriptorCount = frameCount * 2u;
+
+        VkDescriptorPoolCreateInfo pi{};
+        pi.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        pi.maxSets = frameCount * 2u;
+        pi.poolSizeCount = 2;
+        pi.pPoolSizes = sizes;
+        if (vkCreateDescriptorPool(m_device, &pi, nullptr, &m_pool) != VK_SUCCESS)
+            return false;
+
+        m_slots.resize(frameCount);
+        for (FrameSlot &slot : m_slots)
+        {
+            if (CreateBuffer(m_device, m_physicalDevice, sizeof(ShadowUBO), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, slot.buffer, slot.memory) != VK_SUCCESS ||
+                !slot.memory.mapped)
+                return false;
+            std::memset(slot.memory.mapped, 0, sizeof(ShadowUBO));
+
+            const VkDescriptorSetLayout layouts[2] = {m_casterSetLayout, m_receiverSetLayout};
+            VkDescriptorSet sets[2] = {};
+            VkDescriptorSetAllocateInfo ai{};
+            ai.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+            ai.descriptorPool = m_pool;
+            ai.descriptorSetCount = 2;
+            ai.pSetLayouts = layouts;
+            if (vkAllocateDescriptorSets(m_device, &ai, sets) != VK_SUCCESS)
+                return false;
+            slot.casterSet = sets[0];
+            slot.receiverSet = sets[1];
+
+            const VkDescriptorBufferInfo ubo{slot.buffer, 0, sizeof(ShadowUBO)};
+            const VkDescriptorImageInfo maps[2] = {
+                {m_sampler, m_static.arrayView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL},
+                {m_sampler, m_dynamic.arrayView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL},
+            };
+
+            VkWriteDescriptorSet writes[4]{};
+            for (uint32_t i = 0; i < 4u; ++i)
+            {
+                writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                writes[i].descriptorCount = 1;
+            }
+            writes[0].dstSet = slot.casterSet;
+            writes[0].dstBinding = 0;
+            writes[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            writes[0].pBufferInfo = &ubo;
+            writes[1].dstSet = slot.receiverSet;
+            writes[1].dstBinding = 0;
+            writes[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            writes[1].pBufferInfo = &ubo;
+            for (uint32_t i = 0; i < 2u; ++i)
+            {
+                writes[2 + i].dstSet = slot.receiverSet;
+                writes[2 + i].dstBinding = 1u + i;
+                writes[2 + i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+                writes[2 + i].pImageInfo = &maps[i];
+            }
+            vkUpdateDescriptorSets(m_device, 4, writes, 0, nullptr);
+        }
+        return true;
+    }
+
+    bool ShadowCascades::clearAllLayers(VulkanContext &ctx)
+    {
+        // Receivers sample every layer from the first frame on (unused cascades included).
+        VkCommandPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        poolInfo.queueFamilyIndex = ctx.GetGraphicsQueueFamilyIndex();
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+        VkCommandPool pool = VK_NULL_HANDLE;
+        if (vkCreateCommandPool(m_device, &poolInfo, nullptr, &pool) != VK_SUCCESS)
+            return false;
+
+        UploadContext upload{};
+        if (!BeginUploadContext(upload, m_device, m_physicalDevice, pool, ctx.GetGraphicsQueue()))
+        {
+            vkDestroyCommandPool(m_device, pool, nullptr);
+            return false;
+        }
+        for (DepthArray *arr : {&m_static, &m_dynamic})
+        {
+            for (uint32_t layer = 0; layer < MAX_CASCADES; ++layer)
+            {
+                VkClearValue clear{};
+                clear.depthStencil = {1.0f, 0};
+                VkRenderPassBeginInfo rb{};
+                rb.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+                rb.renderPass = m_renderPass;
+                rb.framebuffer = arr->framebuffers[layer];
+                rb.renderArea.extent = {m_resolution, m_resolution};
+                rb.clearValueCount = 1;
+                rb.pClearValues = &clear;
+                vkCmdBeginRenderPass(upload.cmd, &rb, VK_SUBPASS_CONTENTS_INLINE);
+                vkCmdEndRenderPass(upload.cmd);
+            }
+        }
+        const bool ok = EndSubmitAndWait(upload);
+        vkDestroyCommandPool(m_device, pool, nullptr);
+        return ok;
+    }
+
+    void ShadowCascades::destroy()
+    {
+        if (m_device == VK_NULL_HANDLE)
+            return;
+
+        for (FrameSlot &slot : m_slots)
+            DestroyBuffer(m_device, slot.buffer, slot.memory);
+        m_slots.clear();
+        if (m_pool != VK_NULL_HANDLE)
+            vkDestroyDescriptorPool(m_device, m_pool, nullptr);
+        m_pool = VK_NULL_HANDLE;
+        if (m_casterSetLayout != VK_NULL_HANDLE)
+            vkDestroyDescriptorSetLayout(m_device, m_casterSetLayout, nullptr);
+        m_casterSetLayout = VK_NULL_HANDLE;
+        if (m_receiverSetLayout != VK_NULL_HANDLE)
+            vkDestroyDescriptorSetLayout(m_device, m_receiverSetLayout, nullptr);
+        m_receiverSetLayout = VK_NULL_HANDLE;
+
+        if (m_sampler != VK_NULL_HANDLE)
+            vkDestroySampler(m_device, m_sampler, nullptr);
+        m_sampler = VK_NULL_HANDLE;
+        destroyDepthArray(m_static);
+        destroyDepthArray(m_dynamic);
+        if (m_renderPass != VK_NULL_HANDLE)
+            vkDestroyRenderPass(m_device, m_renderPass, nullptr);
+        m_renderPass = VK_NULL_HANDLE;
+
+        m_frame = ShadowFrame{};
+        m_cachedMask = 0;
+        m_device = VK_NULL_HANDLE;
+    }
+
+    void ShadowCascades::fitCascades()
+    {
+        m_frame.cascadeCount = 0;
+        if (!m_enabled || !m_camera || !created())
+            return;
+
+        const float nearPlane = std::max(m_camera->GetNear(), 0.01f);
+        const float farPlane = std::min(m_camera->GetFar(), m_distance);
+        if (!(farPlane > nearPlane))
+            return;
+
+        // Slice spheres depend on the frustum shape only: corners at depth z lie z*k off the axis.
+        const float tanY = std::tan(0.5f * m_camera->GetFOV());
+        const float tanX = tanY * m_camera->GetAspect();
+        const float k2 = tanX * tanX + tanY * tanY;
+
+        const glm::vec3 L = m_lightDir;
+        const glm::vec3 ref = std::abs(L.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+        const glm::vec3 right = glm::normalize(glm::cross(ref, L));
+        const glm::vec3 up = glm::cross(L, right);
+
+        const glm::vec3 camPos = m_camera->GetPosition();
+        const glm::vec3 forward = m_camera->GetForward();
+        const uint32_t count = m_cascadeCount;
+        const float res = static_cast<float>(m_resolution);
+        const float snapTexels = std::min(static_cast<float>(CACHE_SNAP_TEXELS), 0.25f * res);
+
+        auto splitDepth = [&](uint32_t i) -> float
+        {
+            const float t = static_cast<float>(i) / static_cast<float>(count);
+            const float logSplit = nearPlane * std::pow(farPlane / nearPlane, t);
+            const float uniformSplit = nearPlane + (farPlane - nearPlane) * t;
+            return SPLIT_LAMBDA * logSplit + (1.0f - SPLIT_LAMBDA) * uniformSplit;
+        };
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const float a = (i == 0u) ? nearPlane : splitDepth(i);
+            const float b = (i + 1u == count) ? farPlane : splitDepth(i + 1u);
+
+            // Minimal sphere around the slice: equidistant from its near and far corners.
+            float c = 0.5f * (a + b) * (1.0f + k2);
+            float radius = 0.0f;
+            if (c >= b)
+            {
+                c = b;
+                radius = b * std::sqrt(k2);
+            }
+            else
+            {
+                radius = std::sqrt((b - c) * (b - c) + b * b * k2);
+            }
+            // Quantized so float noise in the camera parameters never invalidates a cache.
+            radius = std::ceil(radius * 4.0f) * 0.25f;
+
+            // Grid step s of snapTexels texels at the padded radius P = radius + s.
+            const float step = 2.0f * snapTexels * radius / (res - 2.0f * snapTexels);
+            const float padded = radius + step;
+
+            const glm::vec3 center = camPos + forward * c;
+            CascadeKey key{};
+            key.x = static_cast<int64_t>(std::llround(glm::dot(right, center) / step));
+            key.y = static_cast<int64_t>(std::llround(glm::dot(up, center) / step));
+            key.z = static_cast<int64_t>(std::llround(glm::dot(L, center) / step));
+            key.radius = padded;
+            m_keys[i] = key;
+
+            const float cx = static_cast<float>(key.x) * step;
+            const float cy = static_cast<float>(key.y) * step;
+            const float cz = static_cast<float>(key.z) * step;
+            const float top = cz + padded + CASTER_EXTENT; // depth 0, toward the light
+            const float depthRange = 2.0f * padded + CASTER_EXTENT;
+
+            // Orthographic, zero-to-one depth: x/y = (basis . p - c) / P, z = (top - L . p) / range.
+            glm::mat4 m(0.0f);
+            m[0][0] = right.x / padded;
+            m[1][0] = right.y / padded;
+            m[2][0] = right.z / padded;
+            m[3][0] = -cx / padded;
+            m[0][1] = up.x / padded;
+            m[1][1] = up.y / padded;
+            m[2][1] = up.z / padded;
+            m[3][1] = -cy / padded;
+            m[0][2] = -L.x / depthRange;
+            m[1][2] = -L.y / depthRange;
+            m[2][2] = -L.z / depthRange;
+            m[3][2] = top / depthRange;
+            m[3][3] = 1.0f;
+
+            m_frame.viewProj[i] = m;
+            m_frame.invHalfExtent[i] = 1.0f / padded;
+            m_frame.invDepthRange[i] = 1.0f / depthRange;
+            m_texelWorld[i] = 2.0f * padded / res;
+        }
+        m_frame.cascadeCount = count;
+    }
+
+    const ShadowFrame &ShadowCascades::beginFrame(uint32_t frameIndex, uint64_t staticVersion, bool hasDynamic)
+    {
+        fitCascades();
+        m_frame.staticMask = 0;
+        m_frame.dynamic = false;
+        m_frame.receiverSet = VK_NULL_HANDLE;
+        if (m_slots.empty())
+            return m_frame;
+
+        FrameSlot &slot = m_slots[frameIndex % static_cast<uint32_t>(m_slots.size())];
+        m_frame.receiverSet = slot.receiverSet;
+
+        if (m_frame.cascadeCount > 0)
+        {
+            if (staticVersion != m_cachedStaticVersion)
+            {
+                m_cachedStaticVersion = staticVersion;
+                m_cachedMask = 0;
+            }
+            for (uint32_t i = 0; i < m_frame.cascadeCount; ++i)
+            {
+                if (!(m_cachedMask & (1u << i)) || m_cachedKeys[i] != m_keys[i])
+                    m_frame.staticMask |= 1u << i;
+            }
+
+            // Without dynamic casters the overlay is cleared once and then left alone.
+            m_frame.dynamic = hasDynamic || m_dynamicDirty;
+            m_dynamicDirty = hasDynamic;
+        }
+
+        ShadowUBO ubo{};
+        for (uint32_t i = 0; i < MAX_CASCADES; ++i)
+            ubo.viewProj[i] = m_frame.viewProj[i];
+        ubo.lightDir = glm::vec4(m_lightDir, static_cast<float>(m_frame.cascadeCount));
+        ubo.params = glm::vec4(1.0f / static_cast<float>(m_resolution), NORMAL_OFFSET_TEXELS, 0.0f, 0.0f);
+        ubo.texelWorld = glm::vec4(m_texelWorld[0], m_texelWorld[1], m_texelWorld[2], m_texelWorld[3]);
+        std::memcpy(slot.memory.mapped, &ubo, sizeof(ubo));
+        return m_frame;
+    }
+
+    ShadowCasterInfo ShadowCascades::beginCascade(VkCommandBuffer cmd, uint32_t frameIndex, uint32_t cascade, ShadowCaster layer)
+    {
+        ShadowCasterInfo info{};
+        info.renderPass = m_renderPass;
+        info.setLayout = m_casterSetLayout;
+        info.set = m_slots[frameIndex % static_cast<uint32_t>(m_slots.size())].casterSet;
+        info.viewProj = m_frame.viewProj[cascade];
+        info.cascade = cascade;
+        info.layer = layer;
+        info.extent = {m_resolution, m_resolution};
+        info.depthBiasConstant = DEPTH_BIAS_CONSTANT;
+        info.depthBiasSlope = DEPTH_BIAS_SLOPE;
+
+        const DepthArray &arr = layer == ShadowCaster::Static ? m_static : m_dynamic;
+        VkClearValue clear{};
+        clear.depthStencil = {1.0f, 0};
+        VkRenderPassBeginInfo rb{};
+        rb.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        rb.renderPass = m_renderPass;
+        rb.framebuffer = arr.framebuffers[cascade];
+        rb.renderArea.extent = info.extent;
+        rb.clearValueCount = 1;
+        rb.pClearValues = &clear;
+        vkCmdBeginRenderPass(cmd, &rb, VK_SUBPASS_CONTENTS_INLINE);
+
+        const VkViewport vp{0.0f, 0.0f, static_cast<float>(m_resolution), static_cast<float>(m_resolution), 0.0f, 1.0f};
+        const VkRect2D sc{{0, 0}, info.extent};
+        vkCmdSetViewport(cmd, 0, 1, &vp);
+        vkCmdSetScissor(cmd, 0, 1, &sc);
+
+        if (layer == ShadowCaster::Static)
+            m_stats.staticRedraws += 1u;
+        else
+            m_stats.dynamicRedraws += 1u;
+        return info;
+    }
+
+    void ShadowCascades::endCascade(VkCommandBuffer cmd)
+    {
+        vkCmdEndRenderPass(cmd);
+    }
+
+    void ShadowCascades::markStaticDrawn(uint32_t staticMask)
+    {
+        for (uint32_t i = 0; i < MAX_CASCADES; ++i)
+        {
+            if (staticMask & (1u << i))
+            {
+                m_cachedKeys[i] = m_keys[i];
+                m_cachedMask |= 1u << i;
+            }
+        }
+    }
+} // namespace Engine
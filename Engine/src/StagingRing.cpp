@@ -0,0 +1,234 @@
+#include "utils/StagingRing.h"
+
+namespace Engine
+{
+    static VkDeviceSize alignUp(VkDeviceSize v, VkDeviceSize alignment)
+    {
+        return (alignment > 1) ? ((v + alignment - 1) & ~(alignment - 1)) : v;
+    }
+
+    VkResult StagingRing::create(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize capacity,
+                                 uint32_t queueFamilyCount, const uint32_t *queueFamilies)
+    {
+        destroy();
+        if (capacity == 0)
+            return VK_ERROR_INITIALIZATION_FAILED;
+
+        VkBufferCreateInfo bi{};
+        bi.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        bi.size = capacity;
+        bi.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+        bi.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        if (queueFamilyCount >= 2 && queueFamilies)
+        {
+            bi.sharingMode = VK_SHARING_MODE_CONCURRENT;
+            bi.queueFamilyIndexCount = queueFamilyCount;
+            bi.pQueueFamilyIndices = queueFamilies;
+        }
+
+        VkResult r = vkCreateBuffer(device, &bi, nullptr, &m_buffer);
+        if (r != VK_SUCCESS)
+            return r;
+
+        r = AllocateBufferMemory(device, physicalDevice, m_buffer,
+                                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_memory);
+        if (r != VK_SUCCESS || !m_memory.mapped)
+        {
+            FreeGpuMemory(device, m_memory);
+            vkDestroyBuffer(device, m_buffer, nullptr);
+            m_buffer = VK_NULL_HANDLE;
+            return (r != VK_SUCCESS) ? r : VkResult(VK_ERROR_MEMORY_MAP_FAILED);
+        }
+
+        m_device = device;
+        m_mapped = static_cast<uint8_t *>(m_memory.mapped);
+        m_capacity = capacity;
+        m_head = m_tail = 0;
+        m_empty = true;
+        m_openUsed = false;
+        return VK_SUCCESS;
+    }
+
+    void StagingRing::destroy()
+    {
+        if (m_device == VK_NULL_HANDLE)
+            return;
+
+        for (const Region &r : m_inFlight)
+            vkWaitForFences(m_device, 1, &r.fence, VK_TRUE, UINT64_MAX);
+        for (const Region &r : m_inFlight)
+            vkDestroyFence(m_device, r.fence, nullptr);
+        for (VkFence f : m_freeFences)
+            vkDestroyFence(m_device, f, nullptr);
+        m_inFlight.clear();
+        m_freeFences.clear();
+
+        if (m_buffer != VK_NULL_HANDLE)
+            vkDestroyBuffer(m_device, m_buffer, nullptr);
+        FreeGpuMemory(m_device, m_memory);
+
+        m_device = VK_NULL_HANDLE;
+        m_buffer = VK_NULL_HANDLE;
+        m_mapped = nullptr;
+        m_capacity = 0;
+        m_head = m_tail = 0;
+        m_empty = true;
+        m_openUsed = false;
+    }
+
+    bool StagingRing::tryPlace(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize &outOffset) const
+    {
+        if (m_empty)
+        {
+            outOffset = 0;
+            return size <= m_capacity;
+        }
+        if (m_head == m_tail)
+            return false; // full
+
+        const VkDeviceSize start = alignUp(m_head, alignment);
+        if (m_head > m_tail)
+        {
+            // Free space: [head, capacity) then [0, tail).
+            if (start + size <= m_capacity)
+            {
+                outOffset = start;
+                return true;
+            }
+            if (size <= m_tail)
+            {
+                outOffset = 0;
+                return true;
+            }
+            return false;
+        }
+
+        // Wrapped: free space is [head, tail).
+        if (start + size <= m_tail)
+        {
+            outOffset = start;
+            return true;
+        }
+        return false;
+    }
+
+    bool StagingRing::allocate(VkDeviceSize size, VkDeviceSize alignment, Allocation &out)
+    {
+        if (!valid() || size == 0 || size > m_capacity)
+            return false;
+
+        // Past the point where the last region could still be taken back.
+        m_cancelable = false;
+
+        retire();
+
+        VkDeviceSize offset = 0;
+        while (!tryPlace(size, alignment, offset))
+        {
+            // Only the unsubmitted region is left: waiting would never free anything.
+            if (m_inFlight.empty())
+                return false;
+
+            const VkFence oldest = m_inFlight.front().fence;
+            vkWaitForFences(m_device, 1, &oldest, VK_TRUE, UINT64_MAX);
+            popOldest();
+        }
+
+        if (!m_openUsed)
+        {
+            m_openUsed = true;
+            m_openBegin = offset;
+            if (m_empty)
+                m_tail = offset;
+        }
+        m_head = offset + size;
+        m_empty = false;
+
+        out.buffer = m_buffer;
+        out.offset = offset;
+        out.mapped = m_mapped + offset;
+        return true;
+    }
+
+    VkFence StagingRing::beginSubmit()
+    {
+        if (!m_openUsed)
+            return VK_NULL_HANDLE;
+
+        const VkFence fence = acquireFence();
+        if (fence == VK_NULL_HANDLE)
+            return VK_NULL_HANDLE;
+
+        m_inFlight.push_back(Region{m_openBegin, m_head, fence});
+        m_openUsed = false;
+        m_cancelable = true;
+        return fence;
+    }
+
+    void StagingRing::cancelSubmit()
+    {
+        if (!m_cancelable || m_inFlight.empty())
+            return;
+        m_cancelable = false;
+
+        const Region r = m_inFlight.back();
+        m_inFlight.pop_back();
+        m_freeFences.push_back(r.fence);
+
+        if (m_inFlight.empty())
+        {
+            m_head = m_tail = 0;
+            m_empty = true;
+        }
+        else
+        {
+            m_head = r.begin;
+        }
+    }
+
+    void StagingRing::retire()
+    {
+        while (!m_inFlight.empty() && vkGetFenceStatus(m_device, m_inFlight.front().fence) == VK_SUCCESS)
+            popOldest();
+    }
+
+    void StagingRing::popOldest()
+    {
+        if (m_inFlight.size() == 1u)
+            m_cancelable = false;
+        m_freeFences.push_back(m_inFlight.front().fence);
+        m_inFlight.pop_front();
+
+        if (!m_inFlight.empty())
+        {
+            m_tail = m_inFlight.front().begin;
+        }
+        else if (m_openUsed)
+        {
+            m_tail = m_openBegin;
+        }
+        else
+        {
+            m_head = m_tail = 0;
+            m_empty = true;
+        }
+    }
+
+    VkFence StagingRing::acquireFence()
+    {
+        if (!m_freeFences.empty())
+        {
+            const VkFence fence = m_freeFences.back();
+            m_freeFences.pop_back();
+            vkResetFences(m_device, 1, &fence);
+            return fence;
+        }
+
+        VkFenceCreateInfo fi{};
+        fi.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        VkFence fence = VK_NULL_HANDLE;
+        if (vkCreateFence(m_device, &fi, nullptr, &fence) != VK_SUCCESS)
+            return VK_NULL_HANDLE;
+        return fence;
+    }
+}
@@ -0,0 +1,1932 @@
+#include "Engine/StaticPropRenderPassModule.h"
+#include "Engine/VulkanContext.h"
+#include "Engine/BindlessMaterials.h"
+#include "Engine/SwapChain.h"
+#include "Engine/PerformanceMonitor.h"
+#include "Engine/Frustum.h"
+#include "assets/ModelAsset.h"
+#include "assets/MeshAsset.h"
+#include "assets/MaterialAsset.h"
+#include "assets/model/SModelPackedVertex.h"
+#include "utils/BufferUtils.h"
+#include "utils/ImageUtils.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
+#include <iostream>
+#endif
+
+namespace Engine
+{
+    // Cell coordinates are packed as two biased 16-bit values: +/- 32768 cells on each axis.
+    static uint32_t cellKey(const glm::vec3 &p)
+    {
+        const int32_t cx = static_cast<int32_t>(std::floor(p.x / StaticPropRenderPassModule::CELL_SIZE));
+        const int32_t cz = static_cast<int32_t>(std::floor(p.z / StaticPropRenderPassModule::CELL_SIZE));
+        const uint32_t ux = static_cast<uint32_t>(std::clamp(cx + 32768, 0, 65535));
+        const uint32_t uz = static_cast<uint32_t>(std::clamp(cz + 32768, 0, 65535));
+        return (ux << 16) | uz;
+    }
+
+    StaticPropRenderPassModule::~StaticPropRenderPassModule()
+    {
+        // resources freed in onDestroy
+    }
+
+    void StaticPropRenderPassModule::setFadeDistances(float start, float end)
+    {
+        m_fadeStart = std::max(start, 0.0f);
+        m_fadeEnd = std::max(end, m_fadeStart + 0.01f);
+    }
+
+    void StaticPropRenderPassModule::setImpostorDistance(float start, float blend)
+    {
+        m_impostorStart = std::max(start, 0.0f);
+        m_impostorBlend = std::max(blend, 0.01f);
+    }
+
+    void StaticPropRenderPassModule::setInstance(uint32_t index, const glm::mat4 &world, const glm::vec3 &worldCenter, float worldRadius)
+    {
+        if (index >= m_instances.size())
+        {
+            GpuInstance removed{};
+            removed.world = glm::mat4(1.0f);
+            removed.sphere = glm::vec4(0.0f, 0.0f, 0.0f, -1.0f);
+            m_instances.resize(static_cast<size_t>(index) + 1u, removed);
+        }
+
+        GpuInstance &inst = m_instances[index];
+        if (inst.sphere.w < 0.0f)
+            m_liveInstances += 1u;
+        inst.world = world;
+        inst.sphere = glm::vec4(worldCenter, std::max(worldRadius, 0.0f));
+        m_instancesDirty = true;
+    }
+
+    void StaticPropRenderPassModule::removeInstance(uint32_t index)
+    {
+        if (index >= m_instances.size() || m_instances[index].sphere.w < 0.0f)
+            return;
+        m_instances[index].sphere.w = -1.0f;
+        m_liveInstances -= 1u;
+        m_instancesDirty = true;
+
+        // Keep the table dense at the top so a cleared level drops its instances entirely.
+        while (!m_instances.empty() && m_instances.back().sphere.w < 0.0f)
+            m_instances.pop_back();
+    }
+
+    void StaticPropRenderPassModule::onCreate(VulkanContext &ctx, VkRenderPass pass, const std::vector<VkFramebuffer> &fbs)
+    {
+        m_device = ctx.GetDevice();
+        m_physicalDevice = ctx.GetPhysicalDevice();
+        m_pipelineCache = ctx.GetPipelineCache();
+        m_extent = ctx.GetSwapChain() ? ctx.GetSwapChain()->GetExtent() : VkExtent2D{};
+
+        m_queueFamilyCount = 0;
+        if (ctx.HasAsyncCompute())
+        {
+            m_queueFamilies[0] = ctx.GetGraphicsQueueFamilyIndex();
+            m_queueFamilies[1] = ctx.GetComputeQueueFamilyIndex();
+            m_queueFamilyCount = 2;
+        }
+
+        const size_t frameCount = fbs.size();
+        if (!createFrameResources(ctx, frameCount > 0 ? frameCount : 1))
+        {
+            throw std::runtime_error("StaticPropRenderPassModule: failed to create frame resources");
+        }
+
+        m_bindless = ctx.GetBindlessMaterials();
+        if (!m_bindless && !createMaterialResources(ctx))
+        {
+            throw std::runtime_error("StaticPropRenderPassModule: failed to create material resources");
+        }
+
+        createPipelines(ctx, pass);
+
+        m_impostorReady = createImpostorResources(ctx, pass);
+        if (!m_impostorReady)
+        {
+            destroyImpostorResources();
+#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
+            std::cerr << "[StaticProps] staticprop_impostor shaders unavailable; far props draw full meshes\n";
+#endif
+        }
+
+        m_cullReady = createCullResources(ctx);
+        if (!m_cullReady)
+        {
+            destroyCullResources();
+#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
+            std::cerr << "[StaticProps] staticprop_cull.comp.spv unavailable; static props are not drawn\n";
+#endif
+        }
+    }
+
+    bool StaticPropRenderPassModule::createFrameResources(VulkanContext &ctx, size_t frameCount)
+    {
+        destroyFrameResources();
+
+        // Draw set: camera UBO (the impostor fragment shader projects its depth), instances,
+        // visible ids, impostor ids
+        VkDescriptorSetLayoutBinding bindings[4]{};
+        bindings[0].binding = 0;
+        bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+        bindings[0].descriptorCount = 1;
+        bindings[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+        for (uint32_t i = 1; i < 4u; ++i)
+        {
+            bindings[i].binding = i;
+            bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            bindings[i].descriptorCount = 1;
+            bindings[i].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        }
+
+        VkDescriptorSetLayoutCreateInfo dsl{};
+        dsl.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        dsl.bindingCount = 4;
+        dsl.pBindings = bindings;
+        if (vkCreateDescriptorSetLayout(ctx.GetDevice(), &dsl, nullptr, &m_drawSetLayout) != VK_SUCCESS)
+            return false;
+
+        // Shadow set: instances, cell-sorted instance ids (staticprop_shadow.vert)
+        VkDescriptorSetLayoutBinding shadowBindings[2] = {bindings[1], bindings[2]};
+        shadowBindings[0].binding = 0;
+        shadowBindings[1].binding = 1;
+        dsl.bindingCount = 2;
+        dsl.pBindings = shadowBindings;
+        if (vkCreateDescriptorSetLayout(ctx.GetDevice(), &dsl, nullptr, &m_shadowSetLayout) != VK_SUCCESS)
+            return false;
+
+        // Per frame: the draw set (1 dynamic UBO + 3 SSBOs), the cull set (7 SSBOs) and the shadow
+        // set (2 SSBOs).
+        const uint32_t frames = static_cast<uint32_t>(frameCount);
+        VkDescriptorPoolSize poolSizes[2]{};
+        poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+        poolSizes[0].descriptorCount = frames;
+        poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        poolSizes[1].descriptorCount = frames * 12u;
+
+        VkDescriptorPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.maxSets = frames * 3u;
+        poolInfo.poolSizeCount = 2;
+        poolInfo.pPoolSizes = poolSizes;
+        if (vkCreateDescriptorPool(ctx.GetDevice(), &poolInfo, nullptr, &m_framePool) != VK_SUCCESS)
+            return false;
+
+        std::vector<VkDescriptorSetLayout> layouts(frameCount, m_drawSetLayout);
+        std::vector<VkDescriptorSet> sets(frameCount, VK_NULL_HANDLE);
+        VkDescriptorSetAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = m_framePool;
+        allocInfo.descriptorSetCount = frames;
+        allocInfo.pSetLayouts = layouts.data();
+        if (vkAllocateDescriptorSets(ctx.GetDevice(), &allocInfo, sets.data()) != VK_SUCCESS)
+            return false;
+
+        std::vector<VkDescriptorSetLayout> shadowLayouts(frameCount, m_shadowSetLayout);
+        std::vector<VkDescriptorSet> shadowSets(frameCount, VK_NULL_HANDLE);
+        allocInfo.pSetLayouts = shadowLayouts.data();
+        if (vkAllocateDescriptorSets(ctx.GetDevice(), &allocInfo, shadowSets.data()) != VK_SUCCESS)
+            return false;
+
+        m_frames.resize(frameCount);
+        for (size_t i = 0; i < frameCount; ++i)
+        {
+            FrameData &f = m_frames[i];
+            f.drawSet = sets[i];
+            f.shadowSet = shadowSets[i];
+
+            // Mesh and impostor visible counts
+            if (CreateDeviceLocalBuffer(ctx.GetDevice(), ctx.GetPhysicalDevice(), sizeof(uint32_t) * 2u,
+                                        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, f.counterBuffer, f.counterMemory,
+                                        m_queueFamilyCount, m_queueFamilies) != VK_SUCCESS)
+                return false;
+
+            // Binding 0 is written by allocateCameraUBO(), bindings 1-3 by bindFrameSets() once
+            // the buffers exist.
+            f.cameraRingBuffer = VK_NULL_HANDLE;
+            f.boundGeneration = 0;
+        }
+        return true;
+    }
+
+    void StaticPropRenderPassModule::destroyFrameResources()
+    {
+        for (FrameData &f : m_frames)
+        {
+            f.cameraMapped = nullptr;
+            f.indirectMapped = nullptr;
+            DestroyBuffer(m_device, f.visibleBuffer, f.visibleMemory);
+            DestroyBuffer(m_device, f.impostorVisibleBuffer, f.impostorVisibleMemory);
+            DestroyBuffer(m_device, f.indirectBuffer, f.indirectMemory);
+            DestroyBuffer(m_device, f.counterBuffer, f.counterMemory);
+        }
+        m_frames.clear();
+
+        if (m_framePool != VK_NULL_HANDLE)
+        {
+            vkDestroyDescriptorPool(m_device, m_framePool, nullptr);
+            m_framePool = VK_NULL_HANDLE;
+        }
+        if (m_drawSetLayout != VK_NULL_HANDLE)
+        {
+            vkDestroyDescriptorSetLayout(m_device, m_drawSetLayout, nullptr);
+            m_drawSetLayout = VK_NULL_HANDLE;
+        }
+        if (m_shadowSetLayout != VK_NULL_HANDLE)
+        {
+            vkDestroyDescriptorSetLayout(m_device, m_shadowSetLayout, nullptr);
+            m_shadowSetLayout = VK_NULL_HANDLE;
+        }
+    }
+
+    bool StaticPropRenderPassModule::createMaterialResources(VulkanContext &ctx)
+    {
+        destroyMaterialResources();
+
+        // Without descriptor indexing: one baseColor sampler set per material (smodel.frag style).
+        VkDescriptorSetLayoutBinding baseColorBinding{};
+        baseColorBinding.binding = 0;
+        baseColorBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        baseColorBinding.descriptorCount = 1;
+        baseColorBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+        VkDescriptorSetLayoutCreateInfo dsl{};
+        dsl.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        dsl.bindingCount = 1;
+        dsl.pBindings = &baseColorBinding;
+        if (vkCreateDescriptorSetLayout(ctx.GetDevice(), &dsl, nullptr, &m_materialSetLayout) != VK_SUCCESS)
+            return false;
+
+        // Fallback 1x1 white texture (sRGB)
+        {
+            VkCommandPoolCreateInfo poolInfo{};
+            poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+            poolInfo.queueFamilyIndex = ctx.GetGraphicsQueueFamilyIndex();
+            poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+            VkCommandPool uploadPool = VK_NULL_HANDLE;
+            if (vkCreateCommandPool(ctx.GetDevice(), &poolInfo, nullptr, &uploadPool) != VK_SUCCESS)
+                return false;
+
+            UploadContext upload{};
+            if (!BeginUploadContext(upload, ctx.GetDevice(), ctx.GetPhysicalDevice(), uploadPool, ctx.GetGraphicsQueue()))
+            {
+                vkDestroyCommandPool(ctx.GetDevice(), uploadPool, nullptr);
+                return false;
+            }
+
+            const uint8_t white[4] = {255, 255, 255, 255};
+            const bool ok = m_fallbackWhiteTexture.uploadRGBA8_Deferred(
+                upload, white, 1, 1, true,
+                VK_SAMPLER_ADDRESS_MODE_REPEAT, VK_SAMPLER_ADDRESS_MODE_REPEAT,
+                VK_FILTER_LINEAR, VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_NEAREST, 1.0f);
+
+            const bool submitted = ok && EndSubmitAndWait(upload);
+            vkDestroyCommandPool(ctx.GetDevice(), uploadPool, nullptr);
+            if (!submitted)
+                return false;
+        }
+
+        // Props have few materials; the pool is sized for a handful of models' worth.
+        constexpr uint32_t kMaterialSets = 64;
+        VkDescriptorPoolSize poolSize{};
+        poolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        poolSize.descriptorCount = kMaterialSets;
+
+        VkDescriptorPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.maxSets = kMaterialSets;
+        poolInfo.poolSizeCount = 1;
+        poolInfo.pPoolSizes = &poolSize;
+        if (vkCreateDescriptorPool(ctx.GetDevice(), &poolInfo, nullptr, &m_materialPool) != VK_SUCCESS)
+            return false;
+
+        m_materialSetCache.clear();
+        return true;
+    }
+
+    void StaticPropRenderPassModule::destroyMaterialResources()
+    {
+        m_materialSetCache.clear();
+
+        if (m_materialPool != VK_NULL_HANDLE)
+        {
+            vkDestroyDescriptorPool(m_device, m_materialPool, nullptr);
+            m_materialPool = VK_NULL_HANDLE;
+        }
+        if (m_materialSetLayout != VK_NULL_HANDLE)
+        {
+            vkDestroyDescriptorSetLayout(m_device, m_materialSetLayout, nullptr);
+            m_materialSetLayout = VK_NULL_HANDLE;
+        }
+        if (m_device != VK_NULL_HANDLE && m_fallbackWhiteTexture.isValid())
+            m_fallbackWhiteTexture.destroy(m_device);
+    }
+
+    VkDescriptorSet StaticPropRenderPassModule::getOrCreateMaterialSet(MaterialHandle h, const MaterialAsset *mat)
+    {
+        if (!h.isValid() || !mat || m_materialPool == VK_NULL_HANDLE)
+            return VK_NULL_HANDLE;
+
+        const uint32_t epoch = m_assets ? m_assets->textureViewEpoch() : 0u;
+        auto it = m_materialSetCache.find(h.id);
+        if (it != m_materialSetCache.end())
+        {
+            // A texture's view was replaced since the write: no earlier frame is still pending
+            // (the swap waited for the GPU), so the set is rewritten in place.
+            if (it->second.textureEpoch != epoch)
+            {
+                writeMaterialSet(it->second.set, mat);
+                it->second.textureEpoch = epoch;
+            }
+            return it->second.set;
+        }
+
+        VkDescriptorSetAllocateInfo alloc{};
+        alloc.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        alloc.descriptorPool = m_materialPool;
+        alloc.descriptorSetCount = 1;
+        alloc.pSetLayouts = &m_materialSetLayout;
+
+        VkDescriptorSet set = VK_NULL_HANDLE;
+        if (vkAllocateDescriptorSets(m_device, &alloc, &set) != VK_SUCCESS)
+            return VK_NULL_HANDLE;
+
+        writeMaterialSet(set, mat);
+
+        m_materialSetCache.emplace(h.id, CachedMaterialSet{set, epoch});
+        return set;
+    }
+
+    void StaticPropRenderPassModule::writeMaterialSet(VkDescriptorSet set, const MaterialAsset *mat)
+    {
+        VkImageView view = m_fallbackWhiteTexture.getView();
+        VkSampler sampler = m_fallbackWhiteTexture.getSampler();
+        if (mat->baseColorTexture.isValid() && m_assets)
+        {
+            if (TextureAsset *tex = m_assets->getTexture(mat->baseColorTexture))
+            {
+                if (tex->getView() != VK_NULL_HANDLE && tex->getSampler() != VK_NULL_HANDLE)
+                {
+                    view = tex->getView();
+                    sampler = tex->getSampler();
+                }
+            }
+        }
+
+        VkDescriptorImageInfo di{};
+        di.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        di.imageView = view;
+        di.sampler = sampler;
+
+        VkWriteDescriptorSet write{};
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = set;
+        write.dstBinding = 0;
+        write.dstArrayElement = 0;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        write.descriptorCount = 1;
+        write.pImageInfo = &di;
+        vkUpdateDescriptorSets(m_device, 1, &write, 0, nullptr);
+    }
+
+    void StaticPropRenderPassModule::createPipelines(VulkanContext &ctx, VkRenderPass pass)
+    {
+        const VkDescriptorSetLayout materialLayout = m_bindless ? m_bindless->layout() : m_materialSetLayout;
+        if (m_drawSetLayout == VK_NULL_HANDLE || materialLayout == VK_NULL_HANDLE)
+        {
+            throw std::runtime_error("StaticPropRenderPassModule: descriptor set layouts not created");
+        }
+        if (m_receiverSetLayout == VK_NULL_HANDLE &&
+            ShadowCascades::createReceiverSetLayout(ctx.GetDevice(), m_receiverSetLayout) != VK_SUCCESS)
+        {
+            throw std::runtime_error("StaticPropRenderPassModule: failed to create shadow receiver set layout");
+        }
+
+        VkPushConstantRange pcRange{};
+        pcRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+        pcRange.offset = 0;
+        pcRange.size = sizeof(PushConstantsProp);
+
+        VkDescriptorSetLayout setLayouts[3] = {m_drawSetLayout, materialLayout, m_receiverSetLayout};
+        VkPipelineLayoutCreateInfo plInfo{};
+        plInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        plInfo.setLayoutCount = 3;
+        plInfo.pSetLayouts = setLayouts;
+        plInfo.pushConstantRangeCount = 1;
+        plInfo.pPushConstantRanges = &pcRange;
+        if (vkCreatePipelineLayout(ctx.GetDevice(), &plInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS)
+        {
+            throw std::runtime_error("StaticPropRenderPassModule: failed to create pipeline layout");
+        }
+
+        PipelineCreateInfo pci{};
+        pci.device = ctx.GetDevice();
+        pci.pipelineCache = ctx.GetPipelineCache();
+        pci.renderPass = pass;
+        pci.subpass = 0;
+        pci.pipelineLayout = m_pipelineLayout;
+
+        VkShaderModule vert = Pipeline::createShaderModuleFromFile(pci.device, "shaders/staticprop.vert.spv");
+        VkShaderModule frag = Pipeline::createShaderModuleFromFile(pci.device, m_bindless ? "shaders/staticprop_bindless.frag.spv" : "shaders/staticprop.frag.spv");
+        if (vert == VK_NULL_HANDLE || frag == VK_NULL_HANDLE)
+        {
+            throw std::runtime_error("StaticPropRenderPassModule: failed to load shader modules (staticprop.vert/frag.spv)");
+        }
+
+        VkPipelineShaderStageCreateInfo vs{};
+        vs.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        vs.stage = VK_SHADER_STAGE_VERTEX_BIT;
+        vs.module = vert;
+        vs.pName = "main";
+
+        VkPipelineShaderStageCreateInfo fs{};
+        fs.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        fs.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+        fs.module = frag;
+        fs.pName = "main";
+
+        pci.shaderStages = {vs, fs};
+
+        // Same SModelPackedVertex buffers as SModel (36 bytes); props read position, normal and uv only.
+        std::array<VkVertexInputBindingDescription, 1> bindingDescs{};
+        bindingDescs[0].binding = 0;
+        bindingDescs[0].stride = smodel::SMODEL_PACKED_VERTEX_STRIDE;
+        bindingDescs[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+        std::array<VkVertexInputAttributeDescription, 3> attrs{};
+        attrs[0] = {0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0}; // pos
+        attrs[1] = {1, 0, VK_FORMAT_R16G16_SNORM, 12};    // normal (octahedral)
+        attrs[2] = {2, 0, VK_FORMAT_R16G16_SFLOAT, 16};   // uv0 (half)
+
+        VkPipelineVertexInputStateCreateInfo vi{};
+        vi.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+        vi.vertexBindingDescriptionCount = static_cast<uint32_t>(bindingDescs.size());
+        vi.pVertexBindingDescriptions = bindingDescs.data();
+        vi.vertexAttributeDescriptionCount = static_cast<uint32_t>(attrs.size());
+        vi.pVertexAttributeDescriptions = attrs.data();
+        pci.vertexInput = vi;
+        pci.vertexInputProvided = true;
+
+        VkPipelineInputAssemblyStateCreateInfo ia{};
+        ia.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+        ia.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+        ia.primitiveRestartEnable = VK_FALSE;
+        pci.inputAssembly = ia;
+        pci.inputAssemblyProvided = true;
+
+        // No culling: foliage cards are double sided.
+        VkPipelineRasterizationStateCreateInfo rs{};
+        rs.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+        rs.depthClampEnable = VK_FALSE;
+        rs.rasterizerDiscardEnable = VK_FALSE;
+        rs.polygonMode = VK_POLYGON_MODE_FILL;
+        rs.lineWidth = 1.0f;
+        rs.cullMode = VK_CULL_MODE_NONE;
+        rs.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+        rs.depthBiasEnable = VK_FALSE;
+        pci.rasterization = rs;
+        pci.rasterizationProvided = true;
+
+        pci.dynamicStates = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+
+        VkPipelineDepthStencilStateCreateInfo ds{};
+        ds.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+        ds.depthTestEnable = VK_TRUE;
+        ds.depthWriteEnable = VK_TRUE;
+        // LESS_OR_EQUAL: opaque/masked surfaces pass on the depth the prepass wrote for them.
+        ds.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+        ds.depthBoundsTestEnable = VK_FALSE;
+        ds.stencilTestEnable = VK_FALSE;
+        pci.depthStencil = ds;
+        pci.depthStencilProvided = true;
+
+        VkPipelineColorBlendAttachmentState att{};
+        att.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+                             VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+        att.blendEnable = VK_FALSE;
+
+        VkPipelineColorBlendStateCreateInfo cb{};
+        cb.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+        cb.logicOpEnable = VK_FALSE;
+        cb.attachmentCount = 1;
+        cb.pAttachments = &att;
+        pci.colorBlend = cb;
+        pci.colorBlendProvided = true;
+
+        const VkResult r0 = m_pipelineOpaque.create(pci);
+        const VkResult r1 = m_pipelineMask.create(pci);
+
+        // Transparent: standard alpha blending, test depth but don't write.
+        att.blendEnable = VK_TRUE;
+        att.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+        att.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+        att.colorBlendOp = VK_BLEND_OP_ADD;
+        att.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+        att.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+        att.alphaBlendOp = VK_BLEND_OP_ADD;
+        pci.depthStencil.depthWriteEnable = VK_FALSE;
+        const VkResult r2 = m_pipelineBlend.create(pci);
+
+        // Depth prepass: depth writes on, colour writes off.
+        att = VkPipelineColorBlendAttachmentState{};
+        att.colorWriteMask = 0;
+        pci.depthStencil.depthWriteEnable = VK_TRUE;
+        pci.depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+        const VkResult r3 = m_pipelineDepth.create(pci);
+
+        vkDestroyShaderModule(pci.device, vert, nullptr);
+        vkDestroyShaderModule(pci.device, frag, nullptr);
+
+        if (r0 != VK_SUCCESS || r1 != VK_SUCCESS || r2 != VK_SUCCESS || r3 != VK_SUCCESS)
+        {
+            throw std::runtime_error("StaticPropRenderPassModule: failed to create one or more pipelines");
+        }
+    }
+
+    bool StaticPropRenderPassModule::createCullResources(VulkanContext &ctx)
+    {
+        destroyCullResources();
+        if (m_frames.empty() || m_framePool == VK_NULL_HANDLE)
+            return false;
+
+        // Set 0: cells, cell-sorted instance ids, instances, visible ids, indirect commands, counters,
+        // impostor ids
+        VkDescriptorSetLayoutBinding bindings[7]{};
+        for (uint32_t i = 0; i < 7u; ++i)
+        {
+            bindings[i].binding = i;
+            bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            bindings[i].descriptorCount = 1;
+            bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        }
+
+        VkDescriptorSetLayoutCreateInfo dsl{};
+        dsl.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        dsl.bindingCount = 7;
+        dsl.pBindings = bindings;
+        if (vkCreateDescriptorSetLayout(ctx.GetDevice(), &dsl, nullptr, &m_cullSetLayout) != VK_SUCCESS)
+            return false;
+
+        const uint32_t frameCount = static_cast<uint32_t>(m_frames.size());
+        std::vector<VkDescriptorSetLayout> layouts(frameCount, m_cullSetLayout);
+        std::vector<VkDescriptorSet> sets(frameCount, VK_NULL_HANDLE);
+        VkDescriptorSetAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = m_framePool;
+        allocInfo.descriptorSetCount = frameCount;
+        allocInfo.pSetLayouts = layouts.data();
+        if (vkAllocateDescriptorSets(ctx.GetDevice(), &allocInfo, sets.data()) != VK_SUCCESS)
+            return false;
+        for (uint32_t i = 0; i < frameCount; ++i)
+        {
+            m_frames[i].cullSet = sets[i];
+            m_frames[i].boundGeneration = 0;
+        }
+
+        // Push constants: 6 frustum planes + camera position/fade end + impostor distances + uvec4 info
+        // (see staticprop_cull.comp)
+        VkPushConstantRange pcRange{};
+        pcRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pcRange.offset = 0;
+        pcRange.size = sizeof(float) * 4u * 8u + sizeof(uint32_t) * 4u;
+
+        VkPipelineLayoutCreateInfo plInfo{};
+        plInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        plInfo.setLayoutCount = 1;
+        plInfo.pSetLayouts = &m_cullSetLayout;
+        plInfo.pushConstantRangeCount = 1;
+        plInfo.pPushConstantRanges = &pcRange;
+        if (vkCreatePipelineLayout(ctx.GetDevice(), &plInfo, nullptr, &m_cullPipelineLayout) != VK_SUCCESS)
+            return false;
+
+        VkShaderModule comp = VK_NULL_HANDLE;
+        try
+        {
+            comp = Pipeline::createShaderModuleFromFile(ctx.GetDevice(), "shaders/staticprop_cull.comp.spv");
+        }
+        catch (const std::exception &)
+        {
+            return false;
+        }
+
+        VkComputePipelineCreateInfo cpi{};
+        cpi.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        cpi.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        cpi.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        cpi.stage.module = comp;
+        cpi.stage.pName = "main";
+        cpi.layout = m_cullPipelineLayout;
+
+        const VkResult r = vkCreateComputePipelines(ctx.GetDevice(), ctx.GetPipelineCache(), 1, &cpi, nullptr, &m_cullPipeline);
+        vkDestroyShaderModule(ctx.GetDevice(), comp, nullptr);
+        return r == VK_SUCCESS;
+    }
+
+    void StaticPropRenderPassModule::destroyCullResources()
+    {
+        // Cull sets come from m_framePool and go with it.
+        for (FrameData &f : m_frames)
+            f.cullSet = VK_NULL_HANDLE;
+
+        if (m_cullPipeline != VK_NULL_HANDLE)
+        {
+            vkDestroyPipeline(m_device, m_cullPipeline, nullptr);
+            m_cullPipeline = VK_NULL_HANDLE;
+        }
+        if (m_cullPipelineLayout != VK_NULL_HANDLE)
+        {
+            vkDestroyPipelineLayout(m_device, m_cullPipelineLayout, nullptr);
+            m_cullPipelineLayout = VK_NULL_HANDLE;
+        }
+        if (m_cullSetLayout != VK_NULL_HANDLE)
+        {
+            vkDestroyDescriptorSetLayout(m_device, m_cullSetLayout, nullptr);
+            m_cullSetLayout = VK_NULL_HANDLE;
+        }
+    }
+
+    bool StaticPropRenderPassModule::createImpostorResources(VulkanContext &ctx, VkRenderPass pass)
+    {
+        destroyImpostorResources();
+
+        // Without descriptor indexing: one set with the albedo and normal + depth atlases (the
+        // pass draws one model, so one set rewritten when its material or texture views change).
+        if (!m_bindless)
+        {
+            VkDescriptorSetLayoutBinding bindings[2]{};
+            for (uint32_t i = 0; i < 2u; ++i)
+            {
+                bindings[i].binding = i;
+                bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+                bindings[i].descriptorCount = 1;
+                bindings[i].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+            }
+            VkDescriptorSetLayoutCreateInfo dsl{};
+            dsl.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+            dsl.bindingCount = 2;
+            dsl.pBindings = bindings;
+            if (vkCreateDescriptorSetLayout(ctx.GetDevice(), &dsl, nullptr, &m_impostorSetLayout) != VK_SUCCESS)
+                return false;
+
+            VkDescriptorPoolSize poolSize{};
+            poolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            poolSize.descriptorCount = 2;
+            VkDescriptorPoolCreateInfo poolInfo{};
+            poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+            poolInfo.maxSets = 1;
+            poolInfo.poolSizeCount = 1;
+            poolInfo.pPoolSizes = &poolSize;
+            if (vkCreateDescriptorPool(ctx.GetDevice(), &poolInfo, nullptr, &m_impostorPool) != VK_SUCCESS)
+                return false;
+
+            VkDescriptorSetAllocateInfo alloc{};
+            alloc.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+            alloc.descriptorPool = m_impostorPool;
+            alloc.descriptorSetCount = 1;
+            alloc.pSetLayouts = &m_impostorSetLayout;
+            if (vkAllocateDescriptorSets(ctx.GetDevice(), &alloc, &m_impostorSet) != VK_SUCCESS)
+                return false;
+            m_impostorSetMaterial = 0;
+        }
+
+        VkPushConstantRange pcRange{};
+        pcRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+        pcRange.offset = 0;
+        pcRange.size = sizeof(PushConstantsImpostor);
+
+        VkDescriptorSetLayout setLayouts[2] = {m_drawSetLayout, m_bindless ? m_bindless->layout() : m_impostorSetLayout};
+        VkPipelineLayoutCreateInfo plInfo{};
+        plInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        plInfo.setLayoutCount = 2;
+        plInfo.pSetLayouts = setLayouts;
+        plInfo.pushConstantRangeCount = 1;
+        plInfo.pPushConstantRanges = &pcRange;
+        if (vkCreatePipelineLayout(ctx.GetDevice(), &plInfo, nullptr, &m_impostorPipelineLayout) != VK_SUCCESS)
+            return false;
+
+        VkShaderModule vert = VK_NULL_HANDLE;
+        VkShaderModule frag = VK_NULL_HANDLE;
+        try
+        {
+            vert = Pipeline::createShaderModuleFromFile(ctx.GetDevice(), "shaders/staticprop_impostor.vert.spv");
+            frag = Pipeline::createShaderModuleFromFile(ctx.GetDevice(), m_bindless ? "shaders/staticprop_impostor_bindless.frag.spv" : "shaders/staticprop_impostor.frag.spv");
+        }
+        catch (const std::exception &)
+        {
+            if (vert != VK_NULL_HANDLE)
+                vkDestroyShaderModule(ctx.GetDevice(), vert, nullptr);
+            return false;
+        }
+
+        PipelineCreateInfo pci{};
+        pci.device = ctx.GetDevice();
+        pci.pipelineCache = ctx.GetPipelineCache();
+        pci.renderPass = pass;
+        pci.subpass = 0;
+        pci.pipelineLayout = m_impostorPipelineLayout;
+
+        VkPipelineShaderStageCreateInfo vs{};
+        vs.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        vs.stage = VK_SHADER_STAGE_VERTEX_BIT;
+        vs.module = vert;
+        vs.pName = "main";
+
+        VkPipelineShaderStageCreateInfo fs{};
+        fs.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        fs.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+        fs.module = frag;
+        fs.pName = "main";
+
+        pci.shaderStages = {vs, fs};
+
+        // Corners come from gl_VertexIndex: no vertex input.
+        VkPipelineInputAssemblyStateCreateInfo ia{};
+        ia.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+        ia.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+        ia.primitiveRestartEnable = VK_FALSE;
+        pci.inputAssembly = ia;
+        pci.inputAssemblyProvided = true;
+
+        VkPipelineRasterizationStateCreateInfo rs{};
+        rs.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+        rs.polygonMode = VK_POLYGON_MODE_FILL;
+        rs.lineWidth = 1.0f;
+        rs.cullMode = VK_CULL_MODE_NONE;
+        rs.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+        pci.rasterization = rs;
+        pci.rasterizationProvided = true;
+
+        pci.dynamicStates = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+
+        // Drawn in the Mask phase, after the prepass: tests and writes its own (pushed back) depth.
+        VkPipelineDepthStencilStateCreateInfo ds{};
+        ds.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+        ds.depthTestEnable = VK_TRUE;
+        ds.depthWriteEnable = VK_TRUE;
+        ds.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+        pci.depthStencil = ds;
+        pci.depthStencilProvided = true;
+
+        const VkResult r = m_pipelineImpostor.create(pci);
+        vkDestroyShaderModule(pci.device, vert, nullptr);
+        vkDestroyShaderModule(pci.device, frag, nullptr);
+        return r == VK_SUCCESS;
+    }
+
+    void StaticPropRenderPassModule::destroyImpostorResources()
+    {
+        m_pipelineImpostor.destroy(m_device);
+        m_impostorReady = false;
+        m_impostorSet = VK_NULL_HANDLE; // freed with the pool
+        m_impostorSetMaterial = 0;
+
+        if (m_impostorPipelineLayout != VK_NULL_HANDLE)
+        {
+            vkDestroyPipelineLayout(m_device, m_impostorPipelineLayout, nullptr);
+            m_impostorPipelineLayout = VK_NULL_HANDLE;
+        }
+        if (m_impostorPool != VK_NULL_HANDLE)
+        {
+            vkDestroyDescriptorPool(m_device, m_impostorPool, nullptr);
+            m_impostorPool = VK_NULL_HANDLE;
+        }
+        if (m_impostorSetLayout != VK_NULL_HANDLE)
+        {
+            vkDestroyDescriptorSetLayout(m_device, m_impostorSetLayout, nullptr);
+            m_impostorSetLayout = VK_NULL_HANDLE;
+        }
+    }
+
+    VkDescriptorSet StaticPropRenderPassModule::impostorMaterialSet(const MaterialAsset *mat)
+    {
+        const uint32_t epoch = m_assets->textureViewEpoch();
+        if (m_impostorSetMaterial == m_impostorMaterial.id && m_impostorSetEpoch == epoch)
+            return m_impostorSet;
+
+        // Same in-place rewrite as the material set cache (no pending frame reads the old views).
+        auto imageInfo = [&](TextureHandle h)
+        {
+            VkDescriptorImageInfo di{};
+            di.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            di.imageView = m_fallbackWhiteTexture.getView();
+            di.sampler = m_fallbackWhiteTexture.getSampler();
+            TextureAsset *tex = h.isValid() ? m_assets->getTexture(h) : nullptr;
+            if (tex && tex->getView() != VK_NULL_HANDLE && tex->getSampler() != VK_NULL_HANDLE)
+            {
+                di.imageView = tex->getView();
+                di.sampler = tex->getSampler();
+            }
+            return di;
+        };
+        const VkDescriptorImageInfo infos[2] = {imageInfo(mat->baseColorTexture), imageInfo(mat->normalTexture)};
+
+        VkWriteDescriptorSet writes[2]{};
+        for (uint32_t i = 0; i < 2u; ++i)
+        {
+            writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[i].dstSet = m_impostorSet;
+            writes[i].dstBinding = i;
+            writes[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            writes[i].descriptorCount = 1;
+            writes[i].pImageInfo = &infos[i];
+        }
+        vkUpdateDescriptorSets(m_device, 2, writes, 0, nullptr);
+
+        m_impostorSetMaterial = m_impostorMaterial.id;
+        m_impostorSetEpoch = epoch;
+        return m_impostorSet;
+    }
+
+    bool StaticPropRenderPassModule::impostorsActive() const
+    {
+        return m_impostorReady && m_impostorMaterial.isValid() && m_impostorStart > 0.0f && m_impostorStart < m_fadeEnd;
+    }
+
+    void StaticPropRenderPassModule::recordImpostors(FrameData &frame, VkCommandBuffer cmd)
+    {
+        MaterialAsset *mat = m_assets->getMaterial(m_impostorMaterial);
+        if (!mat)
+            return;
+
+        // Own pipeline layout (push constants differ): both sets are bound again.
+        PushConstantsImpostor pc = m_impostorConstants;
+        VkDescriptorSet materialSet = VK_NULL_HANDLE;
+        if (m_bindless)
+        {
+            materialSet = m_bindless->set();
+            pc.info[2] = m_bindless->materialIndex(*m_assets, m_impostorMaterial);
+        }
+        else
+        {
+            materialSet = impostorMaterialSet(mat);
+        }
+        if (materialSet == VK_NULL_HANDLE)
+            return;
+
+        m_pipelineImpostor.bind(cmd);
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_impostorPipelineLayout, 0, 1, &frame.drawSet, 1, &frame.cameraOffset);
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_impostorPipelineLayout, 1, 1, &materialSet, 0, nullptr);
+        vkCmdPushConstants(cmd, m_impostorPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(pc), &pc);
+
+        const VkDeviceSize offset = static_cast<VkDeviceSize>(m_draws.size()) * sizeof(VkDrawIndexedIndirectCommand);
+        vkCmdDrawIndirect(cmd, frame.indirectBuffer, offset, 1, sizeof(VkDrawIndirectCommand));
+        DrawCallCounter::increment();
+    }
+
+    void StaticPropRenderPassModule::rebuildDrawList(const ModelAsset &model)
+    {
+        m_draws.clear();
+        m_drawListModel = &model;
+        m_drawListPrimitiveCount = model.primitives.size();
+        m_drawListVersion += 1u;
+
+        // Same placement as SModelRenderPassModule's model matrix: scale to the fitted size,
+        // center on XZ and stand the model on y=0. Folded into each draw's node matrix.
+        glm::mat4 fit(1.0f);
+        if (model.hasBounds)
+        {
+            const float s = model.fitScale;
+            fit = glm::scale(glm::mat4(1.0f), glm::vec3(s));
+            fit[3] = glm::vec4(-model.center[0] * s, -model.boundsMin[1] * s, -model.center[2] * s, 1.0f);
+        }
+
+        // The impostor was captured with the node globals applied: it takes the fit alone.
+        m_impostorMaterial = model.hasImpostor() ? model.impostorMaterial : MaterialHandle{};
+        m_impostorConstants = PushConstantsImpostor{};
+        if (m_impostorMaterial.isValid())
+        {
+            std::memcpy(m_impostorConstants.fit, glm::value_ptr(fit), sizeof(m_impostorConstants.fit));
+            std::memcpy(m_impostorConstants.sphere, model.impostorCenter, sizeof(model.impostorCenter));
+            m_impostorConstants.sphere[3] = model.impostorRadius;
+            m_impostorConstants.info[0] = model.impostorFrames;
+            m_impostorConstants.info[1] = model.impostorMapping;
+        }
+
+        auto addDraw = [&](const ModelPrimitive &prim, const glm::mat4 &node)
+        {
+            MeshAsset *mesh = m_assets->getMesh(prim.mesh);
+            MaterialAsset *mat = m_assets->getMaterial(prim.material);
+            if (!mesh || !mat || prim.indexCount == 0)
+                return;
+            if (mesh->getVertexBuffer() == VK_NULL_HANDLE || mesh->getIndexBuffer() == VK_NULL_HANDLE)
+                return;
+            if (mat->alphaMode > 2u)
+                return;
+
+            PropDraw d{};
+            d.pass = mat->alphaMode;
+            d.material = prim.material;
+            d.indexCount = prim.indexCount;
+            d.firstIndex = mesh->getFirstIndex() + prim.firstIndex;
+            d.vertexOffset = mesh->getVertexOffset() + prim.vertexOffset;
+            d.node = fit * node;
+            d.vertexBuffer = mesh->getVertexBuffer();
+            d.indexBuffer = mesh->getIndexBuffer();
+            d.indexType = mesh->getIndexType();
+            m_draws.push_back(d);
+        };
+
+        if (!model.nodes.empty())
+        {
+            // Rest pose: static props never animate.
+            for (uint32_t nodeIndex = 0; nodeIndex < static_cast<uint32_t>(model.nodes.size()); ++nodeIndex)
+            {
+                const auto &node = model.nodes[nodeIndex];
+                const glm::mat4 global = glm::make_mat4(node.globalMatrix);
+                for (uint32_t k = 0; k < node.primitiveCount; ++k)
+                {
+                    const uint32_t primIndex = model.nodePrimitiveIndices[node.firstPrimitiveIndex + k];
+                    if (primIndex < model.primitives.size())
+                        addDraw(model.primitives[primIndex], global);
+                }
+            }
+        }
+        else
+        {
+            for (const ModelPrimitive &prim : model.primitives)
+                addDraw(prim, glm::mat4(1.0f));
+        }
+
+        // Pass, then material, so each phase binds a material once per run.
+        std::stable_sort(m_draws.begin(), m_draws.end(), [](const PropDraw &a, const PropDraw &b)
+                         {
+                             if (a.pass != b.pass)
+                                 return a.pass < b.pass;
+                             return a.material.id < b.material.id; });
+    }
+
+    void StaticPropRenderPassModule::rebuildCells()
+    {
+        m_cellKeys.clear();
+        m_cellKeys.reserve(m_liveInstances);
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_instances.size()); ++i)
+        {
+            const glm::vec4 &s = m_instances[i].sphere;
+            if (s.w >= 0.0f)
+                m_cellKeys.push_back((static_cast<uint64_t>(cellKey(glm::vec3(s))) << 32) | i);
+        }
+        std::sort(m_cellKeys.begin(), m_cellKeys.end());
+
+        m_cellInstances.resize(m_cellKeys.size());
+        m_cells.clear();
+        size_t runStart = 0;
+        while (runStart < m_cellKeys.size())
+        {
+            const uint32_t key = static_cast<uint32_t>(m_cellKeys[runStart] >> 32);
+            size_t runEnd = runStart;
+            glm::vec3 bmin(std::numeric_limits<float>::max());
+            glm::vec3 bmax(-std::numeric_limits<float>::max());
+            while (runEnd < m_cellKeys.size() && static_cast<uint32_t>(m_cellKeys[runEnd] >> 32) == key)
+            {
+                const uint32_t id = static_cast<uint32_t>(m_cellKeys[runEnd]);
+                const glm::vec4 &s = m_instances[id].sphere;
+                bmin = glm::min(bmin, glm::vec3(s) - glm::vec3(s.w));
+                bmax = glm::max(bmax, glm::vec3(s) + glm::vec3(s.w));
+                m_cellInstances[runEnd] = id;
+                ++runEnd;
+            }
+
+            // Sphere around the members' spheres (instances can overhang the cell).
+            const glm::vec3 center = 0.5f * (bmin + bmax);
+            float radius = 0.0f;
+            for (size_t k = runStart; k < runEnd; ++k)
+            {
+                const glm::vec4 &s = m_instances[m_cellInstances[k]].sphere;
+                radius = std::max(radius, glm::length(glm::vec3(s) - center) + s.w);
+            }
+
+            GpuCell cell{};
+            cell.sphere = glm::vec4(center, radius);
+            cell.first = static_cast<uint32_t>(runStart);
+            cell.count = static_cast<uint32_t>(runEnd - runStart);
+            m_cells.push_back(cell);
+            runStart = runEnd;
+        }
+    }
+
+    bool StaticPropRenderPassModule::ensureResidentBuffer(VkBuffer &buffer, GpuAllocation &memory, VkDeviceSize &capacity, VkDeviceSize needed)
+    {
+        if (needed <= capacity && buffer != VK_NULL_HANDLE)
+            return true;
+
+        VkDeviceSize newCap = std::max<VkDeviceSize>(capacity, 4096u);
+        while (newCap < needed)
+            newCap *= 2u;
+
+        retireBuffer(buffer, memory);
+        capacity = 0;
+        if (CreateDeviceLocalBuffer(m_device, m_physicalDevice, newCap,
+                                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, buffer, memory,
+                                    m_queueFamilyCount, m_queueFamilies) != VK_SUCCESS)
+            return false;
+        capacity = newCap;
+        m_generation += 1u;
+        return true;
+    }
+
+    bool StaticPropRenderPassModule::uploadInstances(VkCommandBuffer cmd)
+    {
+        rebuildCells();
+        m_stats.instances = m_liveInstances;
+        m_stats.cells = static_cast<uint32_t>(m_cells.size());
+        if (m_cells.empty())
+        {
+            m_uploadedCells = 0;
+            return true;
+        }
+
+        const VkDeviceSize instanceBytes = static_cast<VkDeviceSize>(m_instances.size()) * sizeof(GpuInstance);
+        const VkDeviceSize idBytes = static_cast<VkDeviceSize>(m_cellInstances.size()) * sizeof(uint32_t);
+        const VkDeviceSize cellBytes = static_cast<VkDeviceSize>(m_cells.size()) * sizeof(GpuCell);
+        if (!ensureResidentBuffer(m_instanceBuffer, m_instanceMemory, m_instanceBytes, instanceBytes) ||
+            !ensureResidentBuffer(m_cellInstanceBuffer, m_cellInstanceMemory, m_cellInstanceBytes, idBytes) ||
+            !ensureResidentBuffer(m_cellBuffer, m_cellMemory, m_cellBytes, cellBytes))
+            return false;
+
+        // One-shot staging buffer, retired like a replaced resident buffer once the copy is queued.
+        VkBuffer staging = VK_NULL_HANDLE;
+        GpuAllocation stagingMemory;
+        const VkDeviceSize total = instanceBytes + idBytes + cellBytes;
+        if (CreateBuffer(m_device, m_physicalDevice, total, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, staging, stagingMemory) != VK_SUCCESS)
+            return false;
+        if (!stagingMemory.mapped)
+        {
+            DestroyBuffer(m_device, staging, stagingMemory);
+            return false;
+        }
+
+        auto *dst = static_cast<uint8_t *>(stagingMemory.mapped);
+        std::memcpy(dst, m_instances.data(), static_cast<size_t>(instanceBytes));
+        std::memcpy(dst + instanceBytes, m_cellInstances.data(), static_cast<size_t>(idBytes));
+        std::memcpy(dst + instanceBytes + idBytes, m_cells.data(), static_cast<size_t>(cellBytes));
+
+        // Earlier frames' cull dispatches and draws may still read the buffers being overwritten.
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+        VkBufferCopy copy{};
+        copy.srcOffset = 0;
+        copy.dstOffset = 0;
+        copy.size = instanceBytes;
+        vkCmdCopyBuffer(cmd, staging, m_instanceBuffer, 1, &copy);
+        copy.srcOffset = instanceBytes;
+        copy.size = idBytes;
+        vkCmdCopyBuffer(cmd, staging, m_cellInstanceBuffer, 1, &copy);
+        copy.srcOffset = instanceBytes + idBytes;
+        copy.size = cellBytes;
+        vkCmdCopyBuffer(cmd, staging, m_cellBuffer, 1, &copy);
+
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+        retireBuffer(staging, stagingMemory);
+        m_uploadedCells = static_cast<uint32_t>(m_cells.size());
+        m_stats.uploads += 1u;
+        m_stats.uploadBytes += total;
+        return true;
+    }
+
+    bool StaticPropRenderPassModule::ensureFrameCapacity(FrameData &frame, uint32_t instances, uint32_t draws)
+    {
+        // This frame's fence has signaled: its own buffers can be replaced right away.
+        if (instances > frame.visibleCapacity)
+        {
+            uint32_t newCap = std::max<uint32_t>(256u, frame.visibleCapacity);
+            while (newCap < instances)
+                newCap *= 2u;
+
+            DestroyBuffer(m_device, frame.visibleBuffer, frame.visibleMemory);
+            DestroyBuffer(m_device, frame.impostorVisibleBuffer, frame.impostorVisibleMemory);
+            frame.visibleCapacity = 0;
+            if (CreateDeviceLocalBuffer(m_device, m_physicalDevice, static_cast<VkDeviceSize>(newCap) * sizeof(uint32_t),
+                                        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, frame.visibleBuffer, frame.visibleMemory,
+                                        m_queueFamilyCount, m_queueFamilies) != VK_SUCCESS)
+                return false;
+            if (CreateDeviceLocalBuffer(m_device, m_physicalDevice, static_cast<VkDeviceSize>(newCap) * sizeof(uint32_t),
+                                        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, frame.impostorVisibleBuffer,
+                                        frame.impostorVisibleMemory, m_queueFamilyCount, m_queueFamilies) != VK_SUCCESS)
+                return false;
+            frame.visibleCapacity = newCap;
+        }
+
+        if (draws > frame.indirectCapacity)
+        {
+            uint32_t newCap = std::max<uint32_t>(16u, frame.indirectCapacity);
+            while (newCap < draws)
+                newCap *= 2u;
+
+            frame.indirectMapped = nullptr;
+            DestroyBuffer(m_device, frame.indirectBuffer, frame.indirectMemory);
+            frame.indirectCapacity = 0;
+            if (CreateBuffer(m_device, m_physicalDevice, static_cast<VkDeviceSize>(newCap) * sizeof(VkDrawIndexedIndirectCommand),
+                             VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, frame.indirectBuffer, frame.indirectMemory,
+                             m_queueFamilyCount, m_queueFamilies) != VK_SUCCESS)
+                return false;
+            frame.indirectMapped = frame.indirectMemory.mapped;
+            if (!frame.indirectMapped)
+                return false;
+            frame.indirectCapacity = newCap;
+            frame.uploadedDrawListVersion = 0;
+        }
+        return true;
+    }
+
+    void StaticPropRenderPassModule::bindFrameSets(FrameData &frame)
+    {
+        if (frame.boundGeneration == m_generation && frame.boundVisible == frame.visibleBuffer &&
+            frame.boundImpostorVisible == frame.impostorVisibleBuffer && frame.boundIndirect == frame.indirectBuffer)
+            return;
+
+        auto whole = [](VkBuffer b)
+        {
+            VkDescriptorBufferInfo info{};
+            info.buffer = b;
+            info.offset = 0;
+            info.range = VK_WHOLE_SIZE;
+            return info;
+        };
+
+        const VkDescriptorBufferInfo drawInfos[3] = {whole(m_instanceBuffer), whole(frame.visibleBuffer), whole(frame.impostorVisibleBuffer)};
+        const VkDescriptorBufferInfo cullInfos[7] = {whole(m_cellBuffer), whole(m_cellInstanceBuffer), whole(m_instanceBuffer),
+                                                     whole(frame.visibleBuffer), whole(frame.indirectBuffer), whole(frame.counterBuffer),
+                                                     whole(frame.impostorVisibleBuffer)};
+
+        VkWriteDescriptorSet writes[10]{};
+        for (uint32_t i = 0; i < 10u; ++i)
+        {
+            const bool draw = i < 3u;
+            writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[i].dstSet = draw ? frame.drawSet : frame.cullSet;
+            writes[i].dstBinding = draw ? i + 1u : i - 3u;
+            writes[i].dstArrayElement = 0;
+            writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writes[i].descriptorCount = 1;
+            writes[i].pBufferInfo = draw ? &drawInfos[i] : &cullInfos[i - 3u];
+        }
+        vkUpdateDescriptorSets(m_device, 10, writes, 0, nullptr);
+
+        frame.boundGeneration = m_generation;
+        frame.boundVisible = frame.visibleBuffer;
+        frame.boundImpostorVisible = frame.impostorVisibleBuffer;
+        frame.boundIndirect = frame.indirectBuffer;
+    }
+
+    void StaticPropRenderPassModule::retireBuffer(VkBuffer &buffer, GpuAllocation &memory)
+    {
+        // Earlier frames may still read the old buffer; destroy it a full frame cycle later.
+        if (buffer == VK_NULL_HANDLE)
+            return;
+
+        RetiredBuffer rb{};
+        rb.buffer = buffer;
+        rb.memory = memory;
+        rb.framesLeft = static_cast<uint32_t>(m_frames.size()) + 1u;
+        m_retiredBuffers.push_back(rb);
+        buffer = VK_NULL_HANDLE;
+        memory = GpuAllocation{};
+    }
+
+    void StaticPropRenderPassModule::releaseRetiredBuffers(bool all)
+    {
+        size_t keep = 0;
+        for (RetiredBuffer &rb : m_retiredBuffers)
+        {
+            if (all || rb.framesLeft <= 1u)
+            {
+                DestroyBuffer(m_device, rb.buffer, rb.memory);
+                continue;
+            }
+            rb.framesLeft -= 1u;
+            m_retiredBuffers[keep++] = rb;
+        }
+        m_retiredBuffers.resize(keep);
+    }
+
+    void StaticPropRenderPassModule::latchCamera(FrameContext &frameCtx)
+    {
+        if (m_frames.empty() || !m_enabled || !m_camera)
+            return;
+        if (m_extent.width == 0 || m_extent.height == 0)
+            return;
+
+        FrameData &frame = m_frames[frameCtx.frameIndex % static_cast<uint32_t>(m_frames.size())];
+        if (!frame.cameraMapped || !frameCtx.camera)
+            return;
+
+        CameraUBO ubo{};
+        ubo.view = frameCtx.camera->view;
+        ubo.proj = frameCtx.camera->proj;
+        ubo.cameraPos = frameCtx.camera->position;
+        // Without impostors the mesh end sits out of reach (the mesh fade stays at 1).
+        const bool impostors = impostorsActive();
+        ubo.fade = glm::vec4(m_fadeEnd, 1.0f / (m_fadeEnd - m_fadeStart), impostors ? m_impostorStart + m_impostorBlend : 1e30f,
+                             impostors ? 1.0f / m_impostorBlend : 1.0f);
+        std::memcpy(frame.cameraMapped, &ubo, sizeof(CameraUBO));
+    }
+
+    bool StaticPropRenderPassModule::allocateCameraUBO(FrameContext &frameCtx, FrameData &frame)
+    {
+        frame.cameraMapped = nullptr;
+        FrameUploadRing::Allocation alloc;
+        if (!frameCtx.uploads || !frameCtx.uploads->allocateUniform(sizeof(CameraUBO), alloc))
+            return false;
+
+        if (frame.cameraRingBuffer != alloc.buffer)
+        {
+            VkDescriptorBufferInfo cbi{};
+            cbi.buffer = alloc.buffer;
+            cbi.offset = 0;
+            cbi.range = sizeof(CameraUBO);
+
+            VkWriteDescriptorSet write{};
+            write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            write.dstSet = frame.drawSet;
+            write.dstBinding = 0;
+            write.dstArrayElement = 0;
+            write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+            write.descriptorCount = 1;
+            write.pBufferInfo = &cbi;
+            vkUpdateDescriptorSets(m_device, 1, &write, 0, nullptr);
+            frame.cameraRingBuffer = alloc.buffer;
+        }
+        frame.cameraOffset = alloc.dynamicOffset();
+        frame.cameraMapped = alloc.mapped;
+        return true;
+    }
+
+    bool StaticPropRenderPassModule::canCull(const FrameData &frame)
+    {
+        if (!m_enabled || !m_cullReady || !m_camera || !m_assets || !m_model.isValid())
+            return false;
+        if (m_extent.width == 0 || m_extent.height == 0 || frame.cullSet == VK_NULL_HANDLE)
+            return false;
+
+        ModelAsset *model = m_assets->getModel(m_model);
+        if (!model || model->primitives.empty())
+            return false;
+        if (m_drawListModel != model || m_drawListPrimitiveCount != model->primitives.size())
+            rebuildDrawList(*model);
+        return !m_draws.empty();
+    }
+
+    bool StaticPropRenderPassModule::prepareFrameCull(FrameData &frame)
+    {
+        if (m_uploadedCells == 0)
+            return false;
+
+        const uint32_t drawCount = static_cast<uint32_t>(m_draws.size());
+        if (!ensureFrameCapacity(frame, static_cast<uint32_t>(m_instances.size()), drawCount + 1u))
+            return false;
+        bindFrameSets(frame);
+
+        // Commands change only with the draw list; the cull shader fills in instanceCount.
+        if (frame.uploadedDrawListVersion != m_drawListVersion)
+        {
+            auto *cmds = static_cast<VkDrawIndexedIndirectCommand *>(frame.indirectMapped);
+            for (uint32_t i = 0; i < drawCount; ++i)
+            {
+                cmds[i].indexCount = m_draws[i].indexCount;
+                cmds[i].instanceCount = 0;
+                cmds[i].firstIndex = m_draws[i].firstIndex;
+                cmds[i].vertexOffset = m_draws[i].vertexOffset;
+                cmds[i].firstInstance = 0;
+            }
+
+            // The impostor quad: a VkDrawIndirectCommand in the slot after the model's draws.
+            VkDrawIndirectCommand quad{};
+            quad.vertexCount = 6;
+            std::memcpy(&cmds[drawCount], &quad, sizeof(quad));
+            frame.uploadedDrawListVersion = m_drawListVersion;
+        }
+        return true;
+    }
+
+    bool StaticPropRenderPassModule::recordAsyncCompute(FrameContext &frameCtx, VkCommandBuffer cmd)
+    {
+        // An instance upload is a graphics-queue copy; that frame culls in recordPrePass().
+        if (m_frames.empty() || m_instancesDirty)
+            return false;
+
+        FrameData &frame = m_frames[frameCtx.frameIndex % static_cast<uint32_t>(m_frames.size())];
+        if (!canCull(frame) || !prepareFrameCull(frame))
+            return false;
+
+        // The instance table was copied by the last graphics submit.
+        if (m_uploadAwaitingCompute)
+        {
+            frameCtx.computeWaitsForGraphics = true;
+            m_uploadAwaitingCompute = false;
+        }
+
+        recordCull(frame, cmd, false);
+        frame.asyncCulled = true;
+        return true;
+    }
+
+    void StaticPropRenderPassModule::recordPrePass(FrameContext &frameCtx, VkCommandBuffer cmd)
+    {
+        if (m_frames.empty())
+            return;
+
+        FrameData &frame = m_frames[frameCtx.frameIndex % static_cast<uint32_t>(m_frames.size())];
+        frame.culled = frame.asyncCulled;
+        frame.asyncCulled = false;
+
+        // Once per frame: this slot's fence has signaled, so retired buffers age by one frame.
+        releaseRetiredBuffers(false);
+
+        // Nothing is drawn this frame without its camera UBO.
+        if (!allocateCameraUBO(frameCtx, frame))
+        {
+            frame.culled = false;
+            return;
+        }
+
+        if (frame.culled || !canCull(frame))
+            return;
+
+        // Static data: uploaded only after the instance set changed.
+        if (m_instancesDirty)
+        {
+            if (!uploadInstances(cmd))
+                return;
+            m_instancesDirty = false;
+            m_uploadAwaitingCompute = true;
+        }
+        if (!prepareFrameCull(frame))
+            return;
+
+        recordCull(frame, cmd, true);
+        frame.culled = true;
+    }
+
+    void StaticPropRenderPassModule::recordCull(FrameData &frame, VkCommandBuffer cmd, bool graphicsQueue)
+    {
+        const uint32_t drawCount = static_cast<uint32_t>(m_draws.size());
+        const float aspect = static_cast<float>(m_extent.width) / static_cast<float>(m_extent.height);
+        m_camera->SetAspect(aspect);
+
+        // The camera UBO is written in latchCamera(); the cull planes use the camera as of now.
+        const glm::mat4 viewProj = m_camera->GetProjectionMatrix() * m_camera->GetViewMatrix();
+        const glm::vec3 cameraPos = m_camera->GetPosition();
+
+        struct CullPushConstants
+        {
+            float planes[6][4];
+            float camera[4];   // xyz=position, w=fade end
+            float impostor[4]; // x=impostor start, y=mesh end
+            uint32_t cellCount;
+            uint32_t drawCount;
+            uint32_t mode;
+            uint32_t impostors;
+        } cpc{};
+
+        const Frustum frustum = Frustum::fromViewProjection(viewProj);
+        for (int i = 0; i < 6; ++i)
+        {
+            const FrustumPlane &pl = frustum.plane(i);
+            cpc.planes[i][0] = pl.normal.x;
+            cpc.planes[i][1] = pl.normal.y;
+            cpc.planes[i][2] = pl.normal.z;
+            cpc.planes[i][3] = pl.distance;
+        }
+        cpc.camera[0] = cameraPos.x;
+        cpc.camera[1] = cameraPos.y;
+        cpc.camera[2] = cameraPos.z;
+        cpc.camera[3] = m_fadeEnd;
+        cpc.impostor[0] = m_impostorStart;
+        cpc.impostor[1] = m_impostorStart + m_impostorBlend;
+        cpc.cellCount = m_uploadedCells;
+        cpc.drawCount = drawCount;
+        cpc.impostors = impostorsActive() ? 1u : 0u;
+
+        // Reset the visible counters
+        vkCmdFillBuffer(cmd, frame.counterBuffer, 0, sizeof(uint32_t) * 2u, 0u);
+
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_cullPipeline);
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_cullPipelineLayout, 0, 1, &frame.cullSet, 0, nullptr);
+
+        // Pass 1: one workgroup per cell (2D grid past the 65535 group limit)
+        cpc.mode = 0u;
+        vkCmdPushConstants(cmd, m_cullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(cpc), &cpc);
+        const uint32_t groupsX = std::min<uint32_t>(m_uploadedCells, 65535u);
+        vkCmdDispatch(cmd, groupsX, (m_uploadedCells + groupsX - 1u) / groupsX, 1);
+
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+        // Pass 2: visible count -> every draw command, impostor count -> the impostor command
+        cpc.mode = 1u;
+        vkCmdPushConstants(cmd, m_cullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(cpc), &cpc);
+        vkCmdDispatch(cmd, (drawCount + CULL_GROUP_SIZE) / CULL_GROUP_SIZE, 1, 1);
+
+        // On the compute queue the timeline semaphore the graphics submit waits on orders the
+        // draws (vertex stages do not exist there).
+        if (!graphicsQueue)
+            return;
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+                             0, 1, &barrier, 0, nullptr, 0, nullptr);
+    }
+
+    const Pipeline *StaticPropRenderPassModule::phasePipeline(RenderPhase phase, uint32_t pass) const
+    {
+        switch (phase)
+        {
+        case RenderPhase::DepthPrepass:
+            return pass <= 1u ? &m_pipelineDepth : nullptr;
+        case RenderPhase::Opaque:
+            return pass == 0u ? &m_pipelineOpaque : nullptr;
+        case RenderPhase::Mask:
+            return pass == 1u ? &m_pipelineMask : nullptr;
+        case RenderPhase::Blend:
+            return pass == 2u ? &m_pipelineBlend : nullptr;
+        default:
+            return nullptr;
+        }
+    }
+
+    void StaticPropRenderPassModule::record(FrameContext &frameCtx, VkCommandBuffer cmd)
+    {
+        for (uint32_t phase = 0; phase < RENDER_PHASE_COUNT; ++phase)
+            recordPhase(frameCtx, cmd, static_cast<RenderPhase>(phase));
+    }
+
+    void StaticPropRenderPassModule::recordPhase(FrameContext &frameCtx, VkCommandBuffer cmd, RenderPhase phase)
+    {
+        if (m_frames.empty())
+            return;
+        FrameData &frame = m_frames[frameCtx.frameIndex % static_cast<uint32_t>(m_frames.size())];
+        if (!frame.culled)
+            return;
+        if (phase == RenderPhase::DepthPrepass && !frameCtx.depthPrepass)
+            return;
+
+        // Render extent, not m_extent: below it with resolution scaling.
+        const VkExtent2D ext = frameCtx.renderExtent;
+        VkViewport vp{0.0f, 0.0f, static_cast<float>(ext.width), static_cast<float>(ext.height), 0.0f, 1.0f};
+        VkRect2D sc{{0, 0}, ext};
+        vkCmdSetViewport(cmd, 0, 1, &vp);
+        vkCmdSetScissor(cmd, 0, 1, &sc);
+
+        const Pipeline *boundPipe = nullptr;
+        VkBuffer boundVB = VK_NULL_HANDLE;
+        VkBuffer boundIB = VK_NULL_HANDLE;
+        uint64_t boundMaterial = UINT64_MAX;
+        uint32_t materialIndex = BindlessMaterials::FALLBACK_INDEX;
+
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_draws.size()); ++i)
+        {
+            const PropDraw &d = m_draws[i];
+            const Pipeline *pipe = phasePipeline(phase, d.pass);
+            if (!pipe)
+                continue;
+            MaterialAsset *mat = m_assets->getMaterial(d.material);
+            if (!mat)
+                continue;
+
+            if (pipe != boundPipe)
+            {
+                pipe->bind(cmd);
+                if (!boundPipe)
+                {
+                    // One layout for every pipeline: the sets survive later pipeline binds.
+                    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 0, 1, &frame.drawSet, 1, &frame.cameraOffset);
+                    if (frameCtx.shadow && frameCtx.shadow->receiverSet != VK_NULL_HANDLE)
+                        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 2, 1, &frameCtx.shadow->receiverSet, 0, nullptr);
+                    if (m_bindless)
+                    {
+                        VkDescriptorSet set = m_bindless->set();
+                        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 1, 1, &set, 0, nullptr);
+                    }
+                }
+                boundPipe = pipe;
+            }
+
+            if (d.material.id != boundMaterial)
+            {
+                if (m_bindless)
+                {
+                    materialIndex = m_bindless->materialIndex(*m_assets, d.material);
+                }
+                else if (VkDescriptorSet matSet = getOrCreateMaterialSet(d.material, mat))
+                {
+                    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 1, 1, &matSet, 0, nullptr);
+                }
+                boundMaterial = d.material.id;
+            }
+
+            if (d.vertexBuffer != boundVB)
+            {
+                VkDeviceSize vbOffset = 0;
+                vkCmdBindVertexBuffers(cmd, 0, 1, &d.vertexBuffer, &vbOffset);
+                boundVB = d.vertexBuffer;
+            }
+            if (d.indexBuffer != boundIB)
+            {
+                vkCmdBindIndexBuffer(cmd, d.indexBuffer, 0, d.indexType);
+                boundIB = d.indexBuffer;
+            }
+
+            PushConstantsProp pc{};
+            std::memcpy(pc.node, glm::value_ptr(d.node), sizeof(pc.node));
+            std::memcpy(pc.baseColorFactor, mat->baseColorFactor, sizeof(pc.baseColorFactor));
+            pc.materialParams[0] = mat->alphaCutoff;
+            pc.materialParams[1] = static_cast<float>(mat->alphaMode);
+            pc.materialIndex = materialIndex;
+            vkCmdPushConstants(cmd, m_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(PushConstantsProp), &pc);
+
+            vkCmdDrawIndexedIndirect(cmd, frame.indirectBuffer, static_cast<VkDeviceSize>(i) * sizeof(VkDrawIndexedIndirectCommand), 1,
+                                     sizeof(VkDrawIndexedIndirectCommand));
+            DrawCallCounter::increment();
+        }
+
+        // Impostors cut out like masked materials (and are left out of the depth prepass).
+        if (phase == RenderPhase::Mask && impostorsActive())
+            recordImpostors(frame, cmd);
+    }
+
+    void StaticPropRenderPassModule::onResize(VulkanContext &ctx, VkExtent2D newExtent)
+    {
+        (void)ctx;
+        m_extent = newExtent;
+    }
+
+    ShadowCaster StaticPropRenderPassModule::shadowCaster() const
+    {
+        if (!m_enabled || !m_castShadows || m_shadowFailed || m_liveInstances == 0)
+            return ShadowCaster::None;
+        return ShadowCaster::Static;
+    }
+
+    uint64_t StaticPropRenderPassModule::shadowContentVersion() const
+    {
+        // Casters are drawn from the uploaded tables: every upload is new content.
+        return static_cast<uint64_t>(m_stats.uploads) + m_drawListVersion;
+    }
+
+    bool StaticPropRenderPassModule::createShadowPipelines(const ShadowCasterInfo &info)
+    {
+        destroyShadowPipelines();
+        m_shadowRenderPass = info.renderPass;
+
+        const VkDescriptorSetLayout materialLayout = m_bindless ? m_bindless->layout() : m_materialSetLayout;
+        if (m_shadowSetLayout == VK_NULL_HANDLE || materialLayout == VK_NULL_HANDLE || info.setLayout == VK_NULL_HANDLE)
+            return false;
+
+        VkPushConstantRange pcRange{};
+        pcRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+        pcRange.offset = 0;
+        pcRange.size = sizeof(PushConstantsShadow);
+
+        VkDescriptorSetLayout setLayouts[3] = {m_shadowSetLayout, materialLayout, info.setLayout};
+        VkPipelineLayoutCreateInfo plInfo{};
+        plInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        plInfo.setLayoutCount = 3;
+        plInfo.pSetLayouts = setLayouts;
+        plInfo.pushConstantRangeCount = 1;
+        plInfo.pPushConstantRanges = &pcRange;
+        if (vkCreatePipelineLayout(m_device, &plInfo, nullptr, &m_shadowPipelineLayout) != VK_SUCCESS)
+            return false;
+
+        VkShaderModule vert = VK_NULL_HANDLE;
+        VkShaderModule frag = VK_NULL_HANDLE;
+        try
+        {
+            vert = Pipeline::createShaderModuleFromFile(m_device, "shaders/staticprop_shadow.vert.spv");
+            frag = Pipeline::createShaderModuleFromFile(m_device, m_bindless ? "shaders/shadow_mask_bindless.frag.spv" : "shaders/shadow_mask.frag.spv");
+        }
+        catch (const std::exception &)
+        {
+            // No mask shader: cards cast their whole quads.
+        }
+        if (vert == VK_NULL_HANDLE)
+        {
+            if (frag != VK_NULL_HANDLE)
+                vkDestroyShaderModule(m_device, frag, nullptr);
+            return false;
+        }
+
+        PipelineCreateInfo pci{};
+        pci.device = m_device;
+        pci.pipelineCache = m_pipelineCache;
+        pci.renderPass = info.renderPass;
+        pci.subpass = 0;
+        pci.pipelineLayout = m_shadowPipelineLayout;
+
+        VkVertexInputBindingDescription binding{};
+        binding.binding = 0;
+        binding.stride = smodel::SMODEL_PACKED_VERTEX_STRIDE;
+        binding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+        std::array<VkVertexInputAttributeDescription, 2> attrs{};
+        attrs[0] = {0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0}; // pos
+        attrs[1] = {2, 0, VK_FORMAT_R16G16_SFLOAT, 16};   // uv0 (alpha test)
+
+        VkPipelineVertexInputStateCreateInfo vi{};
+        vi.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+        vi.vertexBindingDescriptionCount = 1;
+        vi.pVertexBindingDescriptions = &binding;
+        vi.vertexAttributeDescriptionCount = static_cast<uint32_t>(attrs.size());
+        vi.pVertexAttributeDescriptions = attrs.data();
+        pci.vertexInput = vi;
+        pci.vertexInputProvided = true;
+
+        VkPipelineInputAssemblyStateCreateInfo ia{};
+        ia.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+        ia.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+        pci.inputAssembly = ia;
+        pci.inputAssemblyProvided = true;
+
+        VkPipelineRasterizationStateCreateInfo rs{};
+        rs.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+        rs.polygonMode = VK_POLYGON_MODE_FILL;
+        rs.lineWidth = 1.0f;
+        rs.cullMode = VK_CULL_MODE_NONE;
+        rs.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+        rs.depthBiasEnable = VK_TRUE;
+        rs.depthBiasConstantFactor = info.depthBiasConstant;
+        rs.depthBiasSlopeFactor = info.depthBiasSlope;
+        pci.rasterization = rs;
+        pci.rasterizationProvided = true;
+
+        pci.dynamicStates = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+
+        VkPipelineDepthStencilStateCreateInfo ds{};
+        ds.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+        ds.depthTestEnable = VK_TRUE;
+        ds.depthWriteEnable = VK_TRUE;
+        ds.depthCompareOp = VK_COMPARE_OP_LESS;
+        pci.depthStencil = ds;
+        pci.depthStencilProvided = true;
+
+        VkPipelineColorBlendStateCreateInfo cb{};
+        cb.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+        cb.attachmentCount = 0;
+        pci.colorBlend = cb;
+        pci.colorBlendProvided = true;
+
+        VkPipelineShaderStageCreateInfo vs{};
+        vs.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        vs.stage = VK_SHADER_STAGE_VERTEX_BIT;
+        vs.module = vert;
+        vs.pName = "main";
+        pci.shaderStages = {vs};
+        const VkResult r0 = m_pipelineShadow.create(pci);
+
+        m_shadowMaskReady = false;
+        if (frag != VK_NULL_HANDLE)
+        {
+            VkPipelineShaderStageCreateInfo fs = vs;
+            fs.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+            fs.module = frag;
+            pci.shaderStages = {vs, fs};
+            m_shadowMaskReady = m_pipelineShadowMask.create(pci) == VK_SUCCESS;
+            vkDestroyShaderModule(m_device, frag, nullptr);
+        }
+        vkDestroyShaderModule(m_device, vert, nullptr);
+        return r0 == VK_SUCCESS;
+    }
+
+    void StaticPropRenderPassModule::destroyShadowPipelines()
+    {
+        if (m_device == VK_NULL_HANDLE)
+            return;
+        m_pipelineShadow.destroy(m_device);
+        m_pipelineShadowMask.destroy(m_device);
+        m_shadowMaskReady = false;
+        if (m_shadowPipelineLayout != VK_NULL_HANDLE)
+        {
+            vkDestroyPipelineLayout(m_device, m_shadowPipelineLayout, nullptr);
+            m_shadowPipelineLayout = VK_NULL_HANDLE;
+        }
+        m_shadowRenderPass = VK_NULL_HANDLE;
+    }
+
+    void StaticPropRenderPassModule::recordShadow(FrameContext &frameCtx, VkCommandBuffer cmd, const ShadowCasterInfo &info)
+    {
+        // The tables on the GPU must match m_cells (uploaded in recordPrePass()).
+        if (m_frames.empty() || !m_assets || m_draws.empty() || m_uploadedCells == 0 || m_instancesDirty || !frameCtx.shadow)
+            return;
+        FrameData &frame = m_frames[frameCtx.frameIndex % static_cast<uint32_t>(m_frames.size())];
+        if (frame.shadowSet == VK_NULL_HANDLE)
+            return;
+
+        if (info.renderPass != m_shadowRenderPass && !m_shadowFailed)
+        {
+            m_shadowFailed = !createShadowPipelines(info);
+            if (m_shadowFailed)
+            {
+                destroyShadowPipelines();
+#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
+                std::cerr << "[StaticProps] staticprop_shadow.vert.spv unavailable; static props cast no shadows\n";
+#endif
+            }
+        }
+        if (m_shadowFailed)
+            return;
+
+        // Cells touching the cascade, merged into runs of the cell-sorted id list.
+        m_shadowRuns.clear();
+        for (const GpuCell &cell : m_cells)
+        {
+            if (!frameCtx.shadow->casterVisible(info.cascade, glm::vec3(cell.sphere), cell.sphere.w))
+                continue;
+            if (!m_shadowRuns.empty() && m_shadowRuns[m_shadowRuns.size() - 2u] + m_shadowRuns.back() == cell.first)
+            {
+                m_shadowRuns.back() += cell.count;
+                continue;
+            }
+            m_shadowRuns.push_back(cell.first);
+            m_shadowRuns.push_back(cell.count);
+        }
+        if (m_shadowRuns.empty())
+            return;
+
+        if (frame.boundShadowGeneration != m_generation)
+        {
+            VkDescriptorBufferInfo infos[2]{};
+            infos[0] = {m_instanceBuffer, 0, VK_WHOLE_SIZE};
+            infos[1] = {m_cellInstanceBuffer, 0, VK_WHOLE_SIZE};
+            VkWriteDescriptorSet writes[2]{};
+            for (uint32_t i = 0; i < 2u; ++i)
+            {
+                writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                writes[i].dstSet = frame.shadowSet;
+                writes[i].dstBinding = i;
+                writes[i].dstArrayElement = 0;
+                writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                writes[i].descriptorCount = 1;
+                writes[i].pBufferInfo = &infos[i];
+            }
+            vkUpdateDescriptorSets(m_device, 2, writes, 0, nullptr);
+            frame.boundShadowGeneration = m_generation;
+        }
+
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_shadowPipelineLayout, 0, 1, &frame.shadowSet, 0, nullptr);
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_shadowPipelineLayout, 2, 1, &info.set, 0, nullptr);
+        if (m_bindless)
+        {
+            VkDescriptorSet set = m_bindless->set();
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_shadowPipelineLayout, 1, 1, &set, 0, nullptr);
+        }
+
+        const Pipeline *boundPipe = nullptr;
+        VkBuffer boundVB = VK_NULL_HANDLE;
+        VkBuffer boundIB = VK_NULL_HANDLE;
+        uint64_t boundMaterial = UINT64_MAX;
+        uint32_t materialIndex = BindlessMaterials::FALLBACK_INDEX;
+        for (const PropDraw &d : m_draws)
+        {
+            if (d.pass > 1u)
+                continue; // blended surfaces cast no shadow
+            MaterialAsset *mat = m_assets->getMaterial(d.material);
+            if (!mat)
+                continue;
+            const bool masked = d.pass == 1u && m_shadowMaskReady;
+            const Pipeline *pipe = masked ? &m_pipelineShadowMask : &m_pipelineShadow;
+            if (pipe != boundPipe)
+            {
+                pipe->bind(cmd);
+                boundPipe = pipe;
+            }
+            if (masked && d.material.id != boundMaterial)
+            {
+                if (m_bindless)
+                    materialIndex = m_bindless->materialIndex(*m_assets, d.material);
+                else if (VkDescriptorSet matSet = getOrCreateMaterialSet(d.material, mat))
+                    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_shadowPipelineLayout, 1, 1, &matSet, 0, nullptr);
+                boundMaterial = d.material.id;
+            }
+            if (d.vertexBuffer != boundVB)
+            {
+                VkDeviceSize vbOffset = 0;
+                vkCmdBindVertexBuffers(cmd, 0, 1, &d.vertexBuffer, &vbOffset);
+                boundVB = d.vertexBuffer;
+            }
+            if (d.indexBuffer != boundIB)
+            {
+                vkCmdBindIndexBuffer(cmd, d.indexBuffer, 0, d.indexType);
+                boundIB = d.indexBuffer;
+            }
+
+            PushConstantsShadow pc{};
+            std::memcpy(pc.node, glm::value_ptr(d.node), sizeof(pc.node));
+            std::memcpy(pc.baseColorFactor, mat->baseColorFactor, sizeof(pc.baseColorFactor));
+            pc.materialParams[0] = mat->alphaCutoff;
+            pc.materialParams[1] = static_cast<float>(mat->alphaMode);
+            pc.info[2] = info.cascade;
+            pc.info[3] = materialIndex;
+            vkCmdPushConstants(cmd, m_shadowPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(PushConstantsShadow), &pc);
+
+            // gl_InstanceIndex = position in the cell-sorted id list.
+            for (size_t r = 0; r < m_shadowRuns.size(); r += 2u)
+            {
+                vkCmdDrawIndexed(cmd, d.indexCount, m_shadowRuns[r + 1u], d.firstIndex, d.vertexOffset, m_shadowRuns[r]);
+                DrawCallCounter::increment();
+            }
+        }
+    }
+
+    void StaticPropRenderPassModule::reportMemory(MemoryReport &out) const
+    {
+        uint64_t frameBytes = 0;
+        for (const FrameData &f : m_frames)
+            frameBytes += f.visibleMemory.size + f.impostorVisibleMemory.size + f.indirectMemory.size + f.counterMemory.size;
+
+        uint64_t residentBytes = m_instanceMemory.size + m_cellInstanceMemory.size + m_cellMemory.size;
+        for (const RetiredBuffer &r : m_retiredBuffers)
+            residentBytes += r.memory.size;
+
+        const uint64_t cpu = MemoryReport::bytesOf(m_instances) + MemoryReport::bytesOf(m_cellInstances) +
+                             MemoryReport::bytesOf(m_cells) + MemoryReport::bytesOf(m_cellKeys) +
+                             MemoryReport::bytesOf(m_draws) + MemoryReport::bytesOf(m_shadowRuns);
+
+        out.add("Render", "Static props (resident)", cpu, residentBytes + m_fallbackWhiteTexture.getGpuBytes(), m_liveInstances);
+        out.add("Render", "Static props (per frame)", 0, frameBytes, 1);
+    }
+
+    void StaticPropRenderPassModule::destroyResources()
+    {
+        if (m_device == VK_NULL_HANDLE)
+            return;
+
+        // Called after the renderer waited for the device to go idle.
+        releaseRetiredBuffers(true);
+        DestroyBuffer(m_device, m_instanceBuffer, m_instanceMemory);
+        DestroyBuffer(m_device, m_cellInstanceBuffer, m_cellInstanceMemory);
+        DestroyBuffer(m_device, m_cellBuffer, m_cellMemory);
+        m_instanceBytes = 0;
+        m_cellInstanceBytes = 0;
+        m_cellBytes = 0;
+        m_uploadedCells = 0;
+        m_instancesDirty = true; // a re-created pass uploads the CPU table again
+
+        destroyCullResources();
+        destroyImpostorResources();
+        destroyFrameResources();
+        destroyMaterialResources();
+
+        m_pipelineOpaque.destroy(m_device);
+        m_pipelineMask.destroy(m_device);
+        m_pipelineBlend.destroy(m_device);
+        m_pipelineDepth.destroy(m_device);
+        destroyShadowPipelines();
+        m_shadowFailed = false;
+        m_cullReady = false;
+
+        m_draws.clear();
+        m_drawListModel = nullptr;
+        m_drawListPrimitiveCount = 0;
+
+        if (m_pipelineLayout != VK_NULL_HANDLE)
+        {
+            vkDestroyPipelineLayout(m_device, m_pipelineLayout, nullptr);
+            m_pipelineLayout = VK_NULL_HANDLE;
+        }
+        if (m_receiverSetLayout != VK_NULL_HANDLE)
+        {
+            vkDestroyDescriptorSetLayout(m_device, m_receiverSetLayout, nullptr);
+            m_receiverSetLayout = VK_NULL_HANDLE;
+        }
+    }
+
+    void StaticPropRenderPassModule::onDestroy(VulkanContext &ctx)
+    {
+        (void)ctx;
+        destroyResources();
+    }
+
+} // namespace Engine
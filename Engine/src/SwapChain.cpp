@@ -6,6 +6,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <cctype>
+#include <initializer_list>
 
 namespace Engine
 {
@@ -43,6 +44,7 @@ namespace Engine
 
         VkSurfaceFormatKHR surfaceFormat = chooseSwapSurfaceFormat(formats);
         VkPresentModeKHR presentMode = chooseSwapPresentMode(presentModes);
+        m_AvailablePresentModes = presentModes;
         VkExtent2D extent = chooseSwapExtent(capabilities);
 
         uint32_t imageCount = capabilities.minImageCount + 1;
@@ -96,6 +98,8 @@ namespace Engine
 
         m_ImageFormat = surfaceFormat.format;
         m_Extent = extent;
+        m_PresentMode = presentMode;
+        m_RecreatePending = false;
 
         // create image views for use in framebuffers
         createImageViews();
@@ -139,6 +143,37 @@ namespace Engine
         Init();
     }
 
+    void SwapChain::RecreateRetiring(VkExtent2D newExtent, Retired &retired)
+    {
+        retired.swapchain = m_Swapchain;
+        retired.imageViews = std::move(m_ImageViews);
+        m_ImageViews.clear();
+        m_Extent = newExtent;
+        m_InitialExtent = newExtent; // surfaces without a fixed currentExtent follow the window
+        try
+        {
+            Init(); // oldSwapchain = the retired chain: presentation moves over without an idle wait
+        }
+        catch (...)
+        {
+            m_Swapchain = VK_NULL_HANDLE; // owned by `retired` now
+            throw;
+        }
+    }
+
+    void SwapChain::SetVSyncMode(VSyncMode mode)
+    {
+        if (mode == m_VSyncMode)
+            return;
+        m_VSyncMode = mode;
+        m_RecreatePending = true;
+    }
+
+    bool SwapChain::IsPresentModeSupported(VkPresentModeKHR mode) const
+    {
+        return std::find(m_AvailablePresentModes.begin(), m_AvailablePresentModes.end(), mode) != m_AvailablePresentModes.end();
+    }
+
     // helpers
     VkSurfaceFormatKHR SwapChain::chooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR> &available) const
     {
@@ -152,7 +187,30 @@ namespace Engine
 
     VkPresentModeKHR SwapChain::chooseSwapPresentMode(const std::vector<VkPresentModeKHR> &available) const
     {
-        // Optional override for profiling/diagnostics:
+        auto pick = [&](std::initializer_list<VkPresentModeKHR> preferred) -> VkPresentModeKHR
+        {
+            for (VkPresentModeKHR mode : preferred)
+            {
+                if (std::find(available.begin(), available.end(), mode) != available.end())
+                    return mode;
+            }
+            return VK_PRESENT_MODE_FIFO_KHR;
+        };
+
+        switch (m_VSyncMode)
+        {
+        case VSyncMode::On:
+            return VK_PRESENT_MODE_FIFO_KHR;
+        case VSyncMode::Off:
+            return pick({VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR});
+        case VSyncMode::Adaptive:
+            return pick({VK_PRESENT_MODE_FIFO_RELAXED_KHR});
+        case VSyncMode::Auto:
+        default:
+            break;
+        }
+
+        // Optional override for profiling/diagnostics (VSyncMode::Auto only):
         //   ENGINE_PRESENT_MODE=fifo|mailbox|immediate
         // When unset, we keep the default behavior (prefer MAILBOX, else FIFO).
         if (const char *env = std::getenv("ENGINE_PRESENT_MODE"))
@@ -192,12 +250,7 @@ namespace Engine
 #endif
         }
 
-        for (const auto &av : available)
-        {
-            if (av == VK_PRESENT_MODE_MAILBOX_KHR)
-                return av;
-        }
-        return VK_PRESENT_MODE_FIFO_KHR;
+        return pick({VK_PRESENT_MODE_MAILBOX_KHR});
     }
 
     VkExtent2D SwapChain::chooseSwapExtent(const VkSurfaceCapabilitiesKHR &capabilities) const
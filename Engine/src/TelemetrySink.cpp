@@ -0,0 +1,302 @@
+#include "utils/TelemetrySink.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace Engine
+{
+    namespace
+    {
+        // splitmix64 finalizer: spreads sequential or hand-picked session ids over [0, 1).
+        double sessionFraction(uint64_t id)
+        {
+            id += 0x9E3779B97F4A7C15ull;
+            id = (id ^ (id >> 30)) * 0xBF58476D1CE4E5B9ull;
+            id = (id ^ (id >> 27)) * 0x94D049BB133111EBull;
+            id ^= id >> 31;
+            return static_cast<double>(id >> 11) * (1.0 / 9007199254740992.0);
+        }
+
+        void closeSocket(intptr_t s)
+        {
+#ifdef _WIN32
+            closesocket(static_cast<SOCKET>(s));
+            WSACleanup();
+#else
+            ::close(static_cast<int>(s));
+#endif
+        }
+    }
+
+    bool TelemetryConfig::parse(const std::string &spec, TelemetryConfig &out)
+    {
+        if (spec.rfind("file:", 0) == 0 && spec.size() > 5)
+        {
+            out.transport = Transport::FileRing;
+            out.filePrefix = spec.substr(5);
+            return true;
+        }
+        if (spec.rfind("udp:", 0) == 0)
+        {
+            const size_t colon = spec.rfind(':');
+            if (colon <= 4 || colon + 1 >= spec.size())
+                return false;
+            const unsigned long port = std::strtoul(spec.c_str() + colon + 1, nullptr, 10);
+            if (port == 0 || port > 65535)
+                return false;
+            out.transport = Transport::Udp;
+            out.host = spec.substr(4, colon - 4);
+            out.port = static_cast<uint16_t>(port);
+            return true;
+        }
+        return false;
+    }
+
+    TelemetrySink::~TelemetrySink()
+    {
+        close();
+    }
+
+    bool TelemetrySink::open(const TelemetryConfig &config)
+    {
+        close();
+        m_config = config;
+        if (m_config.sessionId == 0)
+        {
+            std::random_device rd;
+            m_config.sessionId = (static_cast<uint64_t>(rd()) << 32) ^ rd();
+        }
+        m_config.intervalSec = std::max(0.1f, m_config.intervalSec);
+        m_config.segmentCount = std::max(1u, m_config.segmentCount);
+        m_config.segmentBytes = std::max<uint32_t>(m_config.segmentBytes, TELEMETRY_MAX_PACKET_BYTES * 4);
+        m_sampled = sessionFraction(m_config.sessionId) < static_cast<double>(m_config.sessionSampleRate);
+        m_sequence = 0;
+        m_packet.reserve(TELEMETRY_MAX_PACKET_BYTES);
+        m_batch.clear();
+
+        if (!m_sampled)
+        {
+            // Nothing will be sent: no socket or files for this session.
+            m_open = true;
+            return true;
+        }
+
+        if (m_config.transport == TelemetryConfig::Transport::Udp)
+        {
+#ifdef _WIN32
+            WSADATA wsa;
+            if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0)
+                return false;
+#endif
+            addrinfo hints{};
+            hints.ai_family = AF_INET;
+            hints.ai_socktype = SOCK_DGRAM;
+            addrinfo *result = nullptr;
+            const std::string port = std::to_string(m_config.port);
+            if (getaddrinfo(m_config.host.c_str(), port.c_str(), &hints, &result) != 0 || !result)
+            {
+#ifdef _WIN32
+                WSACleanup();
+#endif
+                return false;
+            }
+            m_address.assign(reinterpret_cast<const uint8_t *>(result->ai_addr),
+                             reinterpret_cast<const uint8_t *>(result->ai_addr) + result->ai_addrlen);
+            freeaddrinfo(result);
+
+#ifdef _WIN32
+            const SOCKET s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+            if (s == INVALID_SOCKET)
+            {
+                WSACleanup();
+                return false;
+            }
+            u_long nonBlocking = 1;
+            ioctlsocket(s, FIONBIO, &nonBlocking);
+            m_socket = static_cast<intptr_t>(s);
+#else
+            const int s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+            if (s < 0)
+                return false;
+            fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK);
+            m_socket = s;
+#endif
+        }
+        else if (m_config.transport == TelemetryConfig::Transport::FileRing)
+        {
+            m_segment = 0;
+            m_segmentUsed = 0;
+            m_file.open(m_config.filePrefix + ".0.bin", std::ios::binary | std::ios::trunc);
+            if (!m_file)
+                return false;
+        }
+        else
+        {
+            return false;
+        }
+
+        m_open = true;
+        return true;
+    }
+
+    void TelemetrySink::close()
+    {
+        if (m_open)
+            flush();
+        if (m_socket != -1)
+            closeSocket(m_socket);
+        m_socket = -1;
+        if (m_file.is_open())
+            m_file.close();
+        m_open = false;
+    }
+
+    void TelemetrySink::beginPacket(TelemetryPacket kind, uint32_t timeMs)
+    {
+        TelemetryPacketHeader h;
+        h.kind = static_cast<uint8_t>(kind);
+        h.sessionId = m_config.sessionId;
+        h.sequence = m_sequence;
+        h.timeMs = timeMs;
+        m_packet.clear();
+        m_packetOverflow = false;
+        putRaw(&h, sizeof(h));
+    }
+
+    void TelemetrySink::putRaw(const void *data, size_t size)
+    {
+        if (size > remaining())
+        {
+            m_packetOverflow = true;
+            return;
+        }
+        const size_t at = m_packet.size();
+        m_packet.resize(at + size);
+        std::memcpy(m_packet.data() + at, data, size);
+    }
+
+    void TelemetrySink::putString(const std::string &s)
+    {
+        const size_t room = remaining() > 0 ? remaining() - 1 : 0;
+        const size_t n = std::min<size_t>({s.size(), 255u, room});
+        putU8(static_cast<uint8_t>(n));
+        putRaw(s.data(), n);
+    }
+
+    void TelemetrySink::patchU16(size_t offset, uint16_t v)
+    {
+        if (offset + sizeof(v) <= m_packet.size())
+            std::memcpy(m_packet.data() + offset, &v, sizeof(v));
+    }
+
+    void TelemetrySink::endPacket()
+    {
+        if (!m_open || !m_sampled || m_packet.empty())
+            return;
+        if (m_packetOverflow)
+        {
+            // A producer bug, not a transport loss: never send a truncated record.
+            ++m_droppedPackets;
+            return;
+        }
+        ++m_sequence;
+        const uint16_t size = static_cast<uint16_t>(m_packet.size());
+        const size_t at = m_batch.size();
+        m_batch.resize(at + sizeof(size) + m_packet.size());
+        std::memcpy(m_batch.data() + at, &size, sizeof(size));
+        std::memcpy(m_batch.data() + at + sizeof(size), m_packet.data(), m_packet.size());
+    }
+
+    void TelemetrySink::flush()
+    {
+        if (m_batch.empty())
+            return;
+        if (m_socket != -1)
+            sendDatagrams();
+        else if (m_file.is_open())
+            writeFileRecords();
+        m_batch.clear();
+    }
+
+    void TelemetrySink::sendDatagrams()
+    {
+        size_t at = 0;
+        while (at + sizeof(uint16_t) <= m_batch.size())
+        {
+            uint16_t size = 0;
+            std::memcpy(&size, m_batch.data() + at, sizeof(size));
+            const char *packet = reinterpret_cast<const char *>(m_batch.data() + at + sizeof(size));
+            const auto *addr = reinterpret_cast<const sockaddr *>(m_address.data());
+#ifdef _WIN32
+            const int sent = sendto(static_cast<SOCKET>(m_socket), packet, size, 0, addr,
+                                    static_cast<int>(m_address.size()));
+#else
+            const ssize_t sent = sendto(static_cast<int>(m_socket), packet, size, 0, addr,
+                                        static_cast<socklen_t>(m_address.size()));
+#endif
+            if (sent >= 0 && static_cast<size_t>(sent) == size)
+            {
+                ++m_sentPackets;
+                m_sentBytes += size;
+            }
+            else
+            {
+                ++m_droppedPackets; // full send buffer or unreachable collector
+            }
+            at += sizeof(size) + size;
+        }
+    }
+
+    void TelemetrySink::writeFileRecords()
+    {
+        size_t at = 0;
+        while (at + sizeof(uint16_t) <= m_batch.size())
+        {
+            // Whole records per segment so every file parses on its own.
+            size_t end = at;
+            while (end + sizeof(uint16_t) <= m_batch.size())
+            {
+                uint16_t size = 0;
+                std::memcpy(&size, m_batch.data() + end, sizeof(size));
+                const size_t record = sizeof(size) + size;
+                if (m_segmentUsed + (end - at) + record > m_config.segmentBytes)
+                    break;
+                end += record;
+                ++m_sentPackets;
+            }
+            if (end > at)
+            {
+                m_file.write(reinterpret_cast<const char *>(m_batch.data() + at), static_cast<std::streamsize>(end - at));
+                m_segmentUsed += end - at;
+                m_sentBytes += end - at;
+                at = end;
+            }
+            if (at < m_batch.size())
+            {
+                m_file.close();
+                m_segment = (m_segment + 1) % m_config.segmentCount;
+                m_segmentUsed = 0;
+                m_file.open(m_config.filePrefix + "." + std::to_string(m_segment) + ".bin",
+                            std::ios::binary | std::ios::trunc);
+                if (!m_file)
+                    return;
+            }
+        }
+        m_file.flush();
+    }
+}
@@ -0,0 +1,264 @@
+#include "Engine/TerrainHeightfield.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+
+#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
+#include <iostream>
+#endif
+
+namespace Engine
+{
+    void TerrainHeightfield::createFlat(float originX, float originZ, float extentX, float extentZ, float height)
+    {
+        // 2x2 samples: bilinear lookups return the constant everywhere.
+        m_width = 2;
+        m_depth = 2;
+        m_spacingX = std::max(extentX, 1.0f);
+        m_spacingZ = std::max(extentZ, 1.0f);
+        m_originX = originX;
+        m_originZ = originZ;
+        m_heightScale = 0.0f;
+        m_heightOffset = height;
+        m_samples.assign(4, 0u);
+        m_splat.clear();
+        buildMinMax();
+        ++m_revision;
+    }
+
+    bool TerrainHeightfield::loadRaw16(const std::string &path, uint32_t width, uint32_t depth, float spacing,
+                                       float originX, float originZ, float heightScale, float heightOffset)
+    {
+        if (width < 2 || depth < 2 || spacing <= 0.0f)
+            return false;
+
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            return false;
+
+        const size_t count = static_cast<size_t>(width) * depth;
+        std::vector<uint16_t> samples(count);
+        std::vector<uint8_t> bytes(count * 2u);
+        file.read(reinterpret_cast<char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        if (static_cast<size_t>(file.gcount()) != bytes.size())
+        {
+#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
+            std::cerr << "[Terrain] " << path << ": expected " << bytes.size() << " bytes of height samples\n";
+#endif
+            return false;
+        }
+        for (size_t i = 0; i < count; ++i)
+            samples[i] = static_cast<uint16_t>(bytes[2 * i] | (bytes[2 * i + 1] << 8));
+
+        m_width = width;
+        m_depth = depth;
+        m_spacingX = spacing;
+        m_spacingZ = spacing;
+        m_originX = originX;
+        m_originZ = originZ;
+        m_heightScale = heightScale;
+        m_heightOffset = heightOffset;
+        m_samples = std::move(samples);
+        m_splat.clear();
+        buildMinMax();
+        ++m_revision;
+        return true;
+    }
+
+    bool TerrainHeightfield::loadSplatRaw(const std::string &path)
+    {
+        if (!valid())
+            return false;
+
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            return false;
+
+        std::vector<uint8_t> splat(static_cast<size_t>(m_width) * m_depth * 4u);
+        file.read(reinterpret_cast<char *>(splat.data()), static_cast<std::streamsize>(splat.size()));
+        if (static_cast<size_t>(file.gcount()) != splat.size())
+            return false;
+
+        m_splat = std::move(splat);
+        ++m_revision;
+        return true;
+    }
+
+    float TerrainHeightfield::heightAt(float x, float z) const
+    {
+        if (!valid())
+            return 0.0f;
+
+        const float fx = std::clamp((x - m_originX) / m_spacingX, 0.0f, static_cast<float>(m_width - 1));
+        const float fz = std::clamp((z - m_originZ) / m_spacingZ, 0.0f, static_cast<float>(m_depth - 1));
+        const uint32_t ix = std::min(static_cast<uint32_t>(fx), m_width - 2);
+        const uint32_t iz = std::min(static_cast<uint32_t>(fz), m_depth - 2);
+        const float tx = fx - static_cast<float>(ix);
+        const float tz = fz - static_cast<float>(iz);
+
+        const float h00 = sampleHeight(ix, iz);
+        const float h10 = sampleHeight(ix + 1, iz);
+        const float h01 = sampleHeight(ix, iz + 1);
+        const float h11 = sampleHeight(ix + 1, iz + 1);
+        const float h0 = h00 + (h10 - h00) * tx;
+        const float h1 = h01 + (h11 - h01) * tx;
+        return h0 + (h1 - h0) * tz;
+    }
+
+    glm::vec4 TerrainHeightfield::splatAt(float x, float z, float footprint) const
+    {
+        if (!valid())
+            return glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
+
+        if (!m_splat.empty())
+        {
+            // Nearest sample: splat maps are authored at height resolution.
+            const float fx = std::clamp((x - m_originX) / m_spacingX + 0.5f, 0.0f, static_cast<float>(m_width - 1));
+            const float fz = std::clamp((z - m_originZ) / m_spacingZ + 0.5f, 0.0f, static_cast<float>(m_depth - 1));
+            const size_t i = (static_cast<size_t>(fz) * m_width + static_cast<size_t>(fx)) * 4u;
+            glm::vec4 w(m_splat[i], m_splat[i + 1], m_splat[i + 2], m_splat[i + 3]);
+            const float sum = w.x + w.y + w.z + w.w;
+            return sum > 0.0f ? w / sum : glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
+        }
+
+        // Slope from central differences across the caller's footprint.
+        const float d = std::max(footprint, std::min(m_spacingX, m_spacingZ));
+        const float dx = heightAt(x + d, z) - heightAt(x - d, z);
+        const float dz = heightAt(x, z + d) - heightAt(x, z - d);
+        const float ny = (2.0f * d) / std::sqrt(dx * dx + dz * dz + 4.0f * d * d);
+
+        // ~40 degrees and steeper is rock (layer 1).
+        const float t = std::clamp((0.85f - ny) / (0.85f - 0.7f), 0.0f, 1.0f);
+        const float rock = t * t * (3.0f - 2.0f * t);
+        return glm::vec4(1.0f - rock, rock, 0.0f, 0.0f);
+    }
+
+    void TerrainHeightfield::buildMinMax()
+    {
+        m_minMax.clear();
+        m_minMaxDimX.clear();
+        m_minMaxDimZ.clear();
+
+        const uint32_t cellsX = m_width - 1;
+        const uint32_t cellsZ = m_depth - 1;
+        uint32_t dimX = (cellsX + MINMAX_LEAF - 1) / MINMAX_LEAF;
+        uint32_t dimZ = (cellsZ + MINMAX_LEAF - 1) / MINMAX_LEAF;
+
+        std::vector<glm::vec2> leaf(static_cast<size_t>(dimX) * dimZ);
+        m_minHeight = std::numeric_limits<float>::max();
+        m_maxHeight = -std::numeric_limits<float>::max();
+        for (uint32_t bz = 0; bz < dimZ; ++bz)
+        {
+            for (uint32_t bx = 0; bx < dimX; ++bx)
+            {
+                // A block's cells touch samples [b*LEAF, (b+1)*LEAF] inclusive.
+                const uint32_t x0 = bx * MINMAX_LEAF;
+                const uint32_t z0 = bz * MINMAX_LEAF;
+                const uint32_t x1 = std::min(x0 + MINMAX_LEAF, m_width - 1);
+                const uint32_t z1 = std::min(z0 + MINMAX_LEAF, m_depth - 1);
+                glm::vec2 mm(std::numeric_limits<float>::max(), -std::numeric_limits<float>::max());
+                for (uint32_t iz = z0; iz <= z1; ++iz)
+                {
+                    for (uint32_t ix = x0; ix <= x1; ++ix)
+                    {
+                        const float h = sampleHeight(ix, iz);
+                        mm.x = std::min(mm.x, h);
+                        mm.y = std::max(mm.y, h);
+                    }
+                }
+                leaf[static_cast<size_t>(bz) * dimX + bx] = mm;
+                m_minHeight = std::min(m_minHeight, mm.x);
+                m_maxHeight = std::max(m_maxHeight, mm.y);
+            }
+        }
+        m_minMax.push_back(std::move(leaf));
+        m_minMaxDimX.push_back(dimX);
+        m_minMaxDimZ.push_back(dimZ);
+
+        while (dimX > 1 || dimZ > 1)
+        {
+            const uint32_t nx = (dimX + 1) / 2;
+            const uint32_t nz = (dimZ + 1) / 2;
+            const std::vector<glm::vec2> &src = m_minMax.back();
+            std::vector<glm::vec2> dst(static_cast<size_t>(nx) * nz);
+            for (uint32_t z = 0; z < nz; ++z)
+            {
+                for (uint32_t x = 0; x < nx; ++x)
+                {
+                    glm::vec2 mm(std::numeric_limits<float>::max(), -std::numeric_limits<float>::max());
+                    for (uint32_t k = 0; k < 4; ++k)
+                    {
+                        const uint32_t sx = x * 2 + (k & 1u);
+                        const uint32_t sz = z * 2 + (k >> 1);
+                        if (sx >= dimX || sz >= dimZ)
+                            continue;
+                        const glm::vec2 &s = src[static_cast<size_t>(sz) * dimX + sx];
+                        mm.x = std::min(mm.x, s.x);
+                        mm.y = std::max(mm.y, s.y);
+                    }
+                    dst[static_cast<size_t>(z) * nx + x] = mm;
+                }
+            }
+            m_minMax.push_back(std::move(dst));
+            m_minMaxDimX.push_back(nx);
+            m_minMaxDimZ.push_back(nz);
+            dimX = nx;
+            dimZ = nz;
+        }
+    }
+
+    void TerrainHeightfield::heightRange(float x0, float z0, float x1, float z1, float &outMin, float &outMax) const
+    {
+        outMin = m_minHeight;
+        outMax = m_maxHeight;
+        if (!valid() || m_minMax.empty())
+            return;
+
+        // Rectangle in leaf blocks (clamped: outside the map the edge samples repeat).
+        const float blockX = m_spacingX * static_cast<float>(MINMAX_LEAF);
+        const float blockZ = m_spacingZ * static_cast<float>(MINMAX_LEAF);
+        const int32_t maxBx = static_cast<int32_t>(m_minMaxDimX[0]) - 1;
+        const int32_t maxBz = static_cast<int32_t>(m_minMaxDimZ[0]) - 1;
+        int32_t bx0 = std::clamp(static_cast<int32_t>(std::floor((x0 - m_originX) / blockX)), 0, maxBx);
+        int32_t bx1 = std::clamp(static_cast<int32_t>(std::floor((x1 - m_originX) / blockX)), 0, maxBx);
+        int32_t bz0 = std::clamp(static_cast<int32_t>(std::floor((z0 - m_originZ) / blockZ)), 0, maxBz);
+        int32_t bz1 = std::clamp(static_cast<int32_t>(std::floor((z1 - m_originZ) / blockZ)), 0, maxBz);
+
+        // Coarsest level that still keeps the lookup within ~4x4 blocks.
+        size_t level = 0;
+        while (level + 1 < m_minMax.size() && std::max(bx1 - bx0, bz1 - bz0) > 3)
+        {
+            bx0 >>= 1;
+            bx1 >>= 1;
+            bz0 >>= 1;
+            bz1 >>= 1;
+            ++level;
+        }
+
+        const std::vector<glm::vec2> &mm = m_minMax[level];
+        const uint32_t dimX = m_minMaxDimX[level];
+        float lo = std::numeric_limits<float>::max();
+        float hi = -std::numeric_limits<float>::max();
+        for (int32_t bz = bz0; bz <= bz1; ++bz)
+        {
+            for (int32_t bx = bx0; bx <= bx1; ++bx)
+            {
+                const glm::vec2 &v = mm[static_cast<size_t>(bz) * dimX + static_cast<size_t>(bx)];
+                lo = std::min(lo, v.x);
+                hi = std::max(hi, v.y);
+            }
+        }
+        outMin = lo;
+        outMax = hi;
+    }
+
+    uint64_t TerrainHeightfield::memoryBytes() const
+    {
+        uint64_t bytes = m_samples.capacity() * sizeof(uint16_t) + m_splat.capacity();
+        for (const auto &level : m_minMax)
+            bytes += level.capacity() * sizeof(glm::vec2);
+        return bytes;
+    }
+}
@@ -0,0 +1,970 @@
+#include "Engine/TerrainRenderPassModule.h"
+
+#include "Engine/TerrainHeightfield.h"
+#include "Engine/VulkanContext.h"
+#include "Engine/SwapChain.h"
+#include "Engine/PerformanceMonitor.h"
+
+#include "utils/ImageUtils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace Engine
+{
+    namespace
+    {
+        constexpr VkDeviceSize kTileHeightBytes = VkDeviceSize(TerrainRenderPassModule::TILE_SAMPLES) * TerrainRenderPassModule::TILE_SAMPLES * sizeof(float);
+        constexpr VkDeviceSize kTileSplatBytes = VkDeviceSize(TerrainRenderPassModule::TILE_SAMPLES) * TerrainRenderPassModule::TILE_SAMPLES * 4u;
+        constexpr VkDeviceSize kTileBytes = kTileHeightBytes + kTileSplatBytes;
+    }
+
+    void TerrainRenderPassModule::setLayerTexture(uint32_t layer, TextureHandle tex, float metersPerRepeat)
+    {
+        if (layer >= LAYER_COUNT)
+            return;
+        m_layerTextures[layer] = tex;
+        m_layerMetersPerRepeat[layer] = std::max(metersPerRepeat, 0.001f);
+    }
+
+    void TerrainRenderPassModule::onCreate(VulkanContext &ctx, VkRenderPass pass, const std::vector<VkFramebuffer> &fbs)
+    {
+        m_device = ctx.GetDevice();
+        m_physicalDevice = ctx.GetPhysicalDevice();
+        m_extent = ctx.GetSwapChain() ? ctx.GetSwapChain()->GetExtent() : VkExtent2D{};
+
+        const size_t frameCount = (fbs.empty() ? 1u : fbs.size());
+
+        if (!createFrameResources(ctx, frameCount))
+            throw std::runtime_error("TerrainRenderPassModule: failed to create frame resources");
+
+        if (!createTileCache(ctx))
+            throw std::runtime_error("TerrainRenderPassModule: failed to create tile cache");
+
+        if (!createPatchMesh(ctx))
+            throw std::runtime_error("TerrainRenderPassModule: failed to create patch mesh");
+
+        writeLayerDescriptors();
+        createPipelines(ctx, pass);
+    }
+
+    void TerrainRenderPassModule::onResize(VulkanContext &ctx, VkExtent2D newExtent)
+    {
+        (void)ctx;
+        m_extent = newExtent;
+    }
+
+    void TerrainRenderPassModule::onDestroy(VulkanContext &ctx)
+    {
+        (void)ctx;
+
+        if (m_device == VK_NULL_HANDLE)
+            return;
+
+        m_pipeline.destroy(m_device);
+        m_pipelineDepth.destroy(m_device);
+        if (m_pipelineLayout != VK_NULL_HANDLE)
+        {
+            vkDestroyPipelineLayout(m_device, m_pipelineLayout, nullptr);
+            m_pipelineLayout = VK_NULL_HANDLE;
+        }
+        if (m_receiverSetLayout != VK_NULL_HANDLE)
+        {
+            vkDestroyDescriptorSetLayout(m_device, m_receiverSetLayout, nullptr);
+            m_receiverSetLayout = VK_NULL_HANDLE;
+        }
+
+        DestroyVertexBuffer(m_device, m_patchVB);
+        DestroyIndexBuffer(m_device, m_patchIB);
+        m_patchIndexCount = 0;
+
+        destroyTileCache();
+        destroyFrameResources();
+
+        m_device = VK_NULL_HANDLE;
+        m_physicalDevice = VK_NULL_HANDLE;
+        m_extent = {};
+    }
+
+    bool TerrainRenderPassModule::createFrameResources(VulkanContext &ctx, size_t frameCount)
+    {
+        destroyFrameResources();
+
+        // 0: camera UBO, 1: selected nodes, 2: height tiles, 3: splat tiles, 4: layer textures
+        VkDescriptorSetLayoutBinding bindings[5]{};
+        bindings[0].binding = 0;
+        bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+        bindings[0].descriptorCount = 1;
+        bindings[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+
+        bindings[1].binding = 1;
+        bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[1].descriptorCount = 1;
+        bindings[1].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+        bindings[2].binding = 2;
+        bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        bindings[2].descriptorCount = 1;
+        bindings[2].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+        bindings[3].binding = 3;
+        bindings[3].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        bindings[3].descriptorCount = 1;
+        bindings[3].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+        bindings[4].binding = 4;
+        bindings[4].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        bindings[4].descriptorCount = LAYER_COUNT;
+        bindings[4].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+        VkDescriptorSetLayoutCreateInfo dsl{};
+        dsl.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        dsl.bindingCount = 5;
+        dsl.pBindings = bindings;
+        if (vkCreateDescriptorSetLayout(ctx.GetDevice(), &dsl, nullptr, &m_setLayout) != VK_SUCCESS)
+            return false;
+
+        const uint32_t frames = static_cast<uint32_t>(frameCount);
+        VkDescriptorPoolSize poolSizes[3]{};
+        poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+        poolSizes[0].descriptorCount = frames;
+        poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        poolSizes[1].descriptorCount = frames;
+        poolSizes[2].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        poolSizes[2].descriptorCount = frames * (2u + LAYER_COUNT);
+
+        VkDescriptorPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.maxSets = frames;
+        poolInfo.poolSizeCount = 3;
+        poolInfo.pPoolSizes = poolSizes;
+        if (vkCreateDescriptorPool(ctx.GetDevice(), &poolInfo, nullptr, &m_pool) != VK_SUCCESS)
+            return false;
+
+        std::vector<VkDescriptorSetLayout> layouts(frameCount, m_setLayout);
+        std::vector<VkDescriptorSet> sets(frameCount, VK_NULL_HANDLE);
+        VkDescriptorSetAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = m_pool;
+        allocInfo.descriptorSetCount = frames;
+        allocInfo.pSetLayouts = layouts.data();
+        if (vkAllocateDescriptorSets(ctx.GetDevice(), &allocInfo, sets.data()) != VK_SUCCESS)
+            return false;
+
+        const VkMemoryPropertyFlags hostProps = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+        m_frames.resize(frameCount);
+        for (size_t i = 0; i < frameCount; ++i)
+        {
+            FrameData &f = m_frames[i];
+            f.set = sets[i];
+
+            if (CreateBuffer(ctx.GetDevice(), ctx.GetPhysicalDevice(), VkDeviceSize(MAX_NODES) * sizeof(GpuNode), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                             hostProps, f.nodeBuffer, f.nodeMemory) != VK_SUCCESS ||
+                !f.nodeMemory.mapped)
+                return false;
+
+            if (CreateBuffer(ctx.GetDevice(), ctx.GetPhysicalDevice(), VkDeviceSize(TILE_UPLOADS_PER_FRAME) * kTileBytes, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                             hostProps, f.stagingBuffer, f.stagingMemory) != VK_SUCCESS ||
+                !f.stagingMemory.mapped)
+                return false;
+
+            // Binding 0 (camera) is written by recordPrePass() once the upload ring is known.
+            VkDescriptorBufferInfo nbi{};
+            nbi.buffer = f.nodeBuffer;
+            nbi.offset = 0;
+            nbi.range = VkDeviceSize(MAX_NODES) * sizeof(GpuNode);
+
+            VkWriteDescriptorSet write{};
+            write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            write.dstSet = f.set;
+            write.dstBinding = 1;
+            write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            write.descriptorCount = 1;
+            write.pBufferInfo = &nbi;
+
+            vkUpdateDescriptorSets(ctx.GetDevice(), 1, &write, 0, nullptr);
+        }
+        return true;
+    }
+
+    void TerrainRenderPassModule::destroyFrameResources()
+    {
+        for (FrameData &f : m_frames)
+        {
+            DestroyBuffer(m_device, f.nodeBuffer, f.nodeMemory);
+            DestroyBuffer(m_device, f.stagingBuffer, f.stagingMemory);
+            f.set = VK_NULL_HANDLE;
+        }
+        m_frames.clear();
+
+        if (m_pool != VK_NULL_HANDLE)
+        {
+            vkDestroyDescriptorPool(m_device, m_pool, nullptr);
+            m_pool = VK_NULL_HANDLE;
+        }
+        if (m_setLayout != VK_NULL_HANDLE)
+        {
+            vkDestroyDescriptorSetLayout(m_device, m_setLayout, nullptr);
+            m_setLayout = VK_NULL_HANDLE;
+        }
+    }
+
+    bool TerrainRenderPassModule::createTileCache(VulkanContext &ctx)
+    {
+        destroyTileCache();
+
+        auto createArray = [&](VkFormat format, VkImage &image, GpuAllocation &memory, VkImageView &view) -> bool
+        {
+            VkImageCreateInfo ii{};
+            ii.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+            ii.imageType = VK_IMAGE_TYPE_2D;
+            ii.extent = {TILE_SAMPLES, TILE_SAMPLES, 1};
+            ii.mipLevels = 1;
+            ii.arrayLayers = TILE_CACHE_LAYERS;
+            ii.format = format;
+            ii.tiling = VK_IMAGE_TILING_OPTIMAL;
+            ii.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            ii.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+            ii.samples = VK_SAMPLE_COUNT_1_BIT;
+            ii.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            if (vkCreateImage(ctx.GetDevice(), &ii, nullptr, &image) != VK_SUCCESS)
+                return false;
+            if (AllocateImageMemory(ctx.GetDevice(), ctx.GetPhysicalDevice(), image, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, memory) != VK_SUCCESS)
+                return false;
+
+            VkImageViewCreateInfo vi{};
+            vi.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+            vi.image = image;
+            vi.viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+            vi.format = format;
+            vi.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            vi.subresourceRange.baseMipLevel = 0;
+            vi.subresourceRange.levelCount = 1;
+            vi.subresourceRange.baseArrayLayer = 0;
+            vi.subresourceRange.layerCount = TILE_CACHE_LAYERS;
+            return vkCreateImageView(ctx.GetDevice(), &vi, nullptr, &view) == VK_SUCCESS;
+        };
+
+        // R32F heights: sampled images of R32_SFLOAT are always supported, linear filtering of them
+        // is not, so terrain.vert fetches texels and filters them itself.
+        if (!createArray(VK_FORMAT_R32_SFLOAT, m_heightImage, m_heightMemory, m_heightView))
+            return false;
+        if (!createArray(VK_FORMAT_R8G8B8A8_UNORM, m_splatImage, m_splatMemory, m_splatView))
+            return false;
+
+        // Nearest: terrain.vert only uses texelFetch on the tiles.
+        if (CreateTextureSampler(ctx.GetDevice(), ctx.GetPhysicalDevice(),
+                                 VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+                                 VK_FILTER_NEAREST, VK_FILTER_NEAREST, VK_SAMPLER_MIPMAP_MODE_NEAREST, 1.0f, m_tileSampler) != VK_SUCCESS)
+            return false;
+        m_tileImagesInitialized = false;
+
+        // Fallback 1x1 white texture for unset layers (sRGB)
+        {
+            VkCommandPoolCreateInfo poolInfo{};
+            poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+            poolInfo.queueFamilyIndex = ctx.GetGraphicsQueueFamilyIndex();
+            poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+            VkCommandPool uploadPool = VK_NULL_HANDLE;
+            if (vkCreateCommandPool(ctx.GetDevice(), &poolInfo, nullptr, &uploadPool) != VK_SUCCESS)
+                return false;
+
+            UploadContext upload{};
+            if (!BeginUploadContext(upload, ctx.GetDevice(), ctx.GetPhysicalDevice(), uploadPool, ctx.GetGraphicsQueue()))
+            {
+                vkDestroyCommandPool(ctx.GetDevice(), uploadPool, nullptr);
+                return false;
+            }
+
+            const uint8_t white[4] = {255, 255, 255, 255};
+            const bool ok = m_fallbackWhiteTexture.uploadRGBA8_Deferred(
+                upload, white, 1, 1, true,
+                VK_SAMPLER_ADDRESS_MODE_REPEAT, VK_SAMPLER_ADDRESS_MODE_REPEAT,
+                VK_FILTER_LINEAR, VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_NEAREST, 1.0f);
+
+            const bool submitted = ok && EndSubmitAndWait(upload);
+            vkDestroyCommandPool(ctx.GetDevice(), uploadPool, nullptr);
+            if (!submitted)
+                return false;
+        }
+
+        resetTileCache();
+        return true;
+    }
+
+    void TerrainRenderPassModule::destroyTileCache()
+    {
+        if (m_device == VK_NULL_HANDLE)
+            return;
+
+        if (m_tileSampler != VK_NULL_HANDLE)
+        {
+            vkDestroySampler(m_device, m_tileSampler, nullptr);
+            m_tileSampler = VK_NULL_HANDLE;
+        }
+        if (m_heightView != VK_NULL_HANDLE)
+        {
+            vkDestroyImageView(m_device, m_heightView, nullptr);
+            m_heightView = VK_NULL_HANDLE;
+        }
+        if (m_heightImage != VK_NULL_HANDLE)
+        {
+            vkDestroyImage(m_device, m_heightImage, nullptr);
+            m_heightImage = VK_NULL_HANDLE;
+        }
+        FreeGpuMemory(m_device, m_heightMemory);
+        if (m_splatView != VK_NULL_HANDLE)
+        {
+            vkDestroyImageView(m_device, m_splatView, nullptr);
+            m_splatView = VK_NULL_HANDLE;
+        }
+        if (m_splatImage != VK_NULL_HANDLE)
+        {
+            vkDestroyImage(m_device, m_splatImage, nullptr);
+            m_splatImage = VK_NULL_HANDLE;
+        }
+        FreeGpuMemory(m_device, m_splatMemory);
+
+        if (m_fallbackWhiteTexture.isValid())
+            m_fallbackWhiteTexture.destroy(m_device);
+
+        m_tileImagesInitialized = false;
+        m_tileSlots.clear();
+        m_tileByKey.clear();
+    }
+
+    bool TerrainRenderPassModule::createPatchMesh(VulkanContext &ctx)
+    {
+        // Integer grid coordinates; terrain.vert places, morphs and displaces them per node.
+        constexpr uint32_t side = PATCH_QUADS + 1;
+        static_assert(side * side <= 65536u, "patch vertices must fit 16-bit indices");
+
+        std::vector<glm::vec2> verts;
+        verts.reserve(side * side);
+        for (uint32_t z = 0; z < side; ++z)
+            for (uint32_t x = 0; x < side; ++x)
+                verts.emplace_back(static_cast<float>(x), static_cast<float>(z));
+
+        std::vector<uint16_t> indices;
+        indices.reserve(PATCH_QUADS * PATCH_QUADS * 6u);
+        for (uint32_t z = 0; z < PATCH_QUADS; ++z)
+        {
+            for (uint32_t x = 0; x < PATCH_QUADS; ++x)
+            {
+                const uint16_t i00 = static_cast<uint16_t>(z * side + x);
+                const uint16_t i10 = static_cast<uint16_t>(i00 + 1);
+                const uint16_t i01 = static_cast<uint16_t>(i00 + side);
+                const uint16_t i11 = static_cast<uint16_t>(i01 + 1);
+                indices.insert(indices.end(), {i00, i01, i10, i10, i01, i11});
+            }
+        }
+        m_patchIndexCount = static_cast<uint32_t>(indices.size());
+
+        if (CreateOrUpdateVertexBuffer(ctx.GetDevice(), ctx.GetPhysicalDevice(), verts.data(), verts.size() * sizeof(glm::vec2), m_patchVB) != VK_SUCCESS)
+            return false;
+        return CreateOrUpdateIndexBuffer(ctx.GetDevice(), ctx.GetPhysicalDevice(), indices.data(), indices.size() * sizeof(uint16_t), m_patchIB) == VK_SUCCESS;
+    }
+
+    void TerrainRenderPassModule::writeLayerDescriptors()
+    {
+        VkDescriptorImageInfo heightInfo{};
+        heightInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        heightInfo.imageView = m_heightView;
+        heightInfo.sampler = m_tileSampler;
+
+        VkDescriptorImageInfo splatInfo = heightInfo;
+        splatInfo.imageView = m_splatView;
+
+        // Unset layers repeat layer 0 (the ground texture), or white without one.
+        std::array<VkDescriptorImageInfo, LAYER_COUNT> layerInfos{};
+        VkImageView baseView = m_fallbackWhiteTexture.getView();
+        VkSampler baseSampler = m_fallbackWhiteTexture.getSampler();
+        for (uint32_t i = 0; i < LAYER_COUNT; ++i)
+        {
+            VkImageView view = VK_NULL_HANDLE;
+            VkSampler sampler = VK_NULL_HANDLE;
+            if (m_assets && m_layerTextures[i].isValid())
+            {
+                if (TextureAsset *tex = m_assets->getTexture(m_layerTextures[i]))
+                {
+                    view = tex->getView();
+                    sampler = tex->getSampler();
+                }
+            }
+            if (view == VK_NULL_HANDLE || sampler == VK_NULL_HANDLE)
+            {
+                view = baseView;
+                sampler = baseSampler;
+            }
+            else if (i == 0)
+            {
+                baseView = view;
+                baseSampler = sampler;
+            }
+
+            layerInfos[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            layerInfos[i].imageView = view;
+            layerInfos[i].sampler = sampler;
+        }
+
+        for (FrameData &f : m_frames)
+        {
+            VkWriteDescriptorSet writes[3]{};
+            writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[0].dstSet = f.set;
+            writes[0].dstBinding = 2;
+            writes[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            writes[0].descriptorCount = 1;
+            writes[0].pImageInfo = &heightInfo;
+
+            writes[1] = writes[0];
+            writes[1].dstBinding = 3;
+            writes[1].pImageInfo = &splatInfo;
+
+            writes[2] = writes[0];
+            writes[2].dstBinding = 4;
+            writes[2].descriptorCount = LAYER_COUNT;
+            writes[2].pImageInfo = layerInfos.data();
+
+            vkUpdateDescriptorSets(m_device, 3, writes, 0, nullptr);
+        }
+    }
+
+    void TerrainRenderPassModule::createPipelines(VulkanContext &ctx, VkRenderPass pass)
+    {
+        if (m_receiverSetLayout == VK_NULL_HANDLE &&
+            ShadowCascades::createReceiverSetLayout(ctx.GetDevice(), m_receiverSetLayout) != VK_SUCCESS)
+            throw std::runtime_error("TerrainRenderPassModule: failed to create shadow receiver set layout");
+
+        const VkDescriptorSetLayout setLayouts[2] = {m_setLayout, m_receiverSetLayout};
+        VkPipelineLayoutCreateInfo plInfo{};
+        plInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        plInfo.setLayoutCount = 2;
+        plInfo.pSetLayouts = setLayouts;
+        if (vkCreatePipelineLayout(ctx.GetDevice(), &plInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS)
+            throw std::runtime_error("TerrainRenderPassModule: failed to create pipeline layout");
+
+        PipelineCreateInfo pci{};
+        pci.device = ctx.GetDevice();
+        pci.pipelineCache = ctx.GetPipelineCache();
+        pci.renderPass = pass;
+        pci.subpass = 0;
+        pci.pipelineLayout = m_pipelineLayout;
+
+        VkShaderModule vert = Pipeline::createShaderModuleFromFile(pci.device, "shaders/terrain.vert.spv");
+        VkShaderModule frag = Pipeline::createShaderModuleFromFile(pci.device, "shaders/terrain.frag.spv");
+
+        VkPipelineShaderStageCreateInfo vs{};
+        vs.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        vs.stage = VK_SHADER_STAGE_VERTEX_BIT;
+        vs.module = vert;
+        vs.pName = "main";
+
+        VkPipelineShaderStageCreateInfo fs{};
+        fs.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        fs.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+        fs.module = frag;
+        fs.pName = "main";
+
+        pci.shaderStages = {vs, fs};
+
+        VkVertexInputBindingDescription binding{};
+        binding.binding = 0;
+        binding.stride = sizeof(glm::vec2);
+        binding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+        VkVertexInputAttributeDescription attr{0, 0, VK_FORMAT_R32G32_SFLOAT, 0}; // grid coordinate
+
+        VkPipelineVertexInputStateCreateInfo vi{};
+        vi.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+        vi.vertexBindingDescriptionCount = 1;
+        vi.pVertexBindingDescriptions = &binding;
+        vi.vertexAttributeDescriptionCount = 1;
+        vi.pVertexAttributeDescriptions = &attr;
+        pci.vertexInput = vi;
+        pci.vertexInputProvided = true;
+
+        VkPipelineInputAssemblyStateCreateInfo ia{};
+        ia.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+        ia.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+        ia.primitiveRestartEnable = VK_FALSE;
+        pci.inputAssembly = ia;
+        pci.inputAssemblyProvided = true;
+
+        VkPipelineRasterizationStateCreateInfo rs{};
+        rs.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+        rs.depthClampEnable = VK_FALSE;
+        rs.rasterizerDiscardEnable = VK_FALSE;
+        rs.polygonMode = VK_POLYGON_MODE_FILL;
+        rs.lineWidth = 1.0f;
+        rs.cullMode = VK_CULL_MODE_NONE;
+        rs.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+        rs.depthBiasEnable = VK_FALSE;
+        pci.rasterization = rs;
+        pci.rasterizationProvided = true;
+
+        // LESS_OR_EQUAL: the colour pass lands on the depth the prepass wrote.
+        VkPipelineDepthStencilStateCreateInfo ds{};
+        ds.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+        ds.depthTestEnable = VK_TRUE;
+        ds.depthWriteEnable = VK_TRUE;
+        ds.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+        ds.depthBoundsTestEnable = VK_FALSE;
+        ds.stencilTestEnable = VK_FALSE;
+        pci.depthStencil = ds;
+        pci.depthStencilProvided = true;
+
+        VkPipelineColorBlendAttachmentState att{};
+        att.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+                             VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+        att.blendEnable = VK_FALSE;
+
+        VkPipelineColorBlendStateCreateInfo cb{};
+        cb.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+        cb.logicOpEnable = VK_FALSE;
+        cb.attachmentCount = 1;
+        cb.pAttachments = &att;
+        pci.colorBlend = cb;
+        pci.colorBlendProvided = true;
+
+        pci.dynamicStates = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+
+        const VkResult r0 = m_pipeline.create(pci);
+
+        // Depth prepass: the vertex stage alone decides the depth; no colour writes.
+        att.colorWriteMask = 0;
+        pci.depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+        const VkResult r1 = m_pipelineDepth.create(pci);
+
+        vkDestroyShaderModule(pci.device, vert, nullptr);
+        vkDestroyShaderModule(pci.device, frag, nullptr);
+
+        if (r0 != VK_SUCCESS || r1 != VK_SUCCESS)
+            throw std::runtime_error("TerrainRenderPassModule: failed to create pipelines");
+    }
+
+    float TerrainRenderPassModule::nodeSize(uint32_t lod) const
+    {
+        return static_cast<float>(PATCH_QUADS) * std::max(m_cfg.baseSpacing, 0.01f) * static_cast<float>(1u << lod);
+    }
+
+    float TerrainRenderPassModule::lodRange(uint32_t lod) const
+    {
+        // A band must span at least one node of the next level for the morph to meet it.
+        const float range0 = std::max(m_cfg.lod0Range, 2.0f * nodeSize(0));
+        return range0 * static_cast<float>(1u << lod);
+    }
+
+    void TerrainRenderPassModule::selectNodes(const glm::vec3 &cameraPos, const glm::mat4 &viewProj)
+    {
+        m_selected.clear();
+        m_selectCamera = cameraPos;
+        m_selectFrustum = Frustum::fromViewProjection(viewProj);
+
+        // Fewest levels whose root node covers the map's longer side.
+        const float extent = std::max(m_heightfield->extentX(), m_heightfield->extentZ());
+        m_lodCount = 1;
+        while (m_lodCount < MAX_LOD_LEVELS && nodeSize(m_lodCount - 1) < extent)
+            ++m_lodCount;
+
+        const float rootSize = nodeSize(m_lodCount - 1);
+        m_rootsX = std::max(1u, static_cast<uint32_t>(std::ceil(m_heightfield->extentX() / rootSize)));
+        m_rootsZ = std::max(1u, static_cast<uint32_t>(std::ceil(m_heightfield->extentZ() / rootSize)));
+
+        for (uint32_t iz = 0; iz < m_rootsZ; ++iz)
+            for (uint32_t ix = 0; ix < m_rootsX; ++ix)
+                selectNode(m_lodCount - 1, ix, iz);
+        m_stats.lodLevels = m_lodCount;
+    }
+
+    void TerrainRenderPassModule::selectNode(uint32_t lod, uint32_t ix, uint32_t iz)
+    {
+        const float size = nodeSize(lod);
+        const float x0 = m_heightfield->originX() + static_cast<float>(ix) * size;
+        const float z0 = m_heightfield->originZ() + static_cast<float>(iz) * size;
+        if (x0 >= m_heightfield->originX() + m_heightfield->extentX() ||
+            z0 >= m_heightfield->originZ() + m_heightfield->extentZ())
+            return;
+
+        float minY = 0.0f;
+        float maxY = 0.0f;
+        m_heightfield->heightRange(x0, z0, x0 + size, z0 + size, minY, maxY);
+
+        const glm::vec3 bmin(x0, minY, z0);
+        const glm::vec3 bmax(x0 + size, maxY, z0 + size);
+        const glm::vec3 center = 0.5f * (bmin + bmax);
+        if (!m_selectFrustum.testSphere(center, glm::length(bmax - center)))
+            return;
+
+        const glm::vec3 closest = glm::clamp(m_selectCamera, bmin, bmax);
+        const float dist = glm::length(m_selectCamera - closest);
+        if (dist > m_cfg.maxViewDistance)
+            return;
+
+        if (lod == 0 || dist > lodRange(lod - 1))
+        {
+            if (m_selected.size() < MAX_NODES)
+                m_selected.push_back(SelectedNode{lod, ix, iz, dist});
+            return;
+        }
+
+        for (uint32_t k = 0; k < 4u; ++k)
+            selectNode(lod - 1, ix * 2u + (k & 1u), iz * 2u + (k >> 1));
+    }
+
+    void TerrainRenderPassModule::resetTileCache()
+    {
+        m_tileSlots.assign(TILE_CACHE_LAYERS, TileSlot{});
+        m_tileByKey.clear();
+        m_tileByKey.reserve(TILE_CACHE_LAYERS);
+    }
+
+    uint32_t TerrainRenderPassModule::acquireTileSlot()
+    {
+        // Free layer first, else the least recently used one not needed this frame.
+        uint32_t best = UINT32_MAX;
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_tileSlots.size()); ++i)
+        {
+            const TileSlot &s = m_tileSlots[i];
+            if (s.key == UINT64_MAX)
+                return i;
+            if (s.pinned || s.lastUsedFrame == m_frameCounter)
+                continue;
+            if (best == UINT32_MAX || s.lastUsedFrame < m_tileSlots[best].lastUsedFrame)
+                best = i;
+        }
+        if (best != UINT32_MAX)
+            m_tileByKey.erase(m_tileSlots[best].key);
+        return best;
+    }
+
+    void TerrainRenderPassModule::buildTile(uint32_t lod, uint32_t ix, uint32_t iz, float *heights, uint8_t *splat) const
+    {
+        const float size = nodeSize(lod);
+        const float spacing = size / static_cast<float>(PATCH_QUADS);
+        const float x0 = m_heightfield->originX() + static_cast<float>(ix) * size - spacing; // border sample
+        const float z0 = m_heightfield->originZ() + static_cast<float>(iz) * size - spacing;
+
+        for (uint32_t j = 0; j < TILE_SAMPLES; ++j)
+        {
+            const float z = z0 + static_cast<float>(j) * spacing;
+            for (uint32_t i = 0; i < TILE_SAMPLES; ++i)
+            {
+                const float x = x0 + static_cast<float>(i) * spacing;
+                const uint32_t t = j * TILE_SAMPLES + i;
+                heights[t] = m_heightfield->heightAt(x, z);
+
+                const glm::vec4 w = glm::clamp(m_heightfield->splatAt(x, z, spacing), 0.0f, 1.0f);
+                splat[t * 4u + 0] = static_cast<uint8_t>(w.x * 255.0f + 0.5f);
+                splat[t * 4u + 1] = static_cast<uint8_t>(w.y * 255.0f + 0.5f);
+                splat[t * 4u + 2] = static_cast<uint8_t>(w.z * 255.0f + 0.5f);
+                splat[t * 4u + 3] = static_cast<uint8_t>(w.w * 255.0f + 0.5f);
+            }
+        }
+    }
+
+    void TerrainRenderPassModule::streamTiles(FrameData &frame, VkCommandBuffer cmd)
+    {
+        // Roots first (every other node falls back to them), then nearest first.
+        const uint32_t rootLod = m_lodCount - 1;
+        std::sort(m_missing.begin(), m_missing.end(), [&](uint32_t a, uint32_t b)
+                  {
+                      const SelectedNode &na = m_selected[a];
+                      const SelectedNode &nb = m_selected[b];
+                      const bool ra = na.lod == rootLod;
+                      const bool rb = nb.lod == rootLod;
+                      if (ra != rb)
+                          return ra;
+                      return na.distance < nb.distance; });
+
+        std::array<VkBufferImageCopy, TILE_UPLOADS_PER_FRAME> heightCopies{};
+        std::array<VkBufferImageCopy, TILE_UPLOADS_PER_FRAME> splatCopies{};
+        uint32_t uploads = 0;
+        auto *staging = static_cast<uint8_t *>(frame.stagingMemory.mapped);
+
+        for (uint32_t idx : m_missing)
+        {
+            if (uploads >= TILE_UPLOADS_PER_FRAME)
+                break;
+            const SelectedNode &n = m_selected[idx];
+            const uint64_t key = tileKey(n.lod, n.ix, n.iz);
+            if (m_tileByKey.count(key))
+                continue;
+
+            const uint32_t layer = acquireTileSlot();
+            if (layer == UINT32_MAX)
+                break;
+
+            TileSlot &slot = m_tileSlots[layer];
+            slot.key = key;
+            slot.lastUsedFrame = m_frameCounter;
+            slot.pinned = (n.lod == rootLod);
+            m_tileByKey[key] = layer;
+
+            const VkDeviceSize offset = VkDeviceSize(uploads) * kTileBytes;
+            buildTile(n.lod, n.ix, n.iz, reinterpret_cast<float *>(staging + offset), staging + offset + kTileHeightBytes);
+
+            VkBufferImageCopy region{};
+            region.bufferOffset = offset;
+            region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.mipLevel = 0;
+            region.imageSubresource.baseArrayLayer = layer;
+            region.imageSubresource.layerCount = 1;
+            region.imageExtent = {TILE_SAMPLES, TILE_SAMPLES, 1};
+            heightCopies[uploads] = region;
+            region.bufferOffset = offset + kTileHeightBytes;
+            splatCopies[uploads] = region;
+            ++uploads;
+        }
+        m_stats.tileUploads = uploads;
+
+        if (uploads == 0 && m_tileImagesInitialized)
+            return;
+
+        // Earlier frames may still sample layers being replaced: the barrier waits for them.
+        VkImageMemoryBarrier barriers[2]{};
+        for (uint32_t i = 0; i < 2u; ++i)
+        {
+            barriers[i].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            barriers[i].srcAccessMask = 0;
+            barriers[i].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barriers[i].oldLayout = m_tileImagesInitialized ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
+            barriers[i].newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            barriers[i].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barriers[i].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barriers[i].image = i == 0 ? m_heightImage : m_splatImage;
+            barriers[i].subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            barriers[i].subresourceRange.baseMipLevel = 0;
+            barriers[i].subresourceRange.levelCount = 1;
+            barriers[i].subresourceRange.baseArrayLayer = 0;
+            barriers[i].subresourceRange.layerCount = TILE_CACHE_LAYERS;
+        }
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 2, barriers);
+
+        if (uploads > 0)
+        {
+            vkCmdCopyBufferToImage(cmd, frame.stagingBuffer, m_heightImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, uploads, heightCopies.data());
+            vkCmdCopyBufferToImage(cmd, frame.stagingBuffer, m_splatImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, uploads, splatCopies.data());
+        }
+
+        for (VkImageMemoryBarrier &b : barriers)
+        {
+            b.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            b.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+            b.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            b.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        }
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                             0, 0, nullptr, 0, nullptr, 2, barriers);
+        m_tileImagesInitialized = true;
+    }
+
+    void TerrainRenderPassModule::recordPrePass(FrameContext &frameCtx, VkCommandBuffer cmd)
+    {
+        if (m_frames.empty())
+            return;
+
+        FrameData &frame = m_frames[frameCtx.frameIndex % static_cast<uint32_t>(m_frames.size())];
+        frame.nodeCount = 0;
+        frame.cameraMapped = nullptr;
+        m_frameCounter += 1u;
+        m_stats = Stats{};
+
+        if (!m_enabled || !m_camera || !m_heightfield || !m_heightfield->valid())
+            return;
+        if (m_extent.width == 0 || m_extent.height == 0)
+            return;
+        if (!allocateCameraUBO(frameCtx, frame))
+            return;
+
+        if (m_tileRevision != m_heightfield->revision())
+        {
+            resetTileCache();
+            m_tileRevision = m_heightfield->revision();
+        }
+
+        const float aspect = static_cast<float>(m_extent.width) / static_cast<float>(m_extent.height);
+        m_camera->SetAspect(aspect);
+
+        // The camera UBO is written in latchCamera(); selection uses the camera as of now.
+        selectNodes(m_camera->GetPosition(), m_camera->GetProjectionMatrix() * m_camera->GetViewMatrix());
+
+        // Touch resident tiles (own or an ancestor's) so streaming never evicts them this frame.
+        m_missing.clear();
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_selected.size()); ++i)
+        {
+            const SelectedNode &n = m_selected[i];
+            auto it = m_tileByKey.find(tileKey(n.lod, n.ix, n.iz));
+            if (it != m_tileByKey.end())
+            {
+                m_tileSlots[it->second].lastUsedFrame = m_frameCounter;
+                continue;
+            }
+            m_missing.push_back(i);
+            for (uint32_t lod = n.lod + 1, ix = n.ix >> 1, iz = n.iz >> 1; lod < m_lodCount; ++lod, ix >>= 1, iz >>= 1)
+            {
+                auto anc = m_tileByKey.find(tileKey(lod, ix, iz));
+                if (anc != m_tileByKey.end())
+                {
+                    m_tileSlots[anc->second].lastUsedFrame = m_frameCounter;
+                    break;
+                }
+            }
+        }
+
+        streamTiles(frame, cmd);
+
+        // Nodes with their own tile or a resident ancestor's; the rest wait for their root.
+        m_gpuNodes.clear();
+        for (const SelectedNode &n : m_selected)
+        {
+            uint32_t tileLod = n.lod;
+            uint32_t tileX = n.ix;
+            uint32_t tileZ = n.iz;
+            auto it = m_tileByKey.find(tileKey(tileLod, tileX, tileZ));
+            while (it == m_tileByKey.end() && tileLod + 1 < m_lodCount)
+            {
+                ++tileLod;
+                tileX >>= 1;
+                tileZ >>= 1;
+                it = m_tileByKey.find(tileKey(tileLod, tileX, tileZ));
+            }
+            if (it == m_tileByKey.end())
+                continue;
+            if (tileLod != n.lod)
+                ++m_stats.tileFallbacks;
+
+            const float size = nodeSize(n.lod);
+            const float tileSize = nodeSize(tileLod);
+            const float bandStart = n.lod > 0 ? lodRange(n.lod - 1) : 0.0f;
+            const float bandEnd = lodRange(n.lod);
+
+            GpuNode g{};
+            g.node = glm::vec4(m_heightfield->originX() + static_cast<float>(n.ix) * size,
+                               m_heightfield->originZ() + static_cast<float>(n.iz) * size,
+                               size, static_cast<float>(n.lod));
+            g.tile = glm::vec4(m_heightfield->originX() + static_cast<float>(tileX) * tileSize,
+                               m_heightfield->originZ() + static_cast<float>(tileZ) * tileSize,
+                               1.0f / tileSize, static_cast<float>(it->second));
+            g.morph = glm::vec4(bandStart + (bandEnd - bandStart) * MORPH_START, bandEnd, 0.0f, 0.0f);
+            m_gpuNodes.push_back(g);
+        }
+
+        if (!m_gpuNodes.empty())
+            std::memcpy(frame.nodeMemory.mapped, m_gpuNodes.data(), m_gpuNodes.size() * sizeof(GpuNode));
+        frame.nodeCount = static_cast<uint32_t>(m_gpuNodes.size());
+
+        m_stats.nodes = frame.nodeCount;
+        m_stats.tilesResident = static_cast<uint32_t>(m_tileByKey.size());
+    }
+
+    void TerrainRenderPassModule::latchCamera(FrameContext &frameCtx)
+    {
+        if (m_frames.empty() || !m_enabled || !m_camera)
+            return;
+        if (m_extent.width == 0 || m_extent.height == 0)
+            return;
+
+        FrameData &frame = m_frames[frameCtx.frameIndex % static_cast<uint32_t>(m_frames.size())];
+        if (!frame.cameraMapped || !frameCtx.camera)
+            return;
+
+        CameraUBO ubo{};
+        ubo.view = frameCtx.camera->view;
+        ubo.proj = frameCtx.camera->proj;
+        ubo.cameraPos = frameCtx.camera->position;
+        for (uint32_t i = 0; i < LAYER_COUNT; ++i)
+            ubo.layerScale[static_cast<int>(i)] = 1.0f / m_layerMetersPerRepeat[i];
+        std::memcpy(frame.cameraMapped, &ubo, sizeof(CameraUBO));
+    }
+
+    bool TerrainRenderPassModule::allocateCameraUBO(FrameContext &frameCtx, FrameData &frame)
+    {
+        FrameUploadRing::Allocation alloc;
+        if (!frameCtx.uploads || !frameCtx.uploads->allocateUniform(sizeof(CameraUBO), alloc))
+            return false;
+
+        if (frame.cameraRingBuffer != alloc.buffer)
+        {
+            VkDescriptorBufferInfo cbi{};
+            cbi.buffer = alloc.buffer;
+            cbi.offset = 0;
+            cbi.range = sizeof(CameraUBO);
+
+            VkWriteDescriptorSet write{};
+            write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            write.dstSet = frame.set;
+            write.dstBinding = 0;
+            write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+            write.descriptorCount = 1;
+            write.pBufferInfo = &cbi;
+            vkUpdateDescriptorSets(m_device, 1, &write, 0, nullptr);
+            frame.cameraRingBuffer = alloc.buffer;
+        }
+        frame.cameraOffset = alloc.dynamicOffset();
+        frame.cameraMapped = alloc.mapped;
+        return true;
+    }
+
+    void TerrainRenderPassModule::record(FrameContext &frameCtx, VkCommandBuffer cmd)
+    {
+        recordPhase(frameCtx, cmd, RenderPhase::DepthPrepass);
+        recordPhase(frameCtx, cmd, RenderPhase::Opaque);
+    }
+
+    void TerrainRenderPassModule::recordPhase(FrameContext &frameCtx, VkCommandBuffer cmd, RenderPhase phase)
+    {
+        if (phase != RenderPhase::DepthPrepass && phase != RenderPhase::Opaque)
+            return;
+        if (phase == RenderPhase::DepthPrepass && !frameCtx.depthPrepass)
+            return;
+        if (m_frames.empty() || m_patchIndexCount == 0)
+            return;
+
+        const FrameData &frame = m_frames[frameCtx.frameIndex % static_cast<uint32_t>(m_frames.size())];
+        if (frame.nodeCount == 0)
+            return;
+
+        // Render extent, not m_extent: below it with resolution scaling.
+        const VkExtent2D ext = frameCtx.renderExtent;
+        VkViewport vp{0.0f, 0.0f, static_cast<float>(ext.width), static_cast<float>(ext.height), 0.0f, 1.0f};
+        VkRect2D sc{{0, 0}, ext};
+        vkCmdSetViewport(cmd, 0, 1, &vp);
+        vkCmdSetScissor(cmd, 0, 1, &sc);
+
+        (phase == RenderPhase::DepthPrepass ? m_pipelineDepth : m_pipeline).bind(cmd);
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 0, 1, &frame.set, 1, &frame.cameraOffset);
+        if (frameCtx.shadow && frameCtx.shadow->receiverSet != VK_NULL_HANDLE)
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 1, 1, &frameCtx.shadow->receiverSet, 0, nullptr);
+
+        VkDeviceSize offset = 0;
+        vkCmdBindVertexBuffers(cmd, 0, 1, &m_patchVB.buffer, &offset);
+        vkCmdBindIndexBuffer(cmd, m_patchIB.buffer, 0, VK_INDEX_TYPE_UINT16);
+
+        // All nodes in one instanced draw (gl_InstanceIndex selects the node).
+        vkCmdDrawIndexed(cmd, m_patchIndexCount, frame.nodeCount, 0, 0, 0);
+        DrawCallCounter::increment();
+    }
+
+    void TerrainRenderPassModule::reportMemory(MemoryReport &out) const
+    {
+        uint64_t frameBytes = 0;
+        for (const FrameData &f : m_frames)
+            frameBytes += f.nodeMemory.size + f.stagingMemory.size;
+
+        const uint64_t cacheCpu = MemoryReport::bytesOf(m_tileSlots) + MemoryReport::bytesOf(m_selected) +
+                                  MemoryReport::bytesOf(m_gpuNodes) + MemoryReport::bytesOf(m_missing) +
+                                  m_tileByKey.size() * (sizeof(uint64_t) + sizeof(uint32_t));
+        out.add("Render", "Terrain tile cache", cacheCpu, m_heightMemory.size + m_splatMemory.size + m_fallbackWhiteTexture.getGpuBytes(),
+                static_cast<uint32_t>(m_tileByKey.size()));
+        out.add("Render", "Terrain patch + frames", 0, m_patchVB.memory.size + m_patchIB.memory.size + frameBytes,
+                static_cast<uint32_t>(m_frames.size()));
+        if (m_heightfield)
+            out.add("Render", "Terrain heightfield", m_heightfield->memoryBytes(), 0, 1);
+    }
+}
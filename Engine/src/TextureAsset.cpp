@@ -1,10 +1,13 @@
 #include "assets/TextureAsset.h"
+#include "assets/ModelFormat.h"
 #include "utils/ImageUtils.h"
 
 #include <cstdlib>
 #include <cstring>
 #include <algorithm>
+#include <array>
 #include <cmath>
+#include <utility>
 
 // ------------------------------------------------------------
 // stb_image decoding (PNG/JPG)
@@ -22,6 +25,144 @@ namespace Engine
         return static_cast<uint32_t>(std::floor(std::log2(static_cast<double>(maxDim)))) + 1u;
     }
 
+    bool TextureAsset::decodeImageRGBA8(
+        const uint8_t *encodedBytes,
+        size_t encodedSize,
+        std::vector<uint8_t> &outPixels,
+        uint32_t &outWidth,
+        uint32_t &outHeight)
+    {
+        outPixels.clear();
+        outWidth = 0;
+        outHeight = 0;
+
+        if (!encodedBytes || encodedSize == 0)
+            return false;
+
+        int w = 0, h = 0, comp = 0;
+        unsigned char *decoded = stbi_load_from_memory(
+            encodedBytes,
+            static_cast<int>(encodedSize),
+            &w, &h,
+            &comp,
+            4);
+
+        if (!decoded || w <= 0 || h <= 0)
+        {
+            if (decoded)
+                stbi_image_free(decoded);
+            return false;
+        }
+
+        const size_t pixelBytes = static_cast<size_t>(w) * static_cast<size_t>(h) * 4u;
+        outPixels.assign(decoded, decoded + pixelBytes);
+        outWidth = static_cast<uint32_t>(w);
+        outHeight = static_cast<uint32_t>(h);
+
+        stbi_image_free(decoded);
+        return true;
+    }
+
+    // sRGB <-> linear for the CPU mip filter. Encoding goes through a 12-bit table: a linear step
+    // of 1/4096 stays under one sRGB code even near black.
+    static constexpr uint32_t SRGB_ENCODE_STEPS = 4096;
+
+    static const std::array<float, 256> &SrgbDecodeTable()
+    {
+        static const std::array<float, 256> table = []()
+        {
+            std::array<float, 256> t{};
+            for (uint32_t i = 0; i < 256; ++i)
+            {
+                const float c = float(i) / 255.0f;
+                t[i] = (c <= 0.04045f) ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+            }
+            return t;
+        }();
+        return table;
+    }
+
+    static const std::array<uint8_t, SRGB_ENCODE_STEPS + 1> &SrgbEncodeTable()
+    {
+        static const std::array<uint8_t, SRGB_ENCODE_STEPS + 1> table = []()
+        {
+            std::array<uint8_t, SRGB_ENCODE_STEPS + 1> t{};
+            for (uint32_t i = 0; i <= SRGB_ENCODE_STEPS; ++i)
+            {
+                const float l = float(i) / float(SRGB_ENCODE_STEPS);
+                const float c = (l <= 0.0031308f) ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+                t[i] = static_cast<uint8_t>(std::min(255.0f, c * 255.0f + 0.5f));
+            }
+            return t;
+        }();
+        return table;
+    }
+
+    uint32_t TextureAsset::buildMipChainRGBA8(
+        const uint8_t *rgbaPixels,
+        uint32_t width,
+        uint32_t height,
+        bool srgb,
+        std::vector<uint8_t> &outChain)
+    {
+        outChain.clear();
+        if (!rgbaPixels || width == 0 || height == 0)
+            return 0;
+
+        const uint32_t levels = calcMipLevels(width, height);
+        size_t chainBytes = 0;
+        for (uint32_t level = 0; level < levels; ++level)
+            chainBytes += size_t(std::max(1u, width >> level)) * std::max(1u, height >> level) * 4u;
+
+        outChain.resize(chainBytes);
+        std::memcpy(outChain.data(), rgbaPixels, size_t(width) * height * 4u);
+
+        const std::array<float, 256> &decode = SrgbDecodeTable();
+        const std::array<uint8_t, SRGB_ENCODE_STEPS + 1> &encode = SrgbEncodeTable();
+
+        // Each level filters the previous one, like the blit chain of CmdGenerateMipmaps.
+        size_t srcOffset = 0;
+        uint32_t w = width, h = height;
+        for (uint32_t level = 1; level < levels; ++level)
+        {
+            const uint32_t nw = std::max(1u, w >> 1);
+            const uint32_t nh = std::max(1u, h >> 1);
+            const size_t dstOffset = srcOffset + size_t(w) * h * 4u;
+            const uint8_t *cur = outChain.data() + srcOffset;
+            uint8_t *next = outChain.data() + dstOffset;
+
+            for (uint32_t y = 0; y < nh; ++y)
+            {
+                const uint32_t y0 = std::min(y * 2u, h - 1u);
+                const uint32_t y1 = std::min(y * 2u + 1u, h - 1u);
+                for (uint32_t x = 0; x < nw; ++x)
+                {
+                    const uint32_t x0 = std::min(x * 2u, w - 1u);
+                    const uint32_t x1 = std::min(x * 2u + 1u, w - 1u);
+                    const uint8_t *a = cur + (size_t(y0) * w + x0) * 4u;
+                    const uint8_t *b = cur + (size_t(y0) * w + x1) * 4u;
+                    const uint8_t *c = cur + (size_t(y1) * w + x0) * 4u;
+                    const uint8_t *d = cur + (size_t(y1) * w + x1) * 4u;
+                    uint8_t *o = next + (size_t(y) * nw + x) * 4u;
+
+                    const int colorChannels = srgb ? 3 : 0;
+                    for (int ch = 0; ch < colorChannels; ++ch)
+                    {
+                        const float l = (decode[a[ch]] + decode[b[ch]] + decode[c[ch]] + decode[d[ch]]) * 0.25f;
+                        o[ch] = encode[static_cast<uint32_t>(l * float(SRGB_ENCODE_STEPS) + 0.5f)];
+                    }
+                    for (int ch = colorChannels; ch < 4; ++ch)
+                        o[ch] = static_cast<uint8_t>((uint32_t(a[ch]) + b[ch] + c[ch] + d[ch] + 2u) >> 2);
+                }
+            }
+
+            srcOffset = dstOffset;
+            w = nw;
+            h = nh;
+        }
+        return levels;
+    }
+
     bool TextureAsset::uploadRGBA8_Deferred(
         UploadContext &ctx,
         const uint8_t *rgbaPixels,
@@ -52,17 +193,14 @@ namespace Engine
 
         const VkDeviceSize pixelBytes = VkDeviceSize(width) * VkDeviceSize(height) * 4u;
 
-        // 1) Create staging buffer (must survive until submit finishes)
-        StagingBufferHandle staging{};
-        VkResult r = CreateStagingBuffer(ctx.device, ctx.physicalDevice, rgbaPixels, pixelBytes, staging);
-        if (r != VK_SUCCESS)
+        // 1) Stage pixels (ring or dedicated buffer; both owned by ctx until its submit finishes)
+        VkBuffer stagingBuffer = VK_NULL_HANDLE;
+        VkDeviceSize stagingOffset = 0;
+        if (!StageBytes(ctx, rgbaPixels, pixelBytes, stagingBuffer, stagingOffset))
             return false;
 
-        // Keep staging alive until EndSubmitAndWait
-        ctx.pendingStaging.push_back(staging);
-
         // 2) Create GPU image (with mip levels)
-        r = CreateImage2D(
+        VkResult r = CreateImage2D(
             ctx.device, ctx.physicalDevice,
             width, height,
             m_format,
@@ -81,7 +219,7 @@ namespace Engine
             VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
             VK_IMAGE_ASPECT_COLOR_BIT);
 
-        CmdCopyBufferToImage(ctx, staging.buffer, m_image, width, height);
+        CmdCopyBufferToImage(ctx, stagingBuffer, m_image, width, height, stagingOffset);
 
         // 3b) Generate mipmaps if possible; otherwise just transition mip 0.
         if (m_mipLevels > 1)
@@ -116,6 +254,12 @@ namespace Engine
                 VK_IMAGE_ASPECT_COLOR_BIT);
         }
 
+        m_baseMip = 0;
+        m_fullWidth = width;
+        m_fullHeight = height;
+        m_fullMipLevels = m_mipLevels;
+        m_blockCompressed = false;
+
         // 4) Create view now (safe)
         r = CreateImageView2D(ctx.device, m_image, m_format, VK_IMAGE_ASPECT_COLOR_BIT, m_mipLevels, m_view);
         if (r != VK_SUCCESS)
@@ -140,6 +284,112 @@ namespace Engine
         return true;
     }
 
+    bool TextureAsset::uploadRGBA8MipChain_Deferred(
+        UploadContext &ctx,
+        const uint8_t *chainPixels,
+        size_t chainBytes,
+        uint32_t width,
+        uint32_t height,
+        uint32_t mipLevels,
+        bool srgbFormat,
+        VkSamplerAddressMode wrapU,
+        VkSamplerAddressMode wrapV,
+        VkFilter minFilter,
+        VkFilter magFilter,
+        VkSamplerMipmapMode mipMode,
+        float maxAnisotropy)
+    {
+        if (!ctx.begun || ctx.cmd == VK_NULL_HANDLE)
+            return false;
+
+        if (!chainPixels || width == 0 || height == 0 || mipLevels == 0 || mipLevels > calcMipLevels(width, height))
+            return false;
+
+        VkDeviceSize levelBytes[32] = {};
+        VkDeviceSize totalBytes = 0;
+        for (uint32_t level = 0; level < mipLevels; ++level)
+        {
+            levelBytes[level] = VkDeviceSize(std::max(1u, width >> level)) * std::max(1u, height >> level) * 4u;
+            totalBytes += levelBytes[level];
+        }
+        if (chainBytes < totalBytes)
+            return false;
+
+        if (isValid())
+            destroy(ctx.device);
+
+        m_width = width;
+        m_height = height;
+        m_mipLevels = mipLevels;
+        m_format = srgbFormat ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+        m_baseMip = 0;
+        m_fullWidth = width;
+        m_fullHeight = height;
+        m_fullMipLevels = mipLevels;
+        m_blockCompressed = false;
+
+        // 1) Stage the whole chain at once (every level is a multiple of the 4-byte texel)
+        VkBuffer stagingBuffer = VK_NULL_HANDLE;
+        VkDeviceSize stagingOffset = 0;
+        if (!StageBytes(ctx, chainPixels, totalBytes, stagingBuffer, stagingOffset))
+            return false;
+
+        // 2) Create GPU image
+        VkResult r = CreateImage2D(
+            ctx.device, ctx.physicalDevice,
+            width, height,
+            m_format,
+            VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+            m_mipLevels,
+            m_image, m_memory);
+
+        if (r != VK_SUCCESS)
+            return false;
+
+        // 3) One copy per level and a single pair of barriers: no per-level blit dependency chain
+        CmdTransitionImageLayout(
+            ctx,
+            m_image,
+            VK_IMAGE_LAYOUT_UNDEFINED,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            VK_IMAGE_ASPECT_COLOR_BIT,
+            m_mipLevels);
+
+        VkDeviceSize offset = stagingOffset;
+        for (uint32_t level = 0; level < m_mipLevels; ++level)
+        {
+            CmdCopyBufferToImage(ctx, stagingBuffer, m_image, std::max(1u, width >> level), std::max(1u, height >> level), offset, level);
+            offset += levelBytes[level];
+        }
+
+        CmdTransitionImageLayout(
+            ctx,
+            m_image,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            VK_IMAGE_ASPECT_COLOR_BIT,
+            m_mipLevels);
+
+        // 4) View + sampler
+        r = CreateImageView2D(ctx.device, m_image, m_format, VK_IMAGE_ASPECT_COLOR_BIT, m_mipLevels, m_view);
+        if (r != VK_SUCCESS)
+            return false;
+
+        r = CreateTextureSampler(
+            ctx.device,
+            ctx.physicalDevice,
+            wrapU,
+            wrapV,
+            minFilter,
+            magFilter,
+            mipMode,
+            maxAnisotropy,
+            static_cast<float>(m_mipLevels - 1),
+            m_sampler);
+
+        return r == VK_SUCCESS;
+    }
+
     bool TextureAsset::uploadEncodedImage_Deferred(
         UploadContext &ctx,
         const uint8_t *encodedBytes,
@@ -189,6 +439,337 @@ namespace Engine
         return ok;
     }
 
+    bool TextureAsset::isFormatSampleable(VkPhysicalDevice physicalDevice, VkFormat format)
+    {
+        VkFormatProperties props{};
+        vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &props);
+        return (props.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) != 0;
+    }
+
+    bool TextureAsset::uploadBlockCompressed_Deferred(
+        UploadContext &ctx,
+        const uint8_t *blockData,
+        size_t blockDataSize,
+        uint32_t width,
+        uint32_t height,
+        uint32_t mipLevels,
+        VkFormat format,
+        VkSamplerAddressMode wrapU,
+        VkSamplerAddressMode wrapV,
+        VkFilter minFilter,
+        VkFilter magFilter,
+        VkSamplerMipmapMode mipMode,
+        float maxAnisotropy)
+    {
+        if (!ctx.begun || ctx.cmd == VK_NULL_HANDLE)
+            return false;
+
+        if (!blockData || width == 0 || height == 0 || mipLevels == 0 || mipLevels > calcMipLevels(width, height))
+            return false;
+
+        if (blockDataSize < smodel::BlockCompressedMipChainBytes(width, height, mipLevels))
+            return false;
+
+        if (!isFormatSampleable(ctx.physicalDevice, format))
+            return false;
+
+        if (isValid())
+            destroy(ctx.device);
+
+        m_width = width;
+        m_height = height;
+        m_mipLevels = mipLevels;
+        m_format = format;
+        m_baseMip = 0;
+        m_fullWidth = width;
+        m_fullHeight = height;
+        m_fullMipLevels = mipLevels;
+        m_blockCompressed = true;
+
+        const VkDeviceSize chainBytes = smodel::BlockCompressedMipChainBytes(width, height, mipLevels);
+
+        // 1) Stage the whole chain at once (offsets stay 16-byte aligned per level)
+        VkBuffer stagingBuffer = VK_NULL_HANDLE;
+        VkDeviceSize stagingOffset = 0;
+        if (!StageBytes(ctx, blockData, chainBytes, stagingBuffer, stagingOffset))
+            return false;
+
+        // 2) Create GPU image (TRANSFER_SRC: residency trimming copies the mip tail out)
+        VkResult r = CreateImage2D(
+            ctx.device, ctx.physicalDevice,
+            width, height,
+            m_format,
+            VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+            m_mipLevels,
+            m_image, m_memory);
+
+        if (r != VK_SUCCESS)
+            return false;
+
+        // 3) One copy per level, then every level to shader-read
+        CmdTransitionImageLayout(
+            ctx,
+            m_image,
+            VK_IMAGE_LAYOUT_UNDEFINED,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            VK_IMAGE_ASPECT_COLOR_BIT,
+            m_mipLevels);
+
+        uint32_t w = width, h = height;
+        VkDeviceSize offset = stagingOffset;
+        for (uint32_t level = 0; level < m_mipLevels; ++level)
+        {
+            CmdCopyBufferToImage(ctx, stagingBuffer, m_image, w, h, offset, level);
+            offset += smodel::BlockCompressedMipChainBytes(w, h, 1);
+            w = std::max(1u, w >> 1);
+            h = std::max(1u, h >> 1);
+        }
+
+        CmdTransitionImageLayout(
+            ctx,
+            m_image,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            VK_IMAGE_ASPECT_COLOR_BIT,
+            m_mipLevels);
+
+        // 4) View + sampler
+        r = CreateImageView2D(ctx.device, m_image, m_format, VK_IMAGE_ASPECT_COLOR_BIT, m_mipLevels, m_view);
+        if (r != VK_SUCCESS)
+            return false;
+
+        r = CreateTextureSampler(
+            ctx.device,
+            ctx.physicalDevice,
+            wrapU,
+            wrapV,
+            minFilter,
+            magFilter,
+            mipMode,
+            maxAnisotropy,
+            static_cast<float>(m_mipLevels - 1),
+            m_sampler);
+
+        return r == VK_SUCCESS;
+    }
+
+    // 2x2 box filter down 'levels' times; odd edges repeat their last texel. Filters the stored values,
+    // so sRGB levels come out a little darker than the GPU blits of a full upload.
+    static void downsampleRGBA8(const uint8_t *src, uint32_t width, uint32_t height, uint32_t levels,
+                                std::vector<uint8_t> &out, uint32_t &outWidth, uint32_t &outHeight)
+    {
+        std::vector<uint8_t> cur(src, src + size_t(width) * height * 4u);
+        uint32_t w = width, h = height;
+        for (uint32_t level = 0; level < levels && (w > 1u || h > 1u); ++level)
+        {
+            const uint32_t nw = std::max(1u, w >> 1);
+            const uint32_t nh = std::max(1u, h >> 1);
+            std::vector<uint8_t> next(size_t(nw) * nh * 4u);
+            for (uint32_t y = 0; y < nh; ++y)
+            {
+                const uint32_t y0 = std::min(y * 2u, h - 1u);
+                const uint32_t y1 = std::min(y * 2u + 1u, h - 1u);
+                for (uint32_t x = 0; x < nw; ++x)
+                {
+                    const uint32_t x0 = std::min(x * 2u, w - 1u);
+                    const uint32_t x1 = std::min(x * 2u + 1u, w - 1u);
+                    const uint8_t *a = &cur[(size_t(y0) * w + x0) * 4u];
+                    const uint8_t *b = &cur[(size_t(y0) * w + x1) * 4u];
+                    const uint8_t *c = &cur[(size_t(y1) * w + x0) * 4u];
+                    const uint8_t *d = &cur[(size_t(y1) * w + x1) * 4u];
+                    uint8_t *o = &next[(size_t(y) * nw + x) * 4u];
+                    for (int ch = 0; ch < 4; ++ch)
+                        o[ch] = static_cast<uint8_t>((uint32_t(a[ch]) + b[ch] + c[ch] + d[ch] + 2u) >> 2);
+                }
+            }
+            cur.swap(next);
+            w = nw;
+            h = nh;
+        }
+        out.swap(cur);
+        outWidth = w;
+        outHeight = h;
+    }
+
+    uint64_t TextureAsset::bytesForBaseMip(uint32_t baseMip) const
+    {
+        uint64_t total = 0;
+        for (uint32_t level = baseMip; level < m_fullMipLevels; ++level)
+        {
+            const uint32_t w = std::max(1u, m_fullWidth >> level);
+            const uint32_t h = std::max(1u, m_fullHeight >> level);
+            total += m_blockCompressed ? smodel::BlockCompressedMipChainBytes(w, h, 1) : uint64_t(w) * h * 4u;
+        }
+        return total;
+    }
+
+    bool TextureAsset::copyMipTail_Deferred(UploadContext &ctx, const TextureAsset &src, uint32_t baseMip)
+    {
+        if (!ctx.begun || ctx.cmd == VK_NULL_HANDLE || !src.isValid())
+            return false;
+        if (baseMip < src.m_baseMip || baseMip >= src.m_fullMipLevels)
+            return false;
+
+        if (isValid())
+            destroy(ctx.device);
+
+        m_format = src.m_format;
+        m_baseMip = baseMip;
+        m_fullWidth = src.m_fullWidth;
+        m_fullHeight = src.m_fullHeight;
+        m_fullMipLevels = src.m_fullMipLevels;
+        m_blockCompressed = src.m_blockCompressed;
+        m_width = std::max(1u, m_fullWidth >> baseMip);
+        m_height = std::max(1u, m_fullHeight >> baseMip);
+        m_mipLevels = m_fullMipLevels - baseMip;
+
+        VkResult r = CreateImage2D(
+            ctx.device, ctx.physicalDevice,
+            m_width, m_height,
+            m_format,
+            VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+            m_mipLevels,
+            m_image, m_memory);
+        if (r != VK_SUCCESS)
+            return false;
+
+        // Everything that can fail comes before recording: a failed copy leaves src untouched.
+        r = CreateImageView2D(ctx.device, m_image, m_format, VK_IMAGE_ASPECT_COLOR_BIT, m_mipLevels, m_view);
+        if (r != VK_SUCCESS)
+            return false;
+
+        // The source is left in TRANSFER_SRC: it is destroyed once this upload completes.
+        CmdTransitionImageLayout(ctx, src.m_image, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                 VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT, src.m_mipLevels);
+        CmdTransitionImageLayout(ctx, m_image, VK_IMAGE_LAYOUT_UNDEFINED,
+                                 VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT, m_mipLevels);
+        CmdCopyImageMips(ctx, src.m_image, baseMip - src.m_baseMip, m_image, m_width, m_height, m_mipLevels);
+        CmdTransitionImageLayout(ctx, m_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                 VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT, m_mipLevels);
+        return true;
+    }
+
+    bool TextureAsset::uploadMipTail_Deferred(UploadContext &ctx, const TextureAsset &like, uint32_t baseMip,
+                                              const uint8_t *data, size_t dataSize)
+    {
+        if (!ctx.begun || ctx.cmd == VK_NULL_HANDLE || !data)
+            return false;
+        if (baseMip >= like.m_fullMipLevels)
+            return false;
+
+        const uint32_t fullW = like.m_fullWidth;
+        const uint32_t fullH = like.m_fullHeight;
+        if (like.m_blockCompressed)
+        {
+            if (dataSize < smodel::BlockCompressedMipChainBytes(fullW, fullH, like.m_fullMipLevels))
+                return false;
+        }
+        else if (dataSize < size_t(fullW) * fullH * 4u)
+        {
+            return false;
+        }
+
+        if (isValid())
+            destroy(ctx.device);
+
+        m_format = like.m_format;
+        m_baseMip = baseMip;
+        m_fullWidth = fullW;
+        m_fullHeight = fullH;
+        m_fullMipLevels = like.m_fullMipLevels;
+        m_blockCompressed = like.m_blockCompressed;
+        m_width = std::max(1u, fullW >> baseMip);
+        m_height = std::max(1u, fullH >> baseMip);
+        m_mipLevels = m_fullMipLevels - baseMip;
+
+        VkResult r = CreateImage2D(
+            ctx.device, ctx.physicalDevice,
+            m_width, m_height,
+            m_format,
+            VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+            m_mipLevels,
+            m_image, m_memory);
+        if (r != VK_SUCCESS)
+            return false;
+
+        r = CreateImageView2D(ctx.device, m_image, m_format, VK_IMAGE_ASPECT_COLOR_BIT, m_mipLevels, m_view);
+        if (r != VK_SUCCESS)
+            return false;
+
+        if (m_blockCompressed)
+        {
+            // Skip the levels above baseMip; the rest of the chain is staged as stored.
+            VkDeviceSize skip = 0;
+            for (uint32_t level = 0; level < baseMip; ++level)
+                skip += smodel::BlockCompressedMipChainBytes(std::max(1u, fullW >> level), std::max(1u, fullH >> level), 1);
+            const VkDeviceSize tailBytes = smodel::BlockCompressedMipChainBytes(m_width, m_height, m_mipLevels);
+
+            VkBuffer stagingBuffer = VK_NULL_HANDLE;
+            VkDeviceSize stagingOffset = 0;
+            if (!StageBytes(ctx, data + skip, tailBytes, stagingBuffer, stagingOffset))
+                return false;
+
+            CmdTransitionImageLayout(ctx, m_image, VK_IMAGE_LAYOUT_UNDEFINED,
+                                     VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT, m_mipLevels);
+            uint32_t w = m_width, h = m_height;
+            VkDeviceSize offset = stagingOffset;
+            for (uint32_t level = 0; level < m_mipLevels; ++level)
+            {
+                CmdCopyBufferToImage(ctx, stagingBuffer, m_image, w, h, offset, level);
+                offset += smodel::BlockCompressedMipChainBytes(w, h, 1);
+                w = std::max(1u, w >> 1);
+                h = std::max(1u, h >> 1);
+            }
+            CmdTransitionImageLayout(ctx, m_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                     VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT, m_mipLevels);
+        }
+        else
+        {
+            std::vector<uint8_t> reduced;
+            const uint8_t *pixels = data;
+            if (baseMip > 0)
+            {
+                uint32_t rw = 0, rh = 0;
+                downsampleRGBA8(data, fullW, fullH, baseMip, reduced, rw, rh);
+                pixels = reduced.data();
+            }
+
+            VkBuffer stagingBuffer = VK_NULL_HANDLE;
+            VkDeviceSize stagingOffset = 0;
+            if (!StageBytes(ctx, pixels, VkDeviceSize(m_width) * m_height * 4u, stagingBuffer, stagingOffset))
+                return false;
+
+            CmdTransitionImageLayout(ctx, m_image, VK_IMAGE_LAYOUT_UNDEFINED,
+                                     VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT);
+            CmdCopyBufferToImage(ctx, stagingBuffer, m_image, m_width, m_height, stagingOffset);
+
+            // The full chain was blitted when the texture was first uploaded, so this succeeds too.
+            if (m_mipLevels > 1)
+            {
+                if (!CmdGenerateMipmaps(ctx, m_image, m_format, static_cast<int32_t>(m_width),
+                                        static_cast<int32_t>(m_height), m_mipLevels))
+                    return false;
+            }
+            else
+            {
+                CmdTransitionImageLayout(ctx, m_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT);
+            }
+        }
+        return true;
+    }
+
+    void TextureAsset::swapResidency(TextureAsset &other)
+    {
+        std::swap(m_image, other.m_image);
+        std::swap(m_memory, other.m_memory);
+        std::swap(m_view, other.m_view);
+        std::swap(m_width, other.m_width);
+        std::swap(m_height, other.m_height);
+        std::swap(m_mipLevels, other.m_mipLevels);
+        std::swap(m_baseMip, other.m_baseMip);
+    }
+
     void TextureAsset::destroy(VkDevice device)
     {
         if (m_sampler != VK_NULL_HANDLE)
@@ -209,16 +790,17 @@ namespace Engine
             m_image = VK_NULL_HANDLE;
         }
 
-        if (m_memory != VK_NULL_HANDLE)
-        {
-            vkFreeMemory(device, m_memory, nullptr);
-            m_memory = VK_NULL_HANDLE;
-        }
+        FreeGpuMemory(device, m_memory);
 
         m_width = 0;
         m_height = 0;
         m_mipLevels = 1;
         m_format = VK_FORMAT_R8G8B8A8_UNORM;
+        m_baseMip = 0;
+        m_fullWidth = 0;
+        m_fullHeight = 0;
+        m_fullMipLevels = 1;
+        m_blockCompressed = false;
     }
 
 } // namespace Engine
@@ -1,6 +1,8 @@
 #include "Engine/VulkanContext.h"
+#include "Engine/BindlessMaterials.h"
 #include "Engine/Window.h"
 #include "Engine/SwapChain.h"
+#include "utils/JobSystem.h"
 #include "utils/VulkanValidationUtils.h"
 #include <GLFW/glfw3.h> // for glfwCreateWindowSurface
 #include <iostream>
@@ -9,6 +11,10 @@
 #include <stdexcept>
 #include <algorithm>
 #include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <cstdio>
 
 static const std::vector<const char *> requiredDeviceExtensions = {
     VK_KHR_SWAPCHAIN_EXTENSION_NAME};
@@ -20,7 +26,7 @@ static const std::vector<const char *> optionalDeviceExtensions = {
 namespace Engine
 {
 
-    VulkanContext::VulkanContext(Window &window) : m_Window(window)
+    VulkanContext::VulkanContext(Window &window, JobSystem *jobs) : m_Window(window), m_Jobs(jobs)
     {
         // constructor does not init the instance automatically; explicit Init() call pattern can be used
         Init();
@@ -33,10 +39,42 @@ namespace Engine
 
     void VulkanContext::Init()
     {
+        // The cache blob does not depend on the device until it is validated, so the (possibly
+        // multi-MB) read overlaps instance creation and device selection. Shared buffer: the job
+        // must not write into this object if device creation throws before the wait below.
+        auto cacheFile = std::make_shared<std::vector<char>>();
+        auto readCacheFile = [cacheFile]()
+        {
+            std::ifstream in(PIPELINE_CACHE_FILE, std::ios::binary);
+            if (in)
+                cacheFile->assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        };
+        JobHandle cacheRead;
+        if (m_Jobs)
+            cacheRead = m_Jobs->submit(readCacheFile, JobPriority::High);
+        else
+            readCacheFile();
+
         createInstance();
         createSurface();
         pickPhysicalDeviceForPresentation();
         createLogicalDevice();
+        m_Allocator.init(m_Device, m_SelectedDeviceInfo.physicalDevice);
+        if (m_Jobs)
+            m_Jobs->wait(cacheRead);
+        m_PipelineCacheFile = std::move(*cacheFile);
+        createPipelineCache();
+
+        // Global texture/material table; passes fall back to per-material sets without it.
+        if (m_HasDescriptorIndexing)
+        {
+            m_Bindless = std::make_unique<BindlessMaterials>();
+            if (!m_Bindless->create(*this))
+            {
+                m_Bindless->destroy();
+                m_Bindless.reset();
+            }
+        }
 
         m_SwapChain = std::make_unique<SwapChain>(
             m_Device,
@@ -59,9 +97,17 @@ namespace Engine
             vkDeviceWaitIdle(m_Device);
         }
 
+        if (m_Bindless)
+        {
+            m_Bindless->destroy();
+            m_Bindless.reset();
+        }
+
         // Destroy device first (this will free device-local resources)
         if (m_Device != VK_NULL_HANDLE)
         {
+            savePipelineCache();
+            m_Allocator.shutdown();
             vkDestroyDevice(m_Device, nullptr);
             m_Device = VK_NULL_HANDLE;
         }
@@ -83,6 +129,139 @@ namespace Engine
         }
     }
 
+    // ------------------------------------------------------------
+    // Pipeline cache file
+    // ------------------------------------------------------------
+    // Header in front of the vkGetPipelineCacheData() blob. The driver validates its own header
+    // too, but checking here lets us drop stale files (driver update, other GPU) up front.
+    namespace
+    {
+        struct PipelineCacheFileHeader
+        {
+            uint32_t magic;   // 'SPCH'
+            uint32_t version; // bump when the layout changes
+            uint32_t vendorID;
+            uint32_t deviceID;
+            uint32_t driverVersion;
+            uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+            uint64_t dataSize;
+        };
+
+        constexpr uint32_t PIPELINE_CACHE_MAGIC = 0x48435053u; // "SPCH"
+        constexpr uint32_t PIPELINE_CACHE_VERSION = 1u;
+
+        PipelineCacheFileHeader makePipelineCacheHeader(VkPhysicalDevice physicalDevice)
+        {
+            VkPhysicalDeviceProperties props{};
+            vkGetPhysicalDeviceProperties(physicalDevice, &props);
+
+            PipelineCacheFileHeader h{};
+            h.magic = PIPELINE_CACHE_MAGIC;
+            h.version = PIPELINE_CACHE_VERSION;
+            h.vendorID = props.vendorID;
+            h.deviceID = props.deviceID;
+            h.driverVersion = props.driverVersion;
+            std::memcpy(h.pipelineCacheUUID, props.pipelineCacheUUID, VK_UUID_SIZE);
+            return h;
+        }
+    }
+
+    void VulkanContext::createPipelineCache()
+    {
+        const PipelineCacheFileHeader expected = makePipelineCacheHeader(m_SelectedDeviceInfo.physicalDevice);
+
+        std::vector<char> initialData;
+        {
+            const std::vector<char> file = std::move(m_PipelineCacheFile);
+            m_PipelineCacheFile.clear();
+            {
+                PipelineCacheFileHeader h{};
+                if (file.size() >= sizeof(h))
+                {
+                    std::memcpy(&h, file.data(), sizeof(h));
+                    const bool match = h.magic == expected.magic &&
+                                       h.version == expected.version &&
+                                       h.vendorID == expected.vendorID &&
+                                       h.deviceID == expected.deviceID &&
+                                       h.driverVersion == expected.driverVersion &&
+                                       std::memcmp(h.pipelineCacheUUID, expected.pipelineCacheUUID, VK_UUID_SIZE) == 0 &&
+                                       h.dataSize == file.size() - sizeof(h);
+                    if (match)
+                        initialData.assign(file.begin() + sizeof(h), file.end());
+                }
+            }
+        }
+
+        VkPipelineCacheCreateInfo ci{};
+        ci.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        ci.initialDataSize = initialData.size();
+        ci.pInitialData = initialData.empty() ? nullptr : initialData.data();
+
+        VkResult r = vkCreatePipelineCache(m_Device, &ci, nullptr, &m_PipelineCache);
+        if (r != VK_SUCCESS && !initialData.empty())
+        {
+            // Rejected blob: start empty instead.
+            ci.initialDataSize = 0;
+            ci.pInitialData = nullptr;
+            r = vkCreatePipelineCache(m_Device, &ci, nullptr, &m_PipelineCache);
+        }
+        if (r != VK_SUCCESS)
+            m_PipelineCache = VK_NULL_HANDLE; // pipelines are still created, just uncached
+
+#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
+        std::cout << "[Vulkan] Pipeline cache " << (initialData.empty() ? "created empty" : "loaded from disk")
+                  << " (" << initialData.size() << " bytes)\n";
+#endif
+    }
+
+    void VulkanContext::savePipelineCache()
+    {
+        if (m_PipelineCache == VK_NULL_HANDLE)
+            return;
+
+        size_t size = 0;
+        std::vector<char> data;
+        if (vkGetPipelineCacheData(m_Device, m_PipelineCache, &size, nullptr) == VK_SUCCESS && size > 0)
+        {
+            data.resize(size);
+            if (vkGetPipelineCacheData(m_Device, m_PipelineCache, &size, data.data()) != VK_SUCCESS)
+                data.clear();
+            data.resize(std::min(size, data.size()));
+        }
+
+        if (!data.empty())
+        {
+            PipelineCacheFileHeader h = makePipelineCacheHeader(m_SelectedDeviceInfo.physicalDevice);
+            h.dataSize = data.size();
+
+            // Write to a temp file first so a crash mid-write never leaves a truncated cache.
+            const std::string tmpPath = std::string(PIPELINE_CACHE_FILE) + ".tmp";
+            bool written = false;
+            {
+                std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+                if (out)
+                {
+                    out.write(reinterpret_cast<const char *>(&h), sizeof(h));
+                    out.write(data.data(), static_cast<std::streamsize>(data.size()));
+                    written = static_cast<bool>(out);
+                }
+            }
+            if (written)
+            {
+                std::remove(PIPELINE_CACHE_FILE);
+                written = std::rename(tmpPath.c_str(), PIPELINE_CACHE_FILE) == 0;
+            }
+            if (!written)
+            {
+                std::remove(tmpPath.c_str());
+                std::cerr << "[Vulkan] Failed to write " << PIPELINE_CACHE_FILE << "\n";
+            }
+        }
+
+        vkDestroyPipelineCache(m_Device, m_PipelineCache, nullptr);
+        m_PipelineCache = VK_NULL_HANDLE;
+    }
+
     bool VulkanContext::checkValidationLayerSupport()
     {
         const char *layerName = "VK_LAYER_KHRONOS_validation";
@@ -141,13 +320,38 @@ namespace Engine
             extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
         }
 
+        // Vulkan 1.0 needs this to query descriptor indexing support (see createLogicalDevice).
+        {
+            uint32_t availCount = 0;
+            vkEnumerateInstanceExtensionProperties(nullptr, &availCount, nullptr);
+            std::vector<VkExtensionProperties> available(availCount);
+            vkEnumerateInstanceExtensionProperties(nullptr, &availCount, available.data());
+            for (const auto &ext : available)
+            {
+                if (std::strcmp(ext.extensionName, VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) == 0)
+                {
+                    extensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+                    m_HasPhysicalDeviceProperties2 = true;
+                    break;
+                }
+            }
+        }
+
         VkApplicationInfo appInfo{};
         appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
         appInfo.pApplicationName = "MyEngine";
         appInfo.applicationVersion = VK_MAKE_VERSION(0, 1, 0);
         appInfo.pEngineName = "MyEngine";
         appInfo.engineVersion = VK_MAKE_VERSION(0, 1, 0);
-        appInfo.apiVersion = VK_API_VERSION_1_0;
+        // 1.1 when the loader has it: VK_KHR_spirv_1_4 (mesh shaders) needs a 1.1 instance.
+        // Everything else here is written against 1.0 plus extensions.
+        m_InstanceApiVersion = VK_API_VERSION_1_0;
+        auto enumerateInstanceVersion = reinterpret_cast<PFN_vkEnumerateInstanceVersion>(
+            vkGetInstanceProcAddr(VK_NULL_HANDLE, "vkEnumerateInstanceVersion"));
+        uint32_t loaderVersion = VK_API_VERSION_1_0;
+        if (enumerateInstanceVersion && enumerateInstanceVersion(&loaderVersion) == VK_SUCCESS && loaderVersion >= VK_API_VERSION_1_1)
+            m_InstanceApiVersion = VK_API_VERSION_1_1;
+        appInfo.apiVersion = m_InstanceApiVersion;
 
         VkInstanceCreateInfo ci{};
         ci.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -285,6 +489,18 @@ namespace Engine
             ++i;
         }
 
+        // Dedicated families run beside the graphics queue instead of sharing its timeline.
+        for (uint32_t f = 0; f < queueFamilyCount; ++f)
+        {
+            const VkQueueFlags flags = queueFamilies[f].queueFlags;
+            if (flags & VK_QUEUE_GRAPHICS_BIT)
+                continue;
+            if ((flags & VK_QUEUE_COMPUTE_BIT) && !indices.computeFamily.has_value())
+                indices.computeFamily = f;
+            else if ((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & VK_QUEUE_COMPUTE_BIT) && !indices.transferFamily.has_value())
+                indices.transferFamily = f;
+        }
+
         return indices;
     }
 
@@ -331,6 +547,10 @@ namespace Engine
         std::set<uint32_t> uniqueQueueFamilies;
         uniqueQueueFamilies.insert(indices.graphicsFamily.value());
         uniqueQueueFamilies.insert(indices.presentFamily.value());
+        if (indices.computeFamily.has_value())
+            uniqueQueueFamilies.insert(indices.computeFamily.value());
+        if (indices.transferFamily.has_value())
+            uniqueQueueFamilies.insert(indices.transferFamily.value());
 
         float queuePriority = 1.0f;
         for (uint32_t queueFamily : uniqueQueueFamilies)
@@ -347,6 +567,21 @@ namespace Engine
         VkPhysicalDeviceFeatures deviceFeatures{};
         // deviceFeatures.samplerAnisotropy = VK_TRUE; // enable if needed
 
+        // Cooked textures may be BC7 (desktop) or ASTC (mobile); enable whichever exists.
+        // Same for the indirect-draw features used by SModelRenderPassModule.
+        {
+            VkPhysicalDeviceFeatures supported{};
+            vkGetPhysicalDeviceFeatures(m_SelectedDeviceInfo.physicalDevice, &supported);
+            deviceFeatures.textureCompressionBC = supported.textureCompressionBC;
+            deviceFeatures.textureCompressionASTC_LDR = supported.textureCompressionASTC_LDR;
+            deviceFeatures.drawIndirectFirstInstance = supported.drawIndirectFirstInstance;
+            deviceFeatures.multiDrawIndirect = supported.multiDrawIndirect;
+            // Per-pass invocation counts in Renderer (only queried when turned on).
+            deviceFeatures.pipelineStatisticsQuery = supported.pipelineStatisticsQuery;
+            // Bindless materials index the texture array with a push-constant material ID.
+            deviceFeatures.shaderSampledImageArrayDynamicIndexing = supported.shaderSampledImageArrayDynamicIndexing;
+        }
+
         VkDeviceCreateInfo createInfo{};
         createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
         createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
@@ -375,6 +610,156 @@ namespace Engine
                     }
                 }
             }
+
+            // Descriptor indexing (BindlessMaterials): a partially bound, update-after-bind
+            // texture array. Enabled only with every feature it relies on.
+            auto hasExt = [&](const char *name)
+            {
+                for (const auto &avail : availableExts)
+                {
+                    if (std::strcmp(avail.extensionName, name) == 0)
+                        return true;
+                }
+                return false;
+            };
+            auto getFeatures2 = m_HasPhysicalDeviceProperties2
+                                    ? reinterpret_cast<PFN_vkGetPhysicalDeviceFeatures2KHR>(
+                                          vkGetInstanceProcAddr(m_Instance, "vkGetPhysicalDeviceFeatures2KHR"))
+                                    : nullptr;
+            if (getFeatures2 && deviceFeatures.shaderSampledImageArrayDynamicIndexing &&
+                hasExt(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME) && hasExt(VK_KHR_MAINTENANCE3_EXTENSION_NAME))
+            {
+                VkPhysicalDeviceDescriptorIndexingFeaturesEXT supported{};
+                supported.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+                VkPhysicalDeviceFeatures2KHR features2{};
+                features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR;
+                features2.pNext = &supported;
+                getFeatures2(m_SelectedDeviceInfo.physicalDevice, &features2);
+
+                if (supported.runtimeDescriptorArray && supported.descriptorBindingPartiallyBound &&
+                    supported.descriptorBindingSampledImageUpdateAfterBind && supported.descriptorBindingUpdateUnusedWhilePending)
+                {
+                    m_DescriptorIndexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+                    m_DescriptorIndexingFeatures.runtimeDescriptorArray = VK_TRUE;
+                    m_DescriptorIndexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+                    m_DescriptorIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+                    m_DescriptorIndexingFeatures.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+                    // Not needed yet (material IDs are dynamically uniform); lets per-instance IDs follow.
+                    m_DescriptorIndexingFeatures.shaderSampledImageArrayNonUniformIndexing = supported.shaderSampledImageArrayNonUniformIndexing;
+                    createInfo.pNext = &m_DescriptorIndexingFeatures;
+
+                    enabledExtensions.push_back(VK_KHR_MAINTENANCE3_EXTENSION_NAME);
+                    enabledExtensions.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+                    m_HasDescriptorIndexing = true;
+                    std::cout << "[Vulkan] Enabling optional extension: " << VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME << "\n";
+                }
+            }
+
+            // Present id + present wait (Renderer frame pacing): wait until a given present is on
+            // screen instead of only until the GPU finished it.
+            if (getFeatures2 && hasExt(VK_KHR_PRESENT_ID_EXTENSION_NAME) && hasExt(VK_KHR_PRESENT_WAIT_EXTENSION_NAME))
+            {
+                VkPhysicalDevicePresentWaitFeaturesKHR waitSupported{};
+                waitSupported.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+                VkPhysicalDevicePresentIdFeaturesKHR idSupported{};
+                idSupported.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+                idSupported.pNext = &waitSupported;
+                VkPhysicalDeviceFeatures2KHR features2{};
+                features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR;
+                features2.pNext = &idSupported;
+                getFeatures2(m_SelectedDeviceInfo.physicalDevice, &features2);
+
+                if (idSupported.presentId && waitSupported.presentWait)
+                {
+                    m_PresentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+                    m_PresentWaitFeatures.presentWait = VK_TRUE;
+                    m_PresentWaitFeatures.pNext = const_cast<void *>(createInfo.pNext);
+                    m_PresentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+                    m_PresentIdFeatures.presentId = VK_TRUE;
+                    m_PresentIdFeatures.pNext = &m_PresentWaitFeatures;
+                    createInfo.pNext = &m_PresentIdFeatures;
+
+                    enabledExtensions.push_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+                    enabledExtensions.push_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+                    m_HasPresentWait = true;
+                    std::cout << "[Vulkan] Enabling optional extension: " << VK_KHR_PRESENT_WAIT_EXTENSION_NAME << "\n";
+                }
+            }
+
+            // Timeline semaphores (Renderer async compute): one counter per queue replaces a
+            // binary semaphore per frame and lets either queue wait for "frame N done".
+            if (getFeatures2 && hasExt(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME))
+            {
+                VkPhysicalDeviceTimelineSemaphoreFeaturesKHR supported{};
+                supported.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+                VkPhysicalDeviceFeatures2KHR features2{};
+                features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR;
+                features2.pNext = &supported;
+                getFeatures2(m_SelectedDeviceInfo.physicalDevice, &features2);
+
+                if (supported.timelineSemaphore)
+                {
+                    m_TimelineSemaphoreFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+                    m_TimelineSemaphoreFeatures.timelineSemaphore = VK_TRUE;
+                    m_TimelineSemaphoreFeatures.pNext = const_cast<void *>(createInfo.pNext);
+                    createInfo.pNext = &m_TimelineSemaphoreFeatures;
+
+                    enabledExtensions.push_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+                    m_HasTimelineSemaphore = true;
+                    std::cout << "[Vulkan] Enabling optional extension: " << VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME << "\n";
+                }
+            }
+
+            // Draw indirect count (SModelRenderPassModule meshlet culling fallback): the number
+            // of commands comes from a buffer the cull shader wrote.
+            if (hasExt(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME))
+            {
+                enabledExtensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+                m_HasDrawIndirectCount = true;
+                std::cout << "[Vulkan] Enabling optional extension: " << VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME << "\n";
+            }
+
+            // Mesh shaders (SModelRenderPassModule meshlet path): task + mesh stages. The
+            // extension's SPIR-V needs VK_KHR_spirv_1_4, which needs a 1.1 instance and device.
+            VkPhysicalDeviceProperties deviceProps{};
+            vkGetPhysicalDeviceProperties(m_SelectedDeviceInfo.physicalDevice, &deviceProps);
+            auto getProperties2 = m_HasPhysicalDeviceProperties2
+                                      ? reinterpret_cast<PFN_vkGetPhysicalDeviceProperties2KHR>(
+                                            vkGetInstanceProcAddr(m_Instance, "vkGetPhysicalDeviceProperties2KHR"))
+                                      : nullptr;
+            if (getFeatures2 && getProperties2 && m_InstanceApiVersion >= VK_API_VERSION_1_1 && deviceProps.apiVersion >= VK_API_VERSION_1_1 &&
+                hasExt(VK_EXT_MESH_SHADER_EXTENSION_NAME) && hasExt(VK_KHR_SPIRV_1_4_EXTENSION_NAME) &&
+                hasExt(VK_KHR_SHADER_FLOAT_CONTROLS_EXTENSION_NAME))
+            {
+                VkPhysicalDeviceMeshShaderFeaturesEXT supported{};
+                supported.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT;
+                VkPhysicalDeviceFeatures2KHR features2{};
+                features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR;
+                features2.pNext = &supported;
+                getFeatures2(m_SelectedDeviceInfo.physicalDevice, &features2);
+
+                if (supported.taskShader && supported.meshShader)
+                {
+                    m_MeshShaderProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_PROPERTIES_EXT;
+                    VkPhysicalDeviceProperties2KHR props2{};
+                    props2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2_KHR;
+                    props2.pNext = &m_MeshShaderProperties;
+                    getProperties2(m_SelectedDeviceInfo.physicalDevice, &props2);
+                    m_MeshShaderProperties.pNext = nullptr;
+
+                    m_MeshShaderFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT;
+                    m_MeshShaderFeatures.taskShader = VK_TRUE;
+                    m_MeshShaderFeatures.meshShader = VK_TRUE;
+                    m_MeshShaderFeatures.pNext = const_cast<void *>(createInfo.pNext);
+                    createInfo.pNext = &m_MeshShaderFeatures;
+
+                    enabledExtensions.push_back(VK_KHR_SHADER_FLOAT_CONTROLS_EXTENSION_NAME);
+                    enabledExtensions.push_back(VK_KHR_SPIRV_1_4_EXTENSION_NAME);
+                    enabledExtensions.push_back(VK_EXT_MESH_SHADER_EXTENSION_NAME);
+                    m_HasMeshShader = true;
+                    std::cout << "[Vulkan] Enabling optional extension: " << VK_EXT_MESH_SHADER_EXTENSION_NAME << "\n";
+                }
+            }
         }
 
         // Device extensions
@@ -393,12 +778,26 @@ namespace Engine
         std::cout << "Logical device created\n";
 #endif
 
+        if (m_HasPresentWait)
+        {
+            m_WaitForPresent = reinterpret_cast<PFN_vkWaitForPresentKHR>(vkGetDeviceProcAddr(m_Device, "vkWaitForPresentKHR"));
+            m_HasPresentWait = (m_WaitForPresent != nullptr);
+        }
+
         // Retrieve queue handles
         vkGetDeviceQueue(m_Device, indices.graphicsFamily.value(), 0, &m_GraphicsQueue);
         vkGetDeviceQueue(m_Device, indices.presentFamily.value(), 0, &m_PresentQueue);
+        if (indices.computeFamily.has_value())
+            vkGetDeviceQueue(m_Device, indices.computeFamily.value(), 0, &m_ComputeQueue);
+        if (indices.transferFamily.has_value())
+            vkGetDeviceQueue(m_Device, indices.transferFamily.value(), 0, &m_TransferQueue);
 
 #if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
         std::cout << "Graphics queue and Present queue retrieved\n";
+        if (m_ComputeQueue != VK_NULL_HANDLE)
+            std::cout << "Dedicated compute queue retrieved (family " << indices.computeFamily.value() << ")\n";
+        if (m_TransferQueue != VK_NULL_HANDLE)
+            std::cout << "Dedicated transfer queue retrieved (family " << indices.transferFamily.value() << ")\n";
 #endif
     }
 }
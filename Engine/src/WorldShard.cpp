@@ -0,0 +1,299 @@
+#include "ECS/WorldShard.h"
+
+#include "ECS/ECSContext.h"
+#include "ECS/EntityPacket.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Engine::ECS
+{
+    // ------------------------------------------------------------
+    // ShardLayout
+    // ------------------------------------------------------------
+    namespace
+    {
+        std::vector<float> snappedCuts(float minV, float maxV, float cellSize, uint32_t regions)
+        {
+            std::vector<float> cuts;
+            const float step = (maxV - minV) / static_cast<float>(std::max(1u, regions));
+            for (uint32_t i = 1; i < regions; ++i)
+                cuts.push_back(minV + std::round(step * static_cast<float>(i) / cellSize) * cellSize);
+            return cuts;
+        }
+
+        void axisRange(const std::vector<float> &cuts, uint32_t index, float &lo, float &hi)
+        {
+            lo = index > 0 ? cuts[index - 1] : -std::numeric_limits<float>::infinity();
+            hi = index < cuts.size() ? cuts[index] : std::numeric_limits<float>::infinity();
+        }
+    }
+
+    ShardLayout ShardLayout::grid(float minX, float minZ, float maxX, float maxZ, float cellSize,
+                                  uint32_t regionsX, uint32_t regionsZ)
+    {
+        ShardLayout layout;
+        layout.originX = minX;
+        layout.originZ = minZ;
+        layout.cellSize = cellSize > 1e-6f ? cellSize : 1e-6f;
+        layout.cutsX = snappedCuts(minX, maxX, layout.cellSize, regionsX);
+        layout.cutsZ = snappedCuts(minZ, maxZ, layout.cellSize, regionsZ);
+        return layout;
+    }
+
+    uint32_t ShardLayout::regionOf(float x, float z) const
+    {
+        const uint32_t ix = static_cast<uint32_t>(std::upper_bound(cutsX.begin(), cutsX.end(), x) - cutsX.begin());
+        const uint32_t iz = static_cast<uint32_t>(std::upper_bound(cutsZ.begin(), cutsZ.end(), z) - cutsZ.begin());
+        return iz * regionsX() + ix;
+    }
+
+    float ShardLayout::distanceToRegion(float x, float z, uint32_t region) const
+    {
+        float x0, x1, z0, z1;
+        axisRange(cutsX, region % regionsX(), x0, x1);
+        axisRange(cutsZ, region / regionsX(), z0, z1);
+        const float dx = std::max({x0 - x, 0.0f, x - x1});
+        const float dz = std::max({z0 - z, 0.0f, z - z1});
+        return std::sqrt(dx * dx + dz * dz);
+    }
+
+    // ------------------------------------------------------------
+    // WorldShard
+    // ------------------------------------------------------------
+    WorldShard::WorldShard(const ShardLayout &layout, uint32_t region)
+        : WorldShard(layout, region, Config{})
+    {
+    }
+
+    WorldShard::WorldShard(const ShardLayout &layout, uint32_t region, Config config)
+        : m_layout(layout), m_region(region), m_cfg(std::move(config))
+    {
+    }
+
+    void WorldShard::attach(ECSContext &ecs)
+    {
+        ComponentRegistry &registry = ecs.components;
+        m_ghostTagId = registry.registerSparseTag("Ghost");
+        m_positionId = registry.ensureId("Position");
+        m_velocityId = registry.ensureId("Velocity");
+        m_deadId = registry.ensureId("Dead");
+        m_stripped = ComponentMask{};
+        for (const std::string &name : m_cfg.ghostStripped)
+            m_stripped.set(registry.ensureId(name));
+    }
+
+    bool WorldShard::isMoverStore(const ComponentMask &signature) const
+    {
+        return signature.has(m_positionId) && signature.has(m_velocityId);
+    }
+
+    bool WorldShard::isGhost(const ECSContext &ecs, Entity e) const
+    {
+        const SparseTagSet *set = ecs.sparseTag(m_ghostTagId);
+        return set && set->has(e);
+    }
+
+    uint32_t WorldShard::keepOwned(ECSContext &ecs)
+    {
+        std::vector<Entity> foreign;
+        for (const std::unique_ptr<ArchetypeStore> &store : ecs.stores.stores())
+        {
+            if (!store || !isMoverStore(store->signature()))
+                continue;
+            const ColumnView<Position> positions = store->positions();
+            const std::vector<Entity> &entities = store->entities();
+            for (uint32_t row = 0; row < store->size(); ++row)
+            {
+                if (m_layout.regionOf(positions[row].x, positions[row].z) != m_region)
+                    foreign.push_back(entities[row]);
+            }
+        }
+        for (const Entity e : foreign)
+            ecs.destroyEntity(e);
+        return static_cast<uint32_t>(foreign.size());
+    }
+
+    void WorldShard::collect(ECSContext &ecs, std::vector<ShardMessages> &outByRegion)
+    {
+        const uint32_t regions = m_layout.regionCount();
+        outByRegion.resize(regions);
+        for (ShardMessages &m : outByRegion)
+            m.clear();
+        m_migrantsTo.resize(regions);
+        m_ghostsTo.resize(regions);
+        for (uint32_t r = 0; r < regions; ++r)
+        {
+            m_migrantsTo[r].clear();
+            m_ghostsTo[r].clear();
+        }
+
+        // Hits our units landed on ghosts go back to the owners.
+        for (auto &kv : m_ghosts)
+        {
+            Ghost &g = kv.second;
+            const EntityRecord *rec = ecs.entities.find(g.local);
+            ArchetypeStore *store = rec ? ecs.stores.get(rec->archetypeId) : nullptr;
+            if (!store || rec->row >= store->size() || !store->hasHealth())
+                continue;
+            const float hp = store->healths()[rec->row].value;
+            if (hp < g.receivedHealth)
+            {
+                const uint32_t from = static_cast<uint32_t>(kv.first >> 32);
+                if (from < regions)
+                    outByRegion[from].damage.push_back(HealthDelta{g.owner, hp - g.receivedHealth});
+                g.receivedHealth = hp;
+                ++m_stats.damageForwarded;
+            }
+        }
+
+        const SparseTagSet *ghostSet = ecs.sparseTag(m_ghostTagId);
+        for (const std::unique_ptr<ArchetypeStore> &store : ecs.stores.stores())
+        {
+            if (!store || !isMoverStore(store->signature()))
+                continue;
+            const bool dead = store->signature().has(m_deadId);
+            const ColumnView<Position> positions = store->positions();
+            const std::vector<Entity> &entities = store->entities();
+            for (uint32_t row = 0; row < store->size(); ++row)
+            {
+                const Entity e = entities[row];
+                if (ghostSet && ghostSet->has(e))
+                    continue;
+                const Position &p = positions[row];
+                const uint32_t owner = m_layout.regionOf(p.x, p.z);
+                if (owner != m_region && !dead)
+                {
+                    m_migrantsTo[owner].push_back(e);
+                    continue;
+                }
+                // Dead units stay with their owner until removed, but neighbours still see them fall.
+                for (uint32_t r = 0; r < regions; ++r)
+                {
+                    if (r != m_region && m_layout.distanceToRegion(p.x, p.z, r) <= m_cfg.ghostMargin)
+                        m_ghostsTo[r].push_back(e);
+                }
+            }
+        }
+
+        static const ComponentMask keepAll{};
+        for (uint32_t r = 0; r < regions; ++r)
+        {
+            if (r == m_region)
+                continue;
+            ShardMessages &m = outByRegion[r];
+            m_stats.migratedOut += packEntities(ecs, m_migrantsTo[r].data(), static_cast<uint32_t>(m_migrantsTo[r].size()),
+                                                keepAll, m.migrants);
+            m_stats.ghostsSent += packEntities(ecs, m_ghostsTo[r].data(), static_cast<uint32_t>(m_ghostsTo[r].size()),
+                                               m_stripped, m.ghosts);
+            m_stats.bytesSent += m.bytes();
+        }
+        for (uint32_t r = 0; r < regions; ++r)
+        {
+            for (const Entity e : m_migrantsTo[r])
+                ecs.destroyEntity(e);
+        }
+
+        ++m_exchange;
+    }
+
+    bool WorldShard::deliver(ECSContext &ecs, uint32_t fromRegion, const ShardMessages &messages, std::string &outError)
+    {
+        for (const HealthDelta &d : messages.damage)
+        {
+            const EntityRecord *rec = ecs.entities.find(d.target);
+            ArchetypeStore *store = rec ? ecs.stores.get(rec->archetypeId) : nullptr;
+            if (!store || rec->row >= store->size() || !store->hasHealth() || isGhost(ecs, d.target))
+                continue; // died or left this shard since the hit
+            store->healths()[rec->row].value += d.delta;
+        }
+
+        SparseTagSet *ghostSet = ecs.sparseTag(m_ghostTagId);
+        EntityPacketReader packet;
+
+        if (!messages.migrants.empty())
+        {
+            if (!packet.open(messages.migrants.data(), messages.migrants.size(), ecs.components, outError))
+                return false;
+            for (const SnapshotStoreView &view : packet.stores())
+            {
+                for (uint32_t row = 0; row < view.rowCount; ++row)
+                {
+                    // A ghost of the unit becomes the unit: units fighting it keep their handle.
+                    auto it = m_ghosts.find(ghostKey(fromRegion, view.entity(row)));
+                    if (it != m_ghosts.end() && it->second.owner.generation == view.entity(row).generation &&
+                        unpackRowInto(ecs, view, row, it->second.local))
+                    {
+                        if (ghostSet)
+                            ghostSet->remove(it->second.local);
+                        m_ghosts.erase(it);
+                    }
+                    else
+                    {
+                        if (it != m_ghosts.end())
+                            forgetGhost(ecs, it);
+                        unpackRow(ecs, view, row);
+                    }
+                    ++m_stats.migratedIn;
+                }
+            }
+        }
+
+        if (!messages.ghosts.empty())
+        {
+            if (!packet.open(messages.ghosts.data(), messages.ghosts.size(), ecs.components, outError))
+                return false;
+            for (const SnapshotStoreView &view : packet.stores())
+            {
+                for (uint32_t row = 0; row < view.rowCount; ++row)
+                {
+                    const Entity owner = view.entity(row);
+                    const uint64_t key = ghostKey(fromRegion, owner);
+                    auto it = m_ghosts.find(key);
+                    if (it != m_ghosts.end() &&
+                        (it->second.owner.generation != owner.generation || !unpackRowInto(ecs, view, row, it->second.local)))
+                    {
+                        forgetGhost(ecs, it); // the owner reused the slot, or the ghost was destroyed here
+                        it = m_ghosts.end();
+                    }
+                    if (it == m_ghosts.end())
+                    {
+                        const Entity local = unpackRow(ecs, view, row);
+                        if (!local.valid())
+                            continue;
+                        if (ghostSet)
+                            ghostSet->add(local);
+                        it = m_ghosts.emplace(key, Ghost{owner, local, 0.0f, 0}).first;
+                    }
+
+                    Ghost &g = it->second;
+                    const EntityRecord *rec = ecs.entities.find(g.local);
+                    const ArchetypeStore *store = rec ? ecs.stores.get(rec->archetypeId) : nullptr;
+                    g.receivedHealth = (store && store->hasHealth()) ? store->healths()[rec->row].value : 0.0f;
+                    g.exchange = m_exchange;
+                }
+            }
+        }
+        return true;
+    }
+
+    void WorldShard::endExchange(ECSContext &ecs)
+    {
+        for (auto it = m_ghosts.begin(); it != m_ghosts.end();)
+        {
+            auto next = std::next(it);
+            if (it->second.exchange != m_exchange)
+                forgetGhost(ecs, it);
+            it = next;
+        }
+        m_stats.ghosts = static_cast<uint32_t>(m_ghosts.size());
+    }
+
+    void WorldShard::forgetGhost(ECSContext &ecs, std::unordered_map<uint64_t, Ghost>::iterator it)
+    {
+        if (ecs.entities.isAlive(it->second.local))
+            ecs.destroyEntity(it->second.local);
+        m_ghosts.erase(it);
+    }
+}
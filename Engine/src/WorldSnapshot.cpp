@@ -0,0 +1,522 @@
+#include "ECS/WorldSnapshot.h"
+
+#include "ECS/ECSContext.h"
+#include "ECS/SnapshotFormat.h"
+#include "ECS/systems/NavGrid.h"
+#if !defined(ENGINE_HEADLESS) || !ENGINE_HEADLESS
+#include "assets/AssetManager.h"
+#endif
+#include "utils/MappedFile.h"
+#include "utils/Profiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+namespace Engine::ECS
+{
+    // ------------------------------------------------------------
+    // File records (the rest are shared with entity packets: SnapshotFormat.h)
+    // ------------------------------------------------------------
+    struct NavGridRecord
+    {
+        float cellSize = 0.0f;
+        float worldMinX = 0.0f;
+        float worldMinZ = 0.0f;
+        float inflation = 0.0f;
+        int32_t width = 0;
+        int32_t height = 0;
+        int32_t regionsX = 0;
+        int32_t regionsZ = 0;
+        uint32_t revision = 0;
+        uint32_t layoutRevision = 0;
+        uint64_t blockedWords = 0;
+        uint64_t clearanceBytes = 0;
+        uint64_t regionCount = 0;
+    };
+
+    static_assert(sizeof(EntitiesRecord::Slot) == 12, "EntitiesRecord::Slot is stored verbatim");
+    static_assert(sizeof(NavGridRecord) == 64, "NavGridRecord is a file format struct");
+
+    namespace
+    {
+        bool Fail(std::string &outError, const std::string &path, const char *what)
+        {
+            outError = "World snapshot '" + path + "': " + what;
+            return false;
+        }
+    } // namespace
+
+    // ------------------------------------------------------------
+    // Save
+    // ------------------------------------------------------------
+    bool saveWorldSnapshot(const std::string &path, const ECSContext &ecs, const NavGrid *nav,
+                           const Engine::AssetManager *assets, std::string &outError,
+                           WorldSnapshotStats *outStats)
+    {
+        ENGINE_PROFILE_ZONE("WorldSnapshot::save");
+        const ComponentRegistry &registry = ecs.components;
+        const uint32_t componentCount = registry.count();
+
+        // RenderModel handles become 1-based indices into the model table.
+        const uint32_t renderModelId = registry.getId("RenderModel");
+        const ComponentTypeInfo *renderModelType = registry.typeInfo(renderModelId);
+        const bool remapModels = assets && renderModelType && renderModelType->typeKey == componentTypeKey<RenderModel>();
+        std::vector<std::string> modelPaths;
+        std::unordered_map<uint64_t, uint32_t> modelIndex; // handle id -> 1-based index (0 = none)
+
+        std::vector<const ArchetypeStore *> stores;
+        std::vector<uint32_t> storeIds;
+        for (size_t id = 0; id < ecs.stores.stores().size(); ++id)
+        {
+            const ArchetypeStore *store = ecs.stores.stores()[id].get();
+            if (store && store->size() > 0)
+            {
+                stores.push_back(store);
+                storeIds.push_back(static_cast<uint32_t>(id));
+            }
+        }
+
+#if !defined(ENGINE_HEADLESS) || !ENGINE_HEADLESS
+        if (remapModels)
+        {
+            for (const ArchetypeStore *store : stores)
+            {
+                const ComponentColumn *column = store->findColumn(renderModelId);
+                if (!column)
+                    continue;
+                for (uint32_t row = 0; row < store->size(); ++row)
+                {
+                    const ModelHandle h = static_cast<const RenderModel *>(column->at(row))->handle;
+                    if (!h.isValid() || modelIndex.count(h.id))
+                        continue;
+                    std::string modelPath = assets->modelPath(h);
+                    if (modelPath.empty())
+                    {
+                        modelIndex.emplace(h.id, 0u); // built in code or stale: not restorable
+                        continue;
+                    }
+                    modelPaths.push_back(std::move(modelPath));
+                    modelIndex.emplace(h.id, static_cast<uint32_t>(modelPaths.size()));
+                }
+            }
+        }
+#endif
+
+        std::vector<uint32_t> sparseTags;
+        for (uint32_t tagId : registry.sparseTags())
+        {
+            const SparseTagSet *set = ecs.sparseTag(tagId);
+            if (set && !set->empty())
+                sparseTags.push_back(tagId);
+        }
+
+        const std::vector<EntitiesRecord::Slot> &slots = ecs.entities.slots();
+        const std::vector<uint32_t> &freeList = ecs.entities.freeList();
+
+        WorldSnapshotHeader header;
+        header.flags = (nav ? WORLD_SNAPSHOT_HAS_NAVGRID : 0u) | (remapModels ? WORLD_SNAPSHOT_HAS_MODEL_TABLE : 0u);
+        header.componentCount = componentCount;
+        header.storeCount = static_cast<uint32_t>(stores.size());
+        header.modelCount = static_cast<uint32_t>(modelPaths.size());
+        header.sparseTagCount = static_cast<uint32_t>(sparseTags.size());
+        header.slotCount = slots.size();
+        header.freeCount = freeList.size();
+
+        SnapshotWriter w;
+        uint64_t columnBytes = 0;
+        for (const ArchetypeStore *store : stores)
+            for (const ComponentColumn &column : store->columns())
+                columnBytes += static_cast<uint64_t>(column.type().size) * store->size();
+        w.bytes.reserve(static_cast<size_t>(columnBytes) + slots.size() * sizeof(EntitiesRecord::Slot) + 64u * 1024u);
+
+        w.put(header);
+        w.align();
+        writeComponentTable(w, registry);
+
+        for (const std::string &modelPath : modelPaths)
+        {
+            w.put(static_cast<uint32_t>(modelPath.size()));
+            w.append(modelPath.data(), modelPath.size());
+        }
+        w.align();
+
+        w.append(slots.data(), slots.size() * sizeof(EntitiesRecord::Slot));
+        w.append(freeList.data(), freeList.size() * sizeof(uint32_t));
+        w.align();
+
+        uint32_t entityCount = 0;
+        for (size_t s = 0; s < stores.size(); ++s)
+        {
+            const ArchetypeStore &store = *stores[s];
+            const uint32_t rows = store.size();
+            entityCount += rows;
+
+            std::vector<uint32_t> signature;
+            for (uint32_t id = 0; id < componentCount; ++id)
+            {
+                if (store.signature().has(id))
+                    signature.push_back(id);
+            }
+            uint32_t columnCount = 0;
+            for (const ComponentColumn &column : store.columns())
+                columnCount += column.type().trivial ? 1u : 0u;
+
+            StoreRecord rec;
+            rec.archetypeId = storeIds[s];
+            rec.rowCount = rows;
+            rec.signatureCount = static_cast<uint32_t>(signature.size());
+            rec.columnCount = columnCount;
+            w.put(rec);
+            w.append(signature.data(), signature.size() * sizeof(uint32_t));
+            w.align();
+            w.append(store.entities().data(), rows * sizeof(Entity));
+            w.align();
+
+            for (const ComponentColumn &column : store.columns())
+            {
+                const ComponentTypeInfo &type = column.type();
+                if (!type.trivial)
+                    continue; // runtime cache, rebuilt after load (see header)
+
+                ColumnRecord colRec;
+                colRec.componentId = column.componentId();
+                colRec.elementSize = type.size;
+                colRec.byteCount = static_cast<uint64_t>(type.size) * rows;
+                w.put(colRec);
+                w.align();
+
+                // One copy per chunk run; the file holds the rows back to back.
+                const size_t dataAt = w.bytes.size();
+                for (uint32_t c = 0; c < store.chunkCount(); ++c)
+                {
+                    const uint32_t chunkRows = store.chunkRows(c);
+                    if (chunkRows)
+                        w.append(column.at(c * store.chunkCapacity()), static_cast<size_t>(chunkRows) * type.size);
+                }
+
+                if (remapModels && column.componentId() == renderModelId)
+                {
+                    for (uint32_t row = 0; row < rows; ++row)
+                    {
+                        uint8_t *p = w.bytes.data() + dataAt + static_cast<size_t>(row) * sizeof(RenderModel);
+                        RenderModel rm;
+                        std::memcpy(&rm, p, sizeof(rm));
+                        const auto it = modelIndex.find(rm.handle.id);
+                        rm.handle = ModelHandle{it != modelIndex.end() ? it->second : 0u, 0u};
+                        std::memcpy(p, &rm, sizeof(rm));
+                    }
+                }
+                w.align();
+            }
+        }
+
+        for (uint32_t tagId : sparseTags)
+        {
+            const SparseTagSet *set = ecs.sparseTag(tagId);
+            SparseTagRecord rec;
+            rec.tagId = tagId;
+            rec.count = set->size();
+            w.put(rec);
+            w.append(set->entities().data(), set->entities().size() * sizeof(Entity));
+            w.align();
+        }
+
+        if (nav)
+        {
+            NavGridRecord rec;
+            rec.cellSize = nav->cellSize;
+            rec.worldMinX = nav->worldMinX;
+            rec.worldMinZ = nav->worldMinZ;
+            rec.inflation = nav->inflation;
+            rec.width = nav->width;
+            rec.height = nav->height;
+            rec.regionsX = nav->regionsX;
+            rec.regionsZ = nav->regionsZ;
+            rec.revision = nav->revision;
+            rec.layoutRevision = nav->layoutRevision;
+            rec.blockedWords = nav->blockedBits.size();
+            rec.clearanceBytes = nav->clearance.size();
+            rec.regionCount = nav->regionRevision.size();
+            w.put(rec);
+            w.append(nav->blockedBits.data(), nav->blockedBits.size() * sizeof(uint64_t));
+            w.align();
+            w.append(nav->clearance.data(), nav->clearance.size());
+            w.align();
+            w.append(nav->regionRevision.data(), nav->regionRevision.size() * sizeof(uint32_t));
+            w.align();
+        }
+
+        // Write beside the target and rename, so a failed save never leaves half a snapshot.
+        const std::string tmpPath = path + ".tmp";
+        {
+            std::ofstream f(tmpPath, std::ios::binary | std::ios::trunc);
+            if (!f.is_open())
+                return Fail(outError, tmpPath, "cannot open for writing");
+            f.write(reinterpret_cast<const char *>(w.bytes.data()), static_cast<std::streamsize>(w.bytes.size()));
+            if (!f)
+                return Fail(outError, tmpPath, "write failed");
+        }
+        std::remove(path.c_str());
+        if (std::rename(tmpPath.c_str(), path.c_str()) != 0)
+            return Fail(outError, path, "cannot replace the previous snapshot");
+
+        if (outStats)
+        {
+            outStats->entities = entityCount;
+            outStats->stores = static_cast<uint32_t>(stores.size());
+            outStats->bytes = w.bytes.size();
+        }
+        return true;
+    }
+
+    // ------------------------------------------------------------
+    // Load
+    // ------------------------------------------------------------
+    bool loadWorldSnapshot(const std::string &path, ECSContext &ecs, NavGrid *nav,
+                           Engine::AssetManager *assets, std::string &outError,
+                           std::vector<Engine::ModelHandle> *outModelRefs, WorldSnapshotStats *outStats)
+    {
+        ENGINE_PROFILE_ZONE("WorldSnapshot::load");
+        MappedFile file;
+        if (!file.open(path))
+            return Fail(outError, path, "cannot open");
+
+        SnapshotReader r{file.data(), file.size(), 0};
+        WorldSnapshotHeader header;
+        if (!r.get(header) || header.magic != WORLD_SNAPSHOT_MAGIC)
+            return Fail(outError, path, "not a world snapshot");
+        if (header.version != WORLD_SNAPSHOT_VERSION)
+            return Fail(outError, path, "unsupported version");
+        if ((header.flags & WORLD_SNAPSHOT_HAS_MODEL_TABLE) && !assets)
+            return Fail(outError, path, "has a model table but no AssetManager was given");
+        if (!r.align())
+            return Fail(outError, path, "truncated");
+
+        // Everything is validated before the current world is touched.
+        ComponentRegistry &registry = ecs.components;
+        ComponentIdMap idMap;
+        {
+            std::string mismatch;
+            if (!readComponentTable(r, header.componentCount, registry, idMap, mismatch))
+            {
+                if (mismatch.empty())
+                    return Fail(outError, path, "truncated component table");
+                outError = "World snapshot '" + path + "': component '" + mismatch + "' changed layout since it was saved";
+                return false;
+            }
+        }
+
+        std::vector<std::string> modelPaths(header.modelCount);
+        for (uint32_t i = 0; i < header.modelCount; ++i)
+        {
+            uint32_t length = 0;
+            const uint8_t *chars = nullptr;
+            if (!r.get(length) || !(chars = r.take(length)))
+                return Fail(outError, path, "truncated model table");
+            modelPaths[i].assign(reinterpret_cast<const char *>(chars), length);
+        }
+        if (!r.align())
+            return Fail(outError, path, "truncated");
+
+        if (header.slotCount > UINT32_MAX || header.freeCount > header.slotCount)
+            return Fail(outError, path, "corrupt entity table");
+        std::vector<EntitiesRecord::Slot> slots(static_cast<size_t>(header.slotCount));
+        std::vector<uint32_t> freeList(static_cast<size_t>(header.freeCount));
+        {
+            const uint8_t *slotBytes = r.take(slots.size() * sizeof(EntitiesRecord::Slot));
+            const uint8_t *freeBytes = slotBytes ? r.take(freeList.size() * sizeof(uint32_t)) : nullptr;
+            if (!slotBytes || !freeBytes || !r.align())
+                return Fail(outError, path, "truncated entity table");
+            if (!slots.empty())
+                std::memcpy(slots.data(), slotBytes, slots.size() * sizeof(EntitiesRecord::Slot));
+            if (!freeList.empty())
+                std::memcpy(freeList.data(), freeBytes, freeList.size() * sizeof(uint32_t));
+        }
+        for (EntitiesRecord::Slot &slot : slots)
+            slot.record = EntityRecord{}; // re-attached per store below
+
+        // Stores: parse into views over the mapping first.
+        std::vector<SnapshotStoreView> storeViews(header.storeCount);
+        for (SnapshotStoreView &view : storeViews)
+        {
+            const char *what = nullptr;
+            if (!readStoreSection(r, idMap, view, what))
+                return Fail(outError, path, what);
+        }
+
+        struct SavedTag
+        {
+            uint32_t tagId = 0;
+            uint32_t count = 0;
+            const uint8_t *entities = nullptr;
+        };
+        std::vector<SavedTag> tagViews(header.sparseTagCount);
+        for (SavedTag &view : tagViews)
+        {
+            SparseTagRecord rec;
+            if (!r.get(rec) || rec.tagId >= idMap.ids.size())
+                return Fail(outError, path, "corrupt sparse tag");
+            view.tagId = idMap.ids[rec.tagId];
+            view.count = rec.count;
+            view.entities = r.take(static_cast<size_t>(rec.count) * sizeof(Entity));
+            if ((!view.entities && rec.count) || !r.align())
+                return Fail(outError, path, "truncated sparse tag");
+        }
+
+        NavGridRecord navRec;
+        const uint8_t *navBlocked = nullptr, *navClearance = nullptr, *navRegions = nullptr;
+        const bool hasNav = (header.flags & WORLD_SNAPSHOT_HAS_NAVGRID) != 0;
+        if (hasNav)
+        {
+            if (!r.get(navRec) ||
+                !(navBlocked = r.take(static_cast<size_t>(navRec.blockedWords) * sizeof(uint64_t))) || !r.align() ||
+                !(navClearance = r.take(static_cast<size_t>(navRec.clearanceBytes))) || !r.align() ||
+                !(navRegions = r.take(static_cast<size_t>(navRec.regionCount) * sizeof(uint32_t))))
+                return Fail(outError, path, "truncated nav grid");
+        }
+
+        // ---- Point of no return: replace the world ----
+        // Headless builds never get here with a model table: there is no AssetManager to pass.
+        std::vector<ModelHandle> models(modelPaths.size());
+#if !defined(ENGINE_HEADLESS) || !ENGINE_HEADLESS
+        for (size_t i = 0; i < modelPaths.size(); ++i)
+            models[i] = assets->loadModel(modelPaths[i]);
+#endif
+
+        for (const std::unique_ptr<ArchetypeStore> &store : ecs.stores.stores())
+        {
+            if (!store)
+                continue;
+            while (store->size() > 0)
+                (void)store->destroyRowSwap(store->size() - 1u);
+        }
+        for (uint32_t tagId : registry.sparseTags())
+        {
+            if (SparseTagSet *set = ecs.sparseTag(tagId))
+                set->clear();
+        }
+        ecs.prefabs.clearInstances();
+
+        const uint32_t renderModelId = registry.getId("RenderModel");
+        const ComponentTypeInfo *renderModelType = registry.typeInfo(renderModelId);
+        const bool remapModels = (header.flags & WORLD_SNAPSHOT_HAS_MODEL_TABLE) && renderModelType &&
+                                 renderModelType->typeKey == componentTypeKey<RenderModel>();
+        const uint32_t pathId = registry.getId("Path");
+        const uint32_t renderSlotId = registry.getId("RenderSlot");
+
+        uint32_t entityCount = 0;
+        std::vector<Entity> rowEntities;
+        for (const SnapshotStoreView &view : storeViews)
+        {
+            if (view.rowCount == 0)
+                continue;
+            const uint32_t archetypeId = ecs.archetypes.getOrCreate(view.signature);
+            ArchetypeStore *store = ecs.stores.getOrCreate(archetypeId, view.signature, registry);
+            if (!store)
+                continue;
+
+            rowEntities.resize(view.rowCount);
+            std::memcpy(rowEntities.data(), view.entities, static_cast<size_t>(view.rowCount) * sizeof(Entity));
+            const uint32_t first = store->createRows(rowEntities.data(), view.rowCount);
+
+            for (const SnapshotColumnView &col : view.columns)
+            {
+                ComponentColumn *column = store->findColumn(col.componentId);
+                if (!column)
+                    continue;
+                // Chunk runs of the destination, each filled from the contiguous file rows.
+                for (uint32_t row = first, end = first + view.rowCount; row < end;)
+                {
+                    const uint32_t runEnd = std::min(end, (store->chunkOfRow(row) + 1u) * store->chunkCapacity());
+                    std::memcpy(column->at(row), col.bytes + static_cast<size_t>(row - first) * col.elementSize,
+                                static_cast<size_t>(runEnd - row) * col.elementSize);
+                    row = runEnd;
+                }
+            }
+
+            // Handles into caches of the process that saved the world.
+            resetForeignHandles(*store, first, view.rowCount, pathId, renderSlotId);
+            ColumnView<RenderModel> renderModels = store->column<RenderModel>(renderModelId);
+            if (remapModels && !renderModels.empty())
+            {
+                for (uint32_t row = first, end = first + view.rowCount; row < end; ++row)
+                {
+                    ModelHandle &h = renderModels[row].handle;
+                    h = (h.id >= 1 && h.id <= models.size()) ? models[static_cast<size_t>(h.id - 1)] : ModelHandle{};
+                }
+            }
+
+            for (uint32_t i = 0; i < view.rowCount; ++i)
+            {
+                const Entity e = rowEntities[i];
+                if (e.index < slots.size())
+                    slots[e.index].record = EntityRecord{archetypeId, first + i};
+            }
+            ecs.queries.markRowsDirtyAll(archetypeId, first, view.rowCount, store->size());
+            entityCount += view.rowCount;
+        }
+        ecs.entities.restore(std::move(slots), std::move(freeList));
+
+        for (const SavedTag &view : tagViews)
+        {
+            SparseTagSet *set = ecs.sparseTag(view.tagId);
+            if (!set)
+                continue;
+            for (uint32_t i = 0; i < view.count; ++i)
+            {
+                Entity e;
+                std::memcpy(&e, view.entities + static_cast<size_t>(i) * sizeof(Entity), sizeof(e));
+                if (ecs.entities.isAlive(e))
+                    set->add(e);
+            }
+        }
+
+        if (hasNav && nav)
+        {
+            nav->cellSize = navRec.cellSize;
+            nav->worldMinX = navRec.worldMinX;
+            nav->worldMinZ = navRec.worldMinZ;
+            nav->inflation = navRec.inflation;
+            nav->width = navRec.width;
+            nav->height = navRec.height;
+            nav->regionsX = navRec.regionsX;
+            nav->regionsZ = navRec.regionsZ;
+            nav->blockedBits.resize(static_cast<size_t>(navRec.blockedWords));
+            if (navRec.blockedWords)
+                std::memcpy(nav->blockedBits.data(), navBlocked, nav->blockedBits.size() * sizeof(uint64_t));
+            nav->clearance.assign(navClearance, navClearance + navRec.clearanceBytes);
+
+            // Revisions only have to be new to consumers built over the previous grid: a new
+            // layout makes NavHierarchy and PathCache start over.
+            nav->revision = std::max(nav->revision, navRec.revision) + 1u;
+            nav->layoutRevision = std::max(nav->layoutRevision, navRec.layoutRevision) + 1u;
+            nav->regionRevision.assign(static_cast<size_t>(navRec.regionCount), nav->revision);
+            nav->dirtyRegions.clear();
+            // NavGridBuilderSystem's per-obstacle coverage belongs to the old world: it rasterizes
+            // once more and diffs against the restored cells, which logs nothing when they match.
+            nav->dirty = true;
+        }
+
+        if (outModelRefs)
+            outModelRefs->insert(outModelRefs->end(), models.begin(), models.end());
+#if !defined(ENGINE_HEADLESS) || !ENGINE_HEADLESS
+        else
+        {
+            for (ModelHandle h : models)
+                assets->release(h);
+        }
+#endif
+
+        if (outStats)
+        {
+            outStats->entities = entityCount;
+            outStats->stores = header.storeCount;
+            outStats->bytes = file.size();
+        }
+        return true;
+    }
+
+} // namespace Engine::ECS
@@ -0,0 +1,478 @@
+// ------------------------------------------------------------
+// AssetCook: incremental, parallel driver for the cook tools.
+//
+// Walks a raw asset directory and runs GltfToSmodelTool (.gltf/.glb) and ObjToSMeshTool (.obj)
+// for every source whose cook key changed. The key hashes the source file, the files it pulls
+// in (glTF buffers/images, .clips.json and .impostor.json sidecars), the cook options and the
+// tool executable, so a rebuilt tool re-cooks everything and an untouched asset is skipped
+// without being opened by Assimp. Keys are kept in <cooked_dir>/.cook_manifest; tool output goes to
+// <cooked_dir>/.cooklogs/ and is printed only when a cook fails.
+// ------------------------------------------------------------
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Bump when the key layout or the way outputs are named changes.
+static constexpr uint32_t COOK_CACHE_VERSION = 1;
+
+static constexpr const char *MANIFEST_NAME = ".cook_manifest";
+static constexpr const char *LOG_DIR_NAME = ".cooklogs";
+
+// ------------------------------------------------------------
+// Hashing (64-bit FNV-1a; a cache key, not a checksum)
+// ------------------------------------------------------------
+struct Hasher
+{
+    uint64_t h = 1469598103934665603ull;
+
+    void bytes(const void *data, size_t size)
+    {
+        const uint8_t *p = static_cast<const uint8_t *>(data);
+        for (size_t i = 0; i < size; ++i)
+        {
+            h ^= p[i];
+            h *= 1099511628211ull;
+        }
+    }
+
+    void str(const std::string &s)
+    {
+        const uint64_t n = s.size();
+        bytes(&n, sizeof(n));
+        bytes(s.data(), s.size());
+    }
+
+    void u64(uint64_t v) { bytes(&v, sizeof(v)); }
+};
+
+// Hashes the file's contents; false (and nothing hashed) when it cannot be read.
+static bool HashFile(const fs::path &path, Hasher &hasher)
+{
+    std::ifstream f(path, std::ios::binary);
+    if (!f.is_open())
+        return false;
+
+    std::vector<char> buffer(1u << 20);
+    uint64_t total = 0;
+    while (f)
+    {
+        f.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        const std::streamsize got = f.gcount();
+        if (got <= 0)
+            break;
+        hasher.bytes(buffer.data(), static_cast<size_t>(got));
+        total += static_cast<uint64_t>(got);
+    }
+    hasher.u64(total);
+    return true;
+}
+
+static std::string ToHex(uint64_t v)
+{
+    char buf[17];
+    std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(v));
+    return buf;
+}
+
+static std::string GenericPath(const fs::path &p)
+{
+    return p.lexically_normal().generic_string();
+}
+
+// ------------------------------------------------------------
+// glTF dependencies: external buffer/image URIs
+// ------------------------------------------------------------
+static std::string PercentDecode(const std::string &s)
+{
+    std::string out;
+    out.reserve(s.size());
+    for (size_t i = 0; i < s.size(); ++i)
+    {
+        if (s[i] == '%' && i + 2 < s.size() && std::isxdigit(static_cast<unsigned char>(s[i + 1])) &&
+            std::isxdigit(static_cast<unsigned char>(s[i + 2])))
+        {
+            out.push_back(static_cast<char>(std::strtol(s.substr(i + 1, 2).c_str(), nullptr, 16)));
+            i += 2;
+        }
+        else
+        {
+            out.push_back(s[i]);
+        }
+    }
+    return out;
+}
+
+// Every "uri": "..." string in the JSON text, except embedded data: URIs. A scan rather than a
+// parse: it only has to find what the importer will open, and any miss just costs a re-cook.
+static void CollectUris(const std::string &json, std::vector<std::string> &out)
+{
+    size_t pos = 0;
+    while ((pos = json.find("\"uri\"", pos)) != std::string::npos)
+    {
+        pos += 5;
+        size_t q = json.find_first_not_of(" \t\r\n", pos);
+        if (q == std::string::npos || json[q] != ':')
+            continue;
+        q = json.find_first_not_of(" \t\r\n", q + 1);
+        if (q == std::string::npos || json[q] != '"')
+            continue;
+
+        std::string value;
+        size_t i = q + 1;
+        for (; i < json.size() && json[i] != '"'; ++i)
+        {
+            if (json[i] == '\\' && i + 1 < json.size())
+                ++i;
+            value.push_back(json[i]);
+        }
+        pos = i;
+        if (!value.empty() && value.compare(0, 5, "data:") != 0)
+            out.push_back(PercentDecode(value));
+    }
+}
+
+static std::string ReadGltfJson(const fs::path &path)
+{
+    std::ifstream f(path, std::ios::binary);
+    if (!f.is_open())
+        return {};
+
+    if (path.extension() != ".glb")
+        return std::string(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+
+    // GLB: 12-byte header, then the JSON chunk (length, type 'JSON', data).
+    uint32_t header[5] = {};
+    if (!f.read(reinterpret_cast<char *>(header), sizeof(header)) || header[0] != 0x46546C67u || header[4] != 0x4E4F534Au)
+        return {};
+    std::string json(header[3], '\0');
+    f.read(&json[0], static_cast<std::streamsize>(json.size()));
+    return json;
+}
+
+// ------------------------------------------------------------
+// Cook jobs
+// ------------------------------------------------------------
+enum class SourceKind
+{
+    Gltf,
+    Obj
+};
+
+struct CookJob
+{
+    SourceKind kind = SourceKind::Gltf;
+    fs::path source;
+    std::string sourceRel; // manifest key, relative to the raw dir
+    fs::path output;
+    uint64_t key = 0;
+
+    bool cooked = false; // ran this time (else up to date)
+    bool ok = true;
+    double seconds = 0.0;
+};
+
+struct CookOptions
+{
+    fs::path rawDir;
+    fs::path cookedDir;
+    std::string gltfTool;
+    std::string objTool;
+    std::vector<std::string> gltfArgs;
+    uint32_t jobs = 0;
+    bool force = false;
+};
+
+static std::string Quote(const std::string &s)
+{
+    return "\"" + s + "\"";
+}
+
+static uint64_t ComputeCookKey(const CookJob &job, const CookOptions &opt, uint64_t toolHash)
+{
+    Hasher hasher;
+    hasher.u64(COOK_CACHE_VERSION);
+    hasher.u64(toolHash);
+    hasher.u64(static_cast<uint64_t>(job.kind));
+    hasher.str(GenericPath(job.output.lexically_relative(opt.cookedDir)));
+    if (job.kind == SourceKind::Gltf)
+        for (const std::string &a : opt.gltfArgs)
+            hasher.str(a);
+
+    if (!HashFile(job.source, hasher))
+        return 0;
+
+    if (job.kind != SourceKind::Gltf)
+        return hasher.h;
+
+    // Same sidecar names GltfToSmodelTool checks: <stem>.clips.json / <file>.clips.json and
+    // the .impostor.json / .meshlets.json pairs.
+    std::vector<fs::path> deps;
+    for (const char *ext : {".clips.json", ".impostor.json", ".meshlets.json"})
+    {
+        fs::path sidecar = job.source;
+        sidecar.replace_extension(ext);
+        deps.push_back(sidecar);
+        deps.push_back(job.source.string() + ext);
+    }
+
+    std::vector<std::string> uris;
+    CollectUris(ReadGltfJson(job.source), uris);
+    for (const std::string &uri : uris)
+        deps.push_back(job.source.parent_path() / fs::u8path(uri));
+
+    // Missing files are part of the key too, so one appearing later re-cooks.
+    for (const fs::path &dep : deps)
+    {
+        hasher.str(GenericPath(dep.lexically_relative(job.source.parent_path())));
+        hasher.u64(HashFile(dep, hasher) ? 1u : 0u);
+    }
+    return hasher.h;
+}
+
+static std::string BuildCommand(const CookJob &job, const CookOptions &opt, const fs::path &logPath)
+{
+    std::string cmd;
+    if (job.kind == SourceKind::Gltf)
+    {
+        cmd = Quote(opt.gltfTool) + " " + Quote(job.source.string()) + " " + Quote(job.output.string());
+        for (const std::string &a : opt.gltfArgs)
+            cmd += " " + Quote(a);
+    }
+    else
+    {
+        // ObjToSMeshTool takes an output directory and names the file after the source.
+        cmd = Quote(opt.objTool) + " " + Quote(job.source.string()) + " " + Quote(job.output.parent_path().string());
+    }
+    cmd += " > " + Quote(logPath.string()) + " 2>&1";
+#ifdef _WIN32
+    // cmd.exe strips the outer quotes of a command line that starts with one.
+    cmd = "\"" + cmd + "\"";
+#endif
+    return cmd;
+}
+
+static void PrintLog(const fs::path &logPath)
+{
+    std::ifstream f(logPath);
+    if (f.is_open())
+        std::cerr << f.rdbuf();
+}
+
+// ------------------------------------------------------------
+// Manifest: one "<key>\t<source rel>" line per cooked source
+// ------------------------------------------------------------
+static std::unordered_map<std::string, uint64_t> LoadManifest(const fs::path &path)
+{
+    std::unordered_map<std::string, uint64_t> out;
+    std::ifstream f(path);
+    std::string line;
+    while (std::getline(f, line))
+    {
+        const size_t tab = line.find('\t');
+        if (tab == std::string::npos)
+            continue;
+        out[line.substr(tab + 1)] = std::strtoull(line.substr(0, tab).c_str(), nullptr, 16);
+    }
+    return out;
+}
+
+static bool SaveManifest(const fs::path &path, const std::vector<CookJob> &jobs)
+{
+    const fs::path tmp = path.string() + ".tmp";
+    {
+        std::ofstream f(tmp, std::ios::trunc);
+        if (!f.is_open())
+            return false;
+        f << "# AssetCook cache v" << COOK_CACHE_VERSION << "\n";
+        for (const CookJob &job : jobs)
+            if (job.ok && job.key != 0)
+                f << ToHex(job.key) << '\t' << job.sourceRel << '\n';
+        if (!f)
+            return false;
+    }
+    std::error_code ec;
+    fs::rename(tmp, path, ec);
+    return !ec;
+}
+
+// ------------------------------------------------------------
+// main
+// ------------------------------------------------------------
+static void PrintUsage()
+{
+    std::cout << "Usage: AssetCook <raw_dir> <cooked_dir> [--gltf-tool <exe>] [--obj-tool <exe>]\n"
+                 "                 [--gltf-arg <arg>]... [--jobs <n>] [--force]\n"
+                 "  Cooks .gltf/.glb with the glTF tool and .obj with the OBJ tool (a source kind whose\n"
+                 "  tool is not given is skipped), re-cooking only sources whose cook key changed.\n";
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    CookOptions opt;
+    opt.rawDir = fs::path(argv[1]).lexically_normal();
+    opt.cookedDir = fs::path(argv[2]).lexically_normal();
+    for (int i = 3; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--gltf-tool" && i + 1 < argc)
+            opt.gltfTool = argv[++i];
+        else if (arg == "--obj-tool" && i + 1 < argc)
+            opt.objTool = argv[++i];
+        else if (arg == "--gltf-arg" && i + 1 < argc)
+            opt.gltfArgs.push_back(argv[++i]);
+        else if (arg == "--jobs" && i + 1 < argc)
+            opt.jobs = static_cast<uint32_t>(std::max(0l, std::strtol(argv[++i], nullptr, 10)));
+        else if (arg == "--force")
+            opt.force = true;
+        else
+        {
+            std::cerr << "Unknown argument '" << arg << "'\n";
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    std::error_code ec;
+    if (!fs::is_directory(opt.rawDir, ec))
+    {
+        std::cerr << "Raw directory not found: " << opt.rawDir.string() << "\n";
+        return 4;
+    }
+    const fs::path logDir = opt.cookedDir / LOG_DIR_NAME;
+    fs::create_directories(logDir, ec);
+
+    // Tool executables are part of every key: a rebuilt tool may cook differently.
+    auto hashTool = [](const std::string &tool)
+    {
+        Hasher hasher;
+        if (!tool.empty() && !HashFile(tool, hasher))
+            std::cerr << "Warning: cannot read tool '" << tool << "', its cooks are never cached\n";
+        return hasher.h;
+    };
+    const uint64_t gltfToolHash = hashTool(opt.gltfTool);
+    const uint64_t objToolHash = hashTool(opt.objTool);
+
+    // Collect sources (sorted, so manifest and log order are stable).
+    std::vector<CookJob> jobs;
+    for (auto it = fs::recursive_directory_iterator(opt.rawDir, ec); !ec && it != fs::recursive_directory_iterator(); it.increment(ec))
+    {
+        if (!it->is_regular_file(ec))
+            continue;
+        const fs::path &p = it->path();
+        const std::string ext = p.extension().string();
+
+        CookJob job;
+        if ((ext == ".gltf" || ext == ".glb") && !opt.gltfTool.empty())
+            job.kind = SourceKind::Gltf;
+        else if (ext == ".obj" && !opt.objTool.empty())
+            job.kind = SourceKind::Obj;
+        else
+            continue;
+
+        const fs::path rel = p.lexically_relative(opt.rawDir);
+        job.source = p;
+        job.sourceRel = GenericPath(rel);
+        job.output = opt.cookedDir / rel;
+        job.output.replace_extension(job.kind == SourceKind::Gltf ? ".smodel" : ".smesh");
+        jobs.push_back(std::move(job));
+    }
+    std::sort(jobs.begin(), jobs.end(), [](const CookJob &a, const CookJob &b)
+              { return a.sourceRel < b.sourceRel; });
+
+    const fs::path manifestPath = opt.cookedDir / MANIFEST_NAME;
+    const std::unordered_map<std::string, uint64_t> manifest = LoadManifest(manifestPath);
+
+    // Keys hash every source and dependency, so they are computed on the workers as well.
+    const uint32_t hw = std::max(1u, std::thread::hardware_concurrency());
+    const uint32_t workerCount = std::max(1u, std::min<uint32_t>(opt.jobs ? opt.jobs : hw, static_cast<uint32_t>(jobs.size())));
+
+    std::atomic<size_t> next{0};
+    std::atomic<uint32_t> done{0};
+    std::mutex printMutex;
+    const auto start = std::chrono::steady_clock::now();
+
+    auto worker = [&]()
+    {
+        for (size_t i = next.fetch_add(1); i < jobs.size(); i = next.fetch_add(1))
+        {
+            CookJob &job = jobs[i];
+            job.key = ComputeCookKey(job, opt, job.kind == SourceKind::Gltf ? gltfToolHash : objToolHash);
+
+            const auto found = manifest.find(job.sourceRel);
+            const bool upToDate = !opt.force && job.key != 0 && found != manifest.end() && found->second == job.key &&
+                                  fs::exists(job.output);
+            if (upToDate)
+            {
+                done.fetch_add(1);
+                continue;
+            }
+
+            std::error_code dirEc;
+            fs::create_directories(job.output.parent_path(), dirEc);
+
+            std::string logName = job.sourceRel;
+            std::replace(logName.begin(), logName.end(), '/', '_');
+            const fs::path logPath = logDir / (logName + ".log");
+
+            const auto t0 = std::chrono::steady_clock::now();
+            const int rc = std::system(BuildCommand(job, opt, logPath).c_str());
+            job.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            job.cooked = true;
+            job.ok = (rc == 0) && fs::exists(job.output);
+
+            const uint32_t n = done.fetch_add(1) + 1;
+            std::lock_guard<std::mutex> lock(printMutex);
+            std::cout << "[" << n << "/" << jobs.size() << "] " << (job.ok ? "cooked " : "FAILED ") << job.sourceRel << " ("
+                      << static_cast<int>(job.seconds * 1000.0) << " ms)\n";
+            if (!job.ok)
+                PrintLog(logPath);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (uint32_t t = 1; t < workerCount; ++t)
+        threads.emplace_back(worker);
+    worker();
+    for (std::thread &t : threads)
+        t.join();
+
+    uint32_t cooked = 0;
+    uint32_t failed = 0;
+    for (const CookJob &job : jobs)
+    {
+        cooked += job.cooked ? 1u : 0u;
+        failed += job.ok ? 0u : 1u;
+    }
+
+    // Failed cooks stay out of the manifest, so they are retried next run.
+    if (!SaveManifest(manifestPath, jobs))
+        std::cerr << "Warning: could not write " << manifestPath.string() << "\n";
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "AssetCook: " << jobs.size() << " sources, " << (cooked - failed) << " cooked, " << failed << " failed, "
+              << (jobs.size() - cooked) << " up to date (" << workerCount << " workers, " << seconds << " s)\n";
+    return failed == 0 ? 0 : 3;
+}
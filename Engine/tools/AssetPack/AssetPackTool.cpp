@@ -0,0 +1,126 @@
+// ------------------------------------------------------------
+// AssetPackTool: packs a cooked asset directory into one .spak (see assets/AssetPack.h).
+//
+// Every file under <input_dir> is stored as <prefix>/<path relative to input_dir>, so with
+// --prefix assets a runtime load of "assets/Ground/scene.smodel" finds the packed copy.
+// Entries are stored uncompressed by default, so the runtime parses .smodel files in place from
+// the pack's mapping. --lz4 compresses every entry in independent 64 KB blocks (smaller packs,
+// one decode per load); entries that do not shrink, e.g. PNG/JPG, are kept raw either way.
+// ------------------------------------------------------------
+#include "assets/AssetPack.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static bool ReadWholeFile(const fs::path &path, std::vector<uint8_t> &out)
+{
+    std::ifstream f(path, std::ios::binary | std::ios::ate);
+    if (!f.is_open())
+        return false;
+
+    const std::streamsize size = f.tellg();
+    if (size < 0)
+        return false;
+
+    f.seekg(0, std::ios::beg);
+    out.resize(static_cast<size_t>(size));
+    return size == 0 || static_cast<bool>(f.read(reinterpret_cast<char *>(out.data()), size));
+}
+
+// Cook bookkeeping (AssetCookTool) is not runtime content.
+static bool IsCookMetadata(const fs::path &rel)
+{
+    for (const fs::path &part : rel)
+    {
+        const std::string s = part.string();
+        if (s == ".cook_manifest" || s == ".cooklogs")
+            return true;
+    }
+    return false;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        std::cout << "Usage: AssetPackTool <input_dir> <output.spak> [--prefix <path>] [--lz4]\n";
+        return 1;
+    }
+
+    const fs::path inputDir = fs::path(argv[1]).lexically_normal();
+    const std::string outputPath = argv[2];
+    std::string prefix;
+    bool compressAll = false;
+    for (int i = 3; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--prefix" && i + 1 < argc)
+            prefix = argv[++i];
+        else if (arg == "--lz4")
+            compressAll = true;
+        else
+            std::cout << "Ignoring unknown argument '" << arg << "'\n";
+    }
+
+    std::error_code ec;
+    if (!fs::is_directory(inputDir, ec))
+    {
+        std::cerr << "Input directory not found: " << inputDir.string() << "\n";
+        return 4;
+    }
+
+    // Sorted so the entry order (and with it the data layout) is reproducible.
+    std::vector<fs::path> files;
+    for (auto it = fs::recursive_directory_iterator(inputDir, ec); !ec && it != fs::recursive_directory_iterator(); it.increment(ec))
+    {
+        if (it->is_regular_file(ec) && !IsCookMetadata(it->path().lexically_relative(inputDir)))
+            files.push_back(it->path());
+    }
+    std::sort(files.begin(), files.end());
+
+    Engine::AssetPackWriter writer;
+    uint64_t rawBytes = 0;
+    for (const fs::path &file : files)
+    {
+        std::vector<uint8_t> bytes;
+        if (!ReadWholeFile(file, bytes))
+        {
+            std::cerr << "Failed to read " << file.string() << "\n";
+            return 2;
+        }
+
+        const fs::path rel = file.lexically_relative(inputDir);
+        const std::string packPath = prefix.empty() ? rel.generic_string() : (fs::path(prefix) / rel).generic_string();
+        rawBytes += bytes.size();
+        writer.add(packPath, std::move(bytes), compressAll);
+    }
+
+    std::string err;
+    if (!writer.write(outputPath, err))
+    {
+        std::cerr << err << "\n";
+        return 3;
+    }
+
+    Engine::AssetPack pack;
+    if (!pack.open(outputPath, err))
+    {
+        std::cerr << "Written pack does not open: " << err << "\n";
+        return 3;
+    }
+
+    uint32_t compressed = 0;
+    for (uint32_t i = 0; i < pack.entryCount(); ++i)
+        compressed += (pack.entry(i).flags & Engine::PACK_ENTRY_LZ4) ? 1u : 0u;
+
+    std::cout << "Packed " << pack.entryCount() << " files (" << compressed << " LZ4) into " << outputPath << ": "
+              << rawBytes << " bytes -> " << fs::file_size(outputPath, ec) << " bytes\n";
+    return 0;
+}
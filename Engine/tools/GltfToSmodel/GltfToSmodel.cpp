@@ -12,6 +12,8 @@
 #include <sstream>
 #include <filesystem>
 #include <cstring>
+#include <cstdlib>
+#include <cmath>
 #include <algorithm>
 #include <functional>
 #include <cctype>
@@ -20,6 +22,15 @@
 // Your engine format header (adjust include path if needed)
 #include "assets/ModelFormat.h"
 
+#include "TextureCompress.h"
+#include "MeshSimplify.h"
+#include "ImpostorBake.h"
+#include "assets/MeshOptimizer.h"
+
+// Decode source PNG/JPG once at cook time so the runtime never has to.
+#define STB_IMAGE_IMPLEMENTATION
+#include "ThirdParty/Stb/stb_image.h"
+
 #ifndef AI_MATKEY_GLTF_ALPHACUTOFF
 // Older Assimp doesn't expose this macro, but the property exists in glTF materials.
 // "$mat.gltf.alphaCutoff" is what Assimp stores internally.
@@ -247,6 +258,35 @@ static uint32_t ConvertWrapMode(aiTextureMapMode m)
 // ------------------------------------------------------------
 static uint32_t DefaultFilterLinear() { return 1; }
 static uint32_t DefaultMipNone() { return 0; }
+static uint32_t DefaultMipLinear() { return 2; }
+
+// ------------------------------------------------------------
+// Texture output format (--tex)
+// - bc7: decode + build mips + BC7-encode at cook time (default)
+// - png: embed the source PNG/JPG bytes; runtime decodes and builds mips
+// ------------------------------------------------------------
+enum class TextureOutput
+{
+    BC7,
+    Source
+};
+
+// Decode encoded bytes and BC7-compress them with a full mip chain.
+static bool CompressTextureBC7(const std::vector<uint8_t> &encoded, bool srgb, CompressedMipChain &out)
+{
+    int w = 0, h = 0, comp = 0;
+    unsigned char *pixels = stbi_load_from_memory(encoded.data(), static_cast<int>(encoded.size()), &w, &h, &comp, 4);
+    if (!pixels || w <= 0 || h <= 0 || w > 0xFFFF || h > 0xFFFF)
+    {
+        if (pixels)
+            stbi_image_free(pixels);
+        return false;
+    }
+
+    const bool ok = BuildBC7MipChain(pixels, static_cast<uint32_t>(w), static_cast<uint32_t>(h), srgb, out);
+    stbi_image_free(pixels);
+    return ok;
+}
 
 // ------------------------------------------------------------
 // Query which UV channel a texture uses.
@@ -303,7 +343,8 @@ static std::string ResolveTexturePath(const std::string &modelDir, const std::st
 
 // ------------------------------------------------------------
 // Texture loading (external vs embedded)
-// IMPORTANT: runtime uses stb_image to decode bytes -> store compressed bytes
+// Source bytes are either embedded as-is (--tex png, decoded by the runtime with stb_image)
+// or decoded here and BC7-compressed (default).
 // For embedded textures in glTF, Assimp usually stores compressed bytes (height==0)
 // ------------------------------------------------------------
 struct LoadedImageBytes
@@ -677,6 +718,504 @@ static void SampleQuatAt(const float *times, const float *values, uint32_t keyCo
     SlerpQuat(q0, q1, a, out);
 }
 
+// ------------------------------------------------------------
+// Quantized animation clips (--quantize-anim)
+// ------------------------------------------------------------
+// Resamples every channel of every clip at sampleRate and encodes it as one track (see
+// SModelQuantizedAnimation.h). Tracks that never move become Constant and cost no frame words.
+static void QuantizeAnimationClips(uint32_t nodeCount,
+                                   const std::vector<sm::SModelAnimationClipRecord> &animClips,
+                                   const std::vector<sm::SModelAnimationChannelRecord> &animChannels,
+                                   const std::vector<sm::SModelAnimationSamplerRecord> &animSamplers,
+                                   const std::vector<float> &animTimes,
+                                   const std::vector<float> &animValues,
+                                   float sampleRate,
+                                   std::vector<sm::SModelQuantizedClipRecord> &outClips,
+                                   std::vector<sm::SModelQuantizedTrackRecord> &outTracks,
+                                   std::vector<uint16_t> &outData)
+{
+    outClips.clear();
+    outTracks.clear();
+    outData.clear();
+
+    std::vector<float> samples; // frameCount * 4 per track being built
+    std::vector<std::vector<float>> trackSamples;
+
+    for (const auto &clip : animClips)
+    {
+        const float duration = std::max(clip.durationSec, 0.0f);
+        const uint32_t frameCount = static_cast<uint32_t>(std::ceil(duration * sampleRate)) + 1u;
+
+        sm::SModelQuantizedClipRecord qc{};
+        qc.firstTrack = static_cast<uint32_t>(outTracks.size());
+        qc.frameCount = frameCount;
+        qc.durationSec = duration;
+        qc.dataOffset = static_cast<uint32_t>(outData.size());
+
+        trackSamples.clear();
+        for (uint32_t ci = 0; ci < clip.channelCount; ++ci)
+        {
+            const uint32_t chIdx = clip.firstChannel + ci;
+            if (chIdx >= animChannels.size())
+                break;
+            const auto &ch = animChannels[chIdx];
+            if (ch.samplerIndex >= animSamplers.size() || ch.targetNode >= nodeCount || ch.targetNode > 0xFFFFu)
+                continue;
+            if (ch.path > (uint16_t)sm::SModelAnimPath::Scale)
+                continue;
+            const auto &smp = animSamplers[ch.samplerIndex];
+            if (smp.timeCount == 0 || smp.firstTime + smp.timeCount > animTimes.size())
+                continue;
+            if (smp.firstValue + smp.valueCount > animValues.size())
+                continue;
+
+            const float *times = animTimes.data() + smp.firstTime;
+            const float *values = animValues.data() + smp.firstValue;
+            const bool rotation = (ch.path == (uint16_t)sm::SModelAnimPath::Rotation);
+
+            samples.assign(size_t(frameCount) * 4u, 0.0f);
+            for (uint32_t f = 0; f < frameCount; ++f)
+            {
+                const float t = std::min(static_cast<float>(f) / sampleRate, duration);
+                float *out = samples.data() + size_t(f) * 4u;
+                if (rotation)
+                    SampleQuatAt(times, values, smp.timeCount, t, out);
+                else
+                    SampleVec3At(times, values, smp.timeCount, t, out);
+            }
+
+            sm::SModelQuantizedTrackRecord tr{};
+            tr.targetNode = static_cast<uint16_t>(ch.targetNode);
+            tr.path = ch.path;
+
+            bool constant = true;
+            if (rotation)
+            {
+                for (uint32_t f = 1; f < frameCount && constant; ++f)
+                    constant = std::fabs(DotQuat(samples.data(), samples.data() + size_t(f) * 4u)) > 1.0f - 1e-7f;
+                if (constant)
+                {
+                    tr.rangeMin[0] = samples[0];
+                    tr.rangeMin[1] = samples[1];
+                    tr.rangeMin[2] = samples[2];
+                    tr.rangeExtent[0] = samples[3];
+                }
+            }
+            else
+            {
+                for (int c = 0; c < 3; ++c)
+                {
+                    float lo = samples[c];
+                    float hi = samples[c];
+                    for (uint32_t f = 1; f < frameCount; ++f)
+                    {
+                        lo = std::min(lo, samples[size_t(f) * 4u + c]);
+                        hi = std::max(hi, samples[size_t(f) * 4u + c]);
+                    }
+                    tr.rangeMin[c] = lo;
+                    tr.rangeExtent[c] = hi - lo;
+                    if (hi - lo > 1e-6f)
+                        constant = false;
+                }
+                if (constant)
+                    for (int c = 0; c < 3; ++c)
+                        tr.rangeExtent[c] = 0.0f;
+            }
+
+            if (constant)
+            {
+                tr.encoding = (uint16_t)sm::QuantizedTrackEncoding::Constant;
+            }
+            else
+            {
+                tr.encoding = rotation ? (uint16_t)sm::QuantizedTrackEncoding::QuatSmallest3
+                                       : (uint16_t)sm::QuantizedTrackEncoding::Vec3Range16;
+                tr.wordOffset = static_cast<uint16_t>(qc.frameWords);
+                qc.frameWords += 3u;
+                trackSamples.push_back(samples);
+            }
+            outTracks.push_back(tr);
+        }
+        qc.trackCount = static_cast<uint32_t>(outTracks.size()) - qc.firstTrack;
+
+        // Interleave: all animated tracks of frame 0, then frame 1, ...
+        outData.resize(outData.size() + size_t(frameCount) * qc.frameWords);
+        uint32_t animated = 0;
+        for (uint32_t k = 0; k < qc.trackCount; ++k)
+        {
+            const auto &tr = outTracks[qc.firstTrack + k];
+            if (tr.encoding == (uint16_t)sm::QuantizedTrackEncoding::Constant)
+                continue;
+            const std::vector<float> &src = trackSamples[animated++];
+            for (uint32_t f = 0; f < frameCount; ++f)
+            {
+                uint16_t *dst = outData.data() + qc.dataOffset + size_t(f) * qc.frameWords + tr.wordOffset;
+                const float *v = src.data() + size_t(f) * 4u;
+                if (tr.encoding == (uint16_t)sm::QuantizedTrackEncoding::QuatSmallest3)
+                {
+                    sm::EncodeQuatSmallest3(v, dst);
+                }
+                else
+                {
+                    for (int c = 0; c < 3; ++c)
+                        dst[c] = sm::EncodeRange16(v[c], tr.rangeMin[c], tr.rangeExtent[c]);
+                }
+            }
+        }
+
+        outClips.push_back(qc);
+    }
+}
+
+// ------------------------------------------------------------
+// Mesh LOD chains (--lods)
+// ------------------------------------------------------------
+// Projected size (bounding radius / half viewport height) below which level 1 is drawn;
+// each further level halves it.
+static constexpr float LOD_SCREEN_SIZE_LEVEL1 = 0.25f;
+// Simplification error bound per level, relative to the mesh's AABB diagonal (scaled by level).
+static constexpr float LOD_MAX_ERROR = 0.02f;
+// Meshes this small keep their full index list.
+static constexpr uint32_t LOD_MIN_TRIANGLES = 32;
+
+// ------------------------------------------------------------
+// Meshlets (--meshlets)
+// ------------------------------------------------------------
+// Skinned meshlets are culled with their bind-pose bounds carried by one joint: the one
+// with the most total weight over the meshlet's vertices (skin-local index).
+static int32_t MeshletAnchorJoint(const std::vector<VertexPNTTJW> &vertices, const uint32_t *meshletVertices, uint32_t count)
+{
+    std::unordered_map<uint16_t, float> weightByJoint;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const VertexPNTTJW &v = vertices[meshletVertices[i]];
+        for (int k = 0; k < 4; ++k)
+        {
+            if (v.weights[k] > 0.0f)
+                weightByJoint[v.joints[k]] += v.weights[k];
+        }
+    }
+
+    int32_t best = -1;
+    float bestWeight = 0.0f;
+    for (const auto &[joint, weight] : weightByJoint)
+    {
+        if (weight > bestWeight || (weight == bestWeight && joint < best))
+        {
+            best = joint;
+            bestWeight = weight;
+        }
+    }
+    return best < 0 ? 0 : best;
+}
+
+// ------------------------------------------------------------
+// Octahedral impostors (--impostor)
+// ------------------------------------------------------------
+// Frame edge cap: 32 frames of 512 px keep the atlas inside the 16-bit texture record size.
+static constexpr long IMPOSTOR_MAX_FRAME_RESOLUTION = 512;
+
+// Decoded base color of a material texture, kept for the impostor capture.
+struct ImpostorSourceTexture
+{
+    std::vector<uint8_t> rgba;
+    uint32_t width = 0;
+    uint32_t height = 0;
+};
+
+// Model-space point / direction through a column-major node global.
+static void TransformPoint(const float m[16], const float *p, float *out)
+{
+    for (int r = 0; r < 3; ++r)
+        out[r] = m[0 + r] * p[0] + m[4 + r] * p[1] + m[8 + r] * p[2] + m[12 + r];
+}
+
+static void TransformDirection(const float m[16], const float *d, float *out)
+{
+    for (int r = 0; r < 3; ++r)
+        out[r] = m[0 + r] * d[0] + m[4 + r] * d[1] + m[8 + r] * d[2];
+    const float len = std::sqrt(out[0] * out[0] + out[1] * out[1] + out[2] * out[2]);
+    if (len > 1e-8f)
+    {
+        out[0] /= len;
+        out[1] /= len;
+        out[2] /= len;
+    }
+}
+
+// ------------------------------------------------------------
+// Baked animation palettes (--bake-anim)
+// Column-major 4x4 helpers matching the runtime (glm) conventions.
+// ------------------------------------------------------------
+static void MulMat4(const float a[16], const float b[16], float out[16])
+{
+    float r[16];
+    for (int c = 0; c < 4; ++c)
+    {
+        for (int row = 0; row < 4; ++row)
+        {
+            r[c * 4 + row] = a[0 * 4 + row] * b[c * 4 + 0] +
+                             a[1 * 4 + row] * b[c * 4 + 1] +
+                             a[2 * 4 + row] * b[c * 4 + 2] +
+                             a[3 * 4 + row] * b[c * 4 + 3];
+        }
+    }
+    std::memcpy(out, r, sizeof(r));
+}
+
+static void IdentityMat4(float out[16])
+{
+    std::memset(out, 0, sizeof(float) * 16);
+    out[0] = out[5] = out[10] = out[15] = 1.0f;
+}
+
+// T * R * S, quaternion xyzw
+static void ComposeTRS(const float t[3], const float qin[4], const float s[3], float out[16])
+{
+    float q[4] = {qin[0], qin[1], qin[2], qin[3]};
+    NormalizeQuat(q);
+    const float x = q[0], y = q[1], z = q[2], w = q[3];
+
+    out[0] = (1.0f - 2.0f * (y * y + z * z)) * s[0];
+    out[1] = (2.0f * (x * y + w * z)) * s[0];
+    out[2] = (2.0f * (x * z - w * y)) * s[0];
+    out[3] = 0.0f;
+
+    out[4] = (2.0f * (x * y - w * z)) * s[1];
+    out[5] = (1.0f - 2.0f * (x * x + z * z)) * s[1];
+    out[6] = (2.0f * (y * z + w * x)) * s[1];
+    out[7] = 0.0f;
+
+    out[8] = (2.0f * (x * z + w * y)) * s[2];
+    out[9] = (2.0f * (y * z - w * x)) * s[2];
+    out[10] = (1.0f - 2.0f * (x * x + y * y)) * s[2];
+    out[11] = 0.0f;
+
+    out[12] = t[0];
+    out[13] = t[1];
+    out[14] = t[2];
+    out[15] = 1.0f;
+}
+
+// Rest TRS from a column-major local matrix (no shear), like the runtime's DecomposeTRS.
+static void DecomposeTRS(const float m[16], float t[3], float q[4], float s[3])
+{
+    t[0] = m[12];
+    t[1] = m[13];
+    t[2] = m[14];
+
+    for (int c = 0; c < 3; ++c)
+        s[c] = std::sqrt(m[c * 4 + 0] * m[c * 4 + 0] + m[c * 4 + 1] * m[c * 4 + 1] + m[c * 4 + 2] * m[c * 4 + 2]);
+
+    // Mirrored bases: fold the sign into one axis so the rotation stays proper.
+    const float det = m[0] * (m[5] * m[10] - m[9] * m[6]) -
+                      m[4] * (m[1] * m[10] - m[9] * m[2]) +
+                      m[8] * (m[1] * m[6] - m[5] * m[2]);
+    if (det < 0.0f)
+        s[0] = -s[0];
+
+    float r[9]; // r[col * 3 + row]
+    for (int c = 0; c < 3; ++c)
+    {
+        const float inv = (std::fabs(s[c]) > 1e-8f) ? 1.0f / s[c] : 0.0f;
+        for (int row = 0; row < 3; ++row)
+            r[c * 3 + row] = m[c * 4 + row] * inv;
+    }
+
+    const float trace = r[0] + r[4] + r[8];
+    if (trace > 0.0f)
+    {
+        const float k = 0.5f / std::sqrt(trace + 1.0f);
+        q[3] = 0.25f / k;
+        q[0] = (r[5] - r[7]) * k;
+        q[1] = (r[6] - r[2]) * k;
+        q[2] = (r[1] - r[3]) * k;
+    }
+    else if (r[0] > r[4] && r[0] > r[8])
+    {
+        const float k = 2.0f * std::sqrt(1.0f + r[0] - r[4] - r[8]);
+        q[3] = (r[5] - r[7]) / k;
+        q[0] = 0.25f * k;
+        q[1] = (r[3] + r[1]) / k;
+        q[2] = (r[6] + r[2]) / k;
+    }
+    else if (r[4] > r[8])
+    {
+        const float k = 2.0f * std::sqrt(1.0f + r[4] - r[0] - r[8]);
+        q[3] = (r[6] - r[2]) / k;
+        q[0] = (r[3] + r[1]) / k;
+        q[1] = 0.25f * k;
+        q[2] = (r[7] + r[5]) / k;
+    }
+    else
+    {
+        const float k = 2.0f * std::sqrt(1.0f + r[8] - r[0] - r[4]);
+        q[3] = (r[1] - r[3]) / k;
+        q[0] = (r[6] + r[2]) / k;
+        q[1] = (r[7] + r[5]) / k;
+        q[2] = 0.25f * k;
+    }
+    NormalizeQuat(q);
+}
+
+static void AppendTopRows(const float m[16], std::vector<float> &out)
+{
+    for (int row = 0; row < 3; ++row)
+        for (int c = 0; c < 4; ++c)
+            out.push_back(m[c * 4 + row]);
+}
+
+// Sample every clip at a fixed rate into node globals + joint palettes (layout in
+// SModelBakedAnimation.h). Evaluation mirrors ModelAsset::evaluatePoseInto: rest TRS,
+// channel overrides, then a walk from the roots; nodes never reached stay identity.
+static void BakeAnimationPalettes(const std::vector<sm::SModelNodeRecord> &nodeRecords,
+                                  const std::vector<uint32_t> &nodeChildIndices,
+                                  const std::vector<sm::SModelSkinRecord> &skinRecords,
+                                  const std::vector<uint32_t> &skinJointNodeIndices,
+                                  const std::vector<float> &skinInverseBindMatrices,
+                                  const std::vector<sm::SModelAnimationClipRecord> &animClips,
+                                  const std::vector<sm::SModelAnimationChannelRecord> &animChannels,
+                                  const std::vector<sm::SModelAnimationSamplerRecord> &animSamplers,
+                                  const std::vector<float> &animTimes,
+                                  const std::vector<float> &animValues,
+                                  float sampleRate,
+                                  std::vector<sm::SModelBakedClipRecord> &outClips,
+                                  std::vector<float> &outData,
+                                  uint32_t &outJointCount)
+{
+    const uint32_t nodeCount = static_cast<uint32_t>(nodeRecords.size());
+    const uint32_t U32_MAX = ~0u;
+
+    outClips.clear();
+    outData.clear();
+    outJointCount = 0;
+    for (const auto &sr : skinRecords)
+        outJointCount += sr.jointCount;
+
+    struct TRS
+    {
+        float t[3];
+        float r[4];
+        float s[3];
+    };
+    std::vector<TRS> rest(nodeCount);
+    for (uint32_t i = 0; i < nodeCount; ++i)
+        DecomposeTRS(nodeRecords[i].localMatrix, rest[i].t, rest[i].r, rest[i].s);
+
+    std::vector<TRS> trs(nodeCount);
+    std::vector<float> globals(size_t(nodeCount) * 16u);
+    std::vector<uint8_t> visited(nodeCount);
+    std::vector<std::pair<uint32_t, uint32_t>> stack; // (node, parent or U32_MAX)
+
+    uint32_t frameCursor = 0;
+    for (const auto &clip : animClips)
+    {
+        const float duration = std::max(clip.durationSec, 0.0f);
+        const uint32_t frameCount = static_cast<uint32_t>(std::ceil(duration * sampleRate)) + 1u;
+
+        sm::SModelBakedClipRecord bc{};
+        bc.firstFrame = frameCursor;
+        bc.frameCount = frameCount;
+        bc.durationSec = duration;
+        outClips.push_back(bc);
+        frameCursor += frameCount;
+
+        for (uint32_t f = 0; f < frameCount; ++f)
+        {
+            const float t = std::min(static_cast<float>(f) / sampleRate, duration);
+            trs = rest;
+
+            for (uint32_t ci = 0; ci < clip.channelCount; ++ci)
+            {
+                const uint32_t chIdx = clip.firstChannel + ci;
+                if (chIdx >= animChannels.size())
+                    break;
+                const auto &ch = animChannels[chIdx];
+                if (ch.samplerIndex >= animSamplers.size() || ch.targetNode >= nodeCount)
+                    continue;
+                const auto &smp = animSamplers[ch.samplerIndex];
+                if (smp.timeCount == 0 || smp.firstTime + smp.timeCount > animTimes.size())
+                    continue;
+                if (smp.firstValue + smp.valueCount > animValues.size())
+                    continue;
+
+                const float *times = animTimes.data() + smp.firstTime;
+                const float *values = animValues.data() + smp.firstValue;
+                if (ch.path == (uint16_t)sm::SModelAnimPath::Translation)
+                    SampleVec3At(times, values, smp.timeCount, t, trs[ch.targetNode].t);
+                else if (ch.path == (uint16_t)sm::SModelAnimPath::Rotation)
+                    SampleQuatAt(times, values, smp.timeCount, t, trs[ch.targetNode].r);
+                else if (ch.path == (uint16_t)sm::SModelAnimPath::Scale)
+                    SampleVec3At(times, values, smp.timeCount, t, trs[ch.targetNode].s);
+            }
+
+            for (uint32_t i = 0; i < nodeCount; ++i)
+                IdentityMat4(&globals[size_t(i) * 16u]);
+            std::fill(visited.begin(), visited.end(), uint8_t(0));
+
+            for (uint32_t root = 0; root < nodeCount; ++root)
+            {
+                if (nodeRecords[root].parentIndex != U32_MAX)
+                    continue;
+
+                stack.clear();
+                stack.push_back({root, U32_MAX});
+                while (!stack.empty())
+                {
+                    const auto [node, parent] = stack.back();
+                    stack.pop_back();
+                    if (visited[node])
+                        continue;
+                    visited[node] = 1;
+
+                    float local[16];
+                    ComposeTRS(trs[node].t, trs[node].r, trs[node].s, local);
+                    float *g = &globals[size_t(node) * 16u];
+                    if (parent == U32_MAX)
+                        std::memcpy(g, local, sizeof(local));
+                    else
+                        MulMat4(&globals[size_t(parent) * 16u], local, g);
+
+                    const auto &n = nodeRecords[node];
+                    if (n.childCount == 0 || n.firstChildIndex == U32_MAX)
+                        continue;
+                    for (uint32_t c = n.childCount; c-- > 0;)
+                    {
+                        const uint32_t childSlot = n.firstChildIndex + c;
+                        if (childSlot >= nodeChildIndices.size())
+                            continue;
+                        const uint32_t child = nodeChildIndices[childSlot];
+                        if (child < nodeCount)
+                            stack.push_back({child, node});
+                    }
+                }
+            }
+
+            for (uint32_t i = 0; i < nodeCount; ++i)
+                AppendTopRows(&globals[size_t(i) * 16u], outData);
+
+            for (const auto &sr : skinRecords)
+            {
+                for (uint32_t j = 0; j < sr.jointCount; ++j)
+                {
+                    float m[16];
+                    IdentityMat4(m);
+
+                    const size_t jointSlot = size_t(sr.firstJointNodeIndex) + j;
+                    const size_t ibmBase = size_t(sr.firstInverseBindMatrix) + size_t(j) * 16u;
+                    if (jointSlot < skinJointNodeIndices.size() && ibmBase + 16u <= skinInverseBindMatrices.size())
+                    {
+                        const uint32_t jointNode = skinJointNodeIndices[jointSlot];
+                        if (jointNode < nodeCount)
+                            MulMat4(&globals[size_t(jointNode) * 16u], &skinInverseBindMatrices[ibmBase], m);
+                    }
+                    AppendTopRows(m, outData);
+                }
+            }
+        }
+    }
+}
+
 // ------------------------------------------------------------
 // Main
 // ------------------------------------------------------------
@@ -684,7 +1223,7 @@ int main(int argc, char **argv)
 {
     if (argc < 3)
     {
-        std::cout << "Usage: GltfToSModel <input.gltf/.glb> <output.smodel>\n";
+        std::cout << "Usage: GltfToSModel <input.gltf/.glb> <output.smodel> [--tex bc7|png] [--bake-anim <fps>] [--lods <levels>] [--quantize-anim <fps>] [--impostor <frames>] [--impostor-res <px>] [--impostor-full] [--meshlets] [--no-optimize]\n";
         return 0;
     }
 
@@ -692,9 +1231,129 @@ int main(int argc, char **argv)
     const std::string outputPath = NormalizePathSlashes(argv[2]);
     const std::string modelDir = GetDirectoryOfFile(inputPath);
 
+    TextureOutput textureOutput = TextureOutput::BC7;
+    float bakeSampleRate = 0.0f; // --bake-anim: 0 = off
+    uint32_t lodLevels = 0;      // --lods: simplified levels per mesh, 0 = off
+    float quantizeSampleRate = 0.0f; // --quantize-anim: 0 = keep raw keyframes
+    ImpostorSettings impostorSettings{};
+    uint32_t impostorFrames = 0; // --impostor: frames per atlas side, 0 = off
+    bool buildMeshlets = false;  // --meshlets
+    bool optimizeMeshes = true;  // --no-optimize: keep source order (meshlets still need the pass)
+    for (int i = 3; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--tex" && i + 1 < argc)
+        {
+            const std::string v = argv[++i];
+            if (v == "png")
+                textureOutput = TextureOutput::Source;
+            else if (v == "bc7")
+                textureOutput = TextureOutput::BC7;
+            else
+                std::cout << "Unknown --tex value '" << v << "', using bc7\n";
+        }
+        else if (arg == "--bake-anim" && i + 1 < argc)
+        {
+            bakeSampleRate = std::strtof(argv[++i], nullptr);
+            if (!(bakeSampleRate > 0.0f))
+            {
+                std::cout << "Invalid --bake-anim rate, baking disabled\n";
+                bakeSampleRate = 0.0f;
+            }
+        }
+        else if (arg == "--quantize-anim" && i + 1 < argc)
+        {
+            quantizeSampleRate = std::strtof(argv[++i], nullptr);
+            if (!(quantizeSampleRate > 0.0f))
+            {
+                std::cout << "Invalid --quantize-anim rate, keeping raw keyframes\n";
+                quantizeSampleRate = 0.0f;
+            }
+        }
+        else if (arg == "--lods" && i + 1 < argc)
+        {
+            const long v = std::strtol(argv[++i], nullptr, 10);
+            lodLevels = static_cast<uint32_t>(std::clamp<long>(v, 0, sm::SMODEL_MAX_MESH_LODS));
+        }
+        else if (arg == "--impostor" && i + 1 < argc)
+        {
+            const long v = std::strtol(argv[++i], nullptr, 10);
+            impostorFrames = v > 0 ? static_cast<uint32_t>(std::clamp<long>(v, 2, sm::SMODEL_MAX_IMPOSTOR_FRAMES)) : 0u;
+        }
+        else if (arg == "--impostor-res" && i + 1 < argc)
+        {
+            const long v = std::strtol(argv[++i], nullptr, 10);
+            impostorSettings.frameResolution = static_cast<uint32_t>(std::clamp<long>(v, 16, IMPOSTOR_MAX_FRAME_RESOLUTION));
+        }
+        else if (arg == "--impostor-full")
+        {
+            impostorSettings.hemisphere = false;
+        }
+        else if (arg == "--meshlets")
+        {
+            buildMeshlets = true;
+        }
+        else if (arg == "--no-optimize")
+        {
+            optimizeMeshes = false;
+        }
+    }
+
+    // Impostor settings sidecar next to the input, for assets cooked without per-asset flags
+    // (AssetCook): scene.impostor.json with contents like
+    //   { "frames": 8, "resolution": 128, "hemisphere": true }
+    // An --impostor flag takes precedence.
+    if (impostorFrames == 0)
+    {
+        std::string text;
+        std::string path = ReplaceExtension(inputPath, ".impostor.json");
+        if (!ReadTextFile(path, text))
+        {
+            path = inputPath + ".impostor.json";
+            if (!ReadTextFile(path, text))
+                path.clear();
+        }
+        if (!path.empty())
+        {
+            std::smatch m;
+            impostorFrames = 8;
+            if (std::regex_search(text, m, std::regex(R"re("frames"\s*:\s*(\d+))re")))
+                impostorFrames = static_cast<uint32_t>(std::clamp<unsigned long>(std::stoul(m[1].str()), 2, sm::SMODEL_MAX_IMPOSTOR_FRAMES));
+            if (std::regex_search(text, m, std::regex(R"re("resolution"\s*:\s*(\d+))re")))
+                impostorSettings.frameResolution = static_cast<uint32_t>(std::clamp<unsigned long>(std::stoul(m[1].str()), 16, IMPOSTOR_MAX_FRAME_RESOLUTION));
+            if (std::regex_search(text, m, std::regex(R"re("hemisphere"\s*:\s*(true|false))re")))
+                impostorSettings.hemisphere = m[1].str() == "true";
+            std::cout << "Using impostor sidecar: " << path << "\n";
+        }
+    }
+    impostorSettings.framesPerSide = impostorFrames;
+
+    // Meshlet sidecar, same lookup: scene.meshlets.json ({} or { "enabled": true }) marks the
+    // high-poly assets worth clustering without a per-asset --meshlets.
+    if (!buildMeshlets)
+    {
+        std::string text;
+        std::string path = ReplaceExtension(inputPath, ".meshlets.json");
+        if (!ReadTextFile(path, text))
+        {
+            path = inputPath + ".meshlets.json";
+            if (!ReadTextFile(path, text))
+                path.clear();
+        }
+        if (!path.empty())
+        {
+            buildMeshlets = !std::regex_search(text, std::regex(R"re("enabled"\s*:\s*false)re"));
+            std::cout << "Using meshlet sidecar: " << path << "\n";
+        }
+    }
+    // Meshlets are cut from the cache-ordered list.
+    optimizeMeshes = optimizeMeshes || buildMeshlets;
+    bool anyBlockCompressed = false;
+
     std::cout << "Input  : " << inputPath << "\n";
     std::cout << "Output : " << outputPath << "\n";
     std::cout << "ModelDir: " << modelDir << "\n";
+    std::cout << "Textures: " << (textureOutput == TextureOutput::BC7 ? "bc7" : "png") << "\n";
 
     // ------------------------------------------------------------
     // Assimp importer options:
@@ -730,6 +1389,10 @@ int main(int argc, char **argv)
     Blob blob;
 
     std::vector<sm::SModelMeshRecord> meshRecords;
+    std::vector<sm::SModelMeshLodRecord> lodRecords;
+    std::vector<sm::SModelMeshletRecord> meshletRecords;
+    std::vector<uint32_t> meshletVertexData;  // --meshlets: concatenated per mesh
+    std::vector<uint8_t> meshletTriangleData;
     std::vector<sm::SModelPrimitiveRecord> primRecords;
     std::vector<sm::SModelMaterialRecord> materialRecords;
     std::vector<sm::SModelTextureRecord> textureRecords;
@@ -762,6 +1425,8 @@ int main(int argc, char **argv)
     // key = resolved path or "*0"
     // ------------------------------------------------------------
     std::unordered_map<std::string, int32_t> textureKeyToIndex;
+    // --impostor: decoded base color textures by texture index
+    std::unordered_map<int32_t, ImpostorSourceTexture> impostorTextures;
 
     // Create & store a new texture record (or return existing index)
     auto AcquireTextureIndex = [&](const std::string &assimpTexPath,
@@ -809,14 +1474,54 @@ int main(int argc, char **argv)
         tr.mipFilter = DefaultMipNone();
         tr.maxAnisotropy = 1.0f;
 
-        // Blob store (compressed)
-        blob.align(8);
-        tr.imageDataOffset = blob.append(img.bytes.data(), img.bytes.size());
-        tr.imageDataSize = static_cast<uint32_t>(img.bytes.size());
+        CompressedMipChain bc7;
+        if (textureOutput == TextureOutput::BC7)
+        {
+            if (CompressTextureBC7(img.bytes, isSRGB, bc7))
+            {
+                tr.encoding = static_cast<uint32_t>(sm::ImageEncoding::BC7);
+                tr.width = static_cast<uint16_t>(bc7.width);
+                tr.height = static_cast<uint16_t>(bc7.height);
+                tr.mipLevels = bc7.mipLevels;
+                tr.mipFilter = DefaultMipLinear(); // real mips are stored
+                anyBlockCompressed = true;
+            }
+            else
+            {
+                std::cout << "WARNING: BC7 compression failed, embedding source bytes: " << img.debugURI << "\n";
+            }
+        }
+
+        // Blob store (block data needs 16-byte alignment for the staging copy)
+        if (tr.encoding == static_cast<uint32_t>(sm::ImageEncoding::BC7))
+        {
+            blob.align(16);
+            tr.imageDataOffset = blob.append(bc7.bytes.data(), bc7.bytes.size());
+            tr.imageDataSize = static_cast<uint64_t>(bc7.bytes.size());
+        }
+        else
+        {
+            blob.align(8);
+            tr.imageDataOffset = blob.append(img.bytes.data(), img.bytes.size());
+            tr.imageDataSize = static_cast<uint32_t>(img.bytes.size());
+        }
 
         const int32_t newIndex = static_cast<int32_t>(textureRecords.size());
         textureRecords.push_back(tr);
         textureKeyToIndex[key] = newIndex;
+
+        if (impostorFrames > 0 && (type == aiTextureType_BASE_COLOR || type == aiTextureType_DIFFUSE))
+        {
+            int w = 0, h = 0, comp = 0;
+            if (unsigned char *pixels = stbi_load_from_memory(img.bytes.data(), static_cast<int>(img.bytes.size()), &w, &h, &comp, 4))
+            {
+                ImpostorSourceTexture &src = impostorTextures[newIndex];
+                src.width = static_cast<uint32_t>(w);
+                src.height = static_cast<uint32_t>(h);
+                src.rgba.assign(pixels, pixels + size_t(w) * size_t(h) * 4u);
+                stbi_image_free(pixels);
+            }
+        }
         return newIndex;
     };
 
@@ -1005,6 +1710,14 @@ int main(int argc, char **argv)
     primRecords.reserve(scene->mNumMeshes);
 
     std::vector<int32_t> meshIndexToPrimIndex(scene->mNumMeshes, -1);
+    std::vector<ImpostorMesh> impostorMeshes;
+
+    // Merged streams: every mesh's packed vertices back to back, then every index list (base,
+    // then its LOD levels, mesh by mesh), in the layout MeshAsset::uploadMergedDeferred gives the
+    // model's shared VB/IB, so the runtime uploads each with one copy. Offsets below are into
+    // these arrays and get rebased onto the blob after the loop.
+    std::vector<sm::SModelPackedVertex> mergedVertices;
+    std::vector<uint32_t> mergedIndices;
 
     for (uint32_t meshIdx = 0; meshIdx < scene->mNumMeshes; ++meshIdx)
     {
@@ -1175,6 +1888,47 @@ int main(int argc, char **argv)
             indices.push_back(face.mIndices[2]);
         }
 
+        // Mesh LOD chain (--lods): each level halves the triangles of the full mesh's count
+        // and is meant for half the projected size of the one before. Stops once the
+        // simplifier can't make meaningful progress within its error bound.
+        // lists[0] is the full mesh, lists[level] the simplified levels.
+        std::vector<std::vector<uint32_t>> lists(1);
+        lists[0] = std::move(indices);
+        const uint32_t fullIndexCount = static_cast<uint32_t>(lists[0].size());
+        uint32_t prevLodIndexCount = fullIndexCount;
+        for (uint32_t level = 1; level <= lodLevels; ++level)
+        {
+            const float ratio = std::ldexp(1.0f, -static_cast<int>(level));
+            const uint32_t target = static_cast<uint32_t>(float(fullIndexCount) * ratio) / 3u * 3u;
+            if (target < 3u * LOD_MIN_TRIANGLES)
+                break;
+
+            std::vector<uint32_t> lodIndices;
+            SimplifyMesh(vertices[0].pos, sizeof(VertexPNTTJW), static_cast<uint32_t>(vertices.size()),
+                         lists[0].data(), fullIndexCount, target, LOD_MAX_ERROR * float(level), lodIndices);
+            if (lodIndices.empty() || float(lodIndices.size()) > float(prevLodIndexCount) * 0.9f)
+                break;
+
+            prevLodIndexCount = static_cast<uint32_t>(lodIndices.size());
+            lists.push_back(std::move(lodIndices));
+        }
+
+        // Vertex cache / overdraw / fetch order, on every level: cooked here so loading does
+        // no mesh work. Meshlets (--meshlets) are cut from the ordered full list.
+        if (optimizeMeshes)
+            Engine::OptimizeMesh(reinterpret_cast<uint8_t *>(vertices.data()), vertices.size(), sizeof(VertexPNTTJW),
+                                 lists.data(), lists.size());
+        std::vector<Engine::Meshlet> meshlets;
+        std::vector<uint32_t> meshletVertices;
+        std::vector<uint8_t> meshletTriangles;
+        if (buildMeshlets)
+        {
+            Engine::BuildMeshlets(lists[0].data(), lists[0].size(), vertices.size(),
+                                  sm::SMODEL_MAX_MESHLET_VERTICES, sm::SMODEL_MAX_MESHLET_TRIANGLES,
+                                  meshlets, meshletVertices, meshletTriangles);
+        }
+        const std::vector<uint32_t> &fullIndices = lists[0];
+
         // Fill mesh record
         sm::SModelMeshRecord mr{};
         {
@@ -1183,12 +1937,12 @@ int main(int argc, char **argv)
         }
 
         mr.vertexCount = static_cast<uint32_t>(vertices.size());
-        mr.indexCount = static_cast<uint32_t>(indices.size());
-        mr.vertexStride = static_cast<uint32_t>(sizeof(VertexPNTTJW));
+        mr.indexCount = static_cast<uint32_t>(fullIndices.size());
+        mr.vertexStride = sm::SMODEL_PACKED_VERTEX_STRIDE;
 
         // layout flags should match your enum in ModelFormats.h
         // If your enum differs, update accordingly.
-        mr.layoutFlags = sm::VTX_POS | sm::VTX_NORMAL | sm::VTX_UV0 | sm::VTX_TANGENT | sm::VTX_JOINTS | sm::VTX_WEIGHTS;
+        mr.layoutFlags = sm::VTX_POS | sm::VTX_NORMAL | sm::VTX_UV0 | sm::VTX_TANGENT | sm::VTX_JOINTS | sm::VTX_WEIGHTS | sm::VTX_PACKED;
 
         // Indices are always U32 in phase 1
         mr.indexType = 1; // assume 1=U32 (match your IndexType enum if different)
@@ -1196,18 +1950,73 @@ int main(int argc, char **argv)
         // AABB
         ComputeAABB(vertices, mr.aabbMin, mr.aabbMax);
 
-        // Store vertex/index bytes in blob
-        blob.align(8);
-        mr.vertexDataOffset = blob.append(vertices.data(), vertices.size() * sizeof(VertexPNTTJW));
-        mr.vertexDataSize = static_cast<uint32_t>(vertices.size() * sizeof(VertexPNTTJW));
+        // Packed vertices and indices into the merged streams
+        const size_t firstVertex = mergedVertices.size();
+        mergedVertices.resize(firstVertex + vertices.size());
+        sm::PackVerticesPNTTJW(reinterpret_cast<const uint8_t *>(vertices.data()), static_cast<uint32_t>(vertices.size()),
+                               mergedVertices.data() + firstVertex);
+        mr.vertexDataOffset = uint64_t(firstVertex) * sizeof(sm::SModelPackedVertex);
+        mr.vertexDataSize = static_cast<uint32_t>(vertices.size() * sizeof(sm::SModelPackedVertex));
 
-        blob.align(8);
-        mr.indexDataOffset = blob.append(indices.data(), indices.size() * sizeof(uint32_t));
-        mr.indexDataSize = static_cast<uint32_t>(indices.size() * sizeof(uint32_t));
+        mr.indexDataOffset = uint64_t(mergedIndices.size()) * sizeof(uint32_t);
+        mr.indexDataSize = static_cast<uint32_t>(fullIndices.size() * sizeof(uint32_t));
+        mergedIndices.insert(mergedIndices.end(), fullIndices.begin(), fullIndices.end());
 
         const uint32_t outMeshIndex = static_cast<uint32_t>(meshRecords.size());
         meshRecords.push_back(mr);
 
+        // Impostor capture source, indexed like meshRecords (node globals applied later).
+        if (impostorFrames > 0)
+        {
+            ImpostorMesh im{};
+            im.positions.reserve(vertices.size() * 3u);
+            im.normals.reserve(vertices.size() * 3u);
+            im.uvs.reserve(vertices.size() * 2u);
+            for (const VertexPNTTJW &v : vertices)
+            {
+                im.positions.insert(im.positions.end(), v.pos, v.pos + 3);
+                im.normals.insert(im.normals.end(), v.normal, v.normal + 3);
+                im.uvs.insert(im.uvs.end(), v.uv0, v.uv0 + 2);
+            }
+            im.indices = fullIndices;
+            im.material = static_cast<uint32_t>(mesh->mMaterialIndex);
+            impostorMeshes.push_back(std::move(im));
+        }
+
+        for (uint32_t level = 1; level < lists.size(); ++level)
+        {
+            sm::SModelMeshLodRecord lr{};
+            lr.meshIndex = outMeshIndex;
+            lr.level = level;
+            lr.indexCount = static_cast<uint32_t>(lists[level].size());
+            lr.screenSize = LOD_SCREEN_SIZE_LEVEL1 * std::ldexp(1.0f, -static_cast<int>(level - 1));
+            lr.indexDataOffset = uint64_t(mergedIndices.size()) * sizeof(uint32_t);
+            lr.indexDataSize = lists[level].size() * sizeof(uint32_t);
+            mergedIndices.insert(mergedIndices.end(), lists[level].begin(), lists[level].end());
+            lodRecords.push_back(lr);
+        }
+
+        for (const Engine::Meshlet &m : meshlets)
+        {
+            const Engine::MeshletBounds b = Engine::ComputeMeshletBounds(m, meshletVertices.data(), meshletTriangles.data(),
+                                                                         reinterpret_cast<const uint8_t *>(vertices.data()), sizeof(VertexPNTTJW));
+            sm::SModelMeshletRecord rec{};
+            rec.meshIndex = outMeshIndex;
+            rec.firstIndex = m.firstTriangle * 3u;
+            rec.vertexOffset = static_cast<uint32_t>(meshletVertexData.size()) + m.vertexOffset;
+            rec.triangleOffset = static_cast<uint32_t>(meshletTriangleData.size()) + m.triangleOffset * 3u;
+            rec.vertexCount = static_cast<uint16_t>(m.vertexCount);
+            rec.triangleCount = static_cast<uint16_t>(m.triangleCount);
+            rec.anchorJoint = skinIndex >= 0 ? MeshletAnchorJoint(vertices, meshletVertices.data() + m.vertexOffset, m.vertexCount) : -1;
+            std::memcpy(rec.center, b.center, sizeof(rec.center));
+            rec.radius = b.radius;
+            std::memcpy(rec.coneAxis, b.coneAxis, sizeof(rec.coneAxis));
+            rec.coneCutoff = b.coneCutoff;
+            meshletRecords.push_back(rec);
+        }
+        meshletVertexData.insert(meshletVertexData.end(), meshletVertices.begin(), meshletVertices.end());
+        meshletTriangleData.insert(meshletTriangleData.end(), meshletTriangles.begin(), meshletTriangles.end());
+
         // Primitive record (one per mesh)
         sm::SModelPrimitiveRecord pr{};
         pr.meshIndex = outMeshIndex;
@@ -1221,6 +2030,21 @@ int main(int argc, char **argv)
         meshIndexToPrimIndex[meshIdx] = static_cast<int32_t>(primRecords.size() - 1);
     }
 
+    // Merged streams into the blob; mesh / LOD records point into them.
+    {
+        blob.align(8);
+        const uint64_t vertexBase = blob.append(mergedVertices.data(), mergedVertices.size() * sizeof(sm::SModelPackedVertex));
+        blob.align(8);
+        const uint64_t indexBase = blob.append(mergedIndices.data(), mergedIndices.size() * sizeof(uint32_t));
+        for (sm::SModelMeshRecord &mr : meshRecords)
+        {
+            mr.vertexDataOffset += vertexBase;
+            mr.indexDataOffset += indexBase;
+        }
+        for (sm::SModelMeshLodRecord &lr : lodRecords)
+            lr.indexDataOffset += indexBase;
+    }
+
     // ------------------------------------------------------------
     // Build node graph (DFS)
     const uint32_t U32_MAX = ~0u;
@@ -1659,9 +2483,140 @@ int main(int argc, char **argv)
         }
     }
 
+    // ------------------------------------------------------------
+    // Octahedral impostor (optional, --impostor or a .impostor.json sidecar)
+    // Rest pose in model space: each node's primitives through its global, as the runtime
+    // flattens the node graph for static props. Atlases are appended to the texture table.
+    // ------------------------------------------------------------
+    sm::SModelImpostorHeader impostorHeader{};
+    bool impostor = false;
+    if (impostorFrames > 0 && !impostorMeshes.empty())
+    {
+        std::vector<float> globals(nodeRecords.size() * 16u);
+        for (uint32_t n = 0; n < static_cast<uint32_t>(nodeRecords.size()); ++n)
+        {
+            const uint32_t parent = nodeRecords[n].parentIndex;
+            if (parent == U32_MAX || parent >= n) // DFS order: parents come first
+                std::memcpy(&globals[size_t(n) * 16u], nodeRecords[n].localMatrix, sizeof(float) * 16u);
+            else
+                MulMat4(&globals[size_t(parent) * 16u], nodeRecords[n].localMatrix, &globals[size_t(n) * 16u]);
+        }
+
+        std::vector<ImpostorMesh> placed;
+        auto placePrimitive = [&](uint32_t primIndex, const float *global)
+        {
+            if (primIndex >= primRecords.size() || primRecords[primIndex].meshIndex >= impostorMeshes.size())
+                return;
+            ImpostorMesh m = impostorMeshes[primRecords[primIndex].meshIndex];
+            m.material = primRecords[primIndex].materialIndex;
+            if (global)
+            {
+                for (size_t v = 0; v + 2 < m.positions.size(); v += 3)
+                {
+                    float p[3], nrm[3];
+                    TransformPoint(global, &m.positions[v], p);
+                    TransformDirection(global, &m.normals[v], nrm);
+                    std::memcpy(&m.positions[v], p, sizeof(p));
+                    std::memcpy(&m.normals[v], nrm, sizeof(nrm));
+                }
+            }
+            placed.push_back(std::move(m));
+        };
+        if (!nodeRecords.empty())
+        {
+            for (uint32_t n = 0; n < static_cast<uint32_t>(nodeRecords.size()); ++n)
+            {
+                for (uint32_t k = 0; k < nodeRecords[n].primitiveCount; ++k)
+                    placePrimitive(nodePrimitiveIndices[nodeRecords[n].firstPrimitiveIndex + k], &globals[size_t(n) * 16u]);
+            }
+        }
+        else
+        {
+            for (uint32_t p = 0; p < static_cast<uint32_t>(primRecords.size()); ++p)
+                placePrimitive(p, nullptr);
+        }
+
+        std::vector<ImpostorMaterial> impostorMaterials(materialRecords.size());
+        for (size_t mi = 0; mi < materialRecords.size(); ++mi)
+        {
+            const sm::SModelMaterialRecord &mr = materialRecords[mi];
+            ImpostorMaterial &im = impostorMaterials[mi];
+            std::memcpy(im.baseColorFactor, mr.baseColorFactor, sizeof(im.baseColorFactor));
+            im.alphaCutoff = mr.alphaCutoff;
+            im.cutout = mr.alphaMode != 0;
+            auto it = impostorTextures.find(mr.baseColorTexture);
+            if (it != impostorTextures.end())
+            {
+                im.rgba = it->second.rgba.data();
+                im.width = it->second.width;
+                im.height = it->second.height;
+            }
+        }
+
+        ImpostorAtlases atlases;
+        if (BakeImpostorAtlases(placed, impostorMaterials, impostorSettings, atlases))
+        {
+            // Clamped (frames must not bleed into their neighbors), stored like the source textures.
+            auto appendAtlas = [&](const char *name, const std::vector<uint8_t> &rgba, bool srgb) -> int32_t
+            {
+                sm::SModelTextureRecord tr{};
+                tr.nameStrOffset = strings.add(name);
+                tr.uriStrOffset = tr.nameStrOffset;
+                tr.colorSpace = srgb ? 1 : 0;
+                tr.wrapU = ConvertWrapMode(aiTextureMapMode_Clamp);
+                tr.wrapV = ConvertWrapMode(aiTextureMapMode_Clamp);
+                tr.minFilter = DefaultFilterLinear();
+                tr.magFilter = DefaultFilterLinear();
+                tr.mipFilter = DefaultMipLinear();
+                tr.maxAnisotropy = 1.0f;
+                tr.width = static_cast<uint16_t>(atlases.size);
+                tr.height = static_cast<uint16_t>(atlases.size);
+
+                CompressedMipChain bc7;
+                if (textureOutput == TextureOutput::BC7 && BuildBC7MipChain(rgba.data(), atlases.size, atlases.size, srgb, bc7))
+                {
+                    tr.encoding = static_cast<uint32_t>(sm::ImageEncoding::BC7);
+                    tr.mipLevels = bc7.mipLevels;
+                    blob.align(16);
+                    tr.imageDataOffset = blob.append(bc7.bytes.data(), bc7.bytes.size());
+                    tr.imageDataSize = static_cast<uint64_t>(bc7.bytes.size());
+                    anyBlockCompressed = true;
+                }
+                else
+                {
+                    tr.encoding = static_cast<uint32_t>(sm::ImageEncoding::RAW);
+                    tr.mipLevels = 1;
+                    blob.align(8);
+                    tr.imageDataOffset = blob.append(rgba.data(), rgba.size());
+                    tr.imageDataSize = static_cast<uint64_t>(rgba.size());
+                }
+                textureRecords.push_back(tr);
+                return static_cast<int32_t>(textureRecords.size() - 1u);
+            };
+
+            impostorHeader.framesPerSide = impostorSettings.framesPerSide;
+            impostorHeader.frameResolution = impostorSettings.frameResolution;
+            impostorHeader.albedoTexture = appendAtlas("impostor_albedo", atlases.albedo, true);
+            impostorHeader.normalTexture = appendAtlas("impostor_normal_depth", atlases.normalDepth, false);
+            std::memcpy(impostorHeader.center, atlases.center, sizeof(impostorHeader.center));
+            impostorHeader.radius = atlases.radius;
+            impostorHeader.mapping = static_cast<uint32_t>(impostorSettings.hemisphere ? sm::ImpostorMapping::Hemisphere : sm::ImpostorMapping::Sphere);
+            impostor = true;
+        }
+        else
+        {
+            std::cout << "WARNING: impostor capture found no triangles, skipping\n";
+        }
+    }
+
     // Build header offsets
     // File layout:
     // Header
+    // BakedAnimationHeader (only with --bake-anim)
+    // MeshLodHeader (only with --lods)
+    // QuantizedAnimHeader (only with --quantize-anim)
+    // ImpostorHeader (only with --impostor)
+    // MeshletHeader (only with --meshlets)
     // MeshRecords
     // PrimitiveRecords
     // MaterialRecords
@@ -1673,13 +2628,62 @@ int main(int argc, char **argv)
     // SkinJointNodeIndices
     // SkinInverseBindMatrices
     // Anim*
+    // BakedClips, BakedFrames (only with --bake-anim)
+    // MeshLodRecords (only with --lods)
+    // QuantizedClips, QuantizedTracks, QuantizedData (only with --quantize-anim)
+    // MeshletRecords (only with --meshlets)
     // StringTable
     // Blob
     // ------------------------------------------------------------
+    // Baked palettes (optional, --bake-anim): extension header right after the main header,
+    // clip table + frames after the anim values.
+    std::vector<sm::SModelBakedClipRecord> bakedClips;
+    std::vector<float> bakedData;
+    uint32_t bakedJointCount = 0;
+    const bool bakeAnimation = bakeSampleRate > 0.0f && !animClips.empty();
+    if (bakeAnimation)
+    {
+        BakeAnimationPalettes(nodeRecords, nodeChildIndices, skinRecords, skinJointNodeIndices, skinInverseBindMatrices,
+                              animClips, animChannels, animSamplers, animTimes, animValues,
+                              bakeSampleRate, bakedClips, bakedData, bakedJointCount);
+    }
+
+    // Quantized clips (optional, --quantize-anim) replace the raw channels/samplers/keys; clip
+    // records stay (names, durations) with no channels. Baking above still used the raw keys.
+    std::vector<sm::SModelQuantizedClipRecord> quantizedClips;
+    std::vector<sm::SModelQuantizedTrackRecord> quantizedTracks;
+    std::vector<uint16_t> quantizedData;
+    const bool quantizeAnimation = quantizeSampleRate > 0.0f && !animClips.empty();
+    size_t rawAnimBytes = 0;
+    if (quantizeAnimation)
+    {
+        rawAnimBytes = animChannels.size() * sizeof(sm::SModelAnimationChannelRecord) +
+                       animSamplers.size() * sizeof(sm::SModelAnimationSamplerRecord) +
+                       (animTimes.size() + animValues.size()) * sizeof(float);
+        QuantizeAnimationClips(static_cast<uint32_t>(nodeRecords.size()), animClips, animChannels, animSamplers, animTimes, animValues,
+                               quantizeSampleRate, quantizedClips, quantizedTracks, quantizedData);
+        for (auto &c : animClips)
+        {
+            c.firstChannel = 0;
+            c.channelCount = 0;
+        }
+        animChannels.clear();
+        animSamplers.clear();
+        animTimes.clear();
+        animValues.clear();
+    }
+
     sm::SModelHeader header{};
     header.magic = sm::SMODEL_MAGIC;
     header.versionMajor = 4;
-    header.versionMinor = 0;
+    // 4.1: block-compressed textures, 4.2: baked animation, 4.3: mesh LODs, 4.4: quantized animation,
+    // 4.5: octahedral impostor, 4.6: meshlets
+    const bool meshLods = !lodRecords.empty();
+    const bool meshletsOut = !meshletRecords.empty();
+    header.versionMinor = meshletsOut ? 6 : (impostor ? 5 : (quantizeAnimation ? 4 : (meshLods ? 3 : (bakeAnimation ? 2 : (anyBlockCompressed ? 1 : 0)))));
+    header.flags = (bakeAnimation ? sm::SMODEL_FLAG_BAKED_ANIMATION : 0u) | (meshLods ? sm::SMODEL_FLAG_MESH_LODS : 0u) |
+                   (quantizeAnimation ? sm::SMODEL_FLAG_QUANTIZED_ANIMATION : 0u) | (impostor ? sm::SMODEL_FLAG_IMPOSTOR : 0u) |
+                   (optimizeMeshes ? sm::SMODEL_FLAG_OPTIMIZED_MESHES : 0u) | (meshletsOut ? sm::SMODEL_FLAG_MESHLETS : 0u);
 
     header.meshCount = static_cast<uint32_t>(meshRecords.size());
     header.primitiveCount = static_cast<uint32_t>(primRecords.size());
@@ -1699,6 +2703,20 @@ int main(int argc, char **argv)
     header.animValuesCount = static_cast<uint32_t>(animValues.size());
 
     uint64_t cursor = sizeof(sm::SModelHeader);
+    sm::SModelBakedAnimationHeader bakedHeader{};
+    if (bakeAnimation)
+        cursor += sizeof(sm::SModelBakedAnimationHeader);
+    sm::SModelMeshLodHeader lodHeader{};
+    if (meshLods)
+        cursor += sizeof(sm::SModelMeshLodHeader);
+    sm::SModelQuantizedAnimHeader quantizedHeader{};
+    if (quantizeAnimation)
+        cursor += sizeof(sm::SModelQuantizedAnimHeader);
+    if (impostor)
+        cursor += sizeof(sm::SModelImpostorHeader);
+    sm::SModelMeshletHeader meshletHeader{};
+    if (meshletsOut)
+        cursor += sizeof(sm::SModelMeshletHeader);
 
     header.meshesOffset = cursor;
     cursor += uint64_t(meshRecords.size()) * sizeof(sm::SModelMeshRecord);
@@ -1750,6 +2768,63 @@ int main(int argc, char **argv)
     header.animValuesOffset = static_cast<uint32_t>(cursor);
     cursor += uint64_t(animValues.size()) * sizeof(float);
 
+    if (bakeAnimation)
+    {
+        bakedHeader.sampleRate = bakeSampleRate;
+        bakedHeader.nodeCount = static_cast<uint32_t>(nodeRecords.size());
+        bakedHeader.jointCount = bakedJointCount;
+        bakedHeader.clipCount = static_cast<uint32_t>(bakedClips.size());
+
+        bakedHeader.clipsOffset = static_cast<uint32_t>(cursor);
+        cursor += uint64_t(bakedClips.size()) * sizeof(sm::SModelBakedClipRecord);
+
+        bakedHeader.dataOffset = static_cast<uint32_t>(cursor);
+        bakedHeader.dataCount = static_cast<uint32_t>(bakedData.size());
+        cursor += uint64_t(bakedData.size()) * sizeof(float);
+    }
+
+    if (meshLods)
+    {
+        lodHeader.lodCount = static_cast<uint32_t>(lodRecords.size());
+        lodHeader.lodsOffset = static_cast<uint32_t>(cursor);
+        for (const auto &lr : lodRecords)
+            lodHeader.maxLevels = std::max(lodHeader.maxLevels, lr.level);
+        cursor += uint64_t(lodRecords.size()) * sizeof(sm::SModelMeshLodRecord);
+    }
+
+    if (quantizeAnimation)
+    {
+        quantizedHeader.sampleRate = quantizeSampleRate;
+        quantizedHeader.clipCount = static_cast<uint32_t>(quantizedClips.size());
+        quantizedHeader.trackCount = static_cast<uint32_t>(quantizedTracks.size());
+
+        quantizedHeader.clipsOffset = static_cast<uint32_t>(cursor);
+        cursor += uint64_t(quantizedClips.size()) * sizeof(sm::SModelQuantizedClipRecord);
+
+        quantizedHeader.tracksOffset = static_cast<uint32_t>(cursor);
+        cursor += uint64_t(quantizedTracks.size()) * sizeof(sm::SModelQuantizedTrackRecord);
+
+        quantizedHeader.dataOffset = static_cast<uint32_t>(cursor);
+        quantizedHeader.dataWords = static_cast<uint32_t>(quantizedData.size());
+        cursor += uint64_t(quantizedData.size()) * sizeof(uint16_t);
+    }
+
+    if (meshletsOut)
+    {
+        meshletHeader.meshletCount = static_cast<uint32_t>(meshletRecords.size());
+        meshletHeader.meshletsOffset = static_cast<uint32_t>(cursor);
+        meshletHeader.maxVertices = sm::SMODEL_MAX_MESHLET_VERTICES;
+        meshletHeader.maxTriangles = sm::SMODEL_MAX_MESHLET_TRIANGLES;
+        cursor += uint64_t(meshletRecords.size()) * sizeof(sm::SModelMeshletRecord);
+
+        meshletHeader.vertexCount = static_cast<uint32_t>(meshletVertexData.size());
+        meshletHeader.triangleByteCount = static_cast<uint32_t>(meshletTriangleData.size());
+        blob.align(8);
+        meshletHeader.vertexDataOffset = blob.append(meshletVertexData.data(), meshletVertexData.size() * sizeof(uint32_t));
+        blob.align(8);
+        meshletHeader.triangleDataOffset = blob.append(meshletTriangleData.data(), meshletTriangleData.size());
+    }
+
     header.stringTableOffset = cursor;
     header.stringTableSize = static_cast<uint64_t>(strings.data.size());
     cursor += strings.data.size();
@@ -1773,6 +2848,16 @@ int main(int argc, char **argv)
     }
 
     out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    if (bakeAnimation)
+        out.write(reinterpret_cast<const char *>(&bakedHeader), sizeof(bakedHeader));
+    if (meshLods)
+        out.write(reinterpret_cast<const char *>(&lodHeader), sizeof(lodHeader));
+    if (quantizeAnimation)
+        out.write(reinterpret_cast<const char *>(&quantizedHeader), sizeof(quantizedHeader));
+    if (impostor)
+        out.write(reinterpret_cast<const char *>(&impostorHeader), sizeof(impostorHeader));
+    if (meshletsOut)
+        out.write(reinterpret_cast<const char *>(&meshletHeader), sizeof(meshletHeader));
     WriteVector(out, meshRecords);
     WriteVector(out, primRecords);
     WriteVector(out, materialRecords);
@@ -1788,6 +2873,13 @@ int main(int argc, char **argv)
     WriteVector(out, animSamplers);
     WriteVector(out, animTimes);
     WriteVector(out, animValues);
+    WriteVector(out, bakedClips);
+    WriteVector(out, bakedData);
+    WriteVector(out, lodRecords);
+    WriteVector(out, quantizedClips);
+    WriteVector(out, quantizedTracks);
+    WriteVector(out, quantizedData);
+    WriteVector(out, meshletRecords);
     WriteChars(out, strings.data);
     WriteBytes(out, blob.bytes);
 
@@ -1795,6 +2887,7 @@ int main(int argc, char **argv)
 
     std::cout << "\nCook complete \n";
     std::cout << "Meshes     : " << header.meshCount << "\n";
+    std::cout << "Vertices   : " << mergedVertices.size() << " packed, indices " << mergedIndices.size() << " (one merged VB/IB)\n";
     std::cout << "Primitives : " << header.primitiveCount << "\n";
     std::cout << "Materials  : " << header.materialCount << "\n";
     std::cout << "Textures   : " << header.textureCount << "\n";
@@ -1806,6 +2899,20 @@ int main(int argc, char **argv)
     std::cout << "AnimSamplers: " << header.animSamplersCount << "\n";
     std::cout << "AnimTimes  : " << header.animTimesCount << " floats\n";
     std::cout << "AnimValues : " << header.animValuesCount << " floats\n";
+    if (bakeAnimation)
+        std::cout << "BakedAnim  : " << bakedData.size() << " floats @ " << bakeSampleRate << " fps\n";
+    if (quantizeAnimation)
+        std::cout << "QuantAnim  : " << quantizedTracks.size() << " tracks, " << quantizedData.size() * sizeof(uint16_t)
+                  << " bytes @ " << quantizeSampleRate << " fps (raw keys were " << rawAnimBytes << " bytes)\n";
+    if (meshLods)
+        std::cout << "MeshLods   : " << lodRecords.size() << " levels (max " << lodHeader.maxLevels << " per mesh)\n";
+    if (impostor)
+        std::cout << "Impostor   : " << impostorHeader.framesPerSide << "x" << impostorHeader.framesPerSide << " frames of "
+                  << impostorHeader.frameResolution << " px (" << (impostorSettings.hemisphere ? "hemisphere" : "sphere")
+                  << "), radius " << impostorHeader.radius << "\n";
+    if (meshletsOut)
+        std::cout << "Meshlets   : " << meshletRecords.size() << " (<= " << meshletHeader.maxVertices << " verts, "
+                  << meshletHeader.maxTriangles << " tris), " << meshletTriangleData.size() / 3 << " triangles\n";
     std::cout << "StringTable: " << header.stringTableSize << " bytes\n";
     std::cout << "Blob       : " << header.blobSize << " bytes\n";
     std::cout << "FileSize   : " << header.fileSizeBytes << " bytes\n";
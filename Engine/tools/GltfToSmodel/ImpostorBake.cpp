@@ -0,0 +1,331 @@
+#include "ImpostorBake.h"
+
+#include "assets/model/SModelImpostor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace sm = Engine::smodel;
+
+namespace
+{
+    // Frames are rendered at SUPERSAMPLE x the frame resolution and box-filtered down.
+    constexpr uint32_t SUPERSAMPLE = 2;
+    // Empty-texel color bleed passes per frame (texels of silhouette reach).
+    constexpr uint32_t DILATE_PASSES = 8;
+
+    struct Vec3
+    {
+        float x, y, z;
+    };
+
+    Vec3 sub(const Vec3 &a, const Vec3 &b) { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+    float dot(const Vec3 &a, const Vec3 &b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+    Vec3 vertexAt(const std::vector<float> &v, uint32_t i) { return {v[i * 3u + 0u], v[i * 3u + 1u], v[i * 3u + 2u]}; }
+
+    // Bilinear fetch with repeat wrapping; white without a texture.
+    void sampleTexture(const ImpostorMaterial &m, float u, float v, float out[4])
+    {
+        if (!m.rgba || m.width == 0 || m.height == 0)
+        {
+            out[0] = out[1] = out[2] = out[3] = 1.0f;
+            return;
+        }
+        const float x = (u - std::floor(u)) * float(m.width) - 0.5f;
+        const float y = (v - std::floor(v)) * float(m.height) - 0.5f;
+        const float fx = x - std::floor(x);
+        const float fy = y - std::floor(y);
+        const int x0 = static_cast<int>(std::floor(x));
+        const int y0 = static_cast<int>(std::floor(y));
+        const int w = static_cast<int>(m.width);
+        const int h = static_cast<int>(m.height);
+        auto texel = [&](int tx, int ty, int c)
+        {
+            tx = ((tx % w) + w) % w;
+            ty = ((ty % h) + h) % h;
+            return float(m.rgba[(size_t(ty) * m.width + size_t(tx)) * 4u + size_t(c)]) / 255.0f;
+        };
+        for (int c = 0; c < 4; ++c)
+        {
+            const float top = texel(x0, y0, c) * (1.0f - fx) + texel(x0 + 1, y0, c) * fx;
+            const float bottom = texel(x0, y0 + 1, c) * (1.0f - fx) + texel(x0 + 1, y0 + 1, c) * fx;
+            out[c] = top * (1.0f - fy) + bottom * fy;
+        }
+    }
+
+    uint8_t toByte(float v) { return static_cast<uint8_t>(std::lround(std::clamp(v, 0.0f, 1.0f) * 255.0f)); }
+
+    // One supersampled frame: nearest surface per sample.
+    struct FrameTarget
+    {
+        uint32_t size = 0;
+        std::vector<float> depth; // toward the viewer, in radii; -inf = empty
+        std::vector<float> color; // rgb
+        std::vector<float> normal;
+
+        void reset(uint32_t s)
+        {
+            size = s;
+            depth.assign(size_t(s) * s, -std::numeric_limits<float>::infinity());
+            color.assign(size_t(s) * s * 3u, 0.0f);
+            normal.assign(size_t(s) * s * 3u, 0.0f);
+        }
+    };
+
+    void rasterizeMesh(const ImpostorMesh &mesh, const ImpostorMaterial &mat, const Vec3 &center, float radius,
+                       const Vec3 &dir, const Vec3 &right, const Vec3 &up, FrameTarget &target)
+    {
+        const float s = float(target.size);
+        const uint32_t vertexCount = static_cast<uint32_t>(mesh.positions.size() / 3u);
+        for (size_t t = 0; t + 2 < mesh.indices.size(); t += 3)
+        {
+            const uint32_t ix[3] = {mesh.indices[t], mesh.indices[t + 1], mesh.indices[t + 2]};
+            if (ix[0] >= vertexCount || ix[1] >= vertexCount || ix[2] >= vertexCount)
+                continue;
+
+            float sx[3], sy[3], sz[3];
+            for (int k = 0; k < 3; ++k)
+            {
+                const Vec3 p = sub(vertexAt(mesh.positions, ix[k]), center);
+                sx[k] = (dot(p, right) / radius * 0.5f + 0.5f) * s;
+                sy[k] = (0.5f - dot(p, up) / radius * 0.5f) * s;
+                sz[k] = dot(p, dir) / radius;
+            }
+
+            const float area = (sx[1] - sx[0]) * (sy[2] - sy[0]) - (sx[2] - sx[0]) * (sy[1] - sy[0]);
+            if (std::fabs(area) < 1e-8f)
+                continue;
+            const float invArea = 1.0f / area;
+
+            const int minX = std::max(0, static_cast<int>(std::floor(std::min({sx[0], sx[1], sx[2]}))));
+            const int maxX = std::min(int(target.size) - 1, static_cast<int>(std::ceil(std::max({sx[0], sx[1], sx[2]}))));
+            const int minY = std::max(0, static_cast<int>(std::floor(std::min({sy[0], sy[1], sy[2]}))));
+            const int maxY = std::min(int(target.size) - 1, static_cast<int>(std::ceil(std::max({sy[0], sy[1], sy[2]}))));
+
+            for (int py = minY; py <= maxY; ++py)
+            {
+                for (int px = minX; px <= maxX; ++px)
+                {
+                    const float cx = float(px) + 0.5f;
+                    const float cy = float(py) + 0.5f;
+                    // Barycentrics; either winding (foliage cards are double sided).
+                    const float w0 = ((sx[1] - cx) * (sy[2] - cy) - (sx[2] - cx) * (sy[1] - cy)) * invArea;
+                    const float w1 = ((sx[2] - cx) * (sy[0] - cy) - (sx[0] - cx) * (sy[2] - cy)) * invArea;
+                    const float w2 = 1.0f - w0 - w1;
+                    if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f)
+                        continue;
+
+                    const size_t pixel = size_t(py) * target.size + size_t(px);
+                    const float z = w0 * sz[0] + w1 * sz[1] + w2 * sz[2];
+                    if (z <= target.depth[pixel])
+                        continue;
+
+                    float texel[4];
+                    float u = 0.0f, v = 0.0f;
+                    if (mesh.uvs.size() >= size_t(vertexCount) * 2u)
+                    {
+                        u = w0 * mesh.uvs[ix[0] * 2u] + w1 * mesh.uvs[ix[1] * 2u] + w2 * mesh.uvs[ix[2] * 2u];
+                        v = w0 * mesh.uvs[ix[0] * 2u + 1u] + w1 * mesh.uvs[ix[1] * 2u + 1u] + w2 * mesh.uvs[ix[2] * 2u + 1u];
+                    }
+                    sampleTexture(mat, u, v, texel);
+                    if (mat.cutout && texel[3] * mat.baseColorFactor[3] < mat.alphaCutoff)
+                        continue;
+
+                    Vec3 n{0.0f, 1.0f, 0.0f};
+                    if (mesh.normals.size() >= size_t(vertexCount) * 3u)
+                    {
+                        const Vec3 n0 = vertexAt(mesh.normals, ix[0]);
+                        const Vec3 n1 = vertexAt(mesh.normals, ix[1]);
+                        const Vec3 n2 = vertexAt(mesh.normals, ix[2]);
+                        n = {w0 * n0.x + w1 * n1.x + w2 * n2.x, w0 * n0.y + w1 * n1.y + w2 * n2.y, w0 * n0.z + w1 * n1.z + w2 * n2.z};
+                        const float len = std::sqrt(dot(n, n));
+                        n = len > 1e-6f ? Vec3{n.x / len, n.y / len, n.z / len} : Vec3{dir.x, dir.y, dir.z};
+                    }
+                    // A back face seen through a card lights like its front.
+                    if (dot(n, dir) < 0.0f)
+                        n = {-n.x, -n.y, -n.z};
+
+                    target.depth[pixel] = z;
+                    for (int c = 0; c < 3; ++c)
+                        target.color[pixel * 3u + size_t(c)] = texel[c] * mat.baseColorFactor[c];
+                    target.normal[pixel * 3u + 0u] = n.x;
+                    target.normal[pixel * 3u + 1u] = n.y;
+                    target.normal[pixel * 3u + 2u] = n.z;
+                }
+            }
+        }
+    }
+
+    // Box-filters the supersampled frame into its atlas tile (frame x, y).
+    void resolveFrame(const FrameTarget &target, uint32_t frameX, uint32_t frameY, uint32_t res, ImpostorAtlases &out)
+    {
+        for (uint32_t y = 0; y < res; ++y)
+        {
+            for (uint32_t x = 0; x < res; ++x)
+            {
+                float color[3] = {0.0f, 0.0f, 0.0f};
+                float normal[3] = {0.0f, 0.0f, 0.0f};
+                float depth = 0.0f;
+                uint32_t covered = 0;
+                for (uint32_t sy = 0; sy < SUPERSAMPLE; ++sy)
+                {
+                    for (uint32_t sx = 0; sx < SUPERSAMPLE; ++sx)
+                    {
+                        const size_t p = size_t(y * SUPERSAMPLE + sy) * target.size + size_t(x * SUPERSAMPLE + sx);
+                        if (!std::isfinite(target.depth[p]))
+                            continue;
+                        for (int c = 0; c < 3; ++c)
+                        {
+                            color[c] += target.color[p * 3u + size_t(c)];
+                            normal[c] += target.normal[p * 3u + size_t(c)];
+                        }
+                        depth += target.depth[p];
+                        ++covered;
+                    }
+                }
+
+                const size_t texel = (size_t(frameY * res + y) * out.size + size_t(frameX * res + x)) * 4u;
+                if (covered == 0)
+                {
+                    out.albedo[texel + 3u] = 0;
+                    out.normalDepth[texel + 3u] = 0;
+                    continue;
+                }
+                const float inv = 1.0f / float(covered);
+                const float len = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+                const float nInv = len > 1e-6f ? 1.0f / len : 0.0f;
+                for (int c = 0; c < 3; ++c)
+                {
+                    out.albedo[texel + size_t(c)] = toByte(color[c] * inv);
+                    out.normalDepth[texel + size_t(c)] = toByte(normal[c] * nInv * 0.5f + 0.5f);
+                }
+                out.albedo[texel + 3u] = toByte(float(covered) / float(SUPERSAMPLE * SUPERSAMPLE));
+                // At least 1: 0 is reserved for texels the surface never reached.
+                out.normalDepth[texel + 3u] = std::max<uint8_t>(1u, toByte(depth * inv * 0.5f + 0.5f));
+            }
+        }
+    }
+
+    // Spreads covered texels' albedo and normal into empty neighbors (alpha stays 0).
+    void dilateFrame(uint32_t frameX, uint32_t frameY, uint32_t res, ImpostorAtlases &out)
+    {
+        std::vector<uint8_t> filled(size_t(res) * res, 0u);
+        for (uint32_t y = 0; y < res; ++y)
+            for (uint32_t x = 0; x < res; ++x)
+                filled[size_t(y) * res + x] = out.albedo[(size_t(frameY * res + y) * out.size + size_t(frameX * res + x)) * 4u + 3u] != 0 ? 1u : 0u;
+
+        std::vector<uint8_t> next = filled;
+        for (uint32_t pass = 0; pass < DILATE_PASSES; ++pass)
+        {
+            bool changed = false;
+            for (uint32_t y = 0; y < res; ++y)
+            {
+                for (uint32_t x = 0; x < res; ++x)
+                {
+                    if (filled[size_t(y) * res + x])
+                        continue;
+                    uint32_t sum[6] = {0, 0, 0, 0, 0, 0};
+                    uint32_t count = 0;
+                    for (int dy = -1; dy <= 1; ++dy)
+                    {
+                        for (int dx = -1; dx <= 1; ++dx)
+                        {
+                            const int nx = int(x) + dx;
+                            const int ny = int(y) + dy;
+                            if (nx < 0 || ny < 0 || nx >= int(res) || ny >= int(res) || !filled[size_t(ny) * res + size_t(nx)])
+                                continue;
+                            const size_t t = (size_t(frameY * res + uint32_t(ny)) * out.size + size_t(frameX * res + uint32_t(nx))) * 4u;
+                            for (int c = 0; c < 3; ++c)
+                            {
+                                sum[c] += out.albedo[t + size_t(c)];
+                                sum[3 + c] += out.normalDepth[t + size_t(c)];
+                            }
+                            ++count;
+                        }
+                    }
+                    if (count == 0)
+                        continue;
+                    const size_t t = (size_t(frameY * res + y) * out.size + size_t(frameX * res + x)) * 4u;
+                    for (int c = 0; c < 3; ++c)
+                    {
+                        out.albedo[t + size_t(c)] = static_cast<uint8_t>(sum[c] / count);
+                        out.normalDepth[t + size_t(c)] = static_cast<uint8_t>(sum[3 + c] / count);
+                    }
+                    next[size_t(y) * res + x] = 1u;
+                    changed = true;
+                }
+            }
+            filled = next;
+            if (!changed)
+                break;
+        }
+    }
+} // namespace
+
+bool BakeImpostorAtlases(const std::vector<ImpostorMesh> &meshes, const std::vector<ImpostorMaterial> &materials,
+                         const ImpostorSettings &settings, ImpostorAtlases &out)
+{
+    const uint32_t n = std::max<uint32_t>(settings.framesPerSide, 2u);
+    const uint32_t res = std::max<uint32_t>(settings.frameResolution, 4u);
+
+    // Capture sphere: around the AABB center, reaching the farthest vertex.
+    Vec3 bmin{std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max()};
+    Vec3 bmax{-bmin.x, -bmin.y, -bmin.z};
+    size_t triangles = 0;
+    for (const ImpostorMesh &m : meshes)
+    {
+        triangles += m.indices.size() / 3u;
+        for (size_t i = 0; i + 2 < m.positions.size(); i += 3)
+        {
+            bmin = {std::min(bmin.x, m.positions[i]), std::min(bmin.y, m.positions[i + 1]), std::min(bmin.z, m.positions[i + 2])};
+            bmax = {std::max(bmax.x, m.positions[i]), std::max(bmax.y, m.positions[i + 1]), std::max(bmax.z, m.positions[i + 2])};
+        }
+    }
+    if (triangles == 0 || bmin.x > bmax.x)
+        return false;
+
+    const Vec3 center{0.5f * (bmin.x + bmax.x), 0.5f * (bmin.y + bmax.y), 0.5f * (bmin.z + bmax.z)};
+    float radius = 0.0f;
+    for (const ImpostorMesh &m : meshes)
+    {
+        for (size_t i = 0; i + 2 < m.positions.size(); i += 3)
+        {
+            const Vec3 d = sub({m.positions[i], m.positions[i + 1], m.positions[i + 2]}, center);
+            radius = std::max(radius, std::sqrt(dot(d, d)));
+        }
+    }
+    radius = std::max(radius, 1e-4f);
+
+    out.size = n * res;
+    out.albedo.assign(size_t(out.size) * out.size * 4u, 0u);
+    out.normalDepth.assign(size_t(out.size) * out.size * 4u, 0u);
+    out.center[0] = center.x;
+    out.center[1] = center.y;
+    out.center[2] = center.z;
+    out.radius = radius;
+
+    const ImpostorMaterial fallback{};
+    const sm::ImpostorMapping mapping = settings.hemisphere ? sm::ImpostorMapping::Hemisphere : sm::ImpostorMapping::Sphere;
+    FrameTarget target;
+    for (uint32_t fy = 0; fy < n; ++fy)
+    {
+        for (uint32_t fx = 0; fx < n; ++fx)
+        {
+            float d[3], r[3], u[3];
+            sm::ImpostorFrameDirection(float(fx) / float(n - 1u), float(fy) / float(n - 1u), mapping, d);
+            sm::ImpostorFrameBasis(d, r, u);
+
+            target.reset(res * SUPERSAMPLE);
+            for (const ImpostorMesh &m : meshes)
+            {
+                const ImpostorMaterial &mat = m.material < materials.size() ? materials[m.material] : fallback;
+                rasterizeMesh(m, mat, center, radius, {d[0], d[1], d[2]}, {r[0], r[1], r[2]}, {u[0], u[1], u[2]}, target);
+            }
+            resolveFrame(target, fx, fy, res, out);
+            dilateFrame(fx, fy, res, out);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// ------------------------------------------------------------
+// Offline octahedral impostor capture for the cooker (--impostor).
+//
+// BakeImpostorAtlases():
+// - software-rasterizes the model orthographically once per frame direction of an n x n
+//   octahedral grid (smodel::ImpostorFrameDirection / ImpostorFrameBasis), 2x2 supersampled
+// - writes two atlases of n x n frames: albedo (base color texture * factor, alpha coverage)
+//   and normal + depth (model-space normal, depth toward the viewer in alpha), the layout
+//   described by smodel::SModelImpostorHeader
+// - bleeds covered texels' colors into the empty ones around them, so filtering and mips
+//   don't pull black into silhouettes
+//
+// Meshes are in model space (node globals applied). Materials with alphaMode MASK or BLEND
+// cut out below alphaCutoff; OPAQUE ones cover every texel they touch.
+// ------------------------------------------------------------
+struct ImpostorMaterial
+{
+    const uint8_t *rgba = nullptr; // decoded base color texture (sRGB), nullptr = white
+    uint32_t width = 0;
+    uint32_t height = 0;
+    float baseColorFactor[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+    float alphaCutoff = 0.5f;
+    bool cutout = false;
+};
+
+struct ImpostorMesh
+{
+    std::vector<float> positions; // xyz per vertex
+    std::vector<float> normals;   // xyz per vertex
+    std::vector<float> uvs;       // uv per vertex
+    std::vector<uint32_t> indices;
+    uint32_t material = 0;        // into the materials array
+};
+
+struct ImpostorSettings
+{
+    uint32_t framesPerSide = 8;
+    uint32_t frameResolution = 128;
+    bool hemisphere = true; // smodel::ImpostorMapping::Hemisphere, else Sphere
+};
+
+struct ImpostorAtlases
+{
+    uint32_t size = 0;                 // atlas edge in pixels (framesPerSide * frameResolution)
+    std::vector<uint8_t> albedo;       // RGBA8, size x size
+    std::vector<uint8_t> normalDepth;  // RGBA8, size x size
+    float center[3] = {0.0f, 0.0f, 0.0f};
+    float radius = 0.0f;
+};
+
+// False when the meshes have no triangles.
+bool BakeImpostorAtlases(const std::vector<ImpostorMesh> &meshes, const std::vector<ImpostorMaterial> &materials,
+                         const ImpostorSettings &settings, ImpostorAtlases &out);
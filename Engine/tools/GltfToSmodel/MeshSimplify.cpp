@@ -0,0 +1,346 @@
+#include "MeshSimplify.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+namespace
+{
+    struct Vec3
+    {
+        double x, y, z;
+    };
+
+    Vec3 sub(const Vec3 &a, const Vec3 &b) { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+    Vec3 cross(const Vec3 &a, const Vec3 &b) { return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x}; }
+    double dot(const Vec3 &a, const Vec3 &b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+    // Symmetric 4x4 plane quadric (a, b, c, d): error(p) = sum (n.p + d)^2
+    struct Quadric
+    {
+        double a2 = 0, ab = 0, ac = 0, ad = 0;
+        double b2 = 0, bc = 0, bd = 0;
+        double c2 = 0, cd = 0;
+        double d2 = 0;
+
+        void addPlane(const Vec3 &n, double d, double w)
+        {
+            a2 += w * n.x * n.x;
+            ab += w * n.x * n.y;
+            ac += w * n.x * n.z;
+            ad += w * n.x * d;
+            b2 += w * n.y * n.y;
+            bc += w * n.y * n.z;
+            bd += w * n.y * d;
+            c2 += w * n.z * n.z;
+            cd += w * n.z * d;
+            d2 += w * d * d;
+        }
+
+        void add(const Quadric &q)
+        {
+            a2 += q.a2;
+            ab += q.ab;
+            ac += q.ac;
+            ad += q.ad;
+            b2 += q.b2;
+            bc += q.bc;
+            bd += q.bd;
+            c2 += q.c2;
+            cd += q.cd;
+            d2 += q.d2;
+        }
+
+        double eval(const Vec3 &p) const
+        {
+            const double e = a2 * p.x * p.x + 2 * ab * p.x * p.y + 2 * ac * p.x * p.z + 2 * ad * p.x +
+                             b2 * p.y * p.y + 2 * bc * p.y * p.z + 2 * bd * p.y +
+                             c2 * p.z * p.z + 2 * cd * p.z +
+                             d2;
+            return std::max(e, 0.0);
+        }
+    };
+
+    struct Collapse
+    {
+        uint32_t from;
+        uint32_t to;
+        double cost;
+    };
+
+    struct PositionKey
+    {
+        uint32_t bits[3];
+        bool operator==(const PositionKey &o) const { return std::memcmp(bits, o.bits, sizeof(bits)) == 0; }
+    };
+
+    struct PositionKeyHash
+    {
+        size_t operator()(const PositionKey &k) const
+        {
+            return (size_t(k.bits[0]) * 73856093u) ^ (size_t(k.bits[1]) * 19349663u) ^ (size_t(k.bits[2]) * 83492791u);
+        }
+    };
+} // namespace
+
+void SimplifyMesh(const float *positions, size_t positionStrideBytes, uint32_t vertexCount,
+                  const uint32_t *indices, uint32_t indexCount,
+                  uint32_t targetIndexCount, float maxError,
+                  std::vector<uint32_t> &outIndices)
+{
+    outIndices.assign(indices, indices + indexCount);
+    if (vertexCount == 0 || indexCount < 3 || targetIndexCount >= indexCount)
+        return;
+
+    auto positionOf = [&](uint32_t v) -> Vec3
+    {
+        const float *p = reinterpret_cast<const float *>(reinterpret_cast<const uint8_t *>(positions) + size_t(v) * positionStrideBytes);
+        return {p[0], p[1], p[2]};
+    };
+
+    // 1) Weld by position: a "class" is the set of vertices sharing one position.
+    std::vector<uint32_t> cls(vertexCount);
+    {
+        std::unordered_map<PositionKey, uint32_t, PositionKeyHash> firstAt;
+        firstAt.reserve(vertexCount);
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            const float *p = reinterpret_cast<const float *>(reinterpret_cast<const uint8_t *>(positions) + size_t(v) * positionStrideBytes);
+            PositionKey k{};
+            std::memcpy(k.bits, p, sizeof(k.bits));
+            cls[v] = firstAt.emplace(k, v).first->second;
+        }
+    }
+
+    Vec3 lo = positionOf(outIndices[0]);
+    Vec3 hi = lo;
+    for (uint32_t i = 0; i < indexCount; ++i)
+    {
+        const Vec3 p = positionOf(outIndices[i]);
+        lo = {std::min(lo.x, p.x), std::min(lo.y, p.y), std::min(lo.z, p.z)};
+        hi = {std::max(hi.x, p.x), std::max(hi.y, p.y), std::max(hi.z, p.z)};
+    }
+    const Vec3 ext = sub(hi, lo);
+    const double extent = std::sqrt(dot(ext, ext));
+    if (extent <= 0.0)
+        return;
+    const double maxCost = (double(maxError) * extent) * (double(maxError) * extent);
+
+    // 2) Quadrics per class from the incident triangle planes.
+    std::vector<Quadric> quadrics(vertexCount);
+    for (uint32_t t = 0; t + 2 < indexCount; t += 3)
+    {
+        const Vec3 p0 = positionOf(outIndices[t]);
+        const Vec3 p1 = positionOf(outIndices[t + 1]);
+        const Vec3 p2 = positionOf(outIndices[t + 2]);
+        Vec3 n = cross(sub(p1, p0), sub(p2, p0));
+        const double len = std::sqrt(dot(n, n));
+        if (len <= 1e-30)
+            continue;
+        n = {n.x / len, n.y / len, n.z / len};
+        const double d = -dot(n, p0);
+        for (uint32_t k = 0; k < 3; ++k)
+            quadrics[cls[outIndices[t + k]]].addPlane(n, d, 1.0);
+    }
+
+    // 3) Lock classes on open borders (edges used by one triangle, in class space).
+    std::vector<uint8_t> locked(vertexCount, 0u);
+    {
+        std::unordered_map<uint64_t, uint32_t> edgeUse;
+        edgeUse.reserve(indexCount);
+        for (uint32_t t = 0; t + 2 < indexCount; t += 3)
+        {
+            for (uint32_t k = 0; k < 3; ++k)
+            {
+                const uint32_t a = cls[outIndices[t + k]];
+                const uint32_t b = cls[outIndices[t + (k + 1) % 3]];
+                if (a == b)
+                    continue;
+                const uint64_t key = (uint64_t(std::min(a, b)) << 32) | std::max(a, b);
+                edgeUse[key] += 1u;
+            }
+        }
+        for (const auto &kv : edgeUse)
+        {
+            if (kv.second != 1u)
+                continue;
+            locked[uint32_t(kv.first >> 32)] = 1u;
+            locked[uint32_t(kv.first & 0xFFFFFFFFu)] = 1u;
+        }
+    }
+
+    std::vector<uint32_t> triStart(vertexCount + 1);
+    std::vector<uint32_t> triList;
+    std::vector<Collapse> candidates;
+    std::vector<uint32_t> collapseTo(vertexCount);
+    std::vector<uint8_t> touched(vertexCount);
+    std::vector<uint32_t> vertexTarget(vertexCount);
+    std::vector<uint32_t> next;
+
+    const uint32_t targetTris = targetIndexCount / 3u;
+
+    for (int pass = 0; pass < 64; ++pass)
+    {
+        const uint32_t triCount = static_cast<uint32_t>(outIndices.size() / 3u);
+        if (triCount <= targetTris)
+            break;
+
+        // Class -> incident triangles (CSR), rebuilt each pass.
+        std::fill(triStart.begin(), triStart.end(), 0u);
+        for (uint32_t i = 0; i < triCount * 3u; ++i)
+            triStart[cls[outIndices[i]] + 1u] += 1u;
+        for (uint32_t v = 0; v < vertexCount; ++v)
+            triStart[v + 1u] += triStart[v];
+        triList.resize(triCount * 3u);
+        {
+            std::vector<uint32_t> fill(triStart.begin(), triStart.end() - 1);
+            for (uint32_t t = 0; t < triCount; ++t)
+                for (uint32_t k = 0; k < 3; ++k)
+                    triList[fill[cls[outIndices[t * 3u + k]]]++] = t;
+        }
+
+        // Candidate collapses along every class edge, cheapest direction first.
+        candidates.clear();
+        for (uint32_t t = 0; t < triCount; ++t)
+        {
+            for (uint32_t k = 0; k < 3; ++k)
+            {
+                const uint32_t a = cls[outIndices[t * 3u + k]];
+                const uint32_t b = cls[outIndices[t * 3u + (k + 1) % 3]];
+                if (a >= b)
+                    continue; // consistent winding visits each interior edge once with a < b
+
+                Quadric q = quadrics[a];
+                q.add(quadrics[b]);
+                const double costAB = locked[a] ? HUGE_VAL : q.eval(positionOf(b));
+                const double costBA = locked[b] ? HUGE_VAL : q.eval(positionOf(a));
+                if (costAB == HUGE_VAL && costBA == HUGE_VAL)
+                    continue;
+                if (costAB <= costBA)
+                    candidates.push_back({a, b, costAB});
+                else
+                    candidates.push_back({b, a, costBA});
+            }
+        }
+        if (candidates.empty())
+            break;
+        std::sort(candidates.begin(), candidates.end(), [](const Collapse &x, const Collapse &y)
+                  { return x.cost < y.cost; });
+
+        for (uint32_t v = 0; v < vertexCount; ++v)
+            collapseTo[v] = v;
+        std::fill(touched.begin(), touched.end(), uint8_t(0));
+
+        // Each collapse removes about two triangles; leave the rest for later passes so
+        // costs get re-evaluated against the simplified surface.
+        const uint32_t wanted = std::max<uint32_t>((triCount - targetTris) / 2u, 1u);
+        const uint32_t budget = std::max<uint32_t>(wanted / 2u + 1u, 1u);
+        uint32_t accepted = 0;
+
+        for (const Collapse &c : candidates)
+        {
+            if (accepted >= budget || c.cost > maxCost)
+                break;
+            if (touched[c.from] || touched[c.to])
+                continue;
+
+            // Reject if any triangle around 'from' (not shared with 'to') would flip.
+            const Vec3 target = positionOf(c.to);
+            bool flips = false;
+            for (uint32_t i = triStart[c.from]; i < triStart[c.from + 1u] && !flips; ++i)
+            {
+                const uint32_t t = triList[i];
+                const uint32_t ca[3] = {cls[outIndices[t * 3u]], cls[outIndices[t * 3u + 1u]], cls[outIndices[t * 3u + 2u]]};
+                if (ca[0] == c.to || ca[1] == c.to || ca[2] == c.to)
+                    continue;
+
+                Vec3 p[3] = {positionOf(ca[0]), positionOf(ca[1]), positionOf(ca[2])};
+                const Vec3 before = cross(sub(p[1], p[0]), sub(p[2], p[0]));
+                for (uint32_t k = 0; k < 3; ++k)
+                    if (ca[k] == c.from)
+                        p[k] = target;
+                const Vec3 after = cross(sub(p[1], p[0]), sub(p[2], p[0]));
+                if (dot(before, after) <= 0.0)
+                    flips = true;
+            }
+            if (flips)
+                continue;
+
+            collapseTo[c.from] = c.to;
+            accepted += 1u;
+
+            // Neighbours of both ends keep their geometry for the rest of this pass.
+            for (uint32_t end : {c.from, c.to})
+            {
+                for (uint32_t i = triStart[end]; i < triStart[end + 1u]; ++i)
+                {
+                    const uint32_t t = triList[i];
+                    for (uint32_t k = 0; k < 3; ++k)
+                        touched[cls[outIndices[t * 3u + k]]] = 1u;
+                }
+            }
+        }
+
+        if (accepted == 0)
+            break;
+
+        // Pick each collapsed vertex's replacement: prefer a vertex of the target class it
+        // already shares a triangle with (same side of a UV seam), else the class itself.
+        for (uint32_t v = 0; v < vertexCount; ++v)
+            vertexTarget[v] = v;
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            const uint32_t a = cls[v];
+            if (collapseTo[a] == a)
+                continue;
+            const uint32_t b = collapseTo[a];
+            uint32_t pick = b;
+            for (uint32_t i = triStart[a]; i < triStart[a + 1u] && pick == b; ++i)
+            {
+                const uint32_t t = triList[i];
+                const uint32_t *tri = &outIndices[t * 3u];
+                if (tri[0] != v && tri[1] != v && tri[2] != v)
+                    continue;
+                for (uint32_t k = 0; k < 3; ++k)
+                {
+                    if (cls[tri[k]] == b)
+                    {
+                        pick = tri[k];
+                        break;
+                    }
+                }
+            }
+            vertexTarget[v] = pick;
+        }
+
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            const uint32_t a = cls[v];
+            if (collapseTo[a] != a && a == v)
+                quadrics[collapseTo[a]].add(quadrics[a]);
+        }
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            const uint32_t a = cls[v];
+            if (collapseTo[a] != a)
+                cls[v] = collapseTo[a];
+        }
+
+        // Rewrite triangles; drop the ones that became degenerate.
+        next.clear();
+        next.reserve(outIndices.size());
+        for (uint32_t t = 0; t < triCount; ++t)
+        {
+            const uint32_t i0 = vertexTarget[outIndices[t * 3u]];
+            const uint32_t i1 = vertexTarget[outIndices[t * 3u + 1u]];
+            const uint32_t i2 = vertexTarget[outIndices[t * 3u + 2u]];
+            if (cls[i0] == cls[i1] || cls[i1] == cls[i2] || cls[i0] == cls[i2])
+                continue;
+            next.push_back(i0);
+            next.push_back(i1);
+            next.push_back(i2);
+        }
+        outIndices.swap(next);
+    }
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ------------------------------------------------------------
+// Offline mesh simplification for the cooker's LOD chains.
+//
+// SimplifyMesh():
+// - collapses edges onto existing vertices (half-edge collapse), so every LOD level keeps
+//   indexing the LOD 0 vertex buffer
+// - picks the cheapest collapses by quadric error, in independent batches per pass
+// - welds vertices by position first, so UV/normal seams collapse together instead of
+//   tearing apart; open borders are kept in place
+// - rejects collapses that would flip a triangle
+//
+// maxError is relative to the mesh's AABB diagonal; simplification stops early when the
+// next collapse would exceed it. Returns the simplified index list (may be larger than
+// targetIndexCount when the error bound is hit first).
+// ------------------------------------------------------------
+void SimplifyMesh(const float *positions, size_t positionStrideBytes, uint32_t vertexCount,
+                  const uint32_t *indices, uint32_t indexCount,
+                  uint32_t targetIndexCount, float maxError,
+                  std::vector<uint32_t> &outIndices);
@@ -0,0 +1,366 @@
+#include "TextureCompress.h"
+
+#include "assets/ModelFormat.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// ------------------------------------------------------------
+// BC7 mode 6 encoder
+// ------------------------------------------------------------
+// Mode 6 is a single-subset mode: two RGBA endpoints (7 bits per channel + a shared p-bit
+// per endpoint) and a 4-bit index per pixel. It handles opaque and alpha textures alike and
+// is the usual choice for a small, dependency-free encoder.
+//
+// Endpoints start at the extremes of the block's principal axis and are refined with a few
+// least-squares passes over the chosen indices.
+// ------------------------------------------------------------
+static const int kWeights4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+struct Endpoint
+{
+    int q[4] = {0, 0, 0, 0}; // 7-bit channel values
+    int p = 0;               // p-bit
+};
+
+static int Expand(const Endpoint &e, int c)
+{
+    return (e.q[c] << 1) | e.p;
+}
+
+static Endpoint QuantizeEndpoint(const float v[4])
+{
+    Endpoint best{};
+    float bestErr = 1e30f;
+    for (int p = 0; p < 2; ++p)
+    {
+        Endpoint e{};
+        e.p = p;
+        float err = 0.0f;
+        for (int c = 0; c < 4; ++c)
+        {
+            const float x = std::min(255.0f, std::max(0.0f, v[c]));
+            const int q = std::min(127, std::max(0, static_cast<int>(std::lround((x - float(p)) * 0.5f))));
+            e.q[c] = q;
+            const float d = float((q << 1) | p) - x;
+            err += d * d;
+        }
+        if (err < bestErr)
+        {
+            bestErr = err;
+            best = e;
+        }
+    }
+    return best;
+}
+
+// Picks the nearest palette entry per pixel; returns the summed squared error.
+static uint32_t AssignIndices(const uint8_t px[64], const Endpoint &e0, const Endpoint &e1, uint8_t outIdx[16])
+{
+    int pal[16][4];
+    for (int i = 0; i < 16; ++i)
+    {
+        const int w = kWeights4[i];
+        for (int c = 0; c < 4; ++c)
+            pal[i][c] = ((64 - w) * Expand(e0, c) + w * Expand(e1, c) + 32) >> 6;
+    }
+
+    uint32_t total = 0;
+    for (int p = 0; p < 16; ++p)
+    {
+        const uint8_t *s = px + p * 4;
+        uint32_t bestErr = UINT32_MAX;
+        uint8_t bestIdx = 0;
+        for (int i = 0; i < 16; ++i)
+        {
+            uint32_t err = 0;
+            for (int c = 0; c < 4; ++c)
+            {
+                const int d = pal[i][c] - int(s[c]);
+                err += uint32_t(d * d);
+            }
+            if (err < bestErr)
+            {
+                bestErr = err;
+                bestIdx = uint8_t(i);
+            }
+        }
+        outIdx[p] = bestIdx;
+        total += bestErr;
+    }
+    return total;
+}
+
+struct BitWriter
+{
+    uint8_t *out;
+    uint32_t pos = 0;
+
+    void put(uint32_t value, uint32_t count)
+    {
+        for (uint32_t i = 0; i < count; ++i, ++pos)
+        {
+            if ((value >> i) & 1u)
+                out[pos >> 3] |= uint8_t(1u << (pos & 7u));
+        }
+    }
+};
+
+static void PrincipalAxisEndpoints(const uint8_t px[64], float outE0[4], float outE1[4])
+{
+    float mean[4] = {0, 0, 0, 0};
+    for (int p = 0; p < 16; ++p)
+        for (int c = 0; c < 4; ++c)
+            mean[c] += float(px[p * 4 + c]);
+    for (int c = 0; c < 4; ++c)
+        mean[c] *= (1.0f / 16.0f);
+
+    float cov[4][4] = {};
+    for (int p = 0; p < 16; ++p)
+    {
+        float d[4];
+        for (int c = 0; c < 4; ++c)
+            d[c] = float(px[p * 4 + c]) - mean[c];
+        for (int a = 0; a < 4; ++a)
+            for (int b = 0; b < 4; ++b)
+                cov[a][b] += d[a] * d[b];
+    }
+
+    // Power iteration, seeded with the channel of largest variance.
+    float axis[4] = {0, 0, 0, 0};
+    int seed = 0;
+    for (int c = 1; c < 4; ++c)
+        if (cov[c][c] > cov[seed][seed])
+            seed = c;
+    axis[seed] = 1.0f;
+
+    for (int it = 0; it < 8; ++it)
+    {
+        float n[4] = {0, 0, 0, 0};
+        for (int a = 0; a < 4; ++a)
+            for (int b = 0; b < 4; ++b)
+                n[a] += cov[a][b] * axis[b];
+        const float len = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2] + n[3] * n[3]);
+        if (len < 1e-6f)
+            break;
+        for (int c = 0; c < 4; ++c)
+            axis[c] = n[c] / len;
+    }
+
+    float tMin = 0.0f, tMax = 0.0f;
+    for (int p = 0; p < 16; ++p)
+    {
+        float t = 0.0f;
+        for (int c = 0; c < 4; ++c)
+            t += (float(px[p * 4 + c]) - mean[c]) * axis[c];
+        tMin = std::min(tMin, t);
+        tMax = std::max(tMax, t);
+    }
+
+    for (int c = 0; c < 4; ++c)
+    {
+        outE0[c] = mean[c] + axis[c] * tMin;
+        outE1[c] = mean[c] + axis[c] * tMax;
+    }
+}
+
+// Least-squares endpoints for fixed indices. Returns false when the system is degenerate.
+static bool RefineEndpoints(const uint8_t px[64], const uint8_t idx[16], float outE0[4], float outE1[4])
+{
+    float a = 0.0f, b = 0.0f, c = 0.0f;
+    float x0[4] = {0, 0, 0, 0}, x1[4] = {0, 0, 0, 0};
+    for (int p = 0; p < 16; ++p)
+    {
+        const float w = float(kWeights4[idx[p]]) / 64.0f;
+        const float iw = 1.0f - w;
+        a += iw * iw;
+        b += iw * w;
+        c += w * w;
+        for (int ch = 0; ch < 4; ++ch)
+        {
+            x0[ch] += iw * float(px[p * 4 + ch]);
+            x1[ch] += w * float(px[p * 4 + ch]);
+        }
+    }
+
+    const float det = a * c - b * b;
+    if (std::fabs(det) < 1e-6f)
+        return false;
+
+    const float inv = 1.0f / det;
+    for (int ch = 0; ch < 4; ++ch)
+    {
+        outE0[ch] = (c * x0[ch] - b * x1[ch]) * inv;
+        outE1[ch] = (a * x1[ch] - b * x0[ch]) * inv;
+    }
+    return true;
+}
+
+// ------------------------------------------------------------
+// sRGB helpers (mip filtering only)
+// ------------------------------------------------------------
+static float SrgbToLinear(float s)
+{
+    return (s <= 0.04045f) ? (s / 12.92f) : std::pow((s + 0.055f) / 1.055f, 2.4f);
+}
+
+static float LinearToSrgb(float l)
+{
+    return (l <= 0.0031308f) ? (l * 12.92f) : (1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f);
+}
+
+static void Downsample(const std::vector<uint8_t> &src, uint32_t w, uint32_t h,
+                       std::vector<uint8_t> &dst, uint32_t dw, uint32_t dh,
+                       bool srgb, const float *toLinear)
+{
+    dst.resize(size_t(dw) * dh * 4u);
+    for (uint32_t y = 0; y < dh; ++y)
+    {
+        const uint32_t y0 = std::min(2 * y, h - 1);
+        const uint32_t y1 = std::min(2 * y + 1, h - 1);
+        for (uint32_t x = 0; x < dw; ++x)
+        {
+            const uint32_t x0 = std::min(2 * x, w - 1);
+            const uint32_t x1 = std::min(2 * x + 1, w - 1);
+            const uint8_t *s[4] = {
+                &src[(size_t(y0) * w + x0) * 4u],
+                &src[(size_t(y0) * w + x1) * 4u],
+                &src[(size_t(y1) * w + x0) * 4u],
+                &src[(size_t(y1) * w + x1) * 4u]};
+
+            uint8_t *d = &dst[(size_t(y) * dw + x) * 4u];
+            for (int c = 0; c < 4; ++c)
+            {
+                if (srgb && c < 3)
+                {
+                    const float l = 0.25f * (toLinear[s[0][c]] + toLinear[s[1][c]] + toLinear[s[2][c]] + toLinear[s[3][c]]);
+                    d[c] = uint8_t(std::lround(std::min(1.0f, std::max(0.0f, LinearToSrgb(l))) * 255.0f));
+                }
+                else
+                {
+                    d[c] = uint8_t((uint32_t(s[0][c]) + s[1][c] + s[2][c] + s[3][c] + 2u) >> 2);
+                }
+            }
+        }
+    }
+}
+
+static void EncodeLevel(const std::vector<uint8_t> &px, uint32_t w, uint32_t h, uint8_t *out)
+{
+    const uint32_t bw = (w + 3) / 4;
+    const uint32_t bh = (h + 3) / 4;
+    uint8_t block[64];
+    for (uint32_t by = 0; by < bh; ++by)
+    {
+        for (uint32_t bx = 0; bx < bw; ++bx)
+        {
+            // Edge blocks repeat the last row/column.
+            for (uint32_t py = 0; py < 4; ++py)
+            {
+                const uint32_t sy = std::min(by * 4 + py, h - 1);
+                for (uint32_t pxi = 0; pxi < 4; ++pxi)
+                {
+                    const uint32_t sx = std::min(bx * 4 + pxi, w - 1);
+                    std::memcpy(&block[(py * 4 + pxi) * 4], &px[(size_t(sy) * w + sx) * 4u], 4);
+                }
+            }
+            EncodeBC7Block(block, out + (size_t(by) * bw + bx) * 16u);
+        }
+    }
+}
+
+void EncodeBC7Block(const uint8_t pixels[64], uint8_t outBlock[16])
+{
+    float f0[4], f1[4];
+    PrincipalAxisEndpoints(pixels, f0, f1);
+
+    Endpoint e0 = QuantizeEndpoint(f0);
+    Endpoint e1 = QuantizeEndpoint(f1);
+    uint8_t idx[16];
+    uint32_t err = AssignIndices(pixels, e0, e1, idx);
+
+    for (int pass = 0; pass < 2 && err > 0; ++pass)
+    {
+        float r0[4], r1[4];
+        if (!RefineEndpoints(pixels, idx, r0, r1))
+            break;
+
+        const Endpoint n0 = QuantizeEndpoint(r0);
+        const Endpoint n1 = QuantizeEndpoint(r1);
+        uint8_t nIdx[16];
+        const uint32_t nErr = AssignIndices(pixels, n0, n1, nIdx);
+        if (nErr >= err)
+            break;
+
+        e0 = n0;
+        e1 = n1;
+        err = nErr;
+        std::memcpy(idx, nIdx, sizeof(idx));
+    }
+
+    // The anchor (pixel 0) index is stored with its top bit implied zero.
+    if (idx[0] & 8u)
+    {
+        std::swap(e0, e1);
+        for (uint8_t &i : idx)
+            i = uint8_t(15u - i);
+    }
+
+    std::memset(outBlock, 0, 16);
+    BitWriter bw{outBlock};
+    bw.put(1u << 6, 7); // mode 6
+    for (int c = 0; c < 4; ++c)
+    {
+        bw.put(uint32_t(e0.q[c]), 7);
+        bw.put(uint32_t(e1.q[c]), 7);
+    }
+    bw.put(uint32_t(e0.p), 1);
+    bw.put(uint32_t(e1.p), 1);
+    bw.put(idx[0], 3);
+    for (int p = 1; p < 16; ++p)
+        bw.put(idx[p], 4);
+}
+
+bool BuildBC7MipChain(const uint8_t *rgba, uint32_t width, uint32_t height, bool srgb, CompressedMipChain &out)
+{
+    out = CompressedMipChain{};
+    if (!rgba || width == 0 || height == 0)
+        return false;
+
+    uint32_t levels = 1;
+    for (uint32_t d = std::max(width, height); d > 1; d >>= 1)
+        ++levels;
+
+    out.width = width;
+    out.height = height;
+    out.mipLevels = levels;
+    out.bytes.resize(static_cast<size_t>(Engine::smodel::BlockCompressedMipChainBytes(width, height, levels)));
+
+    float toLinear[256];
+    for (int i = 0; i < 256; ++i)
+        toLinear[i] = SrgbToLinear(float(i) / 255.0f);
+
+    std::vector<uint8_t> cur(rgba, rgba + size_t(width) * height * 4u);
+    std::vector<uint8_t> next;
+    uint32_t w = width, h = height;
+    size_t offset = 0;
+
+    for (uint32_t level = 0; level < levels; ++level)
+    {
+        EncodeLevel(cur, w, h, out.bytes.data() + offset);
+        offset += static_cast<size_t>(Engine::smodel::BlockCompressedMipChainBytes(w, h, 1));
+
+        if (level + 1 < levels)
+        {
+            const uint32_t nw = std::max(1u, w >> 1);
+            const uint32_t nh = std::max(1u, h >> 1);
+            Downsample(cur, w, h, next, nw, nh, srgb, toLinear);
+            cur.swap(next);
+            w = nw;
+            h = nh;
+        }
+    }
+
+    return true;
+}
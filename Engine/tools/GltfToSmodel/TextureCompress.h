@@ -0,0 +1,28 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// ------------------------------------------------------------
+// Offline texture compression for the cooker.
+//
+// BuildBC7MipChain():
+// - builds a full mip chain from RGBA8 pixels (2x2 box filter, done in linear space
+//   for sRGB color textures so mips do not darken)
+// - encodes every level as BC7 (4x4 blocks, 16 bytes each, mode 6)
+// - writes levels back to back, mip 0 first, blocks row-major
+//
+// The byte layout matches smodel::BlockCompressedMipChainBytes() so the runtime can
+// copy each level straight into its VkImage mip.
+// ------------------------------------------------------------
+struct CompressedMipChain
+{
+    std::vector<uint8_t> bytes;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t mipLevels = 0;
+};
+
+bool BuildBC7MipChain(const uint8_t *rgba, uint32_t width, uint32_t height, bool srgb, CompressedMipChain &out);
+
+// Encode one 4x4 RGBA8 block (64 bytes, row-major) into 16 bytes of BC7.
+void EncodeBC7Block(const uint8_t pixels[64], uint8_t outBlock[16]);
@@ -2,6 +2,7 @@
 #include "tiny_obj_loader.h"
 
 #include "assets/MeshFormats.h" // reuse SMeshHeaderV0
+#include "assets/MeshOptimizer.h"
 
 #include <cstdint>
 #include <cstdio>
@@ -203,6 +204,14 @@ static bool convertObjToSMesh(const fs::path &objPath, const fs::path &outPath)
         return false;
     }
 
+    // Vertex cache / overdraw / fetch order (positions lead each vertex): the loader keeps
+    // the file's order as is.
+    {
+        std::vector<uint32_t> list = std::move(indices);
+        Engine::OptimizeMesh(reinterpret_cast<uint8_t *>(vertices.data()), vertices.size(), sizeof(VertexPNUT), &list, 1);
+        indices = std::move(list);
+    }
+
     // Normalize positions into a stable [-1, 1] range so the runtime shader can
     // use inPosition directly as clip-space without a camera/model matrix.
     // We center the mesh on its AABB center and scale by the largest half-extent.
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Engine::ECS
+{
+    struct ECSContext;
+    class SystemScheduler;
+}
+
+namespace Sample
+{
+    class SystemRunner;
+
+    // Scripted SampleApp run (SampleApp --benchmark script.json): a fixed scenario and seed, the
+    // camera on a spline through recorded keys, unit orders at fixed times, then frame-time
+    // percentiles, per-pass GPU timings and per-system CPU timings written to a results file.
+    //
+    // Script (JSON, times in seconds of benchmark time):
+    //   { "scenario": "BattleConfig.json", "seed": 1, "simulationHz": 30, "frameSeconds": 0.01667,
+    //     "warmupSeconds": 2, "durationSeconds": 60, "out": "benchmark_results.json",
+    //     "camera": [ { "t": 0, "focus": [x, z], "yaw": -45, "pitch": -55, "height": 120 }, ... ],
+    //     "orders": [ { "t": 5, "type": "move", "team": 0, "x": 10, "z": -40 },
+    //                 { "t": 20, "type": "battle", "x": 0, "z": 0 } ] }
+    //
+    // Benchmark time advances by frameSeconds per frame, not by wall time: every run simulates the
+    // same ticks, sees the same camera and issues the same orders on the same frame, so only the
+    // measured times differ between machines. Simulation runs in lockstep with the script's seed.
+    class FlythroughBenchmark
+    {
+    public:
+        struct CameraKey
+        {
+            float time = 0.0f;
+            float focusX = 0.0f, focusZ = 0.0f;
+            float yawDeg = -45.0f;
+            float pitchDeg = -55.0f;
+            float height = 120.0f;
+        };
+
+        struct Order
+        {
+            enum class Type : uint8_t
+            {
+                Move,       // the team's living units become the selection and move to x/z
+                StartBattle // SystemRunner::StartBattle(x, z)
+            };
+
+            float time = 0.0f;
+            Type type = Type::Move;
+            int team = 0;
+            float x = 0.0f, z = 0.0f;
+        };
+
+        struct Script
+        {
+            std::string scenario = "BattleConfig.json";
+            std::string outPath = "benchmark_results.json";
+            uint32_t seed = 1;
+            float simulationHz = 30.0f;
+            float frameSeconds = 1.0f / 60.0f;
+            float warmupSeconds = 2.0f; // streaming, first paths, lazy queries; not measured
+            float durationSeconds = 60.0f;
+            std::vector<CameraKey> camera; // ascending time
+            std::vector<Order> orders;     // ascending time
+        };
+
+        bool load(const std::string &path, std::string &outError);
+        const Script &script() const { return m_script; }
+
+        // Benchmark time of the current frame.
+        float time() const { return static_cast<float>(m_frame) * m_script.frameSeconds; }
+        bool measuring() const { return time() >= m_script.warmupSeconds; }
+        bool finished() const { return time() >= m_script.warmupSeconds + m_script.durationSeconds; }
+
+        // Catmull-Rom through the keys, clamped to the first/last; false without keys.
+        bool cameraAt(float t, CameraKey &out) const;
+
+        // Orders due by time(), in script order; call once per frame before the next Simulate.
+        void issueDueOrders(Engine::ECS::ECSContext &ecs, SystemRunner &systems);
+
+        // Samples of the frame just finished (only kept while measuring()).
+        void recordFrame(float frameMs);
+        void recordGpuPass(const char *name, float ms);
+        // Last run of every system in the scheduler (Config::recordTimings).
+        void recordSystems(const Engine::ECS::SystemScheduler &scheduler, bool simulation);
+
+        void advanceFrame() { ++m_frame; }
+
+        // Results JSON to script().outPath; checksum is the simulation's last lockstep checksum.
+        bool writeResults(uint32_t simulationTicks, uint64_t checksum, std::string &outError) const;
+
+    private:
+        struct Series
+        {
+            std::string name;
+            std::vector<float> ms;
+        };
+        static Series &seriesFor(std::vector<Series> &list, const char *name);
+
+        Script m_script;
+        std::string m_scriptPath;
+        uint32_t m_frame = 0;
+        size_t m_orderCursor = 0;
+
+        std::vector<float> m_frameMs;
+        std::vector<Series> m_gpuPasses;
+        std::vector<Series> m_simSystems;
+        std::vector<Series> m_frameSystems;
+    };
+}
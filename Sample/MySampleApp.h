@@ -2,37 +2,61 @@
 
 #include "Engine/Application.h"
 #include "Engine/Camera.h"
+#include "Engine/TerrainHeightfield.h"
 
 #include "update.h"
+#include "FlythroughBenchmark.h"
 
 #include "assets/Handles.h"
 
 #include <glm/glm.hpp>
 
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace Engine
 {
     class AssetManager;
-    class GroundPlaneRenderPassModule;
+    class TerrainRenderPassModule;
+    class ParticleRenderPassModule;
+    struct TelemetryConfig;
 }
 
 class MySampleApp : public Engine::Application
 {
 public:
-    MySampleApp();
+    // benchmarkScript: run the scripted flythrough (Sample::FlythroughBenchmark), write its
+    // results and quit; empty for normal play.
+    explicit MySampleApp(const std::string &benchmarkScript = {});
     ~MySampleApp() override;
 
+    // PerformanceMonitor telemetry including per-system timings of both schedules.
+    bool StartTelemetry(const Engine::TelemetryConfig &config);
+
     void Close() override;
     void OnUpdate(Engine::TimeStep ts) override;
     void OnRender() override;
+    void OnSimulate(Engine::TimeStep ts) override;
 
 private:
+    // Files read on the JobSystem while the window and device are created (prefab JSON, terrain).
+    struct StartupPreload;
+    MySampleApp(const std::string &benchmarkScript, std::shared_ptr<StartupPreload> preload);
+
     void setupECSFromPrefabs();
     void OnEvent(const std::string &name);
     void ApplyRTSCamera(float aspect);
+    // Pans the RTS focus by the cursor delta since the last call (LMB drag).
+    void UpdateRTSPan();
     void PickAndSelectEntityAtCursor();
+    // Selects the player's units whose origins project inside the screen rectangle (RMB drag).
+    void SelectEntitiesInScreenRect(glm::vec2 p0, glm::vec2 p1);
+    // X/Z bounds on the ground of everything that can project into the screen rectangle
+    // (pixels); false when the rectangle does not reach the ground.
+    bool ComputeScreenRectFootprint(glm::vec2 p0, glm::vec2 p1, glm::vec2 &outLo, glm::vec2 &outHi);
+    // Benchmark frame: samples the last frame, issues due orders, moves the camera along the spline.
+    void UpdateBenchmark(Engine::TimeStep ts);
 
 private:
     struct RTSCameraController
@@ -55,24 +79,49 @@ private:
     };
 
     std::unique_ptr<Engine::AssetManager> m_assets;
+
+    // Filled by the startup jobs; released once setup has consumed it.
+    std::shared_ptr<StartupPreload> m_preload;
+
+    // Prefabs whose models are still streaming in (bounds are refreshed once resident).
+    std::vector<std::string> m_streamingPrefabs;
+
     RTSCameraController m_rtsCam;
     glm::vec2 m_lastMouse{0.0f, 0.0f};
     bool m_isPanning = false;
     bool m_panJustStarted = false;
+    glm::vec2 m_boxSelectStart{0.0f, 0.0f};
+    bool m_boxSelectPending = false; // RMB held: click or box, decided on release
     float m_scrollDelta = 0.0f;
     Engine::Camera m_camera;
 
-    // Simple background ground plane
+    // Terrain (ground texture as layer 0)
     Engine::TextureHandle m_groundTexture;
-    std::shared_ptr<Engine::GroundPlaneRenderPassModule> m_groundPass;
+    Engine::TerrainHeightfield m_terrain;
+    std::shared_ptr<Engine::TerrainRenderPassModule> m_groundPass;
+
+    // Combat effects; CombatSystem pushes into its spawn ring.
+    std::shared_ptr<Engine::ParticleRenderPassModule> m_particlePass;
 
     Sample::SystemRunner m_systems;
 
+    // Scenario spawned at startup (spawn groups, combat config, start zone).
+    std::string m_scenarioPath = "BattleConfig.json";
+
+    // Scripted benchmark run (--benchmark); null in normal play. Mouse camera and selection are
+    // ignored while it runs.
+    std::unique_ptr<Sample::FlythroughBenchmark> m_benchmark;
+    uint32_t m_benchmarkLastTick = 0;
+
     // True once a new game is started or a save is loaded.
     bool m_inGame = true;
 
     // Small save slot filename
     std::string m_saveFilePath = "sample_save.json";
+    // Binary world (entities + nav grid) saved next to it (F5 save, F9 load)
+    std::string m_worldSnapshotPath = "sample_world.snapshot";
+    // Models the loaded snapshot references (released when the next one replaces it)
+    std::vector<Engine::ModelHandle> m_snapshotModelRefs;
 
     // Start zone: click here to start the battle
     float m_startZoneX = 0.0f;
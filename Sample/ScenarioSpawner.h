@@ -1,5 +1,7 @@
 #pragma once
 
+#include "systems/CombatSystem.h"
+
 #include <cstdint>
 #include <string>
 
@@ -10,7 +12,32 @@ namespace Engine::ECS
 
 namespace Sample
 {
-    // Spawns entities described in the scenario JSON.
-    // Returns total number of spawned entities.
-    uint32_t SpawnFromScenarioFile(Engine::ECS::ECSContext &ecs, const std::string &scenarioPath, bool selectSpawned = true);
+    // Spawns entities described in the scenario JSON, or in a scenario compiled by
+    // CompileScenarioFile (recognized by its magic).
+    // The JSON is streamed: each obstacle and spawn group is spawned as it is parsed and then
+    // dropped, so large scenarios never exist as a whole document. A file that breaks part-way
+    // keeps what was spawned before the error.
+    // targetUnitCount > 0 resizes the groups of moving units (prefabs with Velocity) proportionally
+    // so they total that many; obstacles and static groups are spawned as authored. Resizing holds
+    // the groups back until the whole file is read.
+    // Returns the number of units spawned by spawn groups (obstacles not included).
+    uint32_t SpawnFromScenarioFile(Engine::ECS::ECSContext &ecs, const std::string &scenarioPath, bool selectSpawned = true,
+                                   uint32_t targetUnitCount = 0);
+
+    // Writes scenarioPath (JSON) to outPath as a compiled scenario: anchors resolved, records in
+    // file order, read back without a JSON parser. Prefabs are still looked up by name at load
+    // time. Returns false and removes outPath on a read, parse or write error.
+    bool CompileScenarioFile(const std::string &scenarioPath, const std::string &outPath);
+
+    // Reads the "combat" object of a battle config (BattleConfig.json) over cfg.
+    // Returns false and leaves cfg untouched when the file or object is missing or malformed.
+    bool LoadCombatConfigFile(const std::string &path, CombatSystem::CombatConfig &cfg);
+
+    // Loads every *.json prefab in dir, in file name order, without an AssetManager (headless
+    // runs: EcsBench, SampleServer). Returns the number of prefabs added to ecs.prefabs.
+    uint32_t LoadPrefabsHeadless(Engine::ECS::ECSContext &ecs, const std::string &dir);
+
+    // Where both armies charge when a battle starts without a click: the battle config's
+    // "startZone", or else the centroid of all team units.
+    void BattleStartPoint(const Engine::ECS::ECSContext &ecs, const std::string &battleConfigPath, float &x, float &z);
 }
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "ECS/Entity.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Sample
+{
+    // Player input applied at a simulation tick boundary (see SystemRunner::EnableLockstep).
+    struct SimCommand
+    {
+        enum class Type : uint8_t
+        {
+            MoveSelected = 1, // units get Selected (and nothing else does), then CommandSystem orders them to x/y/z
+            StartBattle = 2,  // CombatSystem::startBattle(x, z): both armies charge the point
+        };
+
+        uint32_t tick = 0; // applied before this tick runs
+        Type type = Type::MoveSelected;
+        float x = 0.0f, y = 0.0f, z = 0.0f;
+        std::vector<Engine::ECS::Entity> units; // MoveSelected, sorted by index
+    };
+
+    // Everything a lockstep peer or a replay needs besides the starting world: the settings that
+    // make the simulation deterministic, the player's commands by tick, and the state checksum
+    // (Engine::ECS::simulationChecksum) after every checksumInterval-th tick.
+    struct SimulationLog
+    {
+        uint32_t seed = 1;
+        float stepSeconds = 1.0f / 30.0f;
+        int32_t humanTeam = -1; // CombatSystem::setHumanTeam
+        uint32_t checksumInterval = 1;
+        std::string scenario; // informational: the scenario the run started from
+
+        std::vector<SimCommand> commands; // ascending tick
+        std::vector<uint64_t> checksums;  // [i]: after tick (i + 1) * checksumInterval - 1
+        uint32_t ticks = 0;               // ticks simulated while recording
+
+        void clearRecording()
+        {
+            commands.clear();
+            checksums.clear();
+            ticks = 0;
+        }
+
+        // JSON, checksums as hex strings.
+        bool save(const std::string &path, std::string &outError) const;
+        bool load(const std::string &path, std::string &outError);
+    };
+}
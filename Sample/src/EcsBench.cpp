@@ -0,0 +1,513 @@
+// EcsBench: headless, fixed-seed run of the Sample simulation schedule.
+//
+// Loads the prefabs in entities/ without GPU assets, spawns a scenario (optionally resized to
+// --units moving units), runs --ticks fixed steps of SystemRunner's simulation schedule and
+// prints per-system timings as JSON. No window, Vulkan instance or device is created.
+//
+//   EcsBench [--scenario BattleConfig.json] [--battle-config BattleConfig.json] [--entities dir]
+//            [--units 10000] [--ticks 600] [--warmup 30] [--seed 1] [--threads N] [--hz 30]
+//            [--no-battle] [--out result.json] [--record log.json] [--replay log.json]
+//            [--compile-scenario out.scnb] [--tick-budget-ms N] [--jps] [--sim-lod R]
+//            [--reorder S]
+//
+// --record runs in lockstep mode (SystemRunner::EnableLockstep, warmup included) and writes the
+// per-tick checksums. --replay plays a recorded log (its seed, tick and commands) from tick 0 for
+// as many ticks as it holds and reports the first tick whose checksum differs, e.g. to check
+// that a run gives the same result at another --threads count. --compile-scenario writes the
+// --scenario file as a compiled scenario (Sample::CompileScenarioFile) and exits; --scenario
+// accepts the result in place of the JSON. --tick-budget-ms throttles the amortized systems to
+// that much CPU time per tick (SystemRunner::SetCpuBudget; timing-dependent, off in lockstep).
+// --jps plans with Jump Point Search instead of A* (give it to --replay too for a log recorded
+// with it). --sim-lod keeps full fidelity within R world units of the origin and runs the rest
+// in the simulation LOD's far tier (SystemRunner::SetSimulationLod; off in lockstep).
+// --reorder sorts store rows by position every S simulated seconds
+// (SystemRunner::SetSpatialReorderInterval; give it to --replay too).
+// After the run a short job-system check reports mainThreadBackgroundJobsInWait: Normal and
+// Background jobs the main thread ran inside JobSystem::wait(). Anything but 0 fails the run.
+//
+// Log output of the loaders and systems goes to stderr, so stdout carries only the JSON.
+
+#include "update.h"
+#include "ScenarioSpawner.h"
+
+#include "ECS/ECSContext.h"
+#include "utils/JobSystem.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef STRATO_SAMPLE_DIR
+#define STRATO_SAMPLE_DIR "."
+#endif
+
+namespace
+{
+    struct BenchOptions
+    {
+        std::string scenarioPath = STRATO_SAMPLE_DIR "/BattleConfig.json";
+        std::string battleConfigPath = STRATO_SAMPLE_DIR "/BattleConfig.json";
+        std::string entitiesDir = STRATO_SAMPLE_DIR "/entities";
+        std::string outPath; // empty = stdout
+        std::string recordPath;
+        std::string replayPath;
+        std::string compilePath;
+        uint32_t units = 0;  // 0 = as authored
+        uint32_t ticks = 600;
+        uint32_t warmupTicks = 30;
+        uint32_t seed = 1;
+        uint32_t threads = std::max(1u, std::thread::hardware_concurrency()) - 1u;
+        float hz = 30.0f;
+        float tickBudgetMs = 0.0f; // 0 = unthrottled
+        bool jumpPointSearch = false;
+        float simLodRadius = -1.0f; // < 0 = no simulation LOD
+        float reorderSeconds = 0.0f; // 0 = rows stay in spawn order
+        bool startBattle = true;
+    };
+
+    struct SystemTiming
+    {
+        std::string name;
+        double totalMs = 0.0;
+        double maxMs = 0.0;
+    };
+
+    void printUsage()
+    {
+        std::cerr << "usage: EcsBench [--scenario path] [--battle-config path] [--entities dir] [--units N]\n"
+                     "                [--ticks N] [--warmup N] [--seed N] [--threads N] [--hz N] [--no-battle]\n"
+                     "                [--out path] [--record log.json] [--replay log.json]\n"
+                     "                [--compile-scenario out.scnb] [--tick-budget-ms N] [--jps] [--sim-lod R]\n"
+                     "                [--reorder S]\n";
+    }
+
+    bool parseArgs(int argc, char **argv, BenchOptions &opt)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const char *arg = argv[i];
+            auto value = [&]() -> const char *
+            {
+                return (i + 1 < argc) ? argv[++i] : nullptr;
+            };
+            auto number = [&](uint32_t &out)
+            {
+                const char *v = value();
+                if (!v)
+                    return false;
+                out = static_cast<uint32_t>(std::strtoul(v, nullptr, 10));
+                return true;
+            };
+
+            bool ok = true;
+            if (std::strcmp(arg, "--scenario") == 0)
+            {
+                const char *v = value();
+                ok = v != nullptr;
+                if (ok)
+                    opt.scenarioPath = v;
+            }
+            else if (std::strcmp(arg, "--battle-config") == 0)
+            {
+                const char *v = value();
+                ok = v != nullptr;
+                if (ok)
+                    opt.battleConfigPath = v;
+            }
+            else if (std::strcmp(arg, "--entities") == 0)
+            {
+                const char *v = value();
+                ok = v != nullptr;
+                if (ok)
+                    opt.entitiesDir = v;
+            }
+            else if (std::strcmp(arg, "--out") == 0)
+            {
+                const char *v = value();
+                ok = v != nullptr;
+                if (ok)
+                    opt.outPath = v;
+            }
+            else if (std::strcmp(arg, "--record") == 0)
+            {
+                const char *v = value();
+                ok = v != nullptr;
+                if (ok)
+                    opt.recordPath = v;
+            }
+            else if (std::strcmp(arg, "--replay") == 0)
+            {
+                const char *v = value();
+                ok = v != nullptr;
+                if (ok)
+                    opt.replayPath = v;
+            }
+            else if (std::strcmp(arg, "--compile-scenario") == 0)
+            {
+                const char *v = value();
+                ok = v != nullptr;
+                if (ok)
+                    opt.compilePath = v;
+            }
+            else if (std::strcmp(arg, "--hz") == 0)
+            {
+                const char *v = value();
+                ok = v != nullptr;
+                if (ok)
+                    opt.hz = std::strtof(v, nullptr);
+            }
+            else if (std::strcmp(arg, "--tick-budget-ms") == 0)
+            {
+                const char *v = value();
+                ok = v != nullptr;
+                if (ok)
+                    opt.tickBudgetMs = std::strtof(v, nullptr);
+            }
+            else if (std::strcmp(arg, "--jps") == 0)
+                opt.jumpPointSearch = true;
+            else if (std::strcmp(arg, "--sim-lod") == 0)
+            {
+                const char *v = value();
+                ok = v != nullptr;
+                if (ok)
+                    opt.simLodRadius = std::strtof(v, nullptr);
+            }
+            else if (std::strcmp(arg, "--reorder") == 0)
+            {
+                const char *v = value();
+                ok = v != nullptr;
+                if (ok)
+                    opt.reorderSeconds = std::strtof(v, nullptr);
+            }
+            else if (std::strcmp(arg, "--units") == 0)
+                ok = number(opt.units);
+            else if (std::strcmp(arg, "--ticks") == 0)
+                ok = number(opt.ticks);
+            else if (std::strcmp(arg, "--warmup") == 0)
+                ok = number(opt.warmupTicks);
+            else if (std::strcmp(arg, "--seed") == 0)
+                ok = number(opt.seed);
+            else if (std::strcmp(arg, "--threads") == 0)
+                ok = number(opt.threads);
+            else if (std::strcmp(arg, "--no-battle") == 0)
+                opt.startBattle = false;
+            else
+                ok = false;
+
+            if (!ok)
+            {
+                std::cerr << "[EcsBench] Bad argument: " << arg << "\n";
+                return false;
+            }
+        }
+        return opt.hz > 0.0f;
+    }
+
+    // FNV-1a over the position and health of every living unit, in store/row order: equal
+    // checksums for equal seeds show the run was deterministic.
+    uint64_t simulationChecksum(const Engine::ECS::ECSContext &ecs, std::map<int, uint32_t> &aliveByTeam)
+    {
+        uint64_t h = 1469598103934665603ull;
+        auto mix = [&](const void *data, size_t size)
+        {
+            const auto *bytes = static_cast<const unsigned char *>(data);
+            for (size_t i = 0; i < size; ++i)
+            {
+                h ^= bytes[i];
+                h *= 1099511628211ull;
+            }
+        };
+
+        for (const auto &storePtr : ecs.stores.stores())
+        {
+            if (!storePtr || !storePtr->hasPosition() || !storePtr->hasHealth() || !storePtr->hasVelocity())
+                continue;
+            const Engine::ECS::ArchetypeStore &store = *storePtr;
+            const auto &pos = store.positions();
+            const auto &hp = store.healths();
+            for (uint32_t row = 0; row < store.size(); ++row)
+            {
+                if (hp[row].value <= 0.0f)
+                    continue;
+                mix(&pos[row].x, sizeof(float));
+                mix(&pos[row].z, sizeof(float));
+                mix(&hp[row].value, sizeof(float));
+                ++aliveByTeam[store.hasTeam() ? static_cast<int>(store.teams()[row].id) : -1];
+            }
+        }
+        return h;
+    }
+
+    // The frame loop waits on its simulation job every frame (Application's pipelined
+    // simulation). Starts such a job on a worker, queues Normal and Background jobs behind it
+    // and counts those the waiting thread ran itself; JobSystem::wait() leaves them to the
+    // workers, so it stays 0.
+    uint32_t waitStealsBackgroundJobs(Engine::JobSystem &jobs)
+    {
+        constexpr uint32_t ROUNDS = 8;
+        constexpr uint32_t JOBS_PER_ROUND = 16;
+        const std::thread::id caller = std::this_thread::get_id();
+        std::atomic<bool> waiting{false};
+        std::atomic<uint32_t> stolen{0};
+        std::vector<Engine::JobHandle> queued;
+        for (uint32_t round = 0; round < ROUNDS; ++round)
+        {
+            std::atomic<bool> started{false};
+            const Engine::JobHandle frame = jobs.submit([&started]
+                                                        {
+                started.store(true, std::memory_order_release);
+                std::this_thread::sleep_for(std::chrono::milliseconds(2)); },
+                                                        Engine::JobPriority::High);
+            while (!started.load(std::memory_order_acquire))
+                std::this_thread::yield();
+
+            for (uint32_t i = 0; i < JOBS_PER_ROUND; ++i)
+            {
+                const Engine::JobPriority priority = (i & 1u) ? Engine::JobPriority::Normal : Engine::JobPriority::Background;
+                queued.push_back(jobs.submit([&]
+                                             {
+                    if (waiting.load(std::memory_order_acquire) && std::this_thread::get_id() == caller)
+                        stolen.fetch_add(1u, std::memory_order_relaxed);
+                    std::this_thread::sleep_for(std::chrono::microseconds(200)); }, priority));
+            }
+            waiting.store(true, std::memory_order_release);
+            jobs.wait(frame);
+            waiting.store(false, std::memory_order_release);
+        }
+        // Drain without wait(): the drain may run the awaited job itself, which is allowed.
+        for (const Engine::JobHandle &h : queued)
+        {
+            while (!h.isDone())
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        return stolen.load(std::memory_order_relaxed);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    BenchOptions opt;
+    if (!parseArgs(argc, argv, opt))
+    {
+        printUsage();
+        return 2;
+    }
+
+    if (!opt.compilePath.empty())
+        return Sample::CompileScenarioFile(opt.scenarioPath, opt.compilePath) ? 0 : 1;
+
+    // Keep stdout for the JSON result.
+    std::streambuf *stdoutBuf = std::cout.rdbuf(std::cerr.rdbuf());
+
+    Engine::JobSystem jobs(opt.threads);
+    Engine::ECS::ECSContext ecs;
+    ecs.SetJobSystem(&jobs);
+    ecs.WireQueryManager();
+
+    const uint32_t prefabCount = Sample::LoadPrefabsHeadless(ecs, opt.entitiesDir);
+    if (prefabCount == 0)
+    {
+        std::cerr << "[EcsBench] No prefabs loaded from " << opt.entitiesDir << "\n";
+        std::cout.rdbuf(stdoutBuf);
+        return 1;
+    }
+
+    const auto setupStart = std::chrono::steady_clock::now();
+    const uint32_t spawned = Sample::SpawnFromScenarioFile(ecs, opt.scenarioPath, /*selectSpawned=*/false, opt.units);
+
+    Sample::SystemRunner systems;
+    systems.SetHeadless(true);
+    {
+        CombatSystem::CombatConfig cfg;
+        if (Sample::LoadCombatConfigFile(opt.battleConfigPath, cfg))
+            systems.GetCombatSystemMut().applyConfig(cfg);
+        systems.GetCombatSystemMut().setRandomSeed(opt.seed);
+    }
+    systems.Initialize(ecs);
+    systems.SetDeterministicPlanning(true); // same checksum for the same seed at any thread count
+    if (opt.jumpPointSearch)
+        systems.SetPathSearchMode(PathfindingSystem::SearchMode::JumpPoint);
+    if (opt.simLodRadius >= 0.0f)
+    {
+        SimulationLod::Config lod;
+        lod.enabled = true;
+        lod.focusRadius = opt.simLodRadius;
+        systems.SetSimulationLod(lod);
+        systems.SetSimulationLodFocus(0.0f, 0.0f);
+    }
+    systems.SetSpatialReorderInterval(opt.reorderSeconds);
+    systems.GetSchedulerMut().setConfig([]
+                                        {
+        Engine::ECS::SystemScheduler::Config cfg;
+        cfg.recordTimings = true;
+        return cfg; }());
+    systems.SetCpuBudget(opt.tickBudgetMs, 0.0f);
+
+    if (!opt.replayPath.empty())
+    {
+        // The log brings seed, tick and the battle start; it runs from its tick 0 to its end.
+        Sample::SimulationLog log;
+        std::string err;
+        if (!log.load(opt.replayPath, err))
+        {
+            std::cerr << "[EcsBench] " << err << "\n";
+            std::cout.rdbuf(stdoutBuf);
+            return 1;
+        }
+        opt.seed = log.seed;
+        opt.hz = log.stepSeconds > 0.0f ? 1.0f / log.stepSeconds : opt.hz;
+        opt.warmupTicks = 0;
+        opt.ticks = log.ticks;
+        systems.StartReplay(ecs, std::move(log));
+    }
+    else
+    {
+        if (!opt.recordPath.empty())
+        {
+            Sample::SimulationLog settings;
+            settings.seed = opt.seed;
+            settings.stepSeconds = 1.0f / opt.hz;
+            settings.scenario = opt.scenarioPath;
+            systems.EnableLockstep(ecs, settings);
+        }
+        if (opt.startBattle)
+        {
+            // Both armies charge the start zone (or their centroid), so the run includes the melee.
+            float zx = 0.0f, zz = 0.0f;
+            Sample::BattleStartPoint(ecs, opt.battleConfigPath, zx, zz);
+            systems.StartBattle(zx, zz);
+        }
+    }
+    const double setupMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - setupStart).count();
+
+    const float step = 1.0f / opt.hz;
+    // Warmup: lazy query creation, first path requests and serial frames until queries are stable.
+    systems.SimulateTicks(ecs, opt.warmupTicks, step);
+
+    const auto &scheduler = systems.GetScheduler();
+    std::vector<SystemTiming> timings(scheduler.systemCount());
+    for (uint32_t i = 0; i < scheduler.systemCount(); ++i)
+        timings[i].name = scheduler.systemAt(i)->name();
+
+    std::vector<double> tickMs;
+    tickMs.reserve(opt.ticks);
+    for (uint32_t t = 0; t < opt.ticks; ++t)
+    {
+        const auto t0 = std::chrono::steady_clock::now();
+        systems.SimulateTicks(ecs, 1u, step);
+        tickMs.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count());
+
+        for (uint32_t i = 0; i < scheduler.systemCount(); ++i)
+        {
+            const double ms = scheduler.systemLastMs(i);
+            timings[i].totalMs += ms;
+            timings[i].maxMs = std::max(timings[i].maxMs, ms);
+        }
+    }
+
+    std::map<int, uint32_t> aliveByTeam;
+    const uint64_t checksum = simulationChecksum(ecs, aliveByTeam);
+    const uint32_t waitStolen = waitStealsBackgroundJobs(jobs);
+
+    if (!opt.recordPath.empty())
+    {
+        std::string err;
+        if (!systems.GetSimulationLog().save(opt.recordPath, err))
+            std::cerr << "[EcsBench] " << err << "\n";
+    }
+
+    double totalMs = 0.0;
+    double maxTickMs = 0.0;
+    for (double ms : tickMs)
+    {
+        totalMs += ms;
+        maxTickMs = std::max(maxTickMs, ms);
+    }
+    std::vector<double> sorted = tickMs;
+    std::sort(sorted.begin(), sorted.end());
+    auto percentile = [&](double p) -> double
+    {
+        if (sorted.empty())
+            return 0.0;
+        const size_t idx = std::min(sorted.size() - 1, static_cast<size_t>(p * static_cast<double>(sorted.size())));
+        return sorted[idx];
+    };
+    const double ticks = std::max<double>(1.0, static_cast<double>(opt.ticks));
+
+    nlohmann::json out;
+    out["scenario"] = opt.scenarioPath;
+    out["unitsRequested"] = opt.units;
+    out["entitiesSpawned"] = spawned;
+    out["prefabs"] = prefabCount;
+    out["ticks"] = opt.ticks;
+    out["warmupTicks"] = opt.warmupTicks;
+    out["stepSeconds"] = step;
+    out["seed"] = opt.seed;
+    out["workerThreads"] = opt.threads;
+    out["setupMs"] = setupMs;
+    out["totalMs"] = totalMs;
+    out["meanTickMs"] = totalMs / ticks;
+    out["p50TickMs"] = percentile(0.50);
+    out["p99TickMs"] = percentile(0.99);
+    out["maxTickMs"] = maxTickMs;
+    out["mainThreadBackgroundJobsInWait"] = waitStolen;
+
+    nlohmann::json systemsJson = nlohmann::json::array();
+    for (const SystemTiming &s : timings)
+    {
+        systemsJson.push_back({{"name", s.name},
+                               {"totalMs", s.totalMs},
+                               {"meanMs", s.totalMs / ticks},
+                               {"maxMs", s.maxMs}});
+    }
+    out["systems"] = systemsJson;
+
+    nlohmann::json teamsJson = nlohmann::json::object();
+    for (const auto &[team, alive] : aliveByTeam)
+        teamsJson[std::to_string(team)] = alive;
+    out["aliveByTeam"] = teamsJson;
+    char checksumHex[17];
+    std::snprintf(checksumHex, sizeof(checksumHex), "%016llx", static_cast<unsigned long long>(checksum));
+    out["checksum"] = checksumHex;
+    if (systems.IsReplaying())
+    {
+        const uint32_t diverged = systems.GetReplayDivergenceTick();
+        out["replay"] = {{"log", opt.replayPath},
+                         {"ticks", systems.GetTick()},
+                         {"checksumsCompared", systems.GetSimulationLog().checksums.size()},
+                         {"diverged", diverged != UINT32_MAX},
+                         {"divergedTick", diverged != UINT32_MAX ? static_cast<int64_t>(diverged) : -1}};
+    }
+
+    if (waitStolen > 0u)
+        std::cerr << "[EcsBench] wait() ran " << waitStolen << " Normal/Background jobs on the waiting thread\n";
+
+    std::cout.rdbuf(stdoutBuf);
+    if (opt.outPath.empty())
+    {
+        std::cout << out.dump(2) << "\n";
+    }
+    else
+    {
+        std::ofstream file(opt.outPath);
+        if (!file.is_open())
+        {
+            std::cerr << "[EcsBench] Cannot write " << opt.outPath << "\n";
+            return 1;
+        }
+        file << out.dump(2) << "\n";
+    }
+    return waitStolen > 0u ? 1 : 0;
+}
@@ -0,0 +1,296 @@
+#include "FlythroughBenchmark.h"
+
+#include "update.h"
+
+#include "ECS/ECSContext.h"
+#include "ECS/SystemScheduler.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+namespace Sample
+{
+    namespace
+    {
+        float catmullRom(float p0, float p1, float p2, float p3, float u)
+        {
+            const float u2 = u * u;
+            const float u3 = u2 * u;
+            return 0.5f * ((2.0f * p1) + (-p0 + p2) * u + (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * u2 +
+                           (-p0 + 3.0f * p1 - 3.0f * p2 + p3) * u3);
+        }
+
+        // mean / p50 / p90 / p99 / max of one series.
+        nlohmann::json summarize(std::vector<float> ms)
+        {
+            nlohmann::json out;
+            out["samples"] = ms.size();
+            if (ms.empty())
+                return out;
+            std::sort(ms.begin(), ms.end());
+            double total = 0.0;
+            for (float v : ms)
+                total += v;
+            auto percentile = [&](double p) -> float
+            {
+                const size_t idx = std::min(ms.size() - 1, static_cast<size_t>(p * static_cast<double>(ms.size())));
+                return ms[idx];
+            };
+            out["meanMs"] = total / static_cast<double>(ms.size());
+            out["p50Ms"] = percentile(0.50);
+            out["p90Ms"] = percentile(0.90);
+            out["p99Ms"] = percentile(0.99);
+            out["maxMs"] = ms.back();
+            return out;
+        }
+
+        // Living movers of the team become the selection (MoveSelected orders whatever is Selected).
+        void selectTeam(Engine::ECS::ECSContext &ecs, int team)
+        {
+            Engine::ECS::SparseTagSet *selected = ecs.sparseTag(ecs.components.getId("Selected"));
+            if (!selected)
+                return;
+            selected->clear();
+            for (const auto &storePtr : ecs.stores.stores())
+            {
+                if (!storePtr || !storePtr->hasTeam() || !storePtr->hasHealth() || !storePtr->hasVelocity())
+                    continue;
+                const auto &teams = storePtr->teams();
+                const auto &hp = storePtr->healths();
+                const auto &entities = storePtr->entities();
+                for (uint32_t row = 0; row < storePtr->size(); ++row)
+                {
+                    if (static_cast<int>(teams[row].id) == team && hp[row].value > 0.0f)
+                        selected->add(entities[row]);
+                }
+            }
+        }
+    }
+
+    bool FlythroughBenchmark::load(const std::string &path, std::string &outError)
+    {
+        std::ifstream i(path);
+        if (!i.is_open())
+        {
+            outError = "Cannot open benchmark script '" + path + "'";
+            return false;
+        }
+        const nlohmann::json j = nlohmann::json::parse(i, nullptr, /*allow_exceptions=*/false);
+        if (j.is_discarded() || !j.is_object())
+        {
+            outError = "Benchmark script '" + path + "' is not a JSON object";
+            return false;
+        }
+
+        Script s;
+        try
+        {
+            s.scenario = j.value("scenario", s.scenario);
+            s.outPath = j.value("out", s.outPath);
+            s.seed = j.value("seed", s.seed);
+            s.simulationHz = j.value("simulationHz", s.simulationHz);
+            s.frameSeconds = j.value("frameSeconds", s.frameSeconds);
+            s.warmupSeconds = std::max(0.0f, j.value("warmupSeconds", s.warmupSeconds));
+            s.durationSeconds = j.value("durationSeconds", s.durationSeconds);
+
+            if (j.contains("camera") && j["camera"].is_array())
+            {
+                for (const auto &k : j["camera"])
+                {
+                    CameraKey key;
+                    key.time = k.value("t", 0.0f);
+                    if (k.contains("focus") && k["focus"].is_array() && k["focus"].size() >= 2)
+                    {
+                        key.focusX = k["focus"][0].get<float>();
+                        key.focusZ = k["focus"][1].get<float>();
+                    }
+                    key.yawDeg = k.value("yaw", key.yawDeg);
+                    key.pitchDeg = k.value("pitch", key.pitchDeg);
+                    key.height = k.value("height", key.height);
+                    s.camera.push_back(key);
+                }
+            }
+
+            if (j.contains("orders") && j["orders"].is_array())
+            {
+                for (const auto &o : j["orders"])
+                {
+                    Order order;
+                    order.time = o.value("t", 0.0f);
+                    const std::string type = o.value("type", std::string("move"));
+                    if (type == "battle")
+                        order.type = Order::Type::StartBattle;
+                    else if (type == "move")
+                        order.type = Order::Type::Move;
+                    else
+                    {
+                        outError = "Benchmark script '" + path + "': unknown order type '" + type + "'";
+                        return false;
+                    }
+                    order.team = o.value("team", order.team);
+                    order.x = o.value("x", 0.0f);
+                    order.z = o.value("z", 0.0f);
+                    s.orders.push_back(order);
+                }
+            }
+        }
+        catch (const nlohmann::json::exception &e)
+        {
+            outError = "Benchmark script '" + path + "': " + e.what();
+            return false;
+        }
+
+        if (s.frameSeconds <= 0.0f || s.durationSeconds <= 0.0f || s.simulationHz <= 0.0f)
+        {
+            outError = "Benchmark script '" + path + "': frameSeconds, durationSeconds and simulationHz must be > 0";
+            return false;
+        }
+
+        // Stable: keys/orders with equal times keep their script order.
+        std::stable_sort(s.camera.begin(), s.camera.end(), [](const CameraKey &a, const CameraKey &b)
+                         { return a.time < b.time; });
+        std::stable_sort(s.orders.begin(), s.orders.end(), [](const Order &a, const Order &b)
+                         { return a.time < b.time; });
+
+        m_script = std::move(s);
+        m_scriptPath = path;
+        m_frame = 0;
+        m_orderCursor = 0;
+        m_frameMs.clear();
+        m_gpuPasses.clear();
+        m_simSystems.clear();
+        m_frameSystems.clear();
+        return true;
+    }
+
+    bool FlythroughBenchmark::cameraAt(float t, CameraKey &out) const
+    {
+        const std::vector<CameraKey> &keys = m_script.camera;
+        if (keys.empty())
+            return false;
+        if (keys.size() == 1u || t <= keys.front().time)
+        {
+            out = keys.front();
+            return true;
+        }
+        if (t >= keys.back().time)
+        {
+            out = keys.back();
+            return true;
+        }
+
+        size_t i = 0;
+        while (i + 2u < keys.size() && keys[i + 1u].time <= t)
+            ++i;
+        const CameraKey &k0 = keys[i > 0u ? i - 1u : i];
+        const CameraKey &k1 = keys[i];
+        const CameraKey &k2 = keys[i + 1u];
+        const CameraKey &k3 = keys[std::min(i + 2u, keys.size() - 1u)];
+        const float span = k2.time - k1.time;
+        const float u = span > 0.0f ? std::clamp((t - k1.time) / span, 0.0f, 1.0f) : 1.0f;
+
+        out.time = t;
+        out.focusX = catmullRom(k0.focusX, k1.focusX, k2.focusX, k3.focusX, u);
+        out.focusZ = catmullRom(k0.focusZ, k1.focusZ, k2.focusZ, k3.focusZ, u);
+        out.yawDeg = catmullRom(k0.yawDeg, k1.yawDeg, k2.yawDeg, k3.yawDeg, u);
+        out.pitchDeg = catmullRom(k0.pitchDeg, k1.pitchDeg, k2.pitchDeg, k3.pitchDeg, u);
+        out.height = std::max(1.0f, catmullRom(k0.height, k1.height, k2.height, k3.height, u));
+        return true;
+    }
+
+    void FlythroughBenchmark::issueDueOrders(Engine::ECS::ECSContext &ecs, SystemRunner &systems)
+    {
+        const float now = time();
+        while (m_orderCursor < m_script.orders.size() && m_script.orders[m_orderCursor].time <= now)
+        {
+            const Order &o = m_script.orders[m_orderCursor++];
+            if (o.type == Order::Type::StartBattle)
+            {
+                systems.StartBattle(o.x, o.z);
+                continue;
+            }
+            selectTeam(ecs, o.team);
+            systems.SetGlobalMoveTarget(o.x, 0.0f, o.z);
+        }
+    }
+
+    FlythroughBenchmark::Series &FlythroughBenchmark::seriesFor(std::vector<Series> &list, const char *name)
+    {
+        for (Series &s : list)
+        {
+            if (s.name == name)
+                return s;
+        }
+        list.push_back(Series{name, {}});
+        return list.back();
+    }
+
+    void FlythroughBenchmark::recordFrame(float frameMs)
+    {
+        if (measuring())
+            m_frameMs.push_back(frameMs);
+    }
+
+    void FlythroughBenchmark::recordGpuPass(const char *name, float ms)
+    {
+        if (measuring())
+            seriesFor(m_gpuPasses, name).ms.push_back(ms);
+    }
+
+    void FlythroughBenchmark::recordSystems(const Engine::ECS::SystemScheduler &scheduler, bool simulation)
+    {
+        if (!measuring())
+            return;
+        std::vector<Series> &list = simulation ? m_simSystems : m_frameSystems;
+        for (uint32_t i = 0; i < scheduler.systemCount(); ++i)
+        {
+            if (const Engine::ECS::SystemBase *system = scheduler.systemAt(i))
+                seriesFor(list, system->name()).ms.push_back(scheduler.systemLastMs(i));
+        }
+    }
+
+    bool FlythroughBenchmark::writeResults(uint32_t simulationTicks, uint64_t checksum, std::string &outError) const
+    {
+        auto seriesJson = [](const std::vector<Series> &list)
+        {
+            nlohmann::json arr = nlohmann::json::array();
+            for (const Series &s : list)
+            {
+                nlohmann::json entry = summarize(s.ms);
+                entry["name"] = s.name;
+                arr.push_back(std::move(entry));
+            }
+            return arr;
+        };
+
+        nlohmann::json out;
+        out["script"] = m_scriptPath;
+        out["scenario"] = m_script.scenario;
+        out["seed"] = m_script.seed;
+        out["simulationHz"] = m_script.simulationHz;
+        out["frameSeconds"] = m_script.frameSeconds;
+        out["warmupSeconds"] = m_script.warmupSeconds;
+        out["durationSeconds"] = m_script.durationSeconds;
+        out["frames"] = m_frameMs.size();
+        out["simulationTicks"] = simulationTicks;
+        char checksumHex[17];
+        std::snprintf(checksumHex, sizeof(checksumHex), "%016llx", static_cast<unsigned long long>(checksum));
+        out["checksum"] = checksumHex;
+        out["frameTime"] = summarize(m_frameMs);
+        out["gpuPasses"] = seriesJson(m_gpuPasses);           // empty without GPU timestamps
+        out["simulationSystems"] = seriesJson(m_simSystems); // one sample per frame that ran a tick
+        out["frameSystems"] = seriesJson(m_frameSystems);
+
+        std::ofstream o(m_script.outPath);
+        if (!o.is_open())
+        {
+            outError = "Cannot write benchmark results '" + m_script.outPath + "'";
+            return false;
+        }
+        o << out.dump(2) << "\n";
+        return true;
+    }
+}
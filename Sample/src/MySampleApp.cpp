@@ -8,11 +8,13 @@
 #include "ECS/Prefab.h"
 #include "ECS/PrefabSpawner.h"
 #include "ECS/ECSContext.h"
+#include "ECS/WorldSnapshot.h"
 
 #include "ScenarioSpawner.h"
 #include "assets/AssetManager.h"
 
-#include "Engine/GroundPlaneRenderPassModule.h"
+#include "Engine/TerrainRenderPassModule.h"
+#include "Engine/ParticleRenderPassModule.h"
 
 #include <nlohmann/json.hpp>
 #include <fstream>
@@ -21,6 +23,7 @@
 #include <iostream>
 #include <limits>
 #include <sstream>
+#include <stdexcept>
 
 #include <cmath>
 #include <algorithm>
@@ -39,10 +42,21 @@ namespace SampleTuning
     // Cursor picking: screen-space radius to consider a unit under the cursor.
     static constexpr float SELECTION_PICK_RADIUS_PX = 30.0f;
 
+    // Asset garbage collection: main-thread time per frame for collecting and destroying unloaded assets.
+    static constexpr float ASSET_GC_BUDGET_MS = 0.5f;
+
     // Selection: local cluster (connected component) radius.
     static constexpr float SELECTION_LINK_RADIUS_M = 14.0f;
     static constexpr uint32_t SELECTION_MAX_UNITS = 2048;
 
+    // Box selection: RMB drags shorter than this are clicks.
+    static constexpr float BOX_SELECT_MIN_DRAG_PX = 6.0f;
+    static constexpr ImU32 BOX_SELECT_FILL = IM_COL32(90, 160, 255, 40);
+    static constexpr ImU32 BOX_SELECT_BORDER = IM_COL32(120, 180, 255, 200);
+
+    // Picking footprint: slack (meters) above/below the terrain height range for unit origins.
+    static constexpr float PICK_HEIGHT_MARGIN_M = 2.0f;
+
     // Enemy-click behavior: if nothing is selected, pick a friendly seed near the enemy.
     static constexpr float ENEMY_CLICK_SEED_SEARCH_RADIUS_M = 80.0f;
 
@@ -66,15 +80,195 @@ namespace SampleTuning
     static constexpr ImU32 HUD_TEAM1_BG = IM_COL32(80, 20, 20, 90);
     static constexpr ImU32 HUD_BORDER = IM_COL32(220, 220, 220, 90);
     static constexpr ImU32 HUD_TEXT = IM_COL32(235, 235, 235, 190);
+
+    // Lockstep recording: seeded, fixed-tick simulation whose move orders and per-tick checksums
+    // are written to SIMULATION_LOG_PATH on exit (replay with EcsBench --replay).
+    static constexpr bool RECORD_SIMULATION = false;
+    static constexpr uint32_t SIMULATION_SEED = 1;
+    static constexpr const char *SIMULATION_LOG_PATH = "sample_replay.json";
+
+    // Simulation LOD: units farther than this from the camera's ground focus run cheaper
+    // avoidance and combat (off while recording, see SystemRunner::SetSimulationLod).
+    static constexpr bool SIMULATION_LOD = true;
+    static constexpr float SIMULATION_LOD_RADIUS_M = 120.0f;
+}
+
+namespace
+{
+    // Clips segment a-b to the slab yMin <= y <= yMax and grows the X/Z bounds by what is left.
+    void AccumulateClippedSegment(const glm::vec3 &a, const glm::vec3 &b, float yMin, float yMax,
+                                  glm::vec2 &lo, glm::vec2 &hi, bool &any)
+    {
+        float t0 = 0.0f, t1 = 1.0f;
+        const float dy = b.y - a.y;
+        if (std::abs(dy) < 1e-6f)
+        {
+            if (a.y < yMin || a.y > yMax)
+                return;
+        }
+        else
+        {
+            float ta = (yMin - a.y) / dy;
+            float tb = (yMax - a.y) / dy;
+            if (ta > tb)
+                std::swap(ta, tb);
+            t0 = std::max(t0, ta);
+            t1 = std::min(t1, tb);
+            if (t0 > t1)
+                return;
+        }
+        for (const float t : {t0, t1})
+        {
+            const glm::vec3 p = a + (b - a) * t;
+            lo = glm::min(lo, glm::vec2(p.x, p.z));
+            hi = glm::max(hi, glm::vec2(p.x, p.z));
+        }
+        any = true;
+    }
+
+    // Stores a selection query matches, indexed by store id (the spatial grid reports store ids).
+    struct SelectableStores
+    {
+        std::vector<uint8_t> accept;
+        bool anyStatic = false; // a match without Velocity lives in the grid's static layer
+
+        bool has(uint32_t storeId) const { return storeId < accept.size() && accept[storeId] != 0; }
+    };
+
+    SelectableStores MatchingStores(Engine::ECS::ECSContext &ecs, Engine::ECS::QueryId queryId)
+    {
+        SelectableStores out;
+        for (uint32_t archetypeId : ecs.queries.get(queryId).matchingArchetypeIds)
+        {
+            const Engine::ECS::ArchetypeStore *store = ecs.stores.get(archetypeId);
+            if (!store || !store->hasPosition() || !store->hasRenderModel() || !store->hasRenderAnimation())
+                continue;
+            if (archetypeId >= out.accept.size())
+                out.accept.resize(static_cast<size_t>(archetypeId) + 1u, 0);
+            out.accept[archetypeId] = 1;
+            out.anyStatic = out.anyStatic || !store->hasVelocity();
+        }
+        return out;
+    }
+
+    // X/Z bounds of the part of the view frustum under the screen rectangle [p0, p1] (pixels) that
+    // lies between heights yMin and yMax: every point there that can project inside the rectangle.
+    // The AABB of a convex polytope clipped by a slab is spanned by its 12 edges clipped to the slab.
+    bool ScreenRectGroundBounds(const glm::mat4 &invVP, glm::vec2 p0, glm::vec2 p1, float width, float height,
+                                float yMin, float yMax, glm::vec2 &outLo, glm::vec2 &outHi)
+    {
+        const float nx[2] = {p0.x / width * 2.0f - 1.0f, p1.x / width * 2.0f - 1.0f};
+        const float ny[2] = {p0.y / height * 2.0f - 1.0f, p1.y / height * 2.0f - 1.0f};
+
+        glm::vec3 corners[2][4]; // [near/far][corner, in order around the rectangle]
+        for (int d = 0; d < 2; ++d)
+        {
+            const float z = d == 0 ? -1.0f : 1.0f;
+            const glm::vec2 ndc[4] = {{nx[0], ny[0]}, {nx[1], ny[0]}, {nx[1], ny[1]}, {nx[0], ny[1]}};
+            for (int c = 0; c < 4; ++c)
+            {
+                const glm::vec4 w = invVP * glm::vec4(ndc[c].x, ndc[c].y, z, 1.0f);
+                if (std::abs(w.w) <= 1e-6f)
+                    return false;
+                corners[d][c] = glm::vec3(w) / w.w;
+            }
+        }
+
+        glm::vec2 lo(std::numeric_limits<float>::max());
+        glm::vec2 hi(-std::numeric_limits<float>::max());
+        bool any = false;
+        for (int c = 0; c < 4; ++c)
+        {
+            const int n = (c + 1) & 3;
+            AccumulateClippedSegment(corners[0][c], corners[0][n], yMin, yMax, lo, hi, any);
+            AccumulateClippedSegment(corners[1][c], corners[1][n], yMin, yMax, lo, hi, any);
+            AccumulateClippedSegment(corners[0][c], corners[1][c], yMin, yMax, lo, hi, any);
+        }
+        outLo = lo;
+        outHi = hi;
+        return any;
+    }
+}
+
+struct MySampleApp::StartupPreload
+{
+    struct PrefabText
+    {
+        std::string path;
+        std::string text; // empty: read failed
+    };
+    std::vector<PrefabText> prefabs; // entities/*.json in directory order
+    std::string prefabError;         // set when entities/ could not be enumerated
+
+    Engine::TerrainHeightfield terrain;
+    bool terrainLoaded = false;
+
+    static std::vector<Engine::Application::StartupJob> jobs(const std::shared_ptr<StartupPreload> &preload)
+    {
+        std::vector<Engine::Application::StartupJob> out;
+        out.push_back([preload]()
+                      {
+            try
+            {
+                for (const auto &entry : std::filesystem::directory_iterator("entities"))
+                {
+                    if (!entry.is_regular_file() || entry.path().extension() != ".json")
+                        continue;
+                    PrefabText prefab;
+                    prefab.path = entry.path().generic_string();
+                    prefab.text = Engine::ECS::readFileText(prefab.path);
+                    preload->prefabs.push_back(std::move(prefab));
+                }
+            }
+            catch (const std::exception &e)
+            {
+                preload->prefabs.clear();
+                preload->prefabError = e.what();
+            } });
+        // Optional 4097x4097 16-bit height map (1 m spacing, 0..200 m) plus splat: ~50 MB of reads
+        // and the min/max pyramid build.
+        out.push_back([preload]()
+                      {
+            preload->terrainLoaded = preload->terrain.loadRaw16("assets/terrain/height.r16", 4097, 4097, 1.0f,
+                                                                -2048.0f, -2048.0f, 200.0f / 65535.0f, 0.0f);
+            if (preload->terrainLoaded)
+                preload->terrain.loadSplatRaw("assets/terrain/splat.rgba8"); });
+        return out;
+    }
+};
+
+MySampleApp::MySampleApp(const std::string &benchmarkScript)
+    : MySampleApp(benchmarkScript, std::make_shared<StartupPreload>())
+{
 }
 
-MySampleApp::MySampleApp() : Engine::Application()
+MySampleApp::MySampleApp(const std::string &benchmarkScript, std::shared_ptr<StartupPreload> preload)
+    : Engine::Application(StartupPreload::jobs(preload)), m_preload(std::move(preload))
 {
+    if (!benchmarkScript.empty())
+    {
+        m_benchmark = std::make_unique<Sample::FlythroughBenchmark>();
+        std::string err;
+        if (!m_benchmark->load(benchmarkScript, err))
+            throw std::runtime_error(err);
+        m_scenarioPath = m_benchmark->script().scenario;
+    }
+
     m_assets = std::make_unique<Engine::AssetManager>(
         GetVulkanContext().GetDevice(),
         GetVulkanContext().GetPhysicalDevice(),
         GetVulkanContext().GetGraphicsQueue(),
         GetVulkanContext().GetGraphicsQueueFamilyIndex());
+    // Streamed meshes and textures upload on the dedicated transfer queue when the device has one.
+    m_assets->setTransferQueue(GetVulkanContext().GetTransferQueue(), GetVulkanContext().GetTransferQueueFamilyIndex());
+
+    // Optional pack (AssetPackTool <exe dir>/assets assets.spak --prefix assets): one mapped file
+    // instead of one open per asset; anything not in it still loads from assets/.
+    if (std::filesystem::exists("assets.spak"))
+        m_assets->mountPack("assets.spak");
+
+    // Prefab models stream in through the engine job system instead of blocking startup.
+    m_assets->setJobSystem(GetECS().jobSystem);
 
     // RTS camera initialization — raised for the larger maze map.
     m_rtsCam.focus = {0.0f, 0.0f, 0.0f};
@@ -98,8 +292,11 @@ MySampleApp::MySampleApp() : Engine::Application()
     m_systems.SetRenderer(&GetRenderer());
     m_systems.SetCamera(&m_camera);
 
+    // Startup assets: record every texture/mesh copy and submit them together.
+    m_assets->beginUploadBatch();
+
     // ------------------------------------------------------------
-    // Background: simple ground-plane pass using ground baseColor tex
+    // Background: terrain pass using ground baseColor tex as layer 0
     // ------------------------------------------------------------
     {
         Engine::ModelHandle groundModel = m_assets->loadModel("assets/Ground/scene.smodel");
@@ -126,20 +323,41 @@ MySampleApp::MySampleApp() : Engine::Application()
             m_assets->release(groundModel);
         }
 
+        // The ground model load above overlapped the startup reads; everything below uses them.
+        WaitForStartupJobs();
+
         if (m_groundTexture.isValid())
         {
-            m_groundPass = std::make_shared<Engine::GroundPlaneRenderPassModule>();
+            // Preloaded height map; flat ground otherwise.
+            if (m_preload->terrainLoaded)
+                m_terrain = std::move(m_preload->terrain);
+            else
+                m_terrain.createFlat(-2048.0f, -2048.0f, 4096.0f, 4096.0f);
+
+            m_groundPass = std::make_shared<Engine::TerrainRenderPassModule>();
             m_groundPass->setAssets(m_assets.get());
             m_groundPass->setCamera(&m_camera);
-            m_groundPass->setBaseColorTexture(m_groundTexture);
-            m_groundPass->setHalfSize(1000.0f);
-            m_groundPass->setTileWorldSize(5.0f);
+            m_groundPass->setHeightfield(&m_terrain);
+            m_groundPass->setLayerTexture(0, m_groundTexture, 5.0f);
             m_groundPass->setEnabled(true);
             GetRenderer().registerPass(m_groundPass);
         }
     }
 
+    // The view camera feeds the shared camera block and the cascades; the terrain never casts,
+    // it only receives.
+    GetRenderer().setCamera(&m_camera);
+
+    m_particlePass = std::make_shared<Engine::ParticleRenderPassModule>();
+    m_particlePass->setCamera(&m_camera);
+    GetRenderer().registerPass(m_particlePass);
+    m_systems.SetParticleSpawns(&m_particlePass->spawnRing());
+
     setupECSFromPrefabs();
+    m_preload.reset();
+
+    if (!m_assets->endUploadBatch())
+        std::cerr << "[Assets] Startup upload batch failed\n";
 
     // Enable incremental query updates when new stores are created.
     GetECS().WireQueryManager();
@@ -147,6 +365,63 @@ MySampleApp::MySampleApp() : Engine::Application()
     // Systems can be initialized after prefabs are registered.
     m_systems.Initialize(GetECS());
 
+    if (m_benchmark)
+    {
+        // Same seed, tick and orders every run; both schedules time their systems.
+        const Sample::FlythroughBenchmark::Script &script = m_benchmark->script();
+        Sample::SimulationLog settings;
+        settings.seed = script.seed;
+        settings.stepSeconds = 1.0f / script.simulationHz;
+        settings.humanTeam = 0;
+        settings.scenario = m_scenarioPath;
+        m_systems.EnableLockstep(GetECS(), settings);
+        for (Engine::ECS::SystemScheduler *scheduler : {&m_systems.GetSchedulerMut(), &m_systems.GetFrameSchedulerMut()})
+        {
+            Engine::ECS::SystemScheduler::Config cfg = scheduler->config();
+            cfg.recordTimings = true;
+            scheduler->setConfig(cfg);
+        }
+    }
+    else if (SampleTuning::RECORD_SIMULATION)
+    {
+        Sample::SimulationLog settings;
+        settings.seed = SampleTuning::SIMULATION_SEED;
+        settings.stepSeconds = m_systems.GetFixedTimestep().config().stepSeconds;
+        settings.humanTeam = 0; // matches setupECSFromPrefabs
+        settings.scenario = m_scenarioPath;
+        m_systems.EnableLockstep(GetECS(), settings);
+    }
+    else if (SampleTuning::SIMULATION_LOD)
+    {
+        SimulationLod::Config lod;
+        lod.enabled = true;
+        lod.focusRadius = SampleTuning::SIMULATION_LOD_RADIUS_M;
+        m_systems.SetSimulationLod(lod);
+    }
+
+    // Asset and gameplay-system byte counts for the overlay's Memory section.
+    AddMemoryProvider([this](Engine::MemoryReport &out)
+                      { m_assets->reportMemory(out);
+                        m_systems.ReportMemory(out);
+                        out.add("Render", "Frame upload ring", 0, GetRenderer().uploadRing().memoryBytes(), 1);
+                        out.add("Render", "Frame graph transients (slot)", 0, GetRenderer().renderGraph().stats().transientBytes,
+                                GetRenderer().renderGraph().stats().transientImages);
+                        if (m_particlePass)
+                            m_particlePass->reportMemory(out); });
+
+    // Simulate the next frame while this one is recorded and submitted (one frame of latency).
+    SetPipelinedSimulation(true);
+
+    // Late latch: re-read the cursor right before submit so panning shows the newest mouse
+    // position; the passes write their camera UBOs from it (Renderer::setLateLatchCallback).
+    GetRenderer().setLateLatchCallback([this]()
+                                       {
+                                           auto &win = GetWindow();
+                                           if (!m_isPanning || win.GetHeight() == 0)
+                                               return;
+                                           UpdateRTSPan();
+                                           ApplyRTSCamera(static_cast<float>(win.GetWidth()) / static_cast<float>(win.GetHeight())); });
+
     // Hook engine window events into our handler.
     SetEventCallback([this](const std::string &e)
                      { this->OnEvent(e); });
@@ -154,14 +429,44 @@ MySampleApp::MySampleApp() : Engine::Application()
 
 MySampleApp::~MySampleApp() = default;
 
+bool MySampleApp::StartTelemetry(const Engine::TelemetryConfig &config)
+{
+    if (!EnableTelemetry(config))
+        return false;
+    struct Schedule
+    {
+        Engine::ECS::SystemScheduler *scheduler;
+        const char *label;
+    };
+    for (const Schedule &s : {Schedule{&m_systems.GetSchedulerMut(), "simulation"},
+                              Schedule{&m_systems.GetFrameSchedulerMut(), "frame"}})
+    {
+        Engine::ECS::SystemScheduler::Config cfg = s.scheduler->config();
+        cfg.recordTimings = true;
+        s.scheduler->setConfig(cfg);
+        AddTelemetryScheduler(s.scheduler, s.label);
+    }
+    return true;
+}
+
 void MySampleApp::Close()
 {
     vkDeviceWaitIdle(GetVulkanContext().GetDevice());
 
+    if (m_systems.IsLockstep() && !m_systems.IsReplaying() && !m_benchmark)
+    {
+        std::string err;
+        if (!m_systems.GetSimulationLog().save(SampleTuning::SIMULATION_LOG_PATH, err))
+            std::cerr << "[Sample] " << err << "\n";
+    }
+
     if (m_assets)
     {
         if (m_groundTexture.isValid())
             m_assets->release(m_groundTexture);
+        for (Engine::ModelHandle h : m_snapshotModelRefs)
+            m_assets->release(h);
+        m_snapshotModelRefs.clear();
         m_assets->garbageCollect();
     }
 
@@ -173,62 +478,104 @@ void MySampleApp::OnUpdate(Engine::TimeStep ts)
     auto &win = GetWindow();
     const float aspect = static_cast<float>(win.GetWidth()) / static_cast<float>(win.GetHeight());
 
-    // Read mouse and compute per-frame delta.
-    double mx = 0.0, my = 0.0;
-    win.GetCursorPosition(mx, my);
-    const glm::vec2 mouse{static_cast<float>(mx), static_cast<float>(my)};
-    const glm::vec2 delta = mouse - m_lastMouse;
-    m_lastMouse = mouse;
-
-    // Pan (LMB drag) in ground plane; modifies focus only.
-    if (m_isPanning)
+    if (m_benchmark)
     {
-        if (m_panJustStarted)
+        UpdateBenchmark(ts);
+    }
+    else
+    {
+        UpdateRTSPan();
+
+        // Zoom (mouse wheel) modifies height.
+        const float wheel = m_scrollDelta;
+        m_scrollDelta = 0.0f;
+        if (wheel != 0.0f)
         {
-            // Prevent a jump on the initial press frame.
-            m_panJustStarted = false;
+            m_rtsCam.height -= wheel * m_rtsCam.zoomSpeed;
+            m_rtsCam.height = glm::clamp(m_rtsCam.height, m_rtsCam.minHeight, m_rtsCam.maxHeight);
         }
-        else
-        {
-            glm::vec3 forward;
-            forward.x = std::cos(glm::radians(m_rtsCam.yawDeg)) * std::cos(glm::radians(m_rtsCam.pitchDeg));
-            forward.y = std::sin(glm::radians(m_rtsCam.pitchDeg));
-            forward.z = std::sin(glm::radians(m_rtsCam.yawDeg)) * std::cos(glm::radians(m_rtsCam.pitchDeg));
-            forward = glm::normalize(forward);
+    }
 
-            const glm::vec3 worldUp{0.0f, 1.0f, 0.0f};
-            const glm::vec3 right = glm::normalize(glm::cross(forward, worldUp));
+    // Apply RTS state to engine camera every frame.
+    ApplyRTSCamera(aspect);
+    m_systems.SetSimulationLodFocus(m_rtsCam.focus.x, m_rtsCam.focus.z);
 
-            glm::vec3 forwardXZ{forward.x, 0.0f, forward.z};
-            glm::vec3 rightXZ{right.x, 0.0f, right.z};
+    // Streamed prefab models: patch bounds of already spawned entities once a model is resident.
+    if (!m_streamingPrefabs.empty())
+    {
+        auto &ecs = GetECS();
+        m_streamingPrefabs.erase(std::remove_if(m_streamingPrefabs.begin(), m_streamingPrefabs.end(),
+                                                [&](const std::string &name)
+                                                {
+                                                    Engine::ECS::Prefab *prefab = ecs.prefabs.find(name);
+                                                    return !prefab || Engine::ECS::refreshStreamedModelBounds(*prefab, ecs, *m_assets);
+                                                }),
+                                 m_streamingPrefabs.end());
+    }
 
-            const float forwardLen2 = glm::dot(forwardXZ, forwardXZ);
-            const float rightLen2 = glm::dot(rightXZ, rightXZ);
-            if (forwardLen2 > 1e-6f)
-                forwardXZ *= 1.0f / std::sqrt(forwardLen2);
-            if (rightLen2 > 1e-6f)
-                rightXZ *= 1.0f / std::sqrt(rightLen2);
+    m_systems.Present(GetECS(), m_benchmark ? m_benchmark->script().frameSeconds : ts.DeltaSeconds);
 
-            const float panScale = m_rtsCam.basePanSpeed * m_rtsCam.height;
-            // Update focus (not position). Mouse delta is in pixels.
-            m_rtsCam.focus += (-rightXZ * delta.x + forwardXZ * delta.y) * panScale;
-            m_rtsCam.focus.y = 0.0f;
-        }
+    // Mip residency from this frame's on-screen sizes, before the passes record.
+    m_assets->updateTextureResidency();
+
+    // Unloaded assets: a slice of collection per frame; GPU objects wait for their frames to retire.
+    auto &renderer = GetRenderer();
+    m_assets->setFrameSerials(renderer.getFrameSerial(), renderer.getCompletedFrameSerial());
+    m_assets->garbageCollectStep(SampleTuning::ASSET_GC_BUDGET_MS);
+}
+
+void MySampleApp::OnSimulate(Engine::TimeStep ts)
+{
+    // Benchmark: a fixed step per frame, so every run simulates the same ticks on the same frames.
+    m_systems.Simulate(GetECS(), m_benchmark ? m_benchmark->script().frameSeconds : ts.DeltaSeconds);
+}
+
+void MySampleApp::UpdateBenchmark(Engine::TimeStep ts)
+{
+    Sample::FlythroughBenchmark &bench = *m_benchmark;
+
+    // Samples of the previous frame: its wall time, the presentation systems it ran, the tick
+    // simulated after its draw (if any) and the newest GPU pass timings the renderer has read
+    // back (a few frames old).
+    if (m_benchmarkLastTick != UINT32_MAX)
+    {
+        bench.recordFrame(ts.DeltaSeconds * 1000.0f);
+        for (const Engine::Renderer::PassGpuTiming &pass : GetRenderer().getGpuPassTimings())
+            bench.recordGpuPass(pass.name, pass.prePassMs + pass.recordMs);
+        bench.recordSystems(m_systems.GetFrameScheduler(), /*simulation=*/false);
+        if (m_systems.GetTick() != m_benchmarkLastTick)
+            bench.recordSystems(m_systems.GetScheduler(), /*simulation=*/true);
+        bench.advanceFrame();
     }
+    m_benchmarkLastTick = m_systems.GetTick();
 
-    // Zoom (mouse wheel) modifies height.
-    const float wheel = m_scrollDelta;
-    m_scrollDelta = 0.0f;
-    if (wheel != 0.0f)
+    if (bench.finished())
     {
-        m_rtsCam.height -= wheel * m_rtsCam.zoomSpeed;
-        m_rtsCam.height = glm::clamp(m_rtsCam.height, m_rtsCam.minHeight, m_rtsCam.maxHeight);
+        const std::vector<uint64_t> &checksums = m_systems.GetSimulationLog().checksums;
+        std::string err;
+        const bool written = bench.writeResults(m_systems.GetTick(), checksums.empty() ? 0u : checksums.back(), err);
+#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
+        if (written)
+            std::cout << "[Benchmark] Results written to " << bench.script().outPath << "\n";
+        else
+            std::cerr << "[Benchmark] " << err << "\n";
+#else
+        (void)written;
+#endif
+        RequestClose();
+        return;
     }
 
-    // Apply RTS state to engine camera every frame.
-    ApplyRTSCamera(aspect);
+    bench.issueDueOrders(GetECS(), m_systems);
 
-    m_systems.Update(GetECS(), ts.DeltaSeconds);
+    Sample::FlythroughBenchmark::CameraKey cam;
+    if (bench.cameraAt(bench.time(), cam))
+    {
+        m_rtsCam.focus = {cam.focusX, 0.0f, cam.focusZ};
+        m_rtsCam.yawDeg = cam.yawDeg;
+        m_rtsCam.pitchDeg = cam.pitchDeg;
+        m_rtsCam.height = cam.height;
+    }
 }
 
 void MySampleApp::PickAndSelectEntityAtCursor()
@@ -261,10 +608,12 @@ void MySampleApp::PickAndSelectEntityAtCursor()
     excluded.set(disabledId);
     excluded.set(deadId);
 
-    // Project entities to screen; pick closest to cursor within a small radius.
+    // Pick the entity closest to the cursor within a small screen radius. Only entities in the
+    // spatial grid cells under the pick square's ground footprint are projected.
     const glm::mat4 view = m_camera.GetViewMatrix();
     const glm::mat4 proj = m_camera.GetProjectionMatrix();
     const glm::mat4 vp = proj * view;
+    const glm::vec3 camPos = m_camera.GetPosition();
 
     const float bestRadius2 = SampleTuning::SELECTION_PICK_RADIUS_PX * SampleTuning::SELECTION_PICK_RADIUS_PX;
     float bestD2 = bestRadius2;
@@ -277,50 +626,47 @@ void MySampleApp::PickAndSelectEntityAtCursor()
     if (pickQueryId == Engine::ECS::QueryManager::InvalidQuery)
         pickQueryId = ecs.queries.createQuery(required, excluded, ecs.stores);
 
-    const auto &q = ecs.queries.get(pickQueryId);
-    for (uint32_t archetypeId : q.matchingArchetypeIds)
+    const glm::vec2 pickR(SampleTuning::SELECTION_PICK_RADIUS_PX);
+    glm::vec2 footLo, footHi;
+    if (ComputeScreenRectFootprint(glm::vec2(mouseX, mouseY) - pickR, glm::vec2(mouseX, mouseY) + pickR, footLo, footHi))
     {
-        Engine::ECS::ArchetypeStore *storePtr = ecs.stores.get(archetypeId);
-        if (!storePtr)
-            continue;
-        auto &store = *storePtr;
-        if (!store.hasPosition() || !store.hasRenderModel() || !store.hasRenderAnimation())
-            continue;
-
-        const auto &positions = store.positions();
-        const uint32_t n = store.size();
-        for (uint32_t row = 0; row < n; ++row)
-        {
-            const auto &p = positions[row];
-            const glm::vec4 world(p.x, p.y, p.z, 1.0f);
-            const glm::vec4 clip = vp * world;
-            if (clip.w <= 1e-6f)
-                continue;
-
-            const glm::vec3 ndc = glm::vec3(clip) / clip.w;
-            if (ndc.x < -1.0f || ndc.x > 1.0f || ndc.y < -1.0f || ndc.y > 1.0f)
-                continue;
-
-            const float sx = (ndc.x * 0.5f + 0.5f) * width;
-            // Camera projection already flips Y for Vulkan, so NDC Y is in the same "down is +" sense as window pixels.
-            const float sy = (ndc.y * 0.5f + 0.5f) * height;
-
-            const float dx = sx - mouseX;
-            const float dy = sy - mouseY;
-            const float d2 = dx * dx + dy * dy;
-
-            const glm::vec3 camPos = m_camera.GetPosition();
-            const glm::vec3 worldPos(p.x, p.y, p.z);
-            const float camD2 = glm::dot(worldPos - camPos, worldPos - camPos);
-
-            if (d2 < bestD2 || (std::abs(d2 - bestD2) < 1e-4f && camD2 < bestCamD2))
-            {
-                bestD2 = d2;
-                bestCamD2 = camD2;
-                bestStore = &store;
-                bestRow = row;
-            }
-        }
+        const SelectableStores selectable = MatchingStores(ecs, pickQueryId);
+        const auto &spatial = m_systems.GetSpatialIndex();
+        spatial.forEntitiesInRect(footLo.x, footLo.y, footHi.x, footHi.y, !selectable.anyStatic, [&](uint32_t storeId, uint32_t row)
+                                  {
+                                      if (!selectable.has(storeId))
+                                          return;
+                                      Engine::ECS::ArchetypeStore *storePtr = ecs.stores.get(storeId);
+                                      if (!storePtr || row >= storePtr->size())
+                                          return;
+
+                                      const auto &p = storePtr->positions()[row];
+                                      const glm::vec4 clip = vp * glm::vec4(p.x, p.y, p.z, 1.0f);
+                                      if (clip.w <= 1e-6f)
+                                          return;
+
+                                      const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+                                      if (ndc.x < -1.0f || ndc.x > 1.0f || ndc.y < -1.0f || ndc.y > 1.0f)
+                                          return;
+
+                                      const float sx = (ndc.x * 0.5f + 0.5f) * width;
+                                      // Camera projection already flips Y for Vulkan, so NDC Y is in the same "down is +" sense as window pixels.
+                                      const float sy = (ndc.y * 0.5f + 0.5f) * height;
+
+                                      const float dx = sx - mouseX;
+                                      const float dy = sy - mouseY;
+                                      const float d2 = dx * dx + dy * dy;
+
+                                      const glm::vec3 worldPos(p.x, p.y, p.z);
+                                      const float camD2 = glm::dot(worldPos - camPos, worldPos - camPos);
+
+                                      if (d2 < bestD2 || (std::abs(d2 - bestD2) < 1e-4f && camD2 < bestCamD2))
+                                      {
+                                          bestD2 = d2;
+                                          bestCamD2 = camD2;
+                                          bestStore = storePtr;
+                                          bestRow = row;
+                                      } });
     }
 
     if (bestStore)
@@ -337,36 +683,12 @@ void MySampleApp::PickAndSelectEntityAtCursor()
         const uint8_t pickedTeam = havePickedTeam ? bestStore->teams()[bestRow].id : 0u;
 
         auto clearSelection = [&]()
-        {
-            std::vector<Engine::ECS::Entity> toClear;
-            toClear.reserve(256);
-            for (const auto &ptr : ecs.stores.stores())
-            {
-                if (!ptr)
-                    continue;
-                const auto &store = *ptr;
-                if (!store.signature().has(selectedId))
-                    continue;
-                const auto &ents = store.entities();
-                const uint32_t n = store.size();
-                for (uint32_t row = 0; row < n; ++row)
-                    toClear.push_back(ents[row]);
-            }
-            for (const auto &e : toClear)
-                (void)ecs.removeTag(e, selectedId);
-        };
+        { ecs.clearTag(selectedId); };
 
         auto hasAnySelected = [&]() -> bool
         {
-            for (const auto &ptr : ecs.stores.stores())
-            {
-                if (!ptr)
-                    continue;
-                const auto &store = *ptr;
-                if (store.signature().has(selectedId) && store.size() > 0)
-                    return true;
-            }
-            return false;
+            const Engine::ECS::SparseTagSet *selection = ecs.sparseTag(selectedId);
+            return selection && !selection->empty();
         };
 
         auto selectLocalClusterForTeam = [&](uint8_t teamToSelect, const Engine::ECS::Entity &seed)
@@ -549,6 +871,171 @@ void MySampleApp::PickAndSelectEntityAtCursor()
     }
 }
 
+bool MySampleApp::ComputeScreenRectFootprint(glm::vec2 p0, glm::vec2 p1, glm::vec2 &outLo, glm::vec2 &outHi)
+{
+    auto &win = GetWindow();
+    const float width = static_cast<float>(win.GetWidth());
+    const float height = static_cast<float>(win.GetHeight());
+    if (width <= 0.0f || height <= 0.0f)
+        return false;
+
+    const glm::mat4 invVP = glm::inverse(m_camera.GetProjectionMatrix() * m_camera.GetViewMatrix());
+    const glm::vec2 rectLo = glm::min(p0, p1);
+    const glm::vec2 rectHi = glm::max(p0, p1);
+
+    // Unit origins stand on the y = 0 ground plane or on the terrain.
+    const float margin = SampleTuning::PICK_HEIGHT_MARGIN_M;
+    float yMin = 0.0f, yMax = 0.0f;
+    if (m_terrain.valid())
+    {
+        yMin = std::min(yMin, m_terrain.minHeight());
+        yMax = std::max(yMax, m_terrain.maxHeight());
+    }
+    if (!ScreenRectGroundBounds(invVP, rectLo, rectHi, width, height, yMin - margin, yMax + margin, outLo, outHi))
+        return false;
+
+    // The terrain under that footprint usually spans far less height than the whole map; the
+    // narrower slab gives a tighter footprint that still holds every candidate of the first.
+    if (m_terrain.valid())
+    {
+        float hMin = 0.0f, hMax = 0.0f;
+        m_terrain.heightRange(outLo.x, outLo.y, outHi.x, outHi.y, hMin, hMax);
+        hMin = std::min(hMin, 0.0f);
+        hMax = std::max(hMax, 0.0f);
+        glm::vec2 lo, hi;
+        if (hMin > yMin || hMax < yMax)
+        {
+            if (!ScreenRectGroundBounds(invVP, rectLo, rectHi, width, height, hMin - margin, hMax + margin, lo, hi))
+                return false;
+            outLo = lo;
+            outHi = hi;
+        }
+    }
+    return true;
+}
+
+void MySampleApp::SelectEntitiesInScreenRect(glm::vec2 p0, glm::vec2 p1)
+{
+    auto &ecs = GetECS();
+    auto &win = GetWindow();
+    const float width = static_cast<float>(win.GetWidth());
+    const float height = static_cast<float>(win.GetHeight());
+
+    const uint32_t selectedId = ecs.components.ensureId("Selected");
+    const uint32_t posId = ecs.components.ensureId("Position");
+    const uint32_t rmId = ecs.components.ensureId("RenderModel");
+    const uint32_t raId = ecs.components.ensureId("RenderAnimation");
+    const uint32_t disabledId = ecs.components.ensureId("Disabled");
+    const uint32_t deadId = ecs.components.ensureId("Dead");
+
+    Engine::ECS::ComponentMask required;
+    required.set(posId);
+    required.set(rmId);
+    required.set(raId);
+
+    Engine::ECS::ComponentMask excluded;
+    excluded.set(disabledId);
+    excluded.set(deadId);
+
+    static Engine::ECS::QueryId boxQueryId = Engine::ECS::QueryManager::InvalidQuery;
+    if (boxQueryId == Engine::ECS::QueryManager::InvalidQuery)
+        boxQueryId = ecs.queries.createQuery(required, excluded, ecs.stores);
+
+    const glm::vec2 rectLo = glm::min(p0, p1);
+    const glm::vec2 rectHi = glm::max(p0, p1);
+
+    // Box selection only ever grabs the player's own living units (all of them when no team is human).
+    const int playerTeam = m_systems.GetCombatSystem().humanTeamId();
+
+    ecs.clearTag(selectedId);
+
+    glm::vec2 footLo, footHi;
+    if (!ComputeScreenRectFootprint(rectLo, rectHi, footLo, footHi))
+        return;
+
+    const glm::mat4 vp = m_camera.GetProjectionMatrix() * m_camera.GetViewMatrix();
+    const SelectableStores selectable = MatchingStores(ecs, boxQueryId);
+
+    std::vector<Engine::ECS::Entity> selected;
+    selected.reserve(256);
+
+    const auto &spatial = m_systems.GetSpatialIndex();
+    spatial.forEntitiesInRect(footLo.x, footLo.y, footHi.x, footHi.y, !selectable.anyStatic, [&](uint32_t storeId, uint32_t row)
+                              {
+                                  if (selected.size() >= SampleTuning::SELECTION_MAX_UNITS || !selectable.has(storeId))
+                                      return;
+                                  Engine::ECS::ArchetypeStore *st = ecs.stores.get(storeId);
+                                  if (!st || row >= st->size() || !st->hasTeam() || !st->hasHealth())
+                                      return;
+                                  if (st->healths()[row].value <= 0.0f)
+                                      return;
+                                  if (playerTeam >= 0 && st->teams()[row].id != static_cast<uint8_t>(playerTeam))
+                                      return;
+
+                                  const auto &p = st->positions()[row];
+                                  const glm::vec4 clip = vp * glm::vec4(p.x, p.y, p.z, 1.0f);
+                                  if (clip.w <= 1e-6f)
+                                      return;
+                                  const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+                                  const float sx = (ndc.x * 0.5f + 0.5f) * width;
+                                  const float sy = (ndc.y * 0.5f + 0.5f) * height;
+                                  if (sx < rectLo.x || sx > rectHi.x || sy < rectLo.y || sy > rectHi.y)
+                                      return;
+
+                                  selected.push_back(st->entities()[row]); });
+
+    for (const auto &e : selected)
+        (void)ecs.addTag(e, selectedId);
+}
+
+void MySampleApp::UpdateRTSPan()
+{
+    auto &win = GetWindow();
+
+    // Read mouse and compute per-frame delta.
+    double mx = 0.0, my = 0.0;
+    win.GetCursorPosition(mx, my);
+    const glm::vec2 mouse{static_cast<float>(mx), static_cast<float>(my)};
+    const glm::vec2 delta = mouse - m_lastMouse;
+    m_lastMouse = mouse;
+
+    // Pan (LMB drag) in ground plane; modifies focus only.
+    if (m_isPanning)
+    {
+        if (m_panJustStarted)
+        {
+            // Prevent a jump on the initial press frame.
+            m_panJustStarted = false;
+        }
+        else
+        {
+            glm::vec3 forward;
+            forward.x = std::cos(glm::radians(m_rtsCam.yawDeg)) * std::cos(glm::radians(m_rtsCam.pitchDeg));
+            forward.y = std::sin(glm::radians(m_rtsCam.pitchDeg));
+            forward.z = std::sin(glm::radians(m_rtsCam.yawDeg)) * std::cos(glm::radians(m_rtsCam.pitchDeg));
+            forward = glm::normalize(forward);
+
+            const glm::vec3 worldUp{0.0f, 1.0f, 0.0f};
+            const glm::vec3 right = glm::normalize(glm::cross(forward, worldUp));
+
+            glm::vec3 forwardXZ{forward.x, 0.0f, forward.z};
+            glm::vec3 rightXZ{right.x, 0.0f, right.z};
+
+            const float forwardLen2 = glm::dot(forwardXZ, forwardXZ);
+            const float rightLen2 = glm::dot(rightXZ, rightXZ);
+            if (forwardLen2 > 1e-6f)
+                forwardXZ *= 1.0f / std::sqrt(forwardLen2);
+            if (rightLen2 > 1e-6f)
+                rightXZ *= 1.0f / std::sqrt(rightLen2);
+
+            const float panScale = m_rtsCam.basePanSpeed * m_rtsCam.height;
+            // Update focus (not position). Mouse delta is in pixels.
+            m_rtsCam.focus += (-rightXZ * delta.x + forwardXZ * delta.y) * panScale;
+            m_rtsCam.focus.y = 0.0f;
+        }
+    }
+}
+
 void MySampleApp::ApplyRTSCamera(float aspect)
 {
     // Projection stays perspective; keep it synced with window aspect.
@@ -791,6 +1278,21 @@ void MySampleApp::OnRender()
         draw->AddText(ImVec2(sx - ts.x * 0.5f, y1 + SampleTuning::HUD_TEXT_OFFSET_Y_PX), SampleTuning::HUD_TEXT, buf);
     }
 
+    // Box selection rectangle while RMB is held past the click threshold.
+    if (m_boxSelectPending)
+    {
+        const ImVec2 cur = io.MousePos;
+        const float dx = std::abs(cur.x - m_boxSelectStart.x);
+        const float dy = std::abs(cur.y - m_boxSelectStart.y);
+        if (std::max(dx, dy) >= SampleTuning::BOX_SELECT_MIN_DRAG_PX)
+        {
+            const ImVec2 a(std::min(cur.x, m_boxSelectStart.x), std::min(cur.y, m_boxSelectStart.y));
+            const ImVec2 b(std::max(cur.x, m_boxSelectStart.x), std::max(cur.y, m_boxSelectStart.y));
+            draw->AddRectFilled(a, b, SampleTuning::BOX_SELECT_FILL);
+            draw->AddRect(a, b, SampleTuning::BOX_SELECT_BORDER);
+        }
+    }
+
     ImGui::End();
 }
 
@@ -798,27 +1300,31 @@ void MySampleApp::setupECSFromPrefabs()
 {
     auto &ecs = GetECS();
 
-    // Load all prefab definitions from JSON copied next to executable.
+    // Prefab definitions from JSON copied next to executable, read by the startup jobs.
     // (CMake copies Sample/entities/*.json -> <build>/Sample/entities/)
+    if (!m_preload->prefabError.empty())
+    {
+#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
+        std::cerr << "[Prefab] Failed to enumerate entities/: " << m_preload->prefabError << "\n";
+#endif
+        return;
+    }
+
     size_t prefabCount = 0;
     try
     {
-        for (const auto &entry : std::filesystem::directory_iterator("entities"))
+        for (const StartupPreload::PrefabText &prefab : m_preload->prefabs)
         {
-            if (!entry.is_regular_file())
-                continue;
-            if (entry.path().extension() != ".json")
-                continue;
-            const std::string path = entry.path().generic_string();
-            const std::string jsonText = Engine::ECS::readFileText(path);
-            if (jsonText.empty())
+            const std::string &path = prefab.path;
+            if (prefab.text.empty())
             {
 #if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
                 std::cerr << "[Prefab] Failed to read: " << path << "\n";
 #endif
                 continue;
             }
-            Engine::ECS::Prefab p = Engine::ECS::loadPrefabFromJson(jsonText, ecs.components, ecs.archetypes, *m_assets);
+            Engine::ECS::Prefab p = Engine::ECS::loadPrefabFromJson(prefab.text, ecs.components, ecs.archetypes, *m_assets,
+                                                                    /*streamModels=*/true);
             if (p.name.empty())
             {
 #if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
@@ -827,6 +1333,7 @@ void MySampleApp::setupECSFromPrefabs()
                 continue;
             }
             ecs.prefabs.add(p);
+            m_streamingPrefabs.push_back(p.name);
             ++prefabCount;
 #if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
             std::cout << "[Prefab] Loaded " << p.name << " from " << path << "\n";
@@ -836,7 +1343,7 @@ void MySampleApp::setupECSFromPrefabs()
     catch (const std::exception &e)
     {
 #if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
-        std::cerr << "[Prefab] Failed to enumerate entities/: " << e.what() << "\n";
+        std::cerr << "[Prefab] Failed to load prefabs: " << e.what() << "\n";
 #endif
         return;
     }
@@ -849,56 +1356,27 @@ void MySampleApp::setupECSFromPrefabs()
         return;
     }
 
-    Sample::SpawnFromScenarioFile(ecs, "BattleConfig.json", /*selectSpawned=*/false);
+    Sample::SpawnFromScenarioFile(ecs, m_scenarioPath, /*selectSpawned=*/false);
+
+    // --- Load combat tuning from the scenario ---
+    {
+        CombatSystem::CombatConfig cfg;
+        if (Sample::LoadCombatConfigFile(m_scenarioPath, cfg))
+        {
+            m_systems.GetCombatSystemMut().applyConfig(cfg);
+            m_systems.GetCombatSystemMut().setHumanTeam(0); // Team A = human player
+#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
+            std::cout << "[Config] Combat config loaded from " << m_scenarioPath << "\n";
+#endif
+        }
+    }
 
-    // --- Load combat tuning from BattleConfig.json ---
     try
     {
-        std::ifstream cfgFile("BattleConfig.json");
+        std::ifstream cfgFile(m_scenarioPath);
         if (cfgFile.is_open())
         {
             nlohmann::json root = nlohmann::json::parse(cfgFile);
-            if (root.contains("combat") && root["combat"].is_object())
-            {
-                const auto &c = root["combat"];
-                CombatSystem::CombatConfig cfg;
-                if (c.contains("meleeRange"))
-                    cfg.meleeRange = c["meleeRange"].get<float>();
-                if (c.contains("engageRange"))
-                    cfg.engageRange = c["engageRange"].get<float>();
-                if (c.contains("damageMin"))
-                    cfg.damageMin = c["damageMin"].get<float>();
-                if (c.contains("damageMax"))
-                    cfg.damageMax = c["damageMax"].get<float>();
-                // Legacy single-value fallback
-                if (c.contains("damagePerHit") && !c.contains("damageMin"))
-                {
-                    float d = c["damagePerHit"].get<float>();
-                    cfg.damageMin = d * 0.6f;
-                    cfg.damageMax = d * 1.4f;
-                }
-                if (c.contains("deathRemoveDelay"))
-                    cfg.deathRemoveDelay = c["deathRemoveDelay"].get<float>();
-                if (c.contains("maxHPPerUnit"))
-                    cfg.maxHPPerUnit = c["maxHPPerUnit"].get<float>();
-                if (c.contains("missChance"))
-                    cfg.missChance = c["missChance"].get<float>();
-                if (c.contains("critChance"))
-                    cfg.critChance = c["critChance"].get<float>();
-                if (c.contains("critMultiplier"))
-                    cfg.critMultiplier = c["critMultiplier"].get<float>();
-                if (c.contains("rageMaxBonus"))
-                    cfg.rageMaxBonus = c["rageMaxBonus"].get<float>();
-                if (c.contains("cooldownJitter"))
-                    cfg.cooldownJitter = c["cooldownJitter"].get<float>();
-                if (c.contains("staggerMax"))
-                    cfg.staggerMax = c["staggerMax"].get<float>();
-                m_systems.GetCombatSystemMut().applyConfig(cfg);
-                m_systems.GetCombatSystemMut().setHumanTeam(0); // Team A = human player
-#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
-                std::cout << "[Config] Combat config loaded from BattleConfig.json\n";
-#endif
-            }
 
             // Load start zone (click here to begin battle)
             if (root.contains("startZone") && root["startZone"].is_object())
@@ -918,7 +1396,7 @@ void MySampleApp::setupECSFromPrefabs()
     catch (const std::exception &e)
     {
 #if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
-        std::cerr << "[Config] Failed to parse combat config: " << e.what() << "\n";
+        std::cerr << "[Config] Failed to parse start zone: " << e.what() << "\n";
 #endif
     }
 }
@@ -935,6 +1413,23 @@ void MySampleApp::OnEvent(const std::string &name)
         return;
     }
 
+    // Scripted benchmark: no input besides the overlay toggle.
+    if (m_benchmark)
+        return;
+
+    if (evt == "F5Pressed")
+    {
+        SaveGameState();
+        return;
+    }
+
+    if (evt == "F9Pressed")
+    {
+        if (HasSaveFile())
+            LoadGameState();
+        return;
+    }
+
     if (evt == "MouseButtonLeftDown")
     {
         // Skip game input when ImGui is using the mouse (editor sliders, buttons, etc.)
@@ -963,7 +1458,30 @@ void MySampleApp::OnEvent(const std::string &name)
         if (ImGui::GetIO().WantCaptureMouse)
             return;
 
-        PickAndSelectEntityAtCursor();
+        // Click or box: decided on release by how far the cursor moved.
+        auto &win = GetWindow();
+        double mx = 0.0, my = 0.0;
+        win.GetCursorPosition(mx, my);
+        m_boxSelectStart = {static_cast<float>(mx), static_cast<float>(my)};
+        m_boxSelectPending = true;
+        return;
+    }
+
+    if (evt == "MouseButtonRightUp")
+    {
+        if (!m_boxSelectPending)
+            return;
+        m_boxSelectPending = false;
+
+        auto &win = GetWindow();
+        double mx = 0.0, my = 0.0;
+        win.GetCursorPosition(mx, my);
+        const glm::vec2 end{static_cast<float>(mx), static_cast<float>(my)};
+        const glm::vec2 drag = glm::abs(end - m_boxSelectStart);
+        if (std::max(drag.x, drag.y) < SampleTuning::BOX_SELECT_MIN_DRAG_PX)
+            PickAndSelectEntityAtCursor();
+        else
+            SelectEntitiesInScreenRect(m_boxSelectStart, end);
         return;
     }
 
@@ -1009,6 +1527,24 @@ void MySampleApp::SaveGameState()
         j["win_y"] = wy;
     }
 
+    j["battle_started"] = m_systems.GetCombatSystem().isBattleStarted();
+
+    // Units, props and the nav grid as one binary blob (column copies, no JSON per entity).
+    std::string err;
+    Engine::ECS::WorldSnapshotStats stats;
+    if (Engine::ECS::saveWorldSnapshot(m_worldSnapshotPath, GetECS(), &m_systems.GetNavGridMut(), m_assets.get(), err, &stats))
+    {
+        j["world_snapshot"] = m_worldSnapshotPath;
+#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
+        std::cout << "[Sample] Saved " << stats.entities << " entities (" << stats.bytes << " bytes) to "
+                  << m_worldSnapshotPath << "\n";
+#endif
+    }
+    else
+    {
+        std::cerr << "[Sample] " << err << "\n";
+    }
+
     std::ofstream o(m_saveFilePath);
     if (o.good())
         o << j.dump(4);
@@ -1029,6 +1565,36 @@ void MySampleApp::LoadGameState()
     m_rtsCam.pitchDeg = j.value("pitchDeg", m_rtsCam.pitchDeg);
     m_rtsCam.height = j.value("height", m_rtsCam.height);
 
+    const std::string snapshotPath = j.value("world_snapshot", std::string{});
+    if (!snapshotPath.empty())
+    {
+        auto &ecs = GetECS();
+        std::string err;
+        std::vector<Engine::ModelHandle> modelRefs;
+        Engine::ECS::WorldSnapshotStats stats;
+        if (Engine::ECS::loadWorldSnapshot(snapshotPath, ecs, &m_systems.GetNavGridMut(), m_assets.get(), err, &modelRefs, &stats))
+        {
+            // The previous snapshot's references go only after the new ones are taken, so
+            // models both use stay resident.
+            for (Engine::ModelHandle h : m_snapshotModelRefs)
+                m_assets->release(h);
+            m_snapshotModelRefs = std::move(modelRefs);
+
+            m_systems.OnWorldSnapshotLoaded(ecs);
+            if (j.value("battle_started", false))
+                m_systems.GetCombatSystemMut().startBattle();
+            m_inGame = true;
+#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
+            std::cout << "[Sample] Loaded " << stats.entities << " entities in " << stats.stores << " stores from "
+                      << snapshotPath << "\n";
+#endif
+        }
+        else
+        {
+            std::cerr << "[Sample] " << err << "\n";
+        }
+    }
+
     // Re-apply camera projection with current window aspect
     auto &win = GetWindow();
     const float aspect = static_cast<float>(win.GetWidth()) / static_cast<float>(win.GetHeight());
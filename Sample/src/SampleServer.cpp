@@ -0,0 +1,495 @@
+// SampleServer: dedicated-server run of the Sample battle, AI against AI.
+//
+// Creates only the ECSContext, a JobSystem and SystemRunner's simulation schedule (headless:
+// no window, Vulkan device, renderer or presentation systems), spawns the scenario and ticks
+// it at a fixed rate until one team is left or --max-ticks pass. With ENGINE_HEADLESS=ON the
+// whole build links neither Vulkan nor GLFW, so this runs on CPU-only nodes.
+//
+//   SampleServer [--scenario BattleConfig.json] [--battle-config BattleConfig.json] [--entities dir]
+//                [--units N] [--battles 1] [--seed 1] [--threads N] [--hz 30] [--max-ticks 18000]
+//                [--realtime] [--record log.json] [--shards N | NXxNZ] [--out result.json]
+//
+// --battles runs that many battles back to back, battle i with seed + i, and reports each
+// outcome plus wins per team (balance runs). --realtime paces ticks to the wall clock instead
+// of running as fast as possible. --record writes the lockstep log of the first battle
+// (replayable with EcsBench --replay).
+//
+// --shards splits the battlefield into N strips along x (or an NX by NZ grid) and runs one
+// simulation per region in this process, exchanging migrating units, border ghosts and hits
+// on ghosts after every tick (Engine::ECS::WorldShard). Each simulation only sees the bytes a
+// network transport would carry between nodes; the result adds per-shard exchange stats.
+//
+// Log output of the loaders and systems goes to stderr, so stdout carries only the JSON.
+
+#include "update.h"
+#include "ScenarioSpawner.h"
+
+#include "ECS/ECSContext.h"
+#include "ECS/WorldShard.h"
+#include "utils/JobSystem.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef STRATO_SAMPLE_DIR
+#define STRATO_SAMPLE_DIR "."
+#endif
+
+namespace
+{
+    struct ServerOptions
+    {
+        std::string scenarioPath = STRATO_SAMPLE_DIR "/BattleConfig.json";
+        std::string battleConfigPath = STRATO_SAMPLE_DIR "/BattleConfig.json";
+        std::string entitiesDir = STRATO_SAMPLE_DIR "/entities";
+        std::string outPath; // empty = stdout
+        std::string recordPath;
+        uint32_t units = 0; // 0 = as authored
+        uint32_t battles = 1;
+        uint32_t seed = 1;
+        uint32_t threads = std::max(1u, std::thread::hardware_concurrency()) - 1u;
+        uint32_t maxTicks = 18000; // 10 simulated minutes at 30 Hz
+        uint32_t shardsX = 1;
+        uint32_t shardsZ = 1;
+        float hz = 30.0f;
+        bool realtime = false;
+    };
+
+    struct TeamState
+    {
+        uint32_t alive = 0;
+        float hp = 0.0f;
+    };
+
+    struct BattleResult
+    {
+        uint32_t seed = 0;
+        uint32_t spawned = 0;
+        uint32_t ticks = 0;
+        int winner = -1;       // team id; -1 = draw or timeout
+        bool finished = false; // at most one team left before maxTicks
+        double wallMs = 0.0;
+        std::map<int, TeamState> teams;
+        std::vector<Engine::ECS::WorldShard::Stats> shards; // empty without --shards
+    };
+
+    void printUsage()
+    {
+        std::cerr << "usage: SampleServer [--scenario path] [--battle-config path] [--entities dir] [--units N]\n"
+                     "                    [--battles N] [--seed N] [--threads N] [--hz N] [--max-ticks N]\n"
+                     "                    [--realtime] [--record log.json] [--shards N | NXxNZ] [--out path]\n";
+    }
+
+    bool parseArgs(int argc, char **argv, ServerOptions &opt)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const char *arg = argv[i];
+            auto value = [&]() -> const char *
+            {
+                return (i + 1 < argc) ? argv[++i] : nullptr;
+            };
+            auto text = [&](std::string &out)
+            {
+                const char *v = value();
+                if (!v)
+                    return false;
+                out = v;
+                return true;
+            };
+            auto number = [&](uint32_t &out)
+            {
+                const char *v = value();
+                if (!v)
+                    return false;
+                out = static_cast<uint32_t>(std::strtoul(v, nullptr, 10));
+                return true;
+            };
+
+            bool ok = true;
+            if (std::strcmp(arg, "--scenario") == 0)
+                ok = text(opt.scenarioPath);
+            else if (std::strcmp(arg, "--battle-config") == 0)
+                ok = text(opt.battleConfigPath);
+            else if (std::strcmp(arg, "--entities") == 0)
+                ok = text(opt.entitiesDir);
+            else if (std::strcmp(arg, "--out") == 0)
+                ok = text(opt.outPath);
+            else if (std::strcmp(arg, "--record") == 0)
+                ok = text(opt.recordPath);
+            else if (std::strcmp(arg, "--hz") == 0)
+            {
+                const char *v = value();
+                ok = v != nullptr;
+                if (ok)
+                    opt.hz = std::strtof(v, nullptr);
+            }
+            else if (std::strcmp(arg, "--units") == 0)
+                ok = number(opt.units);
+            else if (std::strcmp(arg, "--battles") == 0)
+                ok = number(opt.battles);
+            else if (std::strcmp(arg, "--seed") == 0)
+                ok = number(opt.seed);
+            else if (std::strcmp(arg, "--threads") == 0)
+                ok = number(opt.threads);
+            else if (std::strcmp(arg, "--max-ticks") == 0)
+                ok = number(opt.maxTicks);
+            else if (std::strcmp(arg, "--shards") == 0)
+            {
+                const char *v = value();
+                ok = v != nullptr;
+                if (ok)
+                {
+                    char *end = nullptr;
+                    opt.shardsX = static_cast<uint32_t>(std::strtoul(v, &end, 10));
+                    opt.shardsZ = (*end == 'x' || *end == 'X') ? static_cast<uint32_t>(std::strtoul(end + 1, nullptr, 10)) : 1u;
+                    ok = opt.shardsX > 0 && opt.shardsZ > 0;
+                }
+            }
+            else if (std::strcmp(arg, "--realtime") == 0)
+                opt.realtime = true;
+            else
+                ok = false;
+
+            if (!ok)
+            {
+                std::cerr << "[SampleServer] Bad argument: " << arg << "\n";
+                return false;
+            }
+        }
+        return opt.hz > 0.0f && opt.battles > 0;
+    }
+
+    // Living units (positive Health, movers with a Team) per team, added to teams. Ghosts of
+    // another shard's units are skipped.
+    void countTeams(const Engine::ECS::ECSContext &ecs, const Engine::ECS::SparseTagSet *ghosts, std::map<int, TeamState> &teams)
+    {
+        for (const auto &storePtr : ecs.stores.stores())
+        {
+            if (!storePtr || !storePtr->hasTeam() || !storePtr->hasHealth() || !storePtr->hasVelocity())
+                continue;
+            const auto &team = storePtr->teams();
+            const auto &hp = storePtr->healths();
+            const auto &entities = storePtr->entities();
+            for (uint32_t row = 0; row < storePtr->size(); ++row)
+            {
+                if (hp[row].value <= 0.0f || (ghosts && ghosts->has(entities[row])))
+                    continue;
+                TeamState &t = teams[static_cast<int>(team[row].id)];
+                ++t.alive;
+                t.hp += hp[row].value;
+            }
+        }
+    }
+
+    // One simulation: the whole battle, or one region of it with --shards.
+    struct ShardSim
+    {
+        Engine::ECS::ECSContext ecs;
+        Sample::SystemRunner systems;
+        std::unique_ptr<Engine::ECS::WorldShard> shard;
+
+        const Engine::ECS::SparseTagSet *ghosts() const
+        {
+            return shard ? ecs.sparseTag(shard->ghostTagId()) : nullptr;
+        }
+    };
+
+    std::map<int, TeamState> countTeams(const std::vector<std::unique_ptr<ShardSim>> &sims)
+    {
+        std::map<int, TeamState> teams;
+        for (const std::unique_ptr<ShardSim> &sim : sims)
+            countTeams(sim->ecs, sim->ghosts(), teams);
+        return teams;
+    }
+
+    // Regions split the bounding box of the spawned movers; boundaries fall on cells of cellSize
+    // (the spatial index's, whose grid the nav grid's origin is aligned to).
+    Engine::ECS::ShardLayout shardLayout(const Engine::ECS::ECSContext &ecs, float cellSize, uint32_t regionsX, uint32_t regionsZ)
+    {
+        float minX = 0.0f, minZ = 0.0f, maxX = 0.0f, maxZ = 0.0f;
+        bool any = false;
+        for (const auto &storePtr : ecs.stores.stores())
+        {
+            if (!storePtr || !storePtr->hasPosition() || !storePtr->hasVelocity())
+                continue;
+            const auto &pos = storePtr->positions();
+            for (uint32_t row = 0; row < storePtr->size(); ++row)
+            {
+                minX = any ? std::min(minX, pos[row].x) : pos[row].x;
+                maxX = any ? std::max(maxX, pos[row].x) : pos[row].x;
+                minZ = any ? std::min(minZ, pos[row].z) : pos[row].z;
+                maxZ = any ? std::max(maxZ, pos[row].z) : pos[row].z;
+                any = true;
+            }
+        }
+        return Engine::ECS::ShardLayout::grid(std::floor(minX / cellSize) * cellSize, std::floor(minZ / cellSize) * cellSize,
+                                              std::ceil(maxX / cellSize) * cellSize, std::ceil(maxZ / cellSize) * cellSize,
+                                              cellSize, regionsX, regionsZ);
+    }
+
+    // Trades the messages of one tick between all shards (in process: the "network" is a copy).
+    bool exchangeShards(std::vector<std::unique_ptr<ShardSim>> &sims, std::vector<std::vector<Engine::ECS::ShardMessages>> &outboxes)
+    {
+        outboxes.resize(sims.size());
+        for (size_t s = 0; s < sims.size(); ++s)
+            sims[s]->shard->collect(sims[s]->ecs, outboxes[s]);
+        for (size_t to = 0; to < sims.size(); ++to)
+        {
+            for (size_t from = 0; from < sims.size(); ++from)
+            {
+                if (from == to || outboxes[from][to].empty())
+                    continue;
+                std::string err;
+                if (!sims[to]->shard->deliver(sims[to]->ecs, static_cast<uint32_t>(from), outboxes[from][to], err))
+                {
+                    std::cerr << "[SampleServer] Shard " << to << ": " << err << "\n";
+                    return false;
+                }
+            }
+        }
+        for (const std::unique_ptr<ShardSim> &sim : sims)
+            sim->shard->endExchange(sim->ecs);
+        return true;
+    }
+
+    // One battle on fresh worlds. Returns false when a world could not be set up.
+    bool runBattle(const ServerOptions &opt, Engine::JobSystem &jobs, uint32_t seed, bool record, BattleResult &result)
+    {
+        const uint32_t shardCount = opt.shardsX * opt.shardsZ;
+        std::vector<std::unique_ptr<ShardSim>> sims;
+        result.seed = seed;
+        for (uint32_t s = 0; s < shardCount; ++s)
+        {
+            sims.push_back(std::make_unique<ShardSim>());
+            Engine::ECS::ECSContext &ecs = sims.back()->ecs;
+            ecs.SetJobSystem(&jobs);
+            ecs.WireQueryManager();
+
+            if (Sample::LoadPrefabsHeadless(ecs, opt.entitiesDir) == 0)
+            {
+                std::cerr << "[SampleServer] No prefabs loaded from " << opt.entitiesDir << "\n";
+                return false;
+            }
+            // Every shard spawns the whole (deterministic) scenario, then keeps its region's movers.
+            result.spawned = Sample::SpawnFromScenarioFile(ecs, opt.scenarioPath, /*selectSpawned=*/false, opt.units);
+        }
+
+        // On the whole world, before the shards drop their foreign units.
+        float zx = 0.0f, zz = 0.0f;
+        Sample::BattleStartPoint(sims[0]->ecs, opt.battleConfigPath, zx, zz);
+
+        if (shardCount > 1)
+        {
+            const Engine::ECS::ShardLayout layout =
+                shardLayout(sims[0]->ecs, sims[0]->systems.GetSpatialIndex().getCellSize(), opt.shardsX, opt.shardsZ);
+            for (uint32_t s = 0; s < shardCount; ++s)
+            {
+                ShardSim &sim = *sims[s];
+                sim.shard = std::make_unique<Engine::ECS::WorldShard>(layout, s);
+                sim.shard->attach(sim.ecs);
+                sim.shard->keepOwned(sim.ecs);
+            }
+            if (record)
+            {
+                std::cerr << "[SampleServer] --record is ignored with --shards\n";
+                record = false;
+            }
+        }
+
+        for (const std::unique_ptr<ShardSim> &sim : sims)
+        {
+            Sample::SystemRunner &systems = sim->systems;
+            systems.SetHeadless(true);
+            {
+                CombatSystem::CombatConfig cfg;
+                if (Sample::LoadCombatConfigFile(opt.battleConfigPath, cfg))
+                    systems.GetCombatSystemMut().applyConfig(cfg);
+                systems.GetCombatSystemMut().setRandomSeed(seed);
+                systems.GetCombatSystemMut().setHumanTeam(-1);
+            }
+            systems.Initialize(sim->ecs);
+            systems.SetDeterministicPlanning(true);
+            if (record)
+            {
+                Sample::SimulationLog settings;
+                settings.seed = seed;
+                settings.stepSeconds = 1.0f / opt.hz;
+                settings.scenario = opt.scenarioPath;
+                systems.EnableLockstep(sim->ecs, settings);
+            }
+            systems.StartBattle(zx, zz);
+        }
+
+        const float step = 1.0f / opt.hz;
+        // Team counts once per simulated second: a scan of every mover is not free at scale.
+        const uint32_t checkInterval = std::max(1u, static_cast<uint32_t>(opt.hz));
+        const auto tickDuration = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(step));
+
+        std::vector<std::vector<Engine::ECS::ShardMessages>> outboxes;
+        const auto start = std::chrono::steady_clock::now();
+        auto deadline = start;
+        uint32_t tick = 0;
+        while (tick < opt.maxTicks)
+        {
+            if (opt.realtime)
+            {
+                deadline += tickDuration;
+                std::this_thread::sleep_until(deadline);
+            }
+            for (const std::unique_ptr<ShardSim> &sim : sims)
+                sim->systems.SimulateTicks(sim->ecs, 1u, step);
+            if (shardCount > 1 && !exchangeShards(sims, outboxes))
+                return false;
+            ++tick;
+
+            if (tick % checkInterval != 0)
+                continue;
+            const std::map<int, TeamState> teams = countTeams(sims);
+            if (teams.size() <= 1)
+            {
+                result.finished = true;
+                result.winner = teams.empty() ? -1 : teams.begin()->first;
+                break;
+            }
+            if (tick % (checkInterval * 10u) == 0)
+            {
+                std::cerr << "[SampleServer] seed " << seed << " t=" << (tick / checkInterval) << "s";
+                for (const auto &[team, state] : teams)
+                    std::cerr << " team" << team << "=" << state.alive;
+                std::cerr << "\n";
+            }
+        }
+        result.wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        result.ticks = tick;
+        result.teams = countTeams(sims);
+        for (const std::unique_ptr<ShardSim> &sim : sims)
+        {
+            if (sim->shard)
+                result.shards.push_back(sim->shard->stats());
+        }
+
+        if (record)
+        {
+            std::string err;
+            if (!sims[0]->systems.GetSimulationLog().save(opt.recordPath, err))
+                std::cerr << "[SampleServer] " << err << "\n";
+        }
+        return true;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    ServerOptions opt;
+    if (!parseArgs(argc, argv, opt))
+    {
+        printUsage();
+        return 2;
+    }
+
+    // Keep stdout for the JSON result.
+    std::streambuf *stdoutBuf = std::cout.rdbuf(std::cerr.rdbuf());
+
+    Engine::JobSystem jobs(opt.threads);
+
+    std::vector<BattleResult> results;
+    results.reserve(opt.battles);
+    for (uint32_t i = 0; i < opt.battles; ++i)
+    {
+        BattleResult result;
+        if (!runBattle(opt, jobs, opt.seed + i, i == 0 && !opt.recordPath.empty(), result))
+        {
+            std::cout.rdbuf(stdoutBuf);
+            return 1;
+        }
+        std::cerr << "[SampleServer] Battle " << i << " (seed " << result.seed << "): "
+                  << (result.finished ? (result.winner >= 0 ? "team " + std::to_string(result.winner) + " wins" : std::string("draw"))
+                                      : std::string("timeout"))
+                  << " after " << result.ticks << " ticks\n";
+        results.push_back(std::move(result));
+    }
+
+    nlohmann::json out;
+    out["scenario"] = opt.scenarioPath;
+    out["unitsRequested"] = opt.units;
+    out["stepSeconds"] = 1.0f / opt.hz;
+    out["maxTicks"] = opt.maxTicks;
+    out["workerThreads"] = opt.threads;
+    out["realtime"] = opt.realtime;
+    out["shards"] = {opt.shardsX, opt.shardsZ};
+
+    std::map<int, uint32_t> wins;
+    uint32_t unresolved = 0;
+    double totalTicks = 0.0, totalWallMs = 0.0;
+    nlohmann::json battlesJson = nlohmann::json::array();
+    for (const BattleResult &r : results)
+    {
+        if (r.finished && r.winner >= 0)
+            ++wins[r.winner];
+        else
+            ++unresolved;
+        totalTicks += r.ticks;
+        totalWallMs += r.wallMs;
+
+        nlohmann::json teamsJson = nlohmann::json::object();
+        for (const auto &[team, state] : r.teams)
+            teamsJson[std::to_string(team)] = {{"alive", state.alive}, {"hp", state.hp}};
+        nlohmann::json shardsJson = nlohmann::json::array();
+        for (const Engine::ECS::WorldShard::Stats &st : r.shards)
+            shardsJson.push_back({{"migratedOut", st.migratedOut},
+                                  {"migratedIn", st.migratedIn},
+                                  {"ghostsSent", st.ghostsSent},
+                                  {"ghosts", st.ghosts},
+                                  {"damageForwarded", st.damageForwarded},
+                                  {"bytesSent", st.bytesSent}});
+        battlesJson.push_back({{"seed", r.seed},
+                               {"entitiesSpawned", r.spawned},
+                               {"ticks", r.ticks},
+                               {"finished", r.finished},
+                               {"winner", r.winner},
+                               {"wallMs", r.wallMs},
+                               {"meanTickMs", r.ticks ? r.wallMs / r.ticks : 0.0},
+                               {"survivors", std::move(teamsJson)},
+                               {"shards", std::move(shardsJson)}});
+    }
+    out["battles"] = std::move(battlesJson);
+
+    nlohmann::json winsJson = nlohmann::json::object();
+    for (const auto &[team, count] : wins)
+        winsJson[std::to_string(team)] = count;
+    out["wins"] = std::move(winsJson);
+    out["unresolved"] = unresolved;
+    out["meanTicks"] = totalTicks / static_cast<double>(results.size());
+    out["totalWallMs"] = totalWallMs;
+
+    std::cout.rdbuf(stdoutBuf);
+    if (opt.outPath.empty())
+    {
+        std::cout << out.dump(2) << "\n";
+    }
+    else
+    {
+        std::ofstream file(opt.outPath);
+        if (!file.is_open())
+        {
+            std::cerr << "[SampleServer] Cannot write " << opt.outPath << "\n";
+            return 1;
+        }
+        file << out.dump(2) << "\n";
+    }
+    return 0;
+}
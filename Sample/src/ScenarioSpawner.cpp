@@ -8,10 +8,15 @@
 
 #include <nlohmann/json.hpp>
 
+#include <algorithm>
 #include <cmath>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <random>
+#include <type_traits>
 #include <unordered_map>
+#include <vector>
 
 namespace
 {
@@ -35,14 +40,15 @@ namespace
         return 2.0f * (r + s);
     }
 
-    std::unordered_map<std::string, std::pair<float, float>> parseAnchors(const nlohmann::json &j)
-    {
-        std::unordered_map<std::string, std::pair<float, float>> anchors;
+    using AnchorMap = std::unordered_map<std::string, std::pair<float, float>>;
 
-        if (!j.contains("anchors") || !j["anchors"].is_object())
+    AnchorMap parseAnchors(const nlohmann::json &anchorsObject)
+    {
+        AnchorMap anchors;
+        if (!anchorsObject.is_object())
             return anchors;
 
-        for (auto it = j["anchors"].begin(); it != j["anchors"].end(); ++it)
+        for (auto it = anchorsObject.begin(); it != anchorsObject.end(); ++it)
         {
             const std::string key = it.key();
             const auto &a = it.value();
@@ -54,23 +60,17 @@ namespace
         return anchors;
     }
 
-    SpawnGroupResolved parseSpawnGroup(const nlohmann::json &g,
-                                       const std::unordered_map<std::string, std::pair<float, float>> &anchors)
+    // Origin is the group's offset; the anchor it is relative to goes to outAnchor (resolveAnchor).
+    SpawnGroupResolved parseSpawnGroup(const nlohmann::json &g, std::string &outAnchor)
     {
         SpawnGroupResolved sg;
         sg.id = g.value("id", std::string("(no-id)"));
         sg.unitType = g.value("unitType", std::string(""));
         sg.count = g.value("count", 0);
 
-        const std::string anchorName = g.value("anchor", std::string(""));
-        const auto anchorIt = anchors.find(anchorName);
-        const float anchorX = (anchorIt != anchors.end()) ? anchorIt->second.first : 0.0f;
-        const float anchorZ = (anchorIt != anchors.end()) ? anchorIt->second.second : 0.0f;
-
-        const float offX = g.contains("offset") ? g["offset"].value("x", 0.0f) : 0.0f;
-        const float offZ = g.contains("offset") ? g["offset"].value("z", 0.0f) : 0.0f;
-        sg.originX = anchorX + offX;
-        sg.originZ = anchorZ + offZ;
+        outAnchor = g.value("anchor", std::string(""));
+        sg.originX = g.contains("offset") ? g["offset"].value("x", 0.0f) : 0.0f;
+        sg.originZ = g.contains("offset") ? g["offset"].value("z", 0.0f) : 0.0f;
 
         // Defaults
         sg.formationKind = "grid";
@@ -79,7 +79,8 @@ namespace
         sg.jitterM = 0.0f;
         sg.spacingAuto = true;
         sg.spacingM = 0.0f;
-        sg.team = g.value("team", -1);
+        // Named teams ("Neutral") get no team assignment.
+        sg.team = (g.contains("team") && g["team"].is_number_integer()) ? g["team"].get<int>() : -1;
         sg.facingYawDeg = g.value("facingYawDeg", 0.0f);
 
         if (g.contains("formation") && g["formation"].is_object())
@@ -107,6 +108,18 @@ namespace
         return sg;
     }
 
+    // Scale a group to count * scale units on about the same footprint: more columns, tighter
+    // spacing (never below the prefab's auto spacing).
+    void scaleSpawnGroup(SpawnGroupResolved &sg, float scale, float autoSpacingM)
+    {
+        const float side = std::sqrt(scale);
+        sg.count = std::max(1, static_cast<int>(std::lround(static_cast<float>(sg.count) * scale)));
+        if (sg.columns > 0)
+            sg.columns = std::max(1, static_cast<int>(std::lround(static_cast<float>(sg.columns) * side)));
+        if (!sg.spacingAuto && side > 1.0f)
+            sg.spacingM = std::max(autoSpacingM, sg.spacingM / side);
+    }
+
     std::pair<float, float> computeFormationOffset(const SpawnGroupResolved &sg, int i, float spacingM)
     {
         const bool isCircle = (sg.formationKind == "circle");
@@ -132,267 +145,782 @@ namespace
         const float oz = (static_cast<float>(row) - halfH) * spacingM;
         return {ox, oz};
     }
-}
 
-namespace Sample
-{
-    uint32_t SpawnFromScenarioFile(Engine::ECS::ECSContext &ecs, const std::string &scenarioPath, bool selectSpawned)
+    void resolveAnchor(SpawnGroupResolved &sg, const AnchorMap &anchors, const std::string &anchorName)
+    {
+        const auto it = anchors.find(anchorName);
+        if (it == anchors.end())
+            return;
+        sg.originX += it->second.first;
+        sg.originZ += it->second.second;
+    }
+
+    // ------------------------------------------------------------
+    // Obstacles
+    // ------------------------------------------------------------
+    struct ObstacleGap
     {
-        const std::string text = Engine::ECS::readFileText(scenarioPath);
-        if (text.empty())
+        float gx = 0.0f, gz = 0.0f, w = 0.0f;
+    };
+
+    // A wall of prefab posts from start to end, every spacing meters, minus the gaps.
+    struct ObstacleLine
+    {
+        std::string prefab;
+        float sx = 0.0f, sz = 0.0f;
+        float ex = 0.0f, ez = 0.0f;
+        float spacing = 2.0f;
+        std::vector<ObstacleGap> gaps;
+    };
+
+    ObstacleLine parseObstacle(const nlohmann::json &obs)
+    {
+        ObstacleLine line;
+        line.prefab = obs.value("prefab", "");
+        if (obs.contains("start"))
         {
-#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
-            std::cerr << "[Scenario] Failed to read " << scenarioPath << " next to executable\n";
-#endif
-            return 0;
+            line.sx = obs["start"].value("x", 0.0f);
+            line.sz = obs["start"].value("z", 0.0f);
+        }
+        if (obs.contains("end"))
+        {
+            line.ex = obs["end"].value("x", 0.0f);
+            line.ez = obs["end"].value("z", 0.0f);
         }
 
-        nlohmann::json j;
-        try
+        line.spacing = obs.value("spacing", 2.0f);
+        if (line.spacing <= 0.1f)
+            line.spacing = 0.1f;
+
+        if (obs.contains("gaps") && obs["gaps"].is_array())
         {
-            j = nlohmann::json::parse(text);
+            for (const auto &g : obs["gaps"])
+            {
+                ObstacleGap gap;
+                if (g.contains("center"))
+                {
+                    gap.gx = g["center"].value("x", 0.0f);
+                    gap.gz = g["center"].value("z", 0.0f);
+                }
+                gap.w = g.value("width", 0.0f);
+                line.gaps.push_back(gap);
+            }
         }
-        catch (const std::exception &e)
+        return line;
+    }
+
+    void spawnObstacleLine(Engine::ECS::ECSContext &ecs, const ObstacleLine &line)
+    {
+        if (line.prefab.empty())
+            return;
+
+        const Engine::ECS::Prefab *prefab = ecs.prefabs.get(line.prefab);
+        if (!prefab)
         {
 #if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
-            std::cerr << "[Scenario] JSON parse error: " << e.what() << "\n";
+            std::cerr << "[Scenario] Missing obstacle prefab: " << line.prefab << "\n";
 #endif
-            return 0;
+            return;
+        }
+
+        const float dx = line.ex - line.sx;
+        const float dz = line.ez - line.sz;
+        const float len = std::sqrt(dx * dx + dz * dz);
+
+        // Direction along the wall
+        const float ndx = (len > 1e-4f) ? dx / len : 0.0f;
+        const float ndz = (len > 1e-4f) ? dz / len : 0.0f;
+
+        // Posts from start to end inclusive.
+        const int count = static_cast<int>(std::floor(len / line.spacing));
+
+        std::vector<Engine::ECS::Position> posts;
+        posts.reserve(static_cast<size_t>(count) + 1u);
+        for (int i = 0; i <= count; ++i)
+        {
+            const float t = static_cast<float>(i) * line.spacing;
+            if (t > len)
+                break;
+
+            const float px = line.sx + ndx * t;
+            const float pz = line.sz + ndz * t;
+
+            // A post within width/2 of a gap center is left out.
+            bool inGap = false;
+            for (const ObstacleGap &g : line.gaps)
+            {
+                const float gdx = px - g.gx;
+                const float gdz = pz - g.gz;
+                if (gdx * gdx + gdz * gdz <= (g.w * 0.5f) * (g.w * 0.5f))
+                {
+                    inGap = true;
+                    break;
+                }
+            }
+
+            if (!inGap)
+                posts.push_back(Engine::ECS::Position{px, 0.0f, pz});
         }
 
-        const std::string scenarioName = j.value("name", std::string("(unnamed)"));
+        // One batch per wall; the rows are marked dirty so pose/world caches initialize.
+        Engine::ECS::spawnBatch(*prefab, ecs, static_cast<uint32_t>(posts.size()), posts.data());
+    }
+
+    // ------------------------------------------------------------
+    // Spawn groups
+    // ------------------------------------------------------------
+    // Returns how many units the group spawned.
+    uint32_t spawnGroup(Engine::ECS::ECSContext &ecs, const SpawnGroupResolved &sg, bool selectSpawned, uint32_t selectedId)
+    {
+        if (sg.unitType.empty() || sg.count <= 0)
+        {
 #if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
-        std::cout << "[Scenario] Loading: " << scenarioName << "\n";
+            std::cerr << "[Scenario] Skipping group id=" << sg.id << " (missing unitType or count)\n";
 #endif
+            return 0;
+        }
 
-        if (!j.contains("spawnGroups") || !j["spawnGroups"].is_array())
+        const Engine::ECS::Prefab *prefab = ecs.prefabs.get(sg.unitType);
+        if (!prefab)
         {
 #if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
-            std::cerr << "[Scenario] Missing spawnGroups[]\n";
+            std::cerr << "[Scenario] Missing prefab for unitType=" << sg.unitType << " (group=" << sg.id << ")\n";
 #endif
             return 0;
         }
 
-        const auto anchors = parseAnchors(j);
-        const uint32_t selectedId = ecs.components.ensureId("Selected");
+        const float spacingM = sg.spacingAuto ? prefabAutoSpacingMeters(*prefab, ecs.components) : sg.spacingM;
 
-        // ---------------------------------------------------------
-        // Spawn Obstacles
-        // ---------------------------------------------------------
-        if (j.contains("obstacles") && j["obstacles"].is_array())
-        {
-            for (const auto &obs : j["obstacles"])
-            {
-                std::string prefabName = obs.value("prefab", "");
-                if (prefabName.empty())
-                    continue;
+        std::mt19937 rng(static_cast<uint32_t>(std::hash<std::string>{}(sg.id)));
+        std::uniform_real_distribution<float> jitter(-sg.jitterM, sg.jitterM);
 
-                const Engine::ECS::Prefab *prefab = ecs.prefabs.get(prefabName);
-                if (!prefab)
-                {
 #if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
-                    std::cerr << "[Scenario] Missing obstacle prefab: " << prefabName << "\n";
+        std::cout << "[Scenario] Spawn group id=" << sg.id
+                  << " unitType=" << sg.unitType
+                  << " count=" << sg.count
+                  << " origin=(" << sg.originX << "," << sg.originZ << ")"
+                  << " formation=" << sg.formationKind
+                  << " spacingM=" << spacingM
+                  << " jitterM=" << sg.jitterM << "\n";
 #endif
-                    continue;
-                }
 
-                // Line parameters
-                float sx = 0.0f, sz = 0.0f;
-                float ex = 0.0f, ez = 0.0f;
-                if (obs.contains("start"))
-                {
-                    sx = obs["start"].value("x", 0.0f);
-                    sz = obs["start"].value("z", 0.0f);
-                }
-                if (obs.contains("end"))
-                {
-                    ex = obs["end"].value("x", 0.0f);
-                    ez = obs["end"].value("z", 0.0f);
-                }
+        std::vector<Engine::ECS::Position> positions(static_cast<size_t>(sg.count));
+        for (int i = 0; i < sg.count; ++i)
+        {
+            float x = sg.originX;
+            float z = sg.originZ;
 
-                float spacing = obs.value("spacing", 2.0f);
-                if (spacing <= 0.1f)
-                    spacing = 0.1f;
+            const auto [ox, oz] = computeFormationOffset(sg, i, spacingM);
+            x += ox;
+            z += oz;
 
-                // Gaps
-                struct Gap
-                {
-                    float gx, gz, w;
-                };
-                std::vector<Gap> gaps;
-                if (obs.contains("gaps") && obs["gaps"].is_array())
-                {
-                    for (const auto &g : obs["gaps"])
-                    {
-                        float gx = 0.0f, gz = 0.0f, w = 0.0f;
-                        if (g.contains("center"))
-                        {
-                            gx = g["center"].value("x", 0.0f);
-                            gz = g["center"].value("z", 0.0f);
-                        }
-                        w = g.value("width", 0.0f);
-                        gaps.push_back({gx, gz, w});
-                    }
-                }
+            x += jitter(rng);
+            z += jitter(rng);
 
-                // Calculate wall
-                float dx = ex - sx;
-                float dz = ez - sz;
-                float len = std::sqrt(dx * dx + dz * dz);
+            positions[i] = Engine::ECS::Position{x, 0.0f, z};
+        }
 
-                // Normal direction
-                float ndx = (len > 1e-4f) ? dx / len : 0.0f;
-                float ndz = (len > 1e-4f) ? dz / len : 0.0f;
+        // The whole group in one batch; its rows start out dirty for every dirty query, so the
+        // team/facing writes below need no extra marks.
+        std::vector<Engine::ECS::Entity> spawned(selectSpawned ? positions.size() : 0u);
+        const Engine::ECS::SpawnBatchResult batch =
+            Engine::ECS::spawnBatch(*prefab, ecs, static_cast<uint32_t>(positions.size()), positions.data(),
+                                    selectSpawned ? spawned.data() : nullptr);
+        Engine::ECS::ArchetypeStore *store = ecs.stores.get(batch.archetypeId);
+        if (!store || !store->hasPosition())
+            return 0;
 
-                int count = static_cast<int>(std::floor(len / spacing));
-                // Add one for the end post? Usually walls are segments.
-                // Let's do points along the line.
-                // If we want to cover start to end inclusive:
+        const uint32_t endRow = batch.firstRow + batch.count;
+        if (sg.team >= 0 && store->hasTeam())
+        {
+            auto teams = store->teams();
+            for (uint32_t row = batch.firstRow; row < endRow; ++row)
+                teams[row].id = static_cast<uint8_t>(sg.team);
+        }
 
-                for (int i = 0; i <= count; ++i)
-                {
-                    float t = static_cast<float>(i) * spacing;
-                    if (t > len)
-                        break; // Should not happen with <= count
-
-                    float px = sx + ndx * t;
-                    float pz = sz + ndz * t;
-
-                    // Check gaps
-                    bool inGap = false;
-                    for (const auto &g : gaps)
-                    {
-                        float gdx = px - g.gx;
-                        float gdz = pz - g.gz;
-                        // Simple distance check to gap center
-                        // Ideally we project onto the line, but gaps are defined by center on the line?
-                        // Assuming gaps are circular or just "near" the point.
-                        // Width implies linear gap along the wall.
-                        // Check distance to gap center <= width/2.
-                        float distSq = gdx * gdx + gdz * gdz;
-                        if (distSq <= (g.w * 0.5f) * (g.w * 0.5f))
-                        {
-                            inGap = true;
-                            break;
-                        }
-                    }
-
-                    if (inGap)
-                        continue;
-
-                    // Spawn (ECSContext overload marks the row dirty so pose/world caches initialize)
-                    Engine::ECS::SpawnResult res = Engine::ECS::spawnFromPrefab(*prefab, ecs);
-                    Engine::ECS::ArchetypeStore *store = ecs.stores.get(res.archetypeId);
-                    if (store && store->hasPosition())
-                    {
-                        auto &p = store->positions()[res.row];
-                        p.x = px;
-                        p.y = 0.0f;
-                        p.z = pz;
-
-                        // We mutated Position after defaults; ensure dirty-driven systems see it.
-                        ecs.markDirty(ecs.components.ensureId("Position"), res.archetypeId, res.row);
-
-                        // Facing? Maybe random rotation for variety? Or align with wall?
-                        // Prefab default is 0. Leaves it as is.
-                    }
-                }
-            }
+        // Set initial facing
+        if (store->hasFacing() && std::abs(sg.facingYawDeg) > 1e-3f)
+        {
+            const float PI = 3.14159265358979f;
+            auto facings = store->facings();
+            for (uint32_t row = batch.firstRow; row < endRow; ++row)
+                facings[row].yaw = sg.facingYawDeg * PI / 180.0f;
         }
 
-        uint32_t totalSpawned = 0;
-        for (const auto &g : j["spawnGroups"])
+        for (const Engine::ECS::Entity e : spawned)
+            ecs.addTag(e, selectedId);
+
+        return batch.count;
+    }
+
+    // Pre-size the world for the group (ECSContext::reserve) before anything of it spawns.
+    void reserveGroup(Engine::ECS::ECSContext &ecs, const SpawnGroupResolved &sg)
+    {
+        if (sg.count <= 0)
+            return;
+        if (const Engine::ECS::Prefab *prefab = ecs.prefabs.get(sg.unitType))
+            ecs.reserve(*prefab, static_cast<uint32_t>(sg.count));
+    }
+
+    // Scale the groups of moving units (prefabs with Velocity) so they add up to targetUnitCount.
+    void scaleUnitGroups(Engine::ECS::ECSContext &ecs, std::vector<SpawnGroupResolved> &groups, uint32_t targetUnitCount)
+    {
+        const uint32_t velocityId = ecs.components.ensureId("Velocity");
+        auto isUnitGroup = [&](const SpawnGroupResolved &sg)
         {
-            const SpawnGroupResolved sg = parseSpawnGroup(g, anchors);
+            const Engine::ECS::Prefab *prefab = ecs.prefabs.get(sg.unitType);
+            return prefab && sg.count > 0 && prefab->signature.has(velocityId);
+        };
 
-            if (sg.unitType.empty() || sg.count <= 0)
-            {
+        uint32_t authored = 0;
+        for (const auto &sg : groups)
+            authored += isUnitGroup(sg) ? static_cast<uint32_t>(sg.count) : 0u;
+
+        if (authored == 0)
+        {
 #if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
-                std::cerr << "[Scenario] Skipping group id=" << sg.id << " (missing unitType or count)\n";
+            std::cerr << "[Scenario] No unit groups to scale to " << targetUnitCount << " units\n";
 #endif
+            return;
+        }
+
+        const float scale = static_cast<float>(targetUnitCount) / static_cast<float>(authored);
+        SpawnGroupResolved *last = nullptr;
+        uint32_t scaled = 0;
+        for (auto &sg : groups)
+        {
+            if (!isUnitGroup(sg))
                 continue;
+            scaleSpawnGroup(sg, scale, prefabAutoSpacingMeters(*ecs.prefabs.get(sg.unitType), ecs.components));
+            scaled += static_cast<uint32_t>(sg.count);
+            last = &sg;
+        }
+        // Rounding remainder goes to the last unit group.
+        const int64_t diff = static_cast<int64_t>(targetUnitCount) - static_cast<int64_t>(scaled);
+        last->count = static_cast<int>(std::max<int64_t>(1, static_cast<int64_t>(last->count) + diff));
+    }
+
+    // Receives a scenario as it is read. Obstacles spawn on arrival; groups too, unless the run is
+    // resized, which needs every group's authored count first (only the small resolved structs
+    // are kept for that, never the document).
+    class ScenarioSpawnSink
+    {
+    public:
+        ScenarioSpawnSink(Engine::ECS::ECSContext &ecs, bool selectSpawned, uint32_t targetUnitCount)
+            : m_ecs(ecs), m_selectSpawned(selectSpawned), m_targetUnitCount(targetUnitCount),
+              m_selectedId(ecs.components.ensureId("Selected"))
+        {
+        }
+
+        void name(const std::string &scenarioName)
+        {
+#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
+            std::cout << "[Scenario] Loading: " << scenarioName << "\n";
+#else
+            (void)scenarioName;
+#endif
+        }
+
+        void obstacle(const ObstacleLine &line) { spawnObstacleLine(m_ecs, line); }
+
+        void group(SpawnGroupResolved &&sg)
+        {
+            if (m_targetUnitCount > 0)
+            {
+                m_deferred.push_back(std::move(sg));
+                return;
             }
+            reserveGroup(m_ecs, sg);
+            m_spawned += spawnGroup(m_ecs, sg, m_selectSpawned, m_selectedId);
+        }
 
-            const Engine::ECS::Prefab *prefab = ecs.prefabs.get(sg.unitType);
-            if (!prefab)
+        uint32_t finish()
+        {
+            if (m_targetUnitCount > 0)
             {
+                scaleUnitGroups(m_ecs, m_deferred, m_targetUnitCount);
+                // Every group's final count is known: reserve the whole battle, then spawn it.
+                for (const SpawnGroupResolved &sg : m_deferred)
+                    reserveGroup(m_ecs, sg);
+                for (const SpawnGroupResolved &sg : m_deferred)
+                    m_spawned += spawnGroup(m_ecs, sg, m_selectSpawned, m_selectedId);
+                m_deferred.clear();
+            }
+            return m_spawned;
+        }
+
+        uint32_t spawned() const { return m_spawned; }
+
+    private:
+        Engine::ECS::ECSContext &m_ecs;
+        bool m_selectSpawned = true;
+        uint32_t m_targetUnitCount = 0;
+        uint32_t m_selectedId = 0;
+        uint32_t m_spawned = 0;
+        std::vector<SpawnGroupResolved> m_deferred;
+    };
+
+    // ------------------------------------------------------------
+    // Streamed JSON
+    // ------------------------------------------------------------
+    // Parses the scenario through a parser callback: each element of "obstacles" and "spawnGroups"
+    // goes to the sink as soon as its closing brace is read and is then dropped from the document,
+    // so peak memory is one element rather than the whole DOM. The file is read through a stream.
+    // Groups that name an anchor before "anchors" has been read wait (as resolved structs) until
+    // the end; from the first such group on, later groups wait too so the file order is kept.
+    // Returns false (and logs) on a read or parse error; what the sink got before it stays spawned.
+    template <typename Sink>
+    bool streamScenarioJson(const std::string &path, Sink &sink)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open())
+        {
 #if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
-                std::cerr << "[Scenario] Missing prefab for unitType=" << sg.unitType << " (group=" << sg.id << ")\n";
+            std::cerr << "[Scenario] Failed to read " << path << " next to executable\n";
 #endif
-                continue;
+            return false;
+        }
+
+        using Event = nlohmann::json::parse_event_t;
+        std::string section; // current key of the root object
+        AnchorMap anchors;
+        bool anchorsRead = false;
+        bool sawGroups = false;
+        std::vector<std::pair<SpawnGroupResolved, std::string>> waiting; // group, anchor name
+
+        auto callback = [&](int depth, Event event, nlohmann::json &parsed) -> bool
+        {
+            if (depth == 1 && event == Event::key)
+            {
+                section = parsed.get<std::string>();
+                return true;
+            }
+            if (depth == 1 && section == "name" && event == Event::value && parsed.is_string())
+            {
+                sink.name(parsed.get<std::string>());
+                return true;
+            }
+            if (depth == 1 && section == "anchors" && event == Event::object_end)
+            {
+                anchors = parseAnchors(parsed);
+                anchorsRead = true;
+                return false;
+            }
+            if (depth == 1 && section == "spawnGroups" && event == Event::array_start)
+                sawGroups = true;
+            if (depth != 2 || event != Event::object_end)
+                return true;
+
+            if (section == "obstacles")
+            {
+                sink.obstacle(parseObstacle(parsed));
+                return false;
+            }
+            if (section == "spawnGroups")
+            {
+                std::string anchorName;
+                SpawnGroupResolved sg = parseSpawnGroup(parsed, anchorName);
+                if (waiting.empty() && (anchorsRead || anchorName.empty()))
+                {
+                    resolveAnchor(sg, anchors, anchorName);
+                    sink.group(std::move(sg));
+                }
+                else
+                {
+                    waiting.emplace_back(std::move(sg), std::move(anchorName));
+                }
+                return false;
             }
+            return true;
+        };
 
-            const float spacingM = sg.spacingAuto ? prefabAutoSpacingMeters(*prefab, ecs.components) : sg.spacingM;
+        try
+        {
+            // What stays in the root (everything outside the two lists) is small.
+            const nlohmann::json root = nlohmann::json::parse(file, callback);
+            (void)root;
+        }
+        catch (const std::exception &e)
+        {
+#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
+            std::cerr << "[Scenario] JSON parse error: " << e.what() << "\n";
+#else
+            (void)e;
+#endif
+            return false;
+        }
 
-            std::mt19937 rng(static_cast<uint32_t>(std::hash<std::string>{}(sg.id)));
-            std::uniform_real_distribution<float> jitter(-sg.jitterM, sg.jitterM);
+        for (auto &w : waiting)
+        {
+            resolveAnchor(w.first, anchors, w.second);
+            sink.group(std::move(w.first));
+        }
 
 #if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
-            std::cout << "[Scenario] Spawn group id=" << sg.id
-                      << " unitType=" << sg.unitType
-                      << " count=" << sg.count
-                      << " origin=(" << sg.originX << "," << sg.originZ << ")"
-                      << " formation=" << sg.formationKind
-                      << " spacingM=" << spacingM
-                      << " jitterM=" << sg.jitterM << "\n";
+        if (!sawGroups)
+            std::cerr << "[Scenario] Missing spawnGroups[]\n";
 #endif
+        return sawGroups;
+    }
 
-            const uint32_t positionId = ecs.components.ensureId("Position");
-            const uint32_t facingId = ecs.components.ensureId("Facing");
+    // ------------------------------------------------------------
+    // Compiled scenarios
+    // ------------------------------------------------------------
+    // "SCNB", version, then tagged records until SCENARIO_END, in file order. Anchors and offsets
+    // are resolved at compile time; prefab-dependent choices (auto spacing, resizing) stay with
+    // the loader. Native endianness, like the snapshot formats.
+    constexpr uint32_t SCENARIO_BINARY_MAGIC = 0x424E4353u; // "SCNB"
+    constexpr uint32_t SCENARIO_BINARY_VERSION = 1u;
+    constexpr uint8_t SCENARIO_NAME = 'N';
+    constexpr uint8_t SCENARIO_OBSTACLE = 'O';
+    constexpr uint8_t SCENARIO_GROUP = 'G';
+    constexpr uint8_t SCENARIO_END = 'E';
+    constexpr uint32_t SCENARIO_MAX_STRING = 1u << 16;
+    constexpr uint32_t SCENARIO_MAX_GAPS = 1u << 20;
+
+    template <typename T>
+    void writePod(std::ostream &out, const T &v)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "writePod takes trivially copyable types");
+        out.write(reinterpret_cast<const char *>(&v), sizeof(T));
+    }
 
-            for (int i = 0; i < sg.count; ++i)
-            {
-                float x = sg.originX;
-                float z = sg.originZ;
+    void writeString(std::ostream &out, const std::string &s)
+    {
+        writePod(out, static_cast<uint32_t>(s.size()));
+        out.write(s.data(), static_cast<std::streamsize>(s.size()));
+    }
 
-                const auto [ox, oz] = computeFormationOffset(sg, i, spacingM);
-                x += ox;
-                z += oz;
+    template <typename T>
+    bool readPod(std::istream &in, T &v)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "readPod takes trivially copyable types");
+        return static_cast<bool>(in.read(reinterpret_cast<char *>(&v), sizeof(T)));
+    }
 
-                x += jitter(rng);
-                z += jitter(rng);
+    bool readString(std::istream &in, std::string &s)
+    {
+        uint32_t size = 0;
+        if (!readPod(in, size) || size > SCENARIO_MAX_STRING)
+            return false;
+        s.resize(size);
+        return size == 0 || static_cast<bool>(in.read(&s[0], static_cast<std::streamsize>(size)));
+    }
 
-                Engine::ECS::SpawnResult res = Engine::ECS::spawnFromPrefab(*prefab, ecs);
-                Engine::ECS::ArchetypeStore *store = ecs.stores.get(res.archetypeId);
-                if (!store || !store->hasPosition())
-                    continue;
+    class ScenarioBinaryWriter
+    {
+    public:
+        explicit ScenarioBinaryWriter(std::ostream &out) : m_out(out)
+        {
+            writePod(m_out, SCENARIO_BINARY_MAGIC);
+            writePod(m_out, SCENARIO_BINARY_VERSION);
+        }
 
-                auto &p = store->positions()[res.row];
-                p.x = x;
-                p.y = 0.0f;
-                p.z = z;
+        void name(const std::string &scenarioName)
+        {
+            writePod(m_out, SCENARIO_NAME);
+            writeString(m_out, scenarioName);
+        }
 
-                // We mutated Position post-spawn; ensure dirty-driven systems see it.
-                ecs.markDirty(positionId, res.archetypeId, res.row);
+        void obstacle(const ObstacleLine &line)
+        {
+            writePod(m_out, SCENARIO_OBSTACLE);
+            writeString(m_out, line.prefab);
+            for (const float v : {line.sx, line.sz, line.ex, line.ez, line.spacing})
+                writePod(m_out, v);
+            writePod(m_out, static_cast<uint32_t>(line.gaps.size()));
+            for (const ObstacleGap &g : line.gaps)
+                writePod(m_out, g);
+        }
+
+        void group(SpawnGroupResolved &&sg)
+        {
+            writePod(m_out, SCENARIO_GROUP);
+            writeString(m_out, sg.id);
+            writeString(m_out, sg.unitType);
+            writeString(m_out, sg.formationKind);
+            writePod(m_out, static_cast<int32_t>(sg.count));
+            writePod(m_out, static_cast<int32_t>(sg.columns));
+            writePod(m_out, static_cast<int32_t>(sg.team));
+            writePod(m_out, static_cast<uint8_t>(sg.spacingAuto ? 1 : 0));
+            for (const float v : {sg.originX, sg.originZ, sg.jitterM, sg.circleRadiusM, sg.spacingM, sg.facingYawDeg})
+                writePod(m_out, v);
+            ++m_groups;
+        }
+
+        bool finish()
+        {
+            writePod(m_out, SCENARIO_END);
+            m_out.flush();
+            return static_cast<bool>(m_out);
+        }
+
+        uint32_t groups() const { return m_groups; }
 
-                // Set team if specified
-                if (sg.team >= 0 && store->hasTeam())
+    private:
+        std::ostream &m_out;
+        uint32_t m_groups = 0;
+    };
+
+    // Feeds a compiled scenario to the sink one record at a time. The magic is already consumed.
+    template <typename Sink>
+    bool readScenarioBinary(std::istream &in, Sink &sink, std::string &outError)
+    {
+        uint32_t version = 0;
+        if (!readPod(in, version) || version != SCENARIO_BINARY_VERSION)
+        {
+            outError = "unsupported version " + std::to_string(version);
+            return false;
+        }
+
+        for (;;)
+        {
+            uint8_t tag = 0;
+            if (!readPod(in, tag))
+            {
+                outError = "truncated (no end record)";
+                return false;
+            }
+
+            if (tag == SCENARIO_END)
+                return true;
+
+            if (tag == SCENARIO_NAME)
+            {
+                std::string scenarioName;
+                if (!readString(in, scenarioName))
                 {
-                    store->teams()[res.row].id = static_cast<uint8_t>(sg.team);
+                    outError = "truncated name";
+                    return false;
                 }
-
-                // Set initial facing
-                if (store->hasFacing() && std::abs(sg.facingYawDeg) > 1e-3f)
+                sink.name(scenarioName);
+            }
+            else if (tag == SCENARIO_OBSTACLE)
+            {
+                ObstacleLine line;
+                uint32_t gapCount = 0;
+                bool ok = readString(in, line.prefab);
+                for (float *v : {&line.sx, &line.sz, &line.ex, &line.ez, &line.spacing})
+                    ok = ok && readPod(in, *v);
+                ok = ok && readPod(in, gapCount) && gapCount <= SCENARIO_MAX_GAPS;
+                if (ok)
+                    line.gaps.resize(gapCount);
+                for (uint32_t i = 0; ok && i < gapCount; ++i)
+                    ok = readPod(in, line.gaps[i]);
+                if (!ok)
                 {
-                    const float PI = 3.14159265358979f;
-                    store->facings()[res.row].yaw = sg.facingYawDeg * PI / 180.0f;
-
-                    // Keep RenderTransform (and any other dirty-driven systems) in sync.
-                    ecs.markDirty(facingId, res.archetypeId, res.row);
+                    outError = "truncated obstacle";
+                    return false;
                 }
-
-                if (selectSpawned)
+                sink.obstacle(line);
+            }
+            else if (tag == SCENARIO_GROUP)
+            {
+                SpawnGroupResolved sg;
+                int32_t count = 0, columns = 0, team = -1;
+                uint8_t spacingAuto = 1;
+                bool ok = readString(in, sg.id) && readString(in, sg.unitType) && readString(in, sg.formationKind) &&
+                          readPod(in, count) && readPod(in, columns) && readPod(in, team) && readPod(in, spacingAuto);
+                for (float *v : {&sg.originX, &sg.originZ, &sg.jitterM, &sg.circleRadiusM, &sg.spacingM, &sg.facingYawDeg})
+                    ok = ok && readPod(in, *v);
+                if (!ok)
                 {
-                    ecs.addTag(res.entity, selectedId);
+                    outError = "truncated spawn group";
+                    return false;
                 }
+                sg.count = count;
+                sg.columns = columns;
+                sg.team = team;
+                sg.spacingAuto = spacingAuto != 0;
+                sink.group(std::move(sg));
+            }
+            else
+            {
+                outError = "unknown record " + std::to_string(tag);
+                return false;
+            }
+        }
+    }
 
-                ++totalSpawned;
+    bool hasBinaryMagic(std::istream &in)
+    {
+        uint32_t magic = 0;
+        return readPod(in, magic) && magic == SCENARIO_BINARY_MAGIC;
+    }
+}
+
+namespace Sample
+{
+    uint32_t SpawnFromScenarioFile(Engine::ECS::ECSContext &ecs, const std::string &scenarioPath, bool selectSpawned,
+                                   uint32_t targetUnitCount)
+    {
+        ScenarioSpawnSink sink(ecs, selectSpawned, targetUnitCount);
+
+        std::ifstream binary(scenarioPath, std::ios::binary);
+        if (binary.is_open() && hasBinaryMagic(binary))
+        {
+            std::string error;
+            if (!readScenarioBinary(binary, sink, error))
+            {
+#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
+                std::cerr << "[Scenario] Compiled scenario " << scenarioPath << ": " << error << "\n";
+#endif
+                return sink.spawned();
             }
         }
+        else
+        {
+            binary.close();
+            // Groups held back for resizing are dropped with a broken file.
+            if (!streamScenarioJson(scenarioPath, sink))
+                return sink.spawned();
+        }
 
+        const uint32_t totalSpawned = sink.finish();
 #if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
         std::cout << "[Scenario] Total units spawned: " << totalSpawned << "\n";
 #endif
         return totalSpawned;
     }
+
+    bool CompileScenarioFile(const std::string &scenarioPath, const std::string &outPath)
+    {
+        std::ofstream out(outPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open())
+        {
+#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
+            std::cerr << "[Scenario] Cannot write " << outPath << "\n";
+#endif
+            return false;
+        }
+
+        ScenarioBinaryWriter writer(out);
+        if (!streamScenarioJson(scenarioPath, writer) || !writer.finish())
+        {
+            out.close();
+            std::error_code ec;
+            std::filesystem::remove(outPath, ec);
+            return false;
+        }
+#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
+        std::cout << "[Scenario] Compiled " << writer.groups() << " spawn groups to " << outPath << "\n";
+#endif
+        return true;
+    }
+
+    bool LoadCombatConfigFile(const std::string &path, CombatSystem::CombatConfig &cfg)
+    {
+        try
+        {
+            std::ifstream cfgFile(path);
+            if (!cfgFile.is_open())
+                return false;
+
+            nlohmann::json root = nlohmann::json::parse(cfgFile);
+            if (!root.contains("combat") || !root["combat"].is_object())
+                return false;
+
+            const auto &c = root["combat"];
+            CombatSystem::CombatConfig out = cfg;
+            if (c.contains("meleeRange"))
+                out.meleeRange = c["meleeRange"].get<float>();
+            if (c.contains("engageRange"))
+                out.engageRange = c["engageRange"].get<float>();
+            if (c.contains("damageMin"))
+                out.damageMin = c["damageMin"].get<float>();
+            if (c.contains("damageMax"))
+                out.damageMax = c["damageMax"].get<float>();
+            // Legacy single-value fallback
+            if (c.contains("damagePerHit") && !c.contains("damageMin"))
+            {
+                float d = c["damagePerHit"].get<float>();
+                out.damageMin = d * 0.6f;
+                out.damageMax = d * 1.4f;
+            }
+            if (c.contains("deathRemoveDelay"))
+                out.deathRemoveDelay = c["deathRemoveDelay"].get<float>();
+            if (c.contains("maxHPPerUnit"))
+                out.maxHPPerUnit = c["maxHPPerUnit"].get<float>();
+            if (c.contains("missChance"))
+                out.missChance = c["missChance"].get<float>();
+            if (c.contains("critChance"))
+                out.critChance = c["critChance"].get<float>();
+            if (c.contains("critMultiplier"))
+                out.critMultiplier = c["critMultiplier"].get<float>();
+            if (c.contains("rageMaxBonus"))
+                out.rageMaxBonus = c["rageMaxBonus"].get<float>();
+            if (c.contains("cooldownJitter"))
+                out.cooldownJitter = c["cooldownJitter"].get<float>();
+            if (c.contains("staggerMax"))
+                out.staggerMax = c["staggerMax"].get<float>();
+            cfg = out;
+            return true;
+        }
+        catch (const std::exception &e)
+        {
+#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
+            std::cerr << "[Config] Failed to parse combat config: " << e.what() << "\n";
+#endif
+            return false;
+        }
+    }
+
+    uint32_t LoadPrefabsHeadless(Engine::ECS::ECSContext &ecs, const std::string &dir)
+    {
+        uint32_t count = 0;
+        std::error_code ec;
+        std::vector<std::filesystem::path> files;
+        for (const auto &entry : std::filesystem::directory_iterator(dir, ec))
+        {
+            if (entry.is_regular_file() && entry.path().extension() == ".json")
+                files.push_back(entry.path());
+        }
+        // Directory order is unspecified; component ids and archetype ids should not depend on it.
+        std::sort(files.begin(), files.end());
+
+        for (const auto &path : files)
+        {
+            const std::string jsonText = Engine::ECS::readFileText(path.generic_string());
+            if (jsonText.empty())
+                continue;
+            Engine::ECS::Prefab p = Engine::ECS::loadPrefabFromJson(jsonText, ecs.components, ecs.archetypes);
+            if (p.name.empty())
+                continue;
+            ecs.prefabs.add(p);
+            ++count;
+        }
+        return count;
+    }
+
+    void BattleStartPoint(const Engine::ECS::ECSContext &ecs, const std::string &battleConfigPath, float &x, float &z)
+    {
+        std::ifstream file(battleConfigPath);
+        if (file.is_open())
+        {
+            const nlohmann::json root = nlohmann::json::parse(file, nullptr, /*allow_exceptions=*/false);
+            if (!root.is_discarded() && root.contains("startZone") && root["startZone"].is_object())
+            {
+                x = root["startZone"].value("x", 0.0f);
+                z = root["startZone"].value("z", 0.0f);
+                return;
+            }
+        }
+
+        double sx = 0.0, sz = 0.0;
+        uint64_t n = 0;
+        for (const auto &storePtr : ecs.stores.stores())
+        {
+            if (!storePtr || !storePtr->hasPosition() || !storePtr->hasTeam() || !storePtr->hasVelocity())
+                continue;
+            const auto &pos = storePtr->positions();
+            for (uint32_t row = 0; row < storePtr->size(); ++row)
+            {
+                sx += pos[row].x;
+                sz += pos[row].z;
+                ++n;
+            }
+        }
+        x = n ? static_cast<float>(sx / static_cast<double>(n)) : 0.0f;
+        z = n ? static_cast<float>(sz / static_cast<double>(n)) : 0.0f;
+    }
 }
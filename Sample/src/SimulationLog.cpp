@@ -0,0 +1,123 @@
+#include "SimulationLog.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+namespace Sample
+{
+    bool SimulationLog::save(const std::string &path, std::string &outError) const
+    {
+        nlohmann::json j;
+        j["version"] = 1;
+        j["seed"] = seed;
+        j["stepSeconds"] = stepSeconds;
+        j["humanTeam"] = humanTeam;
+        j["checksumInterval"] = checksumInterval;
+        j["scenario"] = scenario;
+        j["ticks"] = ticks;
+
+        nlohmann::json cmds = nlohmann::json::array();
+        for (const SimCommand &c : commands)
+        {
+            nlohmann::json units = nlohmann::json::array();
+            for (const Engine::ECS::Entity &e : c.units)
+                units.push_back({e.index, e.generation});
+            cmds.push_back({{"tick", c.tick},
+                            {"type", static_cast<uint32_t>(c.type)},
+                            {"x", c.x},
+                            {"y", c.y},
+                            {"z", c.z},
+                            {"units", std::move(units)}});
+        }
+        j["commands"] = std::move(cmds);
+
+        nlohmann::json sums = nlohmann::json::array();
+        char hex[17];
+        for (uint64_t c : checksums)
+        {
+            std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(c));
+            sums.push_back(hex);
+        }
+        j["checksums"] = std::move(sums);
+
+        std::ofstream o(path);
+        if (!o.is_open())
+        {
+            outError = "Cannot write simulation log '" + path + "'";
+            return false;
+        }
+        o << j.dump(1);
+        return true;
+    }
+
+    bool SimulationLog::load(const std::string &path, std::string &outError)
+    {
+        std::ifstream i(path);
+        if (!i.is_open())
+        {
+            outError = "Cannot open simulation log '" + path + "'";
+            return false;
+        }
+        const nlohmann::json j = nlohmann::json::parse(i, nullptr, /*allow_exceptions=*/false);
+        if (j.is_discarded() || !j.is_object() || j.value("version", 0) != 1)
+        {
+            outError = "Simulation log '" + path + "' is malformed or has an unknown version";
+            return false;
+        }
+
+        SimulationLog log;
+        log.seed = j.value("seed", log.seed);
+        log.stepSeconds = j.value("stepSeconds", log.stepSeconds);
+        log.humanTeam = j.value("humanTeam", log.humanTeam);
+        log.checksumInterval = std::max(1u, j.value("checksumInterval", log.checksumInterval));
+        log.scenario = j.value("scenario", std::string{});
+        log.ticks = j.value("ticks", 0u);
+
+        if (j.contains("commands") && j["commands"].is_array())
+        {
+            for (const nlohmann::json &jc : j["commands"])
+            {
+                SimCommand c;
+                c.tick = jc.value("tick", 0u);
+                const uint32_t type = jc.value("type", 0u);
+                if (type != static_cast<uint32_t>(SimCommand::Type::MoveSelected) &&
+                    type != static_cast<uint32_t>(SimCommand::Type::StartBattle))
+                {
+                    outError = "Simulation log '" + path + "': unknown command type " + std::to_string(type);
+                    return false;
+                }
+                c.type = static_cast<SimCommand::Type>(type);
+                c.x = jc.value("x", 0.0f);
+                c.y = jc.value("y", 0.0f);
+                c.z = jc.value("z", 0.0f);
+                if (jc.contains("units") && jc["units"].is_array())
+                {
+                    for (const nlohmann::json &ju : jc["units"])
+                    {
+                        if (ju.is_array() && ju.size() == 2)
+                            c.units.push_back(Engine::ECS::Entity{ju[0].get<uint32_t>(), ju[1].get<uint32_t>()});
+                    }
+                }
+                if (!log.commands.empty() && c.tick < log.commands.back().tick)
+                {
+                    outError = "Simulation log '" + path + "': commands are not in tick order";
+                    return false;
+                }
+                log.commands.push_back(std::move(c));
+            }
+        }
+
+        if (j.contains("checksums") && j["checksums"].is_array())
+        {
+            for (const nlohmann::json &js : j["checksums"])
+                log.checksums.push_back(js.is_string() ? std::strtoull(js.get<std::string>().c_str(), nullptr, 16) : 0ull);
+        }
+
+        *this = std::move(log);
+        return true;
+    }
+}
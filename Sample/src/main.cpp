@@ -1,12 +1,47 @@
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <string>
 
 #include "MySampleApp.h"
+#include "utils/TelemetrySink.h"
 
-int main()
+// SampleApp [--benchmark script.json] [--telemetry udp:host:port|file:prefix] [--telemetry-rate r]
+//   --benchmark: scripted flythrough (see FlythroughBenchmark.h); writes its results and quits.
+//   --telemetry: stream PerformanceMonitor packets (utils/TelemetrySink.h); --telemetry-rate is
+//   the fraction of sessions that report (0..1, default 1).
+int main(int argc, char **argv)
 {
+    std::string benchmarkScript;
+    Engine::TelemetryConfig telemetry;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--benchmark") == 0 && i + 1 < argc)
+        {
+            benchmarkScript = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--telemetry") == 0 && i + 1 < argc &&
+                 Engine::TelemetryConfig::parse(argv[i + 1], telemetry))
+        {
+            ++i;
+        }
+        else if (std::strcmp(argv[i], "--telemetry-rate") == 0 && i + 1 < argc)
+        {
+            telemetry.sessionSampleRate = static_cast<float>(std::atof(argv[++i]));
+        }
+        else
+        {
+            std::cerr << "Usage: SampleApp [--benchmark script.json] [--telemetry udp:host:port|file:prefix]"
+                         " [--telemetry-rate r]\n";
+            return 2;
+        }
+    }
+
     try
     {
-        MySampleApp app;
+        MySampleApp app(benchmarkScript);
+        if (telemetry.transport != Engine::TelemetryConfig::Transport::None)
+            app.StartTelemetry(telemetry);
         app.Run();
     }
     catch (const std::exception &e)
@@ -17,4 +52,4 @@ int main()
         return 1;
     }
     return 0;
-}
\ No newline at end of file
+}
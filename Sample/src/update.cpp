@@ -1,4 +1,12 @@
 #include "update.h"
+#include "ECS/SimulationChecksum.h"
+#if !defined(ENGINE_HEADLESS) || !ENGINE_HEADLESS
+#include "Engine/Renderer.h"
+#include "Engine/Camera.h"
+#endif
+
+#include <algorithm>
+#include <iostream>
 
 namespace Sample
 {
@@ -16,6 +24,7 @@ namespace Sample
                 (void)registry.ensureId("Selected");
 
                 m_command.buildMasks(registry);
+                m_command.setNavGrid(&m_navGrid); // formation slots fit walkable space
                 m_steering.buildMasks(registry);
                 m_navGridBuilder.buildMasks(registry);
                 {
@@ -24,6 +33,12 @@ namespace Sample
                         m_navGridBuilder.setConfig(cfg);
                 }
                 m_pathfinding.buildMasks(registry);
+                m_steering.setFlowFields(&m_pathfinding.flowFields());
+                m_steering.setPathStore(&m_pathfinding.pathStore());
+                m_steering.setNavGrid(&m_navGrid); // corridor cells index the pathfinding grid
+                m_crowdField.buildMasks(registry);
+                m_steering.setCrowdField(&m_crowdField.field());
+                m_localAvoidance.setCrowdField(&m_crowdField.field());
                 m_movement.buildMasks(registry);
                 {
                         MovementSystem::Config cfg;
@@ -31,30 +46,97 @@ namespace Sample
                         m_movement.setNavGrid(&m_navGrid);
                         m_movement.setConfig(cfg);
                 }
-                m_renderTransform.buildMasks(registry);
-                m_renderBoundsUpdate.buildMasks(registry);
-                m_visibilityCulling.buildMasks(registry);
+                m_transformHistory.buildMasks(registry);
                 m_spatialIndex.buildMasks(registry);
                 m_localAvoidance.buildMasks(registry);
+                m_sleep.buildMasks(registry);
+                m_spatialReorder.buildMasks(registry);
                 m_combat.buildMasks(registry);
                 m_combat.setSpatialIndex(&m_spatialIndex);
-                m_locomotionAnim.buildMasks(registry);
-                m_animPlayback.buildMasks(registry);
-                m_poseUpdate.buildMasks(registry);
-                m_visibleRenderGather.buildMasks(registry);
-                m_renderModel.buildMasks(registry);
-
-                m_renderModel.setVisibleBuckets(&m_visibleRenderGather.buckets());
+                m_simLod.bind(registry);
+                m_localAvoidance.setSimulationLod(&m_simLod);
+                m_combat.setSimulationLod(&m_simLod);
+                m_spatialIndex.setTeamLayers(true); // combat queries visit enemy-team cells only
+#if !defined(ENGINE_HEADLESS) || !ENGINE_HEADLESS
+                if (!m_headless)
+                {
+                        m_renderTransform.buildMasks(registry);
+                        m_visibilityCulling.buildMasks(registry);
+                        m_locomotionAnim.buildMasks(registry);
+                        m_animPlayback.buildMasks(registry);
+                        m_poseUpdate.buildMasks(registry);
+                        m_visibleRenderGather.buildMasks(registry);
+                        m_renderModel.buildMasks(registry);
+                        m_staticProps.buildMasks(registry);
+
+                        m_renderModel.setVisibleBuckets(&m_visibleRenderGather.buckets());
+                        m_renderModel.setPosePalettePool(&m_poseUpdate.palettePool());
+                        m_poseUpdate.setGpuPoseModels(&m_renderModel.gpuPoseModels());
+                        // Marching/idle blocks play the same clips in lockstep: share their evaluations.
+                        m_poseUpdate.setPoseSharing(PoseUpdateSystem::POSE_SHARE_QUANTUM_SEC);
+                        // Crowds sample rotations with SIMD nlerp; close-ups keep slerp.
+                        PoseUpdateSystem::RotationSamplingPolicy rotation;
+                        rotation.mode = Engine::ModelAsset::RotationSampling::Nlerp;
+                        m_poseUpdate.setRotationSampling(rotation);
+                        // Front-to-back instances: formations hide most of their own rows from early-Z.
+                        m_visibleRenderGather.setDepthSort(true);
+                }
+#endif
 
                 // Initialize NavGrid (cover map area)
                 // BattleConfig.json places obstacles/units around +/-500.
                 // Add padding so clamping in pathfinding doesn't distort routes near the edges.
                 m_navGrid.rebuild(2.0f, -600.0f, -600.0f, 600.0f, 600.0f);
 
+                // Reference order; the scheduler only reorders systems whose access sets do not conflict.
+                // Simulation runs at the fixed step (m_fixedStep), presentation once per frame.
+                m_simScheduler.clear();
+                m_simScheduler.addSystem(m_transformHistory);  // 0. Previous tick pose for interpolation
+                m_simScheduler.addSystem(m_spatialReorder);    // 0a. Periodic spatial row order (off by default)
+                m_simScheduler.addSystem(m_command);           // 1. Input
+                m_simScheduler.addSystem(m_spatialIndex);      // 2. Spatial index rebuild (combat/avoidance neighbor queries)
+                m_simScheduler.addSystem(m_navGridBuilder);    // 3. NavGrid rebuild (pathfinding)
+                m_simScheduler.addSystem(m_combat);            // 4. Combat (may set move targets/stop units)
+                m_simScheduler.addSystem(m_pathfinding);       // 5. Plan paths for units with invalid/new targets
+                m_simScheduler.addSystem(m_crowdField);        // 5a. Crowd density / congestion field
+                m_simScheduler.addSystem(m_steering);          // 6. Follow waypoints, writes preferred velocity
+                m_simScheduler.addSystem(m_localAvoidance);    // 7. Adjust velocity to reduce overlaps
+                m_simScheduler.addSystem(m_movement);          // 8. Integrate velocity
+                m_simScheduler.addSystem(m_sleep);             // 8a. Idle units sleep, movers wake neighbors
+                m_simScheduler.build();
+
+                // Headless: the frame schedule stays empty.
+                m_frameScheduler.clear();
+#if !defined(ENGINE_HEADLESS) || !ENGINE_HEADLESS
+                if (!m_headless)
+                {
+                        m_frameScheduler.addSystem(m_renderTransform);     // 9. Position/Facing -> RenderTransform + world bounds (interpolated)
+                        m_frameScheduler.addSystem(m_visibilityCulling);   // 9b. Frustum culling
+                        m_frameScheduler.addSystem(m_locomotionAnim);      // 10. Animation selection (sample policy)
+                        m_frameScheduler.addSystem(m_animPlayback);        // 11. Animation playback (engine)
+                        m_frameScheduler.addSystem(m_poseUpdate);          // 12. Pose update
+                        m_frameScheduler.addSystem(m_visibleRenderGather); // 12a. Visible render buckets
+                        m_frameScheduler.addSystem(m_renderModel);         // 13. Render
+                        m_frameScheduler.addSystem(m_staticProps);         // 13a. Static props (instanced, GPU culled)
+                }
+#endif
+                m_frameScheduler.build();
+                for (const auto &budget : m_systemBudgets)
+                {
+                        m_simScheduler.setSystemBudgetMs(budget.first, budget.second);
+                        m_frameScheduler.setSystemBudgetMs(budget.first, budget.second);
+                }
+
                 m_initialized = true;
         }
 
         void SystemRunner::Update(Engine::ECS::ECSContext &ecs, float dtSeconds)
+        {
+                Simulate(ecs, dtSeconds);
+                Present(ecs, dtSeconds);
+        }
+
+        void SystemRunner::Simulate(Engine::ECS::ECSContext &ecs, float dtSeconds)
         {
                 if (!m_initialized)
                         Initialize(ecs);
@@ -62,77 +144,309 @@ namespace Sample
                 if (dtSeconds <= 0.0f)
                         return;
 
-                // 1. Input
-                m_command.update(ecs, dtSeconds);
+                // Systems run as a dependency graph derived from their declared read/write sets.
+                // Registration order (see Initialize) is the serial reference order; independent
+                // systems (e.g. spatial index + navgrid rebuild) run concurrently on the JobSystem.
+                const uint32_t steps = m_fixedStep.advance(dtSeconds);
+                for (uint32_t i = 0; i < steps; ++i)
+                        RunTick(ecs, m_fixedStep.stepSeconds());
+        }
 
-                // 2. Spatial index rebuild (used by combat neighbor queries)
-                // 4. NavGrid rebuild (used by pathfinding)
-                // These are independent and can run concurrently.
-                m_spatialIndex.update(ecs, dtSeconds);
-                m_navGridBuilder.update(ecs, dtSeconds);
+        void SystemRunner::SimulateTicks(Engine::ECS::ECSContext &ecs, uint32_t ticks, float stepSeconds)
+        {
+                if (!m_initialized)
+                        Initialize(ecs);
 
-                // 3. Combat (may set move targets/stop units)
-                m_combat.update(ecs, dtSeconds);
+                if (stepSeconds <= 0.0f)
+                        return;
 
-                // 5. Pathfinding (Plan paths for units with invalid/new targets)
-                m_pathfinding.update(ecs, dtSeconds);
+                for (uint32_t i = 0; i < ticks; ++i)
+                        RunTick(ecs, stepSeconds);
+        }
 
-                // 6. Steering (Follow waypoints, update facing) writes preferred velocity
-                m_steering.update(ecs, dtSeconds);
+        void SystemRunner::RunTick(Engine::ECS::ECSContext &ecs, float stepSeconds)
+        {
+                if (!m_lockstep)
+                {
+                        m_simScheduler.run(ecs, stepSeconds);
+                        return;
+                }
 
-                // 7. Local avoidance adjusts velocity to reduce overlaps
-                m_localAvoidance.update(ecs, dtSeconds);
+                if (m_replaying)
+                {
+                        const std::vector<SimCommand> &cmds = m_replayLog.commands;
+                        while (m_replayCursor < cmds.size() && cmds[m_replayCursor].tick <= m_tick)
+                        {
+                                ApplyCommand(ecs, cmds[m_replayCursor]);
+                                m_log.commands.push_back(cmds[m_replayCursor]);
+                                ++m_replayCursor;
+                        }
+                }
+                else
+                {
+                        for (SimCommand &cmd : m_pendingCommands)
+                        {
+                                cmd.tick = m_tick;
+                                // The selection is captured here, where CommandSystem would read it anyway.
+                                if (cmd.type == SimCommand::Type::MoveSelected)
+                                {
+                                        if (const Engine::ECS::SparseTagSet *selected = ecs.sparseTag(ecs.components.getId("Selected")))
+                                                cmd.units = selected->entities();
+                                        std::sort(cmd.units.begin(), cmd.units.end(), [](const Engine::ECS::Entity &a, const Engine::ECS::Entity &b)
+                                                  { return a.index < b.index; });
+                                }
+                                ApplyCommand(ecs, cmd);
+                                m_log.commands.push_back(std::move(cmd));
+                        }
+                        m_pendingCommands.clear();
+                }
 
-                // 8. Movement integration (uses velocity produced by steering+avoidance)
-                m_movement.update(ecs, dtSeconds);
+                m_simScheduler.run(ecs, stepSeconds);
+                ++m_tick;
+                m_log.ticks = m_tick;
 
-                // 9. Render transform cache (Position/Facing -> RenderTransform)
-                m_renderTransform.update(ecs, dtSeconds);
+                const uint32_t interval = std::max(1u, m_log.checksumInterval);
+                if (m_tick % interval != 0)
+                        return;
+                const uint64_t checksum = Engine::ECS::simulationChecksum(ecs, m_checksumIds);
+                const size_t index = m_log.checksums.size();
+                m_log.checksums.push_back(checksum);
+                if (m_replaying && m_divergedTick == UINT32_MAX && index < m_replayLog.checksums.size() &&
+                    m_replayLog.checksums[index] != checksum)
+                {
+                        m_divergedTick = m_tick - 1u;
+#if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
+                        std::cerr << "[Lockstep] Replay diverged at tick " << m_divergedTick << "\n";
+#endif
+                }
+        }
 
-                // 9a. Update world bounds from render transform
-                m_renderBoundsUpdate.update(ecs, dtSeconds);
+        // MoveSelected: Selected becomes exactly cmd.units, added in index order (CommandSystem
+        // walks the tag's dense order), then the order goes to CommandSystem for this tick.
+        void SystemRunner::ApplyCommand(Engine::ECS::ECSContext &ecs, const SimCommand &cmd)
+        {
+                if (cmd.type == SimCommand::Type::StartBattle)
+                {
+                        m_combat.startBattle(cmd.x, cmd.z);
+                        return;
+                }
+                if (Engine::ECS::SparseTagSet *selected = ecs.sparseTag(ecs.components.getId("Selected")))
+                {
+                        selected->clear();
+                        for (const Engine::ECS::Entity &e : cmd.units)
+                        {
+                                if (ecs.entities.isAlive(e))
+                                        selected->add(e);
+                        }
+                }
+                m_command.SetGlobalMoveTarget(cmd.x, cmd.y, cmd.z);
+        }
 
-                // 9b. Cull invisible entities based on camera frustum
-                m_visibilityCulling.update(ecs, dtSeconds);
+        void SystemRunner::EnableLockstep(Engine::ECS::ECSContext &ecs, const SimulationLog &settings)
+        {
+                m_lockstep = true;
+                m_replaying = false;
+                m_tick = 0;
+                m_divergedTick = UINT32_MAX;
+                m_pendingCommands.clear();
+
+                m_log = settings;
+                m_log.checksumInterval = std::max(1u, m_log.checksumInterval);
+                m_log.clearRecording();
+
+                m_combat.setRandomSeed(m_log.seed);
+                m_combat.setHumanTeam(m_log.humanTeam);
+                m_pathfinding.setDeterministic(true);
+                m_spatialReorder.reset();
+                SimulationLod::Config lodCfg = m_simLod.config();
+                lodCfg.enabled = false;
+                m_simLod.setConfig(lodCfg);
+                for (Engine::ECS::SystemScheduler *scheduler : {&m_simScheduler, &m_frameScheduler})
+                {
+                        Engine::ECS::SystemScheduler::Config cfg = scheduler->config();
+                        cfg.enableThrottling = false;
+                        scheduler->setConfig(cfg);
+                }
+                SetSimulationRate(m_log.stepSeconds > 0.0f ? 1.0f / m_log.stepSeconds : 30.0f);
+                m_log.stepSeconds = m_fixedStep.config().stepSeconds;
 
-                // 10. Animation selection (sample policy)
-                m_locomotionAnim.update(ecs, dtSeconds);
+                auto &registry = ecs.components;
+                m_checksumIds = {registry.ensureId("Position"), registry.ensureId("Velocity"), registry.ensureId("Health"),
+                                 registry.ensureId("Facing"), registry.ensureId("AttackCooldown")};
+        }
 
-                // 11. Animation playback (engine)
-                m_animPlayback.update(ecs, dtSeconds);
+        void SystemRunner::StartReplay(Engine::ECS::ECSContext &ecs, SimulationLog log)
+        {
+                EnableLockstep(ecs, log);
+                m_replayLog = std::move(log);
+                m_replayCursor = 0;
+                m_replaying = true;
+        }
 
-                // 12. Pose update
-                m_poseUpdate.update(ecs, dtSeconds);
+        void SystemRunner::Present(Engine::ECS::ECSContext &ecs, float dtSeconds)
+        {
+                if (!m_initialized)
+                        Initialize(ecs);
 
-                // 12a. Build explicit visible render buckets
-                m_visibleRenderGather.update(ecs, dtSeconds);
+                if (dtSeconds <= 0.0f || m_headless)
+                        return;
 
-                // 13. Render
-                m_renderModel.update(ecs, dtSeconds);
+#if !defined(ENGINE_HEADLESS) || !ENGINE_HEADLESS
+                m_renderTransform.setInterpolationAlpha(m_fixedStep.alpha());
+                m_frameScheduler.run(ecs, dtSeconds);
+#endif
         }
 
+#if !defined(ENGINE_HEADLESS) || !ENGINE_HEADLESS
         void SystemRunner::SetAssetManager(Engine::AssetManager *assets)
         {
                 m_animPlayback.setAssetManager(assets);
                 m_poseUpdate.setAssetManager(assets);
                 m_renderModel.setAssetManager(assets);
+                m_staticProps.setAssetManager(assets);
+                m_visibleRenderGather.setAssetManager(assets);
                 m_combat.setAssetManager(assets);
         }
 
         void SystemRunner::SetRenderer(Engine::Renderer *renderer)
         {
+                if (m_renderer && m_renderer != renderer && m_occlusionCulling)
+                {
+                        m_renderer->setHiZOcclusion(false);
+                        m_renderer->setHiZReadbackCallback({});
+                }
+                m_renderer = renderer;
                 m_renderModel.setRenderer(renderer);
+                m_staticProps.setRenderer(renderer);
+                if (m_occlusionCulling)
+                        SetOcclusionCulling(true);
         }
 
         void SystemRunner::SetCamera(Engine::Camera *camera)
         {
                 m_renderModel.setCamera(camera);
+                m_staticProps.setCamera(camera);
                 m_visibilityCulling.setCamera(camera);
+                m_poseUpdate.setCamera(camera);
+                m_visibleRenderGather.setCamera(camera);
+                m_camera = camera;
         }
+#endif
 
         void SystemRunner::SetGlobalMoveTarget(float x, float y, float z)
         {
-                m_command.SetGlobalMoveTarget(x, y, z);
+                if (!m_lockstep)
+                {
+                        m_command.SetGlobalMoveTarget(x, y, z);
+                        return;
+                }
+                if (m_replaying)
+                        return; // the log drives the simulation
+                // CommandSystem keeps only the newest order per tick, so does the log.
+                m_pendingCommands.erase(std::remove_if(m_pendingCommands.begin(), m_pendingCommands.end(), [](const SimCommand &c)
+                                                       { return c.type == SimCommand::Type::MoveSelected; }),
+                                        m_pendingCommands.end());
+                SimCommand cmd;
+                cmd.type = SimCommand::Type::MoveSelected;
+                cmd.x = x;
+                cmd.y = y;
+                cmd.z = z;
+                m_pendingCommands.push_back(std::move(cmd));
+        }
+
+        void SystemRunner::StartBattle(float x, float z)
+        {
+                if (!m_lockstep)
+                {
+                        m_combat.startBattle(x, z);
+                        return;
+                }
+                if (m_replaying)
+                        return;
+                SimCommand cmd;
+                cmd.type = SimCommand::Type::StartBattle;
+                cmd.x = x;
+                cmd.z = z;
+                m_pendingCommands.push_back(std::move(cmd));
+        }
+
+#if !defined(ENGINE_HEADLESS) || !ENGINE_HEADLESS
+        void SystemRunner::SetGpuCulling(bool enable)
+        {
+                m_visibilityCulling.setGpuCulling(enable);
+                m_renderModel.setGpuCulling(enable);
+        }
+
+        void SystemRunner::SetGpuPoseEvaluation(bool enable)
+        {
+                m_renderModel.setGpuPose(enable);
+        }
+
+        void SystemRunner::SetOcclusionCulling(bool enable)
+        {
+                m_occlusionCulling = enable && m_renderer;
+                m_occlusion.reset();
+                if (m_renderer)
+                {
+                        // GPU culls test the pyramid directly; the CPU pass gets its coarse levels.
+                        m_renderer->setHiZOcclusion(m_occlusionCulling);
+                        if (m_occlusionCulling)
+                                m_renderer->setHiZReadbackCallback([this](const Engine::HiZReadback &rb)
+                                                                   { m_occlusion.buildFromReadback(rb); });
+                        else
+                                m_renderer->setHiZReadbackCallback({});
+                }
+                m_visibilityCulling.setOcclusion(m_occlusionCulling ? &m_occlusion : nullptr);
+        }
+#endif
+
+        void SystemRunner::SetSimulationRate(float hz)
+        {
+                Engine::FixedTimestep::Config cfg = m_fixedStep.config();
+                cfg.stepSeconds = hz > 0.0f ? 1.0f / hz : 0.0f;
+                m_fixedStep.setConfig(cfg);
+        }
+
+        void SystemRunner::SetSimulationLod(const SimulationLod::Config &cfg)
+        {
+                SimulationLod::Config applied = cfg;
+                applied.enabled = cfg.enabled && !m_lockstep;
+                m_simLod.setConfig(applied);
+        }
+
+        void SystemRunner::SetCpuBudget(float simulationTickMs, float presentFrameMs)
+        {
+                Engine::ECS::SystemScheduler::Config cfg = m_simScheduler.config();
+                cfg.frameBudgetMs = std::max(simulationTickMs, 0.0f);
+                m_simScheduler.setConfig(cfg);
+
+                cfg = m_frameScheduler.config();
+                cfg.frameBudgetMs = std::max(presentFrameMs, 0.0f);
+                m_frameScheduler.setConfig(cfg);
+        }
+
+        void SystemRunner::SetSystemBudgetMs(const std::string &systemName, float ms)
+        {
+                auto it = std::find_if(m_systemBudgets.begin(), m_systemBudgets.end(),
+                                       [&](const std::pair<std::string, float> &b) { return b.first == systemName; });
+                if (it == m_systemBudgets.end())
+                        m_systemBudgets.emplace_back(systemName, ms);
+                else
+                        it->second = ms;
+                m_simScheduler.setSystemBudgetMs(systemName, ms);
+                m_frameScheduler.setSystemBudgetMs(systemName, ms);
+        }
+
+        void SystemRunner::ReportMemory(Engine::MemoryReport &out) const
+        {
+                out.add("Navigation", "Nav grid", m_navGrid.memoryBytes(), 0, static_cast<uint32_t>(m_navGrid.cellCount()));
+                m_spatialIndex.reportMemory(out);
+                m_pathfinding.reportMemory(out);
+                m_crowdField.reportMemory(out);
+#if !defined(ENGINE_HEADLESS) || !ENGINE_HEADLESS
+                m_renderModel.reportMemory(out);
+                m_staticProps.reportMemory(out);
+#endif
         }
 
         void SystemRunner::ResetForRestart(Engine::ECS::ECSContext &ecs)
@@ -146,6 +460,30 @@ namespace Sample
                 // Clear combat state (death queues, battle flags, unit memories).
                 m_combat.resetBattleState();
 
+#if !defined(ENGINE_HEADLESS) || !ENGINE_HEADLESS
+                // Depth from before the restart describes a different scene.
+                m_occlusion.reset();
+#endif
+
+                // The new scene starts on a tick boundary.
+                m_fixedStep.reset();
+
                 // NavGrid will be rebuilt on next update automatically.
         }
+
+        void SystemRunner::OnWorldSnapshotLoaded(Engine::ECS::ECSContext &ecs)
+        {
+                // Death queues and pending moves name entities of the replaced world.
+                m_combat.resetBattleState();
+
+#if !defined(ENGINE_HEADLESS) || !ENGINE_HEADLESS
+                m_occlusion.reset();
+#endif
+                m_fixedStep.reset();
+                m_spatialReorder.reset();
+
+                // A recording describes the world it started from: start over on the loaded one.
+                if (m_lockstep)
+                        EnableLockstep(ecs, m_log);
+        }
 }
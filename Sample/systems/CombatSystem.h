@@ -12,10 +12,14 @@
 
 #include "ECS/SystemFormat.h"
 #include "ECS/Components.h"
+#include "ECS/TaskScheduler.h"
+#include "ECS/systems/MovementSystem.h"
+#include "ECS/systems/SimulationLod.h"
 #include "ECS/systems/SpatialIndexSystem.h"
-#include "assets/AssetManager.h"
+#include "utils/ParticleSpawnRing.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <cstdint>
 #include <random>
@@ -24,6 +28,11 @@
 #include <vector>
 #include <iostream>
 
+namespace Engine
+{
+    class AssetManager;
+}
+
 // -----------------------------------------------------------------------------
 // TUNABLES (ALL_CAPS)
 // -----------------------------------------------------------------------------
@@ -51,6 +60,8 @@ namespace CombatTuning
     static constexpr float ATTACK_ANIM_SPEED = 1.5f;
     static constexpr float DAMAGE_ANIM_SPEED = 1.0f;
     static constexpr float CRIT_DAMAGE_ANIM_SPEED = 1.4f;
+    // Crossfade into run/attack/hit/death clips instead of snapping (0 = hard switch).
+    static constexpr float ANIM_CROSSFADE_SEC_DEFAULT = 0.15f;
 
     static constexpr float ENEMY_TIE_EPS = 1e-6f;
     static constexpr float BEST_DIST2_INIT = 1e18f;
@@ -64,9 +75,23 @@ namespace CombatTuning
     // (Decision phase is read-only on most components; mutations are applied later in a deterministic merge.)
     static constexpr uint32_t PARALLEL_DECIDE_ENTITY_THRESHOLD = 256;
 
+    // Target acquisition is amortized: a unit searches for the nearest enemy every N ticks
+    // (staggered by entity index), or immediately when its target dies. In between it keeps
+    // fighting its current target. Under a work budget (SystemScheduler) scheduled searches past
+    // it are held for a later tick, at most one more interval; a lost target is replaced at once.
+    static constexpr uint32_t RETARGET_INTERVAL_TICKS = 6;
+
     // Charge leg switching: unit is considered "passing through" the click point.
     static constexpr float PASS_RADIUS = 3.0f;
     static constexpr float PASS_RADIUS2 = PASS_RADIUS * PASS_RADIUS;
+    // A charging unit far from the click point sleeps (TaskScheduler) for as many ticks as it
+    // needs to reach it at MovementSystem's speed cap, at most this many at once (bounds the
+    // delay if the fixed step grows mid-charge).
+    static constexpr uint32_t CHARGE_MAX_SLEEP_TICKS = 60;
+
+    // Effects (setParticleSpawns): hit sparks at this height above the target's feet.
+    static constexpr float HIT_EFFECT_HEIGHT = 1.2f;
+    static constexpr float CRIT_EFFECT_SCALE = 1.6f;
 }
 
 // Knight animation clip indices relevant to combat
@@ -94,7 +119,9 @@ namespace CombatAnims
 class CombatSystem : public Engine::ECS::SystemBase
 {
 public:
-    // Per-team aggregate stats for the HUD overlay
+    // Per-team aggregate stats for the HUD overlay and win checks. Kept up to date from the
+    // damage applied each tick; units are only scanned again when the population of combat
+    // stores no longer matches the living count (spawns, despawns, Disabled) or after a reset.
     struct TeamStats
     {
         int alive = 0;          // living units this frame
@@ -120,6 +147,8 @@ public:
         float rageMaxBonus = CombatTuning::RAGE_MAX_BONUS_DEFAULT;
         float cooldownJitter = CombatTuning::COOLDOWN_JITTER_DEFAULT;
         float staggerMax = CombatTuning::STAGGER_MAX_DEFAULT;
+
+        float animCrossfadeSec = CombatTuning::ANIM_CROSSFADE_SEC_DEFAULT;
     };
 
     CombatSystem();
@@ -128,9 +157,25 @@ public:
 
     void setSpatialIndex(SpatialIndexSystem *spatial) { m_spatial = spatial; }
     void setAssetManager(Engine::AssetManager *assets) { m_assets = assets; }
+    // Far-tier attackers search targets less often and deal expected damage (SimulationLod.h).
+    void setSimulationLod(const SimulationLod *lod) { m_lod = lod; }
+    // Hit sparks, death bursts and dust go here (ParticleRenderPassModule::spawnRing()); null = none.
+    // Cosmetic only: nothing in the simulation reads them back.
+    void setParticleSpawns(Engine::ParticleSpawnRing *ring) { m_particles = ring; }
 
     void applyConfig(const CombatConfig &cfg) { m_cfg = cfg; }
     const CombatConfig &config() const { return m_cfg; }
+    // Seed for cooldown staggering and death-clip picks (default: std::random_device).
+    // Per-unit combat rolls are already seeded from entity ids and the tick counter.
+    void setRandomSeed(uint32_t seed) { m_rng.seed(seed); }
+
+    // Amortized work: one unit is one scheduled target search.
+    bool isAmortized() const override { return true; }
+    uint32_t workRemaining() const override
+    {
+        return m_scansDone.load(std::memory_order_relaxed) + m_scansHeld.load(std::memory_order_relaxed);
+    }
+    uint32_t workDone() const override { return m_scansDone.load(std::memory_order_relaxed); }
 
     void startBattle(float clickX, float clickZ)
     {
@@ -178,8 +223,8 @@ public:
         m_moves.clear();
         m_stops.clear();
         m_newlyDead.clear();
-        m_unitMem.clear();
-        m_frameCounter = 0;
+        m_chargeTasks.clear();
+        // m_frameCounter keeps running: surviving units' CombatMemory::nextScanTick refers to it.
     }
 
     void setMeleeRange(float range) { m_cfg.meleeRange = range; }
@@ -215,10 +260,29 @@ public:
 private:
     void staggerInitialCooldowns(Engine::ECS::ECSContext &ecs);
     void refreshTeamStats(Engine::ECS::ECSContext &ecs);
+    // Rows in the combat query differ from the tracked living units: something besides combat
+    // added or removed units since the last update. O(stores).
+    bool teamPopulationChanged(Engine::ECS::ECSContext &ecs) const;
+    // One hit on a unit of team, health before -> after.
+    void applyDamageToStats(uint8_t team, float before, float after);
     void processDeathRemovals(Engine::ECS::ECSContext &ecs, float dt);
 
+    // One charging unit: leg 1 runs to the click point, then resume() looks for the nearest
+    // enemy (leg 2) and commit writes it as the MoveTarget.
+    struct ChargeTask
+    {
+        Engine::ECS::Entity entity{};
+        bool promote = false; // resume found a leg-2 target
+        float tx = 0.0f;
+        float tz = 0.0f;
+    };
+
     void issueClickTargets(Engine::ECS::ECSContext &ecs, const Engine::ECS::Query &q);
-    void promoteUnitsNearClick(Engine::ECS::ECSContext &ecs, const Engine::ECS::Query &q);
+    void promoteUnitsNearClick(Engine::ECS::ECSContext &ecs, const Engine::ECS::Query &q, float dt);
+    Engine::ECS::TaskWait resumeCharge(Engine::ECS::ECSContext &ecs, const Engine::ECS::Query &q,
+                                       ChargeTask &task, float maxStep) const;
+    // Spatial-query accept: the neighbor's row still has positive Health.
+    static bool isLivingUnit(Engine::ECS::ECSContext &ecs, const GridNeighbor &n);
 
     struct PendingDeath
     {
@@ -256,6 +320,8 @@ private:
 
     SpatialIndexSystem *m_spatial = nullptr;
     Engine::AssetManager *m_assets = nullptr;
+    const SimulationLod *m_lod = nullptr;
+    Engine::ParticleSpawnRing *m_particles = nullptr;
 
     CombatConfig m_cfg;
 
@@ -272,6 +338,7 @@ private:
     bool m_humanAttacking = true;
 
     std::unordered_map<uint8_t, TeamStats> m_teamStats;
+    int m_trackedAlive = 0; // sum of TeamStats::alive
 
     uint32_t m_positionId = Engine::ECS::ComponentRegistry::InvalidID;
     uint32_t m_healthId = Engine::ECS::ComponentRegistry::InvalidID;
@@ -282,6 +349,7 @@ private:
     uint32_t m_renderAnimId = Engine::ECS::ComponentRegistry::InvalidID;
     uint32_t m_facingId = Engine::ECS::ComponentRegistry::InvalidID;
     uint32_t m_deadId = Engine::ECS::ComponentRegistry::InvalidID;
+    uint32_t m_combatMemoryId = Engine::ECS::ComponentRegistry::InvalidID;
 
     Engine::ECS::QueryId m_queryId = Engine::ECS::QueryManager::InvalidQuery;
 
@@ -295,22 +363,17 @@ private:
     std::vector<StopAction> m_stops;
     std::vector<Engine::ECS::Entity> m_newlyDead;
 
-    struct UnitCombatMemory
-    {
-        Engine::ECS::Entity targetEnemy{};
-        // True if this unit is currently participating in combat logic (chasing or fighting).
-        // Used to prevent global-aggro behavior where units across the map start chasing.
-        bool engaged = false;
-        // Tracks whether the unit was in melee recently (for hysteresis around meleeRange).
-        bool inMelee = false;
-        // Tracks whether the CombatSystem has issued a chase move for this unit.
-        // Allows safely clearing combat-driven MoveTarget without stomping player commands.
-        bool combatMoveIssued = false;
-        uint32_t lastSeenFrame = 0;
-    };
-    std::unordered_map<uint64_t, UnitCombatMemory> m_unitMem;
+    // Charging units still on leg 1 (issueClickTargets spawns one per unit).
+    Engine::ECS::TaskScheduler<ChargeTask> m_chargeTasks;
+
+    // Per-unit combat memory (target, engaged/melee hysteresis) lives in the CombatMemory column.
     uint32_t m_frameCounter = 0;
 
+    // Target searches of the last tick, and what is left of this tick's work budget.
+    std::atomic<uint32_t> m_scansDone{0};
+    std::atomic<uint32_t> m_scansHeld{0};
+    std::atomic<int64_t> m_scansLeft{0};
+
     std::mt19937 m_rng;
     std::uniform_real_distribution<float> m_unitDist{0.0f, 1.0f};
     std::uniform_real_distribution<float> m_realDist{-1.0f, 1.0f};
@@ -13,6 +13,7 @@
 // - Uses LocomotionClips (if present) for clip indices.
 // - Does not advance time (handled by AnimationPlaybackSystem).
 // - Does not override active one-shot animations (loop==false && playing==true).
+// - Crossfades between idle and run instead of snapping.
 class LocomotionAnimationControllerSystem : public Engine::ECS::SystemBase
 {
 public:
@@ -20,6 +21,8 @@ public:
     {
         setRequiredNames({"RenderAnimation", "Velocity"});
         setExcludedNames({"Disabled", "Dead"});
+        setReadNames({"Velocity"});
+        setWriteNames({"RenderAnimation"});
     }
 
     const char *name() const override { return "LocomotionAnimationControllerSystem"; }
@@ -40,6 +43,7 @@ public:
         constexpr float kStopMoveSpeed = 0.12f;  // stop moving below this
         constexpr float kStartMoveSpeed2 = kStartMoveSpeed * kStartMoveSpeed;
         constexpr float kStopMoveSpeed2 = kStopMoveSpeed * kStopMoveSpeed;
+        constexpr float kCrossfadeSec = 0.2f;
 
         if (m_queryId == Engine::ECS::QueryManager::InvalidQuery)
         {
@@ -56,14 +60,15 @@ public:
             if (!st || !st->hasRenderAnimation() || !st->hasVelocity())
                 continue;
 
-            auto dirtyRows = ecs.queries.consumeDirtyRows(m_queryId, archetypeId);
+            auto &dirtyRows = m_dirtyRows;
+            ecs.queries.consumeDirtyRows(m_queryId, archetypeId, dirtyRows);
             if (dirtyRows.empty())
                 continue;
 
-            auto &anims = st->renderAnimations();
+            auto anims = st->renderAnimations();
             const auto &vels = st->velocities();
             const bool hasLoco = st->hasLocomotionClips();
-            const auto *loco = hasLoco ? &st->locomotionClips() : nullptr;
+            const auto loco = st->locomotionClips();
             const uint32_t n = st->size();
 
             for (uint32_t row : dirtyRows)
@@ -81,8 +86,8 @@ public:
                 // Gameplay movement is on XZ plane; ignore any small Y jitter.
                 const float speed2 = v.x * v.x + v.z * v.z;
 
-                const uint32_t runClip = hasLoco ? (*loco)[row].runClip : anim.clipIndex;
-                const uint32_t idleClip = hasLoco ? (*loco)[row].idleClip : anim.clipIndex;
+                const uint32_t runClip = hasLoco ? loco[row].runClip : anim.clipIndex;
+                const uint32_t idleClip = hasLoco ? loco[row].idleClip : anim.clipIndex;
 
                 const bool wasMoving = (hasLoco && anim.clipIndex == runClip);
                 const bool isMoving = wasMoving ? (speed2 > kStopMoveSpeed2) : (speed2 > kStartMoveSpeed2);
@@ -94,8 +99,7 @@ public:
                     const uint32_t desiredClip = isMoving ? runClip : idleClip;
                     if (anim.clipIndex != desiredClip)
                     {
-                        anim.clipIndex = desiredClip;
-                        anim.timeSec = 0.0f;
+                        Engine::ECS::CrossfadeTo(anim, desiredClip, kCrossfadeSec);
                         changed = true;
                     }
                 }
@@ -124,6 +128,7 @@ public:
 
 private:
     Engine::ECS::QueryId m_queryId = Engine::ECS::QueryManager::InvalidQuery;
+    std::vector<uint32_t> m_dirtyRows; // consumeDirtyRows scratch, reused across stores and frames
     uint32_t m_renderAnimId = Engine::ECS::ComponentRegistry::InvalidID;
     uint32_t m_velocityId = Engine::ECS::ComponentRegistry::InvalidID;
 };
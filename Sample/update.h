@@ -1,24 +1,38 @@
 #pragma once
 
 #include "ECS/ECSContext.h"
+#include "ECS/SystemScheduler.h"
 
 #include "ECS/systems/CommandSystem.h"
+#include "ECS/systems/CrowdFieldSystem.h"
 #include "ECS/systems/SteeringSystem.h"
 #include "ECS/systems/NavGrid.h"
 #include "ECS/systems/NavGridBuilderSystem.h"
 #include "ECS/systems/PathfindingSystem.h"
 #include "ECS/systems/MovementSystem.h"
+#include "ECS/systems/TransformHistorySystem.h"
+#include "ECS/systems/SpatialIndexSystem.h"
+#include "ECS/systems/LocalAvoidanceSystem.h"
+#include "ECS/systems/SleepSystem.h"
+#include "ECS/systems/SpatialReorderSystem.h"
+#include "ECS/systems/SimulationLod.h"
+#include "systems/CombatSystem.h"
+#include "utils/FixedTimestep.h"
+#include "SimulationLog.h"
+
+// ENGINE_HEADLESS (CMake option): no renderer exists, so the presentation systems are compiled
+// out and SystemRunner only simulates.
+#if !defined(ENGINE_HEADLESS) || !ENGINE_HEADLESS
 #include "ECS/systems/RenderTransformUpdateSystem.h"
-#include "ECS/systems/RenderBoundsUpdateSystem.h"
 #include "ECS/systems/VisibilityCullingSystem.h"
 #include "systems/LocomotionAnimationControllerSystem.h"
 #include "ECS/systems/Animation/AnimationPlaybackSystem.h"
 #include "ECS/systems/PoseUpdateSystem.h"
 #include "ECS/systems/VisibleRenderGatherSystem.h"
 #include "ECS/systems/RenderSystem.h"
-#include "ECS/systems/SpatialIndexSystem.h"
-#include "ECS/systems/LocalAvoidanceSystem.h"
-#include "systems/CombatSystem.h"
+#include "ECS/systems/StaticPropSystem.h"
+#include "Engine/HiZOcclusion.h"
+#endif
 
 namespace Engine
 {
@@ -34,12 +48,98 @@ namespace Sample
     {
     public:
         void Initialize(Engine::ECS::ECSContext &ecs);
-        void Update(Engine::ECS::ECSContext &ecs, float dtSeconds);
-
+        void Update(Engine::ECS::ECSContext &ecs, float dtSeconds); // Simulate + Present
+
+        /// Fixed-step simulation (may run on a worker while the previous frame is drawn; touches no
+        /// renderer or camera state).
+        void Simulate(Engine::ECS::ECSContext &ecs, float dtSeconds);
+        /// Exactly `ticks` simulation steps of stepSeconds each, bypassing the frame accumulator
+        /// (headless benchmarks).
+        void SimulateTicks(Engine::ECS::ECSContext &ecs, uint32_t ticks, float stepSeconds);
+        /// Per-frame presentation systems; feeds the render passes drawn by the next drawFrame().
+        void Present(Engine::ECS::ECSContext &ecs, float dtSeconds);
+
+        /// Simulation only (dedicated server, batch runs): call before Initialize. The presentation
+        /// systems get no queries and Present does nothing. Always on in ENGINE_HEADLESS builds.
+        void SetHeadless(bool enable) { m_headless = enable || HEADLESS_BUILD; }
+        bool IsHeadless() const { return m_headless; }
+
+#if !defined(ENGINE_HEADLESS) || !ENGINE_HEADLESS
         void SetAssetManager(Engine::AssetManager *assets);
         void SetRenderer(Engine::Renderer *renderer);
         void SetCamera(Engine::Camera *camera);
+#endif
+        /// Combat effects (hits, deaths, dust) go into this ring; null (the default) emits none.
+        void SetParticleSpawns(Engine::ParticleSpawnRing *ring) { m_combat.setParticleSpawns(ring); }
         void SetGlobalMoveTarget(float x, float y, float z);
+        /// CombatSystem::startBattle(x, z), through the command log in lockstep.
+        void StartBattle(float x, float z);
+
+#if !defined(ENGINE_HEADLESS) || !ENGINE_HEADLESS
+        /// Move frustum culling from VisibilityCullingSystem to a GPU compute pass per model.
+        void SetGpuCulling(bool enable);
+
+        /// Evaluate animated poses in a compute pass per model instead of PoseUpdateSystem.
+        void SetGpuPoseEvaluation(bool enable);
+
+        /// Hi-Z occlusion culling against the renderer's previous-frame depth pyramid (needs SetRenderer/SetCamera).
+        void SetOcclusionCulling(bool enable);
+#endif
+
+        /// Simulation ticks per second (combat, pathing, avoidance, movement); rendering interpolates
+        /// between ticks. 0 simulates once per frame with the frame dt.
+        void SetSimulationRate(float hz);
+        const Engine::FixedTimestep &GetFixedTimestep() const { return m_fixedStep; }
+
+        /// CPU time budgets in milliseconds per simulation tick / per presented frame (<= 0: none).
+        /// The amortized systems (path requests, combat target searches, nav grid obstacle updates,
+        /// pose evaluations) are given fewer work units when the measured cost of the rest leaves
+        /// too little, so load spikes stretch their work over ticks instead of stalling one.
+        /// Ignored in lockstep, where it would make ticks depend on wall time.
+        void SetCpuBudget(float simulationTickMs, float presentFrameMs);
+        /// Per-system cap by SystemBase::name() (e.g. "PathfindingSystem"), in whichever schedule
+        /// runs it; <= 0 removes it. Kept across ResetForRestart.
+        void SetSystemBudgetMs(const std::string &systemName, float ms);
+
+        /// Serial path planning without a wall-clock budget: the simulation then gives the same
+        /// result for the same input at any thread count (reproducible benchmark runs).
+        void SetDeterministicPlanning(bool enable) { m_pathfinding.setDeterministic(enable); }
+        /// Weighted A* (default) or Jump Point Search for path planning; changes the routes, so
+        /// lockstep peers and replays must use the same mode.
+        void SetPathSearchMode(PathfindingSystem::SearchMode mode) { m_pathfinding.setSearchMode(mode); }
+
+        /// Simulation LOD: units away from the focus point (and not Selected) get cheaper avoidance
+        /// and combat, see SimulationLod.h. Ignored in lockstep, where the tier would depend on
+        /// each peer's camera.
+        void SetSimulationLod(const SimulationLod::Config &cfg);
+        /// Centre of the full-fidelity area (e.g. the camera's ground point); call between ticks.
+        void SetSimulationLodFocus(float x, float z) { m_simLod.setFocus(x, z); }
+        SimulationLod &GetSimulationLodMut() { return m_simLod; }
+
+        /// Deterministic lockstep from the next tick on: seeds CombatSystem with settings.seed,
+        /// plans paths deterministically, fixes the tick to settings.stepSeconds and applies
+        /// SetGlobalMoveTarget/StartBattle only at tick boundaries. Commands and the state checksum are
+        /// recorded into GetSimulationLog() (tick 0 = the first tick after this call), so peers
+        /// exchange commands only and compare checksums.
+        void EnableLockstep(Engine::ECS::ECSContext &ecs, const SimulationLog &settings);
+        /// EnableLockstep with log's settings that plays its commands back instead of taking live
+        /// input; start from the world the log was recorded on. Checksums are compared as ticks
+        /// pass (GetReplayDivergenceTick).
+        void StartReplay(Engine::ECS::ECSContext &ecs, SimulationLog log);
+        bool IsLockstep() const { return m_lockstep; }
+        bool IsReplaying() const { return m_replaying; }
+        bool IsReplayFinished() const { return m_replaying && m_tick >= m_replayLog.ticks; }
+        const SimulationLog &GetSimulationLog() const { return m_log; }
+        /// Ticks simulated since EnableLockstep/StartReplay.
+        uint32_t GetTick() const { return m_tick; }
+        /// First tick whose checksum differs from the replayed log (UINT32_MAX: none so far).
+        uint32_t GetReplayDivergenceTick() const { return m_divergedTick; }
+
+        /// Sort store rows by position every seconds of simulated time (SpatialReorderSystem), so
+        /// neighbor loops read neighboring rows; <= 0 (default) turns it off. Deterministic, so
+        /// lockstep peers and replays must use the same interval.
+        void SetSpatialReorderInterval(float seconds) { m_spatialReorder.setInterval(seconds); }
+        const SpatialReorderSystem &GetSpatialReorder() const { return m_spatialReorder; }
 
         /// Access combat system for HUD stats
         const CombatSystem &GetCombatSystem() const { return m_combat; }
@@ -50,26 +150,70 @@ namespace Sample
         const SpatialIndexSystem &GetSpatialIndex() const { return m_spatialIndex; }
         SpatialIndexSystem &GetSpatialIndexMut() { return m_spatialIndex; }
 
+        /// Sleep/wake counts of the last simulation tick (debug UI)
+        const SleepSystem &GetSleepSystem() const { return m_sleep; }
+
         /// Reset all systems for a clean restart (clears cached queries, battle state, etc.)
         void ResetForRestart(Engine::ECS::ECSContext &ecs);
 
+        /// Nav grid written to / restored from world snapshots (Engine::ECS::WorldSnapshot.h).
+        NavGrid &GetNavGridMut() { return m_navGrid; }
+        /// After loadWorldSnapshot replaced the world: drops per-tick state of the previous one
+        /// (battle flags, last frame's depth, accumulated time). Queries and the nav grid stay;
+        /// a lockstep recording starts over from the loaded world (a replay stops).
+        void OnWorldSnapshotLoaded(Engine::ECS::ECSContext &ecs);
+
+        /// Scheduler stats (levels/parallelism) for debug UI: fixed-step simulation and per-frame presentation.
+        const Engine::ECS::SystemScheduler &GetScheduler() const { return m_simScheduler; }
+        const Engine::ECS::SystemScheduler &GetFrameScheduler() const { return m_frameScheduler; }
+        /// Mutable simulation scheduler (e.g. Config::recordTimings for benchmarks)
+        Engine::ECS::SystemScheduler &GetSchedulerMut() { return m_simScheduler; }
+        Engine::ECS::SystemScheduler &GetFrameSchedulerMut() { return m_frameScheduler; }
+
+        /// Byte counts of the nav grid, spatial index, pathfinding caches and model render passes.
+        void ReportMemory(Engine::MemoryReport &out) const;
+
     private:
+        // One fixed simulation step; in lockstep, commands go in before and the checksum after.
+        void RunTick(Engine::ECS::ECSContext &ecs, float stepSeconds);
+        void ApplyCommand(Engine::ECS::ECSContext &ecs, const SimCommand &cmd);
+
+#if defined(ENGINE_HEADLESS) && ENGINE_HEADLESS
+        static constexpr bool HEADLESS_BUILD = true;
+#else
+        static constexpr bool HEADLESS_BUILD = false;
+#endif
+
         bool m_initialized = false;
+        bool m_headless = HEADLESS_BUILD;
+
+#if !defined(ENGINE_HEADLESS) || !ENGINE_HEADLESS
+        Engine::Renderer *m_renderer = nullptr;
+        Engine::Camera *m_camera = nullptr;
+        bool m_occlusionCulling = false;
+        Engine::HiZOcclusion m_occlusion;
+#endif
 
+        TransformHistorySystem m_transformHistory;
         CommandSystem m_command;
         SteeringSystem m_steering;
         MovementSystem m_movement;
-        RenderTransformUpdateSystem m_renderTransform;
-        RenderBoundsUpdateSystem m_renderBoundsUpdate;
-        VisibilityCullingSystem m_visibilityCulling;
 
         NavGrid m_navGrid;
         NavGridBuilderSystem m_navGridBuilder{&m_navGrid};
         PathfindingSystem m_pathfinding{&m_navGrid};
+        CrowdFieldSystem m_crowdField{&m_navGrid};
 
         SpatialIndexSystem m_spatialIndex{2.0f};
         LocalAvoidanceSystem m_localAvoidance{&m_spatialIndex};
+        SleepSystem m_sleep{&m_spatialIndex};
+        SpatialReorderSystem m_spatialReorder{&m_spatialIndex};
         CombatSystem m_combat;
+        SimulationLod m_simLod;
+
+#if !defined(ENGINE_HEADLESS) || !ENGINE_HEADLESS
+        RenderTransformUpdateSystem m_renderTransform;
+        VisibilityCullingSystem m_visibilityCulling;
 
         LocomotionAnimationControllerSystem m_locomotionAnim;
         AnimationPlaybackSystem m_animPlayback;
@@ -79,5 +223,24 @@ namespace Sample
         VisibleRenderGatherSystem m_visibleRenderGather;
 
         RenderSystem m_renderModel;
+        StaticPropSystem m_staticProps;
+#endif
+
+        // Run the systems above as dependency graphs built from their read/write sets.
+        Engine::FixedTimestep m_fixedStep;
+        Engine::ECS::SystemScheduler m_simScheduler;
+        Engine::ECS::SystemScheduler m_frameScheduler;
+        std::vector<std::pair<std::string, float>> m_systemBudgets; // SetSystemBudgetMs, re-applied on Initialize
+
+        // Lockstep / replay (EnableLockstep, StartReplay)
+        bool m_lockstep = false;
+        bool m_replaying = false;
+        uint32_t m_tick = 0;
+        uint32_t m_divergedTick = UINT32_MAX;
+        SimulationLog m_log;       // being recorded
+        SimulationLog m_replayLog; // being played back
+        size_t m_replayCursor = 0;
+        std::vector<SimCommand> m_pendingCommands; // live input for the next tick
+        std::vector<uint32_t> m_checksumIds;
     };
 }
@@ -6,13 +6,15 @@
 inline void CombatSystem::issueClickTargets(Engine::ECS::ECSContext &ecs,
                                             const Engine::ECS::Query &q)
 {
+    m_chargeTasks.clear();
     for (uint32_t aid : q.matchingArchetypeIds)
     {
         auto *st = ecs.stores.get(aid);
         if (!st || !st->hasMoveTarget() || !st->hasHealth())
             continue;
-        auto &mt = st->moveTargets();
+        auto mt = st->moveTargets();
         const auto &hp = st->healths();
+        const auto &ents = st->entities();
         for (uint32_t r = 0; r < st->size(); ++r)
         {
             if (hp[r].value <= 0.0f)
@@ -22,6 +24,10 @@ inline void CombatSystem::issueClickTargets(Engine::ECS::ECSContext &ecs,
             mt[r].z = m_battleClickZ;
             mt[r].active = 1;
             ecs.markDirty(m_moveTargetId, aid, r);
+
+            ChargeTask task;
+            task.entity = ents[r];
+            m_chargeTasks.spawn(task);
         }
     }
 #if !defined(ENGINE_PRODUCTION) || !ENGINE_PRODUCTION
@@ -30,110 +36,144 @@ inline void CombatSystem::issueClickTargets(Engine::ECS::ECSContext &ecs,
 #endif
 }
 
+// Leg 2 for the charging units that are due this tick. A unit still far from the click point
+// sleeps as many ticks as it needs to get there at MovementSystem's speed cap, so the wait
+// costs nothing until it could possibly arrive.
 inline void CombatSystem::promoteUnitsNearClick(Engine::ECS::ECSContext &ecs,
-                                                const Engine::ECS::Query &q)
+                                                const Engine::ECS::Query &q, float dt)
 {
-    for (uint32_t aid : q.matchingArchetypeIds)
-    {
-        auto *st = ecs.stores.get(aid);
-        if (!st || !st->hasMoveTarget() || !st->hasHealth() || !st->hasPosition() || !st->hasTeam())
-            continue;
+    const float maxStep = std::min(MovementSystem::MAX_SPEED * std::max(0.0f, dt), MovementSystem::MAX_STEP);
 
-        auto &mt = st->moveTargets();
-        const auto &pos = st->positions();
-        const auto &hp = st->healths();
-        const auto &tm = st->teams();
-        const uint32_t n = st->size();
+    m_chargeTasks.tick(
+        dt, ecs.jobSystem,
+        [&](ChargeTask &task, uint32_t)
+        { return resumeCharge(ecs, q, task, maxStep); },
+        [&](ChargeTask &task, const Engine::ECS::TaskWait &)
+        {
+            if (!task.promote)
+                return;
+            const Engine::ECS::EntityRecord *rec = ecs.entities.find(task.entity);
+            Engine::ECS::ArchetypeStore *st = rec ? ecs.stores.get(rec->archetypeId) : nullptr;
+            if (!st || rec->row >= st->size())
+                return;
+            auto &mt = st->moveTargets()[rec->row];
+            mt.x = task.tx;
+            mt.y = 0.0f;
+            mt.z = task.tz;
+            mt.active = 1;
+            ecs.markDirty(m_moveTargetId, rec->archetypeId, rec->row);
+        });
+}
+
+// One step of a charging unit (runs on workers: reads the world, writes only the task).
+// Skips that can end (inactive target, unit outside the query) retry next tick; dying or
+// being ordered elsewhere ends the charge.
+inline Engine::ECS::TaskWait CombatSystem::resumeCharge(Engine::ECS::ECSContext &ecs,
+                                                        const Engine::ECS::Query &q,
+                                                        ChargeTask &task, float maxStep) const
+{
+    using Engine::ECS::TaskWait;
+
+    const Engine::ECS::EntityRecord *rec = ecs.entities.find(task.entity);
+    if (!rec)
+        return TaskWait::done();
+    const Engine::ECS::ArchetypeStore *st = ecs.stores.get(rec->archetypeId);
+    if (!st || !q.matchesArchetype(rec->archetypeId) || rec->row >= st->size() ||
+        !st->hasMoveTarget() || !st->hasHealth() || !st->hasPosition() || !st->hasTeam())
+        return TaskWait::nextTick();
+
+    const uint32_t r = rec->row;
+    if (st->healths()[r].value <= 0.0f)
+        return TaskWait::done();
+    const auto &mt = st->moveTargets()[r];
 
-        for (uint32_t r = 0; r < n; ++r)
+    // Already sent elsewhere (MoveTarget no longer equals click): only a new charge resets it.
+    const float tdx = mt.x - m_battleClickX;
+    const float tdz = mt.z - m_battleClickZ;
+    if (tdx * tdx + tdz * tdz > CombatTuning::CLICK_TARGET_MATCH_DIST2)
+        return TaskWait::done();
+    if (!mt.active)
+        return TaskWait::nextTick();
+
+    // Not near the click yet: sleep until it could be.
+    const auto &p = st->positions()[r];
+    const float dx = p.x - m_battleClickX;
+    const float dz = p.z - m_battleClickZ;
+    const float d2 = dx * dx + dz * dz;
+    if (d2 > CombatTuning::PASS_RADIUS2)
+    {
+        uint32_t ticks = 1;
+        if (maxStep > 0.0f)
         {
-            if (hp[r].value <= 0.0f)
-                continue;
-            if (!mt[r].active)
-                continue;
+            const float ahead = (std::sqrt(d2) - CombatTuning::PASS_RADIUS) / maxStep;
+            ticks = static_cast<uint32_t>(std::min(ahead, static_cast<float>(CombatTuning::CHARGE_MAX_SLEEP_TICKS)));
+        }
+        return TaskWait::forTicks(std::max(1u, ticks));
+    }
 
-            // Already promoted? (MoveTarget no longer equals click)
-            const float tdx = mt[r].x - m_battleClickX;
-            const float tdz = mt[r].z - m_battleClickZ;
-            if (tdx * tdx + tdz * tdz > CombatTuning::CLICK_TARGET_MATCH_DIST2)
-                continue;
+    // Close enough to click → promote to leg 2
+    const float posX = p.x;
+    const float posZ = p.z;
+    const uint8_t myTeam = st->teams()[r].id;
+    float bestEX = posX;
+    float bestEZ = posZ;
+    float bestD2 = CombatTuning::BEST_DIST2_INIT;
 
-            // Close enough to click → promote to leg 2
-            const float dx = pos[r].x - m_battleClickX;
-            const float dz = pos[r].z - m_battleClickZ;
-            if (dx * dx + dz * dz > CombatTuning::PASS_RADIUS2)
-                continue;
+    if (m_spatial)
+    {
+        GridNeighborFilter filter;
+        filter.teamMode = GridNeighborFilter::TeamMode::Other;
+        filter.team = myTeam;
 
-            const uint8_t myTeam = tm[r].id;
-            float bestEX = pos[r].x;
-            float bestEZ = pos[r].z;
-            float bestD2 = CombatTuning::BEST_DIST2_INIT;
+        // Same reach as the old 3x3 scan: every entity within one cell is guaranteed to be seen.
+        GridNeighborHit hit;
+        if (m_spatial->findNearest(posX, posZ, m_spatial->getCellSize(), filter, hit, [&](const GridNeighbor &n)
+                                   { return isLivingUnit(ecs, n); }))
+        {
+            bestD2 = hit.dist2;
+            bestEX = hit.neighbor.x;
+            bestEZ = hit.neighbor.z;
+        }
+    }
 
-            if (m_spatial)
-            {
-                m_spatial->forNeighbors(pos[r].x, pos[r].z, [&](uint32_t nStoreId, uint32_t nRow)
-                                        {
-                                            auto *ns = ecs.stores.get(nStoreId);
-                                            if (!ns || !ns->hasPosition() || !ns->hasHealth() || !ns->hasTeam())
-                                                return;
-                                            if (nRow >= ns->size())
-                                                return;
-                                            if (ns->teams()[nRow].id == myTeam)
-                                                return;
-                                            if (ns->healths()[nRow].value <= 0.0f)
-                                                return;
-
-                                            const float ex = ns->positions()[nRow].x;
-                                            const float ez = ns->positions()[nRow].z;
-                                            const float d2 = (ex - pos[r].x) * (ex - pos[r].x) + (ez - pos[r].z) * (ez - pos[r].z);
-                                            if (d2 < bestD2)
-                                            {
-                                                bestD2 = d2;
-                                                bestEX = ex;
-                                                bestEZ = ez;
-                                            } });
-            }
+    if (bestD2 > CombatTuning::FALLBACK_NO_ENEMY_DIST2)
+    {
+        for (uint32_t oaid : q.matchingArchetypeIds)
+        {
+            const auto *os = ecs.stores.get(oaid);
+            if (!os || !os->hasPosition() || !os->hasHealth() || !os->hasTeam())
+                continue;
 
-            if (bestD2 > CombatTuning::FALLBACK_NO_ENEMY_DIST2)
+            const auto &op = os->positions();
+            const auto &oh = os->healths();
+            const auto &ot = os->teams();
+            const uint32_t on = os->size();
+            for (uint32_t orow = 0; orow < on; ++orow)
             {
-                for (uint32_t oaid : q.matchingArchetypeIds)
+                if (oh[orow].value <= 0.0f)
+                    continue;
+                if (ot[orow].id == myTeam)
+                    continue;
+
+                const float ex = op[orow].x;
+                const float ez = op[orow].z;
+                const float d2e = (ex - posX) * (ex - posX) + (ez - posZ) * (ez - posZ);
+                if (d2e < bestD2)
                 {
-                    auto *os = ecs.stores.get(oaid);
-                    if (!os || !os->hasPosition() || !os->hasHealth() || !os->hasTeam())
-                        continue;
-
-                    const auto &op = os->positions();
-                    const auto &oh = os->healths();
-                    const auto &ot = os->teams();
-                    const uint32_t on = os->size();
-                    for (uint32_t orow = 0; orow < on; ++orow)
-                    {
-                        if (oh[orow].value <= 0.0f)
-                            continue;
-                        if (ot[orow].id == myTeam)
-                            continue;
-
-                        const float ex = op[orow].x;
-                        const float ez = op[orow].z;
-                        const float d2 = (ex - pos[r].x) * (ex - pos[r].x) + (ez - pos[r].z) * (ez - pos[r].z);
-                        if (d2 < bestD2)
-                        {
-                            bestD2 = d2;
-                            bestEX = ex;
-                            bestEZ = ez;
-                        }
-                    }
+                    bestD2 = d2e;
+                    bestEX = ex;
+                    bestEZ = ez;
                 }
             }
-
-            if (bestD2 <= CombatTuning::FALLBACK_NO_ENEMY_DIST2)
-            {
-                mt[r].x = bestEX;
-                mt[r].y = 0.0f;
-                mt[r].z = bestEZ;
-                mt[r].active = 1;
-                ecs.markDirty(m_moveTargetId, aid, r);
-            }
         }
     }
+
+    // No enemy anywhere: keep running to the click and look again next tick.
+    if (bestD2 > CombatTuning::FALLBACK_NO_ENEMY_DIST2)
+        return TaskWait::nextTick();
+
+    task.promote = true;
+    task.tx = bestEX;
+    task.tz = bestEZ;
+    return TaskWait::done();
 }
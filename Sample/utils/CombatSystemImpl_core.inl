@@ -6,14 +6,22 @@
 inline CombatSystem::CombatSystem()
 {
     setRequiredNames({"Position", "Health", "Velocity", "MoveTarget", "MoveSpeed",
-                      "Facing", "Team", "AttackCooldown", "RenderAnimation"});
+                      "Facing", "Team", "AttackCooldown", "RenderAnimation", "CombatMemory"});
     setExcludedNames({"Dead", "Disabled"});
+    // No read/write declaration: combat tags dead units (structural change), so the
+    // scheduler runs it exclusively.
 
     // Non-deterministic seed so each run plays differently
     std::random_device rd;
     m_rng.seed(rd());
 }
 
+inline bool CombatSystem::isLivingUnit(Engine::ECS::ECSContext &ecs, const GridNeighbor &n)
+{
+    const auto *os = ecs.stores.get(n.entry.storeId);
+    return os && os->hasHealth() && n.entry.row < os->size() && os->healths()[n.entry.row].value > 0.0f;
+}
+
 inline void CombatSystem::buildMasks(Engine::ECS::ComponentRegistry &registry)
 {
     Engine::ECS::SystemBase::buildMasks(registry);
@@ -26,5 +34,6 @@ inline void CombatSystem::buildMasks(Engine::ECS::ComponentRegistry &registry)
     m_renderAnimId = registry.ensureId("RenderAnimation");
     m_facingId = registry.ensureId("Facing");
     m_deadId = registry.ensureId("Dead");
+    m_combatMemoryId = registry.ensureId("CombatMemory");
     m_queryId = Engine::ECS::QueryManager::InvalidQuery;
 }
@@ -19,7 +19,7 @@ inline void CombatSystem::staggerInitialCooldowns(Engine::ECS::ECSContext &ecs)
         if (!st || !st->hasAttackCooldown() || !st->hasHealth())
             continue;
 
-        auto &cd = st->attackCooldowns();
+        auto cd = st->attackCooldowns();
         const auto &hp = st->healths();
         const uint32_t n = st->size();
         for (uint32_t row = 0; row < n; ++row)
@@ -36,6 +36,7 @@ inline void CombatSystem::staggerInitialCooldowns(Engine::ECS::ECSContext &ecs)
 inline void CombatSystem::refreshTeamStats(Engine::ECS::ECSContext &ecs)
 {
     // Reset counts
+    m_trackedAlive = 0;
     for (auto &[id, s] : m_teamStats)
     {
         s.alive = 0;
@@ -63,6 +64,7 @@ inline void CombatSystem::refreshTeamStats(Engine::ECS::ECSContext &ecs)
             auto &ts = m_teamStats[teams[row].id];
             ts.alive++;
             ts.currentHP += std::max(0.0f, hp[row].value);
+            ++m_trackedAlive;
         }
     }
 
@@ -75,6 +77,34 @@ inline void CombatSystem::refreshTeamStats(Engine::ECS::ECSContext &ecs)
     }
 }
 
+inline bool CombatSystem::teamPopulationChanged(Engine::ECS::ECSContext &ecs) const
+{
+    // Every row of a matching store has Health and Team; units combat killed carry the Dead
+    // tag (excluded) once the previous tick's commands were applied, so the rows left are the
+    // living units TeamStats counts.
+    const auto &q = ecs.queries.get(m_queryId);
+    uint64_t rows = 0;
+    for (uint32_t archetypeId : q.matchingArchetypeIds)
+    {
+        if (const auto *st = ecs.stores.get(archetypeId))
+            rows += st->size();
+    }
+    return rows != static_cast<uint64_t>(m_trackedAlive);
+}
+
+inline void CombatSystem::applyDamageToStats(uint8_t team, float before, float after)
+{
+    if (before <= 0.0f)
+        return; // already counted out
+    auto &ts = m_teamStats[team];
+    ts.currentHP = std::max(0.0f, ts.currentHP - (before - std::max(0.0f, after)));
+    if (after <= 0.0f)
+    {
+        ts.alive = std::max(0, ts.alive - 1);
+        m_trackedAlive = std::max(0, m_trackedAlive - 1);
+    }
+}
+
 inline void CombatSystem::processDeathRemovals(Engine::ECS::ECSContext &ecs, float dt)
 {
     // Swap-and-pop instead of erase — O(1) per removal instead of O(N)
@@ -85,22 +115,9 @@ inline void CombatSystem::processDeathRemovals(Engine::ECS::ECSContext &ecs, flo
         if (m_deathQueue[i].timeRemaining <= 0.0f)
         {
             auto &pd = m_deathQueue[i];
-            // Destroy the entity
+            // Destroy the entity (deferred to the scheduler's next sync point)
             if (ecs.entities.isAlive(pd.entity))
-            {
-                auto *rec = ecs.entities.find(pd.entity);
-                if (rec)
-                {
-                    auto *store = ecs.stores.get(rec->archetypeId);
-                    if (store)
-                    {
-                        Engine::ECS::Entity moved = store->destroyRowSwap(rec->row);
-                        if (moved.valid())
-                            ecs.entities.attach(moved, rec->archetypeId, rec->row);
-                    }
-                }
-                ecs.entities.destroy(pd.entity);
-            }
+                ecs.commands.writer().destroy(pd.entity);
             m_deathQueueSet.erase(pd.entity.index);
             // Swap with last and pop — don't increment i
             pd = m_deathQueue.back();
@@ -11,6 +11,8 @@ inline void CombatSystem::update(Engine::ECS::ECSContext &ecs, float dt)
         return;
 
     ++m_frameCounter;
+    m_scansDone.store(0, std::memory_order_relaxed);
+    m_scansHeld.store(0, std::memory_order_relaxed);
 
     auto entityKey = [](const Engine::ECS::Entity &e) -> uint64_t
     {
@@ -35,8 +37,8 @@ inline void CombatSystem::update(Engine::ECS::ECSContext &ecs, float dt)
     if (m_queryId == Engine::ECS::QueryManager::InvalidQuery)
         m_queryId = ecs.queries.createQuery(required(), excluded(), ecs.stores);
 
-    // ---- Phase 0: Refresh team stats (only when state changed) ----
-    if (m_statsDirty)
+    // ---- Phase 0: Recount team stats (reset, or units added/removed outside combat) ----
+    if (m_statsDirty || teamPopulationChanged(ecs))
     {
         refreshTeamStats(ecs);
         m_statsDirty = false;
@@ -51,18 +53,9 @@ inline void CombatSystem::update(Engine::ECS::ECSContext &ecs, float dt)
         const float engageR = std::max(0.0f, m_cfg.engageRange);
         if (engageR <= 0.0f)
             return;
-        const float engageR2 = engageR * engageR;
-
-        struct UnitPos
-        {
-            float x;
-            float z;
-            uint8_t team;
-        };
-
-        std::vector<UnitPos> units;
-        units.reserve(256);
 
+        // Any living unit with a living enemy mover within engageR (enemy team layers only).
+        bool shouldStart = false;
         const auto &q0 = ecs.queries.get(m_queryId);
         for (uint32_t archetypeId : q0.matchingArchetypeIds)
         {
@@ -74,30 +67,20 @@ inline void CombatSystem::update(Engine::ECS::ECSContext &ecs, float dt)
             const auto &hp = st->healths();
             const auto &tm = st->teams();
             const uint32_t n = st->size();
-            for (uint32_t row = 0; row < n; ++row)
+            for (uint32_t row = 0; row < n && !shouldStart; ++row)
             {
                 if (hp[row].value <= 0.0f)
                     continue;
-                units.push_back(UnitPos{pos[row].x, pos[row].z, tm[row].id});
-            }
-        }
-
-        bool shouldStart = false;
-        for (size_t i = 0; i < units.size() && !shouldStart; ++i)
-        {
-            for (size_t j = i + 1; j < units.size(); ++j)
-            {
-                if (units[i].team == units[j].team)
-                    continue;
-                const float dx = units[i].x - units[j].x;
-                const float dz = units[i].z - units[j].z;
-                const float d2 = dx * dx + dz * dz;
-                if (d2 <= engageR2)
-                {
-                    shouldStart = true;
-                    break;
-                }
+                GridNeighborFilter filter;
+                filter.teamMode = GridNeighborFilter::TeamMode::Other;
+                filter.team = tm[row].id;
+                filter.requireFlags = GRID_NEIGHBOR_MOVER;
+                GridNeighborHit hit;
+                shouldStart = m_spatial->findNearest(pos[row].x, pos[row].z, engageR, filter, hit, [&](const GridNeighbor &nb)
+                                                     { return isLivingUnit(ecs, nb); });
             }
+            if (shouldStart)
+                break;
         }
 
         if (!shouldStart)
@@ -116,7 +99,7 @@ inline void CombatSystem::update(Engine::ECS::ECSContext &ecs, float dt)
     }
     // ── Charge: promote units near click to leg-2 ───────────────
     if (m_chargeActive)
-        promoteUnitsNearClick(ecs, q);
+        promoteUnitsNearClick(ecs, q, dt);
 
     const float meleeRange = std::max(0.0f, m_cfg.meleeRange);
     const float meleeRange2 = meleeRange * meleeRange;
@@ -154,16 +137,14 @@ inline void CombatSystem::update(Engine::ECS::ECSContext &ecs, float dt)
 
     std::vector<WorkItem> work;
     work.reserve(512);
-    std::vector<UnitCombatMemory> prevMem;
-    prevMem.reserve(512);
 
-    // Build a stable work list of living units, and snapshot previous combat memory.
+    // Build a stable work list of living units (their CombatMemory is read and written in place).
     for (uint32_t archetypeId : q.matchingArchetypeIds)
     {
         auto *storePtr = ecs.stores.get(archetypeId);
         if (!storePtr || !storePtr->hasPosition() || !storePtr->hasHealth() || !storePtr->hasTeam() ||
             !storePtr->hasAttackCooldown() || !storePtr->hasRenderAnimation() || !storePtr->hasFacing() ||
-            !storePtr->hasMoveTarget())
+            !storePtr->hasMoveTarget() || !storePtr->hasCombatMemory())
         {
             continue;
         }
@@ -177,14 +158,7 @@ inline void CombatSystem::update(Engine::ECS::ECSContext &ecs, float dt)
                 continue;
 
             const Engine::ECS::Entity e = ents[row];
-            const uint64_t key = entityKey(e);
-            work.push_back(WorkItem{archetypeId, row, e, key});
-
-            UnitCombatMemory mem{};
-            auto it = m_unitMem.find(key);
-            if (it != m_unitMem.end())
-                mem = it->second;
-            prevMem.push_back(mem);
+            work.push_back(WorkItem{archetypeId, row, e, entityKey(e)});
         }
     }
 
@@ -201,9 +175,14 @@ inline void CombatSystem::update(Engine::ECS::ECSContext &ecs, float dt)
     std::vector<DamageAction> damageOut(workCount);
     std::vector<uint8_t> hasDamageAnim(workCount, 0);
     std::vector<AnimAction> damageAnimOut(workCount);
-    std::vector<UnitCombatMemory> nextMem(workCount);
+    std::vector<uint8_t> engagedOut(workCount, 0);
 
     const bool chargeActiveForDecisions = m_chargeActive;
+    const bool lodActive = m_lod && m_lod->enabled();
+    const uint32_t farRetargetTicks = CombatTuning::RETARGET_INTERVAL_TICKS * (lodActive ? std::max(m_lod->config().retargetScale, 1u) : 1u);
+    const bool farExpectedDamage = lodActive && m_lod->config().expectedDamage;
+    const bool scansLimited = workBudget() != UNLIMITED_WORK;
+    m_scansLeft.store(static_cast<int64_t>(workBudget()), std::memory_order_relaxed);
 
     auto splitmix64 = [](uint64_t &x) -> uint64_t
     {
@@ -220,7 +199,7 @@ inline void CombatSystem::update(Engine::ECS::ECSContext &ecs, float dt)
         if (!storePtr)
             return;
 
-        auto &cooldowns = storePtr->attackCooldowns();
+        auto cooldowns = storePtr->attackCooldowns();
         const auto &pos = storePtr->positions();
         const auto &healths = storePtr->healths();
         const auto &teams = storePtr->teams();
@@ -238,8 +217,9 @@ inline void CombatSystem::update(Engine::ECS::ECSContext &ecs, float dt)
         const float myZ = pos[wi.row].z;
         const uint8_t myTeam = teams[wi.row].id;
 
-        UnitCombatMemory mem = prevMem[idx];
-        mem.lastSeenFrame = m_frameCounter;
+        Engine::ECS::CombatMemory &mem = storePtr->combatMemories()[wi.row];
+        const bool far = lodActive && m_lod->isFar(ecs, myEntity, myX, myZ);
+        const uint32_t retargetTicks = far ? farRetargetTicks : CombatTuning::RETARGET_INTERVAL_TICKS;
 
         // Deterministic per-entity RNG (stable across thread counts).
         uint64_t rngState = wi.selfKey ^ (static_cast<uint64_t>(m_frameCounter) * 0xd1342543de82ef95ull);
@@ -258,94 +238,89 @@ inline void CombatSystem::update(Engine::ECS::ECSContext &ecs, float dt)
             return static_cast<uint32_t>(splitmix64(rngState));
         };
 
-        Engine::ECS::Entity bestEnemy{};
-        float bestEX = myX;
-        float bestEZ = myZ;
-        float bestDist2 = CombatTuning::BEST_DIST2_INIT;
-
-        // Spatial lookup: nearest enemy in neighborhood
-        if (m_spatial)
+        // Current target, if it is still a living enemy.
+        bool haveTarget = false;
+        float targetX = myX;
+        float targetZ = myZ;
+        float targetDist2 = CombatTuning::BEST_DIST2_INIT;
+        if (mem.targetEnemy.valid())
         {
-            m_spatial->forNeighbors(myX, myZ, [&](uint32_t otherArchId, uint32_t otherRow)
-                                    {
-                                        auto *os = ecs.stores.get(otherArchId);
-                                        if (!os || !os->hasPosition() || !os->hasHealth() || !os->hasTeam())
-                                            return;
-                                        if (otherRow >= os->size())
-                                            return;
-
-                                        if (os->healths()[otherRow].value <= 0.0f)
-                                            return;
-                                        if (os->teams()[otherRow].id == myTeam)
-                                            return;
-
-                                        const float ex = os->positions()[otherRow].x;
-                                        const float ez = os->positions()[otherRow].z;
-                                        const float dx = ex - myX;
-                                        const float dz = ez - myZ;
-                                        const float d2 = dx * dx + dz * dz;
-
-                                        const Engine::ECS::Entity cand = os->entities()[otherRow];
-                                        const float tieEps = CombatTuning::ENEMY_TIE_EPS;
-                                        const bool better = (d2 < bestDist2 - tieEps) ||
-                                                            (std::fabs(d2 - bestDist2) <= tieEps &&
-                                                             (!bestEnemy.valid() || cand.index < bestEnemy.index));
-                                        if (better)
-                                        {
-                                            bestDist2 = d2;
-                                            bestEX = ex;
-                                            bestEZ = ez;
-                                            bestEnemy = cand;
-                                        } });
+            const auto *trec = ecs.entities.find(mem.targetEnemy);
+            auto *tst = trec ? ecs.stores.get(trec->archetypeId) : nullptr;
+            if (tst && trec->row < tst->size() && tst->hasPosition() && tst->hasHealth() && tst->hasTeam() &&
+                tst->healths()[trec->row].value > 0.0f && tst->teams()[trec->row].id != myTeam)
+            {
+                haveTarget = true;
+                targetX = tst->positions()[trec->row].x;
+                targetZ = tst->positions()[trec->row].z;
+                const float tdx = targetX - myX;
+                const float tdz = targetZ - myZ;
+                targetDist2 = tdx * tdx + tdz * tdz;
+            }
         }
 
-        // Fallback: full scan only if spatial found nothing
-        if (!bestEnemy.valid())
+        // Amortized acquisition: search every RETARGET_INTERVAL_TICKS (staggered per unit), or at
+        // once when the target died or vanished.
+        const bool targetLost = mem.targetEnemy.valid() && !haveTarget;
+        bool rescan = targetLost || m_frameCounter >= mem.nextScanTick;
+        // Over the work budget a scheduled search waits (the unit keeps its target), unless it
+        // is already a full interval late.
+        if (rescan && !targetLost && scansLimited &&
+            m_frameCounter < mem.nextScanTick + retargetTicks &&
+            m_scansLeft.fetch_sub(1, std::memory_order_relaxed) <= 0)
         {
-            for (uint32_t otherArchId : q.matchingArchetypeIds)
-            {
-                auto *os = ecs.stores.get(otherArchId);
-                if (!os || !os->hasPosition() || !os->hasHealth() || !os->hasTeam())
-                    continue;
+            rescan = false;
+            m_scansHeld.fetch_add(1, std::memory_order_relaxed);
+        }
 
-                const auto &oPos = os->positions();
-                const auto &oHP = os->healths();
-                const auto &oTeam = os->teams();
-                const auto &oEnt = os->entities();
-                const uint32_t oN = os->size();
+        Engine::ECS::Entity chosenEnemy{};
+        float chosenEX = myX;
+        float chosenEZ = myZ;
+        float chosenDist2 = CombatTuning::BEST_DIST2_INIT;
+        if (haveTarget)
+        {
+            chosenEnemy = mem.targetEnemy;
+            chosenEX = targetX;
+            chosenEZ = targetZ;
+            chosenDist2 = targetDist2;
+        }
 
-                for (uint32_t oRow = 0; oRow < oN; ++oRow)
+        if (rescan)
+        {
+            m_scansDone.fetch_add(1, std::memory_order_relaxed);
+            const uint32_t stagger = (mem.nextScanTick == 0) ? (myEntity.index % retargetTicks) : 0u;
+            mem.nextScanTick = m_frameCounter + retargetTicks + stagger;
+
+            // Nothing beyond engageRange (plus hysteresis while engaged) can keep or start a fight,
+            // so the search never needs to go further. Only enemy movers' cells are visited.
+            GridNeighborFilter filter;
+            filter.teamMode = GridNeighborFilter::TeamMode::Other;
+            filter.team = myTeam;
+            filter.requireFlags = GRID_NEIGHBOR_MOVER;
+            filter.excludeStoreId = wi.archetypeId;
+            filter.excludeRow = wi.row;
+
+            const float reach = mem.engaged ? engageRange + CombatTuning::ENGAGE_HYSTERESIS_M : engageRange;
+            const float searchR = std::max(reach, m_spatial->getCellSize());
+            GridNeighborHit hit;
+            if (m_spatial->findNearest(myX, myZ, searchR, filter, hit, [&](const GridNeighbor &n)
+                                       { return isLivingUnit(ecs, n); }))
+            {
+                // Keep the last target (stickiness) unless the new one is clearly closer.
+                const float switchFrac = 0.15f;
+                if (!haveTarget || hit.dist2 < targetDist2 * (1.0f - switchFrac))
                 {
-                    if (otherArchId == wi.archetypeId && oRow == wi.row)
-                        continue;
-                    if (oTeam[oRow].id == myTeam)
-                        continue;
-                    if (oHP[oRow].value <= 0.0f)
-                        continue;
-
-                    const float dx = oPos[oRow].x - myX;
-                    const float dz = oPos[oRow].z - myZ;
-                    const float d2 = dx * dx + dz * dz;
-
-                    const Engine::ECS::Entity cand = oEnt[oRow];
-                    const float tieEps = CombatTuning::ENEMY_TIE_EPS;
-                    const bool better = (d2 < bestDist2 - tieEps) ||
-                                        (std::fabs(d2 - bestDist2) <= tieEps &&
-                                         (!bestEnemy.valid() || cand.index < bestEnemy.index));
-                    if (better)
-                    {
-                        bestDist2 = d2;
-                        bestEX = oPos[oRow].x;
-                        bestEZ = oPos[oRow].z;
-                        bestEnemy = cand;
-                    }
+                    chosenDist2 = hit.dist2;
+                    chosenEX = hit.neighbor.x;
+                    chosenEZ = hit.neighbor.z;
+                    chosenEnemy = ecs.stores.get(hit.neighbor.entry.storeId)->entities()[hit.neighbor.entry.row];
                 }
             }
         }
 
-        if (!bestEnemy.valid())
+        if (!chosenEnemy.valid())
         {
-            // No enemies exist anywhere. Do not stomp player move targets.
+            // No enemy within reach. Do not stomp player move targets.
             // Only stop units that were previously chasing due to combat.
             if (mem.combatMoveIssued)
             {
@@ -353,52 +328,15 @@ inline void CombatSystem::update(Engine::ECS::ECSContext &ecs, float dt)
                 const bool clearVel = (storePtr->moveTargets()[wi.row].active != 0);
                 hasStop[idx] = 1;
                 stopOut[idx] = StopAction{myEntity, yaw, clearVel};
-                mem.combatMoveIssued = false;
+                mem.combatMoveIssued = 0;
             }
 
             mem.targetEnemy = Engine::ECS::Entity{};
-            mem.engaged = false;
-            mem.inMelee = false;
-            nextMem[idx] = mem;
+            mem.engaged = 0;
+            mem.inMelee = 0;
             return;
         }
 
-        // Decide whether to keep last target (stickiness) to avoid rapid swapping.
-        Engine::ECS::Entity chosenEnemy = bestEnemy;
-        float chosenEX = bestEX;
-        float chosenEZ = bestEZ;
-        float chosenDist2 = bestDist2;
-
-        if (mem.targetEnemy.valid())
-        {
-            const auto *trec = ecs.entities.find(mem.targetEnemy);
-            if (trec)
-            {
-                auto *tst = ecs.stores.get(trec->archetypeId);
-                if (tst && trec->row < tst->size() && tst->hasPosition() && tst->hasHealth() && tst->hasTeam())
-                {
-                    if (tst->healths()[trec->row].value > 0.0f && tst->teams()[trec->row].id != myTeam)
-                    {
-                        const float tx = tst->positions()[trec->row].x;
-                        const float tz = tst->positions()[trec->row].z;
-                        const float tdx = tx - myX;
-                        const float tdz = tz - myZ;
-                        const float tdist2 = tdx * tdx + tdz * tdz;
-
-                        const float switchFrac = 0.15f;
-                        const bool keepOld = !(bestDist2 < tdist2 * (1.0f - switchFrac));
-                        if (keepOld)
-                        {
-                            chosenEnemy = mem.targetEnemy;
-                            chosenEX = tx;
-                            chosenEZ = tz;
-                            chosenDist2 = tdist2;
-                        }
-                    }
-                }
-            }
-        }
-
         mem.targetEnemy = chosenEnemy;
 
         // Local engagement gating: only units that have an enemy within engageRange
@@ -418,13 +356,12 @@ inline void CombatSystem::update(Engine::ECS::ECSContext &ecs, float dt)
                 const bool clearVel = (storePtr->moveTargets()[wi.row].active != 0);
                 hasStop[idx] = 1;
                 stopOut[idx] = StopAction{myEntity, yaw, clearVel};
-                mem.combatMoveIssued = false;
+                mem.combatMoveIssued = 0;
             }
 
             mem.targetEnemy = Engine::ECS::Entity{};
-            mem.engaged = false;
-            mem.inMelee = false;
-            nextMem[idx] = mem;
+            mem.engaged = 0;
+            mem.inMelee = 0;
             return;
         }
 
@@ -435,14 +372,15 @@ inline void CombatSystem::update(Engine::ECS::ECSContext &ecs, float dt)
                               : storePtr->facings()[wi.row].yaw;
 
         // From here on, unit is considered engaged in combat.
-        mem.engaged = true;
+        mem.engaged = 1;
+        engagedOut[idx] = 1;
 
         const bool inMelee = mem.inMelee ? (chosenDist2 <= disengageRange2) : (chosenDist2 <= meleeRange2);
         if (inMelee)
         {
             // We're fighting in melee range.
-            mem.combatMoveIssued = false;
-            mem.inMelee = true;
+            mem.combatMoveIssued = 0;
+            mem.inMelee = 1;
 
             const bool clearVel = (storePtr->moveTargets()[wi.row].active != 0);
             hasStop[idx] = 1;
@@ -457,13 +395,52 @@ inline void CombatSystem::update(Engine::ECS::ECSContext &ecs, float dt)
                 hasAttackAnim[idx] = 1;
                 attackAnimOut[idx] = AnimAction{myEntity, attackClip, CombatTuning::ATTACK_ANIM_SPEED, false};
 
+                float myHPFrac = healths[wi.row].value / m_cfg.maxHPPerUnit;
+                float rageMult = 1.0f + m_cfg.rageMaxBonus * (1.0f - std::clamp(myHPFrac, 0.0f, 1.0f));
+
+                // Sparks on the target's side facing the attacker, thrown away from it. Pushed
+                // straight from the worker: the ring is lock-free.
+                auto emitHit = [&](float scale)
+                {
+                    if (!m_particles)
+                        return;
+                    const float dx = chosenEX - myX;
+                    const float dz = chosenEZ - myZ;
+                    const float len = std::sqrt(dx * dx + dz * dz);
+                    const float nx = len > 1e-4f ? dx / len : 0.0f;
+                    const float nz = len > 1e-4f ? dz / len : 0.0f;
+                    Engine::ParticleSpawn spawn;
+                    spawn.position = glm::vec3(chosenEX - nx * 0.3f, pos[wi.row].y + CombatTuning::HIT_EFFECT_HEIGHT, chosenEZ - nz * 0.3f);
+                    spawn.ground = pos[wi.row].y;
+                    spawn.direction = glm::vec3(nx, 0.35f, nz);
+                    spawn.scale = scale;
+                    spawn.effect = Engine::ParticleEffect::Hit;
+                    m_particles->push(spawn);
+                };
+
+                if (far && farExpectedDamage)
+                {
+                    // Far tier: one aggregate hit worth the mean of the miss / damage / crit rolls.
+                    const float hitChance = 1.0f - std::clamp(m_cfg.missChance, 0.0f, 1.0f);
+                    const float critChance = std::clamp(m_cfg.critChance, 0.0f, 1.0f);
+                    const float critGain = 1.0f + critChance * (m_cfg.critMultiplier - 1.0f);
+                    const float meanDmg = 0.5f * (m_cfg.damageMin + m_cfg.damageMax);
+                    if (hitChance > 0.0f)
+                    {
+                        hasDamage[idx] = 1;
+                        damageOut[idx] = DamageAction{chosenEnemy, hitChance * meanDmg * rageMult * critGain};
+                        emitHit(1.0f);
+
+                        const uint32_t dmgCount = (CombatAnims::DAMAGE_END - CombatAnims::DAMAGE_START + 1);
+                        hasDamageAnim[idx] = 1;
+                        damageAnimOut[idx] = AnimAction{chosenEnemy, CombatAnims::DAMAGE_START + (myEntity.index % dmgCount),
+                                                        CombatTuning::DAMAGE_ANIM_SPEED, false};
+                    }
+                }
                 // --- Roll hit / miss ---
-                if (rand01() >= m_cfg.missChance)
+                else if (rand01() >= m_cfg.missChance)
                 {
                     float baseDmg = m_cfg.damageMin + rand01() * (m_cfg.damageMax - m_cfg.damageMin);
-
-                    float myHPFrac = healths[wi.row].value / m_cfg.maxHPPerUnit;
-                    float rageMult = 1.0f + m_cfg.rageMaxBonus * (1.0f - std::clamp(myHPFrac, 0.0f, 1.0f));
                     baseDmg *= rageMult;
 
                     const bool isCrit = (rand01() < m_cfg.critChance);
@@ -472,6 +449,7 @@ inline void CombatSystem::update(Engine::ECS::ECSContext &ecs, float dt)
 
                     hasDamage[idx] = 1;
                     damageOut[idx] = DamageAction{chosenEnemy, baseDmg};
+                    emitHit(isCrit ? CombatTuning::CRIT_EFFECT_SCALE : 1.0f);
 
                     const uint32_t dmgCount = (CombatAnims::DAMAGE_END - CombatAnims::DAMAGE_START + 1);
                     const uint32_t dmgClip = CombatAnims::DAMAGE_START + (randU32() % dmgCount);
@@ -484,7 +462,7 @@ inline void CombatSystem::update(Engine::ECS::ECSContext &ecs, float dt)
         else
         {
             // Not in melee yet: chase toward the chosen enemy.
-            mem.inMelee = false;
+            mem.inMelee = 0;
 
             bool skipChase = false;
             if (chargeActiveForDecisions)
@@ -512,11 +490,9 @@ inline void CombatSystem::update(Engine::ECS::ECSContext &ecs, float dt)
                                           yaw,
                                           CombatAnims::RUN,
                                           anims[wi.row].clipIndex != CombatAnims::RUN};
-                mem.combatMoveIssued = true;
+                mem.combatMoveIssued = 1;
             }
         }
-
-        nextMem[idx] = mem;
     };
 
     Engine::JobSystem *js = ecs.jobSystem;
@@ -530,17 +506,10 @@ inline void CombatSystem::update(Engine::ECS::ECSContext &ecs, float dt)
             decideOne(0, i);
     }
 
-    // Merge memory updates and per-item actions in stable order.
+    // Merge per-item actions in stable order.
     bool anyEngagedThisFrame = false;
     for (uint32_t i = 0; i < workCount; ++i)
-    {
-        if (nextMem[i].lastSeenFrame == m_frameCounter)
-        {
-            auto &mem = m_unitMem[work[i].selfKey];
-            mem = nextMem[i];
-            anyEngagedThisFrame = anyEngagedThisFrame || mem.engaged;
-        }
-    }
+        anyEngagedThisFrame = anyEngagedThisFrame || engagedOut[i];
     if (m_chargeActive && anyEngagedThisFrame)
         m_chargeActive = false;
 
@@ -564,18 +533,6 @@ inline void CombatSystem::update(Engine::ECS::ECSContext &ecs, float dt)
     auto &damages = m_damages;
     auto &damageAnims = m_damageAnims;
 
-    // Cleanup unit memory for entities not seen this frame.
-    if (!m_unitMem.empty())
-    {
-        for (auto it = m_unitMem.begin(); it != m_unitMem.end();)
-        {
-            if (it->second.lastSeenFrame != m_frameCounter)
-                it = m_unitMem.erase(it);
-            else
-                ++it;
-        }
-    }
-
     // ---- Phase 3: Apply deferred actions (safe to mutate stores now) ----
 
     // Apply stops
@@ -637,8 +594,7 @@ inline void CombatSystem::update(Engine::ECS::ECSContext &ecs, float dt)
             st->facings()[rec->row].yaw = mv.yaw;
         if (mv.setRunAnim && st->hasRenderAnimation())
         {
-            st->renderAnimations()[rec->row].clipIndex = mv.runClip;
-            st->renderAnimations()[rec->row].timeSec = 0.0f;
+            Engine::ECS::CrossfadeTo(st->renderAnimations()[rec->row], mv.runClip, m_cfg.animCrossfadeSec);
             st->renderAnimations()[rec->row].playing = true;
             st->renderAnimations()[rec->row].loop = true;
             st->renderAnimations()[rec->row].speed = 1.0f;
@@ -656,8 +612,7 @@ inline void CombatSystem::update(Engine::ECS::ECSContext &ecs, float dt)
         if (!st || rec->row >= st->size() || !st->hasRenderAnimation())
             continue;
 
-        st->renderAnimations()[rec->row].clipIndex = aa.clipIndex;
-        st->renderAnimations()[rec->row].timeSec = 0.0f;
+        Engine::ECS::CrossfadeTo(st->renderAnimations()[rec->row], aa.clipIndex, m_cfg.animCrossfadeSec);
         st->renderAnimations()[rec->row].playing = true;
         st->renderAnimations()[rec->row].loop = aa.loop;
         st->renderAnimations()[rec->row].speed = aa.speed;
@@ -674,8 +629,11 @@ inline void CombatSystem::update(Engine::ECS::ECSContext &ecs, float dt)
         if (!st || rec->row >= st->size() || !st->hasHealth())
             continue;
 
-        st->healths()[rec->row].value -= d.damage;
-        m_statsDirty = true;
+        float &health = st->healths()[rec->row].value;
+        const float before = health;
+        health -= d.damage;
+        if (st->hasTeam())
+            applyDamageToStats(st->teams()[rec->row].id, before, health);
     }
 
     // Apply damage anims (only if still alive — death anim will override below)
@@ -693,8 +651,7 @@ inline void CombatSystem::update(Engine::ECS::ECSContext &ecs, float dt)
         // Only play damage anim if still alive
         if (st->healths()[rec->row].value > 0.0f)
         {
-            st->renderAnimations()[rec->row].clipIndex = da.clipIndex;
-            st->renderAnimations()[rec->row].timeSec = 0.0f;
+            Engine::ECS::CrossfadeTo(st->renderAnimations()[rec->row], da.clipIndex, m_cfg.animCrossfadeSec);
             st->renderAnimations()[rec->row].playing = true;
             st->renderAnimations()[rec->row].loop = false;
             st->renderAnimations()[rec->row].speed = da.speed;
@@ -727,7 +684,7 @@ inline void CombatSystem::update(Engine::ECS::ECSContext &ecs, float dt)
             }
         }
 
-        // Now apply death effects — these migrate entities so must be done outside iteration
+        // Now apply death effects; the Dead tag is deferred to ecs.commands so stores stay put
         for (const auto &deadEntity : m_newlyDead)
         {
             auto *rec = ecs.entities.find(deadEntity);
@@ -742,24 +699,36 @@ inline void CombatSystem::update(Engine::ECS::ECSContext &ecs, float dt)
             {
                 uint32_t deathClip = CombatAnims::DEATH_START +
                                      (m_rng() % (CombatAnims::DEATH_END - CombatAnims::DEATH_START + 1));
-                st->renderAnimations()[rec->row].clipIndex = deathClip;
-                st->renderAnimations()[rec->row].timeSec = 0.0f;
+                Engine::ECS::CrossfadeTo(st->renderAnimations()[rec->row], deathClip, m_cfg.animCrossfadeSec);
                 st->renderAnimations()[rec->row].playing = true;
                 st->renderAnimations()[rec->row].loop = false;
                 st->renderAnimations()[rec->row].speed = 1.0f;
             }
 
+            // A burst where the unit falls and dust where it lands.
+            if (m_particles && st->hasPosition())
+            {
+                const auto &p = st->positions()[rec->row];
+                Engine::ParticleSpawn spawn;
+                spawn.position = glm::vec3(p.x, p.y + CombatTuning::HIT_EFFECT_HEIGHT, p.z);
+                spawn.ground = p.y;
+                spawn.effect = Engine::ParticleEffect::Death;
+                m_particles->push(spawn);
+                spawn.position.y = p.y + 0.1f;
+                spawn.effect = Engine::ParticleEffect::Dust;
+                m_particles->push(spawn);
+            }
+
             // Stop moving
             if (st->hasVelocity())
                 st->velocities()[rec->row] = {0.0f, 0.0f, 0.0f};
             if (st->hasMoveTarget())
                 st->moveTargets()[rec->row].active = 0;
 
-            // Schedule removal and migrate to Dead archetype
+            // Schedule removal and migrate to Dead archetype (at the scheduler's next sync point)
             m_deathQueue.push_back({deadEntity, m_cfg.deathRemoveDelay});
             m_deathQueueSet.insert(deadEntity.index);
-            m_statsDirty = true;
-            ecs.addTag(deadEntity, m_deadId);
+            ecs.commands.writer().addComponent(deadEntity, m_deadId);
         }
     }
 }